@@ -0,0 +1,167 @@
+#version 430 core
+
+// Culls the instances of all the model groups against the view frustum on the GPU,
+//   picking the level of detail of each visible instance by its projected size.
+// The per-instance details of the visible instances are compacted into a region of
+//   their own per level of detail of each group, counted by the instance count of the
+//   indirect draw command of the level, so that each model group is drawn with a
+//   single multi-draw without reading anything back.
+
+// The number of levels of detail of an object, LOD_COUNT, is defined by the shader manager from the engine limits.
+
+// The number of instances culled by each work group (matches GPU_CULLING_WORK_GROUP_SIZE).
+layout(local_size_x = 64) in;
+
+// The structure defining the details of an instance to cull.
+// The layout matches the GpuCullInstanceData structure in the GPU culling.
+struct CullInstance
+{
+	// The corner of the world AABB of the instance with the smallest coordinates.
+	vec3 minCorner;
+	// The index of the model group of the instance.
+	uint groupIndex;
+	// The corner of the world AABB of the instance with the largest coordinates.
+	vec3 maxCorner;
+	// Whether the instance is hidden behind the depth of the last frames (tested on the CPU).
+	uint isOccluded;
+};
+
+// The structure defining the details of a model group.
+// The layout matches the GpuCullGroupData structure in the GPU culling.
+struct CullGroup
+{
+	// The number of levels of detail of the object of the group.
+	uint lodsCount;
+	// The index of the draw command of the first level of detail of the group.
+	uint firstCommand;
+	uint padding0;
+	uint padding1;
+};
+
+// The structure defining an indirect draw command, as read by glMultiDrawElementsIndirect.
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+// The instances to cull, in the same order as the model matrices.
+layout(std430, binding = 0) readonly buffer CullInstances
+{
+	CullInstance instances[];
+};
+// The model groups the instances belong to.
+layout(std430, binding = 1) readonly buffer CullGroups
+{
+	CullGroup groups[];
+};
+// The model matrices of all the instances.
+layout(std430, binding = 2) readonly buffer ModelMatrices
+{
+	mat4 modelMatrices[];
+};
+// The masks of the lights reaching each instance.
+layout(std430, binding = 3) readonly buffer LightMasks
+{
+	uint lightMasks[];
+};
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+// The layers of the texture arrays containing the diffuse textures of the instances.
+layout(std430, binding = 4) readonly buffer TextureLayers
+{
+	uint textureLayers[];
+};
+#endif
+// The draw commands of every level of detail of every model group, counting the
+//   visible instances of each.
+layout(std430, binding = 5) buffer DrawCommands
+{
+	DrawCommand commands[];
+};
+// The model matrices of the visible instances, compacted by level of detail.
+layout(std430, binding = 6) writeonly buffer CulledModelMatrices
+{
+	mat4 culledModelMatrices[];
+};
+// The light masks and texture layers of the visible instances, compacted by level of detail.
+layout(std430, binding = 7) writeonly buffer CulledAttributes
+{
+	uvec2 culledAttributes[];
+};
+
+// The planes of the view frustum of the camera (left, right, bottom, top, near, far).
+uniform vec4 frustumPlanes[6];
+// The position of the camera, followed by the scale of the projection along its height.
+uniform vec4 cameraDetails;
+// The projected sizes below which each of the simplified levels of detail is used.
+uniform vec4 lodScreenSizes;
+// The number of instances to cull.
+uniform int instancesCount;
+
+// Check if the given world AABB is at least partially inside the view frustum, the
+//   same way as the frustum of the camera does on the CPU.
+bool isBoxInside(vec3 minCorner, vec3 maxCorner)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		// Pick the corner of the box furthest along the normal of the plane.
+		vec3 furthestCorner = mix(minCorner, maxCorner, greaterThanEqual(frustumPlanes[i].xyz, vec3(0.0)));
+		// If even that corner is behind the plane, the whole box is outside the frustum.
+		if (dot(frustumPlanes[i].xyz, furthestCorner) + frustumPlanes[i].w < 0.0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Select the level of detail of the given world AABB, the same way as the render
+//   manager does on the CPU.
+uint selectLod(vec3 minCorner, vec3 maxCorner, uint lodsCount)
+{
+	float radius = 0.5 * distance(minCorner, maxCorner);
+	float cameraDistance = distance(0.5 * (minCorner + maxCorner), cameraDetails.xyz);
+	// The models around the camera fill the whole view.
+	if (cameraDistance <= radius)
+	{
+		return 0u;
+	}
+	float screenSize = radius * cameraDetails.w / cameraDistance;
+
+	uint lodIndex = 0u;
+	while (lodIndex + 1u < lodsCount && screenSize < lodScreenSizes[lodIndex])
+	{
+		lodIndex++;
+	}
+	return lodIndex;
+}
+
+void main()
+{
+	uint instanceIndex = gl_GlobalInvocationID.x;
+	if (instanceIndex >= uint(instancesCount))
+	{
+		return;
+	}
+
+	// Skip the instances outside the view frustum or hidden behind the depth of the last frames.
+	CullInstance instance = instances[instanceIndex];
+	if (instance.isOccluded != 0u || !isBoxInside(instance.minCorner, instance.maxCorner))
+	{
+		return;
+	}
+
+	// Append the instance to the region of its level of detail, counting it in the draw command of the level.
+	CullGroup group = groups[instance.groupIndex];
+	uint commandIndex = group.firstCommand + selectLod(instance.minCorner, instance.maxCorner, group.lodsCount);
+	uint culledIndex = commands[commandIndex].baseInstance + atomicAdd(commands[commandIndex].instanceCount, 1u);
+	culledModelMatrices[culledIndex] = modelMatrices[instanceIndex];
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+	culledAttributes[culledIndex] = uvec2(lightMasks[instanceIndex], textureLayers[instanceIndex]);
+#else
+	culledAttributes[culledIndex] = uvec2(lightMasks[instanceIndex], 0u);
+#endif
+}
@@ -0,0 +1,151 @@
+#version 430 core
+
+// Tests the shots against the bounding spheres of the enemies on the GPU, recording a
+//   hit for every enemy a shot touched while it moved since the last dispatch.
+// The shots move in a straight line at a constant velocity from where they were
+//   spawned, so their positions are integrated from their spawn details instead of
+//   being uploaded every frame, and each shot is swept as a sphere over the interval
+//   the dispatch covers so that it cannot pass through the enemies at any speed.
+// The hits are appended through an atomic counter, to be read back by the CPU.
+
+// The number of shots tested by each work group (matches GPU_SHOT_COLLISION_WORK_GROUP_SIZE).
+layout(local_size_x = 64) in;
+
+// The structure defining the details of a shot.
+// The layout matches the GpuShotData structure in the GPU shot collision.
+struct Shot
+{
+	// The position the shot was spawned at.
+	vec3 spawnPosition;
+	// The simulation time the shot was spawned at.
+	float spawnTime;
+	// The velocity of the shot.
+	vec3 velocity;
+	// The radius of the bounding sphere of the shot.
+	float radius;
+	// The generation of the slot of the shot, which tells the spawns of the slot apart.
+	uint generation;
+	// Whether a shot is spawned in the slot.
+	uint isActive;
+	uint padding0;
+	uint padding1;
+};
+
+// The structure defining the bounding sphere of an enemy.
+// The layout matches the GpuShotEnemyData structure in the GPU shot collision.
+struct Enemy
+{
+	// The center of the bounding sphere.
+	vec3 center;
+	// The radius of the bounding sphere.
+	float radius;
+	// The handle of the enemy in the model manager (its slot index and generation).
+	uint slotIndex;
+	uint generation;
+	uint padding0;
+	uint padding1;
+};
+
+// The structure defining a hit of a shot on an enemy.
+// The layout matches the GpuShotHitData structure in the GPU shot collision.
+struct Hit
+{
+	// The slot of the shot, and its generation when it hit.
+	uint shotIndex;
+	uint shotGeneration;
+	// The handle of the enemy in the model manager.
+	uint enemySlotIndex;
+	uint enemyGeneration;
+	// The simulation time the shot first touched the enemy at.
+	float time;
+	uint padding0;
+	uint padding1;
+	uint padding2;
+};
+
+// The slots of the shots.
+layout(std430, binding = 0) readonly buffer Shots
+{
+	Shot shots[];
+};
+// The bounding spheres of the enemies.
+layout(std430, binding = 1) readonly buffer Enemies
+{
+	Enemy enemies[];
+};
+// The hits of the dispatch, counted by the hit counter.
+layout(std430, binding = 2) writeonly buffer Hits
+{
+	Hit hits[];
+};
+// The number of hits of the dispatch (may go past the hits recorded if there are too many).
+layout(binding = 0, offset = 0) uniform atomic_uint hitsCount;
+
+// The number of shot slots and enemies.
+uniform int shotsCount;
+uniform int enemiesCount;
+// The simulation times the dispatch covers, from the end of the last dispatch to the end of the frame.
+uniform vec2 sweepTimes;
+// The most hits recorded by the dispatch.
+uniform int maxHitsCount;
+
+// Get the fraction of the given movement of a sphere at which it first touches another
+//   sphere, the same way as the collision pass on the CPU (-1 if they never touch).
+float getTimeOfImpact(vec3 start, vec3 displacement, float radius, vec3 center)
+{
+	// Solve the distance between the moving center and the other one reaching the sum of the radii.
+	vec3 offset = start - center;
+	float c = dot(offset, offset) - (radius * radius);
+	// The spheres touch from the start.
+	if (c <= 0.0)
+	{
+		return 0.0;
+	}
+	float a = dot(displacement, displacement);
+	float b = dot(offset, displacement);
+	float discriminant = (b * b) - (a * c);
+	// The sphere does not move, moves away, or passes the other one by.
+	if (a <= 0.0 || b >= 0.0 || discriminant < 0.0)
+	{
+		return -1.0;
+	}
+	float timeOfImpact = (-b - sqrt(discriminant)) / a;
+	return timeOfImpact <= 1.0 ? timeOfImpact : -1.0;
+}
+
+void main()
+{
+	uint shotIndex = gl_GlobalInvocationID.x;
+	if (shotIndex >= uint(shotsCount))
+	{
+		return;
+	}
+
+	// Skip the free slots, and the shots spawned after the interval.
+	Shot shot = shots[shotIndex];
+	float startTime = max(sweepTimes.x, shot.spawnTime);
+	if (shot.isActive == 0u || startTime > sweepTimes.y)
+	{
+		return;
+	}
+
+	// Sweep the shot from where it was at the start of the interval (or when it was spawned) to where it is at its end.
+	vec3 start = shot.spawnPosition + (shot.velocity * (startTime - shot.spawnTime));
+	vec3 displacement = shot.velocity * (sweepTimes.y - startTime);
+	for (int i = 0; i < enemiesCount; i++)
+	{
+		Enemy enemy = enemies[i];
+		float timeOfImpact = getTimeOfImpact(start, displacement, shot.radius + enemy.radius, enemy.center);
+		if (timeOfImpact < 0.0)
+		{
+			continue;
+		}
+
+		// Append the hit, dropping the hits beyond the most the dispatch records.
+		uint hitIndex = atomicCounterIncrement(hitsCount);
+		if (hitIndex < uint(maxHitsCount))
+		{
+			hits[hitIndex] = Hit(shotIndex, shot.generation, enemy.slotIndex, enemy.generation, mix(startTime, sweepTimes.y, timeOfImpact), 0u, 0u, 0u);
+		}
+	}
+}
@@ -0,0 +1,13 @@
+#version 330 core
+
+// The color of the line, as added to the debug draw batch.
+in vec4 lineColor;
+
+// The final color of the fragment.
+out vec4 color;
+
+void main()
+{
+	// Each line carries its own color, so that the lines of the whole frame can be drawn together.
+	color = lineColor;
+}
@@ -16,87 +16,186 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_SIMPLE_LIGHTS 2
-#define MAX_CUBE_LIGHTS 5
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
+
+// The layers of the shadow mask, enough for a channel per light with a shadow map (four per layer), are defined by the shader
+//   manager as SHADOW_MASK_LAYERS_COUNT from the engine limits.
+
+// The same shader draws the models into the G-buffer of the deferred shading (with IS_GBUFFER_PASS defined), and lights the
+//   G-buffer with a fullscreen triangle (with IS_DEFERRED_LIGHTING_PASS defined). The lighting pass reads the inputs of the
+//   fragments from the G-buffer instead of the vertex shader, so they are declared as globals for it, and so does the pass
+//   writing the shadow visibility of the lights into the shadow mask from the depth of the depth pre-pass (with
+//   IS_SHADOW_MASK_PASS defined).
+#if defined(IS_DEFERRED_LIGHTING_PASS) || defined(IS_SHADOW_MASK_PASS)
+#define FRAGMENT_INPUT
+#define FLAT_FRAGMENT_INPUT
+#else
+#define FRAGMENT_INPUT in
+#define FLAT_FRAGMENT_INPUT flat in
+#endif
 
 // The UV coordinates of the diffuse color of the fragment in the standard object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
-in vec2 fragmentUv;
+FRAGMENT_INPUT vec2 fragmentUv;
 // The coordinates of the fragment in the standard object model in world-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
-in vec4 fragmentPosition_worldSpace;
+FRAGMENT_INPUT vec4 fragmentPosition_worldSpace;
 // The coordinates of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
-in vec4 fragmentPosition_viewSpace;
+FRAGMENT_INPUT vec4 fragmentPosition_viewSpace;
 // The normal vector of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
-in vec3 fragmentNormal_viewSpace;
+FRAGMENT_INPUT vec3 fragmentNormal_viewSpace;
+// The mask of the lights reaching the model, with a bit per cone light followed by a bit per point light from bit 8.
+FLAT_FRAGMENT_INPUT uint fragmentLightMask;
 
 // The shadow map coordinates of the current fragment w.r.t all the active cone lights.
-in vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
+FRAGMENT_INPUT vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
 
 // The coordinates of the positions of the cone light sources in view-space.
 // Since this value would be the same for all vertices, interpolation won't affect anything.
-in vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
+FRAGMENT_INPUT vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
 // The coordinates of the positions of the point light sources in view-space.
 // Since this value would be the same for all vertices, interpolation won't affect anything.
-in vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
+FRAGMENT_INPUT vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
 
 
+#ifdef IS_SHADOW_MASK_PASS
+// The visibility of the fragment to each light with a shadow map, written to the layers of the shadow mask: the cone lights
+//   followed by the point lights by the cube map of their shadow map, four lights per layer.
+layout(location = 0) out vec4 shadowMaskLayer0;
+layout(location = 1) out vec4 shadowMaskLayer1;
+#elif defined(IS_GBUFFER_PASS)
+// The diffuse color of the fragment, written to the albedo of the G-buffer.
+layout(location = 0) out vec3 color;
+// The normal vector of the fragment in view-space, with the packed mask of the lights reaching the model in W.
+layout(location = 1) out vec4 gBufferNormal;
+#else
 // The final color of the fragment.
 out vec3 color;
+#endif
 
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Fragment
-{
-	// mat4 modelMatrix;
-	mat4 viewMatrix;
-	// mat4 projectionMatrix;
-};
 // The structure defining the details regarding the active lights.
-struct LightDetails_Fragment
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-	vec3 lightPosition;
-	// mat4 lightVpMatrix;
-	vec3 lightColorIntensity;
-	// float nearPlane;
+	mat4 lightVpMatrix;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
 	float farPlane;
 	int layerId;
+	vec4 shadowMapRect;
 };
 
-
-// The details of the model.
-uniform ModelDetails_Fragment modelDetails_fragment;
+// The frame-constant details shared by all the models, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
 
 // The standard object texture sampler.
+// The texture is a layer of a texture array shared with the textures of the same format and size when they are batched.
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+uniform sampler2DArray diffuseTexture;
+// The layer of the texture array containing the texture of the model, passed on from the vertex shader as is.
+FLAT_FRAGMENT_INPUT float fragmentTextureLayer;
+#define DIFFUSE_TEXTURE_COORD(uv) vec3(uv, fragmentTextureLayer)
+#else
 uniform sampler2D diffuseTexture;
+#define DIFFUSE_TEXTURE_COORD(uv) (uv)
+#endif
 
-// The texture sampler of the array of shadow maps of cone lights (2D texture lights).
-uniform sampler2DArray coneLightTextures;
+// The texture sampler of the atlas of shadow maps of cone lights (2D texture lights).
+uniform sampler2DShadow coneLightShadowAtlas;
 // The texture samplers of the array of shadow maps of point lights (cubemap texture lights).
-uniform samplerCubeArray pointLightTextures;
+uniform samplerCubeArrayShadow pointLightTextures;
+// The texture samplers of the moments of the shadow maps of cone lights and point lights, laid out the same
+//   way as the shadow maps, for the light types shadowed with variance shadow maps.
+uniform sampler2D coneLightMomentAtlas;
+uniform samplerCubeArray pointLightMomentTextures;
 
-// The number of active cone lights (2D texture lights).
-uniform int coneLightsCount;
-// The number of active point lights (cubemap texture lights).
-uniform int pointLightsCount;
+// The buffer texture sampler of the details of the point lights binned into the light clusters.
+// Each light takes up three texels: view-space position and radius, color-intensity and far plane,
+//   then world-space position and the layer ID of its shadow map (-1 for lights without one).
+uniform samplerBuffer clusterLightsTexture;
+// The buffer texture sampler of the offset and count of the light indices of each light cluster.
+uniform usamplerBuffer clusterGridTexture;
+// The buffer texture sampler of the light indices of all the light clusters.
+uniform usamplerBuffer clusterLightIndicesTexture;
 
-// The details of the active cone lights (2D texture lights).
-uniform LightDetails_Fragment coneLightDetails_fragment[MAX_SIMPLE_LIGHTS];
-// The details of the active point lights (cubemap texture lights).
-uniform LightDetails_Fragment pointLightDetails_fragment[MAX_CUBE_LIGHTS];
+#ifdef IS_DEFERRED_LIGHTING_PASS
+// The texture samplers of the albedo, the normals (with the packed light masks) and the depth of the G-buffer.
+uniform sampler2D gBufferAlbedoTexture;
+uniform sampler2D gBufferNormalTexture;
+uniform sampler2D gBufferDepthTexture;
+// The inverse of the projection and view matrices of the camera, to find the positions of the fragments from their depths.
+uniform mat4 inverseProjectionMatrix;
+uniform mat4 inverseViewMatrix;
+// The size of the viewport the G-buffer was drawn with.
+uniform vec2 gBufferViewportSize;
+#endif
 
-// The ambient light factor to use.
-// This defines how much of the surface color is visible from ambient lighting.
-uniform float ambientFactor;
-
-// An integer mask defining what features should be disabled (lighting, shadows, etc.)
-uniform int disableFeatureMask;
+#if defined(IS_SHADOW_MASK_PASS) || defined(IS_SHADOW_MASK_ENABLED)
+// The texture sampler of the single-sampled copy of the depth of the depth pre-pass, that the shadow mask is written from.
+uniform sampler2D shadowMaskDepthTexture;
+// The size of the viewport of the scene, the shadow mask covering it at half of it.
+uniform vec2 shadowMaskSceneSize;
+#endif
+#ifdef IS_SHADOW_MASK_PASS
+// The inverse of the projection and view matrices of the camera, to find the positions of the pixels from their depths.
+uniform mat4 inverseProjectionMatrix;
+uniform mat4 inverseViewMatrix;
+#endif
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+// The texture samplers of the shadow mask written by the last frame, and of the depth it was written from.
+uniform sampler2DArray shadowMaskHistoryTexture;
+uniform sampler2D shadowMaskHistoryDepthTexture;
+// The view-projection matrix of the camera of the last frame, to find where the pixels were in the last shadow mask.
+uniform mat4 previousViewProjectionMatrix;
+// The index of the frame among the frames taking the different taps of the kernel, and the weight of the last shadow mask
+//   (0 if it cannot be reprojected, e.g. after a resize).
+uniform vec2 temporalShadowFilterDetails;
+// The rotation of the taps of the kernel of the current pixel, changing every frame.
+mat2 temporalShadowFilterRotation = mat2(1.0);
+#endif
+#ifdef IS_SHADOW_MASK_ENABLED
+// The texture sampler of the layers of the shadow mask.
+uniform sampler2DArray shadowMaskTexture;
+// The visibility of the fragment to each light with a shadow map, upsampled from the shadow mask once for all of them.
+vec4 maskedShadowVisibilities[SHADOW_MASK_LAYERS_COUNT];
+#endif
 
 // The bias values to use to combat acne bias with the various light source types.
 float coneLightAcneBias = 0.0001;
 float pointLightAcneBias = 0.05;
+// The variance the moments are never taken below (instead of a bias) with variance shadow maps, and the
+//   share of the visibility cut off to reduce the light bleeding between overlapping casters.
+float shadowMomentMinVariance = 0.00002;
+float shadowMomentBleedReduction = 0.2;
+
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+// The share of the difference between the depths the last shadow mask is rejected past (a disocclusion), the motion of the pixels
+//   (in texels of the shadow mask) past which the last shadow mask is fully rejected, and how far the visibility taken from the
+//   last shadow mask can be from the one of the current frame (so that the moving shadows do not leave trails behind).
+float temporalShadowDepthTolerance = 0.05;
+float temporalShadowMaxMotion = 16.0;
+float temporalShadowClampRange = 0.25;
+#endif
 
 // The specular values to use that define specular reflectivity and the lobe size.
 // This could also be passed using a specular map, which would also allow to define
@@ -108,18 +207,104 @@ float specularLobeFactor = 3.5;
 int DISABLE_SHADOW = 1;
 int DISABLE_LIGHT = 2;
 
+// The features and light counts are read from the frame details, unless the shader is compiled as a
+//   variant, in which case they are defined as constants so that the compiler can remove the unused
+//   branches and unroll the light loops.
+#ifndef SHADER_VARIANT
+#define IS_SHADOW_ENABLED (frameDetails.disableFeatureMask < DISABLE_SHADOW)
+#define IS_LIGHTING_ENABLED (frameDetails.disableFeatureMask < DISABLE_LIGHT)
+#define IS_CLUSTERED_LIGHTING_ENABLED (frameDetails.clusterDetails.w != 0)
+#define CONE_LIGHTS_COUNT frameDetails.coneLightsCount
+#define POINT_LIGHTS_COUNT frameDetails.pointLightsCount
+#endif
+
+// The kernels of shadow map taps that can be averaged for the visibility of a fragment. Every tap
+//   is a depth comparison filtered by the hardware, which already averages the 4 closest texels.
+#define SHADOW_FILTER_1X1 0
+#define SHADOW_FILTER_3X3 1
+#define SHADOW_FILTER_POISSON_8 2
+#define SHADOW_FILTER_POISSON_16 3
+// The kernel of shadow map taps to use, unless the shader is compiled as a variant using another.
+#ifndef SHADOW_FILTER_KERNEL
+#define SHADOW_FILTER_KERNEL SHADOW_FILTER_3X3
+#endif
+
+// The number of shadow map taps of the kernel.
+#if SHADOW_FILTER_KERNEL == SHADOW_FILTER_1X1
+#define SHADOW_FILTER_TAPS_COUNT 1
+#elif SHADOW_FILTER_KERNEL == SHADOW_FILTER_3X3
+#define SHADOW_FILTER_TAPS_COUNT 9
+#elif SHADOW_FILTER_KERNEL == SHADOW_FILTER_POISSON_8
+#define SHADOW_FILTER_TAPS_COUNT 8
+#else
+#define SHADOW_FILTER_TAPS_COUNT 16
+#endif
+
+// The shadow mask filtered over time takes a few rotated taps of the 16-tap Poisson disk every frame instead, the frames taking
+//   different quarters of the disk, which the accumulated shadow mask averages.
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+#undef SHADOW_FILTER_TAPS_COUNT
+#define SHADOW_FILTER_TAPS_COUNT 4
+#endif
+
+// The techniques the lights of each type are shadowed with (matches the ShadowTechnique values in the shadow
+//   buffer manager): percentage-closer filtering of the shadow maps with the taps of the shadow filter kernel,
+//   or variance shadow maps filtering the moments of the shadow maps with a single fetch.
+#define SHADOW_TECHNIQUE_PCF 0
+#define SHADOW_TECHNIQUE_VSM 1
+
+#ifndef CONE_LIGHT_SHADOW_TECHNIQUE
+#define CONE_LIGHT_SHADOW_TECHNIQUE SHADOW_TECHNIQUE_PCF
+#endif
+#ifndef POINT_LIGHT_SHADOW_TECHNIQUE
+#define POINT_LIGHT_SHADOW_TECHNIQUE SHADOW_TECHNIQUE_PCF
+#endif
+
+// The radius (in texels) the Poisson disk kernels are scaled to.
+float shadowFilterPoissonRadius = 2.0;
+
+// The Poisson disk kernels, spread within the unit circle.
+const vec2 poissonDisk8[8] = vec2[](
+	vec2(-0.7071, 0.7071), vec2(-0.0000, -0.8750), vec2(0.5303, 0.5303), vec2(-0.6250, -0.0000),
+	vec2(0.3536, -0.3536), vec2(-0.0000, 0.3750), vec2(-0.1768, -0.1768), vec2(0.1250, 0.0000));
+const vec2 poissonDisk16[16] = vec2[](
+	vec2(-0.9420, -0.3991), vec2(0.9456, -0.7689), vec2(-0.0942, -0.9294), vec2(0.3450, 0.2939),
+	vec2(-0.9159, 0.4577), vec2(-0.8154, -0.8791), vec2(-0.3828, 0.2768), vec2(0.9748, 0.7565),
+	vec2(0.4432, -0.9751), vec2(0.5374, -0.4737), vec2(-0.2650, -0.4189), vec2(0.7920, 0.1909),
+	vec2(-0.2419, 0.9971), vec2(-0.8141, 0.9144), vec2(0.1998, 0.7864), vec2(0.1438, -0.1410));
+
 /**
- * Function that returns the size of a single texel (texture-pixel) of the given
- *   cone light shadow map texture.
+ * Function that returns the offset of the given tap of the shadow filter kernel.
+ *
+ * @param tapIndex  The index of the tap in the kernel.
+ *
+ * @return The offset of the tap from the center of the kernel, in texels.
+ */
+vec2 getShadowFilterTapOffset(int tapIndex)
+{
+#if defined(IS_TEMPORAL_SHADOW_FILTER)
+	return temporalShadowFilterRotation * poissonDisk16[(int(temporalShadowFilterDetails.x) * SHADOW_FILTER_TAPS_COUNT) + tapIndex] * shadowFilterPoissonRadius;
+#elif SHADOW_FILTER_KERNEL == SHADOW_FILTER_1X1
+	return vec2(0.0);
+#elif SHADOW_FILTER_KERNEL == SHADOW_FILTER_3X3
+	return vec2((tapIndex % 3) - 1, (tapIndex / 3) - 1);
+#elif SHADOW_FILTER_KERNEL == SHADOW_FILTER_POISSON_8
+	return poissonDisk8[tapIndex] * shadowFilterPoissonRadius;
+#else
+	return poissonDisk16[tapIndex] * shadowFilterPoissonRadius;
+#endif
+}
+
+/**
+ * Function that returns the size of a single texel (texture-pixel) of the
+ *   cone light shadow atlas texture.
  *
  * @return The texel size of the texture.
  */
 vec2 getConeLightShadowMapTexelValue()
 {
-	// Grab the shadow map texture size from the sampler array
-	//   (just the first two coordinates, the third indicates number of layers in the
-	//   sampler array).
-	vec2 shadowMapSize = textureSize(coneLightTextures, 0).xy;
+	// Grab the shadow atlas texture size.
+	vec2 shadowMapSize = textureSize(coneLightShadowAtlas, 0);
 	// Calculate the size of a single texel by taking the inverse of the texture size,
 	//   and return it.
 	return 1.0 / shadowMapSize;
@@ -127,169 +312,316 @@ vec2 getConeLightShadowMapTexelValue()
 
 /**
  * Function that returns the size of a single texel (texture-pixel) of the given
- *   point light shadow map texture.
+ *   point light shadow map texture, at a unit distance from the center of the cube map.
  *
  * @return The texel size of the texture.
  */
-vec3 getPointLightShadowMapTexelValue()
+float getPointLightShadowMapTexelValue()
 {
-	// Grab the shadow map texture size value depending on which index is provided
-	//   (just the first two coordinates, the third indicates number of layers in the
-	//   sampler array).
+	// Grab the shadow map texture size (just the first two coordinates, the third
+	//   indicates number of layers in the sampler array).
 	vec2 shadowMapSize = textureSize(pointLightTextures, 0).xy;
-	// Calculate the size of a single texel by taking the inverse of the texture size,
-	//   and return it. The third coordinate is calculated by taking the average of the
-	//   size of the texture on the x-axis and y-axis.
-	return 1.0 / vec3(shadowMapSize, (shadowMapSize.x + shadowMapSize.y) / 2);
+	// A cube map face spans 2 units at a unit distance from the center, so calculate
+	//   the size of a single texel by dividing that by the average face size.
+	return 2.0 / ((shadowMapSize.x + shadowMapSize.y) / 2.0);
 }
 
 /**
- * Function that returns the closest depth value recorded in the given cone
- *   light shadow map texture at the given UV coordinates.
+ * Function that returns the visibility of the fragment from the given
+ *   cone light source, by comparing its depth against the shadow map.
  *
- * @param coords   The UV coordinates from where to get the closest depth value.
- * @param layerId  The index of the cone light shadow map texture to use.
+ * @param shadowMapCoords  The shadow atlas coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
  *
- * @return The closest depth value at the given UV coordinates.
+ * @return The visibility of the fragment, filtered across the closest 4 texels.
  */
-float getConeLightShadowMapCoordValue(vec2 coords, int layerId)
+float getConeLightVisibility(vec2 shadowMapCoords, float currentDepth)
 {
-	// Grab the closest depth value from the shadow map indexed at the given layer.
-	// We grab the value from the red channel because that is where the depth value
-	//   is recorded.
-	return texture(coneLightTextures, vec3(coords, layerId)).r;
+	// Compare the depth of the current fragment w.r.t. the light source (accounting for some bias) against the
+	//   depths of the fragments that were closest to the light source at the given coordinates. The sampler
+	//   returns the fraction of the compared texels that the fragment is not behind.
+	return texture(coneLightShadowAtlas, vec3(shadowMapCoords, currentDepth - coneLightAcneBias));
 }
 
 /**
- * Function that returns the closest depth value recorded in the given point
- *   light shadow map at the given UV coordinates.
+ * Function that returns the average visibility of the fragment from the given
+ *   cone light source by taking multiple samples at and around the given shadow
+ *   map coordinates.
  *
- * @param coords    The UV coordinates from where to get the closest depth value.
- * @param layerId   The index of the point light shadow map texture to use.
- * @param farPlane  The maximum distance the light source can travel till.
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param shadowMapRect    The tile of the shadow atlas of the light (offset, then size).
  *
- * @return The closest depth value at the given UV coordinates.
+ * @return The average visibility of the fragment.
  */
-float getPointLightShadowMapCoordValue(vec3 coords, int layerId, float farPlane)
+float getConeLightAverageVisibility(vec2 shadowMapCoords, float currentDepth, vec4 shadowMapRect)
 {
-	// Grab the closest depth value from the shadow map indexed at the given layer.
-	// We grab the value from the red channel because that is where the depth value
-	//   is recorded.
-	float closestDepth = texture(pointLightTextures, vec4(coords, layerId)).r;
-	// Since for point lights, we divided the actual depth against the max distance
-	//   the light could reach till (the far plane), multiply by the same value again
-	//   to the actual value back and return it.
-	return closestDepth * farPlane;
+	// If the light was evicted from the shadow atlas, the fragment will be fully visible to the light source.
+	if (shadowMapRect.z <= 0.0)
+	{
+		return 1.0;
+	}
+	// If the fragment is outside the view of the light source, it will always be in shadow.
+	if (any(lessThan(shadowMapCoords, vec2(0.0))) || any(greaterThan(shadowMapCoords, vec2(1.0))))
+	{
+		return 0.0;
+	}
+
+	// Define the variable where we'll store the average visibility.
+  float visibility = 0.0;
+	// Get the texel size of the shadow map texture.
+	vec2 texelSize = getConeLightShadowMapTexelValue();
+	// Move the coordinates into the tile of the light, and find the texel centers at its edges that the taps
+	//   are kept within, so that they never read the tiles of other lights.
+	vec2 atlasCoords = shadowMapRect.xy + (shadowMapCoords * shadowMapRect.zw);
+	vec2 minAtlasCoords = shadowMapRect.xy + (texelSize * 0.5);
+	vec2 maxAtlasCoords = shadowMapRect.xy + shadowMapRect.zw - (texelSize * 0.5);
+	// We'll sample the visibility at the taps of the shadow filter kernel around the
+	//   given coordinate to get a better average visibility value.
+	for (int tapIndex = 0; tapIndex < SHADOW_FILTER_TAPS_COUNT; tapIndex++)
+	{
+		// Get the visibility of the fragment at the given shadow map coordinates (with variance).
+		visibility += getConeLightVisibility(clamp(atlasCoords + (getShadowFilterTapOffset(tapIndex) * texelSize), minAtlasCoords, maxAtlasCoords), currentDepth);
+	}
+	// Return the average visibility across the number of shadow map taps taken.
+  return visibility / float(SHADOW_FILTER_TAPS_COUNT);
 }
 
 /**
  * Function that returns the visibility of the fragment from the given
- *   cone light source.
+ *   point light source, by comparing its depth against the shadow map.
  *
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
- * @param layerId          The index of the cone light shadow map texture to use.
+ * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
  *
- * @return The visibility of the fragment.
+ * @return The visibility of the fragment, filtered across the closest 4 texels.
  */
-float getConeLightVisibility(vec2 shadowMapCoords, float currentDepth, int layerId)
+float getPointLightVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
 {
-	// Grab the depth of the fragment that was closest to the light source at the given coordinates from the
-	//   shadow map at the given layer.
-	float closestDepth = getConeLightShadowMapCoordValue(shadowMapCoords, layerId);
-	// If the depth of the current fragment w.r.t. the light source is larger than the depth of the closest
-	//   recorded fragment (accounting for some bias), that means the current fragment is not visible to the
-	//   light source, so the fragment should not be visible. If this is the case, return 0, otherwise return 1.
-	return currentDepth - coneLightAcneBias > closestDepth ? 0.0 : 1.0;
+	// Since for point lights, the depths were divided against the max distance the light could reach
+	//   till (the far plane), divide the depth of the current fragment (accounting for some bias) by
+	//   the same value, and compare it against the depths of the closest fragments at the given coordinates.
+	return texture(pointLightTextures, vec4(shadowMapCoords, layerId), (currentDepth - pointLightAcneBias) / farPlane);
 }
 
 /**
  * Function that returns the average visibility of the fragment from the given
- *   cone light source by taking multiple samples at and around the given shadow
- *   map coordinates.
+ *   point light source.
  *
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
- * @param layerId          The index of the cone light shadow map texture to use.
+ * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
  *
  * @return The average visibility of the fragment.
  */
-float getConeLightAverageVisibility(vec2 shadowMapCoords, float currentDepth, int layerId)
+float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
 {
 	// Define the variable where we'll store the average visibility.
   float visibility = 0.0;
-	// Get the texel size of the shadow map texture.
-	vec2 texelSize = getConeLightShadowMapTexelValue();
-	// We'll sample the closest depth values from the given coordinate and the
-	//   immediately surrounding coordinates as well to get a better average
-	//   visibility value.
-	for (int x = -2; x <= 2; x++)
+	// Get the texel size of the shadow map texture at the distance of the fragment.
+	float texelSize = getPointLightShadowMapTexelValue() * currentDepth;
+	// Find two directions perpendicular to the direction of the fragment from the light source,
+	//   along which the taps of the shadow filter kernel are spread across the cube map.
+	vec3 direction = shadowMapCoords / currentDepth;
+	vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+	vec3 bitangent = cross(direction, tangent);
+	// We'll sample the visibility at the taps of the shadow filter kernel around the
+	//   given coordinate to get a better average visibility value.
+	for (int tapIndex = 0; tapIndex < SHADOW_FILTER_TAPS_COUNT; tapIndex++)
 	{
-		for (int y = -2; y <= 2; y++)
-		{
-			// Get the visibility of the fragment at the given shadow map coordinates (with variance).
-			visibility += getConeLightVisibility(shadowMapCoords + (vec2(x, y) * texelSize), currentDepth, layerId);
-		}
+		// Get the visibility of the fragment at the given shadow map coordinates (with variance).
+		vec2 tapOffset = getShadowFilterTapOffset(tapIndex) * texelSize;
+		visibility += getPointLightVisibility(shadowMapCoords + (tangent * tapOffset.x) + (bitangent * tapOffset.y), currentDepth, layerId, farPlane);
 	}
-	// Return the average visibility across the number of shadow map samples taken (5 * 5 = 25).
-  return visibility / 25.0;
+	// Return the average visibility across the number of shadow map taps taken.
+  return visibility / float(SHADOW_FILTER_TAPS_COUNT);
 }
 
 /**
- * Function that returns the average visibility of the fragment from the given
- *   point light source.
+ * Function that returns the visibility of the fragment from the filtered moments of
+ *   a variance shadow map, by the upper bound of the share of the occluders it is
+ *   not behind (Chebyshev's inequality).
+ *
+ * @param moments       The mean depth and mean squared depth around the fragment.
+ * @param currentDepth  The depth of the current fragment w.r.t. the light source, divided by its far plane.
+ *
+ * @return The visibility of the fragment.
+ */
+float getMomentVisibility(vec2 moments, float currentDepth)
+{
+	// The fragments in front of the mean depth are fully visible.
+	if (currentDepth <= moments.x)
+	{
+		return 1.0;
+	}
+	float variance = max(moments.y - (moments.x * moments.x), shadowMomentMinVariance);
+	float depthDifference = currentDepth - moments.x;
+	float maxVisibility = variance / (variance + (depthDifference * depthDifference));
+	// Cut off the lowest visibilities, which are the ones lit through the casters in front of other casters.
+	return clamp((maxVisibility - shadowMomentBleedReduction) / (1.0 - shadowMomentBleedReduction), 0.0, 1.0);
+}
+
+/**
+ * Function that returns the visibility of the fragment from the given cone light
+ *   source with a variance shadow map.
  *
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
- * @param currentDepth     The depth of the current fragment w.r.t. the light source.
- * @param layerId          The index of the point light shadow map texture to use.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source, divided by its far plane.
+ * @param shadowMapRect    The tile of the shadow atlas of the light (offset, then size).
  *
  * @return The visibility of the fragment.
  */
-float getPointLightVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
+float getConeLightMomentVisibility(vec2 shadowMapCoords, float currentDepth, vec4 shadowMapRect)
 {
-	// Grab the depth of the fragment that was closest to the light source at the given coordinates from the
-	//   shadow map at the given layer.
-	float closestDepth = getPointLightShadowMapCoordValue(shadowMapCoords, layerId, farPlane);
-	// If the depth of the current fragment w.r.t. the light source is larger than the depth of the closest
-	//   recorded fragment (accounting for some bias), that means the current fragment is not visible to the
-	//   light source, so the fragment should not be visible. If this is the case, return 0, otherwise return 1.
-	return currentDepth - pointLightAcneBias > closestDepth ? 0.0 : 1.0;
+	// If the light was evicted from the shadow atlas, the fragment will be fully visible to the light source.
+	if (shadowMapRect.z <= 0.0)
+	{
+		return 1.0;
+	}
+	// Fetch the moments within the tile of the light (before leaving the fragments outside of it, so that the
+	//   mip level is picked the same way for all of them).
+	vec2 texelSize = 1.0 / vec2(textureSize(coneLightMomentAtlas, 0));
+	vec2 atlasCoords = clamp(shadowMapRect.xy + (shadowMapCoords * shadowMapRect.zw), shadowMapRect.xy + (texelSize * 0.5), shadowMapRect.xy + shadowMapRect.zw - (texelSize * 0.5));
+	vec2 moments = texture(coneLightMomentAtlas, atlasCoords).rg;
+	// If the fragment is outside the view of the light source, it will always be in shadow.
+	if (any(lessThan(shadowMapCoords, vec2(0.0))) || any(greaterThan(shadowMapCoords, vec2(1.0))))
+	{
+		return 0.0;
+	}
+	return getMomentVisibility(moments, currentDepth);
 }
 
 /**
- * Function that returns the average visibility of the fragment from the given
- *   point light source.
+ * Function that returns the visibility of the fragment from the given point light
+ *   source with a variance shadow map.
  *
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
  * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
  *
- * @return The average visibility of the fragment.
+ * @return The visibility of the fragment.
  */
-float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
+float getPointLightMomentVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
 {
-	// Define the variable where we'll store the average visibility.
-  float visibility = 0.0;
-	// Get the texel size of the shadow map texture.
-	vec3 texelSize = getPointLightShadowMapTexelValue();
-	// We'll sample the closest depth values from the given coordinate and the
-	//   immediately surrounding coordinates as well to get a better average
-	//   visibility value.
-	for (int x = -1; x <= 1; x++)
+	// The moments are of the depths divided by the far plane, like the shadow maps.
+	return getMomentVisibility(texture(pointLightMomentTextures, vec4(shadowMapCoords, layerId)).rg, currentDepth / farPlane);
+}
+
+/**
+ * Function that calculates the visibility of the current fragment to the given cone light source from its shadow map.
+ *
+ * @param lightIndex  The index of the cone light.
+ *
+ * @return The visibility of the fragment.
+ */
+float getConeLightShadowVisibility(int lightIndex)
+{
+	// Calculate the shadow map coordinates of the fragment w.r.t. the current light source (while applying perspective-division).
+	vec3 shadowMapCoords = (((coneLightShadowMapCoord[lightIndex].xyz) / coneLightShadowMapCoord[lightIndex].w) * 0.5) + 0.5;
+	// Calculate the visibilty of the fragment to the current light source (the moments are of the linear depth, which is
+	//   the W coordinate of the projection of the light).
+#if CONE_LIGHT_SHADOW_TECHNIQUE == SHADOW_TECHNIQUE_VSM
+	return getConeLightMomentVisibility(shadowMapCoords.xy, coneLightShadowMapCoord[lightIndex].w / frameDetails.coneLightDetails[lightIndex].farPlane,
+	                                    frameDetails.coneLightDetails[lightIndex].shadowMapRect);
+#else
+	return getConeLightAverageVisibility(shadowMapCoords.xy, shadowMapCoords.z, frameDetails.coneLightDetails[lightIndex].shadowMapRect);
+#endif
+}
+
+/**
+ * Function that calculates the visibility of the current fragment to the given point light source from its shadow map.
+ *
+ * @param lightPosition_worldSpace  The position of the light source in world-space.
+ * @param farPlane                  The maximum distance the light source can travel till.
+ * @param layerId                   The index of the point light shadow map texture to use.
+ *
+ * @return The visibility of the fragment.
+ */
+float getPointLightShadowVisibility(vec3 lightPosition_worldSpace, float farPlane, int layerId)
+{
+	// Calculate the shadow map coordinates of the fragment w.r.t. the current light source.
+	vec3 shadowMapCoords = fragmentPosition_worldSpace.xyz - lightPosition_worldSpace;
+	// Calculate the visibilty of the fragment to the current light source.
+#if POINT_LIGHT_SHADOW_TECHNIQUE == SHADOW_TECHNIQUE_VSM
+	return getPointLightMomentVisibility(shadowMapCoords.xyz, length(shadowMapCoords), layerId, farPlane);
+#else
+	return getPointLightAverageVisibility(shadowMapCoords.xyz, length(shadowMapCoords), layerId, farPlane);
+#endif
+}
+
+#if defined(IS_SHADOW_MASK_ENABLED) || defined(IS_TEMPORAL_SHADOW_FILTER)
+/**
+ * Function that returns the distance of the given depth of the camera from the camera, along its view direction.
+ *
+ * @param depth  The depth, as written into the depth buffer.
+ *
+ * @return The linear depth.
+ */
+float getLinearDepth(float depth)
+{
+	return frameDetails.projectionMatrix[3][2] / (((depth * 2.0) - 1.0) + frameDetails.projectionMatrix[2][2]);
+}
+#endif
+
+#ifdef IS_SHADOW_MASK_ENABLED
+/**
+ * Function that upsamples the visibility of the current fragment to the lights with a shadow map from the four texels of the
+ *   shadow mask around it, weighing each texel by how close the depth it was written from is to the depth of the fragment, so
+ *   that the shadows do not bleed across the edges of the models.
+ */
+void upsampleShadowMask()
+{
+	// Find the texels of the shadow mask around the fragment, and the bilinear weights of the fragment between them.
+	vec2 maskCoords = (gl_FragCoord.xy * 0.5) - 0.5;
+	ivec2 firstTexel = ivec2(floor(maskCoords));
+	vec2 texelFraction = maskCoords - vec2(firstTexel);
+	ivec2 lastTexel = ivec2(ceil(shadowMaskSceneSize * 0.5)) - 1;
+	float fragmentDepth = -fragmentPosition_viewSpace.z;
+
+	for (int layer = 0; layer < SHADOW_MASK_LAYERS_COUNT; layer++)
+	{
+		maskedShadowVisibilities[layer] = vec4(0.0);
+	}
+	float totalWeight = 0.0;
+	for (int i = 0; i < 4; i++)
 	{
-		for (int y = -1; y <= 1; y++)
+		ivec2 texelOffset = ivec2(i & 1, i >> 1);
+		ivec2 texel = clamp(firstTexel + texelOffset, ivec2(0), lastTexel);
+		// The texels of the mask are written from the first pixel of the pixels they cover.
+		float texelDepth = getLinearDepth(texelFetch(shadowMaskDepthTexture, texel * 2, 0).r);
+		vec2 bilinearWeights = mix(1.0 - texelFraction, texelFraction, vec2(texelOffset));
+		float weight = (bilinearWeights.x * bilinearWeights.y) / (0.001 + (abs(texelDepth - fragmentDepth) / fragmentDepth));
+		for (int layer = 0; layer < SHADOW_MASK_LAYERS_COUNT; layer++)
 		{
-			for (int z = -1; z <= 1; z++)
-			{
-				// Get the visibility of the fragment at the given shadow map coordinates (with variance).
-				visibility += getPointLightVisibility(shadowMapCoords + (vec3(x, y, z) * texelSize), currentDepth, layerId, farPlane);
-			}
+			maskedShadowVisibilities[layer] += weight * texelFetch(shadowMaskTexture, ivec3(texel, layer), 0);
 		}
+		totalWeight += weight;
+	}
+	for (int layer = 0; layer < SHADOW_MASK_LAYERS_COUNT; layer++)
+	{
+		maskedShadowVisibilities[layer] /= totalWeight;
 	}
-	// Return the average visibility across the number of shadow map samples taken (3 * 3 * 3 = 27).
-  return visibility / 27.0;
 }
 
+/**
+ * Function that returns the visibility of the current fragment to the given light with a shadow map, as upsampled from the
+ *   shadow mask.
+ *
+ * @param maskChannel  The channel of the light in the shadow mask (the index of a cone light, or the number of cone lights
+ *                       plus the layer ID of the shadow map of a point light).
+ *
+ * @return The visibility of the fragment.
+ */
+float getMaskedShadowVisibility(int maskChannel)
+{
+	return maskedShadowVisibilities[maskChannel / 4][maskChannel % 4];
+}
+#endif
+
 /**
  * Function that calculates the diffuse lighting value from the given light source.
  *
@@ -338,32 +670,321 @@ vec3 getLightSpecularLighting(vec4 fragmentPosition_viewSpace, vec3 lightColorIn
 	return specularReflectivity * specularLight;
 }
 
+/**
+ * Function that returns the factor smoothly fading out a light as it reaches the end of its range (the distance past which its
+ *   intensity falls under the influence cutoff), so that lights are not cut off at the edges of their range, or of the light
+ *   clusters they were binned into.
+ *
+ * @param distanceFromLight  The distance from the light source to the current fragment.
+ * @param lightRadius        The distance past which the light is considered to not reach the fragment.
+ *
+ * @return The range factor of the light.
+ */
+float getLightRangeFactor(float distanceFromLight, float lightRadius)
+{
+	float distanceRatio = distanceFromLight / lightRadius;
+	float rangeFactor = clamp(1.0 - (distanceRatio * distanceRatio * distanceRatio * distanceRatio), 0.0, 1.0);
+	return rangeFactor * rangeFactor;
+}
+
+/**
+ * Function that calculates the lighting value of the current fragment from the given point light source.
+ *
+ * @param surfaceColor                The diffuse color of the surface of the fragment.
+ * @param lightPosition_viewSpace     The position of the light source in view-space.
+ * @param lightPosition_worldSpace    The position of the light source in world-space.
+ * @param lightColorIntensity         The product of the color and intensity value of the light source.
+ * @param farPlane                    The maximum distance the light source can travel till (its range).
+ * @param layerId                     The index of the point light shadow map texture to use (-1 if the light has none).
+ *
+ * @return The lighting value from the given light source.
+ */
+vec3 getPointLightLighting(vec3 surfaceColor, vec3 lightPosition_viewSpace, vec3 lightPosition_worldSpace, vec3 lightColorIntensity, float farPlane, int layerId)
+{
+	// Calculate the distance of the fragment from the light source, and skip the fragments out of the range of the light before
+	//   sampling its shadow map.
+	float distanceFromLight = distance(fragmentPosition_viewSpace.xyz, lightPosition_viewSpace);
+	if (distanceFromLight >= farPlane)
+	{
+		return vec3(0.0);
+	}
+
+	// Calculate the direction of the light from the source to the fragment in view-space.
+	vec3 pointLightDirection_viewSpace = normalize(lightPosition_viewSpace - fragmentPosition_viewSpace.xyz);
+
+	// Define variable for storing the visibility of the fragment to the current light source.
+	float visibility;
+	// Perform shadow visibility calculations as long as shadows have not been disabled and the light has a shadow map.
+	if (IS_SHADOW_ENABLED && layerId >= 0)
+	{
+		// Calculate the visibilty of the fragment to the current light source (or read it from the shadow mask).
+#ifdef IS_SHADOW_MASK_ENABLED
+		visibility = getMaskedShadowVisibility(MAX_SIMPLE_LIGHTS + layerId);
+#else
+		visibility = getPointLightShadowVisibility(lightPosition_worldSpace, farPlane, layerId);
+#endif
+	}
+	else
+	{
+		// Since shadows have been disabled, the fragment will be fully visible to the light source.
+		visibility = 1.0;
+	}
+
+	// Fade the light out towards the end of its range.
+	visibility *= getLightRangeFactor(distanceFromLight, farPlane);
+
+	// Calculate the light diffuse lighting value, factored against the color of the surface, and the light specular lighting value,
+	//   both factored against the visibility of the fragment to the light source.
+	return visibility * ((surfaceColor * getLightDiffuseLighting(lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace)) +
+	                     getLightSpecularLighting(fragmentPosition_viewSpace, lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace));
+}
+
+/**
+ * Function that packs the given mask of the lights reaching a model into the lowest bits, so that it is stored exactly in the
+ *   half-float normal texture of the G-buffer (the bits of the cone lights followed by the bits of the point lights).
+ *
+ * @param lightMask  The mask of the lights, with the bits of the point lights from bit 8.
+ *
+ * @return The packed mask of the lights.
+ */
+uint packLightMask(uint lightMask)
+{
+	uint coneLightBits = (1u << uint(MAX_SIMPLE_LIGHTS)) - 1u;
+	uint pointLightBits = ((1u << uint(MAX_CUBE_LIGHTS)) - 1u) << uint(MAX_SIMPLE_LIGHTS);
+	return (lightMask & coneLightBits) | ((lightMask >> uint(8 - MAX_SIMPLE_LIGHTS)) & pointLightBits);
+}
+
+/**
+ * Function that unpacks the given mask of the lights reaching a model, as packed by packLightMask.
+ *
+ * @param packedLightMask  The packed mask of the lights.
+ *
+ * @return The mask of the lights, with the bits of the point lights from bit 8.
+ */
+uint unpackLightMask(uint packedLightMask)
+{
+	uint coneLightBits = (1u << uint(MAX_SIMPLE_LIGHTS)) - 1u;
+	return (packedLightMask & coneLightBits) | ((packedLightMask & ~coneLightBits) << uint(8 - MAX_SIMPLE_LIGHTS));
+}
+
+#ifdef IS_DEFERRED_LIGHTING_PASS
+/**
+ * Function that reconstructs the inputs of the fragment from the G-buffer the way the vertex shader would have passed them on,
+ *   and discards the fragments no model was drawn into.
+ *
+ * @return The diffuse color of the surface of the fragment.
+ */
+vec3 readGBufferFragment()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(gBufferDepthTexture, texel, 0).r;
+	if (depth == 1.0)
+	{
+		discard;
+	}
+	// Write the depth of the model, so that the models drawn after the lighting are tested against it.
+	gl_FragDepth = depth;
+
+	// Undo the projection of the camera to find the position of the fragment.
+	vec4 fragmentPosition_ndc = vec4(((gl_FragCoord.xy / gBufferViewportSize) * 2.0) - 1.0, (depth * 2.0) - 1.0, 1.0);
+	fragmentPosition_viewSpace = inverseProjectionMatrix * fragmentPosition_ndc;
+	fragmentPosition_viewSpace /= fragmentPosition_viewSpace.w;
+	fragmentPosition_worldSpace = inverseViewMatrix * fragmentPosition_viewSpace;
+
+	// Grab the normal and the mask of the lights reaching the model.
+	vec4 normalLightMask = texelFetch(gBufferNormalTexture, texel, 0);
+	fragmentNormal_viewSpace = normalLightMask.xyz;
+	fragmentLightMask = unpackLightMask(uint(normalLightMask.w + 0.5));
+
+	// Find the positions of the lights in view-space and the shadow map coordinates of the fragment, as the vertex shader does.
+	for (int lightIndex = 0; lightIndex < CONE_LIGHTS_COUNT; lightIndex++)
+	{
+		coneLightPosition_viewSpace[lightIndex] = frameDetails.viewMatrix * vec4(frameDetails.coneLightDetails[lightIndex].lightPosition.xyz, 1.0);
+		coneLightShadowMapCoord[lightIndex] = frameDetails.coneLightDetails[lightIndex].lightVpMatrix * fragmentPosition_worldSpace;
+	}
+	for (int lightIndex = 0; lightIndex < POINT_LIGHTS_COUNT; lightIndex++)
+	{
+		pointLightPosition_viewSpace[lightIndex] = frameDetails.viewMatrix * vec4(frameDetails.pointLightDetails[lightIndex].lightPosition.xyz, 1.0);
+	}
+
+	return texelFetch(gBufferAlbedoTexture, texel, 0).rgb;
+}
+#endif
+
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+/**
+ * Function that rotates the taps of the kernel of the current pixel of the shadow mask by an angle that changes per pixel (by
+ *   interleaved gradient noise) and per frame, so that the few taps taken every frame cover the kernel once accumulated.
+ */
+void rotateShadowFilterTaps()
+{
+	float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+	float angle = 6.2831853 * fract(noise + (temporalShadowFilterDetails.x * 0.618034));
+	temporalShadowFilterRotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+}
+
+/**
+ * Function that blends the visibilities of the current pixel of the shadow mask with the ones written by the last frame at the
+ *   position the pixel was at, unless the surface there was another one (by its depth) or the pixel moved too far.
+ *
+ * @param visibilities  The visibilities of the current frame, blended with the last ones.
+ */
+void accumulateShadowMask(inout vec4 visibilities[SHADOW_MASK_LAYERS_COUNT])
+{
+	// Find the position of the pixel in the last frame.
+	vec4 previousPosition_clipSpace = previousViewProjectionMatrix * fragmentPosition_worldSpace;
+	if (temporalShadowFilterDetails.y <= 0.0 || previousPosition_clipSpace.w <= 0.0)
+	{
+		return;
+	}
+	vec3 previousPosition_ndc = previousPosition_clipSpace.xyz / previousPosition_clipSpace.w;
+	vec2 previousCoords = (previousPosition_ndc.xy * 0.5) + 0.5;
+	if (any(lessThan(previousCoords, vec2(0.0))) || any(greaterThanEqual(previousCoords, vec2(1.0))))
+	{
+		return;
+	}
+
+	// Reject the last shadow mask where the depth it was written from is not the depth of the pixel in the last frame, which is
+	//   where the surface was hidden (or another model moved over it), and fade it out with the motion of the pixel.
+	ivec2 historyTexel = ivec2(previousCoords * shadowMaskSceneSize * 0.5);
+	float expectedDepth = getLinearDepth((previousPosition_ndc.z * 0.5) + 0.5);
+	float historyDepth = getLinearDepth(texelFetch(shadowMaskHistoryDepthTexture, historyTexel * 2, 0).r);
+	if (abs(historyDepth - expectedDepth) > expectedDepth * temporalShadowDepthTolerance)
+	{
+		return;
+	}
+	vec2 currentCoords = ((floor(gl_FragCoord.xy) * 2.0) + 0.5) / shadowMaskSceneSize;
+	float motion = length((previousCoords - currentCoords) * shadowMaskSceneSize * 0.5);
+	float historyWeight = temporalShadowFilterDetails.y * clamp(1.0 - (motion / temporalShadowMaxMotion), 0.0, 1.0);
+
+	for (int layer = 0; layer < SHADOW_MASK_LAYERS_COUNT; layer++)
+	{
+		vec4 history = texelFetch(shadowMaskHistoryTexture, ivec3(historyTexel, layer), 0);
+		history = clamp(history, visibilities[layer] - temporalShadowClampRange, visibilities[layer] + temporalShadowClampRange);
+		visibilities[layer] = mix(visibilities[layer], history, historyWeight);
+	}
+}
+#endif
+
+#ifdef IS_SHADOW_MASK_PASS
+/**
+ * Function that writes the visibility of the pixel of the shadow mask to each light with a shadow map, from the position of the
+ *   first pixel of the scene it covers. The lights the pixel is out of the range of are written as fully visible.
+ */
+void writeShadowMask()
+{
+	vec4 visibilities[SHADOW_MASK_LAYERS_COUNT];
+	for (int layer = 0; layer < SHADOW_MASK_LAYERS_COUNT; layer++)
+	{
+		visibilities[layer] = vec4(1.0);
+	}
+
+	ivec2 texel = ivec2(gl_FragCoord.xy) * 2;
+	float depth = texelFetch(shadowMaskDepthTexture, texel, 0).r;
+	// Skip the pixels no model was drawn into, and the frames without shadows.
+	if (depth < 1.0 && IS_LIGHTING_ENABLED && IS_SHADOW_ENABLED)
+	{
+		// Undo the projection of the camera to find the position of the pixel.
+		vec4 fragmentPosition_ndc = vec4((((vec2(texel) + 0.5) / shadowMaskSceneSize) * 2.0) - 1.0, (depth * 2.0) - 1.0, 1.0);
+		fragmentPosition_viewSpace = inverseProjectionMatrix * fragmentPosition_ndc;
+		fragmentPosition_viewSpace /= fragmentPosition_viewSpace.w;
+		fragmentPosition_worldSpace = inverseViewMatrix * fragmentPosition_viewSpace;
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+		rotateShadowFilterTaps();
+#endif
+
+		for (int lightIndex = 0; lightIndex < CONE_LIGHTS_COUNT; lightIndex++)
+		{
+			if (distance(fragmentPosition_worldSpace.xyz, frameDetails.coneLightDetails[lightIndex].lightPosition.xyz) < frameDetails.coneLightDetails[lightIndex].farPlane)
+			{
+				coneLightShadowMapCoord[lightIndex] = frameDetails.coneLightDetails[lightIndex].lightVpMatrix * fragmentPosition_worldSpace;
+				visibilities[lightIndex / 4][lightIndex % 4] = getConeLightShadowVisibility(lightIndex);
+			}
+		}
+		for (int lightIndex = 0; lightIndex < POINT_LIGHTS_COUNT; lightIndex++)
+		{
+			vec3 lightPosition_worldSpace = frameDetails.pointLightDetails[lightIndex].lightPosition.xyz;
+			float farPlane = frameDetails.pointLightDetails[lightIndex].farPlane;
+			int maskChannel = MAX_SIMPLE_LIGHTS + frameDetails.pointLightDetails[lightIndex].layerId;
+			if (distance(fragmentPosition_worldSpace.xyz, lightPosition_worldSpace) < farPlane)
+			{
+				visibilities[maskChannel / 4][maskChannel % 4] = getPointLightShadowVisibility(lightPosition_worldSpace, farPlane, frameDetails.pointLightDetails[lightIndex].layerId);
+			}
+		}
+#ifdef IS_TEMPORAL_SHADOW_FILTER
+		accumulateShadowMask(visibilities);
+#endif
+	}
+
+	shadowMaskLayer0 = visibilities[0];
+	shadowMaskLayer1 = visibilities[1];
+}
+#endif
+
 void main()
 {
+#ifdef IS_SHADOW_MASK_PASS
+	// Only write the visibility of the pixel to the lights into the shadow mask, the models read it while being shaded afterwards.
+	writeShadowMask();
+#else
+#ifdef IS_DEFERRED_LIGHTING_PASS
+	// Grab the diffuse color drawn into the G-buffer, along with the rest of the inputs of the fragment.
+	vec3 surfaceColor = readGBufferFragment();
+#else
 	// Grab the diffuse color defined in the shot texture using the given UV coordinates.
-	vec3 surfaceColor = texture(diffuseTexture, fragmentUv).rgb;
+	vec3 surfaceColor = texture(diffuseTexture, DIFFUSE_TEXTURE_COORD(fragmentUv)).rgb;
+#endif
+#ifdef IS_GBUFFER_PASS
+	// Only write the surface of the fragment into the G-buffer, the lighting pass shades it afterwards.
+	color = surfaceColor;
+	gBufferNormal = vec4(fragmentNormal_viewSpace, float(packLightMask(fragmentLightMask)));
+	return;
+#endif
 	// Set the initial color value as the ambient lighting color value of the surface.
 	// If lighting is disabled, the ambient factor is set to 1, since lighting should be ignored as a factor.
-	color = surfaceColor * clamp(ambientFactor + clamp(disableFeatureMask - 1, 0, 1), 0.0, 1.0);
+	color = surfaceColor * clamp(frameDetails.ambientFactor + (IS_LIGHTING_ENABLED ? 0.0 : 1.0), 0.0, 1.0);
 
 	// Perform lighting calculations as long as lighting has not been disabled.
-	if (disableFeatureMask < DISABLE_LIGHT)
+	if (IS_LIGHTING_ENABLED)
 	{
+#ifdef IS_SHADOW_MASK_ENABLED
+		// Upsample the visibility of the fragment to the lights with a shadow map from the shadow mask, once for all of them.
+		if (IS_SHADOW_ENABLED)
+		{
+			upsampleShadowMask();
+		}
+#endif
 		// Iterate through all the active cone lights.
-		for (int lightIndex = 0; lightIndex < coneLightsCount; lightIndex++)
+		for (int lightIndex = 0; lightIndex < CONE_LIGHTS_COUNT; lightIndex++)
 		{
+			// Skip the lights that cannot reach the model.
+			if ((fragmentLightMask & (1u << uint(lightIndex))) == 0u)
+			{
+				continue;
+			}
+
+			// Calculate the distance of the fragment from the light source, and skip the fragments out of the range of the light
+			//   before sampling its shadow map.
+			float distanceFromLight = distance(fragmentPosition_viewSpace.xyz, coneLightPosition_viewSpace[lightIndex].xyz);
+			if (distanceFromLight >= frameDetails.coneLightDetails[lightIndex].farPlane)
+			{
+				continue;
+			}
+
 			// Calculate the direction of the light from the source to the fragment in view-space.
 			vec3 coneLightDirection_viewSpace = normalize((coneLightPosition_viewSpace[lightIndex] - fragmentPosition_viewSpace).xyz);
 
 			// Define variable for storing the visibility of the fragment to the current light source.
 			float visibility;
 			// Perform shadow visibility calculations as long as shadows have not been disabled.
-			if (disableFeatureMask < DISABLE_SHADOW)
+			if (IS_SHADOW_ENABLED)
 			{
-				// Calculate the shadow map coordinates of the fragment w.r.t. the current light source (while applying perspective-division).
-				vec3 shadowMapCoords = (((coneLightShadowMapCoord[lightIndex].xyz) / coneLightShadowMapCoord[lightIndex].w) * 0.5) + 0.5;
-				// Calculate the visibilty of the fragment to the current light source.
-				visibility = getConeLightAverageVisibility(shadowMapCoords.xy, shadowMapCoords.z, coneLightDetails_fragment[lightIndex].layerId);
+				// Calculate the visibilty of the fragment to the current light source (or read it from the shadow mask).
+#ifdef IS_SHADOW_MASK_ENABLED
+				visibility = getMaskedShadowVisibility(lightIndex);
+#else
+				visibility = getConeLightShadowVisibility(lightIndex);
+#endif
 			}
 			else
 			{
@@ -371,48 +992,64 @@ void main()
 				visibility = 1.0;
 			}
 
-			// Calculate the distance of the fragment from the light source.
-  		float distanceFromLight = distance(fragmentPosition_viewSpace.xyz, coneLightPosition_viewSpace[lightIndex].xyz);
+			// Fade the light out towards the end of its range.
+			visibility *= getLightRangeFactor(distanceFromLight, frameDetails.coneLightDetails[lightIndex].farPlane);
 
 			// Calculate and add the light diffuse lighting value to the final color output, factored against the color of the surface
 			//   and the visibility of the fragment to the light source.
-			color += visibility * surfaceColor * getLightDiffuseLighting(coneLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
+			color += visibility * surfaceColor * getLightDiffuseLighting(frameDetails.coneLightDetails[lightIndex].lightColorIntensity.xyz, distanceFromLight, coneLightDirection_viewSpace);
 			// Calculate and add the light specular lighting value to the final color output, factored against the visibility of the
 			//   fragment to the light source.
-			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, coneLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
+			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, frameDetails.coneLightDetails[lightIndex].lightColorIntensity.xyz, distanceFromLight, coneLightDirection_viewSpace);
 		}
 
-		// Iterate through all the active point lights.
-		for (int lightIndex = 0; lightIndex < pointLightsCount; lightIndex++)
+		// Check if the point lights were binned into the light clusters.
+		if (IS_CLUSTERED_LIGHTING_ENABLED)
 		{
-			// Calculate the direction of the light from the source to the fragment in view-space.
-			vec3 pointLightDirection_viewSpace = normalize((pointLightPosition_viewSpace[lightIndex] - fragmentPosition_viewSpace).xyz);
+			// Find the light cluster of the fragment from its position on the screen and its view depth.
+			ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy / frameDetails.clusterDepthDetails.zw),
+			                      int(floor((log(-fragmentPosition_viewSpace.z) * frameDetails.clusterDepthDetails.x) + frameDetails.clusterDepthDetails.y)));
+			cluster = clamp(cluster, ivec3(0), frameDetails.clusterDetails.xyz - 1);
+			// Grab the offset and count of the light indices of the cluster.
+			uvec2 clusterLights = texelFetch(clusterGridTexture, cluster.x + (frameDetails.clusterDetails.x * (cluster.y + (frameDetails.clusterDetails.y * cluster.z)))).xy;
 
-			// Define variable for storing the visibility of the fragment to the current light source.
-			float visibility;
-			// Perform shadow visibility calculations as long as shadows have not been disabled.
-			if (disableFeatureMask < DISABLE_SHADOW)
+			// Iterate through the point lights reaching the cluster.
+			for (uint i = 0u; i < clusterLights.y; i++)
 			{
-				// Calculate the shadow map coordinates of the fragment w.r.t. the current light source.
-				vec3 shadowMapCoords = fragmentPosition_worldSpace.xyz - pointLightDetails_fragment[lightIndex].lightPosition;
-				// Calculate the visibilty of the fragment to the current light source.
-				visibility = getPointLightAverageVisibility(shadowMapCoords.xyz, length(shadowMapCoords), pointLightDetails_fragment[lightIndex].layerId, pointLightDetails_fragment[lightIndex].farPlane);
+				// Grab the details of the light.
+				int lightTexel = int(texelFetch(clusterLightIndicesTexture, int(clusterLights.x + i)).r) * 3;
+				vec4 lightPositionRadius_viewSpace = texelFetch(clusterLightsTexture, lightTexel);
+				vec4 lightColorIntensityFarPlane = texelFetch(clusterLightsTexture, lightTexel + 1);
+				vec4 lightPositionLayer_worldSpace = texelFetch(clusterLightsTexture, lightTexel + 2);
+
+				// Add the lighting value of the light to the final color output (faded out towards the end of its range).
+				color += getPointLightLighting(surfaceColor,
+				                               lightPositionRadius_viewSpace.xyz,
+				                               lightPositionLayer_worldSpace.xyz,
+				                               lightColorIntensityFarPlane.rgb,
+				                               lightColorIntensityFarPlane.w,
+				                               int(lightPositionLayer_worldSpace.w));
 			}
-			else
+		}
+		else
+		{
+			// Iterate through all the active point lights, and add their lighting value to the final color output.
+			for (int lightIndex = 0; lightIndex < POINT_LIGHTS_COUNT; lightIndex++)
 			{
-				// Since shadows have been disabled, the fragment will be fully visible to the light source.
-				visibility = 1.0;
-			}
-
-			// Calculate the distance of the fragment from the light source.
-  		float distanceFromLight = distance(fragmentPosition_viewSpace.xyz, pointLightPosition_viewSpace[lightIndex].xyz);
+				// Skip the lights that cannot reach the model.
+				if ((fragmentLightMask & (1u << uint(8 + lightIndex))) == 0u)
+				{
+					continue;
+				}
 
-			// Calculate and add the light diffuse lighting value to the final color output, factored against the color of the surface
-			//   and the visibility of the fragment to the light source.
-			color += visibility * surfaceColor * getLightDiffuseLighting(pointLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
-			// Calculate and add the light specular lighting value to the final color output, factored against the visibility of the
-			//   fragment to the light source.
-			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, pointLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
+				color += getPointLightLighting(surfaceColor,
+				                               pointLightPosition_viewSpace[lightIndex].xyz,
+				                               frameDetails.pointLightDetails[lightIndex].lightPosition.xyz,
+				                               frameDetails.pointLightDetails[lightIndex].lightColorIntensity.xyz,
+				                               frameDetails.pointLightDetails[lightIndex].farPlane,
+				                               frameDetails.pointLightDetails[lightIndex].layerId);
+			}
 		}
 	}
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 330 core
+
+// The depth pre-pass only writes the depth of the fragments, so that the lit pass
+//   only shades the closest fragment of each pixel. No color is written.
+
+void main()
+{
+}
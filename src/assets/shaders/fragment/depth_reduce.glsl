@@ -0,0 +1,24 @@
+#version 330 core
+
+// Reduces a level of the depth pyramid to the next one, half its size (rounded up),
+//   keeping the farthest depth of the 2x2 texels each texel covers. A box whose closest
+//   depth is farther than the farthest depth of the texels it covers is hidden.
+
+out float depth;
+
+// The level being reduced (the depth of the scene for the first level).
+uniform sampler2D sourceDepthTexture;
+// The size of the part of the level being reduced, in texels.
+uniform ivec2 sourceSize;
+
+void main()
+{
+	// Clamp the texels to the reduced part, so that the last texel of an odd size covers the last texel alone.
+	ivec2 sourceTexel = ivec2(gl_FragCoord.xy) * 2;
+	ivec2 lastTexel = sourceSize - 1;
+	float depth0 = texelFetch(sourceDepthTexture, min(sourceTexel, lastTexel), 0).r;
+	float depth1 = texelFetch(sourceDepthTexture, min(sourceTexel + ivec2(1, 0), lastTexel), 0).r;
+	float depth2 = texelFetch(sourceDepthTexture, min(sourceTexel + ivec2(0, 1), lastTexel), 0).r;
+	float depth3 = texelFetch(sourceDepthTexture, min(sourceTexel + ivec2(1, 1), lastTexel), 0).r;
+	depth = max(max(depth0, depth1), max(depth2, depth3));
+}
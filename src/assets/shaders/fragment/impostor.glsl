@@ -0,0 +1,88 @@
+#version 330 core
+
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
+
+// The UV coordinates of the fragment in the atlas, inside the cell of the view picked.
+in vec2 fragmentUv;
+// The position of the fragment on the plane of the billboard in world-space.
+in vec3 fragmentPosition_worldSpace;
+// The offset in world-space of the baked depth of 1, towards the view the billboard is drawn from.
+flat in vec3 fragmentDepthAxis_worldSpace;
+// The matrix transforming the baked normals from model-space to view-space.
+flat in mat3 fragmentNormalMatrix;
+// The mask of the lights reaching the model.
+flat in uint fragmentLightMask;
+
+// The diffuse color of the fragment, written to the albedo of the G-buffer.
+layout(location = 0) out vec3 color;
+// The normal vector of the fragment in view-space, with the packed mask of the lights reaching the model in W.
+layout(location = 1) out vec4 gBufferNormal;
+
+// The albedo baked into the atlas with its coverage in alpha, and the normals in model-space with their depth in W.
+uniform sampler2D impostorAlbedoTexture;
+uniform sampler2D impostorNormalDepthTexture;
+
+// The structure defining the details regarding the active lights.
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
+{
+	mat4 lightVpMatrix;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
+	float farPlane;
+	int layerId;
+	vec4 shadowMapRect;
+};
+
+// The frame-constant details shared by all the models, written once per frame.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
+
+/**
+ * Function that packs the given mask of the lights reaching a model into the lowest bits, the same way the default fragment
+ *   shader does for the G-buffer.
+ *
+ * @param lightMask  The mask of the lights, with the bits of the point lights from bit 8.
+ *
+ * @return The packed mask of the lights.
+ */
+uint packLightMask(uint lightMask)
+{
+	uint coneLightBits = (1u << uint(MAX_SIMPLE_LIGHTS)) - 1u;
+	uint pointLightBits = ((1u << uint(MAX_CUBE_LIGHTS)) - 1u) << uint(MAX_SIMPLE_LIGHTS);
+	return (lightMask & coneLightBits) | ((lightMask >> uint(8 - MAX_SIMPLE_LIGHTS)) & pointLightBits);
+}
+
+void main()
+{
+	// Skip the parts of the billboard not covered by the baked surface.
+	vec4 albedo = texture(impostorAlbedoTexture, fragmentUv);
+	if (albedo.a < 0.5)
+	{
+		discard;
+	}
+	vec4 normalDepth = texture(impostorNormalDepthTexture, fragmentUv);
+
+	// Write the baked surface into the G-buffer the way the models drawn with their meshes do, for the lighting pass to light it.
+	color = albedo.rgb;
+	gBufferNormal = vec4(normalize(fragmentNormalMatrix * normalDepth.xyz), float(packLightMask(fragmentLightMask)));
+
+	// Move the depth of the fragment off the plane of the billboard to the baked surface, so that the impostors intersect the
+	//   other models (and each other) the way their meshes would.
+	vec4 surfacePosition_clipSpace = frameDetails.viewProjectionMatrix * vec4(fragmentPosition_worldSpace + (fragmentDepthAxis_worldSpace * normalDepth.w), 1.0);
+	gl_FragDepth = ((surfacePosition_clipSpace.z / surfacePosition_clipSpace.w) * 0.5) + 0.5;
+}
@@ -0,0 +1,38 @@
+#version 330 core
+
+// The UV coordinates of the diffuse color of the fragment in the standard object texture.
+in vec2 fragmentUv;
+// The position of the fragment in model-space.
+in vec3 fragmentPosition_modelSpace;
+// The normal vector of the fragment in model-space.
+in vec3 fragmentNormal_modelSpace;
+
+// The diffuse color of the fragment, with full coverage in alpha (the cells being cleared to no coverage).
+layout(location = 0) out vec4 impostorAlbedo;
+// The normal vector of the fragment in model-space, with its depth towards the view in W.
+layout(location = 1) out vec4 impostorNormalDepth;
+
+// The standard object texture sampler, which is a layer of a texture array when the textures are batched.
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+uniform sampler2DArray diffuseTexture;
+// The layer of the texture array containing the texture of the model.
+uniform int impostorTextureLayer;
+#define DIFFUSE_TEXTURE_COORD(uv) vec3(uv, float(impostorTextureLayer))
+#else
+uniform sampler2D diffuseTexture;
+#define DIFFUSE_TEXTURE_COORD(uv) (uv)
+#endif
+
+// The center of the bounds of the object in model-space, with their radius in W.
+uniform vec4 impostorBounds;
+// The direction of the view of the cell being baked in model-space, towards the camera.
+uniform vec4 impostorViewDirection;
+
+void main()
+{
+	impostorAlbedo = vec4(texture(diffuseTexture, DIFFUSE_TEXTURE_COORD(fragmentUv)).rgb, 1.0);
+	// The depth is the distance of the fragment in front of the plane of the billboard through the center of the bounds, as a share
+	//   of their radius, so that the billboards can offset their depth by it whatever the scale of the model.
+	float depth = dot(fragmentPosition_modelSpace - impostorBounds.xyz, impostorViewDirection.xyz) / impostorBounds.w;
+	impostorNormalDepth = vec4(normalize(fragmentNormal_modelSpace), depth);
+}
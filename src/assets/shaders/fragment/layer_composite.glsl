@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec2 fragmentUv;
+
+out vec4 color;
+
+// The color and the depth the cached layers were drawn with.
+uniform sampler2D layerColorTexture;
+uniform sampler2D layerDepthTexture;
+
+void main()
+{
+	// Copy the cached layers with their depth, so that the models drawn over them are still hidden behind the closer ones.
+	color = texture(layerColorTexture, fragmentUv);
+	gl_FragDepth = texture(layerDepthTexture, fragmentUv).r;
+}
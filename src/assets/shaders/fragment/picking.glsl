@@ -0,0 +1,13 @@
+#version 330 core
+
+// The ID of the model the fragment belongs to, counted from 1.
+flat in uint modelPickId;
+
+// The ID written into the picking target (0 being left for no model).
+layout(location = 0) out uint pickId;
+
+void main()
+{
+	// The closest fragment under the picked point keeps its model ID through the depth test.
+	pickId = modelPickId;
+}
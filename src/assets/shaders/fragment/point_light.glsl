@@ -11,48 +11,49 @@
 //   fails to link the two shader components together because their
 //   structures are now different.
 
-#define MAX_LIGHTS 5
+// MAX_SHADOW_LIGHTS is defined by the shader manager from the engine limits.
 
 // The position of the fragment as interpolated by the GPU from the geometry shader.
 in vec4 fragmentPosition;
 in float lightIndex;
 
-// The structure defining the details regarding the point light.
-struct LightDetails_Fragment
+// The structure defining the details regarding the light.
+// The layout matches the ShadowLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-  int layerId;
-  vec3 lightPosition;
   mat4 vpMatrices[6];
+  vec4 lightPosition;
+  int layerId;
   int vpMatrixCount;
-};
-
-// The structure defining the details regarding the projection of
-//   the point light.
-struct ProjectionDetails_Fragment
-{
   float nearPlane;
   float farPlane;
+  vec4 shadowMapRect;
 };
 
-// The details of the current point light.
-uniform LightDetails_Fragment lightDetails_fragment[MAX_LIGHTS];
-// The details of the current point light.
-uniform ProjectionDetails_Fragment projectionDetails_fragment[MAX_LIGHTS];
+// The details of all the lights rendering to the current shadow buffer, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform ShadowDetails
+{
+  LightDetails lightDetails[MAX_SHADOW_LIGHTS];
+  int lightsCount;
+  float animationTime;
+} shadowDetails;
 
 void main()
 {
   int lightIndex_int = int(lightIndex);
 
   // Calculate the distance of the fragment from the light source.
-  float originalLightDistance = length(fragmentPosition.xyz - lightDetails_fragment[lightIndex_int].lightPosition);
+  float originalLightDistance = length(fragmentPosition.xyz - shadowDetails.lightDetails[lightIndex_int].lightPosition.xyz);
   
   // Normalize the light distance against the farthest distance the
   //   light can go till (as defined by the far plane).
   // This makes the light distance a percentage value against the max
   //   distance the light can travel.
-  float lightDistance = originalLightDistance / projectionDetails_fragment[lightIndex_int].farPlane;
+  float lightDistance = originalLightDistance / shadowDetails.lightDetails[lightIndex_int].farPlane;
   
   // Set the fragment depth to the normalized light distance. This
   //   makes it easier to process the shadow map.
-  gl_FragDepth = (step(originalLightDistance, projectionDetails_fragment[lightIndex_int].nearPlane) * projectionDetails_fragment[lightIndex_int].farPlane) + lightDistance;
+  gl_FragDepth = (step(originalLightDistance, shadowDetails.lightDetails[lightIndex_int].nearPlane) * shadowDetails.lightDetails[lightIndex_int].farPlane) + lightDistance;
 }
\ No newline at end of file
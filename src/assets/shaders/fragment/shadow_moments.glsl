@@ -0,0 +1,128 @@
+#version 330 core
+
+#extension GL_ARB_texture_cube_map_array: require
+
+// Writes the moments (the depth and the squared depth) of the tile of a cone light in the shadow atlas, or of a face of the
+//   cube map of a point light, for the variance shadow maps. The moments are written at half the size of the shadowmap, each
+//   texel averaging the 2x2 depths it covers, and blurred with a separable 5-tap binomial kernel: the first pass reads the
+//   depths and blurs along one axis, the second reads the moments of the first and blurs along the other.
+// The depths are linear distances from the light divided by its far plane, so that both light types compare the same way.
+
+out vec2 moments;
+
+// The sources the moments are read from (matches the MomentSource values in the shadow moment maps).
+#define MOMENT_SOURCE_CONE_LIGHT_DEPTH 0
+#define MOMENT_SOURCE_POINT_LIGHT_DEPTH 1
+#define MOMENT_SOURCE_MOMENTS 2
+
+// The shadow atlas of the cone lights, read without the depth comparison.
+uniform sampler2D coneLightDepthTexture;
+// The cube map array of the point lights, read without the depth comparison.
+uniform samplerCubeArray pointLightDepthTextures;
+// The moments written by the first pass.
+uniform sampler2D momentsTexture;
+// The source the moments are read from.
+uniform int momentSource;
+// The texel the tile (or the moments of the first pass) starts at in the source.
+uniform ivec2 sourceOffset;
+// The texel the moments start at in the target, and their size in texels.
+uniform ivec2 targetOffset;
+uniform ivec2 targetSize;
+// The axis the moments are blurred along in this pass.
+uniform ivec2 blurDirection;
+// The cube map of the point light, and the face of the cube map.
+uniform int pointLightCubeIndex;
+uniform int pointLightFace;
+// The near and far planes of the light.
+uniform vec2 depthPlanes;
+
+// The weights of the taps of the blur kernel.
+const float blurWeights[5] = float[5](0.0625, 0.25, 0.375, 0.25, 0.0625);
+
+/**
+ * Function that returns the direction from the center of a cube map to the given
+ *   coordinates of the face of the point light, the inverse of the face selection
+ *   done when the cube map is sampled.
+ *
+ * @param faceCoords  The coordinates in the face, from -1 to 1.
+ *
+ * @return The direction of the coordinates from the center of the cube map.
+ */
+vec3 getCubeFaceDirection(vec2 faceCoords)
+{
+	if (pointLightFace == 0)
+	{
+		return vec3(1.0, -faceCoords.y, -faceCoords.x);
+	}
+	if (pointLightFace == 1)
+	{
+		return vec3(-1.0, -faceCoords.y, faceCoords.x);
+	}
+	if (pointLightFace == 2)
+	{
+		return vec3(faceCoords.x, 1.0, faceCoords.y);
+	}
+	if (pointLightFace == 3)
+	{
+		return vec3(faceCoords.x, -1.0, -faceCoords.y);
+	}
+	if (pointLightFace == 4)
+	{
+		return vec3(faceCoords.x, -faceCoords.y, 1.0);
+	}
+	return vec3(-faceCoords.x, -faceCoords.y, -1.0);
+}
+
+/**
+ * Function that returns the linear depth of the given texel of the shadowmap.
+ *
+ * @param texel  The texel in the tile or the face of the shadowmap.
+ *
+ * @return The distance from the light divided by its far plane.
+ */
+float getSourceDepth(ivec2 texel)
+{
+	if (momentSource == MOMENT_SOURCE_CONE_LIGHT_DEPTH)
+	{
+		// Undo the perspective projection of the cone light.
+		float depth_ndc = (texelFetch(coneLightDepthTexture, sourceOffset + texel, 0).r * 2.0) - 1.0;
+		return (2.0 * depthPlanes.x) / (depthPlanes.y + depthPlanes.x - (depth_ndc * (depthPlanes.y - depthPlanes.x)));
+	}
+	// The depths of the point lights are linear already.
+	vec2 faceCoords = (((vec2(texel) + 0.5) / vec2(targetSize * 2)) * 2.0) - 1.0;
+	return textureLod(pointLightDepthTextures, vec4(getCubeFaceDirection(faceCoords), pointLightCubeIndex), 0.0).r;
+}
+
+/**
+ * Function that returns the unblurred moments of the given texel of the target.
+ *
+ * @param texel  The texel in the target.
+ *
+ * @return The moments of the depths the texel covers.
+ */
+vec2 getSourceMoments(ivec2 texel)
+{
+	if (momentSource == MOMENT_SOURCE_MOMENTS)
+	{
+		return texelFetch(momentsTexture, sourceOffset + texel, 0).rg;
+	}
+	// Average the moments of the 2x2 depths the texel covers (the tiles and faces always have even sizes).
+	vec2 sourceMoments = vec2(0.0);
+	for (int i = 0; i < 4; i++)
+	{
+		float depth = getSourceDepth((texel * 2) + ivec2(i & 1, i >> 1));
+		sourceMoments += vec2(depth, depth * depth) * 0.25;
+	}
+	return sourceMoments;
+}
+
+void main()
+{
+	// Blur the moments along the axis of the pass, clamping the taps to the tile or the face so that nothing bleeds in from the others.
+	ivec2 texel = ivec2(gl_FragCoord.xy) - targetOffset;
+	moments = vec2(0.0);
+	for (int i = 0; i < 5; i++)
+	{
+		moments += getSourceMoments(clamp(texel + (blurDirection * (i - 2)), ivec2(0), targetSize - 1)) * blurWeights[i];
+	}
+}
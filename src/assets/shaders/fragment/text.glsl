@@ -1,14 +1,22 @@
 #version 330 core
 
 in vec2 fragmentUv;
-in float fragmentUvLayer;
 
 out vec4 color;
 
-uniform sampler2DArray textTexture;
+uniform sampler2D textTexture;
+// Whether the glyphs are signed distance fields, with the edge at 0.5, instead of coverage.
+uniform bool isSdfEnabled;
 
 void main()
 {    
-    vec4 textSample = vec4(1.0, 1.0, 1.0, texture(textTexture, vec3(fragmentUv, fragmentUvLayer)).r);
+    float textCoverage = texture(textTexture, fragmentUv).r;
+    if (isSdfEnabled)
+    {
+        // Smooth the edge over about a pixel of the screen, however far the glyph is scaled.
+        float edgeWidth = max(length(vec2(dFdx(textCoverage), dFdy(textCoverage))) * 0.7071, 0.0001);
+        textCoverage = smoothstep(0.5 - edgeWidth, 0.5 + edgeWidth, textCoverage);
+    }
+    vec4 textSample = vec4(1.0, 1.0, 1.0, textCoverage);
     color = textSample;
 }
\ No newline at end of file
@@ -19,12 +19,21 @@ in vec2 fragmentUv;
 out vec4 color;
 
 // The shot object texture sampler.
+// The texture is a layer of a texture array shared with the textures of the same format and size when they are batched.
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+uniform sampler2DArray diffuseTexture;
+// The layer of the texture array containing the texture of the model, passed on from the vertex shader as is.
+flat in float fragmentTextureLayer;
+#define DIFFUSE_TEXTURE_COORD(uv) vec3(uv, fragmentTextureLayer)
+#else
 uniform sampler2D diffuseTexture;
+#define DIFFUSE_TEXTURE_COORD(uv) (uv)
+#endif
 
 void main()
 {
 	// Grab the diffuse color defined in the shot tecture using the given UV coordinates,
 	//   and set that as the color of the fragment.
-	color.rgb = texture(diffuseTexture, fragmentUv).rgb;
+	color.rgb = texture(diffuseTexture, DIFFUSE_TEXTURE_COORD(fragmentUv)).rgb;
 	color.a = color.r * color.g * color.b;
 }
\ No newline at end of file
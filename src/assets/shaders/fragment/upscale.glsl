@@ -0,0 +1,112 @@
+#version 330 core
+
+// The edge detection thresholds and the filter span limits of FXAA.
+#define FXAA_EDGE_THRESHOLD_MIN (1.0 / 32.0)
+#define FXAA_EDGE_THRESHOLD (1.0 / 8.0)
+#define FXAA_REDUCE_MIN (1.0 / 128.0)
+#define FXAA_REDUCE_MUL (1.0 / 8.0)
+#define FXAA_SPAN_MAX 8.0
+
+in vec2 fragmentUv;
+
+out vec4 color;
+
+// The texture the scene was resolved into, of which only the scaled viewport is covered.
+uniform sampler2D sceneTexture;
+// The part of the texture covered by the scaled viewport.
+uniform vec2 sceneUvScale;
+// The size of a texel of the texture.
+uniform vec2 sceneTexelSize;
+// The strength of the sharpening of the upscaled scene (0 for plain bilinear filtering).
+uniform float sharpness;
+// Whether FXAA is applied to the scene, which was rendered without multisampling then.
+uniform bool isFxaaEnabled;
+
+/**
+ * Sample the scene, keeping the samples within the covered part so that the uncovered texels never bleed into the edges.
+ *
+ * @param uv  The texture coordinates to sample at.
+ *
+ * @return The color of the scene.
+ */
+vec3 sampleScene(vec2 uv)
+{
+    return texture(sceneTexture, clamp(uv, sceneTexelSize * 0.5, sceneUvScale - (sceneTexelSize * 0.5))).rgb;
+}
+
+/**
+ * Get the perceived brightness of a color, which FXAA finds the edges from.
+ *
+ * @param sceneColor  The color.
+ *
+ * @return The luma of the color.
+ */
+float getLuma(vec3 sceneColor)
+{
+    return dot(sceneColor, vec3(0.299, 0.587, 0.114));
+}
+
+/**
+ * Apply FXAA to the scene, blurring along the edges found from the luma of the diagonal neighbours.
+ *
+ * @param uv  The texture coordinates of the fragment.
+ *
+ * @return The anti-aliased color of the scene.
+ */
+vec3 applyFxaa(vec2 uv)
+{
+    vec3 colorM = sampleScene(uv);
+    float lumaNW = getLuma(sampleScene(uv + (vec2(-1.0, 1.0) * sceneTexelSize)));
+    float lumaNE = getLuma(sampleScene(uv + (vec2(1.0, 1.0) * sceneTexelSize)));
+    float lumaSW = getLuma(sampleScene(uv + (vec2(-1.0, -1.0) * sceneTexelSize)));
+    float lumaSE = getLuma(sampleScene(uv + (vec2(1.0, -1.0) * sceneTexelSize)));
+    float lumaM = getLuma(colorM);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // Leave the fragments without an edge as they are.
+    if (lumaMax - lumaMin < max(FXAA_EDGE_THRESHOLD_MIN, lumaMax * FXAA_EDGE_THRESHOLD))
+    {
+        return colorM;
+    }
+
+    // Find the direction along the edge, and scale it so that its shorter axis is a texel, up to the span limit.
+    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float directionReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);
+    float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+    direction = clamp(direction * inverseDirectionMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * sceneTexelSize;
+
+    // Blur along the edge with two and four samples, and take the wider blur unless it reaches past the local luma range.
+    vec3 colorA = 0.5 * (sampleScene(uv + (direction * ((1.0 / 3.0) - 0.5))) + sampleScene(uv + (direction * ((2.0 / 3.0) - 0.5))));
+    vec3 colorB = (colorA * 0.5) + (0.25 * (sampleScene(uv - (direction * 0.5)) + sampleScene(uv + (direction * 0.5))));
+    float lumaB = getLuma(colorB);
+    return (lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB;
+}
+
+void main()
+{
+    vec2 uv = fragmentUv * sceneUvScale;
+
+    // The sharpening is left out with FXAA, since it would bring the smoothed edges back.
+    if (isFxaaEnabled)
+    {
+        color = vec4(applyFxaa(uv), 1.0);
+        return;
+    }
+
+    vec3 sceneColor = sampleScene(uv);
+    if (sharpness > 0.0)
+    {
+        // Sharpen with an unsharp mask of the direct neighbours, clamped to their range so that the edges do not ring.
+        vec3 north = sampleScene(uv + vec2(0.0, sceneTexelSize.y));
+        vec3 south = sampleScene(uv - vec2(0.0, sceneTexelSize.y));
+        vec3 east = sampleScene(uv + vec2(sceneTexelSize.x, 0.0));
+        vec3 west = sampleScene(uv - vec2(sceneTexelSize.x, 0.0));
+        vec3 neighboursMin = min(min(north, south), min(east, west));
+        vec3 neighboursMax = max(max(north, south), max(east, west));
+        vec3 blurredColor = (north + south + east + west) * 0.25;
+        sceneColor = clamp(sceneColor + ((sceneColor - blurredColor) * sharpness), min(neighboursMin, sceneColor), max(neighboursMax, sceneColor));
+    }
+
+    color = vec4(sceneColor, 1.0);
+}
\ No newline at end of file
@@ -14,7 +14,7 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_LIGHTS 5
+// MAX_SHADOW_LIGHTS is defined by the shader manager from the engine limits.
 
 // The type of the primitive being accepted by the geometry shader.
 layout (triangles) in;
@@ -22,37 +22,51 @@ layout (triangles) in;
 layout (triangle_strip, max_vertices=18) out;
 
 // The structure defining the details regarding the light.
-struct LightDetails_Geometry
+// The layout matches the ShadowLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-  int layerId;
-  vec3 lightPosition;
   mat4 vpMatrices[6];
+  vec4 lightPosition;
+  int layerId;
   int vpMatrixCount;
+  float nearPlane;
+  float farPlane;
+  vec4 shadowMapRect;
 };
 
-// The details of the current light.
-uniform LightDetails_Geometry lightDetails_geometry[MAX_LIGHTS];
-uniform int lightsCount;
+// The details of all the lights rendering to the current shadow buffer, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform ShadowDetails
+{
+  LightDetails lightDetails[MAX_SHADOW_LIGHTS];
+  int lightsCount;
+  float animationTime;
+} shadowDetails;
+
+// The mask of the shadow map faces the model casts shadows into (a bit per light per face).
+flat in uint geometryCasterMask[];
 
 // The vertex position being used to interpolate fragments.
 out vec4 fragmentPosition;
 
 void main()
 {
-  for(int light = 0; light < lightsCount; light++)
+  for(int light = 0; light < shadowDetails.lightsCount; light++)
   {
     // Generate the vertex position for each face of the light's shadow map.
     // For point lights, this will be 6 faces, for other maps it is just 1 face.
-    for(int face = 0; face < lightDetails_geometry[light].vpMatrixCount; ++face)
+    for(int face = 0; face < shadowDetails.lightDetails[light].vpMatrixCount; ++face)
     {
-      // Set the current layer of the shadow map being modified.
-      // Since shadow maps of lights are saved in arrays, we need to make sure that
-      //   the current positions are saved only for the layer in the array that this
-      //   light is associated with. So we set the base layer value as the layer
-      //   ID sent through us through the light details uniform, and then also add
-      //   in the ID of the current face we're working on, giving us the final layer-face
-      //   value to tell the geometry shader to operate in.
-      gl_Layer = lightDetails_geometry[light].layerId + face;
+      // Skip the faces the model was culled from, since it cannot cast a shadow visible in them.
+      if((geometryCasterMask[0] & (1u << uint((light * 6) + face))) == 0u)
+      {
+        continue;
+      }
+
+      // The shadow maps of cone lights are tiles of a single shadow atlas, so instead of
+      //   picking a layer, the positions are moved into the tile of the light.
+      vec4 shadowMapRect = shadowDetails.lightDetails[light].shadowMapRect;
       // Iterate through each vertex in the input triangle.
       for(int i = 0; i < 3; ++i)
       {
@@ -61,7 +75,17 @@ void main()
         fragmentPosition = gl_in[i].gl_Position;
         // Transform the position of the model vertex using the view and projection
         //   matrices of the light.
-        gl_Position = lightDetails_geometry[light].vpMatrices[face] * fragmentPosition;
+        vec4 position = shadowDetails.lightDetails[light].vpMatrices[face] * fragmentPosition;
+        // Clip the triangle against the edges of the view of the light, since the
+        //   viewport covers the whole atlas and would not clip it to the tile.
+        gl_ClipDistance[0] = position.w + position.x;
+        gl_ClipDistance[1] = position.w - position.x;
+        gl_ClipDistance[2] = position.w + position.y;
+        gl_ClipDistance[3] = position.w - position.y;
+        // Scale and offset the position from the view of the light into its tile
+        //   (done before the perspective division, so the offset is scaled by w).
+        position.xy = (position.xy * shadowMapRect.zw) + (((shadowMapRect.xy * 2.0) + shadowMapRect.zw - 1.0) * position.w);
+        gl_Position = position;
         // Emit the resultant model vertex.
         EmitVertex();
       }
@@ -14,25 +14,40 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_LIGHTS 5
+// MAX_SHADOW_LIGHTS and POINT_SHADOW_MAX_VERTICES are defined by the shader manager from the engine limits.
 
 // The type of the primitive being accepted by the geometry shader.
 layout (triangles) in;
 // The type of the primitive being outputed by the geometry shader.
-layout (triangle_strip, max_vertices=18) out;
+// A triangle can be emitted once for each face of each light (MAX_SHADOW_LIGHTS * 6 * 3 vertices, defined as a literal
+//   by the shader manager since the layout qualifiers take no expressions).
+layout (triangle_strip, max_vertices=POINT_SHADOW_MAX_VERTICES) out;
 
 // The structure defining the details regarding the light.
-struct LightDetails_Geometry
+// The layout matches the ShadowLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-  int layerId;
-  vec3 lightPosition;
   mat4 vpMatrices[6];
+  vec4 lightPosition;
+  int layerId;
   int vpMatrixCount;
+  float nearPlane;
+  float farPlane;
+  vec4 shadowMapRect;
 };
 
-// The details of the current light.
-uniform LightDetails_Geometry lightDetails_geometry[MAX_LIGHTS];
-uniform int lightsCount;
+// The details of all the lights rendering to the current shadow buffer, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform ShadowDetails
+{
+  LightDetails lightDetails[MAX_SHADOW_LIGHTS];
+  int lightsCount;
+  float animationTime;
+} shadowDetails;
+
+// The mask of the shadow map faces the model casts shadows into (a bit per light per face).
+flat in uint geometryCasterMask[];
 
 // The vertex position being used to interpolate fragments.
 out vec4 fragmentPosition;
@@ -41,12 +56,18 @@ out float lightIndex;
 
 void main()
 {
-  for(int light = 0; light < lightsCount; light++)
+  for(int light = 0; light < shadowDetails.lightsCount; light++)
   {
     // Generate the vertex position for each face of the light's shadow map.
     // For point lights, this will be 6 faces, for other maps it is just 1 face.
-    for(int face = 0; face < lightDetails_geometry[light].vpMatrixCount; ++face)
+    for(int face = 0; face < shadowDetails.lightDetails[light].vpMatrixCount; ++face)
     {
+      // Skip the faces the model was culled from, since it cannot cast a shadow visible in them.
+      if((geometryCasterMask[0] & (1u << uint((light * 6) + face))) == 0u)
+      {
+        continue;
+      }
+
       // Set the current layer of the shadow map being modified.
       // Since shadow maps of lights are saved in arrays, we need to make sure that
       //   the current positions are saved only for the layer in the array that this
@@ -54,7 +75,7 @@ void main()
       //   ID sent through us through the light details uniform, and then also add
       //   in the ID of the current face we're working on, giving us the final layer-face
       //   value to tell the geometry shader to operate in.
-      gl_Layer = lightDetails_geometry[light].layerId + face;
+      gl_Layer = shadowDetails.lightDetails[light].layerId + face;
       // Iterate through each vertex in the input triangle.
       for(int i = 0; i < 3; ++i)
       {
@@ -64,7 +85,7 @@ void main()
         lightIndex = float(light);
         // Transform the position of the model vertex using the view and projection
         //   matrices of the light.
-        gl_Position = lightDetails_geometry[light].vpMatrices[face] * fragmentPosition;
+        gl_Position = shadowDetails.lightDetails[light].vpMatrices[face] * fragmentPosition;
         // Emit the resultant model vertex.
         EmitVertex();
       }
@@ -0,0 +1,20 @@
+#version 330 core
+
+// The position of the line vertex (already in world-space).
+layout(location = 0) in vec3 vertexPosition;
+// The color of the line vertex.
+layout(location = 1) in vec4 vertexColor;
+
+// The view-projection matrix of the camera.
+uniform mat4 viewProjectionMatrix;
+
+// The color of the line, passed on to the fragment shader.
+out vec4 lineColor;
+
+void main()
+{
+	// Transform the line vertex based on the view and projection of the camera,
+	//   and return that as the vertex position.
+	gl_Position = viewProjectionMatrix * vec4(vertexPosition, 1.0);
+	lineColor = vertexColor;
+}
@@ -14,8 +14,7 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_SIMPLE_LIGHTS 2
-#define MAX_CUBE_LIGHTS 5
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
 
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
@@ -23,6 +22,21 @@ layout(location = 0) in vec3 vertexPosition;
 layout(location = 1) in vec2 vertexUv;
 // The vertex normal vector attribute of the model.
 layout(location = 2) in vec3 vertexNormal;
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), so that all the
+//   models of the same type can be drawn with a single draw call.
+layout(location = 3) in mat4 modelMatrix;
+// The mask of the lights reaching the model, with a bit per cone light followed by
+//   a bit per point light from bit 8. This is also a per-instance attribute, so that
+//   the lights that cannot reach the model are skipped.
+layout(location = 9) in uint lightMask;
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+// The layer of the texture array containing the diffuse texture of the model. This is also a per-instance attribute,
+//   so that the models of different types sharing a texture array can be drawn together.
+layout(location = 10) in uint textureLayer;
+// The layer passed on to the fragment shader as is.
+flat out float fragmentTextureLayer;
+#endif
 
 // The UV coordinates of the diffuse color of the fragment in the standard object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
@@ -36,6 +50,8 @@ out vec4 fragmentPosition_viewSpace;
 // The normal vector of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 out vec3 fragmentNormal_viewSpace;
+// The mask of the lights reaching the model passed on to the fragment shader as is.
+flat out uint fragmentLightMask;
 
 // The shadow map coordinates of the current fragment w.r.t all the active cone lights.
 out vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
@@ -47,76 +63,114 @@ out vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
 // Since this value would be the same for all vertices, interpolation won't affect anything.
 out vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Vertex
-{
-	mat4 modelMatrix;
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
-};
+// Keep the vertex position computation bit-identical across programs, so that this
+//   shader can depth test against the depth pre-pass with GL_EQUAL.
+invariant gl_Position;
 
 // The structure defining the details regarding the active lights.
-struct LightDetails_Vertex
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-	vec3 lightPosition;
 	mat4 lightVpMatrix;
-	// vec3 lightColor;
-	// float lightIntensity;
-	// float nearPlane;
-	// float farPlane;
-	// int layerId;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
+	float farPlane;
+	int layerId;
+	vec4 shadowMapRect;
 };
 
-
-// The details of the model.
-uniform ModelDetails_Vertex modelDetails_vertex;
-
-// The number of active cone lights (2D texture lights).
-uniform int coneLightsCount;
-// The number of active point lights (cubemap texture lights).
-uniform int pointLightsCount;
-
-// The details of the active cone lights (2D texture lights).
-uniform LightDetails_Vertex coneLightDetails_vertex[MAX_SIMPLE_LIGHTS];
-// The details of the active point lights (cubemap texture lights).
-uniform LightDetails_Vertex pointLightDetails_vertex[MAX_CUBE_LIGHTS];
+// The frame-constant details shared by all the models, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
+
+// The light counts are read from the frame details, unless the shader is compiled as a variant, in which
+//   case they are defined as constants so that the compiler can unroll the light loops.
+#ifndef SHADER_VARIANT
+#define CONE_LIGHTS_COUNT frameDetails.coneLightsCount
+#define POINT_LIGHTS_COUNT frameDetails.pointLightsCount
+#endif
+
+// Get the model matrix of the instance spun to the given time. The spin of the model about its local Y axis (the speed
+//   in radians per second, then the angle at time 0) is packed into the bottom row of the model matrix, left unused
+//   by the affine model transformations, and is zero for the models that do not spin.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+	float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+	float spinSin = sin(spinAngle);
+	float spinCos = cos(spinAngle);
+	mat4 spunModelMatrix = packedModelMatrix;
+	spunModelMatrix[0][3] = 0.0;
+	spunModelMatrix[1][3] = 0.0;
+	return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
 
 void main()
 {
+	// Spin the model to the time of the frame.
+	mat4 spunModelMatrix = getSpunModelMatrix(modelMatrix, frameDetails.animationDetails.x);
+
 	// Calculate the position of the model vertex in world-space.
-	vec4 vertexPosition_worldSpace = modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+	vec4 vertexPosition_worldSpace = spunModelMatrix * vec4(vertexPosition, 1.0);
 
 	// Transform the model vertex from view-space using the projection matrix of the camera,
 	//   and set that as the position of the vertex.
-	gl_Position = modelDetails_vertex.projectionMatrix * modelDetails_vertex.viewMatrix * vertexPosition_worldSpace;
+	gl_Position = frameDetails.viewProjectionMatrix * vertexPosition_worldSpace;
 
 	// Calculate the direction of the vertex normal in view-space.
-	vec3 vertexNormal_viewSpace = (modelDetails_vertex.viewMatrix * modelDetails_vertex.modelMatrix * vec4(vertexNormal, 0.0)).xyz;
+	vec3 vertexNormal_viewSpace = (frameDetails.viewMatrix * spunModelMatrix * vec4(vertexNormal, 0.0)).xyz;
 
 	// Set the value of the UV coordinate of all fragments that are interpolated through this vertex.
 	fragmentUv = vertexUv;
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+	// Set the layer of the diffuse texture for all the fragments.
+	fragmentTextureLayer = float(textureLayer);
+#endif
 	// Set the value of the world-space position of all fragments that are interpolated through this vertex.
 	fragmentPosition_worldSpace = vertexPosition_worldSpace;
 	// Set the value of the view-space normal vector of all fragments that are interpolated through this vertex.
 	fragmentNormal_viewSpace = vertexNormal_viewSpace;
 
 	// Calculate the position of the current fragment in view-space.
-	fragmentPosition_viewSpace = modelDetails_vertex.viewMatrix * vertexPosition_worldSpace;
+	fragmentPosition_viewSpace = frameDetails.viewMatrix * vertexPosition_worldSpace;
+	// Set the mask of the lights reaching the model for all the fragments.
+	fragmentLightMask = lightMask;
 
 	// Iterate through all the active cone lights.
-	for (int lightIndex = 0; lightIndex < coneLightsCount; lightIndex++)
+	for (int lightIndex = 0; lightIndex < CONE_LIGHTS_COUNT; lightIndex++)
 	{
+		// Skip the lights that cannot reach the model, since the fragment shader skips them too.
+		if ((lightMask & (1u << uint(lightIndex))) == 0u)
+		{
+			continue;
+		}
+
 		// Calculate the position of the light in view-space.
-		coneLightPosition_viewSpace[lightIndex] = modelDetails_vertex.viewMatrix * vec4(coneLightDetails_vertex[lightIndex].lightPosition, 1.0);
+		coneLightPosition_viewSpace[lightIndex] = frameDetails.viewMatrix * vec4(frameDetails.coneLightDetails[lightIndex].lightPosition.xyz, 1.0);
 
 		// Calculate the depth of the interpolated fragment w.r.t to the light source (without accounting for perspective division).
-		coneLightShadowMapCoord[lightIndex] = coneLightDetails_vertex[lightIndex].lightVpMatrix * modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+		coneLightShadowMapCoord[lightIndex] = frameDetails.coneLightDetails[lightIndex].lightVpMatrix * spunModelMatrix * vec4(vertexPosition, 1.0);
 	}
 
 	// Iterate through all the active point lights.
-	for (int lightIndex = 0; lightIndex < pointLightsCount; lightIndex++)
+	for (int lightIndex = 0; lightIndex < POINT_LIGHTS_COUNT; lightIndex++)
 	{
 		// Calculate the position of the light in view-space.
-		pointLightPosition_viewSpace[lightIndex] = modelDetails_vertex.viewMatrix * vec4(pointLightDetails_vertex[lightIndex].lightPosition, 1.0);
+		pointLightPosition_viewSpace[lightIndex] = frameDetails.viewMatrix * vec4(frameDetails.pointLightDetails[lightIndex].lightPosition.xyz, 1.0);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#version 330 core
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
+
+// The vertex position attribute of the model.
+layout(location = 0) in vec3 vertexPosition;
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), so that all the
+//   models of the same type can be drawn with a single draw call.
+layout(location = 3) in mat4 modelMatrix;
+
+// Keep the vertex position computation bit-identical across programs, so that the
+//   lit pass can depth test against the depth pre-pass with GL_EQUAL.
+invariant gl_Position;
+
+// The structure defining the details regarding the active lights.
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
+{
+	mat4 lightVpMatrix;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
+	float farPlane;
+	int layerId;
+	vec4 shadowMapRect;
+};
+
+// The frame-constant details shared by all the models, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
+
+// Get the model matrix of the instance spun to the given time. The spin of the model about its local Y axis (the speed
+//   in radians per second, then the angle at time 0) is packed into the bottom row of the model matrix, left unused
+//   by the affine model transformations, and is zero for the models that do not spin.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+	float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+	float spinSin = sin(spinAngle);
+	float spinCos = cos(spinAngle);
+	mat4 spunModelMatrix = packedModelMatrix;
+	spunModelMatrix[0][3] = 0.0;
+	spunModelMatrix[1][3] = 0.0;
+	return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+void main()
+{
+	// Transform the model vertex into world-space, and then further transform it
+	//   based on the view and projection of the camera, and return that as the
+	//   vertex position. This must match the computation in the model shaders exactly.
+	vec4 vertexPosition_worldSpace = getSpunModelMatrix(modelMatrix, frameDetails.animationDetails.x) * vec4(vertexPosition, 1.0);
+	gl_Position = frameDetails.viewProjectionMatrix * vertexPosition_worldSpace;
+}
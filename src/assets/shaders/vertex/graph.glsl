@@ -0,0 +1,15 @@
+#version 330 core
+
+// The point of the graph, from 0 to 1 across the graph and in milliseconds up it.
+layout(location = 0) in vec2 graphPoint;
+
+// The corners of the graph on the window with the smallest and largest coordinates (in normalized device coordinates).
+uniform vec4 graphRect;
+// The time at the top of the graph, which the longer times are clamped to (in milliseconds).
+uniform float maxTime;
+
+void main()
+{
+    vec2 graphPosition = vec2(graphPoint.x, min(graphPoint.y / maxTime, 1.0));
+    gl_Position = vec4(mix(graphRect.xy, graphRect.zw, graphPosition), 0.0, 1.0);
+}
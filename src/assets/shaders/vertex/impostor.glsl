@@ -0,0 +1,121 @@
+#version 330 core
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
+
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), read from the same
+//   model matrix buffer as the model render, so that all the impostors of the same type
+//   are drawn with a single draw call. The corners of the billboards come from the vertex IDs.
+layout(location = 3) in mat4 modelMatrix;
+// The mask of the lights reaching the model, also a per-instance attribute.
+layout(location = 9) in uint lightMask;
+
+// The center of the bounds of the object in model-space, with their radius in W.
+uniform vec4 impostorBounds;
+// The number of views baked into the atlas around the up axis of the object, and from below to above it.
+uniform ivec2 impostorViewCounts;
+
+// The UV coordinates of the fragment in the atlas, inside the cell of the view picked.
+out vec2 fragmentUv;
+// The position of the fragment on the plane of the billboard in world-space.
+out vec3 fragmentPosition_worldSpace;
+// The offset in world-space of the baked depth of 1, towards the view the billboard is drawn from.
+flat out vec3 fragmentDepthAxis_worldSpace;
+// The matrix transforming the baked normals from model-space to view-space.
+flat out mat3 fragmentNormalMatrix;
+// The mask of the lights reaching the model passed on to the fragment shader as is.
+flat out uint fragmentLightMask;
+
+// The structure defining the details regarding the active lights.
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
+{
+	mat4 lightVpMatrix;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
+	float farPlane;
+	int layerId;
+	vec4 shadowMapRect;
+};
+
+// The frame-constant details shared by all the models, written once per frame.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
+
+const float PI = 3.14159265;
+
+// Get the model matrix of the instance spun to the given time, the same way the default vertex shader does.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+	float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+	float spinSin = sin(spinAngle);
+	float spinCos = cos(spinAngle);
+	mat4 spunModelMatrix = packedModelMatrix;
+	spunModelMatrix[0][3] = 0.0;
+	spunModelMatrix[1][3] = 0.0;
+	return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+void main()
+{
+	// Spin the model to the time of the frame.
+	mat4 spunModelMatrix = getSpunModelMatrix(modelMatrix, frameDetails.animationDetails.x);
+
+	// Find the direction the camera sees the model from in model-space.
+	vec3 center_worldSpace = (spunModelMatrix * vec4(impostorBounds.xyz, 1.0)).xyz;
+	vec3 cameraPosition_worldSpace = inverse(frameDetails.viewMatrix)[3].xyz;
+	vec3 viewDirection_modelSpace = normalize(inverse(mat3(spunModelMatrix)) * (cameraPosition_worldSpace - center_worldSpace));
+
+	// Pick the closest of the baked views, the columns going around the up axis of the object and the rows from below to above it,
+	//   and find the direction it was baked from.
+	float yaw = atan(viewDirection_modelSpace.x, viewDirection_modelSpace.z);
+	int column = int(floor(((yaw / (2.0 * PI)) * float(impostorViewCounts.x)) + 0.5));
+	column = ((column % impostorViewCounts.x) + impostorViewCounts.x) % impostorViewCounts.x;
+	float elevation = asin(clamp(viewDirection_modelSpace.y, -1.0, 1.0));
+	int row = clamp(int(floor(((elevation / PI) + 0.5) * float(impostorViewCounts.y))), 0, impostorViewCounts.y - 1);
+	float bakedYaw = (float(column) * 2.0 * PI) / float(impostorViewCounts.x);
+	float bakedElevation = (((float(row) + 0.5) / float(impostorViewCounts.y)) - 0.5) * PI;
+	vec3 bakedDirection = vec3(cos(bakedElevation) * sin(bakedYaw), sin(bakedElevation), cos(bakedElevation) * cos(bakedYaw));
+
+	// Span the billboard over the bounds, facing the baked view with the same right and up axes as the view it was baked with.
+	vec3 right = normalize(cross(-bakedDirection, vec3(0.0, 1.0, 0.0)));
+	vec3 up = cross(right, -bakedDirection);
+	vec2 corner = (vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0) - 1.0;
+	vec3 corner_modelSpace = impostorBounds.xyz + (((right * corner.x) + (up * corner.y)) * impostorBounds.w);
+	vec4 corner_worldSpace = spunModelMatrix * vec4(corner_modelSpace, 1.0);
+	gl_Position = frameDetails.viewProjectionMatrix * corner_worldSpace;
+
+	// Pass on the corner of the cell of the view in the atlas, and how to place the baked surface in the scene.
+	fragmentUv = (vec2(float(column), float(row)) + (corner * 0.5) + 0.5) / vec2(impostorViewCounts);
+	fragmentPosition_worldSpace = corner_worldSpace.xyz;
+	fragmentDepthAxis_worldSpace = mat3(spunModelMatrix) * (bakedDirection * impostorBounds.w);
+	fragmentNormalMatrix = mat3(frameDetails.viewMatrix) * mat3(spunModelMatrix);
+	fragmentLightMask = lightMask;
+}
@@ -13,17 +13,29 @@
 // Note that for primitive uniform variables this cannot be an issue,
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
-
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
+// The vertex UV coordinate attribute of the model.
+layout(location = 1) in vec2 vertexUv;
+// The vertex normal vector attribute of the model.
+layout(location = 2) in vec3 vertexNormal;
+
+// The view-projection matrix of the orthographic view of the cell of the atlas being baked, in model-space.
+uniform mat4 impostorViewProjectionMatrix;
 
-// The model-view-projection matrix of the model against the camera.
-uniform mat4 mvpMatrix;
+// The UV coordinates of the diffuse color of the fragment in the standard object texture.
+out vec2 fragmentUv;
+// The position of the fragment in model-space.
+out vec3 fragmentPosition_modelSpace;
+// The normal vector of the fragment in model-space.
+out vec3 fragmentNormal_modelSpace;
 
 void main()
 {
-	// Transform the model vertex using the model-view-projection matrix,
-	//   and return that as the vertex position.
-	gl_Position = mvpMatrix * vec4(vertexPosition, 1.0);
-}
+	// Project the vertex into the cell of the atlas, the model being baked without its model matrix.
+	gl_Position = impostorViewProjectionMatrix * vec4(vertexPosition, 1.0);
 
+	fragmentUv = vertexUv;
+	fragmentPosition_modelSpace = vertexPosition;
+	fragmentNormal_modelSpace = vertexNormal;
+}
@@ -14,14 +14,64 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
+// MAX_SHADOW_LIGHTS is defined by the shader manager from the engine limits.
+
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
 
 // The transformation matrix to transform the model into world-space.
-uniform mat4 modelMatrix;
+// This is a per-instance attribute (taking up locations 3 to 6), so that all the
+//   models of the same type can be drawn with a single draw call.
+layout(location = 3) in mat4 modelMatrix;
+// The mask of the shadow map faces the model casts shadows into, with a bit per
+//   light per face (light * 6 + face). This is also a per-instance attribute, so that
+//   the geometry shader only emits the model into the faces it can be seen in.
+layout(location = 7) in uint casterMask;
+
+// The caster mask of the model passed on to the geometry shader.
+flat out uint geometryCasterMask;
+
+// The structure defining the details regarding the light.
+// The layout matches the ShadowLightData structure in the uniform buffer manager.
+struct LightDetails
+{
+  mat4 vpMatrices[6];
+  vec4 lightPosition;
+  int layerId;
+  int vpMatrixCount;
+  float nearPlane;
+  float farPlane;
+  vec4 shadowMapRect;
+};
+
+// The details of all the lights rendering to the current shadow buffer, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform ShadowDetails
+{
+  LightDetails lightDetails[MAX_SHADOW_LIGHTS];
+  int lightsCount;
+  float animationTime;
+} shadowDetails;
+
+// Get the model matrix of the instance spun to the given time. The spin of the model about its local Y axis (the speed
+//   in radians per second, then the angle at time 0) is packed into the bottom row of the model matrix, left unused
+//   by the affine model transformations, and is zero for the models that do not spin.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+	float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+	float spinSin = sin(spinAngle);
+	float spinCos = cos(spinAngle);
+	mat4 spunModelMatrix = packedModelMatrix;
+	spunModelMatrix[0][3] = 0.0;
+	spunModelMatrix[1][3] = 0.0;
+	return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
 
 void main()
 {
 	// Transform the model vertex into world-space, and return that as the vertex position.
-	gl_Position = modelMatrix * vec4(vertexPosition, 1.0);
+	gl_Position = getSpunModelMatrix(modelMatrix, shadowDetails.animationTime) * vec4(vertexPosition, 1.0);
+	// Pass the caster mask of the model on as is.
+	geometryCasterMask = casterMask;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 330 core
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+// The box is drawn as 12 triangles from the vertex IDs, without vertex attributes.
+// The corners of the box are numbered by their coordinates, the X, Y and Z of a corner being
+//   the max-corner if bit 0, 1 and 2 of its number is set, and the triangles wind counter-clockwise
+//   seen from outside the box, so that only the faces towards the camera are drawn.
+const int BOX_CORNERS[36] = int[36](0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3, 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6);
+
+// The view-projection matrix of the camera.
+uniform mat4 viewProjectionMatrix;
+// The corners of the world AABB queried with the smallest and largest coordinates.
+uniform vec4 boxMinCorner;
+uniform vec4 boxMaxCorner;
+
+void main()
+{
+	int corner = BOX_CORNERS[gl_VertexID];
+	vec3 cornerPosition_worldSpace = mix(boxMinCorner.xyz, boxMaxCorner.xyz, vec3(float(corner & 1), float((corner >> 1) & 1), float((corner >> 2) & 1)));
+	gl_Position = viewProjectionMatrix * vec4(cornerPosition_worldSpace, 1.0);
+}
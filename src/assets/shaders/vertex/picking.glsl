@@ -0,0 +1,56 @@
+#version 330 core
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+
+// The vertex position attribute of the model.
+layout(location = 0) in vec3 vertexPosition;
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), read from the same
+//   model matrix buffer as the model render, so that the IDs of all the models of the
+//   same type are drawn with a single draw call per level of detail.
+layout(location = 3) in mat4 modelMatrix;
+
+// The view-projection matrix of the camera.
+uniform mat4 viewProjectionMatrix;
+// The time the spinning models are animated to.
+uniform float animationTime;
+// The ID of the first instance of the draw call, the IDs of the other instances following it.
+uniform int firstPickId;
+
+// The ID of the model, passed as is to the fragments of its triangles.
+flat out uint modelPickId;
+
+// Get the model matrix of the instance spun to the given time. The spin of the model about its local Y axis (the speed
+//   in radians per second, then the angle at time 0) is packed into the bottom row of the model matrix, left unused
+//   by the affine model transformations, and is zero for the models that do not spin.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+	float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+	float spinSin = sin(spinAngle);
+	float spinCos = cos(spinAngle);
+	mat4 spunModelMatrix = packedModelMatrix;
+	spunModelMatrix[0][3] = 0.0;
+	spunModelMatrix[1][3] = 0.0;
+	return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+void main()
+{
+	// Transform the model vertex into world-space, then based on the view and projection
+	//   of the camera, and return that as the vertex position.
+	gl_Position = viewProjectionMatrix * getSpunModelMatrix(modelMatrix, animationTime) * vec4(vertexPosition, 1.0);
+	modelPickId = uint(firstPickId + gl_InstanceID);
+}
+
@@ -0,0 +1,94 @@
+#version 330 core
+// Either extension lets the vertex shader pick the layer of the shadow map to draw to.
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+
+// This shader replaces the light base vertex shader and the point light geometry
+//   shader when the vertex shader layer output is supported, drawing each model
+//   once per shadow map face it is seen in through instancing, instead of having
+//   the geometry shader emit every triangle into every face.
+
+// MAX_SHADOW_LIGHTS is defined by the shader manager from the engine limits.
+
+// The vertex position attribute of the model.
+layout(location = 0) in vec3 vertexPosition;
+
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), repeated for
+//   every face the model is drawn into.
+layout(location = 3) in mat4 modelMatrix;
+// The shadow map face the instance is drawn into (light * 6 + face). This is
+//   also a per-instance attribute, with one instance per face of each model.
+layout(location = 8) in uint casterFace;
+
+// The structure defining the details regarding the light.
+// The layout matches the ShadowLightData structure in the uniform buffer manager.
+struct LightDetails
+{
+  mat4 vpMatrices[6];
+  vec4 lightPosition;
+  int layerId;
+  int vpMatrixCount;
+  float nearPlane;
+  float farPlane;
+  vec4 shadowMapRect;
+};
+
+// The details of all the lights rendering to the current shadow buffer, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform ShadowDetails
+{
+  LightDetails lightDetails[MAX_SHADOW_LIGHTS];
+  int lightsCount;
+  float animationTime;
+} shadowDetails;
+
+// The vertex position being used to interpolate fragments.
+out vec4 fragmentPosition;
+// The index of the light for that fragment.
+out float lightIndex;
+
+// Get the model matrix of the instance spun to the given time. The spin of the model about its local Y axis (the speed
+//   in radians per second, then the angle at time 0) is packed into the bottom row of the model matrix, left unused
+//   by the affine model transformations, and is zero for the models that do not spin.
+mat4 getSpunModelMatrix(mat4 packedModelMatrix, float animationTime)
+{
+  float spinAngle = packedModelMatrix[1][3] + (packedModelMatrix[0][3] * animationTime);
+  float spinSin = sin(spinAngle);
+  float spinCos = cos(spinAngle);
+  mat4 spunModelMatrix = packedModelMatrix;
+  spunModelMatrix[0][3] = 0.0;
+  spunModelMatrix[1][3] = 0.0;
+  return spunModelMatrix * mat4(vec4(spinCos, 0.0, -spinSin, 0.0), vec4(0.0, 1.0, 0.0, 0.0), vec4(spinSin, 0.0, spinCos, 0.0), vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+void main()
+{
+  int light = int(casterFace / 6u);
+  int face = int(casterFace % 6u);
+
+  // Set the layer of the shadow map being drawn to, which is the base layer of
+  //   the light offset by the face (the same as the geometry shader does).
+  gl_Layer = shadowDetails.lightDetails[light].layerId + face;
+  // Transform the model vertex into world-space for calculating the light distance.
+  fragmentPosition = getSpunModelMatrix(modelMatrix, shadowDetails.animationTime) * vec4(vertexPosition, 1.0);
+  lightIndex = float(light);
+  // Transform the position of the model vertex using the view and projection
+  //   matrices of the face of the light.
+  gl_Position = shadowDetails.lightDetails[light].vpMatrices[face] * fragmentPosition;
+}
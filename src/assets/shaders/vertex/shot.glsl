@@ -14,36 +14,79 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
+// MAX_SIMPLE_LIGHTS and MAX_CUBE_LIGHTS are defined by the shader manager from the engine limits.
+
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
 // The vertex UV coordinate attribute of the model.
 layout(location = 1) in vec2 vertexUv;
 // The vertex normal vector attribute of the model.
 layout(location = 2) in vec3 vertexNormal;
+// The transformation matrix to transform the model into world-space.
+// This is a per-instance attribute (taking up locations 3 to 6), so that all the
+//   models of the same type can be drawn with a single draw call.
+layout(location = 3) in mat4 modelMatrix;
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+// The layer of the texture array containing the diffuse texture of the model. This is also a per-instance attribute,
+//   so that the models of different types sharing a texture array can be drawn together.
+layout(location = 10) in uint textureLayer;
+// The layer passed on to the fragment shader as is.
+flat out float fragmentTextureLayer;
+#endif
 
 // The UV coordinates of the diffuse color of the fragment in the shot object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 out vec2 fragmentUv;
 
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Vertex
+// Keep the vertex position computation bit-identical across programs, so that this
+//   shader can depth test against the depth pre-pass with GL_EQUAL.
+invariant gl_Position;
+
+// The structure defining the details regarding the active lights.
+// The layout matches the FrameLightData structure in the uniform buffer manager.
+struct LightDetails
 {
-	mat4 modelMatrix;
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
+	mat4 lightVpMatrix;
+	vec4 lightPosition;
+	vec4 lightColorIntensity;
+	float nearPlane;
+	float farPlane;
+	int layerId;
+	vec4 shadowMapRect;
 };
 
-// The details of the model.
-uniform ModelDetails_Vertex modelDetails_vertex;
+// The frame-constant details shared by all the models, written once per frame.
+// Since std140 uniform blocks never have their members removed, the same definition
+//   can be used in every shader component without the suffixing described above.
+layout(std140) uniform FrameDetails
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	float ambientFactor;
+	int disableFeatureMask;
+	int coneLightsCount;
+	int pointLightsCount;
+	ivec4 clusterDetails;
+	vec4 clusterDepthDetails;
+	vec4 animationDetails;
+} frameDetails;
 
 void main()
 {
 	// Transform the model vertex into world-space, and then further transform it
 	//   based on the view and projection of the camera, and return that as the
-	//   vertex position.
-	gl_Position = modelDetails_vertex.projectionMatrix * modelDetails_vertex.viewMatrix * modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+	//   vertex position (computed the same way as in the depth pre-pass shader).
+	vec4 vertexPosition_worldSpace = modelMatrix * vec4(vertexPosition, 1.0);
+	gl_Position = frameDetails.viewProjectionMatrix * vertexPosition_worldSpace;
 
 	// Set the value of the UV coordinate of all fragments that are interpolated through this vertex.
 	fragmentUv = vertexUv;
+#ifdef IS_DIFFUSE_TEXTURE_ARRAY
+	// Set the layer of the diffuse texture for all the fragments.
+	fragmentTextureLayer = float(textureLayer);
+#endif
 }
\ No newline at end of file
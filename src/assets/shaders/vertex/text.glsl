@@ -1,17 +1,21 @@
 #version 330 core
 
-layout (location = 0) in vec2 vertexPosition;
-layout (location = 1) in vec2 vertexUv;
-layout (location = 2) in float vertexUvLayer;
+layout (location = 0) in vec2 glyphPosition;
+layout (location = 1) in vec2 glyphSize;
+layout (location = 2) in vec2 glyphAtlasMin;
+layout (location = 3) in vec2 glyphAtlasMax;
 
 out vec2 fragmentUv;
-out float fragmentUvLayer;
 
+// The size of the glyph atlas (in texels), which the atlas rectangles of the glyphs are normalized with.
+uniform vec2 atlasSize;
 uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * vec4(vertexPosition.xy, 1.0, 1.0);
-    fragmentUv = vertexUv;
-    fragmentUvLayer = vertexUvLayer;
+    // Find the corner of the unit quad from the vertex ID (drawn as a triangle strip), and place it over the glyph.
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = projection * vec4(glyphPosition + (corner * glyphSize), 1.0, 1.0);
+    // The glyph bitmaps are stored top row first, so the top of the quad samples the top of the atlas rectangle.
+    fragmentUv = mix(glyphAtlasMin, glyphAtlasMax, vec2(corner.x, 1.0 - corner.y)) / atlasSize;
 }
\ No newline at end of file
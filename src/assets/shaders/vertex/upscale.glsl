@@ -0,0 +1,11 @@
+#version 330 core
+
+out vec2 fragmentUv;
+
+void main()
+{
+    // Draw a single triangle covering the whole window, with its vertices found from their IDs.
+    vec2 vertexPosition = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4((vertexPosition * 2.0) - 1.0, 0.0, 1.0);
+    fragmentUv = vertexPosition;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef BENCH_BENCH_REPORT_CPP
+#define BENCH_BENCH_REPORT_CPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+#include "../include/allocation_tracker.cpp"
+
+/**
+ * Enum for defining the formats the benchmark results can be printed in.
+ */
+enum BenchReportFormat
+{
+  // Human readable lines.
+  TEXT,
+  // A header line, followed by a line of comma separated values per result.
+  CSV,
+  // An array of objects, one per result.
+  JSON,
+};
+
+/**
+ * Structure for defining the result of a single benchmark.
+ */
+struct BenchResult
+{
+  // The name of the benchmark.
+  std::string name;
+  // The variant of the benchmark, such as the broadphase or the shapes it ran with.
+  std::string variant;
+  // The size of the input the benchmark ran with (colliders, bytes, etc.).
+  size_t count;
+  // The number of operations timed.
+  uint64_t operations;
+  // The average time taken by an operation.
+  double nanosecondsPerOperation;
+  // The average number of heap allocations made by an operation.
+  double allocationsPerOperation;
+  // A count the benchmark produced (hits, pairs, etc.), to check that the variants agree and that nothing was optimized away.
+  uint64_t checksum;
+};
+
+/**
+ * Class for collecting the benchmark results and printing them once all benchmarks are done.
+ */
+class BenchReport
+{
+private:
+  // The format the results are printed in.
+  const BenchReportFormat format;
+  // The collected results.
+  std::vector<BenchResult> results;
+
+public:
+  BenchReport(const BenchReportFormat &format)
+      : format(format),
+        results({}) {}
+
+  /**
+   * Add a result to the report.
+   * 
+   * @param result  The result of a benchmark.
+   */
+  void addResult(const BenchResult &result)
+  {
+    results.push_back(result);
+  }
+
+  /**
+   * Print all the collected results to the standard output in the format of the report.
+   */
+  void print() const
+  {
+    switch (format)
+    {
+    case BenchReportFormat::CSV:
+      std::cout << "name,variant,count,operations,ns_per_op,allocs_per_op,checksum" << std::endl;
+      for (const auto &result : results)
+      {
+        std::cout << result.name << "," << result.variant << "," << result.count << "," << result.operations << "," << result.nanosecondsPerOperation << "," << result.allocationsPerOperation << "," << result.checksum << std::endl;
+      }
+      break;
+    case BenchReportFormat::JSON:
+      std::cout << "[" << std::endl;
+      for (size_t i = 0; i < results.size(); i++)
+      {
+        const auto &result = results[i];
+        std::cout << "  {\"name\": \"" << result.name << "\", \"variant\": \"" << result.variant << "\", \"count\": " << result.count
+                  << ", \"operations\": " << result.operations << ", \"ns_per_op\": " << result.nanosecondsPerOperation
+                  << ", \"allocs_per_op\": " << result.allocationsPerOperation << ", \"checksum\": " << result.checksum << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+      }
+      std::cout << "]" << std::endl;
+      break;
+    default:
+      for (const auto &result : results)
+      {
+        std::cout << result.name << " (" << result.variant << ", " << result.count << "): " << result.nanosecondsPerOperation << " ns/op, "
+                  << result.allocationsPerOperation << " allocs/op over " << result.operations << " ops, checksum " << result.checksum << std::endl;
+      }
+    }
+  }
+};
+
+/**
+ * Structure for defining the timing of the runs of a benchmark body.
+ */
+struct BenchTiming
+{
+  // The average time taken by an operation.
+  double nanosecondsPerOperation;
+  // The number of operations timed.
+  uint64_t operations;
+  // The average number of heap allocations made by an operation.
+  double allocationsPerOperation;
+};
+
+/**
+ * Time the given benchmark body, running it again until enough time has passed for a stable average.
+ * 
+ * @param operationsPerRun  The number of operations a single run of the body performs.
+ * @param checksum          Set to the checksum returned by the last run of the body.
+ * @param run               The benchmark body, returning its checksum.
+ * @param minimumSeconds    The least time to keep running the body for.
+ * 
+ * @return The average time and allocations of an operation, and the number of operations timed.
+ */
+template <typename BenchRun>
+BenchTiming timeBenchRuns(const uint64_t &operationsPerRun, uint64_t &checksum, const BenchRun &run, const double &minimumSeconds = 0.2)
+{
+  uint64_t runs = 0;
+  const auto startAllocationsCount = AllocationTracker::getAllocationsCount();
+  const auto startTime = std::chrono::steady_clock::now();
+  auto elapsedSeconds = 0.0;
+  do
+  {
+    checksum = run();
+    runs++;
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  } while (elapsedSeconds < minimumSeconds);
+  const auto allocationsCount = AllocationTracker::getAllocationsCount() - startAllocationsCount;
+
+  const auto operations = runs * std::max<uint64_t>(operationsPerRun, 1);
+  return {(elapsedSeconds * 1e9) / operations, operations, static_cast<double>(allocationsCount) / operations};
+}
+
+#endif
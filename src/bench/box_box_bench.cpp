@@ -0,0 +1,118 @@
+#ifndef BENCH_BOX_BOX_BENCH_CPP
+#define BENCH_BOX_BOX_BENCH_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "../include/collider.cpp"
+
+#include "bench_report.cpp"
+
+/**
+ * The box-box check used before the separating axis test, kept here only to compare against. It transforms the corners of each
+ *   box into the space of the other and checks if any of them is contained, so it misses boxes that only overlap at their edges.
+ * 
+ * @param box1  The first box collider.
+ * @param box2  The second box collider.
+ * 
+ * @return Whether a corner of either box is inside the other.
+ */
+bool haveBoxBoxCornersCollided(const std::shared_ptr<const BoxColliderShape> &box1, const std::shared_ptr<const BoxColliderShape> &box2)
+{
+  // Check if the AABBs of the two boxes have collided, the same way haveShapesCollided does before the deep checks.
+  if (!box1->getTransformedBox().hasCollided(box2->getTransformedBox()))
+  {
+    return false;
+  }
+
+  const auto box1TransformationMatrix = glm::translate(box1->getPosition()) * glm::toMat4(box1->getRotation()) * glm::scale(box1->getScale()) * glm::mat4();
+  const auto box1InverseTransformationMatrix = glm::inverse(box1TransformationMatrix);
+  const auto box2TransformationMatrix = glm::translate(box2->getPosition()) * glm::toMat4(box2->getRotation()) * glm::scale(box2->getScale()) * glm::mat4();
+  const auto box2InverseTransformationMatrix = glm::inverse(box2TransformationMatrix);
+
+  // Check the corners of each box against the other box.
+  const std::shared_ptr<const BoxColliderShape> boxes[2] = {box1, box2};
+  const glm::mat4 transformationMatrices[2] = {box1TransformationMatrix, box2TransformationMatrix};
+  const glm::mat4 inverseTransformationMatrices[2] = {box2InverseTransformationMatrix, box1InverseTransformationMatrix};
+  for (auto i = 0; i < 2; i++)
+  {
+    std::vector<glm::vec3> transformedCorners({});
+    for (const auto &corner : boxes[i]->getCorners())
+    {
+      transformedCorners.push_back(glm::vec3(transformationMatrices[i] * glm::vec4(corner, 1.0f)));
+    }
+
+    const AxisAlignedBoundingBox otherBox(boxes[1 - i]->getCorners());
+    for (const auto &corner : transformedCorners)
+    {
+      const auto cornerInOtherSpace = glm::vec3(inverseTransformationMatrices[i] * glm::vec4(corner, 1.0f));
+      if (glm::all(glm::greaterThanEqual(cornerInOtherSpace, otherBox.getMinCorner())) && glm::all(glm::lessThanEqual(cornerInOtherSpace, otherBox.getMaxCorner())))
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Time the given box-box check over all the given pairs of boxes.
+ * 
+ * @param name    The name of the check, for the report.
+ * @param boxes   The boxes, checked in consecutive pairs.
+ * @param check   The box-box check.
+ * @param report  The report to add the results to, with the number of pairs hit as the checksum.
+ */
+template <typename BoxBoxCheck>
+void runBoxBoxBench(const std::string &name, const std::vector<std::shared_ptr<const BoxColliderShape>> &boxes, const BoxBoxCheck &check, BenchReport &report)
+{
+  uint64_t checksum = 0;
+  const auto timing = timeBenchRuns(boxes.size() / 2, checksum, [&]() {
+    uint64_t hits = 0;
+    for (size_t j = 0; j + 1 < boxes.size(); j += 2)
+    {
+      hits += check(boxes[j], boxes[j + 1]) ? 1 : 0;
+    }
+    return hits;
+  });
+  report.addResult({"box_box", name, boxes.size() / 2, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+}
+
+/**
+ * Compare the separating axis box-box test against the corner containment check it replaced, on random rotated boxes close
+ *   enough to each other that most pairs need the deep check.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runBoxBoxBenches(BenchReport &report)
+{
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float_t> positionDistribution(-1.5f, 1.5f);
+  std::uniform_real_distribution<float_t> angleDistribution(0.0f, glm::two_pi<float_t>());
+  std::uniform_real_distribution<float_t> sizeDistribution(0.2f, 1.5f);
+
+  std::vector<std::shared_ptr<const BoxColliderShape>> boxes;
+  for (auto i = 0; i < 4096; i++)
+  {
+    const auto halfSize = glm::vec3(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+    boxes.push_back(std::make_shared<const BoxColliderShape>(
+        glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random)),
+        glm::quat(glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random))),
+        glm::vec3(1.0f),
+        -halfSize, halfSize));
+  }
+
+  runBoxBoxBench("corner_containment", boxes, haveBoxBoxCornersCollided, report);
+  runBoxBoxBench("separating_axis", boxes, [](const auto &box1, const auto &box2) { return DeepCollisionValidator::haveShapesCollided(box1, box2, true); }, report);
+}
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef BENCH_COLLISION_BENCH_CPP
+#define BENCH_COLLISION_BENCH_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <utility>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "../include/collider.cpp"
+#include "../include/collision_broadphase.cpp"
+#include "../include/collision_grid.cpp"
+#include "../include/collision_tree.cpp"
+
+#include "bench_report.cpp"
+
+/**
+ * Structure for defining a population of colliders to run the collision benchmarks with.
+ */
+struct CollisionBenchPopulation
+{
+  // The colliders, half spheres and half rotated boxes.
+  std::vector<std::shared_ptr<const ColliderShape>> shapes;
+  // The keys the colliders are added to the broadphases with. They stand in for the models, and are never dereferenced.
+  std::vector<const ModelBaseIntf *> keys;
+  // The AABBs of the colliders, nudged back and forth by the update benchmark.
+  std::vector<std::pair<glm::vec3, glm::vec3>> boxes;
+  // The AABBs of the colliders after the nudge.
+  std::vector<std::pair<glm::vec3, glm::vec3>> movedBoxes;
+};
+
+/**
+ * Create a population of the given number of colliders, spread over a cube that grows with the count so that the density
+ *   (and with it the number of pairs per collider) stays about the same as in a busy scene.
+ * 
+ * @param count   The number of colliders.
+ * @param random  The random number generator.
+ * 
+ * @return The population.
+ */
+CollisionBenchPopulation createCollisionBenchPopulation(const size_t &count, std::mt19937 &random)
+{
+  const auto worldSize = std::cbrt(static_cast<float_t>(count)) * 3.0f;
+  std::uniform_real_distribution<float_t> positionDistribution(0.0f, worldSize);
+  std::uniform_real_distribution<float_t> angleDistribution(0.0f, glm::two_pi<float_t>());
+  std::uniform_real_distribution<float_t> sizeDistribution(0.25f, 1.25f);
+
+  CollisionBenchPopulation population;
+  for (size_t i = 0; i < count; i++)
+  {
+    const auto position = glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+    if (i % 2 == 0)
+    {
+      population.shapes.push_back(std::make_shared<const SphereColliderShape>(position, glm::quat(), glm::vec3(1.0f), sizeDistribution(random)));
+    }
+    else
+    {
+      const auto halfSize = glm::vec3(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+      population.shapes.push_back(std::make_shared<const BoxColliderShape>(
+          position,
+          glm::quat(glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random))),
+          glm::vec3(1.0f),
+          -halfSize, halfSize));
+    }
+
+    // Keys are offset by one so that none of them is null.
+    population.keys.push_back(reinterpret_cast<const ModelBaseIntf *>(static_cast<uintptr_t>(i + 1)));
+
+    const auto &transformedBox = population.shapes.back()->getTransformedBox();
+    population.boxes.push_back({transformedBox.getMinCorner(), transformedBox.getMaxCorner()});
+    // About a frame of movement at the speeds of the enemies.
+    const auto nudge = glm::vec3(0.1f, 0.0f, 0.25f);
+    population.movedBoxes.push_back({transformedBox.getMinCorner() + nudge, transformedBox.getMaxCorner() + nudge});
+  }
+
+  return population;
+}
+
+/**
+ * Create an empty broadphase of the given type.
+ * 
+ * @param broadphaseName  The type of the broadphase, "grid" or "tree".
+ * 
+ * @return The broadphase.
+ */
+std::unique_ptr<CollisionBroadphase> createBenchBroadphase(const std::string &broadphaseName)
+{
+  if (broadphaseName == "tree")
+  {
+    return std::unique_ptr<CollisionBroadphase>(new CollisionTree());
+  }
+  return std::unique_ptr<CollisionBroadphase>(new CollisionGrid());
+}
+
+/**
+ * Add all colliders of the given population to the given broadphase.
+ * 
+ * @param broadphase  The broadphase.
+ * @param population  The population.
+ */
+void insertCollisionBenchPopulation(CollisionBroadphase &broadphase, const CollisionBenchPopulation &population)
+{
+  for (size_t i = 0; i < population.keys.size(); i++)
+  {
+    broadphase.insertCollider(population.keys[i], population.boxes[i].first, population.boxes[i].second);
+  }
+}
+
+/**
+ * Time building, updating and enumerating the pairs of the given broadphase, and the full collision pass over its pairs.
+ * 
+ * @param broadphaseName  The type of the broadphase, "grid" or "tree".
+ * @param population      The population of colliders.
+ * @param report          The report to add the results to.
+ */
+void runBroadphaseBenches(const std::string &broadphaseName, const CollisionBenchPopulation &population, BenchReport &report)
+{
+  const auto count = population.keys.size();
+  uint64_t checksum = 0;
+
+  // Building the broadphase from scratch, per inserted collider.
+  auto timing = timeBenchRuns(count, checksum, [&]() {
+    auto broadphase = createBenchBroadphase(broadphaseName);
+    insertCollisionBenchPopulation(*broadphase, population);
+    return static_cast<uint64_t>(count);
+  });
+  report.addResult({"broadphase_build", broadphaseName, count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  // Moving every collider a frame's worth and back, per updated collider.
+  auto broadphase = createBenchBroadphase(broadphaseName);
+  insertCollisionBenchPopulation(*broadphase, population);
+  auto isMoved = false;
+  timing = timeBenchRuns(count, checksum, [&]() {
+    isMoved = !isMoved;
+    const auto &boxes = isMoved ? population.movedBoxes : population.boxes;
+    for (size_t i = 0; i < count; i++)
+    {
+      broadphase->updateCollider(population.keys[i], boxes[i].first, boxes[i].second);
+    }
+    return static_cast<uint64_t>(count);
+  });
+  report.addResult({"broadphase_update", broadphaseName, count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  // Keep the broadphase at the original boxes for the pair benchmarks.
+  if (isMoved)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      broadphase->updateCollider(population.keys[i], population.boxes[i].first, population.boxes[i].second);
+    }
+  }
+
+  // Enumerating the candidate pairs, per enumeration of all pairs.
+  std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> pairs;
+  timing = timeBenchRuns(1, checksum, [&]() {
+    pairs.clear();
+    broadphase->queryPairs(pairs);
+    return static_cast<uint64_t>(pairs.size());
+  });
+  report.addResult({"broadphase_pairs", broadphaseName, count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  // Checking the candidate pairs with the AABB and deep checks, per whole pass, the same way the collision manager does.
+  timing = timeBenchRuns(1, checksum, [&]() {
+    uint64_t contacts = 0;
+    for (const auto &pair : pairs)
+    {
+      const auto index1 = reinterpret_cast<uintptr_t>(pair.first) - 1, index2 = reinterpret_cast<uintptr_t>(pair.second) - 1;
+      contacts += DeepCollisionValidator::haveShapesCollided(population.shapes[index1], population.shapes[index2], true) ? 1 : 0;
+    }
+    return contacts;
+  });
+  report.addResult({"collision_pass", broadphaseName, count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  // Sweeping a volley of shots through the population, per shot, the same way the collision pass checks the shots.
+  std::mt19937 random(2);
+  const auto worldSize = std::cbrt(static_cast<float_t>(count)) * 3.0f;
+  std::uniform_real_distribution<float_t> positionDistribution(0.0f, worldSize);
+  std::vector<std::shared_ptr<const ColliderShape>> shots;
+  for (auto i = 0; i < 64; i++)
+  {
+    shots.push_back(std::make_shared<const BoxColliderShape>(
+        glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random)),
+        glm::quat(glm::vec3(0.0f, glm::radians(180.0f), 0.0f)),
+        glm::vec3(0.075f),
+        glm::vec3(-1.0f), glm::vec3(1.0f)));
+  }
+  // A frame of movement at the speed of the shots, at 60 frames per second.
+  const auto displacement = glm::vec3(0.0f, 0.0f, -2.0f);
+  std::vector<const ModelBaseIntf *> candidates;
+  timing = timeBenchRuns(shots.size(), checksum, [&]() {
+    uint64_t hits = 0;
+    for (const auto &shot : shots)
+    {
+      // The shots are at the end of their movement, so the swept AABB spans back to where they started.
+      const auto &shotBox = shot->getTransformedBox();
+      const auto minCorner = shotBox.getMinCorner() + glm::min(-displacement, glm::vec3(0.0f));
+      const auto maxCorner = shotBox.getMaxCorner() + glm::max(-displacement, glm::vec3(0.0f));
+      candidates.clear();
+      broadphase->queryBox(minCorner, maxCorner, candidates);
+      for (const auto &candidate : candidates)
+      {
+        const auto &shape = population.shapes[reinterpret_cast<uintptr_t>(candidate) - 1];
+        const auto &box = shape->getTransformedBox();
+        if (CollisionBroadphase::haveBoxesOverlapped(minCorner, maxCorner, box.getMinCorner(), box.getMaxCorner()) &&
+            DeepCollisionValidator::getTimeOfImpact(*shot, displacement, *shape) <= 1.0f)
+        {
+          hits++;
+        }
+      }
+    }
+    return hits;
+  });
+  report.addResult({"shots_sweep", broadphaseName, count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+}
+
+/**
+ * Time the deep check of a single pair of the given shapes, over random pairs close enough that most need the deep check.
+ * 
+ * @param shapeNames  The names of the two shapes, for the report.
+ * @param create1     Creates the first shape of a pair, from a position, a rotation and a size.
+ * @param create2     Creates the second shape of a pair, from a position, a rotation and a size.
+ * @param report      The report to add the result to.
+ */
+void runNarrowphaseBench(
+    const std::string &shapeNames,
+    const std::function<std::shared_ptr<const ColliderShape>(const glm::vec3 &, const glm::vec3 &, const float_t &)> &create1,
+    const std::function<std::shared_ptr<const ColliderShape>(const glm::vec3 &, const glm::vec3 &, const float_t &)> &create2,
+    BenchReport &report)
+{
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float_t> positionDistribution(-1.5f, 1.5f);
+  std::uniform_real_distribution<float_t> angleDistribution(0.0f, glm::two_pi<float_t>());
+  std::uniform_real_distribution<float_t> sizeDistribution(0.25f, 1.25f);
+
+  std::vector<std::pair<std::shared_ptr<const ColliderShape>, std::shared_ptr<const ColliderShape>>> pairs;
+  for (auto i = 0; i < 2048; i++)
+  {
+    const auto rotation1 = glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random));
+    const auto rotation2 = glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random));
+    pairs.push_back({create1(glm::vec3(0.0f), rotation1, sizeDistribution(random)),
+                     create2(glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random)), rotation2, sizeDistribution(random))});
+  }
+
+  uint64_t checksum = 0;
+  const auto timing = timeBenchRuns(pairs.size(), checksum, [&]() {
+    uint64_t hits = 0;
+    for (const auto &pair : pairs)
+    {
+      hits += DeepCollisionValidator::haveShapesCollided(pair.first, pair.second, true) ? 1 : 0;
+    }
+    return hits;
+  });
+  report.addResult({"narrowphase", shapeNames, pairs.size(), timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+}
+
+/**
+ * Run the narrowphase benchmarks, over the pairs of shapes the scenes collide.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runNarrowphaseBenches(BenchReport &report)
+{
+  const auto createSphere = [](const glm::vec3 &position, const glm::vec3 &rotation, const float_t &size) -> std::shared_ptr<const ColliderShape> {
+    return std::make_shared<const SphereColliderShape>(position, glm::quat(rotation), glm::vec3(1.0f), size);
+  };
+  const auto createBox = [](const glm::vec3 &position, const glm::vec3 &rotation, const float_t &size) -> std::shared_ptr<const ColliderShape> {
+    return std::make_shared<const BoxColliderShape>(position, glm::quat(rotation), glm::vec3(1.0f), glm::vec3(-size, -0.5f * size, -size), glm::vec3(size, 0.5f * size, size));
+  };
+  const auto createCylinder = [](const glm::vec3 &position, const glm::vec3 &rotation, const float_t &size) -> std::shared_ptr<const ColliderShape> {
+    return std::make_shared<const CylinderColliderShape>(position, glm::quat(rotation), glm::vec3(1.0f), 0.5f * size, size);
+  };
+  const auto createPill = [](const glm::vec3 &position, const glm::vec3 &rotation, const float_t &size) -> std::shared_ptr<const ColliderShape> {
+    return std::make_shared<const PillColliderShape>(position, glm::quat(rotation), glm::vec3(1.0f), 0.5f * size, size);
+  };
+
+  runNarrowphaseBench("sphere-sphere", createSphere, createSphere, report);
+  runNarrowphaseBench("box-sphere", createBox, createSphere, report);
+  runNarrowphaseBench("box-box", createBox, createBox, report);
+  runNarrowphaseBench("cylinder-sphere", createCylinder, createSphere, report);
+  runNarrowphaseBench("pill-box", createPill, createBox, report);
+  runNarrowphaseBench("cylinder-pill", createCylinder, createPill, report);
+}
+
+/**
+ * Run all the collision benchmarks, with populations of each of the given sizes.
+ * 
+ * @param counts  The numbers of colliders to run the broadphase benchmarks with.
+ * @param report  The report to add the results to.
+ */
+void runCollisionBenches(const std::vector<size_t> &counts, BenchReport &report)
+{
+  runNarrowphaseBenches(report);
+
+  std::mt19937 random(1);
+  for (const auto &count : counts)
+  {
+    const auto population = createCollisionBenchPopulation(count, random);
+    runBroadphaseBenches("grid", population, report);
+    runBroadphaseBenches("tree", population, report);
+  }
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+#include "bench_report.cpp"
+#include "collision_bench.cpp"
+
+/**
+ * Runs the collision benchmarks and prints the results.
+ * 
+ * Usage: collision_bench [--counts 1000,10000,100000] [--format text|csv|json]
+ */
+int main(int argc, char **argv)
+{
+  std::vector<size_t> counts({1000, 10000, 100000});
+  auto format = BenchReportFormat::TEXT;
+
+  for (auto i = 1; i < argc; i++)
+  {
+    const std::string argument(argv[i]);
+    if (argument == "--counts" && i + 1 < argc)
+    {
+      // Parse the comma separated population sizes.
+      counts.clear();
+      std::stringstream countList(argv[++i]);
+      std::string count;
+      while (std::getline(countList, count, ','))
+      {
+        counts.push_back(std::stoul(count));
+      }
+    }
+    else if (argument == "--format" && i + 1 < argc)
+    {
+      const std::string formatName(argv[++i]);
+      format = formatName == "csv" ? BenchReportFormat::CSV : formatName == "json" ? BenchReportFormat::JSON : BenchReportFormat::TEXT;
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--counts 1000,10000,100000] [--format text|csv|json]" << std::endl;
+      return 1;
+    }
+  }
+
+  BenchReport report(format);
+  runCollisionBenches(counts, report);
+  report.print();
+
+  return 0;
+}
@@ -0,0 +1,267 @@
+#ifndef BENCH_KERNEL_BENCH_CPP
+#define BENCH_KERNEL_BENCH_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "../include/collider.cpp"
+#include "../include/object.cpp"
+#include "../include/texture.cpp"
+#include "../include/transform.cpp"
+#include "../include/text_arena.cpp"
+
+#include "bench_report.cpp"
+
+/**
+ * Find the files of the given extension in an asset directory, sorted by name so that the reports line up between runs.
+ * 
+ * @param directoryPath  The path of the asset directory, relative to where the benchmarks are run from.
+ * @param extension      The extension of the files, with its dot.
+ * 
+ * @return The paths of the files, or none if the directory does not exist.
+ */
+std::vector<std::filesystem::path> findBenchAssets(const std::string &directoryPath, const std::string &extension)
+{
+  std::vector<std::filesystem::path> paths;
+  std::error_code errorCode;
+  for (const auto &entry : std::filesystem::directory_iterator(directoryPath, errorCode))
+  {
+    if (entry.is_regular_file() && entry.path().extension() == extension)
+    {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+/**
+ * Time parsing each of the shipped OBJ files into welded vertices and indices, per file.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runObjParseBenches(BenchReport &report)
+{
+  for (const auto &path : findBenchAssets("assets/objects", ".obj"))
+  {
+    const auto fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<uint32_t> indices;
+    uint64_t checksum = 0;
+    const auto timing = timeBenchRuns(1, checksum, [&]() {
+      // Start from empty vectors each run, as the object manager does for each object it loads.
+      std::vector<glm::vec3>().swap(vertices);
+      std::vector<glm::vec2>().swap(uvs);
+      std::vector<glm::vec3>().swap(normals);
+      std::vector<uint32_t>().swap(indices);
+      ObjectManager::loadObjObject(path.stem().string(), path.string(), vertices, uvs, normals, indices);
+      return static_cast<uint64_t>(vertices.size() + indices.size());
+    });
+    report.addResult({"obj_parse", path.filename().string(), fileSize, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+  }
+}
+
+/**
+ * Time reading the header and the pixels of each of the shipped BMP files, per file.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runBmpLoadBenches(BenchReport &report)
+{
+  for (const auto &path : findBenchAssets("assets/textures", ".bmp"))
+  {
+    const auto fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+    const auto textureName = path.stem().string();
+    const auto textureFilePath = path.string();
+    uint32_t dataPos, imageSize, width, height;
+    uint64_t checksum = 0;
+    auto timing = timeBenchRuns(1, checksum, [&]() {
+      TextureManager::readBmpHeader(textureName, textureFilePath, dataPos, imageSize, width, height);
+      return static_cast<uint64_t>(width * height);
+    });
+    report.addResult({"bmp_header", path.filename().string(), fileSize, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+    // The pixels are read into memory of their own instead of a mapped pixel buffer object, with a streaming texture only to be
+    //   marked as read.
+    std::vector<unsigned char> textureData(imageSize);
+    StreamingTexture streamingTexture{};
+    timing = timeBenchRuns(1, checksum, [&]() {
+      TextureManager::readBmpData(textureFilePath, dataPos, imageSize, textureData.data(), nullptr, 0, &streamingTexture);
+      return static_cast<uint64_t>(streamingTexture.isReadSuccessful ? textureData[imageSize / 2] : 0);
+    });
+    report.addResult({"bmp_pixels", path.filename().string(), fileSize, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+    // Generate the mip chain of the pixels on the worker threads, copying it into memory of its own instead of a mapped pixel
+    //   buffer object, per file.
+    const auto mipLevels = MipChainGenerator::getLevelLayouts(width, height);
+    const auto chainSize = MipChainGenerator::getChainSize(mipLevels);
+    const auto baseLevelSize = std::min<uint64_t>(imageSize, mipLevels.front().getSize());
+    std::vector<unsigned char> chainTarget(chainSize);
+    timing = timeBenchRuns(1, checksum, [&]() {
+      auto &jobManager = JobManager::getInstance();
+      const auto chainData = std::make_shared<std::vector<unsigned char>>();
+      const auto readTask = jobManager.submitTask([&, chainData]() {
+        TextureManager::readBmpData(textureFilePath, dataPos, baseLevelSize, chainTarget.data(), chainData.get(), chainSize, &streamingTexture);
+      });
+      jobManager.waitForTask(MipChainGenerator::submitFilterTasks(chainData, chainTarget.data(), mipLevels, readTask));
+      return static_cast<uint64_t>(chainTarget[mipLevels.back().offset]);
+    });
+    report.addResult({"bmp_mips", path.filename().string(), fileSize, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+  }
+}
+
+/**
+ * Time moving colliders and rebuilding their transformed bounding boxes, per collider, as the models do each simulation step.
+ * 
+ * @param name    The name of the collider shape, for the report.
+ * @param shapes  The colliders.
+ * @param report  The report to add the results to.
+ */
+template <typename Shape>
+void runColliderTransformBench(const std::string &name, const std::vector<std::shared_ptr<Shape>> &shapes, BenchReport &report)
+{
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float_t> positionDistribution(-50.0f, 50.0f);
+  std::uniform_real_distribution<float_t> angleDistribution(0.0f, glm::two_pi<float_t>());
+  std::vector<std::pair<glm::vec3, glm::quat>> transforms;
+  for (size_t i = 0; i < shapes.size(); i++)
+  {
+    transforms.emplace_back(glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random)),
+                            glm::quat(glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random))));
+  }
+
+  uint64_t checksum = 0;
+  size_t offset = 0;
+  const auto timing = timeBenchRuns(shapes.size(), checksum, [&]() {
+    // Shift the transforms each run, so that every collider really moves.
+    offset = (offset + 1) % transforms.size();
+    auto sum = 0.0f;
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+      const auto &transform = transforms[(i + offset) % transforms.size()];
+      shapes[i]->updateTransformations(transform.first, transform.second, glm::vec3(1.0f));
+      sum += shapes[i]->getTransformedBox().getMaxCorner().x;
+    }
+    return static_cast<uint64_t>(std::abs(sum));
+  });
+  report.addResult({"collider_transform", name, shapes.size(), timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+}
+
+/**
+ * Time building the world matrices and bounds of the transforms, per transform, both all at once over the job threads as the
+ *   scenes do each frame, and one at a time as they are asked for.
+ * 
+ * @param count   The number of transforms.
+ * @param report  The report to add the results to.
+ */
+void runWorldTransformBenches(const size_t &count, BenchReport &report)
+{
+  auto &transformManager = TransformManager::getInstance();
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float_t> positionDistribution(-50.0f, 50.0f);
+  std::uniform_real_distribution<float_t> angleDistribution(0.0f, glm::two_pi<float_t>());
+  std::vector<TransformHandle> handles;
+  for (size_t i = 0; i < count; i++)
+  {
+    handles.push_back(transformManager.createTransform(glm::vec3(positionDistribution(random), positionDistribution(random), positionDistribution(random)),
+                                                       glm::quat(glm::vec3(angleDistribution(random), angleDistribution(random), angleDistribution(random))), glm::vec3(1.0f)));
+  }
+
+  // Each run nudges every transform first, since only the moved ones are rebuilt.
+  const auto moveTransforms = [&](const float_t &step) {
+    for (const auto &handle : handles)
+    {
+      transformManager.setPosition(handle, transformManager.getPosition(handle) + glm::vec3(step));
+    }
+  };
+
+  uint64_t checksum = 0;
+  auto step = 0.01f;
+  auto timing = timeBenchRuns(count, checksum, [&]() {
+    step = -step;
+    moveTransforms(step);
+    transformManager.updateWorldTransforms();
+    return static_cast<uint64_t>(std::abs(transformManager.getWorldMatrix(handles.back())[3].x));
+  });
+  report.addResult({"world_transforms", "parallel", count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  timing = timeBenchRuns(count, checksum, [&]() {
+    step = -step;
+    moveTransforms(step);
+    auto sum = 0.0f;
+    for (const auto &handle : handles)
+    {
+      sum += transformManager.getWorldMatrix(handle)[3].x;
+    }
+    return static_cast<uint64_t>(std::abs(sum));
+  });
+  report.addResult({"world_transforms", "lazy", count, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+
+  for (const auto &handle : handles)
+  {
+    transformManager.destroyTransform(handle);
+  }
+}
+
+/**
+ * Time formatting the lines of the debug text into a text arena, per line. Laying the glyphs of the lines out needs the
+ *   character set of the text manager, which is only made with a window, so the formatting is what is timed here.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runTextFormatBenches(BenchReport &report)
+{
+  constexpr size_t LINES_COUNT = 16;
+  TextArena arena;
+  uint64_t checksum = 0;
+  uint64_t frame = 0;
+  const auto timing = timeBenchRuns(LINES_COUNT, checksum, [&]() {
+    arena.reset();
+    for (size_t i = 0; i < LINES_COUNT; i++)
+    {
+      const auto offset = arena.getCharactersCount();
+      TextWriter text(arena);
+      text << "Frame: " << frame << " | FPS: " << 1000.0 / (16.0 + i) << " | Enemies: " << static_cast<int32_t>(i * 3) << " | Mode: " << (i % 2 == 0 ? "Idle" : "Active");
+      arena.addTextLine(offset, glm::vec2(0.0f, 0.05f * i), 0.5f);
+    }
+    frame++;
+    return static_cast<uint64_t>(arena.getCharactersCount());
+  });
+  report.addResult({"text_format", "debug_lines", LINES_COUNT, timing.operations, timing.nanosecondsPerOperation, timing.allocationsPerOperation, checksum});
+}
+
+/**
+ * Run the benchmarks of the engine kernels that run without a window.
+ * 
+ * @param report  The report to add the results to.
+ */
+void runKernelBenches(BenchReport &report)
+{
+  runObjParseBenches(report);
+  runBmpLoadBenches(report);
+
+  std::vector<std::shared_ptr<SphereColliderShape>> spheres;
+  std::vector<std::shared_ptr<BoxColliderShape>> boxes;
+  for (auto i = 0; i < 4096; i++)
+  {
+    spheres.push_back(std::make_shared<SphereColliderShape>(glm::vec3(0.0f), glm::quat(), glm::vec3(1.0f), 1.0f));
+    boxes.push_back(std::make_shared<BoxColliderShape>(glm::vec3(0.0f), glm::quat(), glm::vec3(1.0f), glm::vec3(-1.0f), glm::vec3(1.0f)));
+  }
+  runColliderTransformBench("sphere", spheres, report);
+  runColliderTransformBench("box", boxes, report);
+
+  runWorldTransformBenches(4096, report);
+  runTextFormatBenches(report);
+}
+
+#endif
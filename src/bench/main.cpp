@@ -0,0 +1,42 @@
+#include <cmath>
+#include <string>
+#include <iostream>
+
+#include "bench_report.cpp"
+#include "box_box_bench.cpp"
+#include "collision_bench.cpp"
+#include "kernel_bench.cpp"
+
+/**
+ * Runs the micro-benchmarks of the engine kernels that run without a window and prints the results. The asset benchmarks read
+ *   the shipped assets, so the benchmarks are run from the directory the game is.
+ * 
+ * Usage: bench [--format text|csv|json]
+ */
+int main(int argc, char **argv)
+{
+  auto format = BenchReportFormat::TEXT;
+
+  for (auto i = 1; i < argc; i++)
+  {
+    const std::string argument(argv[i]);
+    if (argument == "--format" && i + 1 < argc)
+    {
+      const std::string formatName(argv[++i]);
+      format = formatName == "csv" ? BenchReportFormat::CSV : formatName == "json" ? BenchReportFormat::JSON : BenchReportFormat::TEXT;
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--format text|csv|json]" << std::endl;
+      return 1;
+    }
+  }
+
+  BenchReport report(format);
+  runKernelBenches(report);
+  runNarrowphaseBenches(report);
+  runBoxBoxBenches(report);
+  report.print();
+
+  return 0;
+}
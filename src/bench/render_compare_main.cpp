@@ -0,0 +1,435 @@
+#include <cmath>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "../include/render_config.cpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// The directory the configs and the screenshots of the combinations are written to.
+const char *const COMPARE_DIRECTORY = "compare/";
+// The path the game writes its first screenshot to, moved into the compare directory after each run.
+const char *const COMPARE_SCREENSHOT_PATH = "captures/screenshot_0.bmp";
+// The largest number of toggles compared at once, since every combination of them is run.
+const size_t MAX_COMPARE_TOGGLES = 6;
+
+/**
+ * Structure for defining the statistics of a timing of the runs of a combination (in milliseconds).
+ */
+struct CompareTiming
+{
+  // The means and the 99th percentiles of the timing in each run.
+  std::vector<double> means;
+  std::vector<double> p99s;
+
+  /**
+   * Get the average of some values of the runs.
+   * 
+   * @param values  The values of the runs.
+   * 
+   * @return The average (0 without runs).
+   */
+  static double getAverage(const std::vector<double> &values)
+  {
+    auto sum = 0.0;
+    for (const auto &value : values)
+    {
+      sum += value;
+    }
+    return values.empty() ? 0.0 : sum / values.size();
+  }
+
+  /**
+   * Get the standard error of the average of the means of the runs, for how far apart two averages have to be to differ.
+   * 
+   * @return The standard error (0 with less than two runs).
+   */
+  double getMeanError() const
+  {
+    if (means.size() < 2)
+    {
+      return 0.0;
+    }
+    const auto average = getAverage(means);
+    auto squaresSum = 0.0;
+    for (const auto &mean : means)
+    {
+      squaresSum += (mean - average) * (mean - average);
+    }
+    return std::sqrt(squaresSum / (means.size() - 1) / means.size());
+  }
+};
+
+/**
+ * Structure for defining a combination of the toggles, with the results of its runs.
+ */
+struct CompareCombination
+{
+  // The name of the combination, listing the toggles switched on.
+  std::string name;
+  // The path of the render config the game runs the combination with.
+  std::string configPath;
+  // The CPU frame times and the GPU scene render times of the runs.
+  CompareTiming cpuFrameTime;
+  CompareTiming gpuSceneTime;
+  // The number of runs that failed to report.
+  uint32_t failedRunsCount;
+  // The path of the screenshot of the combination, empty if it has none.
+  std::string screenshotPath;
+};
+
+/**
+ * Read a number of the JSON report of a benchmark run, following the keys of the objects it is nested in.
+ * 
+ * @param report  The report.
+ * @param keys    The keys, from the outermost object to the number.
+ * @param value   The number read.
+ * 
+ * @return Whether the number was found.
+ */
+static bool readReportNumber(const std::string &report, const std::vector<std::string> &keys, double &value)
+{
+  size_t position = 0;
+  for (const auto &key : keys)
+  {
+    position = report.find("\"" + key + "\":", position);
+    if (position == std::string::npos)
+    {
+      return false;
+    }
+    position += key.size() + 3;
+  }
+  return std::sscanf(report.c_str() + position, "%lf", &value) == 1;
+}
+
+/**
+ * Run the game once, and read the timings of its benchmark report.
+ * 
+ * @param command      The command running the game.
+ * @param combination  The combination run, the timings of the run are added to.
+ * 
+ * @return Whether the run reported its timings.
+ */
+static bool runBenchmark(const std::string &command, CompareCombination &combination)
+{
+  const auto pipe = popen(command.c_str(), "r");
+  if (pipe == nullptr)
+  {
+    return false;
+  }
+  // The report is the line of the output starting the benchmark settings.
+  std::string output, report;
+  char buffer[4096];
+  while (std::fgets(buffer, sizeof(buffer), pipe) != nullptr)
+  {
+    output += buffer;
+    if (!output.empty() && output.back() == '\n')
+    {
+      if (output.rfind("{\"settings\"", 0) == 0)
+      {
+        report = output;
+      }
+      output.clear();
+    }
+  }
+  pclose(pipe);
+
+  double cpuMean, cpuP99, gpuMean, gpuP99;
+  if (!readReportNumber(report, {"cpu", "frameTime", "mean"}, cpuMean) || !readReportNumber(report, {"cpu", "frameTime", "p99"}, cpuP99) ||
+      !readReportNumber(report, {"gpu", "sceneRender", "mean"}, gpuMean) || !readReportNumber(report, {"gpu", "sceneRender", "p99"}, gpuP99))
+  {
+    return false;
+  }
+  combination.cpuFrameTime.means.push_back(cpuMean);
+  combination.cpuFrameTime.p99s.push_back(cpuP99);
+  combination.gpuSceneTime.means.push_back(gpuMean);
+  combination.gpuSceneTime.p99s.push_back(gpuP99);
+  return true;
+}
+
+/**
+ * Read the pixels of a 24-bit BMP image, like the screenshots the game writes.
+ * 
+ * @param path    The path of the image.
+ * @param width   The width read.
+ * @param height  The height read.
+ * @param pixels  The pixels read, row by row with the padding of the rows.
+ * 
+ * @return Whether the image could be read.
+ */
+static bool readBmpFile(const std::string &path, int32_t &width, int32_t &height, std::vector<uint8_t> &pixels)
+{
+  std::ifstream stream(path, std::ios::binary);
+  std::array<uint8_t, 54> header;
+  if (!stream.read(reinterpret_cast<char *>(header.data()), header.size()) || header[0] != 'B' || header[1] != 'M' || header[28] != 24)
+  {
+    return false;
+  }
+  const auto readValue = [&header](const size_t &offset) {
+    return static_cast<uint32_t>(header[offset]) | static_cast<uint32_t>(header[offset + 1]) << 8 | static_cast<uint32_t>(header[offset + 2]) << 16 | static_cast<uint32_t>(header[offset + 3]) << 24;
+  };
+  width = static_cast<int32_t>(readValue(18));
+  height = static_cast<int32_t>(readValue(22));
+  pixels.resize(static_cast<size_t>((width * 3 + 3) & ~3) * height);
+  stream.seekg(readValue(10));
+  return static_cast<bool>(stream.read(reinterpret_cast<char *>(pixels.data()), pixels.size()));
+}
+
+/**
+ * Compare the screenshot of a combination with the one of the baseline.
+ * 
+ * @param path          The path of the screenshot.
+ * @param baselinePath  The path of the screenshot of the baseline.
+ * 
+ * @return The comparison as text: the root mean square difference of the channels and the share of the pixels that differ.
+ */
+static std::string compareScreenshots(const std::string &path, const std::string &baselinePath)
+{
+  int32_t width, height, baselineWidth, baselineHeight;
+  std::vector<uint8_t> pixels, baselinePixels;
+  if (!readBmpFile(path, width, height, pixels) || !readBmpFile(baselinePath, baselineWidth, baselineHeight, baselinePixels))
+  {
+    return "Missing";
+  }
+  if (width != baselineWidth || height != baselineHeight)
+  {
+    return "Size Differs";
+  }
+
+  const auto rowSize = static_cast<size_t>((width * 3 + 3) & ~3);
+  auto squaresSum = 0.0;
+  uint64_t differentPixelsCount = 0;
+  for (int32_t y = 0; y < height; y++)
+  {
+    for (int32_t x = 0; x < width; x++)
+    {
+      auto isDifferent = false;
+      for (int32_t channel = 0; channel < 3; channel++)
+      {
+        const auto offset = y * rowSize + x * 3 + channel;
+        const auto difference = static_cast<double>(pixels[offset]) - baselinePixels[offset];
+        squaresSum += difference * difference;
+        isDifferent = isDifferent || difference != 0.0;
+      }
+      differentPixelsCount += isDifferent ? 1 : 0;
+    }
+  }
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(2) << "RMS " << std::sqrt(squaresSum / (3.0 * width * height)) << ", " << 100.0 * differentPixelsCount / (static_cast<double>(width) * height) << "% Px";
+  return text.str();
+}
+
+/**
+ * Write a timing of a combination as columns of the table: its average mean and 99th percentile, and how far they are from the
+ *   ones of the baseline, marked with "*" if the means are further apart than twice their standard error.
+ * 
+ * @param stream    The stream to write to.
+ * @param timing    The timing of the combination.
+ * @param baseline  The timing of the baseline.
+ */
+static void writeTimingColumns(std::ostream &stream, const CompareTiming &timing, const CompareTiming &baseline)
+{
+  const auto mean = CompareTiming::getAverage(timing.means);
+  const auto baselineMean = CompareTiming::getAverage(baseline.means);
+  const auto p99 = CompareTiming::getAverage(timing.p99s);
+  const auto baselineP99 = CompareTiming::getAverage(baseline.p99s);
+  const auto getDelta = [](const double &value, const double &baselineValue) {
+    return baselineValue > 0.0 ? 100.0 * (value - baselineValue) / baselineValue : 0.0;
+  };
+  const auto error = std::sqrt(timing.getMeanError() * timing.getMeanError() + baseline.getMeanError() * baseline.getMeanError());
+  const auto isSignificant = error > 0.0 && std::abs(mean - baselineMean) > 2.0 * error;
+
+  std::ostringstream meanDelta, p99Delta;
+  meanDelta << std::showpos << std::fixed << std::setprecision(1) << getDelta(mean, baselineMean) << "%" << (isSignificant ? "*" : "");
+  p99Delta << std::showpos << std::fixed << std::setprecision(1) << getDelta(p99, baselineP99) << "%";
+  stream << std::fixed << std::setprecision(3) << std::setw(10) << mean << std::setw(10) << meanDelta.str() << std::setw(10) << p99 << std::setw(10) << p99Delta.str();
+}
+
+/**
+ * Runs the benchmark mode of the game under every combination of the chosen render config switches, a number of times each,
+ *   and prints a table of their CPU frame times and GPU scene render times, with how far each is from the baseline (all the
+ *   toggles off). The runs of the combinations take turns, so that the drift of the machine over the runs (e.g. its heat) is
+ *   spread over all of them. With "--images", a screenshot is taken of each combination at the same frame of its run and
+ *   compared with the one of the baseline, to check that the render paths render the same.
+ * The arguments after "--" are passed to the game, usually "--benchmark frames --headless" and the scene of the benchmark.
+ * 
+ * Usage: render_compare --game path --toggles depth-pre-pass,clustered-lighting [--runs 3] [--config file] [--images [frame]] [-- game arguments]
+ */
+int main(int argc, char **argv)
+{
+  std::string gamePath, baseConfigPath, gameArguments;
+  std::vector<std::string> toggles;
+  uint32_t runsCount = 3;
+  auto isImageChecked = false;
+  uint32_t screenshotFrame = 60;
+  auto isUsageShown = false;
+
+  for (auto i = 1; i < argc && !isUsageShown; i++)
+  {
+    const std::string argument(argv[i]);
+    if (argument == "--game" && i + 1 < argc)
+    {
+      gamePath = argv[++i];
+    }
+    else if (argument == "--toggles" && i + 1 < argc)
+    {
+      // Parse the comma separated switches of the render config, which have to be known to it.
+      std::stringstream toggleList(argv[++i]);
+      std::string toggle;
+      while (std::getline(toggleList, toggle, ','))
+      {
+        auto config = RenderConfigManager::getConfig();
+        isUsageShown = isUsageShown || !RenderConfigManager::parseSetting(toggle, "on", config);
+        toggles.push_back(toggle);
+      }
+    }
+    else if (argument == "--runs" && i + 1 < argc)
+    {
+      runsCount = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+    }
+    else if (argument == "--config" && i + 1 < argc)
+    {
+      // The render config the toggles are switched over, the same for all the combinations otherwise.
+      baseConfigPath = argv[++i];
+    }
+    else if (argument == "--images")
+    {
+      // The measured frame the screenshots are taken after is optional.
+      isImageChecked = true;
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        screenshotFrame = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+      }
+    }
+    else if (argument == "--")
+    {
+      for (i++; i < argc; i++)
+      {
+        gameArguments += std::string(" \"") + argv[i] + "\"";
+      }
+    }
+    else
+    {
+      isUsageShown = true;
+    }
+  }
+  if (isUsageShown || gamePath.empty() || toggles.empty() || toggles.size() > MAX_COMPARE_TOGGLES)
+  {
+    std::cerr << "Usage: " << argv[0] << " --game path --toggles depth-pre-pass,clustered-lighting (up to " << MAX_COMPARE_TOGGLES << " render config switches) [--runs 3] [--config file] [--images [frame]] [-- game arguments]" << std::endl;
+    return 1;
+  }
+  if (gameArguments.find("--benchmark") == std::string::npos)
+  {
+    gameArguments += " --benchmark";
+  }
+
+  // Write the render config of each combination: the base config, and then the toggles it switches on and off.
+  std::string baseConfig;
+  if (!baseConfigPath.empty())
+  {
+    std::ifstream baseConfigStream(baseConfigPath);
+    if (!baseConfigStream)
+    {
+      std::cerr << "Failed to read the render config " << baseConfigPath << std::endl;
+      return 1;
+    }
+    baseConfig.assign(std::istreambuf_iterator<char>(baseConfigStream), std::istreambuf_iterator<char>());
+    baseConfig += "\n";
+  }
+  std::error_code errorCode;
+  std::filesystem::create_directories(COMPARE_DIRECTORY, errorCode);
+  auto combinations = std::vector<CompareCombination>({});
+  for (uint32_t mask = 0; mask < (1u << toggles.size()); mask++)
+  {
+    auto combination = CompareCombination({"", std::string(COMPARE_DIRECTORY) + "config_" + std::to_string(mask) + ".txt", {}, {}, 0, ""});
+    std::ofstream configStream(combination.configPath, std::ios::out | std::ios::trunc);
+    configStream << baseConfig;
+    for (size_t i = 0; i < toggles.size(); i++)
+    {
+      const auto isOn = (mask & (1u << i)) != 0;
+      configStream << toggles[i] << (isOn ? " on\n" : " off\n");
+      if (isOn)
+      {
+        combination.name += (combination.name.empty() ? "" : "+") + toggles[i];
+      }
+    }
+    if (combination.name.empty())
+    {
+      combination.name = "baseline";
+    }
+    combinations.push_back(combination);
+  }
+
+  // Run the combinations in turn, a run of each per round.
+  const auto getCommand = [&gamePath, &gameArguments](const CompareCombination &combination, const std::string &extraArguments) {
+    return "\"" + gamePath + "\"" + gameArguments + " --config \"" + combination.configPath + "\"" + extraArguments;
+  };
+  for (uint32_t run = 0; run < runsCount; run++)
+  {
+    for (auto &combination : combinations)
+    {
+      std::cerr << "Run " << run + 1 << "/" << runsCount << ": " << combination.name << std::endl;
+      if (!runBenchmark(getCommand(combination, ""), combination))
+      {
+        combination.failedRunsCount++;
+      }
+    }
+  }
+
+  // Take the screenshots in runs of their own, since reading them back would be timed along with the frames.
+  if (isImageChecked)
+  {
+    for (size_t i = 0; i < combinations.size(); i++)
+    {
+      auto &combination = combinations[i];
+      std::cerr << "Screenshot: " << combination.name << std::endl;
+      std::filesystem::remove(COMPARE_SCREENSHOT_PATH, errorCode);
+      CompareCombination screenshotRun(combination);
+      runBenchmark(getCommand(combination, " --screenshot-frame " + std::to_string(screenshotFrame)), screenshotRun);
+      const auto screenshotPath = std::string(COMPARE_DIRECTORY) + "screenshot_" + std::to_string(i) + ".bmp";
+      std::filesystem::remove(screenshotPath, errorCode);
+      std::filesystem::rename(COMPARE_SCREENSHOT_PATH, screenshotPath, errorCode);
+      combination.screenshotPath = errorCode ? "" : screenshotPath;
+    }
+  }
+
+  // Print the table, each combination against the baseline.
+  const auto &baseline = combinations.front();
+  size_t nameWidth = 12;
+  for (const auto &combination : combinations)
+  {
+    nameWidth = std::max(nameWidth, combination.name.size() + 2);
+  }
+  std::cout << std::left << std::setw(nameWidth) << "Combination" << std::right << std::setw(6) << "Runs" << std::setw(10) << "CPU Mean" << std::setw(10) << "Delta" << std::setw(10) << "CPU p99" << std::setw(10) << "Delta"
+            << std::setw(10) << "GPU Mean" << std::setw(10) << "Delta" << std::setw(10) << "GPU p99" << std::setw(10) << "Delta" << (isImageChecked ? "  Image" : "") << std::endl;
+  for (const auto &combination : combinations)
+  {
+    std::cout << std::left << std::setw(nameWidth) << combination.name << std::right << std::setw(6) << combination.cpuFrameTime.means.size();
+    writeTimingColumns(std::cout, combination.cpuFrameTime, baseline.cpuFrameTime);
+    writeTimingColumns(std::cout, combination.gpuSceneTime, baseline.gpuSceneTime);
+    if (isImageChecked)
+    {
+      std::cout << "  " << (&combination == &baseline ? "Reference" : compareScreenshots(combination.screenshotPath, baseline.screenshotPath));
+    }
+    if (combination.failedRunsCount > 0)
+    {
+      std::cout << "  (" << combination.failedRunsCount << " Failed)";
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "Times in milliseconds, deltas against the baseline (* where the means differ by more than twice their standard error)." << std::endl;
+
+  return 0;
+}
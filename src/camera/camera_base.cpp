@@ -7,6 +7,27 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../include/frustum.cpp"
+
+/**
+ * Structure for defining the matrices of a camera along with the data derived from them, rebuilt only when the camera changes.
+ */
+struct CameraMatrices
+{
+  // The view matrix of the camera.
+  glm::mat4 viewMatrix;
+  // The projection matrix of the camera.
+  glm::mat4 projectionMatrix;
+  // The product of the projection and the view matrices.
+  glm::mat4 viewProjectionMatrix;
+  // The inverses of the view, projection and view-projection matrices.
+  glm::mat4 inverseViewMatrix;
+  glm::mat4 inverseProjectionMatrix;
+  glm::mat4 inverseViewProjectionMatrix;
+  // The view frustum of the camera.
+  Frustum frustum;
+};
+
 /**
  * Base class for creating cameras.
  */
@@ -26,27 +47,61 @@ private:
   // The direction that is the up direction for the camera.
   glm::vec3 up;
 
-  // The view matrix of the camera.
-  glm::mat4 viewMatrix;
-  // The projection matrix of the camera.
-  glm::mat4 projectionMatrix;
+  // The matrices of the camera and the data derived from them, only rebuilt when they are accessed after the camera changed.
+  mutable CameraMatrices matrices;
+  // Whether the position, direction or up vector changed since the view matrix was last built.
+  mutable bool isViewDirty;
+  // Whether the projection changed since the projection matrix was last built.
+  mutable bool isProjectionDirty;
+
+  /**
+   * Rebuild the outdated matrices of the camera, along with the data derived from them.
+   */
+  void updateMatrices() const
+  {
+    if (isViewDirty)
+    {
+      matrices.viewMatrix = glm::lookAt(position, position + direction, up);
+      matrices.inverseViewMatrix = glm::inverse(matrices.viewMatrix);
+    }
+    if (isProjectionDirty)
+    {
+      matrices.projectionMatrix = createProjectionMatrix();
+      matrices.inverseProjectionMatrix = glm::inverse(matrices.projectionMatrix);
+    }
+    matrices.viewProjectionMatrix = matrices.projectionMatrix * matrices.viewMatrix;
+    matrices.inverseViewProjectionMatrix = matrices.inverseViewMatrix * matrices.inverseProjectionMatrix;
+    matrices.frustum = Frustum(matrices.viewProjectionMatrix);
+    isViewDirty = false;
+    isProjectionDirty = false;
+  }
 
 protected:
   CameraBase(const std::string &cameraId,
              const std::string &cameraName,
              const glm::vec3 &position,
              const glm::vec3 &direction,
-             const glm::vec3 &up,
-             const glm::mat4 &projectionMatrix)
+             const glm::vec3 &up)
       : cameraId(cameraId),
         cameraName(cameraName),
         position(position),
         direction(direction),
         up(up),
-        projectionMatrix(projectionMatrix) {}
+        matrices(),
+        isViewDirty(true),
+        isProjectionDirty(true) {}
 
   virtual ~CameraBase() {}
 
+  /**
+   * Mark the projection matrix of the camera as outdated, for the cameras changing the values it is created from (like the field of
+   *   view, the aspect ratio or the planes).
+   */
+  void markProjectionDirty()
+  {
+    isProjectionDirty = true;
+  }
+
 public:
   /**
    * Get the ID of the camera.
@@ -99,23 +154,42 @@ public:
   }
 
   /**
-   * Get the view matrix of the camera.
+   * Get the matrices of the camera along with the data derived from them, rebuilding the ones outdated by the changes to the
+   *   camera since they were last accessed.
    * 
-   * @return The camera view matrix.
+   * @return The camera matrices.
    */
-  const glm::mat4 &getViewMatrix() const
+  const CameraMatrices &getCameraMatrices() const
   {
-    return viewMatrix;
+    if (isViewDirty || isProjectionDirty)
+    {
+      updateMatrices();
+    }
+    return matrices;
   }
 
   /**
-   * Get the projection matrix of the camera.
+   * Get the ray going from the camera through the given point of the screen, by unprojecting the point on the near and far planes.
+   * Works the same for every projection, so the ray starts at the camera for perspective cameras and is parallel to the camera
+   *   direction for orthographic ones.
    * 
-   * @return The camera projection matrix.
+   * @param screenPosition  The point of the screen, normalized with the top-left corner at (0, 0) like the cursor position.
+   * @param origin          Set to the point of the ray on the near plane.
+   * @param direction       Set to the normalized direction of the ray.
+   * 
+   * @return The length of the ray between the near and far planes.
    */
-  const glm::mat4 &getProjectionMatrix() const
+  float_t getScreenRay(const glm::vec2 &screenPosition, glm::vec3 &origin, glm::vec3 &direction) const
   {
-    return projectionMatrix;
+    const auto &inverseViewProjectionMatrix = getCameraMatrices().inverseViewProjectionMatrix;
+    const auto normalizedPosition = glm::vec2((2.0f * screenPosition.x) - 1.0f, 1.0f - (2.0f * screenPosition.y));
+    const auto nearPoint = inverseViewProjectionMatrix * glm::vec4(normalizedPosition, -1.0f, 1.0f);
+    const auto farPoint = inverseViewProjectionMatrix * glm::vec4(normalizedPosition, 1.0f, 1.0f);
+
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    const auto ray = (glm::vec3(farPoint) / farPoint.w) - origin;
+    direction = glm::normalize(ray);
+    return glm::length(ray);
   }
 
   /**
@@ -126,7 +200,7 @@ public:
   virtual void setCameraPosition(const glm::vec3 &newPosition)
   {
     position = newPosition;
-    CameraBase::update();
+    isViewDirty = true;
   }
 
   /**
@@ -137,7 +211,7 @@ public:
   virtual void setCameraDirection(const glm::vec3 &newDirection)
   {
     direction = newDirection;
-    CameraBase::update();
+    isViewDirty = true;
   }
 
   /**
@@ -148,7 +222,7 @@ public:
   virtual void setCameraUp(const glm::vec3 &newUp)
   {
     up = newUp;
-    CameraBase::update();
+    isViewDirty = true;
   }
 
   /**
@@ -162,22 +236,16 @@ public:
   virtual void deinit() {}
 
   /**
-   * Update the camera during the update step before starting rendering.
+   * Update the camera during the update step before starting rendering. The matrices are rebuilt once they are accessed.
    */
-  virtual void update()
-  {
-    // Calculate the view matrix of the camera.
-    viewMatrix = glm::lookAt(position, position + direction, up);
-    // Calculate the projection matrix of the camera.
-    projectionMatrix = createProjectionMatrix();
-  }
+  virtual void update() {}
 
   /**
    * Calculates and returns a projection matrix. Has to be implemented by child classes.
    * 
    * @return The calculated projection matrix.
    */
-  const virtual glm::mat4 createProjectionMatrix() = 0;
+  const virtual glm::mat4 createProjectionMatrix() const = 0;
 };
 
 #endif
\ No newline at end of file
@@ -46,8 +46,6 @@ private:
   float_t verticalAngle;
   // Whether to accept input or not.
   bool acceptInput;
-  // The last time the ability to accept input was changed.
-  float_t lastAcceptInputChange;
 
   /**
    * Update the camera.
@@ -69,9 +67,6 @@ private:
     CameraBase::setCameraDirection(newDirection);
     // Update the camera up vector.
     CameraBase::setCameraUp(up);
-
-    // Call the base class update method to update the view and projection matrices.
-    CameraBase::update();
   }
 
 public:
@@ -81,8 +76,7 @@ public:
             "Perspective",
             glm::vec3(0.0f),
             glm::vec3(0.0f),
-            glm::vec3(0.0f, 1.0f, 0.0f),
-            glm::perspective(glm::radians(90.0f), ASPECT_RATIO, 0.1f, 100.0f)),
+            glm::vec3(0.0f, 1.0f, 0.0f)),
         controlManager(ControlManager::getInstance()),
         defaultPosition(glm::vec3(0.0f)),
         defaultHorizontalAngle(0.0f),
@@ -94,8 +88,7 @@ public:
         lastTime(glfwGetTime()),
         horizontalAngle(0.0f),
         verticalAngle(0.0f),
-        acceptInput(false),
-        lastAcceptInputChange(glfwGetTime() - 10.0f) {}
+        acceptInput(false) {}
 
   void update() override
   {
@@ -104,8 +97,8 @@ public:
     // Get the time difference since the start of the last update.
     const auto deltaTime = float_t(currentTime - lastTime);
 
-    // Check if the M key was pressed after 500ms since the last accept input change.
-    if (controlManager.isKeyPressed(GLFW_KEY_M) && (currentTime - lastAcceptInputChange) > 0.5f)
+    // Check if the M key was pressed since the last frame.
+    if (controlManager.wasKeyPressed(GLFW_KEY_M))
     {
       // "M" key was pressed. Toggle accepting input.
       acceptInput = !acceptInput;
@@ -119,13 +112,6 @@ public:
       {
         controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
       }
-      // Update the timestamp for the last time accept input flag was changed.
-      lastAcceptInputChange = currentTime;
-      // Consume any keypresses used for moving the camera.
-      controlManager.isKeyPressed(GLFW_KEY_UP);
-      controlManager.isKeyPressed(GLFW_KEY_DOWN);
-      controlManager.isKeyPressed(GLFW_KEY_RIGHT);
-      controlManager.isKeyPressed(GLFW_KEY_LEFT);
     }
 
     // If input is not being accepted, just consume mouse inputs and end.
@@ -139,8 +125,8 @@ public:
     controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
 
     // Calculate the camera angles based on the mouse movement.
-    horizontalAngle += mouseSpeed * (0.5f - currentCursorPosition->getX());
-    verticalAngle += mouseSpeed * (0.5f - currentCursorPosition->getY());
+    horizontalAngle += mouseSpeed * (0.5f - currentCursorPosition.getX());
+    verticalAngle += mouseSpeed * (0.5f - currentCursorPosition.getY());
 
     // Calculate the new direction the camera is pointing towards.
     const auto newDirection = glm::vec3(
@@ -241,9 +227,6 @@ public:
     setCameraDirection(newDirection);
     // Update the camera up vector.
     setCameraUp(up);
-
-    // Call the base class update method to update the view and projection matrices.
-    CameraBase::update();
   }
 
   /**
@@ -259,7 +242,7 @@ public:
    * 
    * @return The camera's projection matrix.
    */
-  const glm::mat4 createProjectionMatrix() override
+  const glm::mat4 createProjectionMatrix() const override
   {
     return glm::perspective(glm::radians(fieldOfView), aspectRatio, nearPlane, farPlane);
   }
@@ -0,0 +1,82 @@
+#ifndef MODELS_REAR_VIEW_CAMERA_MODEL_CPP
+#define MODELS_REAR_VIEW_CAMERA_MODEL_CPP
+
+#include <string>
+#include <memory>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "camera_base.cpp"
+#include "../include/constants.cpp"
+
+/**
+ * Class that represents a 3D perspective-based camera looking back from the position of another camera, like a rear camera.
+ */
+class RearViewCamera : public CameraBase
+{
+private:
+  // The camera the camera follows, which must be updated before it.
+  const std::shared_ptr<const CameraBase> targetCamera;
+
+  // The FoV of the camera.
+  const float_t fieldOfView;
+  // The aspect ratio of the camera.
+  const float_t aspectRatio;
+  // The closest distance the camera can capture from.
+  const float_t nearPlane;
+  // The farthest distance the camera can capture till.
+  const float_t farPlane;
+
+public:
+  RearViewCamera(const std::string &cameraId, const std::shared_ptr<const CameraBase> &targetCamera)
+      : CameraBase(
+            cameraId,
+            "RearView",
+            glm::vec3(0.0f),
+            glm::vec3(0.0f),
+            glm::vec3(0.0f, 1.0f, 0.0f)),
+        targetCamera(targetCamera),
+        fieldOfView(60.0f),
+        aspectRatio(ASPECT_RATIO),
+        nearPlane(0.1f),
+        farPlane(100.0f) {}
+
+  void update() override
+  {
+    // Only follow the target camera once it moved or turned, so that the matrices are not rebuilt otherwise.
+    const auto newDirection = -targetCamera->getCameraDirection();
+    if (getCameraPosition() == targetCamera->getCameraPosition() && getCameraDirection() == newDirection && getCameraUp() == targetCamera->getCameraUp())
+    {
+      return;
+    }
+
+    // Look the opposite way from the position of the target camera, with the same up vector.
+    CameraBase::setCameraPosition(targetCamera->getCameraPosition());
+    CameraBase::setCameraDirection(newDirection);
+    CameraBase::setCameraUp(targetCamera->getCameraUp());
+  }
+
+  /**
+   * Creates a new instance of the rear-view camera.
+   * 
+   * @param cameraId      The ID of the camera.
+   * @param targetCamera  The camera to look back from.
+   */
+  const static std::shared_ptr<RearViewCamera> create(const std::string &cameraId, const std::shared_ptr<const CameraBase> &targetCamera)
+  {
+    return std::make_shared<RearViewCamera>(cameraId, targetCamera);
+  }
+
+  /**
+   * Calculates and returns the projection matrix of the camera.
+   * 
+   * @return The camera's projection matrix.
+   */
+  const glm::mat4 createProjectionMatrix() const override
+  {
+    return glm::perspective(glm::radians(fieldOfView), aspectRatio, nearPlane, farPlane);
+  }
+};
+
+#endif
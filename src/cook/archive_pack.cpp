@@ -0,0 +1,214 @@
+#ifndef COOK_ARCHIVE_PACK_CPP
+#define COOK_ARCHIVE_PACK_CPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "../include/mapped_file.cpp"
+#include "../include/asset_archive.cpp"
+#include "../include/asset_manifest.cpp"
+#include "../include/lz4.cpp"
+
+/**
+ * Structure for defining an asset being packed into the archive.
+ */
+struct PackedAsset
+{
+  // The path of the asset relative to the assets directory, which it is looked up by.
+  std::string name;
+  // The data stored in the archive.
+  std::vector<uint8_t> data;
+  // The size of the asset once decompressed.
+  uint64_t size;
+  // The way the data is stored.
+  AssetCompression compression;
+};
+
+// The name of the file listing the order the assets are packed in, in the assets directory.
+static constexpr const char *ARCHIVE_ORDER_FILE_NAME = "archive_order.txt";
+
+/**
+ * Check if a file of the assets directory is packed into the archive. The caches written at runtime, the files of the cook,
+ *   and the sources that have cooked versions are left out, since the game never reads them from the archive.
+ * 
+ * @param name          The path of the file relative to the assets directory.
+ * @param cookedAssets  The cooked assets, by the paths of their sources.
+ * 
+ * @return Whether the file is packed.
+ */
+bool isAssetPacked(const std::string &name, const std::map<const std::string, CookedAsset> &cookedAssets)
+{
+  const auto cookedDirectory = std::string(AssetManifest::COOKED_ASSETS_DIRECTORY);
+  const auto isLocalMeshCache = name.size() > 10 && name.compare(name.size() - 10, 10, ".meshcache") == 0 && name.compare(0, cookedDirectory.size(), cookedDirectory) != 0;
+  return name != AssetArchive::ARCHIVE_FILE_NAME && name != ARCHIVE_ORDER_FILE_NAME && name.compare(0, 14, "shaders/cache/") != 0 &&
+         name.find(".tmp") == std::string::npos && !isLocalMeshCache && cookedAssets.find(name) == cookedAssets.end();
+}
+
+/**
+ * Get the order the assets are packed in: the ones listed by the order file first (the cooked versions in place of their
+ *   sources), followed by the rest in the order of their names.
+ * 
+ * @param assetsDirectory  The directory of the assets, ending with a slash.
+ * @param names            The paths of the packed files relative to the assets directory, sorted.
+ * @param cookedAssets     The cooked assets, by the paths of their sources.
+ * 
+ * @return The paths of the files in the order they are packed in.
+ */
+std::vector<std::string> getPackOrder(const std::string &assetsDirectory, const std::vector<std::string> &names, const std::map<const std::string, CookedAsset> &cookedAssets)
+{
+  std::vector<std::string> packOrder;
+  std::set<std::string> orderedNames;
+  std::ifstream stream(assetsDirectory + ARCHIVE_ORDER_FILE_NAME);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    // Skip the empty lines and the comments.
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    const auto cookedAsset = cookedAssets.find(line);
+    const auto name = cookedAsset != cookedAssets.end() ? cookedAsset->second.cookedPath : line;
+    if (std::binary_search(names.begin(), names.end(), name) && orderedNames.insert(name).second)
+    {
+      packOrder.push_back(name);
+    }
+  }
+  for (const auto &name : names)
+  {
+    if (orderedNames.find(name) == orderedNames.end())
+    {
+      packOrder.push_back(name);
+    }
+  }
+  return packOrder;
+}
+
+/**
+ * Pack the assets of the assets directory into the asset archive, replacing the archive if it exists.
+ * 
+ * @param assetsDirectory  The directory of the assets, ending with a slash.
+ * @param cookedAssets     The cooked assets, whose sources are left out of the archive.
+ * @param isCompressed     Whether the assets are compressed with LZ4 (each only if it saves at least an eighth of its size).
+ * 
+ * @return Whether the archive was written.
+ */
+bool packArchive(const std::string &assetsDirectory, const std::vector<CookedAsset> &cookedAssets, const bool &isCompressed)
+{
+  std::map<const std::string, CookedAsset> cookedSources;
+  for (const auto &cookedAsset : cookedAssets)
+  {
+    cookedSources.insert({cookedAsset.sourcePath, cookedAsset});
+  }
+
+  // Find the files to pack, by their paths relative to the assets directory.
+  std::error_code errorCode;
+  std::vector<std::string> names;
+  for (const auto &entry : std::filesystem::recursive_directory_iterator(assetsDirectory, errorCode))
+  {
+    const auto name = entry.path().lexically_relative(assetsDirectory).generic_string();
+    if (entry.is_regular_file() && isAssetPacked(name, cookedSources))
+    {
+      names.push_back(name);
+    }
+  }
+  std::sort(names.begin(), names.end());
+
+  // Read the files in the order they are packed, compressing the ones it pays off for.
+  std::vector<PackedAsset> packedAssets;
+  uint64_t totalSize = 0;
+  uint64_t totalStoredSize = 0;
+  for (const auto &name : getPackOrder(assetsDirectory, names, cookedSources))
+  {
+    const MappedFile file(assetsDirectory + name);
+    if (!file.isMapped())
+    {
+      std::cerr << "Failed to pack: " << name << std::endl;
+      return false;
+    }
+    auto packedAsset = PackedAsset({name, {}, file.getSize(), AssetCompression::NONE});
+    if (isCompressed)
+    {
+      packedAsset.data = Lz4::compress(file.getData(), file.getSize());
+      packedAsset.compression = AssetCompression::LZ4;
+    }
+    if (packedAsset.data.empty() || packedAsset.data.size() > file.getSize() - (file.getSize() / 8))
+    {
+      packedAsset.data.assign(file.getData(), file.getData() + file.getSize());
+      packedAsset.compression = AssetCompression::NONE;
+    }
+    totalSize += packedAsset.size;
+    totalStoredSize += packedAsset.data.size();
+    packedAssets.push_back(std::move(packedAsset));
+  }
+
+  // Lay out the index sorted by the names, followed by the names and the data of the entries in the packed order.
+  auto sortedIndices = std::vector<size_t>(packedAssets.size());
+  for (size_t i = 0; i < sortedIndices.size(); i++)
+  {
+    sortedIndices[i] = i;
+  }
+  std::sort(sortedIndices.begin(), sortedIndices.end(), [&packedAssets](const size_t &a, const size_t &b) { return packedAssets[a].name < packedAssets[b].name; });
+  std::string entryNames;
+  auto entries = std::vector<AssetArchiveEntry>(packedAssets.size());
+  for (size_t i = 0; i < sortedIndices.size(); i++)
+  {
+    const auto &packedAsset = packedAssets[sortedIndices[i]];
+    entries[i] = AssetArchiveEntry({0, packedAsset.data.size(), packedAsset.size, static_cast<uint32_t>(entryNames.size()), static_cast<uint32_t>(packedAsset.name.size()), packedAsset.compression, 0});
+    entryNames += packedAsset.name;
+  }
+  const auto alignOffset = [](const uint64_t &offset) { return (offset + AssetArchive::ARCHIVE_DATA_ALIGNMENT - 1) / AssetArchive::ARCHIVE_DATA_ALIGNMENT * AssetArchive::ARCHIVE_DATA_ALIGNMENT; };
+  auto dataOffset = alignOffset(sizeof(AssetArchiveHeader) + (entries.size() * sizeof(AssetArchiveEntry)) + entryNames.size());
+  auto dataOffsets = std::vector<uint64_t>(packedAssets.size());
+  for (size_t i = 0; i < packedAssets.size(); i++)
+  {
+    dataOffsets[i] = dataOffset;
+    dataOffset = alignOffset(dataOffset + packedAssets[i].data.size());
+  }
+  for (size_t i = 0; i < sortedIndices.size(); i++)
+  {
+    entries[i].dataOffset = dataOffsets[sortedIndices[i]];
+  }
+
+  // Write to a temporary file first, so that an archive being packed is never loaded half finished.
+  const auto archivePath = assetsDirectory + AssetArchive::ARCHIVE_FILE_NAME;
+  const auto tempFilePath = archivePath + ".tmp";
+  {
+    std::ofstream stream(tempFilePath, std::ios::binary | std::ios::trunc);
+    const auto header = AssetArchiveHeader({AssetArchive::ARCHIVE_MAGIC, AssetArchive::ARCHIVE_VERSION, static_cast<uint32_t>(entries.size()), static_cast<uint32_t>(entryNames.size())});
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(AssetArchiveHeader));
+    stream.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(AssetArchiveEntry));
+    stream.write(entryNames.data(), entryNames.size());
+    for (size_t i = 0; i < packedAssets.size(); i++)
+    {
+      // Pad up to the aligned offset of the entry.
+      const auto padding = std::string(dataOffsets[i] - static_cast<uint64_t>(stream.tellp()), '\0');
+      stream.write(padding.data(), padding.size());
+      stream.write(reinterpret_cast<const char *>(packedAssets[i].data.data()), packedAssets[i].data.size());
+    }
+    if (!stream)
+    {
+      stream.close();
+      remove(tempFilePath.c_str());
+      return false;
+    }
+  }
+  remove(archivePath.c_str());
+  if (rename(tempFilePath.c_str(), archivePath.c_str()) != 0)
+  {
+    return false;
+  }
+  std::cout << "Packed " << archivePath << " (" << packedAssets.size() << " assets, " << totalStoredSize << " of " << totalSize << " bytes stored)" << std::endl;
+  return true;
+}
+
+#endif
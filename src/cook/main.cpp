@@ -0,0 +1,168 @@
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "../include/asset_manifest.cpp"
+#include "../include/object.cpp"
+#include "../include/scene_file.cpp"
+#include "texture_cook.cpp"
+#include "archive_pack.cpp"
+
+/**
+ * Structure for defining a kind of asset the cook writes, and how.
+ */
+struct CookAssetKind
+{
+  // The directory of the source assets, relative to the assets directory.
+  std::string sourceDirectory;
+  // The extension of the source assets.
+  std::string sourceExtension;
+  // The extension of the cooked assets, replacing the extension of the sources.
+  std::string cookedExtension;
+  // The function cooking a source asset into the given path.
+  bool (*cook)(const std::string &sourceFilePath, const std::string &cookedFilePath);
+};
+
+/**
+ * Cook an OBJ object into a mesh cache, in the vertex format the models create the objects with.
+ * 
+ * @param sourceFilePath  The path of the OBJ file.
+ * @param cookedFilePath  The path of the mesh cache to write.
+ * 
+ * @return Whether the object was cooked.
+ */
+bool cookObject(const std::string &sourceFilePath, const std::string &cookedFilePath)
+{
+  return ObjectManager::cookObject(sourceFilePath, cookedFilePath);
+}
+
+/**
+ * Cook the text form of a scene file into its binary form.
+ * 
+ * @param sourceFilePath  The path of the text scene file.
+ * @param cookedFilePath  The path of the binary scene file to write.
+ * 
+ * @return Whether the scene file was cooked.
+ */
+bool cookScene(const std::string &sourceFilePath, const std::string &cookedFilePath)
+{
+  return SceneFile::cookScene(sourceFilePath, cookedFilePath);
+}
+
+/**
+ * Cooks the objects, the textures and the scene files of the assets directory ahead of time: the objects into mesh caches with their levels of
+ *   detail and collider positions, the BMP textures into BC1 compressed DDS files with their mip chains, and the text scene files
+ *   into binary ones. The cooked assets are
+ *   written to the cooked directory of the assets with a manifest of the sources they were cooked from, which the game loads them
+ *   by. The assets cooked from unchanged sources are kept, unless all of them are cooked again. The assets can then be packed
+ *   into the asset archive (compressed with LZ4 unless they are stored as they are), which the game reads them from instead of
+ *   the files, so it has to be packed again whenever an asset changes.
+ * 
+ * Usage: asset_cook [--force] [--pack] [--store] [assets directory]
+ */
+int main(int argc, char **argv)
+{
+  auto assetsDirectory = std::string(AssetManifest::ASSETS_DIRECTORY);
+  auto isForced = false;
+  auto isPacked = false;
+  auto isStored = false;
+
+  for (auto i = 1; i < argc; i++)
+  {
+    const std::string argument(argv[i]);
+    if (argument == "--force")
+    {
+      isForced = true;
+    }
+    else if (argument == "--pack")
+    {
+      isPacked = true;
+    }
+    else if (argument == "--store")
+    {
+      isStored = true;
+    }
+    else if (!argument.empty() && argument[0] != '-')
+    {
+      assetsDirectory = argument.back() == '/' ? argument : argument + "/";
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--force] [--pack] [--store] [assets directory]" << std::endl;
+      return 1;
+    }
+  }
+
+  const auto cookedDirectory = std::string(AssetManifest::COOKED_ASSETS_DIRECTORY);
+  const auto manifestPath = AssetManifest::getManifestPath(assetsDirectory);
+  const auto previousAssets = AssetManifest::readManifest(manifestPath);
+  const auto assetKinds = std::vector<CookAssetKind>({{"objects/", ".obj", ".obj.meshcache", cookObject},
+                                                      {"textures/", ".bmp", ".dds", cookTexture},
+                                                      {"scenes/", ".scene", ".scene.bin", cookScene}});
+
+  std::vector<CookedAsset> cookedAssets;
+  auto failedCount = 0;
+  for (const auto &assetKind : assetKinds)
+  {
+    // Cook the sources in the order of their names, so that the manifest only changes with the assets.
+    std::error_code errorCode;
+    std::vector<std::string> sourceNames;
+    for (const auto &entry : std::filesystem::directory_iterator(assetsDirectory + assetKind.sourceDirectory, errorCode))
+    {
+      if (entry.is_regular_file() && entry.path().extension() == assetKind.sourceExtension)
+      {
+        sourceNames.push_back(entry.path().stem().string());
+      }
+    }
+    std::sort(sourceNames.begin(), sourceNames.end());
+    std::filesystem::create_directories(assetsDirectory + cookedDirectory + assetKind.sourceDirectory, errorCode);
+
+    for (const auto &sourceName : sourceNames)
+    {
+      auto cookedAsset = CookedAsset({assetKind.sourceDirectory + sourceName + assetKind.sourceExtension,
+                                      cookedDirectory + assetKind.sourceDirectory + sourceName + assetKind.cookedExtension, 0, 0, 0});
+      const auto sourceFilePath = assetsDirectory + cookedAsset.sourcePath;
+      const auto cookedFilePath = assetsDirectory + cookedAsset.cookedPath;
+      AssetManifest::getFileStamp(sourceFilePath, cookedAsset.sourceSize, cookedAsset.sourceModifiedTime);
+      cookedAsset.contentHash = AssetManifest::hashFile(sourceFilePath);
+
+      // Keep the cooked asset if its source has the contents it was cooked from.
+      const auto previousAsset = previousAssets.find(cookedAsset.sourcePath);
+      if (!isForced && previousAsset != previousAssets.end() && previousAsset->second.cookedPath == cookedAsset.cookedPath &&
+          previousAsset->second.contentHash == cookedAsset.contentHash && std::filesystem::exists(cookedFilePath, errorCode))
+      {
+        std::cout << "Up to date: " << cookedAsset.sourcePath << std::endl;
+        cookedAssets.push_back(cookedAsset);
+        continue;
+      }
+
+      const auto startTime = std::chrono::steady_clock::now();
+      if (!assetKind.cook(sourceFilePath, cookedFilePath))
+      {
+        std::cerr << "Failed to cook: " << cookedAsset.sourcePath << std::endl;
+        failedCount++;
+        continue;
+      }
+      const auto cookTime = std::chrono::duration<double_t, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+      std::cout << "Cooked: " << cookedAsset.sourcePath << " -> " << cookedAsset.cookedPath << " (" << std::filesystem::file_size(cookedFilePath, errorCode) << " bytes, " << cookTime << "ms)" << std::endl;
+      cookedAssets.push_back(cookedAsset);
+    }
+  }
+
+  if (!AssetManifest::writeManifest(manifestPath, cookedAssets))
+  {
+    std::cerr << "Failed to write the manifest: " << manifestPath << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << manifestPath << " (" << cookedAssets.size() << " assets)" << std::endl;
+  if (isPacked && !packArchive(assetsDirectory, cookedAssets, !isStored))
+  {
+    std::cerr << "Failed to pack the archive: " << assetsDirectory << AssetArchive::ARCHIVE_FILE_NAME << std::endl;
+    return 1;
+  }
+  return failedCount > 0 ? 1 : 0;
+}
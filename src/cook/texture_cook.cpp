@@ -0,0 +1,344 @@
+#ifndef COOK_TEXTURE_COOK_CPP
+#define COOK_TEXTURE_COOK_CPP
+
+#include <cmath>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "../include/mapped_file.cpp"
+
+/**
+ * Structure for defining an image being cooked, stored with the bottom row first like the BMP images.
+ */
+struct CookImage
+{
+  // The size of the image in pixels.
+  uint32_t width;
+  uint32_t height;
+  // The red, green and blue values of each pixel, row by row.
+  std::vector<uint8_t> pixels;
+};
+
+/**
+ * Read an uncompressed 24-bit BMP image.
+ * 
+ * @param bmpFilePath  The path of the BMP file.
+ * @param outImage     The output variable for the image.
+ * 
+ * @return Whether the file is a BMP image of the supported format.
+ */
+bool readBmpImage(const std::string &bmpFilePath, CookImage &outImage)
+{
+  const MappedFile file(bmpFilePath);
+  if (!file.isMapped() || file.getSize() < 54 || file.getData()[0] != 'B' || file.getData()[1] != 'M')
+  {
+    return false;
+  }
+  const auto fileData = file.getData();
+  uint32_t dataPos, compression;
+  int32_t width, height;
+  uint16_t bitsPerPixel;
+  memcpy(&dataPos, &fileData[0x0A], sizeof(uint32_t));
+  memcpy(&width, &fileData[0x12], sizeof(int32_t));
+  memcpy(&height, &fileData[0x16], sizeof(int32_t));
+  memcpy(&bitsPerPixel, &fileData[0x1C], sizeof(uint16_t));
+  memcpy(&compression, &fileData[0x1E], sizeof(uint32_t));
+  if (width <= 0 || height == 0 || bitsPerPixel != 24 || compression != 0)
+  {
+    return false;
+  }
+
+  // The rows are padded to 4 bytes, and stored with the top row first if the height is negative.
+  const auto rowCount = static_cast<uint32_t>(std::abs(height));
+  const uint64_t rowSize = ((static_cast<uint64_t>(width) * 3) + 3) / 4 * 4;
+  if (dataPos + (rowSize * rowCount) > file.getSize())
+  {
+    return false;
+  }
+  outImage.width = width;
+  outImage.height = rowCount;
+  outImage.pixels.resize(static_cast<size_t>(width) * rowCount * 3);
+  for (uint32_t y = 0; y < rowCount; y++)
+  {
+    const auto row = &fileData[dataPos + (rowSize * (height < 0 ? rowCount - 1 - y : y))];
+    for (int32_t x = 0; x < width; x++)
+    {
+      const auto pixel = &outImage.pixels[(static_cast<size_t>(y) * width + x) * 3];
+      // The BMP pixels are stored as blue, green and red.
+      pixel[0] = row[(x * 3) + 2];
+      pixel[1] = row[(x * 3) + 1];
+      pixel[2] = row[x * 3];
+    }
+  }
+  return true;
+}
+
+/**
+ * Create the next level of a mip chain, averaging each 2x2 pixels of the image (the last row or column is repeated for the odd sizes).
+ * 
+ * @param image  The image.
+ * 
+ * @return The image at half the size, at least 1x1.
+ */
+CookImage createMipLevel(const CookImage &image)
+{
+  auto mipLevel = CookImage({std::max(image.width / 2, 1u), std::max(image.height / 2, 1u), {}});
+  mipLevel.pixels.resize(static_cast<size_t>(mipLevel.width) * mipLevel.height * 3);
+  for (uint32_t y = 0; y < mipLevel.height; y++)
+  {
+    for (uint32_t x = 0; x < mipLevel.width; x++)
+    {
+      for (uint32_t channel = 0; channel < 3; channel++)
+      {
+        uint32_t sum = 0;
+        for (uint32_t offset = 0; offset < 4; offset++)
+        {
+          const auto sourceX = std::min((x * 2) + (offset % 2), image.width - 1);
+          const auto sourceY = std::min((y * 2) + (offset / 2), image.height - 1);
+          sum += image.pixels[((static_cast<size_t>(sourceY) * image.width + sourceX) * 3) + channel];
+        }
+        mipLevel.pixels[((static_cast<size_t>(y) * mipLevel.width + x) * 3) + channel] = (sum + 2) / 4;
+      }
+    }
+  }
+  return mipLevel;
+}
+
+/**
+ * Pack a color into the 5:6:5 bits of the BC1 endpoints.
+ * 
+ * @param color  The red, green and blue values (between 0 and 255).
+ * 
+ * @return The packed color.
+ */
+uint16_t packBc1Color(const glm::vec3 &color)
+{
+  const auto clamped = glm::clamp(color, glm::vec3(0.0f), glm::vec3(255.0f));
+  return (static_cast<uint16_t>(std::lround(clamped.r * 31.0f / 255.0f)) << 11) |
+         (static_cast<uint16_t>(std::lround(clamped.g * 63.0f / 255.0f)) << 5) |
+         static_cast<uint16_t>(std::lround(clamped.b * 31.0f / 255.0f));
+}
+
+/**
+ * Unpack a 5:6:5 color of the BC1 endpoints, like the GPU decodes it.
+ * 
+ * @param packedColor  The packed color.
+ * 
+ * @return The red, green and blue values (between 0 and 255).
+ */
+glm::vec3 unpackBc1Color(const uint16_t &packedColor)
+{
+  const auto red = (packedColor >> 11) & 31;
+  const auto green = (packedColor >> 5) & 63;
+  const auto blue = packedColor & 31;
+  return glm::vec3((red << 3) | (red >> 2), (green << 2) | (green >> 4), (blue << 3) | (blue >> 2));
+}
+
+/**
+ * Encode a 4x4 block of pixels in the opaque BC1 mode, with the endpoints at the ends of the principal axis of the colors, and
+ *   the closest of the four palette colors picked for each pixel.
+ * 
+ * @param blockPixels  The colors of the pixels, row by row.
+ * @param outBlock     The output variable for the 8 bytes of the block.
+ */
+void encodeBc1Block(const std::array<glm::vec3, 16> &blockPixels, uint8_t *outBlock)
+{
+  // Find the mean and the covariance of the colors.
+  auto mean = glm::vec3(0.0f);
+  for (const auto &pixel : blockPixels)
+  {
+    mean += pixel / 16.0f;
+  }
+  auto covariance = glm::mat3(0.0f);
+  for (const auto &pixel : blockPixels)
+  {
+    const auto offset = pixel - mean;
+    covariance += glm::outerProduct(offset, offset);
+  }
+
+  // Find the principal axis by power iteration, starting from the longest side of the bounding box.
+  auto minColor = blockPixels[0];
+  auto maxColor = blockPixels[0];
+  for (const auto &pixel : blockPixels)
+  {
+    minColor = glm::min(minColor, pixel);
+    maxColor = glm::max(maxColor, pixel);
+  }
+  auto axis = maxColor - minColor;
+  for (uint32_t i = 0; i < 8 && glm::dot(axis, axis) > 0.0f; i++)
+  {
+    axis = covariance * axis;
+    axis /= std::max({std::abs(axis.r), std::abs(axis.g), std::abs(axis.b), 1e-6f});
+  }
+
+  // Put the endpoints at the extreme projections of the colors on the axis.
+  auto startColor = minColor;
+  auto endColor = maxColor;
+  if (glm::dot(axis, axis) > 0.0f)
+  {
+    auto minProjection = glm::dot(blockPixels[0] - mean, axis);
+    auto maxProjection = minProjection;
+    for (const auto &pixel : blockPixels)
+    {
+      minProjection = std::min(minProjection, glm::dot(pixel - mean, axis));
+      maxProjection = std::max(maxProjection, glm::dot(pixel - mean, axis));
+    }
+    const auto axisLengthSquared = glm::dot(axis, axis);
+    startColor = mean + (axis * (minProjection / axisLengthSquared));
+    endColor = mean + (axis * (maxProjection / axisLengthSquared));
+  }
+
+  // The first endpoint must be the larger one for the opaque four color mode, and equal endpoints only need the first color.
+  auto color0 = packBc1Color(endColor);
+  auto color1 = packBc1Color(startColor);
+  if (color0 < color1)
+  {
+    std::swap(color0, color1);
+  }
+  std::array<glm::vec3, 4> palette;
+  palette[0] = unpackBc1Color(color0);
+  palette[1] = unpackBc1Color(color1);
+  palette[2] = ((palette[0] * 2.0f) + palette[1]) / 3.0f;
+  palette[3] = (palette[0] + (palette[1] * 2.0f)) / 3.0f;
+
+  // Pick the closest palette color of each pixel, with the first pixel in the lowest bits.
+  uint32_t colorIndices = 0;
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    uint32_t bestIndex = 0;
+    auto bestError = glm::dot(blockPixels[i] - palette[0], blockPixels[i] - palette[0]);
+    for (uint32_t index = 1; index < (color0 == color1 ? 1u : 4u); index++)
+    {
+      const auto error = glm::dot(blockPixels[i] - palette[index], blockPixels[i] - palette[index]);
+      if (error < bestError)
+      {
+        bestIndex = index;
+        bestError = error;
+      }
+    }
+    colorIndices |= bestIndex << (i * 2);
+  }
+
+  memcpy(&outBlock[0], &color0, sizeof(uint16_t));
+  memcpy(&outBlock[2], &color1, sizeof(uint16_t));
+  memcpy(&outBlock[4], &colorIndices, sizeof(uint32_t));
+}
+
+/**
+ * Encode an image in the BC1 format, the blocks row by row. The partial blocks at the edges repeat the last row or column.
+ * 
+ * @param image  The image.
+ * 
+ * @return The bytes of the blocks.
+ */
+std::vector<uint8_t> encodeBc1Image(const CookImage &image)
+{
+  const auto blocksWide = (image.width + 3) / 4;
+  const auto blocksHigh = (image.height + 3) / 4;
+  auto blocks = std::vector<uint8_t>(static_cast<size_t>(blocksWide) * blocksHigh * 8);
+  std::array<glm::vec3, 16> blockPixels;
+  for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+  {
+    for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+    {
+      for (uint32_t i = 0; i < 16; i++)
+      {
+        const auto x = std::min((blockX * 4) + (i % 4), image.width - 1);
+        const auto y = std::min((blockY * 4) + (i / 4), image.height - 1);
+        const auto pixel = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 3];
+        blockPixels[i] = glm::vec3(pixel[0], pixel[1], pixel[2]);
+      }
+      encodeBc1Block(blockPixels, &blocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * 8]);
+    }
+  }
+  return blocks;
+}
+
+/**
+ * Write a DXT1 DDS file with the given mip chain, in the layout the texture manager loads.
+ * 
+ * @param ddsFilePath  The path of the DDS file.
+ * @param width        The width of the largest level in pixels.
+ * @param height       The height of the largest level in pixels.
+ * @param mipLevels    The encoded blocks of each level, from the largest to the smallest.
+ * 
+ * @return Whether the file was written.
+ */
+bool writeDdsFile(const std::string &ddsFilePath, const uint32_t &width, const uint32_t &height, const std::vector<std::vector<uint8_t>> &mipLevels)
+{
+  // The 4 byte magic followed by the 124 byte header, with the 32 byte pixel format at 0x4C.
+  uint8_t header[128] = {};
+  const auto writeHeaderValue = [&header](const uint32_t &offset, const uint32_t &value) { memcpy(&header[offset], &value, sizeof(uint32_t)); };
+  memcpy(&header[0x00], "DDS ", 4);
+  writeHeaderValue(0x04, 124);
+  // The caps, height, width, pixel format, mip map count and linear size flags.
+  writeHeaderValue(0x08, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+  writeHeaderValue(0x0C, height);
+  writeHeaderValue(0x10, width);
+  writeHeaderValue(0x14, mipLevels[0].size());
+  writeHeaderValue(0x1C, mipLevels.size());
+  writeHeaderValue(0x4C, 32);
+  // The four character code flag of the pixel format.
+  writeHeaderValue(0x50, 0x4);
+  memcpy(&header[0x54], "DXT1", 4);
+  // The complex, texture and mip map caps.
+  writeHeaderValue(0x6C, 0x8 | 0x1000 | 0x400000);
+
+  // Write to a temporary file first, so that a texture being cooked is never loaded half finished.
+  const auto tempFilePath = ddsFilePath + ".tmp";
+  {
+    std::ofstream stream(tempFilePath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+    for (const auto &mipLevel : mipLevels)
+    {
+      stream.write(reinterpret_cast<const char *>(&mipLevel[0]), mipLevel.size());
+    }
+    if (!stream)
+    {
+      stream.close();
+      remove(tempFilePath.c_str());
+      return false;
+    }
+  }
+  remove(ddsFilePath.c_str());
+  return rename(tempFilePath.c_str(), ddsFilePath.c_str()) == 0;
+}
+
+/**
+ * Cook a BMP texture into a BC1 compressed DDS file with the full mip chain, which loads without generating the mip-maps and
+ *   takes a sixth of the GPU memory.
+ * 
+ * @param bmpFilePath  The path of the BMP file.
+ * @param ddsFilePath  The path of the DDS file to write.
+ * 
+ * @return Whether the texture was cooked.
+ */
+bool cookTexture(const std::string &bmpFilePath, const std::string &ddsFilePath)
+{
+  auto image = CookImage({0, 0, {}});
+  if (!readBmpImage(bmpFilePath, image))
+  {
+    return false;
+  }
+  const auto width = image.width;
+  const auto height = image.height;
+
+  // Encode every level down to 1x1, like the texture manager uploads them.
+  std::vector<std::vector<uint8_t>> mipLevels;
+  mipLevels.push_back(encodeBc1Image(image));
+  while (image.width > 1 || image.height > 1)
+  {
+    image = createMipLevel(image);
+    mipLevels.push_back(encodeBc1Image(image));
+  }
+  return writeDdsFile(ddsFilePath, width, height, mipLevels);
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef INCLUDE_ALLOCATION_TRACKER_CPP
+#define INCLUDE_ALLOCATION_TRACKER_CPP
+
+#include <new>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+
+#include "constants.cpp"
+#include "text_arena.cpp"
+
+// Concatenate two tokens after expanding them, for naming the zone variables after their lines.
+#define ALLOCATION_TRACKER_CONCAT_TOKENS(first, second) first##second
+#define ALLOCATION_TRACKER_CONCAT(first, second) ALLOCATION_TRACKER_CONCAT_TOKENS(first, second)
+
+// The allocations are only tracked if the build defines ALLOCATION_TRACKING_ENABLED, which replaces the global operator new and
+//   operator delete, and the no-alloc zones are compiled out otherwise.
+#ifdef ALLOCATION_TRACKING_ENABLED
+// Flag the allocations made in the rest of the scope by the calling thread, as a zone with the given name which must not allocate.
+#define NO_ALLOC_ZONE(zoneName) const NoAllocZone ALLOCATION_TRACKER_CONCAT(noAllocZone, __LINE__)(zoneName)
+#else
+#define NO_ALLOC_ZONE(zoneName)
+#endif
+
+/**
+ * A manager class for tracking the heap allocations made through the global operator new, counting them and their bytes over
+ *   all the threads for each frame, and on each thread for the zones of the CPU profiler. The counters are updated by the
+ *   replaced operator new on any thread, so they are static atomics (and thread locals) initialized before any allocation can
+ *   be made, and the frames are handed over to the debug text under a mutex.
+ */
+class AllocationTracker
+{
+private:
+  // Singleton instance of the allocation tracker.
+  static AllocationTracker instance;
+
+  // The number of allocations and of bytes allocated since the program started, over all the threads.
+  inline static std::atomic<uint64_t> allocationsCount = 0;
+  inline static std::atomic<uint64_t> allocatedBytes = 0;
+  // The number of allocations and of bytes allocated since the calling thread started.
+  inline static thread_local uint64_t threadAllocationsCount = 0;
+  inline static thread_local uint64_t threadAllocatedBytes = 0;
+  // The name of the no-alloc zone the calling thread is in, or null if it is in none.
+  inline static thread_local const char *threadNoAllocZoneName = nullptr;
+  // The number of allocations made inside the no-alloc zones since the program started, and the name of the zone of the last one.
+  inline static std::atomic<uint64_t> violationsCount = 0;
+  inline static std::atomic<const char *> lastViolationZoneName = nullptr;
+
+  // The counters of the program when the last frame ended.
+  uint64_t frameStartAllocationsCount;
+  uint64_t frameStartAllocatedBytes;
+  // The mutex guarding the counts of the last frame.
+  mutable std::mutex lastFrameMutex;
+  // The number of allocations and of bytes allocated in the last frame.
+  uint64_t lastFrameAllocationsCount;
+  uint64_t lastFrameAllocatedBytes;
+  // The names of the no-alloc zones reported so far, so that each is reported once.
+  std::array<const char *, NO_ALLOC_REPORTED_ZONES_COUNT> reportedZoneNames;
+  size_t reportedZonesCount;
+
+  AllocationTracker()
+      : frameStartAllocationsCount(0),
+        frameStartAllocatedBytes(0),
+        lastFrameAllocationsCount(0),
+        lastFrameAllocatedBytes(0),
+        reportedZoneNames({}),
+        reportedZonesCount(0) {}
+
+  /**
+   * Report the zone of the last allocation made inside a no-alloc zone, unless it was reported before.
+   */
+  void reportViolation()
+  {
+    const auto zoneName = lastViolationZoneName.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < reportedZonesCount; i++)
+    {
+      if (reportedZoneNames[i] == zoneName)
+      {
+        return;
+      }
+    }
+    if (reportedZonesCount < reportedZoneNames.size())
+    {
+      reportedZoneNames[reportedZonesCount++] = zoneName;
+      std::cerr << "Allocation in the no-alloc zone " << zoneName << " (" << violationsCount.load(std::memory_order_relaxed) << " so far)" << std::endl;
+    }
+  }
+
+public:
+  // Preventing copying the allocation tracker, making sure only one instance can exist.
+  AllocationTracker(const AllocationTracker &) = delete;
+
+  /**
+   * Count an allocation made by the calling thread. Called by the replaced operator new, so it must not allocate itself.
+   * 
+   * @param size  The number of bytes allocated.
+   */
+  static void recordAllocation(const std::size_t &size)
+  {
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    threadAllocationsCount++;
+    threadAllocatedBytes += size;
+    if (IS_NO_ALLOC_ZONE_CHECK_ENABLED && threadNoAllocZoneName != nullptr)
+    {
+      violationsCount.fetch_add(1, std::memory_order_relaxed);
+      lastViolationZoneName.store(threadNoAllocZoneName, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Get the number of allocations made since the program started, over all the threads.
+   * 
+   * @return The number of allocations, always 0 if the allocations are not tracked.
+   */
+  static uint64_t getAllocationsCount()
+  {
+    return allocationsCount.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the number of allocations made by the calling thread since it started, for the zones of the thread to count theirs.
+   * 
+   * @return The number of allocations of the thread, always 0 if the allocations are not tracked.
+   */
+  static const uint64_t &getThreadAllocationsCount()
+  {
+    return threadAllocationsCount;
+  }
+
+  /**
+   * Get the number of bytes allocated by the calling thread since it started.
+   * 
+   * @return The number of bytes allocated by the thread, always 0 if the allocations are not tracked.
+   */
+  static const uint64_t &getThreadAllocatedBytes()
+  {
+    return threadAllocatedBytes;
+  }
+
+  /**
+   * Enter a no-alloc zone on the calling thread.
+   * 
+   * @param zoneName  The name of the zone, which has to outlive the program (e.g. a string literal).
+   * 
+   * @return The name of the no-alloc zone the thread was in before, to go back to once the zone ends.
+   */
+  static const char *enterNoAllocZone(const char *zoneName)
+  {
+    const auto lastZoneName = threadNoAllocZoneName;
+    threadNoAllocZoneName = zoneName;
+    return lastZoneName;
+  }
+
+  /**
+   * Go back to the no-alloc zone the calling thread was in before the one ending.
+   * 
+   * @param lastZoneName  The name of the no-alloc zone the thread was in before, or null.
+   */
+  static void exitNoAllocZone(const char *lastZoneName)
+  {
+    threadNoAllocZoneName = lastZoneName;
+  }
+
+  /**
+   * End the frame, handing the counts of its allocations over to the debug text, and report the no-alloc zones that allocated
+   *   for the first time. Done once per frame by the main thread.
+   */
+  void endFrame()
+  {
+    const auto currentAllocationsCount = allocationsCount.load(std::memory_order_relaxed);
+    const auto currentAllocatedBytes = allocatedBytes.load(std::memory_order_relaxed);
+    {
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      lastFrameAllocationsCount = currentAllocationsCount - frameStartAllocationsCount;
+      lastFrameAllocatedBytes = currentAllocatedBytes - frameStartAllocatedBytes;
+    }
+    frameStartAllocationsCount = currentAllocationsCount;
+    frameStartAllocatedBytes = currentAllocatedBytes;
+
+    if (violationsCount.load(std::memory_order_relaxed) > 0)
+    {
+      reportViolation();
+    }
+  }
+
+  /**
+   * Get the number of allocations made in the last frame.
+   * 
+   * @return The number of allocations.
+   */
+  uint64_t getLastFrameAllocationsCount() const
+  {
+    const std::lock_guard<std::mutex> lock(lastFrameMutex);
+    return lastFrameAllocationsCount;
+  }
+
+  /**
+   * Write the allocations of the last frame as text, along with the allocations made inside the no-alloc zones.
+   * 
+   * @param text  The writer of the text, written the counts.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+#ifdef ALLOCATION_TRACKING_ENABLED
+    auto frameAllocationsCount = static_cast<uint64_t>(0), frameAllocatedBytes = static_cast<uint64_t>(0);
+    {
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      frameAllocationsCount = lastFrameAllocationsCount;
+      frameAllocatedBytes = lastFrameAllocatedBytes;
+    }
+    text << frameAllocationsCount << " (" << frameAllocatedBytes / 1024.0 << "KB) | No-Alloc Violations: " << violationsCount.load(std::memory_order_relaxed);
+    const auto zoneName = lastViolationZoneName.load(std::memory_order_relaxed);
+    if (zoneName != nullptr)
+    {
+      text << " (Last In " << zoneName << ")";
+    }
+#else
+    text << "Not Tracked (ALLOCATION_TRACKING Off)";
+#endif
+  }
+
+  /**
+   * Returns the singleton instance of the allocation tracker.
+   * 
+   * @return The allocation tracker singleton instance.
+   */
+  static AllocationTracker &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the allocation tracker singleton instance static variable.
+AllocationTracker AllocationTracker::instance;
+
+/**
+ * A class for flagging the allocations made by the calling thread over the scope it is created in, usually through the
+ *   NO_ALLOC_ZONE macro.
+ */
+class NoAllocZone
+{
+private:
+  // The name of the no-alloc zone the thread was in before the zone.
+  const char *const lastZoneName;
+
+public:
+  explicit NoAllocZone(const char *zoneName)
+      : lastZoneName(AllocationTracker::enterNoAllocZone(zoneName)) {}
+
+  ~NoAllocZone()
+  {
+    AllocationTracker::exitNoAllocZone(lastZoneName);
+  }
+
+  // Preventing copying the zone, since it would go back to the zone before twice.
+  NoAllocZone(const NoAllocZone &) = delete;
+};
+
+#ifdef ALLOCATION_TRACKING_ENABLED
+// Keeping the operators out of line, since GCC warns about the frees of the pointers it sees allocated by operator new once
+//   both are inlined into the same function.
+#if defined(__GNUC__)
+#define ALLOCATION_TRACKER_NOINLINE __attribute__((noinline))
+#else
+#define ALLOCATION_TRACKER_NOINLINE
+#endif
+
+// The replaced global operator new, counting each allocation before making it with malloc. The array and the nothrow forms of
+//   operator new of the standard library end up in this one (the over-aligned forms are not counted).
+ALLOCATION_TRACKER_NOINLINE void *operator new(std::size_t size)
+{
+  AllocationTracker::recordAllocation(size);
+  if (const auto memory = std::malloc(size == 0 ? 1 : size))
+  {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+ALLOCATION_TRACKER_NOINLINE void operator delete(void *memory) noexcept
+{
+  std::free(memory);
+}
+
+ALLOCATION_TRACKER_NOINLINE void operator delete(void *memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef INCLUDE_ASSET_ARCHIVE_CPP
+#define INCLUDE_ASSET_ARCHIVE_CPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+
+#include <sys/stat.h>
+
+#include "mapped_file.cpp"
+#include "lz4.cpp"
+
+/**
+ * An enum for the ways the entries of an asset archive are stored.
+ */
+enum class AssetCompression : uint32_t
+{
+  NONE,
+  LZ4
+};
+
+/**
+ * Structure for defining the header an asset archive starts with, followed by the index of its entries sorted by their names,
+ *   the names of the entries, and the data of the entries (in the order the scenes read them, not the order of the index).
+ */
+struct AssetArchiveHeader
+{
+  // The magic number identifying asset archives, and the version of their layout.
+  uint32_t magic;
+  uint32_t version;
+  // The number of entries in the index.
+  uint32_t entriesCount;
+  // The size of the names of the entries in bytes.
+  uint32_t namesSize;
+};
+
+/**
+ * Structure for defining an entry of the index of an asset archive.
+ */
+struct AssetArchiveEntry
+{
+  // The offset of the data of the entry from the start of the archive.
+  uint64_t dataOffset;
+  // The size of the data stored in the archive, and the size of the asset once decompressed.
+  uint64_t storedSize;
+  uint64_t size;
+  // The offset of the name of the entry in the names, and its length (the names are not terminated).
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  // The way the data of the entry is stored.
+  AssetCompression compression;
+  // Padding to keep the entries 8 byte aligned.
+  uint32_t padding;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 16, "The asset archive header must not contain any implicit padding");
+static_assert(sizeof(AssetArchiveEntry) == 40, "The asset archive entries must not contain any implicit padding");
+
+/**
+ * A manager class for the asset archive, a single file packing the assets that is mapped once when the program starts, so that
+ *   loading a scene reads one file sequentially instead of opening every asset separately. The assets are looked up in the
+ *   archive by their paths relative to the assets directory, and the loaders fall back to the files for the assets it does not
+ *   have (or if there is no archive).
+ * The archive is never changed once mapped, so that it can be looked up from the worker threads.
+ */
+class AssetArchive
+{
+private:
+  // Singleton instance of the asset archive.
+  static AssetArchive instance;
+
+  // The mapped archive file.
+  const MappedFile archiveFile;
+  // The index of the entries sorted by their names, pointing into the mapped file (null if there is no valid archive).
+  const AssetArchiveEntry *entries;
+  // The number of entries in the index.
+  uint32_t entriesCount;
+  // The names of the entries, pointing into the mapped file.
+  const char *names;
+
+  AssetArchive()
+      : archiveFile(std::string(ASSETS_DIRECTORY) + ARCHIVE_FILE_NAME),
+        entries(nullptr),
+        entriesCount(0),
+        names(nullptr)
+  {
+    // Check if the archive was packed by this version of the layout.
+    AssetArchiveHeader header;
+    if (!archiveFile.isMapped() || archiveFile.getSize() < sizeof(AssetArchiveHeader))
+    {
+      return;
+    }
+    memcpy(&header, archiveFile.getData(), sizeof(AssetArchiveHeader));
+    const uint64_t namesOffset = sizeof(AssetArchiveHeader) + (static_cast<uint64_t>(header.entriesCount) * sizeof(AssetArchiveEntry));
+    if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || namesOffset + header.namesSize > archiveFile.getSize())
+    {
+      return;
+    }
+
+    // Check if the names and the data of every entry are within the file, so that a truncated archive is never read past its end.
+    const auto archiveEntries = reinterpret_cast<const AssetArchiveEntry *>(archiveFile.getData() + sizeof(AssetArchiveHeader));
+    for (uint32_t i = 0; i < header.entriesCount; i++)
+    {
+      const auto &entry = archiveEntries[i];
+      if (static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > header.namesSize || entry.dataOffset > archiveFile.getSize() ||
+          entry.storedSize > archiveFile.getSize() - entry.dataOffset || entry.compression > AssetCompression::LZ4 ||
+          (entry.compression == AssetCompression::NONE && entry.storedSize != entry.size))
+      {
+        return;
+      }
+    }
+    entries = archiveEntries;
+    entriesCount = header.entriesCount;
+    names = reinterpret_cast<const char *>(archiveFile.getData() + namesOffset);
+  }
+
+  /**
+   * Get the name of an entry.
+   * 
+   * @param entry  The entry.
+   * 
+   * @return The name, pointing into the mapped file.
+   */
+  std::string_view getEntryName(const AssetArchiveEntry &entry) const
+  {
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+  }
+
+public:
+  // The directory the assets are loaded from, which the names of the entries are relative to.
+  static constexpr const char *ASSETS_DIRECTORY = "assets/";
+  // The name of the archive file, in the assets directory.
+  static constexpr const char *ARCHIVE_FILE_NAME = "assets.pak";
+  // The magic number identifying asset archives ("APAK" when read as characters).
+  static constexpr uint32_t ARCHIVE_MAGIC = 0x4B415041;
+  // The version of the archive layout, to be increased whenever the layout changes.
+  static constexpr uint32_t ARCHIVE_VERSION = 1;
+  // The alignment of the data of the entries in the archive.
+  static constexpr uint64_t ARCHIVE_DATA_ALIGNMENT = 16;
+
+  // Preventing copying the asset archive, making sure only one instance can exist.
+  AssetArchive(const AssetArchive &) = delete;
+
+  /**
+   * Find the entry of an asset, by a binary search of the index.
+   * 
+   * @param assetPath  The path of the asset, starting with the assets directory.
+   * 
+   * @return The entry, or null if the archive does not have the asset.
+   */
+  const AssetArchiveEntry *findEntry(const std::string &assetPath) const
+  {
+    const auto assetsDirectoryLength = strlen(ASSETS_DIRECTORY);
+    if (entriesCount == 0 || assetPath.compare(0, assetsDirectoryLength, ASSETS_DIRECTORY) != 0)
+    {
+      return nullptr;
+    }
+    const auto entryName = std::string_view(assetPath).substr(assetsDirectoryLength);
+    const auto entry = std::lower_bound(entries, entries + entriesCount, entryName, [this](const AssetArchiveEntry &archiveEntry, const std::string_view &name) {
+      return getEntryName(archiveEntry) < name;
+    });
+    return entry != entries + entriesCount && getEntryName(*entry) == entryName ? entry : nullptr;
+  }
+
+  /**
+   * Get the data of an entry, as stored in the archive.
+   * 
+   * @param entry  The entry.
+   * 
+   * @return The pointer to the start of the data of the entry, in the mapped file.
+   */
+  const uint8_t *getEntryData(const AssetArchiveEntry &entry) const
+  {
+    return archiveFile.getData() + entry.dataOffset;
+  }
+
+  /**
+   * Get the number of assets in the archive.
+   * 
+   * @return The number of entries (0 if there is no valid archive).
+   */
+  const uint32_t &getEntriesCount() const
+  {
+    return entriesCount;
+  }
+
+  /**
+   * Returns the singleton instance of the asset archive.
+   * 
+   * @return The asset archive singleton instance.
+   */
+  static const AssetArchive &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the asset archive singleton instance static variable.
+AssetArchive AssetArchive::instance;
+
+/**
+ * Class for reading a whole asset, from the asset archive if it has the asset or mapped from its file otherwise. The stored
+ *   assets point straight into the mapped archive, and the compressed ones are decompressed into memory owned by the instance.
+ */
+class AssetFile
+{
+private:
+  // The mapped file of the asset, if it is not in the archive.
+  std::unique_ptr<MappedFile> mappedFile;
+  // The decompressed data of the asset, if it is compressed in the archive.
+  std::vector<uint8_t> decompressedData;
+  // The pointer to the start of the asset contents (null if the asset could not be read).
+  const uint8_t *data;
+  // The size of the asset in bytes.
+  size_t size;
+
+public:
+  /**
+   * Read the asset at the given path. The asset being missing, empty, or corrupted is not an error, and is reported through
+   *   isMapped instead.
+   * 
+   * @param filePath  The path of the asset.
+   */
+  AssetFile(const std::string &filePath)
+      : mappedFile(nullptr),
+        decompressedData({}),
+        data(nullptr),
+        size(0)
+  {
+    const auto &assetArchive = AssetArchive::getInstance();
+    const auto entry = assetArchive.findEntry(filePath);
+    if (entry == nullptr)
+    {
+      mappedFile = std::make_unique<MappedFile>(filePath);
+      data = mappedFile->getData();
+      size = mappedFile->getSize();
+    }
+    else if (entry->compression == AssetCompression::NONE)
+    {
+      data = assetArchive.getEntryData(*entry);
+      size = entry->size;
+    }
+    else
+    {
+      decompressedData.resize(entry->size);
+      if (Lz4::decompress(assetArchive.getEntryData(*entry), entry->storedSize, decompressedData.data(), decompressedData.size()))
+      {
+        data = decompressedData.data();
+        size = decompressedData.size();
+      }
+    }
+  }
+
+  // Preventing copying the asset file, since it can point into its own memory.
+  AssetFile(const AssetFile &) = delete;
+
+  /**
+   * Get the size of an asset without reading it.
+   * 
+   * @param filePath  The path of the asset.
+   * 
+   * @return The size of the asset in bytes (0 if it does not exist).
+   */
+  static uint64_t getAssetSize(const std::string &filePath)
+  {
+    const auto entry = AssetArchive::getInstance().findEntry(filePath);
+    if (entry != nullptr)
+    {
+      return entry->size;
+    }
+    struct stat fileStat;
+    return stat(filePath.c_str(), &fileStat) == 0 ? fileStat.st_size : 0;
+  }
+
+  /**
+   * Check if the asset was read successfully.
+   * 
+   * @return Whether the asset contents are available or not.
+   */
+  bool isMapped() const
+  {
+    return data != nullptr;
+  }
+
+  /**
+   * Get the contents of the asset.
+   * 
+   * @return The pointer to the start of the asset contents.
+   */
+  const uint8_t *getData() const
+  {
+    return data;
+  }
+
+  /**
+   * Get the size of the asset.
+   * 
+   * @return The size of the asset in bytes.
+   */
+  const size_t &getSize() const
+  {
+    return size;
+  }
+};
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef INCLUDE_ASSET_MANIFEST_CPP
+#define INCLUDE_ASSET_MANIFEST_CPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <sys/stat.h>
+
+#include "mapped_file.cpp"
+#include "asset_archive.cpp"
+
+/**
+ * Structure for defining an asset written by the asset cook, in the manifest of the cooked assets.
+ */
+struct CookedAsset
+{
+  // The path of the source asset, relative to the assets directory.
+  std::string sourcePath;
+  // The path of the cooked asset, relative to the assets directory.
+  std::string cookedPath;
+  // The FNV-1a hash of the contents of the source asset.
+  uint64_t contentHash;
+  // The size of the source asset in bytes.
+  uint64_t sourceSize;
+  // The last modification time of the source asset, which saves hashing it again while it is unchanged.
+  int64_t sourceModifiedTime;
+};
+
+/**
+ * A manager class for the manifest of the assets cooked by the asset cook, which the loaders look the source assets up in to
+ *   load the cooked ones instead. A cooked asset is used if its source is not shipped at all, or if its source still has the
+ *   contents it was cooked from, so that the sources can be edited without cooking them again.
+ * The manifest is read once when the program starts and never changed, so that it can be looked up from the worker threads.
+ */
+class AssetManifest
+{
+private:
+  // Singleton instance of the asset manifest.
+  static AssetManifest instance;
+
+  // The cooked assets, by the paths of their sources relative to the assets directory.
+  std::map<const std::string, CookedAsset> cookedAssets;
+
+  AssetManifest()
+      : cookedAssets(readLoadedManifest()) {}
+
+  /**
+   * Read the manifest the assets are loaded by, from the asset archive if it has one.
+   * 
+   * @return The cooked assets, by the paths of their sources (none if the manifest is missing).
+   */
+  static std::map<const std::string, CookedAsset> readLoadedManifest()
+  {
+    const AssetFile file(getManifestPath(ASSETS_DIRECTORY));
+    return file.isMapped() ? parseManifest(std::string(reinterpret_cast<const char *>(file.getData()), file.getSize())) : std::map<const std::string, CookedAsset>();
+  }
+
+  /**
+   * Get the path of an asset relative to the assets directory.
+   * 
+   * @param assetPath  The path of the asset, as the loaders are given it.
+   * 
+   * @return The relative path, with forward slashes.
+   */
+  static std::string getRelativePath(const std::string &assetPath)
+  {
+    return std::filesystem::path(assetPath).lexically_relative(ASSETS_DIRECTORY).generic_string();
+  }
+
+public:
+  // The directory the source assets are loaded from, and the directory of the cooked assets within it.
+  static constexpr const char *ASSETS_DIRECTORY = AssetArchive::ASSETS_DIRECTORY;
+  static constexpr const char *COOKED_ASSETS_DIRECTORY = "cooked/";
+  // The name of the manifest file, in the directory of the cooked assets.
+  static constexpr const char *MANIFEST_FILE_NAME = "manifest.txt";
+
+  // Preventing copying the asset manifest, making sure only one instance can exist.
+  AssetManifest(const AssetManifest &) = delete;
+
+  /**
+   * Get the path of the manifest of the cooked assets.
+   * 
+   * @param assetsDirectory  The directory of the assets, ending with a slash.
+   * 
+   * @return The path of the manifest.
+   */
+  static std::string getManifestPath(const std::string &assetsDirectory)
+  {
+    return assetsDirectory + COOKED_ASSETS_DIRECTORY + MANIFEST_FILE_NAME;
+  }
+
+  /**
+   * Get the size and last modification time of a file.
+   * 
+   * @param filePath         The path of the file.
+   * @param outFileSize      The output variable for the size of the file.
+   * @param outModifiedTime  The output variable for the last modification time of the file.
+   * 
+   * @return Whether the file exists.
+   */
+  static bool getFileStamp(const std::string &filePath, uint64_t &outFileSize, int64_t &outModifiedTime)
+  {
+    struct stat fileStat;
+    if (stat(filePath.c_str(), &fileStat) != 0)
+    {
+      return false;
+    }
+    outFileSize = fileStat.st_size;
+    outModifiedTime = fileStat.st_mtime;
+    return true;
+  }
+
+  /**
+   * Hash the contents of a file with FNV-1a.
+   * 
+   * @param filePath  The path of the file.
+   * 
+   * @return The hash of the contents, or the hash of no contents if the file cannot be read.
+   */
+  static uint64_t hashFile(const std::string &filePath)
+  {
+    const MappedFile file(filePath);
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; file.isMapped() && i < file.getSize(); i++)
+    {
+      hash = (hash ^ file.getData()[i]) * 0x100000001b3;
+    }
+    return hash;
+  }
+
+  /**
+   * Parse a manifest of cooked assets, written a line per asset (its content hash, its source size and modification time, and
+   *   the paths of its source and the cooked asset).
+   * 
+   * @param manifestText  The text of the manifest.
+   * 
+   * @return The cooked assets, by the paths of their sources.
+   */
+  static std::map<const std::string, CookedAsset> parseManifest(const std::string &manifestText)
+  {
+    std::map<const std::string, CookedAsset> manifestAssets;
+    std::istringstream stream(manifestText);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+      std::istringstream lineStream(line);
+      auto cookedAsset = CookedAsset({"", "", 0, 0, 0});
+      if (lineStream >> std::hex >> cookedAsset.contentHash >> std::dec >> cookedAsset.sourceSize >> cookedAsset.sourceModifiedTime >> cookedAsset.sourcePath >> cookedAsset.cookedPath)
+      {
+        manifestAssets.insert({cookedAsset.sourcePath, cookedAsset});
+      }
+    }
+    return manifestAssets;
+  }
+
+  /**
+   * Read a manifest of cooked assets from its file.
+   * 
+   * @param manifestPath  The path of the manifest.
+   * 
+   * @return The cooked assets, by the paths of their sources (none if the manifest is missing).
+   */
+  static std::map<const std::string, CookedAsset> readManifest(const std::string &manifestPath)
+  {
+    const MappedFile file(manifestPath);
+    return file.isMapped() ? parseManifest(std::string(reinterpret_cast<const char *>(file.getData()), file.getSize())) : std::map<const std::string, CookedAsset>();
+  }
+
+  /**
+   * Write a manifest of cooked assets, replacing the manifest if it exists.
+   * 
+   * @param manifestPath    The path of the manifest.
+   * @param manifestAssets  The cooked assets.
+   * 
+   * @return Whether the manifest was written.
+   */
+  static bool writeManifest(const std::string &manifestPath, const std::vector<CookedAsset> &manifestAssets)
+  {
+    std::ofstream stream(manifestPath, std::ios::out | std::ios::trunc);
+    for (const auto &cookedAsset : manifestAssets)
+    {
+      char hashText[17];
+      snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(cookedAsset.contentHash));
+      stream << hashText << " " << cookedAsset.sourceSize << " " << cookedAsset.sourceModifiedTime << " " << cookedAsset.sourcePath << " " << cookedAsset.cookedPath << "\n";
+    }
+    return stream.good();
+  }
+
+  /**
+   * Check if a cooked asset was cooked from the source asset as it is now.
+   * 
+   * @param cookedAsset  The cooked asset.
+   * @param sourcePath   The path of the source asset.
+   * 
+   * @return Whether the source is missing, or has the contents the asset was cooked from.
+   */
+  static bool isCookedAssetCurrent(const CookedAsset &cookedAsset, const std::string &sourcePath)
+  {
+    uint64_t sourceSize;
+    int64_t sourceModifiedTime;
+    if (!getFileStamp(sourcePath, sourceSize, sourceModifiedTime))
+    {
+      return true;
+    }
+    // Copying the assets changes their modification times, so the sources are only hashed again when it changed.
+    return sourceSize == cookedAsset.sourceSize && (sourceModifiedTime == cookedAsset.sourceModifiedTime || hashFile(sourcePath) == cookedAsset.contentHash);
+  }
+
+  /**
+   * Find the cooked asset to load instead of the given source asset.
+   * 
+   * @param sourcePath  The path of the source asset, as the loaders are given it.
+   * 
+   * @return The path of the cooked asset, or an empty path if the asset was not cooked or its source changed since.
+   */
+  std::string findCookedAsset(const std::string &sourcePath) const
+  {
+    const auto cookedAsset = cookedAssets.find(getRelativePath(sourcePath));
+    if (cookedAsset == cookedAssets.end() || !isCookedAssetCurrent(cookedAsset->second, sourcePath))
+    {
+      return "";
+    }
+    return std::string(ASSETS_DIRECTORY) + cookedAsset->second.cookedPath;
+  }
+
+  /**
+   * Returns the singleton instance of the asset manifest.
+   * 
+   * @return The asset manifest singleton instance.
+   */
+  static const AssetManifest &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the asset manifest singleton instance static variable.
+AssetManifest AssetManifest::instance;
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef INCLUDE_ASSET_REGISTRY_CPP
+#define INCLUDE_ASSET_REGISTRY_CPP
+
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <iostream>
+#include <cstdint>
+
+#include <stdlib.h>
+
+#include "flat_hash_map.cpp"
+#include "name_interner.cpp"
+
+/**
+ * Class for registering the created assets of a manager by their interned names, so that they can be looked up from any thread
+ *   without a lock while only the thread owning the registry (the one creating the assets, and the GL resources with them)
+ *   changes it.
+ * The registered assets are published as an immutable snapshot, read through the atomic operations of the shared pointers,
+ *   and every change copies the snapshot into a new one replacing it, so that the readers keep the snapshot they got for as long
+ *   as they use it. The snapshots share the assets and their reference counts, so a change only copies the pointers.
+ * The reference counts of the assets are atomic, and can be changed from any thread while the asset is registered.
+ */
+template <typename T>
+class AssetRegistry
+{
+public:
+  /**
+   * Structure for defining a registered asset.
+   */
+  struct Entry
+  {
+    // The asset.
+    std::shared_ptr<T> asset;
+    // The number of references to the asset, shared by every snapshot the asset is in.
+    std::shared_ptr<std::atomic<int32_t>> referencesCount;
+  };
+
+  // The type of the snapshots of the registered assets, by their interned names.
+  typedef FlatHashMap<NameId, Entry> Snapshot;
+
+private:
+  // The snapshot of the registered assets last published.
+  std::shared_ptr<const Snapshot> snapshot;
+  // The thread changing the registry.
+  const std::thread::id ownerThreadId;
+
+  /**
+   * Make sure the registry is changed by its owner thread, since the changes are not synchronized with each other.
+   */
+  void checkOwnerThread() const
+  {
+    if (std::this_thread::get_id() != ownerThreadId)
+    {
+      // Changed from another thread, which could lose a concurrent change. Time to crash.
+      std::cout << "Failed at asset registry" << std::endl;
+      exit(1);
+    }
+  }
+
+  /**
+   * Publish the given snapshot of the registered assets, replacing the last one once the readers holding it let it go.
+   * 
+   * @param newSnapshot  The new snapshot.
+   */
+  void publish(const std::shared_ptr<const Snapshot> &newSnapshot)
+  {
+    std::atomic_store(&snapshot, newSnapshot);
+  }
+
+public:
+  /**
+   * Create an empty registry, owned by the thread creating it.
+   */
+  AssetRegistry()
+      : snapshot(std::make_shared<const Snapshot>()),
+        ownerThreadId(std::this_thread::get_id()) {}
+
+  // Preventing copying the registry, since its assets are owned by a single manager.
+  AssetRegistry(const AssetRegistry &) = delete;
+
+  /**
+   * Get the snapshot of the registered assets, which stays unchanged for as long as it is held. Can be called from any thread.
+   * 
+   * @return The snapshot of the registered assets.
+   */
+  std::shared_ptr<const Snapshot> getSnapshot() const
+  {
+    return std::atomic_load(&snapshot);
+  }
+
+  /**
+   * Find the asset with the given name. Can be called from any thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * 
+   * @return The asset, or nullptr if it is not registered.
+   */
+  std::shared_ptr<T> find(const NameId &nameId) const
+  {
+    const auto currentSnapshot = getSnapshot();
+    const auto entry = currentSnapshot->find(nameId);
+    return entry != currentSnapshot->end() ? entry->second.asset : nullptr;
+  }
+
+  /**
+   * Check if an asset with the given name is registered. Can be called from any thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * 
+   * @return Whether the asset is registered.
+   */
+  bool contains(const NameId &nameId) const
+  {
+    return getSnapshot()->count(nameId) != 0;
+  }
+
+  /**
+   * Get the asset with the given name, which must be registered. Can be called from any thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * 
+   * @return The asset.
+   */
+  std::shared_ptr<T> at(const NameId &nameId) const
+  {
+    return getSnapshot()->at(nameId).asset;
+  }
+
+  /**
+   * Add a reference to the asset with the given name, which must be registered. Can be called from any thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * 
+   * @return The number of references to the asset, including the added one.
+   */
+  int32_t addReference(const NameId &nameId) const
+  {
+    return getSnapshot()->at(nameId).referencesCount->fetch_add(1) + 1;
+  }
+
+  /**
+   * Remove a reference to the asset with the given name, which must be registered. Can be called from any thread, but the asset is
+   *   only unregistered by the owner thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * 
+   * @return The number of references to the asset left.
+   */
+  int32_t removeReference(const NameId &nameId) const
+  {
+    return getSnapshot()->at(nameId).referencesCount->fetch_sub(1) - 1;
+  }
+
+  /**
+   * Register the given asset with a single reference, replacing any asset registered with the same name. Must be called from the
+   *   owner thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   * @param asset   The asset.
+   */
+  void insert(const NameId &nameId, const std::shared_ptr<T> &asset)
+  {
+    checkOwnerThread();
+    // Only the owner thread publishes snapshots, so the current one can be read without the atomic load.
+    auto newSnapshot = std::make_shared<Snapshot>(*snapshot);
+    newSnapshot->erase(nameId);
+    newSnapshot->emplace(nameId, Entry{asset, std::make_shared<std::atomic<int32_t>>(1)});
+    publish(newSnapshot);
+  }
+
+  /**
+   * Unregister the asset with the given name, if it is registered. Must be called from the owner thread.
+   * 
+   * @param nameId  The interned name of the asset.
+   */
+  void erase(const NameId &nameId)
+  {
+    checkOwnerThread();
+    if (snapshot->count(nameId) == 0)
+    {
+      return;
+    }
+    auto newSnapshot = std::make_shared<Snapshot>(*snapshot);
+    newSnapshot->erase(nameId);
+    publish(newSnapshot);
+  }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef INCLUDE_ATTACHMENT_CPP
+#define INCLUDE_ATTACHMENT_CPP
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "transform.cpp"
+#include "../light/light_base.cpp"
+
+/**
+ * Structure for defining a light attached to a transform, following it at an offset.
+ */
+struct LightAttachment
+{
+  // The attached light.
+  std::shared_ptr<LightBase> light;
+  // The handle of the transform the light is attached to.
+  TransformHandle parentHandle;
+  // The offset of the light from the position of the transform, along its rotated axes (unscaled).
+  glm::vec3 localOffset;
+  // The version of the transform the light was last placed at.
+  uint64_t parentVersion;
+};
+
+/**
+ * A manager class for attaching lights to the transforms of the models, so that they follow the models without the models
+ *   placing them on every update.
+ * The attached lights are placed by a single pass per frame, which only moves the lights whose transforms changed since the last
+ *   pass (by comparing the versions of the transforms), so that the lights of the models at rest do not rebuild anything.
+ */
+class AttachmentManager
+{
+private:
+  // Singleton instance of the attachment manager.
+  static AttachmentManager instance;
+
+  // The transform manager the parent transforms are read from.
+  const TransformManager &transformManager;
+
+  // The attached lights.
+  std::vector<LightAttachment> lightAttachments;
+
+  /**
+   * Place the light of the given attachment at the offset from its transform.
+   * 
+   * @param attachment  The attachment.
+   */
+  void placeLight(LightAttachment &attachment)
+  {
+    const auto &parentHandle = attachment.parentHandle;
+    attachment.light->setLightPosition(transformManager.getPosition(parentHandle) + (transformManager.getRotation(parentHandle) * attachment.localOffset));
+    attachment.parentVersion = transformManager.getVersion(parentHandle);
+  }
+
+  AttachmentManager()
+      : transformManager(TransformManager::getInstance()),
+        lightAttachments({}) {}
+
+public:
+  // Preventing copying the attachment manager, making sure only one instance can exist.
+  AttachmentManager(const AttachmentManager &) = delete;
+
+  /**
+   * Attach a light to a transform, placing it there right away. The light must be detached before the transform is destroyed.
+   * 
+   * @param light         The light.
+   * @param parentHandle  The handle of the transform to attach the light to.
+   * @param localOffset   The offset of the light from the position of the transform, along its rotated axes (unscaled).
+   */
+  void attachLight(const std::shared_ptr<LightBase> &light, const TransformHandle &parentHandle, const glm::vec3 &localOffset)
+  {
+    lightAttachments.push_back({light, parentHandle, localOffset, 0});
+    placeLight(lightAttachments.back());
+  }
+
+  /**
+   * Detach a light from the transform it is attached to, leaving it where it was last placed.
+   * 
+   * @param light  The light.
+   */
+  void detachLight(const std::shared_ptr<LightBase> &light)
+  {
+    const auto attachment = std::find_if(lightAttachments.begin(), lightAttachments.end(), [&light](const LightAttachment &lightAttachment) {
+      return lightAttachment.light == light;
+    });
+    if (attachment != lightAttachments.end())
+    {
+      // The order of the attachments does not matter, so fill the gap with the last one.
+      *attachment = std::move(lightAttachments.back());
+      lightAttachments.pop_back();
+    }
+  }
+
+  /**
+   * Place all the attached lights whose transforms changed since they were last placed. Must be called once per frame, after the
+   *   models are updated and before the lights are read.
+   */
+  void resolveAttachments()
+  {
+    for (auto &attachment : lightAttachments)
+    {
+      if (attachment.parentVersion != transformManager.getVersion(attachment.parentHandle))
+      {
+        placeLight(attachment);
+      }
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the attachment manager.
+   * 
+   * @return The attachment manager singleton instance.
+   */
+  static AttachmentManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the attachment manager singleton instance static variable.
+AttachmentManager AttachmentManager::instance;
+
+#endif
@@ -0,0 +1,399 @@
+#ifndef INCLUDE_BENCHMARK_CPP
+#define INCLUDE_BENCHMARK_CPP
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "render_config.cpp"
+#include "control.cpp"
+#include "gpu_timer.cpp"
+#include "rolling_stats.cpp"
+
+/**
+ * Structure for defining the scene the benchmark mode runs.
+ */
+struct BenchmarkSettings
+{
+  // The number of frames measured, after the warm-up frames.
+  uint32_t framesCount;
+  // The seed of the random generators of the models.
+  uint32_t seed;
+  // The number of enemies along each axis of their grid.
+  glm::ivec3 enemyGridSize;
+  // The distance between the neighbouring enemies of the grid.
+  float_t enemySpacing;
+  // The largest random offset of the enemies from their place in the grid along each axis (0 to keep them in the grid).
+  float_t enemyScatter;
+  // The fraction of the enemies replaced with unlit ones that cannot be hit, loading the renders but not the collisions.
+  float_t unlitEnemiesFraction;
+  // The fraction of the other enemies replaced with static ones that cannot be hit, whose shadows are cached apart from the
+  //   ones of the other casters.
+  float_t staticEnemiesFraction;
+  // The number of point lights added over the enemies.
+  uint32_t lightsCount;
+  // The number of cone lights added over the enemies, pointed at them.
+  uint32_t coneLightsCount;
+  // The rate the scripted player fires at (in shots per second, 0 to never fire), limited by the rate the player can fire at.
+  float_t fireRate;
+  // The index of the quality preset rendered with.
+  int32_t qualityPreset;
+  // The measured frame a screenshot is taken after (from 1, 0 to take none), e.g. to compare the images of the render paths.
+  uint32_t screenshotFrame;
+};
+
+/**
+ * Structure for defining the timings of a frame measured by the benchmark mode (in milliseconds).
+ */
+struct BenchmarkFrame
+{
+  // The time from the start of the frame before to the start of this one.
+  double_t frameTime;
+  // The time from the start of the frame to the end of its work.
+  double_t processTime;
+  // The GPU times of the latest finished measurements of the scene, the light and the model renders.
+  double_t sceneGpuTime;
+  double_t lightGpuTime;
+  double_t modelGpuTime;
+};
+
+/**
+ * A manager class for the benchmark mode, which runs the game scene with scripted input and a fixed seed for a number of
+ *   frames, and reports the statistics of their CPU and GPU timings as JSON, so that the runs can be compared with each other.
+ */
+class BenchmarkManager
+{
+private:
+  // Singleton instance of the benchmark manager.
+  static BenchmarkManager instance;
+
+  // The keys the scripted player moves with, in the order it moves in (right, up, left, down, sweeping a square).
+  static constexpr std::array<int32_t, 4> SCRIPTED_MOVE_KEYS = {GLFW_KEY_D, GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S};
+
+  // The control manager the scripted keys are set on.
+  ControlManager &controlManager;
+  // The GPU timer manager the GPU times are read from.
+  GpuTimerManager &gpuTimerManager;
+
+  // Whether the benchmark mode is enabled.
+  bool isEnabled;
+  // The scene the benchmark mode runs.
+  BenchmarkSettings settings;
+  // The number of simulation steps the input was scripted for.
+  uint32_t scriptedStepsCount;
+  // The number of frames run, including the warm-up frames.
+  uint32_t framesRunCount;
+  // The measured frames.
+  std::vector<BenchmarkFrame> frames;
+  // The GPU times read on the thread the GL context is current on, for the main thread to record with the frames.
+  std::atomic<double_t> sceneGpuTime;
+  std::atomic<double_t> lightGpuTime;
+  std::atomic<double_t> modelGpuTime;
+
+  BenchmarkManager()
+      : controlManager(ControlManager::getInstance()),
+        gpuTimerManager(GpuTimerManager::getInstance()),
+        isEnabled(false),
+        settings({BENCHMARK_DEFAULT_FRAMES_COUNT, BENCHMARK_DEFAULT_SEED, glm::ivec3(5, 3, 3), BENCHMARK_DEFAULT_ENEMY_SPACING, 0.0f, 0.0f, 0.0f, 0, 0, BENCHMARK_DEFAULT_FIRE_RATE, RenderConfigManager::getConfig().qualityPreset, 0}),
+        scriptedStepsCount(0),
+        framesRunCount(0),
+        frames({}),
+        sceneGpuTime(0.0),
+        lightGpuTime(0.0),
+        modelGpuTime(0.0) {}
+
+  /**
+   * Write the statistics of a timing of the measured frames as a JSON object.
+   * 
+   * @param stream  The stream to write to.
+   * @param name    The name of the timing.
+   * @param timing  The timing of the frames.
+   */
+  void writeTimingSummary(std::ostream &stream, const char *name, double_t BenchmarkFrame::*timing) const
+  {
+    auto sortedValues = std::vector<double_t>({});
+    sortedValues.reserve(frames.size());
+    auto valuesSum = 0.0;
+    for (const auto &frame : frames)
+    {
+      sortedValues.push_back(frame.*timing);
+      valuesSum += frame.*timing;
+    }
+    std::sort(sortedValues.begin(), sortedValues.end());
+
+    const auto summary = getSortedValuesSummary(sortedValues.data(), sortedValues.size(), valuesSum);
+    stream << "\"" << name << "\":{\"mean\":" << summary.mean << ",\"p50\":" << summary.p50 << ",\"p95\":" << summary.p95 << ",\"p99\":" << summary.p99 << ",\"max\":" << summary.max << "}";
+  }
+
+public:
+  // Preventing copying the benchmark manager, making sure only one instance can exist.
+  BenchmarkManager(const BenchmarkManager &) = delete;
+
+  /**
+   * Find the quality preset of the given name (in any case) or index.
+   * 
+   * @param name  The name or the index of the quality preset.
+   * 
+   * @return The index of the quality preset, or -1 if there is none by the name.
+   */
+  /**
+   * Set a setting of the scene the benchmark mode runs from its name and value, as given on the command line (without the
+   *   dashes) or in a scene file.
+   * 
+   * @param name      The name of the setting.
+   * @param value     The value of the setting.
+   * @param settings  The settings to set it in.
+   * 
+   * @return Whether the setting is known and its value is valid.
+   */
+  static bool parseSetting(const std::string &name, const std::string &value, BenchmarkSettings &settings)
+  {
+    if (name == "seed")
+    {
+      return std::sscanf(value.c_str(), "%u", &settings.seed) == 1;
+    }
+    if (name == "enemies")
+    {
+      // The enemy grid is given as its sizes along each axis, like "5x3x3".
+      auto &gridSize = settings.enemyGridSize;
+      return std::sscanf(value.c_str(), "%dx%dx%d", &gridSize.x, &gridSize.y, &gridSize.z) == 3 && gridSize.x > 0 && gridSize.y > 0 && gridSize.z > 0;
+    }
+    if (name == "spacing")
+    {
+      return std::sscanf(value.c_str(), "%f", &settings.enemySpacing) == 1 && settings.enemySpacing > 0.0f;
+    }
+    if (name == "scatter")
+    {
+      return std::sscanf(value.c_str(), "%f", &settings.enemyScatter) == 1 && settings.enemyScatter >= 0.0f;
+    }
+    if (name == "unlit-enemies")
+    {
+      // Some enemies have to be left to be hit, or the run would end right away.
+      return std::sscanf(value.c_str(), "%f", &settings.unlitEnemiesFraction) == 1 && settings.unlitEnemiesFraction >= 0.0f && settings.unlitEnemiesFraction < 1.0f;
+    }
+    if (name == "static-enemies")
+    {
+      return std::sscanf(value.c_str(), "%f", &settings.staticEnemiesFraction) == 1 && settings.staticEnemiesFraction >= 0.0f && settings.staticEnemiesFraction < 1.0f;
+    }
+    if (name == "lights")
+    {
+      return std::sscanf(value.c_str(), "%u", &settings.lightsCount) == 1;
+    }
+    if (name == "cone-lights")
+    {
+      return std::sscanf(value.c_str(), "%u", &settings.coneLightsCount) == 1;
+    }
+    if (name == "fire-rate")
+    {
+      return std::sscanf(value.c_str(), "%f", &settings.fireRate) == 1 && settings.fireRate >= 0.0f;
+    }
+    if (name == "quality")
+    {
+      settings.qualityPreset = RenderConfigManager::findQualityPreset(value);
+      return settings.qualityPreset >= 0;
+    }
+    if (name == "screenshot-frame")
+    {
+      return std::sscanf(value.c_str(), "%u", &settings.screenshotFrame) == 1;
+    }
+    return false;
+  }
+
+  /**
+   * Load the settings of the scene the benchmark mode runs from a scene file, which has a setting per line given as its name
+   *   and value (like "enemies 20x10x10"), the blank lines and the lines starting with "#" being skipped.
+   * 
+   * @param path      The path of the scene file.
+   * @param settings  The settings to set the loaded ones in.
+   * 
+   * @return Whether the file is read and all its settings are valid.
+   */
+  static bool loadSceneFile(const std::string &path, BenchmarkSettings &settings)
+  {
+    std::ifstream stream(path);
+    if (!stream)
+    {
+      return false;
+    }
+    std::string line;
+    while (std::getline(stream, line))
+    {
+      std::istringstream lineStream(line);
+      std::string name, value;
+      if (!(lineStream >> name) || name[0] == '#')
+      {
+        continue;
+      }
+      if (!(lineStream >> value) || !parseSetting(name, value, settings))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Enable the benchmark mode, with the scene to run.
+   * 
+   * @param newSettings  The scene the benchmark mode runs.
+   */
+  void enable(const BenchmarkSettings &newSettings)
+  {
+    isEnabled = true;
+    settings = newSettings;
+  }
+
+  /**
+   * Get whether the benchmark mode is enabled.
+   * 
+   * @return Whether the benchmark mode is enabled.
+   */
+  const bool &isBenchmarkEnabled() const
+  {
+    return isEnabled;
+  }
+
+  /**
+   * Get the scene the benchmark mode runs.
+   * 
+   * @return The benchmark settings.
+   */
+  const BenchmarkSettings &getSettings() const
+  {
+    return settings;
+  }
+
+  /**
+   * Start the run, forgetting the frames of any run before.
+   */
+  void start()
+  {
+    scriptedStepsCount = 0;
+    framesRunCount = 0;
+    frames.clear();
+    frames.reserve(settings.framesCount);
+    sceneGpuTime = 0.0;
+    lightGpuTime = 0.0;
+    modelGpuTime = 0.0;
+  }
+
+  /**
+   * Set the scripted keys of the next simulation step: the player moves in each direction for a while in turn, and fires at
+   *   the fire rate of the scene.
+   */
+  void scriptStepInput()
+  {
+    const auto moveKeyIndex = (scriptedStepsCount / BENCHMARK_MOVE_STEPS) % SCRIPTED_MOVE_KEYS.size();
+    for (size_t i = 0; i < SCRIPTED_MOVE_KEYS.size(); i++)
+    {
+      controlManager.setScriptedKey(SCRIPTED_MOVE_KEYS[i], i == moveKeyIndex);
+    }
+    // Fire on the steps the number of shots due at the fire rate goes up in, which is every step at the default rate.
+    const auto getShotsDueCount = [this](const uint32_t &stepsCount) {
+      return std::floor(stepsCount * SIMULATION_STEP_TIME * settings.fireRate + 1e-6);
+    };
+    controlManager.setScriptedKey(GLFW_KEY_SPACE, getShotsDueCount(scriptedStepsCount + 1) > getShotsDueCount(scriptedStepsCount));
+    scriptedStepsCount++;
+  }
+
+  /**
+   * Read the GPU times of the latest finished measurements. Has to be done on the thread the GL context is current on, once
+   *   per frame after the scene is rendered.
+   */
+  void sampleGpuTimes()
+  {
+    sceneGpuTime = gpuTimerManager.getTimeMs("Scene Render");
+    lightGpuTime = gpuTimerManager.getTimeMs("Light Render");
+    modelGpuTime = gpuTimerManager.getTimeMs("Model Render");
+  }
+
+  /**
+   * Record the timings of a frame, along with the last GPU times read, unless it is one of the warm-up frames.
+   * 
+   * @param frameTime    The time from the start of the frame before to the start of the frame (in milliseconds).
+   * @param processTime  The time from the start of the frame to the end of its work (in milliseconds).
+   */
+  void recordFrame(const double_t &frameTime, const double_t &processTime)
+  {
+    if (framesRunCount++ < BENCHMARK_WARMUP_FRAMES_COUNT)
+    {
+      return;
+    }
+    frames.push_back({frameTime, processTime, sceneGpuTime, lightGpuTime, modelGpuTime});
+  }
+
+  /**
+   * Get whether the screenshot of the run is due, right after its frame is recorded (so it is taken of the next frame presented).
+   * 
+   * @return Whether the screenshot has to be requested.
+   */
+  bool isScreenshotDue() const
+  {
+    return settings.screenshotFrame > 0 && frames.size() == settings.screenshotFrame && framesRunCount == BENCHMARK_WARMUP_FRAMES_COUNT + frames.size();
+  }
+
+  /**
+   * Get whether all the frames of the run are measured.
+   * 
+   * @return Whether the run is finished.
+   */
+  bool isFinished() const
+  {
+    return frames.size() >= settings.framesCount;
+  }
+
+  /**
+   * Write the settings of the run and the statistics of the timings of its measured frames as JSON (in milliseconds).
+   * 
+   * @param stream             The stream to write to.
+   * @param enemiesLeftCount   The number of enemies left at the end of the run, since the run ends early if none are.
+   * @param droppedStepsCount  The number of simulation steps dropped, which should be none in lock step.
+   */
+  void writeReport(std::ostream &stream, const uint32_t &enemiesLeftCount, const uint64_t &droppedStepsCount) const
+  {
+    stream << "{\"settings\":{\"frames\":" << settings.framesCount << ",\"warmupFrames\":" << BENCHMARK_WARMUP_FRAMES_COUNT << ",\"seed\":" << settings.seed;
+    stream << ",\"enemyGrid\":[" << settings.enemyGridSize.x << "," << settings.enemyGridSize.y << "," << settings.enemyGridSize.z << "],\"enemySpacing\":" << settings.enemySpacing;
+    stream << ",\"enemyScatter\":" << settings.enemyScatter << ",\"unlitEnemies\":" << settings.unlitEnemiesFraction << ",\"staticEnemies\":" << settings.staticEnemiesFraction << ",\"lights\":" << settings.lightsCount;
+    stream << ",\"coneLights\":" << settings.coneLightsCount << ",\"fireRate\":" << settings.fireRate;
+    stream << ",\"quality\":\"" << QUALITY_PRESET_NAMES[settings.qualityPreset] << "\",\"renderThread\":" << (IS_RENDER_THREAD_ENABLED ? "true" : "false") << "},";
+    stream << "\"measuredFrames\":" << frames.size() << ",\"enemiesLeft\":" << enemiesLeftCount << ",\"droppedSteps\":" << droppedStepsCount << ",";
+    stream << "\"cpu\":{";
+    writeTimingSummary(stream, "frameTime", &BenchmarkFrame::frameTime);
+    stream << ",";
+    writeTimingSummary(stream, "processTime", &BenchmarkFrame::processTime);
+    stream << "},\"gpu\":{";
+    writeTimingSummary(stream, "sceneRender", &BenchmarkFrame::sceneGpuTime);
+    stream << ",";
+    writeTimingSummary(stream, "lightRender", &BenchmarkFrame::lightGpuTime);
+    stream << ",";
+    writeTimingSummary(stream, "modelRender", &BenchmarkFrame::modelGpuTime);
+    stream << "}}" << std::endl;
+  }
+
+  /**
+   * Returns the singleton instance of the benchmark manager.
+   * 
+   * @return The benchmark manager singleton instance.
+   */
+  static BenchmarkManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the benchmark manager singleton instance static variable.
+BenchmarkManager BenchmarkManager::instance;
+
+#endif
@@ -2,11 +2,14 @@
 #define INCLUDE_CAMERA_CPP
 
 #include <string>
+#include <memory_resource>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "text.cpp"
+#include "profiler.cpp"
+#include "registry.cpp"
 #include "../camera/camera_base.cpp"
 
 /**
@@ -20,15 +23,16 @@ private:
 
   // The text manager responsible for rendering text.
   TextManager &textManager;
+  // The CPU profiler the camera updates are timed with.
+  CpuProfiler &cpuProfiler;
 
-  // The map of registered cameras.
-  std::map<const std::string, const std::shared_ptr<CameraBase>> registeredCameras;
-  std::vector<std::string> registeredCamerasInsertionOrder;
+  // The registered cameras, in their registration order.
+  Registry<CameraBase> registeredCameras;
 
   CameraManager()
       : textManager(TextManager::getInstance()),
-        registeredCameras({}),
-        registeredCamerasInsertionOrder({}) {}
+        cpuProfiler(CpuProfiler::getInstance()),
+        registeredCameras() {}
 
 public:
   // Preventing copying the camera manager, making sure only one instance can exist.
@@ -38,74 +42,86 @@ public:
    * Register a new camera into the camera manager.
    * 
    * @param camera  The camera to register.
+   * 
+   * @return The handle of the camera, to de-register and look it up with.
    */
-  void registerCamera(const std::shared_ptr<CameraBase> &&camera)
+  RegistryHandle registerCamera(const std::shared_ptr<CameraBase> &&camera)
   {
-    // Insert the camera to the map of registered cameras.
-    registeredCameras.emplace(camera->getCameraId(), std::move(camera));
-    registeredCamerasInsertionOrder.push_back(camera->getCameraId());
+    // Add the camera to the registered cameras.
+    const auto cameraHandle = registeredCameras.add(camera->getCameraId(), camera);
+    return cameraHandle;
   }
 
   /**
    * De-register an existing camera from the camera manager.
    * 
-   * @param camera  The ID of the camera to de-register.
+   * @param cameraHandle  The handle of the camera to de-register.
    */
-  void deregisterCamera(const std::string &cameraId)
+  void deregisterCamera(const RegistryHandle &cameraHandle)
   {
-    // Check if camera actually exists. If not, just return since it's not registered.
-    if (std::find(registeredCamerasInsertionOrder.begin(), registeredCamerasInsertionOrder.end(), cameraId) == registeredCamerasInsertionOrder.end())
+    // Check if camera actually exists. If not, just return since it's not registered (anymore).
+    if (!registeredCameras.contains(cameraHandle))
     {
       return;
     }
 
-    // Get the camera that is registered with the given camera ID.
-    auto camera = registeredCameras[cameraId];
-    // Remove the camera from the map of registered cameras.
-    deregisterCamera(camera);
+    // Remove the camera from the registered cameras.
+    registeredCameras.remove(cameraHandle);
   }
 
   /**
-   * De-register an existing camera from the camera manager.
+   * De-register an existing camera from the camera manager, looking it up by its ID (slower than by its handle).
+   * 
+   * @param cameraId  The ID of the camera to de-register.
+   */
+  void deregisterCamera(const std::string &cameraId)
+  {
+    deregisterCamera(registeredCameras.getHandle(cameraId));
+  }
+
+  /**
+   * De-register an existing camera from the camera manager, looking it up by its ID (slower than by its handle).
    * 
    * @param camera  The camera to de-register.
    */
   void deregisterCamera(const std::shared_ptr<CameraBase> &camera)
   {
-    // Remove the camera from the map of registered cameras.
-    registeredCameras.erase(camera->getCameraId());
-    registeredCamerasInsertionOrder.erase(std::remove(registeredCamerasInsertionOrder.begin(), registeredCamerasInsertionOrder.end(), camera->getCameraId()), registeredCamerasInsertionOrder.end());
+    deregisterCamera(registeredCameras.getHandle(camera->getCameraId()));
   }
 
   /**
-   * Return the camera registered with the given camera ID.
+   * Return the camera registered with the given handle.
+   * 
+   * @param cameraHandle  The handle of the camera to return.
+   * 
+   * @return The camera registered with the given handle.
+   */
+  const std::shared_ptr<CameraBase> &getCamera(const RegistryHandle &cameraHandle) const
+  {
+    return registeredCameras.get(cameraHandle);
+  }
+
+  /**
+   * Return the camera registered with the given ID, for debugging (slower than by its handle).
    * 
    * @param cameraId  The ID of the camera to return.
    * 
-   * @return The camera registered with the given camera ID.
+   * @return The camera registered with the given ID.
    */
   const std::shared_ptr<CameraBase> &getCamera(const std::string &cameraId) const
   {
-    return registeredCameras.at(cameraId);
+    return registeredCameras.get(cameraId);
   }
 
   /**
-   * Return the list of all cameras registered with the camera manager.
+   * Return a view over all the cameras registered with the camera manager, in their registration order. Cameras can be registered
+   *   and de-registered while iterating it, but the registered ones are only visited by later iterations.
    * 
-   * @return The list of all registered cameras.
+   * @return The view over the registered cameras.
    */
-  const std::vector<std::shared_ptr<CameraBase>> getAllCameras() const
+  Registry<CameraBase>::View getAllCameras() const
   {
-    // Define a vector to store the list of registered cameras.
-    std::vector<std::shared_ptr<CameraBase>> cameras({});
-    // Iterate through the map of registered cameras.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
-    {
-      // Push each registered model into the models list.
-      cameras.push_back(registeredCameras.find(cameraId)->second);
-    }
-    // Return the list of registered cameras.
-    return cameras;
+    return registeredCameras.getView();
   }
 
   /**
@@ -113,16 +129,10 @@ public:
    */
   void initAllCameras()
   {
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
+    // Iterate through the registered cameras.
+    for (const auto &camera : registeredCameras.getView())
     {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
-      {
-        result->second->init();
-      }
+      camera->init();
     }
   }
 
@@ -131,16 +141,10 @@ public:
    */
   void deinitAllCameras()
   {
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
+    // Iterate through the registered cameras.
+    for (const auto &camera : registeredCameras.getView())
     {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
-      {
-        result->second->deinit();
-      }
+      camera->deinit();
     }
   }
 
@@ -149,44 +153,35 @@ public:
    */
   void updateAllCameras()
   {
-    auto cameraNamesCount = std::map<const std::string, int>({});
-    auto cameraNamesProcessTime = std::map<const std::string, double>({});
-
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
-    {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
-      {
-        if (cameraNamesCount.find(result->second->getCameraName()) != cameraNamesCount.end())
-        {
-          cameraNamesCount[result->second->getCameraName()]++;
-        }
-        else
-        {
-          cameraNamesCount[result->second->getCameraName()] = 1;
-          cameraNamesProcessTime[result->second->getCameraName()] = 0.0f;
-        }
-
-        // If it does, tell the camera to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        result->second->update();
-        const auto endTime = glfwGetTime();
-        cameraNamesProcessTime[result->second->getCameraName()] += (endTime - startTime) * 1000;
-      }
-    }
+    PROFILE_ZONE("Camera Update");
 
+    // Write the camera updates of the last frame, from the zone of each camera name.
     auto height = 13.5f;
-    for (const auto &cameraCounts : cameraNamesCount)
-    {
-      const auto avgRenderTime = cameraNamesProcessTime[cameraCounts.first] / cameraCounts.second;
-      textManager.addText(cameraCounts.first + " Camera Object Instances: " + std::to_string(cameraCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this, &height](const std::string &cameraName, const ProfilerZoneStats &cameraStats) {
+      textManager.beginText(glm::vec2(1, height), 0.5f) << cameraName << " Camera Object Instances: " << cameraStats.itemsCount << " | Update (avg): " << cameraStats.getAverageTimeMs() << "ms";
       height -= 0.5f;
+    });
+
+    // Iterate through the registered cameras.
+    for (const auto &camera : registeredCameras.getView())
+    {
+      // Tell the camera to perform an update on itself, in the zone of its name (entered before the entry of the camera is
+      //   cleared, if it de-registers itself while updating).
+      PROFILE_ZONE(camera->getCameraName());
+      camera->update();
     }
   }
 
+  /**
+   * Switch the memory resource the registered cameras are kept in, e.g. to the arena of the scene. Must not be called while the cameras are iterated.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    registeredCameras.setMemoryResource(memoryResource);
+  }
+
   /**
    * Returns the singleton instance of the camera manager.
    * 
@@ -3,8 +3,14 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <tuple>
+#include <algorithm>
+#include <limits>
 #include <iostream>
 #include <fstream>
 
@@ -19,6 +25,10 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "collision_broadphase.cpp"
+#include "transform_batch.cpp"
+#include "pool_allocator.cpp"
+
 class ColliderShape;
 class SphereColliderShape;
 class BoxColliderShape;
@@ -42,7 +52,7 @@ private:
   glm::vec3 maxCorner;
 
   // The list of the eight corners of the AABB.
-  std::vector<glm::vec3> corners;
+  std::array<glm::vec3, 8> corners;
 
   /**
    * Calculate the corners of the AABB and save them in the vector.
@@ -61,8 +71,8 @@ private:
       {
         for (auto z = 0; z < 2; z++)
         {
-          // The combination of the various min/max values of each axis gives us a coordinate of the box.
-          corners.push_back(glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]));
+          // The combination of the various min/max values of each axis gives us a coordinate of the box (overwritten in place).
+          corners[(x * 4) + (y * 2) + z] = glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]);
         }
       }
     }
@@ -71,9 +81,10 @@ private:
   /**
    * Update the min/max-corners of the AABB using the list of vertices of the object provided.
    * 
-   * @param vertices  The list of vertices of the object using which to calculate the min/max-corners.
+   * @param vertices  The list of vertices of the object using which to calculate the min/max-corners (any container of vertices).
    */
-  void updateMinMaxCorners(const std::vector<glm::vec3> &vertices)
+  template <typename VertexList>
+  void updateMinMaxCorners(const VertexList &vertices)
   {
     // Iterate through all the vertices
     for (const auto &vertex : vertices)
@@ -107,6 +118,16 @@ public:
     updateCorners();
   }
 
+  AxisAlignedBoundingBox(const std::array<glm::vec3, 8> &boxCorners)
+      : minCorner(boxCorners[0]),
+        maxCorner(boxCorners[0])
+  {
+    // Generate the min/max-corners of the AABB using the given corners of a box.
+    updateMinMaxCorners(boxCorners);
+    // Generate the corners of the AABB.
+    updateCorners();
+  }
+
   /**
    * Get the minimum size corner coordinates of the AABB.
    * 
@@ -132,7 +153,7 @@ public:
    * 
    * @return The list of the eight corners.
    */
-  const std::vector<glm::vec3> &getCorners() const
+  const std::array<glm::vec3, 8> &getCorners() const
   {
     return corners;
   }
@@ -172,6 +193,24 @@ public:
     updateCorners();
   }
 
+  /**
+   * Update the min/max-corners of the AABB using the given corners of a box, without allocating.
+   * Also updates the eight corners as well.
+   * 
+   * @param newBoxCorners  The corners of the box to use to calculate the min/max-corners.
+   */
+  void update(const std::array<glm::vec3, 8> &newBoxCorners)
+  {
+    // Set the min-corner to the first corner in the list.
+    minCorner = newBoxCorners[0];
+    // Set the max-corner to the first corner in the list.
+    maxCorner = newBoxCorners[0];
+    // Generate the min/max-corners of the AABB using the given corners.
+    updateMinMaxCorners(newBoxCorners);
+    // Generate the corners of the AABB.
+    updateCorners();
+  }
+
   /**
    * Calculate and return whether the current AABB has intersected/collided with the given AABB.
    * 
@@ -194,6 +233,65 @@ public:
   }
 };
 
+/**
+ * Structure for defining the extents of the colliders of every shape fitting a mesh, calculated once from the bounds of the mesh
+ *   when it is loaded, so that creating a collider for an instance of the mesh neither copies nor scans its vertices.
+ * The base AABBs are shared by all the colliders created from the prototype.
+ */
+struct ColliderPrototype
+{
+  // The base AABB of the box collider, which is the bounding box of the mesh.
+  std::shared_ptr<const AxisAlignedBoundingBox> boxBaseBox;
+  // The radius of the sphere collider, and its base AABB.
+  float_t sphereRadius;
+  std::shared_ptr<const AxisAlignedBoundingBox> sphereBaseBox;
+  // The radius and half-height of the cylinder collider, and its base AABB.
+  float_t cylinderRadius;
+  float_t cylinderHalfHeight;
+  std::shared_ptr<const AxisAlignedBoundingBox> cylinderBaseBox;
+  // The radius and segment half-height of the pill collider, and its base AABB.
+  float_t pillRadius;
+  float_t pillHalfHeight;
+  std::shared_ptr<const AxisAlignedBoundingBox> pillBaseBox;
+
+  /**
+   * Create the collider prototype of a mesh from its bounds.
+   * 
+   * @param minCorner       The min-corner of the bounding box of the vertices of the mesh.
+   * @param maxCorner       The max-corner of the bounding box of the vertices of the mesh.
+   * @param boundingRadius  The distance of the farthest vertex of the mesh from its origin.
+   * @param axialRadius     The distance of the farthest vertex of the mesh from its y-axis.
+   * 
+   * @return The collider prototype.
+   */
+  static ColliderPrototype create(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const float_t &boundingRadius, const float_t &axialRadius)
+  {
+    ColliderPrototype prototype;
+    prototype.boxBaseBox = std::make_shared<const AxisAlignedBoundingBox>(glm::min(minCorner, maxCorner), glm::max(minCorner, maxCorner));
+
+    // The farthest vertex from the origin gives the radius of the sphere.
+    prototype.sphereRadius = boundingRadius;
+    prototype.sphereBaseBox = std::make_shared<const AxisAlignedBoundingBox>(glm::vec3(-boundingRadius), glm::vec3(boundingRadius));
+
+    // The farthest side of the bounding box along the x and z axes gives the radius of the cylinder, and along the y-axis its half-height.
+    const auto farthestCorner = glm::max(glm::abs(minCorner), glm::abs(maxCorner));
+    prototype.cylinderRadius = std::max(farthestCorner.x, farthestCorner.z);
+    prototype.cylinderHalfHeight = farthestCorner.y;
+    prototype.cylinderBaseBox = std::make_shared<const AxisAlignedBoundingBox>(
+        glm::vec3(-prototype.cylinderRadius, -prototype.cylinderHalfHeight, -prototype.cylinderRadius),
+        glm::vec3(prototype.cylinderRadius, prototype.cylinderHalfHeight, prototype.cylinderRadius));
+
+    // The farthest vertex from the y-axis gives the radius of the pill, and the half-spheres cover that much of its half-height.
+    prototype.pillRadius = axialRadius;
+    prototype.pillHalfHeight = std::max(0.0f, farthestCorner.y - axialRadius);
+    prototype.pillBaseBox = std::make_shared<const AxisAlignedBoundingBox>(
+        glm::vec3(-axialRadius, -(prototype.pillHalfHeight + axialRadius), -axialRadius),
+        glm::vec3(axialRadius, prototype.pillHalfHeight + axialRadius, axialRadius));
+
+    return prototype;
+  }
+};
+
 /**
  * Enum of the supported collider shapes.
  */
@@ -215,8 +313,8 @@ protected:
   const ColliderShapeType type;
   // The position of the collider.
   glm::vec3 position;
-  // The rotation of the collider.
-  glm::vec3 rotation;
+  // The rotation of the collider, as a unit quaternion.
+  glm::quat rotation;
   // The scale of the collider.
   glm::vec3 scale;
 
@@ -228,50 +326,54 @@ protected:
   //   is now aligned with that AABB, making it possible to detect collisions against it again.
   std::shared_ptr<const AxisAlignedBoundingBox> baseBox;
   // Since the base AABB is being transformed around, another AABB is generated using the base AABB post-transformation.
-  //   This gives us a base AABB to perform a shallow collision check against.
-  std::shared_ptr<const AxisAlignedBoundingBox> transformedBox;
+  //   This gives us a base AABB to perform a shallow collision check against. It is updated in place, and only when it is
+  //   accessed after the transformations changed, since most moving models are not checked every time they move.
+  mutable AxisAlignedBoundingBox transformedBox;
+  // Whether the transformations changed since the transformed AABB was last updated.
+  mutable bool isTransformedBoxDirty;
 
   // Update the transformed AABB using the transformed base AABB.
-  void updateTransformedBox()
+  void updateTransformedBox() const
   {
     // Get all the corners of the base AABB.
-    const auto baseBoxCorners = baseBox->getCorners();
-    // Define a vector where we will store the transformed corners of the base AABB.
-    std::vector<glm::vec3> newCorners({});
+    const auto &baseBoxCorners = baseBox->getCorners();
+    // Calculate the models' transformation matrix once for all the corners.
+    const auto transformationMatrix = TransformBatchComposer::composeWorldMatrix(position, rotation, scale);
+    // Define an array where we will store the transformed corners of the base AABB.
+    std::array<glm::vec3, 8> newCorners;
     // Iterate through each corner of the base AABB.
-    for (const auto &corner : baseBoxCorners)
+    for (size_t i = 0; i < baseBoxCorners.size(); i++)
     {
       // Transform the corner using the models' transformation matrix and store the result.
-      newCorners.push_back(glm::vec3(glm::translate(position) * glm::toMat4(glm::quat(rotation)) * glm::scale(scale) * glm::vec4(corner, 1.0f)));
+      newCorners[i] = glm::vec3(transformationMatrix * glm::vec4(baseBoxCorners[i], 1.0f));
     }
-    // Generate the new AABB using the transformed base AABB.
-    transformedBox = std::make_shared<const AxisAlignedBoundingBox>(newCorners);
+    // Update the AABB using the transformed base AABB.
+    transformedBox.update(newCorners);
+    isTransformedBoxDirty = false;
   }
 
   void updateBaseBox(const std::shared_ptr<const AxisAlignedBoundingBox> &newBaseBox)
   {
     // Update the base AABB.
     baseBox = newBaseBox;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Mark the transformation AABB to be generated on its next access.
+    isTransformedBoxDirty = true;
   }
 
 public:
   ColliderShape(
       const ColliderShapeType &type,
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const std::shared_ptr<const AxisAlignedBoundingBox> &baseBox)
       : type(type),
         position(position),
         rotation(rotation),
         scale(scale),
-        baseBox(baseBox)
-  {
-    // Generate the transformation AABB.
-    updateTransformedBox();
-  }
+        baseBox(baseBox),
+        transformedBox(glm::vec3(0.0f), glm::vec3(0.0f)),
+        isTransformedBoxDirty(true) {}
 
   virtual ~ColliderShape(){};
 
@@ -298,9 +400,9 @@ public:
   /**
    * Returns the rotation of the collider.
    * 
-   * @return The collider rotation.
+   * @return The collider rotation (a unit quaternion).
    */
-  const glm::vec3 &getRotation() const
+  const glm::quat &getRotation() const
   {
     return rotation;
   }
@@ -328,10 +430,15 @@ public:
   /**
    * Returns the transformation AABB of the collider.
    * 
-   * @return The collider transformation AABB.
+   * @return The collider transformation AABB (generated here if the transformations changed since it was last accessed).
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> &getTransformedBox() const
+  const AxisAlignedBoundingBox &getTransformedBox() const
   {
+    // Generate the transformation AABB if the transformations changed since it was last generated.
+    if (isTransformedBoxDirty)
+    {
+      updateTransformedBox();
+    }
     return transformedBox;
   }
 
@@ -342,7 +449,7 @@ public:
    * @param newRotation  The new rotation of the collider.
    * @param newScale     The new scale of the collider.
    */
-  virtual void updateTransformations(const glm::vec3 &newPosition, const glm::vec3 &newRotation, const glm::vec3 &newScale)
+  virtual void updateTransformations(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale)
   {
     // Update the collider position.
     position = newPosition;
@@ -350,8 +457,51 @@ public:
     rotation = newRotation;
     // Update the collider scale.
     scale = newScale;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Mark the transformation AABB to be generated on its next access.
+    isTransformedBoxDirty = true;
+  }
+
+  /**
+   * Check if the collider stays the same whatever its rotation, so that the rotations of its model can skip updating it.
+   * 
+   * @return Whether the collider is rotation-invariant or not.
+   */
+  virtual bool isRotationInvariant() const
+  {
+    return false;
+  }
+
+  /**
+   * Get the support point of the collider, which is the point of the collider farthest along the given direction. This is all the
+   *   generic convex narrowphase needs to know about a shape, so new shapes only have to provide it to collide with all the others.
+   * 
+   * @param direction  The direction to find the point along (not necessarily normalized).
+   * 
+   * @return The support point, in world space.
+   */
+  virtual glm::vec3 getSupportPoint(const glm::vec3 &direction) const
+  {
+    // Use the transformed AABB, which contains the collider, when the shape doesn't provide its own support point.
+    const auto &box = getTransformedBox();
+    return glm::mix(box.getMinCorner(), box.getMaxCorner(), glm::step(glm::vec3(0.0f), direction));
+  }
+
+protected:
+  /**
+   * Get the support point of the collider from the support point of its untransformed shape. The support point of a transformed
+   *   shape is the transformed support point of the shape along the direction transformed the other way.
+   * 
+   * @param direction        The direction to find the point along, in world space.
+   * @param getLocalSupport  The function returning the support point of the untransformed shape along the given direction.
+   * 
+   * @return The support point, in world space.
+   */
+  template <typename LocalSupportFunction>
+  glm::vec3 getTransformedSupportPoint(const glm::vec3 &direction, const LocalSupportFunction &getLocalSupport) const
+  {
+    const auto rotationMatrix = glm::mat3_cast(rotation);
+    const auto localDirection = scale * (glm::transpose(rotationMatrix) * direction);
+    return position + (rotationMatrix * (scale * getLocalSupport(localDirection)));
   }
 };
 
@@ -374,7 +524,7 @@ private:
   const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const float_t radius)
   {
     // Generates the base AABB by using the negative and positive values of the radius to get the min/max-corners of the AABB.
-    return std::make_shared<AxisAlignedBoundingBox>(glm::vec3(-radius, -radius, -radius), glm::vec3(radius, radius, radius));
+    return makePooledShared<AxisAlignedBoundingBox>(glm::vec3(-radius, -radius, -radius), glm::vec3(radius, radius, radius));
   }
 
   /**
@@ -412,7 +562,7 @@ private:
 public:
   SphereColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const float_t &radius)
       : ColliderShape(
@@ -425,16 +575,16 @@ public:
 
   SphereColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
-      const std::vector<glm::vec3> &vertices)
+      const ColliderPrototype &prototype)
       : ColliderShape(
             ColliderShapeType::SPHERE,
             position,
             rotation,
             scale,
-            createBaseBox(createRadius(vertices))),
-        radius(createRadius(vertices)) {}
+            prototype.sphereBaseBox),
+        radius(prototype.sphereRadius) {}
 
   /**
    * Returns the radius of the collider wphere.
@@ -446,6 +596,19 @@ public:
     return radius;
   }
 
+  bool isRotationInvariant() const override
+  {
+    // Rotating a sphere around its center still gives the same sphere.
+    return true;
+  }
+
+  glm::vec3 getSupportPoint(const glm::vec3 &direction) const override
+  {
+    // The sphere is only scaled by the x-axis of the scale, like in the other checks.
+    const auto directionLength = glm::length(direction);
+    return position + ((directionLength > 0.0f ? direction / directionLength : glm::vec3(1.0f, 0.0f, 0.0f)) * (radius * scale.x));
+  }
+
   /**
    * Update the transformations of the collider (position, rotation, scale).
    * 
@@ -453,7 +616,7 @@ public:
    * @param newRotation  The new rotation of the collider.
    * @param newScale  The new scale of the collider.
    */
-  void updateTransformations(const glm::vec3 &newPosition, const glm::vec3 &newRotation, const glm::vec3 &newScale) override
+  void updateTransformations(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale) override
   {
     (void)newRotation;
 
@@ -464,8 +627,8 @@ public:
     // // rotation = newRotation;
     // Update the collider scale.
     scale = newScale;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Mark the transformation AABB to be generated on its next access.
+    isTransformedBoxDirty = true;
   }
 
   /**
@@ -495,6 +658,19 @@ public:
   }
 };
 
+/**
+ * Structure for defining an oriented bounding box (OBB) in world space.
+ */
+struct OrientedBoundingBox
+{
+  // The center of the box.
+  glm::vec3 center;
+  // The normalized local axes of the box.
+  glm::vec3 axes[3];
+  // The half-sizes of the box along its local axes.
+  glm::vec3 extents;
+};
+
 /**
  * A collider that has the shape of a box (just like an AABB, but not aligned).
  */
@@ -502,7 +678,7 @@ class BoxColliderShape : public ColliderShape
 {
 private:
   // The list of the eight corners of the collider box.
-  std::vector<glm::vec3> corners;
+  std::array<glm::vec3, 8> corners;
 
   /**
    * Creates the colliders' base AABB using the corners of the box.
@@ -511,10 +687,10 @@ private:
    * 
    * @return The collider base AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const std::vector<glm::vec3> &corners)
+  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const std::array<glm::vec3, 8> &corners)
   {
     // Just forward the corners of the box to the AABB constructor, which can generate the AABB accordingly.
-    return std::make_shared<const AxisAlignedBoundingBox>(corners);
+    return makePooledShared<AxisAlignedBoundingBox>(corners);
   }
 
   /**
@@ -524,7 +700,7 @@ private:
    * 
    * @return The corners of the box.
    */
-  const std::vector<glm::vec3> createCorners(const std::vector<glm::vec3> &vertices)
+  const std::array<glm::vec3, 8> createCorners(const std::vector<glm::vec3> &vertices)
   {
     // Set the min-corner to the first vertex in the list.
     glm::vec3 minCorner = vertices[0];
@@ -548,8 +724,8 @@ private:
     const glm::vec2 minMaxY(glm::min(minCorner.y, maxCorner.y), glm::max(minCorner.y, maxCorner.y));
     const glm::vec2 minMaxZ(glm::min(minCorner.z, maxCorner.z), glm::max(minCorner.z, maxCorner.z));
 
-    // Define a vector for storing the corners of the collider box.
-    std::vector<glm::vec3> newCorners({});
+    // Define an array for storing the corners of the collider box.
+    std::array<glm::vec3, 8> newCorners;
     // Iterate through the minimum and maximum coordinate values of all the axes
     for (auto x = 0; x < 2; x++)
     {
@@ -558,7 +734,7 @@ private:
         for (auto z = 0; z < 2; z++)
         {
           // The combination of the various min/max values of each axis gives us a coordinate of the box.
-          newCorners.push_back(glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]));
+          newCorners[(x * 4) + (y * 2) + z] = glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]);
         }
       }
     }
@@ -570,7 +746,7 @@ private:
 public:
   BoxColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const glm::vec3 &oppositeCorner1,
       const glm::vec3 &oppositeCorner2)
@@ -584,27 +760,55 @@ public:
 
   BoxColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
-      const std::vector<glm::vec3> &vertices)
+      const ColliderPrototype &prototype)
       : ColliderShape(
             ColliderShapeType::BOX,
             position,
             rotation,
             scale,
-            createBaseBox(createCorners(vertices))),
-        corners(createCorners(vertices)) {}
+            prototype.boxBaseBox),
+        corners(prototype.boxBaseBox->getCorners()) {}
 
   /**
    * Get all the eight corners of the collider box.
    * 
    * @return The list of the eight corners.
    */
-  const std::vector<glm::vec3> &getCorners() const
+  const std::array<glm::vec3, 8> &getCorners() const
   {
     return corners;
   }
 
+  /**
+   * Get the collider box as an oriented box in world space.
+   * 
+   * @return The oriented box.
+   */
+  OrientedBoundingBox getOrientedBox() const
+  {
+    // The first and last corners of the box are its min/max-corners before any transformations.
+    const auto localCenter = (corners[0] + corners[7]) * 0.5f;
+    const auto rotationMatrix = glm::mat3_cast(rotation);
+    return {
+        position + (rotationMatrix * (localCenter * scale)),
+        {rotationMatrix[0], rotationMatrix[1], rotationMatrix[2]},
+        glm::abs((corners[7] - corners[0]) * 0.5f * scale)};
+  }
+
+  glm::vec3 getSupportPoint(const glm::vec3 &direction) const override
+  {
+    // Pick the corner of the box on the side of the direction along each of its axes.
+    const auto box = getOrientedBox();
+    auto supportPoint = box.center;
+    for (auto i = 0; i < 3; i++)
+    {
+      supportPoint += box.axes[i] * (glm::dot(direction, box.axes[i]) >= 0.0f ? box.extents[i] : -box.extents[i]);
+    }
+    return supportPoint;
+  }
+
   /**
    * Update the corners of the collider box using the given opposite corners for the new box.
    * 
@@ -634,7 +838,7 @@ public:
 };
 
 /**
- * A collider that has the shape of a sphere.
+ * A collider that has the shape of a cylinder, standing along the y-axis.
  */
 class CylinderColliderShape : public ColliderShape
 {
@@ -655,7 +859,7 @@ private:
   const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const float_t radius, const float_t halfHeight)
   {
     // Generates the base AABB by using the negative and positive values of the radius and half-height to get the min/max-corners of the AABB.
-    return std::make_shared<AxisAlignedBoundingBox>(glm::vec3(-radius, -halfHeight, -radius), glm::vec3(radius, halfHeight, radius));
+    return makePooledShared<AxisAlignedBoundingBox>(glm::vec3(-radius, -halfHeight, -radius), glm::vec3(radius, halfHeight, radius));
   }
 
   /**
@@ -722,13 +926,13 @@ private:
     }
 
     // Return the half-height of the cylinder.
-    return std::max(std::abs(minCorner.y), std::abs(minCorner.y));
+    return std::max(std::abs(minCorner.y), std::abs(maxCorner.y));
   }
 
 public:
   CylinderColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const float_t &radius,
       const float_t &halfHeight)
@@ -743,17 +947,17 @@ public:
 
   CylinderColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
-      const std::vector<glm::vec3> &vertices)
-      : radius(calculateRadius(vertices)),
-        halfHeight(calculateHalfHeight(vertices)),
-        ColliderShape(
-            ColliderShapeType::BOX,
+      const ColliderPrototype &prototype)
+      : ColliderShape(
+            ColliderShapeType::CYLINDER,
             position,
             rotation,
             scale,
-            createBaseBox(calculateRadius(vertices), calculateHalfHeight(vertices))) {}
+            prototype.cylinderBaseBox),
+        radius(prototype.cylinderRadius),
+        halfHeight(prototype.cylinderHalfHeight) {}
 
   /**
    * Get the radius of the collider cylinder.
@@ -775,6 +979,16 @@ public:
     return halfHeight;
   }
 
+  glm::vec3 getSupportPoint(const glm::vec3 &direction) const override
+  {
+    return getTransformedSupportPoint(direction, [this](const glm::vec3 &localDirection) {
+      // Pick the point of the cap on the side of the direction, at the edge of the cap in the direction.
+      const auto radialLength = glm::length(glm::vec2(localDirection.x, localDirection.z));
+      const auto radialPoint = radialLength > 0.0f ? glm::vec2(localDirection.x, localDirection.z) * (radius / radialLength) : glm::vec2(0.0f);
+      return glm::vec3(radialPoint.x, localDirection.y >= 0.0f ? halfHeight : -halfHeight, radialPoint.y);
+    });
+  }
+
   /**
    * Update the radius and half-height of the collider cylinder using the given radius and half-height of the new cylinder.
    * 
@@ -806,220 +1020,1089 @@ public:
 };
 
 /**
- * A class that can perform a collision check between all supported collider types.
+ * A collider that has the shape of a pill (a capsule), made of a cylinder standing along the y-axis capped by two half-spheres.
  */
-class DeepCollisionValidator
+class PillColliderShape : public ColliderShape
 {
 private:
+  // The radius of the collider.
+  float_t radius;
+  // The half-height of the segment between the centers of the two half-spheres.
+  float_t halfHeight;
+
   /**
-   * Check if two sphere colliders have interesected/collided with each other.
+   * Creates the colliders' base AABB using the radius and half-height of the pill.
    * 
-   * @param sphere1  The first sphere collider.
-   * @param sphere2  The second sphere collider.
+   * @param radius      The radius of the pill.
+   * @param halfHeight  The half-height of the segment of the pill.
    * 
-   * @return Whether the two sphere colliders have collided or not.
+   * @return The collider base AABB.
    */
-  static bool haveSphereSphereCollided(const std::shared_ptr<const SphereColliderShape> &sphere1, const std::shared_ptr<const SphereColliderShape> &sphere2)
+  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const float_t radius, const float_t halfHeight)
   {
-    // Calculate the scaled radius of the first collider sphere based on the scale of the collider.
-    const auto sphere1ScaledRadius = sphere1->getRadius() * sphere1->getScale().x;
-    // Calculate the scaled radius of the second collider sphere based on the scale of the collider.
-    const auto sphere2ScaledRadius = sphere2->getRadius() * sphere2->getScale().x;
-
-    // Calculate the distance between the centres of the spheres.
-    const auto distanceBetweenSpheres = glm::distance(sphere1->getPosition(), sphere2->getPosition());
-    // If the distance between the spheres is greater than the sum of the radii of the two spheres, then the two have not collided.
-    return distanceBetweenSpheres <= (sphere1ScaledRadius + sphere2ScaledRadius);
+    // Generates the base AABB by extending the segment of the pill by the radius on every side.
+    return makePooledShared<AxisAlignedBoundingBox>(glm::vec3(-radius, -(halfHeight + radius), -radius), glm::vec3(radius, halfHeight + radius, radius));
   }
 
   /**
-   * Check if two cylinder colliders have interesected/collided with each other.
+   * Calculates the radius of the collider pill using the given vertices of the model.
    * 
-   * @param cylinder1  The first cylinder collider.
-   * @param cylinder2  The second cylinder collider.
+   * @param vertices  The vertices of the model.
    * 
-   * @return Whether the two cylinder colliders have collided or not.
+   * @return The radius of the pill.
    */
-  static bool haveCylinderCylinderCollided(const std::shared_ptr<const CylinderColliderShape> &cylinder1, const std::shared_ptr<const CylinderColliderShape> &cylinder2)
+  const float_t calculateRadius(const std::vector<glm::vec3> &vertices)
   {
-    return false;
+    // Use the farthest distance of a vertex from the y-axis as the radius.
+    auto radius = 0.0f;
+    for (const auto &vertex : vertices)
+    {
+      radius = std::max(radius, glm::length(glm::vec2(vertex.x, vertex.z)));
+    }
+    return radius;
   }
 
   /**
-   * Check if two box colliders have interesected/collided with each other.
+   * Calculates the half-height of the segment of the collider pill using the given vertices of the model.
    * 
-   * @param box1  The first box collider.
-   * @param box2  The second box collider.
+   * @param vertices  The vertices of the model.
    * 
-   * @return Whether the two box colliders have collided or not.
+   * @return The half-height of the segment of the pill.
    */
-  static bool haveBoxBoxCollided(const std::shared_ptr<const BoxColliderShape> &box1, const std::shared_ptr<const BoxColliderShape> &box2)
+  const float_t calculateHalfHeight(const std::vector<glm::vec3> &vertices)
   {
-    // Get the transformation matrix of the first collider box.
-    const auto box1TransformationMatrix = glm::translate(box1->getPosition()) * glm::toMat4(glm::quat(box1->getRotation())) * glm::scale(box1->getScale()) * glm::mat4();
-    // Calculate the inverse of the first boxes' transformation matrix.
-    const auto box1InverseTransformationMatrix = glm::inverse(box1TransformationMatrix);
-
-    // Get the transformation matrix of the second collider box.
-    const auto box2TransformationMatrix = glm::translate(box2->getPosition()) * glm::toMat4(glm::quat(box2->getRotation())) * glm::scale(box2->getScale()) * glm::mat4();
-    // Calculate the inverse of the second boxes' transformation matrix.
-    const auto box2InverseTransformationMatrix = glm::inverse(box2TransformationMatrix);
-
-    // Get the corners of the first box.
-    const auto box1Corners = box1->getCorners();
-    // Define a vector for storing the transformed corners of the first box.
-    std::vector<glm::vec3> box1TransformedCorners({});
-    // Iterate through the corners of the first box.
-    for (const auto &box1Corner : box1Corners)
+    // Use the farthest distance of a vertex along the y-axis, minus the part the half-spheres cover.
+    auto halfHeight = 0.0f;
+    for (const auto &vertex : vertices)
     {
-      // Transform the corner using the boxes' transformation matrix and add it to the result list.
-      box1TransformedCorners.push_back(glm::vec3(box1TransformationMatrix * glm::vec4(box1Corner, 1.0f)));
+      halfHeight = std::max(halfHeight, std::abs(vertex.y));
     }
+    return std::max(0.0f, halfHeight - calculateRadius(vertices));
+  }
 
-    const auto box2Corners = box2->getCorners();
-    // Define a vector for storing the transformed corners of the first box.
-    std::vector<glm::vec3> box2TransformedCorners({});
-    // Iterate through the corners of the second box.
-    for (const auto &box2Corner : box2Corners)
-    {
-      // Transform the corner using the boxes' transformation matrix and add it to the result list.
-      box2TransformedCorners.push_back(glm::vec3(box2TransformationMatrix * glm::vec4(box2Corner, 1.0f)));
-    }
+public:
+  PillColliderShape(
+      const glm::vec3 &position,
+      const glm::quat &rotation,
+      const glm::vec3 &scale,
+      const float_t &radius,
+      const float_t &halfHeight)
+      : ColliderShape(
+            ColliderShapeType::PILL,
+            position,
+            rotation,
+            scale,
+            createBaseBox(radius, halfHeight)),
+        radius(radius),
+        halfHeight(halfHeight) {}
 
-    // Create an AABB using the corners of the second box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox box2AABB(box2->getCorners());
-    // Get the min-corner of the second box.
-    const auto box2AABBMinCorners = box2AABB.getMinCorner();
-    // Get the max-corner of the second box.
-    const auto box2AABBMaxCorners = box2AABB.getMaxCorner();
-    // Iterate through the transformed vertices of the first box.
-    for (const auto &box1Corner : box1TransformedCorners)
-    {
-      // Transform the vertex of the first box into the space of the second box
-      const auto box1CornerInBox2Space = glm::vec3(box2InverseTransformationMatrix * glm::vec4(box1Corner, 1.0f));
-      // Check if the vertex of the first box has collided with the second box.
-      const auto isBox1CornerInBox2 = (box1CornerInBox2Space.x >= box2AABBMinCorners.x && box1CornerInBox2Space.x <= box2AABBMaxCorners.x) &&
-                                      (box1CornerInBox2Space.y >= box2AABBMinCorners.y && box1CornerInBox2Space.y <= box2AABBMaxCorners.y) &&
-                                      (box1CornerInBox2Space.z >= box2AABBMinCorners.z && box1CornerInBox2Space.z <= box2AABBMaxCorners.z);
-      // If we have detected a collision, then the two boxes have collided.
-      if (isBox1CornerInBox2)
-      {
-        return true;
-      }
-    }
+  PillColliderShape(
+      const glm::vec3 &position,
+      const glm::quat &rotation,
+      const glm::vec3 &scale,
+      const ColliderPrototype &prototype)
+      : ColliderShape(
+            ColliderShapeType::PILL,
+            position,
+            rotation,
+            scale,
+            prototype.pillBaseBox),
+        radius(prototype.pillRadius),
+        halfHeight(prototype.pillHalfHeight) {}
 
-    // Create an AABB using the corners of the first box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox box1AABB(box1->getCorners());
-    // Get the min-corner of the first box.
-    const auto box1AABBMinCorners = box1AABB.getMinCorner();
-    // Get the max-corner of the first box.
-    const auto box1AABBMaxCorners = box1AABB.getMaxCorner();
-    // Iterate through the transformed vertices of the second box.
-    for (const auto &box2Corner : box2TransformedCorners)
-    {
-      // Transform the vertex of the second box into the space of the first box
-      const auto box2CornerInBox1Space = glm::vec3(box1InverseTransformationMatrix * glm::vec4(box2Corner, 1.0f));
-      // Check if the vertex of the second box has collided with the first box.
-      const auto isBox2CornerInBox1 = (box2CornerInBox1Space.x >= box1AABBMinCorners.x && box2CornerInBox1Space.x <= box1AABBMaxCorners.x) &&
-                                      (box2CornerInBox1Space.y >= box1AABBMinCorners.y && box2CornerInBox1Space.y <= box1AABBMaxCorners.y) &&
-                                      (box2CornerInBox1Space.z >= box1AABBMinCorners.z && box2CornerInBox1Space.z <= box1AABBMaxCorners.z);
-      // If we have detected a collision, then the two boxes have collided.
-      if (isBox2CornerInBox1)
-      {
-        return true;
-      }
-    }
+  /**
+   * Get the radius of the collider pill.
+   * 
+   * @return The radius.
+   */
+  const float_t &getRadius() const
+  {
+    return radius;
+  }
 
-    // No collision has been detected, so return false.
-    return false;
+  /**
+   * Get the half-height of the segment of the collider pill.
+   * 
+   * @return The half-height.
+   */
+  const float_t &getHalfHeight() const
+  {
+    return halfHeight;
+  }
+
+  glm::vec3 getSupportPoint(const glm::vec3 &direction) const override
+  {
+    return getTransformedSupportPoint(direction, [this](const glm::vec3 &localDirection) {
+      // Pick the center of the half-sphere on the side of the direction, and go out to its surface in the direction.
+      const auto directionLength = glm::length(localDirection);
+      const auto spherePoint = directionLength > 0.0f ? localDirection * (radius / directionLength) : glm::vec3(0.0f);
+      return glm::vec3(0.0f, localDirection.y >= 0.0f ? halfHeight : -halfHeight, 0.0f) + spherePoint;
+    });
   }
 
   /**
-   * Check if a box collider and a spehere collider have interesected/collided with each other.
+   * Update the radius and half-height of the collider pill.
    * 
-   * @param box     The box collider.
-   * @param sphere  The sphere collider.
+   * @param newRadius      The radius of the pill.
+   * @param newHalfHeight  The half-height of the segment of the pill.
+   */
+  void update(const float_t &newRadius, const float_t &newHalfHeight)
+  {
+    radius = newRadius;
+    halfHeight = newHalfHeight;
+    // Generate the new base AABB of the collider.
+    updateBaseBox(createBaseBox(newRadius, newHalfHeight));
+  }
+
+  /**
+   * Update the radius and half-height of the collider pill using the given list of vertices of the model.
    * 
-   * @return Whether the box and sphere colliders have collided or not.
+   * @param newVertices  The list vertices of the model to use to calculate the new radius and half-height.
    */
-  static bool haveBoxSphereCollided(const std::shared_ptr<const BoxColliderShape> &box, const std::shared_ptr<const SphereColliderShape> &sphere)
+  void update(const std::vector<glm::vec3> &newVertices)
   {
-    // Get the transformation matrix of the collider box.
-    const auto boxTransformationMatrix = glm::translate(box->getPosition()) * glm::toMat4(glm::quat(box->getRotation())) * glm::scale(box->getScale());
-    // Calculate the inverse of the boxes' transformation matrix.
-    const auto boxInverseTransformationMatrix = glm::inverse(boxTransformationMatrix);
-    // Create an AABB using the corners of the box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox boxAABB(box->getCorners());
-    // Get the min-corner of the box.
-    const auto boxAABBMinCorners = boxAABB.getMinCorner();
-    // Get the max-corner of the box.
-    const auto boxAABBMaxCorners = boxAABB.getMaxCorner();
+    radius = calculateRadius(newVertices);
+    halfHeight = calculateHalfHeight(newVertices);
+    // Generate the new base AABB of the collider.
+    updateBaseBox(createBaseBox(radius, halfHeight));
+  }
+};
 
-    // Calculate the scaled radius of the collider sphere based on the scale of the collider.
-    const auto sphereScaledRadius = glm::length(glm::inverse(glm::scale(box->getScale())) * glm::scale(sphere->getScale()) * glm::vec4(glm::vec3(sphere->getRadius()), 1.0f));
-    // Calculate the position of the wphere w.r.t the box using the boxes' inverse transformation matrix.
-    const auto spherePositionInBoxSpace = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere->getPosition(), 1.0f));
-    // Calculate the point on the box that is closest to the sphere.
-    const auto boxPointClosesToSphere = glm::vec3(
-        glm::max(boxAABBMinCorners.x, glm::min(spherePositionInBoxSpace.x, boxAABBMaxCorners.x)),
-        glm::max(boxAABBMinCorners.y, glm::min(spherePositionInBoxSpace.y, boxAABBMaxCorners.y)),
-        glm::max(boxAABBMinCorners.z, glm::min(spherePositionInBoxSpace.z, boxAABBMaxCorners.z)));
-    // Calculate the distance between the boxes' closest point and the center of the sphere.
-    const auto distanceBetweenClosestBoxPointAndSphereCenter = glm::distance(boxPointClosesToSphere, spherePositionInBoxSpace);
+/**
+ * Structure for defining how deep two colliders overlap.
+ */
+struct ConvexPenetration
+{
+  // The direction to push the first collider along to separate it from the second one.
+  glm::vec3 normal;
+  // How far the first collider has to be pushed along the normal.
+  float_t depth;
+};
 
-    // If the distance between the closest point on the box and the center of the sphere is greater than the radius of the sphere,
-    //   then the two have not collided.
-    return distanceBetweenClosestBoxPointAndSphereCenter <= sphereScaledRadius;
+/**
+ * A class that checks any two convex colliders against each other through their support points alone: GJK (Gilbert-Johnson-Keerthi)
+ *   to check if they overlap, and EPA (Expanding Polytope Algorithm) to find how deep. Both work on the Minkowski difference of the
+ *   two shapes, which contains the origin only if the shapes overlap, and both stop after a bounded number of iterations.
+ * The last separating direction of each pair of colliders is cached, since the colliders barely move between two checks and
+ *   starting from it usually separates them again in the first iteration.
+ */
+class ConvexCollisionValidator
+{
+private:
+  // The most iterations GJK and EPA run for.
+  const static int32_t MAX_ITERATIONS;
+  // The most pairs of colliders the warm-start cache holds before it is cleared.
+  const static size_t MAX_CACHED_PAIRS;
+
+  // The last separating direction of each pair of colliders checked.
+  static std::map<std::pair<const ColliderShape *, const ColliderShape *>, glm::vec3> separatingDirections;
+  // The mutex guarding the warm-start cache, since the pipelined collision pass checks pairs on a worker thread while the scene
+  //   code queries the colliders on the main thread.
+  static std::mutex separatingDirectionsMutex;
+
+  /**
+   * Structure for defining the simplex GJK builds up inside the Minkowski difference, the newest point first.
+   */
+  struct Simplex
+  {
+    std::array<glm::vec3, 4> points;
+    int32_t size;
+  };
+
+  /**
+   * Get the support point of the Minkowski difference of the two colliders.
+   * 
+   * @param shape1     The first collider shape.
+   * @param offset1    The offset the first collider is moved by.
+   * @param shape2     The second collider shape.
+   * @param direction  The direction to find the point along.
+   * 
+   * @return The support point.
+   */
+  static glm::vec3 getSupportPoint(const ColliderShape &shape1, const glm::vec3 &offset1, const ColliderShape &shape2, const glm::vec3 &direction)
+  {
+    return (shape1.getSupportPoint(direction) + offset1) - shape2.getSupportPoint(-direction);
   }
 
-public:
   /**
-   * Checks if the two given collider shapes have intersected/collided with each other.
+   * Reduce the simplex to the feature closest to the origin, and point the direction from it towards the origin.
    * 
-   * @param shape1              The first collider shape.
-   * @param shape2              The second collider shape.
-   * @param deepCollisionCheck  Whether to perform a deep collision check or not. If not, we just check if the
-   *                              AABBs of the two colliders have collided or not.
+   * @param simplex    The simplex, with the newest point first.
+   * @param direction  Set to the next direction to search along.
    * 
-   * @return Whether the two colldier shapes have collided or not.
+   * @return Whether the simplex contains the origin or not.
    */
-  static bool haveShapesCollided(const std::shared_ptr<const ColliderShape> &shape1, const std::shared_ptr<const ColliderShape> &shape2, const bool &deepCollisionCheck)
+  static bool updateSimplex(Simplex &simplex, glm::vec3 &direction)
   {
-    // Check if the AABBs of the two shapes have collided or not.
-    if (!shape1->getTransformedBox()->hasCollided(*(shape2->getTransformedBox())))
+    const auto a = simplex.points[0];
+    const auto ao = -a;
+    switch (simplex.size)
     {
-      // If not, no need to do a deeper check, so just return false.
-      return false;
-    }
-    // If a deep collision check wasn't request, then just return true since the shallow check has passed.
-    if (!deepCollisionCheck)
+    case 2:
     {
-      return true;
+      // The origin is either beside the line or behind its newest point (never behind the oldest one, which was searched past).
+      const auto ab = simplex.points[1] - a;
+      if (glm::dot(ab, ao) > 0.0f)
+      {
+        direction = glm::cross(glm::cross(ab, ao), ab);
+      }
+      else
+      {
+        simplex.size = 1;
+        direction = ao;
+      }
+      break;
     }
-
-    // Calculate a mask to determine what shape collision function is required.
-    const auto shapeTypeMask = (shape1->getType()) + (2 * shape2->getType());
-    // Put the mask through a switch case.
-    switch (shapeTypeMask)
-    {
-    case 0:
-      // Both colliders are a sphere. Perform the check accordingly.
-      return haveSphereSphereCollided(std::dynamic_pointer_cast<const SphereColliderShape>(shape1), std::dynamic_pointer_cast<const SphereColliderShape>(shape2));
-    case 1:
-      // First collider is a box, second is a sphere. Perform the check accordingly.
-      return haveBoxSphereCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape1), std::dynamic_pointer_cast<const SphereColliderShape>(shape2));
-    case 2:
-      // First collider is a sphere, second is a box. Perform the check accordingly.
-      return haveBoxSphereCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape2), std::dynamic_pointer_cast<const SphereColliderShape>(shape1));
     case 3:
-      // Both colliders are a box. Perform the check accordingly.
-      return haveBoxBoxCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape1), std::dynamic_pointer_cast<const BoxColliderShape>(shape2));
-    default:
-      // Can't determine the shapes, so say the two haven't collided.
-      return false;
-    }
-  }
-};
+    {
+      const auto b = simplex.points[1], c = simplex.points[2];
+      const auto ab = b - a, ac = c - a;
+      const auto abc = glm::cross(ab, ac);
+      if (glm::dot(glm::cross(abc, ac), ao) > 0.0f)
+      {
+        // The origin is beyond the edge AC, or behind A.
+        if (glm::dot(ac, ao) > 0.0f)
+        {
+          simplex = {{a, c}, 2};
+          direction = glm::cross(glm::cross(ac, ao), ac);
+        }
+        else
+        {
+          simplex = {{a, b}, 2};
+          return updateSimplex(simplex, direction);
+        }
+      }
+      else if (glm::dot(glm::cross(ab, abc), ao) > 0.0f)
+      {
+        // The origin is beyond the edge AB, or behind A.
+        simplex = {{a, b}, 2};
+        return updateSimplex(simplex, direction);
+      }
+      else if (glm::dot(abc, ao) > 0.0f)
+      {
+        // The origin is above the triangle.
+        direction = abc;
+      }
+      else
+      {
+        // The origin is below the triangle, so flip it to keep the faces of the tetrahedron wound the same way.
+        simplex = {{a, c, b}, 3};
+        direction = -abc;
+      }
+      break;
+    }
+    case 4:
+    {
+      // The origin is inside the tetrahedron unless it is beyond one of the faces with the newest point.
+      const auto b = simplex.points[1], c = simplex.points[2], d = simplex.points[3];
+      if (glm::dot(glm::cross(b - a, c - a), ao) > 0.0f)
+      {
+        simplex = {{a, b, c}, 3};
+        return updateSimplex(simplex, direction);
+      }
+      if (glm::dot(glm::cross(c - a, d - a), ao) > 0.0f)
+      {
+        simplex = {{a, c, d}, 3};
+        return updateSimplex(simplex, direction);
+      }
+      if (glm::dot(glm::cross(d - a, b - a), ao) > 0.0f)
+      {
+        simplex = {{a, d, b}, 3};
+        return updateSimplex(simplex, direction);
+      }
+      return true;
+    }
+    }
+
+    // The origin lies on the simplex if there is no direction left to search along.
+    return glm::dot(direction, direction) < 1e-12f;
+  }
+
+  /**
+   * Run GJK on the two colliders.
+   * 
+   * @param shape1   The first collider shape.
+   * @param offset1  The offset the first collider is moved by.
+   * @param shape2   The second collider shape.
+   * @param simplex  Set to the last simplex, which is a tetrahedron containing the origin when the colliders overlap deeply enough.
+   * 
+   * @return Whether the colliders overlap or not.
+   */
+  static bool runGjk(const ColliderShape &shape1, const glm::vec3 &offset1, const ColliderShape &shape2, Simplex &simplex)
+  {
+    // Start from the last separating direction of the pair, or the direction between the colliders for a new pair.
+    const auto pairKey = std::make_pair(&shape1, &shape2);
+    auto direction = (shape1.getPosition() + offset1) - shape2.getPosition();
+    {
+      const std::lock_guard<std::mutex> lock(separatingDirectionsMutex);
+      const auto cachedDirection = separatingDirections.find(pairKey);
+      if (cachedDirection != separatingDirections.end())
+      {
+        direction = cachedDirection->second;
+      }
+    }
+    if (glm::dot(direction, direction) < 1e-12f)
+    {
+      direction = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    simplex = {{getSupportPoint(shape1, offset1, shape2, direction)}, 1};
+    direction = -simplex.points[0];
+    for (auto i = 0; i < MAX_ITERATIONS; i++)
+    {
+      // The origin is on the simplex, so the colliders touch.
+      if (glm::dot(direction, direction) < 1e-12f)
+      {
+        return true;
+      }
+
+      // The colliders are apart if the Minkowski difference doesn't reach past the origin along the direction.
+      const auto point = getSupportPoint(shape1, offset1, shape2, direction);
+      if (glm::dot(point, direction) < 0.0f)
+      {
+        const std::lock_guard<std::mutex> lock(separatingDirectionsMutex);
+        if (separatingDirections.size() >= MAX_CACHED_PAIRS)
+        {
+          separatingDirections.clear();
+        }
+        separatingDirections[pairKey] = direction;
+        return false;
+      }
+
+      // Add the point as the newest point of the simplex.
+      for (auto j = simplex.size; j > 0; j--)
+      {
+        simplex.points[j] = simplex.points[j - 1];
+      }
+      simplex.points[0] = point;
+      simplex.size++;
+      if (updateSimplex(simplex, direction))
+      {
+        return true;
+      }
+    }
+
+    // Only colliders barely touching take this many iterations, so count them as overlapping.
+    return true;
+  }
+
+public:
+  /**
+   * Check if two colliders overlap.
+   * 
+   * @param shape1   The first collider shape.
+   * @param shape2   The second collider shape.
+   * @param offset1  The offset to move the first collider by before checking.
+   * 
+   * @return Whether the two colliders overlap or not.
+   */
+  static bool haveShapesCollided(const ColliderShape &shape1, const ColliderShape &shape2, const glm::vec3 &offset1 = glm::vec3(0.0f))
+  {
+    Simplex simplex;
+    return runGjk(shape1, offset1, shape2, simplex);
+  }
+
+  /**
+   * Find how deep two colliders overlap.
+   * 
+   * @param shape1       The first collider shape.
+   * @param shape2       The second collider shape.
+   * @param penetration  Set to the direction and depth of the overlap, if the colliders overlap.
+   * 
+   * @return Whether the two colliders overlap or not.
+   */
+  static bool getPenetration(const ColliderShape &shape1, const ColliderShape &shape2, ConvexPenetration &penetration)
+  {
+    const auto offset1 = glm::vec3(0.0f);
+    Simplex simplex;
+    if (!runGjk(shape1, offset1, shape2, simplex))
+    {
+      return false;
+    }
+
+    // Colliders that only touch leave a flat simplex, which has no depth to expand.
+    if (simplex.size < 4)
+    {
+      const auto direction = shape2.getPosition() - shape1.getPosition();
+      penetration = {glm::dot(direction, direction) > 0.0f ? -glm::normalize(direction) : glm::vec3(0.0f, 1.0f, 0.0f), 0.0f};
+      return true;
+    }
+
+    // Expand the tetrahedron towards the surface of the Minkowski difference, one support point at a time, through the face
+    //   closest to the origin, until the closest face is on the surface.
+    std::vector<glm::vec3> vertices(simplex.points.begin(), simplex.points.end());
+    // Wind the faces of the tetrahedron so that their normals point out of it, which the faces added later keep.
+    if (glm::dot(glm::cross(vertices[1] - vertices[0], vertices[2] - vertices[0]), vertices[3] - vertices[0]) > 0.0f)
+    {
+      std::swap(vertices[1], vertices[2]);
+    }
+    std::vector<std::array<size_t, 3>> faces({{0, 1, 2}, {0, 2, 3}, {0, 3, 1}, {1, 3, 2}});
+    std::vector<std::pair<size_t, size_t>> edges({});
+    glm::vec3 normal(0.0f, 1.0f, 0.0f);
+    auto distance = 0.0f;
+    for (auto i = 0; i < MAX_ITERATIONS; i++)
+    {
+      // Find the face closest to the origin.
+      auto closestFace = faces.size();
+      distance = std::numeric_limits<float_t>::infinity();
+      for (size_t j = 0; j < faces.size(); j++)
+      {
+        const auto &face = faces[j];
+        const auto faceNormal = glm::cross(vertices[face[1]] - vertices[face[0]], vertices[face[2]] - vertices[face[0]]);
+        const auto faceNormalLength = glm::length(faceNormal);
+        if (faceNormalLength < 1e-12f)
+        {
+          continue;
+        }
+        const auto faceDistance = glm::dot(faceNormal, vertices[face[0]]) / faceNormalLength;
+        if (faceDistance < distance)
+        {
+          closestFace = j;
+          distance = faceDistance;
+          normal = faceNormal / faceNormalLength;
+        }
+      }
+      if (closestFace == faces.size())
+      {
+        break;
+      }
+
+      // Stop once the surface is no farther along the normal than the closest face.
+      const auto point = getSupportPoint(shape1, offset1, shape2, normal);
+      if (glm::dot(point, normal) - distance < 1e-4f)
+      {
+        break;
+      }
+
+      // Remove the faces the new point can see, keeping the edges on the boundary of the hole they leave.
+      edges.clear();
+      for (size_t j = 0; j < faces.size();)
+      {
+        const auto &face = faces[j];
+        if (glm::dot(glm::cross(vertices[face[1]] - vertices[face[0]], vertices[face[2]] - vertices[face[0]]), point - vertices[face[0]]) <= 0.0f)
+        {
+          j++;
+          continue;
+        }
+        for (auto k = 0; k < 3; k++)
+        {
+          // An edge shared by two removed faces is inside the hole.
+          const auto edge = std::make_pair(face[k], face[(k + 1) % 3]);
+          const auto reversedEdge = std::find(edges.begin(), edges.end(), std::make_pair(edge.second, edge.first));
+          if (reversedEdge != edges.end())
+          {
+            edges.erase(reversedEdge);
+          }
+          else
+          {
+            edges.push_back(edge);
+          }
+        }
+        faces[j] = faces.back();
+        faces.pop_back();
+      }
+
+      // Close the hole with faces from its boundary to the new point.
+      vertices.push_back(point);
+      for (const auto &edge : edges)
+      {
+        faces.push_back({edge.first, edge.second, vertices.size() - 1});
+      }
+    }
+
+    // The Minkowski difference has to move by the normal times the distance to leave the origin, so the first collider has to
+    //   move the other way.
+    penetration = {-normal, distance};
+    return true;
+  }
+};
+
+// Initialize the iteration limit static variable.
+const int32_t ConvexCollisionValidator::MAX_ITERATIONS = 32;
+// Initialize the warm-start cache limit static variable.
+const size_t ConvexCollisionValidator::MAX_CACHED_PAIRS = 4096;
+// Initialize the warm-start cache static variable.
+std::map<std::pair<const ColliderShape *, const ColliderShape *>, glm::vec3> ConvexCollisionValidator::separatingDirections;
+// Initialize the warm-start cache mutex static variable.
+std::mutex ConvexCollisionValidator::separatingDirectionsMutex;
+
+/**
+ * A class that can perform a collision check between all supported collider types.
+ */
+class DeepCollisionValidator
+{
+private:
+  /**
+   * Check if two sphere colliders have interesected/collided with each other.
+   * 
+   * @param sphere1  The first sphere collider.
+   * @param sphere2  The second sphere collider.
+   * 
+   * @return Whether the two sphere colliders have collided or not.
+   */
+  static bool haveSphereSphereCollided(const SphereColliderShape &sphere1, const SphereColliderShape &sphere2)
+  {
+    // Calculate the scaled radius of the first collider sphere based on the scale of the collider.
+    const auto sphere1ScaledRadius = sphere1.getRadius() * sphere1.getScale().x;
+    // Calculate the scaled radius of the second collider sphere based on the scale of the collider.
+    const auto sphere2ScaledRadius = sphere2.getRadius() * sphere2.getScale().x;
+
+    // Calculate the distance between the centres of the spheres.
+    const auto distanceBetweenSpheres = glm::distance(sphere1.getPosition(), sphere2.getPosition());
+    // If the distance between the spheres is greater than the sum of the radii of the two spheres, then the two have not collided.
+    return distanceBetweenSpheres <= (sphere1ScaledRadius + sphere2ScaledRadius);
+  }
+
+  /**
+   * Check if two box colliders have interesected/collided with each other.
+   * 
+   * @param box1  The first box collider.
+   * @param box2  The second box collider.
+   * 
+   * @return Whether the two box colliders have collided or not.
+   */
+  static bool haveBoxBoxCollided(const BoxColliderShape &box1, const BoxColliderShape &box2)
+  {
+    return haveOrientedBoxesCollided(box1.getOrientedBox(), box2.getOrientedBox());
+  }
+
+  /**
+   * Get the squared distance from a point to an oriented box.
+   * 
+   * @param box    The oriented box.
+   * @param point  The point.
+   * 
+   * @return The squared distance (0 if the point is inside the box).
+   */
+  static float_t getSquaredBoxPointDistance(const OrientedBoundingBox &box, const glm::vec3 &point)
+  {
+    const auto offset = point - box.center;
+    auto squaredDistance = 0.0f;
+    for (auto i = 0; i < 3; i++)
+    {
+      // Project the offset on the local axis, and add how far it is outside the box along it.
+      const auto projection = glm::dot(offset, box.axes[i]);
+      const auto outside = projection - glm::clamp(projection, -box.extents[i], box.extents[i]);
+      squaredDistance += outside * outside;
+    }
+    return squaredDistance;
+  }
+
+  /**
+   * Get the time at which a moving oriented box first touches a sphere, by conservative advancement: the box is moved forward by
+   *   its distance to the sphere, which it cannot cover without touching it, until the distance is close enough to zero.
+   * 
+   * @param box           The oriented box at the start of the movement.
+   * @param displacement  The movement of the box.
+   * @param center        The center of the sphere.
+   * @param radius        The radius of the sphere.
+   * 
+   * @return The time of impact as a fraction of the movement (negative if the box does not touch the sphere).
+   */
+  static float_t getBoxSphereTimeOfImpact(const OrientedBoundingBox &box, const glm::vec3 &displacement, const glm::vec3 &center, const float_t &radius)
+  {
+    const auto displacementLength = glm::length(displacement);
+    auto time = 0.0f;
+    for (auto i = 0; i < 32; i++)
+    {
+      // Measure from the sphere moved back, which is the same as the box moved forward.
+      const auto distance = glm::sqrt(getSquaredBoxPointDistance(box, center - (displacement * time))) - radius;
+      if (distance <= 1e-4f)
+      {
+        return time;
+      }
+      if (displacementLength == 0.0f)
+      {
+        return -1.0f;
+      }
+
+      time += distance / displacementLength;
+      if (time > 1.0f)
+      {
+        return -1.0f;
+      }
+    }
+
+    // Only a movement grazing the sphere takes this many steps, so count it as touching where the steps stopped.
+    return time;
+  }
+
+  /**
+   * Get the time at which a moving sphere first touches another sphere.
+   * 
+   * @param center1       The center of the moving sphere at the start of the movement.
+   * @param radius1       The radius of the moving sphere.
+   * @param displacement  The movement of the moving sphere.
+   * @param center2       The center of the other sphere.
+   * @param radius2       The radius of the other sphere.
+   * 
+   * @return The time of impact as a fraction of the movement (negative if the spheres do not touch).
+   */
+  static float_t getSphereSphereTimeOfImpact(const glm::vec3 &center1, const float_t &radius1, const glm::vec3 &displacement, const glm::vec3 &center2, const float_t &radius2)
+  {
+    // Solve |offset + (displacement * time)| = radius sum for the smallest time.
+    const auto offset = center1 - center2;
+    const auto radiusSum = radius1 + radius2;
+    const auto c = glm::dot(offset, offset) - (radiusSum * radiusSum);
+    if (c <= 0.0f)
+    {
+      // The spheres already touch.
+      return 0.0f;
+    }
+
+    const auto a = glm::dot(displacement, displacement);
+    const auto b = glm::dot(offset, displacement);
+    const auto discriminant = (b * b) - (a * c);
+    if (a == 0.0f || b >= 0.0f || discriminant < 0.0f)
+    {
+      // The sphere is not moving towards the other sphere, or passes it by.
+      return -1.0f;
+    }
+
+    const auto time = (-b - glm::sqrt(discriminant)) / a;
+    return time <= 1.0f ? time : -1.0f;
+  }
+
+  /**
+   * Get the time at which a moving oriented box first touches another oriented box. Since the separating axis test only says
+   *   whether the boxes touch, the movement is sampled in steps shorter than the boxes, so that no contact is stepped over, and
+   *   the first touching step is then narrowed down by bisection.
+   * 
+   * @param box1          The moving oriented box at the start of the movement.
+   * @param displacement  The movement of the moving box.
+   * @param box2          The other oriented box.
+   * 
+   * @return The time of impact as a fraction of the movement (negative if the boxes do not touch).
+   */
+  static float_t getBoxBoxTimeOfImpact(const OrientedBoundingBox &box1, const glm::vec3 &displacement, const OrientedBoundingBox &box2)
+  {
+    const auto stepLength = glm::max(1e-4f, glm::min(glm::min(box1.extents.x, glm::min(box1.extents.y, box1.extents.z)), glm::min(box2.extents.x, glm::min(box2.extents.y, box2.extents.z))));
+    const auto stepCount = static_cast<int32_t>(glm::min(1024.0f, glm::ceil(glm::length(displacement) / stepLength)));
+
+    auto movedBox = box1;
+    auto lastTime = 0.0f;
+    for (auto i = 0; i <= stepCount; i++)
+    {
+      const auto time = stepCount == 0 ? 0.0f : static_cast<float_t>(i) / stepCount;
+      movedBox.center = box1.center + (displacement * time);
+      if (!haveOrientedBoxesCollided(movedBox, box2))
+      {
+        lastTime = time;
+        continue;
+      }
+      if (i == 0)
+      {
+        return 0.0f;
+      }
+
+      // Narrow the contact down between the last step apart and this one.
+      auto apartTime = lastTime, touchingTime = time;
+      for (auto j = 0; j < 8; j++)
+      {
+        const auto middleTime = (apartTime + touchingTime) * 0.5f;
+        movedBox.center = box1.center + (displacement * middleTime);
+        (haveOrientedBoxesCollided(movedBox, box2) ? touchingTime : apartTime) = middleTime;
+      }
+      return touchingTime;
+    }
+
+    return -1.0f;
+  }
+
+  /**
+   * Get the time at which a moving collider first touches another collider, the same way as getBoxBoxTimeOfImpact does, but with
+   *   the generic convex check so that it works for any shapes.
+   * 
+   * @param shape1        The moving collider shape, at the end of the movement.
+   * @param displacement  The movement of the moving collider.
+   * @param shape2        The other collider shape.
+   * 
+   * @return The time of impact as a fraction of the movement (negative if the colliders do not touch).
+   */
+  static float_t getConvexTimeOfImpact(const ColliderShape &shape1, const glm::vec3 &displacement, const ColliderShape &shape2)
+  {
+    const auto &box1 = shape1.getTransformedBox(), &box2 = shape2.getTransformedBox();
+    const auto extents = glm::min(box1.getMaxCorner() - box1.getMinCorner(), box2.getMaxCorner() - box2.getMinCorner()) * 0.5f;
+    const auto stepLength = glm::max(1e-4f, glm::min(extents.x, glm::min(extents.y, extents.z)));
+    const auto stepCount = static_cast<int32_t>(glm::min(1024.0f, glm::ceil(glm::length(displacement) / stepLength)));
+
+    // The collider is at the end of the movement, so it is offset back to where it was at each time.
+    auto lastTime = 0.0f;
+    for (auto i = 0; i <= stepCount; i++)
+    {
+      const auto time = stepCount == 0 ? 0.0f : static_cast<float_t>(i) / stepCount;
+      if (!ConvexCollisionValidator::haveShapesCollided(shape1, shape2, displacement * (time - 1.0f)))
+      {
+        lastTime = time;
+        continue;
+      }
+      if (i == 0)
+      {
+        return 0.0f;
+      }
+
+      // Narrow the contact down between the last step apart and this one.
+      auto apartTime = lastTime, touchingTime = time;
+      for (auto j = 0; j < 8; j++)
+      {
+        const auto middleTime = (apartTime + touchingTime) * 0.5f;
+        (ConvexCollisionValidator::haveShapesCollided(shape1, shape2, displacement * (middleTime - 1.0f)) ? touchingTime : apartTime) = middleTime;
+      }
+      return touchingTime;
+    }
+
+    return -1.0f;
+  }
+
+public:
+  /**
+   * Check if two oriented boxes have interesected/collided with each other, using the separating axis test.
+   * Two boxes are apart only if they are apart along one of the 15 axes made of the local axes of each box and the cross products
+   *   of those, so the test stops at the first axis the boxes are apart on, and all the math is done in the space of the first box.
+   * 
+   * @param orientedBox1  The first oriented box.
+   * @param orientedBox2  The second oriented box.
+   * 
+   * @return Whether the two oriented boxes have collided or not.
+   */
+  static bool haveOrientedBoxesCollided(const OrientedBoundingBox &orientedBox1, const OrientedBoundingBox &orientedBox2)
+  {
+    const auto &extents1 = orientedBox1.extents;
+    const auto &extents2 = orientedBox2.extents;
+
+    // Calculate the rotation of the second box in the space of the first box. The small value added to its absolute values keeps
+    //   the cross product axes from going wrong when edges of the two boxes are parallel (and the cross products are near zero).
+    glm::mat3 rotation, absoluteRotation;
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        rotation[i][j] = glm::dot(orientedBox1.axes[i], orientedBox2.axes[j]);
+        absoluteRotation[i][j] = glm::abs(rotation[i][j]) + 1e-6f;
+      }
+    }
+
+    // Calculate the offset between the centers of the boxes in the space of the first box.
+    const auto worldOffset = orientedBox2.center - orientedBox1.center;
+    const glm::vec3 offset(glm::dot(worldOffset, orientedBox1.axes[0]), glm::dot(worldOffset, orientedBox1.axes[1]), glm::dot(worldOffset, orientedBox1.axes[2]));
+
+    // Check the local axes of the first box.
+    for (auto i = 0; i < 3; i++)
+    {
+      const auto radius2 = (extents2[0] * absoluteRotation[i][0]) + (extents2[1] * absoluteRotation[i][1]) + (extents2[2] * absoluteRotation[i][2]);
+      if (glm::abs(offset[i]) > extents1[i] + radius2)
+      {
+        return false;
+      }
+    }
+
+    // Check the local axes of the second box.
+    for (auto j = 0; j < 3; j++)
+    {
+      const auto radius1 = (extents1[0] * absoluteRotation[0][j]) + (extents1[1] * absoluteRotation[1][j]) + (extents1[2] * absoluteRotation[2][j]);
+      const auto distance = (offset[0] * rotation[0][j]) + (offset[1] * rotation[1][j]) + (offset[2] * rotation[2][j]);
+      if (glm::abs(distance) > radius1 + extents2[j])
+      {
+        return false;
+      }
+    }
+
+    // Check the cross products of the local axes of the first box with the local axes of the second box.
+    for (auto i = 0; i < 3; i++)
+    {
+      // The other two local axes of the first box.
+      const auto i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+      for (auto j = 0; j < 3; j++)
+      {
+        // The other two local axes of the second box.
+        const auto j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+        const auto radius1 = (extents1[i1] * absoluteRotation[i2][j]) + (extents1[i2] * absoluteRotation[i1][j]);
+        const auto radius2 = (extents2[j1] * absoluteRotation[i][j2]) + (extents2[j2] * absoluteRotation[i][j1]);
+        const auto distance = (offset[i2] * rotation[i1][j]) - (offset[i1] * rotation[i2][j]);
+        if (glm::abs(distance) > radius1 + radius2)
+        {
+          return false;
+        }
+      }
+    }
+
+    // No separating axis has been found, so the two boxes have collided.
+    return true;
+  }
+
+  /**
+   * Get the oriented box enclosing everything an oriented box passes through while moving in a straight line, by stretching the box
+   *   along its own axes over the movement. Useful for finding what a fast moving box can hit in a single broad check.
+   * 
+   * @param box           The oriented box at the start of the movement.
+   * @param displacement  The movement of the box.
+   * 
+   * @return The enclosing oriented box.
+   */
+  static OrientedBoundingBox getSweptBox(const OrientedBoundingBox &box, const glm::vec3 &displacement)
+  {
+    auto sweptBox = box;
+    sweptBox.center += displacement * 0.5f;
+    for (auto i = 0; i < 3; i++)
+    {
+      sweptBox.extents[i] += glm::abs(glm::dot(displacement, box.axes[i])) * 0.5f;
+    }
+    return sweptBox;
+  }
+
+  /**
+   * Get the time at which a collider that moved in a straight line first touched another collider along the way (continuous
+   *   collision detection), so that fast moving colliders cannot pass through others between two updates.
+   * 
+   * @param shape1        The moving collider shape, at the end of the movement.
+   * @param displacement  The movement of the moving collider, relative to the other one.
+   * @param shape2        The other collider shape.
+   * 
+   * @return The time of impact as a fraction of the movement (negative if the colliders do not touch, or the shapes are not supported).
+   */
+  static float_t getTimeOfImpact(const ColliderShape &shape1, const glm::vec3 &displacement, const ColliderShape &shape2)
+  {
+    // Sweep the other shapes with the generic convex check, since only spheres and boxes have their own sweeps.
+    const auto type1 = shape1.getType(), type2 = shape2.getType();
+    if ((type1 != ColliderShapeType::SPHERE && type1 != ColliderShapeType::BOX) || (type2 != ColliderShapeType::SPHERE && type2 != ColliderShapeType::BOX))
+    {
+      return getConvexTimeOfImpact(shape1, displacement, shape2);
+    }
+
+    if (type1 == ColliderShapeType::SPHERE && type2 == ColliderShapeType::SPHERE)
+    {
+      // Both colliders are a sphere.
+      const auto &sphere1 = static_cast<const SphereColliderShape &>(shape1), &sphere2 = static_cast<const SphereColliderShape &>(shape2);
+      return getSphereSphereTimeOfImpact(sphere1.getPosition() - displacement, sphere1.getRadius() * sphere1.getScale().x, displacement, sphere2.getPosition(), sphere2.getRadius() * sphere2.getScale().x);
+    }
+    if (type1 == ColliderShapeType::BOX && type2 == ColliderShapeType::SPHERE)
+    {
+      // The moving collider is a box, the other is a sphere.
+      const auto &sphere = static_cast<const SphereColliderShape &>(shape2);
+      auto box = static_cast<const BoxColliderShape &>(shape1).getOrientedBox();
+      box.center -= displacement;
+      return getBoxSphereTimeOfImpact(box, displacement, sphere.getPosition(), sphere.getRadius() * sphere.getScale().x);
+    }
+    if (type1 == ColliderShapeType::SPHERE)
+    {
+      // The moving collider is a sphere, the other is a box, which is the same as the box moving the other way.
+      const auto &sphere = static_cast<const SphereColliderShape &>(shape1);
+      auto box = static_cast<const BoxColliderShape &>(shape2).getOrientedBox();
+      box.center += displacement;
+      return getBoxSphereTimeOfImpact(box, -displacement, sphere.getPosition(), sphere.getRadius() * sphere.getScale().x);
+    }
+
+    // Both colliders are a box.
+    auto box = static_cast<const BoxColliderShape &>(shape1).getOrientedBox();
+    box.center -= displacement;
+    return getBoxBoxTimeOfImpact(box, displacement, static_cast<const BoxColliderShape &>(shape2).getOrientedBox());
+  }
+
+  /**
+   * Get the distance along the given ray at which it hits the given collider: exactly for spheres and boxes, and against the
+   *   transformed AABB for the other shapes.
+   * 
+   * @param shape        The collider shape.
+   * @param origin       The origin of the ray.
+   * @param direction    The normalized direction of the ray.
+   * @param maxDistance  The length of the ray.
+   * 
+   * @return The distance to the collider (0 if the origin is inside it, and negative if the ray misses it).
+   */
+  static float_t getRayShapeDistance(const ColliderShape &shape, const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance)
+  {
+    switch (shape.getType())
+    {
+    case ColliderShapeType::SPHERE:
+    {
+      // Solve |offset + (direction * distance)| = radius for the smallest distance.
+      const auto &sphere = static_cast<const SphereColliderShape &>(shape);
+      const auto radius = sphere.getRadius() * sphere.getScale().x;
+      const auto offset = origin - sphere.getPosition();
+      const auto c = glm::dot(offset, offset) - (radius * radius);
+      if (c <= 0.0f)
+      {
+        return 0.0f;
+      }
+      const auto b = glm::dot(offset, direction);
+      const auto discriminant = (b * b) - c;
+      if (b >= 0.0f || discriminant < 0.0f)
+      {
+        return -1.0f;
+      }
+      const auto distance = -b - glm::sqrt(discriminant);
+      return distance <= maxDistance ? distance : -1.0f;
+    }
+    case ColliderShapeType::BOX:
+    {
+      // Move the ray into the space of the box, where the box is axis-aligned around the origin.
+      const auto box = static_cast<const BoxColliderShape &>(shape).getOrientedBox();
+      const auto offset = origin - box.center;
+      const auto boxOrigin = glm::vec3(glm::dot(offset, box.axes[0]), glm::dot(offset, box.axes[1]), glm::dot(offset, box.axes[2]));
+      const auto boxDirection = glm::vec3(glm::dot(direction, box.axes[0]), glm::dot(direction, box.axes[1]), glm::dot(direction, box.axes[2]));
+      return CollisionBroadphase::getRayBoxDistance(-box.extents, box.extents, boxOrigin, boxDirection, maxDistance);
+    }
+    default:
+    {
+      const auto &transformedBox = shape.getTransformedBox();
+      return CollisionBroadphase::getRayBoxDistance(transformedBox.getMinCorner(), transformedBox.getMaxCorner(), origin, direction, maxDistance);
+    }
+    }
+  }
+
+private:
+  /**
+   * Check if a box collider and a spehere collider have interesected/collided with each other.
+   * 
+   * @param box     The box collider.
+   * @param sphere  The sphere collider.
+   * 
+   * @return Whether the box and sphere colliders have collided or not.
+   */
+  static bool haveBoxSphereCollided(const BoxColliderShape &box, const SphereColliderShape &sphere)
+  {
+    // Get the transformation matrix of the collider box.
+    const auto boxTransformationMatrix = TransformBatchComposer::composeWorldMatrix(box.getPosition(), box.getRotation(), box.getScale());
+    // Calculate the inverse of the boxes' transformation matrix.
+    const auto boxInverseTransformationMatrix = glm::inverse(boxTransformationMatrix);
+    // Create an AABB using the corners of the box (doing this just as a way to get the min/max-corners).
+    const AxisAlignedBoundingBox boxAABB(box.getCorners());
+    // Get the min-corner of the box.
+    const auto boxAABBMinCorners = boxAABB.getMinCorner();
+    // Get the max-corner of the box.
+    const auto boxAABBMaxCorners = boxAABB.getMaxCorner();
+
+    // Calculate the scaled radius of the collider sphere based on the scale of the collider.
+    const auto sphereScaledRadius = glm::length(glm::inverse(glm::scale(box.getScale())) * glm::scale(sphere.getScale()) * glm::vec4(glm::vec3(sphere.getRadius()), 1.0f));
+    // Calculate the position of the wphere w.r.t the box using the boxes' inverse transformation matrix.
+    const auto spherePositionInBoxSpace = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere.getPosition(), 1.0f));
+    // Calculate the point on the box that is closest to the sphere.
+    const auto boxPointClosesToSphere = glm::vec3(
+        glm::max(boxAABBMinCorners.x, glm::min(spherePositionInBoxSpace.x, boxAABBMaxCorners.x)),
+        glm::max(boxAABBMinCorners.y, glm::min(spherePositionInBoxSpace.y, boxAABBMaxCorners.y)),
+        glm::max(boxAABBMinCorners.z, glm::min(spherePositionInBoxSpace.z, boxAABBMaxCorners.z)));
+    // Calculate the distance between the boxes' closest point and the center of the sphere.
+    const auto distanceBetweenClosestBoxPointAndSphereCenter = glm::distance(boxPointClosesToSphere, spherePositionInBoxSpace);
+
+    // If the distance between the closest point on the box and the center of the sphere is greater than the radius of the sphere,
+    //   then the two have not collided.
+    return distanceBetweenClosestBoxPointAndSphereCenter <= sphereScaledRadius;
+  }
+
+  // The collider shape classes, at the indices of their collider shape types. New shapes only need to be added here (and to the
+  //   collider shape types) for the narrowphase functions table to cover them.
+  using ColliderShapeClasses = std::tuple<SphereColliderShape, BoxColliderShape, CylinderColliderShape, PillColliderShape>;
+  // The number of collider shape types.
+  static constexpr size_t COLLIDER_SHAPE_TYPES_COUNT = std::tuple_size<ColliderShapeClasses>::value;
+
+  // The function checking a pair of collider shapes of known types past their AABBs.
+  using NarrowphaseFunction = bool (*)(const ColliderShape &shape1, const ColliderShape &shape2);
+  // The narrowphase functions, by the type of the first shape times the number of types plus the type of the second one.
+  static const std::array<NarrowphaseFunction, COLLIDER_SHAPE_TYPES_COUNT * COLLIDER_SHAPE_TYPES_COUNT> narrowphaseFunctions;
+
+  // Check the pairs of shapes without a specialized check through their support points.
+  template <typename Shape1, typename Shape2>
+  static bool haveShapePairCollided(const Shape1 &shape1, const Shape2 &shape2)
+  {
+    return ConvexCollisionValidator::haveShapesCollided(shape1, shape2);
+  }
+
+  // Use the specialized checks for the pairs of spheres and boxes, which are the most common ones.
+  static bool haveShapePairCollided(const SphereColliderShape &sphere1, const SphereColliderShape &sphere2)
+  {
+    return haveSphereSphereCollided(sphere1, sphere2);
+  }
+
+  static bool haveShapePairCollided(const BoxColliderShape &box, const SphereColliderShape &sphere)
+  {
+    return haveBoxSphereCollided(box, sphere);
+  }
+
+  static bool haveShapePairCollided(const SphereColliderShape &sphere, const BoxColliderShape &box)
+  {
+    return haveBoxSphereCollided(box, sphere);
+  }
+
+  static bool haveShapePairCollided(const BoxColliderShape &box1, const BoxColliderShape &box2)
+  {
+    return haveBoxBoxCollided(box1, box2);
+  }
+
+  /**
+   * Check a pair of collider shapes whose types are known from their indices in the narrowphase functions table.
+   * 
+   * @param shape1  The first collider shape.
+   * @param shape2  The second collider shape.
+   * 
+   * @return Whether the two collider shapes have collided or not.
+   */
+  template <size_t index>
+  static bool haveIndexedShapesCollided(const ColliderShape &shape1, const ColliderShape &shape2)
+  {
+    using Shape1 = std::tuple_element_t<index / COLLIDER_SHAPE_TYPES_COUNT, ColliderShapeClasses>;
+    using Shape2 = std::tuple_element_t<index % COLLIDER_SHAPE_TYPES_COUNT, ColliderShapeClasses>;
+    return haveShapePairCollided(static_cast<const Shape1 &>(shape1), static_cast<const Shape2 &>(shape2));
+  }
+
+  /**
+   * Create the narrowphase functions table, with a function for every pair of collider shape types.
+   * 
+   * @return The narrowphase functions.
+   */
+  template <size_t... indices>
+  static constexpr std::array<NarrowphaseFunction, sizeof...(indices)> createNarrowphaseFunctions(std::index_sequence<indices...>)
+  {
+    return {{&haveIndexedShapesCollided<indices>...}};
+  }
+
+public:
+  /**
+   * Checks if the two given collider shapes have intersected/collided with each other.
+   * 
+   * @param shape1              The first collider shape.
+   * @param shape2              The second collider shape.
+   * @param deepCollisionCheck  Whether to perform a deep collision check or not. If not, we just check if the
+   *                              AABBs of the two colliders have collided or not.
+   * 
+   * @return Whether the two colldier shapes have collided or not.
+   */
+  static bool haveShapesCollided(const ColliderShape &shape1, const ColliderShape &shape2, const bool &deepCollisionCheck)
+  {
+    // Check if the AABBs of the two shapes have collided or not.
+    if (!shape1.getTransformedBox().hasCollided(shape2.getTransformedBox()))
+    {
+      // If not, no need to do a deeper check, so just return false.
+      return false;
+    }
+    // If a deep collision check wasn't request, then just return true since the shallow check has passed.
+    if (!deepCollisionCheck)
+    {
+      return true;
+    }
+
+    // Run the check of the pair of shape types from the table.
+    return narrowphaseFunctions[shape1.getType() * COLLIDER_SHAPE_TYPES_COUNT + shape2.getType()](shape1, shape2);
+  }
+
+  /**
+   * Checks if the two given collider shapes have intersected/collided with each other.
+   * 
+   * @param shape1              The first collider shape.
+   * @param shape2              The second collider shape.
+   * @param deepCollisionCheck  Whether to perform a deep collision check or not. If not, we just check if the
+   *                              AABBs of the two colliders have collided or not.
+   * 
+   * @return Whether the two colldier shapes have collided or not.
+   */
+  static bool haveShapesCollided(const std::shared_ptr<const ColliderShape> &shape1, const std::shared_ptr<const ColliderShape> &shape2, const bool &deepCollisionCheck)
+  {
+    return haveShapesCollided(*shape1, *shape2, deepCollisionCheck);
+  }
+};
+
+// Initialize the narrowphase functions table static variable, with the functions of all the pairs of collider shape types.
+const std::array<DeepCollisionValidator::NarrowphaseFunction, DeepCollisionValidator::COLLIDER_SHAPE_TYPES_COUNT * DeepCollisionValidator::COLLIDER_SHAPE_TYPES_COUNT> DeepCollisionValidator::narrowphaseFunctions =
+    DeepCollisionValidator::createNarrowphaseFunctions(std::make_index_sequence<DeepCollisionValidator::COLLIDER_SHAPE_TYPES_COUNT * DeepCollisionValidator::COLLIDER_SHAPE_TYPES_COUNT>());
 
 /**
  * Class for containing the details of the collider.
@@ -0,0 +1,787 @@
+#ifndef INCLUDE_COLLISION_CPP
+#define INCLUDE_COLLISION_CPP
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "collider.cpp"
+#include "collision_broadphase.cpp"
+#include "collision_grid.cpp"
+#include "collision_tree.cpp"
+
+class ModelBaseIntf;
+
+/**
+ * Enum for defining the spatial structures the collision manager can use.
+ */
+enum CollisionBroadphaseType
+{
+  // A uniform grid of cells.
+  GRID,
+  // A dynamic AABB tree.
+  TREE,
+};
+
+/**
+ * Enum for defining the collision layers of the models, combined into masks to choose which layers a model wants collision
+ *   events for.
+ */
+enum CollisionLayer
+{
+  // The model is in no layer, so no model gets collision events for it.
+  NO_COLLISION_LAYER = 0,
+  // The shots fired by the player.
+  SHOT_COLLISION_LAYER = 1 << 0,
+  // The enemies the shots can hit.
+  ENEMY_COLLISION_LAYER = 1 << 1,
+  // The menu cursor.
+  CURSOR_COLLISION_LAYER = 1 << 2,
+  // The menu buttons the cursor can hover.
+  BUTTON_COLLISION_LAYER = 1 << 3,
+};
+
+/**
+ * Enum for defining how the colliders of the models move, so that the collision pass only tests the pairs that can have changed.
+ */
+enum ColliderMotionType
+{
+  // The collider is moved by the game now and then, and falls asleep once it stops moving, so that its pairs with the other
+  //   colliders not moving either keep their last results instead of being tested again.
+  DYNAMIC_COLLIDER,
+  // The collider is moved by the game all the time (like the shots), so it is never put to sleep.
+  KINEMATIC_COLLIDER,
+  // The collider is placed once and meant to stay (like the menu buttons). It is kept in a spatial structure of its own, built
+  //   as the colliders are registered, and never tested against the other static colliders.
+  STATIC_COLLIDER,
+};
+
+/**
+ * Enum for defining the kinds of collision events sent to the models.
+ */
+enum CollisionEventType
+{
+  // The models started touching during the last update.
+  COLLISION_ENTER,
+  // The models were already touching, and still are.
+  COLLISION_STAY,
+  // The models stopped touching during the last update.
+  COLLISION_EXIT,
+};
+
+/**
+ * Structure for defining a collision event to be sent to a model.
+ */
+struct CollisionEvent
+{
+  // The kind of the event.
+  CollisionEventType type;
+  // The model the event is sent to.
+  std::shared_ptr<ModelBaseIntf> model;
+  // The model it collided with.
+  std::shared_ptr<ModelBaseIntf> otherModel;
+  // The fraction of the sweeps at which the models touched, so that the earliest contacts can be sent first.
+  float_t time;
+};
+
+/**
+ * Structure for defining the closest model hit by a ray.
+ */
+struct CollisionRayHit
+{
+  // The model hit by the ray.
+  std::shared_ptr<ModelBaseIntf> model;
+  // The collider shape of the model.
+  std::shared_ptr<const ColliderShape> colliderShape;
+  // The distance along the ray at which it hits the collider.
+  float_t distance;
+};
+
+/**
+ * A manager class for finding the models that can collide with each other without checking every pair of models.
+ * The transformed AABBs of the colliders of the registered models are kept in a spatial structure (a uniform grid or a dynamic
+ *   AABB tree), updated whenever a model is transformed, so that only the models close to a query need deeper checks.
+ * Once per frame, the collision pass finds all the touching pairs of models whose layers and masks match, testing each pair once,
+ *   and turns them into enter, stay and exit events for the models. Only the pairs with an awake collider are found and tested
+ *   again, through the spatial structures, the contacts between the colliders asleep or static being kept from the last pass.
+ */
+class CollisionManager
+{
+private:
+  // Singleton instance of the collision manager.
+  static CollisionManager instance;
+
+  /**
+   * Structure for defining a model registered with the collision manager.
+   */
+  struct CollisionEntry
+  {
+    // The registered model, kept weak so that the collision manager does not keep models alive.
+    std::weak_ptr<ModelBaseIntf> model;
+    // The collider shape of the model, whose transformed AABB is added to the spatial structure.
+    std::shared_ptr<const ColliderShape> colliderShape;
+    // Whether the model was transformed since its AABB was last updated in the spatial structure.
+    bool isMoved;
+    // How the collider of the model moves.
+    ColliderMotionType motionType;
+    // Whether the collider is awake, meaning its pairs are found and tested by the collision pass.
+    bool isAwake;
+    // Whether the model was transformed since the last collision pass, and the number of passes since it last was.
+    bool isMovedSincePass;
+    uint32_t idlePassesCount;
+    // The collision layers the model is in.
+    uint32_t collisionLayer;
+    // The collision layers the model wants collision events for.
+    uint32_t collisionMask;
+    // How far the model moved since the last collision pass, when it moves fast enough to need a swept check.
+    glm::vec3 sweep;
+  };
+
+
+  // The registered models, by the model they belong to.
+  std::map<const ModelBaseIntf *, CollisionEntry> entries;
+
+  // The spatial structures the models can be added to.
+  CollisionGrid grid;
+  CollisionTree tree;
+  // The type of the spatial structure the models are added to.
+  CollisionBroadphaseType broadphaseType;
+  // The spatial structure the models are added to, except the static ones.
+  CollisionBroadphase *broadphase;
+  // The spatial structure the static models are added to.
+  CollisionTree staticTree;
+
+  // The awake models, whose pairs are found and tested by the collision pass.
+  std::vector<const ModelBaseIntf *> awakeModels;
+
+  // The models transformed since their AABBs were last updated in the spatial structure.
+  std::vector<const ModelBaseIntf *> movedModels;
+  // The mutex guarding the moved models, since the models updated in parallel mark themselves as moved at the same time.
+  std::mutex movedModelsMutex;
+
+  // The models whose sweep was set since the last collision pass.
+  std::vector<const ModelBaseIntf *> sweptModels;
+
+  // The candidates found by the spatial structure for the last query (kept around to avoid reallocating every query).
+  std::vector<const ModelBaseIntf *> candidateModels;
+  std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> candidatePairs;
+
+  // The pairs of models touching at the last and the current collision pass, ordered and sorted for searching.
+  std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> lastContacts;
+  std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> currentContacts;
+
+  /**
+   * Get the AABB a model is added to the spatial structure with, which also covers where it moved from if it has a sweep.
+   * 
+   * @param entry      The registration of the model.
+   * @param minCorner  Set to the corner of the AABB with the smallest coordinates.
+   * @param maxCorner  Set to the corner of the AABB with the largest coordinates.
+   */
+  static void getBroadphaseBox(const CollisionEntry &entry, glm::vec3 &minCorner, glm::vec3 &maxCorner)
+  {
+    const auto &transformedBox = entry.colliderShape->getTransformedBox();
+    minCorner = transformedBox.getMinCorner() + glm::min(-entry.sweep, glm::vec3(0.0f));
+    maxCorner = transformedBox.getMaxCorner() + glm::max(-entry.sweep, glm::vec3(0.0f));
+  }
+
+  /**
+   * Check if two registered models are touching, or touched at any point of their sweeps.
+   * 
+   * @param entry1  The registration of the first model.
+   * @param entry2  The registration of the second model.
+   * @param time    Set to the fraction of the sweeps at which the models touched (0 if neither has a sweep).
+   * 
+   * @return Whether the models are touching or not.
+   */
+  static bool haveEntriesCollided(const CollisionEntry &entry1, const CollisionEntry &entry2, float_t &time)
+  {
+    glm::vec3 minCorner1, maxCorner1, minCorner2, maxCorner2;
+    getBroadphaseBox(entry1, minCorner1, maxCorner1);
+    getBroadphaseBox(entry2, minCorner2, maxCorner2);
+    if (!CollisionBroadphase::haveBoxesOverlapped(minCorner1, maxCorner1, minCorner2, maxCorner2))
+    {
+      return false;
+    }
+
+    // Check the models where they are, unless one of them moved too fast for that to be enough.
+    const auto relativeSweep = entry1.sweep - entry2.sweep;
+    if (relativeSweep == glm::vec3(0.0f))
+    {
+      time = 0.0f;
+      return DeepCollisionValidator::haveShapesCollided(*entry1.colliderShape, *entry2.colliderShape, true);
+    }
+
+    time = DeepCollisionValidator::getTimeOfImpact(*entry1.colliderShape, relativeSweep, *entry2.colliderShape);
+    return time >= 0.0f;
+  }
+
+  /**
+   * Queue the events of a pair of touching or separated models, for each model of the pair whose mask has the layer of the other.
+   * 
+   * @param type             The kind of the events.
+   * @param entry1           The registration of the first model.
+   * @param entry2           The registration of the second model.
+   * @param time             The fraction of the sweeps at which the models touched.
+   * @param collisionEvents  Appended with the events.
+   */
+  static void queueCollisionEvents(const CollisionEventType &type, const CollisionEntry &entry1, const CollisionEntry &entry2, const float_t &time, std::vector<CollisionEvent> &collisionEvents)
+  {
+    const auto model1 = entry1.model.lock(), model2 = entry2.model.lock();
+    if (model1 == nullptr || model2 == nullptr)
+    {
+      return;
+    }
+
+    if ((entry1.collisionMask & entry2.collisionLayer) != 0)
+    {
+      collisionEvents.push_back({type, model1, model2, time});
+    }
+    if ((entry2.collisionMask & entry1.collisionLayer) != 0)
+    {
+      collisionEvents.push_back({type, model2, model1, time});
+    }
+  }
+
+  /**
+   * Get the spatial structure a registered model is added to.
+   * 
+   * @param entry  The registration of the model.
+   * 
+   * @return The spatial structure of the model.
+   */
+  CollisionBroadphase &getEntryBroadphase(const CollisionEntry &entry)
+  {
+    return entry.motionType == ColliderMotionType::STATIC_COLLIDER ? staticTree : *broadphase;
+  }
+
+  /**
+   * Update the AABBs of the transformed models in the spatial structure, so that they are only read once per query no matter
+   *   how many times the models were transformed since the last one.
+   */
+  void updateMovedModels()
+  {
+    for (const auto &movedModel : movedModels)
+    {
+      // Skip the models de-registered since they were transformed.
+      const auto entry = entries.find(movedModel);
+      if (entry == entries.end() || !entry->second.isMoved)
+      {
+        continue;
+      }
+
+      glm::vec3 minCorner, maxCorner;
+      getBroadphaseBox(entry->second, minCorner, maxCorner);
+      getEntryBroadphase(entry->second).updateCollider(movedModel, minCorner, maxCorner);
+      entry->second.isMoved = false;
+    }
+    movedModels.clear();
+  }
+
+  /**
+   * Find the pairs of models with an awake model that can overlap each other, each returned once. The awake models are looked
+   *   for in both spatial structures, except the static ones, which are only looked for in the structure of the other models.
+   * 
+   * @param pairs  Appended with the candidate pairs.
+   */
+  void queryAwakePairs(std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> &pairs)
+  {
+    const std::less<const ModelBaseIntf *> isLess;
+    for (const auto &awakeModel : awakeModels)
+    {
+      const auto &entry = entries.at(awakeModel);
+      glm::vec3 minCorner, maxCorner;
+      getBroadphaseBox(entry, minCorner, maxCorner);
+      candidateModels.clear();
+      broadphase->queryBox(minCorner, maxCorner, candidateModels);
+      if (entry.motionType != ColliderMotionType::STATIC_COLLIDER)
+      {
+        staticTree.queryBox(minCorner, maxCorner, candidateModels);
+      }
+
+      for (const auto &candidateModel : candidateModels)
+      {
+        // Skip the model itself, and take the pairs of two awake models only from the first of them, so that they are found once.
+        if (candidateModel == awakeModel || (entries.at(candidateModel).isAwake && isLess(candidateModel, awakeModel)))
+        {
+          continue;
+        }
+        pairs.push_back({awakeModel, candidateModel});
+      }
+    }
+  }
+
+  /**
+   * Put the awake models that did not move since the last collision pass for long enough to sleep, except the kinematic ones.
+   */
+  void updateSleepingModels()
+  {
+    awakeModels.erase(std::remove_if(awakeModels.begin(), awakeModels.end(), [this](const ModelBaseIntf *awakeModel) {
+                        auto &entry = entries.at(awakeModel);
+                        if (entry.isMovedSincePass)
+                        {
+                          entry.isMovedSincePass = false;
+                          entry.idlePassesCount = 0;
+                          return false;
+                        }
+                        if (entry.motionType == ColliderMotionType::KINEMATIC_COLLIDER || ++entry.idlePassesCount < COLLISION_SLEEP_PASSES)
+                        {
+                          return false;
+                        }
+                        entry.isAwake = false;
+                        return true;
+                      }),
+                      awakeModels.end());
+  }
+
+  CollisionManager()
+      : entries({}),
+        grid(),
+        tree(),
+        broadphaseType(CollisionBroadphaseType::GRID),
+        broadphase(&grid),
+        staticTree(),
+        awakeModels({}),
+        movedModels({}),
+        sweptModels({}),
+        candidateModels({}),
+        candidatePairs({}),
+        lastContacts({}),
+        currentContacts({}) {}
+
+public:
+  // Preventing copying the collision manager, making sure only one instance can exist.
+  CollisionManager(const CollisionManager &) = delete;
+
+  /**
+   * Register a model with the collision manager, adding the transformed AABB of its collider to the spatial structure.
+   * 
+   * @param model           The model to register.
+   * @param colliderShape   The collider shape of the model.
+   * @param collisionLayer  The collision layers the model is in.
+   * @param collisionMask   The collision layers the model wants collision events for.
+   * @param motionType      How the collider of the model moves.
+   */
+  void registerModel(const std::shared_ptr<ModelBaseIntf> &model, const std::shared_ptr<const ColliderShape> &colliderShape, const uint32_t &collisionLayer, const uint32_t &collisionMask,
+                     const ColliderMotionType &motionType)
+  {
+    // Remove any earlier registration of the model.
+    deregisterModel(model.get());
+
+    // The model starts awake, so that its pairs are found by the next collision pass.
+    const auto entry = entries.emplace(model.get(), CollisionEntry{model, colliderShape, false, motionType, true, false, 0, collisionLayer, collisionMask, glm::vec3(0.0f)}).first;
+    glm::vec3 minCorner, maxCorner;
+    getBroadphaseBox(entry->second, minCorner, maxCorner);
+    getEntryBroadphase(entry->second).insertCollider(model.get(), minCorner, maxCorner);
+    awakeModels.push_back(model.get());
+  }
+
+  /**
+   * De-register a model from the collision manager.
+   * 
+   * @param model  The model to de-register (ignored if it is not registered).
+   */
+  void deregisterModel(const ModelBaseIntf *model)
+  {
+    const auto entry = entries.find(model);
+    if (entry == entries.end())
+    {
+      return;
+    }
+
+    getEntryBroadphase(entry->second).removeCollider(model);
+    if (entry->second.isAwake)
+    {
+      awakeModels.erase(std::find(awakeModels.begin(), awakeModels.end(), model));
+    }
+    entries.erase(entry);
+
+    // Forget the contacts of the model, without sending exit events for them since the model is gone.
+    lastContacts.erase(std::remove_if(lastContacts.begin(), lastContacts.end(), [model](const auto &contact) { return contact.first == model || contact.second == model; }), lastContacts.end());
+  }
+
+  /**
+   * Mark a model as transformed, so that its AABB is updated in the spatial structure before the next query, waking it up if it
+   *   was asleep. Can be called for different models from multiple threads at once, but not while models are registered or
+   *   de-registered.
+   * 
+   * @param model  The model that was transformed (ignored if it is not registered).
+   */
+  void markModelMoved(const ModelBaseIntf *model)
+  {
+    const auto entry = entries.find(model);
+    if (entry == entries.end() || entry->second.isMoved)
+    {
+      return;
+    }
+
+    entry->second.isMoved = true;
+    entry->second.isMovedSincePass = true;
+    const std::lock_guard<std::mutex> lock(movedModelsMutex);
+    movedModels.push_back(model);
+    if (!entry->second.isAwake)
+    {
+      entry->second.isAwake = true;
+      awakeModels.push_back(model);
+    }
+  }
+
+  /**
+   * Set how far a model moved since the last collision pass, so that the pass checks everything it passed through on the way
+   *   instead of only where it ended up. Meant for the models moving further than their size in a single update.
+   * 
+   * @param model         The model that moved, and is now at the end of the movement (ignored if it is not registered).
+   * @param displacement  The movement of the model.
+   */
+  void setModelSweep(const ModelBaseIntf *model, const glm::vec3 &displacement)
+  {
+    const auto entry = entries.find(model);
+    if (entry == entries.end())
+    {
+      return;
+    }
+
+    if (entry->second.sweep == glm::vec3(0.0f))
+    {
+      sweptModels.push_back(model);
+    }
+    entry->second.sweep = displacement;
+    markModelMoved(model);
+  }
+
+  /**
+   * Run the collision pass, finding all the touching pairs of registered models through the spatial structures and turning them
+   *   into collision events. Each pair with an awake model is tested once, and only if the mask of one of the models has the
+   *   layer of the other. The contacts between the models neither awake stay as they were in the last pass.
+   * 
+   * @param collisionEvents  Set to the events of the pass, the earliest contacts first.
+   */
+  void updateCollisions(std::vector<CollisionEvent> &collisionEvents)
+  {
+    updateMovedModels();
+    collisionEvents.clear();
+    candidatePairs.clear();
+    queryAwakePairs(candidatePairs);
+
+    // Keep the contacts of the last pass between the models neither awake, since neither of them moved since they were tested.
+    currentContacts.clear();
+    for (const auto &contact : lastContacts)
+    {
+      const auto &entry1 = entries.at(contact.first), &entry2 = entries.at(contact.second);
+      if (!entry1.isAwake && !entry2.isAwake)
+      {
+        currentContacts.push_back(contact);
+        queueCollisionEvents(CollisionEventType::COLLISION_STAY, entry1, entry2, 0.0f, collisionEvents);
+      }
+    }
+    const std::less<const ModelBaseIntf *> isLess;
+    for (const auto &candidatePair : candidatePairs)
+    {
+      // Skip the pairs neither model wants events for.
+      const auto &entry1 = entries.at(candidatePair.first), &entry2 = entries.at(candidatePair.second);
+      if ((entry1.collisionMask & entry2.collisionLayer) == 0 && (entry2.collisionMask & entry1.collisionLayer) == 0)
+      {
+        continue;
+      }
+
+      auto time = 0.0f;
+      if (!haveEntriesCollided(entry1, entry2, time))
+      {
+        continue;
+      }
+
+      // Order the pair, so that it can be found again by the next pass whichever way the spatial structure returns it.
+      const auto contact = isLess(candidatePair.first, candidatePair.second) ? candidatePair : std::make_pair(candidatePair.second, candidatePair.first);
+      currentContacts.push_back(contact);
+      queueCollisionEvents(std::binary_search(lastContacts.begin(), lastContacts.end(), contact) ? CollisionEventType::COLLISION_STAY : CollisionEventType::COLLISION_ENTER, entry1, entry2, time, collisionEvents);
+    }
+    std::sort(currentContacts.begin(), currentContacts.end());
+
+    // Add exit events for the contacts of the last pass that are gone.
+    for (const auto &contact : lastContacts)
+    {
+      if (!std::binary_search(currentContacts.begin(), currentContacts.end(), contact))
+      {
+        queueCollisionEvents(CollisionEventType::COLLISION_EXIT, entries.at(contact.first), entries.at(contact.second), 1.0f, collisionEvents);
+      }
+    }
+    std::swap(lastContacts, currentContacts);
+
+    // Put the models that stopped moving to sleep, before the sweeps are cleared (which moves the swept models once more).
+    updateSleepingModels();
+
+    // Clear the sweeps, so that the swept models are only checked along their next movement from now on.
+    for (const auto &sweptModel : sweptModels)
+    {
+      const auto entry = entries.find(sweptModel);
+      if (entry != entries.end())
+      {
+        entry->second.sweep = glm::vec3(0.0f);
+        markModelMoved(sweptModel);
+      }
+    }
+    sweptModels.clear();
+
+    std::stable_sort(collisionEvents.begin(), collisionEvents.end(), [](const auto &event1, const auto &event2) { return event1.time < event2.time; });
+  }
+
+  /**
+   * Update the AABBs of the transformed models in the spatial structures ahead of a collision pass run on another thread, so
+   *   that the colliders (whose transformed AABBs are generated on their first access) are only read from then on.
+   */
+  void prepareCollisions()
+  {
+    updateMovedModels();
+  }
+
+  /**
+   * Check if a model is registered with the collision manager.
+   * 
+   * @param model  The model to check.
+   * 
+   * @return Whether the model is registered or not.
+   */
+  bool isModelRegistered(const ModelBaseIntf *model) const
+  {
+    return entries.find(model) != entries.end();
+  }
+
+  /**
+   * Find the registered models whose transformed AABBs overlap the given AABB.
+   * 
+   * @param minCorner  The corner of the AABB with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB with the largest coordinates.
+   * @param models     Set to the overlapping models (cleared first, so that the same vector can be reused across queries).
+   */
+  void queryModels(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, std::vector<std::shared_ptr<ModelBaseIntf>> &models)
+  {
+    updateMovedModels();
+    models.clear();
+    candidateModels.clear();
+    broadphase->queryBox(minCorner, maxCorner, candidateModels);
+    staticTree.queryBox(minCorner, maxCorner, candidateModels);
+
+    for (const auto &candidateModel : candidateModels)
+    {
+      // Keep the model only if its AABB overlaps the queried one, and it is still alive.
+      const auto &entry = entries.at(candidateModel);
+      const auto &transformedBox = entry.colliderShape->getTransformedBox();
+      const auto model = entry.model.lock();
+      if (model != nullptr && CollisionBroadphase::haveBoxesOverlapped(transformedBox.getMinCorner(), transformedBox.getMaxCorner(), minCorner, maxCorner))
+      {
+        models.push_back(model);
+      }
+    }
+  }
+
+  /**
+   * Find the registered models whose transformed AABBs are hit by the given ray.
+   * 
+   * @param origin       The origin of the ray.
+   * @param direction    The normalized direction of the ray.
+   * @param maxDistance  The length of the ray.
+   * @param models       Set to the hit models and the distances at which the ray hits them, from the closest to the farthest.
+   */
+  void castRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, std::vector<std::pair<float_t, std::shared_ptr<ModelBaseIntf>>> &models)
+  {
+    updateMovedModels();
+    models.clear();
+    candidateModels.clear();
+    broadphase->queryRay(origin, direction, maxDistance, candidateModels);
+    staticTree.queryRay(origin, direction, maxDistance, candidateModels);
+
+    for (const auto &candidateModel : candidateModels)
+    {
+      // Keep the model only if the ray hits its AABB, and it is still alive.
+      const auto &entry = entries.at(candidateModel);
+      const auto &transformedBox = entry.colliderShape->getTransformedBox();
+      const auto distance = CollisionBroadphase::getRayBoxDistance(transformedBox.getMinCorner(), transformedBox.getMaxCorner(), origin, direction, maxDistance);
+      const auto model = entry.model.lock();
+      if (model != nullptr && distance >= 0.0f)
+      {
+        models.push_back({distance, model});
+      }
+    }
+
+    std::sort(models.begin(), models.end(), [](const auto &hit1, const auto &hit2) { return hit1.first < hit2.first; });
+  }
+
+  /**
+   * Find the closest registered model whose collider is hit by the given ray, checking the colliders exactly in the order their
+   *   AABBs are hit, until the next AABB is farther than the closest collider found.
+   * 
+   * @param origin          The origin of the ray.
+   * @param direction       The normalized direction of the ray.
+   * @param maxDistance     The length of the ray.
+   * @param collisionMask   The collision layers of the models the ray can hit.
+   * @param hit             Set to the closest model hit by the ray, if any.
+   * 
+   * @return Whether the ray hit a model or not.
+   */
+  bool castRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, const uint32_t &collisionMask, CollisionRayHit &hit)
+  {
+    updateMovedModels();
+    candidateModels.clear();
+    broadphase->queryRay(origin, direction, maxDistance, candidateModels);
+    staticTree.queryRay(origin, direction, maxDistance, candidateModels);
+
+    // Find the distances to the AABBs of the models in the layers of the mask, closest first.
+    std::vector<std::pair<float_t, const CollisionEntry *>> boxHits({});
+    for (const auto &candidateModel : candidateModels)
+    {
+      const auto &entry = entries.at(candidateModel);
+      if ((entry.collisionLayer & collisionMask) == 0)
+      {
+        continue;
+      }
+      const auto &transformedBox = entry.colliderShape->getTransformedBox();
+      const auto distance = CollisionBroadphase::getRayBoxDistance(transformedBox.getMinCorner(), transformedBox.getMaxCorner(), origin, direction, maxDistance);
+      if (distance >= 0.0f)
+      {
+        boxHits.push_back({distance, &entry});
+      }
+    }
+    std::sort(boxHits.begin(), boxHits.end(), [](const auto &hit1, const auto &hit2) { return hit1.first < hit2.first; });
+
+    hit = {nullptr, nullptr, maxDistance};
+    for (const auto &boxHit : boxHits)
+    {
+      // A collider can't be hit before its AABB, so none of the rest can be closer.
+      if (boxHit.first > hit.distance)
+      {
+        break;
+      }
+
+      const auto distance = DeepCollisionValidator::getRayShapeDistance(*boxHit.second->colliderShape, origin, direction, hit.distance);
+      const auto model = boxHit.second->model.lock();
+      if (model != nullptr && distance >= 0.0f && distance <= hit.distance)
+      {
+        hit = {model, boxHit.second->colliderShape, distance};
+      }
+    }
+
+    return hit.model != nullptr;
+  }
+
+  /**
+   * Find the pairs of registered models whose transformed AABBs overlap each other.
+   * 
+   * @param pairs  Set to the overlapping pairs, each pair returned once.
+   */
+  void queryPairs(std::vector<std::pair<std::shared_ptr<ModelBaseIntf>, std::shared_ptr<ModelBaseIntf>>> &pairs)
+  {
+    updateMovedModels();
+    pairs.clear();
+    candidatePairs.clear();
+    broadphase->queryPairs(candidatePairs);
+    // Add the pairs of the other models with the static ones, the static models never being paired with each other.
+    for (const auto &entry : entries)
+    {
+      if (entry.second.motionType == ColliderMotionType::STATIC_COLLIDER)
+      {
+        continue;
+      }
+      glm::vec3 minCorner, maxCorner;
+      getBroadphaseBox(entry.second, minCorner, maxCorner);
+      candidateModels.clear();
+      staticTree.queryBox(minCorner, maxCorner, candidateModels);
+      for (const auto &candidateModel : candidateModels)
+      {
+        candidatePairs.push_back({entry.first, candidateModel});
+      }
+    }
+
+    for (const auto &candidatePair : candidatePairs)
+    {
+      // Keep the pair only if the AABBs overlap, and both models are still alive.
+      const auto &entry1 = entries.at(candidatePair.first), &entry2 = entries.at(candidatePair.second);
+      const auto &transformedBox1 = entry1.colliderShape->getTransformedBox(), &transformedBox2 = entry2.colliderShape->getTransformedBox();
+      const auto model1 = entry1.model.lock(), model2 = entry2.model.lock();
+      if (model1 != nullptr && model2 != nullptr &&
+          CollisionBroadphase::haveBoxesOverlapped(transformedBox1.getMinCorner(), transformedBox1.getMaxCorner(), transformedBox2.getMinCorner(), transformedBox2.getMaxCorner()))
+      {
+        pairs.push_back({model1, model2});
+      }
+    }
+  }
+
+  /**
+   * Get the type of the spatial structure the models are added to.
+   * 
+   * @return The type of the spatial structure.
+   */
+  const CollisionBroadphaseType &getBroadphaseType() const
+  {
+    return broadphaseType;
+  }
+
+  /**
+   * Set the type of the spatial structure the models are added to, moving the registered models over to it.
+   * 
+   * @param newBroadphaseType  The type of the spatial structure.
+   */
+  void setBroadphaseType(const CollisionBroadphaseType &newBroadphaseType)
+  {
+    if (newBroadphaseType == broadphaseType)
+    {
+      return;
+    }
+
+    // Move the registered models from the current spatial structure to the new one, leaving the static ones in theirs.
+    CollisionBroadphase *newBroadphase = newBroadphaseType == CollisionBroadphaseType::TREE ? static_cast<CollisionBroadphase *>(&tree) : &grid;
+    for (const auto &entry : entries)
+    {
+      if (entry.second.motionType == ColliderMotionType::STATIC_COLLIDER)
+      {
+        continue;
+      }
+      glm::vec3 minCorner, maxCorner;
+      getBroadphaseBox(entry.second, minCorner, maxCorner);
+      broadphase->removeCollider(entry.first);
+      newBroadphase->insertCollider(entry.first, minCorner, maxCorner);
+    }
+
+    broadphaseType = newBroadphaseType;
+    broadphase = newBroadphase;
+  }
+
+  /**
+   * Get the number of models registered with the collision manager.
+   * 
+   * @return The number of registered models.
+   */
+  size_t getModelsCount() const
+  {
+    return entries.size();
+  }
+
+  /**
+   * Get the number of awake models, whose pairs are found and tested by the collision pass.
+   * 
+   * @return The number of awake models.
+   */
+  size_t getAwakeModelsCount() const
+  {
+    return awakeModels.size();
+  }
+
+  /**
+   * Returns the singleton instance of the collision manager.
+   * 
+   * @return The collision manager singleton instance.
+   */
+  static CollisionManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the collision manager singleton instance static variable.
+CollisionManager CollisionManager::instance;
+
+#endif
@@ -0,0 +1,641 @@
+#ifndef INCLUDE_COLLISION_BATCH_CPP
+#define INCLUDE_COLLISION_BATCH_CPP
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COLLISION_BATCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC compiles any intrinsic without extra flags, so the AVX2 kernels need no target attribute there.
+#define COLLISION_BATCH_AVX2_TARGET
+#else
+// GCC and Clang only allow AVX2 intrinsics in the functions marked for it, so that the rest of the program still runs on older CPUs.
+#define COLLISION_BATCH_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#include "collider.cpp"
+
+/**
+ * Enum for defining the instruction sets the batched collision kernels can use.
+ */
+enum CollisionKernelSet
+{
+  SCALAR,
+  SSE2,
+  AVX2,
+};
+
+/**
+ * Structure for defining a batch of sphere colliders as structure-of-arrays, so that the kernels can load them a vector at a time.
+ */
+struct SphereColliderBatch
+{
+  // The world-space centers of the spheres, per axis.
+  std::vector<float_t> centerX;
+  std::vector<float_t> centerY;
+  std::vector<float_t> centerZ;
+  // The world-space radii of the spheres.
+  std::vector<float_t> radii;
+
+  /**
+   * Remove all the spheres from the batch, keeping the memory for the next batch.
+   */
+  void clear()
+  {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radii.clear();
+  }
+
+  /**
+   * Add a sphere to the batch.
+   * 
+   * @param center  The world-space center of the sphere.
+   * @param radius  The world-space radius of the sphere.
+   */
+  void add(const glm::vec3 &center, const float_t &radius)
+  {
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radii.push_back(radius);
+  }
+
+  /**
+   * Add a sphere collider to the batch, scaled the same way the deep collision checks scale it.
+   * 
+   * @param sphere  The sphere collider.
+   */
+  void add(const SphereColliderShape &sphere)
+  {
+    add(sphere.getPosition(), sphere.getRadius() * sphere.getScale().x);
+  }
+
+  /**
+   * Get the number of spheres in the batch.
+   * 
+   * @return The number of spheres.
+   */
+  size_t size() const
+  {
+    return radii.size();
+  }
+};
+
+/**
+ * Structure for defining a batch of oriented box colliders as structure-of-arrays, so that the kernels can load them a vector at a time.
+ */
+struct BoxColliderBatch
+{
+  // The world-space centers of the boxes, per axis.
+  std::vector<float_t> centerX;
+  std::vector<float_t> centerY;
+  std::vector<float_t> centerZ;
+  // The components of the local axes of the boxes, by local axis and then by world axis.
+  std::vector<float_t> axes[3][3];
+  // The half-sizes of the boxes, by local axis.
+  std::vector<float_t> extents[3];
+
+  /**
+   * Remove all the boxes from the batch, keeping the memory for the next batch.
+   */
+  void clear()
+  {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        axes[i][j].clear();
+      }
+      extents[i].clear();
+    }
+  }
+
+  /**
+   * Add an oriented box to the batch.
+   * 
+   * @param box  The oriented box.
+   */
+  void add(const OrientedBoundingBox &box)
+  {
+    centerX.push_back(box.center.x);
+    centerY.push_back(box.center.y);
+    centerZ.push_back(box.center.z);
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        axes[i][j].push_back(box.axes[i][j]);
+      }
+      extents[i].push_back(box.extents[i]);
+    }
+  }
+
+  /**
+   * Get the number of boxes in the batch.
+   * 
+   * @return The number of boxes.
+   */
+  size_t size() const
+  {
+    return centerX.size();
+  }
+};
+
+/**
+ * A class that can test a single collider against a batch of colliders at once, with the sphere-sphere and sphere-OBB kernels
+ *   vectorized using SSE2 or AVX2 (picked at runtime by what the CPU supports), and scalar code everywhere else.
+ * The hits are returned as a bitmask with a bit per collider in the batch, in 32-bit words.
+ */
+class CollisionBatchValidator
+{
+private:
+  // The instruction set the kernels use.
+  static CollisionKernelSet kernelSet;
+
+  /**
+   * Find the best instruction set the CPU and the OS support.
+   * 
+   * @return The instruction set.
+   */
+  static CollisionKernelSet detectKernelSet()
+  {
+#ifdef COLLISION_BATCH_X86
+#ifdef _MSC_VER
+    int32_t cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] >= 7)
+    {
+      // AVX2 needs the CPU flag, and the OS saving the AVX registers on context switches.
+      __cpuid(cpuInfo, 1);
+      const auto isAvxSavedByOs = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+      __cpuidex(cpuInfo, 7, 0);
+      if (isAvxSavedByOs && (cpuInfo[1] & (1 << 5)) != 0)
+      {
+        return CollisionKernelSet::AVX2;
+      }
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return CollisionKernelSet::AVX2;
+    }
+#endif
+    // SSE2 is part of every x86-64 CPU, and of every x86 CPU that can run this program.
+    return CollisionKernelSet::SSE2;
+#else
+    return CollisionKernelSet::SCALAR;
+#endif
+  }
+
+  /**
+   * Get the squared distance from a point to an oriented box, given the offset of the point from the center of the box.
+   * 
+   * @param offsetX  The offset of the point along the world X axis.
+   * @param offsetY  The offset of the point along the world Y axis.
+   * @param offsetZ  The offset of the point along the world Z axis.
+   * @param axes     The components of the local axes of the box, by local axis and then by world axis.
+   * @param extents  The half-sizes of the box, by local axis.
+   * 
+   * @return The squared distance (0 if the point is inside the box).
+   */
+  static float_t getSquaredBoxDistance(const float_t &offsetX, const float_t &offsetY, const float_t &offsetZ, const float_t axes[3][3], const float_t extents[3])
+  {
+    auto squaredDistance = 0.0f;
+    for (auto i = 0; i < 3; i++)
+    {
+      // Project the offset on the local axis, and add how far it is outside the box along it.
+      const auto projection = (offsetX * axes[i][0]) + (offsetY * axes[i][1]) + (offsetZ * axes[i][2]);
+      const auto outside = projection - glm::clamp(projection, -extents[i], extents[i]);
+      squaredDistance += outside * outside;
+    }
+    return squaredDistance;
+  }
+
+  /**
+   * Set the bits of the given hits in the bitmask.
+   * 
+   * @param hitMasks  The bitmask of the hits.
+   * @param index     The index of the first collider the hits are for (a multiple of the number of hits).
+   * @param hits      The hits, a bit per collider.
+   */
+  static void setHits(std::vector<uint32_t> &hitMasks, const size_t &index, const uint32_t &hits)
+  {
+    hitMasks[index / 32] |= hits << (index % 32);
+  }
+
+  /**
+   * Test a sphere against the spheres of a batch with scalar code, from the given index to the end of the batch.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param spheres   The batch of spheres.
+   * @param index     The index of the first sphere to test.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The number of spheres in the batch.
+   */
+  static size_t testSphereSpheresScalar(const glm::vec3 &center, const float_t &radius, const SphereColliderBatch &spheres, size_t index, std::vector<uint32_t> &hitMasks)
+  {
+    for (; index < spheres.size(); index++)
+    {
+      const auto offset = glm::vec3(spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index]) - center;
+      const auto radiusSum = radius + spheres.radii[index];
+      if (glm::dot(offset, offset) <= radiusSum * radiusSum)
+      {
+        setHits(hitMasks, index, 1);
+      }
+    }
+    return index;
+  }
+
+  /**
+   * Test an oriented box against the spheres of a batch with scalar code, from the given index to the end of the batch.
+   * 
+   * @param box       The oriented box.
+   * @param spheres   The batch of spheres.
+   * @param index     The index of the first sphere to test.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The number of spheres in the batch.
+   */
+  static size_t testBoxSpheresScalar(const OrientedBoundingBox &box, const SphereColliderBatch &spheres, size_t index, std::vector<uint32_t> &hitMasks)
+  {
+    const float_t axes[3][3] = {{box.axes[0].x, box.axes[0].y, box.axes[0].z}, {box.axes[1].x, box.axes[1].y, box.axes[1].z}, {box.axes[2].x, box.axes[2].y, box.axes[2].z}};
+    const float_t extents[3] = {box.extents.x, box.extents.y, box.extents.z};
+    for (; index < spheres.size(); index++)
+    {
+      const auto squaredDistance = getSquaredBoxDistance(spheres.centerX[index] - box.center.x, spheres.centerY[index] - box.center.y, spheres.centerZ[index] - box.center.z, axes, extents);
+      if (squaredDistance <= spheres.radii[index] * spheres.radii[index])
+      {
+        setHits(hitMasks, index, 1);
+      }
+    }
+    return index;
+  }
+
+  /**
+   * Test a sphere against the oriented boxes of a batch with scalar code, from the given index to the end of the batch.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param boxes     The batch of oriented boxes.
+   * @param index     The index of the first box to test.
+   * @param hitMasks  The bitmask to set the bits of the hit boxes in.
+   * 
+   * @return The number of boxes in the batch.
+   */
+  static size_t testSphereBoxesScalar(const glm::vec3 &center, const float_t &radius, const BoxColliderBatch &boxes, size_t index, std::vector<uint32_t> &hitMasks)
+  {
+    for (; index < boxes.size(); index++)
+    {
+      const float_t axes[3][3] = {
+          {boxes.axes[0][0][index], boxes.axes[0][1][index], boxes.axes[0][2][index]},
+          {boxes.axes[1][0][index], boxes.axes[1][1][index], boxes.axes[1][2][index]},
+          {boxes.axes[2][0][index], boxes.axes[2][1][index], boxes.axes[2][2][index]}};
+      const float_t extents[3] = {boxes.extents[0][index], boxes.extents[1][index], boxes.extents[2][index]};
+      const auto squaredDistance = getSquaredBoxDistance(center.x - boxes.centerX[index], center.y - boxes.centerY[index], center.z - boxes.centerZ[index], axes, extents);
+      if (squaredDistance <= radius * radius)
+      {
+        setHits(hitMasks, index, 1);
+      }
+    }
+    return index;
+  }
+
+#ifdef COLLISION_BATCH_X86
+  /**
+   * Test a sphere against the spheres of a batch four at a time with SSE2, leaving the spheres that do not fill a vector.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The index of the first sphere left untested.
+   */
+  static size_t testSphereSpheresSse2(const glm::vec3 &center, const float_t &radius, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    const auto centerX = _mm_set1_ps(center.x), centerY = _mm_set1_ps(center.y), centerZ = _mm_set1_ps(center.z), radiusVector = _mm_set1_ps(radius);
+    size_t index = 0;
+    for (; index + 4 <= spheres.size(); index += 4)
+    {
+      const auto offsetX = _mm_sub_ps(_mm_loadu_ps(&spheres.centerX[index]), centerX);
+      const auto offsetY = _mm_sub_ps(_mm_loadu_ps(&spheres.centerY[index]), centerY);
+      const auto offsetZ = _mm_sub_ps(_mm_loadu_ps(&spheres.centerZ[index]), centerZ);
+      const auto squaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)), _mm_mul_ps(offsetZ, offsetZ));
+      const auto radiusSum = _mm_add_ps(_mm_loadu_ps(&spheres.radii[index]), radiusVector);
+      setHits(hitMasks, index, _mm_movemask_ps(_mm_cmple_ps(squaredDistance, _mm_mul_ps(radiusSum, radiusSum))));
+    }
+    return index;
+  }
+
+  /**
+   * Get the squared distances from four points to oriented boxes, given the offsets of the points from the centers of the boxes.
+   * 
+   * @param offsets  The offsets of the points, by world axis.
+   * @param axes     The components of the local axes of the boxes, by local axis and then by world axis.
+   * @param extents  The half-sizes of the boxes, by local axis.
+   * 
+   * @return The squared distances.
+   */
+  static __m128 getSquaredBoxDistancesSse2(const __m128 offsets[3], const __m128 axes[3][3], const __m128 extents[3])
+  {
+    auto squaredDistance = _mm_setzero_ps();
+    for (auto i = 0; i < 3; i++)
+    {
+      const auto projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsets[0], axes[i][0]), _mm_mul_ps(offsets[1], axes[i][1])), _mm_mul_ps(offsets[2], axes[i][2]));
+      const auto clamped = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), extents[i]), _mm_min_ps(projection, extents[i]));
+      const auto outside = _mm_sub_ps(projection, clamped);
+      squaredDistance = _mm_add_ps(squaredDistance, _mm_mul_ps(outside, outside));
+    }
+    return squaredDistance;
+  }
+
+  /**
+   * Test an oriented box against the spheres of a batch four at a time with SSE2, leaving the spheres that do not fill a vector.
+   * 
+   * @param box       The oriented box.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The index of the first sphere left untested.
+   */
+  static size_t testBoxSpheresSse2(const OrientedBoundingBox &box, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    __m128 axes[3][3], extents[3];
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        axes[i][j] = _mm_set1_ps(box.axes[i][j]);
+      }
+      extents[i] = _mm_set1_ps(box.extents[i]);
+    }
+    const auto centerX = _mm_set1_ps(box.center.x), centerY = _mm_set1_ps(box.center.y), centerZ = _mm_set1_ps(box.center.z);
+
+    size_t index = 0;
+    for (; index + 4 <= spheres.size(); index += 4)
+    {
+      const __m128 offsets[3] = {
+          _mm_sub_ps(_mm_loadu_ps(&spheres.centerX[index]), centerX),
+          _mm_sub_ps(_mm_loadu_ps(&spheres.centerY[index]), centerY),
+          _mm_sub_ps(_mm_loadu_ps(&spheres.centerZ[index]), centerZ)};
+      const auto radii = _mm_loadu_ps(&spheres.radii[index]);
+      setHits(hitMasks, index, _mm_movemask_ps(_mm_cmple_ps(getSquaredBoxDistancesSse2(offsets, axes, extents), _mm_mul_ps(radii, radii))));
+    }
+    return index;
+  }
+
+  /**
+   * Test a sphere against the oriented boxes of a batch four at a time with SSE2, leaving the boxes that do not fill a vector.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param boxes     The batch of oriented boxes.
+   * @param hitMasks  The bitmask to set the bits of the hit boxes in.
+   * 
+   * @return The index of the first box left untested.
+   */
+  static size_t testSphereBoxesSse2(const glm::vec3 &center, const float_t &radius, const BoxColliderBatch &boxes, std::vector<uint32_t> &hitMasks)
+  {
+    const auto centerX = _mm_set1_ps(center.x), centerY = _mm_set1_ps(center.y), centerZ = _mm_set1_ps(center.z);
+    const auto squaredRadius = _mm_set1_ps(radius * radius);
+
+    size_t index = 0;
+    for (; index + 4 <= boxes.size(); index += 4)
+    {
+      __m128 axes[3][3], extents[3];
+      for (auto i = 0; i < 3; i++)
+      {
+        for (auto j = 0; j < 3; j++)
+        {
+          axes[i][j] = _mm_loadu_ps(&boxes.axes[i][j][index]);
+        }
+        extents[i] = _mm_loadu_ps(&boxes.extents[i][index]);
+      }
+      const __m128 offsets[3] = {
+          _mm_sub_ps(centerX, _mm_loadu_ps(&boxes.centerX[index])),
+          _mm_sub_ps(centerY, _mm_loadu_ps(&boxes.centerY[index])),
+          _mm_sub_ps(centerZ, _mm_loadu_ps(&boxes.centerZ[index]))};
+      setHits(hitMasks, index, _mm_movemask_ps(_mm_cmple_ps(getSquaredBoxDistancesSse2(offsets, axes, extents), squaredRadius)));
+    }
+    return index;
+  }
+
+  /**
+   * Test a sphere against the spheres of a batch eight at a time with AVX2, leaving the spheres that do not fill a vector.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The index of the first sphere left untested.
+   */
+  COLLISION_BATCH_AVX2_TARGET static size_t testSphereSpheresAvx2(const glm::vec3 &center, const float_t &radius, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    const auto centerX = _mm256_set1_ps(center.x), centerY = _mm256_set1_ps(center.y), centerZ = _mm256_set1_ps(center.z), radiusVector = _mm256_set1_ps(radius);
+    size_t index = 0;
+    for (; index + 8 <= spheres.size(); index += 8)
+    {
+      const auto offsetX = _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerX[index]), centerX);
+      const auto offsetY = _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerY[index]), centerY);
+      const auto offsetZ = _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerZ[index]), centerZ);
+      const auto squaredDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(offsetX, offsetX), _mm256_mul_ps(offsetY, offsetY)), _mm256_mul_ps(offsetZ, offsetZ));
+      const auto radiusSum = _mm256_add_ps(_mm256_loadu_ps(&spheres.radii[index]), radiusVector);
+      setHits(hitMasks, index, _mm256_movemask_ps(_mm256_cmp_ps(squaredDistance, _mm256_mul_ps(radiusSum, radiusSum), _CMP_LE_OQ)));
+    }
+    return index;
+  }
+
+  /**
+   * Get the squared distances from eight points to oriented boxes, given the offsets of the points from the centers of the boxes.
+   * 
+   * @param offsets  The offsets of the points, by world axis.
+   * @param axes     The components of the local axes of the boxes, by local axis and then by world axis.
+   * @param extents  The half-sizes of the boxes, by local axis.
+   * 
+   * @return The squared distances.
+   */
+  COLLISION_BATCH_AVX2_TARGET static __m256 getSquaredBoxDistancesAvx2(const __m256 offsets[3], const __m256 axes[3][3], const __m256 extents[3])
+  {
+    auto squaredDistance = _mm256_setzero_ps();
+    for (auto i = 0; i < 3; i++)
+    {
+      const auto projection = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(offsets[0], axes[i][0]), _mm256_mul_ps(offsets[1], axes[i][1])), _mm256_mul_ps(offsets[2], axes[i][2]));
+      const auto clamped = _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), extents[i]), _mm256_min_ps(projection, extents[i]));
+      const auto outside = _mm256_sub_ps(projection, clamped);
+      squaredDistance = _mm256_add_ps(squaredDistance, _mm256_mul_ps(outside, outside));
+    }
+    return squaredDistance;
+  }
+
+  /**
+   * Test an oriented box against the spheres of a batch eight at a time with AVX2, leaving the spheres that do not fill a vector.
+   * 
+   * @param box       The oriented box.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  The bitmask to set the bits of the hit spheres in.
+   * 
+   * @return The index of the first sphere left untested.
+   */
+  COLLISION_BATCH_AVX2_TARGET static size_t testBoxSpheresAvx2(const OrientedBoundingBox &box, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    __m256 axes[3][3], extents[3];
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        axes[i][j] = _mm256_set1_ps(box.axes[i][j]);
+      }
+      extents[i] = _mm256_set1_ps(box.extents[i]);
+    }
+    const auto centerX = _mm256_set1_ps(box.center.x), centerY = _mm256_set1_ps(box.center.y), centerZ = _mm256_set1_ps(box.center.z);
+
+    size_t index = 0;
+    for (; index + 8 <= spheres.size(); index += 8)
+    {
+      const __m256 offsets[3] = {
+          _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerX[index]), centerX),
+          _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerY[index]), centerY),
+          _mm256_sub_ps(_mm256_loadu_ps(&spheres.centerZ[index]), centerZ)};
+      const auto radii = _mm256_loadu_ps(&spheres.radii[index]);
+      setHits(hitMasks, index, _mm256_movemask_ps(_mm256_cmp_ps(getSquaredBoxDistancesAvx2(offsets, axes, extents), _mm256_mul_ps(radii, radii), _CMP_LE_OQ)));
+    }
+    return index;
+  }
+
+  /**
+   * Test a sphere against the oriented boxes of a batch eight at a time with AVX2, leaving the boxes that do not fill a vector.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param boxes     The batch of oriented boxes.
+   * @param hitMasks  The bitmask to set the bits of the hit boxes in.
+   * 
+   * @return The index of the first box left untested.
+   */
+  COLLISION_BATCH_AVX2_TARGET static size_t testSphereBoxesAvx2(const glm::vec3 &center, const float_t &radius, const BoxColliderBatch &boxes, std::vector<uint32_t> &hitMasks)
+  {
+    const auto centerX = _mm256_set1_ps(center.x), centerY = _mm256_set1_ps(center.y), centerZ = _mm256_set1_ps(center.z);
+    const auto squaredRadius = _mm256_set1_ps(radius * radius);
+
+    size_t index = 0;
+    for (; index + 8 <= boxes.size(); index += 8)
+    {
+      __m256 axes[3][3], extents[3];
+      for (auto i = 0; i < 3; i++)
+      {
+        for (auto j = 0; j < 3; j++)
+        {
+          axes[i][j] = _mm256_loadu_ps(&boxes.axes[i][j][index]);
+        }
+        extents[i] = _mm256_loadu_ps(&boxes.extents[i][index]);
+      }
+      const __m256 offsets[3] = {
+          _mm256_sub_ps(centerX, _mm256_loadu_ps(&boxes.centerX[index])),
+          _mm256_sub_ps(centerY, _mm256_loadu_ps(&boxes.centerY[index])),
+          _mm256_sub_ps(centerZ, _mm256_loadu_ps(&boxes.centerZ[index]))};
+      setHits(hitMasks, index, _mm256_movemask_ps(_mm256_cmp_ps(getSquaredBoxDistancesAvx2(offsets, axes, extents), squaredRadius, _CMP_LE_OQ)));
+    }
+    return index;
+  }
+#endif
+
+public:
+  /**
+   * Test a sphere against a batch of spheres.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  Set to the bitmask of the spheres of the batch that overlap the sphere.
+   */
+  static void testSphereSpheres(const glm::vec3 &center, const float_t &radius, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    hitMasks.assign((spheres.size() + 31) / 32, 0);
+    size_t index = 0;
+#ifdef COLLISION_BATCH_X86
+    index = kernelSet == CollisionKernelSet::AVX2 ? testSphereSpheresAvx2(center, radius, spheres, hitMasks) : kernelSet == CollisionKernelSet::SSE2 ? testSphereSpheresSse2(center, radius, spheres, hitMasks) : 0;
+#endif
+    // Test the spheres left over from the vectors with scalar code.
+    testSphereSpheresScalar(center, radius, spheres, index, hitMasks);
+  }
+
+  /**
+   * Test an oriented box against a batch of spheres.
+   * 
+   * @param box       The oriented box.
+   * @param spheres   The batch of spheres.
+   * @param hitMasks  Set to the bitmask of the spheres of the batch that overlap the box.
+   */
+  static void testBoxSpheres(const OrientedBoundingBox &box, const SphereColliderBatch &spheres, std::vector<uint32_t> &hitMasks)
+  {
+    hitMasks.assign((spheres.size() + 31) / 32, 0);
+    size_t index = 0;
+#ifdef COLLISION_BATCH_X86
+    index = kernelSet == CollisionKernelSet::AVX2 ? testBoxSpheresAvx2(box, spheres, hitMasks) : kernelSet == CollisionKernelSet::SSE2 ? testBoxSpheresSse2(box, spheres, hitMasks) : 0;
+#endif
+    // Test the spheres left over from the vectors with scalar code.
+    testBoxSpheresScalar(box, spheres, index, hitMasks);
+  }
+
+  /**
+   * Test a sphere against a batch of oriented boxes.
+   * 
+   * @param center    The world-space center of the sphere.
+   * @param radius    The world-space radius of the sphere.
+   * @param boxes     The batch of oriented boxes.
+   * @param hitMasks  Set to the bitmask of the boxes of the batch that overlap the sphere.
+   */
+  static void testSphereBoxes(const glm::vec3 &center, const float_t &radius, const BoxColliderBatch &boxes, std::vector<uint32_t> &hitMasks)
+  {
+    hitMasks.assign((boxes.size() + 31) / 32, 0);
+    size_t index = 0;
+#ifdef COLLISION_BATCH_X86
+    index = kernelSet == CollisionKernelSet::AVX2 ? testSphereBoxesAvx2(center, radius, boxes, hitMasks) : kernelSet == CollisionKernelSet::SSE2 ? testSphereBoxesSse2(center, radius, boxes, hitMasks) : 0;
+#endif
+    // Test the boxes left over from the vectors with scalar code.
+    testSphereBoxesScalar(center, radius, boxes, index, hitMasks);
+  }
+
+  /**
+   * Get the instruction set the kernels use.
+   * 
+   * @return The instruction set.
+   */
+  static const CollisionKernelSet &getKernelSet()
+  {
+    return kernelSet;
+  }
+
+  /**
+   * Get the name of the instruction set the kernels use.
+   * 
+   * @return The name of the instruction set.
+   */
+  static const char *getKernelSetName()
+  {
+    return kernelSet == CollisionKernelSet::AVX2 ? "AVX2" : kernelSet == CollisionKernelSet::SSE2 ? "SSE2" : "Scalar";
+  }
+};
+
+// Initialize the kernel instruction set static variable with the best one the CPU supports.
+CollisionKernelSet CollisionBatchValidator::kernelSet = CollisionBatchValidator::detectKernelSet();
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef INCLUDE_COLLISION_BROADPHASE_CPP
+#define INCLUDE_COLLISION_BROADPHASE_CPP
+
+#include <vector>
+#include <utility>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+class ModelBaseIntf;
+
+/**
+ * Base class for the spatial structures the collision manager uses to find the models that can collide, without checking
+ *   every pair of models. The structures only track the AABBs they are given and may return extra candidates, leaving the
+ *   exact checks to the collision manager.
+ */
+class CollisionBroadphase
+{
+public:
+  virtual ~CollisionBroadphase() {}
+
+  /**
+   * Add a model to the structure.
+   * 
+   * @param model      The model to add.
+   * @param minCorner  The corner of the AABB of the model with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB of the model with the largest coordinates.
+   */
+  virtual void insertCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) = 0;
+
+  /**
+   * Remove a model from the structure.
+   * 
+   * @param model  The model to remove (ignored if it was not added).
+   */
+  virtual void removeCollider(const ModelBaseIntf *model) = 0;
+
+  /**
+   * Update the AABB of a model in the structure after it was transformed.
+   * 
+   * @param model      The model that was transformed (ignored if it was not added).
+   * @param minCorner  The corner of the new AABB of the model with the smallest coordinates.
+   * @param maxCorner  The corner of the new AABB of the model with the largest coordinates.
+   */
+  virtual void updateCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) = 0;
+
+  /**
+   * Find the models that can overlap the given AABB, each returned once.
+   * 
+   * @param minCorner  The corner of the AABB with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB with the largest coordinates.
+   * @param models     Appended with the candidate models.
+   */
+  virtual void queryBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, std::vector<const ModelBaseIntf *> &models) = 0;
+
+  /**
+   * Find the models that can be hit by the given ray, each returned once.
+   * 
+   * @param origin       The origin of the ray.
+   * @param direction    The normalized direction of the ray.
+   * @param maxDistance  The length of the ray.
+   * @param models       Appended with the candidate models.
+   */
+  virtual void queryRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, std::vector<const ModelBaseIntf *> &models) = 0;
+
+  /**
+   * Find the pairs of models that can overlap each other, each returned once.
+   * 
+   * @param pairs  Appended with the candidate pairs.
+   */
+  virtual void queryPairs(std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> &pairs) = 0;
+
+  /**
+   * Check if the given AABBs overlap.
+   * 
+   * @param minCorner1  The corner of the first AABB with the smallest coordinates.
+   * @param maxCorner1  The corner of the first AABB with the largest coordinates.
+   * @param minCorner2  The corner of the second AABB with the smallest coordinates.
+   * @param maxCorner2  The corner of the second AABB with the largest coordinates.
+   * 
+   * @return Whether the AABBs overlap or not.
+   */
+  static bool haveBoxesOverlapped(const glm::vec3 &minCorner1, const glm::vec3 &maxCorner1, const glm::vec3 &minCorner2, const glm::vec3 &maxCorner2)
+  {
+    return glm::all(glm::lessThanEqual(minCorner1, maxCorner2)) && glm::all(glm::greaterThanEqual(maxCorner1, minCorner2));
+  }
+
+  /**
+   * Get the distance along the given ray at which it enters the given AABB, using the slab test.
+   * 
+   * @param minCorner    The corner of the AABB with the smallest coordinates.
+   * @param maxCorner    The corner of the AABB with the largest coordinates.
+   * @param origin       The origin of the ray.
+   * @param direction    The normalized direction of the ray.
+   * @param maxDistance  The length of the ray.
+   * 
+   * @return The distance to the AABB (0 if the origin is inside it, and negative if the ray misses it).
+   */
+  static float_t getRayBoxDistance(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance)
+  {
+    auto enterDistance = 0.0f, exitDistance = maxDistance;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      // A ray parallel to the slab has to start between its planes.
+      if (direction[axis] == 0.0f)
+      {
+        if (origin[axis] < minCorner[axis] || origin[axis] > maxCorner[axis])
+        {
+          return -1.0f;
+        }
+        continue;
+      }
+
+      // Narrow the distances down to where the ray is between the planes of the slab.
+      auto nearDistance = (minCorner[axis] - origin[axis]) / direction[axis];
+      auto farDistance = (maxCorner[axis] - origin[axis]) / direction[axis];
+      if (nearDistance > farDistance)
+      {
+        std::swap(nearDistance, farDistance);
+      }
+      enterDistance = glm::max(enterDistance, nearDistance);
+      exitDistance = glm::min(exitDistance, farDistance);
+      if (enterDistance > exitDistance)
+      {
+        return -1.0f;
+      }
+    }
+
+    return enterDistance;
+  }
+};
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef INCLUDE_COLLISION_GRID_CPP
+#define INCLUDE_COLLISION_GRID_CPP
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "collision_broadphase.cpp"
+
+/**
+ * Structure for defining the range of the grid cells an AABB overlaps, per axis.
+ */
+struct CollisionCellRange
+{
+  // The cell with the smallest coordinates.
+  glm::ivec3 minCell;
+  // The cell with the largest coordinates.
+  glm::ivec3 maxCell;
+};
+
+/**
+ * Class for hashing the AABBs of the models into a uniform grid of cells, so that only the models sharing cells can collide.
+ * Cheap to update, and works best when the models are spread evenly and are about as large as the cells.
+ */
+class CollisionGrid : public CollisionBroadphase
+{
+private:
+  // The width, height and depth of the grid cells.
+  const static float_t CELL_SIZE;
+
+  // The cells each added model was last hashed into.
+  std::map<const ModelBaseIntf *, CollisionCellRange> cellRanges;
+  // The models overlapping each non-empty grid cell, by the key of the cell.
+  std::unordered_map<uint64_t, std::vector<const ModelBaseIntf *>> cells;
+
+  /**
+   * Get the range of the grid cells that the given AABB overlaps.
+   * 
+   * @param minCorner  The corner of the AABB with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB with the largest coordinates.
+   * 
+   * @return The range of the cells.
+   */
+  static CollisionCellRange getCellRange(const glm::vec3 &minCorner, const glm::vec3 &maxCorner)
+  {
+    return {glm::ivec3(glm::floor(minCorner / CELL_SIZE)), glm::ivec3(glm::floor(maxCorner / CELL_SIZE))};
+  }
+
+  /**
+   * Get the key of the given grid cell, packing the coordinates into 21 bits each.
+   * 
+   * @param cell  The coordinates of the cell.
+   * 
+   * @return The key of the cell.
+   */
+  static uint64_t getCellKey(const glm::ivec3 &cell)
+  {
+    return ((static_cast<uint64_t>(cell.x) & 0x1FFFFF) << 42) | ((static_cast<uint64_t>(cell.y) & 0x1FFFFF) << 21) | (static_cast<uint64_t>(cell.z) & 0x1FFFFF);
+  }
+
+  /**
+   * Add the given model to the grid cells in the given range.
+   * 
+   * @param model      The model to add.
+   * @param cellRange  The range of the cells to add the model to.
+   */
+  void insertIntoCells(const ModelBaseIntf *model, const CollisionCellRange &cellRange)
+  {
+    for (auto x = cellRange.minCell.x; x <= cellRange.maxCell.x; x++)
+    {
+      for (auto y = cellRange.minCell.y; y <= cellRange.maxCell.y; y++)
+      {
+        for (auto z = cellRange.minCell.z; z <= cellRange.maxCell.z; z++)
+        {
+          cells[getCellKey(glm::ivec3(x, y, z))].push_back(model);
+        }
+      }
+    }
+  }
+
+  /**
+   * Remove the given model from the grid cells in the given range, dropping the cells left empty.
+   * 
+   * @param model      The model to remove.
+   * @param cellRange  The range of the cells to remove the model from.
+   */
+  void removeFromCells(const ModelBaseIntf *model, const CollisionCellRange &cellRange)
+  {
+    for (auto x = cellRange.minCell.x; x <= cellRange.maxCell.x; x++)
+    {
+      for (auto y = cellRange.minCell.y; y <= cellRange.maxCell.y; y++)
+      {
+        for (auto z = cellRange.minCell.z; z <= cellRange.maxCell.z; z++)
+        {
+          const auto cell = cells.find(getCellKey(glm::ivec3(x, y, z)));
+          if (cell == cells.end())
+          {
+            continue;
+          }
+          cell->second.erase(std::remove(cell->second.begin(), cell->second.end(), model), cell->second.end());
+          if (cell->second.empty())
+          {
+            cells.erase(cell);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Append the models of the given cell that are not in the given list yet.
+   * 
+   * @param cell         The coordinates of the cell.
+   * @param models       Appended with the models of the cell.
+   * @param firstIndex   The index of the first model appended by the current query, before which models are not checked.
+   */
+  void appendCellModels(const glm::ivec3 &cell, std::vector<const ModelBaseIntf *> &models, const size_t &firstIndex) const
+  {
+    const auto cellModels = cells.find(getCellKey(cell));
+    if (cellModels == cells.end())
+    {
+      return;
+    }
+
+    for (const auto &cellModel : cellModels->second)
+    {
+      // Skip the models already found through another cell.
+      if (std::find(models.begin() + firstIndex, models.end(), cellModel) == models.end())
+      {
+        models.push_back(cellModel);
+      }
+    }
+  }
+
+public:
+  CollisionGrid()
+      : cellRanges({}),
+        cells({}) {}
+
+  void insertCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) override
+  {
+    const auto cellRange = getCellRange(minCorner, maxCorner);
+    cellRanges[model] = cellRange;
+    insertIntoCells(model, cellRange);
+  }
+
+  void removeCollider(const ModelBaseIntf *model) override
+  {
+    const auto cellRange = cellRanges.find(model);
+    if (cellRange == cellRanges.end())
+    {
+      return;
+    }
+
+    removeFromCells(model, cellRange->second);
+    cellRanges.erase(cellRange);
+  }
+
+  void updateCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) override
+  {
+    const auto cellRange = cellRanges.find(model);
+    if (cellRange == cellRanges.end())
+    {
+      return;
+    }
+
+    // Only move the model if it overlaps other cells than before.
+    const auto newCellRange = getCellRange(minCorner, maxCorner);
+    if (newCellRange.minCell == cellRange->second.minCell && newCellRange.maxCell == cellRange->second.maxCell)
+    {
+      return;
+    }
+
+    removeFromCells(model, cellRange->second);
+    insertIntoCells(model, newCellRange);
+    cellRange->second = newCellRange;
+  }
+
+  void queryBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, std::vector<const ModelBaseIntf *> &models) override
+  {
+    const auto firstIndex = models.size();
+    const auto cellRange = getCellRange(minCorner, maxCorner);
+    for (auto x = cellRange.minCell.x; x <= cellRange.maxCell.x; x++)
+    {
+      for (auto y = cellRange.minCell.y; y <= cellRange.maxCell.y; y++)
+      {
+        for (auto z = cellRange.minCell.z; z <= cellRange.maxCell.z; z++)
+        {
+          appendCellModels(glm::ivec3(x, y, z), models, firstIndex);
+        }
+      }
+    }
+  }
+
+  void queryRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, std::vector<const ModelBaseIntf *> &models) override
+  {
+    const auto firstIndex = models.size();
+
+    // Walk through the cells the ray passes, one cell boundary at a time (Amanatides & Woo), starting with the cell of the origin.
+    auto cell = glm::ivec3(glm::floor(origin / CELL_SIZE));
+    glm::ivec3 cellStep;
+    glm::vec3 boundaryDistance, boundaryStep;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      cellStep[axis] = direction[axis] > 0.0f ? 1 : -1;
+      if (direction[axis] == 0.0f)
+      {
+        // The ray never crosses the boundaries of this axis.
+        boundaryDistance[axis] = std::numeric_limits<float_t>::infinity();
+        boundaryStep[axis] = std::numeric_limits<float_t>::infinity();
+        continue;
+      }
+      const auto nextBoundary = (cell[axis] + (direction[axis] > 0.0f ? 1 : 0)) * CELL_SIZE;
+      boundaryDistance[axis] = (nextBoundary - origin[axis]) / direction[axis];
+      boundaryStep[axis] = CELL_SIZE / glm::abs(direction[axis]);
+    }
+
+    auto distance = 0.0f;
+    while (distance <= maxDistance)
+    {
+      appendCellModels(cell, models, firstIndex);
+
+      // Step into the cell behind the closest boundary.
+      auto axis = 0;
+      if (boundaryDistance[1] < boundaryDistance[axis])
+      {
+        axis = 1;
+      }
+      if (boundaryDistance[2] < boundaryDistance[axis])
+      {
+        axis = 2;
+      }
+      distance = boundaryDistance[axis];
+      boundaryDistance[axis] += boundaryStep[axis];
+      cell[axis] += cellStep[axis];
+    }
+  }
+
+  void queryPairs(std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> &pairs) override
+  {
+    const auto firstIndex = pairs.size();
+    const std::less<const ModelBaseIntf *> isLess;
+    for (const auto &cell : cells)
+    {
+      for (size_t i = 0; i < cell.second.size(); i++)
+      {
+        for (auto j = i + 1; j < cell.second.size(); j++)
+        {
+          // Order the pair, so that the pairs sharing several cells can be merged.
+          const auto model1 = cell.second[i], model2 = cell.second[j];
+          pairs.push_back(isLess(model1, model2) ? std::make_pair(model1, model2) : std::make_pair(model2, model1));
+        }
+      }
+    }
+
+    // Merge the pairs sharing several cells.
+    std::sort(pairs.begin() + firstIndex, pairs.end());
+    pairs.erase(std::unique(pairs.begin() + firstIndex, pairs.end()), pairs.end());
+  }
+};
+
+// Initialize the grid cell size static variable.
+const float_t CollisionGrid::CELL_SIZE = 4.0f;
+
+#endif
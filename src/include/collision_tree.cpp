@@ -0,0 +1,538 @@
+#ifndef INCLUDE_COLLISION_TREE_CPP
+#define INCLUDE_COLLISION_TREE_CPP
+
+#include <vector>
+#include <map>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "collision_broadphase.cpp"
+#include "frustum.cpp"
+
+/**
+ * Structure for defining a node of a collision tree.
+ */
+struct CollisionTreeNode
+{
+  // The corner of the AABB of the node with the smallest coordinates (fattened for the leaves).
+  glm::vec3 minCorner;
+  // The corner of the AABB of the node with the largest coordinates (fattened for the leaves).
+  glm::vec3 maxCorner;
+  // The model of the node (null for the nodes that are not leaves).
+  const ModelBaseIntf *model;
+  // The index of the parent node (or of the next free node, for the free nodes).
+  int32_t parentIndex;
+  // The indices of the child nodes (-1 for the leaves).
+  int32_t childIndex1;
+  int32_t childIndex2;
+  // The height of the node in the tree (0 for the leaves, and -1 for the free nodes).
+  int32_t height;
+};
+
+/**
+ * Class for keeping the AABBs of the models in a dynamic bounding volume hierarchy, where every node encloses the nodes below it.
+ * The leaves are fattened so that models moving by small amounts do not change the tree, and the tree is kept balanced with
+ *   rotations as the leaves are inserted and removed. Works best when the models are packed in some places and the rest of the
+ *   scene is empty, where a grid would either have many empty cells or many models per cell.
+ */
+class CollisionTree : public CollisionBroadphase
+{
+private:
+  // The index used for a node that does not exist.
+  static constexpr int32_t NULL_NODE = -1;
+  // How much the AABBs of the leaves are fattened on every side.
+  static constexpr float_t FAT_MARGIN = 0.5f;
+
+  // The nodes of the tree, including the free ones.
+  std::vector<CollisionTreeNode> nodes;
+  // The index of the root node.
+  int32_t rootIndex;
+  // The index of the first free node.
+  int32_t freeIndex;
+  // The index of the leaf of each added model.
+  std::map<const ModelBaseIntf *, int32_t> leafIndices;
+  // The nodes left to visit by a query (kept around to avoid reallocating every query).
+  std::vector<int32_t> nodeStack;
+
+  /**
+   * Get the surface area of the given AABB, used as the cost of a node.
+   * 
+   * @param minCorner  The corner of the AABB with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB with the largest coordinates.
+   * 
+   * @return The surface area of the AABB.
+   */
+  static float_t getSurfaceArea(const glm::vec3 &minCorner, const glm::vec3 &maxCorner)
+  {
+    const auto size = maxCorner - minCorner;
+    return 2.0f * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+  }
+
+  /**
+   * Get the surface area of the AABB enclosing both the given nodes.
+   * 
+   * @param nodeIndex1  The index of the first node.
+   * @param nodeIndex2  The index of the second node.
+   * 
+   * @return The surface area of the enclosing AABB.
+   */
+  float_t getCombinedSurfaceArea(const int32_t &nodeIndex1, const int32_t &nodeIndex2) const
+  {
+    const auto &node1 = nodes[nodeIndex1], &node2 = nodes[nodeIndex2];
+    return getSurfaceArea(glm::min(node1.minCorner, node2.minCorner), glm::max(node1.maxCorner, node2.maxCorner));
+  }
+
+  /**
+   * Update the AABB and the height of the given node from its children.
+   * 
+   * @param nodeIndex  The index of the node.
+   */
+  void refitNode(const int32_t &nodeIndex)
+  {
+    auto &node = nodes[nodeIndex];
+    const auto &child1 = nodes[node.childIndex1], &child2 = nodes[node.childIndex2];
+    node.minCorner = glm::min(child1.minCorner, child2.minCorner);
+    node.maxCorner = glm::max(child1.maxCorner, child2.maxCorner);
+    node.height = 1 + glm::max(child1.height, child2.height);
+  }
+
+  /**
+   * Take a node out of the free nodes, or add a new one if there are none.
+   * 
+   * @return The index of the node.
+   */
+  int32_t allocateNode()
+  {
+    if (freeIndex == NULL_NODE)
+    {
+      nodes.push_back({glm::vec3(0.0f), glm::vec3(0.0f), nullptr, NULL_NODE, NULL_NODE, NULL_NODE, 0});
+      return static_cast<int32_t>(nodes.size() - 1);
+    }
+
+    const auto nodeIndex = freeIndex;
+    freeIndex = nodes[nodeIndex].parentIndex;
+    nodes[nodeIndex] = {glm::vec3(0.0f), glm::vec3(0.0f), nullptr, NULL_NODE, NULL_NODE, NULL_NODE, 0};
+    return nodeIndex;
+  }
+
+  /**
+   * Collect the models of all the leaves below the given node, which the tree is balanced enough to recurse into.
+   * 
+   * @param nodeIndex  The index of the node.
+   * @param models     Appended with the models of the leaves.
+   */
+  void collectLeaves(const int32_t &nodeIndex, std::vector<const ModelBaseIntf *> &models) const
+  {
+    const auto &node = nodes[nodeIndex];
+    if (node.childIndex1 == NULL_NODE)
+    {
+      models.push_back(node.model);
+      return;
+    }
+    collectLeaves(node.childIndex1, models);
+    collectLeaves(node.childIndex2, models);
+  }
+
+  /**
+   * Put the given node back into the free nodes.
+   * 
+   * @param nodeIndex  The index of the node.
+   */
+  void freeNode(const int32_t &nodeIndex)
+  {
+    nodes[nodeIndex].parentIndex = freeIndex;
+    nodes[nodeIndex].height = -1;
+    freeIndex = nodeIndex;
+  }
+
+  /**
+   * Point the parent of the given node to another node instead, or make that node the root if the given node has no parent.
+   * 
+   * @param nodeIndex     The index of the node being replaced.
+   * @param newNodeIndex  The index of the node replacing it.
+   */
+  void replaceChild(const int32_t &nodeIndex, const int32_t &newNodeIndex)
+  {
+    const auto parentIndex = nodes[nodeIndex].parentIndex;
+    nodes[newNodeIndex].parentIndex = parentIndex;
+    if (parentIndex == NULL_NODE)
+    {
+      rootIndex = newNodeIndex;
+    }
+    else if (nodes[parentIndex].childIndex1 == nodeIndex)
+    {
+      nodes[parentIndex].childIndex1 = newNodeIndex;
+    }
+    else
+    {
+      nodes[parentIndex].childIndex2 = newNodeIndex;
+    }
+  }
+
+  /**
+   * Rotate the grandchild of the given node from its taller side up, if one side is taller than the other by more than one.
+   * 
+   * @param nodeIndex  The index of the node.
+   * 
+   * @return The index of the node now in the place of the given node.
+   */
+  int32_t balanceNode(const int32_t &nodeIndex)
+  {
+    if (nodes[nodeIndex].height < 2)
+    {
+      return nodeIndex;
+    }
+
+    const auto childIndex1 = nodes[nodeIndex].childIndex1, childIndex2 = nodes[nodeIndex].childIndex2;
+    const auto balance = nodes[childIndex2].height - nodes[childIndex1].height;
+    if (balance >= -1 && balance <= 1)
+    {
+      return nodeIndex;
+    }
+
+    // Rotate the taller child up into the place of the node, with the node becoming its child.
+    const auto isSecondTaller = balance > 1;
+    const auto tallIndex = isSecondTaller ? childIndex2 : childIndex1;
+    const auto grandchildIndex1 = nodes[tallIndex].childIndex1, grandchildIndex2 = nodes[tallIndex].childIndex2;
+    replaceChild(nodeIndex, tallIndex);
+    nodes[tallIndex].childIndex1 = nodeIndex;
+    nodes[nodeIndex].parentIndex = tallIndex;
+
+    // Keep the taller grandchild under the rotated child, and give the shorter one to the node in place of the rotated child.
+    const auto isFirstGrandchildTaller = nodes[grandchildIndex1].height > nodes[grandchildIndex2].height;
+    const auto keptIndex = isFirstGrandchildTaller ? grandchildIndex1 : grandchildIndex2;
+    const auto movedIndex = isFirstGrandchildTaller ? grandchildIndex2 : grandchildIndex1;
+    nodes[tallIndex].childIndex2 = keptIndex;
+    (isSecondTaller ? nodes[nodeIndex].childIndex2 : nodes[nodeIndex].childIndex1) = movedIndex;
+    nodes[movedIndex].parentIndex = nodeIndex;
+
+    refitNode(nodeIndex);
+    refitNode(tallIndex);
+    return tallIndex;
+  }
+
+  /**
+   * Rebalance and refit the nodes from the given node up to the root.
+   * 
+   * @param nodeIndex  The index of the first node.
+   */
+  void refitAncestors(int32_t nodeIndex)
+  {
+    while (nodeIndex != NULL_NODE)
+    {
+      nodeIndex = balanceNode(nodeIndex);
+      refitNode(nodeIndex);
+      nodeIndex = nodes[nodeIndex].parentIndex;
+    }
+  }
+
+  /**
+   * Insert the given leaf into the tree, next to the node that grows the surface areas of the tree the least.
+   * 
+   * @param leafIndex  The index of the leaf.
+   */
+  void insertLeaf(const int32_t &leafIndex)
+  {
+    if (rootIndex == NULL_NODE)
+    {
+      rootIndex = leafIndex;
+      nodes[leafIndex].parentIndex = NULL_NODE;
+      return;
+    }
+
+    // Descend towards the cheapest sibling, where the cost of a node is the increase of the surface areas caused by adding the leaf.
+    auto siblingIndex = rootIndex;
+    while (nodes[siblingIndex].childIndex1 != NULL_NODE)
+    {
+      const auto &sibling = nodes[siblingIndex];
+      const auto combinedArea = getCombinedSurfaceArea(siblingIndex, leafIndex);
+      // The cost of making a new parent for the leaf and this node.
+      const auto cost = 2.0f * combinedArea;
+      // The cost every node below this one pays for the growth of this node.
+      const auto inheritedCost = 2.0f * (combinedArea - getSurfaceArea(sibling.minCorner, sibling.maxCorner));
+
+      float_t childCosts[2];
+      const int32_t childIndices[2] = {sibling.childIndex1, sibling.childIndex2};
+      for (auto i = 0; i < 2; i++)
+      {
+        const auto &child = nodes[childIndices[i]];
+        const auto childCombinedArea = getCombinedSurfaceArea(childIndices[i], leafIndex);
+        childCosts[i] = (child.childIndex1 == NULL_NODE ? childCombinedArea : childCombinedArea - getSurfaceArea(child.minCorner, child.maxCorner)) + inheritedCost;
+      }
+
+      if (cost < childCosts[0] && cost < childCosts[1])
+      {
+        break;
+      }
+      siblingIndex = childCosts[0] < childCosts[1] ? childIndices[0] : childIndices[1];
+    }
+
+    // Make a new parent for the leaf and the sibling, in the place of the sibling.
+    const auto parentIndex = allocateNode();
+    replaceChild(siblingIndex, parentIndex);
+    nodes[parentIndex].childIndex1 = siblingIndex;
+    nodes[parentIndex].childIndex2 = leafIndex;
+    nodes[siblingIndex].parentIndex = parentIndex;
+    nodes[leafIndex].parentIndex = parentIndex;
+
+    refitAncestors(parentIndex);
+  }
+
+  /**
+   * Remove the given leaf from the tree, replacing its parent with its sibling.
+   * 
+   * @param leafIndex  The index of the leaf.
+   */
+  void removeLeaf(const int32_t &leafIndex)
+  {
+    if (leafIndex == rootIndex)
+    {
+      rootIndex = NULL_NODE;
+      return;
+    }
+
+    const auto parentIndex = nodes[leafIndex].parentIndex;
+    const auto siblingIndex = nodes[parentIndex].childIndex1 == leafIndex ? nodes[parentIndex].childIndex2 : nodes[parentIndex].childIndex1;
+    const auto grandparentIndex = nodes[parentIndex].parentIndex;
+    replaceChild(parentIndex, siblingIndex);
+    freeNode(parentIndex);
+
+    refitAncestors(grandparentIndex);
+  }
+
+  /**
+   * Set the AABB of the given leaf to the given AABB fattened by the margin.
+   * 
+   * @param leafIndex  The index of the leaf.
+   * @param minCorner  The corner of the AABB with the smallest coordinates.
+   * @param maxCorner  The corner of the AABB with the largest coordinates.
+   */
+  void setFatBox(const int32_t &leafIndex, const glm::vec3 &minCorner, const glm::vec3 &maxCorner)
+  {
+    nodes[leafIndex].minCorner = minCorner - glm::vec3(FAT_MARGIN);
+    nodes[leafIndex].maxCorner = maxCorner + glm::vec3(FAT_MARGIN);
+  }
+
+public:
+  CollisionTree()
+      : nodes({}),
+        rootIndex(NULL_NODE),
+        freeIndex(NULL_NODE),
+        leafIndices({}),
+        nodeStack({}) {}
+
+  void insertCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) override
+  {
+    const auto leafIndex = allocateNode();
+    nodes[leafIndex].model = model;
+    setFatBox(leafIndex, minCorner, maxCorner);
+    leafIndices[model] = leafIndex;
+    insertLeaf(leafIndex);
+  }
+
+  void removeCollider(const ModelBaseIntf *model) override
+  {
+    const auto leafIndex = leafIndices.find(model);
+    if (leafIndex == leafIndices.end())
+    {
+      return;
+    }
+
+    removeLeaf(leafIndex->second);
+    freeNode(leafIndex->second);
+    leafIndices.erase(leafIndex);
+  }
+
+  void updateCollider(const ModelBaseIntf *model, const glm::vec3 &minCorner, const glm::vec3 &maxCorner) override
+  {
+    const auto leafIndex = leafIndices.find(model);
+    if (leafIndex == leafIndices.end())
+    {
+      return;
+    }
+
+    // Leave the tree as it is while the model stays inside its fattened AABB.
+    const auto &leaf = nodes[leafIndex->second];
+    if (glm::all(glm::lessThanEqual(leaf.minCorner, minCorner)) && glm::all(glm::greaterThanEqual(leaf.maxCorner, maxCorner)))
+    {
+      return;
+    }
+
+    removeLeaf(leafIndex->second);
+    setFatBox(leafIndex->second, minCorner, maxCorner);
+    insertLeaf(leafIndex->second);
+  }
+
+  void queryBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, std::vector<const ModelBaseIntf *> &models) override
+  {
+    if (rootIndex == NULL_NODE)
+    {
+      return;
+    }
+
+    // Descend into the nodes overlapping the AABB.
+    nodeStack.clear();
+    nodeStack.push_back(rootIndex);
+    while (!nodeStack.empty())
+    {
+      const auto &node = nodes[nodeStack.back()];
+      nodeStack.pop_back();
+      if (!haveBoxesOverlapped(node.minCorner, node.maxCorner, minCorner, maxCorner))
+      {
+        continue;
+      }
+
+      if (node.childIndex1 == NULL_NODE)
+      {
+        models.push_back(node.model);
+        continue;
+      }
+      nodeStack.push_back(node.childIndex1);
+      nodeStack.push_back(node.childIndex2);
+    }
+  }
+
+  void queryRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, std::vector<const ModelBaseIntf *> &models) override
+  {
+    if (rootIndex == NULL_NODE)
+    {
+      return;
+    }
+
+    // Descend into the nodes the ray hits.
+    nodeStack.clear();
+    nodeStack.push_back(rootIndex);
+    while (!nodeStack.empty())
+    {
+      const auto &node = nodes[nodeStack.back()];
+      nodeStack.pop_back();
+      if (getRayBoxDistance(node.minCorner, node.maxCorner, origin, direction, maxDistance) < 0.0f)
+      {
+        continue;
+      }
+
+      if (node.childIndex1 == NULL_NODE)
+      {
+        models.push_back(node.model);
+        continue;
+      }
+      nodeStack.push_back(node.childIndex1);
+      nodeStack.push_back(node.childIndex2);
+    }
+  }
+
+  /**
+   * Find the models whose leaves are inside the given frustum. The leaves below a node fully inside the frustum are taken without
+   *   testing them, so that the query takes time by the models found rather than by all the models.
+   * 
+   * @param frustum            The frustum.
+   * @param containedModels    Appended with the models whose fattened AABBs are fully inside the frustum.
+   * @param intersectedModels  Appended with the models whose fattened AABBs cross the planes of the frustum, which may be outside of it.
+   */
+  void queryFrustum(const Frustum &frustum, std::vector<const ModelBaseIntf *> &containedModels, std::vector<const ModelBaseIntf *> &intersectedModels)
+  {
+    if (rootIndex == NULL_NODE)
+    {
+      return;
+    }
+
+    // Descend into the nodes crossing the planes of the frustum, and take all the leaves of the nodes inside it.
+    nodeStack.clear();
+    nodeStack.push_back(rootIndex);
+    while (!nodeStack.empty())
+    {
+      const auto nodeIndex = nodeStack.back();
+      const auto &node = nodes[nodeIndex];
+      nodeStack.pop_back();
+      if (!frustum.isBoxInside(node.minCorner, node.maxCorner))
+      {
+        continue;
+      }
+
+      if (frustum.isBoxContained(node.minCorner, node.maxCorner))
+      {
+        collectLeaves(nodeIndex, containedModels);
+        continue;
+      }
+      if (node.childIndex1 == NULL_NODE)
+      {
+        intersectedModels.push_back(node.model);
+        continue;
+      }
+      nodeStack.push_back(node.childIndex1);
+      nodeStack.push_back(node.childIndex2);
+    }
+  }
+
+  /**
+   * Find the models whose leaves overlap the given sphere (e.g. the range of a light).
+   * 
+   * @param center  The center of the sphere.
+   * @param radius  The radius of the sphere.
+   * @param models  Appended with the models whose fattened AABBs overlap the sphere.
+   */
+  void querySphere(const glm::vec3 &center, const float_t &radius, std::vector<const ModelBaseIntf *> &models)
+  {
+    if (rootIndex == NULL_NODE)
+    {
+      return;
+    }
+
+    // Descend into the nodes whose point closest to the center of the sphere is within the radius.
+    nodeStack.clear();
+    nodeStack.push_back(rootIndex);
+    while (!nodeStack.empty())
+    {
+      const auto &node = nodes[nodeStack.back()];
+      nodeStack.pop_back();
+      const auto offset = glm::clamp(center, node.minCorner, node.maxCorner) - center;
+      if (glm::dot(offset, offset) > radius * radius)
+      {
+        continue;
+      }
+
+      if (node.childIndex1 == NULL_NODE)
+      {
+        models.push_back(node.model);
+        continue;
+      }
+      nodeStack.push_back(node.childIndex1);
+      nodeStack.push_back(node.childIndex2);
+    }
+  }
+
+  void queryPairs(std::vector<std::pair<const ModelBaseIntf *, const ModelBaseIntf *>> &pairs) override
+  {
+    // Query the tree with every leaf, keeping each pair only from the leaf with the smaller index.
+    for (const auto &leafIndex : leafIndices)
+    {
+      const auto &leaf = nodes[leafIndex.second];
+      nodeStack.clear();
+      nodeStack.push_back(rootIndex);
+      while (!nodeStack.empty())
+      {
+        const auto nodeIndex = nodeStack.back();
+        const auto &node = nodes[nodeIndex];
+        nodeStack.pop_back();
+        if (!haveBoxesOverlapped(node.minCorner, node.maxCorner, leaf.minCorner, leaf.maxCorner))
+        {
+          continue;
+        }
+
+        if (node.childIndex1 == NULL_NODE)
+        {
+          if (nodeIndex > leafIndex.second)
+          {
+            pairs.push_back({leaf.model, node.model});
+          }
+          continue;
+        }
+        nodeStack.push_back(node.childIndex1);
+        nodeStack.push_back(node.childIndex2);
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef INCLUDE_COMMAND_LINE_CPP
+#define INCLUDE_COMMAND_LINE_CPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <stdlib.h>
+#elif defined(__APPLE__)
+#include <crt_externs.h>
+#else
+#include <fstream>
+#endif
+
+#include <glm/glm.hpp>
+
+/**
+ * Class for reading the command line the program was started with while the singletons are constructed, before main() gets
+ *   its arguments, for the few options the singletons are created with (like the headless window).
+ */
+class CommandLine
+{
+public:
+  /**
+   * Get the arguments the program was started with, without the program name.
+   * 
+   * @return The arguments.
+   */
+  static std::vector<std::string> getArguments()
+  {
+    std::vector<std::string> arguments({});
+#ifdef _WIN32
+    // The C runtime parses the command line before the static objects are constructed.
+    for (int i = 1; i < __argc; i++)
+    {
+      arguments.push_back(__argv[i]);
+    }
+#elif defined(__APPLE__)
+    const auto argumentsCount = *_NSGetArgc();
+    const auto argumentValues = *_NSGetArgv();
+    for (int i = 1; i < argumentsCount; i++)
+    {
+      arguments.push_back(argumentValues[i]);
+    }
+#else
+    // The arguments are kept by the kernel separated by null characters, the program name first.
+    std::ifstream stream("/proc/self/cmdline", std::ios::binary);
+    std::string argument;
+    auto isProgramName = true;
+    while (std::getline(stream, argument, '\0'))
+    {
+      if (!isProgramName)
+      {
+        arguments.push_back(argument);
+      }
+      isProgramName = false;
+    }
+#endif
+    return arguments;
+  }
+
+  /**
+   * Parse a size given as its width and height, like "1920x1080".
+   * 
+   * @param value  The value of the argument.
+   * @param size   The size parsed.
+   * 
+   * @return Whether the value is a valid size.
+   */
+  static bool parseSize(const std::string &value, glm::ivec2 &size)
+  {
+    return std::sscanf(value.c_str(), "%dx%d", &size.x, &size.y) == 2 && size.x > 0 && size.y > 0;
+  }
+};
+
+#endif
@@ -9,86 +9,92 @@
 
 #include <GL/glew.h>
 
+#include "gl_stats.cpp"
+
 /**
- * Class for storing the vertex attribute array information.
+ * Class for describing vertex attributes in vertex array objects, which store the attribute layout of a mesh
+ *   so that it is only described once, and drawing only has to bind the vertex array object.
  */
-class VertexAttributeArray
+class VertexArray
 {
-private:
-  // The set of attribute IDs already in use.
-  static std::set<GLuint> attributeIds;
-
-  // The ID of the attribute.
-  const GLuint attributeId;
-  // The name of the attribute.
-  const std::string attributeName;
-  // The ID of the buffer the attribute is linked to.
-  const GLuint bufferId;
-  // The size of the elements in the buffer.
-  const uint32_t bufferElementSize;
-  // The type of the attribute data
-  const GLenum attributeType;
+public:
+  // The fixed attribute IDs of the vertex data of meshes (matching the locations in the shaders).
+  const static GLuint POSITION_ATTRIBUTE_ID;
+  const static GLuint UV_ATTRIBUTE_ID;
+  const static GLuint NORMAL_ATTRIBUTE_ID;
 
   /**
-   * Creates a new attribute ID for the current attribute to use.
+   * Create a new vertex array object, and bind it so that attributes can be described in it.
    * 
-   * @return The attribute ID.
+   * @return The ID of the vertex array object.
    */
-  GLuint createAttributeId()
+  static GLuint createVertexArray()
   {
-    // Get the maximum possible attribute ID that can be used.
-    const GLuint maxId = std::numeric_limits<GLuint>::max();
-    // Iterate through all possible attribute IDs that can be used.
-    for (GLuint i = 0; i < maxId; i++)
-    {
-      // Check if the atribute ID is being used.
-      if (attributeIds.find(i) == attributeIds.end())
-      {
-        // The attribute ID is available. Return it for use.
-        return i;
-      }
-    }
-
-    // Could not get an available attribute ID. Time to crash.
-    std::cout << "Failed at vertex attribute array" << std::endl;
-    exit(1);
-  }
-
-public:
-  // Preventing copying the vertex attribute array, making sure only one instance can exist.
-  VertexAttributeArray(const VertexAttributeArray &) = delete;
-
-  VertexAttributeArray(const std::string &attributeName, const GLuint &bufferId, const uint32_t &bufferElementSize, const GLenum &attributeType = GL_FLOAT)
-      : attributeId(createAttributeId()),
-        attributeName(attributeName),
-        bufferId(bufferId),
-        bufferElementSize(bufferElementSize),
-        attributeType(attributeType)
-  {
-    // Insert it to the set of attribute IDs being used.
-    attributeIds.insert(attributeId);
-  }
-
-  ~VertexAttributeArray()
-  {
-    // Delete the attribute ID from the set of used IDs.
-    attributeIds.erase(attributeId);
-    // Disable the vertex attribute array from being used by the GPU.
-    glDisableVertexAttribArray(attributeId);
+    // Define a variable for storing the vertex array ID.
+    GLuint vertexArrayId;
+    // Create a new vertex array object and store the ID.
+    glGenVertexArrays(1, &vertexArrayId);
+    // Bind the vertex array object.
+    GlCalls::bindVertexArray(vertexArrayId);
+    // Return the ID of the created vertex array object.
+    return vertexArrayId;
   }
 
-  void enableAttribute()
+  /**
+   * Enable the given attribute in the bound vertex array object, and link it to the given buffer.
+   * 
+   * @param attributeId        The ID of the attribute (its location in the shaders).
+   * @param bufferId           The ID of the buffer the attribute is linked to.
+   * @param bufferElementSize  The number of components of the elements in the buffer.
+   * @param attributeType      The type of the components of the attribute data.
+   * @param attributeDivisor   The number of instances that share each element of the attribute (0 if the element advances per vertex).
+   * @param bufferStride       The byte offset between consecutive elements in the buffer (0 if the elements are tightly packed).
+   * @param bufferOffset       The byte offset of the first element in the buffer.
+   * @param isNormalized       Whether integer components are mapped to the [0, 1] (or [-1, 1] when signed) range, instead of read as whole numbers.
+   */
+  static void enableAttribute(const GLuint &attributeId,
+                              const GLuint &bufferId,
+                              const GLint &bufferElementSize,
+                              const GLenum &attributeType = GL_FLOAT,
+                              const GLuint &attributeDivisor = 0,
+                              const GLsizei &bufferStride = 0,
+                              const size_t &bufferOffset = 0,
+                              const GLboolean &isNormalized = GL_FALSE)
   {
     // Enable the vertex attribute array for being used by the GPU.
     glEnableVertexAttribArray(attributeId);
     // Bind the buffer as the array buffer the vertex attribute will link with.
     glBindBuffer(GL_ARRAY_BUFFER, bufferId);
     // Define the details regarding the vertex attribute list stored in the array buffer.
-    glVertexAttribPointer(attributeId, bufferElementSize, attributeType, GL_FALSE, 0, (void *)0);
+    // Integer attributes must use the integer variant, otherwise their values are converted to floats.
+    if ((attributeType == GL_INT || attributeType == GL_UNSIGNED_INT) && isNormalized == GL_FALSE)
+    {
+      glVertexAttribIPointer(attributeId, bufferElementSize, attributeType, bufferStride, (void *)bufferOffset);
+    }
+    else
+    {
+      glVertexAttribPointer(attributeId, bufferElementSize, attributeType, isNormalized, bufferStride, (void *)bufferOffset);
+    }
+    // Define how many instances share each element of the vertex attribute.
+    glVertexAttribDivisor(attributeId, attributeDivisor);
+  }
+
+  /**
+   * Disable the given attribute in the bound vertex array object.
+   * 
+   * @param attributeId  The ID of the attribute (its location in the shaders).
+   */
+  static void disableAttribute(const GLuint &attributeId)
+  {
+    glDisableVertexAttribArray(attributeId);
   }
 };
 
-// Initialize the set of used attribute IDs to an empty set.
-std::set<GLuint> VertexAttributeArray::attributeIds = std::set<GLuint>({});
+// Initialize the fixed attribute ID of the vertex positions static variable.
+const GLuint VertexArray::POSITION_ATTRIBUTE_ID = 0;
+// Initialize the fixed attribute ID of the vertex UV coordinates static variable.
+const GLuint VertexArray::UV_ATTRIBUTE_ID = 1;
+// Initialize the fixed attribute ID of the vertex normal vectors static variable.
+const GLuint VertexArray::NORMAL_ATTRIBUTE_ID = 2;
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_CONSTANTS_CPP
 #define INCLUDE_CONSTANTS_CPP
 
+#include <array>
+
 /**
  * A bunch of constants that's required to be known globally.
  */
@@ -8,11 +10,406 @@
 const int32_t WINDOW_WIDTH = 1024;
 const int32_t WINDOW_HEIGHT = 768;
 const float_t ASPECT_RATIO = WINDOW_WIDTH / WINDOW_HEIGHT;
-const int32_t MAX_CONE_LIGHTS = 2;
-const int32_t MAX_POINT_LIGHTS = 5;
-const int32_t MAX_LIGHTS = MAX_CONE_LIGHTS + MAX_POINT_LIGHTS;
+// The default size a headless window is rendered at offscreen ("--headless" without a size).
+const int32_t HEADLESS_WIDTH = 1920;
+const int32_t HEADLESS_HEIGHT = 1080;
+// The number of frames the GPU may still be working on once a frame is swapped before the CPU starts on the next one (set
+//   with "--frames-in-flight N"), and the most it can be set to. Fewer frames in flight means less input latency, at the cost
+//   of the CPU waiting on the GPU.
+const uint32_t DEFAULT_MAX_FRAMES_IN_FLIGHT = 2;
+const uint32_t MAX_FRAMES_IN_FLIGHT_LIMIT = 3;
+// The largest numbers of cone and point lights of a frame, which can be raised by the build (e.g. with
+//   -DENGINE_MAX_POINT_LIGHTS=8). They size the uniform blocks of the frame, so they go through the engine limits below.
+#ifndef ENGINE_MAX_CONE_LIGHTS
+#define ENGINE_MAX_CONE_LIGHTS 2
+#endif
+#ifndef ENGINE_MAX_POINT_LIGHTS
+#define ENGINE_MAX_POINT_LIGHTS 5
+#endif
+
+/**
+ * Types of the lights whose arrays are sized by the engine limits.
+ */
+enum class LightLimitType
+{
+  CONE,
+  POINT
+};
+
+/**
+ * Structure for defining the largest number of lights of a type in a frame, and the name of its definition in the shaders.
+ */
+template <LightLimitType type>
+struct LightLimit;
+
+template <>
+struct LightLimit<LightLimitType::CONE>
+{
+  static constexpr int32_t MAX_COUNT = ENGINE_MAX_CONE_LIGHTS;
+  static constexpr const char *SHADER_DEFINE = "MAX_SIMPLE_LIGHTS";
+};
+
+template <>
+struct LightLimit<LightLimitType::POINT>
+{
+  static constexpr int32_t MAX_COUNT = ENGINE_MAX_POINT_LIGHTS;
+  static constexpr const char *SHADER_DEFINE = "MAX_CUBE_LIGHTS";
+};
+
+// An array with an element for each of the lights of a type a frame can have.
+template <typename T, LightLimitType type>
+using LightArray = std::array<T, LightLimit<type>::MAX_COUNT>;
+
+/**
+ * Structure for defining the limits the engine shares with its shaders, which the shader manager defines in every shader it
+ *   compiles, so that the sizes of the arrays on both sides always match.
+ */
+struct EngineLimits
+{
+  // The largest numbers of lights of a frame.
+  static constexpr int32_t MAX_CONE_LIGHTS = LightLimit<LightLimitType::CONE>::MAX_COUNT;
+  static constexpr int32_t MAX_POINT_LIGHTS = LightLimit<LightLimitType::POINT>::MAX_COUNT;
+  static constexpr int32_t MAX_LIGHTS = MAX_CONE_LIGHTS + MAX_POINT_LIGHTS;
+  // The lights of the uniform block of the shadowmap shaders, enough for the point lights (MAX_SHADOW_LIGHTS in the shaders).
+  static constexpr int32_t MAX_SHADOW_LIGHTS = MAX_POINT_LIGHTS;
+  // The vertices the point light geometry shader emits at most, a triangle for each face of each light.
+  static constexpr int32_t POINT_SHADOW_MAX_VERTICES = MAX_SHADOW_LIGHTS * 6 * 3;
+  // The layers of the shadow mask, enough for a channel per light with a shadowmap (four per layer).
+  static constexpr int32_t SHADOW_MASK_LAYERS_COUNT = (MAX_LIGHTS + 3) / 4;
+  // The largest number of levels of detail of an object (LOD_COUNT in the shaders).
+  static constexpr uint32_t OBJECT_LOD_COUNT = 4;
+};
+
+// The light masks of the models keep the bits of the cone lights in their first byte, and the ones of the point lights in the next.
+static_assert(EngineLimits::MAX_CONE_LIGHTS <= 8 && EngineLimits::MAX_POINT_LIGHTS <= 8, "The lights of each type must fit a byte of the light masks");
+
+const int32_t MAX_CONE_LIGHTS = EngineLimits::MAX_CONE_LIGHTS;
+const int32_t MAX_POINT_LIGHTS = EngineLimits::MAX_POINT_LIGHTS;
+const int32_t MAX_LIGHTS = EngineLimits::MAX_LIGHTS;
 const int32_t MAX_TEXT_LENGTH = 80;
+// The largest number of worker threads running the parallel loops (such as the model updates) along with the main thread.
+const uint32_t MAX_JOB_WORKER_THREADS = 7;
+// The number of tasks the worker threads can queue for the main thread without a lock, before the ones after them are queued
+//   behind a lock until the main thread catches up (and the number of GL objects they can retire the same way).
+const size_t MAIN_THREAD_QUEUE_CAPACITY = 1024;
+// The time the tasks queued for the main thread are run for in each frame, the tasks left over waiting for the next frames
+//   (in seconds).
+const double_t MAIN_THREAD_TASKS_TIME_BUDGET = 0.002;
+// The number of models updated by each job of the parallel model update, which the threads take and steal one at a time.
+const size_t MODEL_UPDATE_JOB_SIZE = 64;
+// The number of zones each thread can record for the CPU profiler between two frames, before the oldest ones are overwritten.
+const size_t CPU_PROFILER_RECORDS_PER_THREAD = 16384;
+// The time a trace capture of the profiler runs for, unless it is stopped before (in seconds).
+const double_t TRACE_CAPTURE_DURATION = 10.0;
+// The directory the trace captures are written to, as Chrome Trace Event JSON files.
+const char *const TRACE_CAPTURE_DIRECTORY = "traces/";
+// The number of the last frames kept by the capture watching for hitches, written out along with the frame over the budget.
+const size_t HITCH_CAPTURE_FRAMES = 8;
+// The directory the telemetry logs of the sessions are written to, as CSV files of a row per second.
+const char *const TELEMETRY_DIRECTORY = "telemetry/";
+// The number of frames the telemetry can queue for its log thread, beyond which the frames are dropped.
+const size_t TELEMETRY_QUEUE_CAPACITY = 1024;
+// The time the telemetry log thread waits between draining the queued frames (in seconds).
+const double_t TELEMETRY_DRAIN_INTERVAL = 0.1;
+// The number of rows (seconds) of a telemetry log file before the log moves on to a new file, and the number of files kept.
+const uint32_t TELEMETRY_ROWS_PER_FILE = 3600;
+const uint32_t TELEMETRY_FILES_KEPT = 24;
+// The number of pixel buffers the captured frames are read back into, used in turn, so that each frame is mapped a couple of
+//   frames after it is read instead of waiting for the GPU.
+const uint32_t FRAME_CAPTURE_READBACK_BUFFERS = 3;
+// The number of captured frames that can wait to be written by the worker threads, beyond which the frames read back are dropped.
+const uint32_t FRAME_CAPTURE_WRITE_BUFFERS = 8;
+// The directory the screenshots and the continuous frame captures are written to, as BMP files.
+const char *const FRAME_CAPTURE_DIRECTORY = "captures/";
+// Whether the allocations made inside the zones marked with NO_ALLOC_ZONE are flagged (counted in the debug text and reported
+//   once per zone), when the build tracks the allocations.
+const bool IS_NO_ALLOC_ZONE_CHECK_ENABLED = true;
+// The number of no-alloc zones remembered as reported, beyond which the zones are not reported again.
+const size_t NO_ALLOC_REPORTED_ZONES_COUNT = 16;
+// Whether the window is created with a debug context, whose messages (the errors and the performance warnings of the driver)
+//   are counted in the debug text and reported, and whose GL objects are labeled with the names of their assets for the GPU
+//   debuggers. The debug contexts of some drivers are slower, so it is off unless the GL calls are being looked into.
+const bool IS_GL_DEBUG_CONTEXT_ENABLED = false;
+// The number of distinct GL debug messages reported, beyond which the new ones are only counted.
+const size_t GL_DEBUG_REPORTED_MESSAGES_COUNT = 64;
+// The number of transforms rebuilt by each job of the parallel world transform update.
+const size_t TRANSFORM_UPDATE_JOB_SIZE = 256;
+// The number of models tested against the view frustum by each job of the parallel culling pass.
+const size_t MODEL_CULL_JOB_SIZE = 256;
+// The length of a step of the fixed-step simulation of the game scene (in seconds), so that the simulation costs the same
+//   however many frames are rendered.
+const double_t SIMULATION_STEP_TIME = 1.0 / 60.0;
+// The most steps of the fixed-step simulation run in a single frame to catch up with the real time, beyond which the steps are dropped.
+const uint32_t MAX_SIMULATION_STEPS_PER_FRAME = 5;
+// Whether the cursor is sampled again right before the cameras are updated, so that the view follows the mouse movement made
+//   while the frame was simulated (not while the input of a session is recorded or replayed, which is sampled once per frame).
+const bool IS_LATE_CURSOR_SAMPLING_ENABLED = true;
+// Whether the menus show the cursor image as a hardware cursor, instead of drawing a cursor model following the cursor, and the
+//   size the image is scaled down to for it (in pixels).
+const bool IS_HARDWARE_CURSOR_ENABLED = true;
+const int32_t HARDWARE_CURSOR_SIZE = 32;
+// Whether the game scene is rendered on a dedicated thread owning the GL context, from the render packets filled by the main thread.
+//   The models must not create GL resources while the scene runs in this mode (the shots and their lights are pooled up front).
+const bool IS_RENDER_THREAD_ENABLED = false;
+// Whether the images of the BMP textures are uploaded by a thread of their own, with a hidden context shared with the window, so
+//   that the large uploads do not block the frames rendered while they load.
+const bool IS_UPLOAD_CONTEXT_ENABLED = true;
+// The number of render packets the main thread can fill ahead of the render thread (2 lets the next frame be simulated while the
+//   last one is rendered).
+const size_t RENDER_PACKET_RING_SIZE = 2;
+// The size of each region of the stream buffer the data written anew every frame is allocated from (in bytes), and the number of
+//   regions, each written by one frame while the GPU may still read the others.
+const size_t STREAM_BUFFER_REGION_SIZE = 8 * 1024 * 1024;
+const uint32_t STREAM_BUFFER_REGIONS = 3;
+// The number of shots (and their lights) created up front, so that firing reuses them instead of creating new ones.
+const uint32_t SHOT_POOL_SIZE = 32;
 const int32_t MAX_TEXT_CHARS = 10240;
+// The number of bytes of text the text arena of a frame holds (the text beyond it is cut off), and the number of text lines it
+//   has room for up front.
+const size_t TEXT_ARENA_SIZE = 16 * 1024;
+const size_t TEXT_ARENA_LINES = 256;
+// The width of the text glyph atlas, and the height it starts at and can grow up to (in texels).
+const int32_t TEXT_ATLAS_WIDTH = 512;
+const int32_t TEXT_ATLAS_INITIAL_HEIGHT = 128;
+const int32_t TEXT_ATLAS_MAX_HEIGHT = 4096;
+// The gap kept around the glyphs packed into the text glyph atlas (in texels).
+const int32_t TEXT_ATLAS_GLYPH_PADDING = 1;
+// Whether the glyphs are rasterized as signed distance fields, which stay crisp at any scale, instead of as coverage at the
+//   text height.
+const bool IS_TEXT_SDF_ENABLED = true;
+// The size the distance field glyphs are rasterized at, and how far their distance fields reach past the edges (in pixels).
+const int32_t TEXT_SDF_FONT_SIZE = 24;
+const int32_t TEXT_SDF_SPREAD = 4;
+// The number of code points looked up in the flat glyph table of the text font without a lock (the first ones, covering
+//   Latin-1), and the number of text lines whose glyph instances are kept for the frames laying out the same text again.
+const uint32_t TEXT_GLYPH_TABLE_SIZE = 256;
+const size_t TEXT_LAYOUT_CACHE_SIZE = 64;
+// The number of times a second the HUD stats are formatted from the counters sampled since the last time (in Hz), and the number
+//   of characters all of their lines can take up.
+const double_t HUD_STATS_REFRESH_RATE = 4.0;
+const size_t HUD_STATS_CHAR_BUDGET = 2048;
+// The sizes that unreferenced resources can take while being kept alive for reuse (in bytes, or programs for the shaders).
+const uint64_t OBJECT_RESIDENCY_BUDGET = 64 * 1024 * 1024;
+const uint64_t TEXTURE_RESIDENCY_BUDGET = 256 * 1024 * 1024;
+const uint64_t SHADER_RESIDENCY_BUDGET = 32;
+// The number of compiled shaders kept alive once no program is linking with them, so that the programs sharing a stage (e.g. the
+//   vertex shader of the fullscreen passes) compile it once.
+const uint64_t SHADER_STAGE_RESIDENCY_BUDGET = 32;
+// Whether the shaders that only read uniform blocks (the shadow passes of the lights) link each of their stages as a separable
+//   program shared by all of them, combined by program pipelines (when the driver has separate shader objects).
+const bool IS_SEPARATE_SHADER_STAGES_ENABLED = true;
+// Whether the objects keep the positions of their vertices in system memory once they are uploaded. Nothing needs them by
+//   default, since the colliders are created from the collider prototypes of the objects.
+const bool IS_OBJECT_GEOMETRY_KEPT = false;
+// The size the files of the assets preloaded for the likely-next scene can take together (in bytes).
+const uint64_t SCENE_PRELOAD_BUDGET = 64 * 1024 * 1024;
+// The size the resident mip levels of the streamed textures can take in GPU memory together (in bytes), and the largest side of
+//   the mip level they start at before any model using them is drawn (in texels).
+const uint64_t TEXTURE_STREAMING_BUDGET = 128 * 1024 * 1024;
+const uint32_t TEXTURE_STREAMING_INITIAL_SIZE = 64;
+// The texels along the largest side of a texture needed for each pixel of the projected height of the models using it.
+const float_t TEXTURE_STREAMING_TEXELS_PER_PIXEL = 1.0f;
+// The number of updates the top mip level of a streamed texture has to go unneeded for before it is dropped (unless the
+//   streamed textures are over their budget), so that the levels of models moving back and forth are not streamed again.
+const uint32_t TEXTURE_STREAMING_DROP_DELAY = 120;
+// Whether the diffuse textures of the same format and size share texture arrays, which the model shaders pick them from by a
+//   per-instance layer, so that the models of different types can be drawn with the same texture bound. The textures in the
+//   arrays are always fully resident, without their mip levels streamed.
+const bool IS_TEXTURE_ARRAY_BATCHING_ENABLED = false;
+// The most layers a shared texture array grows to (doubling each time it is full).
+const uint32_t TEXTURE_ARRAY_MAX_LAYERS = 64;
+// Whether the mip chains of the BMP textures are generated on the worker threads instead of by the driver, and uploaded through
+//   their pixel buffer objects a few levels at a time from the smallest one, so that the textures show their smaller levels while
+//   the larger ones are still uploading. The BMP textures then skip the upload context.
+const bool IS_CPU_MIP_GENERATION_ENABLED = true;
+// The number of rows of a mip level filtered by each mip generation task, and the size of the mip levels uploaded by each update
+//   of the streaming textures (in bytes, at least one level being uploaded by each update).
+const uint32_t MIP_GENERATION_TILE_ROWS = 64;
+const uint64_t MIP_UPLOAD_BUDGET = 4 * 1024 * 1024;
+// Whether the window asks for an OpenGL 4.3 context (falling back to OpenGL 3.3 if the driver does not have it), so that the
+//   models can be culled by a compute shader and each model group drawn with a single indirect multi-draw.
+const bool IS_GPU_DRIVEN_RENDERING_ENABLED = true;
+// The number of instances culled by each work group of the GPU culling compute shader (matches the local size in the shader).
+const uint32_t GPU_CULLING_WORK_GROUP_SIZE = 64;
+// The widest level of the depth pyramid of the occlusion culling read back from the GPU (the rest of the pyramid is reduced on
+//   the CPU), the number of readbacks in flight at once, and the depth a box has to be behind the pyramid by to be hidden.
+const int32_t HI_Z_READBACK_WIDTH = 128;
+const uint32_t HI_Z_READBACK_BUFFERS = 3;
+const float_t HI_Z_DEPTH_BIAS = 0.0001f;
+// The number of readbacks of the model picking in flight at once, each reading back the ID of the model under a point of the
+//   screen a frame (or a few) after it was requested.
+const uint32_t PICKING_READBACK_BUFFERS = 3;
+// The number of the lowest render layers drawn into the layer cache when a scene enables it, so that they are only drawn again
+//   when their models change, at most at the given rate (in times per second), and composited under the other layers every frame.
+const uint32_t CACHED_RENDER_LAYERS_COUNT = 1;
+const double LAYER_CACHE_REFRESH_RATE = 15.0;
+// Whether the shots are tested against the enemies by a compute shader instead of the collision pass, when the OpenGL 4.3
+//   context of the GPU-driven rendering is available. The hits are read back without waiting for the GPU, so they reach the
+//   shots a frame (or a few) after the shots touched the enemies.
+const bool IS_GPU_SHOT_COLLISION_ENABLED = true;
+// The number of shots tested by each work group of the shot collision compute shader (matches the local size in the shader),
+//   the most shots tested by the GPU at once (the shots spawned beyond them are left to the collision pass), the most hits
+//   recorded by a dispatch, and the number of hit readbacks in flight at once.
+const uint32_t GPU_SHOT_COLLISION_WORK_GROUP_SIZE = 64;
+const uint32_t GPU_SHOT_COLLISION_MAX_SHOTS = 256;
+const uint32_t GPU_SHOT_COLLISION_MAX_HITS = 256;
+const uint32_t GPU_SHOT_COLLISION_READBACK_BUFFERS = 3;
+// Whether the collision pass of each simulation step of the game runs on a worker thread, overlapping the rest of the frame, its
+//   events reaching the models at the start of the next step (a step late) instead of right away.
+const bool IS_COLLISION_PIPELINE_ENABLED = true;
+// The number of collision passes a dynamic collider has to go through without moving before it falls asleep, so that the models
+//   moving now and then do not keep waking up and falling asleep.
+const uint32_t COLLISION_SLEEP_PASSES = 2;
+// The largest number of levels of detail of an object (including the full detail one), and the fewest triangles an object
+//   needs to get the simplified levels generated when it is loaded.
+const uint32_t OBJECT_LOD_COUNT = EngineLimits::OBJECT_LOD_COUNT;
+const uint32_t OBJECT_LOD_MIN_TRIANGLES = 2048;
+// The share of the triangles of the level before each simplified level is made with, and the largest error a simplification
+//   may introduce (as a share of the bounding radius of the object).
+const float_t OBJECT_LOD_TRIANGLE_RATIO = 0.35f;
+const float_t OBJECT_LOD_MAX_ERROR = 0.05f;
+// The projected sizes below which the models switch to each simplified level (the diameter of the world AABB of the model as
+//   a share of the height of the view), and the scale of the projected sizes in the shadow passes, so that the shadow casters
+//   switch earlier.
+const float_t OBJECT_LOD_SCREEN_SIZES[OBJECT_LOD_COUNT - 1] = {0.25f, 0.1f, 0.04f};
+const float_t SHADOW_LOD_SCREEN_SIZE_SCALE = 0.4f;
+// The projected size below which the models of the model types drawn with impostors switch to the billboards baked from their
+//   object (see OBJECT_LOD_SCREEN_SIZES), the size of the impostor atlases (in texels), and the number of views baked into them
+//   around the up axis of the objects and from below to above them.
+const float_t IMPOSTOR_SCREEN_SIZE = 0.02f;
+const int32_t IMPOSTOR_ATLAS_SIZE = 512;
+const uint32_t IMPOSTOR_YAW_VIEWS = 8;
+const uint32_t IMPOSTOR_PITCH_VIEWS = 4;
+// The fewest triangles the visible models of a model group have to be drawn with for the group to be drawn behind an occlusion
+//   query of the union of their world AABBs, the most visible models it can have for the union to stay tight, the number of
+//   frames the queries are kept around for their results to be read back without waiting, and the number of queries read back
+//   the hit rates of the model types follow.
+const uint32_t OCCLUSION_QUERY_MIN_TRIANGLES = 20000;
+const uint32_t OCCLUSION_QUERY_MAX_INSTANCES = 4;
+const uint32_t OCCLUSION_QUERY_FRAMES = 3;
+const uint32_t OCCLUSION_QUERY_STATS_WINDOW = 120;
+// The number of vertices of the post-transform vertex cache the triangles of the objects are reordered for, and how close the
+//   cache misses of a cluster of triangles have to get to the ones of its run for the cluster to be reordered for overdraw.
+const int32_t MESH_OPTIMIZER_CACHE_SIZE = 16;
+const float_t MESH_OVERDRAW_THRESHOLD = 1.05f;
+// The smallest tile of the shadow atlas a cone light can get (the other shadowmap sizes are set by the render config).
+const int32_t CONE_LIGHT_MIN_SHADOW_MAP_SIZE = 128;
+// The steps the fitted projections of the cone lights are snapped to (across the angles and the depth of the full projection),
+//   how much smaller than its fit the models of a light have to get for the fit to shrink, and the padding of the world AABBs of
+//   the models kept inside the fits, for the models drawn interpolated between the last two steps.
+const float_t SHADOW_FIT_ANGLE_STEPS = 32.0f;
+const float_t SHADOW_FIT_DEPTH_STEPS = 64.0f;
+const float_t SHADOW_FIT_SHRINK_RATIO = 1.25f;
+const float_t SHADOW_FIT_BOX_MARGIN = 0.5f;
+// The weight the shadow mask of the last frame is blended with when the shadow mask is filtered over time, which the shadow mask
+//   converges to the average of the taps of the frames with (closer to 1 is smoother, but slower to follow moving shadows).
+const float_t TEMPORAL_SHADOW_HISTORY_WEIGHT = 0.85f;
+// The size the moments of the shadowmaps filtered as variance shadow maps are kept at (a fraction of the shadowmap size),
+//   and the number of mip levels they are filtered across, few enough that the smallest tiles of the cone light atlas are
+//   not blended together.
+const int32_t SHADOW_MOMENT_MAP_DOWNSCALE = 2;
+const int32_t SHADOW_MOMENT_MIP_LEVELS = 4;
+// The number of outdated point light shadowmap faces rendered per frame while the shadowmap updates are amortized.
+const uint32_t POINT_LIGHT_SHADOW_FACES_PER_FRAME = 12;
+// The number of lights shaded with shadows per light type, and the number of point lights shaded at all, for each quality preset (low, medium, high, ultra).
+// The lights are picked by their estimated contribution to the view, so that bursts of lights cannot spike the frame time.
+const int32_t QUALITY_PRESETS_COUNT = 4;
+const int32_t DEFAULT_QUALITY_PRESET = 2;
+const int32_t SHADOWED_CONE_LIGHTS[QUALITY_PRESETS_COUNT] = {1, 2, 2, 2};
+const int32_t SHADOWED_POINT_LIGHTS[QUALITY_PRESETS_COUNT] = {1, 3, 5, 5};
+const int32_t SHADED_POINT_LIGHTS[QUALITY_PRESETS_COUNT] = {8, 32, 128, 256};
+// The names of the quality presets, shown in the debug text and the benchmark reports.
+const char *const QUALITY_PRESET_NAMES[QUALITY_PRESETS_COUNT] = {"Low", "Medium", "High", "Ultra"};
+// The settings the render config starts from for each quality preset, before the overrides of the config file: the anti-aliasing
+//   mode of the window (a multisampling one), the shadow filter kernel (1x1, 3x3, Poisson 8 and Poisson 16), the shadow atlas and
+//   the largest tile of the cone lights, the cube map faces of the point lights (in pixels), the bits per shadowmap depth (16 or
+//   24), the size the shadowmaps of all the lights are expected to take in video memory (in bytes), and whether the shadowmap
+//   updates start out amortized.
+const int32_t QUALITY_PRESET_ANTI_ALIASING_MODES[QUALITY_PRESETS_COUNT] = {0, 1, 2, 3};
+const int32_t QUALITY_PRESET_SHADOW_FILTER_KERNELS[QUALITY_PRESETS_COUNT] = {0, 1, 1, 3};
+const int32_t QUALITY_PRESET_CONE_LIGHT_SHADOW_ATLAS_SIZES[QUALITY_PRESETS_COUNT] = {1024, 1024, 2048, 4096};
+const int32_t QUALITY_PRESET_CONE_LIGHT_MAX_SHADOW_MAP_SIZES[QUALITY_PRESETS_COUNT] = {512, 512, 1024, 2048};
+const int32_t QUALITY_PRESET_POINT_LIGHT_SHADOW_MAP_SIZES[QUALITY_PRESETS_COUNT] = {128, 256, 256, 512};
+const int32_t QUALITY_PRESET_SHADOW_MAP_DEPTH_BITS[QUALITY_PRESETS_COUNT] = {16, 24, 24, 24};
+const uint64_t QUALITY_PRESET_SHADOW_MEMORY_BUDGETS[QUALITY_PRESETS_COUNT] = {8 * 1024 * 1024, 16 * 1024 * 1024, 32 * 1024 * 1024, 128 * 1024 * 1024};
+const bool QUALITY_PRESET_SHADOW_UPDATES_AMORTIZED[QUALITY_PRESETS_COUNT] = {true, false, false, false};
+// The path the render config is read from when no "--config" option gives one, skipped if there is no file there.
+const char *const DEFAULT_RENDER_CONFIG_PATH = "render.cfg";
+// The lighting contribution (per unit of color) below which a light is considered to not reach a fragment, which sets the range
+//   of each light from its color and intensity (for its shadowmaps, its light clusters and its culling).
+const float_t LIGHT_INFLUENCE_CUTOFF = 0.05f;
+// The largest distance between lights casting no shadows merged into one by the light aggregation (as a share of the smaller of
+//   their ranges), close enough that the merged light lights about the same.
+const float_t LIGHT_AGGREGATION_RANGE_RATIO = 0.05f;
+// The frame rate limits the frame pacer can be switched between (in frames per second, 0 for no limit).
+const int32_t FRAME_RATE_LIMITS_COUNT = 5;
+const uint32_t FRAME_RATE_LIMITS[FRAME_RATE_LIMITS_COUNT] = {0, 30, 60, 120, 144};
+// The frame rate limit of the menu scenes, which have nothing to gain from running faster (in frames per second).
+const uint32_t MENU_FRAME_RATE_LIMIT = 60;
+// The time before a frame deadline the frame pacer stops sleeping and spins instead, since sleeping can overshoot by about
+//   a scheduler tick (in seconds).
+const double_t FRAME_PACER_SPIN_TIME = 0.002;
+// The number of frames the frame time statistics are taken over.
+const size_t FRAME_TIME_HISTORY_SIZE = 120;
+// The frame times the frame time graph draws budget lines at, e.g. for the frame rates to hold (in milliseconds).
+const size_t FRAME_TIME_GRAPH_BUDGETS_COUNT = 2;
+const double_t FRAME_TIME_GRAPH_BUDGETS[FRAME_TIME_GRAPH_BUDGETS_COUNT] = {1000.0 / 60.0, 1000.0 / 30.0};
+// The frame time at the top of the frame time graph, which the longer frames are clamped to (in milliseconds).
+const double_t FRAME_TIME_GRAPH_MAX_TIME = 50.0;
+// The corners of the frame time graph on the window, in the bottom right under the shorter lines of the debug text (in
+//   normalized device coordinates).
+const float_t FRAME_TIME_GRAPH_LEFT = 0.5f;
+const float_t FRAME_TIME_GRAPH_BOTTOM = -0.97f;
+const float_t FRAME_TIME_GRAPH_RIGHT = 0.97f;
+const float_t FRAME_TIME_GRAPH_TOP = -0.72f;
+// The number of line vertices the debug draws of a frame can add (the lines beyond it are dropped).
+const uint32_t DEBUG_DRAW_MAX_VERTICES = 65536;
+// The number of lines each of the three circles of a debug sphere is drawn with.
+const uint32_t DEBUG_DRAW_SPHERE_SEGMENTS = 24;
+// Whether the menu scenes start out rendering on demand, redrawing only when the input changes, for a while after that, or at
+//   the idle redraw rate, and waiting for window events in between.
+const bool IS_MENU_RENDER_ON_DEMAND = true;
+// The rate the menu scenes redraw at when rendering on demand with no input, enough for their slow animations (in redraws per
+//   second).
+const double_t MENU_IDLE_REDRAW_RATE = 10.0;
+// The time the menu scenes keep redrawing at the full frame rate after the input changes (in seconds).
+const double_t MENU_INPUT_ACTIVE_TIME = 0.5;
+// The anti-aliasing modes of the scene (Off, MSAA 2x, MSAA 4x, MSAA 8x and FXAA), and the number of samples of each.
+const int32_t ANTI_ALIASING_MODES_COUNT = 5;
+const int32_t ANTI_ALIASING_SAMPLES[ANTI_ALIASING_MODES_COUNT] = {0, 2, 4, 8, 0};
+// The anti-aliasing mode applied as a post-process pass instead of multisampling.
+const int32_t FXAA_ANTI_ALIASING_MODE = 4;
+// The number of anti-aliasing modes the window can be created with (the multisampling ones, from Off to MSAA 8x).
+const int32_t WINDOW_ANTI_ALIASING_MODES_COUNT = 4;
+// The range of scales of the resolution of the scene render target, relative to the window viewport.
+const float_t DYNAMIC_RESOLUTION_MIN_SCALE = 0.5f;
+const float_t DYNAMIC_RESOLUTION_MAX_SCALE = 1.0f;
+// The GPU time the dynamic resolution scaling aims to render the scene in (in milliseconds).
+const double_t DYNAMIC_RESOLUTION_GPU_BUDGET = 10.0;
+// The share of the GPU budget the measured GPU time can be off by before the resolution scale is changed.
+const double_t DYNAMIC_RESOLUTION_TOLERANCE = 0.1;
+// The number of frames between the changes of the resolution scale, since the GPU times are read a few frames late.
+const uint32_t DYNAMIC_RESOLUTION_ADJUST_INTERVAL = 8;
+// The largest change of the resolution scale at once.
+const float_t DYNAMIC_RESOLUTION_MAX_STEP = 0.1f;
+// The strength of the sharpening of the scene when upscaling it to the window (0 for none).
+const float_t DYNAMIC_RESOLUTION_SHARPNESS = 0.5f;
+// The number of frames the benchmark mode measures, unless given on the command line.
+const uint32_t BENCHMARK_DEFAULT_FRAMES_COUNT = 1000;
+// The number of frames the benchmark mode runs before measuring, for the shaders, buffers and shadow maps to settle.
+const uint32_t BENCHMARK_WARMUP_FRAMES_COUNT = 60;
+// The seed of the benchmark mode, unless given on the command line.
+const uint32_t BENCHMARK_DEFAULT_SEED = 1;
+// The number of simulation steps the scripted player of the benchmark mode moves in each direction for, sweeping a square.
+const uint32_t BENCHMARK_MOVE_STEPS = 60;
+// The spacing of the enemy grid of the benchmark mode, unless given on the command line or in a scene file.
+const float_t BENCHMARK_DEFAULT_ENEMY_SPACING = 5.0f;
+// The rate the scripted player of the benchmark mode fires at (in shots per second), unless given on the command line or in a
+//   scene file. Once every simulation step, so that it fires whenever it can.
+const float_t BENCHMARK_DEFAULT_FIRE_RATE = static_cast<float_t>(1.0 / SIMULATION_STEP_TIME);
+// The radius of the ring the extra lights of the benchmark mode are placed on over the enemies, and its height.
+const float_t BENCHMARK_LIGHTS_RADIUS = 15.0f;
+const float_t BENCHMARK_LIGHTS_HEIGHT = 10.0f;
 
 int32_t VIEWPORT_WIDTH = WINDOW_WIDTH;
 int32_t VIEWPORT_HEIGHT = WINDOW_HEIGHT;
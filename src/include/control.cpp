@@ -4,12 +4,21 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <array>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <condition_variable>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include "constants.cpp"
 #include "window.cpp"
+#include "text_arena.cpp"
+#include "input_recording.cpp"
 
 /**
  * Class containing the normalized position of the cursor.
@@ -46,6 +55,204 @@ public:
   }
 };
 
+/**
+ * Class containing the state of the keys, mouse buttons and cursor as of the last time the window events were polled, along
+ *   with the keys and mouse buttons that went down or up since the poll before it, so that it can be read from any thread
+ *   (unlike GLFW, which can only be queried from the main thread). Filled from the GLFW input callbacks rather than by querying
+ *   GLFW, so that reading it is a plain array lookup.
+ */
+class InputSnapshot
+{
+private:
+  // Whether each key is held down, by its GLFW key code.
+  std::array<bool, GLFW_KEY_LAST + 1> pressedKeys;
+  // Whether each key went down since the last snapshot, by its GLFW key code.
+  std::array<bool, GLFW_KEY_LAST + 1> keyPresses;
+  // Whether each key went up since the last snapshot, by its GLFW key code.
+  std::array<bool, GLFW_KEY_LAST + 1> keyReleases;
+  // Whether each mouse button is held down, by its GLFW button code.
+  std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> pressedMouseButtons;
+  // Whether each mouse button went down since the last snapshot, by its GLFW button code.
+  std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> mouseButtonPresses;
+  // Whether each mouse button went up since the last snapshot, by its GLFW button code.
+  std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> mouseButtonReleases;
+  // The normalized x,y-coordinates of the cursor.
+  double_t cursorX, cursorY;
+  // Whether any key, mouse button or cursor event arrived since the last snapshot.
+  bool isInputReceived;
+
+public:
+  InputSnapshot()
+      : pressedKeys({}),
+        keyPresses({}),
+        keyReleases({}),
+        pressedMouseButtons({}),
+        mouseButtonPresses({}),
+        mouseButtonReleases({}),
+        cursorX(0.5),
+        cursorY(0.5),
+        isInputReceived(false) {}
+
+  /**
+   * Apply a key event to the snapshot being filled.
+   * 
+   * @param key     The key of the event.
+   * @param action  The GLFW action of the event.
+   */
+  void handleKey(const int32_t &key, const int32_t &action)
+  {
+    // Ignore the unknown keys and the key repeats, which do not change whether the key is held.
+    if (key < 0 || key > GLFW_KEY_LAST || action == GLFW_REPEAT)
+    {
+      return;
+    }
+    pressedKeys[key] = action == GLFW_PRESS;
+    (action == GLFW_PRESS ? keyPresses : keyReleases)[key] = true;
+    isInputReceived = true;
+  }
+
+  /**
+   * Apply a mouse button event to the snapshot being filled.
+   * 
+   * @param button  The mouse button of the event.
+   * @param action  The GLFW action of the event.
+   */
+  void handleMouseButton(const int32_t &button, const int32_t &action)
+  {
+    if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST)
+    {
+      return;
+    }
+    pressedMouseButtons[button] = action == GLFW_PRESS;
+    (action == GLFW_PRESS ? mouseButtonPresses : mouseButtonReleases)[button] = true;
+    isInputReceived = true;
+  }
+
+  /**
+   * Apply a cursor position to the snapshot being filled.
+   * 
+   * @param x                The normalized x-coordinate of the cursor.
+   * @param y                The normalized y-coordinate of the cursor.
+   * @param isInputReceived  Whether the position came from a cursor event, rather than from setting the cursor position.
+   */
+  void handleCursor(const double_t &x, const double_t &y, const bool &isInputReceived)
+  {
+    // Ignore the events not moving the cursor, like the ones echoing the cursor position being set.
+    if (x == cursorX && y == cursorY)
+    {
+      return;
+    }
+    cursorX = x;
+    cursorY = y;
+    this->isInputReceived = this->isInputReceived || isInputReceived;
+  }
+
+  /**
+   * Forget the keys and mouse buttons that went down or up, once the snapshot is taken, so that they are only reported by one
+   *   snapshot.
+   */
+  void clearEdges()
+  {
+    keyPresses.fill(false);
+    keyReleases.fill(false);
+    mouseButtonPresses.fill(false);
+    mouseButtonReleases.fill(false);
+    isInputReceived = false;
+  }
+
+  /**
+   * Checks whether a key was held down when the snapshot was taken.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key was held down or not.
+   */
+  bool isKeyPressed(const int32_t &key) const
+  {
+    return pressedKeys[key];
+  }
+
+  /**
+   * Checks whether a key went down since the last snapshot, replacing the timestamps debouncing the toggles.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key went down or not.
+   */
+  bool wasKeyPressed(const int32_t &key) const
+  {
+    return keyPresses[key];
+  }
+
+  /**
+   * Checks whether a key went up since the last snapshot.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key went up or not.
+   */
+  bool wasKeyReleased(const int32_t &key) const
+  {
+    return keyReleases[key];
+  }
+
+  /**
+   * Checks whether a mouse button was held down when the snapshot was taken.
+   * 
+   * @param key  The mouse button to check.
+   * 
+   * @return Whether the mouse button was held down or not.
+   */
+  bool isMouseButtonPressed(const int32_t &key) const
+  {
+    return pressedMouseButtons[key];
+  }
+
+  /**
+   * Checks whether a mouse button went down since the last snapshot.
+   * 
+   * @param key  The mouse button to check.
+   * 
+   * @return Whether the mouse button went down or not.
+   */
+  bool wasMouseButtonPressed(const int32_t &key) const
+  {
+    return mouseButtonPresses[key];
+  }
+
+  /**
+   * Checks whether a mouse button went up since the last snapshot.
+   * 
+   * @param key  The mouse button to check.
+   * 
+   * @return Whether the mouse button went up or not.
+   */
+  bool wasMouseButtonReleased(const int32_t &key) const
+  {
+    return mouseButtonReleases[key];
+  }
+
+  /**
+   * Returns the position of the cursor when the snapshot was taken.
+   * 
+   * @return The normalized cursor position.
+   */
+  CursorPosition getCursorPosition() const
+  {
+    return CursorPosition(cursorX, cursorY);
+  }
+
+  /**
+   * Checks whether any key, mouse button or cursor event arrived since the last snapshot.
+   * 
+   * @return Whether any input was received or not.
+   */
+  bool isAnyInputReceived() const
+  {
+    return isInputReceived;
+  }
+};
+
 /**
  * A class to manage controls and inputs of the window.
  */
@@ -63,25 +270,231 @@ private:
   // The window manager responsible for managing the window and properties related to it.
   const WindowManager &windowManager;
 
-  ControlManager() : windowManager(WindowManager::getInstance()) {}
+  // The state of the input as of the last time the window events were polled.
+  InputSnapshot inputSnapshot;
+  // The state of the input being filled by the GLFW input callbacks, taken as the snapshot when the window events are polled.
+  InputSnapshot pendingInputSnapshot;
+  // The state of the input the simulation steps read, taken once per step instead of once per frame, so that a key going down
+  //   is reported to exactly one step however many steps the frames run.
+  InputSnapshot simulationInputSnapshot;
+  // The state of the input being filled for the next simulation step.
+  InputSnapshot pendingSimulationInputSnapshot;
+  // Whether the keys of the simulation input are set by a script (like the one of the benchmark mode) instead of the window
+  //   events.
+  bool isSimulationInputScripted;
+
+  // The recorder of the input of the sessions, and the path of the file they are recorded to (empty if not asked to).
+  InputRecorder inputRecorder;
+  std::string inputRecordingPath;
+  // The recorded session to replay, if asked to.
+  InputReplay inputReplay;
+  bool isInputReplayRequested;
+  // Whether the input of a session is being recorded or replayed.
+  bool isInputSessionActive;
+  // The seed the random generators of the sessions are seeded with while recording or replaying, so that a replay simulates
+  //   the same as the recording.
+  uint32_t inputSessionSeed;
+  // The time the session started (in seconds).
+  double_t inputSessionStartTime;
+  // The events received since the last poll, recorded with the frame of the next.
+  std::vector<InputEvent> recordedEvents;
+  // The number of simulation steps run since the last poll.
+  uint32_t simulationStepsSincePoll;
+  // The time of the last poll, the latest the input of the snapshot was sampled at (in seconds).
+  double_t inputSampleTime;
+
+  // The thread posting an empty event once the timeout of a wait for window events passes, since GLFW before 3.2 can only wait
+  //   without a timeout (started with the first wait).
+  std::thread wakeThread;
+  // The mutex guarding the wake-up state.
+  std::mutex wakeMutex;
+  // The condition notified whenever the wake-up state changes.
+  std::condition_variable wakeCondition;
+  // The time the wake thread posts an empty event at, if a wake-up is armed.
+  std::chrono::steady_clock::time_point wakeTime;
+  // Whether a wake-up is armed.
+  bool isWakeArmed;
+  // Whether the wake thread is asked to stop.
+  bool isWakeThreadStopped;
+
+  ControlManager()
+      : windowManager(WindowManager::getInstance()),
+        inputSnapshot(),
+        pendingInputSnapshot(),
+        simulationInputSnapshot(),
+        pendingSimulationInputSnapshot(),
+        isSimulationInputScripted(false),
+        inputRecorder(),
+        inputRecordingPath(""),
+        inputReplay(),
+        isInputReplayRequested(false),
+        isInputSessionActive(false),
+        inputSessionSeed(0),
+        inputSessionStartTime(0.0),
+        recordedEvents({}),
+        simulationStepsSincePoll(0),
+        inputSampleTime(0.0),
+        wakeThread(),
+        wakeMutex(),
+        wakeCondition(),
+        wakeTime(),
+        isWakeArmed(false),
+        isWakeThreadStopped(false)
+  {
+    // Start from the current position of the cursor, and collect the input from the callbacks of the window from now on.
+    double_t x, y;
+    glfwGetCursorPos(windowManager.getWindow(), &x, &y);
+    pendingInputSnapshot.handleCursor(x / width, y / height, false);
+    pendingSimulationInputSnapshot.handleCursor(x / width, y / height, false);
+    inputSnapshot = pendingInputSnapshot;
+    simulationInputSnapshot = pendingSimulationInputSnapshot;
+    glfwSetKeyCallback(windowManager.getWindow(), handleKeyEvent);
+    glfwSetMouseButtonCallback(windowManager.getWindow(), handleMouseButtonEvent);
+    glfwSetCursorPosCallback(windowManager.getWindow(), handleCursorEvent);
+  }
+
+  /**
+   * The GLFW key callback of the window, run while the window events are polled.
+   */
+  static void handleKeyEvent(GLFWwindow *, int32_t key, int32_t, int32_t action, int32_t)
+  {
+    // The window input is ignored while a session is replayed, which feeds the recorded events instead.
+    if (!instance.isInputReplaying())
+    {
+      instance.handleEvent({InputEventType::KEY, static_cast<int16_t>(key), static_cast<uint8_t>(action), 0.0, 0.0});
+    }
+  }
+
+  /**
+   * The GLFW mouse button callback of the window, run while the window events are polled.
+   */
+  static void handleMouseButtonEvent(GLFWwindow *, int32_t button, int32_t action, int32_t)
+  {
+    if (!instance.isInputReplaying())
+    {
+      instance.handleEvent({InputEventType::MOUSE_BUTTON, static_cast<int16_t>(button), static_cast<uint8_t>(action), 0.0, 0.0});
+    }
+  }
+
+  /**
+   * The GLFW cursor position callback of the window, run while the window events are polled.
+   */
+  static void handleCursorEvent(GLFWwindow *, double_t x, double_t y)
+  {
+    // The cursor position is based on the size of the window, so normalize accordingly.
+    if (!instance.isInputReplaying())
+    {
+      instance.handleEvent({InputEventType::CURSOR, 0, 0, x / width, y / height});
+    }
+  }
+
+  /**
+   * Collect an input event into the pending snapshots, and keep it for the frame being recorded if a session is.
+   * 
+   * @param event  The input event.
+   */
+  void handleEvent(const InputEvent &event)
+  {
+    switch (event.type)
+    {
+    case InputEventType::KEY:
+      pendingInputSnapshot.handleKey(event.code, event.action);
+      if (!isSimulationInputScripted)
+      {
+        pendingSimulationInputSnapshot.handleKey(event.code, event.action);
+      }
+      break;
+    case InputEventType::MOUSE_BUTTON:
+      pendingInputSnapshot.handleMouseButton(event.code, event.action);
+      pendingSimulationInputSnapshot.handleMouseButton(event.code, event.action);
+      break;
+    case InputEventType::CURSOR:
+      pendingInputSnapshot.handleCursor(event.x, event.y, true);
+      pendingSimulationInputSnapshot.handleCursor(event.x, event.y, true);
+      break;
+    }
+    if (isInputSessionActive && inputRecorder.isOpen())
+    {
+      recordedEvents.push_back(event);
+    }
+  }
+
+  /**
+   * Take the input collected since the last poll as the snapshot, once the window events are polled.
+   */
+  void takeInputSnapshot()
+  {
+    inputSnapshot = pendingInputSnapshot;
+    pendingInputSnapshot.clearEdges();
+  }
+
+  /**
+   * Run the wake thread, posting an empty event whenever an armed wake-up is due, until the thread is asked to stop.
+   */
+  void runWakeThread()
+  {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!isWakeThreadStopped)
+    {
+      if (!isWakeArmed)
+      {
+        wakeCondition.wait(lock);
+      }
+      else if (wakeCondition.wait_until(lock, wakeTime) == std::cv_status::timeout && isWakeArmed)
+      {
+        // The wait for window events timed out, so wake it up.
+        glfwPostEmptyEvent();
+        isWakeArmed = false;
+      }
+    }
+  }
+
+  /**
+   * Arm or disarm the wake-up of a wait for window events.
+   * 
+   * @param isArmed  Whether the wake-up is armed.
+   * @param timeout  The time after which an armed wake-up is due (in seconds).
+   */
+  void setWake(const bool &isArmed, const double_t &timeout)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(wakeMutex);
+      if (!wakeThread.joinable())
+      {
+        wakeThread = std::thread([this]() { runWakeThread(); });
+      }
+      isWakeArmed = isArmed;
+      wakeTime = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double_t>(timeout));
+    }
+    wakeCondition.notify_all();
+  }
 
 public:
   // Preventing copying the control manager, making sure only one instance can exist.
   ControlManager(const ControlManager &) = delete;
 
+  ~ControlManager()
+  {
+    // Stop the wake thread, if it was ever started.
+    {
+      const std::lock_guard<std::mutex> lock(wakeMutex);
+      isWakeThreadStopped = true;
+    }
+    wakeCondition.notify_all();
+    if (wakeThread.joinable())
+    {
+      wakeThread.join();
+    }
+  }
+
   /**
-   * Returns the position of the cursor on the window.
+   * Returns the position of the cursor on the window, as of the last poll or the last time it was set.
    * 
    * @return The cursor position.
    */
-  const std::shared_ptr<CursorPosition> getCursorPosition() const
+  CursorPosition getCursorPosition() const
   {
-    // Define variables for the x,y-coordinates of the cursor.
-    double_t x, y;
-    // Get the cursor position in the window from GLFW.
-    glfwGetCursorPos(windowManager.getWindow(), &x, &y);
-    // The cursor position is based on the size of the window, so normalize accordingly and return it.
-    return std::make_shared<CursorPosition>(x / width, y / height);
+    return inputSnapshot.getCursorPosition();
   }
 
   /**
@@ -94,40 +507,336 @@ public:
     // Tell GLFW to set the position of the cursor. GLFW requires the absolute position of the cursor on the window,
     //   but the input coordinates are normalized, so multiply them with the dimensions of the window.
     glfwSetCursorPos(windowManager.getWindow(), newPosition.getX() * width, newPosition.getY() * height);
+    // Keep the snapshots in line with the new position, which GLFW does not report as a cursor event. Only done on the main
+    //   thread while no worker reads the cursor.
+    inputSnapshot.handleCursor(newPosition.getX(), newPosition.getY(), false);
+    pendingInputSnapshot.handleCursor(newPosition.getX(), newPosition.getY(), false);
+    pendingSimulationInputSnapshot.handleCursor(newPosition.getX(), newPosition.getY(), false);
   }
 
   /**
-   * Checks whether a key has been pressed or not.
+   * Checks whether a key is held down, as of the last poll.
    * 
    * @param key  The key to check.
    * 
-   * @return Whether the key has been pressed or not.
+   * @return Whether the key is held down or not.
    */
   bool isKeyPressed(const int32_t &key) const
   {
-    // Query GLFW to see the status of the key and return true if it is being pressed.
-    return glfwGetKey(windowManager.getWindow(), key) == GLFW_PRESS;
+    return inputSnapshot.isKeyPressed(key);
   }
 
   /**
-   * Checks whether a mouse button has been pressed or not.
+   * Checks whether a key went down between the last two polls, which is reported by a single frame.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key went down or not.
+   */
+  bool wasKeyPressed(const int32_t &key) const
+  {
+    return inputSnapshot.wasKeyPressed(key);
+  }
+
+  /**
+   * Checks whether a mouse button is held down, as of the last poll.
    * 
    * @param key  The mouse button to check.
    * 
-   * @return Whether the mouse button has been pressed or not.
+   * @return Whether the mouse button is held down or not.
    */
   bool isMouseButtonPressed(const int32_t &key) const
   {
-    // Query GLFW to see the status of the mouse button and return true if it is being pressed.
-    return glfwGetMouseButton(windowManager.getWindow(), key) == GLFW_PRESS;
+    return inputSnapshot.isMouseButtonPressed(key);
+  }
+
+  /**
+   * Checks whether a mouse button went down between the last two polls, which is reported by a single frame.
+   * 
+   * @param key  The mouse button to check.
+   * 
+   * @return Whether the mouse button went down or not.
+   */
+  bool wasMouseButtonPressed(const int32_t &key) const
+  {
+    return inputSnapshot.wasMouseButtonPressed(key);
+  }
+
+  /**
+   * Returns the state of the input as of the last time the window events were polled, which the models updated in parallel
+   *   read their input from.
+   * 
+   * @return The input snapshot.
+   */
+  const InputSnapshot &getInputSnapshot() const
+  {
+    return inputSnapshot;
+  }
+
+  /**
+   * Returns the state of the input as of the start of the current simulation step, which the models updated in fixed
+   *   simulation steps read their input from.
+   * 
+   * @return The simulation input snapshot.
+   */
+  const InputSnapshot &getSimulationInputSnapshot() const
+  {
+    return simulationInputSnapshot;
+  }
+
+  /**
+   * Take the input collected since the last simulation step as the simulation snapshot, before a step is run (and once before
+   *   the first step, to drop the input collected before the simulation started).
+   */
+  void advanceSimulationInput()
+  {
+    simulationInputSnapshot = pendingSimulationInputSnapshot;
+    pendingSimulationInputSnapshot.clearEdges();
+    simulationStepsSincePoll++;
+  }
+
+  /**
+   * Set whether the keys of the simulation input are set by a script instead of the window events. The keys of the frame input
+   *   (e.g. for the hotkeys) are still taken from the window events.
+   * 
+   * @param isScripted  Whether the simulation keys are scripted.
+   */
+  void setSimulationInputScripted(const bool &isScripted)
+  {
+    isSimulationInputScripted = isScripted;
+  }
+
+  /**
+   * Set whether a key of the simulation input is held, for the next simulation step. The key is reported as going down or up to
+   *   the step only if it changed, like it would be by the window events.
+   * 
+   * @param key        The GLFW key code.
+   * @param isPressed  Whether the key is held.
+   */
+  void setScriptedKey(const int32_t &key, const bool &isPressed)
+  {
+    if (pendingSimulationInputSnapshot.isKeyPressed(key) != isPressed)
+    {
+      pendingSimulationInputSnapshot.handleKey(key, isPressed ? GLFW_PRESS : GLFW_RELEASE);
+    }
   }
 
   /**
-   * Poll for input/control events on the window.
+   * Poll for input/control events on the window, and capture the input snapshot.
    */
   void pollEvents()
   {
     glfwPollEvents();
+    if (isInputReplaying())
+    {
+      // Feed the events the poll received when recorded, once the steps of the frame are run like they were.
+      if (!inputReplay.isFinished())
+      {
+        for (const auto &event : inputReplay.getNextFrame().events)
+        {
+          handleEvent(event);
+        }
+        inputReplay.advance();
+      }
+    }
+    else if (isInputSessionActive && inputRecorder.isOpen())
+    {
+      // Record the frame the poll ends, with the events it received.
+      inputRecorder.writeFrame(glfwGetTime() - inputSessionStartTime, static_cast<uint16_t>(simulationStepsSincePoll), recordedEvents);
+      recordedEvents.clear();
+    }
+    simulationStepsSincePoll = 0;
+    inputSampleTime = glfwGetTime();
+    // The callbacks only run while polling, so the snapshot stays the same until the next poll.
+    takeInputSnapshot();
+  }
+
+  /**
+   * Poll for the window events again, but only take the position of the cursor into the input snapshot, so that the cameras
+   *   follow the mouse movement made since the last poll. The keys and mouse buttons are left for the next poll, so that their
+   *   presses are still reported by a single frame. Only done on the main thread while no worker reads the cursor, and not
+   *   while the input of a session is recorded or replayed, which is taken once per frame.
+   */
+  void resampleCursor()
+  {
+    if (!IS_LATE_CURSOR_SAMPLING_ENABLED || isInputSessionActive || isInputReplaying())
+    {
+      return;
+    }
+    glfwPollEvents();
+    const auto cursorPosition = pendingInputSnapshot.getCursorPosition();
+    inputSnapshot.handleCursor(cursorPosition.getX(), cursorPosition.getY(), true);
+  }
+
+  /**
+   * Get the time of the last poll, the latest the input of the snapshot was sampled at.
+   * 
+   * @return The time of the last poll (in seconds).
+   */
+  double_t getInputSampleTime() const
+  {
+    return inputSampleTime;
+  }
+
+  /**
+   * Record the input of the sessions to a file from now on, each session replacing the recording of the one before.
+   * 
+   * @param path  The path of the file.
+   */
+  void setInputRecordingPath(const std::string &path)
+  {
+    inputRecordingPath = path;
+    // Seed the sessions from a nondeterministic source, like they are otherwise, but keep the seed for the recording.
+    inputSessionSeed = std::random_device()();
+  }
+
+  /**
+   * Read a recorded session, to replay the input of the sessions from now on instead of taking it from the window.
+   * 
+   * @param path  The path of the recording.
+   * 
+   * @return Whether the recording was read.
+   */
+  bool loadInputReplay(const std::string &path)
+  {
+    isInputReplayRequested = inputReplay.load(path);
+    inputSessionSeed = inputReplay.getSeed();
+    return isInputReplayRequested;
+  }
+
+  /**
+   * Get whether the sessions are recorded or replayed, in which case their random generators have to be seeded with the seed
+   *   of the session.
+   * 
+   * @return Whether the sessions are recorded or replayed.
+   */
+  bool isInputSessionSeeded() const
+  {
+    return isInputReplayRequested || !inputRecordingPath.empty();
+  }
+
+  /**
+   * Get the seed of the sessions recorded or replayed.
+   * 
+   * @return The seed.
+   */
+  const uint32_t &getInputSessionSeed() const
+  {
+    return inputSessionSeed;
+  }
+
+  /**
+   * Start recording or replaying the input of a session (if asked to), from the next simulation step and poll on. Done once
+   *   the session starts running its frames, after the simulation input collected before it was dropped.
+   */
+  void beginInputSession()
+  {
+    if (isInputReplayRequested)
+    {
+      inputReplay.rewind();
+      isInputSessionActive = true;
+    }
+    else if (!inputRecordingPath.empty())
+    {
+      isInputSessionActive = inputRecorder.open(inputRecordingPath, inputSessionSeed);
+      if (!isInputSessionActive)
+      {
+        std::cerr << "Failed to open the input recording " << inputRecordingPath << std::endl;
+      }
+    }
+    inputSessionStartTime = glfwGetTime();
+    recordedEvents.clear();
+    simulationStepsSincePoll = 0;
+  }
+
+  /**
+   * Stop recording or replaying the input of the session, writing out the recording.
+   */
+  void endInputSession()
+  {
+    if (inputRecorder.isOpen() && !inputRecorder.close())
+    {
+      std::cerr << "Failed to write the input recording " << inputRecordingPath << std::endl;
+    }
+    isInputSessionActive = false;
+  }
+
+  /**
+   * Get whether the input of a session is being replayed.
+   * 
+   * @return Whether a session is replayed.
+   */
+  bool isInputReplaying() const
+  {
+    return isInputSessionActive && isInputReplayRequested;
+  }
+
+  /**
+   * Get whether all the frames of the session replayed are, which ends the session.
+   * 
+   * @return Whether the replay is finished (false if no session is replayed).
+   */
+  bool isInputReplayFinished() const
+  {
+    return isInputReplaying() && inputReplay.isFinished();
+  }
+
+  /**
+   * Get the number of simulation steps the frame being replayed ran when recorded, for the frame to run as many.
+   * 
+   * @return The number of steps (0 if the replay is finished).
+   */
+  uint32_t getReplayedStepsCount() const
+  {
+    return inputReplay.isFinished() ? 0 : inputReplay.getNextFrame().stepsCount;
+  }
+
+  /**
+   * Write the state of the recording or the replay of the session as text.
+   * 
+   * @param text  The writer of the text, written whether the session is recorded or replayed and how far.
+   */
+  void writeInputSessionStatus(TextWriter &text) const
+  {
+    if (isInputReplaying())
+    {
+      text << "Replaying (" << inputReplay.getReplayedFramesCount() << "/" << inputReplay.getFramesCount() << " Frames)";
+    }
+    else if (isInputSessionActive && inputRecorder.isOpen())
+    {
+      text << "Recording (" << glfwGetTime() - inputSessionStartTime << "s)";
+    }
+    else
+    {
+      text << "Off";
+    }
+  }
+
+  /**
+   * Wait for input/control events on the window, until one arrives or the timeout passes, and capture the input snapshot. Lets
+   *   the scenes with nothing to do sleep instead of polling in a loop.
+   * 
+   * @param timeout  The longest time to wait for (in seconds, just polling if 0 or less).
+   */
+  void waitEvents(const double_t &timeout)
+  {
+    if (timeout <= 0.0)
+    {
+      glfwPollEvents();
+    }
+    else
+    {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 2)
+      glfwWaitEventsTimeout(timeout);
+#else
+      // Have the wake thread cut the wait short once the timeout passes. A wake-up posted after another event already ended the
+      //   wait only makes the next wait return at once.
+      setWake(true, timeout);
+      glfwWaitEvents();
+      setWake(false, 0.0);
+#endif
+    }
+    takeInputSnapshot();
   }
 
   /**
@@ -157,6 +866,16 @@ public:
     glfwSetInputMode(windowManager.getWindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
   }
 
+  /**
+   * Set the image the cursor is shown with while it is over the window and not disabled.
+   * 
+   * @param cursor  The hardware cursor, or null for the default arrow cursor.
+   */
+  void setCursorShape(GLFWcursor *const cursor)
+  {
+    glfwSetCursor(windowManager.getWindow(), cursor);
+  }
+
   /**
    * Returns the singleton instance of the control manager.
    * 
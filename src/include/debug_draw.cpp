@@ -0,0 +1,316 @@
+#ifndef INCLUDE_DEBUG_DRAW_CPP
+#define INCLUDE_DEBUG_DRAW_CPP
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "constants.cpp"
+#include "common.cpp"
+#include "shader.cpp"
+#include "gl_stats.cpp"
+#include "gl_debug.cpp"
+#include "stream_buffer.cpp"
+
+/**
+ * Structure for defining a vertex of a debug line.
+ */
+struct DebugLineVertex
+{
+  // The position of the vertex (in world-space).
+  glm::vec3 position;
+  // The color of the vertex, packed as 8 bits per channel.
+  uint32_t color;
+};
+
+/**
+ * A manager class for drawing debug lines in immediate mode. The lines, boxes, spheres and frusta added over a frame are written
+ *   into an allocation of the stream buffer, and drawn together with a single draw call, each line in its own color. The shapes
+ *   have to be added on the thread the GL context is current on, since the lines of the frame are allocated on the first one.
+ */
+class DebugDrawManager
+{
+private:
+  // Singleton instance of the debug draw manager.
+  static DebugDrawManager instance;
+
+  // The pairs of the indices of the corners of a box joined by its edges, with the corners indexed as the corners of the AABBs
+  //   are ((x * 4) + (y * 2) + z, 0 for the minimum and 1 for the maximum of each axis).
+  static constexpr std::array<std::array<uint8_t, 2>, 12> BOX_EDGES = {{{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}}};
+
+  ShaderManager &shaderManager;
+  // The stream buffer manager the lines of each frame are written through.
+  StreamBufferManager &streamBufferManager;
+
+  // The shader the debug lines are drawn with, created the first time lines are drawn, since only the debug mode draws them.
+  std::shared_ptr<const ShaderDetails> debugLinesShader;
+  // The ID of the vertex array of the debug lines, pointed at the allocation of the frame in the stream buffer.
+  const GLuint lineVertexArrayId;
+  // The allocation of the stream buffer the lines of the frame are written to.
+  StreamAllocation frameAllocation;
+  // The lines of the frame, written here without being drawn if the stream buffer had no room left for them.
+  std::vector<DebugLineVertex> discardedVertices;
+  // The vertices the lines of the frame are written to, acquired when the first line of the frame is added.
+  DebugLineVertex *frameVertices;
+  // The number of vertices of the lines added in the frame.
+  uint32_t frameVerticesCount;
+  // The number of vertices dropped in the frame, once the region was full.
+  uint32_t droppedVerticesCount;
+  // The numbers of vertices drawn and dropped in the last frame, for the debug text.
+  uint32_t lastFrameVerticesCount;
+  uint32_t lastFrameDroppedVerticesCount;
+
+  static GLuint createLineVertexArray()
+  {
+    // The attributes are described with each frame, once the lines of the frame are allocated.
+    const auto vertexArrayId = VertexArray::createVertexArray();
+    GlCalls::bindVertexArray(0);
+    return vertexArrayId;
+  }
+
+  /**
+   * Describe the attributes of the line vertices starting at the given offset of a buffer, in the bound vertex array object.
+   * 
+   * @param bufferId      The ID of the buffer.
+   * @param bufferOffset  The byte offset of the first vertex in the buffer.
+   */
+  static void describeLineAttributes(const GLuint &bufferId, const size_t &bufferOffset)
+  {
+    VertexArray::enableAttribute(0, bufferId, 3, GL_FLOAT, 0, sizeof(DebugLineVertex), bufferOffset + offsetof(DebugLineVertex, position));
+    VertexArray::enableAttribute(1, bufferId, 4, GL_UNSIGNED_BYTE, 0, sizeof(DebugLineVertex), bufferOffset + offsetof(DebugLineVertex, color), GL_TRUE);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  DebugDrawManager()
+      : shaderManager(ShaderManager::getInstance()),
+        streamBufferManager(StreamBufferManager::getInstance()),
+        debugLinesShader(nullptr),
+        lineVertexArrayId(createLineVertexArray()),
+        frameAllocation({}),
+        discardedVertices({}),
+        frameVertices(nullptr),
+        frameVerticesCount(0),
+        droppedVerticesCount(0),
+        lastFrameVerticesCount(0),
+        lastFrameDroppedVerticesCount(0) {}
+
+  ~DebugDrawManager()
+  {
+    GlCalls::deleteVertexArrays(1, &lineVertexArrayId);
+    if (debugLinesShader != nullptr)
+    {
+      shaderManager.destroyShaderProgram(debugLinesShader);
+    }
+  }
+
+  /**
+   * Get the vertices the lines of the frame are written to, allocating them in the stream buffer the first time in the frame.
+   * 
+   * @return The vertices of the frame.
+   */
+  DebugLineVertex *getFrameVertices()
+  {
+    if (frameVertices != nullptr)
+    {
+      return frameVertices;
+    }
+    frameAllocation = streamBufferManager.allocate(sizeof(DebugLineVertex) * DEBUG_DRAW_MAX_VERTICES, sizeof(DebugLineVertex));
+    if (frameAllocation.data == nullptr)
+    {
+      discardedVertices.resize(DEBUG_DRAW_MAX_VERTICES);
+      frameVertices = discardedVertices.data();
+      return frameVertices;
+    }
+    frameVertices = reinterpret_cast<DebugLineVertex *>(frameAllocation.data);
+    return frameVertices;
+  }
+
+  /**
+   * Add the twelve edges of a box.
+   * 
+   * @param corners  The corners of the box, indexed as the corners of the AABBs are.
+   * @param color    The color of the edges.
+   */
+  void addBoxEdges(const std::array<glm::vec3, 8> &corners, const glm::vec4 &color)
+  {
+    for (const auto &edge : BOX_EDGES)
+    {
+      addLine(corners[edge[0]], corners[edge[1]], color);
+    }
+  }
+
+public:
+  // Preventing copying the debug draw manager, making sure only one instance can exist.
+  DebugDrawManager(const DebugDrawManager &) = delete;
+
+  /**
+   * Add a line to the lines of the frame, dropping it if the frame is out of room.
+   * 
+   * @param start  The start of the line (in world-space).
+   * @param end    The end of the line (in world-space).
+   * @param color  The color of the line.
+   */
+  void addLine(const glm::vec3 &start, const glm::vec3 &end, const glm::vec4 &color)
+  {
+    if (frameVerticesCount + 2 > DEBUG_DRAW_MAX_VERTICES)
+    {
+      droppedVerticesCount += 2;
+      return;
+    }
+    const auto vertices = getFrameVertices();
+    const auto packedColor = glm::packUnorm4x8(color);
+    vertices[frameVerticesCount++] = {start, packedColor};
+    vertices[frameVerticesCount++] = {end, packedColor};
+  }
+
+  /**
+   * Add the edges of an axis aligned box.
+   * 
+   * @param box    The box (in world-space).
+   * @param color  The color of the edges.
+   */
+  void addAabb(const AxisAlignedBoundingBox &box, const glm::vec4 &color)
+  {
+    addBoxEdges(box.getCorners(), color);
+  }
+
+  /**
+   * Add the edges of an oriented box, as an axis aligned box transformed into world-space.
+   * 
+   * @param box                   The box (in the space of the transformation).
+   * @param transformationMatrix  The transformation of the box into world-space.
+   * @param color                 The color of the edges.
+   */
+  void addObb(const AxisAlignedBoundingBox &box, const glm::mat4 &transformationMatrix, const glm::vec4 &color)
+  {
+    std::array<glm::vec3, 8> corners;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+      corners[i] = glm::vec3(transformationMatrix * glm::vec4(box.getCorners()[i], 1.0f));
+    }
+    addBoxEdges(corners, color);
+  }
+
+  /**
+   * Add a sphere, as the three circles around its axes.
+   * 
+   * @param center  The center of the sphere (in world-space).
+   * @param radius  The radius of the sphere.
+   * @param color   The color of the circles.
+   */
+  void addSphere(const glm::vec3 &center, const float_t &radius, const glm::vec4 &color)
+  {
+    auto lastPoint = glm::vec2(radius, 0.0f);
+    for (uint32_t i = 1; i <= DEBUG_DRAW_SPHERE_SEGMENTS; i++)
+    {
+      const auto angle = glm::two_pi<float_t>() * i / DEBUG_DRAW_SPHERE_SEGMENTS;
+      const auto point = glm::vec2(glm::cos(angle), glm::sin(angle)) * radius;
+      addLine(center + glm::vec3(lastPoint.x, lastPoint.y, 0.0f), center + glm::vec3(point.x, point.y, 0.0f), color);
+      addLine(center + glm::vec3(lastPoint.x, 0.0f, lastPoint.y), center + glm::vec3(point.x, 0.0f, point.y), color);
+      addLine(center + glm::vec3(0.0f, lastPoint.x, lastPoint.y), center + glm::vec3(0.0f, point.x, point.y), color);
+      lastPoint = point;
+    }
+  }
+
+  /**
+   * Add the edges of the view frustum of a camera.
+   * 
+   * @param viewProjectionMatrix  The view-projection matrix of the camera.
+   * @param color                 The color of the edges.
+   */
+  void addFrustum(const glm::mat4 &viewProjectionMatrix, const glm::vec4 &color)
+  {
+    // Take the corners of the clip-space cube back into world-space.
+    const auto inverseViewProjectionMatrix = glm::inverse(viewProjectionMatrix);
+    std::array<glm::vec3, 8> corners;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+      const auto corner = inverseViewProjectionMatrix * glm::vec4((i & 4) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 1) ? 1.0f : -1.0f, 1.0f);
+      corners[i] = glm::vec3(corner) / corner.w;
+    }
+    addBoxEdges(corners, color);
+  }
+
+  /**
+   * Draw the lines added in the frame, with a single draw call, and start the lines of the next frame.
+   * 
+   * @param viewProjectionMatrix  The view-projection matrix of the camera the lines are drawn for.
+   */
+  void render(const glm::mat4 &viewProjectionMatrix)
+  {
+    lastFrameVerticesCount = frameVerticesCount;
+    lastFrameDroppedVerticesCount = droppedVerticesCount;
+    if (frameVerticesCount == 0)
+    {
+      droppedVerticesCount = 0;
+      return;
+    }
+
+    if (debugLinesShader == nullptr)
+    {
+      debugLinesShader = shaderManager.createShaderProgram("DebugLinesShader", "assets/shaders/vertex/debug_lines.glsl", "assets/shaders/fragment/debug_lines.glsl");
+    }
+    GlCalls::useProgram(debugLinesShader->getShaderId());
+    GlCalls::uniformMatrix4fv(glGetUniformLocation(debugLinesShader->getShaderId(), "viewProjectionMatrix"), 1, GL_FALSE, &viewProjectionMatrix[0][0]);
+    if (frameAllocation.data != nullptr)
+    {
+      // Point the attributes at the lines of the frame, and draw them.
+      streamBufferManager.commit(frameAllocation, sizeof(DebugLineVertex) * frameVerticesCount);
+      GlCalls::bindVertexArray(lineVertexArrayId);
+      describeLineAttributes(frameAllocation.bufferId, frameAllocation.offset);
+      GlCalls::drawArrays(GL_LINES, 0, frameVerticesCount);
+      GlCalls::bindVertexArray(0);
+    }
+    else
+    {
+      // The stream buffer had no room left for the lines of the frame.
+      lastFrameDroppedVerticesCount += frameVerticesCount;
+      lastFrameVerticesCount = 0;
+    }
+
+    frameVertices = nullptr;
+    frameVerticesCount = 0;
+    droppedVerticesCount = 0;
+  }
+
+  /**
+   * Get the number of line vertices drawn in the last frame.
+   * 
+   * @return The number of vertices (2 per line).
+   */
+  const uint32_t &getLastFrameVerticesCount() const
+  {
+    return lastFrameVerticesCount;
+  }
+
+  /**
+   * Get the number of line vertices dropped in the last frame, once the frame was out of room.
+   * 
+   * @return The number of dropped vertices (2 per line).
+   */
+  const uint32_t &getLastFrameDroppedVerticesCount() const
+  {
+    return lastFrameDroppedVerticesCount;
+  }
+
+  /**
+   * Returns the singleton instance of the debug draw manager.
+   * 
+   * @return The debug draw manager singleton instance.
+   */
+  static DebugDrawManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the debug draw manager singleton instance static variable.
+DebugDrawManager DebugDrawManager::instance;
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef INCLUDE_DEBUG_RENDER_CPP
 #define INCLUDE_DEBUG_RENDER_CPP
 
-#include <map>
+#include <array>
 #include <set>
 
 #include <GL/glew.h>
@@ -15,6 +15,10 @@
 #include "models.cpp"
 #include "render.cpp"
 #include "text.cpp"
+#include "profiler.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "debug_draw.cpp"
 
 class DebugRenderManager
 {
@@ -29,42 +33,32 @@ private:
   ObjectManager &objectManager;
   ShaderManager &shaderManager;
   TextManager &textManager;
+  // The CPU profiler the debug renders of the lights and the models are timed with.
+  CpuProfiler &cpuProfiler;
+  // The debug draw manager the lines of the lights, the colliders and the cameras are batched in.
+  DebugDrawManager &debugDrawManager;
   // The camera manager responsible for managing all the cameras.
   const CameraManager &cameraManager;
   // The light manager responsible for managing all the lights.
   const LightManager &lightManager;
-  // The model manager responsible for managing all the models.
-  const ModelManager &modelManager;
   // The render manager responsible for rendering to the scene to the window.
   const RenderManager &renderManager;
 
-  const std::shared_ptr<const ObjectDetails> sphereDetails;
-  const std::shared_ptr<const ShaderDetails> debugAabbShader;
-  const std::shared_ptr<const ShaderDetails> debugBoxShader;
-  const std::shared_ptr<const ShaderDetails> debugSphereShader;
-  const GLuint debugModelBufferId;
-
-  GLuint createDebugModelBuffer()
-  {
-    GLuint bufferId;
-    glGenBuffers(1, &bufferId);
-    return bufferId;
-  }
+  // The shader the wireframes of the models are drawn with, instanced like the model render (created the first time the debug
+  //   models are rendered, so that it is not loaded unless the debug mode is used).
+  std::shared_ptr<const ShaderDetails> debugWireframeShader;
 
   DebugRenderManager()
       : windowManager(WindowManager::getInstance()),
         objectManager(ObjectManager::getInstance()),
         shaderManager(ShaderManager::getInstance()),
         textManager(TextManager::getInstance()),
+        cpuProfiler(CpuProfiler::getInstance()),
+        debugDrawManager(DebugDrawManager::getInstance()),
         cameraManager(CameraManager::getInstance()),
         lightManager(LightManager::getInstance()),
-        modelManager(ModelManager::getInstance()),
         renderManager(RenderManager::getInstance()),
-        sphereDetails(objectManager.createObject("DebugSphere", "assets/objects/sphere.obj")),
-        debugAabbShader(shaderManager.createShaderProgram("DebugAabbShader", "assets/shaders/vertex/debug_aabb.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugBoxShader(shaderManager.createShaderProgram("DebugBoxShader", "assets/shaders/vertex/debug_box.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugSphereShader(shaderManager.createShaderProgram("DebugSphereShader", "assets/shaders/vertex/debug_sphere.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugModelBufferId(createDebugModelBuffer())
+        debugWireframeShader(nullptr)
   {
   }
 
@@ -73,219 +67,102 @@ public:
 
   ~DebugRenderManager()
   {
-    objectManager.destroyObject(sphereDetails);
-    shaderManager.destroyShaderProgram(debugAabbShader);
-    shaderManager.destroyShaderProgram(debugBoxShader);
-    shaderManager.destroyShaderProgram(debugSphereShader);
-    glDeleteBuffers(1, &debugModelBufferId);
-  }
-
-  std::vector<glm::vec3> getLineVertices(const std::vector<glm::vec3> &boundingBoxVertices) const
-  {
-    std::vector<glm::vec3> lineVertices({});
-    for (unsigned long i = 0; i < boundingBoxVertices.size(); i++)
+    if (debugWireframeShader != nullptr)
     {
-      for (unsigned long j = i + 1; j < boundingBoxVertices.size(); j++)
-      {
-        lineVertices.push_back(boundingBoxVertices[i]);
-        lineVertices.push_back(boundingBoxVertices[j]);
-      }
+      shaderManager.destroyShaderProgram(debugWireframeShader);
     }
-    return lineVertices;
   }
 
   void renderLights() const
   {
-    const auto activeCamera = cameraManager.getCamera(renderManager.activeCameraId);
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto lightNamesCount = std::map<const std::string, int>({});
-    auto lightNamesProcessTime = std::map<const std::string, double>({});
+    PROFILE_ZONE("Light Debug Render");
 
-    GLuint shaderId = -1;
     for (const auto &light : lightManager.getAllLights())
     {
-      if (shaderId != debugSphereShader->getShaderId())
-      {
-        shaderId = debugSphereShader->getShaderId();
-        glUseProgram(shaderId);
-      }
-
-      if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
-      {
-        lightNamesCount[light->getLightName()]++;
-      }
-      else
-      {
-        lightNamesCount[light->getLightName()] = 1;
-        lightNamesProcessTime[light->getLightName()] = 0.0f;
-      }
-
-      const auto startTime = glfwGetTime();
-
-      const auto mvpMatrixId = glGetUniformLocation(debugSphereShader->getShaderId(), "mvpMatrix");
-      const auto radiusId = glGetUniformLocation(debugSphereShader->getShaderId(), "radius");
-      const auto lineColorId = glGetUniformLocation(debugSphereShader->getShaderId(), "lineColor");
-
-      const auto mvpMatrix = projectionMatrix * viewMatrix * glm::translate(light->getLightPosition()) * glm::mat4();
-      glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-      glUniform1f(radiusId, light->getLightNearPlane());
-      glUniform4f(lineColorId, debugColor3.r, debugColor3.g, debugColor3.b, debugColor3.a);
-
-      VertexAttributeArray vertexArray("VertexArray", sphereDetails->getVertexBufferId(), 3);
-      vertexArray.enableAttribute();
-
-      glDrawArrays(GL_TRIANGLES, 0, sphereDetails->getBufferSize());
-
-      const auto endTime = glfwGetTime();
-
-      lightNamesProcessTime[light->getLightName()] += (endTime - startTime) * 1000;
+      PROFILE_ZONE(light->getLightName());
+      debugDrawManager.addSphere(light->getLightPosition(), light->getLightNearPlane(), debugColor3);
     }
 
+    // Write the debug renders of the lights of the last frame, from the zone of each light name.
     auto height = 18.5f;
-    for (const auto &lightCounts : lightNamesCount)
-    {
-      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Debug Light Render Instances: " + std::to_string(lightCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this, &height](const std::string &lightName, const ProfilerZoneStats &lightStats) {
+      textManager.beginText(glm::vec2(1, height), 0.5f) << lightName << " Debug Light Render Instances: " << lightStats.itemsCount << " | Render (avg): " << lightStats.getAverageTimeMs() << "ms";
       height -= 0.5f;
-    }
+    });
   }
 
-  void renderModels() const
+  /**
+   * Draw the wireframes of the models inside the view frustum over the scene, a draw per model group in the order of the last
+   *   model render, from the model matrices it uploaded.
+   */
+  void renderWireframes() const
   {
-    const auto activeCamera = cameraManager.getCamera(renderManager.activeCameraId);
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto modelNamesCount = std::map<const std::string, int>({});
-    auto modelNamesProcessTime = std::map<const std::string, double>({});
-
-    GLuint shaderId = -1;
-    for (const auto &model : modelManager.getAllModels())
+    const auto &packet = renderManager.framePacket;
+    GlCalls::useProgram(debugWireframeShader->getShaderId());
+    const auto &viewProjectionMatrix = packet.camera.matrices.viewProjectionMatrix;
+    GlCalls::uniformMatrix4fv(glGetUniformLocation(debugWireframeShader->getShaderId(), "viewProjectionMatrix"), 1, GL_FALSE, &viewProjectionMatrix[0][0]);
+    GlCalls::uniform4f(glGetUniformLocation(debugWireframeShader->getShaderId(), "lineColor"), debugColor2.r, debugColor2.g, debugColor2.b, debugColor2.a);
+    GlCalls::uniform1f(glGetUniformLocation(debugWireframeShader->getShaderId(), "animationTime"), packet.animationTime);
+
+    GLuint currentObjectId = 0;
+    for (const auto &renderQueueItem : renderManager.renderQueue.getItems())
     {
-      if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
-      {
-        modelNamesCount[model->getModelName()]++;
-      }
-      else
+      const auto &modelGroup = packet.modelGroups[renderQueueItem.itemIndex];
+      if (currentObjectId != modelGroup.model->getObjectDetails()->getVertexBufferId())
       {
-        modelNamesCount[model->getModelName()] = 1;
-        modelNamesProcessTime[model->getModelName()] = 0.0f;
+        currentObjectId = modelGroup.model->getObjectDetails()->getVertexBufferId();
+        GlCalls::bindVertexArray(modelGroup.model->getObjectDetails()->getVertexArrayId());
       }
+      renderManager.drawModelGroup(modelGroup, renderManager.modelMatrixBufferId, sizeof(glm::mat4));
+    }
+  }
 
-      const auto startTime = glfwGetTime();
-
-      if (model->getColliderDetails()->getColliderShape()->getType() == ColliderShapeType::SPHERE)
-      {
-        if (shaderId != debugSphereShader->getShaderId())
-        {
-          shaderId = debugSphereShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto mvpMatrixId = glGetUniformLocation(debugSphereShader->getShaderId(), "mvpMatrix");
-        const auto radiusId = glGetUniformLocation(debugSphereShader->getShaderId(), "radius");
-        const auto lineColorId = glGetUniformLocation(debugSphereShader->getShaderId(), "lineColor");
-
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform1f(radiusId, std::dynamic_pointer_cast<SphereColliderShape>(model->getColliderDetails()->getColliderShape())->getRadius());
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
-
-        VertexAttributeArray vertexArray("VertexArray", sphereDetails->getVertexBufferId(), 3);
-        vertexArray.enableAttribute();
+  void renderModels() const
+  {
+    PROFILE_ZONE("Model Debug Render");
 
-        glDrawArrays(GL_TRIANGLES, 0, sphereDetails->getBufferSize());
-      }
-      else if (model->getColliderDetails()->getColliderShape()->getType() == ColliderShapeType::BOX)
+    // Only the colliders of the models inside the view frustum are drawn, as found by the visibility of the frame.
+    const auto &packet = renderManager.framePacket;
+    for (size_t i = 0; i < packet.groupedModels.size(); i++)
+    {
+      if (!packet.visibility.isVisible(packet.camera.visibilityView, packet.groupedTransformHandles[i]))
       {
-        if (shaderId != debugBoxShader->getShaderId())
-        {
-          shaderId = debugBoxShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto mvpMatrixId = glGetUniformLocation(debugBoxShader->getShaderId(), "mvpMatrix");
-        const auto lineColorId = glGetUniformLocation(debugBoxShader->getShaderId(), "lineColor");
-
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
-
-        const auto debugModelBuffer = getLineVertices(model->getColliderDetails()->getColliderShape()->getBaseBox()->getCorners());
-        glBindBuffer(GL_ARRAY_BUFFER, debugModelBufferId);
-        glBufferData(GL_ARRAY_BUFFER, debugModelBuffer.size() * sizeof(glm::vec3), &debugModelBuffer[0], GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        VertexAttributeArray vertexArray("VertexArray", debugModelBufferId, 3);
-        vertexArray.enableAttribute();
-
-        glDrawArrays(GL_LINES, 0, debugModelBuffer.size());
+        continue;
       }
+      const auto &model = packet.groupedModels[i];
+      PROFILE_ZONE(model->getModelName());
 
+      // The colliders are batched, as their spheres or boxes along with their AABBs.
+      const auto &colliderShape = model->getColliderDetails()->getColliderShape();
+      if (colliderShape->getType() == ColliderShapeType::SPHERE)
       {
-        if (shaderId != debugBoxShader->getShaderId())
-        {
-          shaderId = debugBoxShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto mvpMatrixId = glGetUniformLocation(debugBoxShader->getShaderId(), "mvpMatrix");
-        const auto lineColorId = glGetUniformLocation(debugBoxShader->getShaderId(), "lineColor");
-
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor2.r, debugColor2.g, debugColor2.b, debugColor2.a);
-
-        VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-        vertexArray.enableAttribute();
-
-        glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
+        const auto sphereShape = std::static_pointer_cast<SphereColliderShape>(colliderShape);
+        debugDrawManager.addSphere(sphereShape->getPosition(), sphereShape->getRadius() * sphereShape->getScale().x, debugColor1);
       }
-
+      else if (colliderShape->getType() == ColliderShapeType::BOX)
       {
-        if (shaderId != debugAabbShader->getShaderId())
-        {
-          shaderId = debugAabbShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto viewMatrixId = glGetUniformLocation(debugAabbShader->getShaderId(), "viewMatrix");
-        const auto projectionMatrixId = glGetUniformLocation(debugAabbShader->getShaderId(), "projectionMatrix");
-        const auto lineColorId = glGetUniformLocation(debugAabbShader->getShaderId(), "lineColor");
-
-        glUniformMatrix4fv(viewMatrixId, 1, GL_FALSE, &viewMatrix[0][0]);
-        glUniformMatrix4fv(projectionMatrixId, 1, GL_FALSE, &projectionMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
-
-        const auto debugModelBuffer = getLineVertices(model->getColliderDetails()->getColliderShape()->getTransformedBox()->getCorners());
-        glBindBuffer(GL_ARRAY_BUFFER, debugModelBufferId);
-        glBufferData(GL_ARRAY_BUFFER, debugModelBuffer.size() * sizeof(glm::vec3), &debugModelBuffer[0], GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        VertexAttributeArray vertexArray("VertexArray", debugModelBufferId, 3);
-        vertexArray.enableAttribute();
-
-        glDrawArrays(GL_LINES, 0, debugModelBuffer.size());
+        debugDrawManager.addObb(*colliderShape->getBaseBox(), model->getModelMatrix(), debugColor1);
       }
-
-      const auto endTime = glfwGetTime();
-
-      modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
+      debugDrawManager.addAabb(colliderShape->getTransformedBox(), debugColor1);
     }
 
+    renderWireframes();
+
+    // Write the debug renders of the models of the last frame, from the zone of each model name.
     auto height = 20.0f;
-    for (const auto &modelCounts : modelNamesCount)
-    {
-      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Debug Model Render Instances: " + std::to_string(modelCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this, &height](const std::string &modelName, const ProfilerZoneStats &modelStats) {
+      textManager.beginText(glm::vec2(1, height), 0.5f) << modelName << " Debug Model Render Instances: " << modelStats.itemsCount << " | Render (avg): " << modelStats.getAverageTimeMs() << "ms";
       height -= 0.5f;
-    }
+    });
   }
 
-  void render() const
+  void render()
   {
+    GL_STATS_PASS(GlStatsPass::DEBUG);
+    if (debugWireframeShader == nullptr)
+    {
+      debugWireframeShader = shaderManager.createShaderProgram("DebugWireframeShader", "assets/shaders/vertex/debug_wireframe.glsl", "assets/shaders/fragment/debug.glsl");
+    }
     const auto currentTime = glfwGetTime();
     auto updateStartTime = currentTime, updateEndTime = currentTime;
 
@@ -294,14 +171,27 @@ public:
     updateStartTime = glfwGetTime();
     renderLights();
     updateEndTime = glfwGetTime();
-    textManager.addText("Light Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 24.5f), 0.5f);
+    textManager.beginText(glm::vec2(1, 24.5f), 0.5f) << "Light Debug Render: " << (updateEndTime - updateStartTime) * 1000 << "ms";
 
     updateStartTime = glfwGetTime();
     renderModels();
     updateEndTime = glfwGetTime();
-    textManager.addText("Model Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 24), 0.5f);
+    textManager.beginText(glm::vec2(1, 24), 0.5f) << "Model Debug Render: " << (updateEndTime - updateStartTime) * 1000 << "ms";
 
+    GlCalls::bindVertexArray(0);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    // Add the frusta of the cameras other than the active one, and draw all the lines of the frame together.
+    const auto &activeCamera = cameraManager.getCamera(renderManager.activeCameraHandle);
+    for (const auto &camera : cameraManager.getAllCameras())
+    {
+      if (camera != activeCamera)
+      {
+        debugDrawManager.addFrustum(camera->getCameraMatrices().viewProjectionMatrix, debugColor3);
+      }
+    }
+    debugDrawManager.render(activeCamera->getCameraMatrices().viewProjectionMatrix);
+    textManager.beginText(glm::vec2(1, 23.5f), 0.5f) << "Debug Lines: " << debugDrawManager.getLastFrameVerticesCount() / 2 << " | Dropped: " << debugDrawManager.getLastFrameDroppedVerticesCount() / 2;
   }
 
   static DebugRenderManager &getInstance()
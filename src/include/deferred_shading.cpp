@@ -0,0 +1,276 @@
+#ifndef INCLUDE_DEFERRED_SHADING_CPP
+#define INCLUDE_DEFERRED_SHADING_CPP
+
+#include <string>
+#include <memory>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Class for shading the models that receive light in a deferred pass, instead of while drawing them.
+ * The models are drawn into the G-buffer first (their albedo, their normal with the mask of the lights reaching them, and their
+ *   depth), using the same shaders as forward shading compiled with IS_GBUFFER_PASS. The G-buffer is then lit with a single
+ *   fullscreen triangle, compiled from the same shader with IS_DEFERRED_LIGHTING_PASS, so that each pixel is shaded only once
+ *   however many models overlap it. The models that do not receive light are still drawn forward after the lighting pass.
+ * The G-buffer is only created once deferred shading is first used, and is never multisampled.
+ */
+class DeferredShading
+{
+private:
+  // The definition that the model shaders check to only write their surface into the G-buffer.
+  static constexpr const char *GBUFFER_PASS_DEFINE = "#define IS_GBUFFER_PASS 1\n";
+  // The definition that the model shaders check to light the G-buffer instead of a model.
+  static constexpr const char *LIGHTING_PASS_DEFINE = "#define IS_DEFERRED_LIGHTING_PASS 1\n";
+
+  // The shader manager responsible for creating the lighting shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the G-buffer textures are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program lighting the G-buffer, with the features and light counts read from the frame details.
+  const std::shared_ptr<const ShaderDetails> lightingShaderDetails;
+  // The uniform IDs of the lighting shader.
+  const GLuint gBufferAlbedoTextureUniformId;
+  const GLuint gBufferNormalTextureUniformId;
+  const GLuint gBufferDepthTextureUniformId;
+  const GLuint inverseProjectionMatrixUniformId;
+  const GLuint inverseViewMatrixUniformId;
+  const GLuint gBufferViewportSizeUniformId;
+
+  // The size the G-buffer was created with (0 until it is needed).
+  glm::ivec2 gBufferSize;
+  // The framebuffer of the G-buffer, and its albedo, normal and depth textures.
+  GLuint gBufferFramebufferId;
+  GLuint albedoTextureId;
+  GLuint normalTextureId;
+  GLuint depthTextureId;
+  // The empty vertex array object the fullscreen triangle is drawn with (its vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  // The preprocessor definitions code of the models the pass definitions were last created from, and the pass definitions.
+  std::string modelDefinesCode;
+  std::string gBufferDefinesCode;
+  std::string lightingDefinesCode;
+
+  /**
+   * Create a texture of the G-buffer and attach it to the framebuffer of the G-buffer, as bound.
+   * 
+   * @param textureId       The ID of the texture to create.
+   * @param attachment      The attachment of the framebuffer.
+   * @param internalFormat  The internal format of the texture.
+   * @param format          The format of the texels.
+   * @param type            The type of the texels.
+   * @param bytesPerPixel   The size of a texel in bytes.
+   * @param textureName     The name of the texture the memory is accounted under.
+   */
+  void createGBufferTexture(GLuint &textureId, const GLenum &attachment, const GLint &internalFormat, const GLenum &format, const GLenum &type, const uint32_t &bytesPerPixel, const std::string &textureName)
+  {
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, internalFormat, gBufferSize.x, gBufferSize.y, format, type, nullptr, bytesPerPixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureId, GpuMemoryCategory::RENDER_TARGET, textureName, GpuMemoryManager::getTextureSize(gBufferSize.x, gBufferSize.y, 1, bytesPerPixel, false));
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textureId, 0);
+  }
+
+  /**
+   * Delete the G-buffer, if it was created.
+   */
+  void deleteGBuffer()
+  {
+    for (const auto &textureId : {albedoTextureId, normalTextureId, depthTextureId})
+    {
+      if (textureId != 0)
+      {
+        GlCalls::deleteTextures(1, &textureId);
+        gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, textureId);
+      }
+    }
+    if (gBufferFramebufferId != 0)
+    {
+      GlCalls::deleteFramebuffers(1, &gBufferFramebufferId);
+    }
+    albedoTextureId = normalTextureId = depthTextureId = gBufferFramebufferId = 0;
+  }
+
+  /**
+   * Create the G-buffer at the size of the viewport, if it does not exist yet or the viewport was resized since.
+   * It is as large as the scene at full resolution, so the scene scaled down by the dynamic resolution uses a corner of it.
+   */
+  void createGBuffer()
+  {
+    const auto viewportSize = glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    if (gBufferFramebufferId != 0 && gBufferSize == viewportSize)
+    {
+      return;
+    }
+    deleteGBuffer();
+    gBufferSize = viewportSize;
+
+    glGenFramebuffers(1, &gBufferFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, gBufferFramebufferId);
+    createGBufferTexture(albedoTextureId, GL_COLOR_ATTACHMENT0, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, "G-Buffer Albedo");
+    // The normals are half-floats, which also store the packed light masks exactly.
+    createGBufferTexture(normalTextureId, GL_COLOR_ATTACHMENT1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8, "G-Buffer Normal");
+    createGBufferTexture(depthTextureId, GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4, "G-Buffer Depth");
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      std::cout << "Failed at G-buffer" << std::endl;
+    }
+  }
+
+  /**
+   * Create the definitions of the G-buffer and lighting passes from the given definitions of the models, if they changed.
+   * 
+   * @param definesCode  The preprocessor definitions code the models receiving light are drawn with.
+   */
+  void updateDefinesCode(const std::string &definesCode)
+  {
+    if (definesCode == modelDefinesCode)
+    {
+      return;
+    }
+    modelDefinesCode = definesCode;
+    gBufferDefinesCode = definesCode + GBUFFER_PASS_DEFINE;
+    lightingDefinesCode = definesCode + LIGHTING_PASS_DEFINE;
+  }
+
+public:
+  DeferredShading()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        lightingShaderDetails(shaderManager.createShaderProgramWithDefines("DeferredShading::Lighting", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/default.glsl", LIGHTING_PASS_DEFINE)),
+        gBufferAlbedoTextureUniformId(shaderManager.getUniformId("gBufferAlbedoTexture")),
+        gBufferNormalTextureUniformId(shaderManager.getUniformId("gBufferNormalTexture")),
+        gBufferDepthTextureUniformId(shaderManager.getUniformId("gBufferDepthTexture")),
+        inverseProjectionMatrixUniformId(shaderManager.getUniformId("inverseProjectionMatrix")),
+        inverseViewMatrixUniformId(shaderManager.getUniformId("inverseViewMatrix")),
+        gBufferViewportSizeUniformId(shaderManager.getUniformId("gBufferViewportSize")),
+        gBufferSize(0),
+        gBufferFramebufferId(0),
+        albedoTextureId(0),
+        normalTextureId(0),
+        depthTextureId(0),
+        vertexArrayId(0),
+        modelDefinesCode(),
+        gBufferDefinesCode(),
+        lightingDefinesCode()
+  {
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~DeferredShading()
+  {
+    // Destroy the lighting shader, and delete the G-buffer.
+    shaderManager.destroyShaderProgram(lightingShaderDetails);
+    deleteGBuffer();
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+  }
+
+  // Preventing copying the deferred shading, since it owns GPU resources.
+  DeferredShading(const DeferredShading &) = delete;
+
+  /**
+   * Get the shader program the given model shader draws the surface of a model into the G-buffer with.
+   * 
+   * @param shaderDetails  The details of the shader of the model.
+   * @param definesCode    The preprocessor definitions code the models receiving light are drawn with.
+   * 
+   * @return The details of the G-buffer variant of the shader, or nullptr if the shader has no such variant or it is not compiled yet.
+   */
+  std::shared_ptr<const ShaderDetails> getGBufferShader(const std::shared_ptr<const ShaderDetails> &shaderDetails, const std::string &definesCode)
+  {
+    updateDefinesCode(definesCode);
+    const auto &gBufferShaderDetails = shaderManager.getShaderVariant(shaderDetails, gBufferDefinesCode);
+    return gBufferShaderDetails != shaderDetails ? gBufferShaderDetails : nullptr;
+  }
+
+  /**
+   * Get the shader program lighting the G-buffer, which is the variant with the features and light counts fixed at compile
+   *   time once it is compiled.
+   * 
+   * @param definesCode  The preprocessor definitions code the models receiving light are drawn with.
+   * 
+   * @return The details of the lighting shader.
+   */
+  std::shared_ptr<const ShaderDetails> getLightingShader(const std::string &definesCode)
+  {
+    updateDefinesCode(definesCode);
+    return shaderManager.getShaderVariant(lightingShaderDetails, lightingDefinesCode);
+  }
+
+  /**
+   * Bind and clear the G-buffer, with the viewport of the scene, for the models to be drawn into it.
+   * 
+   * @param viewportSize  The size of the viewport of the scene.
+   */
+  void bindGBuffer(const glm::ivec2 &viewportSize)
+  {
+    createGBuffer();
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, gBufferFramebufferId);
+    GlCalls::viewport(0, 0, viewportSize.x, viewportSize.y);
+    // Clear without touching the clear color and depth the scenes set.
+    const GLfloat clearColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat clearDepth = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, clearColor);
+    glClearBufferfv(GL_COLOR, 1, clearColor);
+    glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+  }
+
+  /**
+   * Light the G-buffer into the render target of the scene, writing the depth of the models into it as well, so that the
+   *   models drawn forward afterwards are tested against them.
+   * The lighting shader has to be in use, with the texture units of the shadowmaps and the light clusters already set.
+   * 
+   * @param lightingShader       The details of the lighting shader (as returned by getLightingShader).
+   * @param targetFramebufferId  The ID of the framebuffer the scene is rendered into.
+   * @param viewportSize         The size of the viewport of the scene.
+   * @param projectionMatrix     The projection matrix of the camera.
+   * @param viewMatrix           The view matrix of the camera.
+   * @param firstTextureUnit     The first of the three texture units to bind the G-buffer textures to.
+   */
+  void renderLighting(const std::shared_ptr<const ShaderDetails> &lightingShader, const GLuint &targetFramebufferId, const glm::ivec2 &viewportSize, const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix, const GLint &firstTextureUnit) const
+  {
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, targetFramebufferId);
+    GlCalls::viewport(0, 0, viewportSize.x, viewportSize.y);
+
+    // Bind the textures of the G-buffer.
+    const GLuint textureIds[] = {albedoTextureId, normalTextureId, depthTextureId};
+    const GLuint textureUniformIds[] = {gBufferAlbedoTextureUniformId, gBufferNormalTextureUniformId, gBufferDepthTextureUniformId};
+    for (GLint i = 0; i < 3; i++)
+    {
+      GlCalls::bindTextureUnit(firstTextureUnit + i, GL_TEXTURE_2D, textureIds[i]);
+      GlCalls::uniform1i(lightingShader->getUniformLocation(textureUniformIds[i]), firstTextureUnit + i);
+    }
+    GlCalls::uniformMatrix4fv(lightingShader->getUniformLocation(inverseProjectionMatrixUniformId), 1, GL_FALSE, &glm::inverse(projectionMatrix)[0][0]);
+    GlCalls::uniformMatrix4fv(lightingShader->getUniformLocation(inverseViewMatrixUniformId), 1, GL_FALSE, &glm::inverse(viewMatrix)[0][0]);
+    GlCalls::uniform2f(lightingShader->getUniformLocation(gBufferViewportSizeUniformId), viewportSize.x, viewportSize.y);
+
+    // Light every pixel models were drawn into with a fullscreen triangle, which writes their depth whatever was there.
+    GlCalls::depthFunc(GL_ALWAYS);
+    GlCalls::bindVertexArray(vertexArrayId);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+    GlCalls::bindVertexArray(0);
+    GlCalls::depthFunc(GL_LESS);
+
+    for (GLint i = 2; i >= 0; i--)
+    {
+      GlCalls::bindTextureUnit(firstTextureUnit + i, GL_TEXTURE_2D, 0);
+    }
+    GlCalls::activeTexture(GL_TEXTURE0);
+  }
+};
+
+#endif
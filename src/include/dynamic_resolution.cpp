@@ -0,0 +1,469 @@
+#ifndef INCLUDE_DYNAMIC_RESOLUTION_CPP
+#define INCLUDE_DYNAMIC_RESOLUTION_CPP
+
+#include <cmath>
+#include <string>
+#include <memory>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "constants.cpp"
+#include "window.cpp"
+#include "render_config.cpp"
+#include "shader.cpp"
+#include "gpu_timer.cpp"
+#include "text_arena.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * The modes of the dynamic resolution scaling of the scene.
+ */
+enum DynamicResolutionMode
+{
+  // The scene is rendered straight to the window, at the full resolution.
+  DYNAMIC_RESOLUTION_OFF,
+  // The scene is rendered at a scaled resolution, and upscaled to the window with bilinear filtering.
+  DYNAMIC_RESOLUTION_BILINEAR,
+  // The scene is rendered at a scaled resolution, and upscaled to the window with bilinear filtering and sharpening.
+  DYNAMIC_RESOLUTION_SHARPEN
+};
+
+/**
+ * The policies picking the resolution of the scene from the framebuffer of the window, before the dynamic resolution scale.
+ */
+enum RenderScalePolicy
+{
+  // The scene is rendered at the resolution of the framebuffer, with every pixel of a high pixel density display.
+  RENDER_SCALE_NATIVE,
+  // The scene is rendered at the size of the window in screen coordinates, as many pixels as on a display of standard density.
+  RENDER_SCALE_LOGICAL,
+  // The scene is rendered at the resolution of the framebuffer scaled by the custom scale of the render config.
+  RENDER_SCALE_CUSTOM
+};
+
+/**
+ * A manager class for rendering the scene into an offscreen render target with a resolution scaled to keep the GPU time of the
+ *   scene within a budget, and upscaling it to the window before the text is rendered on top at the full resolution.
+ * The render target is allocated at the full resolution of the window, and only the part of it covered by the scaled viewport is
+ *   used, so that changing the scale never reallocates it (only resizing the window does, the next time the target is bound).
+ * The scale starts from the one of the render scale policy, so that a high pixel density display can be rendered at fewer pixels
+ *   than it has.
+ * The render target also carries the anti-aliasing of the scene, either multisampled with the sample count of the mode, or
+ *   single-sampled with FXAA applied in the upscale pass.
+ */
+class DynamicResolutionManager
+{
+private:
+  // Singleton instance of the dynamic resolution manager.
+  static DynamicResolutionManager instance;
+
+  // The window manager responsible for managing the window and properties related to it.
+  WindowManager &windowManager;
+  // The GPU timer manager measuring the GPU time of the scene.
+  GpuTimerManager &gpuTimerManager;
+  // The GPU memory manager the render targets are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The framebuffer the scene is rendered into, with its color and depth renderbuffers.
+  GLuint sceneFramebufferId;
+  GLuint sceneColorRenderbufferId;
+  GLuint sceneDepthRenderbufferId;
+  // The framebuffer the scene is resolved into, with the texture it is upscaled to the window from.
+  GLuint resolveFramebufferId;
+  GLuint resolveTextureId;
+  // The empty vertex array object the fullscreen triangle is drawn with (its vertices come from the vertex IDs).
+  GLuint upscaleVertexArrayId;
+  // The shader program upscaling the scene to the window.
+  const std::shared_ptr<const ShaderDetails> upscaleShader;
+
+  // Whether the scenes render through the offscreen render target (only the game scene does).
+  bool isEnabled;
+  // The way the scene is upscaled, switched between while enabled.
+  DynamicResolutionMode mode;
+  // Whether the scene of the current frame is being rendered into the offscreen render target.
+  bool isSceneTargetBound;
+  // The scale of the resolution of the scene, relative to the window viewport.
+  float_t renderScale;
+  // The number of frames presented since the resolution scale was last changed.
+  uint32_t framesSinceAdjust;
+  // The anti-aliasing mode of the scene.
+  int32_t antiAliasingMode;
+  // The largest number of samples the renderbuffers can have.
+  GLint maxSamplesCount;
+  // The size of the viewport of the window the render targets were allocated for.
+  glm::ivec2 targetSize;
+  // The policy picking the resolution of the scene before the dynamic resolution scale, and its custom scale.
+  const RenderScalePolicy renderScalePolicy;
+  const float_t customRenderScale;
+
+  /**
+   * Get the number of samples the renderbuffers of the scene have in an anti-aliasing mode, limited to the most supported.
+   * 
+   * @param antiAliasingMode  The anti-aliasing mode.
+   * 
+   * @return The number of samples (0 for single-sampled).
+   */
+  int32_t getSamplesCount(const int32_t &antiAliasingMode) const
+  {
+    return std::min(ANTI_ALIASING_SAMPLES[antiAliasingMode], static_cast<int32_t>(maxSamplesCount));
+  }
+
+  /**
+   * Allocate the storage of the renderbuffers of the scene at the size of the render targets, with the number of samples of the
+   *   anti-aliasing mode.
+   */
+  void allocateSceneRenderbuffers()
+  {
+    const auto samplesCount = getSamplesCount(antiAliasingMode);
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneColorRenderbufferId);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samplesCount, GL_RGBA8, targetSize.x, targetSize.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneDepthRenderbufferId);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samplesCount, GL_DEPTH24_STENCIL8, targetSize.x, targetSize.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // The depth format matches the one of the window, so that the depth can be blitted the same way from either.
+    // Both formats take 4 bytes per sample, and single-sampled storage has one sample.
+    const auto renderbufferSize = GpuMemoryManager::getTextureSize(targetSize.x, targetSize.y, std::max(samplesCount, 1), 4, false);
+    gpuMemoryManager.recordAllocation(GpuResourceType::RENDERBUFFER, sceneColorRenderbufferId, GpuMemoryCategory::RENDER_TARGET, "Scene Color", renderbufferSize);
+    gpuMemoryManager.recordAllocation(GpuResourceType::RENDERBUFFER, sceneDepthRenderbufferId, GpuMemoryCategory::RENDER_TARGET, "Scene Depth", renderbufferSize);
+  }
+
+  /**
+   * Allocate the storage of the texture the scene is resolved into at the size of the render targets.
+   */
+  void allocateResolveTexture()
+  {
+    GlCalls::bindTexture(GL_TEXTURE_2D, resolveTextureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetSize.x, targetSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, resolveTextureId, GpuMemoryCategory::RENDER_TARGET, "Scene Resolve", GpuMemoryManager::getTextureSize(targetSize.x, targetSize.y, 1, 4, false));
+  }
+
+  /**
+   * Get the scale of the resolution of the scene picked by the render scale policy, relative to the framebuffer of the window.
+   * 
+   * @return The scale, within the range of the dynamic resolution scale.
+   */
+  float_t getPolicyScale() const
+  {
+    switch (renderScalePolicy)
+    {
+    case RENDER_SCALE_LOGICAL:
+      return glm::clamp(1.0f / windowManager.getPixelDensity(), DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+    case RENDER_SCALE_CUSTOM:
+      return customRenderScale;
+    default:
+      return 1.0f;
+    }
+  }
+
+  /**
+   * Check whether the scene of the current frame has to be rendered through the offscreen render target, which is the case
+   *   when its resolution is scaled (by the mode or the render scale policy), when its anti-aliasing differs from the multisampling of the window, or when the window is
+   *   headless (its offscreen framebuffer is single-sampled).
+   * 
+   * @return Whether the offscreen render target is needed.
+   */
+  bool isSceneTargetNeeded() const
+  {
+    return isEnabled && (mode != DYNAMIC_RESOLUTION_OFF || antiAliasingMode != RenderConfigManager::getConfig().antiAliasingMode || windowManager.isHeadless() || getPolicyScale() < 1.0f);
+  }
+
+  DynamicResolutionManager()
+      : windowManager(WindowManager::getInstance()),
+        gpuTimerManager(GpuTimerManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        sceneFramebufferId(0),
+        sceneColorRenderbufferId(0),
+        sceneDepthRenderbufferId(0),
+        resolveFramebufferId(0),
+        resolveTextureId(0),
+        upscaleVertexArrayId(0),
+        upscaleShader(ShaderManager::getInstance().createShaderProgram("DynamicResolution::Upscale", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/upscale.glsl")),
+        isEnabled(false),
+        mode(DYNAMIC_RESOLUTION_SHARPEN),
+        isSceneTargetBound(false),
+        renderScale(DYNAMIC_RESOLUTION_MAX_SCALE),
+        framesSinceAdjust(0),
+        antiAliasingMode(RenderConfigManager::getConfig().antiAliasingMode),
+        maxSamplesCount(0),
+        targetSize(VIEWPORT_WIDTH, VIEWPORT_HEIGHT),
+        renderScalePolicy(static_cast<RenderScalePolicy>(RenderConfigManager::getConfig().renderScalePolicy)),
+        customRenderScale(RenderConfigManager::getConfig().customRenderScale)
+  {
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamplesCount);
+
+    // Create the framebuffer of the scene, at the full size of the window viewport.
+    glGenFramebuffers(1, &sceneFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    glGenRenderbuffers(1, &sceneColorRenderbufferId);
+    glGenRenderbuffers(1, &sceneDepthRenderbufferId);
+    allocateSceneRenderbuffers();
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, sceneColorRenderbufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneDepthRenderbufferId);
+
+    // Create the resolve framebuffer, with a linearly filtered texture for the upscale to sample.
+    glGenFramebuffers(1, &resolveFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, resolveFramebufferId);
+    glGenTextures(1, &resolveTextureId);
+    allocateResolveTexture();
+    GlCalls::bindTexture(GL_TEXTURE_2D, resolveTextureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolveTextureId, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &upscaleVertexArrayId);
+  }
+
+  /**
+   * Get the size of the scaled viewport the scene is rendered with, scaled by the render scale policy and the resolution scale.
+   * 
+   * @return The width and height of the scaled viewport (in pixels).
+   */
+  glm::ivec2 getSceneSize() const
+  {
+    return glm::max(glm::ivec2(glm::round(glm::vec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT) * getPolicyScale() * renderScale)), glm::ivec2(1));
+  }
+
+  /**
+   * Move the resolution scale towards the one rendering the scene within the GPU budget, once every few frames. The GPU time
+   *   is taken to grow with the number of pixels, i.e. with the square of the scale.
+   */
+  void adjustRenderScale()
+  {
+    framesSinceAdjust++;
+    const auto gpuTime = gpuTimerManager.getTimeMs("Scene Render");
+    if (framesSinceAdjust < DYNAMIC_RESOLUTION_ADJUST_INTERVAL || gpuTime <= 0.0)
+    {
+      return;
+    }
+    framesSinceAdjust = 0;
+
+    // Leave the scale alone while the GPU time is close enough to the budget, so that it does not keep flickering.
+    const auto budgetRatio = DYNAMIC_RESOLUTION_GPU_BUDGET / gpuTime;
+    if (std::abs(budgetRatio - 1.0) <= DYNAMIC_RESOLUTION_TOLERANCE)
+    {
+      return;
+    }
+    const auto targetScale = renderScale * static_cast<float_t>(std::sqrt(budgetRatio));
+    renderScale = glm::clamp(glm::clamp(targetScale, renderScale - DYNAMIC_RESOLUTION_MAX_STEP, renderScale + DYNAMIC_RESOLUTION_MAX_STEP),
+                             DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+  }
+
+public:
+  // Preventing copying the dynamic resolution manager, making sure only one instance can exist.
+  DynamicResolutionManager(const DynamicResolutionManager &) = delete;
+
+  ~DynamicResolutionManager()
+  {
+    GlCalls::deleteVertexArrays(1, &upscaleVertexArrayId);
+    GlCalls::deleteFramebuffers(1, &resolveFramebufferId);
+    GlCalls::deleteTextures(1, &resolveTextureId);
+    GlCalls::deleteFramebuffers(1, &sceneFramebufferId);
+    glDeleteRenderbuffers(1, &sceneColorRenderbufferId);
+    glDeleteRenderbuffers(1, &sceneDepthRenderbufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, resolveTextureId);
+    gpuMemoryManager.recordRelease(GpuResourceType::RENDERBUFFER, sceneColorRenderbufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::RENDERBUFFER, sceneDepthRenderbufferId);
+  }
+
+  /**
+   * Set whether the scenes render through the offscreen render target, starting from the full resolution.
+   * 
+   * @param isEnabled  Whether the dynamic resolution scaling is enabled.
+   */
+  void setEnabled(const bool &isEnabled)
+  {
+    this->isEnabled = isEnabled;
+    renderScale = DYNAMIC_RESOLUTION_MAX_SCALE;
+    framesSinceAdjust = 0;
+  }
+
+  /**
+   * Switch to the next dynamic resolution mode, going back to the scene rendered straight to the window after the last.
+   */
+  void cycleMode()
+  {
+    mode = static_cast<DynamicResolutionMode>((mode + 1) % (DYNAMIC_RESOLUTION_SHARPEN + 1));
+    renderScale = DYNAMIC_RESOLUTION_MAX_SCALE;
+    framesSinceAdjust = 0;
+  }
+
+  /**
+   * Switch to the next anti-aliasing mode, going back to no anti-aliasing after FXAA. The renderbuffers of the scene are
+   *   reallocated with the number of samples of the mode.
+   */
+  void cycleAntiAliasingMode()
+  {
+    antiAliasingMode = (antiAliasingMode + 1) % ANTI_ALIASING_MODES_COUNT;
+    allocateSceneRenderbuffers();
+  }
+
+  /**
+   * Bind the framebuffer and viewport the scene is rendered with, which is the offscreen render target at the scaled resolution
+   *   if the dynamic resolution scaling or the anti-aliasing needs it, or the window otherwise. Done by the render manager once the shadowmaps are
+   *   rendered.
+   */
+  void bindSceneTarget()
+  {
+    isSceneTargetBound = isSceneTargetNeeded();
+    if (!isSceneTargetBound)
+    {
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, windowManager.getWindowFramebufferId());
+      windowManager.switchToWindowViewport();
+      return;
+    }
+
+    // Allocate the render targets again at the size of the window once it is resized.
+    if (targetSize != glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT))
+    {
+      targetSize = glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+      allocateSceneRenderbuffers();
+      allocateResolveTexture();
+    }
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    const auto sceneSize = getSceneSize();
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+    gpuTimerManager.beginTimer("Scene Render");
+  }
+
+  /**
+   * Get the scale of the resolution the scene is rendered with in the current frame, e.g. to scale whatever is derived from
+   *   the window coordinates of the fragments.
+   * 
+   * @return The resolution scale (1 if the scene is rendered straight to the window).
+   */
+  float_t getSceneScale() const
+  {
+    return isSceneTargetBound ? static_cast<float_t>(getSceneSize().x) / VIEWPORT_WIDTH : 1.0f;
+  }
+
+  /**
+   * Get the framebuffer the scene is rendered into in the current frame.
+   * 
+   * @return The ID of the offscreen render target (the window framebuffer if the scene is rendered straight to the window).
+   */
+  GLuint getSceneFramebufferId() const
+  {
+    return isSceneTargetBound ? sceneFramebufferId : windowManager.getWindowFramebufferId();
+  }
+
+  /**
+   * Get the size of the viewport the scene is rendered with in the current frame.
+   * 
+   * @return The width and height of the viewport (in pixels).
+   */
+  glm::ivec2 getSceneViewportSize() const
+  {
+    return isSceneTargetBound ? getSceneSize() : glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+  }
+
+  /**
+   * Upscale the scene rendered into the offscreen render target to the window, once everything in the scene (including the
+   *   debug models) is rendered, and leave the window bound for the text. Does nothing if the scene was rendered straight to
+   *   the window.
+   */
+  void presentScene()
+  {
+    if (!isSceneTargetBound)
+    {
+      return;
+    }
+    isSceneTargetBound = false;
+    gpuTimerManager.endTimer("Scene Render");
+
+    // Resolve the samples of the scaled viewport, or just copy it if single-sampled (a multisampled blit cannot scale, so it
+    //   keeps the size).
+    const auto sceneSize = getSceneSize();
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::bindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFramebufferId);
+    glBlitFramebuffer(0, 0, sceneSize.x, sceneSize.y, 0, 0, sceneSize.x, sceneSize.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    // Nothing reads the render target of the scene again before the next frame clears it, so its contents are discarded rather
+    //   than written back to memory.
+    if (windowManager.getGpuCapabilities().isInvalidateFramebufferSupported)
+    {
+      const GLenum sceneAttachments[] = {GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT};
+      glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, 2, sceneAttachments);
+    }
+
+    // Draw the resolved scene over the whole window with a fullscreen triangle, since the window may be multisampled and could
+    //   not be blitted into then.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, windowManager.getWindowFramebufferId());
+    windowManager.switchToWindowViewport();
+    GlCalls::disable(GL_DEPTH_TEST);
+
+    GlCalls::useProgram(upscaleShader->getShaderId());
+    GlCalls::bindTextureUnit(0, GL_TEXTURE_2D, resolveTextureId);
+    GlCalls::uniform1i(glGetUniformLocation(upscaleShader->getShaderId(), "sceneTexture"), 0);
+    GlCalls::uniform2f(glGetUniformLocation(upscaleShader->getShaderId(), "sceneUvScale"), static_cast<float_t>(sceneSize.x) / VIEWPORT_WIDTH, static_cast<float_t>(sceneSize.y) / VIEWPORT_HEIGHT);
+    GlCalls::uniform2f(glGetUniformLocation(upscaleShader->getShaderId(), "sceneTexelSize"), 1.0f / VIEWPORT_WIDTH, 1.0f / VIEWPORT_HEIGHT);
+    GlCalls::uniform1f(glGetUniformLocation(upscaleShader->getShaderId(), "sharpness"), mode == DYNAMIC_RESOLUTION_SHARPEN ? DYNAMIC_RESOLUTION_SHARPNESS : 0.0f);
+    GlCalls::uniform1i(glGetUniformLocation(upscaleShader->getShaderId(), "isFxaaEnabled"), antiAliasingMode == FXAA_ANTI_ALIASING_MODE);
+
+    GlCalls::bindVertexArray(upscaleVertexArrayId);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+    GlCalls::bindVertexArray(0);
+
+    GlCalls::enable(GL_DEPTH_TEST);
+
+    // The resolution is only scaled if the dynamic resolution scaling is on, and not just the anti-aliasing needs the target.
+    if (mode != DYNAMIC_RESOLUTION_OFF)
+    {
+      adjustRenderScale();
+    }
+  }
+
+  /**
+   * Write the state of the dynamic resolution scaling and the anti-aliasing as text.
+   * 
+   * @param text  The writer of the text, written the mode, the scaled resolution and the GPU time of the scene against the
+   *   budget, and the anti-aliasing mode.
+   */
+  void writeStatus(TextWriter &text)
+  {
+    const char *modeNames[] = {"Off", "Bilinear", "Sharpened"};
+    // The display names of the anti-aliasing modes, indexed by the modes.
+    const char *antiAliasingModeNames[] = {"Off", "MSAA 2x", "MSAA 4x", "MSAA 8x", "FXAA"};
+    if (!isEnabled || mode == DYNAMIC_RESOLUTION_OFF)
+    {
+      text << "Dynamic Resolution (X): " << modeNames[DYNAMIC_RESOLUTION_OFF];
+    }
+    else
+    {
+      const auto sceneSize = getSceneSize();
+      text << "Dynamic Resolution (X): " << modeNames[mode] << ", " << sceneSize.x << "x" << sceneSize.y << "px (" << static_cast<int32_t>(std::round(renderScale * 100)) << "%), GPU " << gpuTimerManager.getTimeMs("Scene Render") << "/" << DYNAMIC_RESOLUTION_GPU_BUDGET << "ms";
+    }
+
+    const auto policyScale = getPolicyScale();
+    const char *renderScalePolicyNames[] = {"Native", "Logical", "Custom"};
+    text << " | Render Scale: " << renderScalePolicyNames[renderScalePolicy] << " (" << static_cast<int32_t>(std::round(policyScale * 100)) << "%, " << windowManager.getPixelDensity() << "x Density)";
+
+    const auto activeAntiAliasingMode = isEnabled ? antiAliasingMode : RenderConfigManager::getConfig().antiAliasingMode;
+    text << " | Anti-Aliasing (N): " << antiAliasingModeNames[activeAntiAliasingMode];
+    if (getSamplesCount(activeAntiAliasingMode) < ANTI_ALIASING_SAMPLES[activeAntiAliasingMode])
+    {
+      text << " (" << maxSamplesCount << "x Max)";
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the dynamic resolution manager.
+   * 
+   * @return The dynamic resolution manager singleton instance.
+   */
+  static DynamicResolutionManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the dynamic resolution manager singleton instance static variable.
+DynamicResolutionManager DynamicResolutionManager::instance;
+
+#endif
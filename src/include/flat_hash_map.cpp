@@ -0,0 +1,386 @@
+#ifndef INCLUDE_FLAT_HASH_MAP_CPP
+#define INCLUDE_FLAT_HASH_MAP_CPP
+
+#include <vector>
+#include <optional>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+
+/**
+ * Class for mapping keys to values in a single array of slots with open addressing, so that looking up a key takes a hash and
+ *   a few probes of consecutive slots instead of walking the nodes of a tree, and inserting does not allocate a node.
+ * Keys are placed by linear probing from the slot their hash picks, and the slots following an erased key are shifted back
+ *   into it, so that no tombstones are left behind. The slots are doubled once they are three quarters full.
+ * Inserting and erasing moves the other entries around, so pointers, references and iterators to the entries are only valid
+ *   until the map is changed. The entries are iterated in no particular order.
+ */
+template <typename K, typename V, typename H = std::hash<K>>
+class FlatHashMap
+{
+public:
+  // The type of the entries of the map.
+  typedef std::pair<const K, V> value_type;
+
+private:
+  // The slots of the entries, empty for the unused ones (always a power of two of them, or none).
+  std::vector<std::optional<value_type>> slots;
+  // The number of entries in the map.
+  size_t entriesCount;
+  // The function hashing the keys.
+  H hasher;
+
+  /**
+   * Get the slot the hash of the given key picks, from the high bits of the hash mixed by a multiplication, so that the keys with
+   *   hashes differing only in their high bits (or identity hashes of consecutive numbers) are still spread.
+   * 
+   * @param key  The key.
+   * 
+   * @return The index of the slot.
+   */
+  size_t getHomeSlot(const K &key) const
+  {
+    return static_cast<size_t>((static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1);
+  }
+
+  /**
+   * Find the slot of the given key.
+   * 
+   * @param key  The key to find.
+   * 
+   * @return The index of the slot of the key, or the number of slots if it is not in the map.
+   */
+  size_t findSlot(const K &key) const
+  {
+    if (entriesCount == 0)
+    {
+      return slots.size();
+    }
+    for (auto i = getHomeSlot(key);; i = (i + 1) & (slots.size() - 1))
+    {
+      if (!slots[i].has_value())
+      {
+        return slots.size();
+      }
+      if (slots[i]->first == key)
+      {
+        return i;
+      }
+    }
+  }
+
+  /**
+   * Move the entries into a new array of slots with the given number of slots.
+   * 
+   * @param slotsCount  The number of slots, a power of two that fits all the entries within the load factor.
+   */
+  void rehash(const size_t &slotsCount)
+  {
+    auto oldSlots = std::move(slots);
+    slots = std::vector<std::optional<value_type>>(slotsCount);
+    for (auto &slot : oldSlots)
+    {
+      if (!slot.has_value())
+      {
+        continue;
+      }
+      auto i = getHomeSlot(slot->first);
+      while (slots[i].has_value())
+      {
+        i = (i + 1) & (slots.size() - 1);
+      }
+      slots[i].emplace(std::move(*slot));
+    }
+  }
+
+  /**
+   * Empty the slot at the given index, and shift the entries probed past it back, so that every entry stays reachable from the
+   *   slot its hash picks without a gap.
+   * 
+   * @param slotIndex  The index of the slot of the entry to erase.
+   */
+  void eraseSlot(size_t slotIndex)
+  {
+    slots[slotIndex].reset();
+    entriesCount--;
+    for (auto i = (slotIndex + 1) & (slots.size() - 1); slots[i].has_value(); i = (i + 1) & (slots.size() - 1))
+    {
+      // Move the entry into the gap if the gap lies between the slot its hash picks and its current slot.
+      const auto homeSlot = getHomeSlot(slots[i]->first);
+      const auto distance = (i - homeSlot) & (slots.size() - 1);
+      const auto gapDistance = (i - slotIndex) & (slots.size() - 1);
+      if (gapDistance <= distance)
+      {
+        slots[slotIndex].emplace(std::move(*slots[i]));
+        slots[i].reset();
+        slotIndex = i;
+      }
+    }
+  }
+
+  /**
+   * Class for iterating the entries of the map, skipping the unused slots.
+   */
+  template <typename S, typename E>
+  class BaseIterator
+  {
+  private:
+    // The slots of the map, and the index of the current slot.
+    S *slots;
+    size_t slotIndex;
+
+    /**
+     * Skip to the next used slot, or the end of the slots.
+     */
+    void skipUnused()
+    {
+      while (slotIndex < slots->size() && !(*slots)[slotIndex].has_value())
+      {
+        slotIndex++;
+      }
+    }
+
+  public:
+    BaseIterator(S *slots, const size_t &slotIndex)
+        : slots(slots),
+          slotIndex(slotIndex)
+    {
+      skipUnused();
+    }
+
+    E &operator*() const
+    {
+      return *(*slots)[slotIndex];
+    }
+
+    E *operator->() const
+    {
+      return &*(*slots)[slotIndex];
+    }
+
+    BaseIterator &operator++()
+    {
+      slotIndex++;
+      skipUnused();
+      return *this;
+    }
+
+    bool operator==(const BaseIterator &other) const
+    {
+      return slotIndex == other.slotIndex;
+    }
+
+    bool operator!=(const BaseIterator &other) const
+    {
+      return slotIndex != other.slotIndex;
+    }
+
+    /**
+     * Get the index of the slot the iterator is at.
+     * 
+     * @return The index of the slot.
+     */
+    const size_t &getSlotIndex() const
+    {
+      return slotIndex;
+    }
+  };
+
+public:
+  // The types of the iterators over the entries.
+  typedef BaseIterator<std::vector<std::optional<value_type>>, value_type> iterator;
+  typedef BaseIterator<const std::vector<std::optional<value_type>>, const value_type> const_iterator;
+
+  FlatHashMap()
+      : slots(),
+        entriesCount(0),
+        hasher() {}
+
+  /**
+   * Make room for the given number of entries, so that inserting them does not rehash the map.
+   * 
+   * @param count  The number of entries.
+   */
+  void reserve(const size_t &count)
+  {
+    auto slotsCount = slots.empty() ? static_cast<size_t>(8) : slots.size();
+    while (count * 4 > slotsCount * 3)
+    {
+      slotsCount *= 2;
+    }
+    if (slotsCount != slots.size())
+    {
+      rehash(slotsCount);
+    }
+  }
+
+  /**
+   * Insert an entry with the given key and value, unless the key is already in the map.
+   * 
+   * @param key    The key of the entry.
+   * @param value  The value of the entry.
+   * 
+   * @return The iterator to the entry of the key, and whether it was inserted.
+   */
+  template <typename... A>
+  std::pair<iterator, bool> emplace(const K &key, A &&...value)
+  {
+    const auto existingSlot = findSlot(key);
+    if (existingSlot != slots.size())
+    {
+      return {iterator(&slots, existingSlot), false};
+    }
+
+    reserve(entriesCount + 1);
+    auto i = getHomeSlot(key);
+    while (slots[i].has_value())
+    {
+      i = (i + 1) & (slots.size() - 1);
+    }
+    slots[i].emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<A>(value)...));
+    entriesCount++;
+    return {iterator(&slots, i), true};
+  }
+
+  /**
+   * Get the value of the given key, inserting a default one if the key is not in the map.
+   * 
+   * @param key  The key.
+   * 
+   * @return The value of the key.
+   */
+  V &operator[](const K &key)
+  {
+    return emplace(key).first->second;
+  }
+
+  /**
+   * Get the value of the given key, which must be in the map.
+   * 
+   * @param key  The key.
+   * 
+   * @return The value of the key.
+   */
+  V &at(const K &key)
+  {
+    const auto slotIndex = findSlot(key);
+    if (slotIndex == slots.size())
+    {
+      throw std::out_of_range("FlatHashMap::at");
+    }
+    return slots[slotIndex]->second;
+  }
+
+  const V &at(const K &key) const
+  {
+    const auto slotIndex = findSlot(key);
+    if (slotIndex == slots.size())
+    {
+      throw std::out_of_range("FlatHashMap::at");
+    }
+    return slots[slotIndex]->second;
+  }
+
+  /**
+   * Find the entry of the given key.
+   * 
+   * @param key  The key.
+   * 
+   * @return The iterator to the entry of the key, or the end iterator if the key is not in the map.
+   */
+  iterator find(const K &key)
+  {
+    return iterator(&slots, findSlot(key));
+  }
+
+  const_iterator find(const K &key) const
+  {
+    return const_iterator(&slots, findSlot(key));
+  }
+
+  /**
+   * Get the number of entries with the given key.
+   * 
+   * @param key  The key.
+   * 
+   * @return 1 if the key is in the map, 0 otherwise.
+   */
+  size_t count(const K &key) const
+  {
+    return findSlot(key) != slots.size() ? 1 : 0;
+  }
+
+  /**
+   * Erase the entry of the given key.
+   * 
+   * @param key  The key.
+   * 
+   * @return The number of entries erased (0 if the key is not in the map).
+   */
+  size_t erase(const K &key)
+  {
+    const auto slotIndex = findSlot(key);
+    if (slotIndex == slots.size())
+    {
+      return 0;
+    }
+    eraseSlot(slotIndex);
+    return 1;
+  }
+
+  /**
+   * Erase the entry the given iterator is at. Invalidates all the iterators, since the entries after it may shift back.
+   * 
+   * @param entry  The iterator to the entry.
+   */
+  void erase(const iterator &entry)
+  {
+    eraseSlot(entry.getSlotIndex());
+  }
+
+  /**
+   * Erase all the entries, keeping the slots for the next ones.
+   */
+  void clear()
+  {
+    for (auto &slot : slots)
+    {
+      slot.reset();
+    }
+    entriesCount = 0;
+  }
+
+  size_t size() const
+  {
+    return entriesCount;
+  }
+
+  bool empty() const
+  {
+    return entriesCount == 0;
+  }
+
+  iterator begin()
+  {
+    return iterator(&slots, 0);
+  }
+
+  iterator end()
+  {
+    return iterator(&slots, slots.size());
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(&slots, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(&slots, slots.size());
+  }
+};
+
+#endif
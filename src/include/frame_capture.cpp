@@ -0,0 +1,417 @@
+#ifndef INCLUDE_FRAME_CAPTURE_CPP
+#define INCLUDE_FRAME_CAPTURE_CPP
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "job.cpp"
+#include "window.cpp"
+#include "gl_stats.cpp"
+#include "gl_debug.cpp"
+#include "gpu_memory.cpp"
+#include "text_arena.cpp"
+
+/**
+ * A manager class for capturing the frames presented to the window as BMP files without stalling the GPU, either as one-off
+ *   screenshots or as a continuous capture of every frame (e.g. for a video of a benchmark run).
+ * The frames are read into a ring of pixel buffers with a fence each, mapped once the GPU is done with them a couple of frames
+ *   later, and written out by a task on the worker threads. If all the pixel buffers are in flight, or too many frames wait to
+ *   be written, the frame is dropped instead of waited for.
+ * The captures are requested from the main thread, and read back on the thread owning the GL context.
+ */
+class FrameCaptureManager
+{
+private:
+  /**
+   * Structure for defining a readback of a frame.
+   */
+  struct FrameReadback
+  {
+    // The ID of the pixel buffer the frame is read into.
+    GLuint pixelBufferId;
+    // The size of the pixel buffer (in bytes).
+    size_t bufferSize;
+    // The fence signaled once the frame is read (null if the readback is not in flight).
+    GLsync fence;
+    // The size of the frame read.
+    glm::ivec2 size;
+    // The path of the file the frame is written to.
+    std::string filePath;
+  };
+
+  /**
+   * Structure for defining a frame waiting to be written by a worker thread.
+   */
+  struct CapturedFrame
+  {
+    // The pixels of the frame, as BGR rows from the bottom one up, each padded to a multiple of 4 bytes like in the BMP format.
+    std::vector<uint8_t> pixels;
+    // The size of the frame.
+    glm::ivec2 size;
+    // The path of the file the frame is written to.
+    std::string filePath;
+    // The task writing the frame (null if the frame was never written).
+    std::shared_ptr<JobTask> writeTask;
+  };
+
+  // Singleton instance of the frame capture manager.
+  static FrameCaptureManager instance;
+
+  // The job manager the frames are written by.
+  JobManager &jobManager;
+  // The window manager the frames are read from.
+  WindowManager &windowManager;
+  // The GPU memory manager the pixel buffers are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The readbacks of the frames, used in turn.
+  std::array<FrameReadback, FRAME_CAPTURE_READBACK_BUFFERS> readbacks;
+  // The index of the oldest readback, which is the next one to be used.
+  uint32_t nextReadbackIndex;
+  // The frames read back, reused once they are written.
+  std::array<CapturedFrame, FRAME_CAPTURE_WRITE_BUFFERS> capturedFrames;
+
+  // Whether a screenshot is requested, taken from the next frame presented.
+  std::atomic<bool> isScreenshotRequested;
+  // Whether the frames presented are captured continuously.
+  std::atomic<bool> isContinuousCaptureRequested;
+  // Whether the continuous capture is running on the thread owning the GL context, so that a new capture is started when requested again.
+  bool isContinuousCaptureRunning;
+  // The number of screenshots and continuous captures started since the program started, which the file names are numbered with.
+  uint32_t screenshotsCount;
+  uint32_t continuousCapturesCount;
+  // The number of frames of the running (or the last) continuous capture, and how many of them were dropped.
+  std::atomic<uint32_t> continuousFramesCount;
+  std::atomic<uint32_t> droppedFramesCount;
+
+  // The lock of the last capture text, written by the worker threads.
+  mutable std::mutex statusMutex;
+  // The path of the last frame written, or the reason it could not be.
+  std::string lastCaptureText;
+
+  FrameCaptureManager()
+      : jobManager(JobManager::getInstance()),
+        windowManager(WindowManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        readbacks({}),
+        nextReadbackIndex(0),
+        capturedFrames({}),
+        isScreenshotRequested(false),
+        isContinuousCaptureRequested(false),
+        isContinuousCaptureRunning(false),
+        screenshotsCount(0),
+        continuousCapturesCount(0),
+        continuousFramesCount(0),
+        droppedFramesCount(0),
+        statusMutex(),
+        lastCaptureText("None") {}
+
+  ~FrameCaptureManager()
+  {
+    // Wait for the frames still being written, and delete the pixel buffers (only created once a frame is captured).
+    for (const auto &capturedFrame : capturedFrames)
+    {
+      if (capturedFrame.writeTask != nullptr)
+      {
+        jobManager.waitForTask(capturedFrame.writeTask);
+      }
+    }
+    for (const auto &readback : readbacks)
+    {
+      if (readback.fence != nullptr)
+      {
+        glDeleteSync(readback.fence);
+      }
+      if (readback.pixelBufferId != 0)
+      {
+        glDeleteBuffers(1, &readback.pixelBufferId);
+        gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, readback.pixelBufferId);
+      }
+    }
+  }
+
+  /**
+   * Write the given frame as a BMP file, done on a worker thread.
+   * 
+   * @param frame  The frame.
+   * 
+   * @return Whether the file could be written.
+   */
+  static bool writeBmpFile(const CapturedFrame &frame)
+  {
+    std::error_code errorCode;
+    std::filesystem::create_directories(std::filesystem::path(frame.filePath).parent_path(), errorCode);
+    std::ofstream stream(frame.filePath, std::ios::binary);
+    if (!stream)
+    {
+      return false;
+    }
+
+    // Write the file header and the info header of a 24-bit uncompressed image, whose rows go from the bottom one up like the
+    //   rows read from the window.
+    const auto imageSize = static_cast<uint32_t>(frame.pixels.size());
+    std::array<uint8_t, 54> header = {'B', 'M'};
+    const auto writeValue = [&header](const size_t &offset, const uint32_t &value, const size_t &bytesCount) {
+      for (size_t i = 0; i < bytesCount; i++)
+      {
+        header[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+      }
+    };
+    writeValue(2, static_cast<uint32_t>(header.size()) + imageSize, 4);
+    writeValue(10, static_cast<uint32_t>(header.size()), 4);
+    writeValue(14, 40, 4);
+    writeValue(18, static_cast<uint32_t>(frame.size.x), 4);
+    writeValue(22, static_cast<uint32_t>(frame.size.y), 4);
+    writeValue(26, 1, 2);
+    writeValue(28, 24, 2);
+    writeValue(34, imageSize, 4);
+    stream.write(reinterpret_cast<const char *>(header.data()), header.size());
+    stream.write(reinterpret_cast<const char *>(frame.pixels.data()), frame.pixels.size());
+    return static_cast<bool>(stream);
+  }
+
+  /**
+   * Find a captured frame done being written, to read a frame back into.
+   * 
+   * @return The captured frame, or null if all of them are still waiting to be written.
+   */
+  CapturedFrame *findFreeFrame()
+  {
+    for (auto &capturedFrame : capturedFrames)
+    {
+      if (capturedFrame.writeTask == nullptr || capturedFrame.writeTask->isFinished())
+      {
+        return &capturedFrame;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Copy the frames that are done being read by the GPU out of their pixel buffers, and start writing them on the worker threads.
+   * 
+   * @param isWaiting  Whether to wait for the frames still in flight, instead of leaving them for later.
+   */
+  void collectReadbacks(const bool &isWaiting)
+  {
+    for (uint32_t i = 0; i < readbacks.size(); i++)
+    {
+      // Check the readbacks from the oldest to the newest, stopping at the first one still in flight.
+      auto &readback = readbacks[(nextReadbackIndex + i) % readbacks.size()];
+      if (readback.fence == nullptr)
+      {
+        continue;
+      }
+      const auto waitResult = glClientWaitSync(readback.fence, isWaiting ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, isWaiting ? GL_TIMEOUT_IGNORED : 0);
+      if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+      {
+        break;
+      }
+      glDeleteSync(readback.fence);
+      readback.fence = nullptr;
+
+      // Copy the frame out into a free captured frame, dropping it if the worker threads are too far behind.
+      auto capturedFrame = findFreeFrame();
+      if (capturedFrame == nullptr)
+      {
+        droppedFramesCount++;
+        continue;
+      }
+      const auto frameSize = getFrameBufferSize(readback.size);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+      const auto pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameSize, GL_MAP_READ_BIT));
+      if (pixels != nullptr)
+      {
+        capturedFrame->pixels.assign(pixels, pixels + frameSize);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      if (pixels == nullptr)
+      {
+        droppedFramesCount++;
+        continue;
+      }
+      capturedFrame->size = readback.size;
+      capturedFrame->filePath = readback.filePath;
+
+      // Write the frame on a worker thread, keeping the last path written for the debug text.
+      capturedFrame->writeTask = jobManager.submitTask([this, capturedFrame]() {
+        const auto isWritten = writeBmpFile(*capturedFrame);
+        const std::lock_guard<std::mutex> lock(statusMutex);
+        lastCaptureText = isWritten ? capturedFrame->filePath : "Failed to write " + capturedFrame->filePath;
+      });
+    }
+  }
+
+  /**
+   * Get the size of the pixels of a frame, with the rows padded to a multiple of 4 bytes (the default pack alignment of GL, and
+   *   the row alignment of the BMP format).
+   * 
+   * @param size  The size of the frame.
+   * 
+   * @return The size of the pixels (in bytes).
+   */
+  static size_t getFrameBufferSize(const glm::ivec2 &size)
+  {
+    return static_cast<size_t>(((size.x * 3) + 3) & ~3) * size.y;
+  }
+
+public:
+  // Preventing copying the frame capture manager, making sure only one instance can exist.
+  FrameCaptureManager(const FrameCaptureManager &) = delete;
+
+  /**
+   * Request a screenshot of the next frame presented.
+   */
+  void requestScreenshot()
+  {
+    isScreenshotRequested.store(true);
+  }
+
+  /**
+   * Start capturing every frame presented, or stop the running continuous capture.
+   */
+  void toggleContinuousCapture()
+  {
+    isContinuousCaptureRequested.store(!isContinuousCaptureRequested.load());
+  }
+
+  /**
+   * Read back the frame presented to the window if it is captured, and write out the frames read back in the earlier frames.
+   * Called on the thread owning the GL context, once the scene is presented to the window (before the debug text is drawn).
+   */
+  void captureFrame()
+  {
+    collectReadbacks(false);
+
+    // Start a new continuous capture if one was requested since the last frame.
+    const auto isContinuous = isContinuousCaptureRequested.load();
+    if (isContinuous && !isContinuousCaptureRunning)
+    {
+      continuousCapturesCount++;
+      continuousFramesCount = 0;
+      droppedFramesCount = 0;
+    }
+    isContinuousCaptureRunning = isContinuous;
+    const auto isScreenshot = isScreenshotRequested.exchange(false);
+    if (!isContinuous && !isScreenshot)
+    {
+      return;
+    }
+
+    // Drop the frame if the oldest readback is still in flight, so that the GPU is never waited for.
+    auto &readback = readbacks[nextReadbackIndex];
+    if (readback.fence != nullptr)
+    {
+      droppedFramesCount++;
+      if (isScreenshot)
+      {
+        // Keep the screenshot for the next frame instead.
+        isScreenshotRequested.store(true);
+      }
+      return;
+    }
+
+    // Name the file after the screenshot, or the frame of the continuous capture.
+    if (isScreenshot)
+    {
+      readback.filePath = std::string(FRAME_CAPTURE_DIRECTORY) + "screenshot_" + std::to_string(screenshotsCount++) + ".bmp";
+    }
+    else
+    {
+      char frameName[32];
+      std::snprintf(frameName, sizeof(frameName), "/frame_%06u.bmp", continuousFramesCount++);
+      readback.filePath = std::string(FRAME_CAPTURE_DIRECTORY) + "capture_" + std::to_string(continuousCapturesCount - 1) + frameName;
+    }
+
+    // Grow the pixel buffer of the readback if the window is larger than the last frame it read.
+    readback.size = glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    const auto frameSize = getFrameBufferSize(readback.size);
+    if (readback.pixelBufferId == 0)
+    {
+      glGenBuffers(1, &readback.pixelBufferId);
+      GlDebugManager::getInstance().labelObject(GL_BUFFER, readback.pixelBufferId, "Frame Capture Pixels");
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+    if (readback.bufferSize < frameSize)
+    {
+      if (readback.bufferSize > 0)
+      {
+        gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, readback.pixelBufferId);
+      }
+      readback.bufferSize = frameSize;
+      GlCalls::bufferData(GL_PIXEL_PACK_BUFFER, readback.bufferSize, nullptr, GL_STREAM_READ);
+      gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, readback.pixelBufferId, GpuMemoryCategory::DYNAMIC, "Frame Capture", readback.bufferSize);
+    }
+
+    // Read the back buffer of the window (or the offscreen framebuffer of a headless window) into the pixel buffer, which
+    //   returns right away, and fence it.
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, windowManager.getWindowFramebufferId());
+    glReadBuffer(windowManager.isHeadless() ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glReadPixels(0, 0, readback.size.x, readback.size.y, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextReadbackIndex = (nextReadbackIndex + 1) % readbacks.size();
+  }
+
+  /**
+   * Write out all the frames captured so far, waiting for their readbacks and writes. Called on the thread owning the GL
+   *   context, before the scene capturing them ends.
+   */
+  void finishCaptures()
+  {
+    collectReadbacks(true);
+    for (const auto &capturedFrame : capturedFrames)
+    {
+      if (capturedFrame.writeTask != nullptr)
+      {
+        jobManager.waitForTask(capturedFrame.writeTask);
+      }
+    }
+  }
+
+  /**
+   * Write the state of the captures as text.
+   * 
+   * @param text  The writer of the text, written the frames of the running continuous capture or the last frame written.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+    if (isContinuousCaptureRequested.load())
+    {
+      text << "Capturing (" << continuousFramesCount.load() << " Frames, " << droppedFramesCount.load() << " Dropped)";
+    }
+    else
+    {
+      const std::lock_guard<std::mutex> lock(statusMutex);
+      text << "Last Capture: " << lastCaptureText;
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the frame capture manager.
+   * 
+   * @return The frame capture manager singleton instance.
+   */
+  static FrameCaptureManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the frame capture manager singleton instance static variable.
+FrameCaptureManager FrameCaptureManager::instance;
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef INCLUDE_FRAME_GRAPH_CPP
+#define INCLUDE_FRAME_GRAPH_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#include "job.cpp"
+#include "text_arena.cpp"
+
+/**
+ * The resources of a frame the phases of a frame graph access, as bits of an access mask.
+ */
+enum FrameResource
+{
+  LIGHTS_FRAME_RESOURCE = 1 << 0,
+  MODELS_FRAME_RESOURCE = 1 << 1,
+  TRANSFORMS_FRAME_RESOURCE = 1 << 2,
+  CAMERAS_FRAME_RESOURCE = 1 << 3,
+  TEXT_FRAME_RESOURCE = 1 << 4,
+  GPU_FRAME_RESOURCE = 1 << 5
+};
+
+/**
+ * The threads the phases of a frame graph can run on.
+ */
+enum FramePhaseThread
+{
+  // The main thread, for the phases making GL or window calls.
+  MAIN_FRAME_PHASE_THREAD,
+  // Any worker thread of the job manager, for the phases only touching memory.
+  WORKER_FRAME_PHASE_THREAD
+};
+
+/**
+ * Structure for defining the resources a phase of a frame graph accesses, each as a mask of frame resource bits.
+ */
+struct FrameResourceAccess
+{
+  // The resources the phase reads.
+  uint32_t reads;
+  // The resources the phase modifies.
+  uint32_t writes;
+  // The resources the phase only adds to (e.g. text lines), which phases adding to them as well can do at the same time.
+  uint32_t appends;
+};
+
+/**
+ * Structure for defining a phase of a frame graph.
+ */
+struct FramePhase
+{
+  // The name of the phase, used in the timings.
+  std::string name;
+  // The resources the phase accesses.
+  FrameResourceAccess access;
+  // The thread the phase runs on.
+  FramePhaseThread thread;
+  // The function running the phase.
+  std::function<void()> function;
+  // The indices of the earlier phases the phase has to wait for, derived from their resource accesses.
+  std::vector<size_t> dependencies;
+  // The time the phase started in the last frame (in seconds since the start of the frame).
+  double_t startTime;
+  // The time the phase ended in the last frame (in seconds since the start of the frame).
+  double_t endTime;
+};
+
+/**
+ * Class for running the phases of a frame as tasks on the job manager. The phases declare the resources they access instead of
+ *   their order, and each phase only waits for the earlier phases its accesses conflict with, so that independent phases
+ *   overlap (e.g. a worker thread phase with a main thread one). The phases keep the order they are added in wherever they
+ *   conflict, so the frame behaves as if they were run one after the other.
+ */
+class FrameGraph
+{
+private:
+  // The job manager running the phases.
+  JobManager &jobManager;
+
+  // The phases of the frame, in the order they are added.
+  std::vector<FramePhase> phases;
+  // The tasks of the phases of the frame being run (kept around to avoid reallocating every frame).
+  std::vector<std::shared_ptr<JobTask>> phaseTasks;
+  // The time the last frame started.
+  std::chrono::steady_clock::time_point frameStartTime;
+  // The phases of the critical path of the last frame, from the one that ended last (kept around to avoid reallocating every
+  //   frame).
+  std::vector<size_t> criticalPhases;
+
+  /**
+   * Check whether the accesses of two phases conflict, so that the later one has to wait for the earlier one.
+   * 
+   * @param earlierAccess  The accesses of the earlier phase.
+   * @param laterAccess    The accesses of the later phase.
+   * 
+   * @return Whether the accesses conflict.
+   */
+  static bool isAccessConflicting(const FrameResourceAccess &earlierAccess, const FrameResourceAccess &laterAccess)
+  {
+    return (earlierAccess.writes & (laterAccess.reads | laterAccess.writes | laterAccess.appends)) != 0 ||
+           (earlierAccess.reads & (laterAccess.writes | laterAccess.appends)) != 0 ||
+           (earlierAccess.appends & (laterAccess.reads | laterAccess.writes)) != 0;
+  }
+
+  /**
+   * Get the time since the start of the frame.
+   * 
+   * @return The time (in seconds).
+   */
+  double_t getFrameTime() const
+  {
+    return std::chrono::duration<double_t>(std::chrono::steady_clock::now() - frameStartTime).count();
+  }
+
+  /**
+   * Find the phase with the given name.
+   * 
+   * @param phaseName  The name of the phase.
+   * 
+   * @return The phase, or null if there is none.
+   */
+  const FramePhase *findPhase(const std::string &phaseName) const
+  {
+    const auto phase = std::find_if(phases.begin(), phases.end(), [&phaseName](const FramePhase &phase) { return phase.name == phaseName; });
+    return phase != phases.end() ? &*phase : nullptr;
+  }
+
+public:
+  FrameGraph()
+      : jobManager(JobManager::getInstance()),
+        phases({}),
+        phaseTasks({}),
+        frameStartTime(std::chrono::steady_clock::now()),
+        criticalPhases({}) {}
+
+  /**
+   * Add a phase to the frame, run after all the earlier phases its resource accesses conflict with.
+   * 
+   * @param name      The name of the phase.
+   * @param access    The resources the phase accesses.
+   * @param thread    The thread the phase runs on.
+   * @param function  The function running the phase.
+   */
+  void addPhase(const std::string &name, const FrameResourceAccess &access, const FramePhaseThread &thread, const std::function<void()> &function)
+  {
+    std::vector<size_t> dependencies;
+    for (size_t i = 0; i < phases.size(); i++)
+    {
+      if (isAccessConflicting(phases[i].access, access))
+      {
+        dependencies.push_back(i);
+      }
+    }
+    phases.push_back({name, access, thread, function, dependencies, 0.0, 0.0});
+  }
+
+  /**
+   * Run all the phases of the frame, and wait for them to finish, running the main thread phases on the calling main thread.
+   */
+  void execute()
+  {
+    frameStartTime = std::chrono::steady_clock::now();
+
+    // Submit the phases in order, each depending on the tasks of the phases it waits for.
+    phaseTasks.clear();
+    std::vector<std::shared_ptr<JobTask>> dependencyTasks;
+    for (auto &phase : phases)
+    {
+      dependencyTasks.clear();
+      for (const auto &dependency : phase.dependencies)
+      {
+        dependencyTasks.push_back(phaseTasks[dependency]);
+      }
+
+      // Time the phase in the task, so that the timings are all written once the tasks are finished.
+      const auto phasePointer = &phase;
+      const auto runPhase = [this, phasePointer]() {
+        phasePointer->startTime = getFrameTime();
+        phasePointer->function();
+        phasePointer->endTime = getFrameTime();
+      };
+      phaseTasks.push_back(phase.thread == MAIN_FRAME_PHASE_THREAD ? jobManager.submitMainThreadTask(runPhase, dependencyTasks) : jobManager.submitTask(runPhase, dependencyTasks));
+    }
+
+    // Wait for all the phases, which runs the main thread phases as they become ready.
+    for (const auto &phaseTask : phaseTasks)
+    {
+      jobManager.waitForTask(phaseTask);
+    }
+  }
+
+  /**
+   * Get the time the phase with the given name took in the last frame.
+   * 
+   * @param phaseName  The name of the phase.
+   * 
+   * @return The time taken by the phase (in milliseconds, 0 if there is no such phase).
+   */
+  double_t getPhaseTime(const std::string &phaseName) const
+  {
+    const auto phase = findPhase(phaseName);
+    return phase != nullptr ? (phase->endTime - phase->startTime) * 1000 : 0.0;
+  }
+
+  /**
+   * Get the time the phase with the given name ended in the last frame, counted from the start of the frame.
+   * 
+   * @param phaseName  The name of the phase.
+   * 
+   * @return The end time of the phase (in milliseconds, 0 if there is no such phase).
+   */
+  double_t getPhaseEndTime(const std::string &phaseName) const
+  {
+    const auto phase = findPhase(phaseName);
+    return phase != nullptr ? phase->endTime * 1000 : 0.0;
+  }
+
+  /**
+   * Write the critical path of the last frame as text, i.e. the chain of phases that the end of the frame waited for. Going back
+   *   from the phase that ended last, each phase waited for whichever of its dependencies (or of the earlier phases on the main
+   *   thread, for the main thread phases) ended last before it started.
+   * 
+   * @param text  The writer of the text, written the phases of the critical path with their times, in the order they ran.
+   */
+  void writeCriticalPath(TextWriter &text)
+  {
+    if (phases.empty())
+    {
+      text << "None";
+      return;
+    }
+
+    // Start from the phase that ended last.
+    auto phaseIndex = static_cast<size_t>(std::max_element(phases.begin(), phases.end(), [](const FramePhase &phase1, const FramePhase &phase2) { return phase1.endTime < phase2.endTime; }) - phases.begin());
+    criticalPhases.assign(1, phaseIndex);
+    while (true)
+    {
+      const auto &phase = phases[phaseIndex];
+      auto blockingPhaseIndex = phases.size();
+      const auto checkBlockingPhase = [this, &phase, &phaseIndex, &blockingPhaseIndex](const size_t &candidateIndex) {
+        // Only take the phases that started earlier (or at once but were added earlier), so that the walk always ends.
+        const auto &candidate = phases[candidateIndex];
+        const auto isStartedEarlier = candidate.startTime < phase.startTime || (candidate.startTime == phase.startTime && candidateIndex < phaseIndex);
+        if (isStartedEarlier && candidate.endTime <= phase.startTime && (blockingPhaseIndex == phases.size() || candidate.endTime > phases[blockingPhaseIndex].endTime))
+        {
+          blockingPhaseIndex = candidateIndex;
+        }
+      };
+      for (const auto &dependency : phase.dependencies)
+      {
+        checkBlockingPhase(dependency);
+      }
+      if (phase.thread == MAIN_FRAME_PHASE_THREAD)
+      {
+        for (size_t i = 0; i < phases.size(); i++)
+        {
+          if (i != phaseIndex && phases[i].thread == MAIN_FRAME_PHASE_THREAD)
+          {
+            checkBlockingPhase(i);
+          }
+        }
+      }
+      if (blockingPhaseIndex == phases.size())
+      {
+        break;
+      }
+      phaseIndex = blockingPhaseIndex;
+      criticalPhases.push_back(phaseIndex);
+    }
+
+    // Write the phases from the first one to run.
+    for (auto criticalPhase = criticalPhases.rbegin(); criticalPhase != criticalPhases.rend(); criticalPhase++)
+    {
+      const auto &phase = phases[*criticalPhase];
+      text << (criticalPhase == criticalPhases.rbegin() ? "" : " > ") << phase.name << " " << (phase.endTime - phase.startTime) * 1000 << "ms";
+    }
+  }
+};
+
+#endif
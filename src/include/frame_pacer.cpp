@@ -0,0 +1,213 @@
+#ifndef INCLUDE_FRAME_PACER_CPP
+#define INCLUDE_FRAME_PACER_CPP
+
+#include <cmath>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+
+#include "constants.cpp"
+#include "text_arena.cpp"
+#include "rolling_stats.cpp"
+
+/**
+ * A class for pacing the frames of the scenes to a frame rate limit, and for keeping the statistics of their frame times.
+ * The frames are held until their deadlines, which follow each other by the frame period of the limit, by sleeping until just
+ *   before the deadline and spinning for the rest, since sleeping alone overshoots by up to a scheduler tick.
+ */
+class FramePacer
+{
+private:
+  // Singleton instance of the frame pacer.
+  static FramePacer instance;
+
+  // The index of the frame rate limit of the scenes that can be switched between limits.
+  int32_t frameRateLimitIndex;
+  // The time the current frame started (in seconds, 0 before the first frame).
+  double_t frameStartTime;
+  // The time the next frame is held until (in seconds).
+  double_t nextFrameDeadline;
+  // The time from the start of the last frame to the start of the current one (in milliseconds).
+  double_t lastFrameTime;
+  // The time the last frame spent on its work, before being held until its deadline (in milliseconds).
+  double_t lastProcessTime;
+  // The statistics of the times of the last frames (in milliseconds).
+  RollingStats<FRAME_TIME_HISTORY_SIZE> frameTimeStats;
+  // The statistics of the times the last frames spent on their work (in milliseconds).
+  RollingStats<FRAME_TIME_HISTORY_SIZE> processTimeStats;
+
+  FramePacer()
+      : frameRateLimitIndex(0),
+        frameStartTime(0.0),
+        nextFrameDeadline(0.0),
+        lastFrameTime(0.0),
+        lastProcessTime(0.0),
+        frameTimeStats(),
+        processTimeStats() {}
+
+  /**
+   * Hold the calling thread until the given time.
+   * 
+   * @param deadline  The time to hold the thread until (in seconds).
+   */
+  static void waitUntil(const double_t &deadline)
+  {
+    // Sleep for most of the time left, and spin for the rest.
+    const auto sleepTime = deadline - glfwGetTime() - FRAME_PACER_SPIN_TIME;
+    if (sleepTime > 0.0)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double_t>(sleepTime));
+    }
+    while (glfwGetTime() < deadline)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+public:
+  // Preventing copying the frame pacer, making sure only one instance can exist.
+  FramePacer(const FramePacer &) = delete;
+
+  /**
+   * Forget the frames of the last scene, so that the time spent switching scenes is not counted as a frame.
+   */
+  void reset()
+  {
+    frameStartTime = 0.0;
+    lastFrameTime = 0.0;
+    lastProcessTime = 0.0;
+    frameTimeStats.reset();
+    processTimeStats.reset();
+  }
+
+  /**
+   * Mark the start of a frame, storing the time since the start of the last one.
+   */
+  void beginFrame()
+  {
+    const auto currentTime = glfwGetTime();
+    if (frameStartTime > 0.0)
+    {
+      lastFrameTime = (currentTime - frameStartTime) * 1000;
+      frameTimeStats.add(lastFrameTime);
+    }
+    else
+    {
+      nextFrameDeadline = currentTime;
+    }
+    frameStartTime = currentTime;
+  }
+
+  /**
+   * Mark the end of the work of a frame, and hold the frame until its deadline by the given frame rate limit. The deadlines keep
+   *   their cadence after a late frame, unless it fell behind by more than a frame period.
+   * 
+   * @param frameRateLimit  The frame rate to hold the frames to (in frames per second, 0 for no limit).
+   */
+  void endFrame(const uint32_t &frameRateLimit)
+  {
+    const auto currentTime = glfwGetTime();
+    lastProcessTime = (currentTime - frameStartTime) * 1000;
+    processTimeStats.add(lastProcessTime);
+    if (frameRateLimit == 0)
+    {
+      nextFrameDeadline = currentTime;
+      return;
+    }
+
+    const auto framePeriod = 1.0 / frameRateLimit;
+    nextFrameDeadline += framePeriod;
+    if (nextFrameDeadline < currentTime - framePeriod)
+    {
+      nextFrameDeadline = currentTime;
+    }
+    waitUntil(nextFrameDeadline);
+  }
+
+  /**
+   * Switch to the next frame rate limit, going back to no limit after the highest.
+   */
+  void cycleFrameRateLimit()
+  {
+    frameRateLimitIndex = (frameRateLimitIndex + 1) % FRAME_RATE_LIMITS_COUNT;
+  }
+
+  /**
+   * Get the frame rate limit of the scenes that can be switched between limits.
+   * 
+   * @return The frame rate limit (in frames per second, 0 for no limit).
+   */
+  const uint32_t &getFrameRateLimit() const
+  {
+    return FRAME_RATE_LIMITS[frameRateLimitIndex];
+  }
+
+  /**
+   * Get the time of the last frame, from its start to the start of the current one.
+   * 
+   * @return The frame time (in milliseconds).
+   */
+  const double_t &getFrameTime() const
+  {
+    return lastFrameTime;
+  }
+
+  /**
+   * Get the time the last frame spent on its work, before being held until its deadline.
+   * 
+   * @return The process time (in milliseconds).
+   */
+  const double_t &getProcessTime() const
+  {
+    return lastProcessTime;
+  }
+
+  /**
+   * Get the statistics of the times of the last frames.
+   * 
+   * @return The frame time statistics (in milliseconds).
+   */
+  const RollingStats<FRAME_TIME_HISTORY_SIZE> &getFrameTimeStats() const
+  {
+    return frameTimeStats;
+  }
+
+  /**
+   * Get the statistics of the times the last frames spent on their work.
+   * 
+   * @return The process time statistics (in milliseconds).
+   */
+  const RollingStats<FRAME_TIME_HISTORY_SIZE> &getProcessTimeStats() const
+  {
+    return processTimeStats;
+  }
+
+  /**
+   * Write the statistics of the times of the last frames as text.
+   * 
+   * @param text  The writer of the text, written the mean, the percentiles and the maximum of the frame times.
+   */
+  void writeFrameTimeStats(TextWriter &text) const
+  {
+    frameTimeStats.writeSummary(text);
+    text << " (" << frameTimeStats.getCount() << " Frames)";
+  }
+
+  /**
+   * Returns the singleton instance of the frame pacer.
+   * 
+   * @return The frame pacer singleton instance.
+   */
+  static FramePacer &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the frame pacer singleton instance static variable.
+FramePacer FramePacer::instance;
+
+#endif
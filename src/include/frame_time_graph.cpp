@@ -0,0 +1,144 @@
+#ifndef INCLUDE_FRAME_TIME_GRAPH_CPP
+#define INCLUDE_FRAME_TIME_GRAPH_CPP
+
+#include <array>
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "common.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * A manager class for drawing the times of the last frames as a line graph over the debug text, with a line for each frame time
+ *   budget, so that the spikes show up as they happen.
+ */
+class FrameTimeGraphManager
+{
+private:
+  // Singleton instance of the frame time graph manager.
+  static FrameTimeGraphManager instance;
+
+  // The number of points of the graph: one for each frame time, and two for each budget line.
+  static constexpr size_t GRAPH_POINTS_COUNT = FRAME_TIME_HISTORY_SIZE + (2 * FRAME_TIME_GRAPH_BUDGETS_COUNT);
+
+  // The color of the line of the frame times.
+  const static glm::vec4 frameTimeColor;
+  // The color of the budget lines.
+  const static glm::vec4 budgetColor;
+
+  // The shader the graph lines are drawn with.
+  const std::shared_ptr<const ShaderDetails> graphShader;
+  // The ID of the buffer of the points of the graph, refilled each time the graph is drawn.
+  const GLuint graphBufferId;
+  // The ID of the vertex array of the points of the graph.
+  const GLuint graphVertexArrayId;
+  // The points of the graph, from 0 to 1 across it and in milliseconds up it (the budget lines after the frame times).
+  std::array<glm::vec2, GRAPH_POINTS_COUNT> graphPoints;
+
+  static GLuint createGraphBuffer()
+  {
+    GLuint bufferId;
+    glGenBuffers(1, &bufferId);
+    glBindBuffer(GL_ARRAY_BUFFER, bufferId);
+    GlCalls::bufferData(GL_ARRAY_BUFFER, GRAPH_POINTS_COUNT * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DEBUG, "Frame Time Graph", GRAPH_POINTS_COUNT * sizeof(glm::vec2));
+    return bufferId;
+  }
+
+  static GLuint createGraphVertexArray(const GLuint &bufferId)
+  {
+    const auto vertexArrayId = VertexArray::createVertexArray();
+    VertexArray::enableAttribute(VertexArray::POSITION_ATTRIBUTE_ID, bufferId, 2);
+    GlCalls::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return vertexArrayId;
+  }
+
+  FrameTimeGraphManager()
+      : graphShader(ShaderManager::getInstance().createShaderProgram("FrameTimeGraph", "assets/shaders/vertex/graph.glsl", "assets/shaders/fragment/debug.glsl")),
+        graphBufferId(createGraphBuffer()),
+        graphVertexArrayId(createGraphVertexArray(graphBufferId)),
+        graphPoints({})
+  {
+    // The budget lines never move, so only the frame times are filled in each time.
+    for (size_t i = 0; i < FRAME_TIME_GRAPH_BUDGETS_COUNT; i++)
+    {
+      const auto budget = static_cast<float_t>(FRAME_TIME_GRAPH_BUDGETS[i]);
+      graphPoints[FRAME_TIME_HISTORY_SIZE + (2 * i)] = glm::vec2(0.0f, budget);
+      graphPoints[FRAME_TIME_HISTORY_SIZE + (2 * i) + 1] = glm::vec2(1.0f, budget);
+    }
+  }
+
+  ~FrameTimeGraphManager()
+  {
+    GlCalls::deleteVertexArrays(1, &graphVertexArrayId);
+    glDeleteBuffers(1, &graphBufferId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::BUFFER, graphBufferId);
+  }
+
+public:
+  // Preventing copying the frame time graph manager, making sure only one instance can exist.
+  FrameTimeGraphManager(const FrameTimeGraphManager &) = delete;
+
+  /**
+   * Draw the graph of the given frame times over whatever is on the window.
+   * 
+   * @param frameTimes       The frame times, from the oldest to the newest (in milliseconds).
+   * @param frameTimesCount  The number of frame times, at most FRAME_TIME_HISTORY_SIZE.
+   */
+  void render(const float_t *frameTimes, const size_t &frameTimesCount)
+  {
+    // Space the frame times out so that the newest is always at the right of the graph, as the full history would be.
+    for (size_t i = 0; i < frameTimesCount; i++)
+    {
+      graphPoints[i] = glm::vec2(static_cast<float_t>(FRAME_TIME_HISTORY_SIZE - frameTimesCount + i) / (FRAME_TIME_HISTORY_SIZE - 1), frameTimes[i]);
+    }
+
+    GlCalls::disable(GL_DEPTH_TEST);
+    GlCalls::useProgram(graphShader->getShaderId());
+    GlCalls::uniform4f(glGetUniformLocation(graphShader->getShaderId(), "graphRect"), FRAME_TIME_GRAPH_LEFT, FRAME_TIME_GRAPH_BOTTOM, FRAME_TIME_GRAPH_RIGHT, FRAME_TIME_GRAPH_TOP);
+    GlCalls::uniform1f(glGetUniformLocation(graphShader->getShaderId(), "maxTime"), static_cast<float_t>(FRAME_TIME_GRAPH_MAX_TIME));
+    const auto lineColorId = glGetUniformLocation(graphShader->getShaderId(), "lineColor");
+
+    // Upload the frame times along with the budget lines after them.
+    glBindBuffer(GL_ARRAY_BUFFER, graphBufferId);
+    GlCalls::bufferSubData(GL_ARRAY_BUFFER, 0, GRAPH_POINTS_COUNT * sizeof(glm::vec2), graphPoints.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GlCalls::bindVertexArray(graphVertexArrayId);
+
+    GlCalls::uniform4f(lineColorId, budgetColor.r, budgetColor.g, budgetColor.b, budgetColor.a);
+    GlCalls::drawArrays(GL_LINES, FRAME_TIME_HISTORY_SIZE, 2 * FRAME_TIME_GRAPH_BUDGETS_COUNT);
+    if (frameTimesCount > 1)
+    {
+      GlCalls::uniform4f(lineColorId, frameTimeColor.r, frameTimeColor.g, frameTimeColor.b, frameTimeColor.a);
+      GlCalls::drawArrays(GL_LINE_STRIP, 0, frameTimesCount);
+    }
+
+    GlCalls::bindVertexArray(0);
+    GlCalls::enable(GL_DEPTH_TEST);
+  }
+
+  /**
+   * Returns the singleton instance of the frame time graph manager.
+   * 
+   * @return The frame time graph manager singleton instance.
+   */
+  static FrameTimeGraphManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the frame time graph manager singleton instance static variable.
+FrameTimeGraphManager FrameTimeGraphManager::instance;
+
+const glm::vec4 FrameTimeGraphManager::frameTimeColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+const glm::vec4 FrameTimeGraphManager::budgetColor = glm::vec4(1.0f, 0.5f, 0.0f, 1.0f);
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef INCLUDE_FRUSTUM_CPP
+#define INCLUDE_FRUSTUM_CPP
+
+#include <array>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+/**
+ * Class for defining a view frustum in world space, used to check what is visible to a camera or light.
+ */
+class Frustum
+{
+private:
+  // The planes of the frustum (left, right, bottom, top, near, far).
+  //   The xyz components are the normal pointing into the frustum, and the w component is the distance from the origin.
+  std::array<glm::vec4, 6> planes;
+
+public:
+  Frustum() : planes({}) {}
+
+  Frustum(const glm::mat4 &vpMatrix)
+  {
+    // Grab the rows of the projection-view matrix (glm matrices are indexed by column first).
+    std::array<glm::vec4, 4> rows;
+    for (auto i = 0; i < 4; i++)
+    {
+      rows[i] = glm::vec4(vpMatrix[0][i], vpMatrix[1][i], vpMatrix[2][i], vpMatrix[3][i]);
+    }
+
+    // Each plane is the sum or difference of the last row and the row of its axis.
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      planes[axis * 2] = rows[3] + rows[axis];
+      planes[(axis * 2) + 1] = rows[3] - rows[axis];
+    }
+
+    // Normalize the planes so that the w component is the actual distance from the origin.
+    for (auto &plane : planes)
+    {
+      plane /= glm::length(glm::vec3(plane));
+    }
+  }
+
+  /**
+   * Get the planes of the frustum.
+   * 
+   * @return The frustum planes (left, right, bottom, top, near, far).
+   */
+  const std::array<glm::vec4, 6> &getPlanes() const
+  {
+    return planes;
+  }
+
+  /**
+   * Check if the given axis-aligned box is at least partially inside the frustum.
+   * 
+   * @param minCorner  The corner of the box with the smallest coordinates.
+   * @param maxCorner  The corner of the box with the largest coordinates.
+   * 
+   * @return Whether the box is inside the frustum or not.
+   */
+  bool isBoxInside(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const
+  {
+    // Iterate through all the frustum planes.
+    for (const auto &plane : planes)
+    {
+      // Pick the corner of the box furthest along the normal of the plane.
+      const glm::vec3 furthestCorner(plane.x >= 0 ? maxCorner.x : minCorner.x,
+                                     plane.y >= 0 ? maxCorner.y : minCorner.y,
+                                     plane.z >= 0 ? maxCorner.z : minCorner.z);
+      // If even that corner is behind the plane, the whole box is outside the frustum.
+      if (glm::dot(glm::vec3(plane), furthestCorner) + plane.w < 0)
+      {
+        return false;
+      }
+    }
+
+    // The box is not fully behind any plane, so consider it inside.
+    return true;
+  }
+
+  /**
+   * Check if the given axis-aligned box is fully inside the frustum, so that everything inside the box is inside the frustum too.
+   * 
+   * @param minCorner  The corner of the box with the smallest coordinates.
+   * @param maxCorner  The corner of the box with the largest coordinates.
+   * 
+   * @return Whether the box is fully inside the frustum or not.
+   */
+  bool isBoxContained(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const
+  {
+    for (const auto &plane : planes)
+    {
+      // Pick the corner of the box furthest against the normal of the plane, which has to be in front of the plane as well.
+      const glm::vec3 nearestCorner(plane.x >= 0 ? minCorner.x : maxCorner.x,
+                                    plane.y >= 0 ? minCorner.y : maxCorner.y,
+                                    plane.z >= 0 ? minCorner.z : maxCorner.z);
+      if (glm::dot(glm::vec3(plane), nearestCorner) + plane.w < 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Get how far the given point is outside the frustum, approximated by the distance behind the plane it is furthest behind.
+   * 
+   * @param point  The point to measure.
+   * 
+   * @return The distance of the point outside the frustum (0 if it is inside).
+   */
+  float_t getDistance(const glm::vec3 &point) const
+  {
+    auto distance = 0.0f;
+    for (const auto &plane : planes)
+    {
+      distance = std::max(distance, -(glm::dot(glm::vec3(plane), point) + plane.w));
+    }
+    return distance;
+  }
+};
+
+#endif
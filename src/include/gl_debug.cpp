@@ -0,0 +1,234 @@
+#ifndef INCLUDE_GL_DEBUG_CPP
+#define INCLUDE_GL_DEBUG_CPP
+
+#include <set>
+#include <mutex>
+#include <tuple>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "constants.cpp"
+#include "profiler.cpp"
+#include "text_arena.cpp"
+
+/**
+ * Structure for defining the numbers of the GL debug messages of each kind received in a frame.
+ */
+struct GlDebugMessageCounts
+{
+  // The number of errors (and undefined behaviour).
+  uint64_t errors;
+  // The number of performance warnings (e.g. buffer stalls and shader recompiles).
+  uint64_t performanceWarnings;
+  // The number of the other messages (e.g. deprecated behaviour and portability issues).
+  uint64_t otherMessages;
+};
+
+/**
+ * A manager class for the messages of the GL debug context, received through glDebugMessageCallback. The notifications and the
+ *   debug group markers are filtered out by the driver, and the rest are counted by kind for each frame, with each distinct
+ *   message reported the first time it is received. The context is synchronous, so the messages are received by the thread the
+ *   GL context is current on inside the call causing them, and the counts of the last frame are handed over under a mutex for
+ *   the debug text (written on any thread) to read.
+ */
+class GlDebugManager
+{
+private:
+  // Singleton instance of the GL debug manager.
+  static GlDebugManager instance;
+
+  // The CPU profiler the counts of the frames are recorded into while it captures a trace.
+  CpuProfiler &cpuProfiler;
+
+  // Whether the debug messages of the context are received, and the GL objects labeled.
+  bool isEnabled;
+  // The counts of the frame being rendered.
+  GlDebugMessageCounts frameCounts;
+  // The IDs of the messages reported so far, by their sources and types, so that each is reported once.
+  std::set<std::tuple<GLenum, GLenum, GLuint>> reportedMessages;
+  // The mutex guarding the counts of the last frame and the last performance warning.
+  mutable std::mutex lastFrameMutex;
+  // The counts of the last frame rendered.
+  GlDebugMessageCounts lastFrameCounts;
+  // The last performance warning received.
+  std::string lastPerformanceWarning;
+
+  GlDebugManager()
+      : cpuProfiler(CpuProfiler::getInstance()),
+        isEnabled(false),
+        frameCounts({0, 0, 0}),
+        reportedMessages(),
+        lastFrameCounts({0, 0, 0}),
+        lastPerformanceWarning("None") {}
+
+  /**
+   * Get the name of a type of the GL debug messages.
+   * 
+   * @param type  The type of the message.
+   * 
+   * @return The name of the type.
+   */
+  static const char *getTypeName(const GLenum &type)
+  {
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR:
+      return "Error";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+      return "Undefined Behavior";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+      return "Deprecated Behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:
+      return "Portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:
+      return "Performance";
+    default:
+      return "Other";
+    }
+  }
+
+  /**
+   * Receive a message of the GL debug context, counting it and reporting it if it was not received before.
+   * 
+   * @param source    The source of the message (e.g. the API or the shader compiler).
+   * @param type      The type of the message.
+   * @param id        The ID of the message, unique within its source and type.
+   * @param severity  The severity of the message.
+   * @param length    The length of the message.
+   * @param message   The text of the message.
+   */
+  void receiveMessage(const GLenum &source, const GLenum &type, const GLuint &id, const GLenum &severity, const GLsizei &length, const GLchar *message)
+  {
+    if (type == GL_DEBUG_TYPE_ERROR || type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR)
+    {
+      frameCounts.errors++;
+    }
+    else if (type == GL_DEBUG_TYPE_PERFORMANCE)
+    {
+      frameCounts.performanceWarnings++;
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      // Cut the warning off at the length of a line of the debug text.
+      lastPerformanceWarning.assign(message, std::min<GLsizei>(length, MAX_TEXT_LENGTH));
+    }
+    else
+    {
+      frameCounts.otherMessages++;
+    }
+
+    if (reportedMessages.size() < GL_DEBUG_REPORTED_MESSAGES_COUNT && reportedMessages.emplace(source, type, id).second)
+    {
+      std::cerr << "GL " << getTypeName(type) << " (" << (severity == GL_DEBUG_SEVERITY_HIGH ? "High" : severity == GL_DEBUG_SEVERITY_MEDIUM ? "Medium" : "Low") << ", " << id << "): " << std::string(message, length) << std::endl;
+    }
+  }
+
+  /**
+   * The callback of the GL debug context, passing the messages on to the manager.
+   */
+  static void GLAPIENTRY messageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
+  {
+    static_cast<GlDebugManager *>(const_cast<void *>(userParam))->receiveMessage(source, type, id, severity, length, message);
+  }
+
+public:
+  // Preventing copying the GL debug manager, making sure only one instance can exist.
+  GlDebugManager(const GlDebugManager &) = delete;
+
+  /**
+   * Start receiving the messages of the GL debug context, if the context is one and the driver supports the debug output. Done
+   *   once the GL context is created and GLEW is initialized.
+   */
+  void enable()
+  {
+    GLint contextFlags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+    if (!IS_GL_DEBUG_CONTEXT_ENABLED || !(GLEW_VERSION_4_3 || GLEW_KHR_debug) || (contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+    {
+      return;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    // Receive the messages inside the calls causing them, so that they can be traced back to the calls in a debugger.
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(messageCallback, this);
+    // Filter out the notifications (e.g. the buffer placements) and the debug group markers, which are not problems.
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    isEnabled = true;
+  }
+
+  /**
+   * Label a GL object with a name, shown for it by the GPU debuggers (e.g. RenderDoc and Nsight). Ignored unless the messages
+   *   of the debug context are received.
+   * 
+   * @param identifier  The kind of the object (e.g. GL_BUFFER, GL_TEXTURE or GL_PROGRAM).
+   * @param objectId    The ID of the object, which has to be bound at least once before it can be labeled.
+   * @param label       The name of the object.
+   */
+  void labelObject(const GLenum &identifier, const GLuint &objectId, const std::string &label) const
+  {
+    if (isEnabled && objectId != 0)
+    {
+      glObjectLabel(identifier, objectId, static_cast<GLsizei>(label.size()), label.c_str());
+    }
+  }
+
+  /**
+   * End the frame on the thread rendering it, handing its counts over to the debug text and to the trace being captured (if
+   *   any), and start counting the next one.
+   */
+  void endFrame()
+  {
+    if (!isEnabled)
+    {
+      return;
+    }
+    if (cpuProfiler.isCaptureRunning())
+    {
+      const auto time = CpuProfiler::getTimestamp();
+      cpuProfiler.recordCounter("GL Errors", time, frameCounts.errors);
+      cpuProfiler.recordCounter("GL Performance Warnings", time, frameCounts.performanceWarnings);
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      lastFrameCounts = frameCounts;
+    }
+    frameCounts = {0, 0, 0};
+  }
+
+  /**
+   * Write the counts of the messages of the last frame as text, along with the last performance warning.
+   * 
+   * @param text  The writer of the text, written the counts.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+    if (!isEnabled)
+    {
+      text << (IS_GL_DEBUG_CONTEXT_ENABLED ? "Not Supported" : "Off");
+      return;
+    }
+    const std::lock_guard<std::mutex> lock(lastFrameMutex);
+    text << "Errors: " << lastFrameCounts.errors << " | Performance: " << lastFrameCounts.performanceWarnings << " | Other: " << lastFrameCounts.otherMessages << " | Last Performance: " << lastPerformanceWarning;
+  }
+
+  /**
+   * Returns the singleton instance of the GL debug manager.
+   * 
+   * @return The GL debug manager singleton instance.
+   */
+  static GlDebugManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GL debug manager singleton instance static variable.
+GlDebugManager GlDebugManager::instance;
+
+#endif
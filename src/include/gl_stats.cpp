@@ -0,0 +1,839 @@
+#ifndef INCLUDE_GL_STATS_CPP
+#define INCLUDE_GL_STATS_CPP
+
+#include <array>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "profiler.cpp"
+#include "text_arena.cpp"
+
+// The GL calls are only counted if the build defines GL_STATS_ENABLED, and the wrappers forward straight to GL otherwise.
+#ifdef GL_STATS_ENABLED
+// Count the GL calls made until the end of the enclosing scope in the given pass.
+#define GL_STATS_PASS(pass) const GlStatsPassScope CPU_PROFILER_CONCAT(glStatsPass, __LINE__)(pass)
+#else
+#define GL_STATS_PASS(pass)
+#endif
+
+/**
+ * An enum for the passes of a frame the GL calls are counted in.
+ */
+enum class GlStatsPass
+{
+  SHADOWS,
+  DEPTH_PRE_PASS,
+  MODELS,
+  VIEWS,
+  DEBUG,
+  TEXT,
+  // Everything outside the other passes (e.g. the upscale and the frame time graph).
+  OTHER,
+  COUNT
+};
+
+/**
+ * Structure for defining the numbers of the GL calls of a kind made in a pass.
+ */
+struct GlCallCounts
+{
+  // The number of draw calls.
+  uint64_t draws;
+  // The number of shader program binds.
+  uint64_t programBinds;
+  // The number of texture binds.
+  uint64_t textureBinds;
+  // The number of vertex array object binds.
+  uint64_t vertexArrayBinds;
+  // The number of buffer and texture uploads, and the number of bytes uploaded by them.
+  uint64_t uploads;
+  uint64_t uploadedBytes;
+  // The number of uniform calls.
+  uint64_t uniformCalls;
+  // The number of state changes dropped for setting the state it already had.
+  uint64_t redundantCalls;
+
+  /**
+   * Add the counts of another pass to these.
+   * 
+   * @param other  The counts to add.
+   */
+  void add(const GlCallCounts &other)
+  {
+    draws += other.draws;
+    programBinds += other.programBinds;
+    textureBinds += other.textureBinds;
+    vertexArrayBinds += other.vertexArrayBinds;
+    uploads += other.uploads;
+    uploadedBytes += other.uploadedBytes;
+    uniformCalls += other.uniformCalls;
+    redundantCalls += other.redundantCalls;
+  }
+};
+
+/**
+ * A manager class for counting the GL calls made through GlCalls in each pass of a frame. The calls are only made by the thread
+ *   the GL context is current on, so the counts of the frame being rendered are not guarded, and are handed over under a mutex
+ *   when the frame ends for the debug text (written on any thread) to read.
+ */
+class GlStatsManager
+{
+private:
+  // Singleton instance of the GL stats manager.
+  static GlStatsManager instance;
+
+  // The names of the passes, shown in the debug text.
+  static constexpr std::array<const char *, static_cast<size_t>(GlStatsPass::COUNT)> PASS_NAMES = {"Shadows", "Depth", "Models", "Views", "Debug", "Text", "Other"};
+
+  // The CPU profiler the counts of the frames are recorded into while it captures a trace.
+  CpuProfiler &cpuProfiler;
+
+  // The counts of the frame being rendered, by pass.
+  std::array<GlCallCounts, static_cast<size_t>(GlStatsPass::COUNT)> frameCounts;
+  // The pass the calls are counted in.
+  GlStatsPass currentPass;
+  // The mutex guarding the counts of the last frame.
+  mutable std::mutex lastFrameMutex;
+  // The counts of the last frame rendered, by pass.
+  std::array<GlCallCounts, static_cast<size_t>(GlStatsPass::COUNT)> lastFrameCounts;
+
+  GlStatsManager()
+      : cpuProfiler(CpuProfiler::getInstance()),
+        frameCounts({}),
+        currentPass(GlStatsPass::OTHER),
+        lastFrameCounts({}) {}
+
+public:
+  // Preventing copying the GL stats manager, making sure only one instance can exist.
+  GlStatsManager(const GlStatsManager &) = delete;
+
+  /**
+   * Get the counts of the pass the calls are counted in.
+   * 
+   * @return The counts of the current pass.
+   */
+  GlCallCounts &getCurrentCounts()
+  {
+    return frameCounts[static_cast<size_t>(currentPass)];
+  }
+
+  /**
+   * Set the pass the next calls are counted in.
+   * 
+   * @param pass  The pass.
+   * 
+   * @return The pass the calls were counted in before.
+   */
+  GlStatsPass setPass(const GlStatsPass &pass)
+  {
+    const auto previousPass = currentPass;
+    currentPass = pass;
+    return previousPass;
+  }
+
+  /**
+   * End the frame on the thread rendering it, handing its counts over to the debug text and to the trace being captured (if any),
+   *   and start counting the next one.
+   */
+  void endFrame()
+  {
+    if (cpuProfiler.isCaptureRunning())
+    {
+      auto totalCounts = GlCallCounts({});
+      for (const auto &passCounts : frameCounts)
+      {
+        totalCounts.add(passCounts);
+      }
+      const auto time = CpuProfiler::getTimestamp();
+      cpuProfiler.recordCounter("Draws", time, totalCounts.draws);
+      cpuProfiler.recordCounter("Program Binds", time, totalCounts.programBinds);
+      cpuProfiler.recordCounter("Texture Binds", time, totalCounts.textureBinds);
+      cpuProfiler.recordCounter("Vertex Array Binds", time, totalCounts.vertexArrayBinds);
+      cpuProfiler.recordCounter("Uploads", time, totalCounts.uploads);
+      cpuProfiler.recordCounter("Uploaded KB", time, totalCounts.uploadedBytes / 1024.0);
+      cpuProfiler.recordCounter("Uniform Calls", time, totalCounts.uniformCalls);
+      cpuProfiler.recordCounter("Redundant Calls", time, totalCounts.redundantCalls);
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      lastFrameCounts = frameCounts;
+    }
+    frameCounts = {};
+  }
+
+  /**
+   * Get the counts of the last frame rendered, over all the passes. Can be called from any thread.
+   * 
+   * @return The total counts of the last frame (all 0 if the calls are not counted).
+   */
+  GlCallCounts getLastFrameTotalCounts() const
+  {
+    auto totalCounts = GlCallCounts({});
+    const std::lock_guard<std::mutex> lock(lastFrameMutex);
+    for (const auto &passCounts : lastFrameCounts)
+    {
+      totalCounts.add(passCounts);
+    }
+    return totalCounts;
+  }
+
+  /**
+   * Write the counts of the last frame as text, with the draws split by pass.
+   * 
+   * @param text  The writer of the text, written the counts.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+#ifdef GL_STATS_ENABLED
+    auto passCounts = std::array<GlCallCounts, static_cast<size_t>(GlStatsPass::COUNT)>({});
+    {
+      const std::lock_guard<std::mutex> lock(lastFrameMutex);
+      passCounts = lastFrameCounts;
+    }
+    auto totalCounts = GlCallCounts({});
+    for (const auto &counts : passCounts)
+    {
+      totalCounts.add(counts);
+    }
+
+    text << "Draws: " << totalCounts.draws << " (";
+    for (size_t i = 0; i < passCounts.size(); i++)
+    {
+      text << (i == 0 ? "" : ", ") << PASS_NAMES[i] << " " << passCounts[i].draws;
+    }
+    text << ") | Programs: " << totalCounts.programBinds << " | Textures: " << totalCounts.textureBinds << " | Vertex Arrays: " << totalCounts.vertexArrayBinds << " | Uploads: " << totalCounts.uploads << " (" << totalCounts.uploadedBytes / 1024.0 << "KB) | Uniforms: " << totalCounts.uniformCalls << " | Redundant: " << totalCounts.redundantCalls;
+#else
+    text << "Not Counted (GL_STATS Off)";
+#endif
+  }
+
+  /**
+   * Returns the singleton instance of the GL stats manager.
+   * 
+   * @return The GL stats manager singleton instance.
+   */
+  static GlStatsManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GL stats manager singleton instance static variable.
+GlStatsManager GlStatsManager::instance;
+
+/**
+ * A class for counting the GL calls of a scope in a pass, going back to the pass counted in before when it ends.
+ */
+class GlStatsPassScope
+{
+private:
+  // The pass counted in before the scope.
+  const GlStatsPass previousPass;
+
+public:
+  explicit GlStatsPassScope(const GlStatsPass &pass)
+      : previousPass(GlStatsManager::getInstance().setPass(pass)) {}
+
+  ~GlStatsPassScope()
+  {
+    GlStatsManager::getInstance().setPass(previousPass);
+  }
+
+  // Preventing copying the scope, since it would restore the pass twice.
+  GlStatsPassScope(const GlStatsPassScope &) = delete;
+};
+
+/**
+ * Structure for defining the GL state last set through GlCalls, so that the calls setting a state to the value it already has
+ *   can be dropped. Every state starts unknown, so that the first call setting it always reaches GL.
+ * The element array buffer binding is part of the vertex array object state, and the generic buffer bindings are changed by the
+ *   indexed binds as well, so the buffer bindings are not tracked.
+ */
+struct GlStateCache
+{
+  // The value of a state that was not set through GlCalls yet.
+  static constexpr GLuint UNKNOWN = std::numeric_limits<GLuint>::max();
+  // The number of texture units whose bindings are tracked (the binds of the units after them always reach GL).
+  static constexpr GLuint TEXTURE_UNITS_COUNT = 32;
+
+  // The shader program in use.
+  GLuint programId;
+  // The bound program pipeline (only used while no shader program is in use).
+  GLuint programPipelineId;
+  // The bound vertex array object.
+  GLuint vertexArrayId;
+  // The framebuffers bound for drawing and reading.
+  GLuint drawFramebufferId;
+  GLuint readFramebufferId;
+  // The active texture unit.
+  GLenum activeTexture;
+  // The target and texture of the last bind of each texture unit, which is still bound to that target of the unit.
+  std::array<std::pair<GLenum, GLuint>, TEXTURE_UNITS_COUNT> textureBindings;
+  // The viewport (offset, then size).
+  std::array<GLint, 4> viewport;
+  // Whether blending, face culling and depth testing are enabled (0 or 1).
+  GLuint blendState;
+  GLuint cullFaceState;
+  GLuint depthTestState;
+  // The factors of the blend function (source, then destination).
+  std::array<GLenum, 2> blendFactors;
+  // The faces culled.
+  GLenum cullFaceMode;
+  // The depth test function.
+  GLenum depthFunc;
+  // Whether the depth buffer is written (0 or 1).
+  GLuint depthMask;
+  // Whether the wrappers having a direct state access form make their calls with it, without binding the objects they change
+  //   (set once the GL context is known to support it).
+  bool isDirectStateAccessEnabled;
+
+  GlStateCache()
+      : programId(UNKNOWN),
+        programPipelineId(UNKNOWN),
+        vertexArrayId(UNKNOWN),
+        drawFramebufferId(UNKNOWN),
+        readFramebufferId(UNKNOWN),
+        activeTexture(UNKNOWN),
+        textureBindings(),
+        viewport({-1, -1, -1, -1}),
+        blendState(UNKNOWN),
+        cullFaceState(UNKNOWN),
+        depthTestState(UNKNOWN),
+        blendFactors({UNKNOWN, UNKNOWN}),
+        cullFaceMode(UNKNOWN),
+        depthFunc(UNKNOWN),
+        depthMask(UNKNOWN),
+        isDirectStateAccessEnabled(false)
+  {
+    textureBindings.fill({UNKNOWN, UNKNOWN});
+  }
+
+  /**
+   * Get the enabled state of the given capability, if it is one of the tracked ones.
+   * 
+   * @param capability  The capability.
+   * 
+   * @return The enabled state of the capability, or nullptr if it is not tracked.
+   */
+  GLuint *getCapabilityState(const GLenum &capability)
+  {
+    switch (capability)
+    {
+    case GL_BLEND:
+      return &blendState;
+    case GL_CULL_FACE:
+      return &cullFaceState;
+    case GL_DEPTH_TEST:
+      return &depthTestState;
+    default:
+      return nullptr;
+    }
+  }
+};
+
+/**
+ * A class of thin wrappers of the GL calls the render passes make, which count them in the current pass before making them.
+ * The calls changing the state tracked by the GL state cache are dropped if the state already has the value, so the tracked state
+ *   must only be changed through these wrappers.
+ */
+class GlCalls
+{
+private:
+  /**
+   * Get the GL state last set through the wrappers, of the one GL context all the calls are made on.
+   * 
+   * @return The GL state cache.
+   */
+  static GlStateCache &getStateCache()
+  {
+    static GlStateCache stateCache;
+    return stateCache;
+  }
+
+  /**
+   * Check if a state change is redundant, counting it if it is.
+   * 
+   * @param isRedundant  Whether the state already has the value the call sets.
+   * 
+   * @return Whether the call is redundant, and should be dropped.
+   */
+  static bool isRedundantCall(const bool &isRedundant)
+  {
+#ifdef GL_STATS_ENABLED
+    if (isRedundant)
+    {
+      getCounts().redundantCalls++;
+    }
+#endif
+    return isRedundant;
+  }
+  /**
+   * Get the counts the calls are added to.
+   * 
+   * @return The counts of the current pass.
+   */
+  static GlCallCounts &getCounts()
+  {
+    return GlStatsManager::getInstance().getCurrentCounts();
+  }
+
+  /**
+   * Count an upload.
+   * 
+   * @param size  The number of bytes uploaded.
+   */
+  static void countUpload(const uint64_t &size)
+  {
+#ifdef GL_STATS_ENABLED
+    auto &counts = getCounts();
+    counts.uploads++;
+    counts.uploadedBytes += size;
+#else
+    static_cast<void>(size);
+#endif
+  }
+
+public:
+  /**
+   * Set whether the wrappers having a direct state access form (GL 4.5 or ARB_direct_state_access) make their calls with it.
+   * 
+   * @param isEnabled  Whether the direct state access calls are made.
+   */
+  static void setDirectStateAccessEnabled(const bool &isEnabled)
+  {
+    getStateCache().isDirectStateAccessEnabled = isEnabled;
+  }
+
+  /**
+   * Check if the wrappers having a direct state access form make their calls with it.
+   * 
+   * @return Whether the direct state access calls are made.
+   */
+  static bool isDirectStateAccessEnabled()
+  {
+    return getStateCache().isDirectStateAccessEnabled;
+  }
+
+  static void drawArrays(const GLenum &mode, const GLint &first, const GLsizei &count)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().draws++;
+#endif
+    glDrawArrays(mode, first, count);
+  }
+
+  static void drawArraysInstanced(const GLenum &mode, const GLint &first, const GLsizei &count, const GLsizei &instanceCount)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().draws++;
+#endif
+    glDrawArraysInstanced(mode, first, count, instanceCount);
+  }
+
+  static void drawElements(const GLenum &mode, const GLsizei &count, const GLenum &type, const void *indices)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().draws++;
+#endif
+    glDrawElements(mode, count, type, indices);
+  }
+
+  static void drawElementsInstanced(const GLenum &mode, const GLsizei &count, const GLenum &type, const void *indices, const GLsizei &instanceCount)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().draws++;
+#endif
+    glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+  }
+
+  static void multiDrawElementsIndirect(const GLenum &mode, const GLenum &type, const void *indirect, const GLsizei &drawCount, const GLsizei &stride)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().draws++;
+#endif
+    glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+  }
+
+  static void useProgram(const GLuint &programId)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.programId == programId))
+    {
+      return;
+    }
+#ifdef GL_STATS_ENABLED
+    getCounts().programBinds++;
+#endif
+    stateCache.programId = programId;
+    glUseProgram(programId);
+  }
+
+  static void bindProgramPipeline(const GLuint &programPipelineId)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.programPipelineId == programPipelineId))
+    {
+      return;
+    }
+#ifdef GL_STATS_ENABLED
+    getCounts().programBinds++;
+#endif
+    stateCache.programPipelineId = programPipelineId;
+    glBindProgramPipeline(programPipelineId);
+  }
+
+  static void deleteProgramPipelines(const GLsizei &count, const GLuint *programPipelineIds)
+  {
+    // Deleting the bound program pipeline binds none instead.
+    auto &stateCache = getStateCache();
+    for (GLsizei i = 0; i < count; i++)
+    {
+      if (stateCache.programPipelineId == programPipelineIds[i])
+      {
+        stateCache.programPipelineId = GlStateCache::UNKNOWN;
+      }
+    }
+    glDeleteProgramPipelines(count, programPipelineIds);
+  }
+
+  static void activeTexture(const GLenum &textureUnit)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.activeTexture == textureUnit))
+    {
+      return;
+    }
+    stateCache.activeTexture = textureUnit;
+    glActiveTexture(textureUnit);
+  }
+
+  static void bindTexture(const GLenum &target, const GLuint &textureId)
+  {
+    // Only the texture units whose binds are tracked, and that are known to be active, can drop the bind.
+    auto &stateCache = getStateCache();
+    const auto unitIndex = stateCache.activeTexture - GL_TEXTURE0;
+    const auto isUnitTracked = stateCache.activeTexture != GlStateCache::UNKNOWN && unitIndex < GlStateCache::TEXTURE_UNITS_COUNT;
+    if (isUnitTracked && isRedundantCall(stateCache.textureBindings[unitIndex] == std::make_pair(target, textureId)))
+    {
+      return;
+    }
+#ifdef GL_STATS_ENABLED
+    getCounts().textureBinds++;
+#endif
+    if (isUnitTracked)
+    {
+      stateCache.textureBindings[unitIndex] = {target, textureId};
+    }
+    glBindTexture(target, textureId);
+  }
+
+  /**
+   * Bind a texture to the given texture unit. With direct state access, the texture is bound without changing the active texture
+   *   unit, which is left as it was, so that the binds not going through a unit have to set it first. Otherwise, the unit is
+   *   made active before the bind.
+   * 
+   * @param unit       The index of the texture unit.
+   * @param target     The target of the texture (the target of the texture itself with direct state access).
+   * @param textureId  The ID of the texture (0 unbinds every target of the unit with direct state access).
+   */
+  static void bindTextureUnit(const GLuint &unit, const GLenum &target, const GLuint &textureId)
+  {
+    auto &stateCache = getStateCache();
+    if (!stateCache.isDirectStateAccessEnabled)
+    {
+      activeTexture(GL_TEXTURE0 + unit);
+      bindTexture(target, textureId);
+      return;
+    }
+    const auto isUnitTracked = unit < GlStateCache::TEXTURE_UNITS_COUNT;
+    if (isUnitTracked && isRedundantCall(stateCache.textureBindings[unit] == std::make_pair(target, textureId)))
+    {
+      return;
+    }
+#ifdef GL_STATS_ENABLED
+    getCounts().textureBinds++;
+#endif
+    if (isUnitTracked)
+    {
+      stateCache.textureBindings[unit] = {target, textureId};
+    }
+    glBindTextureUnit(unit, textureId);
+  }
+
+  static void deleteTextures(const GLsizei &count, const GLuint *textureIds)
+  {
+    // Deleting a texture unbinds it from every unit it is bound to.
+    auto &stateCache = getStateCache();
+    for (GLsizei i = 0; i < count; i++)
+    {
+      for (auto &textureBinding : stateCache.textureBindings)
+      {
+        if (textureBinding.second == textureIds[i])
+        {
+          textureBinding = {GlStateCache::UNKNOWN, GlStateCache::UNKNOWN};
+        }
+      }
+    }
+    glDeleteTextures(count, textureIds);
+  }
+
+  static void bindVertexArray(const GLuint &vertexArrayId)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.vertexArrayId == vertexArrayId))
+    {
+      return;
+    }
+#ifdef GL_STATS_ENABLED
+    getCounts().vertexArrayBinds++;
+#endif
+    stateCache.vertexArrayId = vertexArrayId;
+    glBindVertexArray(vertexArrayId);
+  }
+
+  static void deleteVertexArrays(const GLsizei &count, const GLuint *vertexArrayIds)
+  {
+    // Deleting the bound vertex array object binds the default one instead.
+    auto &stateCache = getStateCache();
+    for (GLsizei i = 0; i < count; i++)
+    {
+      if (stateCache.vertexArrayId == vertexArrayIds[i])
+      {
+        stateCache.vertexArrayId = GlStateCache::UNKNOWN;
+      }
+    }
+    glDeleteVertexArrays(count, vertexArrayIds);
+  }
+
+  static void bindFramebuffer(const GLenum &target, const GLuint &framebufferId)
+  {
+    auto &stateCache = getStateCache();
+    const auto isDrawBound = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    const auto isReadBound = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if (isRedundantCall((!isDrawBound || stateCache.drawFramebufferId == framebufferId) && (!isReadBound || stateCache.readFramebufferId == framebufferId)))
+    {
+      return;
+    }
+    if (isDrawBound)
+    {
+      stateCache.drawFramebufferId = framebufferId;
+    }
+    if (isReadBound)
+    {
+      stateCache.readFramebufferId = framebufferId;
+    }
+    glBindFramebuffer(target, framebufferId);
+  }
+
+  static void deleteFramebuffers(const GLsizei &count, const GLuint *framebufferIds)
+  {
+    // Deleting a bound framebuffer binds the default framebuffer instead.
+    auto &stateCache = getStateCache();
+    for (GLsizei i = 0; i < count; i++)
+    {
+      if (stateCache.drawFramebufferId == framebufferIds[i])
+      {
+        stateCache.drawFramebufferId = GlStateCache::UNKNOWN;
+      }
+      if (stateCache.readFramebufferId == framebufferIds[i])
+      {
+        stateCache.readFramebufferId = GlStateCache::UNKNOWN;
+      }
+    }
+    glDeleteFramebuffers(count, framebufferIds);
+  }
+
+  static void viewport(const GLint &x, const GLint &y, const GLsizei &width, const GLsizei &height)
+  {
+    auto &stateCache = getStateCache();
+    const std::array<GLint, 4> newViewport = {x, y, width, height};
+    if (isRedundantCall(stateCache.viewport == newViewport))
+    {
+      return;
+    }
+    stateCache.viewport = newViewport;
+    glViewport(x, y, width, height);
+  }
+
+  static void enable(const GLenum &capability)
+  {
+    auto capabilityState = getStateCache().getCapabilityState(capability);
+    if (capabilityState != nullptr)
+    {
+      if (isRedundantCall(*capabilityState == 1))
+      {
+        return;
+      }
+      *capabilityState = 1;
+    }
+    glEnable(capability);
+  }
+
+  static void disable(const GLenum &capability)
+  {
+    auto capabilityState = getStateCache().getCapabilityState(capability);
+    if (capabilityState != nullptr)
+    {
+      if (isRedundantCall(*capabilityState == 0))
+      {
+        return;
+      }
+      *capabilityState = 0;
+    }
+    glDisable(capability);
+  }
+
+  static void blendFunc(const GLenum &sourceFactor, const GLenum &destinationFactor)
+  {
+    auto &stateCache = getStateCache();
+    const std::array<GLenum, 2> newBlendFactors = {sourceFactor, destinationFactor};
+    if (isRedundantCall(stateCache.blendFactors == newBlendFactors))
+    {
+      return;
+    }
+    stateCache.blendFactors = newBlendFactors;
+    glBlendFunc(sourceFactor, destinationFactor);
+  }
+
+  static void cullFace(const GLenum &mode)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.cullFaceMode == mode))
+    {
+      return;
+    }
+    stateCache.cullFaceMode = mode;
+    glCullFace(mode);
+  }
+
+  static void depthFunc(const GLenum &function)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.depthFunc == function))
+    {
+      return;
+    }
+    stateCache.depthFunc = function;
+    glDepthFunc(function);
+  }
+
+  static void depthMask(const GLboolean &isWritten)
+  {
+    auto &stateCache = getStateCache();
+    if (isRedundantCall(stateCache.depthMask == isWritten))
+    {
+      return;
+    }
+    stateCache.depthMask = isWritten;
+    glDepthMask(isWritten);
+  }
+
+  static void bufferData(const GLenum &target, const GLsizeiptr &size, const void *data, const GLenum &usage)
+  {
+    // Only count the storage filled with data, not the storage just allocated (or orphaned).
+    if (data != nullptr)
+    {
+      countUpload(size);
+    }
+    glBufferData(target, size, data, usage);
+  }
+
+  static void bufferSubData(const GLenum &target, const GLintptr &offset, const GLsizeiptr &size, const void *data)
+  {
+    countUpload(size);
+    glBufferSubData(target, offset, size, data);
+  }
+
+  /**
+   * Upload a part of the storage of the given buffer. With direct state access, the buffer is written without being bound.
+   *   Otherwise, it is bound to the given target for the upload, which is left without a buffer bound afterwards.
+   */
+  static void namedBufferSubData(const GLenum &target, const GLuint &bufferId, const GLintptr &offset, const GLsizeiptr &size, const void *data)
+  {
+    countUpload(size);
+    if (getStateCache().isDirectStateAccessEnabled)
+    {
+      glNamedBufferSubData(bufferId, offset, size, data);
+      return;
+    }
+    glBindBuffer(target, bufferId);
+    glBufferSubData(target, offset, size, data);
+    glBindBuffer(target, 0);
+  }
+
+  /**
+   * Upload the whole image of a texture level (without a border), counting the upload with the given texel size since GL does
+   *   not tell.
+   */
+  static void texImage2D(const GLenum &target, const GLint &level, const GLint &internalFormat, const GLsizei &width, const GLsizei &height, const GLenum &format, const GLenum &type, const void *pixels, const GLsizei &bytesPerPixel)
+  {
+    if (pixels != nullptr)
+    {
+      countUpload(static_cast<uint64_t>(width) * height * bytesPerPixel);
+    }
+    glTexImage2D(target, level, internalFormat, width, height, 0, format, type, pixels);
+  }
+
+  /**
+   * Upload a part of the image of a texture level, counting the upload with the given texel size since GL does not tell.
+   */
+  static void texSubImage2D(const GLenum &target, const GLint &level, const GLint &xOffset, const GLint &yOffset, const GLsizei &width, const GLsizei &height, const GLenum &format, const GLenum &type, const void *pixels, const GLsizei &bytesPerPixel)
+  {
+    countUpload(static_cast<uint64_t>(width) * height * bytesPerPixel);
+    glTexSubImage2D(target, level, xOffset, yOffset, width, height, format, type, pixels);
+  }
+
+  static void uniform1i(const GLint &location, const GLint &value)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniform1i(location, value);
+  }
+
+  static void uniform1f(const GLint &location, const GLfloat &value)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniform1f(location, value);
+  }
+
+  static void uniform2f(const GLint &location, const GLfloat &x, const GLfloat &y)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniform2f(location, x, y);
+  }
+
+  static void uniform2i(const GLint &location, const GLint &x, const GLint &y)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniform2i(location, x, y);
+  }
+
+  static void uniform4f(const GLint &location, const GLfloat &x, const GLfloat &y, const GLfloat &z, const GLfloat &w)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniform4f(location, x, y, z, w);
+  }
+
+  static void uniformMatrix4fv(const GLint &location, const GLsizei &count, const GLboolean &transpose, const GLfloat *value)
+  {
+#ifdef GL_STATS_ENABLED
+    getCounts().uniformCalls++;
+#endif
+    glUniformMatrix4fv(location, count, transpose, value);
+  }
+};
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef INCLUDE_GPU_CULLING_CPP
+#define INCLUDE_GPU_CULLING_CPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "common.cpp"
+#include "window.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "render_packet.cpp"
+
+/**
+ * Structure for defining an instance culled by the GPU culling compute shader.
+ * The layout matches the CullInstance structure in the shader.
+ */
+struct GpuCullInstanceData
+{
+  // The corner of the world AABB of the instance with the smallest coordinates.
+  glm::vec3 minCorner;
+  // The index of the model group of the instance.
+  uint32_t groupIndex;
+  // The corner of the world AABB of the instance with the largest coordinates.
+  glm::vec3 maxCorner;
+  // Whether the instance is hidden behind the depth of the last frames (tested on the CPU).
+  uint32_t isOccluded;
+};
+
+/**
+ * Structure for defining a model group culled by the GPU culling compute shader.
+ * The layout matches the CullGroup structure in the shader.
+ */
+struct GpuCullGroupData
+{
+  // The number of levels of detail of the object of the group.
+  uint32_t lodsCount;
+  // The index of the draw command of the first level of detail of the group.
+  uint32_t firstCommand;
+  // Padding to keep the groups 16 byte aligned.
+  uint32_t padding[2];
+};
+
+/**
+ * Structure for defining an indirect draw command, as read by glMultiDrawElementsIndirect.
+ */
+struct DrawElementsIndirectCommand
+{
+  // The number of indices of the level of detail.
+  uint32_t count;
+  // The number of instances to draw, counted by the culling compute shader.
+  uint32_t instanceCount;
+  // The index of the first index of the level of detail in the element buffer.
+  uint32_t firstIndex;
+  // The value added to the indices before reading the vertices.
+  int32_t baseVertex;
+  // The index of the first culled instance of the level of detail, which the per-instance attributes start at.
+  uint32_t baseInstance;
+};
+
+static_assert(sizeof(GpuCullInstanceData) == 32, "GpuCullInstanceData does not match the std430 layout of the shader");
+static_assert(sizeof(GpuCullGroupData) == 16, "GpuCullGroupData does not match the std430 layout of the shader");
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand does not match the layout of indirect draws");
+static_assert(OBJECT_LOD_COUNT - 1 <= 4, "The screen sizes of the levels of detail must fit the vec4 uniform of the shader");
+
+/**
+ * Class for culling the models against the view frustum and picking their levels of detail on the GPU, so that each model group
+ *   is drawn with a single indirect multi-draw (one draw command per level of detail) instead of an instanced draw call and an
+ *   attribute setup per level. A compute shader compacts the per-instance details of the visible models into a region of their
+ *   own per level of detail of each group, counting them in the draw commands, so nothing is read back to the CPU.
+ * Needs OpenGL 4.3 (compute shaders, shader storage buffers and indirect multi-draws with base instances), so it is only used
+ *   when the window manager reports it as supported.
+ */
+class GpuModelCulling
+{
+private:
+  /**
+   * An enum for the binding points of the shader storage buffers of the culling compute shader (matching the bindings in the shader).
+   */
+  enum StorageBinding : GLuint
+  {
+    INSTANCES_BINDING,
+    GROUPS_BINDING,
+    MODEL_MATRICES_BINDING,
+    LIGHT_MASKS_BINDING,
+    TEXTURE_LAYERS_BINDING,
+    COMMANDS_BINDING,
+    CULLED_MODEL_MATRICES_BINDING,
+    CULLED_ATTRIBUTES_BINDING
+  };
+
+  // The shader manager responsible for creating the culling compute shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the buffers are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program details of the culling compute shader (null if the GPU-driven rendering is not supported).
+  const std::shared_ptr<const ShaderDetails> cullShaderDetails;
+  // The uniform IDs of the culling compute shader.
+  std::array<GLuint, 6> frustumPlaneUniformIds;
+  const GLuint cameraDetailsUniformId;
+  const GLuint lodScreenSizesUniformId;
+  const GLuint instancesCountUniformId;
+
+  // The ID of the buffer containing the instances to cull.
+  const GLuint instanceBufferId;
+  // The ID of the buffer containing the model groups of the instances.
+  const GLuint groupBufferId;
+  // The ID of the buffer containing the draw commands of every level of detail of every model group.
+  const GLuint commandBufferId;
+  // The ID of the buffer containing the model matrices of the visible instances, compacted by level of detail.
+  const GLuint culledModelMatrixBufferId;
+  // The ID of the buffer containing the light masks and texture layers of the visible instances, compacted by level of detail.
+  const GLuint culledAttributeBufferId;
+
+  // The instances to cull, in the same order as the model matrices (kept around to avoid reallocating every frame).
+  std::vector<GpuCullInstanceData> instances;
+  // The model groups of the instances (kept around to avoid reallocating every frame).
+  std::vector<GpuCullGroupData> groups;
+  // The draw commands of every level of detail of every model group, with no instances counted yet (kept around to avoid
+  //   reallocating every frame).
+  std::vector<DrawElementsIndirectCommand> commands;
+
+  /**
+   * Create a new buffer.
+   * 
+   * @return The ID of the created buffer.
+   */
+  static GLuint createBuffer()
+  {
+    GLuint bufferId;
+    glGenBuffers(1, &bufferId);
+    return bufferId;
+  }
+
+  /**
+   * Write the given data into the given buffer, replacing its storage, and bind it to the given binding point of the
+   *   culling compute shader.
+   * 
+   * @param bufferId  The ID of the buffer.
+   * @param binding   The binding point of the shader storage buffer.
+   * @param data      The data to write (null to only allocate the storage).
+   * @param dataSize  The size of the data in bytes.
+   */
+  void writeBuffer(const GLuint &bufferId, const StorageBinding &binding, const void *data, const GLsizeiptr &dataSize)
+  {
+    // Orphan the old storage so that the GPU can keep reading it while the new data is written, keeping at least a single
+    //   model matrix so that the buffer is never bound empty.
+    const auto bufferSize = std::max<GLsizeiptr>(dataSize, sizeof(glm::mat4));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferId);
+    GlCalls::bufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, dataSize > 0 ? data : nullptr, GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, bufferId);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "GPU Culling", bufferSize);
+  }
+
+public:
+  GpuModelCulling()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        cullShaderDetails(WindowManager::getInstance().isGpuDrivenRenderingSupported() ? shaderManager.createComputeShaderProgram("GpuCulling::Shader", "assets/shaders/compute/model_cull.glsl") : nullptr),
+        frustumPlaneUniformIds({}),
+        cameraDetailsUniformId(shaderManager.getUniformId("cameraDetails")),
+        lodScreenSizesUniformId(shaderManager.getUniformId("lodScreenSizes")),
+        instancesCountUniformId(shaderManager.getUniformId("instancesCount")),
+        instanceBufferId(createBuffer()),
+        groupBufferId(createBuffer()),
+        commandBufferId(createBuffer()),
+        culledModelMatrixBufferId(createBuffer()),
+        culledAttributeBufferId(createBuffer()),
+        instances({}),
+        groups({}),
+        commands({})
+  {
+    for (uint32_t i = 0; i < frustumPlaneUniformIds.size(); i++)
+    {
+      frustumPlaneUniformIds[i] = shaderManager.getUniformId("frustumPlanes[" + std::to_string(i) + "]");
+    }
+  }
+
+  ~GpuModelCulling()
+  {
+    // Destroy the culling compute shader if it was created.
+    if (cullShaderDetails != nullptr)
+    {
+      shaderManager.destroyShaderProgram(cullShaderDetails);
+    }
+    // Delete the buffers.
+    const GLuint bufferIds[] = {instanceBufferId, groupBufferId, commandBufferId, culledModelMatrixBufferId, culledAttributeBufferId};
+    for (const auto &bufferId : bufferIds)
+    {
+      glDeleteBuffers(1, &bufferId);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, bufferId);
+    }
+  }
+
+  // Preventing copying the GPU culling, since it owns GPU buffers.
+  GpuModelCulling(const GpuModelCulling &) = delete;
+
+  /**
+   * Cull all the models of the given render packet against the view frustum of its camera on the GPU, filling the draw commands
+   *   of the model groups with their visible instances.
+   * The per-instance buffers must already contain the details of all the models of the groups, not only the visible ones, and
+   *   the GPU-driven rendering must be supported.
+   * 
+   * @param packet                     The render packet of the frame.
+   * @param modelMatrixBufferId        The ID of the buffer containing the model matrices of all the models.
+   * @param modelLightMaskBufferId     The ID of the buffer containing the light masks of all the models.
+   * @param modelTextureLayerBufferId  The ID of the buffer containing the texture layers of all the models (only read when the
+   *                                     textures are batched).
+   */
+  void cull(const RenderPacket &packet, const GLuint &modelMatrixBufferId, const GLuint &modelLightMaskBufferId, const GLuint &modelTextureLayerBufferId)
+  {
+    // Give each level of detail of each model group a region of culled instances as large as the group, which the draw command
+    //   of the level starts its instances at.
+    instances.resize(packet.groupedModels.size());
+    groups.clear();
+    commands.clear();
+    uint32_t culledInstancesCount = 0;
+    for (uint32_t i = 0; i < packet.modelGroups.size(); i++)
+    {
+      const auto &modelGroup = packet.modelGroups[i];
+      const auto &objectDetails = modelGroup.model->getObjectDetails();
+      groups.push_back({objectDetails->getLodsCount(), static_cast<uint32_t>(commands.size()), {0, 0}});
+      for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
+      {
+        const auto &lod = objectDetails->getLod(l);
+        commands.push_back({lod.indexCount, 0, lod.indexOffset, 0, culledInstancesCount});
+        culledInstancesCount += l < objectDetails->getLodsCount() ? modelGroup.instanceCount : 0;
+      }
+      for (auto k = modelGroup.instanceOffset; k < modelGroup.instanceOffset + modelGroup.instanceCount; k++)
+      {
+        instances[k] = {packet.groupedMinCorners[k], i, packet.groupedMaxCorners[k], packet.groupedOcclusions[k]};
+      }
+    }
+
+    // Write the instances, groups and draw commands, and allocate the culled instances.
+    writeBuffer(instanceBufferId, INSTANCES_BINDING, instances.data(), instances.size() * sizeof(GpuCullInstanceData));
+    writeBuffer(groupBufferId, GROUPS_BINDING, groups.data(), groups.size() * sizeof(GpuCullGroupData));
+    writeBuffer(commandBufferId, COMMANDS_BINDING, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+    writeBuffer(culledModelMatrixBufferId, CULLED_MODEL_MATRICES_BINDING, nullptr, culledInstancesCount * sizeof(glm::mat4));
+    writeBuffer(culledAttributeBufferId, CULLED_ATTRIBUTES_BINDING, nullptr, culledInstancesCount * sizeof(glm::uvec2));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Read the details of the models from the buffers they are drawn from by the CPU-driven path.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MODEL_MATRICES_BINDING, modelMatrixBufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_MASKS_BINDING, modelLightMaskBufferId);
+    if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+    {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TEXTURE_LAYERS_BINDING, modelTextureLayerBufferId);
+    }
+
+    // Set the view frustum, the camera and the level of detail sizes, and cull the instances.
+    GlCalls::useProgram(cullShaderDetails->getShaderId());
+    const auto &frustumPlanes = packet.camera.matrices.frustum.getPlanes();
+    for (uint32_t i = 0; i < frustumPlanes.size(); i++)
+    {
+      GlCalls::uniform4f(cullShaderDetails->getUniformLocation(frustumPlaneUniformIds[i]), frustumPlanes[i].x, frustumPlanes[i].y, frustumPlanes[i].z, frustumPlanes[i].w);
+    }
+    GlCalls::uniform4f(cullShaderDetails->getUniformLocation(cameraDetailsUniformId), packet.camera.position.x, packet.camera.position.y, packet.camera.position.z, packet.camera.matrices.projectionMatrix[1][1]);
+    auto lodScreenSizes = glm::vec4(0.0f);
+    std::copy(OBJECT_LOD_SCREEN_SIZES, OBJECT_LOD_SCREEN_SIZES + OBJECT_LOD_COUNT - 1, &lodScreenSizes[0]);
+    GlCalls::uniform4f(cullShaderDetails->getUniformLocation(lodScreenSizesUniformId), lodScreenSizes.x, lodScreenSizes.y, lodScreenSizes.z, lodScreenSizes.w);
+    GlCalls::uniform1i(cullShaderDetails->getUniformLocation(instancesCountUniformId), static_cast<GLint>(instances.size()));
+    glDispatchCompute((static_cast<GLuint>(instances.size()) + GPU_CULLING_WORK_GROUP_SIZE - 1) / GPU_CULLING_WORK_GROUP_SIZE, 1, 1);
+
+    // Make the counted draw commands and the culled instances visible to the draws reading them.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+  }
+
+  /**
+   * Draw the visible models of the given model group with a single indirect multi-draw, with a draw command per level of detail.
+   * The vertex array object of the model object must already be bound, and the models must have been culled in the frame.
+   * 
+   * @param groupIndex               The index of the model group in the render packet.
+   * @param modelMatrixAttributeId   The ID of the first vertex attribute of the model matrix (a matrix takes up four attribute IDs).
+   * @param lightMaskAttributeId     The ID of the vertex attribute of the light mask (not pointed at if 0, which is always a
+   *                                   per-vertex attribute).
+   * @param textureLayerAttributeId  The ID of the vertex attribute of the texture layer (not pointed at if 0).
+   */
+  void drawModelGroup(const uint32_t &groupIndex, const GLuint &modelMatrixAttributeId, const GLuint &lightMaskAttributeId, const GLuint &textureLayerAttributeId) const
+  {
+    // Point the per-instance attributes at the start of the culled instances, which the base instance of each draw command
+    //   offsets to its region.
+    for (GLuint i = 0; i < 4; i++)
+    {
+      VertexArray::enableAttribute(modelMatrixAttributeId + i, culledModelMatrixBufferId, 4, GL_FLOAT, 1, sizeof(glm::mat4), i * sizeof(glm::vec4));
+    }
+    if (lightMaskAttributeId != 0)
+    {
+      VertexArray::enableAttribute(lightMaskAttributeId, culledAttributeBufferId, 1, GL_UNSIGNED_INT, 1, sizeof(glm::uvec2), 0);
+    }
+    if (textureLayerAttributeId != 0)
+    {
+      VertexArray::enableAttribute(textureLayerAttributeId, culledAttributeBufferId, 1, GL_UNSIGNED_INT, 1, sizeof(glm::uvec2), sizeof(uint32_t));
+    }
+
+    // Draw every level of detail of the group, skipping the ones with no visible instances counted.
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBufferId);
+    GlCalls::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void *>(static_cast<uintptr_t>(groups[groupIndex].firstCommand) * sizeof(DrawElementsIndirectCommand)), OBJECT_LOD_COUNT, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
+};
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef INCLUDE_GPU_DELETION_CPP
+#define INCLUDE_GPU_DELETION_CPP
+
+#include <deque>
+#include <vector>
+#include <thread>
+
+#include <GL/glew.h>
+
+#include "constants.cpp"
+#include "gl_stats.cpp"
+#include "mpsc_queue.cpp"
+#include "job.cpp"
+
+/**
+ * Enumeration of the types of the GL objects retired to the GPU deletion queue.
+ */
+enum class GpuObjectType
+{
+  BUFFER,
+  TEXTURE,
+  VERTEX_ARRAY,
+  PROGRAM,
+  PROGRAM_PIPELINE
+};
+
+/**
+ * Structure for defining a GL object retired from a worker thread, handed to the main thread to be retired there.
+ */
+struct RetiredGpuObject
+{
+  // The type of the object.
+  GpuObjectType type;
+  // The ID of the object.
+  GLuint objectId;
+};
+
+/**
+ * Structure for defining the GL objects retired during a frame, deleted together once the GPU is done with the frame.
+ */
+struct GpuDeletionBatch
+{
+  // The fence issued at the end of the frame the objects were retired in (null while the frame is running).
+  GLsync fence;
+  // The IDs of the retired objects of each type.
+  std::vector<GLuint> bufferIds;
+  std::vector<GLuint> textureIds;
+  std::vector<GLuint> vertexArrayIds;
+  std::vector<GLuint> programIds;
+  std::vector<GLuint> programPipelineIds;
+
+  /**
+   * Check if no object was retired into the batch.
+   * 
+   * @return Whether the batch is empty or not.
+   */
+  bool isEmpty() const
+  {
+    return bufferIds.empty() && textureIds.empty() && vertexArrayIds.empty() && programIds.empty() && programPipelineIds.empty();
+  }
+};
+
+/**
+ * A manager class for deleting the GL objects of the assets once the GPU is done with the frames that may still use them,
+ *   instead of as soon as their last reference is dropped (which can happen mid-frame, e.g. from the deinit of a scene).
+ * The objects retired during a frame are fenced at its end, and deleted in batches at the same point of a later frame, once its
+ *   fence is passed, so that the driver never has to work on a deletion in the middle of a frame or wait for the GPU for it.
+ * The objects can be retired from any thread, the ones retired from the worker threads being handed to the main thread through
+ *   a lock-free queue, and added to the batch of the frame that ends next.
+ */
+class GpuDeletionQueue
+{
+private:
+  // Singleton instance of the GPU deletion queue.
+  static GpuDeletionQueue instance;
+
+  // The objects retired during the current frame.
+  GpuDeletionBatch currentBatch;
+  // The batches of the frames that ended, waiting for their fences, from the oldest.
+  std::deque<GpuDeletionBatch> fencedBatches;
+  // The emptied batches, kept around to reuse their memory.
+  std::vector<GpuDeletionBatch> spareBatches;
+  // The objects retired from the worker threads, not added to the current batch yet.
+  MpscQueue<RetiredGpuObject, MAIN_THREAD_QUEUE_CAPACITY> workerRetiredObjects;
+  // The thread making the GL calls, which the batches are only changed by.
+  const std::thread::id mainThreadId;
+
+  /**
+   * Retire a GL object into the current batch if called from the main thread, or hand it to the main thread otherwise (through a
+   *   task, if the queue of the objects retired from the worker threads is full).
+   * 
+   * @param type      The type of the object.
+   * @param objectId  The ID of the object.
+   */
+  void retire(const GpuObjectType &type, const GLuint &objectId)
+  {
+    if (objectId == 0)
+    {
+      return;
+    }
+    if (std::this_thread::get_id() == mainThreadId)
+    {
+      getBatchObjectIds(currentBatch, type).push_back(objectId);
+      return;
+    }
+    auto retiredObject = RetiredGpuObject{type, objectId};
+    if (!workerRetiredObjects.tryPush(retiredObject))
+    {
+      JobManager::getInstance().submitMainThreadTask([this, type, objectId]() { retire(type, objectId); });
+    }
+  }
+
+  /**
+   * Get the IDs of the retired objects of the given type of a batch.
+   * 
+   * @param batch  The batch.
+   * @param type   The type of the objects.
+   * 
+   * @return The IDs of the objects.
+   */
+  static std::vector<GLuint> &getBatchObjectIds(GpuDeletionBatch &batch, const GpuObjectType &type)
+  {
+    switch (type)
+    {
+    case GpuObjectType::BUFFER:
+      return batch.bufferIds;
+    case GpuObjectType::TEXTURE:
+      return batch.textureIds;
+    case GpuObjectType::VERTEX_ARRAY:
+      return batch.vertexArrayIds;
+    case GpuObjectType::PROGRAM_PIPELINE:
+      return batch.programPipelineIds;
+    default:
+      return batch.programIds;
+    }
+  }
+
+  /**
+   * Delete the objects of a batch, and empty it.
+   * 
+   * @param batch  The batch.
+   */
+  static void deleteBatch(GpuDeletionBatch &batch)
+  {
+    if (!batch.bufferIds.empty())
+    {
+      glDeleteBuffers(static_cast<GLsizei>(batch.bufferIds.size()), batch.bufferIds.data());
+    }
+    if (!batch.textureIds.empty())
+    {
+      GlCalls::deleteTextures(static_cast<GLsizei>(batch.textureIds.size()), batch.textureIds.data());
+    }
+    if (!batch.vertexArrayIds.empty())
+    {
+      GlCalls::deleteVertexArrays(static_cast<GLsizei>(batch.vertexArrayIds.size()), batch.vertexArrayIds.data());
+    }
+    for (const auto &programId : batch.programIds)
+    {
+      glDeleteProgram(programId);
+    }
+    if (!batch.programPipelineIds.empty())
+    {
+      GlCalls::deleteProgramPipelines(static_cast<GLsizei>(batch.programPipelineIds.size()), batch.programPipelineIds.data());
+    }
+    if (batch.fence != nullptr)
+    {
+      glDeleteSync(batch.fence);
+      batch.fence = nullptr;
+    }
+    batch.bufferIds.clear();
+    batch.textureIds.clear();
+    batch.vertexArrayIds.clear();
+    batch.programIds.clear();
+    batch.programPipelineIds.clear();
+  }
+
+  GpuDeletionQueue()
+      : currentBatch({nullptr, {}, {}, {}, {}, {}}),
+        fencedBatches(),
+        spareBatches({}),
+        workerRetiredObjects(),
+        mainThreadId(std::this_thread::get_id()) {}
+
+public:
+  // Preventing copying the GPU deletion queue, making sure only one instance can exist.
+  GpuDeletionQueue(const GpuDeletionQueue &) = delete;
+
+  /**
+   * Retire a buffer, deleting it once the GPU is done with the current frame. The ID must not be used anymore.
+   * 
+   * @param bufferId  The ID of the buffer.
+   */
+  void retireBuffer(const GLuint &bufferId)
+  {
+    retire(GpuObjectType::BUFFER, bufferId);
+  }
+
+  /**
+   * Retire a texture, deleting it once the GPU is done with the current frame. The ID must not be used anymore.
+   * 
+   * @param textureId  The ID of the texture.
+   */
+  void retireTexture(const GLuint &textureId)
+  {
+    retire(GpuObjectType::TEXTURE, textureId);
+  }
+
+  /**
+   * Retire a vertex array object, deleting it once the GPU is done with the current frame. The ID must not be used anymore.
+   * 
+   * @param vertexArrayId  The ID of the vertex array object.
+   */
+  void retireVertexArray(const GLuint &vertexArrayId)
+  {
+    retire(GpuObjectType::VERTEX_ARRAY, vertexArrayId);
+  }
+
+  /**
+   * Retire a shader program, deleting it once the GPU is done with the current frame. The ID must not be used anymore.
+   * 
+   * @param programId  The ID of the shader program.
+   */
+  void retireProgram(const GLuint &programId)
+  {
+    retire(GpuObjectType::PROGRAM, programId);
+  }
+
+  /**
+   * Retire a program pipeline, deleting it once the GPU is done with the current frame. The ID must not be used anymore.
+   * 
+   * @param programPipelineId  The ID of the program pipeline.
+   */
+  void retireProgramPipeline(const GLuint &programPipelineId)
+  {
+    retire(GpuObjectType::PROGRAM_PIPELINE, programPipelineId);
+  }
+
+  /**
+   * End the frame of the retired objects, fencing them, and delete the objects of the earlier frames the GPU is done with.
+   *   Must be called once per frame, after its last draw.
+   */
+  void endFrame()
+  {
+    // Add the objects retired from the worker threads since the last frame ended.
+    RetiredGpuObject retiredObject;
+    while (workerRetiredObjects.tryPop(retiredObject))
+    {
+      getBatchObjectIds(currentBatch, retiredObject.type).push_back(retiredObject.objectId);
+    }
+
+    if (!currentBatch.isEmpty())
+    {
+      currentBatch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      fencedBatches.push_back(std::move(currentBatch));
+      if (spareBatches.empty())
+      {
+        currentBatch = {nullptr, {}, {}, {}, {}, {}};
+      }
+      else
+      {
+        currentBatch = std::move(spareBatches.back());
+        spareBatches.pop_back();
+      }
+    }
+
+    // The fences are passed in order, so stop at the first one that is not.
+    while (!fencedBatches.empty() && glClientWaitSync(fencedBatches.front().fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+    {
+      deleteBatch(fencedBatches.front());
+      spareBatches.push_back(std::move(fencedBatches.front()));
+      fencedBatches.pop_front();
+    }
+  }
+
+  /**
+   * Delete all the retired objects right away, without waiting for the GPU (e.g. before the GL context is destroyed, once
+   *   nothing is drawn anymore).
+   */
+  void deleteAll()
+  {
+    for (auto &fencedBatch : fencedBatches)
+    {
+      deleteBatch(fencedBatch);
+    }
+    fencedBatches.clear();
+    deleteBatch(currentBatch);
+  }
+
+  /**
+   * Returns the singleton instance of the GPU deletion queue.
+   * 
+   * @return The GPU deletion queue singleton instance.
+   */
+  static GpuDeletionQueue &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GPU deletion queue singleton instance static variable.
+GpuDeletionQueue GpuDeletionQueue::instance;
+
+#endif
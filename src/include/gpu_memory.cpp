@@ -0,0 +1,323 @@
+#ifndef INCLUDE_GPU_MEMORY_CPP
+#define INCLUDE_GPU_MEMORY_CPP
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+#include "text_arena.cpp"
+
+/**
+ * An enum for the kinds of GL objects the GPU memory is allocated for, each with IDs of their own.
+ */
+enum class GpuResourceType
+{
+  BUFFER,
+  TEXTURE,
+  RENDERBUFFER
+};
+
+/**
+ * An enum for the categories the GPU memory is accounted in.
+ */
+enum class GpuMemoryCategory
+{
+  // The vertex and index buffers of the objects.
+  MESH,
+  // The textures of the models.
+  TEXTURE,
+  // The shadow map atlas and arrays.
+  SHADOW_MAP,
+  // The framebuffer attachments the scene is rendered into.
+  RENDER_TARGET,
+  // The glyph atlas and the glyph instance buffers.
+  TEXT,
+  // The buffers of the debug renders and the frame time graph.
+  DEBUG,
+  // The buffers refilled each frame (instance data, uniform blocks, light clusters and texture uploads).
+  DYNAMIC,
+  COUNT
+};
+
+/**
+ * Structure for defining an allocation of GPU memory.
+ */
+struct GpuMemoryAllocation
+{
+  // The category the allocation is accounted in.
+  GpuMemoryCategory category;
+  // The name of the asset (or the manager) the allocation is made for.
+  std::string assetName;
+  // The size of the allocation (in bytes).
+  uint64_t size;
+};
+
+/**
+ * A manager class for keeping track of the GPU memory allocated by the managers for their buffers, textures and renderbuffers,
+ *   by category and by asset. The sizes are the ones asked of GL (estimated from the formats for the textures and
+ *   renderbuffers), so the driver can use more for alignment and padding, which the driver memory reported by the
+ *   GL_NVX_gpu_memory_info and GL_ATI_meminfo extensions (where available) shows.
+ */
+class GpuMemoryManager
+{
+private:
+  // Singleton instance of the GPU memory manager.
+  static GpuMemoryManager instance;
+
+  // The names of the categories, shown in the reports.
+  static constexpr std::array<const char *, static_cast<size_t>(GpuMemoryCategory::COUNT)> CATEGORY_NAMES = {"Meshes", "Textures", "Shadow Maps", "Render Targets", "Text", "Debug", "Dynamic Buffers"};
+
+  // The mutex guarding the allocations, since the GL objects are created on the thread rendering while the reports can be
+  //   written on any thread.
+  mutable std::mutex allocationsMutex;
+  // The allocations by the types and the IDs of their GL objects.
+  std::unordered_map<uint64_t, GpuMemoryAllocation> allocations;
+  // The total size of the allocations of each category (in bytes).
+  std::array<uint64_t, static_cast<size_t>(GpuMemoryCategory::COUNT)> categorySizes;
+
+  // The size of the video memory reported by the driver, and how much of it is free (in kilobytes, -1 if not reported).
+  std::atomic<int64_t> driverTotalMemory;
+  std::atomic<int64_t> driverFreeMemory;
+
+  GpuMemoryManager()
+      : allocations({}),
+        categorySizes({}),
+        driverTotalMemory(-1),
+        driverFreeMemory(-1) {}
+
+  /**
+   * Get the key of the allocation of a GL object.
+   * 
+   * @param type        The type of the GL object.
+   * @param resourceId  The ID of the GL object.
+   * 
+   * @return The allocation key.
+   */
+  static uint64_t getAllocationKey(const GpuResourceType &type, const GLuint &resourceId)
+  {
+    return (static_cast<uint64_t>(type) << 32) | resourceId;
+  }
+
+  /**
+   * Remove an allocation from the totals and forget it. The allocations mutex has to be held.
+   * 
+   * @param allocationKey  The key of the allocation.
+   */
+  void eraseAllocation(const uint64_t &allocationKey)
+  {
+    const auto allocation = allocations.find(allocationKey);
+    if (allocation != allocations.end())
+    {
+      categorySizes[static_cast<size_t>(allocation->second.category)] -= allocation->second.size;
+      allocations.erase(allocation);
+    }
+  }
+
+  /**
+   * Get a size in megabytes.
+   * 
+   * @param size  The size (in bytes).
+   * 
+   * @return The size (in megabytes).
+   */
+  static double_t toMegabytes(const uint64_t &size)
+  {
+    return size / (1024.0 * 1024.0);
+  }
+
+public:
+  // Preventing copying the GPU memory manager, making sure only one instance can exist.
+  GpuMemoryManager(const GpuMemoryManager &) = delete;
+
+  /**
+   * Get the size of a texture.
+   * 
+   * @param width          The width of the texture (in texels).
+   * @param height         The height of the texture (in texels).
+   * @param layers         The number of layers (or faces) of the texture.
+   * @param bytesPerTexel  The size of a texel of the format of the texture (in bytes).
+   * @param hasMipmaps     Whether the texture has a full mip chain, which adds about a third.
+   * 
+   * @return The size of the texture (in bytes).
+   */
+  static uint64_t getTextureSize(const uint32_t &width, const uint32_t &height, const uint32_t &layers, const uint32_t &bytesPerTexel, const bool &hasMipmaps)
+  {
+    const auto baseSize = static_cast<uint64_t>(width) * height * layers * bytesPerTexel;
+    return hasMipmaps ? (baseSize * 4) / 3 : baseSize;
+  }
+
+  /**
+   * Record the memory allocated for a GL object, replacing what was recorded for it before (e.g. when a buffer is reallocated
+   *   with another size).
+   * 
+   * @param type        The type of the GL object.
+   * @param resourceId  The ID of the GL object.
+   * @param category    The category the memory is accounted in.
+   * @param assetName   The name of the asset (or the manager) the memory is allocated for.
+   * @param size        The size of the allocation (in bytes).
+   */
+  void recordAllocation(const GpuResourceType &type, const GLuint &resourceId, const GpuMemoryCategory &category, const std::string &assetName, const uint64_t &size)
+  {
+    const auto allocationKey = getAllocationKey(type, resourceId);
+    const std::lock_guard<std::mutex> lock(allocationsMutex);
+    const auto allocation = allocations.find(allocationKey);
+    if (allocation != allocations.end() && allocation->second.category == category && allocation->second.assetName == assetName)
+    {
+      // Only the size changed, as it does for the buffers refilled each frame, so the name is not copied again.
+      categorySizes[static_cast<size_t>(category)] += size - allocation->second.size;
+      allocation->second.size = size;
+      return;
+    }
+    eraseAllocation(allocationKey);
+    allocations.emplace(allocationKey, GpuMemoryAllocation({category, assetName, size}));
+    categorySizes[static_cast<size_t>(category)] += size;
+  }
+
+  /**
+   * Record the memory of a GL object as freed, when the object is deleted.
+   * 
+   * @param type        The type of the GL object.
+   * @param resourceId  The ID of the GL object (0 is ignored).
+   */
+  void recordRelease(const GpuResourceType &type, const GLuint &resourceId)
+  {
+    if (resourceId == 0)
+    {
+      return;
+    }
+    const std::lock_guard<std::mutex> lock(allocationsMutex);
+    eraseAllocation(getAllocationKey(type, resourceId));
+  }
+
+  /**
+   * Get the total size of the recorded allocations.
+   * 
+   * @return The total size (in bytes).
+   */
+  uint64_t getTotalSize() const
+  {
+    const std::lock_guard<std::mutex> lock(allocationsMutex);
+    auto totalSize = static_cast<uint64_t>(0);
+    for (const auto &categorySize : categorySizes)
+    {
+      totalSize += categorySize;
+    }
+    return totalSize;
+  }
+
+  /**
+   * Query the video memory the driver reports, through GL_NVX_gpu_memory_info or GL_ATI_meminfo if either is supported. Has to
+   *   be done on the thread the GL context is current on, so it is done once per frame there and the reports use the result.
+   */
+  void sampleDriverMemory()
+  {
+    if (GLEW_NVX_gpu_memory_info)
+    {
+      GLint totalMemory = 0, freeMemory = 0;
+      glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &totalMemory);
+      glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &freeMemory);
+      driverTotalMemory = totalMemory;
+      driverFreeMemory = freeMemory;
+    }
+    else if (GLEW_ATI_meminfo)
+    {
+      // Only the free memory of the texture pool is reported (first of the four values), with no total.
+      GLint freeMemory[4] = {0, 0, 0, 0};
+      glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, freeMemory);
+      driverFreeMemory = freeMemory[0];
+    }
+  }
+
+  /**
+   * Write the total tracked GPU memory and the video memory the driver reports as text.
+   * 
+   * @param text  The writer of the text, written the GPU memory status.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+    const int64_t totalMemory = driverTotalMemory, freeMemory = driverFreeMemory;
+    text << toMegabytes(getTotalSize()) << "MB Tracked | Driver: ";
+    if (totalMemory >= 0)
+    {
+      text << (totalMemory - freeMemory) / 1024.0 << "/" << totalMemory / 1024.0 << "MB Used";
+    }
+    else if (freeMemory >= 0)
+    {
+      text << freeMemory / 1024.0 << "MB Free";
+    }
+    else
+    {
+      text << "Not Reported";
+    }
+  }
+
+  /**
+   * Print the tracked GPU memory by category and by asset, from the largest to the smallest, along with the video memory the
+   *   driver reports.
+   */
+  void dump() const
+  {
+    // Sum the allocations of each asset up, since an asset can have a few GL objects.
+    std::map<std::pair<GpuMemoryCategory, std::string>, uint64_t> assetSizes;
+    auto categorySizesCopy = std::array<uint64_t, static_cast<size_t>(GpuMemoryCategory::COUNT)>({});
+    {
+      const std::lock_guard<std::mutex> lock(allocationsMutex);
+      for (const auto &allocation : allocations)
+      {
+        assetSizes[std::make_pair(allocation.second.category, allocation.second.assetName)] += allocation.second.size;
+      }
+      categorySizesCopy = categorySizes;
+    }
+    auto sortedAssetSizes = std::vector<std::pair<std::pair<GpuMemoryCategory, std::string>, uint64_t>>(assetSizes.begin(), assetSizes.end());
+    std::sort(sortedAssetSizes.begin(), sortedAssetSizes.end(), [](const auto &first, const auto &second) {
+      return first.second > second.second;
+    });
+
+    std::cout << "GPU Memory: " << toMegabytes(getTotalSize()) << "MB Tracked" << std::endl;
+    for (size_t i = 0; i < categorySizesCopy.size(); i++)
+    {
+      std::cout << "  " << CATEGORY_NAMES[i] << ": " << toMegabytes(categorySizesCopy[i]) << "MB" << std::endl;
+      for (const auto &assetSize : sortedAssetSizes)
+      {
+        if (static_cast<size_t>(assetSize.first.first) == i)
+        {
+          std::cout << "    " << assetSize.first.second << ": " << assetSize.second / 1024.0 << "KB" << std::endl;
+        }
+      }
+    }
+    const int64_t totalMemory = driverTotalMemory, freeMemory = driverFreeMemory;
+    if (totalMemory >= 0)
+    {
+      std::cout << "Driver (GL_NVX_gpu_memory_info): " << (totalMemory - freeMemory) / 1024.0 << "/" << totalMemory / 1024.0 << "MB Used" << std::endl;
+    }
+    else if (freeMemory >= 0)
+    {
+      std::cout << "Driver (GL_ATI_meminfo): " << freeMemory / 1024.0 << "MB Free" << std::endl;
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the GPU memory manager.
+   * 
+   * @return The GPU memory manager singleton instance.
+   */
+  static GpuMemoryManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GPU memory manager singleton instance static variable.
+GpuMemoryManager GpuMemoryManager::instance;
+
+#endif
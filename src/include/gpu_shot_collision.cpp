@@ -0,0 +1,565 @@
+#ifndef INCLUDE_GPU_SHOT_COLLISION_CPP
+#define INCLUDE_GPU_SHOT_COLLISION_CPP
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "window.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "simulation_clock.cpp"
+#include "collider.cpp"
+#include "collision.cpp"
+#include "registry.cpp"
+#include "models.cpp"
+
+/**
+ * Structure for defining the slot of a shot tested by the shot collision compute shader.
+ * The layout matches the Shot structure in the shader.
+ */
+struct GpuShotData
+{
+  // The position the shot was spawned at.
+  glm::vec3 spawnPosition;
+  // The simulation time the shot was spawned at.
+  float_t spawnTime;
+  // The velocity of the shot.
+  glm::vec3 velocity;
+  // The radius of the bounding sphere of the shot.
+  float_t radius;
+  // The generation of the slot, which tells the spawns of the slot apart.
+  uint32_t generation;
+  // Whether a shot is spawned in the slot.
+  uint32_t isActive;
+  // Padding to keep the slots 16 byte aligned.
+  uint32_t padding[2];
+};
+
+/**
+ * Structure for defining the bounding sphere of an enemy tested by the shot collision compute shader.
+ * The layout matches the Enemy structure in the shader.
+ */
+struct GpuShotEnemyData
+{
+  // The center of the bounding sphere.
+  glm::vec3 center;
+  // The radius of the bounding sphere.
+  float_t radius;
+  // The handle of the enemy in the model manager.
+  RegistryHandle modelHandle;
+  // Padding to keep the enemies 16 byte aligned.
+  uint32_t padding[2];
+};
+
+/**
+ * Structure for defining a hit of a shot on an enemy, recorded by the shot collision compute shader.
+ * The layout matches the Hit structure in the shader.
+ */
+struct GpuShotHitData
+{
+  // The slot of the shot, and its generation when it hit.
+  uint32_t shotIndex;
+  uint32_t shotGeneration;
+  // The handle of the enemy in the model manager.
+  RegistryHandle enemyHandle;
+  // The simulation time the shot first touched the enemy at.
+  float_t time;
+  // Padding to keep the hits 16 byte aligned.
+  uint32_t padding[3];
+};
+
+static_assert(sizeof(GpuShotData) == 48, "GpuShotData does not match the std430 layout of the shader");
+static_assert(sizeof(GpuShotEnemyData) == 32, "GpuShotEnemyData does not match the std430 layout of the shader");
+static_assert(sizeof(GpuShotHitData) == 32, "GpuShotHitData does not match the std430 layout of the shader");
+
+/**
+ * Structure for defining the shots and enemies of a frame to test against each other on the GPU, filled into the render packets.
+ */
+struct GpuShotCollisionBatch
+{
+  // The slots of the shots, only filled if they changed since the last batch.
+  std::vector<GpuShotData> shots;
+  // Whether the slots of the shots changed since the last batch (and were filled).
+  bool isShotsChanged;
+  // The bounding spheres of the enemies.
+  std::vector<GpuShotEnemyData> enemies;
+  // The simulation time the batch was filled at, which the shots are swept until.
+  float_t time;
+};
+
+/**
+ * Class for testing the shots against the enemies on the GPU, instead of as part of the collision pass on the CPU.
+ * The shots are kept in the slots of a shader storage buffer, only written when a shot is spawned or despawned, since they move
+ *   in a straight line at a constant velocity: a compute shader integrates their positions from their spawn details, and sweeps
+ *   each shot over the time since the last dispatch against the bounding spheres of the enemies, uploaded every frame. The hits
+ *   are appended to a buffer through an atomic counter, and read back without waiting for the GPU, so they are handed to the
+ *   shots a frame (or a few) after the shots touched the enemies, in the order they touched them.
+ * The shots and enemies are filled into the render packets on the main thread, dispatched on the thread owning the GL context,
+ *   and the hits read back are handed over under a lock. The shots still move on the CPU, which renders and lights them.
+ * Needs OpenGL 4.3 (compute shaders, shader storage buffers and atomic counters), so the shots are left to the collision pass
+ *   if the window manager does not report it as supported.
+ */
+class GpuShotCollisionManager
+{
+private:
+  // Singleton instance of the GPU shot collision manager.
+  static GpuShotCollisionManager instance;
+
+  /**
+   * An enum for the binding points of the shader storage buffers of the shot collision compute shader (matching the bindings in
+   *   the shader).
+   */
+  enum StorageBinding : GLuint
+  {
+    SHOTS_BINDING,
+    ENEMIES_BINDING,
+    HITS_BINDING
+  };
+
+  /**
+   * Structure for defining a readback of the hits of a dispatch.
+   */
+  struct HitReadback
+  {
+    // The ID of the buffer the hit count and the hits are copied into.
+    GLuint bufferId;
+    // The fence signaled once the hits are copied (null if the readback is not in flight).
+    GLsync fence;
+  };
+
+  // The model manager the shots and enemies are registered with.
+  ModelManager &modelManager;
+  // The shader manager responsible for creating the shot collision compute shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the buffers are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+  // The simulation clock the shots are spawned and swept with.
+  const SimulationClock &simulationClock;
+
+  // Whether the shots are tested on the GPU.
+  const bool isSupported;
+
+  // The shader program details of the shot collision compute shader (null if the GPU shot collision is not supported).
+  const std::shared_ptr<const ShaderDetails> collisionShaderDetails;
+  // The uniform IDs of the shot collision compute shader.
+  const GLuint shotsCountUniformId;
+  const GLuint enemiesCountUniformId;
+  const GLuint sweepTimesUniformId;
+  const GLuint maxHitsCountUniformId;
+
+  // The IDs of the buffers of the shot slots, the enemies, the hits, and the hit counter (0 if not supported).
+  GLuint shotBufferId;
+  GLuint enemyBufferId;
+  GLuint hitBufferId;
+  GLuint hitCounterBufferId;
+
+  // The readbacks of the hits, used in turn.
+  std::array<HitReadback, GPU_SHOT_COLLISION_READBACK_BUFFERS> readbacks;
+  // The index of the oldest readback, which is the next one to be used.
+  uint32_t nextReadbackIndex;
+  // The number of shot slots written into the shot buffer, and the simulation time the shots were last swept until, on the
+  //   thread owning the GL context.
+  uint32_t uploadedShotsCount;
+  float_t sweptTime;
+
+  // The slots of the shots, and the shots spawned in them (null for the free slots), on the main thread.
+  std::vector<GpuShotData> shots;
+  std::vector<ModelBaseIntf *> shotModels;
+  // The free slots of the shots, and whether the slots changed since the last batch.
+  std::vector<uint32_t> freeShotIndices;
+  bool isShotsChanged;
+
+  // The lock of the hits read back.
+  std::mutex hitsMutex;
+  // The hits read back and not handed to the shots yet, written on the thread owning the GL context.
+  std::vector<GpuShotHitData> latestHits;
+  // The hits being handed to the shots, taken from the latest ones.
+  std::vector<GpuShotHitData> appliedHits;
+
+  /**
+   * Create a new buffer with the given storage, bound to the given target.
+   * 
+   * @param target  The target to bind the buffer to.
+   * @param size    The size of the storage in bytes.
+   * @param usage   The expected usage of the storage.
+   * 
+   * @return The ID of the created buffer.
+   */
+  GLuint createBuffer(const GLenum &target, const GLsizeiptr &size, const GLenum &usage)
+  {
+    GLuint bufferId;
+    glGenBuffers(1, &bufferId);
+    glBindBuffer(target, bufferId);
+    GlCalls::bufferData(target, size, nullptr, usage);
+    glBindBuffer(target, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "Shot Collision", size);
+    return bufferId;
+  }
+
+  /**
+   * Read back the hits of the dispatches that are done on the GPU, adding them to the latest hits. Never waits for the GPU.
+   */
+  void collectReadbacks()
+  {
+    for (uint32_t i = 0; i < readbacks.size(); i++)
+    {
+      // Check the readbacks from the oldest to the newest, stopping at the first one still in flight.
+      auto &readback = readbacks[(nextReadbackIndex + i) % readbacks.size()];
+      if (readback.fence == nullptr)
+      {
+        continue;
+      }
+      const auto waitResult = glClientWaitSync(readback.fence, 0, 0);
+      if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+      {
+        break;
+      }
+      glDeleteSync(readback.fence);
+      readback.fence = nullptr;
+
+      // The hit count comes first, in a slot as large as a hit, followed by the hits.
+      glBindBuffer(GL_COPY_READ_BUFFER, readback.bufferId);
+      const auto readbackData = static_cast<const GpuShotHitData *>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, (GPU_SHOT_COLLISION_MAX_HITS + 1) * sizeof(GpuShotHitData), GL_MAP_READ_BIT));
+      if (readbackData != nullptr)
+      {
+        const auto hitsCount = std::min(*reinterpret_cast<const uint32_t *>(readbackData), GPU_SHOT_COLLISION_MAX_HITS);
+        const std::lock_guard<std::mutex> lock(hitsMutex);
+        // Drop the hits that do not fit, if the main thread has not taken the earlier ones for a while.
+        const auto keptHitsCount = std::min<size_t>(hitsCount, latestHits.capacity() - latestHits.size());
+        latestHits.insert(latestHits.end(), readbackData + 1, readbackData + 1 + keptHitsCount);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+      }
+      glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+  }
+
+  GpuShotCollisionManager()
+      : modelManager(ModelManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        simulationClock(SimulationClock::getInstance()),
+        isSupported(WindowManager::getInstance().isGpuShotCollisionSupported()),
+        collisionShaderDetails(isSupported ? shaderManager.createComputeShaderProgram("GpuShotCollision::Shader", "assets/shaders/compute/shot_collision.glsl") : nullptr),
+        shotsCountUniformId(shaderManager.getUniformId("shotsCount")),
+        enemiesCountUniformId(shaderManager.getUniformId("enemiesCount")),
+        sweepTimesUniformId(shaderManager.getUniformId("sweepTimes")),
+        maxHitsCountUniformId(shaderManager.getUniformId("maxHitsCount")),
+        shotBufferId(0),
+        enemyBufferId(0),
+        hitBufferId(0),
+        hitCounterBufferId(0),
+        readbacks({}),
+        nextReadbackIndex(0),
+        uploadedShotsCount(0),
+        sweptTime(std::numeric_limits<float_t>::lowest()),
+        shots({}),
+        shotModels({}),
+        freeShotIndices({}),
+        isShotsChanged(false),
+        hitsMutex(),
+        latestHits({}),
+        appliedHits({})
+  {
+    if (!isSupported)
+    {
+      return;
+    }
+
+    // Create the buffers of the shot slots, the hits and the hit counter at their largest, and the readbacks of the hits.
+    shotBufferId = createBuffer(GL_SHADER_STORAGE_BUFFER, GPU_SHOT_COLLISION_MAX_SHOTS * sizeof(GpuShotData), GL_DYNAMIC_DRAW);
+    enemyBufferId = createBuffer(GL_SHADER_STORAGE_BUFFER, sizeof(GpuShotEnemyData), GL_STREAM_DRAW);
+    hitBufferId = createBuffer(GL_SHADER_STORAGE_BUFFER, GPU_SHOT_COLLISION_MAX_HITS * sizeof(GpuShotHitData), GL_DYNAMIC_COPY);
+    hitCounterBufferId = createBuffer(GL_ATOMIC_COUNTER_BUFFER, sizeof(uint32_t), GL_DYNAMIC_COPY);
+    for (auto &readback : readbacks)
+    {
+      readback.bufferId = createBuffer(GL_COPY_WRITE_BUFFER, (GPU_SHOT_COLLISION_MAX_HITS + 1) * sizeof(GpuShotHitData), GL_STREAM_READ);
+      readback.fence = nullptr;
+    }
+
+    // Reserve the slots and the hits up front, so that spawning the shots and reading the hits back never allocates.
+    shots.reserve(GPU_SHOT_COLLISION_MAX_SHOTS);
+    shotModels.reserve(GPU_SHOT_COLLISION_MAX_SHOTS);
+    freeShotIndices.reserve(GPU_SHOT_COLLISION_MAX_SHOTS);
+    latestHits.reserve(GPU_SHOT_COLLISION_MAX_HITS * GPU_SHOT_COLLISION_READBACK_BUFFERS);
+    appliedHits.reserve(GPU_SHOT_COLLISION_MAX_HITS * GPU_SHOT_COLLISION_READBACK_BUFFERS);
+  }
+
+public:
+  // The slot index returned for the shots left to the collision pass.
+  static constexpr uint32_t INVALID_SHOT_INDEX = std::numeric_limits<uint32_t>::max();
+
+  ~GpuShotCollisionManager()
+  {
+    if (!isSupported)
+    {
+      return;
+    }
+
+    // Destroy the shot collision compute shader.
+    shaderManager.destroyShaderProgram(collisionShaderDetails);
+    // Delete the buffers and the readbacks.
+    for (const auto &bufferId : {shotBufferId, enemyBufferId, hitBufferId, hitCounterBufferId})
+    {
+      glDeleteBuffers(1, &bufferId);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, bufferId);
+    }
+    for (const auto &readback : readbacks)
+    {
+      if (readback.fence != nullptr)
+      {
+        glDeleteSync(readback.fence);
+      }
+      glDeleteBuffers(1, &readback.bufferId);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, readback.bufferId);
+    }
+  }
+
+  // Preventing copying the GPU shot collision manager, making sure only one instance can exist.
+  GpuShotCollisionManager(const GpuShotCollisionManager &) = delete;
+
+  /**
+   * Check if the shots are tested against the enemies on the GPU.
+   * 
+   * @return Whether the GPU shot collision is supported or not.
+   */
+  bool isGpuShotCollisionSupported() const
+  {
+    return isSupported;
+  }
+
+  /**
+   * Give a slot to a shot spawned now, to be tested against the enemies on the GPU until it is de-registered. On the main thread.
+   * 
+   * @param shot      The shot, which is sent the enter events of its hits.
+   * @param position  The position the shot is spawned at.
+   * @param velocity  The velocity the shot moves at.
+   * @param radius    The radius of the bounding sphere of the shot.
+   * 
+   * @return The slot of the shot, or INVALID_SHOT_INDEX if the shot is to be left to the collision pass (the GPU shot
+   *   collision is not supported, or all the slots are taken).
+   */
+  uint32_t registerShot(ModelBaseIntf *shot, const glm::vec3 &position, const glm::vec3 &velocity, const float_t &radius)
+  {
+    if (!isSupported || (freeShotIndices.empty() && shots.size() == GPU_SHOT_COLLISION_MAX_SHOTS))
+    {
+      return INVALID_SHOT_INDEX;
+    }
+
+    // Reuse a free slot if there is one, moving on to the next generation of the slot.
+    auto shotIndex = static_cast<uint32_t>(shots.size());
+    auto generation = 1u;
+    if (!freeShotIndices.empty())
+    {
+      shotIndex = freeShotIndices.back();
+      freeShotIndices.pop_back();
+      generation = shots[shotIndex].generation + 1;
+    }
+    else
+    {
+      shots.emplace_back();
+      shotModels.push_back(nullptr);
+    }
+    shots[shotIndex] = {position, static_cast<float_t>(simulationClock.getTime()), velocity, radius, generation, 1, {0, 0}};
+    shotModels[shotIndex] = shot;
+    isShotsChanged = true;
+    return shotIndex;
+  }
+
+  /**
+   * Free the slot of a shot, so that it is no longer tested against the enemies. On the main thread.
+   * 
+   * @param shotIndex  The slot of the shot (ignored if INVALID_SHOT_INDEX).
+   */
+  void deregisterShot(const uint32_t &shotIndex)
+  {
+    if (shotIndex == INVALID_SHOT_INDEX)
+    {
+      return;
+    }
+    shots[shotIndex].isActive = 0;
+    shotModels[shotIndex] = nullptr;
+    freeShotIndices.push_back(shotIndex);
+    isShotsChanged = true;
+  }
+
+  /**
+   * Fill the given batch with the shots (if they changed since the last batch) and the bounding spheres of the enemies, to be
+   *   tested against each other once the batch is dispatched. On the main thread, while nothing changes the models.
+   * 
+   * @param batch  The batch to fill.
+   */
+  void fillBatch(GpuShotCollisionBatch &batch)
+  {
+    batch.isShotsChanged = isShotsChanged;
+    batch.enemies.clear();
+    batch.time = static_cast<float_t>(simulationClock.getTime());
+    if (!isSupported)
+    {
+      return;
+    }
+    if (isShotsChanged)
+    {
+      batch.shots.assign(shots.begin(), shots.end());
+      isShotsChanged = false;
+    }
+
+    // Take the bounding spheres of the enemies, the exact ones of the sphere colliders.
+    for (const auto &model : modelManager.getAllModels())
+    {
+      if ((model->getCollisionLayer() & CollisionLayer::ENEMY_COLLISION_LAYER) == 0)
+      {
+        continue;
+      }
+      const auto &colliderShape = model->getColliderDetails()->getColliderShape();
+      if (colliderShape->getType() == ColliderShapeType::SPHERE)
+      {
+        const auto &sphere = static_cast<const SphereColliderShape &>(*colliderShape);
+        batch.enemies.push_back({sphere.getPosition(), sphere.getRadius() * sphere.getScale().x, model->getModelHandle(), {0, 0}});
+      }
+      else
+      {
+        const auto &box = colliderShape->getTransformedBox();
+        batch.enemies.push_back({(box.getMinCorner() + box.getMaxCorner()) * 0.5f, glm::distance(box.getMinCorner(), box.getMaxCorner()) * 0.5f, model->getModelHandle(), {0, 0}});
+      }
+    }
+  }
+
+  /**
+   * Sweep the shots of the given batch against its enemies, from the time the shots were last swept until to the time of the
+   *   batch, and collect the hits of the earlier batches the GPU is done with. A batch is skipped if all the readbacks are still
+   *   in flight, so that the GPU is never waited for, in which case the next one sweeps the shots over the time of both.
+   * On the thread owning the GL context.
+   * 
+   * @param batch  The batch to dispatch.
+   */
+  void dispatchBatch(const GpuShotCollisionBatch &batch)
+  {
+    if (!isSupported)
+    {
+      return;
+    }
+    collectReadbacks();
+
+    // Write the slots of the shots that changed, which the earlier dispatches may still be reading.
+    if (batch.isShotsChanged)
+    {
+      uploadedShotsCount = static_cast<uint32_t>(batch.shots.size());
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, shotBufferId);
+      GlCalls::bufferSubData(GL_SHADER_STORAGE_BUFFER, 0, uploadedShotsCount * sizeof(GpuShotData), batch.shots.data());
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    auto &readback = readbacks[nextReadbackIndex];
+    if (readback.fence != nullptr)
+    {
+      return;
+    }
+    // Nothing can be hit, so the shots only need to be swept from now on.
+    if (uploadedShotsCount == 0 || batch.enemies.empty())
+    {
+      sweptTime = batch.time;
+      return;
+    }
+
+    // Write the enemies, orphaning the old storage so that the GPU can keep reading it, and reset the hit counter.
+    const auto enemiesSize = static_cast<GLsizeiptr>(batch.enemies.size() * sizeof(GpuShotEnemyData));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, enemyBufferId);
+    GlCalls::bufferData(GL_SHADER_STORAGE_BUFFER, enemiesSize, batch.enemies.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, enemyBufferId, GpuMemoryCategory::DYNAMIC, "Shot Collision", enemiesSize);
+    const uint32_t zeroHitsCount = 0;
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, hitCounterBufferId);
+    GlCalls::bufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(uint32_t), &zeroHitsCount);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+    // Sweep the shots against the enemies.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SHOTS_BINDING, shotBufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ENEMIES_BINDING, enemyBufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HITS_BINDING, hitBufferId);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, hitCounterBufferId);
+    GlCalls::useProgram(collisionShaderDetails->getShaderId());
+    GlCalls::uniform1i(collisionShaderDetails->getUniformLocation(shotsCountUniformId), static_cast<GLint>(uploadedShotsCount));
+    GlCalls::uniform1i(collisionShaderDetails->getUniformLocation(enemiesCountUniformId), static_cast<GLint>(batch.enemies.size()));
+    GlCalls::uniform2f(collisionShaderDetails->getUniformLocation(sweepTimesUniformId), sweptTime, batch.time);
+    GlCalls::uniform1i(collisionShaderDetails->getUniformLocation(maxHitsCountUniformId), static_cast<GLint>(GPU_SHOT_COLLISION_MAX_HITS));
+    glDispatchCompute((uploadedShotsCount + GPU_SHOT_COLLISION_WORK_GROUP_SIZE - 1) / GPU_SHOT_COLLISION_WORK_GROUP_SIZE, 1, 1);
+    sweptTime = batch.time;
+
+    // Start copying the hit count and the hits into the buffer of the readback once they are written, to be collected in a
+    //   later frame.
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readback.bufferId);
+    glBindBuffer(GL_COPY_READ_BUFFER, hitCounterBufferId);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(uint32_t));
+    glBindBuffer(GL_COPY_READ_BUFFER, hitBufferId);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, sizeof(GpuShotHitData), GPU_SHOT_COLLISION_MAX_HITS * sizeof(GpuShotHitData));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextReadbackIndex = (nextReadbackIndex + 1) % readbacks.size();
+  }
+
+  /**
+   * Send the enter events of the hits read back since the last time to the shots, the earliest hits first, the same way as the
+   *   collision pass: the hits of the shots and enemies de-registered (or queued to be) by the earlier events are skipped, along
+   *   with those of the shots despawned since they hit. On the main thread, once the collision pass is done.
+   */
+  void applyHits()
+  {
+    if (!isSupported)
+    {
+      return;
+    }
+    {
+      const std::lock_guard<std::mutex> lock(hitsMutex);
+      std::swap(latestHits, appliedHits);
+    }
+    // Order the hits the same way whichever order the GPU appended them in.
+    std::sort(appliedHits.begin(), appliedHits.end(), [](const GpuShotHitData &hit1, const GpuShotHitData &hit2) {
+      return std::make_tuple(hit1.time, hit1.shotIndex, hit1.enemyHandle.slotIndex) < std::make_tuple(hit2.time, hit2.shotIndex, hit2.enemyHandle.slotIndex);
+    });
+
+    for (const auto &hit : appliedHits)
+    {
+      // Check that the shot is still the spawn that hit the enemy, and that the enemy is still registered.
+      if (hit.shotIndex >= shots.size() || shots[hit.shotIndex].isActive == 0 || shots[hit.shotIndex].generation != hit.shotGeneration ||
+          !modelManager.isModelRegistered(hit.enemyHandle))
+      {
+        continue;
+      }
+      const auto shot = shotModels[hit.shotIndex];
+      const auto &enemy = modelManager.getModel(hit.enemyHandle);
+      if (shot->getModelHandle() == INVALID_REGISTRY_HANDLE || modelManager.isDeregistrationQueued(shot) || modelManager.isDeregistrationQueued(enemy.get()))
+      {
+        continue;
+      }
+      shot->onCollisionEnter(enemy);
+    }
+    appliedHits.clear();
+  }
+
+  /**
+   * Returns the singleton instance of the GPU shot collision manager.
+   * 
+   * @return The GPU shot collision manager singleton instance.
+   */
+  static GpuShotCollisionManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GPU shot collision manager singleton instance static variable.
+GpuShotCollisionManager GpuShotCollisionManager::instance;
+
+#endif
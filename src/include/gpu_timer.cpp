@@ -0,0 +1,227 @@
+#ifndef INCLUDE_GPU_TIMER_CPP
+#define INCLUDE_GPU_TIMER_CPP
+
+#include <string>
+#include <array>
+
+#include <GL/glew.h>
+
+#include "window.cpp"
+#include "profiler.cpp"
+#include "name_interner.cpp"
+
+/**
+ * Structure for defining the queries of a single named GPU timer.
+ */
+struct GpuTimerQueries
+{
+  // The number of measurements that can be in flight at once, before the oldest one has to be read back.
+  // The GPU usually runs a couple of frames behind, so this is enough for results to be ready before they are needed.
+  static constexpr uint32_t RING_SIZE = 4;
+
+  // The IDs of the timestamp queries issued at the start of each measurement.
+  std::array<GLuint, RING_SIZE> startQueryIds;
+  // The IDs of the timestamp queries issued at the end of each measurement.
+  std::array<GLuint, RING_SIZE> endQueryIds;
+  // Whether each measurement was issued and not read back yet.
+  std::array<bool, RING_SIZE> isPending;
+  // The index of the next measurement to issue.
+  uint32_t nextSlot;
+  // The index of the measurement currently being issued.
+  uint32_t activeSlot;
+  // The GPU time of the last measurement read back in milliseconds.
+  double lastTimeMs;
+};
+
+/**
+ * A manager class for measuring the time the GPU takes to execute the commands between two points.
+ * Timestamp queries are used instead of elapsed time queries so that timers can be nested
+ *   (e.g. per model type timers inside the model render pass timer).
+ */
+class GpuTimerManager
+{
+private:
+  // Singleton instance of the GPU timer manager.
+  static GpuTimerManager instance;
+
+  // The window manager responsible for the window (must be created before any query).
+  WindowManager &windowManager;
+  // The CPU profiler the measurements are recorded to while it is capturing.
+  CpuProfiler &cpuProfiler;
+
+  // The name interner the names of the timers are interned with.
+  NameInterner &nameInterner;
+  // The map of named timers, by their interned names.
+  FlatHashMap<NameId, GpuTimerQueries> namedTimers;
+
+  // Whether the offset from the GPU timestamps to the steady clock of the CPU profiler was measured for its running capture.
+  bool isClockOffsetMeasured;
+  // The offset from the GPU timestamps to the steady clock of the CPU profiler (in nanoseconds).
+  int64_t clockOffset;
+
+  /**
+   * Read back the results of the measurements of the given timer that the GPU has finished, without waiting for it.
+   * 
+   * @param timerNameId  The interned name of the timer.
+   * @param timer        The timer to read the results of.
+   */
+  void collectResults(const NameId &timerNameId, GpuTimerQueries &timer)
+  {
+    // Measure the offset of the GPU clock once per capture of the profiler, to place the measurements next to the CPU zones.
+    const auto isCapturing = cpuProfiler.isCaptureRunning();
+    if (isCapturing && !isClockOffsetMeasured)
+    {
+      GLint64 gpuTime = 0;
+      glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+      clockOffset = CpuProfiler::getTimestamp() - gpuTime;
+      isClockOffsetMeasured = true;
+    }
+    isClockOffsetMeasured = isCapturing;
+
+    // Iterate through the measurements from the oldest to the newest.
+    for (uint32_t i = 0; i < GpuTimerQueries::RING_SIZE; i++)
+    {
+      const auto slot = (timer.nextSlot + i) % GpuTimerQueries::RING_SIZE;
+      if (!timer.isPending[slot])
+      {
+        continue;
+      }
+
+      // Check if the end query is done, which also means the start query is done.
+      GLint isAvailable = GL_FALSE;
+      glGetQueryObjectiv(timer.endQueryIds[slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+      if (isAvailable == GL_FALSE)
+      {
+        // The newer measurements cannot be done either, so stop here.
+        return;
+      }
+
+      // Read the timestamps and store the time between them.
+      GLuint64 startTime, endTime;
+      glGetQueryObjectui64v(timer.startQueryIds[slot], GL_QUERY_RESULT, &startTime);
+      glGetQueryObjectui64v(timer.endQueryIds[slot], GL_QUERY_RESULT, &endTime);
+      timer.lastTimeMs = (endTime - startTime) / 1000000.0;
+      timer.isPending[slot] = false;
+      if (isCapturing)
+      {
+        cpuProfiler.recordGpuTime(nameInterner.getName(timerNameId), static_cast<int64_t>(startTime) + clockOffset, static_cast<int64_t>(endTime) + clockOffset);
+      }
+    }
+  }
+
+  GpuTimerManager()
+      : windowManager(WindowManager::getInstance()),
+        cpuProfiler(CpuProfiler::getInstance()),
+        nameInterner(NameInterner::getInstance()),
+        namedTimers(),
+        isClockOffsetMeasured(false),
+        clockOffset(0) {}
+
+  ~GpuTimerManager()
+  {
+    // Delete the queries of all the timers.
+    for (auto &namedTimer : namedTimers)
+    {
+      glDeleteQueries(GpuTimerQueries::RING_SIZE, namedTimer.second.startQueryIds.data());
+      glDeleteQueries(GpuTimerQueries::RING_SIZE, namedTimer.second.endQueryIds.data());
+    }
+  }
+
+public:
+  // Preventing copying the GPU timer manager, making sure only one instance can exist.
+  GpuTimerManager(const GpuTimerManager &) = delete;
+
+  /**
+   * Start a measurement with the given timer, creating the timer if it does not exist.
+   * 
+   * @param timerNameId  The interned name of the timer.
+   */
+  void beginTimer(const NameId &timerNameId)
+  {
+    // Check if the timer already exists.
+    auto existingTimer = namedTimers.find(timerNameId);
+    if (existingTimer == namedTimers.end())
+    {
+      // If not, create the queries of the timer.
+      GpuTimerQueries newTimer = {};
+      glGenQueries(GpuTimerQueries::RING_SIZE, newTimer.startQueryIds.data());
+      glGenQueries(GpuTimerQueries::RING_SIZE, newTimer.endQueryIds.data());
+      existingTimer = namedTimers.emplace(timerNameId, newTimer).first;
+    }
+    auto &timer = existingTimer->second;
+
+    // Read back whatever is done, so that the slot about to be reused is free in the usual case.
+    collectResults(timerNameId, timer);
+
+    // Issue the start timestamp of the measurement (a measurement still pending in the slot is dropped).
+    timer.activeSlot = timer.nextSlot;
+    timer.isPending[timer.activeSlot] = false;
+    glQueryCounter(timer.startQueryIds[timer.activeSlot], GL_TIMESTAMP);
+  }
+
+  void beginTimer(const std::string &timerName)
+  {
+    beginTimer(nameInterner.intern(timerName));
+  }
+
+  /**
+   * End the current measurement of the given timer.
+   * 
+   * @param timerNameId  The interned name of the timer.
+   */
+  void endTimer(const NameId &timerNameId)
+  {
+    // Issue the end timestamp of the measurement, and move on to the next slot.
+    auto &timer = namedTimers.at(timerNameId);
+    glQueryCounter(timer.endQueryIds[timer.activeSlot], GL_TIMESTAMP);
+    timer.isPending[timer.activeSlot] = true;
+    timer.nextSlot = (timer.activeSlot + 1) % GpuTimerQueries::RING_SIZE;
+  }
+
+  void endTimer(const std::string &timerName)
+  {
+    endTimer(nameInterner.intern(timerName));
+  }
+
+  /**
+   * Get the GPU time of the latest finished measurement of the given timer.
+   * Since the GPU runs behind the CPU, this is usually the measurement from a couple of frames before.
+   * 
+   * @param timerNameId  The interned name of the timer.
+   * 
+   * @return The GPU time in milliseconds (0 if no measurement has finished yet).
+   */
+  double getTimeMs(const NameId &timerNameId)
+  {
+    // Check if the timer exists.
+    const auto existingTimer = namedTimers.find(timerNameId);
+    if (existingTimer == namedTimers.end())
+    {
+      return 0.0;
+    }
+
+    // Read back whatever is done, and return the latest result.
+    collectResults(timerNameId, existingTimer->second);
+    return existingTimer->second.lastTimeMs;
+  }
+
+  double getTimeMs(const std::string &timerName)
+  {
+    return getTimeMs(nameInterner.intern(timerName));
+  }
+
+  /**
+   * Returns the singleton instance of the GPU timer manager.
+   * 
+   * @return The GPU timer manager singleton instance.
+   */
+  static GpuTimerManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the GPU timer manager singleton instance static variable.
+GpuTimerManager GpuTimerManager::instance;
+
+#endif
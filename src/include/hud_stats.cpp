@@ -0,0 +1,380 @@
+#ifndef INCLUDE_HUD_STATS_CPP
+#define INCLUDE_HUD_STATS_CPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "registry.cpp"
+#include "text_arena.cpp"
+#include "text.cpp"
+
+/**
+ * Structure for defining a counter of a line of the HUD stats, sampled since the last refresh of the HUD.
+ */
+struct HudStatsCounter
+{
+  // The name of the counter, shown before its value.
+  std::string name;
+  // The unit shown after the value of the counter (a string literal, e.g. "ms").
+  const char *unit;
+  // The sum of the samples since the last refresh, or the last value for the counters that are not averaged.
+  double_t value;
+  // The number of samples since the last refresh.
+  uint32_t samplesCount;
+  // Whether the samples are averaged (shown with decimals), instead of the last one being shown (as an integer).
+  bool isAveraged;
+};
+
+/**
+ * Structure for defining a line of a section of the HUD stats (e.g. the stats of a model type), made of its counters.
+ */
+struct HudStatsLine
+{
+  // The name of the line, shown before the title of its section.
+  std::string name;
+  // The counters of the line, in the order they are written in.
+  std::vector<HudStatsCounter> counters;
+  // Whether the line was written since the last refresh, the lines that were not being dropped from the HUD.
+  bool isWritten;
+};
+
+/**
+ * Structure for defining a section of the HUD stats, taking up a number of lines of the debug text going down from its position.
+ */
+struct HudStatsSection
+{
+  // The title of the section, shown after the name of each line.
+  std::string title;
+  // The position of the first line of the section, with the origin being the bottom-left of the screen.
+  glm::vec2 position;
+  // The number of lines the section takes up on screen.
+  uint32_t maxLinesCount;
+  // The lines of the section, in the order they were first written in.
+  std::vector<HudStatsLine> lines;
+  // The retained texts showing the lines of the section, one for each line on screen (created by the first refresh).
+  std::vector<RegistryHandle> textHandles;
+};
+
+/**
+ * A class for writing the counters of a line of the HUD stats, holding the lock of the HUD stats while doing so.
+ */
+class HudStatsLineWriter
+{
+private:
+  // The lock of the HUD stats, held until the line is written.
+  std::unique_lock<std::mutex> lock;
+  // The line written to.
+  HudStatsLine &line;
+  // The index of the next counter written.
+  size_t counterIndex;
+
+  /**
+   * Find the counter with the given name for the next counter written, moving it there (or adding it) if the counters of the
+   *   line were written in another order before.
+   *
+   * @param name        The name of the counter.
+   * @param unit        The unit of the counter.
+   * @param isAveraged  Whether the samples of the counter are averaged.
+   *
+   * @return The counter.
+   */
+  HudStatsCounter &findCounter(const std::string_view &name, const char *unit, const bool &isAveraged)
+  {
+    auto &counters = line.counters;
+    const auto counter = std::find_if(counters.begin() + counterIndex, counters.end(), [&name](const HudStatsCounter &counter) { return counter.name == name; });
+    if (counter == counters.end())
+    {
+      counters.insert(counters.begin() + counterIndex, {std::string(name), unit, 0.0, 0, isAveraged});
+    }
+    else
+    {
+      std::rotate(counters.begin() + counterIndex, counter, counter + 1);
+    }
+    return counters[counterIndex++];
+  }
+
+public:
+  HudStatsLineWriter(std::unique_lock<std::mutex> &&lock, HudStatsLine &line)
+      : lock(std::move(lock)),
+        line(line),
+        counterIndex(0)
+  {
+    line.isWritten = true;
+  }
+
+  /**
+   * Add a sample of a counter, which is shown averaged over the samples since the last refresh.
+   *
+   * @param name   The name of the counter.
+   * @param value  The value sampled.
+   * @param unit   The unit shown after the value (a string literal).
+   *
+   * @return The writer of the line.
+   */
+  HudStatsLineWriter &addSample(const std::string_view &name, const double_t &value, const char *unit = "")
+  {
+    auto &counter = findCounter(name, unit, true);
+    counter.value += value;
+    counter.samplesCount++;
+    return *this;
+  }
+
+  /**
+   * Set the value of a counter counting something (e.g. the instances rendered), which is shown as the last value set before the
+   *   refresh.
+   *
+   * @param name   The name of the counter.
+   * @param value  The value.
+   * @param unit   The unit shown after the value (a string literal).
+   *
+   * @return The writer of the line.
+   */
+  HudStatsLineWriter &setCount(const std::string_view &name, const uint64_t &value, const char *unit = "")
+  {
+    auto &counter = findCounter(name, unit, false);
+    counter.value = static_cast<double_t>(value);
+    counter.samplesCount++;
+    return *this;
+  }
+};
+
+/**
+ * A manager class for the stats shown in the debug text whose number of lines changes with the scene (e.g. a line for each model
+ *   type rendered), which the subsystems write as counters each frame instead of formatting text lines.
+ * The counters are formatted into retained texts only when the HUD is refreshed (a few times a second), averaged over the frames
+ *   since the last refresh, so that the frames in between neither format nor lay out the lines. Each section only takes up its
+ *   number of lines, and all the sections together only their number of characters, the lines left out being counted on the
+ *   last line of their section instead of being cut off by the maximum number of text characters. The lines that were not written
+ *   since the last refresh (e.g. the model types that went out of view) are dropped.
+ */
+class HudStatsManager
+{
+private:
+  // Singleton instance of the HUD stats manager.
+  static HudStatsManager instance;
+
+  // The text manager the lines of the HUD are retained in.
+  TextManager &textManager;
+
+  // The sections of the HUD, by their indices.
+  std::vector<HudStatsSection> sections;
+  // The time of the last refresh (in seconds).
+  double_t lastRefreshTime;
+  // The arena the lines are formatted into by the refreshes.
+  TextArena refreshTextArena;
+  // The mutex guarding the sections, since the counters are written from the render thread as well.
+  std::mutex sectionsMutex;
+
+  HudStatsManager()
+      : textManager(TextManager::getInstance()),
+        sections({}),
+        lastRefreshTime(0.0),
+        refreshTextArena(),
+        sectionsMutex() {}
+
+  /**
+   * Show a text on a line of a section, creating the retained text of the line if it was not created yet.
+   *
+   * @param section    The index of the section.
+   * @param lineIndex  The index of the line on screen.
+   * @param content    The text content.
+   * @param length     The number of bytes of the text content.
+   */
+  void setLineText(const uint32_t &section, const size_t &lineIndex, const char *content, const size_t &length)
+  {
+    auto &hudSection = sections[section];
+    while (hudSection.textHandles.size() <= lineIndex)
+    {
+      const auto position = hudSection.position - glm::vec2(0.0f, 0.5f * hudSection.textHandles.size());
+      hudSection.textHandles.push_back(textManager.addRetainedText("Hud::" + hudSection.title + std::to_string(hudSection.textHandles.size()), "", position, 0.5f));
+    }
+    textManager.setRetainedText(hudSection.textHandles[lineIndex], content, length);
+  }
+
+  /**
+   * Format the counters sampled since the last refresh into the lines of the sections, within the lines of each section and the
+   *   characters of the whole HUD, and start sampling them again. The sections mutex has to be held.
+   */
+  void refresh()
+  {
+    refreshTextArena.reset();
+    size_t charactersCount = 0;
+    for (uint32_t s = 0; s < sections.size(); s++)
+    {
+      auto &section = sections[s];
+      // Drop the lines (and the counters) that were not written since the last refresh.
+      section.lines.erase(std::remove_if(section.lines.begin(), section.lines.end(), [](const HudStatsLine &line) { return !line.isWritten; }), section.lines.end());
+
+      // Leave the last line of the section for the number of the lines left out if they do not all fit.
+      const auto shownLinesCount = section.lines.size() > section.maxLinesCount ? section.maxLinesCount - 1 : section.maxLinesCount;
+      size_t lineIndex = 0, hiddenLinesCount = 0;
+      for (auto &line : section.lines)
+      {
+        line.counters.erase(std::remove_if(line.counters.begin(), line.counters.end(), [](const HudStatsCounter &counter) { return counter.samplesCount == 0; }), line.counters.end());
+        if (lineIndex >= shownLinesCount)
+        {
+          hiddenLinesCount++;
+          continue;
+        }
+
+        TextWriter text(refreshTextArena);
+        text << line.name << ' ' << section.title;
+        for (const auto &counter : line.counters)
+        {
+          text << " | " << counter.name << ": ";
+          if (counter.isAveraged)
+          {
+            text << counter.value / counter.samplesCount;
+          }
+          else
+          {
+            text << static_cast<int64_t>(counter.value);
+          }
+          text << counter.unit;
+        }
+        if (charactersCount + text.getLength() > HUD_STATS_CHAR_BUDGET)
+        {
+          hiddenLinesCount++;
+          continue;
+        }
+        charactersCount += text.getLength();
+        setLineText(s, lineIndex++, text.getContent(), text.getLength());
+      }
+      if (hiddenLinesCount > 0)
+      {
+        TextWriter text(refreshTextArena);
+        text << "+" << hiddenLinesCount << " More " << section.title << " Lines (Over HUD Budget)";
+        setLineText(s, lineIndex++, text.getContent(), text.getLength());
+      }
+      // Clear the lines of the section left over from the last refresh.
+      for (; lineIndex < section.textHandles.size(); lineIndex++)
+      {
+        textManager.setRetainedText(section.textHandles[lineIndex], "", 0);
+      }
+
+      // Start sampling the counters again.
+      for (auto &line : section.lines)
+      {
+        line.isWritten = false;
+        for (auto &counter : line.counters)
+        {
+          counter.value = 0.0;
+          counter.samplesCount = 0;
+        }
+      }
+    }
+  }
+
+public:
+  // Preventing copying the HUD stats manager, making sure only one instance can exist.
+  HudStatsManager(const HudStatsManager &) = delete;
+
+  /**
+   * Add a section to the HUD, for the lines written to it to be shown in.
+   *
+   * @param title          The title of the section, shown after the name of each line (e.g. "Model Render").
+   * @param position       The position of the first line of the section, with the origin being the bottom-left of the screen.
+   * @param maxLinesCount  The number of lines the section takes up on screen (at least one).
+   *
+   * @return The index of the section.
+   */
+  uint32_t registerSection(const std::string &title, const glm::vec2 &position, const uint32_t &maxLinesCount)
+  {
+    const std::lock_guard<std::mutex> lock(sectionsMutex);
+    sections.push_back({title, position, std::max(maxLinesCount, 1u), {}, {}});
+    return static_cast<uint32_t>(sections.size() - 1);
+  }
+
+  /**
+   * Get the position of the line right below the lines a section takes up, for the text following the section.
+   *
+   * @param section  The index of the section.
+   *
+   * @return The position of the line below the section, with the origin being the bottom-left of the screen.
+   */
+  glm::vec2 getSectionEndPosition(const uint32_t &section)
+  {
+    const std::lock_guard<std::mutex> lock(sectionsMutex);
+    return sections[section].position - glm::vec2(0.0f, 0.5f * sections[section].maxLinesCount);
+  }
+
+  /**
+   * Begin writing the counters of a line of a section for the frame, adding the line if it was not written before. The counters
+   *   written from the other threads wait until the returned writer is destroyed.
+   *
+   * @param section   The index of the section.
+   * @param lineName  The name of the line (e.g. the name of a model type).
+   *
+   * @return The writer of the line.
+   */
+  HudStatsLineWriter beginLine(const uint32_t &section, const std::string &lineName)
+  {
+    std::unique_lock<std::mutex> lock(sectionsMutex);
+    auto &lines = sections[section].lines;
+    auto line = std::find_if(lines.begin(), lines.end(), [&lineName](const HudStatsLine &line) { return line.name == lineName; });
+    if (line == lines.end())
+    {
+      lines.push_back({lineName, {}, false});
+      line = lines.end() - 1;
+    }
+    return HudStatsLineWriter(std::move(lock), *line);
+  }
+
+  /**
+   * Refresh the lines of the HUD if the refresh interval passed since the last refresh, leaving the retained texts of the lines
+   *   as they are otherwise.
+   *
+   * @param time  The current time (in seconds).
+   */
+  void update(const double_t &time)
+  {
+    if (time - lastRefreshTime < 1.0 / HUD_STATS_REFRESH_RATE)
+    {
+      return;
+    }
+    lastRefreshTime = time;
+    const std::lock_guard<std::mutex> lock(sectionsMutex);
+    refresh();
+  }
+
+  /**
+   * Take the lines of the HUD off the screen and forget the counters sampled so far (e.g. the ones of the last scene), keeping
+   *   the sections.
+   */
+  void clear()
+  {
+    const std::lock_guard<std::mutex> lock(sectionsMutex);
+    for (auto &section : sections)
+    {
+      section.lines.clear();
+      for (const auto &textHandle : section.textHandles)
+      {
+        textManager.removeRetainedText(textHandle);
+      }
+      section.textHandles.clear();
+    }
+    lastRefreshTime = 0.0;
+  }
+
+  /**
+   * Returns the singleton instance of the HUD stats manager.
+   *
+   * @return The HUD stats manager singleton instance.
+   */
+  static HudStatsManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the HUD stats manager singleton instance static variable.
+HudStatsManager HudStatsManager::instance;
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef INCLUDE_IMPOSTOR_CPP
+#define INCLUDE_IMPOSTOR_CPP
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "common.cpp"
+#include "constants.cpp"
+#include "shader.cpp"
+#include "texture.cpp"
+#include "object.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "render_packet.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Class for drawing the distant models of the model types drawn with impostors as billboards, instead of with their meshes.
+ * The full detail level of the object of each model type is baked once into an atlas, from a grid of view directions around the
+ *   up axis of the object and from below to above it, with the albedo of the surface and its normal in model-space along with its
+ *   depth towards the view. The billboards pick the view closest to the direction the camera sees them from, face it, and write
+ *   the baked surface into the G-buffer the way the models drawn with their meshes do, with the depth of the surface, so that the
+ *   lighting pass lights them the same way. The atlas is baked again if the object or the texture of the model type changes (e.g.
+ *   when a streamed texture replaces its placeholder).
+ * Only the G-buffer pass of the deferred shading draws the impostors, the other passes drawing the same models with the coarsest
+ *   level of detail of their object instead.
+ */
+class ImpostorRenderer
+{
+private:
+  /**
+   * Structure for defining the atlas baked for a model type.
+   */
+  struct ImpostorAtlas
+  {
+    // The IDs of the albedo texture of the atlas, and of its texture of the normals in model-space with the depth towards the view.
+    GLuint albedoTextureId;
+    GLuint normalDepthTextureId;
+    // The IDs of the vertex buffer of the object and of the texture the atlas was baked from (0 if it was never baked).
+    GLuint vertexBufferId;
+    GLuint textureId;
+    // The center of the bounding box of the object in model-space, with the radius of the views around it in W.
+    glm::vec4 bounds;
+  };
+
+  // The shader manager responsible for creating the impostor shaders.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the atlases are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program baking the objects into the atlases.
+  const std::shared_ptr<const ShaderDetails> bakeShaderDetails;
+  // The shader program drawing the billboards into the G-buffer.
+  const std::shared_ptr<const ShaderDetails> impostorShaderDetails;
+  // The uniform IDs of the impostor shaders.
+  const GLuint impostorViewProjectionMatrixUniformId;
+  const GLuint impostorBoundsUniformId;
+  const GLuint impostorViewDirectionUniformId;
+  const GLuint impostorTextureLayerUniformId;
+  const GLuint impostorViewCountsUniformId;
+  const GLuint diffuseTextureUniformId;
+  const GLuint impostorAlbedoTextureUniformId;
+  const GLuint impostorNormalDepthTextureUniformId;
+
+  // The framebuffer the atlases are baked in, with the depth renderbuffer shared by all of them.
+  GLuint bakeFramebufferId;
+  GLuint bakeDepthRenderbufferId;
+  // The vertex array object the billboards are drawn with, with no vertex attributes (the corners come from the vertex IDs)
+  //   and the per-instance attributes of the models.
+  GLuint vertexArrayId;
+
+  // The atlases of the model types, by the model type IDs.
+  std::vector<ImpostorAtlas> atlases;
+
+  /**
+   * Get the direction the view of the given cell of the atlases is baked from, towards the camera. The columns go around the up
+   *   axis of the object, and the rows from below the object to above it, matching the views picked by the impostor shader.
+   * 
+   * @param column  The column of the cell.
+   * @param row     The row of the cell.
+   * 
+   * @return The direction of the view in model-space.
+   */
+  static glm::vec3 getViewDirection(const uint32_t &column, const uint32_t &row)
+  {
+    const auto yaw = column * glm::two_pi<float_t>() / IMPOSTOR_YAW_VIEWS;
+    const auto elevation = (((row + 0.5f) / IMPOSTOR_PITCH_VIEWS) - 0.5f) * glm::pi<float_t>();
+    return glm::vec3(std::cos(elevation) * std::sin(yaw), std::sin(elevation), std::cos(elevation) * std::cos(yaw));
+  }
+
+  /**
+   * Create a texture of the size of the atlases with the given format, filtered through its mip-maps, accounting it in the GPU
+   *   memory.
+   * 
+   * @param internalFormat  The internal format of the texture.
+   * @param type            The type of the texel components.
+   * @param bytesPerTexel   The size of a texel in bytes.
+   * 
+   * @return The ID of the created texture.
+   */
+  GLuint createAtlasTexture(const GLint &internalFormat, const GLenum &type, const uint32_t &bytesPerTexel)
+  {
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, internalFormat, IMPOSTOR_ATLAS_SIZE, IMPOSTOR_ATLAS_SIZE, GL_RGBA, type, nullptr, bytesPerTexel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureId, GpuMemoryCategory::TEXTURE, "Impostors", GpuMemoryManager::getTextureSize(IMPOSTOR_ATLAS_SIZE, IMPOSTOR_ATLAS_SIZE, 1, bytesPerTexel, true));
+    return textureId;
+  }
+
+public:
+  ImpostorRenderer()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        bakeShaderDetails(shaderManager.createShaderProgram("ImpostorRenderer::Bake", "assets/shaders/vertex/impostor_bake.glsl", "assets/shaders/fragment/impostor_bake.glsl")),
+        impostorShaderDetails(shaderManager.createShaderProgram("ImpostorRenderer::Impostor", "assets/shaders/vertex/impostor.glsl", "assets/shaders/fragment/impostor.glsl")),
+        impostorViewProjectionMatrixUniformId(shaderManager.getUniformId("impostorViewProjectionMatrix")),
+        impostorBoundsUniformId(shaderManager.getUniformId("impostorBounds")),
+        impostorViewDirectionUniformId(shaderManager.getUniformId("impostorViewDirection")),
+        impostorTextureLayerUniformId(shaderManager.getUniformId("impostorTextureLayer")),
+        impostorViewCountsUniformId(shaderManager.getUniformId("impostorViewCounts")),
+        diffuseTextureUniformId(shaderManager.getUniformId("diffuseTexture")),
+        impostorAlbedoTextureUniformId(shaderManager.getUniformId("impostorAlbedoTexture")),
+        impostorNormalDepthTextureUniformId(shaderManager.getUniformId("impostorNormalDepthTexture")),
+        bakeFramebufferId(0),
+        bakeDepthRenderbufferId(0),
+        vertexArrayId(0),
+        atlases({})
+  {
+    // Create the framebuffer the atlases are baked in, their textures being attached to it as they are baked.
+    glGenFramebuffers(1, &bakeFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, bakeFramebufferId);
+    glGenRenderbuffers(1, &bakeDepthRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, bakeDepthRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, IMPOSTOR_ATLAS_SIZE, IMPOSTOR_ATLAS_SIZE);
+    gpuMemoryManager.recordAllocation(GpuResourceType::RENDERBUFFER, bakeDepthRenderbufferId, GpuMemoryCategory::RENDER_TARGET, "Impostors", GpuMemoryManager::getTextureSize(IMPOSTOR_ATLAS_SIZE, IMPOSTOR_ATLAS_SIZE, 1, 4, false));
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, bakeDepthRenderbufferId);
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~ImpostorRenderer()
+  {
+    // Destroy the impostor shaders.
+    shaderManager.destroyShaderProgram(bakeShaderDetails);
+    shaderManager.destroyShaderProgram(impostorShaderDetails);
+    // Delete the framebuffer, the vertex array object and the textures of the atlases.
+    GlCalls::deleteFramebuffers(1, &bakeFramebufferId);
+    glDeleteRenderbuffers(1, &bakeDepthRenderbufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::RENDERBUFFER, bakeDepthRenderbufferId);
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+    for (const auto &atlas : atlases)
+    {
+      if (atlas.albedoTextureId != 0)
+      {
+        GlCalls::deleteTextures(1, &atlas.albedoTextureId);
+        GlCalls::deleteTextures(1, &atlas.normalDepthTextureId);
+        gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, atlas.albedoTextureId);
+        gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, atlas.normalDepthTextureId);
+      }
+    }
+  }
+
+  // Preventing copying the impostor renderer, since it owns GPU resources.
+  ImpostorRenderer(const ImpostorRenderer &) = delete;
+
+  /**
+   * Check if the atlas of the model type of the given model is baked from its current object and texture.
+   * 
+   * @param model  The model.
+   * 
+   * @return Whether the atlas is baked.
+   */
+  bool isAtlasBaked(ModelBaseIntf &model) const
+  {
+    const auto &modelTypeId = model.getModelTypeId();
+    return modelTypeId < atlases.size() &&
+           atlases[modelTypeId].vertexBufferId == model.getObjectDetails()->getVertexBufferId() &&
+           atlases[modelTypeId].textureId == model.getTextureDetails()->getTextureId();
+  }
+
+  /**
+   * Bake the atlas of the model type of the given model from its object and texture, creating the atlas if it is the first one of
+   *   the model type. Binds its own framebuffer and viewport, and changes the program, the diffuse texture and the vertex array
+   *   object bound, so the render target has to be bound again afterwards, and the state of the models set again.
+   * 
+   * @param model  The model.
+   */
+  void bakeAtlas(ModelBaseIntf &model)
+  {
+    const auto &modelTypeId = model.getModelTypeId();
+    if (modelTypeId >= atlases.size())
+    {
+      atlases.resize(modelTypeId + 1, {0, 0, 0, 0, glm::vec4(0.0f)});
+    }
+    auto &atlas = atlases[modelTypeId];
+    if (atlas.albedoTextureId == 0)
+    {
+      atlas.albedoTextureId = createAtlasTexture(GL_RGBA8, GL_UNSIGNED_BYTE, 4);
+      atlas.normalDepthTextureId = createAtlasTexture(GL_RGBA16F, GL_HALF_FLOAT, 8);
+    }
+    const auto &objectDetails = model.getObjectDetails();
+    const auto &textureDetails = model.getTextureDetails();
+    atlas.vertexBufferId = objectDetails->getVertexBufferId();
+    atlas.textureId = textureDetails->getTextureId();
+    const auto center = (objectDetails->getMinCorner() + objectDetails->getMaxCorner()) * 0.5f;
+    const auto radius = glm::length(objectDetails->getMaxCorner() - objectDetails->getMinCorner()) * 0.5f;
+    atlas.bounds = glm::vec4(center, radius);
+
+    // Clear the atlas to no surface, without touching the clear color and depth the scenes set.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, bakeFramebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas.albedoTextureId, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlas.normalDepthTextureId, 0);
+    const GLfloat clearColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat clearDepth = 1.0f;
+    GlCalls::viewport(0, 0, IMPOSTOR_ATLAS_SIZE, IMPOSTOR_ATLAS_SIZE);
+    glClearBufferfv(GL_COLOR, 0, clearColor);
+    glClearBufferfv(GL_COLOR, 1, clearColor);
+    glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+    // Draw the full detail level of the object into each cell, seen through an orthographic projection fitting the bounds.
+    GlCalls::useProgram(bakeShaderDetails->getShaderId());
+    GlCalls::activeTexture(GL_TEXTURE0);
+    GlCalls::bindTexture(TextureDetails::getTextureTarget(), textureDetails->getTextureId());
+    GlCalls::uniform1i(bakeShaderDetails->getUniformLocation(diffuseTextureUniformId), 0);
+    GlCalls::uniform1i(bakeShaderDetails->getUniformLocation(impostorTextureLayerUniformId), static_cast<GLint>(textureDetails->getTextureLayer()));
+    GlCalls::uniform4f(bakeShaderDetails->getUniformLocation(impostorBoundsUniformId), center.x, center.y, center.z, radius);
+    GlCalls::bindVertexArray(objectDetails->getVertexArrayId());
+    const auto &lod = objectDetails->getLod(0);
+    const auto cellWidth = IMPOSTOR_ATLAS_SIZE / static_cast<int32_t>(IMPOSTOR_YAW_VIEWS);
+    const auto cellHeight = IMPOSTOR_ATLAS_SIZE / static_cast<int32_t>(IMPOSTOR_PITCH_VIEWS);
+    const auto projectionMatrix = glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius);
+    for (uint32_t row = 0; row < IMPOSTOR_PITCH_VIEWS; row++)
+    {
+      for (uint32_t column = 0; column < IMPOSTOR_YAW_VIEWS; column++)
+      {
+        const auto viewDirection = getViewDirection(column, row);
+        const auto viewMatrix = glm::lookAt(center + (viewDirection * (2.0f * radius)), center, glm::vec3(0.0f, 1.0f, 0.0f));
+        const auto viewProjectionMatrix = projectionMatrix * viewMatrix;
+        GlCalls::viewport(column * cellWidth, row * cellHeight, cellWidth, cellHeight);
+        GlCalls::uniformMatrix4fv(bakeShaderDetails->getUniformLocation(impostorViewProjectionMatrixUniformId), 1, GL_FALSE, &viewProjectionMatrix[0][0]);
+        GlCalls::uniform4f(bakeShaderDetails->getUniformLocation(impostorViewDirectionUniformId), viewDirection.x, viewDirection.y, viewDirection.z, 0.0f);
+        GlCalls::drawElements(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, reinterpret_cast<const void *>(static_cast<uintptr_t>(lod.indexOffset) * sizeof(uint32_t)));
+      }
+    }
+    GlCalls::bindVertexArray(0);
+    GlCalls::bindTexture(TextureDetails::getTextureTarget(), 0);
+
+    // Filter the distant billboards through the mip-maps of the atlas.
+    GlCalls::bindTexture(GL_TEXTURE_2D, atlas.albedoTextureId);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GlCalls::bindTexture(GL_TEXTURE_2D, atlas.normalDepthTextureId);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  /**
+   * Draw the models of the given model groups far enough to be drawn as impostors into the bound G-buffer, as billboards with an
+   *   instanced draw call per model group. The atlases of their model types must already be baked. The atlas textures are bound to
+   *   the given texture unit and the one after it, and unbound once done, along with the vertex array object.
+   * 
+   * @param modelGroups             The models in the scene grouped by model type.
+   * @param isImpostorDrawn         Whether the impostors of each model group are drawn, in the same order as the model groups.
+   * @param modelMatrixBufferId     The ID of the buffer containing the model matrices of the model groups.
+   * @param lightMaskBufferId       The ID of the buffer containing the masks of the lights reaching the models of the groups.
+   * @param modelMatrixAttributeId  The ID of the first of the four attributes of the columns of the model matrices.
+   * @param lightMaskAttributeId    The ID of the attribute of the light masks.
+   * @param textureUnit             The first texture unit to bind the atlas textures to.
+   * 
+   * @return The number of billboards drawn.
+   */
+  uint32_t renderImpostors(const std::vector<ModelGroup> &modelGroups, const std::vector<bool> &isImpostorDrawn, const GLuint &modelMatrixBufferId, const GLuint &lightMaskBufferId, const GLuint &modelMatrixAttributeId, const GLuint &lightMaskAttributeId, const GLuint &textureUnit) const
+  {
+    GlCalls::useProgram(impostorShaderDetails->getShaderId());
+    GlCalls::uniform1i(impostorShaderDetails->getUniformLocation(impostorAlbedoTextureUniformId), textureUnit);
+    GlCalls::uniform1i(impostorShaderDetails->getUniformLocation(impostorNormalDepthTextureUniformId), textureUnit + 1);
+    GlCalls::uniform2i(impostorShaderDetails->getUniformLocation(impostorViewCountsUniformId), IMPOSTOR_YAW_VIEWS, IMPOSTOR_PITCH_VIEWS);
+    GlCalls::bindVertexArray(vertexArrayId);
+
+    uint32_t impostorsCount = 0;
+    for (size_t i = 0; i < modelGroups.size(); i++)
+    {
+      const auto &modelGroup = modelGroups[i];
+      if (!isImpostorDrawn[i])
+      {
+        continue;
+      }
+      const auto &atlas = atlases[modelGroup.model->getModelTypeId()];
+      GlCalls::bindTextureUnit(textureUnit, GL_TEXTURE_2D, atlas.albedoTextureId);
+      GlCalls::bindTextureUnit(textureUnit + 1, GL_TEXTURE_2D, atlas.normalDepthTextureId);
+      GlCalls::uniform4f(impostorShaderDetails->getUniformLocation(impostorBoundsUniformId), atlas.bounds.x, atlas.bounds.y, atlas.bounds.z, atlas.bounds.w);
+
+      // Point the per-instance attributes at the impostors, which are the last of the visible models of the group.
+      const auto firstImpostor = modelGroup.instanceOffset + modelGroup.visibleInstanceCount - modelGroup.impostorInstanceCount;
+      for (GLuint c = 0; c < 4; c++)
+      {
+        VertexArray::enableAttribute(modelMatrixAttributeId + c, modelMatrixBufferId, 4, GL_FLOAT, 1, sizeof(glm::mat4), (firstImpostor * sizeof(glm::mat4)) + (c * sizeof(glm::vec4)));
+      }
+      VertexArray::enableAttribute(lightMaskAttributeId, lightMaskBufferId, 1, GL_UNSIGNED_INT, 1, sizeof(uint32_t), firstImpostor * sizeof(uint32_t));
+
+      // Draw a quad per impostor.
+      GlCalls::drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, modelGroup.impostorInstanceCount);
+      impostorsCount += modelGroup.impostorInstanceCount;
+    }
+
+    GlCalls::bindVertexArray(0);
+    GlCalls::bindTextureUnit(textureUnit + 1, GL_TEXTURE_2D, 0);
+    GlCalls::bindTextureUnit(textureUnit, GL_TEXTURE_2D, 0);
+    return impostorsCount;
+  }
+
+  /**
+   * Get the given model group with its models far enough to be drawn as impostors left out of its coarsest level of detail, for
+   *   drawing the rest of its models with their meshes along with the impostors.
+   * 
+   * @param modelGroup  The model group.
+   * 
+   * @return The model group without the impostors.
+   */
+  static ModelGroup getMeshModelGroup(const ModelGroup &modelGroup)
+  {
+    auto lodInstanceCounts = modelGroup.lodInstanceCounts;
+    lodInstanceCounts[OBJECT_LOD_COUNT - 1] -= modelGroup.impostorInstanceCount;
+    return {modelGroup.model, modelGroup.instanceOffset, modelGroup.instanceCount, modelGroup.visibleInstanceCount, modelGroup.viewDepth, lodInstanceCounts, 0};
+  }
+};
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef INCLUDE_INPUT_RECORDING_CPP
+#define INCLUDE_INPUT_RECORDING_CPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+/**
+ * An enum for the kinds of window input events recorded.
+ */
+enum class InputEventType : uint8_t
+{
+  KEY,
+  MOUSE_BUTTON,
+  CURSOR
+};
+
+/**
+ * Structure for defining a window input event, as received by the GLFW input callbacks.
+ */
+struct InputEvent
+{
+  // The kind of the event.
+  InputEventType type;
+  // The GLFW key code or mouse button, and the GLFW action (for the key and mouse button events).
+  int16_t code;
+  uint8_t action;
+  // The normalized position of the cursor (for the cursor events).
+  double_t x;
+  double_t y;
+};
+
+/**
+ * Structure for defining a frame of an input recording, from a poll of the window events to the next.
+ */
+struct InputRecordingFrame
+{
+  // The time of the poll, since the recording started (in seconds).
+  double_t time;
+  // The number of simulation steps run before the poll, since the poll before.
+  uint16_t stepsCount;
+  // The events received by the poll.
+  std::vector<InputEvent> events;
+};
+
+/**
+ * A class for writing the window input of a session to a compact binary file, a frame per poll of the window events. The
+ *   file starts with a header (the magic, the version and the seed of the session), followed by the frames, each its time, its
+ *   number of simulation steps, and its events. The values are written in the byte order of the machine, since the recordings
+ *   are only meant to be replayed where they were made.
+ */
+class InputRecorder
+{
+private:
+  // The stream the recording is written to.
+  std::ofstream stream;
+
+  /**
+   * Write a value to the recording as its bytes.
+   * 
+   * @param value  The value.
+   */
+  template <typename T>
+  void writeValue(const T &value)
+  {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+public:
+  // The magic the recordings start with, and the version of their format.
+  static constexpr char MAGIC[4] = {'I', 'N', 'P', 'R'};
+  static constexpr uint32_t VERSION = 1;
+
+  /**
+   * Start writing a recording to a file, replacing the file if it exists.
+   * 
+   * @param path  The path of the file.
+   * @param seed  The seed of the session, for the random generators to be seeded with when replayed.
+   * 
+   * @return Whether the file could be opened.
+   */
+  bool open(const std::string &path, const uint32_t &seed)
+  {
+    stream.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+      return false;
+    }
+    stream.write(MAGIC, sizeof(MAGIC));
+    writeValue(VERSION);
+    writeValue(seed);
+    return stream.good();
+  }
+
+  /**
+   * Get whether a recording is being written.
+   * 
+   * @return Whether the recording is open.
+   */
+  bool isOpen() const
+  {
+    return stream.is_open();
+  }
+
+  /**
+   * Write a frame to the recording. The key and mouse button events take 4 bytes, and the cursor events 17.
+   * 
+   * @param time        The time of the poll, since the recording started (in seconds).
+   * @param stepsCount  The number of simulation steps run since the poll before.
+   * @param events      The events received by the poll.
+   */
+  void writeFrame(const double_t &time, const uint16_t &stepsCount, const std::vector<InputEvent> &events)
+  {
+    writeValue(time);
+    writeValue(stepsCount);
+    writeValue(static_cast<uint32_t>(events.size()));
+    for (const auto &event : events)
+    {
+      writeValue(event.type);
+      if (event.type == InputEventType::CURSOR)
+      {
+        writeValue(event.x);
+        writeValue(event.y);
+      }
+      else
+      {
+        writeValue(event.code);
+        writeValue(event.action);
+      }
+    }
+  }
+
+  /**
+   * Finish writing the recording, flushing it to the file.
+   * 
+   * @return Whether the recording was written.
+   */
+  bool close()
+  {
+    stream.flush();
+    const auto isWritten = stream.good();
+    stream.close();
+    return isWritten;
+  }
+};
+
+/**
+ * A class for reading the window input of a session recorded by the input recorder, to replay it frame by frame.
+ */
+class InputReplay
+{
+private:
+  // The seed of the recorded session.
+  uint32_t seed;
+  // The recorded frames.
+  std::vector<InputRecordingFrame> frames;
+  // The index of the frame replayed next.
+  size_t nextFrameIndex;
+
+  /**
+   * Read a value from the bytes of a recording, moving past it.
+   * 
+   * @param bytes   The bytes of the recording.
+   * @param offset  The offset of the value in the bytes, moved past the value.
+   * @param value   The value read.
+   * 
+   * @return Whether the bytes held the value.
+   */
+  template <typename T>
+  static bool readValue(const std::vector<char> &bytes, size_t &offset, T &value)
+  {
+    if (offset + sizeof(T) > bytes.size())
+    {
+      return false;
+    }
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+  }
+
+public:
+  InputReplay()
+      : seed(0),
+        frames({}),
+        nextFrameIndex(0) {}
+
+  /**
+   * Read a recording from a file.
+   * 
+   * @param path  The path of the file.
+   * 
+   * @return Whether the file is a recording of the supported version, read in full.
+   */
+  bool load(const std::string &path)
+  {
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+    {
+      return false;
+    }
+    const auto bytes = std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    frames.clear();
+    nextFrameIndex = 0;
+    size_t offset = 0;
+    char magic[sizeof(InputRecorder::MAGIC)];
+    auto version = static_cast<uint32_t>(0);
+    if (!readValue(bytes, offset, magic) || std::memcmp(magic, InputRecorder::MAGIC, sizeof(magic)) != 0 ||
+        !readValue(bytes, offset, version) || version != InputRecorder::VERSION || !readValue(bytes, offset, seed))
+    {
+      return false;
+    }
+    while (offset < bytes.size())
+    {
+      auto frame = InputRecordingFrame({0.0, 0, {}});
+      auto eventsCount = static_cast<uint32_t>(0);
+      if (!readValue(bytes, offset, frame.time) || !readValue(bytes, offset, frame.stepsCount) || !readValue(bytes, offset, eventsCount))
+      {
+        return false;
+      }
+      frame.events.reserve(eventsCount);
+      for (uint32_t i = 0; i < eventsCount; i++)
+      {
+        auto event = InputEvent({InputEventType::KEY, 0, 0, 0.0, 0.0});
+        if (!readValue(bytes, offset, event.type) ||
+            (event.type == InputEventType::CURSOR ? !readValue(bytes, offset, event.x) || !readValue(bytes, offset, event.y)
+                                                  : !readValue(bytes, offset, event.code) || !readValue(bytes, offset, event.action)))
+        {
+          return false;
+        }
+        frame.events.push_back(event);
+      }
+      frames.push_back(std::move(frame));
+    }
+    return true;
+  }
+
+  /**
+   * Get the seed of the recorded session.
+   * 
+   * @return The seed.
+   */
+  const uint32_t &getSeed() const
+  {
+    return seed;
+  }
+
+  /**
+   * Start replaying from the first frame.
+   */
+  void rewind()
+  {
+    nextFrameIndex = 0;
+  }
+
+  /**
+   * Get whether all the frames are replayed.
+   * 
+   * @return Whether the replay is finished.
+   */
+  bool isFinished() const
+  {
+    return nextFrameIndex >= frames.size();
+  }
+
+  /**
+   * Get the frame replayed next.
+   * 
+   * @return The next frame, which must not be asked for once the replay is finished.
+   */
+  const InputRecordingFrame &getNextFrame() const
+  {
+    return frames[nextFrameIndex];
+  }
+
+  /**
+   * Move on to the next frame, once the one replayed is done.
+   */
+  void advance()
+  {
+    nextFrameIndex++;
+  }
+
+  /**
+   * Get the number of frames replayed so far.
+   * 
+   * @return The number of frames replayed.
+   */
+  const size_t &getReplayedFramesCount() const
+  {
+    return nextFrameIndex;
+  }
+
+  /**
+   * Get the number of frames recorded.
+   * 
+   * @return The number of frames.
+   */
+  size_t getFramesCount() const
+  {
+    return frames.size();
+  }
+};
+
+#endif
@@ -0,0 +1,779 @@
+#ifndef INCLUDE_JOB_CPP
+#define INCLUDE_JOB_CPP
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+#include "constants.cpp"
+#include "mpsc_queue.cpp"
+#include "thread_scheduling.cpp"
+
+/**
+ * Structure for defining a range of the items of a parallel loop, run as a single job.
+ */
+struct JobRange
+{
+  // The index of the first item of the job.
+  size_t begin;
+  // The index after the last item of the job.
+  size_t end;
+};
+
+/**
+ * Structure for defining the time a thread spent running the jobs of the last parallel loop. Aligned to a cache line, so that
+ *   the threads do not slow each other down writing their timings next to each other.
+ */
+struct alignas(64) JobThreadTiming
+{
+  // The time spent running jobs (in seconds).
+  double_t busyTime;
+  // The number of jobs run.
+  uint32_t jobsCount;
+};
+
+/**
+ * Class for defining the jobs queued for a thread. The thread takes its jobs from the back, while the other threads steal them
+ *   from the front, so that the thieves take the jobs the owner would run last.
+ */
+template <typename T>
+class JobQueue
+{
+private:
+  // The mutex guarding the jobs.
+  std::mutex mutex;
+  // The queued jobs, of which the ones before the front index are already taken (kept around to avoid reallocating every loop).
+  std::vector<T> jobs;
+  // The index of the first job not taken from the front.
+  size_t frontIndex;
+
+  /**
+   * Start over once the queue runs empty, keeping its memory.
+   */
+  void resetIfEmpty()
+  {
+    if (frontIndex == jobs.size())
+    {
+      jobs.clear();
+      frontIndex = 0;
+    }
+  }
+
+public:
+  JobQueue()
+      : jobs(),
+        frontIndex(0) {}
+
+  /**
+   * Queue a new job.
+   * 
+   * @param job  The job to queue.
+   */
+  void push(T job)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+  }
+
+  /**
+   * Take the job queued last, as the thread owning the queue.
+   * 
+   * @param job  The job taken, if any.
+   * 
+   * @return Whether a job was taken.
+   */
+  bool pop(T &job)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (frontIndex == jobs.size())
+    {
+      return false;
+    }
+    job = std::move(jobs.back());
+    jobs.pop_back();
+    resetIfEmpty();
+    return true;
+  }
+
+  /**
+   * Take the job queued first, as a thread not owning the queue.
+   * 
+   * @param job  The job taken, if any.
+   * 
+   * @return Whether a job was taken.
+   */
+  bool steal(T &job)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (frontIndex == jobs.size())
+    {
+      return false;
+    }
+    job = std::move(jobs[frontIndex++]);
+    resetIfEmpty();
+    return true;
+  }
+};
+
+/**
+ * Class for defining a task submitted to the job manager, which runs once all the tasks it depends on are finished.
+ */
+class JobTask
+{
+private:
+  friend class JobManager;
+
+  // The function of the task, released once it has run.
+  std::function<void()> function;
+  // Whether the task has to run on the main thread (e.g. since it makes GL calls).
+  const bool isMainThreadTask;
+  // The number of dependencies of the task not finished yet, plus one held while the task is being submitted.
+  std::atomic<uint32_t> pendingDependenciesCount;
+  // The mutex guarding the continuations and the finished flag against the tasks submitted while the task finishes.
+  std::mutex continuationsMutex;
+  // The tasks waiting for the task to finish.
+  std::vector<std::shared_ptr<JobTask>> continuations;
+  // Whether the task is finished.
+  std::atomic<bool> isTaskFinished;
+
+public:
+  JobTask(std::function<void()> function, const bool &isMainThreadTask)
+      : function(std::move(function)),
+        isMainThreadTask(isMainThreadTask),
+        pendingDependenciesCount(0),
+        continuations(),
+        isTaskFinished(false) {}
+
+  /**
+   * Check whether the task is finished, in which case everything it did is visible to the calling thread.
+   * 
+   * @return Whether the task is finished.
+   */
+  bool isFinished() const
+  {
+    return isTaskFinished.load(std::memory_order_acquire);
+  }
+};
+
+/**
+ * A manager class for running work on a pool of worker threads, shared by all the systems of the engine instead of each of them
+ *   starting their own threads:
+ *   - Parallel loops split their items into jobs queued round-robin to the threads (the calling main thread included), and the
+ *       threads running out of jobs steal them from the others. Parallel loops can only be run from the main thread.
+ *   - Tasks run once the tasks they depend on are finished, on the worker threads, which steal them from each other as well.
+ *       Tasks making GL calls are queued for the main thread instead, which runs them in runMainThreadTasks().
+ * The worker threads are only started on first use, and without any (on a single hardware thread) all the tasks run on the
+ *   main thread.
+ */
+class JobManager
+{
+private:
+  // Singleton instance of the job manager.
+  static JobManager instance;
+  // The index of the threads not started by the manager other than the main thread (e.g. the render thread), which neither own a
+  //   task queue nor run the tasks queued for the main thread.
+  static constexpr uint32_t EXTERNAL_THREAD_INDEX = std::numeric_limits<uint32_t>::max();
+  // The index of the thread running the code, where the main thread is 0 (set by the manager, constructed on the main thread).
+  inline static thread_local uint32_t currentThreadIndex = EXTERNAL_THREAD_INDEX;
+
+  // The number of worker threads to start, taken from the hardware concurrency unless configured.
+  uint32_t workerThreadsCount;
+  // The worker threads, run alongside the main thread.
+  std::vector<std::thread> workerThreads;
+  // The flag the worker threads are started once by, since the main thread and the render thread can both use them first.
+  std::once_flag workerThreadsStartFlag;
+  // Whether the worker threads were started, so that their number is no longer changed.
+  std::atomic<bool> areWorkerThreadsStarted;
+  // The loop jobs queued for each thread, the main thread first.
+  std::vector<std::unique_ptr<JobQueue<JobRange>>> loopJobQueues;
+  // The tasks queued for each thread, the main thread first (which does not queue tasks for itself, but steals them).
+  std::vector<std::unique_ptr<JobQueue<std::shared_ptr<JobTask>>>> taskQueues;
+  // The timings of each thread in the last parallel loop, the main thread first.
+  std::vector<JobThreadTiming> threadTimings;
+  // The number of tasks queued by the main thread and the external threads, spreading them round-robin over the worker threads
+  //   (atomic, since the render thread queues tasks alongside the main thread).
+  std::atomic<uint32_t> spreadTasksCount;
+
+  // The tasks queued for the main thread, pushed from any thread without a lock.
+  MpscQueue<std::shared_ptr<JobTask>, MAIN_THREAD_QUEUE_CAPACITY> mainThreadTasks;
+  // The mutex guarding the tasks queued for the main thread while their queue is full.
+  std::mutex overflowMainThreadTasksMutex;
+  // The tasks queued for the main thread while their queue was full, run after the ones in the queue.
+  std::vector<std::shared_ptr<JobTask>> overflowMainThreadTasks;
+  // The number of tasks queued while the queue was full, so that the main thread only takes the lock when there are some.
+  std::atomic<size_t> overflowMainThreadTasksCount;
+
+  // The mutex guarding the wake generation and the stop flag, which the worker threads wait on.
+  std::mutex wakeMutex;
+  // The condition that the worker threads are woken by when jobs are queued, or when they are stopped.
+  std::condition_variable wakeCondition;
+  // The number of times jobs were queued, so that the worker threads know when there are new ones.
+  uint64_t wakeGeneration;
+  // Whether the worker threads are being stopped.
+  bool isStopping;
+
+  // The function running the items of a job of the current loop with the loop function.
+  void (*runLoopFunction)(const void *loopFunction, const size_t &begin, const size_t &end);
+  // The function of the current loop, run on the ranges of items of the jobs.
+  const void *loopFunction;
+  // The number of jobs of the current loop not finished yet.
+  std::atomic<size_t> pendingJobsCount;
+
+  JobManager()
+      : workerThreadsCount(ThreadSchedulingManager::getInstance().getJobCoresCount() > 0 ? ThreadSchedulingManager::getInstance().getJobCoresCount() : std::min(std::max(std::thread::hardware_concurrency(), 1u) - 1, MAX_JOB_WORKER_THREADS)),
+        workerThreads(),
+        workerThreadsStartFlag(),
+        areWorkerThreadsStarted(false),
+        loopJobQueues(),
+        taskQueues(),
+        threadTimings({}),
+        spreadTasksCount(0),
+        mainThreadTasks(),
+        overflowMainThreadTasks(),
+        overflowMainThreadTasksCount(0),
+        wakeGeneration(0),
+        isStopping(false),
+        runLoopFunction(nullptr),
+        loopFunction(nullptr),
+        pendingJobsCount(0)
+  {
+    // The manager is constructed by the static initialization, on the main thread.
+    currentThreadIndex = 0;
+  }
+
+  /**
+   * Start the worker threads if they are not started yet.
+   */
+  void startWorkerThreads()
+  {
+    // The threads using the workers first wait for the one starting them, so that they see the queues created.
+    std::call_once(workerThreadsStartFlag, [this]() {
+      areWorkerThreadsStarted.store(true, std::memory_order_relaxed);
+      for (uint32_t i = 0; i <= workerThreadsCount; i++)
+      {
+        loopJobQueues.push_back(std::make_unique<JobQueue<JobRange>>());
+        taskQueues.push_back(std::make_unique<JobQueue<std::shared_ptr<JobTask>>>());
+      }
+      threadTimings.resize(workerThreadsCount + 1);
+      for (uint32_t i = 1; i <= workerThreadsCount; i++)
+      {
+        workerThreads.emplace_back(&JobManager::runWorkerThread, this, i);
+      }
+    });
+  }
+
+  /**
+   * Wake the worker threads, since jobs were queued for them.
+   * 
+   * @param isWakingAll  Whether to wake all the worker threads, or just one of them.
+   */
+  void wakeWorkerThreads(const bool &isWakingAll)
+  {
+    if (workerThreads.empty())
+    {
+      return;
+    }
+    {
+      const std::lock_guard<std::mutex> lock(wakeMutex);
+      wakeGeneration++;
+    }
+    if (isWakingAll)
+    {
+      wakeCondition.notify_all();
+    }
+    else
+    {
+      wakeCondition.notify_one();
+    }
+  }
+
+  /**
+   * Run the loop of a worker thread, running the queued jobs whenever it is woken.
+   * 
+   * @param threadIndex  The index of the thread.
+   */
+  void runWorkerThread(const uint32_t threadIndex)
+  {
+    currentThreadIndex = threadIndex;
+    auto &threadSchedulingManager = ThreadSchedulingManager::getInstance();
+    threadSchedulingManager.applyToCurrentThread(ThreadRole::WORKER, threadIndex);
+    uint64_t lastWakeGeneration = 0;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this, &lastWakeGeneration]() { return isStopping || wakeGeneration != lastWakeGeneration; });
+        if (isStopping)
+        {
+          return;
+        }
+        lastWakeGeneration = wakeGeneration;
+      }
+
+      // Run the loop jobs first, since the main thread is waiting for them, and the tasks once there are none left.
+      while (runLoopJob(threadIndex) || runTask(threadIndex))
+      {
+      }
+      threadSchedulingManager.sampleCurrentThread();
+    }
+  }
+
+  /**
+   * Run a job of the current loop, queued for the given thread or stolen from the others.
+   * 
+   * @param threadIndex  The index of the thread.
+   * 
+   * @return Whether a job was run.
+   */
+  bool runLoopJob(const uint32_t &threadIndex)
+  {
+    if (pendingJobsCount.load(std::memory_order_acquire) == 0)
+    {
+      return false;
+    }
+
+    JobRange job;
+    auto isJobTaken = loopJobQueues[threadIndex]->pop(job);
+    for (size_t i = 1; !isJobTaken && i < loopJobQueues.size(); i++)
+    {
+      isJobTaken = loopJobQueues[(threadIndex + i) % loopJobQueues.size()]->steal(job);
+    }
+    if (!isJobTaken)
+    {
+      return false;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    runLoopFunction(loopFunction, job.begin, job.end);
+    const auto endTime = std::chrono::steady_clock::now();
+
+    // Record the timing before finishing the job, so that the timings are all written once the loop ends.
+    threadTimings[threadIndex].busyTime += std::chrono::duration<double_t>(endTime - startTime).count();
+    threadTimings[threadIndex].jobsCount++;
+    pendingJobsCount.fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Run a task queued for the given thread, or stolen from the others.
+   * 
+   * @param threadIndex  The index of the thread.
+   * 
+   * @return Whether a task was run.
+   */
+  bool runTask(const uint32_t &threadIndex)
+  {
+    if (taskQueues.empty())
+    {
+      return false;
+    }
+
+    // The external threads own no queue, so they only steal the tasks.
+    std::shared_ptr<JobTask> task;
+    const auto isExternalThread = threadIndex == EXTERNAL_THREAD_INDEX;
+    auto isTaskTaken = !isExternalThread && taskQueues[threadIndex]->pop(task);
+    for (size_t i = isExternalThread ? 0 : 1; !isTaskTaken && i < taskQueues.size(); i++)
+    {
+      isTaskTaken = taskQueues[((isExternalThread ? 0 : threadIndex) + i) % taskQueues.size()]->steal(task);
+    }
+    if (!isTaskTaken)
+    {
+      return false;
+    }
+
+    runAndFinishTask(task);
+    return true;
+  }
+
+  /**
+   * Run a task queued for the main thread.
+   * 
+   * @return Whether a task was run.
+   */
+  bool runMainThreadTask()
+  {
+    std::shared_ptr<JobTask> task;
+    if (!mainThreadTasks.tryPop(task))
+    {
+      if (overflowMainThreadTasksCount.load(std::memory_order_acquire) == 0)
+      {
+        return false;
+      }
+      const std::lock_guard<std::mutex> lock(overflowMainThreadTasksMutex);
+      if (overflowMainThreadTasks.empty())
+      {
+        return false;
+      }
+      task = std::move(overflowMainThreadTasks.front());
+      overflowMainThreadTasks.erase(overflowMainThreadTasks.begin());
+      overflowMainThreadTasksCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    runAndFinishTask(task);
+    return true;
+  }
+
+  /**
+   * Run the given task, mark it as finished, and queue the continuations it was the last dependency of.
+   * 
+   * @param task  The task to run.
+   */
+  void runAndFinishTask(const std::shared_ptr<JobTask> &task)
+  {
+    task->function();
+    // Release whatever the function holds on to as soon as it is done.
+    task->function = nullptr;
+
+    std::vector<std::shared_ptr<JobTask>> continuations;
+    {
+      const std::lock_guard<std::mutex> lock(task->continuationsMutex);
+      task->isTaskFinished.store(true, std::memory_order_release);
+      continuations.swap(task->continuations);
+    }
+    for (const auto &continuation : continuations)
+    {
+      releaseTaskDependency(continuation);
+    }
+  }
+
+  /**
+   * Release one of the dependencies of the given task, queuing the task once it has none left.
+   * 
+   * @param task  The task.
+   */
+  void releaseTaskDependency(const std::shared_ptr<JobTask> &task)
+  {
+    if (task->pendingDependenciesCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+      return;
+    }
+
+    // Run the tasks on the main thread when they have to, or when there is no worker thread to run them.
+    if (task->isMainThreadTask || workerThreads.empty())
+    {
+      auto queuedTask = task;
+      if (!mainThreadTasks.tryPush(queuedTask))
+      {
+        // The main thread fell behind, so queue the task behind the lock rather than waiting for it to catch up (which it never
+        //   does if it is the thread queuing the task).
+        const std::lock_guard<std::mutex> lock(overflowMainThreadTasksMutex);
+        overflowMainThreadTasks.push_back(std::move(queuedTask));
+        overflowMainThreadTasksCount.fetch_add(1, std::memory_order_release);
+      }
+      return;
+    }
+
+    // Keep the tasks queued by a worker thread on the same thread, and spread the ones queued by the main thread and the external
+    //   threads.
+    auto threadIndex = currentThreadIndex;
+    if (threadIndex == 0 || threadIndex == EXTERNAL_THREAD_INDEX)
+    {
+      threadIndex = spreadTasksCount.fetch_add(1, std::memory_order_relaxed) % workerThreadsCount + 1;
+    }
+    taskQueues[threadIndex]->push(task);
+    wakeWorkerThreads(false);
+  }
+
+  /**
+   * Create a task and submit it to run once the given tasks are finished.
+   * 
+   * @param function          The function of the task.
+   * @param dependencies      The tasks to wait for.
+   * @param isMainThreadTask  Whether the task has to run on the main thread.
+   * 
+   * @return The submitted task.
+   */
+  std::shared_ptr<JobTask> submitTask(std::function<void()> function, const std::vector<std::shared_ptr<JobTask>> &dependencies, const bool &isMainThreadTask)
+  {
+    startWorkerThreads();
+
+    const auto task = std::make_shared<JobTask>(std::move(function), isMainThreadTask);
+    // Hold an extra dependency while adding the task to its dependencies, so that it cannot start before all of them are added.
+    task->pendingDependenciesCount.store(static_cast<uint32_t>(dependencies.size()) + 1, std::memory_order_relaxed);
+    for (const auto &dependency : dependencies)
+    {
+      const std::lock_guard<std::mutex> lock(dependency->continuationsMutex);
+      if (dependency->isTaskFinished.load(std::memory_order_relaxed))
+      {
+        task->pendingDependenciesCount.fetch_sub(1, std::memory_order_relaxed);
+        continue;
+      }
+      dependency->continuations.push_back(task);
+    }
+    releaseTaskDependency(task);
+
+    return task;
+  }
+
+public:
+  // Preventing copying the job manager, making sure only one instance can exist.
+  JobManager(const JobManager &) = delete;
+
+  ~JobManager()
+  {
+    // Stop and wait for the worker threads.
+    {
+      const std::lock_guard<std::mutex> lock(wakeMutex);
+      isStopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto &workerThread : workerThreads)
+    {
+      workerThread.join();
+    }
+  }
+
+  /**
+   * Set the number of worker threads to start, instead of one for each hardware thread other than the main thread. Only has
+   *   an effect before the worker threads are started by their first use.
+   * 
+   * @param newWorkerThreadsCount  The number of worker threads, where 0 runs everything on the main thread.
+   */
+  void setWorkerThreadsCount(const uint32_t &newWorkerThreadsCount)
+  {
+    if (!areWorkerThreadsStarted.load(std::memory_order_relaxed))
+    {
+      workerThreadsCount = newWorkerThreadsCount;
+    }
+  }
+
+  /**
+   * Get the number of worker threads run alongside the main thread (started or not yet).
+   * 
+   * @return The number of worker threads.
+   */
+  uint32_t getWorkerThreadsCount() const
+  {
+    return workerThreadsCount;
+  }
+
+  /**
+   * Submit a task to run on a worker thread once the given tasks are finished.
+   * 
+   * @param function      The function of the task.
+   * @param dependencies  The tasks to wait for.
+   * 
+   * @return The submitted task, to wait for or to make other tasks depend on.
+   */
+  std::shared_ptr<JobTask> submitTask(std::function<void()> function, const std::vector<std::shared_ptr<JobTask>> &dependencies = {})
+  {
+    return submitTask(std::move(function), dependencies, false);
+  }
+
+  /**
+   * Submit a task to run on the main thread (e.g. since it makes GL calls) once the given tasks are finished. It runs in the
+   *   next runMainThreadTasks() after that, or while the main thread waits for a task.
+   * 
+   * @param function      The function of the task.
+   * @param dependencies  The tasks to wait for.
+   * 
+   * @return The submitted task, to wait for or to make other tasks depend on.
+   */
+  std::shared_ptr<JobTask> submitMainThreadTask(std::function<void()> function, const std::vector<std::shared_ptr<JobTask>> &dependencies = {})
+  {
+    return submitTask(std::move(function), dependencies, true);
+  }
+
+  /**
+   * Run the tasks queued for the main thread. Meant to be called on the main thread once per frame.
+   */
+  void runMainThreadTasks()
+  {
+    while (runMainThreadTask())
+    {
+    }
+  }
+
+  /**
+   * Run the tasks queued for the main thread until there are none left or the given time is used up, leaving the others for the
+   *   next call. At least one task is run if there is any, so that the queued tasks always make progress.
+   * 
+   * @param timeBudget  The time to run the tasks for (in seconds).
+   * 
+   * @return Whether all the queued tasks were run.
+   */
+  bool runMainThreadTasks(const double &timeBudget)
+  {
+    const auto endTime = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeBudget);
+    do
+    {
+      if (!runMainThreadTask())
+      {
+        return true;
+      }
+    } while (std::chrono::steady_clock::now() < endTime);
+    return false;
+  }
+
+  /**
+   * Wait for the given task to finish, running the other queued tasks in the meantime (including the ones queued for the main
+   *   thread, when called on it), so that waiting never blocks the work it waits for. Can be called from any thread.
+   * 
+   * @param task  The task to wait for.
+   */
+  void waitForTask(const std::shared_ptr<JobTask> &task)
+  {
+    while (!task->isFinished())
+    {
+      if ((currentThreadIndex == 0 && runMainThreadTask()) || runTask(currentThreadIndex))
+      {
+        continue;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Run the given function on all the items of a loop, split into ranges run in parallel by the worker threads and the calling
+   *   main thread, and wait for all of them to finish.
+   * 
+   * @param itemsCount    The number of items of the loop.
+   * @param itemsPerJob   The number of items run by each job, which the threads take and steal one at a time.
+   * @param function      The function run on each range of items, taking the index of the first item and the index after the
+   *                        last one. It is run on multiple threads at once, so it must only modify the items of the range.
+   */
+  template <typename F>
+  void parallelFor(const size_t &itemsCount, const size_t &itemsPerJob, const F &function)
+  {
+    if (itemsCount == 0)
+    {
+      return;
+    }
+    startWorkerThreads();
+
+    runLoopFunction = [](const void *loopFunction, const size_t &begin, const size_t &end) {
+      (*static_cast<const F *>(loopFunction))(begin, end);
+    };
+    loopFunction = &function;
+    for (auto &threadTiming : threadTimings)
+    {
+      threadTiming = {0.0, 0};
+    }
+
+    // Queue the jobs round-robin to the threads.
+    const auto jobItemsCount = std::max(itemsPerJob, static_cast<size_t>(1));
+    const auto jobsCount = (itemsCount + jobItemsCount - 1) / jobItemsCount;
+    pendingJobsCount.store(jobsCount, std::memory_order_release);
+    for (size_t i = 0; i < jobsCount; i++)
+    {
+      loopJobQueues[i % loopJobQueues.size()]->push({i * jobItemsCount, std::min((i + 1) * jobItemsCount, itemsCount)});
+    }
+
+    // Wake the worker threads, and help them with the jobs until they are all finished.
+    wakeWorkerThreads(true);
+    while (runLoopJob(0))
+    {
+    }
+    while (pendingJobsCount.load(std::memory_order_acquire) > 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Get the number of threads running the parallel loops, including the main thread.
+   * 
+   * @return The number of threads (0 until the first use starts them).
+   */
+  size_t getThreadsCount() const
+  {
+    return threadTimings.size();
+  }
+
+  /**
+   * Get the timing of the given thread in the last parallel loop.
+   * 
+   * @param threadIndex  The index of the thread, where the main thread is 0.
+   * 
+   * @return The timing of the thread.
+   */
+  const JobThreadTiming &getThreadTiming(const size_t &threadIndex) const
+  {
+    return threadTimings[threadIndex];
+  }
+
+  /**
+   * Returns the singleton instance of the job manager.
+   * 
+   * @return The job manager singleton instance.
+   */
+  static JobManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the job manager singleton instance static variable.
+JobManager JobManager::instance;
+
+/**
+ * Class for defining the result of a function run as a task on a worker thread, in place of std::async and std::future, so that
+ *   the loaders share the worker threads of the job manager instead of starting their own.
+ */
+template <typename R>
+class JobFuture
+{
+private:
+  // The result of the function, filled by the task.
+  std::shared_ptr<R> result;
+  // The task running the function.
+  std::shared_ptr<JobTask> task;
+
+public:
+  /**
+   * Run the given function as a task, on a worker thread or on the main thread (e.g. for the GL calls of the worker threads).
+   * 
+   * @param function          The function, returning the result.
+   * @param isMainThreadTask  Whether the function has to run on the main thread, in its next runMainThreadTasks().
+   */
+  template <typename F>
+  JobFuture(F function, const bool &isMainThreadTask = false)
+      : result(std::make_shared<R>())
+  {
+    const auto taskResult = result;
+    const auto taskFunction = [taskResult, function]() {
+      *taskResult = function();
+    };
+    auto &jobManager = JobManager::getInstance();
+    task = isMainThreadTask ? jobManager.submitMainThreadTask(taskFunction) : jobManager.submitTask(taskFunction);
+  }
+
+  /**
+   * Check whether the function finished, so that getting the result does not wait.
+   * 
+   * @return Whether the result is ready.
+   */
+  bool isReady() const
+  {
+    return task->isFinished();
+  }
+
+  /**
+   * Wait for the function to finish, running other tasks in the meantime.
+   */
+  void wait() const
+  {
+    JobManager::getInstance().waitForTask(task);
+  }
+
+  /**
+   * Wait for the function to finish, and take its result (so it can only be taken once).
+   * 
+   * @return The result of the function.
+   */
+  R get()
+  {
+    wait();
+    return std::move(*result);
+  }
+};
+
+#endif
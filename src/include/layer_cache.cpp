@@ -0,0 +1,220 @@
+#ifndef INCLUDE_LAYER_CACHE_CPP
+#define INCLUDE_LAYER_CACHE_CPP
+
+#include <memory>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Class for caching the lowest render layers of a mostly static scene (e.g. the background of the menus) in an offscreen target,
+ *   so that their models are only drawn again when the signature of what they are drawn with changes, and at most at the refresh
+ *   rate of the layer cache while it keeps changing (e.g. for slowly spinning models).
+ * The cached color and depth are composited into the scene with a fullscreen triangle every frame, before the other layers are
+ *   drawn over them, so that the closer cached models still hide the models drawn over them.
+ */
+class RenderLayerCache
+{
+private:
+  // The shader manager responsible for creating the composite shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the render target is accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program compositing the cached layers into the scene.
+  const std::shared_ptr<const ShaderDetails> compositeShaderDetails;
+  // The uniform IDs of the composite shader.
+  const GLuint layerColorTextureUniformId;
+  const GLuint layerDepthTextureUniformId;
+
+  // The framebuffer the cached layers are drawn into, with its color and depth textures.
+  GLuint layerFramebufferId;
+  GLuint layerColorTextureId;
+  GLuint layerDepthTextureId;
+  // The size the textures are allocated with (zero until the layers are first drawn).
+  glm::ivec2 layerSize;
+  // The empty vertex array object the fullscreen triangle is drawn with (its vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  // Whether the cached layers were drawn since the cache was last invalidated.
+  bool isCaptured;
+  // The signature the cached layers were last drawn with.
+  uint64_t capturedSignature;
+  // The time the cached layers were last drawn at (in seconds).
+  double captureTime;
+
+  /**
+   * Allocate the textures of the cached layers with the given size, accounting them in the GPU memory.
+   * 
+   * @param size  The size of the textures.
+   */
+  void allocateTextures(const glm::ivec2 &size)
+  {
+    layerSize = size;
+    GlCalls::bindTexture(GL_TEXTURE_2D, layerColorTextureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, layerDepthTextureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, size.x, size.y, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    const auto textureSize = GpuMemoryManager::getTextureSize(size.x, size.y, 1, 4, false);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, layerColorTextureId, GpuMemoryCategory::RENDER_TARGET, "Layer Cache", textureSize);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, layerDepthTextureId, GpuMemoryCategory::RENDER_TARGET, "Layer Cache", textureSize);
+  }
+
+  /**
+   * Create a texture with a single level, sampled without filtering.
+   * 
+   * @return The ID of the created texture (without storage).
+   */
+  static GLuint createTexture()
+  {
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+  }
+
+public:
+  RenderLayerCache()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        compositeShaderDetails(shaderManager.createShaderProgram("RenderLayerCache::Composite", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/layer_composite.glsl")),
+        layerColorTextureUniformId(shaderManager.getUniformId("layerColorTexture")),
+        layerDepthTextureUniformId(shaderManager.getUniformId("layerDepthTexture")),
+        layerFramebufferId(0),
+        layerColorTextureId(createTexture()),
+        layerDepthTextureId(createTexture()),
+        layerSize(0),
+        vertexArrayId(0),
+        isCaptured(false),
+        capturedSignature(0),
+        captureTime(0.0)
+  {
+    // Create the framebuffer, the storage of its textures being allocated once the size of the scene is known.
+    glGenFramebuffers(1, &layerFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, layerFramebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layerColorTextureId, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, layerDepthTextureId, 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~RenderLayerCache()
+  {
+    // Destroy the composite shader.
+    shaderManager.destroyShaderProgram(compositeShaderDetails);
+    // Delete the framebuffer and the textures of the cached layers.
+    GlCalls::deleteFramebuffers(1, &layerFramebufferId);
+    GlCalls::deleteTextures(1, &layerColorTextureId);
+    GlCalls::deleteTextures(1, &layerDepthTextureId);
+    gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, layerColorTextureId);
+    gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, layerDepthTextureId);
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+  }
+
+  // Preventing copying the layer cache, since it owns GPU resources.
+  RenderLayerCache(const RenderLayerCache &) = delete;
+
+  /**
+   * Check if the cached layers have to be drawn again, which is the case if they were never drawn, if the size of the scene
+   *   changed, or if their signature changed and they were not drawn within the refresh interval of the layer cache.
+   * 
+   * @param signature  The signature of what the cached layers are drawn with in the current frame.
+   * @param sceneSize  The size of the viewport the scene is rendered with.
+   * @param time       The current time (in seconds).
+   * 
+   * @return Whether the cached layers have to be drawn again.
+   */
+  bool isRefreshDue(const uint64_t &signature, const glm::ivec2 &sceneSize, const double &time) const
+  {
+    if (!isCaptured || sceneSize != layerSize)
+    {
+      return true;
+    }
+    return signature != capturedSignature && time - captureTime >= 1.0 / LAYER_CACHE_REFRESH_RATE;
+  }
+
+  /**
+   * Start drawing the cached layers, binding their framebuffer with the given viewport and clearing it.
+   * 
+   * @param sceneSize  The size of the viewport the scene is rendered with.
+   */
+  void beginCapture(const glm::ivec2 &sceneSize)
+  {
+    if (sceneSize != layerSize)
+    {
+      allocateTextures(sceneSize);
+    }
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, layerFramebufferId);
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  }
+
+  /**
+   * Finish drawing the cached layers, binding the scene framebuffer again with the given viewport.
+   * 
+   * @param signature           The signature of what the cached layers were drawn with.
+   * @param time                The current time (in seconds).
+   * @param sceneFramebufferId  The ID of the framebuffer the scene is rendered into (0 for the window).
+   * @param sceneSize           The size of the viewport the scene is rendered with.
+   */
+  void endCapture(const uint64_t &signature, const double &time, const GLuint &sceneFramebufferId, const glm::ivec2 &sceneSize)
+  {
+    isCaptured = true;
+    capturedSignature = signature;
+    captureTime = time;
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+  }
+
+  /**
+   * Draw the cached layers into the bound scene framebuffer with their depth, replacing what is there. The textures are bound to
+   *   the given texture unit and the one after it, and unbound once done.
+   * 
+   * @param textureUnit   The first texture unit to bind the textures of the cached layers to.
+   * @param isBlendingOn  Whether blending is enabled, so that it is enabled again after the composite.
+   */
+  void composite(const GLuint &textureUnit, const bool &isBlendingOn) const
+  {
+    GlCalls::disable(GL_BLEND);
+    GlCalls::depthFunc(GL_ALWAYS);
+    GlCalls::useProgram(compositeShaderDetails->getShaderId());
+    GlCalls::bindTextureUnit(textureUnit, GL_TEXTURE_2D, layerColorTextureId);
+    GlCalls::bindTextureUnit(textureUnit + 1, GL_TEXTURE_2D, layerDepthTextureId);
+    GlCalls::uniform1i(compositeShaderDetails->getUniformLocation(layerColorTextureUniformId), textureUnit);
+    GlCalls::uniform1i(compositeShaderDetails->getUniformLocation(layerDepthTextureUniformId), textureUnit + 1);
+
+    GlCalls::bindVertexArray(vertexArrayId);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+    GlCalls::bindVertexArray(0);
+
+    GlCalls::bindTextureUnit(textureUnit + 1, GL_TEXTURE_2D, 0);
+    GlCalls::bindTextureUnit(textureUnit, GL_TEXTURE_2D, 0);
+    GlCalls::depthFunc(GL_LESS);
+    if (isBlendingOn)
+    {
+      GlCalls::enable(GL_BLEND);
+    }
+  }
+
+  /**
+   * Forget the cached layers, so that they are drawn again the next time they are used (e.g. when a scene stops using them).
+   */
+  void invalidate()
+  {
+    isCaptured = false;
+  }
+};
+
+#endif
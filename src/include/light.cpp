@@ -2,13 +2,42 @@
 #define INCLUDE_LIGHT_CPP
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <memory_resource>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "constants.cpp"
 #include "text.cpp"
+#include "profiler.cpp"
+#include "registry.cpp"
+#include "frustum.cpp"
 #include "../light/light_base.cpp"
 
+/**
+ * Structure for defining a light shaded in a frame, standing for one or more registered lights merged by the light aggregation.
+ */
+struct LightAggregate
+{
+  // The most important light of the aggregate, which it is shaded as (with its type, planes and shadow buffer).
+  std::shared_ptr<LightBase> light;
+  // The position of the aggregate, the average of the positions of its lights weighted by their intensities.
+  glm::vec3 position;
+  // The color of the aggregate, the average of the colors of its lights weighted by their intensities.
+  glm::vec3 color;
+  // The intensity of the aggregate, the sum of the intensities of its lights.
+  float_t intensity;
+  // The range of the aggregate, the range of its summed intensity, limited to the largest of the far planes of its lights.
+  float_t farPlane;
+  // The largest of the far planes of the lights of the aggregate.
+  float_t maxFarPlane;
+  // The number of lights merged into the aggregate.
+  uint32_t lightsCount;
+};
+
 /**
  * A manager class for managing lights in a scene.
  */
@@ -20,15 +49,21 @@ private:
 
   // The text manager responsible for rendering text.
   TextManager &textManager;
+  // The CPU profiler the light updates are timed with.
+  CpuProfiler &cpuProfiler;
+
+  // The registered lights, in their registration order.
+  Registry<LightBase> registeredLights;
 
-  // The map of registered lights.
-  std::map<const std::string, std::shared_ptr<LightBase>> registeredLights;
-  std::vector<std::string> registeredLightsInsertionOrder;
+  // The registrations and de-registrations queued by the updates, applied in their order by the next applyQueuedCommands() (kept
+  //   around to avoid reallocating every frame).
+  std::vector<RegistryCommand<LightBase>> queuedCommands;
 
   LightManager()
       : textManager(TextManager::getInstance()),
-        registeredLights({}),
-        registeredLightsInsertionOrder({}) {}
+        cpuProfiler(CpuProfiler::getInstance()),
+        registeredLights(),
+        queuedCommands({}) {}
 
 public:
   // Preventing copying the light manager, making sure only one instance can exist.
@@ -38,155 +73,296 @@ public:
    * Register a new light into the light manager.
    * 
    * @param light  The light to register.
+   * 
+   * @return The handle of the light, to de-register and look it up with.
    */
-  void registerLight(const std::shared_ptr<LightBase> &&light)
+  RegistryHandle registerLight(const std::shared_ptr<LightBase> &&light)
   {
-    // Insert the light to the map of registered lights.
-    registeredLights.emplace(light->getLightId(), std::move(light));
-    registeredLightsInsertionOrder.push_back(light->getLightId());
+    // Add the light to the registered lights.
+    const auto lightHandle = registeredLights.add(light->getLightId(), light);
+    return lightHandle;
   }
 
   /**
    * De-register an existing light from the light manager.
    * 
-   * @param light  The ID of the light to de-register.
+   * @param lightHandle  The handle of the light to de-register.
    */
-  void deregisterLight(const std::string &lightId)
+  void deregisterLight(const RegistryHandle &lightHandle)
   {
-    // Check if light actually exists. If not, just return since it's not registered.
-    if (std::find(registeredLightsInsertionOrder.begin(), registeredLightsInsertionOrder.end(), lightId) == registeredLightsInsertionOrder.end())
+    // Check if light actually exists. If not, just return since it's not registered (anymore).
+    if (!registeredLights.contains(lightHandle))
     {
       return;
     }
 
-    // Get the light that is registered with the given light ID.
-    auto light = registeredLights[lightId];
-    // Remove the light from the map of registered lights.
-    deregisterLight(light);
+    // Remove the light from the registered lights.
+    registeredLights.remove(lightHandle);
   }
 
   /**
-   * De-register an existing light from the light manager.
+   * De-register an existing light from the light manager, looking it up by its ID (slower than by its handle).
+   * 
+   * @param lightId  The ID of the light to de-register.
+   */
+  void deregisterLight(const std::string &lightId)
+  {
+    deregisterLight(registeredLights.getHandle(lightId));
+  }
+
+  /**
+   * De-register an existing light from the light manager, looking it up by its ID (slower than by its handle).
    * 
    * @param light  The light to de-register.
    */
   void deregisterLight(const std::shared_ptr<LightBase> &light)
   {
-    // Remove the light from the map of registered lights.
-    registeredLights.erase(light->getLightId());
-    registeredLightsInsertionOrder.erase(std::remove(registeredLightsInsertionOrder.begin(), registeredLightsInsertionOrder.end(), light->getLightId()), registeredLightsInsertionOrder.end());
+    deregisterLight(registeredLights.getHandle(light->getLightId()));
   }
 
   /**
-   * Return the light registered with the given light ID.
+   * Return the light registered with the given handle.
    * 
-   * @param light  The ID of the light to return.
+   * @param lightHandle  The handle of the light to return.
    * 
-   * @return The light registered with the given light ID.
+   * @return The light registered with the given handle.
    */
-  const std::shared_ptr<LightBase> &getLight(const std::string &lightId) const
+  const std::shared_ptr<LightBase> &getLight(const RegistryHandle &lightHandle) const
   {
-    return registeredLights.at(lightId);
+    return registeredLights.get(lightHandle);
   }
 
   /**
-   * Return the list of all lights registered with the light manager.
+   * Queue the registration of a light, to be applied by the next applyQueuedCommands(). Meant for the lights added while the
+   *   models or lights are updated.
    * 
-   * @return The list of all registered lights.
+   * @param light  The light to register.
    */
-  const std::vector<std::shared_ptr<LightBase>> getAllLights() const
+  void queueRegisterLight(const std::shared_ptr<LightBase> &light)
   {
-    // Define a vector to store the list of registered lights.
-    std::vector<std::shared_ptr<LightBase>> lights({});
-    // Iterate through the map of registered lights.
-    for (const auto &lightId : registeredLightsInsertionOrder)
-    {
-      // Push each registered model into the models list.
-      lights.push_back(registeredLights.find(lightId)->second);
-    }
-    // Return the list of registered lights.
-    return lights;
+    queuedCommands.push_back({RegistryCommandType::REGISTER_REGISTRY_COMMAND, light});
   }
 
   /**
-   * Run the initialize operation on all the registered lights.
+   * Queue the de-registration of a light, to be applied by the next applyQueuedCommands(). Meant for the lights removed while
+   *   the models or lights are updated, which stay registered until then.
+   * 
+   * @param light  The light to de-register.
    */
-  void initAllLights()
+  void queueDeregisterLight(const std::shared_ptr<LightBase> &light)
+  {
+    queuedCommands.push_back({RegistryCommandType::DEREGISTER_REGISTRY_COMMAND, light});
+  }
+
+  /**
+   * Apply the queued registrations and de-registrations in one batch, in the order they were queued. Meant to be run once
+   *   per frame, after the updates, while nothing iterates the lights.
+   */
+  void applyQueuedCommands()
   {
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    for (auto &queuedCommand : queuedCommands)
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
+      switch (queuedCommand.type)
       {
-        result->second->init();
+      case RegistryCommandType::REGISTER_REGISTRY_COMMAND:
+        registerLight(std::move(queuedCommand.entry));
+        break;
+      case RegistryCommandType::DEREGISTER_REGISTRY_COMMAND:
+        deregisterLight(queuedCommand.entry);
+        break;
       }
     }
+    queuedCommands.clear();
   }
 
   /**
-   * Run the de-initialize operation on all the registered lights.
+   * Return the light registered with the given ID, for debugging (slower than by its handle).
+   * 
+   * @param lightId  The ID of the light to return.
+   * 
+   * @return The light registered with the given ID.
    */
-  void deinitAllLights()
+  const std::shared_ptr<LightBase> &getLight(const std::string &lightId) const
+  {
+    return registeredLights.get(lightId);
+  }
+
+  /**
+   * Return a view over all the lights registered with the light manager, in their registration order. Lights can be registered
+   *   and de-registered while iterating it, but the registered ones are only visited by later iterations.
+   * 
+   * @return The view over the registered lights.
+   */
+  Registry<LightBase>::View getAllLights() const
+  {
+    return registeredLights.getView();
+  }
+
+  /**
+   * Return the registered lights that can light the view, ranked by their estimated contribution to it, which is their intensity
+   *   falling off with their distance outside the view frustum and their distance to the camera (relative to their range).
+   * Lights whose range does not reach the view frustum are left out, since they cannot light anything visible.
+   * 
+   * @param viewFrustum     The view frustum of the camera.
+   * @param cameraPosition  The position of the camera.
+   * 
+   * @return The list of the lights reaching the view, from the most important to the least important.
+   */
+  std::vector<std::shared_ptr<LightBase>> getRankedLights(const Frustum &viewFrustum, const glm::vec3 &cameraPosition) const
   {
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    // Estimate the contribution of each light reaching the view.
+    std::vector<std::pair<float_t, std::shared_ptr<LightBase>>> lightImportances;
+    for (const auto &light : registeredLights.getView())
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
+      const auto frustumDistance = viewFrustum.getDistance(light->getLightPosition());
+      const auto lightRange = light->getLightRange();
+      if (frustumDistance > lightRange)
       {
-        result->second->deinit();
+        continue;
       }
+      const auto cameraDistance = glm::distance(cameraPosition, light->getLightPosition()) / lightRange;
+      lightImportances.push_back({light->getLightIntensity() / ((1.0f + frustumDistance) * (1.0f + cameraDistance)), light});
     }
+
+    // Sort the lights by their importance, keeping the registration order of equally important lights.
+    std::stable_sort(lightImportances.begin(), lightImportances.end(), [](const auto &first, const auto &second) {
+      return first.first > second.first;
+    });
+    std::vector<std::shared_ptr<LightBase>> lights;
+    for (const auto &lightImportance : lightImportances)
+    {
+      lights.push_back(lightImportance.second);
+    }
+    return lights;
   }
 
   /**
-   * Run the update operation on all the registered lights.
+   * Merge the ranked lights casting no shadows that are close enough to each other (relative to their ranges) into single lights
+   *   of the same type, so that bursts of nearby lights (like the lights of continuous fire) are shaded as a few lights.
+   * Each aggregate is seeded by its most important light, and takes the less important lights within the aggregation range of
+   *   the seed, so that the aggregates do not drift along chains of lights. The lights casting shadows are never merged, since
+   *   each of them has its own shadowmap.
+   * 
+   * @param rankedLights  The lights reaching the view, from the most important to the least important.
+   * @param isAggregated  Whether to merge the lights, or to return each of them as an aggregate of its own.
+   * 
+   * @return The aggregates, in the order of the importance of their seeds.
    */
-  void updateAllLights()
+  static std::vector<LightAggregate> aggregateLights(const std::vector<std::shared_ptr<LightBase>> &rankedLights, const bool &isAggregated)
   {
-    auto lightNamesCount = std::map<const std::string, int>({});
-    auto lightNamesProcessTime = std::map<const std::string, double>({});
-
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    std::vector<LightAggregate> aggregates;
+    aggregates.reserve(rankedLights.size());
+    // The sums of the positions and colors weighted by the intensities of the lights of each aggregate, and the indices of the
+    //   aggregates that can take more lights.
+    std::vector<std::pair<glm::vec3, glm::vec3>> weightedSums;
+    std::vector<size_t> mergeableIndices;
+    for (const auto &light : rankedLights)
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
+      const auto &position = light->getLightPosition();
+      const auto &intensity = light->getLightIntensity();
+      if (isAggregated && !light->isShadowCaster())
       {
-        if (lightNamesCount.find(result->second->getLightName()) != lightNamesCount.end())
+        // Find the first aggregate of the type whose seed is within range, which is the most important one.
+        auto isMerged = false;
+        for (const auto &aggregateIndex : mergeableIndices)
         {
-          lightNamesCount[result->second->getLightName()]++;
+          auto &aggregate = aggregates[aggregateIndex];
+          const auto aggregationRange = LIGHT_AGGREGATION_RANGE_RATIO * std::min(aggregate.light->getLightRange(), light->getLightRange());
+          if (aggregate.light->getLightType() != light->getLightType() || glm::distance(aggregate.light->getLightPosition(), position) > aggregationRange)
+          {
+            continue;
+          }
+          weightedSums[aggregateIndex].first += position * intensity;
+          weightedSums[aggregateIndex].second += light->getLightColor() * intensity;
+          aggregate.intensity += intensity;
+          aggregate.maxFarPlane = std::max(aggregate.maxFarPlane, light->getLightFarPlane());
+          aggregate.lightsCount++;
+          isMerged = true;
+          break;
         }
-        else
+        if (isMerged)
         {
-          lightNamesCount[result->second->getLightName()] = 1;
-          lightNamesProcessTime[result->second->getLightName()] = 0.0f;
+          continue;
         }
+        mergeableIndices.push_back(aggregates.size());
+      }
+      aggregates.push_back({light, position, light->getLightColor(), intensity, light->getLightRange(), light->getLightFarPlane(), 1});
+      weightedSums.push_back({position * intensity, light->getLightColor() * intensity});
+    }
 
-        // If it does, tell the light to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        result->second->update();
-        const auto endTime = glfwGetTime();
-        lightNamesProcessTime[result->second->getLightName()] += (endTime - startTime) * 1000;
+    // Average the positions and colors of the aggregates that took more lights, by the intensities of their lights, and find the
+    //   range of their summed intensity.
+    for (const auto &aggregateIndex : mergeableIndices)
+    {
+      auto &aggregate = aggregates[aggregateIndex];
+      if (aggregate.lightsCount > 1 && aggregate.intensity > 0.0f)
+      {
+        aggregate.position = weightedSums[aggregateIndex].first / aggregate.intensity;
+        aggregate.color = weightedSums[aggregateIndex].second / aggregate.intensity;
+        aggregate.farPlane = std::max(aggregate.farPlane, LightBase::getInfluenceRange(aggregate.color, aggregate.intensity, aggregate.maxFarPlane));
       }
     }
+    return aggregates;
+  }
 
-    auto height = 15.0f;
-    for (const auto &lightCounts : lightNamesCount)
+  /**
+   * Run the initialize operation on all the registered lights.
+   */
+  void initAllLights()
+  {
+    // Iterate through the registered lights.
+    for (const auto &light : registeredLights.getView())
     {
-      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Light Object Instances: " + std::to_string(lightCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+      light->init();
+    }
+  }
+
+  /**
+   * Run the de-initialize operation on all the registered lights.
+   */
+  void deinitAllLights()
+  {
+    // Iterate through the registered lights.
+    for (const auto &light : registeredLights.getView())
+    {
+      light->deinit();
+    }
+  }
+
+  /**
+   * Run the update operation on all the registered lights.
+   */
+  void updateAllLights()
+  {
+    PROFILE_ZONE("Light Update");
+
+    // Write the light updates of the last frame, from the zone of each light name.
+    auto height = 15.0f;
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this, &height](const std::string &lightName, const ProfilerZoneStats &lightStats) {
+      textManager.beginText(glm::vec2(1, height), 0.5f) << lightName << " Light Object Instances: " << lightStats.itemsCount << " | Update (avg): " << lightStats.getAverageTimeMs() << "ms";
       height -= 0.5f;
+    });
+
+    // Iterate through the registered lights.
+    for (const auto &light : registeredLights.getView())
+    {
+      // Tell the light to perform an update on itself, in the zone of its name (entered before the entry of the light is
+      //   cleared, if it de-registers itself while updating).
+      PROFILE_ZONE(light->getLightName());
+      light->update();
     }
   }
 
+  /**
+   * Switch the memory resource the registered lights are kept in, e.g. to the arena of the scene. Must not be called while the lights are iterated.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    registeredLights.setMemoryResource(memoryResource);
+  }
+
   /**
    * Returns the singleton instance of the light manager.
    * 
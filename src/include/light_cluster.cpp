@@ -0,0 +1,383 @@
+#ifndef INCLUDE_LIGHT_CLUSTER_CPP
+#define INCLUDE_LIGHT_CLUSTER_CPP
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Structure for defining the details of a single light binned into the light cluster grid.
+ */
+struct ClusterLightData
+{
+  // The position of the light in world-space.
+  glm::vec3 lightPosition;
+  // The product of the color and intensity of the light.
+  glm::vec3 lightColorIntensity;
+  // The farthest distance till which the shadowmap captures objects.
+  float_t farPlane;
+  // The index of the shadowmap of the light in the shadowmap texture array (-1 if the light has no shadowmap).
+  int32_t layerId;
+};
+
+/**
+ * Class for binning lights into a grid of view-space clusters (tiles of the screen split into depth slices),
+ *   so that each fragment only loops over the lights that can reach the cluster it is in.
+ * The grid is written into buffer textures, since shader storage buffers are not available in OpenGL 3.3.
+ */
+class LightClusterGrid
+{
+public:
+  // The number of clusters along the width of the screen.
+  const static int32_t CLUSTER_COUNT_X;
+  // The number of clusters along the height of the screen.
+  const static int32_t CLUSTER_COUNT_Y;
+  // The number of clusters along the depth of the view.
+  const static int32_t CLUSTER_COUNT_Z;
+
+private:
+  // The number of texels each light takes up in the light details buffer texture.
+  const static uint32_t TEXELS_PER_LIGHT;
+
+  // The ID of the buffer containing the details of the binned lights.
+  const GLuint lightBufferId;
+  // The ID of the buffer texture reading the details of the binned lights (RGBA32F).
+  const GLuint lightTextureId;
+  // The ID of the buffer containing the offset and count of the light indices of each cluster.
+  const GLuint clusterBufferId;
+  // The ID of the buffer texture reading the offset and count of the light indices of each cluster (RG32UI).
+  const GLuint clusterTextureId;
+  // The ID of the buffer containing the light indices of all the clusters.
+  const GLuint lightIndexBufferId;
+  // The ID of the buffer texture reading the light indices of all the clusters (R32UI).
+  const GLuint lightIndexTextureId;
+
+  // The details of the binned lights (kept around to avoid reallocating every frame).
+  std::vector<glm::vec4> lightTexels;
+  // The offset and count of the light indices of each cluster (kept around to avoid reallocating every frame).
+  std::vector<glm::uvec2> clusterTexels;
+  // The light indices of all the clusters (kept around to avoid reallocating every frame).
+  std::vector<uint32_t> lightIndices;
+  // The first and last cluster reached by each binned light (kept around to avoid reallocating every frame).
+  std::vector<std::array<glm::ivec3, 2>> lightClusterRanges;
+
+  // The scale and bias converting the log of the view depth to a depth slice, followed by the size of a cluster tile in pixels.
+  glm::vec4 clusterDepthDetails;
+
+  /**
+   * Create a buffer, and a buffer texture reading it with the given format.
+   * 
+   * @param bufferId  The ID of the buffer to read.
+   * @param format    The internal format of the texels of the buffer texture.
+   * 
+   * @return The ID of the created buffer texture.
+   */
+  static GLuint createBufferTexture(const GLuint &bufferId, const GLenum &format)
+  {
+    // Allocate the buffer with a single empty texel, since it will be rewritten every frame.
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId);
+    GlCalls::bufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "Light Clusters", sizeof(glm::vec4));
+
+    // Define a variable for storing the texture ID.
+    GLuint textureId;
+    // Create a new texture, and attach the buffer to it.
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_BUFFER, textureId);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, bufferId);
+
+    // Unbind the texture and buffer now that we're done.
+    GlCalls::bindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // Return the ID of the created texture.
+    return textureId;
+  }
+
+  /**
+   * Create a new buffer.
+   * 
+   * @return The ID of the created buffer.
+   */
+  static GLuint createBuffer()
+  {
+    GLuint bufferId;
+    glGenBuffers(1, &bufferId);
+    return bufferId;
+  }
+
+  /**
+   * Write the given data into the given buffer, replacing its storage.
+   * 
+   * @param bufferId  The ID of the buffer.
+   * @param data      The data to write.
+   * @param dataSize  The size of the data in bytes.
+   */
+  static void writeBuffer(const GLuint &bufferId, const void *data, const GLsizeiptr &dataSize)
+  {
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferId);
+    // Orphan the old storage so that the GPU can keep reading it while the new data is written,
+    //   keeping at least a single texel so that the buffer texture is never empty.
+    if (dataSize > 0)
+    {
+      GlCalls::bufferData(GL_TEXTURE_BUFFER, dataSize, data, GL_STREAM_DRAW);
+    }
+    else
+    {
+      GlCalls::bufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "Light Clusters", std::max<GLsizeiptr>(dataSize, sizeof(glm::vec4)));
+  }
+
+  /**
+   * Get the depth slice of the given view depth.
+   * 
+   * @param viewDepth  The distance from the camera along the view direction.
+   * 
+   * @return The index of the depth slice, clamped to the grid.
+   */
+  int32_t getDepthSlice(const float_t &viewDepth) const
+  {
+    const auto slice = static_cast<int32_t>(std::floor((std::log(viewDepth) * clusterDepthDetails.x) + clusterDepthDetails.y));
+    return std::clamp(slice, 0, CLUSTER_COUNT_Z - 1);
+  }
+
+  /**
+   * Get the cluster tile of the given normalized device coordinate.
+   * 
+   * @param ndcCoord      The normalized device coordinate, between -1 and 1.
+   * @param clusterCount  The number of clusters along the axis of the coordinate.
+   * 
+   * @return The index of the tile, clamped to the grid.
+   */
+  static int32_t getTile(const float_t &ndcCoord, const int32_t &clusterCount)
+  {
+    const auto tile = static_cast<int32_t>(std::floor(((ndcCoord * 0.5f) + 0.5f) * clusterCount));
+    return std::clamp(tile, 0, clusterCount - 1);
+  }
+
+  /**
+   * Get the index of the given cluster in the grid.
+   * 
+   * @param cluster  The coordinates of the cluster in the grid.
+   * 
+   * @return The index of the cluster.
+   */
+  static uint32_t getClusterIndex(const glm::ivec3 &cluster)
+  {
+    return cluster.x + (CLUSTER_COUNT_X * (cluster.y + (CLUSTER_COUNT_Y * cluster.z)));
+  }
+
+public:
+  LightClusterGrid()
+      : lightBufferId(createBuffer()),
+        lightTextureId(createBufferTexture(lightBufferId, GL_RGBA32F)),
+        clusterBufferId(createBuffer()),
+        clusterTextureId(createBufferTexture(clusterBufferId, GL_RG32UI)),
+        lightIndexBufferId(createBuffer()),
+        lightIndexTextureId(createBufferTexture(lightIndexBufferId, GL_R32UI)),
+        lightTexels({}),
+        clusterTexels({}),
+        lightIndices({}),
+        lightClusterRanges({}),
+        clusterDepthDetails(0.0f) {}
+
+  ~LightClusterGrid()
+  {
+    // Delete the buffer textures and their buffers.
+    GlCalls::deleteTextures(1, &lightTextureId);
+    GlCalls::deleteTextures(1, &clusterTextureId);
+    GlCalls::deleteTextures(1, &lightIndexTextureId);
+    glDeleteBuffers(1, &lightBufferId);
+    glDeleteBuffers(1, &clusterBufferId);
+    glDeleteBuffers(1, &lightIndexBufferId);
+    auto &gpuMemoryManager = GpuMemoryManager::getInstance();
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, lightBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, clusterBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, lightIndexBufferId);
+  }
+
+  // Preventing copying the light cluster grid, since it owns GPU buffers.
+  LightClusterGrid(const LightClusterGrid &) = delete;
+
+  /**
+   * Bin the given lights into the clusters of the view of the given camera matrices, and write the grid to the buffer textures.
+   * 
+   * @param lights            The lights to bin.
+   * @param viewMatrix        The view matrix of the camera.
+   * @param projectionMatrix  The projection matrix of the camera.
+   */
+  void update(const std::vector<ClusterLightData> &lights, const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix)
+  {
+    // Find the near and far planes of the camera by unprojecting the near and far planes of the normalized device coordinates.
+    const auto inverseProjectionMatrix = glm::inverse(projectionMatrix);
+    const auto nearPoint = inverseProjectionMatrix * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+    const auto farPoint = inverseProjectionMatrix * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    const auto nearDepth = -nearPoint.z / nearPoint.w;
+    const auto farDepth = -farPoint.z / farPoint.w;
+
+    // Split the depth range into exponentially growing slices, so that the clusters keep roughly the same shape with distance.
+    const auto sliceScale = CLUSTER_COUNT_Z / std::log(farDepth / nearDepth);
+    clusterDepthDetails = glm::vec4(sliceScale,
+                                    -std::log(nearDepth) * sliceScale,
+                                    static_cast<float_t>(VIEWPORT_WIDTH) / CLUSTER_COUNT_X,
+                                    static_cast<float_t>(VIEWPORT_HEIGHT) / CLUSTER_COUNT_Y);
+
+    lightTexels.clear();
+    lightTexels.reserve(lights.size() * TEXELS_PER_LIGHT);
+    lightClusterRanges.clear();
+    clusterTexels.assign(CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z, glm::uvec2(0));
+
+    // Iterate through the lights, finding the clusters each of them reaches.
+    for (const auto &light : lights)
+    {
+      // The far plane of the light is already the distance past which it contributes less than the influence cutoff.
+      const auto radius = light.farPlane;
+      const auto lightPosition_viewSpace = glm::vec3(viewMatrix * glm::vec4(light.lightPosition, 1.0f));
+
+      // Skip the light if its sphere of influence is fully in front of the near plane or behind the far plane.
+      const auto closestDepth = -lightPosition_viewSpace.z - radius;
+      const auto farthestDepth = -lightPosition_viewSpace.z + radius;
+      if (farthestDepth < nearDepth || closestDepth > farDepth)
+      {
+        continue;
+      }
+
+      // Project the corners of the box around the sphere of influence to find the screen area it covers.
+      // Corners behind the near plane are moved onto it, which only makes the area larger.
+      auto ndcMin = glm::vec2(1.0f), ndcMax = glm::vec2(-1.0f);
+      for (auto corner = 0; corner < 8; corner++)
+      {
+        auto cornerPosition = lightPosition_viewSpace + (radius * glm::vec3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f));
+        cornerPosition.z = std::min(cornerPosition.z, -nearDepth);
+        const auto cornerPosition_clipSpace = projectionMatrix * glm::vec4(cornerPosition, 1.0f);
+        const auto cornerPosition_ndc = glm::vec2(cornerPosition_clipSpace) / cornerPosition_clipSpace.w;
+        ndcMin = glm::min(ndcMin, cornerPosition_ndc);
+        ndcMax = glm::max(ndcMax, cornerPosition_ndc);
+      }
+
+      // Skip the light if the area it covers is fully off the screen.
+      if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+      {
+        continue;
+      }
+
+      // Store the range of clusters the light reaches.
+      const auto firstCluster = glm::ivec3(getTile(ndcMin.x, CLUSTER_COUNT_X), getTile(ndcMin.y, CLUSTER_COUNT_Y), getDepthSlice(std::max(closestDepth, nearDepth)));
+      const auto lastCluster = glm::ivec3(getTile(ndcMax.x, CLUSTER_COUNT_X), getTile(ndcMax.y, CLUSTER_COUNT_Y), getDepthSlice(farthestDepth));
+      lightClusterRanges.push_back({firstCluster, lastCluster});
+
+      // Store the details of the light (view-space position and radius, color and far plane, world-space position and shadowmap layer).
+      lightTexels.push_back(glm::vec4(lightPosition_viewSpace, radius));
+      lightTexels.push_back(glm::vec4(light.lightColorIntensity, light.farPlane));
+      lightTexels.push_back(glm::vec4(light.lightPosition, static_cast<float_t>(light.layerId)));
+
+      // Count the light in each of the clusters it reaches.
+      for (auto z = firstCluster.z; z <= lastCluster.z; z++)
+      {
+        for (auto y = firstCluster.y; y <= lastCluster.y; y++)
+        {
+          for (auto x = firstCluster.x; x <= lastCluster.x; x++)
+          {
+            clusterTexels[getClusterIndex(glm::ivec3(x, y, z))].y++;
+          }
+        }
+      }
+    }
+
+    // Convert the counts into the offset of the first light index of each cluster, resetting the counts to fill them again.
+    uint32_t offset = 0;
+    for (auto &clusterTexel : clusterTexels)
+    {
+      clusterTexel.x = offset;
+      offset += clusterTexel.y;
+      clusterTexel.y = 0;
+    }
+
+    // Write the index of each light into the clusters it reaches.
+    lightIndices.resize(offset);
+    for (uint32_t i = 0; i < lightClusterRanges.size(); i++)
+    {
+      const auto &firstCluster = lightClusterRanges[i][0];
+      const auto &lastCluster = lightClusterRanges[i][1];
+      for (auto z = firstCluster.z; z <= lastCluster.z; z++)
+      {
+        for (auto y = firstCluster.y; y <= lastCluster.y; y++)
+        {
+          for (auto x = firstCluster.x; x <= lastCluster.x; x++)
+          {
+            auto &clusterTexel = clusterTexels[getClusterIndex(glm::ivec3(x, y, z))];
+            lightIndices[clusterTexel.x + clusterTexel.y++] = i;
+          }
+        }
+      }
+    }
+
+    // Write the grid to the buffers read by the buffer textures.
+    writeBuffer(lightBufferId, lightTexels.data(), lightTexels.size() * sizeof(glm::vec4));
+    writeBuffer(clusterBufferId, clusterTexels.data(), clusterTexels.size() * sizeof(glm::uvec2));
+    writeBuffer(lightIndexBufferId, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+  }
+
+  /**
+   * Bind the buffer textures of the grid to consecutive texture units (light details, clusters, then light indices).
+   * 
+   * @param firstTextureUnit  The index of the texture unit to bind the light details to.
+   */
+  void bindTextures(const GLuint &firstTextureUnit) const
+  {
+    GlCalls::bindTextureUnit(firstTextureUnit, GL_TEXTURE_BUFFER, lightTextureId);
+    GlCalls::bindTextureUnit(firstTextureUnit + 1, GL_TEXTURE_BUFFER, clusterTextureId);
+    GlCalls::bindTextureUnit(firstTextureUnit + 2, GL_TEXTURE_BUFFER, lightIndexTextureId);
+  }
+
+  /**
+   * Get the scale and bias converting the log of the view depth to a depth slice, followed by the size of a cluster tile in pixels.
+   * 
+   * @return The depth details of the grid.
+   */
+  const glm::vec4 &getClusterDepthDetails() const
+  {
+    return clusterDepthDetails;
+  }
+
+  /**
+   * Get the number of lights binned into the grid in the last update.
+   * 
+   * @return The number of binned lights.
+   */
+  uint32_t getLightsCount() const
+  {
+    return lightClusterRanges.size();
+  }
+
+  /**
+   * Get the number of light indices written into the clusters in the last update.
+   * 
+   * @return The number of light indices.
+   */
+  uint32_t getLightIndicesCount() const
+  {
+    return lightIndices.size();
+  }
+};
+
+// Initialize the number of clusters along the width of the screen static variable.
+const int32_t LightClusterGrid::CLUSTER_COUNT_X = 16;
+// Initialize the number of clusters along the height of the screen static variable.
+const int32_t LightClusterGrid::CLUSTER_COUNT_Y = 9;
+// Initialize the number of clusters along the depth of the view static variable.
+const int32_t LightClusterGrid::CLUSTER_COUNT_Z = 24;
+// Initialize the number of texels of each light in the light details buffer texture static variable.
+const uint32_t LightClusterGrid::TEXELS_PER_LIGHT = 3;
+
+#endif
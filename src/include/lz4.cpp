@@ -0,0 +1,212 @@
+#ifndef INCLUDE_LZ4_CPP
+#define INCLUDE_LZ4_CPP
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+/**
+ * A class for compressing and decompressing data in the LZ4 block format, which decompresses at memory speed. Each block is a
+ *   sequence of tokens, each followed by its literal bytes and a match copying earlier bytes of the output, with the last one
+ *   only having literals.
+ */
+class Lz4
+{
+private:
+  // The shortest match that can be encoded.
+  static constexpr size_t MIN_MATCH = 4;
+  // The number of bytes at the end of a block that are always literals.
+  static constexpr size_t LAST_LITERALS = 5;
+  // The distance from the end of a block the last match must start at.
+  static constexpr size_t MATCH_SAFE_DISTANCE = 12;
+  // The furthest a match can copy the bytes from.
+  static constexpr size_t MAX_OFFSET = 65535;
+  // The number of bits of the hashes the positions of the earlier bytes are found by.
+  static constexpr uint32_t HASH_BITS = 16;
+
+  /**
+   * Write a length that does not fit the 4 bits of a token, as bytes of 255 followed by the rest.
+   * 
+   * @param length       The part of the length that did not fit the token.
+   * @param destination  The compressed bytes to write to.
+   */
+  static void writeLength(size_t length, std::vector<uint8_t> &destination)
+  {
+    for (; length >= 255; length -= 255)
+    {
+      destination.push_back(255);
+    }
+    destination.push_back(static_cast<uint8_t>(length));
+  }
+
+  /**
+   * Write a sequence of literal bytes, followed by a match (unless it is the last sequence).
+   * 
+   * @param literals       The literal bytes.
+   * @param literalsCount  The number of literal bytes.
+   * @param offset         The distance back the match copies the bytes from.
+   * @param matchLength    The length of the match (0 for the last sequence).
+   * @param destination    The compressed bytes to write to.
+   */
+  static void writeSequence(const uint8_t *literals, const size_t &literalsCount, const size_t &offset, const size_t &matchLength, std::vector<uint8_t> &destination)
+  {
+    const auto matchLengthCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    destination.push_back(static_cast<uint8_t>((std::min<size_t>(literalsCount, 15) << 4) | std::min<size_t>(matchLengthCode, 15)));
+    if (literalsCount >= 15)
+    {
+      writeLength(literalsCount - 15, destination);
+    }
+    destination.insert(destination.end(), literals, literals + literalsCount);
+    if (matchLength == 0)
+    {
+      return;
+    }
+    destination.push_back(static_cast<uint8_t>(offset & 0xFF));
+    destination.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchLengthCode >= 15)
+    {
+      writeLength(matchLengthCode - 15, destination);
+    }
+  }
+
+  /**
+   * Read 4 bytes as a number.
+   * 
+   * @param source  The bytes.
+   * 
+   * @return The number.
+   */
+  static uint32_t read32(const uint8_t *source)
+  {
+    uint32_t value;
+    memcpy(&value, source, sizeof(uint32_t));
+    return value;
+  }
+
+public:
+  /**
+   * Compress data into an LZ4 block, greedily taking the match found through a hash of the next 4 bytes at each position.
+   * 
+   * @param source      The data.
+   * @param sourceSize  The size of the data in bytes.
+   * 
+   * @return The compressed block.
+   */
+  static std::vector<uint8_t> compress(const uint8_t *source, const size_t &sourceSize)
+  {
+    std::vector<uint8_t> destination;
+    destination.reserve(sourceSize / 2);
+    auto positions = std::vector<uint32_t>(static_cast<size_t>(1) << HASH_BITS, UINT32_MAX);
+    size_t anchor = 0;
+    size_t position = 0;
+    while (sourceSize >= MATCH_SAFE_DISTANCE + 1 && position <= sourceSize - MATCH_SAFE_DISTANCE)
+    {
+      // Look up the last position the next 4 bytes were seen at.
+      const auto sequence = read32(&source[position]);
+      const auto hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+      const auto candidate = positions[hash];
+      positions[hash] = static_cast<uint32_t>(position);
+      if (candidate == UINT32_MAX || position - candidate > MAX_OFFSET || read32(&source[candidate]) != sequence)
+      {
+        position++;
+        continue;
+      }
+
+      // Extend the match as far as it goes, keeping the last bytes as literals.
+      auto matchLength = MIN_MATCH;
+      const auto maxMatchLength = sourceSize - LAST_LITERALS - position;
+      while (matchLength < maxMatchLength && source[candidate + matchLength] == source[position + matchLength])
+      {
+        matchLength++;
+      }
+      writeSequence(&source[anchor], position - anchor, position - candidate, matchLength, destination);
+      position += matchLength;
+      anchor = position;
+    }
+    writeSequence(&source[anchor], sourceSize - anchor, 0, 0, destination);
+    return destination;
+  }
+
+  /**
+   * Decompress an LZ4 block, checking every length and offset so that a corrupted block is never read or written past its end.
+   * 
+   * @param source           The compressed block.
+   * @param sourceSize       The size of the compressed block in bytes.
+   * @param destination      The memory to decompress the data into.
+   * @param destinationSize  The size of the decompressed data in bytes.
+   * 
+   * @return Whether the block decompressed to exactly the given size.
+   */
+  static bool decompress(const uint8_t *source, const size_t &sourceSize, uint8_t *destination, const size_t &destinationSize)
+  {
+    size_t sourcePosition = 0;
+    size_t destinationPosition = 0;
+    while (sourcePosition < sourceSize)
+    {
+      // Copy the literals of the sequence.
+      const auto token = source[sourcePosition++];
+      size_t literalsCount = token >> 4;
+      if (literalsCount == 15)
+      {
+        uint8_t lengthByte;
+        do
+        {
+          if (sourcePosition >= sourceSize)
+          {
+            return false;
+          }
+          lengthByte = source[sourcePosition++];
+          literalsCount += lengthByte;
+        } while (lengthByte == 255);
+      }
+      if (literalsCount > sourceSize - sourcePosition || literalsCount > destinationSize - destinationPosition)
+      {
+        return false;
+      }
+      memcpy(&destination[destinationPosition], &source[sourcePosition], literalsCount);
+      sourcePosition += literalsCount;
+      destinationPosition += literalsCount;
+
+      // The last sequence has no match.
+      if (sourcePosition == sourceSize)
+      {
+        break;
+      }
+
+      // Copy the match byte by byte, since it can overlap the bytes it writes.
+      if (sourceSize - sourcePosition < 2)
+      {
+        return false;
+      }
+      const size_t offset = source[sourcePosition] | (source[sourcePosition + 1] << 8);
+      sourcePosition += 2;
+      size_t matchLength = token & 15;
+      if (matchLength == 15)
+      {
+        uint8_t lengthByte;
+        do
+        {
+          if (sourcePosition >= sourceSize)
+          {
+            return false;
+          }
+          lengthByte = source[sourcePosition++];
+          matchLength += lengthByte;
+        } while (lengthByte == 255);
+      }
+      matchLength += MIN_MATCH;
+      if (offset == 0 || offset > destinationPosition || matchLength > destinationSize - destinationPosition)
+      {
+        return false;
+      }
+      for (size_t i = 0; i < matchLength; i++, destinationPosition++)
+      {
+        destination[destinationPosition] = destination[destinationPosition - offset];
+      }
+    }
+    return destinationPosition == destinationSize;
+  }
+};
+
+#endif
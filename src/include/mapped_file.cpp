@@ -0,0 +1,163 @@
+#ifndef INCLUDE_MAPPED_FILE_CPP
+#define INCLUDE_MAPPED_FILE_CPP
+
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * Class for mapping a whole file into memory as read-only, so that its contents can be used without copying them.
+ * The file is unmapped when the instance is destroyed.
+ */
+class MappedFile
+{
+private:
+  // The pointer to the start of the mapped file contents (null if the file could not be mapped).
+  const uint8_t *data;
+  // The size of the file in bytes.
+  size_t size;
+
+#ifdef _WIN32
+  // The handle of the opened file.
+  HANDLE fileHandle;
+  // The handle of the file mapping object.
+  HANDLE mappingHandle;
+#endif
+
+public:
+  /**
+   * Map the file at the given path into memory. The file being missing, empty, or unreadable is not an error,
+   *   and is reported through isMapped instead.
+   * 
+   * @param filePath  The path of the file to map.
+   */
+  MappedFile(const std::string &filePath)
+      : data(nullptr),
+        size(0)
+  {
+#ifdef _WIN32
+    mappingHandle = NULL;
+    // Open the file for reading.
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+      return;
+    }
+
+    // Get the size of the file, since empty files cannot be mapped.
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+      return;
+    }
+
+    // Create a read-only mapping of the whole file, and map a view of it.
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL)
+    {
+      return;
+    }
+    data = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data != nullptr)
+    {
+      size = static_cast<size_t>(fileSize.QuadPart);
+    }
+#else
+    // Open the file for reading.
+    const auto fileDescriptor = open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+      return;
+    }
+
+    // Get the size of the file, since empty files cannot be mapped.
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+      // Map the whole file as read-only.
+      const auto mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+      if (mapping != MAP_FAILED)
+      {
+        data = static_cast<const uint8_t *>(mapping);
+        size = fileStat.st_size;
+      }
+    }
+
+    // The mapping stays valid after the file is closed.
+    close(fileDescriptor);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifdef _WIN32
+    // Unmap the view, and close the mapping and the file.
+    if (data != nullptr)
+    {
+      UnmapViewOfFile(data);
+    }
+    if (mappingHandle != NULL)
+    {
+      CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(fileHandle);
+    }
+#else
+    // Unmap the file contents.
+    if (data != nullptr)
+    {
+      munmap(const_cast<uint8_t *>(data), size);
+    }
+#endif
+  }
+
+  // Preventing copying the mapped file, since the mapping can only be released once.
+  MappedFile(const MappedFile &) = delete;
+
+  /**
+   * Check if the file was mapped successfully.
+   * 
+   * @return Whether the file contents are available or not.
+   */
+  bool isMapped() const
+  {
+    return data != nullptr;
+  }
+
+  /**
+   * Get the mapped contents of the file.
+   * 
+   * @return The pointer to the start of the file contents.
+   */
+  const uint8_t *getData() const
+  {
+    return data;
+  }
+
+  /**
+   * Get the size of the mapped file.
+   * 
+   * @return The size of the file in bytes.
+   */
+  const size_t &getSize() const
+  {
+    return size;
+  }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef INCLUDE_MEMORY_RESOURCE_CPP
+#define INCLUDE_MEMORY_RESOURCE_CPP
+
+#include <new>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <memory_resource>
+
+/**
+ * A memory resource handing out memory from a monotonic arena guarded by a mutex, so that the managers filling their containers
+ *   from it can be called from the worker threads too. Nothing is freed until the whole arena is released at once.
+ */
+class SynchronizedMonotonicResource : public std::pmr::memory_resource
+{
+private:
+  // The mutex guarding the arena.
+  std::mutex mutex;
+  // The arena the memory is handed out from, getting its buffers from the heap.
+  std::pmr::monotonic_buffer_resource arena;
+  // The number of bytes handed out since the arena was last released.
+  size_t allocatedBytes;
+
+  void *do_allocate(size_t bytes, size_t alignment) override
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    allocatedBytes += bytes;
+    return arena.allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *, size_t, size_t) override
+  {
+    // The memory is only given back when the arena is released.
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+  {
+    return this == &other;
+  }
+
+public:
+  SynchronizedMonotonicResource(const size_t &initialSize)
+      : arena(initialSize, std::pmr::new_delete_resource()),
+        allocatedBytes(0) {}
+
+  /**
+   * Free all the memory handed out by the resource at once. Nothing allocated from it may be used afterwards.
+   */
+  void release()
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    arena.release();
+    allocatedBytes = 0;
+  }
+
+  /**
+   * Get the number of bytes handed out since the arena was last released.
+   * 
+   * @return The number of bytes.
+   */
+  size_t getAllocatedBytes()
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return allocatedBytes;
+  }
+};
+
+/**
+ * Move the elements of a polymorphic container into a container allocating from another memory resource, in place of the
+ *   original one. The allocators of the polymorphic containers are never replaced by assigning or swapping the containers, so
+ *   the container is rebuilt instead, leaving nothing of it in its former memory resource.
+ * 
+ * @param container       The container.
+ * @param memoryResource  The memory resource for the container to allocate from.
+ */
+template <typename C>
+void rebindMemoryResource(C &container, std::pmr::memory_resource *memoryResource)
+{
+  if (container.get_allocator().resource() == memoryResource)
+  {
+    return;
+  }
+  C reboundContainer(std::make_move_iterator(container.begin()), std::make_move_iterator(container.end()), memoryResource);
+  container.~C();
+  new (&container) C(std::move(reboundContainer));
+}
+
+#endif
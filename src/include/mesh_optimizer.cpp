@@ -0,0 +1,376 @@
+#ifndef INCLUDE_MESH_OPTIMIZER_CPP
+#define INCLUDE_MESH_OPTIMIZER_CPP
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+
+/**
+ * A class for reordering the triangles and the vertices of an indexed triangle mesh for drawing: the triangles for the hits of
+ *   the post-transform vertex cache (with Tipsify), then clusters of them for early depth rejection (drawing the clusters
+ *   facing outwards first), and the vertices in the order the triangles first use them for the vertex fetches.
+ */
+class MeshOptimizer
+{
+private:
+  // The value of the vertices not picked.
+  static constexpr uint32_t INVALID_VERTEX = UINT32_MAX;
+
+  /**
+   * Class for simulating a FIFO post-transform vertex cache, through the time when each vertex was last added to it.
+   */
+  class VertexCache
+  {
+  private:
+    // The time each vertex was last added to the cache.
+    std::vector<int64_t> vertexTimes;
+    // The number of vertices added to the cache so far.
+    int64_t time;
+
+  public:
+    VertexCache(const uint32_t &vertexCount)
+        : vertexTimes(vertexCount, -static_cast<int64_t>(MESH_OPTIMIZER_CACHE_SIZE)),
+          time(0) {}
+
+    /**
+     * Transform a vertex through the cache, adding it if it is not in it.
+     * 
+     * @param vertex  The vertex.
+     * 
+     * @return Whether the vertex missed the cache.
+     */
+    bool transform(const uint32_t &vertex)
+    {
+      if (time - vertexTimes[vertex] < MESH_OPTIMIZER_CACHE_SIZE)
+      {
+        return false;
+      }
+      vertexTimes[vertex] = time++;
+      return true;
+    }
+
+    /**
+     * Empty the cache, as if it was flushed between draws.
+     */
+    void flush()
+    {
+      time += MESH_OPTIMIZER_CACHE_SIZE;
+    }
+  };
+
+  /**
+   * Find the triangles around each vertex of the given triangles.
+   * 
+   * @param indices             The indices of the triangles.
+   * @param indexCount          The number of indices.
+   * @param vertexCount         The number of vertices the indices refer to.
+   * @param outTriangleOffsets  The output variable for the start of the triangles around each vertex (and the end of the last one).
+   * @param outVertexTriangles  The output variable for the triangles around the vertices.
+   */
+  static void findVertexTriangles(const uint32_t *indices, const size_t &indexCount, const uint32_t &vertexCount, std::vector<uint32_t> &outTriangleOffsets, std::vector<uint32_t> &outVertexTriangles)
+  {
+    outTriangleOffsets.assign(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      outTriangleOffsets[indices[i] + 1]++;
+    }
+    std::partial_sum(outTriangleOffsets.begin(), outTriangleOffsets.end(), outTriangleOffsets.begin());
+    outVertexTriangles.resize(indexCount);
+    auto nextOffsets = std::vector<uint32_t>(outTriangleOffsets.begin(), outTriangleOffsets.end() - 1);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      outVertexTriangles[nextOffsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  /**
+   * Reorder the triangles for the vertex cache with Tipsify, fanning out around a vertex kept in the cache at a time, and
+   *   record where the cache had to start over from a vertex out of it.
+   * 
+   * @param indices           The indices of the triangles, reordered in place.
+   * @param indexCount        The number of indices.
+   * @param vertexCount       The number of vertices the indices refer to.
+   * @param outClusterStarts  The output variable for the first triangle of each run fanned out without starting over.
+   */
+  static void optimizeVertexCache(uint32_t *indices, const size_t &indexCount, const uint32_t &vertexCount, std::vector<uint32_t> &outClusterStarts)
+  {
+    std::vector<uint32_t> triangleOffsets, vertexTriangles;
+    findVertexTriangles(indices, indexCount, vertexCount, triangleOffsets, vertexTriangles);
+
+    // The number of triangles left around each vertex, and the time each vertex was last added to the cache.
+    std::vector<uint32_t> liveCounts(vertexCount, 0);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+      liveCounts[i] = triangleOffsets[i + 1] - triangleOffsets[i];
+    }
+    std::vector<int64_t> cacheTimes(vertexCount, 0);
+    std::vector<bool> isEmitted(indexCount / 3, false);
+    std::vector<uint32_t> deadEnds, candidates, sortedIndices;
+    sortedIndices.reserve(indexCount);
+    auto time = static_cast<int64_t>(MESH_OPTIMIZER_CACHE_SIZE) + 1;
+    uint32_t scanCursor = 0;
+
+    outClusterStarts.assign(1, 0);
+    auto fanningVertex = indexCount > 0 ? indices[0] : INVALID_VERTEX;
+    while (fanningVertex != INVALID_VERTEX)
+    {
+      // Emit the triangles left around the fanning vertex.
+      candidates.clear();
+      for (auto i = triangleOffsets[fanningVertex]; i < triangleOffsets[fanningVertex + 1]; i++)
+      {
+        const auto triangle = vertexTriangles[i];
+        if (isEmitted[triangle])
+        {
+          continue;
+        }
+        for (uint32_t j = 0; j < 3; j++)
+        {
+          const auto vertex = indices[(triangle * 3) + j];
+          sortedIndices.push_back(vertex);
+          deadEnds.push_back(vertex);
+          candidates.push_back(vertex);
+          liveCounts[vertex]--;
+          if (time - cacheTimes[vertex] > MESH_OPTIMIZER_CACHE_SIZE)
+          {
+            cacheTimes[vertex] = time++;
+          }
+        }
+        isEmitted[triangle] = true;
+      }
+
+      // Fan out around the vertex of the triangles emitted that stays in the cache the longest while its triangles are emitted.
+      fanningVertex = INVALID_VERTEX;
+      int64_t bestPriority = -1;
+      for (const auto &vertex : candidates)
+      {
+        if (liveCounts[vertex] == 0)
+        {
+          continue;
+        }
+        int64_t priority = 0;
+        if (time - cacheTimes[vertex] + (2 * liveCounts[vertex]) <= MESH_OPTIMIZER_CACHE_SIZE)
+        {
+          priority = time - cacheTimes[vertex];
+        }
+        if (priority > bestPriority)
+        {
+          bestPriority = priority;
+          fanningVertex = vertex;
+        }
+      }
+      if (fanningVertex != INVALID_VERTEX)
+      {
+        continue;
+      }
+
+      // Otherwise, start over from the latest vertex emitted with triangles left, or the next one in the index order.
+      while (!deadEnds.empty() && fanningVertex == INVALID_VERTEX)
+      {
+        fanningVertex = liveCounts[deadEnds.back()] > 0 ? deadEnds.back() : INVALID_VERTEX;
+        deadEnds.pop_back();
+      }
+      for (; scanCursor < vertexCount && fanningVertex == INVALID_VERTEX; scanCursor++)
+      {
+        fanningVertex = liveCounts[scanCursor] > 0 ? scanCursor : INVALID_VERTEX;
+      }
+      if (fanningVertex != INVALID_VERTEX)
+      {
+        outClusterStarts.push_back(static_cast<uint32_t>(sortedIndices.size() / 3));
+      }
+    }
+    std::copy(sortedIndices.begin(), sortedIndices.end(), indices);
+  }
+
+  /**
+   * Split the runs of triangles found by the vertex cache reordering further, wherever the cache misses of the triangles so far
+   *   are close enough to the ones of the whole run, so that the clusters can be reordered without losing many cache hits.
+   * 
+   * @param indices        The indices of the triangles.
+   * @param indexCount     The number of indices.
+   * @param vertexCount    The number of vertices the indices refer to.
+   * @param clusterStarts  The first triangle of each run, replaced with the first triangle of each cluster.
+   */
+  static void splitClusters(const uint32_t *indices, const size_t &indexCount, const uint32_t &vertexCount, std::vector<uint32_t> &clusterStarts)
+  {
+    const auto triangleCount = static_cast<uint32_t>(indexCount / 3);
+    VertexCache cache(vertexCount);
+    std::vector<uint32_t> splitStarts;
+    for (size_t c = 0; c < clusterStarts.size(); c++)
+    {
+      const auto runStart = clusterStarts[c];
+      const auto runEnd = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+      cache.flush();
+      uint32_t runMisses = 0;
+      for (auto i = runStart * 3; i < runEnd * 3; i++)
+      {
+        runMisses += cache.transform(indices[i]) ? 1 : 0;
+      }
+      const auto runAcmr = static_cast<float_t>(runMisses) / (runEnd - runStart);
+
+      // Start a new cluster after each triangle bringing the misses of the cluster down to the ones of the run.
+      cache.flush();
+      auto clusterStart = runStart;
+      uint32_t clusterMisses = 0;
+      splitStarts.push_back(runStart);
+      for (auto t = runStart; t < runEnd; t++)
+      {
+        for (uint32_t j = 0; j < 3; j++)
+        {
+          clusterMisses += cache.transform(indices[(t * 3) + j]) ? 1 : 0;
+        }
+        const auto clusterTriangles = t + 1 - clusterStart;
+        if (t + 1 < runEnd && clusterMisses <= MESH_OVERDRAW_THRESHOLD * runAcmr * clusterTriangles)
+        {
+          clusterStart = t + 1;
+          clusterMisses = 0;
+          cache.flush();
+          splitStarts.push_back(clusterStart);
+        }
+      }
+    }
+    clusterStarts.swap(splitStarts);
+  }
+
+  /**
+   * Reorder the clusters of triangles so that the ones facing away from the center of the mesh are drawn first, since they are
+   *   the most likely to hide the others from any view.
+   * 
+   * @param indices        The indices of the triangles, reordered in place.
+   * @param indexCount     The number of indices.
+   * @param vertices       The positions of the vertices.
+   * @param clusterStarts  The first triangle of each cluster.
+   */
+  static void sortClusters(uint32_t *indices, const size_t &indexCount, const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &clusterStarts)
+  {
+    const auto triangleCount = static_cast<uint32_t>(indexCount / 3);
+    auto meshCenter = glm::dvec3(0.0);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      meshCenter += glm::dvec3(vertices[indices[i]]);
+    }
+    meshCenter /= std::max<size_t>(indexCount, 1);
+
+    // Find how far out along its area-weighted normal each cluster is.
+    std::vector<std::pair<double_t, uint32_t>> clusterKeys;
+    for (uint32_t c = 0; c < clusterStarts.size(); c++)
+    {
+      const auto clusterEnd = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+      auto clusterCenter = glm::dvec3(0.0), clusterNormal = glm::dvec3(0.0);
+      for (auto t = clusterStarts[c]; t < clusterEnd; t++)
+      {
+        const auto vertex1 = glm::dvec3(vertices[indices[t * 3]]), vertex2 = glm::dvec3(vertices[indices[(t * 3) + 1]]), vertex3 = glm::dvec3(vertices[indices[(t * 3) + 2]]);
+        clusterCenter += vertex1 + vertex2 + vertex3;
+        clusterNormal += glm::cross(vertex2 - vertex1, vertex3 - vertex1);
+      }
+      clusterCenter /= 3.0 * std::max<uint32_t>(clusterEnd - clusterStarts[c], 1);
+      const auto normalLength = glm::length(clusterNormal);
+      clusterKeys.push_back({normalLength > 0.0 ? glm::dot(clusterCenter - meshCenter, clusterNormal / normalLength) : 0.0, c});
+    }
+    std::stable_sort(clusterKeys.begin(), clusterKeys.end(), [](const std::pair<double_t, uint32_t> &first, const std::pair<double_t, uint32_t> &second) {
+      return first.first > second.first;
+    });
+
+    const auto unsortedIndices = std::vector<uint32_t>(indices, indices + indexCount);
+    size_t sortedIndexCount = 0;
+    for (const auto &clusterKey : clusterKeys)
+    {
+      const auto &c = clusterKey.second;
+      const auto clusterEnd = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+      sortedIndexCount = std::copy(unsortedIndices.begin() + (clusterStarts[c] * 3), unsortedIndices.begin() + (clusterEnd * 3), indices + sortedIndexCount) - indices;
+    }
+  }
+
+public:
+  /**
+   * Get the average cache miss ratio of the given triangles: the number of vertices transformed per triangle through a FIFO
+   *   post-transform cache, from 3 for no reuse down to about 0.5 for the best orders of regular meshes.
+   * 
+   * @param indices      The indices of the triangles.
+   * @param indexCount   The number of indices.
+   * @param vertexCount  The number of vertices the indices refer to.
+   * 
+   * @return The average cache miss ratio, 0 for no triangles.
+   */
+  static float_t getAcmr(const uint32_t *indices, const size_t &indexCount, const uint32_t &vertexCount)
+  {
+    if (indexCount < 3)
+    {
+      return 0.0f;
+    }
+    VertexCache cache(vertexCount);
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      misses += cache.transform(indices[i]) ? 1 : 0;
+    }
+    return static_cast<float_t>(misses) / (indexCount / 3);
+  }
+
+  /**
+   * Reorder the given triangles for the vertex cache, then reorder clusters of them for reducing the overdraw.
+   * 
+   * @param indices     The indices of the triangles, reordered in place.
+   * @param indexCount  The number of indices.
+   * @param vertices    The positions of the vertices.
+   */
+  static void optimizeTriangles(uint32_t *indices, const size_t &indexCount, const std::vector<glm::vec3> &vertices)
+  {
+    const auto vertexCount = static_cast<uint32_t>(vertices.size());
+    std::vector<uint32_t> clusterStarts;
+    optimizeVertexCache(indices, indexCount, vertexCount, clusterStarts);
+    splitClusters(indices, indexCount, vertexCount, clusterStarts);
+    sortClusters(indices, indexCount, vertices, clusterStarts);
+  }
+
+  /**
+   * Renumber the vertices in the order the given triangles first use them, so that the vertex fetches move forward through
+   *   the vertex buffers.
+   * 
+   * @param indices      The indices of the triangles, renumbered in place.
+   * @param vertexCount  The number of vertices the indices refer to.
+   * 
+   * @return The new number of each vertex, the unused vertices numbered after the used ones.
+   */
+  static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t> &indices, const uint32_t &vertexCount)
+  {
+    std::vector<uint32_t> vertexRemap(vertexCount, INVALID_VERTEX);
+    uint32_t nextVertex = 0;
+    for (auto &index : indices)
+    {
+      if (vertexRemap[index] == INVALID_VERTEX)
+      {
+        vertexRemap[index] = nextVertex++;
+      }
+      index = vertexRemap[index];
+    }
+    for (auto &newVertex : vertexRemap)
+    {
+      newVertex = newVertex == INVALID_VERTEX ? nextVertex++ : newVertex;
+    }
+    return vertexRemap;
+  }
+
+  /**
+   * Move the given values of the vertices to the new numbers of the vertices.
+   * 
+   * @param vertexRemap  The new number of each vertex.
+   * @param values       The values of the vertices, moved in place.
+   */
+  template <typename T>
+  static void remapVertices(const std::vector<uint32_t> &vertexRemap, std::vector<T> &values)
+  {
+    auto remappedValues = std::vector<T>(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      remappedValues[vertexRemap[i]] = values[i];
+    }
+    values.swap(remappedValues);
+  }
+};
+
+#endif
@@ -0,0 +1,510 @@
+#ifndef INCLUDE_MESH_SIMPLIFIER_CPP
+#define INCLUDE_MESH_SIMPLIFIER_CPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+/**
+ * Structure for defining the quadric error of a vertex: the sum of the squared distances of a point to the planes of the
+ *   triangles around the vertex, stored as the upper triangle of the symmetric 4x4 matrix of the planes.
+ */
+struct MeshQuadric
+{
+  // The xx, xy, xz, xw, yy, yz, yw, zz, zw and ww terms of the matrix.
+  std::array<double_t, 10> terms;
+
+  /**
+   * Create the quadric of the plane through the given point with the given normal.
+   * 
+   * @param normal  The unit normal of the plane.
+   * @param point   A point on the plane.
+   * 
+   * @return The quadric of the plane.
+   */
+  static MeshQuadric fromPlane(const glm::dvec3 &normal, const glm::dvec3 &point)
+  {
+    const auto d = -glm::dot(normal, point);
+    return {{normal.x * normal.x, normal.x * normal.y, normal.x * normal.z, normal.x * d,
+             normal.y * normal.y, normal.y * normal.z, normal.y * d,
+             normal.z * normal.z, normal.z * d,
+             d * d}};
+  }
+
+  /**
+   * Add another quadric to this one.
+   * 
+   * @param other  The quadric to add.
+   */
+  void add(const MeshQuadric &other)
+  {
+    for (size_t i = 0; i < terms.size(); i++)
+    {
+      terms[i] += other.terms[i];
+    }
+  }
+
+  /**
+   * Get the error of moving the vertex to the given point.
+   * 
+   * @param point  The point.
+   * 
+   * @return The sum of the squared distances of the point to the planes.
+   */
+  double_t getError(const glm::dvec3 &point) const
+  {
+    const auto &q = terms;
+    const auto error = (q[0] * point.x * point.x) + (2.0 * q[1] * point.x * point.y) + (2.0 * q[2] * point.x * point.z) + (2.0 * q[3] * point.x) +
+                       (q[4] * point.y * point.y) + (2.0 * q[5] * point.y * point.z) + (2.0 * q[6] * point.y) +
+                       (q[7] * point.z * point.z) + (2.0 * q[8] * point.z) +
+                       q[9];
+    return std::max(error, 0.0);
+  }
+};
+
+/**
+ * A class for simplifying an indexed triangle mesh with quadric error metrics, by collapsing its edges into one of their
+ *   vertices one after the other, the ones adding the least error first. Since the vertices only ever move onto other
+ *   vertices, the simplified triangles keep referring to the vertices of the full mesh, so that every level of detail can share
+ *   its vertex buffers.
+ * The vertices split along the seams of the UV coordinates and the normal vectors are moved in pairs, along the seams only, so
+ *   that the seams stay closed, while the vertices on the open borders of the mesh and where seams meet are never moved. The
+ *   simplification can be continued from the last result, so that the levels of detail of an object are made one after the
+ *   other, with the error of each collapse carried along.
+ */
+class MeshSimplifier
+{
+private:
+  /**
+   * An enum for the ways the vertices can be moved.
+   */
+  enum class VertexKind : uint8_t
+  {
+    // The vertex is the only one at its position, away from the borders, and can be moved along any of its edges.
+    MANIFOLD,
+    // The vertex is one of the two at its position along a seam, and can be moved along the seam along with the other one.
+    SEAM,
+    // The vertex is on a border of the mesh or where seams meet, and is never moved.
+    LOCKED
+  };
+
+  /**
+   * Structure for defining a possible collapse of an edge, moving one of its vertices onto the other.
+   */
+  struct EdgeCollapse
+  {
+    // The error added by the collapse.
+    double_t error;
+    // The vertex moved, and the vertex it is moved onto.
+    uint32_t fromVertex;
+    uint32_t toVertex;
+  };
+
+  // The positions of the vertices.
+  const std::vector<glm::vec3> &vertices;
+  // The indices of the triangles of the current result (three per triangle).
+  std::vector<uint32_t> indices;
+  // The first vertex at the position of each vertex, which the quadrics of the positions are stored at.
+  std::vector<uint32_t> positionVertices;
+  // The other vertex at the position of each seam vertex (the vertex itself for the other vertices).
+  std::vector<uint32_t> seamSiblings;
+  // The way each vertex can be moved.
+  std::vector<VertexKind> vertexKinds;
+  // The quadric of each position, including the ones of the positions collapsed onto it.
+  std::vector<MeshQuadric> quadrics;
+
+  // The start of the triangles around each vertex in the triangle list, and the triangles around the vertices.
+  std::vector<uint32_t> vertexTriangleOffsets;
+  std::vector<uint32_t> vertexTriangles;
+  // The number of triangles along each edge of the current result, which is 1 along the seams.
+  std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts;
+  // The possible collapses of the edges of the current result.
+  std::vector<EdgeCollapse> collapses;
+  // The vertex each vertex is moved onto by the current pass (itself if it stays).
+  std::vector<uint32_t> vertexRemap;
+  // Whether each vertex was moved or had its triangles changed in the current pass, which rules out the collapses with it.
+  std::vector<bool> isVertexTouched;
+
+  /**
+   * Get the key of the edge between two vertices, which is the same in both directions.
+   * 
+   * @param vertex1  The first vertex.
+   * @param vertex2  The second vertex.
+   * 
+   * @return The key of the edge.
+   */
+  static uint64_t getEdgeKey(const uint32_t &vertex1, const uint32_t &vertex2)
+  {
+    return (static_cast<uint64_t>(std::min(vertex1, vertex2)) << 32) | std::max(vertex1, vertex2);
+  }
+
+  /**
+   * Get the normal of a triangle, not normalized (its length is twice the area of the triangle).
+   * 
+   * @param vertex1  The first vertex of the triangle.
+   * @param vertex2  The second vertex of the triangle.
+   * @param vertex3  The third vertex of the triangle.
+   * 
+   * @return The normal.
+   */
+  static glm::dvec3 getTriangleNormal(const glm::dvec3 &vertex1, const glm::dvec3 &vertex2, const glm::dvec3 &vertex3)
+  {
+    return glm::cross(vertex2 - vertex1, vertex3 - vertex1);
+  }
+
+  /**
+   * Count the triangles along each edge of the given triangles.
+   * 
+   * @param triangleIndices        The indices of the triangles.
+   * @param vertexIds              The ID each vertex is counted as (e.g. its position).
+   * @param outEdgeTriangleCounts  The output variable for the number of triangles along each edge.
+   */
+  static void countEdgeTriangles(const std::vector<uint32_t> &triangleIndices, const std::vector<uint32_t> &vertexIds, std::unordered_map<uint64_t, uint32_t> &outEdgeTriangleCounts)
+  {
+    outEdgeTriangleCounts.clear();
+    outEdgeTriangleCounts.reserve(triangleIndices.size());
+    for (size_t i = 0; i < triangleIndices.size(); i += 3)
+    {
+      for (uint32_t j = 0; j < 3; j++)
+      {
+        outEdgeTriangleCounts[getEdgeKey(vertexIds[triangleIndices[i + j]], vertexIds[triangleIndices[i + ((j + 1) % 3)]])]++;
+      }
+    }
+  }
+
+  /**
+   * Get the number of triangles along an edge of the current result.
+   * 
+   * @param vertex1  The first vertex of the edge.
+   * @param vertex2  The second vertex of the edge.
+   * 
+   * @return The number of triangles, 0 if there is no such edge.
+   */
+  uint32_t getEdgeTriangleCount(const uint32_t &vertex1, const uint32_t &vertex2) const
+  {
+    const auto edgeTriangleCount = edgeTriangleCounts.find(getEdgeKey(vertex1, vertex2));
+    return edgeTriangleCount == edgeTriangleCounts.end() ? 0 : edgeTriangleCount->second;
+  }
+
+  /**
+   * Check if a vertex can be moved onto another along their edge, which for a seam vertex has to be along the seam, with the
+   *   other vertex of the seam moved onto the other vertex at the position moved to.
+   * 
+   * @param fromVertex  The vertex moved.
+   * @param toVertex    The vertex it is moved onto.
+   * 
+   * @return Whether the vertex can be moved.
+   */
+  bool isCollapseAllowed(const uint32_t &fromVertex, const uint32_t &toVertex) const
+  {
+    switch (vertexKinds[fromVertex])
+    {
+    case VertexKind::MANIFOLD:
+      return true;
+    case VertexKind::SEAM:
+      return vertexKinds[toVertex] == VertexKind::SEAM && getEdgeTriangleCount(fromVertex, toVertex) == 1 && getEdgeTriangleCount(seamSiblings[fromVertex], seamSiblings[toVertex]) == 1;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * Find the triangles around each vertex of the current result.
+   */
+  void updateVertexTriangles()
+  {
+    std::fill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end(), 0);
+    for (const auto &index : indices)
+    {
+      vertexTriangleOffsets[index + 1]++;
+    }
+    for (size_t i = 1; i < vertexTriangleOffsets.size(); i++)
+    {
+      vertexTriangleOffsets[i] += vertexTriangleOffsets[i - 1];
+    }
+    vertexTriangles.resize(indices.size());
+    auto nextOffsets = std::vector<uint32_t>(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+    for (uint32_t i = 0; i < indices.size(); i++)
+    {
+      vertexTriangles[nextOffsets[indices[i]]++] = i / 3;
+    }
+  }
+
+  /**
+   * Check if moving a vertex onto another would flip or squash any of the triangles around it that are kept.
+   * 
+   * @param fromVertex  The vertex moved.
+   * @param toVertex    The vertex it is moved onto.
+   * 
+   * @return Whether the collapse keeps the triangles facing the way they did.
+   */
+  bool isCollapseValid(const uint32_t &fromVertex, const uint32_t &toVertex) const
+  {
+    const auto toPosition = glm::dvec3(vertices[toVertex]);
+    for (auto i = vertexTriangleOffsets[fromVertex]; i < vertexTriangleOffsets[fromVertex + 1]; i++)
+    {
+      const auto triangle = vertexTriangles[i];
+      std::array<glm::dvec3, 3> positions;
+      auto isRemoved = false;
+      for (uint32_t j = 0; j < 3; j++)
+      {
+        const auto vertex = indices[(triangle * 3) + j];
+        isRemoved = isRemoved || vertex == toVertex;
+        positions[j] = glm::dvec3(vertices[vertex]);
+      }
+      // The triangles along the collapsed edge are removed by it.
+      if (isRemoved)
+      {
+        continue;
+      }
+
+      const auto oldNormal = getTriangleNormal(positions[0], positions[1], positions[2]);
+      for (uint32_t j = 0; j < 3; j++)
+      {
+        if (indices[(triangle * 3) + j] == fromVertex)
+        {
+          positions[j] = toPosition;
+        }
+      }
+      const auto newNormal = getTriangleNormal(positions[0], positions[1], positions[2]);
+      // Rule out the triangles turning by more than 60 degrees, or shrinking to nothing.
+      const auto oldLength = glm::length(oldNormal), newLength = glm::length(newNormal);
+      if (newLength <= 1e-12 * (oldLength + 1e-30) || glm::dot(oldNormal, newNormal) < 0.5 * oldLength * newLength)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Move a vertex onto another, leaving the vertices of its triangles alone for the rest of the pass since their triangles
+   *   change.
+   * 
+   * @param fromVertex  The vertex moved.
+   * @param toVertex    The vertex it is moved onto.
+   * 
+   * @return The number of indices of the triangles removed by the collapse.
+   */
+  size_t collapseVertex(const uint32_t &fromVertex, const uint32_t &toVertex)
+  {
+    vertexRemap[fromVertex] = toVertex;
+    size_t removedIndexCount = 0;
+    for (auto i = vertexTriangleOffsets[fromVertex]; i < vertexTriangleOffsets[fromVertex + 1]; i++)
+    {
+      const auto triangle = vertexTriangles[i];
+      auto isRemoved = false;
+      for (uint32_t j = 0; j < 3; j++)
+      {
+        isRemoved = isRemoved || indices[(triangle * 3) + j] == toVertex;
+        isVertexTouched[indices[(triangle * 3) + j]] = true;
+      }
+      removedIndexCount += isRemoved ? 3 : 0;
+    }
+    return removedIndexCount;
+  }
+
+  /**
+   * Run a pass of collapses, collapsing the edges adding the least error first, each vertex at most once.
+   * 
+   * @param targetIndexCount  The number of indices to stop at.
+   * @param maxError          The largest error a collapse may add.
+   * 
+   * @return The number of collapses done.
+   */
+  uint32_t collapseEdges(const size_t &targetIndexCount, const double_t &maxError)
+  {
+    updateVertexTriangles();
+    countEdgeTriangles(indices, vertexRemap, edgeTriangleCounts);
+
+    // Find the cheapest allowed direction to collapse each edge in.
+    collapses.clear();
+    for (const auto &edgeTriangleCount : edgeTriangleCounts)
+    {
+      const auto vertex1 = static_cast<uint32_t>(edgeTriangleCount.first >> 32), vertex2 = static_cast<uint32_t>(edgeTriangleCount.first & 0xFFFFFFFF);
+      auto quadric = quadrics[positionVertices[vertex1]];
+      quadric.add(quadrics[positionVertices[vertex2]]);
+      const auto error1 = isCollapseAllowed(vertex1, vertex2) ? quadric.getError(glm::dvec3(vertices[vertex2])) : maxError + 1.0;
+      const auto error2 = isCollapseAllowed(vertex2, vertex1) ? quadric.getError(glm::dvec3(vertices[vertex1])) : maxError + 1.0;
+      const auto collapse = error1 <= error2 ? EdgeCollapse({error1, vertex1, vertex2}) : EdgeCollapse({error2, vertex2, vertex1});
+      if (collapse.error <= maxError)
+      {
+        collapses.push_back(collapse);
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse &first, const EdgeCollapse &second) {
+      return first.error < second.error || (first.error == second.error && first.fromVertex < second.fromVertex);
+    });
+
+    // Collapse the edges in order until the target is reached, skipping the ones next to the vertices already changed.
+    std::fill(isVertexTouched.begin(), isVertexTouched.end(), false);
+    auto indexCount = indices.size();
+    uint32_t collapsesCount = 0;
+    for (const auto &collapse : collapses)
+    {
+      if (indexCount <= targetIndexCount)
+      {
+        break;
+      }
+      const auto &fromVertex = collapse.fromVertex, &toVertex = collapse.toVertex;
+      const auto &fromSibling = seamSiblings[fromVertex], &toSibling = seamSiblings[toVertex];
+      const auto isSeam = vertexKinds[fromVertex] == VertexKind::SEAM;
+      if (isVertexTouched[fromVertex] || isVertexTouched[toVertex] || (isSeam && (isVertexTouched[fromSibling] || isVertexTouched[toSibling])) ||
+          !isCollapseValid(fromVertex, toVertex) || (isSeam && !isCollapseValid(fromSibling, toSibling)))
+      {
+        continue;
+      }
+
+      indexCount -= collapseVertex(fromVertex, toVertex);
+      if (isSeam)
+      {
+        indexCount -= collapseVertex(fromSibling, toSibling);
+      }
+      quadrics[positionVertices[toVertex]].add(quadrics[positionVertices[fromVertex]]);
+      collapsesCount++;
+    }
+
+    // Move the vertices of the triangles, dropping the triangles left with a repeated vertex.
+    size_t keptIndexCount = 0;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+      const auto vertex1 = vertexRemap[indices[i]], vertex2 = vertexRemap[indices[i + 1]], vertex3 = vertexRemap[indices[i + 2]];
+      if (vertex1 == vertex2 || vertex2 == vertex3 || vertex3 == vertex1)
+      {
+        continue;
+      }
+      indices[keptIndexCount++] = vertex1;
+      indices[keptIndexCount++] = vertex2;
+      indices[keptIndexCount++] = vertex3;
+    }
+    indices.resize(keptIndexCount);
+    for (uint32_t i = 0; i < vertexRemap.size(); i++)
+    {
+      vertexRemap[i] = i;
+    }
+    return collapsesCount;
+  }
+
+public:
+  /**
+   * Start simplifying the given mesh.
+   * 
+   * @param vertices  The positions of the vertices, which must outlive the simplifier.
+   * @param indices   The indices of the triangles (three per triangle).
+   */
+  MeshSimplifier(const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &indices)
+      : vertices(vertices),
+        indices(indices),
+        positionVertices(vertices.size(), 0),
+        seamSiblings(vertices.size(), 0),
+        vertexKinds(vertices.size(), VertexKind::MANIFOLD),
+        quadrics(vertices.size(), MeshQuadric({{}})),
+        vertexTriangleOffsets(vertices.size() + 1, 0),
+        vertexTriangles({}),
+        edgeTriangleCounts({}),
+        collapses({}),
+        vertexRemap(vertices.size(), 0),
+        isVertexTouched(vertices.size(), false)
+  {
+    // Find the first vertex at the position of each vertex, and count the vertices at each position.
+    std::unordered_map<uint64_t, uint32_t> firstPositionVertices;
+    std::vector<uint32_t> positionVertexCounts(vertices.size(), 0);
+    firstPositionVertices.reserve(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+      // The positions are hashed by their bits, since only the vertices split from the same position are looked for.
+      uint32_t bits[3];
+      memcpy(bits, &vertices[i], sizeof(bits));
+      const auto positionKey = (static_cast<uint64_t>(bits[0]) * 73856093u) ^ (static_cast<uint64_t>(bits[1]) * 19349663u) ^ (static_cast<uint64_t>(bits[2]) * 83492791u);
+      auto positionVertex = firstPositionVertices.emplace(positionKey, i).first->second;
+      // Fall back to the vertex itself for the rare positions whose hashes collide.
+      positionVertex = vertices[positionVertex] == vertices[i] ? positionVertex : i;
+      positionVertices[i] = positionVertex;
+      seamSiblings[i] = i;
+      if (positionVertex != i)
+      {
+        seamSiblings[i] = positionVertex;
+        seamSiblings[positionVertex] = i;
+      }
+      positionVertexCounts[positionVertex]++;
+      vertexRemap[i] = i;
+    }
+
+    // Add the plane of each triangle to the quadrics of its positions.
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+      const auto normal = getTriangleNormal(glm::dvec3(vertices[indices[i]]), glm::dvec3(vertices[indices[i + 1]]), glm::dvec3(vertices[indices[i + 2]]));
+      const auto normalLength = glm::length(normal);
+      if (normalLength > 0.0)
+      {
+        const auto quadric = MeshQuadric::fromPlane(normal / normalLength, glm::dvec3(vertices[indices[i]]));
+        for (uint32_t j = 0; j < 3; j++)
+        {
+          quadrics[positionVertices[indices[i + j]]].add(quadric);
+        }
+      }
+    }
+
+    // The edges with a single triangle between the positions are on the open borders of the mesh, and the edges with a single
+    //   triangle between the vertices are either on the open borders or along the seams.
+    std::unordered_map<uint64_t, uint32_t> positionEdgeTriangleCounts;
+    countEdgeTriangles(indices, positionVertices, positionEdgeTriangleCounts);
+    countEdgeTriangles(indices, vertexRemap, edgeTriangleCounts);
+    std::vector<bool> isBorderPosition(vertices.size(), false), isBorderVertex(vertices.size(), false);
+    for (const auto &edgeTriangleCount : positionEdgeTriangleCounts)
+    {
+      if (edgeTriangleCount.second == 1)
+      {
+        isBorderPosition[edgeTriangleCount.first >> 32] = true;
+        isBorderPosition[edgeTriangleCount.first & 0xFFFFFFFF] = true;
+      }
+    }
+    for (const auto &edgeTriangleCount : edgeTriangleCounts)
+    {
+      if (edgeTriangleCount.second == 1)
+      {
+        isBorderVertex[edgeTriangleCount.first >> 32] = true;
+        isBorderVertex[edgeTriangleCount.first & 0xFFFFFFFF] = true;
+      }
+    }
+
+    // The vertices alone at their positions move freely, and the pairs at the same position move along their seam.
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+      const auto &positionVertexCount = positionVertexCounts[positionVertices[i]];
+      if (isBorderPosition[positionVertices[i]] || positionVertexCount > 2 || (positionVertexCount == 1 && isBorderVertex[i]))
+      {
+        vertexKinds[i] = VertexKind::LOCKED;
+      }
+      else if (positionVertexCount == 2)
+      {
+        vertexKinds[i] = VertexKind::SEAM;
+      }
+    }
+  }
+
+  /**
+   * Continue simplifying the mesh until it has at most the given number of indices, or no edge can be collapsed within the
+   *   given error.
+   * 
+   * @param targetIndexCount  The number of indices to reach.
+   * @param maxError          The largest distance the surface may move by each collapse.
+   * 
+   * @return The indices of the simplified triangles.
+   */
+  const std::vector<uint32_t> &simplify(const size_t &targetIndexCount, const float_t &maxError)
+  {
+    const auto maxQuadricError = static_cast<double_t>(maxError) * maxError;
+    while (indices.size() > targetIndexCount && collapseEdges(targetIndexCount, maxQuadricError) > 0)
+    {
+    }
+    return indices;
+  }
+};
+
+#endif
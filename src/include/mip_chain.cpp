@@ -0,0 +1,233 @@
+#ifndef INCLUDE_MIP_CHAIN_CPP
+#define INCLUDE_MIP_CHAIN_CPP
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <string.h>
+
+#include "constants.cpp"
+#include "job.cpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIP_CHAIN_X86
+#include <emmintrin.h>
+#endif
+
+/**
+ * Structure for defining where a level of a mip chain of BGR8 pixels is stored, in the memory holding the whole chain.
+ */
+struct MipLevelLayout
+{
+  // The size of the level (in pixels).
+  uint32_t width;
+  uint32_t height;
+  // The size of each row (in bytes), padded to 4 bytes like the rows of the BMP images (and the default unpack alignment).
+  uint32_t rowSize;
+  // The offset of the level from the start of the chain (in bytes).
+  uint64_t offset;
+
+  /**
+   * Get the size of the level.
+   *
+   * @return The size (in bytes).
+   */
+  uint64_t getSize() const
+  {
+    return static_cast<uint64_t>(rowSize) * height;
+  }
+};
+
+/**
+ * A class that generates the mip chains of BGR8 images on the worker threads, filtering each level from the one above it with a
+ *   2x2 box filter (the last row or column of an odd level is dropped, the same as the levels generated by the driver).
+ * Each level is split into tiles of rows filtered by tasks of their own, which only wait for the two tiles of the level above
+ *   they read from, so that the tiles of the same level and the first tiles of the smaller levels are filtered in parallel.
+ * The rows are filtered three pixels at a time with SSE2 where available, and with scalar code everywhere else.
+ */
+class MipChainGenerator
+{
+private:
+  /**
+   * Filter a row of a level from two rows of the level above with scalar code, from the given pixel to the end of the row.
+   *
+   * @param sourceRow      The first of the rows of the level above.
+   * @param nextSourceRow  The second of the rows of the level above (the same as the first for a level one row high).
+   * @param sourceWidth    The width of the level above.
+   * @param targetRow      The row to write the filtered pixels to.
+   * @param targetWidth    The width of the level.
+   * @param pixel          The first pixel of the row to filter.
+   */
+  static void filterRowScalar(const unsigned char *const sourceRow, const unsigned char *const nextSourceRow, const uint32_t &sourceWidth,
+                              unsigned char *const targetRow, const uint32_t &targetWidth, uint32_t pixel)
+  {
+    for (; pixel < targetWidth; pixel++)
+    {
+      const auto left = std::min(pixel * 2, sourceWidth - 1) * 3, right = std::min(pixel * 2 + 1, sourceWidth - 1) * 3;
+      for (auto channel = 0; channel < 3; channel++)
+      {
+        targetRow[pixel * 3 + channel] = static_cast<unsigned char>(
+            (sourceRow[left + channel] + sourceRow[right + channel] + nextSourceRow[left + channel] + nextSourceRow[right + channel] + 2) >> 2);
+      }
+    }
+  }
+
+#ifdef MIP_CHAIN_X86
+  /**
+   * Filter a row of a level from two rows of the level above three pixels at a time with SSE2, leaving the pixels that are too
+   *   close to the end of the row to load a vector for.
+   * Each row is loaded twice, the second time three bytes (a pixel) later, so that adding the loads sums each channel of every
+   *   pixel with the same channel of the pixel after it. The sums of the even pixels are the filtered pixels.
+   *
+   * @param sourceRow      The first of the rows of the level above.
+   * @param nextSourceRow  The second of the rows of the level above.
+   * @param sourceWidth    The width of the level above.
+   * @param targetRow      The row to write the filtered pixels to.
+   * @param targetWidth    The width of the level.
+   *
+   * @return The first pixel of the row left unfiltered.
+   */
+  static uint32_t filterRowSse2(const unsigned char *const sourceRow, const unsigned char *const nextSourceRow, const uint32_t &sourceWidth,
+                                unsigned char *const targetRow, const uint32_t &targetWidth)
+  {
+    const auto zero = _mm_setzero_si128(), rounding = _mm_set1_epi16(2);
+    alignas(16) unsigned char filteredBytes[16];
+    uint32_t pixel = 0;
+    for (; pixel + 3 <= targetWidth && pixel * 6 + 19 <= sourceWidth * 3; pixel += 3)
+    {
+      const auto offset = pixel * 6;
+      const auto left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sourceRow + offset));
+      const auto right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sourceRow + offset + 3));
+      const auto nextLeft = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nextSourceRow + offset));
+      const auto nextRight = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nextSourceRow + offset + 3));
+
+      // Sum the four pixels of each channel as 16-bit values, and round the averages back to bytes.
+      const auto sumLow = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(left, zero), _mm_unpacklo_epi8(right, zero)),
+                                        _mm_add_epi16(_mm_unpacklo_epi8(nextLeft, zero), _mm_unpacklo_epi8(nextRight, zero)));
+      const auto sumHigh = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(left, zero), _mm_unpackhi_epi8(right, zero)),
+                                         _mm_add_epi16(_mm_unpackhi_epi8(nextLeft, zero), _mm_unpackhi_epi8(nextRight, zero)));
+      _mm_store_si128(reinterpret_cast<__m128i *>(filteredBytes),
+                      _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(sumLow, rounding), 2), _mm_srli_epi16(_mm_add_epi16(sumHigh, rounding), 2)));
+
+      // Keep the averages of the even pixels (bytes 0, 6 and 12).
+      memcpy(targetRow + pixel * 3, filteredBytes, 3);
+      memcpy(targetRow + pixel * 3 + 3, filteredBytes + 6, 3);
+      memcpy(targetRow + pixel * 3 + 6, filteredBytes + 12, 3);
+    }
+    return pixel;
+  }
+#endif
+
+  /**
+   * Filter the given rows of a level from the level above.
+   *
+   * @param chainData  The memory of the mip chain.
+   * @param source     The layout of the level above.
+   * @param target     The layout of the level.
+   * @param beginRow   The first row to filter.
+   * @param endRow     The row after the last one to filter.
+   */
+  static void filterRows(unsigned char *const chainData, const MipLevelLayout &source, const MipLevelLayout &target, const uint32_t &beginRow, const uint32_t &endRow)
+  {
+    for (auto row = beginRow; row < endRow; row++)
+    {
+      const auto sourceRow = chainData + source.offset + static_cast<uint64_t>(std::min(row * 2, source.height - 1)) * source.rowSize;
+      const auto nextSourceRow = chainData + source.offset + static_cast<uint64_t>(std::min(row * 2 + 1, source.height - 1)) * source.rowSize;
+      const auto targetRow = chainData + target.offset + static_cast<uint64_t>(row) * target.rowSize;
+#ifdef MIP_CHAIN_X86
+      const auto pixel = filterRowSse2(sourceRow, nextSourceRow, source.width, targetRow, target.width);
+#else
+      const uint32_t pixel = 0;
+#endif
+      filterRowScalar(sourceRow, nextSourceRow, source.width, targetRow, target.width, pixel);
+    }
+  }
+
+public:
+  /**
+   * Get the layouts of all the levels of the mip chain of an image, down to the 1x1 level, stored one after the other.
+   *
+   * @param width   The width of the image.
+   * @param height  The height of the image.
+   *
+   * @return The layouts of the levels, starting from the image itself.
+   */
+  static std::vector<MipLevelLayout> getLevelLayouts(const uint32_t &width, const uint32_t &height)
+  {
+    std::vector<MipLevelLayout> levels;
+    uint64_t offset = 0;
+    auto levelWidth = std::max(width, 1u), levelHeight = std::max(height, 1u);
+    while (true)
+    {
+      levels.push_back({levelWidth, levelHeight, (levelWidth * 3 + 3) & ~3u, offset});
+      offset += levels.back().getSize();
+      if (levelWidth == 1 && levelHeight == 1)
+      {
+        return levels;
+      }
+      levelWidth = std::max(levelWidth / 2, 1u);
+      levelHeight = std::max(levelHeight / 2, 1u);
+    }
+  }
+
+  /**
+   * Get the size of the whole mip chain with the given levels.
+   *
+   * @param levels  The layouts of the levels.
+   *
+   * @return The size (in bytes).
+   */
+  static uint64_t getChainSize(const std::vector<MipLevelLayout> &levels)
+  {
+    return levels.back().offset + levels.back().getSize();
+  }
+
+  /**
+   * Submit the tasks generating the levels of a mip chain below its base level, once the base level is filled in.
+   *
+   * @param chainData      The memory of the mip chain (sized by the base level task, which fills in the base level), which the
+   *                         levels are filtered in. It is freed once all the levels are generated.
+   * @param targetData     The memory each filtered tile is copied to, at the same offset as in the chain (e.g. a mapped pixel
+   *                         buffer object, which is only written to).
+   * @param levels         The layouts of the levels.
+   * @param baseLevelTask  The task filling in the base level.
+   *
+   * @return The task finishing once all the levels are generated and copied.
+   */
+  static std::shared_ptr<JobTask> submitFilterTasks(const std::shared_ptr<std::vector<unsigned char>> &chainData, unsigned char *const targetData,
+                                                    const std::vector<MipLevelLayout> &levels, const std::shared_ptr<JobTask> &baseLevelTask)
+  {
+    auto &jobManager = JobManager::getInstance();
+    std::vector<std::shared_ptr<JobTask>> allTasks = {baseLevelTask};
+    std::vector<std::shared_ptr<JobTask>> sourceTasks = {baseLevelTask};
+    for (size_t level = 1; level < levels.size(); level++)
+    {
+      const auto source = levels[level - 1], target = levels[level];
+      std::vector<std::shared_ptr<JobTask>> levelTasks;
+      for (uint32_t beginRow = 0; beginRow < target.height; beginRow += MIP_GENERATION_TILE_ROWS)
+      {
+        // The rows of the tile are filtered from the rows of (at most) two tiles of the level above, the base level being a
+        //   single tile.
+        const auto tile = beginRow / MIP_GENERATION_TILE_ROWS;
+        const auto firstSourceTile = std::min<size_t>(tile * 2, sourceTasks.size() - 1), lastSourceTile = std::min<size_t>(tile * 2 + 1, sourceTasks.size() - 1);
+        const auto endRow = std::min(beginRow + MIP_GENERATION_TILE_ROWS, target.height);
+        levelTasks.push_back(jobManager.submitTask(
+            [chainData, targetData, source, target, beginRow, endRow]() {
+              filterRows(chainData->data(), source, target, beginRow, endRow);
+              const auto tileOffset = target.offset + static_cast<uint64_t>(beginRow) * target.rowSize;
+              memcpy(targetData + tileOffset, chainData->data() + tileOffset, static_cast<uint64_t>(endRow - beginRow) * target.rowSize);
+            },
+            std::vector<std::shared_ptr<JobTask>>(sourceTasks.begin() + firstSourceTile, sourceTasks.begin() + lastSourceTile + 1)));
+      }
+      allTasks.insert(allTasks.end(), levelTasks.begin(), levelTasks.end());
+      sourceTasks = std::move(levelTasks);
+    }
+
+    // Free the memory of the chain once every tile is filtered (including the ones only an odd row or column dropped by the next
+    //   level is filtered from, which no other tile waits for).
+    return jobManager.submitTask([chainData]() { std::vector<unsigned char>().swap(*chainData); }, allTasks);
+  }
+};
+
+#endif
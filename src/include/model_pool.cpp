@@ -0,0 +1,161 @@
+#ifndef INCLUDE_MODEL_POOL_CPP
+#define INCLUDE_MODEL_POOL_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "models.cpp"
+
+/**
+ * Class for keeping preallocated instances of a model type around, so that spawning and despawning them registers and
+ *   de-registers the instances with the model manager instead of creating and destroying them (and their colliders, lights,
+ *   shader programs and shadow buffers) every time.
+ * The model type is expected to have a `create(modelId)` factory, and to reset its state (and re-register anything it owns)
+ *   in init() and release it in deinit(), since those are run on every spawn and despawn.
+ */
+template <typename T>
+class ModelPool
+{
+private:
+  // The model manager responsible for managing the models in the scene.
+  ModelManager &modelManager;
+  // The transform manager storing the transformations of the pooled models.
+  TransformManager &transformManager;
+
+  // The prefix of the IDs of the pooled models, followed by their index in the pool.
+  const std::string modelIdPrefix;
+  // All the models of the pool, spawned or not, kept alive by the pool.
+  std::vector<std::shared_ptr<T>> pooledModels;
+  // The models free to be spawned, the most recently despawned last.
+  std::vector<std::shared_ptr<T>> freeModels;
+  // The despawned models still waiting for their queued de-registration to be applied, before they can be spawned again.
+  std::vector<std::shared_ptr<T>> despawnedModels;
+
+  /**
+   * Create a new model for the pool, and mark it as free.
+   */
+  void createPooledModel()
+  {
+    const auto model = T::create(modelIdPrefix + std::to_string(pooledModels.size()));
+    pooledModels.push_back(model);
+    freeModels.push_back(model);
+  }
+
+  /**
+   * Mark the despawned models as free once their de-registration is applied.
+   */
+  void freeDespawnedModels()
+  {
+    for (size_t i = 0; i < despawnedModels.size();)
+    {
+      if (despawnedModels[i]->getModelHandle() != INVALID_REGISTRY_HANDLE)
+      {
+        i++;
+        continue;
+      }
+      freeModels.push_back(std::move(despawnedModels[i]));
+      despawnedModels[i] = std::move(despawnedModels.back());
+      despawnedModels.pop_back();
+    }
+  }
+
+public:
+  ModelPool(const std::string &modelIdPrefix)
+      : modelManager(ModelManager::getInstance()),
+        transformManager(TransformManager::getInstance()),
+        modelIdPrefix(modelIdPrefix),
+        pooledModels({}),
+        freeModels({}),
+        despawnedModels({}) {}
+
+  // Preventing copying the model pool, since the models know nothing of the pools they belong to.
+  ModelPool(const ModelPool &) = delete;
+
+  /**
+   * Create models until the pool holds at least the given number of them.
+   * 
+   * @param modelCount  The number of models to hold.
+   */
+  void reserve(const size_t &modelCount)
+  {
+    pooledModels.reserve(modelCount);
+    freeModels.reserve(modelCount);
+    despawnedModels.reserve(modelCount);
+    while (pooledModels.size() < modelCount)
+    {
+      createPooledModel();
+    }
+  }
+
+  /**
+   * Spawn a free model of the pool at the given position, initializing it and queuing its registration with the model manager.
+   *   A new model is only created if all the models of the pool are spawned already.
+   * 
+   * @param position  The position to spawn the model at.
+   * 
+   * @return The spawned model.
+   */
+  const std::shared_ptr<T> spawn(const glm::vec3 &position)
+  {
+    freeDespawnedModels();
+    if (freeModels.empty())
+    {
+      createPooledModel();
+    }
+    const auto model = std::move(freeModels.back());
+    freeModels.pop_back();
+
+    model->setModelPosition(position);
+    // Do not interpolate the rendered model from where it was despawned.
+    transformManager.resetInterpolation(model->getTransformHandle());
+    model->init();
+    modelManager.queueRegisterModel(model);
+
+    return model;
+  }
+
+  /**
+   * Despawn a spawned model of the pool, de-initializing it and queuing its de-registration from the model manager, after
+   *   which it is free to be spawned again.
+   * 
+   * @param model  The model to despawn (ignored if it is not registered with the model manager, or already despawned).
+   */
+  void despawn(T *model)
+  {
+    const auto modelHandle = model->getModelHandle();
+    if (modelHandle == INVALID_REGISTRY_HANDLE || modelManager.isDeregistrationQueued(model))
+    {
+      return;
+    }
+
+    // Take the model from the model manager, which lets go of it once the de-registration is applied.
+    const auto pooledModel = std::static_pointer_cast<T>(modelManager.getModel(modelHandle));
+    model->deinit();
+    modelManager.queueDeregisterModel(pooledModel);
+    despawnedModels.push_back(pooledModel);
+  }
+
+  /**
+   * De-register all the spawned models of the pool right away, and destroy all its models. Meant for when the scene ends,
+   *   while nothing iterates the models.
+   */
+  void clear()
+  {
+    for (const auto &model : pooledModels)
+    {
+      if (model->getModelHandle() != INVALID_REGISTRY_HANDLE)
+      {
+        model->deinit();
+        modelManager.deregisterModel(model->getModelHandle());
+      }
+    }
+    despawnedModels.clear();
+    freeModels.clear();
+    pooledModels.clear();
+  }
+};
+
+#endif
@@ -2,12 +2,12 @@
 #define INCLUDE_MODELS_CPP
 
 #include <string>
-#include <map>
 #include <vector>
 #include <memory>
 #include <algorithm>
 #include <iterator>
 #include <any>
+#include <memory_resource>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -19,9 +19,38 @@
 #include "texture.cpp"
 #include "shader.cpp"
 #include "collider.cpp"
+#include "collision.cpp"
+#include "scene_tree.cpp"
+#include "render_group.cpp"
+#include "job.cpp"
 #include "text.cpp"
+#include "profiler.cpp"
+#include "registry.cpp"
 #include "../models/model_base_intf.cpp"
 
+/**
+ * Structure for defining the models of a model type updated together by the batch update of the type.
+ */
+struct ModelUpdateBatch
+{
+  // The batch update function of the model type (null while the batch has no models).
+  ModelBatchUpdate batchUpdate;
+  // The models of the type, in their registration order.
+  std::vector<ModelBaseIntf *> models;
+};
+
+/**
+ * Structure for defining a range of the models of a batch, updated by a single job of the parallel model update.
+ */
+struct ModelUpdateRange
+{
+  // The model type ID of the batch.
+  ModelTypeId modelTypeId;
+  // The index of the first model of the range in the batch, and the index after the last one.
+  size_t begin;
+  size_t end;
+};
+
 /**
  * A manager class for managing models in a scene.
  */
@@ -33,49 +62,175 @@ private:
 
   // The text manager responsible for rendering text.
   TextManager &textManager;
+  // The CPU profiler the model updates are timed with.
+  CpuProfiler &cpuProfiler;
+
+  // The collision manager responsible for finding the models that can collide with each other.
+  CollisionManager &collisionManager;
+  // The scene tree manager responsible for finding the models the renderer needs.
+  SceneTreeManager &sceneTreeManager;
+  // The render group manager responsible for keeping the models grouped by type for the renderer.
+  RenderGroupManager &renderGroupManager;
+  // The job manager responsible for updating the thread-safe models in parallel.
+  JobManager &jobManager;
+
+  // The registered models, in their registration order.
+  Registry<ModelBaseIntf> registeredModels;
+  // The number of registered models of each model type, by the model type IDs.
+  std::vector<uint32_t> modelTypeCounts;
+  // The number of registered models casting shadows flagged as static, which the renderer caches the shadows of.
+  uint32_t staticCastersCount;
+
+  // The collision events of the last collision pass (kept around to avoid reallocating every frame).
+  std::vector<CollisionEvent> collisionEvents;
+  // Whether the collision passes submitted by submitCollisions() run on a worker thread, their events sent to the models at the
+  //   next sync point, instead of right away on the calling thread.
+  bool isCollisionPipelined;
+  // The collision pass running on a worker thread, until its events are sent by the next syncCollisions().
+  std::shared_ptr<JobTask> collisionTask;
+  // The time the collision pass running on a worker thread took there (in seconds), written by the pass and only read once it
+  //   is synced.
+  double_t pipelinedCollisionTime;
+  // The time the last collision pass whose events were sent took (in seconds), on the thread it ran on.
+  double_t collisionPassTime;
+
+  // The registrations and de-registrations queued by the updates and collision events, applied in their order by the next
+  //   applyQueuedCommands() (kept around to avoid reallocating every frame).
+  std::vector<RegistryCommand<ModelBaseIntf>> queuedCommands;
 
-  // The map of registered models.
-  std::map<const std::string, std::shared_ptr<ModelBaseIntf>> registeredModels;
-  std::vector<std::string> registeredModelsInsertionOrder;
+  // The models of the last update updated in parallel, and the ones updated on the main thread, batched by the model type IDs
+  //   (kept around to avoid reallocating every frame).
+  std::vector<ModelUpdateBatch> parallelBatches;
+  std::vector<ModelUpdateBatch> serialBatches;
+  // The ranges of the parallel batches run by each job, and the model type IDs of the serial batches, in the order their
+  //   first models were registered.
+  std::vector<ModelUpdateRange> parallelRanges;
+  std::vector<ModelTypeId> serialModelTypeIds;
+  // The time the last update took to update the models in parallel, and on the main thread (in seconds).
+  double_t parallelUpdateTime;
+  double_t serialUpdateTime;
 
   ModelManager()
       : textManager(TextManager::getInstance()),
-        registeredModels({}),
-        registeredModelsInsertionOrder({}) {}
+        cpuProfiler(CpuProfiler::getInstance()),
+        collisionManager(CollisionManager::getInstance()),
+        sceneTreeManager(SceneTreeManager::getInstance()),
+        renderGroupManager(RenderGroupManager::getInstance()),
+        jobManager(JobManager::getInstance()),
+        registeredModels(),
+        modelTypeCounts({}),
+        staticCastersCount(0),
+        collisionEvents({}),
+        isCollisionPipelined(false),
+        collisionTask(nullptr),
+        pipelinedCollisionTime(0.0),
+        collisionPassTime(0.0),
+        queuedCommands({}),
+        parallelBatches({}),
+        serialBatches({}),
+        parallelRanges({}),
+        serialModelTypeIds({}),
+        parallelUpdateTime(0.0),
+        serialUpdateTime(0.0) {}
+
+  /**
+   * Check if the given model casts shadows and is flagged as a static caster by its model type.
+   * 
+   * @param model  The model to check.
+   * 
+   * @return Whether the model is a static shadow caster or not.
+   */
+  static bool isStaticCaster(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    const auto &renderFlags = model->getRenderFlags();
+    return renderFlags.isShadowCaster && renderFlags.isStaticCaster;
+  }
 
 public:
   // Preventing copying the model manager, making sure only one instance can exist.
   ModelManager(const ModelManager &) = delete;
 
+  /**
+   * Make room for the given number of models to be registered, e.g. before the models of a scene file are registered in bulk.
+   * 
+   * @param modelsCount  The number of models to make room for.
+   */
+  void reserveModels(const size_t &modelsCount)
+  {
+    registeredModels.reserve(modelsCount);
+  }
+
   /**
    * Register a new model into the model manager.
    * 
    * @param model  The model to register.
+   * 
+   * @return The handle of the model, to de-register and look it up with.
    */
-  void registerModel(const std::shared_ptr<ModelBaseIntf> &&model)
+  RegistryHandle registerModel(const std::shared_ptr<ModelBaseIntf> &&model)
   {
-    // Insert the model to the map of registered models.
-    registeredModels.emplace(model->getModelId(), std::move(model));
-    registeredModelsInsertionOrder.push_back(model->getModelId());
+    // The collision pass running on a worker thread reads the registered colliders.
+    waitForCollisions();
+    // Add the model to the registered models.
+    const auto modelHandle = registeredModels.add(model->getModelId(), model);
+    model->setModelHandle(modelHandle);
+    // Count the model in its model type.
+    if (model->getModelTypeId() >= modelTypeCounts.size())
+    {
+      modelTypeCounts.resize(model->getModelTypeId() + 1, 0);
+    }
+    modelTypeCounts[model->getModelTypeId()]++;
+    if (isStaticCaster(model))
+    {
+      staticCastersCount++;
+    }
+    // Hash the collider of the model into the collision grid.
+    collisionManager.registerModel(model, model->getColliderDetails()->getColliderShape(), model->getCollisionLayer(), model->getCollisionMask(), model->getColliderMotionType());
+    // Add the world AABB of the model to the scene tree for the renderer.
+    sceneTreeManager.registerModel(model.get(), model->getColliderDetails()->getColliderShape().get());
+    // Add the model to the render group of its model type.
+    renderGroupManager.registerModel(model);
+    return modelHandle;
   }
 
   /**
    * De-register an existing model from the model manager.
    * 
-   * @param model  The ID of the model to de-register.
+   * @param modelHandle  The handle of the model to de-register.
    */
-  void deregisterModel(const std::string &modelId)
+  void deregisterModel(const RegistryHandle &modelHandle)
   {
-    // Check if model actually exists. If not, just return since it's not registered.
-    if (std::find(registeredModelsInsertionOrder.begin(), registeredModelsInsertionOrder.end(), modelId) == registeredModelsInsertionOrder.end())
+    // Check if model actually exists. If not, just return since it's not registered (anymore).
+    if (!registeredModels.contains(modelHandle))
     {
       return;
     }
 
-    // Get the model that is registered with the given model ID.
-    auto model = registeredModels[modelId];
-    // Remove the model from the map of registered models.
-    deregisterModel(model);
+    // Remove the model from the collision grid, the scene tree, its render group and the count of its model type, and clear its
+    //   handle (once the collision pass running on a worker thread is done with its collider).
+    waitForCollisions();
+    const auto &model = registeredModels.get(modelHandle);
+    collisionManager.deregisterModel(model.get());
+    sceneTreeManager.deregisterModel(model.get());
+    renderGroupManager.deregisterModel(model.get());
+    modelTypeCounts[model->getModelTypeId()]--;
+    if (isStaticCaster(model))
+    {
+      staticCastersCount--;
+    }
+    model->setModelHandle(INVALID_REGISTRY_HANDLE);
+    // Remove the model from the registered models.
+    registeredModels.remove(modelHandle);
+  }
+
+  /**
+   * De-register an existing model from the model manager, looking it up by its ID (slower than by its handle).
+   * 
+   * @param modelId  The ID of the model to de-register.
+   */
+  void deregisterModel(const std::string &modelId)
+  {
+    deregisterModel(registeredModels.getHandle(modelId));
   }
 
   /**
@@ -85,41 +240,138 @@ public:
    */
   void deregisterModel(const std::shared_ptr<ModelBaseIntf> &model)
   {
-    // Remove the model from the map of registered models.
-    registeredModels.erase(model->getModelId());
-    registeredModelsInsertionOrder.erase(std::remove(registeredModelsInsertionOrder.begin(), registeredModelsInsertionOrder.end(), model->getModelId()), registeredModelsInsertionOrder.end());
+    deregisterModel(model->getModelHandle());
   }
 
   /**
-   * Return the model registered with the given model ID.
+   * Queue the registration of a model, to be applied by the next applyQueuedCommands(). Meant for the models spawned while
+   *   the models are updated or handle collision events.
    * 
-   * @param model  The ID of the model to return.
+   * @param model  The model to register.
+   */
+  void queueRegisterModel(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    queuedCommands.push_back({RegistryCommandType::REGISTER_REGISTRY_COMMAND, model});
+  }
+
+  /**
+   * Queue the de-registration of a model, to be applied by the next applyQueuedCommands(). Meant for the models despawned
+   *   while the models are updated or handle collision events, which stay registered until then.
    * 
-   * @return The model registered with the given model ID.
+   * @param model  The model to de-register.
    */
-  const std::shared_ptr<ModelBaseIntf> &getModel(const std::string &modelId) const
+  void queueDeregisterModel(const std::shared_ptr<ModelBaseIntf> &model)
   {
-    return registeredModels.at(modelId);
+    queuedCommands.push_back({RegistryCommandType::DEREGISTER_REGISTRY_COMMAND, model});
   }
 
   /**
-   * Return the list of all models registered with the model manager.
+   * Check if the de-registration of the given model is queued.
    * 
-   * @return The list of all registered models.
+   * @param model  The model to check.
+   * 
+   * @return Whether the de-registration of the model is queued.
    */
-  const std::vector<std::shared_ptr<ModelBaseIntf>> getAllModels() const
+  bool isDeregistrationQueued(const ModelBaseIntf *model) const
   {
-    // Define a vector to store the list of registered models.
-    std::vector<std::shared_ptr<ModelBaseIntf>> models({});
-    // Iterate through the map of registered models.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    for (const auto &queuedCommand : queuedCommands)
     {
-      // Push each registered model into the models list.
-      models.push_back(registeredModels.find(modelId)->second);
+      if (queuedCommand.type == RegistryCommandType::DEREGISTER_REGISTRY_COMMAND && queuedCommand.entry.get() == model)
+      {
+        return true;
+      }
     }
+    return false;
+  }
+
+  /**
+   * Apply the queued registrations and de-registrations in one batch, in the order they were queued. Meant to be run once
+   *   per frame, after the models are updated and the collision pass is done, while nothing iterates the models.
+   */
+  void applyQueuedCommands()
+  {
+    for (auto &queuedCommand : queuedCommands)
+    {
+      switch (queuedCommand.type)
+      {
+      case RegistryCommandType::REGISTER_REGISTRY_COMMAND:
+        registerModel(std::move(queuedCommand.entry));
+        break;
+      case RegistryCommandType::DEREGISTER_REGISTRY_COMMAND:
+        deregisterModel(queuedCommand.entry);
+        break;
+      }
+    }
+    queuedCommands.clear();
+  }
+
+  /**
+   * Check if a model is registered with the given handle, which stops being the case once the model is de-registered.
+   * 
+   * @param modelHandle  The handle of the model to check.
+   * 
+   * @return Whether a model is registered with the handle.
+   */
+  bool isModelRegistered(const RegistryHandle &modelHandle) const
+  {
+    return registeredModels.contains(modelHandle);
+  }
+
+  /**
+   * Return the model registered with the given handle.
+   * 
+   * @param modelHandle  The handle of the model to return.
+   * 
+   * @return The model registered with the given handle.
+   */
+  const std::shared_ptr<ModelBaseIntf> &getModel(const RegistryHandle &modelHandle) const
+  {
+    return registeredModels.get(modelHandle);
+  }
+
+  /**
+   * Return the model registered with the given ID, for debugging (slower than by its handle).
+   * 
+   * @param modelId  The ID of the model to return.
+   * 
+   * @return The model registered with the given ID.
+   */
+  const std::shared_ptr<ModelBaseIntf> &getModel(const std::string &modelId) const
+  {
+    return registeredModels.get(modelId);
+  }
+
+  /**
+   * Return the number of registered models of the given model type.
+   * 
+   * @param modelTypeId  The ID of the model type (e.g. from ModelBase<T>::getTypeId()).
+   * 
+   * @return The number of registered models of the type.
+   */
+  uint32_t getModelsCount(const ModelTypeId &modelTypeId) const
+  {
+    return modelTypeId < modelTypeCounts.size() ? modelTypeCounts[modelTypeId] : 0;
+  }
 
-    // Return the list of registered models.
-    return models;
+  /**
+   * Return the number of registered models casting shadows flagged as static.
+   * 
+   * @return The number of registered static shadow casters.
+   */
+  const uint32_t &getStaticCastersCount() const
+  {
+    return staticCastersCount;
+  }
+
+  /**
+   * Return a view over all the models registered with the model manager, in their registration order. Models can be registered
+   *   and de-registered while iterating it, but the registered ones are only visited by later iterations.
+   * 
+   * @return The view over the registered models.
+   */
+  Registry<ModelBaseIntf>::View getAllModels() const
+  {
+    return registeredModels.getView();
   }
 
   /**
@@ -127,16 +379,10 @@ public:
    */
   void initAllModels()
   {
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    // Iterate through the registered models.
+    for (const auto &model : registeredModels.getView())
     {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
-      {
-        result->second->init();
-      }
+      model->init();
     }
   }
 
@@ -145,61 +391,278 @@ public:
    */
   void deinitAllModels()
   {
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    // Iterate through the registered models.
+    for (const auto &model : registeredModels.getView())
     {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
+      model->deinit();
+    }
+  }
+
+  /**
+   * Add the given model to the batch of its model type, out of the given batches.
+   * 
+   * @param model    The model.
+   * @param batches  The batches, by the model type IDs.
+   * 
+   * @return Whether the model is the first one of its batch.
+   */
+  static bool addToBatch(ModelBaseIntf *model, std::vector<ModelUpdateBatch> &batches)
+  {
+    const auto &modelTypeId = model->getModelTypeId();
+    if (modelTypeId >= batches.size())
+    {
+      batches.resize(modelTypeId + 1, {nullptr, {}});
+    }
+    auto &batch = batches[modelTypeId];
+    batch.batchUpdate = model->getBatchUpdate();
+    batch.models.push_back(model);
+    return batch.models.size() == 1;
+  }
+
+  /**
+   * Run the update operation on all the registered models, batched by their model types so that each type is dispatched once.
+   *   The thread-safe models are updated in parallel on the job system first, and the other models on the main thread afterwards.
+   */
+  void updateAllModels()
+  {
+    PROFILE_ZONE("Model Update");
+
+    // Send the events of the pipelined collision pass of the last step before the models move again.
+    syncCollisions();
+
+    // Write the model updates of the last frame, from the zone of each model name.
+    auto height = 17.0f;
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this, &height](const std::string &modelName, const ProfilerZoneStats &modelStats) {
+      textManager.beginText(glm::vec2(1, height), 0.5f) << modelName << " Model Object Instances: " << modelStats.itemsCount << " | Update (avg): " << modelStats.getAverageTimeMs() << "ms";
+      height -= 0.5f;
+    });
+
+    // Split the models by whether they can be updated in parallel, keeping the view until all of them are updated so that the
+    //   models de-registered meanwhile are kept alive.
+    const auto models = registeredModels.getView();
+    for (auto &batch : parallelBatches)
+    {
+      batch.models.clear();
+    }
+    for (auto &batch : serialBatches)
+    {
+      batch.models.clear();
+    }
+    serialModelTypeIds.clear();
+    for (const auto &model : models)
+    {
+      if (model->isUpdateThreadSafe())
+      {
+        addToBatch(model.get(), parallelBatches);
+      }
+      else if (addToBatch(model.get(), serialBatches))
+      {
+        serialModelTypeIds.push_back(model->getModelTypeId());
+      }
+    }
+
+    // Split the parallel batches into the ranges run by each job, so that the jobs never mix model types.
+    parallelRanges.clear();
+    for (ModelTypeId i = 0; i < parallelBatches.size(); i++)
+    {
+      for (size_t begin = 0; begin < parallelBatches[i].models.size(); begin += MODEL_UPDATE_JOB_SIZE)
+      {
+        parallelRanges.push_back({i, begin, std::min(begin + MODEL_UPDATE_JOB_SIZE, parallelBatches[i].models.size())});
+      }
+    }
+
+    // Update the thread-safe models in parallel, a range of a batch per job, in the zones of their names nested in the model
+    //   update on whichever thread runs them.
+    const auto modelUpdateZoneId = CpuProfiler::getCurrentZoneId();
+    const auto parallelStartTime = glfwGetTime();
+    jobManager.parallelFor(parallelRanges.size(), 1, [this, &modelUpdateZoneId](const size_t &begin, const size_t &end) {
+      for (auto i = begin; i < end; i++)
+      {
+        const auto &range = parallelRanges[i];
+        const auto &batch = parallelBatches[range.modelTypeId];
+        PROFILE_CHILD_ITEMS_ZONE(modelUpdateZoneId, batch.models[range.begin]->getModelName(), range.end - range.begin);
+        batch.batchUpdate(batch.models.data() + range.begin, range.end - range.begin);
+      }
+    });
+    const auto parallelEndTime = glfwGetTime();
+    parallelUpdateTime = parallelEndTime - parallelStartTime;
+
+    // Update the other models on the main thread, a batch at a time.
+    for (const auto &modelTypeId : serialModelTypeIds)
+    {
+      // Tell the models of the batch to perform an update on themselves, in the zone of their name (entered before the entry of a
+      //   model is cleared, if it de-registers itself while updating).
+      const auto &batch = serialBatches[modelTypeId];
+      PROFILE_ITEMS_ZONE(batch.models.front()->getModelName(), batch.models.size());
+      batch.batchUpdate(batch.models.data(), batch.models.size());
+    }
+    serialUpdateTime = glfwGetTime() - parallelEndTime;
+  }
+
+  /**
+   * Write the text describing how long the last update took, with the time each thread spent updating the models in parallel.
+   * 
+   * @param text  The writer of the text, written the update timing text.
+   */
+  void writeUpdateTiming(TextWriter &text) const
+  {
+    text << "Model Update: " << (parallelUpdateTime + serialUpdateTime) * 1000 << "ms (Main Thread: " << serialUpdateTime * 1000 << "ms, Parallel: " << parallelUpdateTime * 1000 << "ms";
+    // Add the time each thread was busy during the parallel update, and how many jobs it ran.
+    const auto &threadSchedulingManager = ThreadSchedulingManager::getInstance();
+    for (size_t i = 0; i < jobManager.getThreadsCount(); i++)
+    {
+      const auto &threadTiming = jobManager.getThreadTiming(i);
+      text << (i == 0 ? " - T" : ", T") << i << " " << threadTiming.busyTime * 1000 << "ms/" << threadTiming.jobsCount << " jobs";
+      // Add the CPU the thread was last on, and how often the scheduler preempted it.
+      const auto &threadStats = threadSchedulingManager.getJobThreadStats(i);
+      const auto cpu = threadStats.cpu.load(std::memory_order_relaxed);
+      if (cpu >= 0)
       {
-        result->second->deinit();
+        text << " @" << (threadSchedulingManager.isEfficiencyCpu(cpu) ? "E" : "P") << cpu << (threadStats.isPinned.load(std::memory_order_relaxed) ? " pinned" : "") << " " << threadStats.preemptionsCount.load(std::memory_order_relaxed) << " preempted";
       }
     }
+    text << ")";
   }
 
   /**
-   * Run the update operation on all the registered models.
+   * Wait for the collision pass running on a worker thread to finish, keeping its events for the next syncCollisions().
    */
-  void updateAllModels()
+  void waitForCollisions()
   {
-    auto modelNamesCount = std::map<const std::string, int>({});
-    auto modelNamesProcessTime = std::map<const std::string, double>({});
+    if (collisionTask != nullptr)
+    {
+      jobManager.waitForTask(collisionTask);
+    }
+  }
 
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+  /**
+   * Send the collision events found by the last collision pass to the models, once all the pairs are tested, so that the models
+   *   can be de-registered from the event handlers without changing the pass.
+   */
+  void sendCollisionEvents()
+  {
+    // Iterate through the events, the earliest contacts first.
+    for (const auto &collisionEvent : collisionEvents)
     {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
+      // Skip the events of the models de-registered (or queued to be) by the earlier events.
+      if (!collisionManager.isModelRegistered(collisionEvent.model.get()) || !collisionManager.isModelRegistered(collisionEvent.otherModel.get()) ||
+          isDeregistrationQueued(collisionEvent.model.get()) || isDeregistrationQueued(collisionEvent.otherModel.get()))
       {
-        const auto model = result->second;
-        if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
-        {
-          modelNamesCount[model->getModelName()]++;
-        }
-        else
-        {
-          modelNamesCount[model->getModelName()] = 1;
-          modelNamesProcessTime[model->getModelName()] = 0.0f;
-        }
-
-        // If it does, tell the model to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        model->update();
-        const auto endTime = glfwGetTime();
-        modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
+        continue;
+      }
+
+      switch (collisionEvent.type)
+      {
+      case CollisionEventType::COLLISION_ENTER:
+        collisionEvent.model->onCollisionEnter(collisionEvent.otherModel);
+        break;
+      case CollisionEventType::COLLISION_STAY:
+        collisionEvent.model->onCollisionStay(collisionEvent.otherModel);
+        break;
+      case CollisionEventType::COLLISION_EXIT:
+        collisionEvent.model->onCollisionExit(collisionEvent.otherModel);
+        break;
       }
     }
 
-    auto height = 17.0f;
-    for (const auto &modelCounts : modelNamesCount)
+    // Release the models held by the events, so that the de-registered ones are destroyed.
+    collisionEvents.clear();
+  }
+
+  /**
+   * Run the collision pass on all the registered models right away, sending them the collision events.
+   */
+  void updateAllCollisions()
+  {
+    syncCollisions();
+    const auto collisionStartTime = glfwGetTime();
+    collisionManager.updateCollisions(collisionEvents);
+    collisionPassTime = glfwGetTime() - collisionStartTime;
+    sendCollisionEvents();
+  }
+
+  /**
+   * Run the collision pass on all the registered models, on a worker thread if the collisions are pipelined (in which case the
+   *   events are sent by the next syncCollisions(), a simulation step late), or right away otherwise.
+   * The pipelined pass tests the models as they are when it is submitted, so the models must not be moved, registered or
+   *   de-registered until the next syncCollisions(), which the next model update (or registration) starts with. Until then, it
+   *   overlaps the rest of the frame, like the render packet and the rendering.
+   */
+  void submitCollisions()
+  {
+    if (!isCollisionPipelined)
     {
-      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Model Object Instances: " + std::to_string(modelCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      updateAllCollisions();
+      return;
+    }
+
+    // Update the AABBs of the moved models (which generates the transformed AABBs of their colliders) before the pass starts, so
+    //   that the rest of the frame only reads the colliders while the pass runs.
+    syncCollisions();
+    collisionManager.prepareCollisions();
+    collisionTask = jobManager.submitTask([this]() {
+      const auto collisionStartTime = glfwGetTime();
+      collisionManager.updateCollisions(collisionEvents);
+      pipelinedCollisionTime = glfwGetTime() - collisionStartTime;
+    });
+  }
+
+  /**
+   * Wait for the collision pass running on a worker thread, if any, and send its events to the models.
+   */
+  void syncCollisions()
+  {
+    if (collisionTask == nullptr)
+    {
+      return;
     }
+    waitForCollisions();
+    collisionTask = nullptr;
+    collisionPassTime = pipelinedCollisionTime;
+    sendCollisionEvents();
+  }
+
+  /**
+   * Get the time the last collision pass whose events were sent took, measured on the thread it ran on (the worker thread for
+   *   the pipelined passes, whose time is published along with their events by syncCollisions()).
+   * 
+   * @return The time of the collision pass (in seconds).
+   */
+  const double_t &getCollisionPassTime() const
+  {
+    return collisionPassTime;
+  }
+
+  /**
+   * Check whether the collision passes run on a worker thread, their events sent a simulation step late.
+   * 
+   * @return Whether the collisions are pipelined.
+   */
+  const bool &isCollisionPipelineEnabled() const
+  {
+    return isCollisionPipelined;
+  }
+
+  /**
+   * Set whether the collision passes run on a worker thread, their events sent a simulation step late, or right away for the
+   *   gameplay that needs the hits in the same step. The collision pass running on a worker thread is synced first.
+   * 
+   * @param isPipelined  Whether the collisions are pipelined.
+   */
+  void setCollisionPipelined(const bool &isPipelined)
+  {
+    syncCollisions();
+    isCollisionPipelined = isPipelined;
+  }
+
+  /**
+   * Switch the memory resource the registered models are kept in, e.g. to the arena of the scene. Must not be called while the models are iterated.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    registeredModels.setMemoryResource(memoryResource);
   }
 
   /**
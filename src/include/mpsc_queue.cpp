@@ -0,0 +1,115 @@
+#ifndef INCLUDE_MPSC_QUEUE_CPP
+#define INCLUDE_MPSC_QUEUE_CPP
+
+#include <array>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+
+/**
+ * Class for handing items from any number of threads to a single consumer thread without a lock, in a ring of a fixed number of
+ *   slots. Each slot has a sequence number telling whether it is free for the producer of a position or filled for the consumer,
+ *   so the producers only race for the positions (with a compare-and-swap), and never wait for each other.
+ * Pushing fails when every slot is filled, so the producers need a way out for when the consumer falls behind.
+ */
+template <typename T, size_t N>
+class MpscQueue
+{
+private:
+  static_assert(N > 0 && (N & (N - 1)) == 0, "MpscQueue needs a power of two of slots");
+
+  /**
+   * Structure for defining a slot of the ring.
+   */
+  struct Slot
+  {
+    // The position the slot is free for (the position itself), or filled for (the position plus one).
+    std::atomic<size_t> sequence;
+    // The item in the slot, only valid while the slot is filled.
+    T item;
+  };
+
+  // The slots of the ring.
+  std::array<Slot, N> slots;
+  // The position the next item is pushed to, shared by the producers (on its own cache line, away from the consumer).
+  alignas(64) std::atomic<size_t> pushPosition;
+  // The position the next item is popped from, only changed by the consumer.
+  alignas(64) size_t popPosition;
+
+public:
+  MpscQueue()
+      : pushPosition(0),
+        popPosition(0)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Preventing copying the queue, since the producers point at it.
+  MpscQueue(const MpscQueue &) = delete;
+
+  /**
+   * Push an item from any thread, if there is a free slot.
+   * 
+   * @param item  The item, only moved from if it is pushed.
+   * 
+   * @return Whether the item was pushed, which fails if every slot is filled.
+   */
+  bool tryPush(T &item)
+  {
+    auto position = pushPosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+      auto &slot = slots[position & (N - 1)];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+      if (difference == 0)
+      {
+        // The slot is free for the position, so take the position unless another producer took it first.
+        if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          slot.item = std::move(item);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        // The slot still holds the item of the position a lap before, which the consumer has not popped yet.
+        return false;
+      }
+      else
+      {
+        // Another producer took the position, so try the next one.
+        position = pushPosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Pop the oldest item, from the consumer thread only.
+   * 
+   * @param item  The item to move the popped one into.
+   * 
+   * @return Whether an item was popped, which fails if the queue is empty (or the oldest item is still being pushed).
+   */
+  bool tryPop(T &item)
+  {
+    auto &slot = slots[popPosition & (N - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != popPosition + 1)
+    {
+      return false;
+    }
+    item = std::move(slot.item);
+    // Leave the slot without the item, so that what it holds on to is released now rather than a lap later.
+    slot.item = T();
+    // Free the slot for the position a lap later.
+    slot.sequence.store(popPosition + N, std::memory_order_release);
+    popPosition++;
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef INCLUDE_NAME_INTERNER_CPP
+#define INCLUDE_NAME_INTERNER_CPP
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <mutex>
+#include <cstdint>
+
+#include "flat_hash_map.cpp"
+
+// The ID of an interned name, the same for every interning of the same name for the lifetime of the program.
+typedef uint32_t NameId;
+
+/**
+ * A manager class for interning the names of the assets and the models, so that they can be kept and compared as 32-bit IDs
+ *   instead of strings, e.g. as the keys of the named assets of the managers. The names are never forgotten, so an ID stays
+ *   valid for the lifetime of the program.
+ * Names can be interned from any thread.
+ */
+class NameInterner
+{
+private:
+  // Singleton instance of the name interner.
+  static NameInterner instance;
+
+  // The interned names, by their IDs (a deque, so that the IDs by name can point into them).
+  std::deque<std::string> names;
+  // The ID of each interned name, pointing into the interned names.
+  FlatHashMap<std::string_view, NameId> nameIds;
+  // The mutex guarding the interned names, since the assets are named from the worker threads as well.
+  mutable std::mutex namesMutex;
+
+  NameInterner()
+      : names(),
+        nameIds(),
+        namesMutex() {}
+
+public:
+  // Preventing copying the name interner, making sure only one instance can exist.
+  NameInterner(const NameInterner &) = delete;
+
+  /**
+   * Get the ID of the given name, interning it if it was not interned yet.
+   * 
+   * @param name  The name.
+   * 
+   * @return The ID of the name.
+   */
+  NameId intern(const std::string_view &name)
+  {
+    const std::lock_guard<std::mutex> lock(namesMutex);
+    const auto nameId = nameIds.find(name);
+    if (nameId != nameIds.end())
+    {
+      return nameId->second;
+    }
+
+    names.emplace_back(name);
+    const auto newNameId = static_cast<NameId>(names.size() - 1);
+    nameIds.emplace(names.back(), newNameId);
+    return newNameId;
+  }
+
+  /**
+   * Get the name of the given ID.
+   * 
+   * @param nameId  The ID of an interned name.
+   * 
+   * @return The name, which stays valid for the lifetime of the program.
+   */
+  const std::string &getName(const NameId &nameId) const
+  {
+    const std::lock_guard<std::mutex> lock(namesMutex);
+    return names[nameId];
+  }
+
+  /**
+   * Returns the singleton instance of the name interner.
+   * 
+   * @return The name interner singleton instance.
+   */
+  static NameInterner &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the name interner singleton instance static variable.
+NameInterner NameInterner::instance;
+
+#endif
@@ -1,18 +1,68 @@
 #ifndef INCLUDE_OBJECT_CPP
 #define INCLUDE_OBJECT_CPP
 
+#include <array>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cmath>
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "constants.cpp"
+#include "common.cpp"
+#include "mapped_file.cpp"
+#include "asset_archive.cpp"
+#include "residency_cache.cpp"
+#include "job.cpp"
+#include "gpu_memory.cpp"
+#include "gl_debug.cpp"
+#include "mesh_simplifier.cpp"
+#include "mesh_optimizer.cpp"
+#include "asset_manifest.cpp"
+#include "name_interner.cpp"
+#include "asset_registry.cpp"
+#include "collider.cpp"
+#include "startup_timer.cpp"
+#include "gpu_deletion.cpp"
+
+/**
+ * Enum of supported vertex formats of objects.
+ */
+enum VertexFormat
+{
+	// Separate float buffers for the positions, UV coordinates and normal vectors (32 bytes per vertex).
+	SEPARATE_FLOAT,
+	// A single interleaved buffer of float positions, normalized 16-bit UV coordinates and 10-bit normal vectors (20 bytes per vertex).
+	INTERLEAVED_FLOAT,
+	// A single interleaved buffer of half float positions, normalized 16-bit UV coordinates and 10-bit normal vectors (16 bytes per vertex).
+	INTERLEAVED_HALF
+};
+
+/**
+ * Structure for defining a level of detail of an object, as a range of the indices in its element buffer. All the levels
+ *   refer to the same vertices, so that they are drawn with the same vertex array object.
+ */
+struct ObjectLod
+{
+	// The index of the first index of the level in the element buffer.
+	uint32_t indexOffset;
+	// The number of indices of the level (three per triangle).
+	uint32_t indexCount;
+};
 
 /**
  * Class for containing the details of the object.
@@ -27,35 +77,86 @@ private:
 	const std::string objectName;
 	// The file path to the object data.
 	const std::string objectFilePath;
+	// The format the vertices of the object are stored in.
+	const VertexFormat vertexFormat;
 
 	// The list of vertices of the object.
 	const std::vector<glm::vec3> vertices;
 
-	// The ID of the array buffer containing the vertex position data of the object.
+	// The ID of the array buffer containing the vertex position data of the object (or all the vertex data, if interleaved).
 	const GLuint vertexBufferId;
-	// The ID of the array buffer containing the vertex UV coordinates data of the object.
+	// The ID of the array buffer containing the vertex UV coordinates data of the object (0 if interleaved).
 	const GLuint uvBufferId;
-	// The ID of the array buffer containing the vertex normal vector data of the object.
+	// The ID of the array buffer containing the vertex normal vector data of the object (0 if interleaved).
 	const GLuint normalBufferId;
-	// The size of the buffer/number of vertices of the object.
-	const uint32_t bufferSize;
+	// The ID of the element buffer containing the indices of the vertices of each triangle of the object.
+	const GLuint indexBufferId;
+	// The ID of the vertex array object describing the vertex attributes of the object.
+	const GLuint vertexArrayId;
+	// The number of unique vertices of the object.
+	const uint32_t vertexCount;
+	// The number of indices of the object at full detail (three per triangle).
+	const uint32_t indexCount;
+	// The levels of detail of the object, from the full detail one to the most simplified one.
+	const std::array<ObjectLod, OBJECT_LOD_COUNT> lods;
+	// The number of levels of detail of the object (1 if it was not simplified).
+	const uint32_t lodsCount;
+
+	// The corner of the bounding box of the vertices with the smallest coordinates.
+	const glm::vec3 minCorner;
+	// The corner of the bounding box of the vertices with the largest coordinates.
+	const glm::vec3 maxCorner;
+	// The distance of the farthest vertex from the origin of the object.
+	const float_t boundingRadius;
+	// The distance of the farthest vertex from the y-axis of the object.
+	const float_t axialRadius;
+	// The extents of the colliders of every shape fitting the object, shared by the colliders of all its instances.
+	const ColliderPrototype colliderPrototype;
+	// The average cache miss ratios of the full detail triangles in the order of the OBJ file and once reordered for drawing.
+	const float_t originalAcmr;
+	const float_t optimizedAcmr;
 
 public:
 	ObjectDetails(
 			const std::string &objectName,
 			const std::string &objectFilePath,
-			const std::vector<glm::vec3> &vertices,
+			const VertexFormat &vertexFormat,
+			std::vector<glm::vec3> vertices,
 			const GLuint &vertexBufferId,
 			const GLuint &uvBufferId,
 			const GLuint &normalBufferId,
-			const uint32_t &bufferCount)
+			const GLuint &indexBufferId,
+			const GLuint &vertexArrayId,
+			const uint32_t &vertexCount,
+			const uint32_t &indexCount,
+			const std::array<ObjectLod, OBJECT_LOD_COUNT> &lods,
+			const uint32_t &lodsCount,
+			const glm::vec3 &minCorner,
+			const glm::vec3 &maxCorner,
+			const float_t &boundingRadius,
+			const float_t &axialRadius,
+			const float_t &originalAcmr,
+			const float_t &optimizedAcmr)
 			: objectName(objectName),
 				objectFilePath(objectFilePath),
-				vertices(vertices),
+				vertexFormat(vertexFormat),
+				vertices(std::move(vertices)),
 				vertexBufferId(vertexBufferId),
 				uvBufferId(uvBufferId),
 				normalBufferId(normalBufferId),
-				bufferSize(bufferCount) {}
+				indexBufferId(indexBufferId),
+				vertexArrayId(vertexArrayId),
+				vertexCount(vertexCount),
+				indexCount(indexCount),
+				lods(lods),
+				lodsCount(lodsCount),
+				minCorner(minCorner),
+				maxCorner(maxCorner),
+				boundingRadius(boundingRadius),
+				axialRadius(axialRadius),
+				colliderPrototype(ColliderPrototype::create(minCorner, maxCorner, boundingRadius, axialRadius)),
+				originalAcmr(originalAcmr),
+				optimizedAcmr(optimizedAcmr) {}
 
 	/**
    * Get the name of the object.
@@ -68,9 +169,19 @@ public:
 	}
 
 	/**
-   * Get the list of vertices of the object.
+   * Get the format the vertices of the object are stored in.
+   * 
+   * @return The vertex format.
+   */
+	const VertexFormat &getVertexFormat() const
+	{
+		return vertexFormat;
+	}
+
+	/**
+   * Get the list of vertices of the object, which are only kept once it is uploaded if IS_OBJECT_GEOMETRY_KEPT is set.
    * 
-   * @return The object vertices.
+   * @return The object vertices (empty if they were not kept).
    */
 	const std::vector<glm::vec3> &getVertices() const
 	{
@@ -108,13 +219,163 @@ public:
 	}
 
 	/**
-   * Get the size of the buffer/number of vertices of the object.
+   * Get the ID of the vertex array object describing the vertex attributes of the object.
+   * Binding it is all that is needed to draw the object, other than the per-instance attributes.
+   * 
+   * @return The vertex array object ID.
+   */
+	const GLuint &getVertexArrayId() const
+	{
+		return vertexArrayId;
+	}
+
+	/**
+   * Get the element buffer ID of the object vertex indices.
+   * 
+   * @return The element buffer ID.
+   */
+	const GLuint &getIndexBufferId() const
+	{
+		return indexBufferId;
+	}
+
+	/**
+   * Get the number of unique vertices of the object.
    * 
    * @return The number of vertices.
    */
-	const uint32_t &getBufferSize() const
+	const uint32_t &getVertexCount() const
+	{
+		return vertexCount;
+	}
+
+	/**
+   * Get the number of indices of the object, which is the number of vertices drawn (three per triangle).
+   * 
+   * @return The number of indices.
+   */
+	const uint32_t &getIndexCount() const
+	{
+		return indexCount;
+	}
+
+	/**
+   * Get the number of levels of detail of the object.
+   * 
+   * @return The number of levels, 1 if the object was not simplified.
+   */
+	const uint32_t &getLodsCount() const
+	{
+		return lodsCount;
+	}
+
+	/**
+   * Get a level of detail of the object.
+   * 
+   * @param lodIndex  The index of the level, clamped to the most simplified one (0 for the full detail).
+   * 
+   * @return The range of the indices of the level.
+   */
+	const ObjectLod &getLod(const uint32_t &lodIndex) const
+	{
+		return lods[std::min(lodIndex, lodsCount - 1)];
+	}
+
+	/**
+   * Select the level of detail to draw the object with at the given projected size.
+   * 
+   * @param screenSize  The diameter of the model as a share of the height of the view.
+   * 
+   * @return The index of the level, 0 for the full detail.
+   */
+	uint32_t selectLod(const float_t &screenSize) const
+	{
+		uint32_t lodIndex = 0;
+		while (lodIndex + 1 < lodsCount && screenSize < OBJECT_LOD_SCREEN_SIZES[lodIndex])
+		{
+			lodIndex++;
+		}
+		return lodIndex;
+	}
+
+	/**
+   * Get the number of indices of all the levels of detail of the object, which are stored one after the other.
+   * 
+   * @return The number of indices in the element buffer.
+   */
+	uint32_t getTotalIndexCount() const
 	{
-		return bufferSize;
+		return lods[lodsCount - 1].indexOffset + lods[lodsCount - 1].indexCount;
+	}
+
+	/**
+   * Get the corner of the bounding box of the vertices of the object with the smallest coordinates.
+   * 
+   * @return The min-corner of the bounding box.
+   */
+	const glm::vec3 &getMinCorner() const
+	{
+		return minCorner;
+	}
+
+	/**
+   * Get the corner of the bounding box of the vertices of the object with the largest coordinates.
+   * 
+   * @return The max-corner of the bounding box.
+   */
+	const glm::vec3 &getMaxCorner() const
+	{
+		return maxCorner;
+	}
+
+	/**
+   * Get the distance of the farthest vertex of the object from its origin.
+   * 
+   * @return The bounding radius.
+   */
+	const float_t &getBoundingRadius() const
+	{
+		return boundingRadius;
+	}
+
+	/**
+   * Get the distance of the farthest vertex of the object from its y-axis.
+   * 
+   * @return The axial radius.
+   */
+	const float_t &getAxialRadius() const
+	{
+		return axialRadius;
+	}
+
+	/**
+   * Get the extents of the colliders of every shape fitting the object, to create the colliders of its instances with.
+   * 
+   * @return The collider prototype.
+   */
+	const ColliderPrototype &getColliderPrototype() const
+	{
+		return colliderPrototype;
+	}
+
+	/**
+   * Get the average cache miss ratio of the full detail triangles of the object in the order of its OBJ file.
+   * 
+   * @return The vertices transformed per triangle through the simulated post-transform vertex cache.
+   */
+	const float_t &getOriginalAcmr() const
+	{
+		return originalAcmr;
+	}
+
+	/**
+   * Get the average cache miss ratio of the full detail triangles of the object in the order they are drawn in.
+   * 
+   * @return The vertices transformed per triangle through the simulated post-transform vertex cache.
+   */
+	const float_t &getOptimizedAcmr() const
+	{
+		return optimizedAcmr;
 	}
 };
 
@@ -124,23 +385,171 @@ public:
 class ObjectManager
 {
 private:
+	/**
+	 * Structure for identifying a unique vertex of an OBJ file by the indices of its position, UV coordinates and normal vector.
+	 */
+	struct ObjVertexKey
+	{
+		uint32_t vertexIndex;
+		uint32_t uvIndex;
+		uint32_t normalIndex;
+
+		bool operator==(const ObjVertexKey &other) const
+		{
+			return vertexIndex == other.vertexIndex && uvIndex == other.uvIndex && normalIndex == other.normalIndex;
+		}
+	};
+
+	/**
+	 * Structure for hashing the unique vertex keys of an OBJ file.
+	 */
+	struct ObjVertexKeyHash
+	{
+		size_t operator()(const ObjVertexKey &key) const
+		{
+			// Combine the indices with large odd multipliers, so that nearby indices spread across the buckets.
+			return (static_cast<size_t>(key.vertexIndex) * 73856093u) ^ (static_cast<size_t>(key.uvIndex) * 19349663u) ^ (static_cast<size_t>(key.normalIndex) * 83492791u);
+		}
+	};
+
+	/**
+	 * Structure for storing the vertex information and triangle corners read from a line-aligned chunk of an OBJ file.
+	 */
+	struct ObjChunk
+	{
+		// The vertex positions defined in the chunk.
+		std::vector<glm::vec3> vertices;
+		// The vertex UV coordinates defined in the chunk.
+		std::vector<glm::vec2> uvs;
+		// The vertex normal vectors defined in the chunk.
+		std::vector<glm::vec3> normals;
+		// The corners of the triangles defined in the chunk (three per triangle).
+		std::vector<ObjVertexKey> corners;
+		// Whether the chunk contains a face that is not formatted in a supported way.
+		bool hasUnsupportedFace;
+	};
+
+	// The smallest number of bytes of an OBJ file given to each parsing thread, so that small files are not split needlessly.
+	static constexpr size_t MIN_OBJ_CHUNK_SIZE = 256 * 1024;
+	// The largest number of threads parsing a single OBJ file.
+	static constexpr uint32_t MAX_OBJ_PARSE_THREADS = 8;
+
+	/**
+	 * Structure for defining the header of a binary mesh cache file.
+	 * The header is followed by the vertex stream (in the layout of the vertex format), the index stream (with the levels of
+	 *   detail one after the other), and the float positions of the unique vertices, for the objects keeping their geometry.
+	 */
+	struct MeshCacheHeader
+	{
+		// The magic number identifying mesh cache files.
+		uint32_t magic;
+		// The version of the mesh cache layout.
+		uint32_t version;
+		// The vertex format that the object was requested in.
+		uint32_t requestedVertexFormat;
+		// The vertex format that the vertex stream is stored in.
+		uint32_t vertexFormat;
+		// The number of unique vertices of the object.
+		uint32_t vertexCount;
+		// The number of indices of the object, of all the levels of detail.
+		uint32_t indexCount;
+		// The size of the vertex stream in bytes.
+		uint64_t vertexStreamSize;
+		// The size of the source OBJ file the cache was created from.
+		uint64_t sourceFileSize;
+		// The last modification time of the source OBJ file the cache was created from.
+		int64_t sourceModifiedTime;
+		// The min-corner of the bounding box of the vertices.
+		glm::vec3 minCorner;
+		// The max-corner of the bounding box of the vertices.
+		glm::vec3 maxCorner;
+		// The distance of the farthest vertex from the origin.
+		float_t boundingRadius;
+		// The number of indices of each level of detail (0 for the levels the object does not have).
+		uint32_t lodIndexCounts[OBJECT_LOD_COUNT];
+		// The average cache miss ratios of the full detail triangles in the order of the OBJ file and once reordered.
+		float_t originalAcmr;
+		float_t optimizedAcmr;
+		// The distance of the farthest vertex from the y-axis.
+		float_t axialRadius;
+	};
+	// Make sure the header has the same layout on every platform, since it is read straight from the file.
+	static_assert(sizeof(MeshCacheHeader) == 80 + (4 * ((OBJECT_LOD_COUNT + 3) / 2 * 2)), "MeshCacheHeader does not have the expected layout");
+
+	/**
+	 * Structure for storing the data of an object that was read and parsed, but not uploaded yet.
+	 * Preparing this data does not need the GL context, so it can be done on worker threads.
+	 */
+	struct PreparedObject
+	{
+		// The format the vertex stream is stored in.
+		VertexFormat vertexFormat;
+		// The number of unique vertices of the object.
+		uint32_t vertexCount;
+		// The unique vertex positions of the object (only read from the mesh cache if the objects keep their geometry, and
+		//   released once the cache is written otherwise).
+		std::vector<glm::vec3> vertices;
+		// The number of indices of the object, of all the levels of detail.
+		uint32_t indexCount;
+		// The number of indices of each level of detail (0 for the levels the object does not have).
+		std::array<uint32_t, OBJECT_LOD_COUNT> lodIndexCounts;
+		// The min-corner of the bounding box of the vertices.
+		glm::vec3 minCorner;
+		// The max-corner of the bounding box of the vertices.
+		glm::vec3 maxCorner;
+		// The distance of the farthest vertex from the origin.
+		float_t boundingRadius;
+		// The distance of the farthest vertex from the y-axis.
+		float_t axialRadius;
+		// The average cache miss ratios of the full detail triangles in the order of the OBJ file and once reordered.
+		float_t originalAcmr;
+		float_t optimizedAcmr;
+		// The mapped mesh cache file that the streams point into (null if the object was parsed from the OBJ file).
+		std::unique_ptr<AssetFile> cacheFile;
+		// The vertex stream and indices parsed from the OBJ file (empty if the object was read from the mesh cache).
+		std::vector<uint8_t> parsedVertexStream;
+		std::vector<uint32_t> parsedIndices;
+		// The start of the vertex stream to upload.
+		const uint8_t *vertexStream;
+		// The start of the indices to upload.
+		const uint8_t *indexStream;
+	};
+
+	// The magic number identifying mesh cache files ("MESH" when read as characters).
+	static constexpr uint32_t MESH_CACHE_MAGIC = 0x4853454D;
+	// The version of the mesh cache layout, to be increased whenever the layout or the packing of any vertex format changes.
+	static constexpr uint32_t MESH_CACHE_VERSION = 4;
+	// The extension appended to the OBJ file path to get the path of its mesh cache file.
+	static constexpr const char *MESH_CACHE_FILE_EXTENSION = ".meshcache";
+
 	// Singleton instance of the object manager.
 	static ObjectManager instance;
 
-	// A map of created objects.
-	std::map<const std::string, const std::shared_ptr<const ObjectDetails>> namedObjects;
-	// A map counting the references to the created objects.
-	std::map<const std::string, int32_t> namedObjectReferences;
+	// The name interner the names of the created objects are interned with.
+	NameInterner &nameInterner;
+	// The registry of the created objects and their reference counts, by their interned names (looked up from any thread).
+	AssetRegistry<const ObjectDetails> namedObjects;
+	// A map of the objects being prepared on worker threads, waiting to be created.
+	std::map<const std::string, JobFuture<std::shared_ptr<PreparedObject>>> preparingObjects;
+	// The cache keeping the objects without references alive, so that the next scene using them does not load them again.
+	ResidencyCache residencyCache;
+	// The GPU memory manager the buffers of the objects are accounted in.
+	GpuMemoryManager &gpuMemoryManager;
+	// The GL debug manager the buffers and the vertex arrays of the objects are labeled with.
+	const GlDebugManager &glDebugManager;
+	// The GPU deletion queue the buffers and the vertex arrays of the destroyed objects are retired to.
+	GpuDeletionQueue &gpuDeletionQueue;
 
 	/**
-	 * Create a array buffer of the given vector type, and store data as static draw use.
+	 * Create a array buffer, and store the given data as static draw use.
 	 * 
-	 * @param bufferData  The data to store in the buffer.
+	 * @param objectName  The name of the object the buffer is for, which its GPU memory is accounted to.
+	 * @param bufferData  The pointer to the data to store in the buffer.
+	 * @param bufferSize  The size of the data in bytes.
 	 * 
 	 * @return The ID of the array buffer.
 	 */
-	template <typename VecType>
-	GLuint createBuffer(const std::vector<VecType> &bufferData)
+	GLuint createBuffer(const std::string &objectName, const void *bufferData, const GLsizeiptr &bufferSize)
 	{
 		// Define a variable for storing the buffer ID.
 		GLuint bufferId;
@@ -149,278 +558,1173 @@ private:
 		// Bind the buffer as an array buffer.
 		glBindBuffer(GL_ARRAY_BUFFER, bufferId);
 		// Store the data into the array buffer, with usage set as static draw (won't be modified, and will be used for drawing repeatedly).
-		glBufferData(GL_ARRAY_BUFFER, bufferData.size() * sizeof(VecType), &bufferData[0], GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, bufferSize, bufferData, GL_STATIC_DRAW);
 		// Unbind the buffer now that we're done.
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// Account the memory of the buffer to the object, and label the buffer with its name.
+		gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::MESH, objectName, bufferSize);
+		glDebugManager.labelObject(GL_BUFFER, bufferId, objectName);
 		// Return the ID of the created array buffer.
 		return bufferId;
 	}
 
 	/**
-	 * Load the OBJ object file and create array buffers for it.
+	 * Create a array buffer of the given vector type, and store data as static draw use.
 	 * 
-	 * @param objectName      The name of the object being loaded.
-	 * @param objectFilePath  The file path to the object data.
-	 * @param outVertices     The vector to store the object vertices to.
+	 * @param objectName  The name of the object the buffer is for, which its GPU memory is accounted to.
+	 * @param bufferData  The data to store in the buffer.
 	 * 
-	 * @return The number of vertices in the object.
+	 * @return The ID of the array buffer.
 	 */
-	uint32_t loadObjObject(const std::string &objectName, const std::string &objectFilePath, std::vector<glm::vec3> &outVertices, GLuint *const vertexBufferId, GLuint *const uvBufferId, GLuint *const normalBufferId)
+	template <typename VecType>
+	GLuint createBuffer(const std::string &objectName, const std::vector<VecType> &bufferData)
 	{
-		// Define vectors for storing the indices to the vertex information.
-		std::vector<uint32_t> vertexIndices, uvIndices, normalIndices;
-		// Define temporary vectors for storing the vertex information stored in the OBJ file.
-		std::vector<glm::vec3> tempVertices;
-		std::vector<glm::vec2> tempUvs;
-		std::vector<glm::vec3> tempNormals;
+		return createBuffer(objectName, &bufferData[0], bufferData.size() * sizeof(VecType));
+	}
 
-		// Define vectors for storing the final list of vertex information of the object in order of their use for each triangle.
-		std::vector<glm::vec2> outUvs;
-		std::vector<glm::vec3> outNormals;
+	/**
+	 * Get the size of the positions of a single vertex in the interleaved array buffer of the given vertex format.
+	 * 
+	 * @param vertexFormat  The interleaved vertex format.
+	 * 
+	 * @return The size of the positions in bytes (half float positions are padded to keep the rest aligned).
+	 */
+	static GLsizei getInterleavedPositionSize(const VertexFormat &vertexFormat)
+	{
+		return vertexFormat == INTERLEAVED_HALF ? 4 * sizeof(uint16_t) : 3 * sizeof(float_t);
+	}
 
-		// Open the OBJ file.
-		const auto file = fopen(objectFilePath.c_str(), "r");
-		// Check if the file is accessible.
-		if (file == NULL)
+	/**
+	 * Get the size of a single vertex in the interleaved array buffer of the given vertex format.
+	 * 
+	 * @param vertexFormat  The interleaved vertex format.
+	 * 
+	 * @return The size of a vertex in bytes.
+	 */
+	static GLsizei getInterleavedVertexSize(const VertexFormat &vertexFormat)
+	{
+		// The positions are followed by the packed UV coordinates and the packed normal vector.
+		return getInterleavedPositionSize(vertexFormat) + sizeof(uint32_t) + sizeof(uint32_t);
+	}
+
+	/**
+	 * Get the size of the vertex stream of the given number of vertices stored in the given vertex format.
+	 * 
+	 * @param vertexFormat  The vertex format.
+	 * @param vertexCount   The number of vertices.
+	 * 
+	 * @return The size of the vertex stream in bytes.
+	 */
+	static uint64_t getVertexStreamSize(const VertexFormat &vertexFormat, const uint32_t &vertexCount)
+	{
+		if (vertexFormat == SEPARATE_FLOAT)
 		{
-			// Could not read the object file. Time to crash.
-			std::cout << objectName << std::endl
-								<< "Failed at object 1" << std::endl;
-			exit(1);
+			// The float positions, UV coordinates and normal vectors are stored one after the other.
+			return static_cast<uint64_t>(vertexCount) * (sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3));
 		}
+		return static_cast<uint64_t>(vertexCount) * getInterleavedVertexSize(vertexFormat);
+	}
 
-		// Keep reading the file until we hit a condition.
-		while (1)
+	/**
+	 * Create the vertex stream of the given vertex information, quantized as defined by the given vertex format.
+	 * 
+	 * @param vertexFormat  The vertex format.
+	 * @param vertices      The vertex positions.
+	 * @param uvs           The vertex UV coordinates (must be between 0 and 1 for interleaved formats).
+	 * @param normals       The vertex normal vectors.
+	 * 
+	 * @return The bytes of the vertex stream.
+	 */
+	static std::vector<uint8_t> createVertexStream(const VertexFormat &vertexFormat, const std::vector<glm::vec3> &vertices, const std::vector<glm::vec2> &uvs, const std::vector<glm::vec3> &normals)
+	{
+		// Define a vector for storing the bytes of the vertex stream.
+		std::vector<uint8_t> streamData(getVertexStreamSize(vertexFormat, vertices.size()));
+		if (streamData.empty())
 		{
-			// Define a variable for storing the first string in a line
-			char lineHeader[128];
-			// Read a string from the file.
-			int32_t res = fscanf(file, "%s", lineHeader);
-			// Check if we hit the end of the file.
-			if (res == EOF)
-			{
-				// Completed reading the file. So break out of the loop.
-				break;
-			}
+			return streamData;
+		}
 
-			// If the string equals "v".
-			if (strcmp(lineHeader, "v") == 0)
-			{
-				// Line defines a vertex position data.
-				// Define a variable for storing the vertex position.
-				glm::vec3 vertex;
-				// Read the position coordinates of the vertex from the file.
-				fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-				// Store it in the temporary vertex position vector.
-				tempVertices.push_back(vertex);
-			}
-			// If the string equals "vt".
-			else if (strcmp(lineHeader, "vt") == 0)
-			{
-				// Line defines a vertex UV coordinates data.
-				// Define a variable for storing the vertex UV coordinates.
-				glm::vec2 uv;
-				// Read the UV coordinates of the vertex from the file.
-				fscanf(file, "%f %f\n", &uv.x, &uv.y);
-				// Store it in the temporary vertex UV coordinates vector.
-				tempUvs.push_back(uv);
-			}
-			// If the string equals "vt".
-			else if (strcmp(lineHeader, "vn") == 0)
-			{
-				// Line defines a vertex normal vector data.
-				// Define a variable for storing the vertex normal vector.
-				glm::vec3 normal;
-				// Read the normal vector of the vertex from the file.
-				fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-				// Store it in the temporary vertex normal vector vector.
-				tempNormals.push_back(normal);
-			}
-			// If the string equals "f".
-			else if (strcmp(lineHeader, "f") == 0)
-			{
-				// Line defines the indexes of the vertex information that describes a single face/polygon of the object.
-				// Define a variable for storing the indices to the vertex information stored in the temp vectors.
-				uint32_t vertexIndex[4], uvIndex[4], normalIndex[4];
+		if (vertexFormat == SEPARATE_FLOAT)
+		{
+			// Store the positions, UV coordinates and normal vectors one after the other, as they are.
+			auto streamPointer = &streamData[0];
+			memcpy(streamPointer, &vertices[0], vertices.size() * sizeof(glm::vec3));
+			streamPointer += vertices.size() * sizeof(glm::vec3);
+			memcpy(streamPointer, &uvs[0], uvs.size() * sizeof(glm::vec2));
+			streamPointer += uvs.size() * sizeof(glm::vec2);
+			memcpy(streamPointer, &normals[0], normals.size() * sizeof(glm::vec3));
+			return streamData;
+		}
 
-				// Read the indices to the vertex information.
-				int32_t matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2], &vertexIndex[3], &uvIndex[3], &normalIndex[3]);
-				if (matches == 12)
-				{
-					// Push the vertex position indices of the face/polygon into the vertex position vector.
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[1]);
-					vertexIndices.push_back(vertexIndex[2]);
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[2]);
-					vertexIndices.push_back(vertexIndex[3]);
-
-					// Push the vertex UV coordinates indices of the face/polygon into the vertex UV coordinates vector.
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[1]);
-					uvIndices.push_back(uvIndex[2]);
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[2]);
-					uvIndices.push_back(uvIndex[3]);
-
-					// Push the vertex normal vector indices of the face/polygon into the vertex normal vector vector.
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[1]);
-					normalIndices.push_back(normalIndex[2]);
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[2]);
-					normalIndices.push_back(normalIndex[3]);
-				}
-				else if (matches == 9)
-				{
-					// Push the vertex position indices of the face/polygon into the vertex position vector.
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[1]);
-					vertexIndices.push_back(vertexIndex[2]);
-
-					// Push the vertex UV coordinates indices of the face/polygon into the vertex UV coordinates vector.
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[1]);
-					uvIndices.push_back(uvIndex[2]);
-
-					// Push the vertex normal vector indices of the face/polygon into the vertex normal vector vector.
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[1]);
-					normalIndices.push_back(normalIndex[2]);
-				}
-				else
-				{
-					// If we don't manage to read all nine coordinates, then this OBJ file is formatted in a way that we can't support. Close the file and time to crash.
-					fclose(file);
-					std::cout << objectName << std::endl
-										<< "Failed at object 2" << std::endl;
-					exit(1);
-				}
+		const auto positionSize = getInterleavedPositionSize(vertexFormat);
+		const auto vertexSize = getInterleavedVertexSize(vertexFormat);
+		for (uint32_t i = 0; i < vertices.size(); i++)
+		{
+			auto vertexData = &streamData[i * vertexSize];
+
+			// Store the position as floats, or as half floats with a zero padding.
+			if (vertexFormat == INTERLEAVED_HALF)
+			{
+				const uint16_t position[4] = {glm::packHalf1x16(vertices[i].x), glm::packHalf1x16(vertices[i].y), glm::packHalf1x16(vertices[i].z), 0};
+				memcpy(vertexData, position, positionSize);
 			}
 			else
 			{
-				// Some information about the object we don't care about. Read the entire line and ignore it.
-				char ingoreBuffer[1000];
-				fgets(ingoreBuffer, 1000, file);
+				memcpy(vertexData, &vertices[i], positionSize);
 			}
-		}
-
-		// Done reading the file, so close it.
-		fclose(file);
 
-		// Loop through the vertex indices of the faces/polygons that we read.
-		for (uint32_t i = 0; i < vertexIndices.size(); i++)
-		{
-			// Grab the indices of the vertex information that represent the face/polygon.
-			auto vertexIndex = vertexIndices[i];
-			auto uvIndex = uvIndices[i];
-			auto normalIndex = normalIndices[i];
-
-			// Grab the actual vertex information that the indices point to.
-			auto vertex = tempVertices[vertexIndex - 1];
-			auto uv = tempUvs[uvIndex - 1];
-			auto normal = tempNormals[normalIndex - 1];
+			// Store the UV coordinates as normalized 16-bit integers.
+			const uint32_t uv = glm::packUnorm2x16(uvs[i]);
+			memcpy(vertexData + positionSize, &uv, sizeof(uv));
 
-			// Store the vertex information into the final output vectors.
-			outVertices.push_back(vertex);
-			outUvs.push_back(uv);
-			outNormals.push_back(normal);
+			// Store the normal vector as normalized signed 10-bit integers (GL_INT_2_10_10_10_REV), making sure it has unit length first.
+			const auto normalLength = glm::length(normals[i]);
+			const uint32_t normal = glm::packSnorm3x10_1x2(glm::vec4(normalLength > 0.0f ? normals[i] / normalLength : normals[i], 0.0f));
+			memcpy(vertexData + positionSize + sizeof(uv), &normal, sizeof(normal));
 		}
 
-		// Create buffers for the vertex information, and store them in the buffer ID output variables
-		*vertexBufferId = createBuffer(outVertices);
-		*uvBufferId = createBuffer(outUvs);
-		*normalBufferId = createBuffer(outNormals);
-
-		// Return the number of vertices that were read from the OBJ file.
-		return outVertices.size();
+		return streamData;
 	}
 
-	ObjectManager()
-			: namedObjects({}),
-				namedObjectReferences({}) {}
-
-public:
-	// Preventing copying the object manager, making sure only one instance can exist.
-	ObjectManager(const ObjectManager &) = delete;
-
 	/**
-	 * Load and create an object from the given object file path. If an object with the same name was already created,
-	 * return the same object.
-	 * 
-	 * @param objectName      The name of the object.
-	 * @param objectFilePath  The file path to the object data.
+	 * Create the array buffers of the given vertex stream.
 	 * 
-	 * @return The details of the loaded object.
+	 * @param objectName      The name of the object the buffers are for.
+	 * @param vertexFormat    The format the vertex stream is stored in.
+	 * @param vertexCount     The number of vertices in the vertex stream.
+	 * @param vertexStream    The pointer to the start of the vertex stream.
+	 * @param vertexBufferId  The output variable for the ID of the array buffer of the vertex positions (or all the vertex data, if interleaved).
+	 * @param uvBufferId      The output variable for the ID of the array buffer of the vertex UV coordinates (0 if interleaved).
+	 * @param normalBufferId  The output variable for the ID of the array buffer of the vertex normal vectors (0 if interleaved).
 	 */
-	const std::shared_ptr<const ObjectDetails> &createObject(const std::string &objectName, const std::string &objectFilePath)
+	void createVertexBuffers(const std::string &objectName, const VertexFormat &vertexFormat, const uint32_t &vertexCount, const uint8_t *vertexStream, GLuint *const vertexBufferId, GLuint *const uvBufferId, GLuint *const normalBufferId)
 	{
-		// Check if an object with the name already exists.
-		const auto existingObject = namedObjects.find(objectName);
-		if (existingObject != namedObjects.end())
+		if (vertexFormat == SEPARATE_FLOAT)
 		{
-			// Object already loaded. Increase its reference count and return it.
-			namedObjectReferences[objectName]++;
-			return existingObject->second;
+			// Upload each part of the vertex stream into its own buffer.
+			const auto uvOffset = vertexCount * sizeof(glm::vec3);
+			const auto normalOffset = uvOffset + (vertexCount * sizeof(glm::vec2));
+			*vertexBufferId = createBuffer(objectName, vertexStream, vertexCount * sizeof(glm::vec3));
+			*uvBufferId = createBuffer(objectName, vertexStream + uvOffset, vertexCount * sizeof(glm::vec2));
+			*normalBufferId = createBuffer(objectName, vertexStream + normalOffset, vertexCount * sizeof(glm::vec3));
+		}
+		else
+		{
+			// Upload the whole interleaved vertex stream into a single buffer.
+			*vertexBufferId = createBuffer(objectName, vertexStream, getVertexStreamSize(vertexFormat, vertexCount));
+			*uvBufferId = 0;
+			*normalBufferId = 0;
 		}
-
-		// Create variables for storing the object details after loading it.
-		std::vector<glm::vec3> vertices;
-		GLuint vertexBufferId;
-		GLuint uvBufferId;
-		GLuint normalBufferId;
-
-		// Load the OBJ object file and store its details.
-		const uint32_t bufferSize = loadObjObject(objectName, objectFilePath, vertices, &vertexBufferId, &uvBufferId, &normalBufferId);
-
-		// Create a new object details with the captured data.
-		const auto newObject = std::make_shared<ObjectDetails>(objectName, objectFilePath, vertices, vertexBufferId, uvBufferId, normalBufferId, bufferSize);
-
-		// Insert the newly created object into the map of created objects.
-		namedObjects.insert(std::make_pair(objectName, newObject));
-		// Set the reference count of the object to 1.
-		namedObjectReferences[objectName] = 1;
-
-		// Return the object details.
-		return namedObjects[objectName];
 	}
 
 	/**
-   * Return the object created with the given name.
-   * 
-   * @param objectName  The name of the object to return.
-   * 
-   * @return The object created with the given name.
-   */
-	const std::shared_ptr<const ObjectDetails> &getObjectDetails(const std::string &objectName) const
+	 * Calculate the bounds of the given vertices.
+	 * 
+	 * @param vertices           The vertex positions.
+	 * @param outMinCorner       The output variable for the min-corner of the bounding box.
+	 * @param outMaxCorner       The output variable for the max-corner of the bounding box.
+	 * @param outBoundingRadius  The output variable for the distance of the farthest vertex from the origin.
+	 * @param outAxialRadius     The output variable for the distance of the farthest vertex from the y-axis.
+	 */
+	static void calculateBounds(const std::vector<glm::vec3> &vertices, glm::vec3 &outMinCorner, glm::vec3 &outMaxCorner, float_t &outBoundingRadius, float_t &outAxialRadius)
 	{
-		return namedObjects.at(objectName);
+		outMinCorner = vertices.empty() ? glm::vec3(0.0f) : vertices[0];
+		outMaxCorner = outMinCorner;
+		outBoundingRadius = 0.0f;
+		outAxialRadius = 0.0f;
+		for (const auto &vertex : vertices)
+		{
+			outMinCorner = glm::min(outMinCorner, vertex);
+			outMaxCorner = glm::max(outMaxCorner, vertex);
+			outBoundingRadius = glm::max(outBoundingRadius, glm::length(vertex));
+			outAxialRadius = glm::max(outAxialRadius, glm::length(glm::vec2(vertex.x, vertex.z)));
+		}
 	}
 
 	/**
-	 * Delete a reference to the object, and destroy it if no more references are present.
+	 * Get the size and last modification time of the given file, which identify the version of an OBJ file a mesh cache was created from.
 	 * 
-	 * @param objectDetails  The details of the object to destroy.
+	 * @param filePath         The path of the file.
+	 * @param outFileSize      The output variable for the size of the file.
+	 * @param outModifiedTime  The output variable for the last modification time of the file.
+	 * 
+	 * @return Whether the file details were read or not.
 	 */
-	void destroyObject(const std::shared_ptr<const ObjectDetails> &objectDetails)
+	static bool getFileStamp(const std::string &filePath, uint64_t &outFileSize, int64_t &outModifiedTime)
 	{
-		// Reduce the reference count of the object.
-		namedObjectReferences[objectDetails->getObjectName()]--;
-		// Check if there are no more references to the object.
-		if (namedObjectReferences[objectDetails->getObjectName()] <= 0)
-		{
-			// No more references left, so time to clean.
-			// Remove the object from the created objects references map.
-			namedObjectReferences.erase(objectDetails->getObjectName());
-			// Remove the object from the created objects map.
-			namedObjects.erase(objectDetails->getObjectName());
-			// Delete the array buffer containing the vertex position data of the object.
-			glDeleteBuffers(1, &objectDetails->vertexBufferId);
-			// Delete the array buffer containing the vertex UV coordinates data of the object.
-			glDeleteBuffers(1, &objectDetails->uvBufferId);
-			// Delete the array buffer containing the vertex normal vector data of the object.
-			glDeleteBuffers(1, &objectDetails->normalBufferId);
+		struct stat fileStat;
+		if (stat(filePath.c_str(), &fileStat) != 0)
+		{
+			return false;
+		}
+		outFileSize = fileStat.st_size;
+		outModifiedTime = fileStat.st_mtime;
+		return true;
+	}
+
+	/**
+	 * Map the mesh cache file matching the given source OBJ file details, so that the buffers can be created straight from the mapping.
+	 * 
+	 * @param cacheFilePath    The file path to the mesh cache.
+	 * @param expectedHeader   The header with the requested vertex format and source OBJ file details the cache must match.
+	 * @param outObject        The output variable for the prepared object pointing into the mapped cache.
+	 * @param isSourceChecked  Whether the cache must match the source OBJ file details (not for the cooked caches, which the asset manifest checks).
+	 * 
+	 * @return Whether the cache was read or not (false if it is missing, stale, or corrupted).
+	 */
+	static bool readMeshCache(const std::string &cacheFilePath, const MeshCacheHeader &expectedHeader, PreparedObject &outObject, const bool &isSourceChecked = true)
+	{
+		// Map the cache file, and check if it is large enough to contain a header.
+		auto cacheFile = std::make_unique<AssetFile>(cacheFilePath);
+		if (!cacheFile->isMapped() || cacheFile->getSize() < sizeof(MeshCacheHeader))
+		{
+			return false;
+		}
+
+		// Check if the cache was created by this version of the layout, for the same vertex format and OBJ file.
+		MeshCacheHeader header;
+		memcpy(&header, cacheFile->getData(), sizeof(MeshCacheHeader));
+		if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+				header.requestedVertexFormat != expectedHeader.requestedVertexFormat || header.vertexFormat > INTERLEAVED_HALF ||
+				(isSourceChecked && (header.sourceFileSize != expectedHeader.sourceFileSize || header.sourceModifiedTime != expectedHeader.sourceModifiedTime)))
+		{
+			return false;
+		}
+
+		// Check if the size of the streams match the counts in the header, so a truncated file is never read past its end.
+		const auto vertexFormat = static_cast<VertexFormat>(header.vertexFormat);
+		const uint64_t indexStreamOffset = sizeof(MeshCacheHeader) + header.vertexStreamSize;
+		const uint64_t positionStreamOffset = indexStreamOffset + (static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t));
+		const uint64_t cacheFileSize = positionStreamOffset + (static_cast<uint64_t>(header.vertexCount) * sizeof(glm::vec3));
+		if (header.vertexCount == 0 || header.indexCount == 0 ||
+				header.vertexStreamSize != getVertexStreamSize(vertexFormat, header.vertexCount) || cacheFileSize != cacheFile->getSize())
+		{
+			return false;
+		}
+		// Check if the levels of detail add up to the indices, with the full detail one first.
+		uint64_t lodIndexCount = 0;
+		for (uint32_t i = 0; i < OBJECT_LOD_COUNT; i++)
+		{
+			if (header.lodIndexCounts[i] % 3 != 0 || (i > 0 && header.lodIndexCounts[i] > 0 && header.lodIndexCounts[i - 1] == 0))
+			{
+				return false;
+			}
+			lodIndexCount += header.lodIndexCounts[i];
+		}
+		if (header.lodIndexCounts[0] == 0 || lodIndexCount != header.indexCount)
+		{
+			return false;
+		}
+
+		// Copy the positions if the objects keep their geometry, and point the streams into the mapped file.
+		outObject.vertexFormat = vertexFormat;
+		outObject.vertexCount = header.vertexCount;
+		if (IS_OBJECT_GEOMETRY_KEPT)
+		{
+			outObject.vertices.resize(header.vertexCount);
+			memcpy(&outObject.vertices[0], cacheFile->getData() + positionStreamOffset, header.vertexCount * sizeof(glm::vec3));
+		}
+		outObject.indexCount = header.indexCount;
+		std::copy(header.lodIndexCounts, header.lodIndexCounts + OBJECT_LOD_COUNT, outObject.lodIndexCounts.begin());
+		outObject.minCorner = header.minCorner;
+		outObject.maxCorner = header.maxCorner;
+		outObject.boundingRadius = header.boundingRadius;
+		outObject.axialRadius = header.axialRadius;
+		outObject.originalAcmr = header.originalAcmr;
+		outObject.optimizedAcmr = header.optimizedAcmr;
+		outObject.vertexStream = cacheFile->getData() + sizeof(MeshCacheHeader);
+		outObject.indexStream = cacheFile->getData() + indexStreamOffset;
+		outObject.cacheFile = std::move(cacheFile);
+
+		return true;
+	}
+
+	/**
+	 * Write a mesh cache file with the given header and streams. Failing to write the cache is not an error,
+	 *   since the OBJ file will just be parsed again the next time.
+	 * 
+	 * @param cacheFilePath  The file path to the mesh cache.
+	 * @param header         The header of the cache.
+	 * @param vertexStream   The bytes of the vertex stream.
+	 * @param indices        The indices of the vertices of each triangle.
+	 * @param vertices       The unique vertex positions.
+	 * 
+	 * @return Whether the cache was written or not.
+	 */
+	static bool writeMeshCache(const std::string &cacheFilePath, const MeshCacheHeader &header, const std::vector<uint8_t> &vertexStream, const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &vertices)
+	{
+		// Write to a temporary file first, so that a cache being written is never loaded half finished
+		//   (named after the thread, since objects with different names can share the same OBJ file).
+		const auto tempFilePath = cacheFilePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		{
+			std::ofstream cacheFile(tempFilePath, std::ios::binary | std::ios::trunc);
+			cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(MeshCacheHeader));
+			cacheFile.write(reinterpret_cast<const char *>(&vertexStream[0]), vertexStream.size());
+			cacheFile.write(reinterpret_cast<const char *>(&indices[0]), indices.size() * sizeof(uint32_t));
+			cacheFile.write(reinterpret_cast<const char *>(&vertices[0]), vertices.size() * sizeof(glm::vec3));
+			if (!cacheFile)
+			{
+				cacheFile.close();
+				remove(tempFilePath.c_str());
+				return false;
+			}
+		}
+
+		// Replace the old cache with the new one.
+		remove(cacheFilePath.c_str());
+		return rename(tempFilePath.c_str(), cacheFilePath.c_str()) == 0;
+	}
+
+	/**
+	 * Create a vertex array object linking the fixed vertex attribute IDs to the given array buffers.
+	 * 
+	 * @param vertexFormat    The format the vertices are stored in.
+	 * @param vertexBufferId  The ID of the array buffer containing the vertex position data (or all the vertex data, if interleaved).
+	 * @param uvBufferId      The ID of the array buffer containing the vertex UV coordinates data (unused if interleaved).
+	 * @param normalBufferId  The ID of the array buffer containing the vertex normal vector data (unused if interleaved).
+	 * @param indexBufferId   The ID of the element buffer containing the vertex indices.
+	 * 
+	 * @return The ID of the vertex array object.
+	 */
+	GLuint createVertexArray(const VertexFormat &vertexFormat, const GLuint &vertexBufferId, const GLuint &uvBufferId, const GLuint &normalBufferId, const GLuint &indexBufferId)
+	{
+		// Create and bind a new vertex array object.
+		const auto vertexArrayId = VertexArray::createVertexArray();
+		// Describe the vertex position, UV coordinates, and normal vector attributes once, since they never change.
+		if (vertexFormat == SEPARATE_FLOAT)
+		{
+			VertexArray::enableAttribute(VertexArray::POSITION_ATTRIBUTE_ID, vertexBufferId, 3);
+			VertexArray::enableAttribute(VertexArray::UV_ATTRIBUTE_ID, uvBufferId, 2);
+			VertexArray::enableAttribute(VertexArray::NORMAL_ATTRIBUTE_ID, normalBufferId, 3);
+		}
+		else
+		{
+			// All the attributes read from the same interleaved buffer, at their offset in each vertex.
+			const auto positionSize = getInterleavedPositionSize(vertexFormat);
+			const auto vertexSize = getInterleavedVertexSize(vertexFormat);
+			VertexArray::enableAttribute(VertexArray::POSITION_ATTRIBUTE_ID, vertexBufferId, 3, vertexFormat == INTERLEAVED_HALF ? GL_HALF_FLOAT : GL_FLOAT, 0, vertexSize, 0);
+			VertexArray::enableAttribute(VertexArray::UV_ATTRIBUTE_ID, vertexBufferId, 2, GL_UNSIGNED_SHORT, 0, vertexSize, positionSize, GL_TRUE);
+			VertexArray::enableAttribute(VertexArray::NORMAL_ATTRIBUTE_ID, vertexBufferId, 4, GL_INT_2_10_10_10_REV, 0, vertexSize, positionSize + sizeof(uint32_t), GL_TRUE);
+		}
+		// Bind the element buffer, which is also stored in the vertex array object.
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
+		// Unbind the vertex array object and buffer now that we're done.
+		GlCalls::bindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// Return the ID of the created vertex array object.
+		return vertexArrayId;
+	}
+
+	/**
+	 * Skip the spaces and tabs at the cursor of an OBJ line.
+	 * 
+	 * @param cursor  The cursor to move past the spaces.
+	 * @param end     The end of the line.
+	 */
+	static void skipObjSpaces(const char *&cursor, const char *end)
+	{
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+		{
+			cursor++;
+		}
+	}
+
+	/**
+	 * Parse a decimal floating-point number at the cursor of an OBJ line, without the locale handling and
+	 *   buffering that the C library functions go through.
+	 * 
+	 * @param cursor  The cursor to move past the number.
+	 * @param end     The end of the line.
+	 * 
+	 * @return The parsed number (0 if there was no number at the cursor).
+	 */
+	static float_t parseObjFloat(const char *&cursor, const char *end)
+	{
+		// The powers of ten that can be represented exactly as doubles.
+		static constexpr double EXACT_POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+		// The largest mantissa that more digits can be appended to without overflowing.
+		static constexpr uint64_t MAX_MANTISSA = 100000000000000000ull;
+
+		skipObjSpaces(cursor, end);
+
+		// Read the sign.
+		bool isNegative = false;
+		if (cursor < end && (*cursor == '-' || *cursor == '+'))
+		{
+			isNegative = *cursor == '-';
+			cursor++;
+		}
+
+		// Read the digits into an integer mantissa, keeping track of the power of ten it has to be scaled by.
+		uint64_t mantissa = 0;
+		int32_t exponent = 0;
+		while (cursor < end && *cursor >= '0' && *cursor <= '9')
+		{
+			if (mantissa < MAX_MANTISSA)
+			{
+				mantissa = (mantissa * 10) + (*cursor - '0');
+			}
+			else
+			{
+				exponent++;
+			}
+			cursor++;
+		}
+		if (cursor < end && *cursor == '.')
+		{
+			cursor++;
+			while (cursor < end && *cursor >= '0' && *cursor <= '9')
+			{
+				if (mantissa < MAX_MANTISSA)
+				{
+					mantissa = (mantissa * 10) + (*cursor - '0');
+					exponent--;
+				}
+				cursor++;
+			}
+		}
+
+		// Read the exponent, if any.
+		if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+		{
+			cursor++;
+			bool isExponentNegative = false;
+			if (cursor < end && (*cursor == '-' || *cursor == '+'))
+			{
+				isExponentNegative = *cursor == '-';
+				cursor++;
+			}
+			int32_t explicitExponent = 0;
+			while (cursor < end && *cursor >= '0' && *cursor <= '9')
+			{
+				explicitExponent = std::min((explicitExponent * 10) + (*cursor - '0'), 1000);
+				cursor++;
+			}
+			exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+		}
+
+		// Scale the mantissa, using the exact powers of ten for the usual short numbers.
+		double value = static_cast<double>(mantissa);
+		if (mantissa != 0 && exponent != 0)
+		{
+			const auto absoluteExponent = exponent < 0 ? -exponent : exponent;
+			const auto scale = absoluteExponent <= 22 ? EXACT_POWERS_OF_TEN[absoluteExponent] : std::pow(10.0, absoluteExponent);
+			value = exponent < 0 ? value / scale : value * scale;
+		}
+
+		return static_cast<float_t>(isNegative ? -value : value);
+	}
+
+	/**
+	 * Parse a face corner of vertex information indices ("v/vt/vn") at the cursor of an OBJ line.
+	 * 
+	 * @param cursor     The cursor to move past the face corner.
+	 * @param end        The end of the line.
+	 * @param outCorner  The output variable for the indices of the face corner.
+	 * 
+	 * @return Whether all three indices were read or not.
+	 */
+	static bool parseObjCorner(const char *&cursor, const char *end, ObjVertexKey &outCorner)
+	{
+		uint32_t *const indices[3] = {&outCorner.vertexIndex, &outCorner.uvIndex, &outCorner.normalIndex};
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			// The indices are separated by slashes.
+			if (i > 0)
+			{
+				if (cursor >= end || *cursor != '/')
+				{
+					return false;
+				}
+				cursor++;
+			}
+
+			// Read the digits of the index (which start from 1).
+			const auto digitsStart = cursor;
+			uint32_t index = 0;
+			while (cursor < end && *cursor >= '0' && *cursor <= '9')
+			{
+				index = (index * 10) + (*cursor - '0');
+				cursor++;
+			}
+			if (cursor == digitsStart || index == 0)
+			{
+				return false;
+			}
+			*indices[i] = index;
+		}
+		return true;
+	}
+
+	/**
+	 * Check if the OBJ line starts with the given keyword followed by a space.
+	 * 
+	 * @param line     The start of the line.
+	 * @param lineEnd  The end of the line.
+	 * @param keyword  The keyword.
+	 * 
+	 * @return Whether the line defines the keyword or not.
+	 */
+	static bool isObjLineType(const char *line, const char *lineEnd, const char *keyword)
+	{
+		const auto keywordLength = strlen(keyword);
+		return lineEnd - line > static_cast<ptrdiff_t>(keywordLength) && memcmp(line, keyword, keywordLength) == 0 && (line[keywordLength] == ' ' || line[keywordLength] == '\t');
+	}
+
+	/**
+	 * Get the end of the OBJ line starting at the given position.
+	 * 
+	 * @param line  The start of the line.
+	 * @param end   The end of the chunk.
+	 * 
+	 * @return The position of the newline character ending the line, or the end of the chunk.
+	 */
+	static const char *findObjLineEnd(const char *line, const char *end)
+	{
+		const auto lineEnd = static_cast<const char *>(memchr(line, '\n', end - line));
+		return lineEnd == nullptr ? end : lineEnd;
+	}
+
+	/**
+	 * Parse a line-aligned chunk of an OBJ file. Safe to run on several threads at once, since the face indices
+	 *   of OBJ files refer to the whole file and not to the chunk.
+	 * 
+	 * @param chunkStart  The start of the chunk.
+	 * @param chunkEnd    The end of the chunk.
+	 * @param outChunk    The output variable for the vertex information and triangle corners of the chunk.
+	 */
+	static void parseObjChunk(const char *chunkStart, const char *chunkEnd, ObjChunk &outChunk)
+	{
+		// Count the lines of each type first, so that each vector is allocated only once.
+		size_t vertexCount = 0, uvCount = 0, normalCount = 0, faceCount = 0;
+		for (auto line = chunkStart; line < chunkEnd;)
+		{
+			const auto lineEnd = findObjLineEnd(line, chunkEnd);
+			vertexCount += isObjLineType(line, lineEnd, "v");
+			uvCount += isObjLineType(line, lineEnd, "vt");
+			normalCount += isObjLineType(line, lineEnd, "vn");
+			faceCount += isObjLineType(line, lineEnd, "f");
+			line = lineEnd + 1;
+		}
+		outChunk.vertices.reserve(vertexCount);
+		outChunk.uvs.reserve(uvCount);
+		outChunk.normals.reserve(normalCount);
+		// Reserve enough for every face being a quad (two triangles).
+		outChunk.corners.reserve(faceCount * 6);
+		outChunk.hasUnsupportedFace = false;
+
+		// Parse the lines.
+		for (auto line = chunkStart; line < chunkEnd;)
+		{
+			const auto lineEnd = findObjLineEnd(line, chunkEnd);
+			if (isObjLineType(line, lineEnd, "v"))
+			{
+				// Line defines a vertex position data.
+				auto cursor = line + 1;
+				const auto x = parseObjFloat(cursor, lineEnd);
+				const auto y = parseObjFloat(cursor, lineEnd);
+				const auto z = parseObjFloat(cursor, lineEnd);
+				outChunk.vertices.push_back(glm::vec3(x, y, z));
+			}
+			else if (isObjLineType(line, lineEnd, "vt"))
+			{
+				// Line defines a vertex UV coordinates data.
+				auto cursor = line + 2;
+				const auto u = parseObjFloat(cursor, lineEnd);
+				const auto v = parseObjFloat(cursor, lineEnd);
+				outChunk.uvs.push_back(glm::vec2(u, v));
+			}
+			else if (isObjLineType(line, lineEnd, "vn"))
+			{
+				// Line defines a vertex normal vector data.
+				auto cursor = line + 2;
+				const auto x = parseObjFloat(cursor, lineEnd);
+				const auto y = parseObjFloat(cursor, lineEnd);
+				const auto z = parseObjFloat(cursor, lineEnd);
+				outChunk.normals.push_back(glm::vec3(x, y, z));
+			}
+			else if (isObjLineType(line, lineEnd, "f"))
+			{
+				// Line defines the indices of the vertex information of a triangle or a quad.
+				auto cursor = line + 1;
+				ObjVertexKey faceCorners[4];
+				uint32_t cornerCount = 0;
+				while (true)
+				{
+					skipObjSpaces(cursor, lineEnd);
+					if (cursor >= lineEnd)
+					{
+						break;
+					}
+					// More than four corners, or corners without all three indices, are not supported.
+					if (cornerCount == 4 || !parseObjCorner(cursor, lineEnd, faceCorners[cornerCount]))
+					{
+						cornerCount = 0;
+						break;
+					}
+					cornerCount++;
+				}
+
+				if (cornerCount == 4)
+				{
+					// Split the quad into two triangles.
+					outChunk.corners.insert(outChunk.corners.end(), {faceCorners[0], faceCorners[1], faceCorners[2], faceCorners[0], faceCorners[2], faceCorners[3]});
+				}
+				else if (cornerCount == 3)
+				{
+					outChunk.corners.insert(outChunk.corners.end(), {faceCorners[0], faceCorners[1], faceCorners[2]});
+				}
+				else
+				{
+					// This OBJ file is formatted in a way that we can't support, so stop parsing.
+					outChunk.hasUnsupportedFace = true;
+					return;
+				}
+			}
+			// Any other line is some information about the object we don't care about.
+			line = lineEnd + 1;
+		}
+	}
+
+	/**
+	 * Simplify the given triangles into the levels of detail after the full detail one, appending the indices of each level to
+	 *   the indices. Only the objects with enough triangles are simplified, and the levels stop once the simplification cannot
+	 *   remove enough of the triangles left within the error allowed.
+	 * 
+	 * @param vertices           The vertex positions.
+	 * @param boundingRadius     The distance of the farthest vertex from the origin, which the error allowed is a share of.
+	 * @param indices            The indices of the triangles at full detail, followed by the indices of the levels made.
+	 * @param outLodIndexCounts  The output variable for the number of indices of each level (0 for the levels not made).
+	 */
+	static void createObjectLods(const std::vector<glm::vec3> &vertices, const float_t &boundingRadius, std::vector<uint32_t> &indices, std::array<uint32_t, OBJECT_LOD_COUNT> &outLodIndexCounts)
+	{
+		outLodIndexCounts.fill(0);
+		outLodIndexCounts[0] = indices.size();
+		if (indices.size() / 3 < OBJECT_LOD_MIN_TRIANGLES)
+		{
+			return;
+		}
+
+		// Each level is simplified further from the one before it, keeping the error of the collapses done for that one.
+		MeshSimplifier simplifier(vertices, indices);
+		for (uint32_t i = 1; i < OBJECT_LOD_COUNT; i++)
+		{
+			const auto targetIndexCount = static_cast<size_t>(outLodIndexCounts[i - 1] / 3 * OBJECT_LOD_TRIANGLE_RATIO) * 3;
+			const auto &lodIndices = simplifier.simplify(targetIndexCount, OBJECT_LOD_MAX_ERROR * boundingRadius);
+			// A level keeping most of the triangles of the one before it is not worth drawing instead.
+			if (lodIndices.empty() || lodIndices.size() > outLodIndexCounts[i - 1] * 3 / 4)
+			{
+				return;
+			}
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+			outLodIndexCounts[i] = lodIndices.size();
+		}
+	}
+
+	/**
+	 * Reorder the triangles of each level of detail for the post-transform vertex cache and the overdraw, then the vertices in
+	 *   the order the triangles use them, measuring the average cache miss ratio of the full detail triangles before and after.
+	 * 
+	 * @param vertices          The vertex positions, reordered in place.
+	 * @param uvs               The vertex UV coordinates, reordered in place.
+	 * @param normals           The vertex normal vectors, reordered in place.
+	 * @param indices           The indices of the triangles of all the levels of detail, reordered in place.
+	 * @param lodIndexCounts    The number of indices of each level of detail.
+	 * @param outOriginalAcmr   The output variable for the average cache miss ratio of the full detail triangles before.
+	 * @param outOptimizedAcmr  The output variable for the average cache miss ratio of the full detail triangles after.
+	 */
+	static void optimizeObjectMesh(std::vector<glm::vec3> &vertices, std::vector<glm::vec2> &uvs, std::vector<glm::vec3> &normals, std::vector<uint32_t> &indices, const std::array<uint32_t, OBJECT_LOD_COUNT> &lodIndexCounts, float_t &outOriginalAcmr, float_t &outOptimizedAcmr)
+	{
+		const auto vertexCount = static_cast<uint32_t>(vertices.size());
+		outOriginalAcmr = MeshOptimizer::getAcmr(&indices[0], lodIndexCounts[0], vertexCount);
+		size_t indexOffset = 0;
+		for (const auto &lodIndexCount : lodIndexCounts)
+		{
+			MeshOptimizer::optimizeTriangles(&indices[indexOffset], lodIndexCount, vertices);
+			indexOffset += lodIndexCount;
+		}
+		outOptimizedAcmr = MeshOptimizer::getAcmr(&indices[0], lodIndexCounts[0], vertexCount);
+
+		// The full detail triangles come first, so the vertices they use are numbered in their order.
+		const auto vertexRemap = MeshOptimizer::optimizeVertexFetch(indices, vertexCount);
+		MeshOptimizer::remapVertices(vertexRemap, vertices);
+		MeshOptimizer::remapVertices(vertexRemap, uvs);
+		MeshOptimizer::remapVertices(vertexRemap, normals);
+	}
+
+	/**
+	 * Parse the OBJ object file, simplifying its levels of detail and reordering it for drawing.
+	 * Does not use the GL context, so it can be run on worker threads.
+	 * 
+	 * @param objectName      The name of the object being loaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices in (separate floats are used instead if the UV coordinates do not fit the quantized range).
+	 * @param outObject       The output variable for the prepared object owning the parsed streams.
+	 */
+	static void parseObjectData(const std::string &objectName, const std::string &objectFilePath, const VertexFormat &vertexFormat, PreparedObject &outObject)
+	{
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+		auto &vertices = outObject.vertices;
+		auto &indices = outObject.parsedIndices;
+		loadObjObject(objectName, objectFilePath, vertices, uvs, normals, indices);
+		if (indices.empty())
+		{
+			// An object without any faces cannot be drawn. Time to crash.
+			std::cout << objectName << std::endl
+								<< "Failed at object 3" << std::endl;
+			exit(1);
+		}
+
+		// The quantized UV coordinates can only represent values between 0 and 1, so keep the floats for objects with repeating textures.
+		outObject.vertexFormat = vertexFormat;
+		for (const auto &uv : uvs)
+		{
+			if (uv.x < 0.0f || uv.x > 1.0f || uv.y < 0.0f || uv.y > 1.0f)
+			{
+				outObject.vertexFormat = SEPARATE_FLOAT;
+				break;
+			}
+		}
+
+		// Calculate the bounds, simplify the levels of detail, and reorder the triangles and the vertices for drawing.
+		calculateBounds(vertices, outObject.minCorner, outObject.maxCorner, outObject.boundingRadius, outObject.axialRadius);
+		createObjectLods(vertices, outObject.boundingRadius, indices, outObject.lodIndexCounts);
+		optimizeObjectMesh(vertices, uvs, normals, indices, outObject.lodIndexCounts, outObject.originalAcmr, outObject.optimizedAcmr);
+		outObject.parsedVertexStream = createVertexStream(outObject.vertexFormat, vertices, uvs, normals);
+		outObject.vertexCount = vertices.size();
+		outObject.indexCount = indices.size();
+		outObject.vertexStream = &outObject.parsedVertexStream[0];
+		outObject.indexStream = reinterpret_cast<const uint8_t *>(&indices[0]);
+	}
+
+	/**
+	 * Write the mesh cache file of a parsed object.
+	 * 
+	 * @param cacheFilePath   The file path to the mesh cache.
+	 * @param header          The header with the requested vertex format and source OBJ file details, filled in with the rest of the details.
+	 * @param preparedObject  The prepared object owning the parsed streams.
+	 * 
+	 * @return Whether the cache was written or not.
+	 */
+	static bool writeObjectCache(const std::string &cacheFilePath, MeshCacheHeader &header, const PreparedObject &preparedObject)
+	{
+		header.vertexFormat = preparedObject.vertexFormat;
+		header.vertexCount = preparedObject.vertexCount;
+		header.indexCount = preparedObject.parsedIndices.size();
+		header.vertexStreamSize = preparedObject.parsedVertexStream.size();
+		header.minCorner = preparedObject.minCorner;
+		header.maxCorner = preparedObject.maxCorner;
+		header.boundingRadius = preparedObject.boundingRadius;
+		header.axialRadius = preparedObject.axialRadius;
+		std::copy(preparedObject.lodIndexCounts.begin(), preparedObject.lodIndexCounts.end(), header.lodIndexCounts);
+		header.originalAcmr = preparedObject.originalAcmr;
+		header.optimizedAcmr = preparedObject.optimizedAcmr;
+		return writeMeshCache(cacheFilePath, header, preparedObject.parsedVertexStream, preparedObject.parsedIndices, preparedObject.vertices);
+	}
+
+	/**
+	 * Define the header that a valid mesh cache of the given OBJ object file must match.
+	 * 
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The requested format to store the vertices in.
+	 * @param outHeader       The output variable for the header.
+	 * 
+	 * @return Whether the details of the OBJ file were read or not.
+	 */
+	static bool createMeshCacheHeader(const std::string &objectFilePath, const VertexFormat &vertexFormat, MeshCacheHeader &outHeader)
+	{
+		outHeader = {};
+		outHeader.magic = MESH_CACHE_MAGIC;
+		outHeader.version = MESH_CACHE_VERSION;
+		outHeader.requestedVertexFormat = vertexFormat;
+		return getFileStamp(objectFilePath, outHeader.sourceFileSize, outHeader.sourceModifiedTime);
+	}
+
+	/**
+	 * Read the object from its cooked mesh cache or its mesh cache file, or parse the OBJ object file if both are missing or stale (writing
+	 *   a new cache for the next time).
+	 * Does not use the GL context, so it can be run on worker threads.
+	 * 
+	 * @param objectName      The name of the object being loaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices in (separate floats are used instead if the UV coordinates do not fit the quantized range).
+	 * 
+	 * @return The prepared object data.
+	 */
+	static std::shared_ptr<PreparedObject> prepareObjectData(const std::string objectName, const std::string objectFilePath, const VertexFormat vertexFormat)
+	{
+		STARTUP_PHASE("Object Read", objectName);
+		const auto cacheFilePath = objectFilePath + MESH_CACHE_FILE_EXTENSION;
+		auto preparedObject = std::make_shared<PreparedObject>();
+
+		// Define the header that a valid cache must match.
+		MeshCacheHeader header;
+		const auto hasFileStamp = createMeshCacheHeader(objectFilePath, vertexFormat, header);
+
+		// Try reading the cooked cache first, which the asset manifest only finds while the OBJ file is unchanged.
+		const auto cookedFilePath = AssetManifest::getInstance().findCookedAsset(objectFilePath);
+		if (!cookedFilePath.empty() && readMeshCache(cookedFilePath, header, *preparedObject, false))
+		{
+			return preparedObject;
+		}
+
+		// Then the cache next to the OBJ file.
+		if (hasFileStamp && readMeshCache(cacheFilePath, header, *preparedObject))
+		{
+			return preparedObject;
+		}
+
+		// Otherwise, parse the OBJ file.
+		parseObjectData(objectName, objectFilePath, vertexFormat, *preparedObject);
+
+		// Write the cache next to the OBJ file for the next time.
+		if (hasFileStamp)
+		{
+			writeObjectCache(cacheFilePath, header, *preparedObject);
+		}
+		// Release the positions once they are written, unless the objects keep their geometry.
+		if (!IS_OBJECT_GEOMETRY_KEPT)
+		{
+			std::vector<glm::vec3>().swap(preparedObject->vertices);
+		}
+
+		// Return the prepared object data.
+		return preparedObject;
+	}
+
+	/**
+	 * Delete the object with the given name, and remove it from the created objects.
+	 * 
+	 * @param objectName  The name of the object to delete.
+	 */
+	void deleteObject(const std::string objectName)
+	{
+		const auto objectNameId = nameInterner.intern(objectName);
+		const auto objectDetails = namedObjects.at(objectNameId);
+		// Remove the object from the created objects, along with its reference count.
+		namedObjects.erase(objectNameId);
+		// Retire the vertex array object and the buffers of the object (the vertex positions, UV coordinates, normal vectors and
+		//   indices), since the frames still in flight may draw it.
+		gpuDeletionQueue.retireVertexArray(objectDetails->vertexArrayId);
+		gpuDeletionQueue.retireBuffer(objectDetails->vertexBufferId);
+		gpuDeletionQueue.retireBuffer(objectDetails->uvBufferId);
+		gpuDeletionQueue.retireBuffer(objectDetails->normalBufferId);
+		gpuDeletionQueue.retireBuffer(objectDetails->indexBufferId);
+		// Free the GPU memory accounted to the object.
+		gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, objectDetails->vertexBufferId);
+		gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, objectDetails->uvBufferId);
+		gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, objectDetails->normalBufferId);
+		gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, objectDetails->indexBufferId);
+	}
+
+	ObjectManager()
+			: nameInterner(NameInterner::getInstance()),
+				namedObjects(),
+				preparingObjects(),
+				residencyCache(OBJECT_RESIDENCY_BUDGET),
+				gpuMemoryManager(GpuMemoryManager::getInstance()),
+				glDebugManager(GlDebugManager::getInstance()),
+				gpuDeletionQueue(GpuDeletionQueue::getInstance()) {}
+
+	~ObjectManager()
+	{
+		// Wait for any object still being prepared, since the tasks use the static helpers of the manager.
+		for (auto &preparingObject : preparingObjects)
+		{
+			preparingObject.second.wait();
+		}
+	}
+
+public:
+	// Preventing copying the object manager, making sure only one instance can exist.
+	ObjectManager(const ObjectManager &) = delete;
+
+	/**
+	 * Load the OBJ object file, parsing line-aligned chunks of it on multiple threads.
+	 * Face corners sharing the same position, UV coordinates and normal vector are welded into a single vertex,
+	 *   which the triangles then refer to through the indices.
+	 * 
+	 * @param objectName      The name of the object being loaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param outVertices     The vector to store the unique object vertex positions to.
+	 * @param outUvs          The vector to store the unique object vertex UV coordinates to.
+	 * @param outNormals      The vector to store the unique object vertex normal vectors to.
+	 * @param outIndices      The vector to store the indices of the vertices of each triangle to.
+	 */
+	static void loadObjObject(const std::string &objectName, const std::string &objectFilePath, std::vector<glm::vec3> &outVertices, std::vector<glm::vec2> &outUvs, std::vector<glm::vec3> &outNormals, std::vector<uint32_t> &outIndices)
+	{
+		// Map the whole OBJ file into memory (or point into the asset archive if it has the file).
+		const AssetFile file(objectFilePath);
+		// Check if the file is accessible.
+		if (!file.isMapped())
+		{
+			// Could not read the object file. Time to crash.
+			std::cout << objectName << std::endl
+								<< "Failed at object 1" << std::endl;
+			exit(1);
+		}
+		const auto fileStart = reinterpret_cast<const char *>(file.getData());
+		const auto fileEnd = fileStart + file.getSize();
+
+		// Pick the number of chunks, giving each thread of the job manager a reasonable amount of work.
+		auto &jobManager = JobManager::getInstance();
+		const size_t threadCount = jobManager.getWorkerThreadsCount() + 1;
+		const size_t chunkCount = std::max<size_t>(1, std::min({threadCount, static_cast<size_t>(MAX_OBJ_PARSE_THREADS), file.getSize() / MIN_OBJ_CHUNK_SIZE}));
+
+		// Split the file into chunks of about the same size, moving each boundary to the start of the next line.
+		std::vector<const char *> chunkBounds(chunkCount + 1, fileEnd);
+		chunkBounds[0] = fileStart;
+		for (size_t i = 1; i < chunkCount; i++)
+		{
+			const auto approximateBound = std::max(fileStart + ((file.getSize() * i) / chunkCount), chunkBounds[i - 1]);
+			chunkBounds[i] = std::min(findObjLineEnd(approximateBound, fileEnd) + 1, fileEnd);
+		}
+
+		// Parse the chunks, the first one on this thread and the rest as tasks on the worker threads.
+		std::vector<ObjChunk> chunks(chunkCount);
+		std::vector<std::shared_ptr<JobTask>> parseTasks;
+		for (size_t i = 1; i < chunkCount; i++)
+		{
+			const auto chunkStart = chunkBounds[i];
+			const auto chunkEnd = chunkBounds[i + 1];
+			auto &chunk = chunks[i];
+			parseTasks.push_back(jobManager.submitTask([chunkStart, chunkEnd, &chunk]() {
+				parseObjChunk(chunkStart, chunkEnd, chunk);
+			}));
+		}
+		parseObjChunk(chunkBounds[0], chunkBounds[1], chunks[0]);
+		for (const auto &parseTask : parseTasks)
+		{
+			jobManager.waitForTask(parseTask);
+		}
+
+		// Merge the vertex information of the chunks in file order, since the face indices refer to it that way.
+		std::vector<glm::vec3> tempVertices;
+		std::vector<glm::vec2> tempUvs;
+		std::vector<glm::vec3> tempNormals;
+		size_t cornerCount = 0;
+		for (auto &chunk : chunks)
+		{
+			if (chunk.hasUnsupportedFace)
+			{
+				// This OBJ file is formatted in a way that we can't support. Time to crash.
+				std::cout << objectName << std::endl
+									<< "Failed at object 2" << std::endl;
+				exit(1);
+			}
+			tempVertices.insert(tempVertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+			tempUvs.insert(tempUvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+			tempNormals.insert(tempNormals.end(), chunk.normals.begin(), chunk.normals.end());
+			cornerCount += chunk.corners.size();
+			// Release the vertex information of the chunk once it is merged, so that it is never held twice.
+			std::vector<glm::vec3>().swap(chunk.vertices);
+			std::vector<glm::vec2>().swap(chunk.uvs);
+			std::vector<glm::vec3>().swap(chunk.normals);
+		}
+
+		// Define a map from the indices of the vertex information to the index of the unique vertex using them.
+		std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> uniqueVertexIds;
+		uniqueVertexIds.reserve(cornerCount);
+		outIndices.reserve(cornerCount);
+
+		// Loop through the triangle corners of the chunks that we read.
+		for (auto &chunk : chunks)
+		{
+			for (const auto &vertexKey : chunk.corners)
+			{
+				// Check if a vertex with the same vertex information was already stored.
+				const auto existingVertex = uniqueVertexIds.find(vertexKey);
+				if (existingVertex != uniqueVertexIds.end())
+				{
+					// If it was, refer to the same vertex.
+					outIndices.push_back(existingVertex->second);
+					continue;
+				}
+
+				// Make sure the indices point to vertex information that exists.
+				if (vertexKey.vertexIndex > tempVertices.size() || vertexKey.uvIndex > tempUvs.size() || vertexKey.normalIndex > tempNormals.size())
+				{
+					// This OBJ file refers to vertex information it does not define. Time to crash.
+					std::cout << objectName << std::endl
+										<< "Failed at object 2" << std::endl;
+					exit(1);
+				}
+
+				// Store the actual vertex information that the indices point to as a new vertex into the final output vectors.
+				const uint32_t vertexId = outVertices.size();
+				outVertices.push_back(tempVertices[vertexKey.vertexIndex - 1]);
+				outUvs.push_back(tempUvs[vertexKey.uvIndex - 1]);
+				outNormals.push_back(tempNormals[vertexKey.normalIndex - 1]);
+				uniqueVertexIds.emplace(vertexKey, vertexId);
+				outIndices.push_back(vertexId);
+			}
+			// Release the corners of the chunk once they are welded, while the unique vertices grow.
+			std::vector<ObjVertexKey>().swap(chunk.corners);
+		}
+	}
+
+	/**
+	 * Start reading and parsing the object from the given object file path on a worker thread, so that calling createObject later
+	 * only has to upload it. Does nothing if an object with the same name was already created or is already being prepared.
+	 * 
+	 * @param objectName      The name of the object.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices of the object in.
+	 */
+	void prepareObject(const std::string &objectName, const std::string &objectFilePath, const VertexFormat &vertexFormat = INTERLEAVED_FLOAT)
+	{
+		if (namedObjects.contains(nameInterner.intern(objectName)) || preparingObjects.find(objectName) != preparingObjects.end())
+		{
+			return;
+		}
+		preparingObjects.emplace(objectName, [objectName, objectFilePath, vertexFormat]() { return prepareObjectData(objectName, objectFilePath, vertexFormat); });
+	}
+
+	/**
+	 * Check if the object with the given name can be created without waiting for a worker thread.
+	 * 
+	 * @param objectName  The name of the object.
+	 * 
+	 * @return Whether the object is not being prepared anymore.
+	 */
+	bool isObjectPrepared(const std::string &objectName) const
+	{
+		const auto preparingObject = preparingObjects.find(objectName);
+		return preparingObject == preparingObjects.end() || preparingObject->second.isReady();
+	}
+
+	/**
+	 * Load and create an object from the given object file path. If an object with the same name was already created,
+	 * return the same object. If the object was prepared with prepareObject, its prepared data is used (waiting for it if needed).
+	 * 
+	 * @param objectName      The name of the object.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices of the object in.
+	 * 
+	 * @return The details of the loaded object.
+	 */
+	std::shared_ptr<const ObjectDetails> createObject(const std::string &objectName, const std::string &objectFilePath, const VertexFormat &vertexFormat = INTERLEAVED_FLOAT)
+	{
+		// Check if an object with the name already exists.
+		const auto objectNameId = nameInterner.intern(objectName);
+		const auto existingObject = namedObjects.find(objectNameId);
+		if (existingObject != nullptr)
+		{
+			// Object already loaded. Take it out of the residency cache if it had no references, increase its reference count and return it.
+			residencyCache.acquire(objectName);
+			namedObjects.addReference(objectNameId);
+			return existingObject;
+		}
+
+		// Take the data of the object if it was being prepared, or prepare it now.
+		STARTUP_PHASE("Object Upload", objectName);
+		std::shared_ptr<PreparedObject> preparedObject;
+		const auto preparingObject = preparingObjects.find(objectName);
+		if (preparingObject != preparingObjects.end())
+		{
+			preparedObject = preparingObject->second.get();
+			preparingObjects.erase(preparingObject);
+		}
+		else
+		{
+			preparedObject = prepareObjectData(objectName, objectFilePath, vertexFormat);
+		}
+
+		// Create the buffers for the vertex information and indices.
+		GLuint vertexBufferId;
+		GLuint uvBufferId;
+		GLuint normalBufferId;
+		const auto vertexCount = preparedObject->vertexCount;
+		createVertexBuffers(objectName, preparedObject->vertexFormat, vertexCount, preparedObject->vertexStream, &vertexBufferId, &uvBufferId, &normalBufferId);
+		const auto indexBufferId = createBuffer(objectName, preparedObject->indexStream, preparedObject->indexCount * sizeof(uint32_t));
+
+		// Create the vertex array object of the object.
+		const auto vertexArrayId = createVertexArray(preparedObject->vertexFormat, vertexBufferId, uvBufferId, normalBufferId, indexBufferId);
+		glDebugManager.labelObject(GL_VERTEX_ARRAY, vertexArrayId, objectName);
+
+		// Find the ranges of the indices of the levels of detail, which are stored one after the other.
+		std::array<ObjectLod, OBJECT_LOD_COUNT> lods = {};
+		uint32_t lodsCount = 0;
+		for (uint32_t indexOffset = 0; lodsCount < OBJECT_LOD_COUNT && preparedObject->lodIndexCounts[lodsCount] > 0; lodsCount++)
+		{
+			lods[lodsCount] = {indexOffset, preparedObject->lodIndexCounts[lodsCount]};
+			indexOffset += preparedObject->lodIndexCounts[lodsCount];
+		}
+
+		// Create a new object details with the captured data.
+		const auto newObject = std::make_shared<ObjectDetails>(objectName, objectFilePath, preparedObject->vertexFormat, std::move(preparedObject->vertices), vertexBufferId, uvBufferId, normalBufferId, indexBufferId, vertexArrayId, vertexCount, lods[0].indexCount, lods, lodsCount, preparedObject->minCorner, preparedObject->maxCorner, preparedObject->boundingRadius, preparedObject->axialRadius, preparedObject->originalAcmr, preparedObject->optimizedAcmr);
+
+		// Register the newly created object with a reference count of 1.
+		namedObjects.insert(objectNameId, newObject);
+
+		// Return the object details.
+		return newObject;
+	}
+
+	/**
+	 * Check if the object with the given name is created, whether it is referenced or only kept in the residency cache.
+	 * 
+	 * @param objectName  The name of the object.
+	 * 
+	 * @return Whether the object is created or not.
+	 */
+	bool isObjectCreated(const std::string &objectName) const
+	{
+		return namedObjects.contains(nameInterner.intern(objectName));
+	}
+
+	/**
+   * Return the object created with the given name.
+   * 
+   * @param objectName  The name of the object to return.
+   * 
+   * @return The object created with the given name.
+   */
+	std::shared_ptr<const ObjectDetails> getObjectDetails(const std::string &objectName) const
+	{
+		return namedObjects.at(nameInterner.intern(objectName));
+	}
+
+	/**
+	 * Delete a reference to the object, and destroy it if no more references are present.
+	 * 
+	 * @param objectDetails  The details of the object to destroy.
+	 */
+	void destroyObject(const std::shared_ptr<const ObjectDetails> &objectDetails)
+	{
+		// Reduce the reference count of the object, and check if there are no more references to it.
+		if (namedObjects.removeReference(nameInterner.intern(objectDetails->getObjectName())) <= 0)
+		{
+			// No more references left, so keep it in the residency cache, and clean the objects that do not fit the budget anymore.
+			const uint64_t objectSize = getVertexStreamSize(objectDetails->getVertexFormat(), objectDetails->getVertexCount()) + (static_cast<uint64_t>(objectDetails->getTotalIndexCount()) * sizeof(uint32_t));
+			for (const auto &evictedObjectName : residencyCache.release(objectDetails->getObjectName(), objectSize))
+			{
+				deleteObject(evictedObjectName);
+			}
+		}
+	}
+
+	/**
+	 * Parse the OBJ object file and write it as a cooked mesh cache, which is loaded instead of the OBJ file while it is unchanged
+	 *   (for the asset cook, without a GL context).
+	 * 
+	 * @param objectFilePath  The file path to the object data.
+	 * @param cookedFilePath  The file path to write the cooked mesh cache to.
+	 * @param vertexFormat    The format to store the vertices in, which must be the one the object is created with.
+	 * 
+	 * @return Whether the cooked mesh cache was written or not.
+	 */
+	static bool cookObject(const std::string &objectFilePath, const std::string &cookedFilePath, const VertexFormat &vertexFormat = INTERLEAVED_FLOAT)
+	{
+		MeshCacheHeader header;
+		if (!createMeshCacheHeader(objectFilePath, vertexFormat, header))
+		{
+			return false;
 		}
+		PreparedObject preparedObject;
+		parseObjectData(objectFilePath, objectFilePath, vertexFormat, preparedObject);
+		return writeObjectCache(cookedFilePath, header, preparedObject);
 	}
 
 	/**
@@ -0,0 +1,509 @@
+#ifndef INCLUDE_OCCLUSION_CULLING_CPP
+#define INCLUDE_OCCLUSION_CULLING_CPP
+
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Structure for defining a pyramid of the farthest depths of the view of a camera, each level half the size of the one before it
+ *   (rounded up) down to a single texel.
+ */
+struct DepthPyramid
+{
+  // The depths of each level, row by row from the bottom of the view.
+  std::vector<std::vector<float_t>> levels;
+  // The size of each level in texels.
+  std::vector<glm::ivec2> levelSizes;
+  // The number of levels filled (0 if there is no depth to test against).
+  uint32_t levelsCount;
+  // The view projection matrix of the camera the depths were captured with.
+  glm::mat4 viewProjectionMatrix;
+};
+
+/**
+ * Class for culling the models hidden behind the depth of the last frames (hierarchical-Z occlusion culling).
+ * The depth of the models drawn each frame is reduced on the GPU into a pyramid of the farthest depths, whose coarsest GPU level
+ *   is read back without waiting for the GPU (so the depth is a few frames old). The rest of the pyramid is reduced on the CPU,
+ *   and the world AABBs of the models are tested against the level they cover at most 2x2 texels of, with the view projection
+ *   matrix the depth was captured with: a box whose closest depth is farther than the farthest depth it covers is hidden.
+ * The pyramid is captured on the thread owning the GL context and tested while the render packets are filled, so it is handed
+ *   over under a lock.
+ */
+class OcclusionCuller
+{
+private:
+  /**
+   * Structure for defining a readback of the coarsest GPU level of the depth pyramid.
+   */
+  struct DepthReadback
+  {
+    // The ID of the pixel buffer the level is read into.
+    GLuint pixelBufferId;
+    // The fence signaled once the level is read (null if the readback is not in flight).
+    GLsync fence;
+    // The size of the part of the level read.
+    glm::ivec2 size;
+    // The view projection matrix of the camera the depth was captured with.
+    glm::mat4 viewProjectionMatrix;
+  };
+
+  // The shader manager responsible for creating the depth reduction shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the render targets are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program reducing a level of the depth pyramid to the next one.
+  const std::shared_ptr<const ShaderDetails> reduceShaderDetails;
+  // The uniform IDs of the depth reduction shader.
+  const GLuint sourceDepthTextureUniformId;
+  const GLuint sourceSizeUniformId;
+
+  // The framebuffer the depth of the scene is copied into, with its single-sampled depth texture.
+  GLuint depthFramebufferId;
+  GLuint depthTextureId;
+  // The size of the viewport the depth copy and the GPU levels of the depth pyramid were created for.
+  glm::ivec2 targetSize;
+  // The framebuffers the GPU levels of the depth pyramid are reduced into, with their textures and sizes.
+  std::vector<GLuint> levelFramebufferIds;
+  std::vector<GLuint> levelTextureIds;
+  std::vector<glm::ivec2> levelTextureSizes;
+  // The empty vertex array object the fullscreen triangles are drawn with (their vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  // The readbacks of the coarsest GPU level, used in turn.
+  std::array<DepthReadback, HI_Z_READBACK_BUFFERS> readbacks;
+  // The index of the oldest readback, which is the next one to be used.
+  uint32_t nextReadbackIndex;
+
+  // The lock of the latest depth pyramid.
+  std::mutex pyramidMutex;
+  // The latest depth pyramid read back, written on the thread owning the GL context.
+  DepthPyramid latestPyramid;
+  // The depth pyramid the models are tested against, taken from the latest one before testing them.
+  DepthPyramid testPyramid;
+
+  /**
+   * Get the size of the next level of the depth pyramid.
+   * 
+   * @param size  The size of the level.
+   * 
+   * @return The size of the next level, half the size of the level rounded up.
+   */
+  static glm::ivec2 getNextLevelSize(const glm::ivec2 &size)
+  {
+    return (size + 1) / 2;
+  }
+
+  /**
+   * Create a framebuffer rendering into the given texture.
+   * 
+   * @param textureId   The ID of the texture.
+   * @param attachment  The attachment point of the texture.
+   * 
+   * @return The ID of the created framebuffer.
+   */
+  static GLuint createFramebuffer(const GLuint &textureId, const GLenum &attachment)
+  {
+    GLuint framebufferId;
+    glGenFramebuffers(1, &framebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textureId, 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return framebufferId;
+  }
+
+  /**
+   * Create a texture with a single level, read with texel fetches.
+   * 
+   * @param size            The size of the texture.
+   * @param internalFormat  The internal format of the texels.
+   * @param format          The format of the (missing) texel data.
+   * @param type            The type of the (missing) texel data.
+   * 
+   * @return The ID of the created texture.
+   */
+  static GLuint createTexture(const glm::ivec2 &size, const GLint &internalFormat, const GLenum &format, const GLenum &type)
+  {
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, internalFormat, size.x, size.y, format, type, nullptr, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+  }
+
+  /**
+   * Reduce the finest level of the given depth pyramid down to a single texel, keeping the farthest depth of the 2x2 texels each
+   *   texel covers the same way as the GPU levels.
+   * 
+   * @param pyramid  The depth pyramid, with the size and the depths of its finest level filled.
+   */
+  static void reducePyramid(DepthPyramid &pyramid)
+  {
+    pyramid.levelsCount = 1;
+    while (pyramid.levelSizes[pyramid.levelsCount - 1] != glm::ivec2(1) && pyramid.levelsCount < pyramid.levels.size())
+    {
+      const auto &sourceSize = pyramid.levelSizes[pyramid.levelsCount - 1];
+      const auto &sourceDepths = pyramid.levels[pyramid.levelsCount - 1];
+      const auto size = getNextLevelSize(sourceSize);
+      auto &depths = pyramid.levels[pyramid.levelsCount];
+      depths.resize(size.x * size.y);
+      for (int32_t y = 0; y < size.y; y++)
+      {
+        const auto y0 = (2 * y) * sourceSize.x, y1 = std::min((2 * y) + 1, sourceSize.y - 1) * sourceSize.x;
+        for (int32_t x = 0; x < size.x; x++)
+        {
+          const auto x0 = 2 * x, x1 = std::min((2 * x) + 1, sourceSize.x - 1);
+          depths[(y * size.x) + x] = std::max(std::max(sourceDepths[y0 + x0], sourceDepths[y0 + x1]), std::max(sourceDepths[y1 + x0], sourceDepths[y1 + x1]));
+        }
+      }
+      pyramid.levelSizes[pyramid.levelsCount] = size;
+      pyramid.levelsCount++;
+    }
+  }
+
+  /**
+   * Read back the depth pyramid levels that are done being read by the GPU, reducing the latest one into the latest depth pyramid.
+   * Never waits for the GPU.
+   */
+  void collectReadbacks()
+  {
+    for (uint32_t i = 0; i < readbacks.size(); i++)
+    {
+      // Check the readbacks from the oldest to the newest, stopping at the first one still in flight.
+      auto &readback = readbacks[(nextReadbackIndex + i) % readbacks.size()];
+      if (readback.fence == nullptr)
+      {
+        continue;
+      }
+      const auto waitResult = glClientWaitSync(readback.fence, 0, 0);
+      if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+      {
+        break;
+      }
+      glDeleteSync(readback.fence);
+      readback.fence = nullptr;
+
+      // Copy the level into the finest level of the latest depth pyramid, and reduce the rest of the pyramid from it.
+      const auto levelSize = static_cast<size_t>(readback.size.x * readback.size.y);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+      const auto depths = static_cast<const float_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, levelSize * sizeof(float_t), GL_MAP_READ_BIT));
+      if (depths != nullptr)
+      {
+        const std::lock_guard<std::mutex> lock(pyramidMutex);
+        latestPyramid.levels[0].assign(depths, depths + levelSize);
+        latestPyramid.levelSizes[0] = readback.size;
+        latestPyramid.viewProjectionMatrix = readback.viewProjectionMatrix;
+        reducePyramid(latestPyramid);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+  }
+
+  /**
+   * Create the copy of the depth of the scene and the GPU levels of the depth pyramid at the given size of the viewport, with the
+   *   pixel buffers the coarsest level is read back into.
+   * 
+   * @param viewportSize  The size of the viewport of the window.
+   */
+  void createPyramidTargets(const glm::ivec2 &viewportSize)
+  {
+    // Create the copy of the depth of the scene, in the depth format of the window and the scene target so that it can be blitted.
+    targetSize = viewportSize;
+    depthTextureId = createTexture(viewportSize, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+    depthFramebufferId = createFramebuffer(depthTextureId, GL_DEPTH_STENCIL_ATTACHMENT);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, depthTextureId, GpuMemoryCategory::RENDER_TARGET, "Depth Pyramid", GpuMemoryManager::getTextureSize(viewportSize.x, viewportSize.y, 1, 4, false));
+
+    // Create the GPU levels of the depth pyramid, halving the size until the level is narrow enough to be read back.
+    auto levelSize = viewportSize;
+    do
+    {
+      levelSize = getNextLevelSize(levelSize);
+      levelTextureSizes.push_back(levelSize);
+      levelTextureIds.push_back(createTexture(levelSize, GL_R32F, GL_RED, GL_FLOAT));
+      levelFramebufferIds.push_back(createFramebuffer(levelTextureIds.back(), GL_COLOR_ATTACHMENT0));
+      gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, levelTextureIds.back(), GpuMemoryCategory::RENDER_TARGET, "Depth Pyramid", GpuMemoryManager::getTextureSize(levelSize.x, levelSize.y, 1, 4, false));
+    } while (levelSize.x > HI_Z_READBACK_WIDTH);
+
+    // Create the pixel buffers the coarsest GPU level is read back into.
+    const auto readbackSize = static_cast<GLsizeiptr>(levelSize.x * levelSize.y * sizeof(float_t));
+    for (auto &readback : readbacks)
+    {
+      glGenBuffers(1, &readback.pixelBufferId);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+      GlCalls::bufferData(GL_PIXEL_PACK_BUFFER, readbackSize, nullptr, GL_STREAM_READ);
+      gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, readback.pixelBufferId, GpuMemoryCategory::DYNAMIC, "Depth Pyramid", readbackSize);
+      readback.fence = nullptr;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Reserve the CPU levels of the latest depth pyramid up front, so that reading the pyramid back never allocates, forgetting
+    //   the depth captured at the old size. The pyramid the models are tested against grows to it when it is next acquired.
+    const std::lock_guard<std::mutex> lock(pyramidMutex);
+    latestPyramid.levels.clear();
+    latestPyramid.levelSizes.clear();
+    latestPyramid.levelsCount = 0;
+    for (auto size = levelSize;; size = getNextLevelSize(size))
+    {
+      latestPyramid.levels.emplace_back();
+      latestPyramid.levels.back().reserve(size.x * size.y);
+      latestPyramid.levelSizes.push_back(glm::ivec2(0));
+      if (size == glm::ivec2(1))
+      {
+        break;
+      }
+    }
+  }
+
+  /**
+   * Delete the copy of the depth of the scene, the GPU levels of the depth pyramid and its pixel buffers, dropping the readbacks
+   *   still in flight.
+   */
+  void deletePyramidTargets()
+  {
+    GlCalls::deleteFramebuffers(1, &depthFramebufferId);
+    GlCalls::deleteTextures(1, &depthTextureId);
+    gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, depthTextureId);
+    GlCalls::deleteFramebuffers(levelFramebufferIds.size(), levelFramebufferIds.data());
+    GlCalls::deleteTextures(levelTextureIds.size(), levelTextureIds.data());
+    for (const auto &levelTextureId : levelTextureIds)
+    {
+      gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, levelTextureId);
+    }
+    levelFramebufferIds.clear();
+    levelTextureIds.clear();
+    levelTextureSizes.clear();
+    for (auto &readback : readbacks)
+    {
+      if (readback.fence != nullptr)
+      {
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+      }
+      glDeleteBuffers(1, &readback.pixelBufferId);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, readback.pixelBufferId);
+    }
+    nextReadbackIndex = 0;
+  }
+
+public:
+  OcclusionCuller()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        reduceShaderDetails(shaderManager.createShaderProgram("OcclusionCuller::Reduce", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/depth_reduce.glsl")),
+        sourceDepthTextureUniformId(shaderManager.getUniformId("sourceDepthTexture")),
+        sourceSizeUniformId(shaderManager.getUniformId("sourceSize")),
+        depthFramebufferId(0),
+        depthTextureId(0),
+        targetSize(0),
+        levelFramebufferIds({}),
+        levelTextureIds({}),
+        levelTextureSizes({}),
+        vertexArrayId(0),
+        readbacks({}),
+        nextReadbackIndex(0),
+        pyramidMutex(),
+        latestPyramid({{}, {}, 0, glm::mat4(1.0f)}),
+        testPyramid({{}, {}, 0, glm::mat4(1.0f)})
+  {
+    createPyramidTargets(glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT));
+
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~OcclusionCuller()
+  {
+    // Destroy the depth reduction shader.
+    shaderManager.destroyShaderProgram(reduceShaderDetails);
+    // Delete the framebuffers, textures and pixel buffers of the depth pyramid.
+    deletePyramidTargets();
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+  }
+
+  // Preventing copying the occlusion culler, since it owns GPU resources.
+  OcclusionCuller(const OcclusionCuller &) = delete;
+
+  /**
+   * Capture the depth of the models drawn in the current frame into the depth pyramid, and collect the readbacks of the earlier
+   *   frames. Skipped if all the readbacks are still in flight, so that the GPU is never waited for.
+   * The depth pyramid is created again once the viewport of the window is resized, forgetting the depth of the old size.
+   * The scene framebuffer is bound again with the given viewport once done.
+   * 
+   * @param sceneFramebufferId    The ID of the framebuffer the scene is rendered into (0 for the window).
+   * @param sceneSize             The size of the viewport the scene is rendered with.
+   * @param viewProjectionMatrix  The view projection matrix of the camera the scene is rendered with.
+   */
+  void captureDepth(const GLuint &sceneFramebufferId, const glm::ivec2 &sceneSize, const glm::mat4 &viewProjectionMatrix)
+  {
+    if (targetSize != glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT))
+    {
+      deletePyramidTargets();
+      createPyramidTargets(glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT));
+    }
+    collectReadbacks();
+    auto &readback = readbacks[nextReadbackIndex];
+    if (readback.fence != nullptr)
+    {
+      return;
+    }
+
+    // Copy the depth of the scene, which may be multisampled, into the single-sampled depth texture.
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::bindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFramebufferId);
+    glBlitFramebuffer(0, 0, sceneSize.x, sceneSize.y, 0, 0, sceneSize.x, sceneSize.y, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    // Reduce the depth into each GPU level of the pyramid, only covering the part of the levels the scene viewport reaches.
+    GlCalls::disable(GL_DEPTH_TEST);
+    GlCalls::useProgram(reduceShaderDetails->getShaderId());
+    GlCalls::uniform1i(reduceShaderDetails->getUniformLocation(sourceDepthTextureUniformId), 0);
+    GlCalls::bindVertexArray(vertexArrayId);
+    GlCalls::activeTexture(GL_TEXTURE0);
+    auto sourceTextureId = depthTextureId;
+    auto sourceSize = sceneSize;
+    for (uint32_t i = 0; i < levelTextureIds.size(); i++)
+    {
+      const auto levelSize = getNextLevelSize(sourceSize);
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, levelFramebufferIds[i]);
+      GlCalls::viewport(0, 0, levelSize.x, levelSize.y);
+      GlCalls::bindTexture(GL_TEXTURE_2D, sourceTextureId);
+      GlCalls::uniform2i(reduceShaderDetails->getUniformLocation(sourceSizeUniformId), sourceSize.x, sourceSize.y);
+      GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+      sourceTextureId = levelTextureIds[i];
+      sourceSize = levelSize;
+    }
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    GlCalls::bindVertexArray(0);
+    GlCalls::enable(GL_DEPTH_TEST);
+
+    // Start reading the coarsest GPU level back into the pixel buffer of the readback, to be collected in a later frame.
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, levelFramebufferIds.back());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+    glReadPixels(0, 0, sourceSize.x, sourceSize.y, GL_RED, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.size = sourceSize;
+    readback.viewProjectionMatrix = viewProjectionMatrix;
+    nextReadbackIndex = (nextReadbackIndex + 1) % readbacks.size();
+
+    // Bind the scene framebuffer again for whatever is drawn into the scene after the models.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+  }
+
+  /**
+   * Forget the depth pyramid, so that no model is culled until the depth is captured again (e.g. when the models drawn stop
+   *   hiding the ones behind them).
+   */
+  void invalidate()
+  {
+    const std::lock_guard<std::mutex> lock(pyramidMutex);
+    latestPyramid.levelsCount = 0;
+  }
+
+  /**
+   * Take the latest depth pyramid to test the models against, until it is taken again. Not to be called while any models are
+   *   being tested.
+   * 
+   * @return Whether there is a depth pyramid to test against or not.
+   */
+  bool acquireDepthPyramid()
+  {
+    const std::lock_guard<std::mutex> lock(pyramidMutex);
+    // Grow the levels to the ones of the latest depth pyramid, which only gets more of them once the viewport is resized.
+    if (testPyramid.levels.size() < latestPyramid.levels.size())
+    {
+      testPyramid.levels.resize(latestPyramid.levels.size());
+      testPyramid.levelSizes.resize(latestPyramid.levels.size(), glm::ivec2(0));
+    }
+    testPyramid.levelsCount = latestPyramid.levelsCount;
+    testPyramid.viewProjectionMatrix = latestPyramid.viewProjectionMatrix;
+    for (uint32_t i = 0; i < latestPyramid.levelsCount; i++)
+    {
+      testPyramid.levels[i].assign(latestPyramid.levels[i].begin(), latestPyramid.levels[i].end());
+      testPyramid.levelSizes[i] = latestPyramid.levelSizes[i];
+    }
+    return testPyramid.levelsCount > 0;
+  }
+
+  /**
+   * Check if the given world AABB is hidden behind the depth of the acquired depth pyramid. Can be called from any thread.
+   * 
+   * @param minCorner  The corner of the box with the smallest coordinates.
+   * @param maxCorner  The corner of the box with the largest coordinates.
+   * 
+   * @return Whether the box is hidden or not (never if there is no depth pyramid, or the box was not fully in front of the camera).
+   */
+  bool isBoxOccluded(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const
+  {
+    if (testPyramid.levelsCount == 0)
+    {
+      return false;
+    }
+
+    // Project the corners of the box with the camera the depth was captured with, finding the screen area and closest depth it covers.
+    auto ndcMin = glm::vec3(std::numeric_limits<float_t>::max()), ndcMax = glm::vec3(std::numeric_limits<float_t>::lowest());
+    for (auto corner = 0; corner < 8; corner++)
+    {
+      const auto cornerPosition = glm::vec3(corner & 1 ? maxCorner.x : minCorner.x, corner & 2 ? maxCorner.y : minCorner.y, corner & 4 ? maxCorner.z : minCorner.z);
+      const auto cornerPosition_clipSpace = testPyramid.viewProjectionMatrix * glm::vec4(cornerPosition, 1.0f);
+      // The boxes reaching in front of the near plane cannot be projected, so they are never hidden.
+      if (cornerPosition_clipSpace.w <= 0.0f || cornerPosition_clipSpace.z < -cornerPosition_clipSpace.w)
+      {
+        return false;
+      }
+      const auto cornerPosition_ndc = glm::vec3(cornerPosition_clipSpace) / cornerPosition_clipSpace.w;
+      ndcMin = glm::min(ndcMin, cornerPosition_ndc);
+      ndcMax = glm::max(ndcMax, cornerPosition_ndc);
+    }
+    // The boxes outside the captured view cannot be told to be hidden either.
+    if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+    {
+      return false;
+    }
+
+    // Find the texels of the finest level the screen area covers, and go down the levels until it covers at most 2x2 texels.
+    const auto &finestSize = testPyramid.levelSizes[0];
+    auto minTexel = glm::clamp(glm::ivec2(glm::floor(((glm::vec2(ndcMin) * 0.5f) + 0.5f) * glm::vec2(finestSize))), glm::ivec2(0), finestSize - 1);
+    auto maxTexel = glm::clamp(glm::ivec2(glm::floor(((glm::vec2(ndcMax) * 0.5f) + 0.5f) * glm::vec2(finestSize))), glm::ivec2(0), finestSize - 1);
+    uint32_t level = 0;
+    while (level + 1 < testPyramid.levelsCount && (maxTexel.x - minTexel.x > 1 || maxTexel.y - minTexel.y > 1))
+    {
+      minTexel /= 2;
+      maxTexel /= 2;
+      level++;
+    }
+
+    // Check if the closest depth of the box is farther than the farthest depth of the texels it covers.
+    const auto &depths = testPyramid.levels[level];
+    const auto &levelSize = testPyramid.levelSizes[level];
+    auto farthestDepth = 0.0f;
+    for (auto y = minTexel.y; y <= maxTexel.y; y++)
+    {
+      for (auto x = minTexel.x; x <= maxTexel.x; x++)
+      {
+        farthestDepth = std::max(farthestDepth, depths[(y * levelSize.x) + x]);
+      }
+    }
+    return (ndcMin.z * 0.5f) + 0.5f > farthestDepth + HI_Z_DEPTH_BIAS;
+  }
+};
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef INCLUDE_OCCLUSION_QUERY_CPP
+#define INCLUDE_OCCLUSION_QUERY_CPP
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "gl_stats.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for defining how often the occlusion queries of a model type found its models hidden.
+ */
+struct OcclusionQueryStats
+{
+  // The number of queries read back (halved along with the hidden ones once it reaches the statistics window, so that the hit
+  //   rate follows the recent frames).
+  uint32_t queriesCount;
+  // The number of the queries read back that found the models hidden.
+  uint32_t hiddenCount;
+};
+
+/**
+ * Class for drawing the expensive model groups behind occlusion queries of their world AABBs, tested against the depth of the
+ *   models drawn before them in the frame. The models are drawn with conditional rendering, which skips the draws on the GPU if
+ *   the query found no sample of the box visible, without waiting for it (the models are drawn if the result is not ready yet),
+ *   so the CPU never waits for the queries.
+ * The results are also read back a few frames later, when they are available, for the hit rates of the model types.
+ */
+class OcclusionQueries
+{
+private:
+  /**
+   * Structure for defining the queries issued in a frame.
+   */
+  struct QuerySet
+  {
+    // The IDs of the query objects, the used ones first (kept around to be issued again).
+    std::vector<GLuint> queryIds;
+    // The model types of the used queries.
+    std::vector<ModelTypeId> modelTypeIds;
+    // The number of the used queries.
+    uint32_t usedCount;
+  };
+
+  // The shader manager responsible for creating the box shader.
+  ShaderManager &shaderManager;
+
+  // The shader program drawing the boxes of the queries.
+  const std::shared_ptr<const ShaderDetails> boxShaderDetails;
+  // The uniform IDs of the box shader.
+  const GLuint viewProjectionMatrixUniformId;
+  const GLuint boxMinCornerUniformId;
+  const GLuint boxMaxCornerUniformId;
+
+  // The empty vertex array object the boxes are drawn with (their vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  // The queries of the last frames, used in turn.
+  std::array<QuerySet, OCCLUSION_QUERY_FRAMES> querySets;
+  // The index of the queries of the current frame.
+  uint32_t currentSetIndex;
+  // The hit rates of the model types, by the model type IDs.
+  std::vector<OcclusionQueryStats> stats;
+
+public:
+  OcclusionQueries()
+      : shaderManager(ShaderManager::getInstance()),
+        boxShaderDetails(shaderManager.createShaderProgram("OcclusionQueries::Box", "assets/shaders/vertex/occlusion_box.glsl", "assets/shaders/fragment/depth.glsl")),
+        viewProjectionMatrixUniformId(shaderManager.getUniformId("viewProjectionMatrix")),
+        boxMinCornerUniformId(shaderManager.getUniformId("boxMinCorner")),
+        boxMaxCornerUniformId(shaderManager.getUniformId("boxMaxCorner")),
+        vertexArrayId(0),
+        querySets({}),
+        currentSetIndex(0),
+        stats({})
+  {
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~OcclusionQueries()
+  {
+    // Destroy the box shader.
+    shaderManager.destroyShaderProgram(boxShaderDetails);
+    // Delete the vertex array object and the query objects.
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+    for (const auto &querySet : querySets)
+    {
+      if (!querySet.queryIds.empty())
+      {
+        glDeleteQueries(static_cast<GLsizei>(querySet.queryIds.size()), querySet.queryIds.data());
+      }
+    }
+  }
+
+  // Preventing copying the occlusion queries, since they own GPU resources.
+  OcclusionQueries(const OcclusionQueries &) = delete;
+
+  /**
+   * Start the queries of a new frame, reusing the queries of the oldest frame once their results available are read back into the
+   *   hit rates of their model types. Never waits for the GPU, the results not available by then being dropped.
+   */
+  void beginFrame()
+  {
+    currentSetIndex = (currentSetIndex + 1) % OCCLUSION_QUERY_FRAMES;
+    auto &querySet = querySets[currentSetIndex];
+    for (uint32_t i = 0; i < querySet.usedCount; i++)
+    {
+      GLuint isAvailable = GL_FALSE;
+      glGetQueryObjectuiv(querySet.queryIds[i], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+      if (isAvailable == GL_FALSE)
+      {
+        continue;
+      }
+      GLuint isAnySamplePassed = GL_FALSE;
+      glGetQueryObjectuiv(querySet.queryIds[i], GL_QUERY_RESULT, &isAnySamplePassed);
+
+      const auto &modelTypeId = querySet.modelTypeIds[i];
+      if (modelTypeId >= stats.size())
+      {
+        stats.resize(modelTypeId + 1, {0, 0});
+      }
+      auto &modelTypeStats = stats[modelTypeId];
+      modelTypeStats.queriesCount++;
+      modelTypeStats.hiddenCount += isAnySamplePassed == GL_FALSE ? 1 : 0;
+      if (modelTypeStats.queriesCount >= OCCLUSION_QUERY_STATS_WINDOW)
+      {
+        modelTypeStats.queriesCount /= 2;
+        modelTypeStats.hiddenCount /= 2;
+      }
+    }
+    querySet.usedCount = 0;
+  }
+
+  /**
+   * Issue an occlusion query of the given world AABB against the depth of the bound render target, drawing the box without
+   *   writing any color or depth. The box is not queried if the camera is inside it, since its faces behind the camera would be
+   *   clipped away. Binds the program and the vertex array object of the boxes, so the state of the models has to be set again.
+   * 
+   * @param modelTypeId           The ID of the model type of the models inside the box, for its hit rate.
+   * @param minCorner             The corner of the box with the smallest coordinates.
+   * @param maxCorner             The corner of the box with the largest coordinates.
+   * @param cameraPosition        The position of the camera.
+   * @param viewProjectionMatrix  The view projection matrix of the camera.
+   * @param isColorWritten        Whether colors are written once the box is drawn.
+   * @param isDepthWritten        Whether the depth is written once the box is drawn.
+   * 
+   * @return The ID of the query, or 0 if the box is not queried.
+   */
+  GLuint issueQuery(const ModelTypeId &modelTypeId, const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &cameraPosition, const glm::mat4 &viewProjectionMatrix, const bool &isColorWritten, const bool &isDepthWritten)
+  {
+    if (glm::all(glm::greaterThanEqual(cameraPosition, minCorner)) && glm::all(glm::lessThanEqual(cameraPosition, maxCorner)))
+    {
+      return 0;
+    }
+
+    // Take the next query of the frame, creating it if all of them are used.
+    auto &querySet = querySets[currentSetIndex];
+    if (querySet.usedCount == querySet.queryIds.size())
+    {
+      GLuint queryId;
+      glGenQueries(1, &queryId);
+      querySet.queryIds.push_back(queryId);
+      querySet.modelTypeIds.push_back(0);
+    }
+    const auto queryId = querySet.queryIds[querySet.usedCount];
+    querySet.modelTypeIds[querySet.usedCount] = modelTypeId;
+    querySet.usedCount++;
+
+    // Draw the box inside the query, without touching the render target.
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    GlCalls::depthMask(GL_FALSE);
+    GlCalls::useProgram(boxShaderDetails->getShaderId());
+    GlCalls::uniformMatrix4fv(boxShaderDetails->getUniformLocation(viewProjectionMatrixUniformId), 1, GL_FALSE, &viewProjectionMatrix[0][0]);
+    GlCalls::uniform4f(boxShaderDetails->getUniformLocation(boxMinCornerUniformId), minCorner.x, minCorner.y, minCorner.z, 1.0f);
+    GlCalls::uniform4f(boxShaderDetails->getUniformLocation(boxMaxCornerUniformId), maxCorner.x, maxCorner.y, maxCorner.z, 1.0f);
+    GlCalls::bindVertexArray(vertexArrayId);
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, queryId);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 36);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    GlCalls::bindVertexArray(0);
+    const auto colorMask = isColorWritten ? GL_TRUE : GL_FALSE;
+    glColorMask(colorMask, colorMask, colorMask, colorMask);
+    GlCalls::depthMask(isDepthWritten ? GL_TRUE : GL_FALSE);
+    return queryId;
+  }
+
+  /**
+   * Start skipping the draws on the GPU if the given query found its box hidden, drawing them if its result is not ready yet.
+   * 
+   * @param queryId  The ID of the query (0 to always draw).
+   */
+  static void beginConditionalRender(const GLuint &queryId)
+  {
+    if (queryId != 0)
+    {
+      glBeginConditionalRender(queryId, GL_QUERY_NO_WAIT);
+    }
+  }
+
+  /**
+   * Stop skipping the draws for the given query.
+   * 
+   * @param queryId  The ID of the query conditional rendering was started with (0 if it was not).
+   */
+  static void endConditionalRender(const GLuint &queryId)
+  {
+    if (queryId != 0)
+    {
+      glEndConditionalRender();
+    }
+  }
+
+  /**
+   * Get how often the occlusion queries of the given model type found its models hidden.
+   * 
+   * @param modelTypeId  The ID of the model type.
+   * 
+   * @return The hit rate of the model type (no queries if it was never queried).
+   */
+  OcclusionQueryStats getStats(const ModelTypeId &modelTypeId) const
+  {
+    return modelTypeId < stats.size() ? stats[modelTypeId] : OcclusionQueryStats{0, 0};
+  }
+};
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef INCLUDE_PICKING_CPP
+#define INCLUDE_PICKING_CPP
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for defining a request to pick the model under a point of the screen, filled into the render packets.
+ */
+struct PickRequest
+{
+  // The ID of the request, counted from 1 (0 if no pick is requested).
+  uint64_t requestId;
+  // The point of the screen, normalized with the top-left corner at (0, 0) like the cursor position.
+  glm::vec2 screenPosition;
+  // The collision layers of the models that can be picked, the other models being drawn through.
+  uint32_t collisionMask;
+};
+
+/**
+ * Structure for defining the model picked by a request.
+ */
+struct PickResult
+{
+  // The ID of the request the model was picked for (0 if no request was read back yet).
+  uint64_t requestId;
+  // The model closest to the camera under the point of the request, or null if there was none. Only meant to be compared with the
+  //   models, since it may have been destroyed since it was picked.
+  const ModelBaseIntf *model;
+};
+
+/**
+ * Class for picking the model under a point of the screen on the GPU, by drawing the IDs of the pickable models into a single
+ *   pixel target, with a projection narrowed down to the pixel under the point so that only that pixel is rasterized.
+ * The pixel is read back into a pixel buffer without waiting for the GPU, so the model is picked a frame (or a few) after it was
+ *   requested. The pick is exact to the triangles of the models drawn, and the CPU only reads a single ID, however many models
+ *   the scene has.
+ * The models are drawn on the thread owning the GL context, and the results read back are handed over under a lock.
+ */
+class ModelPicker
+{
+private:
+  /**
+   * Structure for defining a readback of the ID under the point of a request.
+   */
+  struct PickReadback
+  {
+    // The ID of the pixel buffer the ID is read into.
+    GLuint pixelBufferId;
+    // The fence signaled once the ID is read (null if the readback is not in flight).
+    GLsync fence;
+    // The ID of the request.
+    uint64_t requestId;
+    // The models drawn for the request, by their IDs minus 1 (the ID 0 meaning no model).
+    std::vector<const ModelBaseIntf *> pickableModels;
+  };
+
+  // The shader manager responsible for creating the picking shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the render target is accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program drawing the IDs of the models.
+  const std::shared_ptr<const ShaderDetails> pickShaderDetails;
+  // The uniform IDs of the picking shader.
+  const GLuint viewProjectionMatrixUniformId;
+  const GLuint animationTimeUniformId;
+  const GLuint firstPickIdUniformId;
+
+  // The framebuffer the IDs are drawn into, with its single pixel ID and depth renderbuffers.
+  GLuint pickFramebufferId;
+  GLuint pickIdRenderbufferId;
+  GLuint pickDepthRenderbufferId;
+
+  // The readbacks of the picked IDs, used in turn.
+  std::array<PickReadback, PICKING_READBACK_BUFFERS> readbacks;
+  // The index of the oldest readback, which is the next one to be used.
+  uint32_t nextReadbackIndex;
+  // The request left waiting for a readback, when all of them were in flight (0 as its ID if there is none).
+  PickRequest deferredRequest;
+
+  // The lock of the latest result.
+  std::mutex resultMutex;
+  // The result of the latest request read back, written on the thread owning the GL context.
+  PickResult latestResult;
+
+  /**
+   * Read back the picked IDs that are done being read by the GPU, into the latest result. Never waits for the GPU.
+   */
+  void collectReadbacks()
+  {
+    for (uint32_t i = 0; i < readbacks.size(); i++)
+    {
+      // Check the readbacks from the oldest to the newest, stopping at the first one still in flight.
+      auto &readback = readbacks[(nextReadbackIndex + i) % readbacks.size()];
+      if (readback.fence == nullptr)
+      {
+        continue;
+      }
+      const auto waitResult = glClientWaitSync(readback.fence, 0, 0);
+      if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+      {
+        break;
+      }
+      glDeleteSync(readback.fence);
+      readback.fence = nullptr;
+
+      // Find the model of the ID read, if any.
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+      const auto pickId = static_cast<const uint32_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t), GL_MAP_READ_BIT));
+      if (pickId != nullptr)
+      {
+        const std::lock_guard<std::mutex> lock(resultMutex);
+        latestResult.requestId = readback.requestId;
+        latestResult.model = *pickId != 0 && *pickId <= readback.pickableModels.size() ? readback.pickableModels[*pickId - 1] : nullptr;
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+  }
+
+public:
+  ModelPicker()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        pickShaderDetails(shaderManager.createShaderProgram("ModelPicker", "assets/shaders/vertex/picking.glsl", "assets/shaders/fragment/picking.glsl")),
+        viewProjectionMatrixUniformId(shaderManager.getUniformId("viewProjectionMatrix")),
+        animationTimeUniformId(shaderManager.getUniformId("animationTime")),
+        firstPickIdUniformId(shaderManager.getUniformId("firstPickId")),
+        pickFramebufferId(0),
+        pickIdRenderbufferId(0),
+        pickDepthRenderbufferId(0),
+        readbacks({}),
+        nextReadbackIndex(0),
+        deferredRequest({0, glm::vec2(0.0f), 0}),
+        resultMutex(),
+        latestResult({0, nullptr})
+  {
+    // Create the single pixel target the IDs are drawn into, with a depth of its own so that the closest model is kept.
+    glGenFramebuffers(1, &pickFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, pickFramebufferId);
+    glGenRenderbuffers(1, &pickIdRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, pickIdRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+    gpuMemoryManager.recordAllocation(GpuResourceType::RENDERBUFFER, pickIdRenderbufferId, GpuMemoryCategory::RENDER_TARGET, "Picking", 4);
+    glGenRenderbuffers(1, &pickDepthRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, pickDepthRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+    gpuMemoryManager.recordAllocation(GpuResourceType::RENDERBUFFER, pickDepthRenderbufferId, GpuMemoryCategory::RENDER_TARGET, "Picking", 4);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, pickIdRenderbufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, pickDepthRenderbufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Create the pixel buffers the IDs are read back into.
+    for (auto &readback : readbacks)
+    {
+      glGenBuffers(1, &readback.pixelBufferId);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+      GlCalls::bufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t), nullptr, GL_STREAM_READ);
+      gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, readback.pixelBufferId, GpuMemoryCategory::DYNAMIC, "Picking", sizeof(uint32_t));
+      readback.fence = nullptr;
+      readback.requestId = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  ~ModelPicker()
+  {
+    // Destroy the picking shader.
+    shaderManager.destroyShaderProgram(pickShaderDetails);
+    // Delete the framebuffer, renderbuffers and pixel buffers of the picking.
+    GlCalls::deleteFramebuffers(1, &pickFramebufferId);
+    glDeleteRenderbuffers(1, &pickIdRenderbufferId);
+    glDeleteRenderbuffers(1, &pickDepthRenderbufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::RENDERBUFFER, pickIdRenderbufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::RENDERBUFFER, pickDepthRenderbufferId);
+    for (const auto &readback : readbacks)
+    {
+      if (readback.fence != nullptr)
+      {
+        glDeleteSync(readback.fence);
+      }
+      glDeleteBuffers(1, &readback.pixelBufferId);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, readback.pixelBufferId);
+    }
+  }
+
+  // Preventing copying the model picker, since it owns GPU resources.
+  ModelPicker(const ModelPicker &) = delete;
+
+  /**
+   * Collect the readbacks of the earlier frames, and start drawing the IDs of the models for the given request, or for the request
+   *   left waiting by an earlier frame if there is none. The request is left waiting if all the readbacks are still in flight, so
+   *   that the GPU is never waited for.
+   * The pickable models are then added with their IDs drawn, and the pick finished.
+   * 
+   * @param request               The request of the frame (0 as its ID if there is none).
+   * @param viewProjectionMatrix  The view projection matrix of the camera the scene is rendered with.
+   * @param animationTime         The time the spinning models are animated to.
+   * 
+   * @return The collision layers of the models to draw for the request, or 0 if no models are to be drawn.
+   */
+  uint32_t beginPick(const PickRequest &request, const glm::mat4 &viewProjectionMatrix, const float_t &animationTime)
+  {
+    collectReadbacks();
+    if (request.requestId != 0)
+    {
+      deferredRequest = request;
+    }
+    auto &readback = readbacks[nextReadbackIndex];
+    if (deferredRequest.requestId == 0 || readback.fence != nullptr)
+    {
+      return 0;
+    }
+    readback.requestId = deferredRequest.requestId;
+    readback.pickableModels.clear();
+
+    // Narrow the projection down to the pixel under the point of the request, scaling the pixel up to the whole clip space.
+    const auto pointPosition_ndc = glm::vec2((2.0f * deferredRequest.screenPosition.x) - 1.0f, 1.0f - (2.0f * deferredRequest.screenPosition.y));
+    const auto pickMatrix = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(VIEWPORT_WIDTH, VIEWPORT_HEIGHT, 1.0f)), glm::vec3(-pointPosition_ndc, 0.0f));
+    const auto pickViewProjectionMatrix = pickMatrix * viewProjectionMatrix;
+    deferredRequest.requestId = 0;
+
+    // Clear the pixel to no model, and draw the models into it with its own depth.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, pickFramebufferId);
+    GlCalls::viewport(0, 0, 1, 1);
+    const GLuint noPickId[] = {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 0, noPickId);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    GlCalls::useProgram(pickShaderDetails->getShaderId());
+    GlCalls::uniformMatrix4fv(pickShaderDetails->getUniformLocation(viewProjectionMatrixUniformId), 1, GL_FALSE, &pickViewProjectionMatrix[0][0]);
+    GlCalls::uniform1f(pickShaderDetails->getUniformLocation(animationTimeUniformId), animationTime);
+    return deferredRequest.collisionMask;
+  }
+
+  /**
+   * Add the models drawn next to the pick, giving them their IDs.
+   * 
+   * @param models      The models of the frame, in the same order as their model matrices.
+   * @param firstModel  The index of the first model drawn next.
+   * @param count       The number of models drawn next.
+   * 
+   * @return The ID of the first model drawn next.
+   */
+  uint32_t addPickableModels(const std::vector<std::shared_ptr<ModelBaseIntf>> &models, const uint32_t &firstModel, const uint32_t &count)
+  {
+    auto &pickableModels = readbacks[nextReadbackIndex].pickableModels;
+    const auto firstPickId = static_cast<uint32_t>(pickableModels.size()) + 1;
+    for (uint32_t i = firstModel; i < firstModel + count; i++)
+    {
+      pickableModels.push_back(models[i].get());
+    }
+    return firstPickId;
+  }
+
+  /**
+   * Set the ID of the first instance of the next draw, the IDs of the other instances following it.
+   * 
+   * @param firstPickId  The ID.
+   */
+  void setFirstPickId(const uint32_t &firstPickId) const
+  {
+    GlCalls::uniform1i(pickShaderDetails->getUniformLocation(firstPickIdUniformId), static_cast<GLint>(firstPickId));
+  }
+
+  /**
+   * Finish the pick, starting to read the ID drawn back into the pixel buffer of the readback, to be collected in a later frame.
+   * The scene framebuffer is bound again with the given viewport once done.
+   * 
+   * @param sceneFramebufferId  The ID of the framebuffer the scene is rendered into (0 for the window).
+   * @param sceneSize           The size of the viewport the scene is rendered with.
+   */
+  void endPick(const GLuint &sceneFramebufferId, const glm::ivec2 &sceneSize)
+  {
+    auto &readback = readbacks[nextReadbackIndex];
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, pickFramebufferId);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBufferId);
+    glReadPixels(0, 0, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextReadbackIndex = (nextReadbackIndex + 1) % readbacks.size();
+
+    // Bind the scene framebuffer again for whatever is drawn into the scene after the pick.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+  }
+
+  /**
+   * Get the result of the latest request read back. Can be called from any thread.
+   * 
+   * @return The result.
+   */
+  PickResult getLatestResult()
+  {
+    const std::lock_guard<std::mutex> lock(resultMutex);
+    return latestResult;
+  }
+};
+
+#endif
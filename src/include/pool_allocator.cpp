@@ -0,0 +1,176 @@
+#ifndef INCLUDE_POOL_ALLOCATOR_CPP
+#define INCLUDE_POOL_ALLOCATOR_CPP
+
+#include <new>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+/**
+ * A pool of fixed-size blocks carved out of slabs, handing out and taking back the blocks through a free list, so that the
+ *   objects allocated from it cost a pop or a push instead of a heap allocation, and sit next to each other in memory.
+ * There is one pool per block size and alignment, shared by all the types of that size, and the pools are never destroyed,
+ *   since the objects they hold may be released by other singletons after the end of main.
+ */
+template <size_t BlockSize, size_t BlockAlignment>
+class SlabPool
+{
+private:
+  // A block on the free list, overlaying the memory of the object it held.
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  // The size and the alignment of the blocks, large enough to hold a free block when they are free.
+  static constexpr size_t BLOCK_ALIGNMENT = std::max(BlockAlignment, alignof(FreeBlock));
+  static constexpr size_t BLOCK_SIZE = (std::max(BlockSize, sizeof(FreeBlock)) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+  // The number of blocks carved out of each slab.
+  static constexpr size_t SLAB_BLOCKS_COUNT = 64;
+
+  // The mutex guarding the free list, since the models can be created by the worker threads of the scene loader.
+  std::mutex mutex;
+  // The first free block, or null if all the blocks of the slabs are used.
+  FreeBlock *freeBlocks;
+
+  SlabPool()
+      : freeBlocks(nullptr) {}
+
+  /**
+   * Allocate a new slab and push all of its blocks to the free list, the first block on top.
+   */
+  void allocateSlab()
+  {
+    const auto slab = static_cast<unsigned char *>(::operator new(BLOCK_SIZE * SLAB_BLOCKS_COUNT, std::align_val_t(BLOCK_ALIGNMENT)));
+    for (size_t i = SLAB_BLOCKS_COUNT; i > 0; i--)
+    {
+      const auto block = reinterpret_cast<FreeBlock *>(slab + (i - 1) * BLOCK_SIZE);
+      block->next = freeBlocks;
+      freeBlocks = block;
+    }
+  }
+
+public:
+  // Preventing copying the pool, making sure only one instance can exist.
+  SlabPool(const SlabPool &) = delete;
+
+  /**
+   * Allocate a block, getting a new slab if there is no free block left.
+   * 
+   * @return The block.
+   */
+  void *allocate()
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (freeBlocks == nullptr)
+    {
+      allocateSlab();
+    }
+    const auto block = freeBlocks;
+    freeBlocks = block->next;
+    return block;
+  }
+
+  /**
+   * Return a block to the pool, to be handed out again by the next allocation.
+   * 
+   * @param block  The block, allocated from this pool.
+   */
+  void deallocate(void *block)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const auto freeBlock = static_cast<FreeBlock *>(block);
+    freeBlock->next = freeBlocks;
+    freeBlocks = freeBlock;
+  }
+
+  /**
+   * Returns the pool of the blocks of the size and alignment, created on its first use and never destroyed.
+   * 
+   * @return The pool instance.
+   */
+  static SlabPool &getInstance()
+  {
+    static auto *const instance = new SlabPool();
+    return *instance;
+  }
+};
+
+/**
+ * An allocator handing out single objects from the slab pool of their size and alignment, falling back to the heap for arrays.
+ *   Passed to std::allocate_shared, it places the object and its control block in a single pooled block, since the allocator is
+ *   rebound to the type of the control block.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+
+  PoolAllocator() noexcept {}
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+  /**
+   * Allocate the memory of the given number of objects.
+   * 
+   * @param count  The number of objects.
+   * 
+   * @return The memory of the objects.
+   */
+  T *allocate(const size_t count)
+  {
+    if (count != 1)
+    {
+      return std::allocator<T>().allocate(count);
+    }
+    return static_cast<T *>(SlabPool<sizeof(T), alignof(T)>::getInstance().allocate());
+  }
+
+  /**
+   * Release the memory of the given number of objects.
+   * 
+   * @param objects  The memory of the objects, allocated by a pool allocator of the same type.
+   * @param count    The number of objects.
+   */
+  void deallocate(T *objects, const size_t count)
+  {
+    if (count != 1)
+    {
+      std::allocator<T>().deallocate(objects, count);
+      return;
+    }
+    SlabPool<sizeof(T), alignof(T)>::getInstance().deallocate(objects);
+  }
+};
+
+// The pool allocators are stateless, so the memory allocated by any of them can be released by any other.
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) noexcept
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) noexcept
+{
+  return false;
+}
+
+/**
+ * Create a shared object in a pooled block, along with its control block.
+ * 
+ * @param arguments  The arguments of the constructor of the object.
+ * 
+ * @return The shared object.
+ */
+template <typename T, typename... Arguments>
+std::shared_ptr<T> makePooledShared(Arguments &&...arguments)
+{
+  return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Arguments>(arguments)...);
+}
+
+#endif
@@ -0,0 +1,625 @@
+#ifndef INCLUDE_PROFILER_CPP
+#define INCLUDE_PROFILER_CPP
+
+#include <map>
+#include <array>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <shared_mutex>
+
+#include "constants.cpp"
+#include "allocation_tracker.cpp"
+
+// Concatenate two tokens after expanding them, for naming the zone variables after their lines.
+#define CPU_PROFILER_CONCAT_TOKENS(first, second) first##second
+#define CPU_PROFILER_CONCAT(first, second) CPU_PROFILER_CONCAT_TOKENS(first, second)
+
+// The zones are only recorded if the build defines CPU_PROFILER_ENABLED, and compiled out completely otherwise.
+#ifdef CPU_PROFILER_ENABLED
+// Profile the rest of the scope as a zone with the given name, nested in the zone the calling thread is in.
+#define PROFILE_ZONE(zoneName) const ProfilerZone CPU_PROFILER_CONCAT(profilerZone, __LINE__)(zoneName, 1)
+// Profile the rest of the scope as a zone with the given name, counting it as the given number of items (e.g. the instances
+//   drawn by it).
+#define PROFILE_ITEMS_ZONE(zoneName, itemsCount) const ProfilerZone CPU_PROFILER_CONCAT(profilerZone, __LINE__)(zoneName, itemsCount)
+// Profile the rest of the scope as a zone with the given name, nested in the given zone instead of the one the calling thread
+//   is in (for the jobs run on other threads on behalf of a zone).
+#define PROFILE_CHILD_ZONE(parentZoneId, zoneName) const ProfilerZone CPU_PROFILER_CONCAT(profilerZone, __LINE__)(parentZoneId, zoneName, 1)
+// Profile the rest of the scope as a zone with the given name nested in the given zone, counting it as the given number of items.
+#define PROFILE_CHILD_ITEMS_ZONE(parentZoneId, zoneName, itemsCount) const ProfilerZone CPU_PROFILER_CONCAT(profilerZone, __LINE__)(parentZoneId, zoneName, itemsCount)
+#else
+#define PROFILE_ZONE(zoneName)
+#define PROFILE_ITEMS_ZONE(zoneName, itemsCount)
+#define PROFILE_CHILD_ZONE(parentZoneId, zoneName)
+#define PROFILE_CHILD_ITEMS_ZONE(parentZoneId, zoneName, itemsCount)
+#endif
+
+/**
+ * Structure for defining a zone recorded by a thread, once it ended.
+ */
+struct ProfilerZoneRecord
+{
+  // The ID of the zone.
+  uint32_t zoneId;
+  // The number of items the zone is counted as.
+  uint32_t itemsCount;
+  // The times the zone started and ended (in nanoseconds of the steady clock).
+  int64_t startTime;
+  int64_t endTime;
+  // The number of allocations and of bytes allocated by the thread in the zone (always 0 if the allocations are not tracked).
+  uint32_t allocationsCount;
+  uint64_t allocatedBytes;
+};
+
+/**
+ * Class for defining the ring of the zones recorded by a thread. Only the thread writes to it, and the profiler reads the
+ *   records written since the last frame from the other end, so no lock is needed.
+ */
+class ProfilerThreadBuffer
+{
+  friend class CpuProfiler;
+  friend class ProfilerZone;
+
+private:
+  // The index of the thread, in the order the threads first recorded a zone.
+  const uint32_t threadIndex;
+  // The records of the zones, as a ring.
+  std::array<ProfilerZoneRecord, CPU_PROFILER_RECORDS_PER_THREAD> records;
+  // The number of records written since the thread started, published after each record is written.
+  std::atomic<uint64_t> writtenCount;
+  // The number of records read by the profiler.
+  uint64_t readCount;
+
+public:
+  explicit ProfilerThreadBuffer(const uint32_t &threadIndex)
+      : threadIndex(threadIndex),
+        records({}),
+        writtenCount(0),
+        readCount(0) {}
+};
+
+/**
+ * Structure for defining a zone recorded while a capture of the profiler is running, with the thread that recorded it.
+ */
+struct ProfilerCapturedZone
+{
+  // The index of the thread that recorded the zone, in the order the threads first recorded a zone.
+  uint32_t threadIndex;
+  // The record of the zone.
+  ProfilerZoneRecord record;
+};
+
+/**
+ * Structure for defining a GPU timer measurement read back while a capture of the profiler is running.
+ */
+struct ProfilerCapturedGpuTime
+{
+  // The name of the GPU timer.
+  std::string timerName;
+  // The times the measurement started and ended on the GPU (in nanoseconds, moved to the steady clock of the zones).
+  int64_t startTime;
+  int64_t endTime;
+};
+
+/**
+ * Structure for defining a sample of a counter (e.g. the draw calls of a frame) recorded while a capture of the profiler is running.
+ */
+struct ProfilerCapturedCounter
+{
+  // The name of the counter, which has to outlive the capture.
+  const char *counterName;
+  // The time the sample was taken (in nanoseconds of the steady clock).
+  int64_t time;
+  // The value of the counter.
+  double_t value;
+};
+
+/**
+ * Structure for defining everything recorded by a capture of the profiler, for writing it out as a trace.
+ */
+struct ProfilerCapture
+{
+  // The time the capture started (in nanoseconds of the steady clock).
+  int64_t startTime;
+  // The index of the thread that ended the frames.
+  uint32_t mainThreadIndex;
+  // The zones of all the threads, in the order they were aggregated.
+  std::vector<ProfilerCapturedZone> zones;
+  // The GPU timer measurements, in the order they were read back.
+  std::vector<ProfilerCapturedGpuTime> gpuTimes;
+  // The counter samples, in the order they were taken.
+  std::vector<ProfilerCapturedCounter> counters;
+  // The times the frames ended (in nanoseconds of the steady clock).
+  std::vector<int64_t> frameEndTimes;
+};
+
+/**
+ * Structure for defining the statistics of a zone over the last frame, over all the threads.
+ */
+struct ProfilerZoneStats
+{
+  // The number of times the zone was entered.
+  uint32_t callsCount;
+  // The number of items the zone was counted as.
+  uint64_t itemsCount;
+  // The time spent in the zone (in nanoseconds).
+  int64_t totalTime;
+  // The number of allocations and of bytes allocated in the zone (always 0 if the allocations are not tracked).
+  uint64_t allocationsCount;
+  uint64_t allocatedBytes;
+
+  /**
+   * Get the time spent in the zone.
+   * 
+   * @return The total time (in milliseconds).
+   */
+  double_t getTotalTimeMs() const
+  {
+    return totalTime / 1000000.0;
+  }
+
+  /**
+   * Get the time spent in the zone per item.
+   * 
+   * @return The average time per item (in milliseconds).
+   */
+  double_t getAverageTimeMs() const
+  {
+    return itemsCount > 0 ? getTotalTimeMs() / itemsCount : 0.0;
+  }
+};
+
+/**
+ * Structure for defining a zone of the profiler, which is identified by its name within the zone it is nested in.
+ */
+struct ProfilerZoneInfo
+{
+  // The name of the zone.
+  std::string name;
+  // The ID of the zone the zone is nested in.
+  uint32_t parentZoneId;
+  // The IDs of the zones nested in the zone, by their names (in the order of the names, which the reports follow).
+  std::map<std::string, uint32_t, std::less<>> childZoneIds;
+};
+
+/**
+ * A class for profiling the time the CPU spends in nested zones of the code, marked with the PROFILE_ZONE macros. Each thread
+ *   records the zones it ends into a ring buffer of its own with nanosecond steady clock timestamps, and the records of all the
+ *   threads are aggregated once per frame into the statistics of each zone, which the debug text is written from.
+ */
+class CpuProfiler
+{
+private:
+  // Singleton instance of the CPU profiler.
+  static CpuProfiler instance;
+  // The ring buffer of the calling thread, created the first time the thread ends a zone.
+  inline static thread_local ProfilerThreadBuffer *threadBuffer = nullptr;
+  // The ID of the zone the calling thread is in, where 0 is the root zone (outside of all the zones).
+  inline static thread_local uint32_t currentZoneId = 0;
+
+  // The mutex guarding the zones, shared by the threads looking zones up and taken exclusively to add one.
+  std::shared_mutex zonesMutex;
+  // The zones by their IDs, the root zone first (a deque, so that adding zones keeps the others in place).
+  std::deque<ProfilerZoneInfo> zones;
+
+  // The mutex guarding the ring buffers of the threads.
+  std::mutex threadBuffersMutex;
+  // The ring buffers of all the threads that recorded zones.
+  std::vector<std::unique_ptr<ProfilerThreadBuffer>> threadBuffers;
+
+  // The mutex guarding the statistics of the last frame.
+  std::mutex statsMutex;
+  // The statistics of the zones over the last frame, by the zone IDs.
+  std::vector<ProfilerZoneStats> frameStats;
+  // The statistics of the zones gathered for the current frame (kept around to avoid reallocating every frame).
+  std::vector<ProfilerZoneStats> gatheredStats;
+  // The number of records overwritten before they were aggregated, since the profiler was created.
+  uint64_t droppedRecordsCount;
+
+  // Whether a capture is running, checked by the GPU timers before taking the capture mutex.
+  std::atomic<bool> isCapturing;
+  // The mutex guarding the capture, which the GPU timers add to from the thread rendering.
+  std::mutex captureMutex;
+  // The zones, GPU timer measurements and frames recorded by the running capture.
+  ProfilerCapture capture;
+
+  CpuProfiler()
+      : zones({{"Frame", 0, {}}}),
+        threadBuffers(),
+        frameStats({}),
+        gatheredStats({}),
+        droppedRecordsCount(0),
+        isCapturing(false),
+        capture({0, 0, {}, {}, {}, {}}) {}
+
+  /**
+   * Aggregate the records written to a ring buffer since the last frame into the gathered statistics. The records the thread
+   *   overwrote meanwhile (if it lapped the ring) are dropped.
+   * 
+   * @param buffer  The ring buffer.
+   */
+  void gatherRecords(ProfilerThreadBuffer &buffer)
+  {
+    const auto writtenCount = buffer.writtenCount.load(std::memory_order_acquire);
+    if (writtenCount - buffer.readCount > CPU_PROFILER_RECORDS_PER_THREAD)
+    {
+      droppedRecordsCount += writtenCount - buffer.readCount - CPU_PROFILER_RECORDS_PER_THREAD;
+      buffer.readCount = writtenCount - CPU_PROFILER_RECORDS_PER_THREAD;
+    }
+    for (; buffer.readCount < writtenCount; buffer.readCount++)
+    {
+      const auto &record = buffer.records[buffer.readCount % CPU_PROFILER_RECORDS_PER_THREAD];
+      if (record.zoneId >= gatheredStats.size())
+      {
+        continue;
+      }
+      auto &stats = gatheredStats[record.zoneId];
+      stats.callsCount++;
+      stats.itemsCount += record.itemsCount;
+      stats.totalTime += record.endTime - record.startTime;
+      stats.allocationsCount += record.allocationsCount;
+      stats.allocatedBytes += record.allocatedBytes;
+
+      // Keep the zones that ended after the capture started, for the trace.
+      if (isCapturing && record.endTime >= capture.startTime)
+      {
+        capture.zones.push_back({buffer.threadIndex, record});
+      }
+    }
+  }
+
+public:
+  // Preventing copying the CPU profiler, making sure only one instance can exist.
+  CpuProfiler(const CpuProfiler &) = delete;
+
+  /**
+   * Get the current time of the steady clock the zones are timed with.
+   * 
+   * @return The time (in nanoseconds).
+   */
+  static int64_t getTimestamp()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   * Get the ID of the zone the calling thread is in.
+   * 
+   * @return The zone ID, 0 for the root zone.
+   */
+  static uint32_t getCurrentZoneId()
+  {
+    return currentZoneId;
+  }
+
+  /**
+   * Get the ID of the zone with the given name nested in a zone, adding the zone the first time it is looked up.
+   * 
+   * @param parentZoneId  The ID of the zone the zone is nested in.
+   * @param zoneName      The name of the zone.
+   * 
+   * @return The zone ID.
+   */
+  template <typename T>
+  uint32_t getZoneId(const uint32_t &parentZoneId, const T &zoneName)
+  {
+    {
+      const std::shared_lock<std::shared_mutex> lock(zonesMutex);
+      const auto &childZoneIds = zones[parentZoneId].childZoneIds;
+      const auto childZoneId = childZoneIds.find(zoneName);
+      if (childZoneId != childZoneIds.end())
+      {
+        return childZoneId->second;
+      }
+    }
+
+    const std::unique_lock<std::shared_mutex> lock(zonesMutex);
+    const auto zoneId = static_cast<uint32_t>(zones.size());
+    const auto insertedZone = zones[parentZoneId].childZoneIds.emplace(zoneName, zoneId);
+    if (insertedZone.second)
+    {
+      zones.push_back({insertedZone.first->first, parentZoneId, {}});
+    }
+    return insertedZone.first->second;
+  }
+
+  /**
+   * Enter a zone on the calling thread, nested in the given zone.
+   * 
+   * @param zoneId  The ID of the zone.
+   * 
+   * @return The ID of the zone the thread was in before, to go back to once the zone ends.
+   */
+  static uint32_t enterZone(const uint32_t &zoneId)
+  {
+    const auto lastZoneId = currentZoneId;
+    currentZoneId = zoneId;
+    return lastZoneId;
+  }
+
+  /**
+   * Record a zone ended by the calling thread, and go back to the zone it was nested in.
+   * 
+   * @param record      The record of the zone.
+   * @param lastZoneId  The ID of the zone the thread was in before the zone.
+   */
+  void recordZone(const ProfilerZoneRecord &record, const uint32_t &lastZoneId)
+  {
+    if (threadBuffer == nullptr)
+    {
+      const std::lock_guard<std::mutex> lock(threadBuffersMutex);
+      threadBuffers.push_back(std::make_unique<ProfilerThreadBuffer>(static_cast<uint32_t>(threadBuffers.size())));
+      threadBuffer = threadBuffers.back().get();
+    }
+    const auto writtenCount = threadBuffer->writtenCount.load(std::memory_order_relaxed);
+    threadBuffer->records[writtenCount % CPU_PROFILER_RECORDS_PER_THREAD] = record;
+    threadBuffer->writtenCount.store(writtenCount + 1, std::memory_order_release);
+    currentZoneId = lastZoneId;
+  }
+
+  /**
+   * Aggregate the zones recorded by all the threads since the last frame into the statistics of the last frame. Done once per
+   *   frame by the main thread, once the threads it waits for are done with the frame.
+   */
+  void endFrame()
+  {
+    {
+      const std::shared_lock<std::shared_mutex> lock(zonesMutex);
+      gatheredStats.assign(zones.size(), {0, 0, 0, 0, 0});
+    }
+    {
+      const std::lock_guard<std::mutex> captureLock(captureMutex);
+      const std::lock_guard<std::mutex> lock(threadBuffersMutex);
+      for (const auto &buffer : threadBuffers)
+      {
+        gatherRecords(*buffer);
+      }
+      if (isCapturing)
+      {
+        capture.frameEndTimes.push_back(getTimestamp());
+        if (threadBuffer != nullptr)
+        {
+          capture.mainThreadIndex = threadBuffer->threadIndex;
+        }
+      }
+    }
+
+    const std::lock_guard<std::mutex> lock(statsMutex);
+    frameStats.swap(gatheredStats);
+  }
+
+  /**
+   * Start capturing the zones, the GPU timer measurements, the counters and the frames, for writing them out as a trace. A
+   *   capture already running is started over.
+   */
+  void startCapture()
+  {
+    const std::lock_guard<std::mutex> lock(captureMutex);
+    capture.startTime = getTimestamp();
+    capture.zones.clear();
+    capture.gpuTimes.clear();
+    capture.counters.clear();
+    capture.frameEndTimes.clear();
+    isCapturing = true;
+  }
+
+  /**
+   * Stop the running capture, handing over what it recorded.
+   * 
+   * @param stoppedCapture  The capture to move the recorded zones, GPU timer measurements and frames into.
+   */
+  void stopCapture(ProfilerCapture &stoppedCapture)
+  {
+    const std::lock_guard<std::mutex> lock(captureMutex);
+    isCapturing = false;
+    stoppedCapture = std::move(capture);
+    capture = {0, 0, {}, {}, {}, {}};
+  }
+
+  /**
+   * Drop what the running capture recorded before the last frames, so that a capture kept running to watch for hitches only
+   *   holds the frames leading up to the last one.
+   * 
+   * @param framesCount  The number of the last frames to keep.
+   */
+  void trimCapture(const size_t &framesCount)
+  {
+    const std::lock_guard<std::mutex> lock(captureMutex);
+    if (!isCapturing || capture.frameEndTimes.size() <= framesCount)
+    {
+      return;
+    }
+
+    // The capture starts over from the end of the last frame dropped, keeping what ended after it like a new capture would.
+    const auto trimmedFramesCount = capture.frameEndTimes.size() - framesCount;
+    const auto trimTime = capture.frameEndTimes[trimmedFramesCount - 1];
+    capture.startTime = trimTime;
+    capture.frameEndTimes.erase(capture.frameEndTimes.begin(), capture.frameEndTimes.begin() + trimmedFramesCount);
+    capture.zones.erase(std::remove_if(capture.zones.begin(), capture.zones.end(), [&trimTime](const ProfilerCapturedZone &zone) {
+                          return zone.record.endTime < trimTime;
+                        }),
+                        capture.zones.end());
+    capture.gpuTimes.erase(std::remove_if(capture.gpuTimes.begin(), capture.gpuTimes.end(), [&trimTime](const ProfilerCapturedGpuTime &gpuTime) {
+                             return gpuTime.endTime < trimTime;
+                           }),
+                           capture.gpuTimes.end());
+    capture.counters.erase(std::remove_if(capture.counters.begin(), capture.counters.end(), [&trimTime](const ProfilerCapturedCounter &counter) {
+                             return counter.time < trimTime;
+                           }),
+                           capture.counters.end());
+  }
+
+  /**
+   * Check whether a capture is running.
+   * 
+   * @return Whether the profiler is capturing.
+   */
+  bool isCaptureRunning() const
+  {
+    return isCapturing;
+  }
+
+  /**
+   * Record a GPU timer measurement read back while a capture is running (ignored otherwise).
+   * 
+   * @param timerName  The name of the GPU timer.
+   * @param startTime  The time the measurement started (in nanoseconds of the steady clock).
+   * @param endTime    The time the measurement ended (in nanoseconds of the steady clock).
+   */
+  void recordGpuTime(const std::string &timerName, const int64_t &startTime, const int64_t &endTime)
+  {
+    const std::lock_guard<std::mutex> lock(captureMutex);
+    if (isCapturing && endTime >= capture.startTime)
+    {
+      capture.gpuTimes.push_back({timerName, startTime, endTime});
+    }
+  }
+
+  /**
+   * Record a sample of a counter while a capture is running (ignored otherwise).
+   * 
+   * @param counterName  The name of the counter, which has to outlive the capture (e.g. a string literal).
+   * @param time         The time the sample was taken (in nanoseconds of the steady clock).
+   * @param value        The value of the counter.
+   */
+  void recordCounter(const char *counterName, const int64_t &time, const double_t &value)
+  {
+    const std::lock_guard<std::mutex> lock(captureMutex);
+    if (isCapturing)
+    {
+      capture.counters.push_back({counterName, time, value});
+    }
+  }
+
+  /**
+   * Get the name of a zone.
+   * 
+   * @param zoneId  The ID of the zone.
+   * 
+   * @return The zone name.
+   */
+  std::string getZoneName(const uint32_t &zoneId)
+  {
+    const std::shared_lock<std::shared_mutex> lock(zonesMutex);
+    return zoneId < zones.size() ? zones[zoneId].name : std::string();
+  }
+
+  /**
+   * Call a function with the names and the statistics over the last frame of the zones nested in a zone, in the order of their
+   *   names, skipping the ones not entered in the last frame. The function must not enter zones itself.
+   * 
+   * @param parentZoneId  The ID of the zone the zones are nested in.
+   * @param function      The function called with the name and the statistics of each zone.
+   */
+  template <typename F>
+  void forEachChildZone(const uint32_t &parentZoneId, const F &function)
+  {
+    const std::shared_lock<std::shared_mutex> zonesLock(zonesMutex);
+    const std::lock_guard<std::mutex> statsLock(statsMutex);
+    for (const auto &childZoneId : zones[parentZoneId].childZoneIds)
+    {
+      if (childZoneId.second < frameStats.size() && frameStats[childZoneId.second].callsCount > 0)
+      {
+        function(childZoneId.first, frameStats[childZoneId.second]);
+      }
+    }
+  }
+
+  /**
+   * Get the statistics over the last frame of the zone with the given name nested in a zone.
+   * 
+   * @param parentZoneId  The ID of the zone the zone is nested in.
+   * @param zoneName      The name of the zone.
+   * 
+   * @return The statistics of the zone, all 0 if it was not entered in the last frame.
+   */
+  template <typename T>
+  ProfilerZoneStats getChildZoneStats(const uint32_t &parentZoneId, const T &zoneName)
+  {
+    const std::shared_lock<std::shared_mutex> zonesLock(zonesMutex);
+    const std::lock_guard<std::mutex> statsLock(statsMutex);
+    const auto &childZoneIds = zones[parentZoneId].childZoneIds;
+    const auto childZoneId = childZoneIds.find(zoneName);
+    if (childZoneId == childZoneIds.end() || childZoneId->second >= frameStats.size())
+    {
+      return {0, 0, 0, 0, 0};
+    }
+    return frameStats[childZoneId->second];
+  }
+
+  /**
+   * Get the number of records overwritten before they were aggregated, which happens if a thread records more zones in a frame
+   *   than its ring buffer holds.
+   * 
+   * @return The number of dropped records.
+   */
+  const uint64_t &getDroppedRecordsCount() const
+  {
+    return droppedRecordsCount;
+  }
+
+  /**
+   * Returns the singleton instance of the CPU profiler.
+   * 
+   * @return The CPU profiler singleton instance.
+   */
+  static CpuProfiler &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the CPU profiler singleton instance static variable.
+CpuProfiler CpuProfiler::instance;
+
+/**
+ * A class for timing a zone of the CPU profiler over the scope it is created in, usually through the PROFILE_ZONE macros.
+ */
+class ProfilerZone
+{
+private:
+  // The ID of the zone.
+  const uint32_t zoneId;
+  // The number of items the zone is counted as.
+  const uint32_t itemsCount;
+  // The ID of the zone the thread was in before the zone.
+  const uint32_t lastZoneId;
+  // The time the zone started (in nanoseconds).
+  const int64_t startTime;
+  // The number of allocations and of bytes allocated by the thread when the zone started.
+  const uint64_t startAllocationsCount;
+  const uint64_t startAllocatedBytes;
+
+public:
+  template <typename T>
+  ProfilerZone(const uint32_t &parentZoneId, const T &zoneName, const uint32_t &itemsCount)
+      : zoneId(CpuProfiler::getInstance().getZoneId(parentZoneId, zoneName)),
+        itemsCount(itemsCount),
+        lastZoneId(CpuProfiler::enterZone(zoneId)),
+        startTime(CpuProfiler::getTimestamp()),
+        startAllocationsCount(AllocationTracker::getThreadAllocationsCount()),
+        startAllocatedBytes(AllocationTracker::getThreadAllocatedBytes()) {}
+
+  template <typename T>
+  ProfilerZone(const T &zoneName, const uint32_t &itemsCount)
+      : ProfilerZone(CpuProfiler::getCurrentZoneId(), zoneName, itemsCount) {}
+
+  // Preventing copying the zone, since it is recorded once it is destroyed.
+  ProfilerZone(const ProfilerZone &) = delete;
+
+  ~ProfilerZone()
+  {
+    const auto endTime = CpuProfiler::getTimestamp();
+    CpuProfiler::getInstance().recordZone({zoneId, itemsCount, startTime, endTime, static_cast<uint32_t>(AllocationTracker::getThreadAllocationsCount() - startAllocationsCount),
+                                           AllocationTracker::getThreadAllocatedBytes() - startAllocatedBytes},
+                                          lastZoneId);
+  }
+};
+
+#endif
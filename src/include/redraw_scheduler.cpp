@@ -0,0 +1,112 @@
+#ifndef INCLUDE_REDRAW_SCHEDULER_CPP
+#define INCLUDE_REDRAW_SCHEDULER_CPP
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+
+#include "constants.cpp"
+#include "control.cpp"
+#include "text_arena.cpp"
+
+/**
+ * A class for rendering the frames of a scene on demand, for the scenes that mostly sit still (like the menus). A frame is only
+ *   redrawn when the input changed, for a while after that (so that whatever the input set moving settles on screen), or when
+ *   the idle redraw rate is due (for the slow animations). In between, the scene waits for window events instead of polling,
+ *   sleeping until the next idle redraw unless an event arrives first.
+ */
+class RedrawScheduler
+{
+private:
+  // The control manager the window events are polled or waited for through.
+  ControlManager &controlManager;
+
+  // Whether the frames are rendered on demand, or all of them rendered.
+  bool isOnDemand;
+  // The time the input last changed (in seconds).
+  double_t lastInputChangeTime;
+  // The time the last frame was redrawn (in seconds).
+  double_t lastRedrawTime;
+  // The number of frames not redrawn since the scheduler was created.
+  uint64_t skippedRedrawsCount;
+
+  /**
+   * Check whether the scene is still settling after an input change, in which case all the frames are redrawn.
+   * 
+   * @param currentTime  The current time (in seconds).
+   * 
+   * @return Whether the scene is active.
+   */
+  bool isActive(const double_t &currentTime) const
+  {
+    return !isOnDemand || currentTime - lastInputChangeTime < MENU_INPUT_ACTIVE_TIME;
+  }
+
+public:
+  RedrawScheduler()
+      : controlManager(ControlManager::getInstance()),
+        isOnDemand(IS_MENU_RENDER_ON_DEMAND),
+        lastInputChangeTime(glfwGetTime()),
+        lastRedrawTime(0.0),
+        skippedRedrawsCount(0) {}
+
+  /**
+   * Switch between rendering the frames on demand and rendering all of them.
+   */
+  void toggleOnDemand()
+  {
+    isOnDemand = !isOnDemand;
+  }
+
+  /**
+   * Check whether the current frame has to be redrawn, once the scene has been updated.
+   * 
+   * @return Whether the frame has to be redrawn.
+   */
+  bool isRedrawDue()
+  {
+    const auto currentTime = glfwGetTime();
+    // Any key, mouse button or cursor event since the last poll (which reports each of them to a single frame) is an input change.
+    if (controlManager.getInputSnapshot().isAnyInputReceived())
+    {
+      lastInputChangeTime = currentTime;
+    }
+    if (isActive(currentTime) || currentTime - lastRedrawTime >= 1.0 / MENU_IDLE_REDRAW_RATE)
+    {
+      lastRedrawTime = currentTime;
+      return true;
+    }
+    skippedRedrawsCount++;
+    return false;
+  }
+
+  /**
+   * Poll for the window events if the scene is active, or wait for them until the next idle redraw is due otherwise.
+   */
+  void pollEvents()
+  {
+    const auto currentTime = glfwGetTime();
+    if (isActive(currentTime))
+    {
+      controlManager.pollEvents();
+    }
+    else
+    {
+      controlManager.waitEvents(std::max(lastRedrawTime + 1.0 / MENU_IDLE_REDRAW_RATE - currentTime, 0.0));
+    }
+  }
+
+  /**
+   * Write the render mode and the number of frames not redrawn as text.
+   * 
+   * @param text  The writer of the text, written the render mode text.
+   */
+  void writeRenderMode(TextWriter &text) const
+  {
+    text << (isOnDemand ? "On-Demand" : "Continuous") << " | Skipped Redraws: " << skippedRedrawsCount << " | Idle Redraw Rate: " << static_cast<int32_t>(std::round(MENU_IDLE_REDRAW_RATE)) << "Hz";
+  }
+};
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef INCLUDE_REGISTRY_CPP
+#define INCLUDE_REGISTRY_CPP
+
+#include <new>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <stdexcept>
+#include <memory_resource>
+
+#include "memory_resource.cpp"
+
+/**
+ * Structure for defining the handle of an entry in a registry, which is only valid for as long as the entry is registered. The
+ *   generation of the slot changes whenever the slot is reused, so the handles of de-registered entries never find a new entry.
+ */
+struct RegistryHandle
+{
+  // The index of the slot of the entry.
+  uint32_t slotIndex;
+  // The generation of the slot when the entry was registered, where 0 is never handed out.
+  uint32_t generation;
+
+  bool operator==(const RegistryHandle &other) const
+  {
+    return slotIndex == other.slotIndex && generation == other.generation;
+  }
+
+  bool operator!=(const RegistryHandle &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+// The handle that never refers to a registered entry.
+const RegistryHandle INVALID_REGISTRY_HANDLE = {0, 0};
+
+/**
+ * Types of the changes queued with the managers instead of being applied to their registries right away.
+ */
+enum RegistryCommandType
+{
+  REGISTER_REGISTRY_COMMAND,
+  DEREGISTER_REGISTRY_COMMAND
+};
+
+/**
+ * Structure for defining a registration or de-registration queued with a manager, applied together with the others at the
+ *   end of the updates so that nothing registers or de-registers entries while the registries are iterated.
+ */
+template <typename T>
+struct RegistryCommand
+{
+  // The type of the change.
+  RegistryCommandType type;
+  // The entry to register or de-register.
+  std::shared_ptr<T> entry;
+};
+
+/**
+ * Class for storing the registered entries of a manager (models, lights, cameras, scenes) in a dense array in the order they
+ *   were registered, so that they can be iterated without building a list or looking each of them up.
+ * Entries are found by the handles handed out when they are registered, through a table of slots pointing into the dense array,
+ *   so that registering, de-registering and looking them up takes constant time. Their string IDs are kept for debug lookups.
+ * Entries can be registered and de-registered while the entries are iterated. Registered entries are only visited by the
+ *   iterations started afterwards, and de-registered entries are skipped, but kept alive until the last iteration ends.
+ * The arrays and the handles by ID are allocated from a memory resource, which can be switched (e.g. to the arena of a scene)
+ *   while the entries are not iterated.
+ */
+template <typename T>
+class Registry
+{
+private:
+  // The map of the handles of the entries by their IDs.
+  using EntryHandleMap = std::pmr::unordered_map<std::string, RegistryHandle>;
+
+  // The registered entries in their registration order, with nulls left by the entries de-registered while iterating. Mutable
+  //   so that the views, which are also taken from const managers, can drop the nulls once the last of them ends.
+  mutable std::pmr::vector<std::shared_ptr<T>> entries;
+  // The IDs of the entries, at the same indices as the entries, pointing to the keys of the handles by ID.
+  mutable std::pmr::vector<const std::string *> entryIds;
+  // The slots of the entries, at the same indices as the entries.
+  mutable std::pmr::vector<uint32_t> entrySlots;
+  // The index of each entry in the entries, by its slot.
+  mutable std::pmr::vector<size_t> slotEntryIndices;
+  // The current generation of each slot.
+  std::pmr::vector<uint32_t> slotGenerations;
+  // The slots of the de-registered entries, to be reused by the next entries registered.
+  std::pmr::vector<uint32_t> freeSlots;
+  // The handle of each registered entry, by its ID.
+  EntryHandleMap entryHandles;
+  // The nodes of the handles by ID of the de-registered entries, reused by the next entries registered so that entries coming
+  //   and going (like pooled models) do not allocate. The nodes carry their allocators, so they are kept in a plain vector.
+  std::vector<typename EntryHandleMap::node_type> freeHandleNodes;
+  // The entries de-registered while iterating, kept alive until the last iteration ends since they may still be in use.
+  mutable std::pmr::vector<std::shared_ptr<T>> removedEntries;
+  // The number of nulls left in the entries by the de-registered ones.
+  mutable size_t removedEntryCount;
+  // The number of views currently iterating the entries.
+  mutable uint32_t iterationDepth;
+
+  /**
+   * Release the entries de-registered while iterating, and drop the nulls left in the entries once they are at least as many as
+   *   the registered entries, so that de-registering takes constant time on average.
+   */
+  void compactEntries() const
+  {
+    removedEntries.clear();
+    if (removedEntryCount == 0 || removedEntryCount < entries.size() - removedEntryCount)
+    {
+      return;
+    }
+
+    size_t nextIndex = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      if (entries[i] == nullptr)
+      {
+        continue;
+      }
+      slotEntryIndices[entrySlots[i]] = nextIndex;
+      entrySlots[nextIndex] = entrySlots[i];
+      entryIds[nextIndex] = entryIds[i];
+      entries[nextIndex++] = std::move(entries[i]);
+    }
+    entries.resize(nextIndex);
+    entryIds.resize(nextIndex);
+    entrySlots.resize(nextIndex);
+    removedEntryCount = 0;
+  }
+
+  /**
+   * Check if the given handle refers to a registered entry.
+   * 
+   * @param handle  The handle of the entry.
+   * 
+   * @return Whether the entry is registered.
+   */
+  bool isHandleValid(const RegistryHandle &handle) const
+  {
+    return handle.slotIndex < slotGenerations.size() && slotGenerations[handle.slotIndex] == handle.generation;
+  }
+
+public:
+  /**
+   * Class for iterating the registered entries without copying them.
+   */
+  class View
+  {
+  private:
+    // The registry being iterated.
+    const Registry &registry;
+    // The number of entries when the view was taken, so that the entries registered while iterating are not visited.
+    const size_t entryCount;
+
+  public:
+    /**
+     * Iterator over the registered entries, skipping the ones de-registered while iterating.
+     */
+    class Iterator
+    {
+    private:
+      // The registry being iterated.
+      const Registry &registry;
+      // The index of the current entry.
+      size_t index;
+      // The index after the last entry to visit.
+      const size_t endIndex;
+
+      /**
+       * Move to the next entry still registered, starting at the current one.
+       */
+      void skipRemovedEntries()
+      {
+        while (index < endIndex && registry.entries[index] == nullptr)
+        {
+          index++;
+        }
+      }
+
+    public:
+      Iterator(const Registry &registry, const size_t &index, const size_t &endIndex)
+          : registry(registry),
+            index(index),
+            endIndex(endIndex)
+      {
+        skipRemovedEntries();
+      }
+
+      const std::shared_ptr<T> &operator*() const
+      {
+        return registry.entries[index];
+      }
+
+      Iterator &operator++()
+      {
+        index++;
+        skipRemovedEntries();
+        return *this;
+      }
+
+      bool operator!=(const Iterator &other) const
+      {
+        return index != other.index;
+      }
+    };
+
+    View(const Registry &registry)
+        : registry(registry),
+          entryCount(registry.entries.size())
+    {
+      registry.iterationDepth++;
+    }
+
+    // Preventing copying the view, so that each view ends the iteration it started only once.
+    View(const View &) = delete;
+
+    ~View()
+    {
+      // Release the entries de-registered while iterating once the last iteration ends.
+      if (--registry.iterationDepth == 0)
+      {
+        registry.compactEntries();
+      }
+    }
+
+    Iterator begin() const
+    {
+      return Iterator(registry, 0, entryCount);
+    }
+
+    Iterator end() const
+    {
+      return Iterator(registry, entryCount, entryCount);
+    }
+
+    /**
+     * Get the number of entries currently registered.
+     * 
+     * @return The number of registered entries.
+     */
+    size_t size() const
+    {
+      return registry.size();
+    }
+
+    /**
+     * Check whether there are no entries currently registered.
+     * 
+     * @return Whether the registry is empty.
+     */
+    bool empty() const
+    {
+      return registry.size() == 0;
+    }
+  };
+
+  Registry(std::pmr::memory_resource *memoryResource = std::pmr::get_default_resource())
+      : entries(memoryResource),
+        entryIds(memoryResource),
+        entrySlots(memoryResource),
+        slotEntryIndices(memoryResource),
+        slotGenerations(memoryResource),
+        freeSlots(memoryResource),
+        entryHandles(memoryResource),
+        freeHandleNodes(),
+        removedEntries(memoryResource),
+        removedEntryCount(0),
+        iterationDepth(0) {}
+
+  /**
+   * Move the arrays and the handles by ID of the registry to another memory resource, so that nothing of the registry is left in
+   *   the former one. The registered entries, their handles and the addresses of their IDs are kept.
+   * 
+   * @param memoryResource  The memory resource for the registry to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    if (iterationDepth != 0)
+    {
+      throw std::logic_error("The memory resource of a registry cannot be switched while it is iterated.");
+    }
+    if (entries.get_allocator().resource() == memoryResource)
+    {
+      return;
+    }
+
+    // The handles by ID are moved one by one, since the keys would be copied into new nodes anyway, and the IDs of the entries
+    //   pointed to their new keys. The nodes kept for reuse belong to the former memory resource, so they are dropped.
+    compactEntries();
+    EntryHandleMap reboundEntryHandles(memoryResource);
+    reboundEntryHandles.reserve(entryHandles.size());
+    for (auto &entryId : entryIds)
+    {
+      if (entryId != nullptr)
+      {
+        entryId = &reboundEntryHandles.emplace(*entryId, entryHandles.at(*entryId)).first->first;
+      }
+    }
+    freeHandleNodes.clear();
+    entryHandles.~EntryHandleMap();
+    new (&entryHandles) EntryHandleMap(std::move(reboundEntryHandles));
+
+    rebindMemoryResource(entries, memoryResource);
+    rebindMemoryResource(entryIds, memoryResource);
+    rebindMemoryResource(entrySlots, memoryResource);
+    rebindMemoryResource(slotEntryIndices, memoryResource);
+    rebindMemoryResource(slotGenerations, memoryResource);
+    rebindMemoryResource(freeSlots, memoryResource);
+    rebindMemoryResource(removedEntries, memoryResource);
+  }
+
+  /**
+   * Make room for the given number of entries to be registered on top of the registered ones, so that registering them in bulk
+   *   does not grow the arrays over and over.
+   * 
+   * @param entriesCount  The number of entries to make room for.
+   */
+  void reserve(const size_t &entriesCount)
+  {
+    const auto newEntriesCount = entries.size() + entriesCount;
+    entries.reserve(newEntriesCount);
+    entryIds.reserve(newEntriesCount);
+    entrySlots.reserve(newEntriesCount);
+    slotEntryIndices.reserve(newEntriesCount);
+    slotGenerations.reserve(newEntriesCount);
+    entryHandles.reserve(newEntriesCount);
+  }
+
+  /**
+   * Register a new entry, unless an entry is already registered with the given ID.
+   * 
+   * @param entryId  The ID to register the entry with.
+   * @param entry    The entry to register.
+   * 
+   * @return The handle of the entry (or of the entry already registered with the ID).
+   */
+  RegistryHandle add(const std::string &entryId, const std::shared_ptr<T> &entry)
+  {
+    const auto existingHandle = entryHandles.find(entryId);
+    if (existingHandle != entryHandles.end())
+    {
+      return existingHandle->second;
+    }
+
+    // Reuse the slot of a de-registered entry if there is any.
+    uint32_t slotIndex;
+    if (!freeSlots.empty())
+    {
+      slotIndex = freeSlots.back();
+      freeSlots.pop_back();
+    }
+    else
+    {
+      slotIndex = static_cast<uint32_t>(slotGenerations.size());
+      slotGenerations.push_back(0);
+      slotEntryIndices.push_back(0);
+    }
+    // Move the slot to its next generation, skipping 0 when it wraps around.
+    if (++slotGenerations[slotIndex] == 0)
+    {
+      slotGenerations[slotIndex] = 1;
+    }
+
+    const RegistryHandle handle = {slotIndex, slotGenerations[slotIndex]};
+    // Reuse the node of a de-registered entry for the handle by ID if there is any, keeping the ID buffer it already has.
+    EntryHandleMap::iterator handleEntry;
+    if (!freeHandleNodes.empty())
+    {
+      auto handleNode = std::move(freeHandleNodes.back());
+      freeHandleNodes.pop_back();
+      handleNode.key() = entryId;
+      handleNode.mapped() = handle;
+      handleEntry = entryHandles.insert(std::move(handleNode)).position;
+    }
+    else
+    {
+      handleEntry = entryHandles.emplace(entryId, handle).first;
+    }
+
+    slotEntryIndices[slotIndex] = entries.size();
+    entries.push_back(entry);
+    // The keys keep their address for as long as they are in the map, even when it rehashes.
+    entryIds.push_back(&handleEntry->first);
+    entrySlots.push_back(slotIndex);
+    return handle;
+  }
+
+  /**
+   * De-register the entry with the given handle.
+   * 
+   * @param handle  The handle of the entry.
+   */
+  void remove(const RegistryHandle &handle)
+  {
+    if (!isHandleValid(handle))
+    {
+      return;
+    }
+
+    // Invalidate the handles of the entry, and free its slot.
+    const auto entryIndex = slotEntryIndices[handle.slotIndex];
+    slotGenerations[handle.slotIndex]++;
+    freeSlots.push_back(handle.slotIndex);
+    freeHandleNodes.push_back(entryHandles.extract(*entryIds[entryIndex]));
+    entryIds[entryIndex] = nullptr;
+
+    // Leave a null in place of the entry, dropped once enough of them pile up and the entries are not being iterated.
+    removedEntries.push_back(std::move(entries[entryIndex]));
+    removedEntryCount++;
+    if (iterationDepth == 0)
+    {
+      compactEntries();
+    }
+  }
+
+  /**
+   * De-register the entry registered with the given ID.
+   * 
+   * @param entryId  The ID of the entry.
+   */
+  void remove(const std::string &entryId)
+  {
+    remove(getHandle(entryId));
+  }
+
+  /**
+   * Check if the entry with the given handle is registered.
+   * 
+   * @param handle  The handle of the entry.
+   * 
+   * @return Whether the entry is registered.
+   */
+  bool contains(const RegistryHandle &handle) const
+  {
+    return isHandleValid(handle);
+  }
+
+  /**
+   * Check if an entry is registered with the given ID.
+   * 
+   * @param entryId  The ID of the entry.
+   * 
+   * @return Whether the entry is registered.
+   */
+  bool contains(const std::string &entryId) const
+  {
+    return entryHandles.find(entryId) != entryHandles.end();
+  }
+
+  /**
+   * Get the entry with the given handle.
+   * 
+   * @param handle  The handle of the entry.
+   * 
+   * @return The entry (throws std::out_of_range if the entry is not registered).
+   */
+  const std::shared_ptr<T> &get(const RegistryHandle &handle) const
+  {
+    if (!isHandleValid(handle))
+    {
+      throw std::out_of_range("No entry is registered with the handle.");
+    }
+    return entries[slotEntryIndices[handle.slotIndex]];
+  }
+
+  /**
+   * Get the entry registered with the given ID.
+   * 
+   * @param entryId  The ID of the entry.
+   * 
+   * @return The entry (throws std::out_of_range if no entry is registered with the ID).
+   */
+  const std::shared_ptr<T> &get(const std::string &entryId) const
+  {
+    return get(entryHandles.at(entryId));
+  }
+
+  /**
+   * Get the handle of the entry registered with the given ID.
+   * 
+   * @param entryId  The ID of the entry.
+   * 
+   * @return The handle of the entry, or the invalid handle if no entry is registered with the ID.
+   */
+  RegistryHandle getHandle(const std::string &entryId) const
+  {
+    const auto handle = entryHandles.find(entryId);
+    return handle != entryHandles.end() ? handle->second : INVALID_REGISTRY_HANDLE;
+  }
+
+  /**
+   * Get the number of entries registered.
+   * 
+   * @return The number of registered entries.
+   */
+  size_t size() const
+  {
+    return entryHandles.size();
+  }
+
+  /**
+   * Get a view for iterating the registered entries in their registration order.
+   * 
+   * @return The view over the entries.
+   */
+  View getView() const
+  {
+    return View(*this);
+  }
+};
+
+#endif
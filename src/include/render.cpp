@@ -3,18 +3,61 @@
 
 #include <map>
 #include <set>
+#include <array>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string_view>
+#include <bitset>
+#include <functional>
 
 #include <GL/glew.h>
 
 #include "common.cpp"
 #include "constants.cpp"
 #include "window.cpp"
+#include "render_config.cpp"
 #include "control.cpp"
 #include "shadowbuffer.cpp"
 #include "camera.cpp"
 #include "light.cpp"
 #include "models.cpp"
 #include "text.cpp"
+#include "hud_stats.cpp"
+#include "shader.cpp"
+#include "texture.cpp"
+#include "uniform_buffer.cpp"
+#include "render_queue.cpp"
+#include "frustum.cpp"
+#include "transform.cpp"
+#include "attachment.cpp"
+#include "job.cpp"
+#include "gpu_timer.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "stream_buffer.cpp"
+#include "profiler.cpp"
+#include "allocation_tracker.cpp"
+#include "light_cluster.cpp"
+#include "gpu_culling.cpp"
+#include "occlusion_culling.cpp"
+#include "picking.cpp"
+#include "layer_cache.cpp"
+#include "impostor.cpp"
+#include "occlusion_query.cpp"
+#include "shadow_moments.cpp"
+#include "deferred_shading.cpp"
+#include "shadow_mask.cpp"
+#include "gpu_shot_collision.cpp"
+#include "simulation_clock.cpp"
+#include "dynamic_resolution.cpp"
+#include "visibility.cpp"
+#include "render_packet.cpp"
+#include "scene_preloader.cpp"
 #include "../light/light_base.cpp"
 #include "../camera/camera_base.cpp"
 #include "../models/model_base.cpp"
@@ -25,23 +68,97 @@
 struct LightDetails
 {
   // The position of the light
-  const glm::vec3 lightPosition;
+  glm::vec3 lightPosition;
   // The projection-view matrix of the light.
-  const glm::mat4 lightVpMatrix;
+  glm::mat4 lightVpMatrix;
   // The color of the light.
-  const glm::vec3 lightColor;
+  glm::vec3 lightColor;
   // The intensity of the light.
-  const float_t lightIntensity;
+  float_t lightIntensity;
   // The width of the shadowmap of the light.
-  const int32_t mapWidth;
+  int32_t mapWidth;
   // The height of the shadowmap of the light.
-  const int32_t mapHeight;
+  int32_t mapHeight;
   // The closest distance from which the shadowmap captures objects.
-  const float_t nearPlane;
+  float_t nearPlane;
   // The farthest distance till which the shadowmap captures objects.
-  const float_t farPlane;
+  float_t farPlane;
   // The ID of the layer of the shadowmap texture array the shadowmap is stored in.
-  const GLuint textureArrayLayerId;
+  GLuint textureArrayLayerId;
+  // The region of the shadowmap texture the shadowmap is drawn to, in texture coordinates (offset, then size).
+  glm::vec4 shadowMapRect;
+  // The view of the first shadowmap face of the light in the visibility of the frame, followed by the views of its other faces.
+  uint32_t visibilityView;
+  // The number of shadowmap faces of the light.
+  uint32_t facesCount;
+};
+
+/**
+ * Structure for defining the lights with a shadowmap in a frame, by their shadow buffer type and in the order of the frame details.
+ * The lights are kept in arrays as large as the frame details fit, refilled by the shadow pass every frame without allocating.
+ */
+struct FrameLights
+{
+  // The details of the cone lights.
+  LightArray<LightDetails, LightLimitType::CONE> coneLights;
+  // The number of cone lights.
+  uint32_t coneLightsCount;
+  // The details of the point lights.
+  LightArray<LightDetails, LightLimitType::POINT> pointLights;
+  // The number of point lights.
+  uint32_t pointLightsCount;
+};
+
+/**
+ * Structure for defining the per-instance details of a model drawn into the light shadowmaps.
+ */
+struct ShadowCasterData
+{
+  // The transformation matrix of the model.
+  glm::mat4 modelMatrix;
+  // The mask of the shadowmap faces the model is drawn into, with a bit per light per face (light * 6 + face).
+  uint32_t casterMask;
+  // The shadowmap face the instance is drawn into (light * 6 + face), when the faces are drawn as instances instead of by the geometry shader.
+  uint32_t casterFace;
+  // Padding to keep the model matrices of consecutive instances aligned.
+  uint32_t padding[2];
+};
+
+/**
+ * Structure for tracking which faces of the shadowmap of a light are outdated, so that they can be rendered over several frames.
+ */
+struct ShadowFaceState
+{
+  // The signature of the light and its casters the faces were last marked outdated for.
+  uint64_t signature;
+  // The mask of the faces waiting to be rendered again (a bit per face).
+  uint32_t pendingFacesMask;
+  // The mask of the faces that had casters drawn into them the last time they were rendered (a bit per face).
+  uint32_t occupiedFacesMask;
+  // The face to start from the next time faces of the light are picked, so that they are rendered round-robin.
+  uint32_t nextFace;
+  // The number of frames the light has been waiting with outdated faces.
+  uint32_t staleFrames;
+  // The position of the light in the last frame, to tell how fast it moves.
+  glm::vec3 lastLightPosition;
+  // The signature of the light and its static casters the cached static faces were last marked outdated for.
+  uint64_t staticSignature;
+  // The mask of the cached static faces waiting to be rendered again along with the faces (a bit per face).
+  uint32_t staticPendingFacesMask;
+  // The mask of the cached static faces that had static casters drawn into them the last time they were rendered (a bit per face).
+  uint32_t staticOccupiedFacesMask;
+};
+
+/**
+ * Structure for defining a camera registered to be drawn as an additional view of the scene.
+ */
+struct RenderViewCamera
+{
+  // The handle of the camera of the view.
+  RegistryHandle cameraHandle;
+  // The part of the render target the view is drawn into, as its bottom-left corner followed by its width and height (as shares of
+  //   the size of the render target).
+  glm::vec4 viewportRect;
 };
 
 /**
@@ -60,6 +177,17 @@ private:
   const static int32_t DISABLE_SHADOW;
   const static int32_t DISABLE_LIGHT;
 
+  // The ID of the first vertex attribute of the per-instance model matrix (a matrix takes up four attribute IDs).
+  const static GLuint MODEL_MATRIX_ATTRIBUTE_ID;
+  // The ID of the vertex attribute of the per-instance shadow caster mask.
+  const static GLuint CASTER_MASK_ATTRIBUTE_ID;
+  // The ID of the vertex attribute of the per-instance shadowmap face.
+  const static GLuint CASTER_FACE_ATTRIBUTE_ID;
+  // The ID of the vertex attribute of the per-instance mask of the lights reaching the model.
+  const static GLuint MODEL_LIGHT_MASK_ATTRIBUTE_ID;
+  // The ID of the vertex attribute of the per-instance layer of the texture array containing the diffuse texture of the model.
+  const static GLuint MODEL_TEXTURE_LAYER_ATTRIBUTE_ID;
+
   // Singleton instance of the render manager.
   static RenderManager instance;
 
@@ -71,15 +199,62 @@ private:
   LightManager &lightManager;
   // The model manager responsible for managing all the models.
   ModelManager &modelManager;
+  // The render group manager keeping the registered models grouped by their model type.
+  const RenderGroupManager &renderGroupManager;
+  // The visibility manager computing which models are inside the view frustums of the cameras and the shadowmap faces.
+  VisibilityManager &visibilityManager;
   // The text manager responsible for rendering text.
   TextManager &textManager;
+  // The HUD stats manager the stats of each light and model type rendered are written to, and their sections.
+  HudStatsManager &hudStatsManager;
+  const uint32_t lightRenderHudSection;
+  const uint32_t modelRenderHudSection;
+  // The CPU profiler the light and model render steps are timed with.
+  CpuProfiler &cpuProfiler;
   // The control manager responsible for managing controls and inputs of the window.
   const ControlManager &controlManager;
   // The shadow buffer manager responsible for creating shadow buffers for lights.
-  const ShadowBufferManager &shadowBufferManager;
-
-  // The ID of the active camera to use to render the scene to the window.
-  std::string activeCameraId;
+  ShadowBufferManager &shadowBufferManager;
+  // The shader manager responsible for managing shader programs.
+  ShaderManager &shaderManager;
+  // The uniform buffer manager responsible for the uniform buffers shared by all shader programs.
+  const UniformBufferManager &uniformBufferManager;
+  // The GPU timer manager responsible for measuring the GPU time of the render steps.
+  GpuTimerManager &gpuTimerManager;
+  // The dynamic resolution manager responsible for the render target the scene is rendered into.
+  DynamicResolutionManager &dynamicResolutionManager;
+  // The texture manager responsible for uploading the textures streamed in the background.
+  TextureManager &textureManager;
+  // The scene preloader creating the assets preloaded for the likely-next scene a few at a time.
+  ScenePreloader &scenePreloader;
+  // The transform manager storing the transformations of all the models.
+  TransformManager &transformManager;
+  // The attachment manager placing the lights attached to the models.
+  AttachmentManager &attachmentManager;
+  // The job manager running the culling pass in parallel, and the tasks queued for the main thread.
+  JobManager &jobManager;
+  // The GPU memory manager the instance buffers are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+  // The stream buffer manager the per-instance details drawn only as vertex attributes are written through.
+  StreamBufferManager &streamBufferManager;
+  // The GPU shot collision manager the shots and enemies of the render packets are tested by.
+  GpuShotCollisionManager &gpuShotCollisionManager;
+  // The simulation clock the spinning models are animated with.
+  SimulationClock &simulationClock;
+  // The name interner the names of the GPU timers of the model types are interned with.
+  NameInterner &nameInterner;
+
+  // The interned names of the GPU timers of the model types, by the interned model names.
+  FlatHashMap<NameId, NameId> modelTimerNameIds;
+
+  // The handle of the active camera to use to render the scene to the window.
+  RegistryHandle activeCameraHandle;
+  // The cameras of the additional views drawn over the view of the active camera, in their registration order.
+  std::vector<RenderViewCamera> viewCameras;
+  // Whether the additional views are drawn.
+  bool isMultiViewEnabled;
+  // How far the rendered model transforms are interpolated from their state before the last simulation step to their current state.
+  float_t interpolationFactor;
 
   // The timestamp when the render manager was loaded.
   const float_t startTime;
@@ -88,505 +263,2815 @@ private:
 
   // A mask defining what features to disable (shadows/lighting).
   int32_t disableFeatureMask;
-  // The timestamp of the last time the mask for disabling features was modifed.
-  float_t lastDisableFeatureMaskChange;
-
-  RenderManager()
-      : windowManager(WindowManager::getInstance()),
-        cameraManager(CameraManager::getInstance()),
-        lightManager(LightManager::getInstance()),
-        modelManager(ModelManager::getInstance()),
-        textManager(TextManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        shadowBufferManager(ShadowBufferManager::getInstance()),
-        startTime(glfwGetTime()),
-        lastTime(glfwGetTime()),
-        disableFeatureMask(0),
-        lastDisableFeatureMaskChange(glfwGetTime() - 10) {}
 
-public:
-  // Preventing copying the render manager, making sure only one instance can exist.
-  RenderManager(const RenderManager &) = delete;
+  // Whether the depth of the models is drawn in a separate pass before shading them.
+  bool isDepthPrePassEnabled;
+  // The shader program details of the depth pre-pass.
+  const std::shared_ptr<const ShaderDetails> depthShaderDetails;
+
+  // Whether the models receiving light are drawn into a G-buffer and lit in a single deferred pass, instead of being shaded
+  //   while they are drawn (only while blending is disabled).
+  bool isDeferredShadingEnabled;
+  // Whether the distant models of the model types drawn with impostors are drawn as billboards into the G-buffer (only with
+  //   deferred shading).
+  bool isImpostorRenderingEnabled;
+
+  // Whether the shadow visibility of the lights is evaluated into a half-resolution mask from the depth of the depth pre-pass,
+  //   which the models read while being shaded instead of sampling the shadowmaps (only with the depth pre-pass).
+  bool isShadowMaskEnabled;
+
+  // Whether the point lights are binned into light clusters, instead of being looped over by every fragment.
+  bool isClusteredLightingEnabled;
+
+  // Whether the models are culled by a compute shader and each model group is drawn with a single indirect multi-draw, instead
+  //   of an instanced draw call per level of detail (only if the GPU-driven rendering is supported, and from the start
+  //   on a discrete GPU).
+  bool isGpuDrivenRenderingEnabled;
+
+  // Whether the models hidden behind the depth of the last frames are culled.
+  bool isOcclusionCullingEnabled;
+  // Whether the expensive model groups with few visible models are drawn behind occlusion queries of their world AABBs, skipped
+  //   on the GPU if the queries find them hidden behind the models drawn before them.
+  bool isOcclusionQueryEnabled;
+
+  // The kernel of shadowmap taps the model shaders average for the shadows.
+  ShadowFilterKernel shadowFilterKernel;
+  // The techniques the model shaders shadow the lights of each type with (the shadow filter kernel only applies to percentage-closer filtering).
+  std::map<const ShadowBufferType, ShadowTechnique> shadowTechniques;
+
+  // Whether the point light shadowmap faces are rendered within a budget per frame, leaving the rest of the outdated faces for later frames.
+  bool isShadowUpdateAmortized;
+
+  // The quality preset picking how many lights are shaded with and without shadows.
+  int32_t qualityPreset;
+  // The lights shaded in the current frame, from the most important to the least important (the shadowed ones have shadowmap slots).
+  std::vector<const RenderLightState *> shadedLights;
+  // The shadow buffers of the lights given shadowmap slots in the current frame, by their shadow buffer type.
+  std::array<std::vector<std::shared_ptr<const ShadowBufferDetails>>, 2> shadowedBuffers;
+  // The lights with a shadowmap in the current frame, by their shadow buffer type.
+  std::array<std::vector<const RenderLightState *>, 2> shadowedLights;
+  // The details of the lights with a shadowmap in the current frame, as read by the shadow pass and the model passes.
+  FrameLights frameLights;
+  // The number of registered lights left out of the current frame, for not reaching the view or not fitting the quality preset.
+  uint32_t droppedLightsCount;
+
+  // The uniform IDs of the textures in the model shaders.
+  const GLuint diffuseTextureUniformId;
+  const GLuint coneLightShadowAtlasUniformId;
+  const GLuint pointLightTexturesUniformId;
+  const GLuint coneLightMomentAtlasUniformId;
+  const GLuint pointLightMomentTexturesUniformId;
+  const GLuint clusterLightsTextureUniformId;
+  const GLuint clusterGridTextureUniformId;
+  const GLuint clusterLightIndicesTextureUniformId;
+
+  // The ID of the buffer containing the model matrices of all the models, grouped by model type.
+  const GLuint modelMatrixBufferId;
+  // The models of the model group being created that are outside the view frustum (kept around to avoid reallocating every frame).
+  std::vector<std::shared_ptr<ModelBaseIntf>> culledModels;
+  // The models of the model group being created inside the view frustum but hidden behind the depth of the last frames (kept
+  //   around to avoid reallocating every frame).
+  std::vector<std::shared_ptr<ModelBaseIntf>> occludedModels;
+  // The visible models of the model group being created drawn with each level of detail (kept around to avoid reallocating
+  //   every frame).
+  std::array<std::vector<std::shared_ptr<ModelBaseIntf>>, OBJECT_LOD_COUNT> lodModels;
+  // The visible models of the model group being created far enough to be drawn as impostors (kept around to avoid reallocating
+  //   every frame).
+  std::vector<std::shared_ptr<ModelBaseIntf>> impostorModels;
+  // All the models of the scene, one render group after the other, tested against the view frustum in parallel (kept around to
+  //   avoid reallocating every frame).
+  std::vector<const ModelBaseIntf *> frameModels;
+  // Whether each of the frame models is inside the view frustum, as bytes so that the threads can write them side by side.
+  std::vector<uint8_t> frameModelVisibilities;
+  // Whether each of the frame models inside the view frustum is hidden behind the depth of the last frames, as bytes as well.
+  std::vector<uint8_t> frameModelOcclusions;
+  // The render packet the scene is filled into and rendered from when both are done at once (kept around to avoid reallocating every frame).
+  RenderPacket framePacket;
+  // The ID of the buffer containing the masks of the lights reaching each model, in the same order as the model matrices.
+  const GLuint modelLightMaskBufferId;
+  // The masks of the lights reaching each model, with a bit per cone light followed by a bit per point light from bit 8
+  //   (kept around to avoid reallocating every frame).
+  std::vector<uint32_t> modelLightMasks;
+  // The ID of the buffer containing the layers of the texture arrays containing the diffuse textures of the models, in the same
+  //   order as the model matrices (only filled when the textures are batched).
+  const GLuint modelTextureLayerBufferId;
+  // The layers of the texture arrays containing the diffuse textures of the models (kept around to avoid reallocating every frame).
+  std::vector<uint32_t> modelTextureLayers;
+  // The IDs of the buffers containing the model matrices, light masks and texture layers of the models of the additional view being
+  //   drawn, written again for each view.
+  const GLuint viewModelMatrixBufferId;
+  const GLuint viewModelLightMaskBufferId;
+  const GLuint viewModelTextureLayerBufferId;
+  // The light masks and texture layers of the models of the additional view being drawn (kept around to avoid reallocating every frame).
+  std::vector<uint32_t> viewModelLightMasks;
+  std::vector<uint32_t> viewModelTextureLayers;
+  // The indices of the visible models of the model group of the additional view being created in the grouped models of the frame,
+  //   drawn with each level of detail (kept around to avoid reallocating every frame).
+  std::array<std::vector<uint32_t>, OBJECT_LOD_COUNT> viewLodInstances;
+  // The frame details of the view of the active camera, which the additional views are drawn with after switching the camera.
+  FrameData frameData;
+
+  // The ID of the buffer containing the per-instance details of the models drawn into the shadowmaps of the current light type,
+  //   when the stream buffer has no room left for them.
+  const GLuint shadowCasterBufferId;
+  // The allocation the per-instance details of the models drawn into the shadowmaps of the current light type are written to.
+  StreamAllocation shadowCasterAllocation;
+  // The per-instance details of the models drawn into the shadowmaps of the current light type (kept around to avoid reallocating every frame).
+  std::vector<ShadowCasterData> shadowCasters;
+  // The shadow casters of the model group being collected drawn with each level of detail (kept around to avoid reallocating
+  //   every frame).
+  std::array<std::vector<ShadowCasterData>, OBJECT_LOD_COUNT> lodShadowCasters;
+  // The shadow casters repeated once per face they are drawn into, for the lights drawing their faces as instances (kept around to avoid reallocating every frame).
+  std::vector<ShadowCasterData> shadowCasterFaces;
+  // The outdated faces of each shadowmap layer and the signature they were marked outdated for, per shadow buffer type.
+  std::map<const ShadowBufferType, std::map<const GLuint, ShadowFaceState>> shadowFaceStates;
+  // The queue used to sort the model groups by the GPU state they use before drawing them.
+  RenderQueue renderQueue;
+  // The shader program variants the model groups are drawn with, in the same order as the model groups (kept around to avoid reallocating every frame).
+  std::vector<std::shared_ptr<const ShaderDetails>> modelGroupShaders;
+  // The shader program variants the model groups are drawn into the G-buffer with, in the same order as the model groups (nullptr
+  //   for the model groups drawn forward, kept around to avoid reallocating every frame).
+  std::vector<std::shared_ptr<const ShaderDetails>> modelGroupGBufferShaders;
+  // Whether the impostors of the model groups are drawn as billboards into the G-buffer, in the same order as the model groups
+  //   (kept around to avoid reallocating every frame).
+  std::vector<bool> modelGroupImpostors;
+  // Whether the model groups are drawn behind an occlusion query not issued yet, and the IDs of the queries issued for them (0 if
+  //   they are always drawn), in the same order as the model groups (kept around to avoid reallocating every frame).
+  std::vector<bool> modelGroupOcclusionQueried;
+  std::vector<GLuint> modelGroupOcclusionQueries;
+  // The details of the point lights to bin into the light clusters (kept around to avoid reallocating every frame).
+  std::vector<ClusterLightData> clusterLights;
+  // The grid of light clusters the point lights are binned into.
+  LightClusterGrid lightClusterGrid;
+  // The GPU culling of the models drawn by the GPU-driven path.
+  GpuModelCulling gpuModelCulling;
+  // The occlusion culling of the models against the depth of the last frames.
+  OcclusionCuller occlusionCuller;
+  // The moments of the shadowmaps of the light types shadowed with variance shadow maps.
+  ShadowMomentMaps shadowMomentMaps;
+  // The G-buffer and the lighting pass of the deferred shading.
+  DeferredShading deferredShading;
+  // The half-resolution mask of the shadow visibility of the lights.
+  ShadowMask shadowMask;
+  // The picking of the models under a point of the screen on the GPU.
+  ModelPicker modelPicker;
+  // The cache of the lowest render layers, and whether the scene asks for them to be drawn from it.
+  RenderLayerCache layerCache;
+  bool isLayerCacheEnabled;
+  // The impostor atlases of the model types drawn with impostors, and the billboards drawn from them.
+  ImpostorRenderer impostorRenderer;
+  // The occlusion queries of the model groups drawn behind them, and the hit rates of their model types.
+  OcclusionQueries occlusionQueries;
+  // The pick requested for the next frame to be filled (0 as its ID if there is none), and the ID of the last request made.
+  PickRequest pendingPickRequest;
+  uint64_t lastPickRequestId;
 
   /**
-   * Registers a camera to be used as the active camera.
+   * Create a buffer for storing per-instance model details.
    * 
-   * @param cameraId  The ID of the camera to set as the active camera.
+   * @return The ID of the created buffer.
    */
-  void registerActiveCamera(const std::string &cameraId)
+  GLuint createInstanceBuffer()
   {
-    activeCameraId = cameraId;
+    // Define a variable for storing the buffer ID.
+    GLuint bufferId;
+    // Create a new buffer and store the buffer ID.
+    glGenBuffers(1, &bufferId);
+    // Return the ID of the created buffer.
+    return bufferId;
   }
 
   /**
-   * Render the shadow maps for all the lights in the scene, and return the map of lights categorized by their shadow map type.
+   * Get the projected size of a model in the view of a camera.
    * 
-   * @return The map of the lights in the scene categorized by their shadow map type.
+   * @param camera     The state of the camera.
+   * @param minCorner  The corner of the world AABB of the model with the smallest coordinates.
+   * @param maxCorner  The corner of the world AABB of the model with the largest coordinates.
+   * 
+   * @return The diameter of the world AABB as a share of the height of the view.
    */
-  std::map<const ShadowBufferType, std::vector<LightDetails>> renderLights() const
+  static float_t getScreenSize(const RenderCameraState &camera, const glm::vec3 &minCorner, const glm::vec3 &maxCorner)
   {
-    // Switch the viewport to the size of the render framebuffers.
-    windowManager.switchToFrameBufferViewport();
-
-    // Create a map of the categorized lights.
-    std::map<const ShadowBufferType, std::vector<LightDetails>> categorizedLightDetails({{ShadowBufferType::CONE, {}}, {ShadowBufferType::POINT, {}}});
-
-    // Set the current active shader ID to 0.
-    GLuint currentShaderId = 0;
-
+    const auto radius = 0.5f * glm::distance(minCorner, maxCorner);
+    const auto distance = glm::distance(0.5f * (minCorner + maxCorner), camera.position);
+    // The models around the camera fill the whole view.
+    if (distance <= radius)
     {
-      // Bind the cone light shadow framebuffer as the active framebuffer and clear it.
-      glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferManager.getConeLightShadowBufferId());
-      glClear(GL_DEPTH_BUFFER_BIT);
-
-      // Bind the point light shadow framebuffer as the active framebuffer and clear it.
-      glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferManager.getPointLightShadowBufferId());
-      glClear(GL_DEPTH_BUFFER_BIT);
-
-      // Bind the window framebuffer as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      return std::numeric_limits<float_t>::max();
     }
+    return radius * camera.matrices.projectionMatrix[1][1] / distance;
+  }
 
-    auto lightNamesCount = std::map<const std::string, int>({});
-    auto lightNamesProcessTime = std::map<const std::string, double>({});
-
-    std::map<const ShadowBufferType, std::vector<std::shared_ptr<LightBase>>> categorizedLights({{ShadowBufferType::CONE, {}}, {ShadowBufferType::POINT, {}}});
-    for (const auto &light : lightManager.getAllLights())
+  /**
+   * Get the interned name of the GPU timer the models of the type of the given model are drawn in, so that the name is only
+   *   built once per model type instead of every frame.
+   * 
+   * @param model  The model.
+   * 
+   * @return The interned name of the GPU timer.
+   */
+  NameId getModelTimerNameId(const ModelBaseIntf &model)
+  {
+    const auto existingTimerNameId = modelTimerNameIds.find(model.getModelNameId());
+    if (existingTimerNameId != modelTimerNameIds.end())
     {
-      categorizedLights.at(light->getShadowBufferDetails()->getShadowBufferType()).push_back(light);
+      return existingTimerNameId->second;
     }
+    const auto timerNameId = nameInterner.intern("Model Render::" + model.getModelName());
+    modelTimerNameIds.emplace(model.getModelNameId(), timerNameId);
+    return timerNameId;
+  }
 
-    for (const auto &lights : categorizedLights)
+  /**
+   * Group all the models in the scene by their model type into the given render packet, along with their model matrices and world AABBs.
+   * The models of a group inside the view frustum of the camera are stored before the ones outside it, ordered by the level of
+   *   detail their projected size selects, the ones far enough to be drawn as impostors (if their model type is) coming last with
+   *   the coarsest level. The models hidden behind the depth of the last frames are stored after the ones outside it.
+   * 
+   * @param packet  The render packet to fill, with the state of the active camera already in it.
+   */
+  void createModelGroups(RenderPacket &packet)
+  {
+    // Test the visible models against the depth pyramid of the last frames if there is one, going through the models of the
+    //   render groups, which are kept grouped by their model type as they are registered.
+    const auto &renderGroups = renderGroupManager.getGroups();
+    frameModels.clear();
+    for (const auto &renderGroup : renderGroups)
+    {
+      for (const auto &model : renderGroup.models)
+      {
+        frameModels.push_back(model.get());
+      }
+    }
+    frameModelVisibilities.resize(frameModels.size());
+    frameModelOcclusions.resize(frameModels.size());
+    const auto isOcclusionTested = occlusionCuller.acquireDepthPyramid();
+    jobManager.parallelFor(frameModels.size(), MODEL_CULL_JOB_SIZE, [this, &packet, isOcclusionTested](const size_t &begin, const size_t &end) {
+      for (auto i = begin; i < end; i++)
+      {
+        const auto transformHandle = frameModels[i]->getTransformHandle();
+        frameModelVisibilities[i] = packet.visibility.isVisible(packet.camera.visibilityView, transformHandle);
+        frameModelOcclusions[i] = isOcclusionTested && frameModelVisibilities[i] && occlusionCuller.isBoxOccluded(transformManager.getWorldMinCorner(transformHandle), transformManager.getWorldMaxCorner(transformHandle));
+      }
+    });
+
+    // Create the model groups and collect the model matrices of each group next to each other.
+    packet.modelGroups.clear();
+    packet.modelMatrices.clear();
+    packet.groupedModels.clear();
+    packet.groupedTransformHandles.clear();
+    packet.groupedTransformVersions.clear();
+    packet.groupedMinCorners.clear();
+    packet.groupedMaxCorners.clear();
+    packet.groupedScreenSizes.clear();
+    packet.groupedOcclusions.clear();
+    packet.occludedModelsCount = 0;
+    const auto addGroupedModel = [this, &packet](const std::shared_ptr<ModelBaseIntf> &model, const bool &isOccluded) {
+      const auto transformHandle = model->getTransformHandle();
+      packet.modelMatrices.push_back(interpolationFactor < 1.0f ? transformManager.getInterpolatedWorldMatrix(transformHandle, interpolationFactor) : transformManager.getWorldMatrix(transformHandle));
+      // Pack the spin of the model into the bottom row of its model matrix, left unused by the affine transformations, so that
+      //   every instance path carries it to the vertex shaders along with the matrix.
+      auto transformVersion = model->getTransformVersion();
+      const auto &spin = transformManager.getSpin(transformHandle);
+      if (spin.x != 0.0f)
+      {
+        packet.modelMatrices.back()[0][3] = spin.x;
+        packet.modelMatrices.back()[1][3] = spin.y;
+        // A spinning model looks different every frame while its transform stays the same, so its version follows the time too.
+        transformVersion ^= static_cast<uint64_t>(glm::floatBitsToUint(packet.animationTime)) << 32;
+      }
+      packet.groupedModels.push_back(model);
+      packet.groupedTransformHandles.push_back(transformHandle);
+      packet.groupedTransformVersions.push_back(transformVersion);
+      packet.groupedMinCorners.push_back(transformManager.getWorldMinCorner(transformHandle));
+      packet.groupedMaxCorners.push_back(transformManager.getWorldMaxCorner(transformHandle));
+      packet.groupedScreenSizes.push_back(getScreenSize(packet.camera, packet.groupedMinCorners.back(), packet.groupedMaxCorners.back()));
+      packet.groupedOcclusions.push_back(isOccluded);
+    };
+    // The frame models of each render group follow those of the group before it.
+    size_t groupOffset = 0;
+    for (const auto &renderGroup : renderGroups)
     {
-      if (lights.second.empty())
+      const auto &groupModels = renderGroup.models;
+      const auto firstModelIndex = groupOffset;
+      groupOffset += groupModels.size();
+      if (groupModels.empty())
       {
         continue;
       }
-
-      const auto startTime = glfwGetTime();
-
-      const auto firstLight = lights.second.front();
-
-      // Bind the shadowmap framebuffer of the light as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, firstLight->getShadowBufferDetails()->getShadowBufferId());
-
-      // Check if the shader of the light is the same as the currently used shader.
-      if (currentShaderId != firstLight->getShaderDetails()->getShaderId())
+      const auto instanceOffset = static_cast<uint32_t>(packet.modelMatrices.size());
+
+      // Sort the visible models by the level of detail their projected size selects, finding the distance of the closest one to
+      //   the camera.
+      const auto &objectDetails = groupModels.front()->getObjectDetails();
+      culledModels.clear();
+      occludedModels.clear();
+      for (auto &models : lodModels)
       {
-        // If not, set it as the currently used shader and use it.
-        currentShaderId = firstLight->getShaderDetails()->getShaderId();
-        glUseProgram(currentShaderId);
+        models.clear();
       }
-
-      // Iterate through all the lights in the scene.
-      for (unsigned long i = 0; i < lights.second.size(); i++)
+      impostorModels.clear();
+      const auto hasImpostors = isImpostorRenderingEnabled && groupModels.front()->getRenderFlags().hasImpostors;
+      auto viewDepth = std::numeric_limits<float_t>::max();
+      for (size_t i = 0; i < groupModels.size(); i++)
       {
-        const auto &light = lights.second.at(i);
-
-        if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
+        // Check if the world AABB of the model is outside the view frustum of the camera.
+        const auto &model = groupModels[i];
+        const auto modelIndex = firstModelIndex + i;
+        const auto transformHandle = model->getTransformHandle();
+        if (!frameModelVisibilities[modelIndex])
         {
-          lightNamesCount[light->getLightName()]++;
+          // If so, keep it aside, since it may still cast shadows into the view.
+          culledModels.push_back(model);
+          continue;
         }
-        else
+        // Check if it is hidden behind the depth of the last frames.
+        if (frameModelOcclusions[modelIndex])
         {
-          lightNamesCount[light->getLightName()] = 1;
-          lightNamesProcessTime[light->getLightName()] = 0.0f;
+          // If so, keep it aside as well, since it may still cast shadows into the view.
+          occludedModels.push_back(model);
+          continue;
         }
 
-        // Get the type of the shadow.
-        const auto shadowType = light->getShadowBufferDetails()->getShadowBufferType();
-        // Generate a structure detailing information about the light.
-        const LightDetails lightDetails = {
-            light->getLightPosition(),
-            light->getProjectionMatrices()[0] * light->getViewMatrices()[0] * glm::mat4(),
-            light->getLightColor(),
-            light->getLightIntensity(),
-            FRAMEBUFFER_WIDTH,
-            FRAMEBUFFER_WIDTH,
-            light->getLightNearPlane(),
-            light->getLightFarPlane(),
-            light->getShadowBufferDetails()->getShadowBufferTextureArrayLayerId()};
-        // Store the light details in the categorized map.
-        categorizedLightDetails.at(shadowType).push_back(lightDetails);
+        const auto screenSize = getScreenSize(packet.camera, transformManager.getWorldMinCorner(transformHandle), transformManager.getWorldMaxCorner(transformHandle));
+        (hasImpostors && screenSize < IMPOSTOR_SCREEN_SIZE ? impostorModels : lodModels[objectDetails->selectLod(screenSize)]).push_back(model);
+        viewDepth = std::min(viewDepth, glm::length(transformManager.getPosition(transformHandle) - packet.camera.position));
+      }
 
-        // If shadows are disabled, skip the shadowmap render step.
-        if (disableFeatureMask >= DISABLE_SHADOW)
+      // Collect the model matrices of the visible models first, one level of detail after the other, followed by the impostors,
+      //   which are drawn with the coarsest level by the passes not drawing the impostors.
+      std::array<uint32_t, OBJECT_LOD_COUNT> lodInstanceCounts;
+      for (uint32_t i = 0; i < OBJECT_LOD_COUNT; i++)
+      {
+        lodInstanceCounts[i] = static_cast<uint32_t>(lodModels[i].size());
+        for (const auto &model : lodModels[i])
+        {
+          addGroupedModel(model, false);
+        }
+      }
+      const auto impostorInstanceCount = static_cast<uint32_t>(impostorModels.size());
+      lodInstanceCounts[OBJECT_LOD_COUNT - 1] += impostorInstanceCount;
+      for (const auto &model : impostorModels)
+      {
+        addGroupedModel(model, false);
+      }
+      const auto visibleInstanceCount = static_cast<uint32_t>(packet.modelMatrices.size()) - instanceOffset;
+
+      // Collect the model matrices of the culled models after the visible ones, followed by the hidden ones.
+      for (const auto &model : culledModels)
+      {
+        addGroupedModel(model, false);
+      }
+      for (const auto &model : occludedModels)
+      {
+        addGroupedModel(model, true);
+      }
+      packet.occludedModelsCount += static_cast<uint32_t>(occludedModels.size());
+
+      packet.modelGroups.push_back({groupModels.front(), instanceOffset, static_cast<uint32_t>(groupModels.size()), visibleInstanceCount, viewDepth, lodInstanceCounts, impostorInstanceCount});
+    }
+  }
+
+  /**
+   * Group the models inside the view frustum of the camera of an additional view by their model type, from the model groups of
+   *   the frame, along with their model matrices and world AABBs. The models are ordered by the level of detail their projected
+   *   size in the view selects. The depth of the last frames is only captured for the view of the active camera, so the models
+   *   are not tested against it.
+   * 
+   * @param packet  The render packet to fill, with the model groups of the frame already in it.
+   * @param view    The view to fill, with the state of its camera already in it.
+   */
+  void createViewModelGroups(const RenderPacket &packet, RenderViewState &view)
+  {
+    view.modelGroups.clear();
+    view.modelMatrices.clear();
+    view.groupedTransformHandles.clear();
+    view.groupedMinCorners.clear();
+    view.groupedMaxCorners.clear();
+    view.groupedScreenSizes.clear();
+    for (const auto &modelGroup : packet.modelGroups)
+    {
+      // Sort the visible models by the level of detail their projected size selects, finding the distance of the closest one to
+      //   the camera.
+      const auto &objectDetails = modelGroup.model->getObjectDetails();
+      for (auto &instances : viewLodInstances)
+      {
+        instances.clear();
+      }
+      auto viewDepth = std::numeric_limits<float_t>::max();
+      for (auto i = modelGroup.instanceOffset; i < modelGroup.instanceOffset + modelGroup.instanceCount; i++)
+      {
+        const auto transformHandle = packet.groupedTransformHandles[i];
+        if (!packet.visibility.isVisible(view.camera.visibilityView, transformHandle))
         {
           continue;
         }
+        const auto screenSize = getScreenSize(view.camera, packet.groupedMinCorners[i], packet.groupedMaxCorners[i]);
+        viewLodInstances[objectDetails->selectLod(screenSize)].push_back(i);
+        viewDepth = std::min(viewDepth, glm::length(transformManager.getPosition(transformHandle) - view.camera.position));
+      }
 
-        // Get the view and projection matrices of the light.
-        const auto viewMatrices = light->getViewMatrices();
-        const auto projectionMatrices = light->getProjectionMatrices();
-
-        // Get the uniform ID of the count of the projection-view matrix variable and set it.
-        const auto vpMatrixCountVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountVertexId, viewMatrices.size());
-        const auto vpMatrixCountGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountGeometryId, viewMatrices.size());
-        const auto vpMatrixCountFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountFragmentId, viewMatrices.size());
-
-        // Get the uniform ID of the light position variable and set it.
-        const auto lightPositionVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-        const auto lightPositionGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionGeometryId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-        const auto lightPositionFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-        // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-        const auto layerIdVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdVertexId, lightDetails.textureArrayLayerId);
-        const auto layerIdGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdGeometryId, lightDetails.textureArrayLayerId);
-        const auto layerIdFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdFragmentId, lightDetails.textureArrayLayerId);
-
-        // Get the uniform ID of the near plane of the light variable and set it.
-        const auto nearPlaneVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneVertexId, lightDetails.nearPlane);
-        const auto nearPlaneGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_geometry[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneGeometryId, lightDetails.nearPlane);
-        const auto nearPlaneFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneFragmentId, lightDetails.nearPlane);
-
-        // Get the uniform ID of the far plane of the light variable and set it.
-        const auto farPlaneVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneVertexId, lightDetails.farPlane);
-        const auto farPlaneGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_geometry[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneGeometryId, lightDetails.farPlane);
-        const auto farPlaneFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneFragmentId, lightDetails.farPlane);
-
-        // Iterate through the view matrices of the light.
-        for (unsigned long j = 0; j < viewMatrices.size(); j++)
-        {
-          // Calculate the projection-view matrix.
-          const auto vpMatrix = projectionMatrices[j] * viewMatrices[j];
-          // Get the uniform ID of the projection-view matrix of the light variable and set it.
-          const auto vpMatrixVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixVertexId, 1, GL_FALSE, &vpMatrix[0][0]);
-          const auto vpMatrixGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixGeometryId, 1, GL_FALSE, &vpMatrix[0][0]);
-          const auto vpMatrixFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixFragmentId, 1, GL_FALSE, &vpMatrix[0][0]);
-        }
-      }
-
-      // Get the uniform ID of the lights count variable and set it.
-      const auto lightsCountVertexId = glGetUniformLocation(firstLight->getShaderDetails()->getShaderId(), "lightsCount");
-      glUniform1i(lightsCountVertexId, lights.second.size());
-
-      // Iterate through the models in the scene.
-      for (const auto &model : modelManager.getAllModels())
-      {
-        // Get the model matrix of the model.
-        const auto modelMatrix = model->getModelMatrix();
-        // Get the uniform ID of the model matrix variable and set it.
-        const auto modelMatrixId = glGetUniformLocation(firstLight->getShaderDetails()->getShaderId(), "modelMatrix");
-        glUniformMatrix4fv(modelMatrixId, 1, GL_FALSE, &modelMatrix[0][0]);
-
-        // Define a vertex attribute array that contains the vertex position data of the model.
-        VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-
-        // Enable it so that it can be used by the GPU.
-        vertexArray.enableAttribute();
-
-        // Draw the triangles of the model.
-        glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
+      // Collect the model matrices of the visible models, one level of detail after the other, skipping the groups without any.
+      const auto instanceOffset = static_cast<uint32_t>(view.modelMatrices.size());
+      std::array<uint32_t, OBJECT_LOD_COUNT> lodInstanceCounts;
+      for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
+      {
+        lodInstanceCounts[l] = static_cast<uint32_t>(viewLodInstances[l].size());
+        for (const auto &instance : viewLodInstances[l])
+        {
+          view.modelMatrices.push_back(packet.modelMatrices[instance]);
+          view.groupedTransformHandles.push_back(packet.groupedTransformHandles[instance]);
+          view.groupedMinCorners.push_back(packet.groupedMinCorners[instance]);
+          view.groupedMaxCorners.push_back(packet.groupedMaxCorners[instance]);
+          view.groupedScreenSizes.push_back(getScreenSize(view.camera, view.groupedMinCorners.back(), view.groupedMaxCorners.back()));
+        }
+      }
+      const auto visibleInstanceCount = static_cast<uint32_t>(view.modelMatrices.size()) - instanceOffset;
+      if (visibleInstanceCount == 0)
+      {
+        continue;
       }
+      view.modelGroups.push_back({modelGroup.model, instanceOffset, visibleInstanceCount, visibleInstanceCount, viewDepth, lodInstanceCounts, 0});
+    }
+  }
 
-      // Bind the window framebuffer as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  /**
+   * Write the given per-instance details to an instance buffer, orphaning the storage used by the last frame.
+   * 
+   * @param bufferId   The ID of the instance buffer.
+   * @param values     The per-instance details to write.
+   * @param assetName  The name the storage of the buffer is accounted under.
+   */
+  template <typename T>
+  void writeInstanceBuffer(const GLuint &bufferId, const std::vector<T> &values, const std::string &assetName)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, bufferId);
+    GlCalls::bufferData(GL_ARRAY_BUFFER, values.size() * sizeof(T), values.data(), GL_STREAM_DRAW);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, assetName, values.size() * sizeof(T));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
 
-      const auto endTime = glfwGetTime();
+  /**
+   * Write the given per-instance details to the stream buffer, or to the given instance buffer if the stream buffer has no room
+   *   left for them, orphaning the storage used by the last frame.
+   * 
+   * @param bufferId   The ID of the instance buffer written if the stream buffer has no room left.
+   * @param values     The per-instance details to write.
+   * @param assetName  The name the storage of the instance buffer is accounted under.
+   * 
+   * @return The allocation the details were written to, with the buffer and the offset to point the attributes at.
+   */
+  template <typename T>
+  StreamAllocation writeStreamedInstances(const GLuint &bufferId, const std::vector<T> &values, const std::string &assetName)
+  {
+    const auto dataSize = values.size() * sizeof(T);
+    const auto allocation = streamBufferManager.allocate(dataSize);
+    if (allocation.data == nullptr)
+    {
+      writeInstanceBuffer(bufferId, values, assetName);
+      return {bufferId, 0, dataSize, nullptr};
+    }
+    memcpy(allocation.data, values.data(), dataSize);
+    streamBufferManager.commit(allocation, dataSize);
+    return allocation;
+  }
 
-      lightNamesProcessTime[firstLight->getLightName()] += (endTime - startTime) * 1000;
+  /**
+   * Multiply the projection and view matrices of the shadowmap faces of the given light, so that the render packet carries them
+   *   in a fixed-size array instead of copying the matrix vectors of the light.
+   * 
+   * @param light  The light.
+   * 
+   * @return The projection-view matrices of the faces of the light (only as many as the light has faces are set).
+   */
+  static std::array<glm::mat4, 6> createLightVpMatrices(const LightBase &light)
+  {
+    std::array<glm::mat4, 6> vpMatrices = {};
+    const auto &viewMatrices = light.getViewMatrices();
+    const auto &projectionMatrices = light.getProjectionMatrices();
+    for (size_t i = 0; i < viewMatrices.size() && i < vpMatrices.size(); i++)
+    {
+      vpMatrices[i] = projectionMatrices[i] * viewMatrices[i];
     }
+    return vpMatrices;
+  }
+
+  /**
+   * Copy the state of the given light aggregate into a render packet, shaded as its most important light moved to the position
+   *   of the aggregate.
+   * 
+   * @param aggregate  The light aggregate to copy the state of.
+   * 
+   * @return The state of the light.
+   */
+  static RenderLightState createRenderLightState(const LightAggregate &aggregate)
+  {
+    const auto &light = aggregate.light;
+    return {light,
+            light->getLightName(),
+            aggregate.position,
+            aggregate.color,
+            aggregate.intensity,
+            light->getLightNearPlane(),
+            aggregate.farPlane,
+            createLightVpMatrices(*light),
+            static_cast<uint32_t>(light->getViewMatrices().size()),
+            light->getShadowVersion(),
+            0};
+  }
 
-    auto height = 21.5f;
-    for (const auto &lightCounts : lightNamesCount)
+  /**
+   * Check if the given axis-aligned box is at least partially inside the given sphere.
+   * 
+   * @param minCorner  The corner of the box with the smallest coordinates.
+   * @param maxCorner  The corner of the box with the largest coordinates.
+   * @param center     The center of the sphere.
+   * @param radius     The radius of the sphere.
+   * 
+   * @return Whether the box is inside the sphere or not.
+   */
+  static bool isBoxInSphere(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const glm::vec3 &center, const float_t &radius)
+  {
+    // Find the point of the box closest to the center of the sphere, and check if it is within the radius.
+    const auto offset = glm::clamp(center, minCorner, maxCorner) - center;
+    return glm::dot(offset, offset) <= radius * radius;
+  }
+
+  /**
+   * Check if the shadowmap face with the given projection-view matrix can be seen through the view frustum of the camera, i.e. if
+   *   any of the fragments in the view can sample it. Tested with the world AABB of the frustum of the face, so it is conservative.
+   * 
+   * @param vpMatrix       The projection-view matrix of the shadowmap face.
+   * @param cameraFrustum  The view frustum of the camera.
+   * 
+   * @return Whether the face can be seen or not.
+   */
+  static bool isShadowFaceViewed(const glm::mat4 &vpMatrix, const Frustum &cameraFrustum)
+  {
+    // Take the corners of the frustum of the face back from the clip space cube into world space.
+    const auto inverseVpMatrix = glm::inverse(vpMatrix);
+    auto minCorner = glm::vec3(std::numeric_limits<float_t>::max()), maxCorner = glm::vec3(std::numeric_limits<float_t>::lowest());
+    for (auto corner = 0; corner < 8; corner++)
     {
-      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Light Render Instances: " + std::to_string(lightCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      const auto cornerPosition = inverseVpMatrix * glm::vec4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f, 1.0f);
+      minCorner = glm::min(minCorner, glm::vec3(cornerPosition) / cornerPosition.w);
+      maxCorner = glm::max(maxCorner, glm::vec3(cornerPosition) / cornerPosition.w);
     }
+    return cameraFrustum.isBoxInside(minCorner, maxCorner);
+  }
 
-    // Return the map of the categorized lights.
-    return categorizedLightDetails;
+  /**
+   * Combine the given value into the given shadowmap signature.
+   * 
+   * @param signature  The signature to combine the value into.
+   * @param value      The value to combine.
+   */
+  static void combineShadowSignature(uint64_t &signature, const uint64_t &value)
+  {
+    signature ^= value + 0x9E3779B97F4A7C15ull + (signature << 6) + (signature >> 2);
   }
 
   /**
-   * Render the shadow maps for all the models in the scene.
+   * Check if the shadowmap faces of the given lights are drawn as one instance per face picking its layer in the vertex shader,
+   *   instead of having the geometry shader emit every triangle into every face. Only point lights have a geometry-shader-free
+   *   path, and only if the vertex shader layer output is supported (the lights pick their shaders the same way).
    * 
-   * @param categorizedLights  The categorized map of lights in the scene.
+   * @param lights  The lights rendering to the shadow buffer type.
+   * 
+   * @return Whether the faces are drawn as instances or not.
    */
-  void renderModels(const std::map<const ShadowBufferType, std::vector<LightDetails>> &categorizedLights) const
+  bool isShadowFaceInstanced(const std::vector<const RenderLightState *> &lights) const
   {
-    // Switch the viewport to the size of the window viewport.
-    windowManager.switchToWindowViewport();
-    // Set the clear screen color to pure white.
-    windowManager.setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    return !lights.empty() && lights[0]->light->getShadowBufferDetails()->getShadowBufferType() == ShadowBufferType::POINT && windowManager.isVertexShaderLayerSupported();
+  }
 
-    // Clear the color buffer and depth buffer of the screen.
-    windowManager.clearScreen(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  /**
+   * Check if the shadows of the given model are cached in the static faces of the shadowmaps, apart from the other casters.
+   * 
+   * @param model  The model to check.
+   * 
+   * @return Whether the model is a static caster with its shadows cached or not.
+   */
+  bool isStaticShadowCaster(const std::shared_ptr<ModelBaseIntf> &model) const
+  {
+    return shadowBufferManager.isStaticShadowCacheEnabled() && model->getRenderFlags().isStaticCaster;
+  }
 
-    // Set the current active shader ID to 0.
-    GLuint currentShaderId = 0;
-    // Get the active camera to use to render the video.
-    const auto activeCamera = cameraManager.getCamera(activeCameraId);
-    // Get the view matrix of the camera.
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    // Get the projection matrix of the camera.
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto modelNamesCount = std::map<const std::string, int>({});
-    auto modelNamesProcessTime = std::map<const std::string, double>({});
-    auto modelNamesPolygonCount = std::map<const std::string, long>({});
-    auto totalPolygons = 0l;
+  /**
+   * Find the models that cast shadows into the shadowmaps of the given lights, and write their details to the shadow caster buffer.
+   * A model is a caster of a light if it is within the far plane of the light, and a caster of a shadowmap face if it is inside its frustum,
+   *   as found by the visibility of the frame for the view of the face.
+   * Only the outdated faces get casters, where all the faces of a shadowmap are outdated if the light or the set of its casters
+   *   (including their transform versions) changed since the last time it was rendered. Faces that had nothing drawn into them
+   *   and still have no casters are left as they are, and so are the outdated faces out of the views of the camera and of the
+   *   additional views until they come into one, since no fragment in the views samples them.
+   * If the shadows of the static casters are cached, the static casters are only drawn into the cached static faces, which are
+   *   rendered again along with the faces when the light or the static casters change, and copied into the faces in place of
+   *   clearing them. The other casters are drawn into the faces on top.
+   * While the updates are amortized, the point lights only get their outdated faces rendered within the budget of faces per frame,
+   *   picked round-robin from the lights that are moving fastest, closest to the camera and waiting the longest first.
+   * 
+   * @param packet                The render packet of the frame.
+   * @param lights                The lights rendering to the shadow buffer type.
+   * @param shadowData            The shadow details of the lights.
+   * @param dirtyFacesMask        Set to the mask of the faces rendered this frame (a bit per light per face, light * 6 + face).
+   * @param staticDirtyFacesMask  Set to the mask of the cached static faces rendered this frame (a bit per light per face).
+   * @param staticCopyFacesMask   Set to the mask of the faces rendered this frame copied from their cached static faces, instead of
+   *                                being cleared (a bit per light per face).
+   * @param unviewedFacesMask     Set to the mask of the outdated faces left for later for being out of the view (a bit per light per face).
+   * 
+   * @return The list of groups of shadow casters, referring to the shadow caster buffer instead of the model matrix buffer.
+   */
+  std::vector<ModelGroup> createShadowCasterGroups(const RenderPacket &packet, const std::vector<const RenderLightState *> &lights, const ShadowData &shadowData, uint32_t &dirtyFacesMask, uint32_t &staticDirtyFacesMask, uint32_t &staticCopyFacesMask, uint32_t &unviewedFacesMask)
+  {
+    const auto &modelGroups = packet.modelGroups;
+    // Find the faces of all the lights seen through the view frustum of the camera, and start their signatures with the details
+    //   of the light.
+    std::vector<uint64_t> lightSignatures(shadowData.lightsCount, 0);
+    std::vector<uint32_t> lightCasterFaces(shadowData.lightsCount, 0);
+    // The signatures of the lights with only their static casters, and the masks of the faces the static casters are inside of.
+    std::vector<uint64_t> lightStaticSignatures(shadowData.lightsCount, 0);
+    std::vector<uint32_t> lightStaticCasterFaces(shadowData.lightsCount, 0);
+    // The masks of the faces of each light seen through the view frustum of the camera or of any additional view, since the
+    //   additional views sample the same shadowmaps.
+    std::vector<uint32_t> lightViewedFaces(shadowData.lightsCount, 0);
+    for (int32_t i = 0; i < shadowData.lightsCount; i++)
+    {
+      for (int32_t j = 0; j < shadowData.lights[i].vpMatrixCount; j++)
+      {
+        const auto &vpMatrix = shadowData.lights[i].vpMatrices[j];
+        auto isViewed = isShadowFaceViewed(vpMatrix, packet.camera.matrices.frustum);
+        for (size_t v = 0; v < packet.views.size() && !isViewed; v++)
+        {
+          isViewed = isShadowFaceViewed(vpMatrix, packet.views[v].camera.matrices.frustum);
+        }
+        if (isViewed)
+        {
+          lightViewedFaces[i] |= 1u << j;
+        }
+      }
+      combineShadowSignature(lightSignatures[i], lights[i]->shadowVersion);
+      // Add the shadow atlas tile of the light, since moving to another tile leaves the new one outdated.
+      const auto &shadowMapTile = lights[i]->light->getShadowBufferDetails()->getShadowMapTile();
+      combineShadowSignature(lightSignatures[i], (static_cast<uint64_t>(shadowMapTile.size) << 32) | (static_cast<uint64_t>(shadowMapTile.y) << 16) | static_cast<uint64_t>(shadowMapTile.x));
+      lightStaticSignatures[i] = lightSignatures[i];
+    }
 
-    // Iterate through all the models in the scene.
-    for (const auto &model : modelManager.getAllModels())
+    // Iterate through all the model groups, collecting the models casting shadows into at least one face, one level of detail
+    //   after the other.
+    std::vector<std::pair<uint32_t, uint32_t>> casterRanges;
+    std::vector<std::array<uint32_t, OBJECT_LOD_COUNT>> casterLodCounts;
+    shadowCasters.clear();
+    for (const auto &modelGroup : modelGroups)
     {
-      // Check if the shader of the light is the same as the currently used shader.
-      if (currentShaderId != model->getShaderDetails()->getShaderId())
+      const auto instanceOffset = static_cast<uint32_t>(shadowCasters.size());
+      // Skip the model types that do not cast shadows.
+      if (!modelGroup.model->getRenderFlags().isShadowCaster)
+      {
+        casterRanges.push_back({instanceOffset, 0});
+        casterLodCounts.push_back({});
+        continue;
+      }
+      const auto &objectDetails = modelGroup.model->getObjectDetails();
+      const auto isStaticGroup = isStaticShadowCaster(modelGroup.model);
+      for (auto &casters : lodShadowCasters)
+      {
+        casters.clear();
+      }
+      for (uint32_t k = modelGroup.instanceOffset; k < modelGroup.instanceOffset + modelGroup.instanceCount; k++)
+      {
+        const auto &transformHandle = packet.groupedTransformHandles[k];
+        // The shadows are drawn with a coarser level of detail than the model would be drawn with at its size in the view.
+        const auto casterLod = objectDetails->selectLod(packet.groupedScreenSizes[k] * SHADOW_LOD_SCREEN_SIZE_SCALE);
+
+        // Calculate the mask of the faces the model is inside of (and within the far plane of the light).
+        uint32_t casterMask = 0;
+        for (int32_t i = 0; i < shadowData.lightsCount; i++)
+        {
+          uint32_t faceMask = 0;
+          for (int32_t j = 0; j < shadowData.lights[i].vpMatrixCount; j++)
+          {
+            if (packet.visibility.isVisible(lights[i]->visibilityView + j, transformHandle))
+            {
+              faceMask |= 1u << j;
+            }
+          }
+          if (faceMask == 0)
+          {
+            continue;
+          }
+
+          // Add the model to the signature of the light along with its level of detail, since they change what the shadowmap contains.
+          casterMask |= faceMask << (i * 6);
+          lightCasterFaces[i] |= faceMask;
+          combineShadowSignature(lightSignatures[i], packet.groupedTransformVersions[k]);
+          combineShadowSignature(lightSignatures[i], (static_cast<uint64_t>(casterLod) << 32) | faceMask);
+          // Add the static casters to the static signature as well, since they change what the cached static faces contain.
+          if (isStaticGroup)
+          {
+            lightStaticCasterFaces[i] |= faceMask;
+            combineShadowSignature(lightStaticSignatures[i], packet.groupedTransformVersions[k]);
+            combineShadowSignature(lightStaticSignatures[i], (static_cast<uint64_t>(casterLod) << 32) | faceMask);
+          }
+        }
+
+        // Store the model as a caster only if it is drawn into at least one face.
+        if (casterMask != 0)
+        {
+          lodShadowCasters[casterLod].push_back({packet.modelMatrices[k], casterMask, 0, {}});
+        }
+      }
+
+      std::array<uint32_t, OBJECT_LOD_COUNT> lodCasterCounts;
+      for (uint32_t i = 0; i < OBJECT_LOD_COUNT; i++)
       {
-        // If not, set it as the currently used shader and use it.
-        currentShaderId = model->getShaderDetails()->getShaderId();
-        glUseProgram(currentShaderId);
+        lodCasterCounts[i] = static_cast<uint32_t>(lodShadowCasters[i].size());
+        shadowCasters.insert(shadowCasters.end(), lodShadowCasters[i].begin(), lodShadowCasters[i].end());
       }
+      casterRanges.push_back({instanceOffset, static_cast<uint32_t>(shadowCasters.size()) - instanceOffset});
+      casterLodCounts.push_back(lodCasterCounts);
+    }
 
-      if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
+    // Compare the signatures of the lights with the ones their faces were last marked outdated for, marking all the faces outdated if they differ.
+    const auto &cameraPosition = packet.camera.position;
+    std::vector<ShadowFaceState *> faceStates(shadowData.lightsCount, nullptr);
+    std::vector<std::pair<float_t, int32_t>> lightPriorities;
+    for (int32_t i = 0; i < shadowData.lightsCount; i++)
+    {
+      const auto &shadowBufferDetails = lights[i]->light->getShadowBufferDetails();
+      auto &layerFaceStates = shadowFaceStates[shadowBufferDetails->getShadowBufferType()];
+      const auto lightPosition = glm::vec3(shadowData.lights[i].lightPosition);
+      const uint32_t lightFacesMask = (1u << shadowData.lights[i].vpMatrixCount) - 1;
+      // The cached static faces are only rendered if the shadows of the static casters are cached.
+      const uint32_t lightStaticFacesMask = shadowBufferManager.isStaticShadowCacheEnabled() ? lightFacesMask : 0;
+      const auto layerFaceState = layerFaceStates.find(shadowBufferDetails->getShadowBufferTextureArrayLayerId());
+      if (layerFaceState == layerFaceStates.end())
       {
-        modelNamesCount[model->getModelName()]++;
+        // The layer was never rendered for the light, so all the faces are outdated and have to be cleared.
+        faceStates[i] = &(layerFaceStates[shadowBufferDetails->getShadowBufferTextureArrayLayerId()] = {lightSignatures[i], lightFacesMask, lightFacesMask, 0, 0, lightPosition, lightStaticSignatures[i], lightStaticFacesMask, lightStaticFacesMask});
       }
       else
       {
-        modelNamesCount[model->getModelName()] = 1;
-        modelNamesProcessTime[model->getModelName()] = 0.0f;
-      }
-
-      const auto startTime = glfwGetTime();
-
-      // Get the model matrix of the model.
-      const auto modelMatrix = model->getModelMatrix();
-      // Get the uniform ID of the model matrix variable and set it.
-      const auto modelMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.modelMatrix");
-      glUniformMatrix4fv(modelMatrixVertexId, 1, GL_FALSE, &modelMatrix[0][0]);
-      const auto modelMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.modelMatrix");
-      glUniformMatrix4fv(modelMatrixFragmentId, 1, GL_FALSE, &modelMatrix[0][0]);
-
-      // Get the uniform ID of the diffuse texture of the model variable and set it.
-      const auto diffuseTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "diffuseTexture");
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, model->getTextureDetails()->getTextureId());
-      glUniform1i(diffuseTextureId, 0);
-
-      // Get the uniform ID of the view matrix of the camera variable and set it.
-      const auto viewMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.viewMatrix");
-      glUniformMatrix4fv(viewMatrixVertexId, 1, GL_FALSE, &viewMatrix[0][0]);
-      const auto viewMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.viewMatrix");
-      glUniformMatrix4fv(viewMatrixFragmentId, 1, GL_FALSE, &viewMatrix[0][0]);
-
-      // Get the uniform ID of the projection matrix of the camera variable and set it.
-      const auto projectionMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.projectionMatrix");
-      glUniformMatrix4fv(projectionMatrixVertexId, 1, GL_FALSE, &projectionMatrix[0][0]);
-      const auto projectionMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.projectionMatrix");
-      glUniformMatrix4fv(projectionMatrixFragmentId, 1, GL_FALSE, &projectionMatrix[0][0]);
-
-      // Get the uniform ID of the disable feature mask variable and set it.
-      const auto disableFeatureMaskId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "disableFeatureMask");
-      glUniform1i(disableFeatureMaskId, disableFeatureMask);
-
-      // Get the uniform ID of the ambient lighting factor variable and set it.
-      const auto ambientFactorId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "ambientFactor");
-      glUniform1f(ambientFactorId, ambientFactor);
-      // Get the uniform ID of the cone lights count in the scene and set it.
-      const auto coneLightsCountId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "coneLightsCount");
-      glUniform1i(coneLightsCountId, categorizedLights.at(ShadowBufferType::CONE).size());
-      // Get the uniform ID of the point lights count in the scene and set it.
-      const auto pointLightsCountId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "pointLightsCount");
-      glUniform1i(pointLightsCountId, categorizedLights.at(ShadowBufferType::POINT).size());
-
-      // If lighting is not disabled, then setup the lighting information.
-      if (disableFeatureMask < DISABLE_LIGHT)
-      {
-        // Iterate through the cone lights in the scene.
-        for (unsigned long i = 0; i < categorizedLights.at(ShadowBufferType::CONE).size(); i++)
-        {
-          // Get the details of the cone light.
-          const auto lightDetails = categorizedLights.at(ShadowBufferType::CONE)[i];
-
-          // Get the uniform ID of the light position variable and set it.
-          const auto lightPositionVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-          const auto lightPositionFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-          // Get the uniform ID of the count of the projection-view matrix variable and set it.
-          const auto lightVpMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixVertexId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-          const auto lightVpMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixFragmentId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-
-          // Get the uniform ID of the light color-intensity variable and set it.
-          const auto lightColorIntensityVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityVertexId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-          const auto lightColorIntensityFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityFragmentId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-
-          // Get the uniform ID of the near plane of the light variable and set it.
-          const auto lightNearPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneVertexId, lightDetails.nearPlane);
-          const auto lightNearPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneFragmentId, lightDetails.nearPlane);
-
-          // Get the uniform ID of the far plane of the light variable and set it.
-          const auto lightFarPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneVertexId, lightDetails.farPlane);
-          const auto lightFarPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneFragmentId, lightDetails.farPlane);
-
-          // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-          const auto lightLayerIdVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdVertexId, lightDetails.textureArrayLayerId);
-          const auto lightLayerIdFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdFragmentId, lightDetails.textureArrayLayerId);
-        }
-
-        // Iterate through the point lights in the scene.
-        for (unsigned long i = 0; i < categorizedLights.at(ShadowBufferType::POINT).size(); i++)
-        {
-          // Get the details of the point light.
-          const auto lightDetails = categorizedLights.at(ShadowBufferType::POINT)[i];
-
-          // Get the uniform ID of the light position variable and set it.
-          const auto lightPositionVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-          const auto lightPositionFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-          // Get the uniform ID of the count of the projection-view matrix variable and set it.
-          const auto lightVpMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixVertexId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-          const auto lightVpMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixFragmentId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-
-          // Get the uniform ID of the light color-intensity variable and set it.
-          const auto lightColorIntensityVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityVertexId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-          const auto lightColorIntensityFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityFragmentId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-
-          // Get the uniform ID of the near plane of the light variable and set it.
-          const auto lightNearPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneVertexId, lightDetails.nearPlane);
-          const auto lightNearPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneFragmentId, lightDetails.nearPlane);
-
-          // Get the uniform ID of the far plane of the light variable and set it.
-          const auto lightFarPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneVertexId, lightDetails.farPlane);
-          const auto lightFarPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneFragmentId, lightDetails.farPlane);
-
-          // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-          const auto lightLayerIdVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdVertexId, lightDetails.textureArrayLayerId / 6);
-          const auto lightLayerIdFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdFragmentId, lightDetails.textureArrayLayerId / 6);
-        }
-      }
-
-      // Get the uniform ID of the cone light shadow map texture array and set it.
-      const auto coneLightTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "coneLightTextures");
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D_ARRAY, shadowBufferManager.getConeLightTextureArrayId());
-      glUniform1i(coneLightTextureId, 1);
-
-      // Get the uniform ID of the point light shadow map texture array and set it.
-      const auto pointLightTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "pointLightTextures");
-      glActiveTexture(GL_TEXTURE2);
-      glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowBufferManager.getPointLightTextureArrayId());
-      glUniform1i(pointLightTextureId, 2);
+        faceStates[i] = &layerFaceState->second;
+        if (faceStates[i]->signature != lightSignatures[i])
+        {
+          faceStates[i]->signature = lightSignatures[i];
+          faceStates[i]->pendingFacesMask |= lightFacesMask;
+        }
+        if (faceStates[i]->staticSignature != lightStaticSignatures[i])
+        {
+          faceStates[i]->staticSignature = lightStaticSignatures[i];
+          faceStates[i]->staticPendingFacesMask |= lightStaticFacesMask;
+        }
+      }
+      auto &faceState = *faceStates[i];
+
+      // Faces that were empty and still have no casters are already up to date, and so are the cached static ones.
+      // The faces are rendered again along with their cached static faces, since they are copied from them.
+      faceState.pendingFacesMask &= lightCasterFaces[i] | faceState.occupiedFacesMask;
+      faceState.staticPendingFacesMask &= lightStaticCasterFaces[i] | faceState.staticOccupiedFacesMask;
+      faceState.pendingFacesMask |= faceState.staticPendingFacesMask;
+
+      // Prioritize the lights moving the fastest and closest to the camera, raising the priority for every frame they wait.
+      // Only the outdated faces in the view are waiting, the others are left outdated until they come into it.
+      const auto lightSpeed = glm::distance(faceState.lastLightPosition, lightPosition);
+      faceState.lastLightPosition = lightPosition;
+      if ((faceState.pendingFacesMask & lightViewedFaces[i]) == 0)
+      {
+        faceState.staleFrames = 0;
+        continue;
+      }
+      faceState.staleFrames++;
+      lightPriorities.push_back({faceState.staleFrames * (1.0f + lightSpeed) / (1.0f + glm::distance(cameraPosition, lightPosition)), i});
+    }
 
-      // Define vertex attribute arrays that contains the vertex position, UV coordinates, and normal vector data of the model.
-      VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-      VertexAttributeArray uvArray("UvArray", model->getObjectDetails()->getUvBufferId(), 2);
-      VertexAttributeArray normalArray("NormalArray", model->getObjectDetails()->getNormalBufferId(), 3);
-
-      // Enable them so that it can be used by the GPU.
-      vertexArray.enableAttribute();
-      uvArray.enableAttribute();
-      normalArray.enableAttribute();
+    // Pick the outdated faces to render this frame, in the order of the light priorities, within the budget while the updates are amortized.
+    std::sort(lightPriorities.begin(), lightPriorities.end(), std::greater<std::pair<float_t, int32_t>>());
+    const auto isAmortized = isShadowUpdateAmortized && !lights.empty() && lights[0]->light->getShadowBufferDetails()->getShadowBufferType() == ShadowBufferType::POINT;
+    auto facesBudget = isAmortized ? POINT_LIGHT_SHADOW_FACES_PER_FRAME : std::numeric_limits<uint32_t>::max();
+    dirtyFacesMask = 0;
+    staticDirtyFacesMask = 0;
+    staticCopyFacesMask = 0;
+    unviewedFacesMask = 0;
+    for (int32_t i = 0; i < shadowData.lightsCount; i++)
+    {
+      unviewedFacesMask |= (faceStates[i]->pendingFacesMask & ~lightViewedFaces[i]) << (i * 6);
+    }
+    for (const auto &lightPriority : lightPriorities)
+    {
+      const auto i = lightPriority.second;
+      auto &faceState = *faceStates[i];
+      for (uint32_t j = 0; j < 6 && facesBudget > 0; j++)
+      {
+        const auto face = (faceState.nextFace + j) % 6;
+        if ((faceState.pendingFacesMask & lightViewedFaces[i] & (1u << face)) == 0)
+        {
+          continue;
+        }
 
-      // Draw the triangles of the model.
-      glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
-      const auto endTime = glfwGetTime();
+        // Render the face again, remembering if anything is drawn into it.
+        faceState.pendingFacesMask &= ~(1u << face);
+        faceState.occupiedFacesMask = (faceState.occupiedFacesMask & ~(1u << face)) | (lightCasterFaces[i] & (1u << face));
+        faceState.nextFace = (face + 1) % 6;
+        dirtyFacesMask |= 1u << ((i * 6) + face);
+        facesBudget--;
 
-      modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
-      modelNamesPolygonCount[model->getModelName()] = model->getObjectDetails()->getBufferSize() / 3;
-      totalPolygons += model->getObjectDetails()->getBufferSize() / 3;
+        // Render the cached static face again too if it is outdated, and copy it into the face if anything is drawn into it.
+        if ((faceState.staticPendingFacesMask & (1u << face)) != 0)
+        {
+          faceState.staticPendingFacesMask &= ~(1u << face);
+          faceState.staticOccupiedFacesMask = (faceState.staticOccupiedFacesMask & ~(1u << face)) | (lightStaticCasterFaces[i] & (1u << face));
+          staticDirtyFacesMask |= 1u << ((i * 6) + face);
+        }
+        if ((faceState.staticOccupiedFacesMask & (1u << face)) != 0)
+        {
+          staticCopyFacesMask |= 1u << ((i * 6) + face);
+        }
+      }
+      if ((faceState.pendingFacesMask & lightViewedFaces[i]) == 0)
+      {
+        faceState.staleFrames = 0;
+      }
     }
 
-    auto height = 23.0f;
-    for (const auto &modelCounts : modelNamesCount)
+    // Remove the faces of the up to date shadowmaps from the casters, dropping the casters left with no faces.
+    // If the faces are drawn as instances, every caster is repeated once per face it is drawn into instead.
+    const auto isFaceInstanced = isShadowFaceInstanced(lights);
+    std::vector<ModelGroup> casterGroups;
+    uint32_t casterCount = 0;
+    shadowCasterFaces.clear();
+    for (uint32_t g = 0; g < modelGroups.size(); g++)
     {
-      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Model Render Instances: " + std::to_string(modelCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms | Polygon Count: " + std::to_string(modelNamesPolygonCount[modelCounts.first]), glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      const auto instanceOffset = isFaceInstanced ? static_cast<uint32_t>(shadowCasterFaces.size()) : casterCount;
+      // Keep the casters left ordered by their level of detail, counting the instances left of each level.
+      std::array<uint32_t, OBJECT_LOD_COUNT> lodInstanceCounts;
+      auto k = casterRanges[g].first;
+      for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
+      {
+        const auto lodInstanceOffset = isFaceInstanced ? static_cast<uint32_t>(shadowCasterFaces.size()) : casterCount;
+        for (const auto lodEnd = k + casterLodCounts[g][l]; k < lodEnd; k++)
+        {
+          // The static casters are only drawn into the cached static faces rendered this frame.
+          shadowCasters[k].casterMask &= isStaticShadowCaster(modelGroups[g].model) ? staticDirtyFacesMask : dirtyFacesMask;
+          if (shadowCasters[k].casterMask == 0)
+          {
+            continue;
+          }
+          for (uint32_t j = 0; isFaceInstanced && j < static_cast<uint32_t>(shadowData.lightsCount) * 6; j++)
+          {
+            if ((shadowCasters[k].casterMask & (1u << j)) != 0)
+            {
+              shadowCasterFaces.push_back({shadowCasters[k].modelMatrix, 1u << j, j, {}});
+            }
+          }
+          shadowCasters[casterCount++] = shadowCasters[k];
+        }
+        lodInstanceCounts[l] = (isFaceInstanced ? static_cast<uint32_t>(shadowCasterFaces.size()) : casterCount) - lodInstanceOffset;
+      }
+
+      const auto instanceCount = (isFaceInstanced ? static_cast<uint32_t>(shadowCasterFaces.size()) : casterCount) - instanceOffset;
+      if (instanceCount > 0)
+      {
+        casterGroups.push_back({modelGroups[g].model, instanceOffset, instanceCount, instanceCount, modelGroups[g].viewDepth, lodInstanceCounts, 0});
+      }
     }
-    textManager.addText("Total Polygons: " + std::to_string(totalPolygons), glm::vec2(1, 12.5f), 0.5f);
+    shadowCasters.resize(casterCount);
+
+    // Write the shadow caster details to the stream buffer, in a new allocation for each light type.
+    shadowCasterAllocation = writeStreamedInstances(shadowCasterBufferId, isFaceInstanced ? shadowCasterFaces : shadowCasters, "Shadow Casters");
+
+    // Return the shadow caster groups.
+    return casterGroups;
   }
 
   /**
-   * Render the scene with the light shadowmaps and the models.
+   * Draw the models of the given model group with an instanced draw call per level of detail they are drawn with.
+   * The vertex array object of the model object must already be bound.
+   * 
+   * @param modelGroup               The model group to draw.
+   * @param instanceBufferId         The ID of the buffer containing the model matrices of the group.
+   * @param instanceBufferOffset     The byte offset of the details of the first instance in the buffer (e.g. of an allocation of
+   *                                   the stream buffer).
+   * @param instanceStride           The byte offset between the model matrices of consecutive instances in the buffer.
+   * @param pointInstanceAttributes  The function pointing the other per-instance attributes at the given instance of the group
+   *                                   (counted from the first one), called before each draw.
    */
-  void render()
+  template <typename F>
+  void drawModelGroup(const ModelGroup &modelGroup, const GLuint &instanceBufferId, const size_t &instanceBufferOffset, const GLsizei &instanceStride, const F &pointInstanceAttributes) const
   {
-    // Get the time at the start of the frame.
-    const auto currentTime = glfwGetTime();
-    auto updateStartTime = currentTime, updateEndTime = currentTime;
-
-    // Check if the "L" has been pressed 500ms after the last time the disable feature mask was changed.
-    if (controlManager.isKeyPressed(GLFW_KEY_L) && (currentTime - lastDisableFeatureMaskChange) > 0.5f)
+    const auto &objectDetails = modelGroup.model->getObjectDetails();
+    uint32_t firstInstance = 0;
+    for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
     {
-      // "L" was pressed, meaning we need to start disabling render features.
-      // Check which features have already been disabled.
-      switch (disableFeatureMask)
+      const auto &instanceCount = modelGroup.lodInstanceCounts[l];
+      if (instanceCount == 0)
       {
-      case 0:
-        // No features were disabled. Start disabling shadows.
-        disableFeatureMask = DISABLE_SHADOW;
-        break;
-      case 1:
-        // Shadows were disabled. Start disabling lighting.
-        disableFeatureMask = DISABLE_LIGHT;
-        break;
+        continue;
+      }
+
+      // Point the attributes of the columns of the model matrices at the models of the level.
+      // This is the only attribute setup left per draw, since OpenGL 3.3 cannot offset the instances of a draw call.
+      for (GLuint i = 0; i < 4; i++)
+      {
+        VertexArray::enableAttribute(MODEL_MATRIX_ATTRIBUTE_ID + i,
+                                     instanceBufferId,
+                                     4,
+                                     GL_FLOAT,
+                                     1,
+                                     instanceStride,
+                                     instanceBufferOffset + ((modelGroup.instanceOffset + firstInstance) * instanceStride) + (i * sizeof(glm::vec4)));
+      }
+      pointInstanceAttributes(firstInstance);
+
+      // Draw the triangles of the level of detail for the models of the level.
+      const auto &lod = objectDetails->getLod(l);
+      GlCalls::drawElementsInstanced(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, reinterpret_cast<const void *>(static_cast<uintptr_t>(lod.indexOffset) * sizeof(uint32_t)), instanceCount);
+      firstInstance += instanceCount;
+    }
+  }
+
+  /**
+   * Draw the models of the given model group with an instanced draw call per level of detail they are drawn with, with no other
+   *   per-instance attributes than the model matrices.
+   * The vertex array object of the model object must already be bound.
+   * 
+   * @param modelGroup        The model group to draw.
+   * @param instanceBufferId  The ID of the buffer containing the model matrices of the group.
+   * @param instanceStride    The byte offset between the model matrices of consecutive instances in the buffer.
+   */
+  void drawModelGroup(const ModelGroup &modelGroup, const GLuint &instanceBufferId, const GLsizei &instanceStride) const
+  {
+    drawModelGroup(modelGroup, instanceBufferId, 0, instanceStride, [](const uint32_t &) {});
+  }
+
+  /**
+   * Draw the depth of the given model groups without shading them, so that the lit pass only shades the closest fragments.
+   * 
+   * The occlusion queries of the model groups drawn behind them are issued here, against the depth of the models drawn before them.
+   * 
+   * @param renderQueueItems  The sorted render queue items referring to the model groups to draw.
+   * @param packet            The render packet of the frame, with the models in the scene grouped by model type.
+   */
+  void renderDepthPrePass(const std::vector<RenderQueueItem> &renderQueueItems, const RenderPacket &packet)
+  {
+    const auto &modelGroups = packet.modelGroups;
+    GL_STATS_PASS(GlStatsPass::DEPTH_PRE_PASS);
+    // Use the depth pre-pass shader for all the models, and disable writing colors.
+    GlCalls::useProgram(depthShaderDetails->getShaderId());
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    GLuint currentObjectId = 0;
+
+    // Iterate through all the model groups in the sorted order, which also draws the closest ones first.
+    for (const auto &renderQueueItem : renderQueueItems)
+    {
+      const auto &modelGroup = modelGroups[renderQueueItem.itemIndex];
+
+      // Issue the occlusion query of the group if it is drawn behind one, using the depth pre-pass shader again afterwards.
+      if (modelGroupOcclusionQueried[renderQueueItem.itemIndex])
+      {
+        issueOcclusionQuery(packet, renderQueueItem.itemIndex, false, true);
+        GlCalls::useProgram(depthShaderDetails->getShaderId());
+        currentObjectId = 0;
+      }
+
+      // Check if the object of the model is the same as the object of the currently bound vertex array object.
+      if (currentObjectId != modelGroup.model->getObjectDetails()->getVertexBufferId())
+      {
+        // If not, bind the vertex array object of the current object.
+        currentObjectId = modelGroup.model->getObjectDetails()->getVertexBufferId();
+        GlCalls::bindVertexArray(modelGroup.model->getObjectDetails()->getVertexArrayId());
+      }
+
+      // Draw the depth of the models of the group inside the view frustum of the camera, unless its occlusion query found it hidden.
+      OcclusionQueries::beginConditionalRender(modelGroupOcclusionQueries[renderQueueItem.itemIndex]);
+      if (isGpuDrivenRenderingEnabled)
+      {
+        gpuModelCulling.drawModelGroup(renderQueueItem.itemIndex, MODEL_MATRIX_ATTRIBUTE_ID, 0, 0);
+      }
+      else
+      {
+        drawModelGroup(modelGroup, modelMatrixBufferId, sizeof(glm::mat4));
+      }
+      OcclusionQueries::endConditionalRender(modelGroupOcclusionQueries[renderQueueItem.itemIndex]);
+    }
+
+    // Unbind the vertex array object, and enable writing colors again.
+    GlCalls::bindVertexArray(0);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  }
+
+  /**
+   * Issue the occlusion query of the given model group drawn behind one, from the union of the world AABBs of its visible models,
+   *   against the depth drawn so far. The query is only issued once, by the first pass drawing the group.
+   * 
+   * @param packet           The render packet of the frame, with the models in the scene grouped by model type.
+   * @param modelGroupIndex  The index of the model group.
+   * @param isColorWritten   Whether colors are written by the pass drawing the group.
+   * @param isDepthWritten   Whether the depth is written by the pass drawing the group.
+   */
+  void issueOcclusionQuery(const RenderPacket &packet, const size_t &modelGroupIndex, const bool &isColorWritten, const bool &isDepthWritten)
+  {
+    modelGroupOcclusionQueried[modelGroupIndex] = false;
+    const auto &modelGroup = packet.modelGroups[modelGroupIndex];
+    auto minCorner = glm::vec3(std::numeric_limits<float_t>::max());
+    auto maxCorner = glm::vec3(std::numeric_limits<float_t>::lowest());
+    for (auto i = modelGroup.instanceOffset; i < modelGroup.instanceOffset + modelGroup.visibleInstanceCount; i++)
+    {
+      minCorner = glm::min(minCorner, packet.groupedMinCorners[i]);
+      maxCorner = glm::max(maxCorner, packet.groupedMaxCorners[i]);
+    }
+    modelGroupOcclusionQueries[modelGroupIndex] = occlusionQueries.issueQuery(modelGroup.model->getModelTypeId(), minCorner, maxCorner, packet.camera.position, packet.camera.matrices.viewProjectionMatrix, isColorWritten, isDepthWritten);
+  }
+
+  /**
+   * Create the details of the given light as stored in the frame details uniform buffer.
+   * 
+   * @param lightDetails    The details of the light.
+   * @param layersPerLight  The number of texture array layers taken up by a single light shadowmap.
+   * 
+   * @return The details of the light as stored in the frame details uniform buffer.
+   */
+  static FrameLightData createFrameLightData(const LightDetails &lightDetails, const GLuint &layersPerLight)
+  {
+    return {lightDetails.lightVpMatrix,
+            glm::vec4(lightDetails.lightPosition, 1.0f),
+            glm::vec4(lightDetails.lightColor * lightDetails.lightIntensity, 1.0f),
+            lightDetails.nearPlane,
+            lightDetails.farPlane,
+            static_cast<int32_t>(lightDetails.textureArrayLayerId / layersPerLight),
+            0,
+            lightDetails.shadowMapRect};
+  }
+
+  RenderManager()
+      : windowManager(WindowManager::getInstance()),
+        cameraManager(CameraManager::getInstance()),
+        lightManager(LightManager::getInstance()),
+        modelManager(ModelManager::getInstance()),
+        renderGroupManager(RenderGroupManager::getInstance()),
+        visibilityManager(VisibilityManager::getInstance()),
+        textManager(TextManager::getInstance()),
+        hudStatsManager(HudStatsManager::getInstance()),
+        lightRenderHudSection(hudStatsManager.registerSection("Light Render", glm::vec2(1, 21.5f), 2)),
+        modelRenderHudSection(hudStatsManager.registerSection("Model Render", glm::vec2(1, 23.0f), 3)),
+        cpuProfiler(CpuProfiler::getInstance()),
+        controlManager(ControlManager::getInstance()),
+        shadowBufferManager(ShadowBufferManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        uniformBufferManager(UniformBufferManager::getInstance()),
+        gpuTimerManager(GpuTimerManager::getInstance()),
+        dynamicResolutionManager(DynamicResolutionManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        scenePreloader(ScenePreloader::getInstance()),
+        transformManager(TransformManager::getInstance()),
+        attachmentManager(AttachmentManager::getInstance()),
+        jobManager(JobManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        streamBufferManager(StreamBufferManager::getInstance()),
+        gpuShotCollisionManager(GpuShotCollisionManager::getInstance()),
+        simulationClock(SimulationClock::getInstance()),
+        nameInterner(NameInterner::getInstance()),
+        modelTimerNameIds(),
+        activeCameraHandle(INVALID_REGISTRY_HANDLE),
+        viewCameras({}),
+        isMultiViewEnabled(false),
+        interpolationFactor(1.0f),
+        startTime(glfwGetTime()),
+        lastTime(glfwGetTime()),
+        disableFeatureMask(0),
+        isDepthPrePassEnabled(RenderConfigManager::getConfig().isDepthPrePassEnabled),
+        depthShaderDetails(shaderManager.createShaderProgram("DepthPrePass::Shader", "assets/shaders/vertex/depth.glsl", "assets/shaders/fragment/depth.glsl")),
+        isDeferredShadingEnabled(RenderConfigManager::getConfig().isDeferredShadingEnabled),
+        isImpostorRenderingEnabled(true),
+        isShadowMaskEnabled(RenderConfigManager::getConfig().isShadowMaskEnabled),
+        isClusteredLightingEnabled(RenderConfigManager::getConfig().isClusteredLightingEnabled),
+        isGpuDrivenRenderingEnabled(windowManager.isGpuDrivenRenderingPreferred()),
+        isOcclusionCullingEnabled(RenderConfigManager::getConfig().isOcclusionCullingEnabled),
+        isOcclusionQueryEnabled(true),
+        shadowFilterKernel(static_cast<ShadowFilterKernel>(RenderConfigManager::getConfig().shadowFilterKernel)),
+        shadowTechniques({{ShadowBufferType::CONE, static_cast<ShadowTechnique>(RenderConfigManager::getConfig().coneLightShadowTechnique)}, {ShadowBufferType::POINT, static_cast<ShadowTechnique>(RenderConfigManager::getConfig().pointLightShadowTechnique)}}),
+        isShadowUpdateAmortized(RenderConfigManager::getConfig().isShadowUpdateAmortized),
+        qualityPreset(RenderConfigManager::getConfig().qualityPreset),
+        shadedLights({}),
+        shadowedBuffers(),
+        shadowedLights(),
+        frameLights(),
+        droppedLightsCount(0),
+        diffuseTextureUniformId(shaderManager.getUniformId("diffuseTexture")),
+        coneLightShadowAtlasUniformId(shaderManager.getUniformId("coneLightShadowAtlas")),
+        pointLightTexturesUniformId(shaderManager.getUniformId("pointLightTextures")),
+        coneLightMomentAtlasUniformId(shaderManager.getUniformId("coneLightMomentAtlas")),
+        pointLightMomentTexturesUniformId(shaderManager.getUniformId("pointLightMomentTextures")),
+        clusterLightsTextureUniformId(shaderManager.getUniformId("clusterLightsTexture")),
+        clusterGridTextureUniformId(shaderManager.getUniformId("clusterGridTexture")),
+        clusterLightIndicesTextureUniformId(shaderManager.getUniformId("clusterLightIndicesTexture")),
+        modelMatrixBufferId(createInstanceBuffer()),
+        culledModels({}),
+        occludedModels({}),
+        lodModels({}),
+        impostorModels({}),
+        frameModels({}),
+        frameModelVisibilities({}),
+        frameModelOcclusions({}),
+        framePacket(),
+        modelLightMaskBufferId(createInstanceBuffer()),
+        modelLightMasks({}),
+        modelTextureLayerBufferId(createInstanceBuffer()),
+        modelTextureLayers({}),
+        viewModelMatrixBufferId(createInstanceBuffer()),
+        viewModelLightMaskBufferId(createInstanceBuffer()),
+        viewModelTextureLayerBufferId(createInstanceBuffer()),
+        viewModelLightMasks({}),
+        viewModelTextureLayers({}),
+        viewLodInstances({}),
+        frameData(),
+        shadowCasterBufferId(createInstanceBuffer()),
+        shadowCasterAllocation({}),
+        shadowCasters({}),
+        lodShadowCasters({}),
+        shadowCasterFaces({}),
+        shadowFaceStates({}),
+        renderQueue(),
+        modelGroupShaders({}),
+        modelGroupGBufferShaders({}),
+        modelGroupImpostors({}),
+        modelGroupOcclusionQueried({}),
+        modelGroupOcclusionQueries({}),
+        clusterLights({}),
+        lightClusterGrid(),
+        gpuModelCulling(),
+        occlusionCuller(),
+        shadowMomentMaps(),
+        deferredShading(),
+        shadowMask(),
+        modelPicker(),
+        layerCache(),
+        isLayerCacheEnabled(false),
+        impostorRenderer(),
+        occlusionQueries(),
+        pendingPickRequest({0, glm::vec2(0.0f), 0}),
+        lastPickRequestId(0) {}
+
+  ~RenderManager()
+  {
+    // Destroy the shader program for the depth pre-pass.
+    shaderManager.destroyShaderProgram(depthShaderDetails);
+    // Delete the model matrix and shadow caster buffers.
+    glDeleteBuffers(1, &modelMatrixBufferId);
+    glDeleteBuffers(1, &modelLightMaskBufferId);
+    glDeleteBuffers(1, &modelTextureLayerBufferId);
+    glDeleteBuffers(1, &viewModelMatrixBufferId);
+    glDeleteBuffers(1, &viewModelLightMaskBufferId);
+    glDeleteBuffers(1, &viewModelTextureLayerBufferId);
+    glDeleteBuffers(1, &shadowCasterBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, modelMatrixBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, modelLightMaskBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, modelTextureLayerBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, viewModelMatrixBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, viewModelLightMaskBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, viewModelTextureLayerBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, shadowCasterBufferId);
+  }
+
+public:
+  // Preventing copying the render manager, making sure only one instance can exist.
+  RenderManager(const RenderManager &) = delete;
+
+  /**
+   * Registers a camera to be used as the active camera.
+   * 
+   * @param cameraHandle  The handle of the camera to set as the active camera.
+   */
+  void registerActiveCamera(const RegistryHandle &cameraHandle)
+  {
+    activeCameraHandle = cameraHandle;
+  }
+
+  /**
+   * Registers a camera to be drawn as an additional view of the scene over the view of the active camera (e.g. a rear camera
+   *   shown picture-in-picture, or the other half of a split screen). The views share the shadowmaps rendered for the frame, and
+   *   are shaded by the lights picked for the view of the active camera.
+   * 
+   * @param cameraHandle  The handle of the camera of the view.
+   * @param viewportRect  The part of the render target the view is drawn into, as its bottom-left corner followed by its width
+   *                        and height (as shares of the size of the render target).
+   */
+  void registerViewCamera(const RegistryHandle &cameraHandle, const glm::vec4 &viewportRect)
+  {
+    deregisterViewCamera(cameraHandle);
+    viewCameras.push_back({cameraHandle, viewportRect});
+  }
+
+  /**
+   * Set whether the models of the lowest render layers are drawn from the layer cache, only drawn again when they change (and at
+   *   a reduced rate while they keep changing), which suits the scenes with a mostly static background like the menus. The
+   *   cached models should not be lit by moving lights, since the lights are not part of what the cache is checked against.
+   * 
+   * @param isEnabled  Whether the layer cache is enabled.
+   */
+  void setLayerCacheEnabled(const bool &isEnabled)
+  {
+    isLayerCacheEnabled = isEnabled;
+  }
+
+  /**
+   * Request to pick the model under a point of the screen in the view of the active camera, drawn on the GPU with the next frame
+   *   and read back a frame (or a few) later. A request made before the next frame replaces the last one.
+   * 
+   * @param screenPosition  The point of the screen, normalized with the top-left corner at (0, 0) like the cursor position.
+   * @param collisionMask   The collision layers of the models that can be picked, the other models being drawn through.
+   * 
+   * @return The ID of the request, found in its result once read back.
+   */
+  uint64_t requestPick(const glm::vec2 &screenPosition, const uint32_t &collisionMask)
+  {
+    pendingPickRequest = {++lastPickRequestId, screenPosition, collisionMask};
+    return lastPickRequestId;
+  }
+
+  /**
+   * Get the result of the latest pick request read back from the GPU.
+   * 
+   * @return The result, whose request ID is 0 if no request was read back yet.
+   */
+  PickResult getPickResult()
+  {
+    return modelPicker.getLatestResult();
+  }
+
+  /**
+   * De-registers a camera drawn as an additional view of the scene.
+   * 
+   * @param cameraHandle  The handle of the camera of the view (ignored if it is not drawn as a view).
+   */
+  void deregisterViewCamera(const RegistryHandle &cameraHandle)
+  {
+    viewCameras.erase(std::remove_if(viewCameras.begin(), viewCameras.end(), [&cameraHandle](const RenderViewCamera &viewCamera) {
+                        return viewCamera.cameraHandle == cameraHandle;
+                      }),
+                      viewCameras.end());
+  }
+
+  /**
+   * Set how far the rendered model transforms are interpolated between the last two simulation steps.
+   * 
+   * @param newInterpolationFactor  The interpolation factor, from 0 (the state before the last step) to 1 (the current state).
+   */
+  void setInterpolationFactor(const float_t &newInterpolationFactor)
+  {
+    interpolationFactor = newInterpolationFactor;
+  }
+
+  /**
+   * Set the quality preset, which decides how many of the lights are shaded and how many of them cast shadows.
+   * 
+   * @param newQualityPreset  The index of the quality preset, from 0 (Low) to QUALITY_PRESETS_COUNT - 1 (Ultra).
+   */
+  void setQualityPreset(const int32_t &newQualityPreset)
+  {
+    qualityPreset = glm::clamp(newQualityPreset, 0, QUALITY_PRESETS_COUNT - 1);
+  }
+
+  /**
+   * Rank the lights by their contribution to the view, and pick the lights shaded in the frame by the quality preset.
+   * The most important lights of each type casting shadows get the shadowmap slots, and the other point lights are shaded without
+   *   shadows (through the light clusters) up to the limit of the preset. Cone lights can only be shaded with shadows, so the rest
+   *   are dropped.
+   * 
+   * @param packet  The render packet of the frame, with the lights already ranked.
+   */
+  void selectLights(const RenderPacket &packet)
+  {
+    // Pick the lights in the order of their importance while their type has room left in the preset.
+    //   The limits and counts are indexed by the shadow buffer types.
+    const std::array<int32_t, 2> shadowedLimits = {std::min(SHADOWED_CONE_LIGHTS[qualityPreset], MAX_CONE_LIGHTS), std::min(SHADOWED_POINT_LIGHTS[qualityPreset], MAX_POINT_LIGHTS)};
+    const std::array<int32_t, 2> shadedLimits = {shadowedLimits[ShadowBufferType::CONE], SHADED_POINT_LIGHTS[qualityPreset]};
+    std::array<int32_t, 2> shadedCounts = {0, 0};
+    std::array<int32_t, 2> shadowedCounts = {0, 0};
+    for (auto &buffers : shadowedBuffers)
+    {
+      buffers.clear();
+    }
+    shadedLights.clear();
+    for (const auto &lightState : packet.lights)
+    {
+      const auto lightType = lightState.light->getLightType();
+      const auto isShadowCaster = lightState.light->isShadowCaster();
+      if (shadedCounts[lightType] >= shadedLimits[lightType] || (!isShadowCaster && lightType != ShadowBufferType::POINT))
+      {
+        continue;
+      }
+      if (isShadowCaster && shadowedCounts[lightType] < shadowedLimits[lightType])
+      {
+        shadowedBuffers[lightType].push_back(lightState.light->getShadowBufferDetails());
+        shadowedCounts[lightType]++;
+      }
+      shadedCounts[lightType]++;
+      shadedLights.push_back(&lightState);
+    }
+    droppedLightsCount = packet.registeredLightsCount - packet.mergedLightsCount - shadedLights.size();
+
+    // Move the shadowmap slots to the shadowed lights.
+    shadowBufferManager.updateShadowSlots(ShadowBufferType::CONE, shadowedBuffers[ShadowBufferType::CONE]);
+    shadowBufferManager.updateShadowSlots(ShadowBufferType::POINT, shadowedBuffers[ShadowBufferType::POINT]);
+  }
+
+  /**
+   * Render the shadow maps for all the lights in the scene, and return the lights with a shadowmap by their shadow map type.
+   * 
+   * @param packet  The render packet of the frame.
+   * 
+   * @return The lights of the frame with a shadowmap, valid until the next call.
+   */
+  const FrameLights &renderLights(const RenderPacket &packet)
+  {
+    PROFILE_ZONE("Light Render");
+    GL_STATS_PASS(GlStatsPass::SHADOWS);
+
+    // Empty the lights of the last frame.
+    frameLights.coneLightsCount = 0;
+    frameLights.pointLightsCount = 0;
+
+    // Set the current active shader ID to 0.
+    GLuint currentShaderId = 0;
+
+    // If shadows are disabled, forget what the shadowmaps were rendered with, so that they are all rendered again once enabled.
+    if (disableFeatureMask >= DISABLE_SHADOW)
+    {
+      shadowFaceStates.clear();
+    }
+
+    // Cache the shadows of the static casters while any are registered, and forget what the shadowmaps were rendered with when
+    //   the cache is switched, so that the static copies are filled before any face is copied from them.
+    if (packet.hasStaticCasters != shadowBufferManager.isStaticShadowCacheEnabled())
+    {
+      shadowBufferManager.setStaticShadowCacheEnabled(packet.hasStaticCasters);
+      shadowFaceStates.clear();
+    }
+
+    // Skip the shadow pass entirely if the scene has no lights reaching the view (like the menu scenes), since there are no shadowmaps to render.
+    if (shadedLights.empty())
+    {
+      textManager.beginText(glm::vec2(1, 21.5f), 0.5f) << "Shadow Pass: Skipped (No Lights) | Dropped Lights: " << droppedLightsCount;
+      return frameLights;
+    }
+
+    auto shadowCastersCount = 0l, culledShadowCastersCount = 0l;
+    auto renderedShadowMapsCount = 0l, cachedShadowMapsCount = 0l, renderedShadowFacesCount = 0l, unviewedShadowFacesCount = 0l, staticShadowFacesCount = 0l, copiedShadowFacesCount = 0l;
+
+    for (auto &lights : shadowedLights)
+    {
+      lights.clear();
+    }
+    for (const auto &light : shadedLights)
+    {
+      // Skip the lights that did not get a shadowmap, since the shader light arrays only fit one light per shadowmap.
+      // Point lights without one (or casting no shadows) are still lit through the light clusters.
+      if (!light->light->isShadowCaster() || !light->light->getShadowBufferDetails()->hasShadowMap())
+      {
+        continue;
+      }
+      shadowedLights[light->light->getShadowBufferDetails()->getShadowBufferType()].push_back(light);
+    }
+
+    // Assign the tiles of the shadow atlas to the cone lights by how much of the view they light, estimated by the view angle
+    //   their range covers from the camera.
+    const auto &cameraPosition = packet.camera.position;
+    std::vector<std::pair<std::shared_ptr<const ShadowBufferDetails>, float_t>> shadowBufferImportances;
+    for (const auto &light : shadowedLights[ShadowBufferType::CONE])
+    {
+      const auto cameraDistance = glm::distance(cameraPosition, light->lightPosition);
+      shadowBufferImportances.push_back({light->light->getShadowBufferDetails(), glm::clamp(light->farPlane / std::max(cameraDistance, 0.001f), 0.0f, 1.0f)});
+    }
+    shadowBufferManager.updateShadowAtlas(shadowBufferImportances);
+
+    for (const auto shadowBufferType : {ShadowBufferType::CONE, ShadowBufferType::POINT})
+    {
+      const auto &lights = shadowedLights[shadowBufferType];
+      if (lights.empty())
+      {
+        continue;
+      }
+
+      // Render the shadows of the lights of the type in the zone of the name of the first of them, counting each light.
+      const auto firstLight = lights.front();
+      PROFILE_ITEMS_ZONE(firstLight->lightName, lights.size());
+      gpuTimerManager.beginTimer("Light Render::" + firstLight->lightName);
+
+      // Define the shadow details of the lights, to be written to the uniform buffer.
+      ShadowData shadowData = {};
+
+      // Iterate through all the lights in the scene.
+      for (unsigned long i = 0; i < lights.size(); i++)
+      {
+        const auto &light = lights.at(i);
+
+        // Get the type of the shadow, and the size of the shadowmap (the tile of the shadow atlas for cone lights).
+        const auto &shadowBufferDetails = light->light->getShadowBufferDetails();
+        const auto shadowType = shadowBufferDetails->getShadowBufferType();
+        const auto mapSize = shadowType == ShadowBufferType::POINT ? ShadowBufferManager::getShadowMapSize(shadowType) : shadowBufferDetails->getShadowMapTile().size;
+        // Generate a structure detailing information about the light.
+        const LightDetails lightDetails = {
+            light->lightPosition,
+            light->vpMatrices[0],
+            light->lightColor,
+            light->lightIntensity,
+            mapSize,
+            mapSize,
+            light->nearPlane,
+            light->farPlane,
+            shadowBufferDetails->getShadowBufferTextureArrayLayerId(),
+            shadowBufferDetails->getShadowMapRect(),
+            light->visibilityView,
+            light->facesCount};
+        // Store the light details in the lights of the frame with a shadowmap.
+        if (shadowType == ShadowBufferType::POINT)
+        {
+          frameLights.pointLights[frameLights.pointLightsCount++] = lightDetails;
+        }
+        else
+        {
+          frameLights.coneLights[frameLights.coneLightsCount++] = lightDetails;
+        }
+
+        // If shadows are disabled, skip the shadowmap render step.
+        if (disableFeatureMask >= DISABLE_SHADOW)
+        {
+          continue;
+        }
+
+        // Store the shadow details of the light.
+        auto &lightData = shadowData.lights[i];
+        lightData.lightPosition = glm::vec4(lightDetails.lightPosition, 1.0f);
+        lightData.layerId = lightDetails.textureArrayLayerId;
+        // Lights evicted from the shadow atlas get no faces, so that nothing is drawn for them.
+        lightData.vpMatrixCount = mapSize > 0 ? light->facesCount : 0;
+        lightData.shadowMapRect = lightDetails.shadowMapRect;
+        lightData.nearPlane = lightDetails.nearPlane;
+        lightData.farPlane = lightDetails.farPlane;
+        // Store the projection-view matrices of the faces of the light.
+        for (uint32_t j = 0; j < light->facesCount; j++)
+        {
+          lightData.vpMatrices[j] = light->vpMatrices[j];
+        }
+      }
+
+      // If shadows are disabled, there is nothing to draw into the shadowmaps.
+      if (disableFeatureMask < DISABLE_SHADOW)
+      {
+        // Set the lights count, and write the shadow details of the lights to the uniform buffer.
+        shadowData.lightsCount = lights.size();
+        shadowData.animationTime = packet.animationTime;
+        uniformBufferManager.updateShadowData(shadowBufferType, shadowData);
+
+        // Find the models casting shadows into the outdated shadowmap faces of the lights (including the ones culled from the view).
+        uint32_t dirtyFacesMask = 0, staticDirtyFacesMask = 0, staticCopyFacesMask = 0, unviewedFacesMask = 0;
+        const auto casterGroups = createShadowCasterGroups(packet, lights, shadowData, dirtyFacesMask, staticDirtyFacesMask, staticCopyFacesMask, unviewedFacesMask);
+        unviewedShadowFacesCount += std::bitset<32>(unviewedFacesMask).count();
+        staticShadowFacesCount += std::bitset<32>(staticDirtyFacesMask).count();
+        copiedShadowFacesCount += std::bitset<32>(staticCopyFacesMask).count();
+        const auto isFaceInstanced = isShadowFaceInstanced(lights);
+        shadowCastersCount += shadowCasters.size();
+        culledShadowCastersCount += packet.groupedModels.size() - shadowCasters.size();
+
+        // Draw the shadow caster groups of the static casters (or of the other casters) into the shadowmaps (or into their cached
+        //   static copies).
+        const auto drawCasterGroups = [this, &casterGroups, &isFaceInstanced, &firstLight, &shadowBufferType, &currentShaderId](const bool &isStaticPass) {
+          // Bind the shadowmap framebuffer of the light as the active framebuffer, and switch the viewport to the resolution of its shadowmaps.
+          const auto &shadowBufferDetails = firstLight->light->getShadowBufferDetails();
+          GlCalls::bindFramebuffer(GL_FRAMEBUFFER, isStaticPass ? shadowBufferManager.getStaticShadowBufferId(shadowBufferType) : shadowBufferDetails->getShadowBufferId());
+          // The cone lights are clipped to their tiles of the shadow atlas by the geometry shader.
+          const auto shadowMapSize = ShadowBufferManager::getShadowMapSize(shadowBufferType);
+          GlCalls::viewport(0, 0, shadowMapSize, shadowMapSize);
+          for (GLenum i = 0; i < 4 && shadowBufferType != ShadowBufferType::POINT; i++)
+          {
+            glEnable(GL_CLIP_DISTANCE0 + i);
+          }
+
+          // Check if the shader of the light is the same as the currently used shader.
+          const auto &lightShaderDetails = firstLight->light->getShaderDetails();
+          if (!casterGroups.empty() && lightShaderDetails->getPipelineId() != 0)
+          {
+            // The program pipeline of the light only takes effect with no shader program in use, which the next shader program
+            //   used overrides again.
+            currentShaderId = 0;
+            GlCalls::useProgram(0);
+            GlCalls::bindProgramPipeline(lightShaderDetails->getPipelineId());
+          }
+          else if (!casterGroups.empty() && currentShaderId != lightShaderDetails->getShaderId())
+          {
+            // If not, set it as the currently used shader and use it.
+            currentShaderId = lightShaderDetails->getShaderId();
+            GlCalls::useProgram(currentShaderId);
+          }
+
+          // Iterate through the shadow caster groups of the pass.
+          for (const auto &casterGroup : casterGroups)
+          {
+            if (isStaticShadowCaster(casterGroup.model) != isStaticPass)
+            {
+              continue;
+            }
+
+            // Bind the vertex array object of the model.
+            GlCalls::bindVertexArray(casterGroup.model->getObjectDetails()->getVertexArrayId());
+
+            // Draw the triangles of all the casters of the group, pointing the caster mask attribute at the casters of each level
+            //   of detail.
+            drawModelGroup(casterGroup, shadowCasterAllocation.bufferId, shadowCasterAllocation.offset, sizeof(ShadowCasterData), [this, &casterGroup, &isFaceInstanced](const uint32_t &firstInstance) {
+              const auto casterOffset = shadowCasterAllocation.offset + ((casterGroup.instanceOffset + firstInstance) * sizeof(ShadowCasterData));
+              VertexArray::enableAttribute(CASTER_MASK_ATTRIBUTE_ID,
+                                           shadowCasterAllocation.bufferId,
+                                           1,
+                                           GL_UNSIGNED_INT,
+                                           1,
+                                           sizeof(ShadowCasterData),
+                                           casterOffset + offsetof(ShadowCasterData, casterMask));
+              if (isFaceInstanced)
+              {
+                // Point the shadowmap face attribute at the faces of the casters as well.
+                VertexArray::enableAttribute(CASTER_FACE_ATTRIBUTE_ID,
+                                             shadowCasterAllocation.bufferId,
+                                             1,
+                                             GL_UNSIGNED_INT,
+                                             1,
+                                             sizeof(ShadowCasterData),
+                                             casterOffset + offsetof(ShadowCasterData, casterFace));
+              }
+            });
+
+            // Disable the caster mask and face attributes again, since the model shaders do not provide them.
+            VertexArray::disableAttribute(CASTER_MASK_ATTRIBUTE_ID);
+            if (isFaceInstanced)
+            {
+              VertexArray::disableAttribute(CASTER_FACE_ATTRIBUTE_ID);
+            }
+          }
+          // Unbind the vertex array object now that we're done.
+          GlCalls::bindVertexArray(0);
+          for (GLenum i = 0; i < 4; i++)
+          {
+            glDisable(GL_CLIP_DISTANCE0 + i);
+          }
+        };
+
+        // Render the outdated cached static faces first, since the faces rendered this frame are copied from them.
+        if (staticDirtyFacesMask != 0)
+        {
+          for (unsigned long i = 0; i < lights.size(); i++)
+          {
+            const auto lightStaticDirtyFacesMask = (staticDirtyFacesMask >> (i * 6)) & 0x3Fu;
+            if (lightStaticDirtyFacesMask != 0)
+            {
+              shadowBufferManager.clearShadowBuffer(lights.at(i)->light->getShadowBufferDetails(), lightStaticDirtyFacesMask, true);
+            }
+          }
+          drawCasterGroups(true);
+        }
+
+        // Clear the faces rendered this frame (or copy the shadows of the static casters into them), leaving the other faces with
+        //   the depth they were last rendered with.
+        for (unsigned long i = 0; i < lights.size(); i++)
+        {
+          const auto lightDirtyFacesMask = (dirtyFacesMask >> (i * 6)) & 0x3Fu;
+          if (lightDirtyFacesMask == 0)
+          {
+            cachedShadowMapsCount++;
+            continue;
+          }
+          renderedShadowMapsCount++;
+          renderedShadowFacesCount += std::bitset<6>(lightDirtyFacesMask).count();
+          const auto lightStaticCopyFacesMask = (staticCopyFacesMask >> (i * 6)) & 0x3Fu;
+          if ((lightDirtyFacesMask & ~lightStaticCopyFacesMask) != 0)
+          {
+            shadowBufferManager.clearShadowBuffer(lights.at(i)->light->getShadowBufferDetails(), lightDirtyFacesMask & ~lightStaticCopyFacesMask);
+          }
+          if (lightStaticCopyFacesMask != 0)
+          {
+            shadowBufferManager.copyStaticShadowBuffer(lights.at(i)->light->getShadowBufferDetails(), lightStaticCopyFacesMask);
+          }
+        }
+
+        // Draw the other casters into the faces, on top of the shadows of the static casters.
+        drawCasterGroups(false);
+
+        // Write the moments of the faces rendered this frame if the lights of the type are shadowed with variance shadow maps,
+        //   and filter them across their mip levels once all of them are written.
+        if (shadowTechniques.at(shadowBufferType) == ShadowTechnique::TECHNIQUE_VSM && dirtyFacesMask != 0)
+        {
+          for (unsigned long i = 0; i < lights.size(); i++)
+          {
+            const auto lightDirtyFacesMask = (dirtyFacesMask >> (i * 6)) & 0x3Fu;
+            if (lightDirtyFacesMask != 0)
+            {
+              const auto &light = lights.at(i);
+              shadowMomentMaps.updateMoments(light->light->getShadowBufferDetails(), lightDirtyFacesMask, light->nearPlane, light->farPlane);
+            }
+          }
+          shadowMomentMaps.generateMipmaps(shadowBufferType);
+          // The moments are written with a shader of their own.
+          currentShaderId = 0;
+        }
+      }
+
+      // Bind the window framebuffer as the active framebuffer.
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, windowManager.getWindowFramebufferId());
+
+      gpuTimerManager.endTimer("Light Render::" + firstLight->lightName);
+    }
+
+    // Write the light renders of the last frame into the HUD stats, from the zone of each light name, and the other shadow stats
+    //   below their section.
+    cpuProfiler.forEachChildZone(CpuProfiler::getCurrentZoneId(), [this](const std::string &lightName, const ProfilerZoneStats &lightStats) {
+      const auto avgGpuRenderTime = gpuTimerManager.getTimeMs("Light Render::" + lightName) / lightStats.itemsCount;
+      hudStatsManager.beginLine(lightRenderHudSection, lightName).setCount("Instances", lightStats.itemsCount).addSample("Render (avg)", lightStats.getAverageTimeMs(), "ms").addSample("GPU (avg)", avgGpuRenderTime, "ms");
+    });
+    const auto height = hudStatsManager.getSectionEndPosition(lightRenderHudSection).y;
+    const auto shadowedLightsCount = frameLights.coneLightsCount + frameLights.pointLightsCount;
+    textManager.beginText(glm::vec2(1, height - 1.0f), 0.5f) << "Lights Shadowed: " << shadowedLightsCount << " | Unshadowed: " << shadedLights.size() - shadowedLightsCount << " | Merged: " << packet.mergedLightsCount << " | Dropped: " << droppedLightsCount;
+    textManager.beginText(glm::vec2(1, height), 0.5f) << "Shadow Caster Instances: " << shadowCastersCount << " | Culled: " << culledShadowCastersCount << " | Point Light Faces: " << (windowManager.isVertexShaderLayerSupported() ? "Instanced" : "Geometry Shader");
+    {
+      auto text = textManager.beginText(glm::vec2(1, height - 0.5f), 0.5f);
+      text << "Shadow Maps Rendered: " << renderedShadowMapsCount << " | Cached: " << cachedShadowMapsCount << " | Faces: " << renderedShadowFacesCount << " | Out of View: " << unviewedShadowFacesCount;
+      if (shadowBufferManager.isStaticShadowCacheEnabled())
+      {
+        text << " | Static Faces: " << staticShadowFacesCount << " | Copied: " << copiedShadowFacesCount;
+      }
+      if (isShadowUpdateAmortized)
+      {
+        text << " (Amortized " << POINT_LIGHT_SHADOW_FACES_PER_FRAME << "/Frame, F)";
+      }
+      else
+      {
+        text << " (F)";
+      }
+      // Write the sizes of the shadow atlas tiles the cone lights were given.
+      text << " | Atlas Tiles: ";
+      if (shadowBufferImportances.empty())
+      {
+        text << "None";
+      }
+      for (const auto &shadowBufferImportance : shadowBufferImportances)
+      {
+        text << (&shadowBufferImportance == &shadowBufferImportances.front() ? "" : ", ") << shadowBufferImportance.first->getShadowMapTile().size << "px";
+      }
+    }
+
+    // Return the lights with a shadowmap.
+    return frameLights;
+  }
+
+  /**
+   * Find the lights of the frame reaching each visible model of the given model groups as a mask, so that the model shaders only
+   *   loop over the lights that can light the model.
+   * A light reaches a model if the model is within its far plane, and for cone lights with a shadowmap, also inside its frustum
+   *   (since the fragments outside it are in shadow anyway), as found by the visibility of the frame for the view of the light.
+   * 
+   * @param frameLights       The lights of the frame with a shadowmap, in the same order as the frame details.
+   * @param visibility        The visibility of the models to the views of the frame.
+   * @param modelGroups       The model groups to find the lights of.
+   * @param transformHandles  The transforms of the grouped models.
+   * @param minCorners        The corners of the world AABBs of the grouped models with the smallest coordinates.
+   * @param maxCorners        The corners of the world AABBs of the grouped models with the largest coordinates.
+   * @param isCulledAssigned  Whether the lights of the culled models of the groups are found as well.
+   * @param lightMasks        Set to the light masks of the grouped models.
+   */
+  static void createModelLightMasks(const FrameLights &frameLights, const FrameVisibility &visibility, const std::vector<ModelGroup> &modelGroups,
+                                    const std::vector<TransformHandle> &transformHandles, const std::vector<glm::vec3> &minCorners, const std::vector<glm::vec3> &maxCorners, const bool &isCulledAssigned,
+                                    std::vector<uint32_t> &lightMasks)
+  {
+    const auto &coneLights = frameLights.coneLights;
+    const auto &pointLights = frameLights.pointLights;
+
+    // Only the visible models are drawn, so the masks of the culled models are left at 0 (unless the models are culled on the GPU).
+    lightMasks.assign(minCorners.size(), 0);
+    for (const auto &modelGroup : modelGroups)
+    {
+      const auto assignedInstanceCount = isCulledAssigned ? modelGroup.instanceCount : modelGroup.visibleInstanceCount;
+      for (uint32_t k = modelGroup.instanceOffset; k < modelGroup.instanceOffset + assignedInstanceCount; k++)
+      {
+        const auto &minCorner = minCorners[k];
+        const auto &maxCorner = maxCorners[k];
+
+        for (uint32_t i = 0; i < frameLights.coneLightsCount; i++)
+        {
+          // The cone lights left without a tile of the shadow atlas light the whole of their range.
+          if (coneLights[i].shadowMapRect.z > 0.0f ? visibility.isVisible(coneLights[i].visibilityView, transformHandles[k])
+                                                   : isBoxInSphere(minCorner, maxCorner, coneLights[i].lightPosition, coneLights[i].farPlane))
+          {
+            lightMasks[k] |= 1u << i;
+          }
+        }
+        for (uint32_t i = 0; i < frameLights.pointLightsCount; i++)
+        {
+          if (isBoxInSphere(minCorner, maxCorner, pointLights[i].lightPosition, pointLights[i].farPlane))
+          {
+            lightMasks[k] |= 1u << (8 + i);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Find the lights reaching each visible model of the frame, and write their masks to the model light mask buffer.
+   * 
+   * @param frameLights  The lights of the frame with a shadowmap, in the same order as the frame details.
+   * @param packet       The render packet of the frame.
+   */
+  void assignModelLights(const FrameLights &frameLights, const RenderPacket &packet)
+  {
+    createModelLightMasks(frameLights, packet.visibility, packet.modelGroups, packet.groupedTransformHandles, packet.groupedMinCorners, packet.groupedMaxCorners, isGpuDrivenRenderingEnabled, modelLightMasks);
+    writeInstanceBuffer(modelLightMaskBufferId, modelLightMasks, "Light Masks");
+  }
+
+  /**
+   * Create the defines code of the model shader variants for the features and light counts of the frame, as set in the frame
+   *   details.
+   * 
+   * @param isLightReceiver  Whether the models receive light (the lighting and shadows are compiled out otherwise).
+   * @param isClustered      Whether the point lights are read from the light clusters.
+   * 
+   * @return The defines code.
+   */
+  std::string createModelDefinesCode(const bool &isLightReceiver, const bool &isClustered) const
+  {
+    return ShaderManager::createShaderDefinesCode({
+        {"IS_SHADOW_ENABLED", isLightReceiver && disableFeatureMask < DISABLE_SHADOW ? "true" : "false"},
+        {"IS_LIGHTING_ENABLED", isLightReceiver && disableFeatureMask < DISABLE_LIGHT ? "true" : "false"},
+        {"IS_CLUSTERED_LIGHTING_ENABLED", isLightReceiver && isClustered ? "true" : "false"},
+        {"CONE_LIGHTS_COUNT", std::to_string(isLightReceiver ? frameData.coneLightsCount : 0)},
+        {"POINT_LIGHTS_COUNT", std::to_string(isLightReceiver ? frameData.pointLightsCount : 0)},
+        {"SHADOW_FILTER_KERNEL", std::to_string(shadowFilterKernel)},
+        {"CONE_LIGHT_SHADOW_TECHNIQUE", std::to_string(shadowTechniques.at(ShadowBufferType::CONE))},
+        {"POINT_LIGHT_SHADOW_TECHNIQUE", std::to_string(shadowTechniques.at(ShadowBufferType::POINT))},
+    });
+  }
+
+  /**
+   * Set the texture units of the diffuse texture, the shadowmaps and the light cluster buffer textures of the given model shader,
+   *   as bound for the models.
+   * 
+   * @param shaderDetails  The details of the shader program in use.
+   */
+  void setModelTextureUnits(const ShaderDetails &shaderDetails) const
+  {
+    // Set the texture units of the diffuse texture and the cone light shadow atlas and the point light shadow map texture array.
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(diffuseTextureUniformId), 0);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(coneLightShadowAtlasUniformId), 1);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(pointLightTexturesUniformId), 2);
+    // Set the texture units of the light cluster buffer textures.
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(clusterLightsTextureUniformId), 3);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(clusterGridTextureUniformId), 4);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(clusterLightIndicesTextureUniformId), 5);
+    // Set the texture units of the moments of the variance shadow maps.
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(coneLightMomentAtlasUniformId), 6);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(pointLightMomentTexturesUniformId), 7);
+    // Set the texture units of the shadow mask, in the units after the G-buffer textures.
+    shadowMask.setMaskUniforms(shaderDetails, 11);
+  }
+
+  /**
+   * Render the shadow maps for all the models in the scene.
+   * 
+   * @param frameLights  The lights of the frame with a shadowmap.
+   * @param packet       The render packet of the frame.
+   */
+  void renderModels(const FrameLights &frameLights, const RenderPacket &packet)
+  {
+    PROFILE_ZONE("Model Render");
+    GL_STATS_PASS(GlStatsPass::MODELS);
+
+    const auto &modelGroups = packet.modelGroups;
+    // Switch to the render target of the scene, with the viewport scaled to its resolution.
+    dynamicResolutionManager.bindSceneTarget();
+    // Set the clear screen color to pure white.
+    windowManager.setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // Clear the color buffer and depth buffer of the screen.
+    windowManager.clearScreen(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Set the current active shader, texture and object IDs to 0.
+    GLuint currentShaderId = 0;
+    GLuint currentTextureId = 0;
+    GLuint currentObjectId = 0;
+    // Get the view matrix of the active camera.
+    const auto &viewMatrix = packet.camera.matrices.viewMatrix;
+    // Get the projection matrix of the active camera.
+    const auto &projectionMatrix = packet.camera.matrices.projectionMatrix;
+
+    // Define the frame details, to be written to the uniform buffer once for all the models.
+    frameData = {};
+    frameData.viewMatrix = viewMatrix;
+    frameData.projectionMatrix = projectionMatrix;
+    frameData.viewProjectionMatrix = packet.camera.matrices.viewProjectionMatrix;
+    frameData.ambientFactor = ambientFactor;
+    frameData.disableFeatureMask = disableFeatureMask;
+    frameData.coneLightsCount = frameLights.coneLightsCount;
+    frameData.pointLightsCount = frameLights.pointLightsCount;
+    frameData.clusterDetails = glm::ivec4(LightClusterGrid::CLUSTER_COUNT_X, LightClusterGrid::CLUSTER_COUNT_Y, LightClusterGrid::CLUSTER_COUNT_Z, isClusteredLightingEnabled);
+    frameData.animationDetails = glm::vec4(packet.animationTime, 0.0f, 0.0f, 0.0f);
+    // Iterate through the cone lights in the scene, using the same layer ID as the cone light texture array layer.
+    for (uint32_t i = 0; i < frameLights.coneLightsCount; i++)
+    {
+      frameData.coneLights[i] = createFrameLightData(frameLights.coneLights[i], 1);
+    }
+    // Iterate through the point lights in the scene, converting the layer ID from the layer-face to the cube map index.
+    for (uint32_t i = 0; i < frameLights.pointLightsCount; i++)
+    {
+      frameData.pointLights[i] = createFrameLightData(frameLights.pointLights[i], 6);
+    }
+    // Check if the point lights should be binned into the light clusters.
+    if (isClusteredLightingEnabled)
+    {
+      // Gather the point lights shaded in the frame, including the ones without a shadowmap.
+      clusterLights.clear();
+      for (const auto &light : shadedLights)
+      {
+        if (light->light->getLightType() != ShadowBufferType::POINT)
+        {
+          continue;
+        }
+        const auto &shadowBufferDetails = light->light->getShadowBufferDetails();
+        const auto hasShadowMap = shadowBufferDetails != nullptr && shadowBufferDetails->hasShadowMap();
+        clusterLights.push_back({light->lightPosition,
+                                 light->lightColor * light->lightIntensity,
+                                 light->farPlane,
+                                 hasShadowMap ? static_cast<int32_t>(shadowBufferDetails->getShadowBufferTextureArrayLayerId() / 6) : -1});
+      }
+
+      // Bin the point lights into the light clusters of the view of the camera.
+      lightClusterGrid.update(clusterLights, viewMatrix, projectionMatrix);
+      frameData.clusterDepthDetails = lightClusterGrid.getClusterDepthDetails();
+      // The clusters are found from the window coordinates of the fragments, so their tile sizes follow the scene resolution.
+      frameData.clusterDepthDetails.z *= dynamicResolutionManager.getSceneScale();
+      frameData.clusterDepthDetails.w *= dynamicResolutionManager.getSceneScale();
+    }
+    // Write the frame details to the uniform buffer.
+    uniformBufferManager.updateFrameData(frameData);
+    // Find the lights reaching each visible model.
+    assignModelLights(frameLights, packet);
+    // Cull the models on the GPU for the GPU-driven path, once all their per-instance details are written.
+    if (isGpuDrivenRenderingEnabled)
+    {
+      gpuModelCulling.cull(packet, modelMatrixBufferId, modelLightMaskBufferId, modelTextureLayerBufferId);
+    }
+
+    // Define the features and light counts of the frame at compile time, so that the models are drawn with shader variants
+    //   without the disabled branches, and with the light loops unrolled. The model types that do not receive light are drawn
+    //   with the lighting and shadows compiled out instead.
+    const auto definesCode = createModelDefinesCode(true, isClusteredLightingEnabled);
+    const auto unlitDefinesCode = createModelDefinesCode(false, false);
+    // Deferred shading relies on the depth of the models hiding the ones behind them, so it is only used when blending is disabled.
+    const auto useDeferredShading = isDeferredShadingEnabled && !windowManager.isBlendingEnabled();
+    // The shadow mask is written from the depth of the depth pre-pass, so it is only used along with it, and while there are shadows.
+    const auto useShadowMask = isShadowMaskEnabled && isDepthPrePassEnabled && !windowManager.isBlendingEnabled() && !useDeferredShading &&
+                               disableFeatureMask < DISABLE_SHADOW && frameLights.coneLightsCount + frameLights.pointLightsCount > 0;
+    // The mask of the last frame cannot be reprojected once a frame is rendered without the mask.
+    if (!useShadowMask)
+    {
+      shadowMask.resetHistory();
+    }
+    // The models receiving light read the shadow visibility of the lights from the mask instead of the shadowmaps with it.
+    const auto &litDefinesCode = useShadowMask ? shadowMask.getMaskedDefinesCode(definesCode) : definesCode;
+
+    // Bind the cone light shadow atlas and the point light shadow map texture array, which are the same for all the models.
+    GlCalls::bindTextureUnit(1, GL_TEXTURE_2D, shadowBufferManager.getConeLightAtlasTextureId());
+    GlCalls::bindTextureUnit(2, GL_TEXTURE_CUBE_MAP_ARRAY, shadowBufferManager.getPointLightTextureArrayId());
+    // Bind the light cluster buffer textures, which are also the same for all the models.
+    lightClusterGrid.bindTextures(3);
+    // Bind the moments of the shadowmaps of the light types shadowed with variance shadow maps as well.
+    GlCalls::bindTextureUnit(6, GL_TEXTURE_2D, shadowMomentMaps.getMomentTextureId(ShadowBufferType::CONE));
+    GlCalls::bindTextureUnit(7, GL_TEXTURE_CUBE_MAP_ARRAY, shadowMomentMaps.getMomentTextureId(ShadowBufferType::POINT));
+
+    auto totalPolygons = 0l;
+    uint32_t impostorsCount = 0;
+
+    // Sort the model groups by shader, texture and object, so that the state shared by consecutive groups is only set once.
+    renderQueue.clear();
+    modelGroupShaders.assign(modelGroups.size(), nullptr);
+    modelGroupGBufferShaders.assign(modelGroups.size(), nullptr);
+    modelGroupImpostors.assign(modelGroups.size(), false);
+    modelGroupOcclusionQueried.assign(modelGroups.size(), false);
+    modelGroupOcclusionQueries.assign(modelGroups.size(), 0);
+    occlusionQueries.beginFrame();
+    auto visibleModelsCount = 0l, culledModelsCount = 0l;
+    for (uint32_t i = 0; i < modelGroups.size(); i++)
+    {
+      visibleModelsCount += modelGroups[i].visibleInstanceCount;
+      culledModelsCount += modelGroups[i].instanceCount - modelGroups[i].visibleInstanceCount;
+
+      // Skip the model groups with all their models outside the view frustum of the camera.
+      if (modelGroups[i].visibleInstanceCount == 0)
+      {
+        continue;
+      }
+
+      const auto &model = modelGroups[i].model;
+      // Request the resolution the largest visible model of the group needs from its texture, which streams its mip levels by it.
+      auto screenSize = 0.0f;
+      for (auto j = modelGroups[i].instanceOffset; j < modelGroups[i].instanceOffset + modelGroups[i].visibleInstanceCount; j++)
+      {
+        screenSize = std::max(screenSize, packet.groupedScreenSizes[j]);
+      }
+      textureManager.requestTextureResolution(model->getTextureDetails(), screenSize * VIEWPORT_HEIGHT * TEXTURE_STREAMING_TEXELS_PER_PIXEL);
+
+      // Use the variant of the shader of the model, which is the shader itself until the variant is compiled.
+      const auto &renderFlags = model->getRenderFlags();
+      modelGroupShaders[i] = shaderManager.getShaderVariant(model->getShaderDetails(), renderFlags.isLightReceiver ? litDefinesCode : unlitDefinesCode);
+      // With deferred shading, the models receiving light are drawn into the G-buffer instead, once the G-buffer variant is compiled.
+      if (useDeferredShading && renderFlags.isLightReceiver)
+      {
+        modelGroupGBufferShaders[i] = deferredShading.getGBufferShader(model->getShaderDetails(), definesCode);
+      }
+      // The models of the group far enough to be drawn as impostors are drawn as billboards into the G-buffer along with it, once
+      //   the atlas of its model type is baked (the GPU-driven path picks the levels of detail of the models on its own).
+      if (modelGroupGBufferShaders[i] != nullptr && modelGroups[i].impostorInstanceCount > 0 && !isGpuDrivenRenderingEnabled)
+      {
+        if (!impostorRenderer.isAtlasBaked(*model))
+        {
+          // Bake the atlas before the G-buffer is bound, setting the state of the models again afterwards.
+          impostorRenderer.bakeAtlas(*model);
+          currentShaderId = 0;
+          currentTextureId = 0;
+          currentObjectId = 0;
+        }
+        modelGroupImpostors[i] = true;
+      }
+      // The model groups drawn with many triangles by few visible models are drawn behind an occlusion query of the union of their
+      //   world AABBs, after the other opaque models of their layer so that the query is tested against their depth (the
+      //   GPU-driven path picks the visible models on its own).
+      if (isOcclusionQueryEnabled && !windowManager.isBlendingEnabled() && !isGpuDrivenRenderingEnabled && modelGroups[i].visibleInstanceCount <= OCCLUSION_QUERY_MAX_INSTANCES)
+      {
+        auto visibleTriangles = 0l;
+        for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
+        {
+          visibleTriangles += (model->getObjectDetails()->getLod(l).indexCount / 3) * modelGroups[i].lodInstanceCounts[l];
+        }
+        modelGroupOcclusionQueried[i] = visibleTriangles >= OCCLUSION_QUERY_MIN_TRIANGLES;
+      }
+      renderQueue.push(RenderQueue::createSortKey((modelGroupGBufferShaders[i] != nullptr ? modelGroupGBufferShaders[i] : modelGroupShaders[i])->getShaderId(),
+                                                  model->getTextureDetails()->getTextureId(),
+                                                  model->getObjectDetails()->getVertexBufferId(),
+                                                  modelGroups[i].viewDepth,
+                                                  windowManager.isBlendingEnabled(),
+                                                  renderFlags.renderLayer,
+                                                  modelGroupOcclusionQueried[i]),
+                       i);
+    }
+
+    const auto &renderQueueItems = renderQueue.sort();
+
+    // Blended models must not hide the models behind them, so the depth pre-pass is only used when blending is disabled (and
+    //   without deferred shading, which only shades the models on top already).
+    const auto useDepthPrePass = isDepthPrePassEnabled && !windowManager.isBlendingEnabled() && !useDeferredShading;
+    if (useDepthPrePass)
+    {
+      // Draw the depth of the models first.
+      renderDepthPrePass(renderQueueItems, packet);
+
+      // Write the shadow visibility of the lights into the shadow mask from the depth of the models, with the same textures as the
+      //   models, and the depth copy and the mask in the units after the G-buffer textures.
+      if (useShadowMask)
+      {
+        gpuTimerManager.beginTimer("Shadow Mask");
+        const auto &maskShaderDetails = shadowMask.getMaskShader(definesCode);
+        currentShaderId = maskShaderDetails->getShaderId();
+        GlCalls::useProgram(currentShaderId);
+        setModelTextureUnits(*maskShaderDetails);
+        shadowMask.renderMask(maskShaderDetails, dynamicResolutionManager.getSceneFramebufferId(), dynamicResolutionManager.getSceneViewportSize(), projectionMatrix, viewMatrix, 11);
+        // The mask pass unbinds its vertex array object.
+        currentObjectId = 0;
+        gpuTimerManager.endTimer("Shadow Mask");
+      }
+
+      // Only shade the fragments with exactly the depth drawn by the pre-pass, without writing the depth again.
+      GlCalls::depthFunc(GL_EQUAL);
+      GlCalls::depthMask(GL_FALSE);
+    }
+
+    // Draw the model groups of the G-buffer pass, or the ones drawn forward, in the sorted order, from the render layers in the
+    //   given range.
+    const auto drawModelGroups = [this, &packet, &renderQueueItems, &modelGroups, &useDepthPrePass, &currentShaderId, &currentTextureId, &currentObjectId, &totalPolygons](const bool &isGBufferPass, const uint32_t &firstLayer, const uint32_t &endLayer) {
+      // Iterate through all the model groups in the scene, in the sorted order.
+      for (const auto &renderQueueItem : renderQueueItems)
+      {
+        // The models of the group drawn as impostors by the G-buffer pass are left out of the coarsest level of detail.
+        const auto &sortedModelGroup = modelGroups[renderQueueItem.itemIndex];
+        const auto modelGroup = isGBufferPass && modelGroupImpostors[renderQueueItem.itemIndex] ? ImpostorRenderer::getMeshModelGroup(sortedModelGroup) : sortedModelGroup;
+        const auto &model = modelGroup.model;
+        // Skip the model groups drawn in the other pass, or in the other render layers.
+        const auto &gBufferShaderDetails = modelGroupGBufferShaders[renderQueueItem.itemIndex];
+        const auto &renderLayer = model->getRenderFlags().renderLayer;
+        if ((gBufferShaderDetails != nullptr) != isGBufferPass || renderLayer < firstLayer || renderLayer >= endLayer)
+        {
+          continue;
+        }
+        const auto &shaderDetails = isGBufferPass ? gBufferShaderDetails : modelGroupShaders[renderQueueItem.itemIndex];
+
+        // Issue the occlusion query of the group if it is drawn behind one not issued by the depth pre-pass, which binds its own
+        //   shader and vertex array object.
+        if (modelGroupOcclusionQueried[renderQueueItem.itemIndex])
+        {
+          issueOcclusionQuery(packet, renderQueueItem.itemIndex, true, !useDepthPrePass);
+          currentShaderId = 0;
+          currentObjectId = 0;
+        }
+
+        // Check if the shader of the light is the same as the currently used shader.
+        if (currentShaderId != shaderDetails->getShaderId())
+        {
+          // If not, set it as the currently used shader and use it.
+          currentShaderId = shaderDetails->getShaderId();
+          GlCalls::useProgram(currentShaderId);
+
+          // Set the texture units of the textures bound for the models.
+          setModelTextureUnits(*shaderDetails);
+        }
+
+        // Render the models of the group in the zone of their name, counting each model drawn.
+        PROFILE_ITEMS_ZONE(model->getModelName(), modelGroup.visibleInstanceCount);
+        const auto modelTimerNameId = getModelTimerNameId(*model);
+        gpuTimerManager.beginTimer(modelTimerNameId);
+
+        // Check if the diffuse texture of the model is the same as the currently bound texture.
+        if (currentTextureId != model->getTextureDetails()->getTextureId())
+        {
+          // If not, bind it as the diffuse texture (which is a texture array shared with other models, if the textures are batched).
+          currentTextureId = model->getTextureDetails()->getTextureId();
+          GlCalls::bindTextureUnit(0, TextureDetails::getTextureTarget(), currentTextureId);
+        }
+
+        // Check if the object of the model is the same as the object of the currently bound vertex array object.
+        if (currentObjectId != model->getObjectDetails()->getVertexBufferId())
+        {
+          // If not, bind the vertex array object of the object, which already describes its vertex attributes.
+          currentObjectId = model->getObjectDetails()->getVertexBufferId();
+          GlCalls::bindVertexArray(model->getObjectDetails()->getVertexArrayId());
+        }
+
+        // Draw the triangles of the models of the group inside the view frustum of the camera, pointing the light mask (and texture
+        //   layer) attributes at the models of each level of detail, unless the occlusion query of the group found it hidden.
+        OcclusionQueries::beginConditionalRender(modelGroupOcclusionQueries[renderQueueItem.itemIndex]);
+        if (isGpuDrivenRenderingEnabled)
+        {
+          gpuModelCulling.drawModelGroup(renderQueueItem.itemIndex, MODEL_MATRIX_ATTRIBUTE_ID, MODEL_LIGHT_MASK_ATTRIBUTE_ID, IS_TEXTURE_ARRAY_BATCHING_ENABLED ? MODEL_TEXTURE_LAYER_ATTRIBUTE_ID : 0);
+        }
+        else
+        {
+          drawModelGroup(modelGroup, modelMatrixBufferId, 0, sizeof(glm::mat4), [this, &modelGroup](const uint32_t &firstInstance) {
+            VertexArray::enableAttribute(MODEL_LIGHT_MASK_ATTRIBUTE_ID,
+                                         modelLightMaskBufferId,
+                                         1,
+                                         GL_UNSIGNED_INT,
+                                         1,
+                                         sizeof(uint32_t),
+                                         (modelGroup.instanceOffset + firstInstance) * sizeof(uint32_t));
+            if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+            {
+              VertexArray::enableAttribute(MODEL_TEXTURE_LAYER_ATTRIBUTE_ID,
+                                           modelTextureLayerBufferId,
+                                           1,
+                                           GL_UNSIGNED_INT,
+                                           1,
+                                           sizeof(uint32_t),
+                                           (modelGroup.instanceOffset + firstInstance) * sizeof(uint32_t));
+            }
+          });
+        }
+        OcclusionQueries::endConditionalRender(modelGroupOcclusionQueries[renderQueueItem.itemIndex]);
+        // Disable the light mask (and texture layer) attributes again, since the shadow casters drawn with the same vertex array
+        //   object do not provide them.
+        VertexArray::disableAttribute(MODEL_LIGHT_MASK_ATTRIBUTE_ID);
+        if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+        {
+          VertexArray::disableAttribute(MODEL_TEXTURE_LAYER_ATTRIBUTE_ID);
+        }
+        gpuTimerManager.endTimer(modelTimerNameId);
+
+        for (uint32_t l = 0; l < OBJECT_LOD_COUNT; l++)
+        {
+          totalPolygons += (model->getObjectDetails()->getLod(l).indexCount / 3) * modelGroup.lodInstanceCounts[l];
+        }
+      }
+    };
+
+    if (useDeferredShading)
+    {
+      // Draw the surfaces of the models receiving light into the G-buffer.
+      gpuTimerManager.beginTimer("G-Buffer Render");
+      deferredShading.bindGBuffer(dynamicResolutionManager.getSceneViewportSize());
+      drawModelGroups(true, 0, std::numeric_limits<uint32_t>::max());
+      // Draw the impostors into the G-buffer after the meshes, with the atlas textures in the units of the G-buffer textures, which
+      //   are only bound by the lighting pass.
+      impostorsCount = impostorRenderer.renderImpostors(modelGroups, modelGroupImpostors, modelMatrixBufferId, modelLightMaskBufferId, MODEL_MATRIX_ATTRIBUTE_ID, MODEL_LIGHT_MASK_ATTRIBUTE_ID, 8);
+      totalPolygons += 2l * impostorsCount;
+      currentShaderId = 0;
+      currentObjectId = 0;
+      gpuTimerManager.endTimer("G-Buffer Render");
+
+      // Light the G-buffer into the render target of the scene, with the same textures as the models shaded forward, and the
+      //   G-buffer textures in the units after them.
+      gpuTimerManager.beginTimer("Deferred Lighting");
+      const auto &lightingShaderDetails = deferredShading.getLightingShader(definesCode);
+      currentShaderId = lightingShaderDetails->getShaderId();
+      GlCalls::useProgram(currentShaderId);
+      setModelTextureUnits(*lightingShaderDetails);
+      deferredShading.renderLighting(lightingShaderDetails, dynamicResolutionManager.getSceneFramebufferId(), dynamicResolutionManager.getSceneViewportSize(), projectionMatrix, viewMatrix, 8);
+      // The lighting pass unbinds its vertex array object.
+      currentObjectId = 0;
+      gpuTimerManager.endTimer("Deferred Lighting");
+    }
+
+    // Draw the rest of the models forward (all of them without deferred shading), tested against the depth of the lit models.
+    gpuTimerManager.beginTimer("Forward Render");
+    // Draw the lowest render layers from the layer cache if the scene asks for it, and they are all drawn forward in one pass.
+    if (packet.isLayerCacheEnabled && !useDeferredShading && !useDepthPrePass)
+    {
+      // Draw the cached layers again only if what they are drawn with changed, at most at the refresh rate of the cache.
+      const auto &sceneSize = dynamicResolutionManager.getSceneViewportSize();
+      const auto layerSignature = getCachedLayerSignature(packet);
+      if (layerCache.isRefreshDue(layerSignature, sceneSize, glfwGetTime()))
+      {
+        layerCache.beginCapture(sceneSize);
+        drawModelGroups(false, 0, CACHED_RENDER_LAYERS_COUNT);
+        layerCache.endCapture(layerSignature, glfwGetTime(), dynamicResolutionManager.getSceneFramebufferId(), sceneSize);
+      }
+      // Composite the cached layers with the texture units of the G-buffer, unused without deferred shading, and draw the other
+      //   layers over them. The composite uses its own shader and vertex array object.
+      layerCache.composite(8, windowManager.isBlendingEnabled());
+      currentShaderId = 0;
+      currentObjectId = 0;
+      drawModelGroups(false, CACHED_RENDER_LAYERS_COUNT, std::numeric_limits<uint32_t>::max());
+    }
+    else
+    {
+      layerCache.invalidate();
+      drawModelGroups(false, 0, std::numeric_limits<uint32_t>::max());
+    }
+    gpuTimerManager.endTimer("Forward Render");
+
+    // Write the model renders of the last frame into the HUD stats from the zone of each model name, with the polygons and the
+    //   vertices left after welding the face corners sharing the same vertex information of the models drawn in this one, and the
+    //   vertex cache misses per triangle before and after reordering them.
+    const auto modelRenderZoneId = CpuProfiler::getCurrentZoneId();
+    for (size_t i = 0; i < modelGroups.size(); i++)
+    {
+      const auto &modelGroup = modelGroups[i];
+      if (modelGroup.visibleInstanceCount == 0)
+      {
+        continue;
+      }
+      const auto &modelName = modelGroup.model->getModelName();
+      const auto &objectDetails = modelGroup.model->getObjectDetails();
+      const auto modelStats = cpuProfiler.getChildZoneStats(modelRenderZoneId, modelName);
+      const auto avgGpuRenderTime = gpuTimerManager.getTimeMs(getModelTimerNameId(*modelGroup.model)) / modelGroup.visibleInstanceCount;
+      const auto vertexReduction = objectDetails->getIndexCount() > 0 ? static_cast<float_t>(objectDetails->getVertexCount()) / objectDetails->getIndexCount() : 1.0f;
+      auto line = hudStatsManager.beginLine(modelRenderHudSection, modelName);
+      line.setCount("Instances", modelGroup.visibleInstanceCount).addSample("Render (avg)", modelStats.getAverageTimeMs(), "ms").addSample("GPU (avg)", avgGpuRenderTime, "ms").setCount("Polygon Count", objectDetails->getIndexCount() / 3).setCount("Vertices", objectDetails->getVertexCount()).setCount("Indices", objectDetails->getIndexCount()).addSample("Vertex Reduction", vertexReduction * 100.0f, "%").addSample("ACMR", objectDetails->getOriginalAcmr()).addSample("Optimized ACMR", objectDetails->getOptimizedAcmr());
+      if (objectDetails->getLodsCount() > 1)
+      {
+        // Add the instances drawn with each level of detail, for the objects that have any (named in a buffer, so that naming
+        //   them allocates nothing).
+        for (uint32_t l = 0; l < objectDetails->getLodsCount(); l++)
+        {
+          char lodCounterName[24];
+          const auto lodCounterNameLength = std::snprintf(lodCounterName, sizeof(lodCounterName), "LOD %u Instances", l);
+          line.setCount(std::string_view(lodCounterName, lodCounterNameLength), modelGroup.lodInstanceCounts[l]);
+        }
+      }
+      if (modelGroupImpostors[i])
+      {
+        line.setCount("Impostors", modelGroup.impostorInstanceCount);
+      }
+      // Add how often the occlusion queries found the models hidden, for the model groups drawn behind them.
+      if (modelGroupOcclusionQueries[i] != 0)
+      {
+        const auto queryStats = occlusionQueries.getStats(modelGroup.model->getModelTypeId());
+        const auto hiddenRate = queryStats.queriesCount > 0 ? 100.0f * queryStats.hiddenCount / queryStats.queriesCount : 0.0f;
+        line.setCount("Occlusion Query Hidden", queryStats.hiddenCount).setCount("Occlusion Queries", queryStats.queriesCount).addSample("Hidden Rate", hiddenRate, "%");
+      }
+    }
+    // Unbind the vertex array object now that we're done.
+    GlCalls::bindVertexArray(0);
+
+    // Unbind the shadow mask once the models reading it are drawn.
+    if (useShadowMask)
+    {
+      shadowMask.unbindMaskTextures(11);
+    }
+
+    // Restore the default depth testing after the depth pre-pass.
+    if (useDepthPrePass)
+    {
+      GlCalls::depthFunc(GL_LESS);
+      GlCalls::depthMask(GL_TRUE);
+    }
+
+    // Capture the depth of the models into the depth pyramid the models of the next frames are tested against, unless the models
+    //   are blended and do not hide the ones behind them.
+    if (isOcclusionCullingEnabled && !windowManager.isBlendingEnabled())
+    {
+      occlusionCuller.captureDepth(dynamicResolutionManager.getSceneFramebufferId(), dynamicResolutionManager.getSceneViewportSize(), packet.camera.matrices.viewProjectionMatrix);
+    }
+    else
+    {
+      occlusionCuller.invalidate();
+    }
+
+    {
+      auto text = textManager.beginText(glm::vec2(1, 12.5f), 0.5f);
+      text << "Total Polygons: " << totalPolygons << " | ";
+      dynamicResolutionManager.writeStatus(text);
+    }
+    // The occlusion rate is the share of the models inside the view frustum hidden behind the depth of the last frames.
+    const auto occludedModelsCount = static_cast<long>(packet.occludedModelsCount);
+    const auto occlusionRate = occludedModelsCount > 0 ? 100.0f * occludedModelsCount / (visibleModelsCount + occludedModelsCount) : 0.0f;
+    textManager.beginText(glm::vec2(1, 12), 0.5f) << "Visible Models: " << visibleModelsCount << " | Culled Models: " << culledModelsCount - occludedModelsCount << " | Occluded Models (Z): " << occludedModelsCount << " (" << occlusionRate << "%) | Visibility Tests: " << packet.visibility.testedCount << " (Reused: " << packet.visibility.reusedCount << ") | Occlusion Queries (H): " << (isOcclusionQueryEnabled ? "On" : "Off") << " | Streamed Texture Mips: " << textureManager.getStreamedMipsSize() / (1024 * 1024) << " / " << TEXTURE_STREAMING_BUDGET / (1024 * 1024) << " MB";
+    textManager.beginText(glm::vec2(1, 11.5f), 0.5f) << "Clustered Lighting (C): " << (isClusteredLightingEnabled ? "On" : "Off") << " | Binned Lights: " << (isClusteredLightingEnabled ? lightClusterGrid.getLightsCount() : 0) << " | Light Indices: " << (isClusteredLightingEnabled ? lightClusterGrid.getLightIndicesCount() : 0);
+    {
+      // Write the GPU times of the passes of the deferred shading next to the time of the models drawn forward.
+      auto text = textManager.beginText(glm::vec2(1, 13.5f), 0.5f);
+      text << "Shading (E): " << (useDeferredShading ? "Deferred" : isDeferredShadingEnabled ? "Deferred (Off While Blending)" : "Forward");
+      if (useDeferredShading)
+      {
+        text << " | G-Buffer GPU: " << gpuTimerManager.getTimeMs("G-Buffer Render") << "ms | Lighting GPU: " << gpuTimerManager.getTimeMs("Deferred Lighting") << "ms | Impostors (J): ";
+        if (isImpostorRenderingEnabled)
+        {
+          text << impostorsCount;
+        }
+        else
+        {
+          text << "Off";
+        }
+      }
+      text << " | Forward GPU: " << gpuTimerManager.getTimeMs("Forward Render") << "ms | Shadow Mask: " << (useShadowMask ? (shadowMask.isTemporalFiltered() ? "On (Temporal)" : "On") : isShadowMaskEnabled ? "Off (Needs Depth Pre-Pass)" : "Off");
+      if (useShadowMask)
+      {
+        text << " (" << gpuTimerManager.getTimeMs("Shadow Mask") << "ms)";
+      }
+    }
+  }
+
+  /**
+   * Get the signature of what the models of the cached render layers are drawn with in the given render packet, hashing the
+   *   camera, the streamed texture mips, and the types, shaders, textures and transform versions of the visible models of the
+   *   cached layers, so that the layer cache is drawn again whenever any of them changes.
+   * Must be called once the shaders of the model groups are picked for the frame.
+   * 
+   * @param packet  The render packet of the frame.
+   * 
+   * @return The signature.
+   */
+  uint64_t getCachedLayerSignature(const RenderPacket &packet) const
+  {
+    // Hash the details one 64-bit word at a time with FNV-1a.
+    uint64_t signature = 0xcbf29ce484222325;
+    const auto addToSignature = [&signature](const uint64_t &value) {
+      signature = (signature ^ value) * 0x100000001b3;
+    };
+    const auto &viewProjectionMatrix = packet.camera.matrices.viewProjectionMatrix;
+    for (glm::length_t i = 0; i < 4; i++)
+    {
+      for (glm::length_t j = 0; j < 4; j++)
+      {
+        addToSignature(glm::floatBitsToUint(viewProjectionMatrix[i][j]));
+      }
+    }
+    addToSignature(textureManager.getStreamedMipsSize());
+    addToSignature(windowManager.isBlendingEnabled());
+    addToSignature(static_cast<uint64_t>(disableFeatureMask));
+
+    for (uint32_t i = 0; i < packet.modelGroups.size(); i++)
+    {
+      const auto &modelGroup = packet.modelGroups[i];
+      const auto &model = modelGroup.model;
+      if (modelGroup.visibleInstanceCount == 0 || model->getRenderFlags().renderLayer >= CACHED_RENDER_LAYERS_COUNT)
+      {
+        continue;
+      }
+      addToSignature(model->getModelTypeId());
+      addToSignature(modelGroupShaders[i]->getShaderId());
+      addToSignature(model->getTextureDetails()->getTextureId());
+      addToSignature(modelGroup.visibleInstanceCount);
+      for (auto j = modelGroup.instanceOffset; j < modelGroup.instanceOffset + modelGroup.visibleInstanceCount; j++)
+      {
+        addToSignature(packet.groupedTransformVersions[j]);
+      }
+    }
+    return signature;
+  }
+
+  /**
+   * Draw the IDs of the visible models that can be picked by the pick request of the given render packet (or by the request left
+   *   waiting by an earlier frame) into the picking target, from the model matrices uploaded for the frame.
+   * 
+   * @param packet  The render packet of the frame.
+   */
+  void renderPick(const RenderPacket &packet)
+  {
+    const auto collisionMask = modelPicker.beginPick(packet.pickRequest, packet.camera.matrices.viewProjectionMatrix, packet.animationTime);
+    if (collisionMask == 0)
+    {
+      return;
+    }
+
+    GLuint currentObjectId = 0;
+    for (const auto &modelGroup : packet.modelGroups)
+    {
+      // The models of a group share their collision layer, so the whole group is either picked or drawn through.
+      if (modelGroup.visibleInstanceCount == 0 || (modelGroup.model->getCollisionLayer() & collisionMask) == 0)
+      {
+        continue;
+      }
+      const auto &objectDetails = modelGroup.model->getObjectDetails();
+      if (currentObjectId != objectDetails->getVertexBufferId())
+      {
+        currentObjectId = objectDetails->getVertexBufferId();
+        GlCalls::bindVertexArray(objectDetails->getVertexArrayId());
+      }
+      const auto firstPickId = modelPicker.addPickableModels(packet.groupedModels, modelGroup.instanceOffset, modelGroup.visibleInstanceCount);
+      drawModelGroup(modelGroup, modelMatrixBufferId, 0, sizeof(glm::mat4), [this, &firstPickId](const uint32_t &firstInstance) {
+        modelPicker.setFirstPickId(firstPickId + firstInstance);
+      });
+    }
+    GlCalls::bindVertexArray(0);
+
+    modelPicker.endPick(dynamicResolutionManager.getSceneFramebufferId(), dynamicResolutionManager.getSceneViewportSize());
+  }
+
+  /**
+   * Render the additional views of the scene, each into its part of the render target of the scene over the view of the active
+   *   camera, with the shadowmaps and the lights of the frame. The views are drawn forward, with the point lights looped over
+   *   instead of binned, since the light clusters are only built for the view of the active camera.
+   * 
+   * @param frameLights  The lights of the frame with a shadowmap, in the same order as the frame details.
+   * @param packet       The render packet of the frame.
+   */
+  void renderViews(const FrameLights &frameLights, const RenderPacket &packet)
+  {
+    if (packet.views.empty())
+    {
+      return;
+    }
+    PROFILE_ZONE("View Render");
+    GL_STATS_PASS(GlStatsPass::VIEWS);
+
+    // The shadowmaps and the render target bound for the models of the active camera are still bound, so only the frame details
+    //   and the per-instance details change between the views.
+    const auto definesCode = createModelDefinesCode(true, false);
+    const auto unlitDefinesCode = createModelDefinesCode(false, false);
+    const auto sceneViewportSize = glm::vec2(dynamicResolutionManager.getSceneViewportSize());
+    GLuint currentShaderId = 0;
+    GLuint currentTextureId = 0;
+    GLuint currentObjectId = 0;
+    glEnable(GL_SCISSOR_TEST);
+    for (const auto &view : packet.views)
+    {
+      // Draw the view into its part of the render target, clearing only that part.
+      const auto viewportOrigin = glm::ivec2(glm::vec2(view.viewportRect.x, view.viewportRect.y) * sceneViewportSize);
+      const auto viewportSize = glm::ivec2(glm::vec2(view.viewportRect.z, view.viewportRect.w) * sceneViewportSize);
+      GlCalls::viewport(viewportOrigin.x, viewportOrigin.y, viewportSize.x, viewportSize.y);
+      glScissor(viewportOrigin.x, viewportOrigin.y, viewportSize.x, viewportSize.y);
+      windowManager.clearScreen(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+      // Switch the frame details to the camera of the view, with the point lights read from the frame details.
+      frameData.viewMatrix = view.camera.matrices.viewMatrix;
+      frameData.projectionMatrix = view.camera.matrices.projectionMatrix;
+      frameData.viewProjectionMatrix = view.camera.matrices.viewProjectionMatrix;
+      frameData.clusterDetails.w = false;
+      uniformBufferManager.updateFrameData(frameData);
+
+      // Write the per-instance details of the models of the view.
+      createModelLightMasks(frameLights, packet.visibility, view.modelGroups, view.groupedTransformHandles, view.groupedMinCorners, view.groupedMaxCorners, false, viewModelLightMasks);
+      const auto modelMatrixAllocation = writeStreamedInstances(viewModelMatrixBufferId, view.modelMatrices, "View Model Matrices");
+      const auto lightMaskAllocation = writeStreamedInstances(viewModelLightMaskBufferId, viewModelLightMasks, "View Light Masks");
+      StreamAllocation textureLayerAllocation = {};
+      if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+      {
+        viewModelTextureLayers.clear();
+        for (const auto &modelGroup : view.modelGroups)
+        {
+          viewModelTextureLayers.insert(viewModelTextureLayers.end(), modelGroup.instanceCount, modelGroup.model->getTextureDetails()->getTextureLayer());
+        }
+        textureLayerAllocation = writeStreamedInstances(viewModelTextureLayerBufferId, viewModelTextureLayers, "View Texture Layers");
+      }
+
+      // Sort the model groups of the view by shader, texture and object, the same way as the ones of the active camera.
+      renderQueue.clear();
+      modelGroupShaders.assign(view.modelGroups.size(), nullptr);
+      for (uint32_t i = 0; i < view.modelGroups.size(); i++)
+      {
+        const auto &modelGroup = view.modelGroups[i];
+        const auto &model = modelGroup.model;
+        // Request the resolution the largest model of the group needs in the view from its texture as well.
+        auto screenSize = 0.0f;
+        for (auto j = modelGroup.instanceOffset; j < modelGroup.instanceOffset + modelGroup.visibleInstanceCount; j++)
+        {
+          screenSize = std::max(screenSize, view.groupedScreenSizes[j]);
+        }
+        textureManager.requestTextureResolution(model->getTextureDetails(), screenSize * view.viewportRect.w * VIEWPORT_HEIGHT * TEXTURE_STREAMING_TEXELS_PER_PIXEL);
+
+        const auto &renderFlags = model->getRenderFlags();
+        modelGroupShaders[i] = shaderManager.getShaderVariant(model->getShaderDetails(), renderFlags.isLightReceiver ? definesCode : unlitDefinesCode);
+        renderQueue.push(RenderQueue::createSortKey(modelGroupShaders[i]->getShaderId(),
+                                                    model->getTextureDetails()->getTextureId(),
+                                                    model->getObjectDetails()->getVertexBufferId(),
+                                                    modelGroup.viewDepth,
+                                                    windowManager.isBlendingEnabled(),
+                                                    renderFlags.renderLayer,
+                                                    false),
+                         i);
+      }
+
+      // Draw the model groups of the view in the sorted order.
+      for (const auto &renderQueueItem : renderQueue.sort())
+      {
+        const auto &modelGroup = view.modelGroups[renderQueueItem.itemIndex];
+        const auto &model = modelGroup.model;
+        const auto &shaderDetails = modelGroupShaders[renderQueueItem.itemIndex];
+        if (currentShaderId != shaderDetails->getShaderId())
+        {
+          currentShaderId = shaderDetails->getShaderId();
+          GlCalls::useProgram(currentShaderId);
+          setModelTextureUnits(*shaderDetails);
+        }
+        if (currentTextureId != model->getTextureDetails()->getTextureId())
+        {
+          currentTextureId = model->getTextureDetails()->getTextureId();
+          GlCalls::bindTextureUnit(0, TextureDetails::getTextureTarget(), currentTextureId);
+        }
+        if (currentObjectId != model->getObjectDetails()->getVertexBufferId())
+        {
+          currentObjectId = model->getObjectDetails()->getVertexBufferId();
+          GlCalls::bindVertexArray(model->getObjectDetails()->getVertexArrayId());
+        }
+
+        drawModelGroup(modelGroup, modelMatrixAllocation.bufferId, modelMatrixAllocation.offset, sizeof(glm::mat4), [&modelGroup, &lightMaskAllocation, &textureLayerAllocation](const uint32_t &firstInstance) {
+          VertexArray::enableAttribute(MODEL_LIGHT_MASK_ATTRIBUTE_ID,
+                                       lightMaskAllocation.bufferId,
+                                       1,
+                                       GL_UNSIGNED_INT,
+                                       1,
+                                       sizeof(uint32_t),
+                                       lightMaskAllocation.offset + ((modelGroup.instanceOffset + firstInstance) * sizeof(uint32_t)));
+          if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+          {
+            VertexArray::enableAttribute(MODEL_TEXTURE_LAYER_ATTRIBUTE_ID,
+                                         textureLayerAllocation.bufferId,
+                                         1,
+                                         GL_UNSIGNED_INT,
+                                         1,
+                                         sizeof(uint32_t),
+                                         textureLayerAllocation.offset + ((modelGroup.instanceOffset + firstInstance) * sizeof(uint32_t)));
+          }
+        });
+        VertexArray::disableAttribute(MODEL_LIGHT_MASK_ATTRIBUTE_ID);
+        if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+        {
+          VertexArray::disableAttribute(MODEL_TEXTURE_LAYER_ATTRIBUTE_ID);
+        }
+      }
+    }
+    GlCalls::bindVertexArray(0);
+    glDisable(GL_SCISSOR_TEST);
+
+    // Go back to the whole render target and the frame details of the active camera, for whatever is drawn over the scene next.
+    GlCalls::viewport(0, 0, static_cast<GLsizei>(sceneViewportSize.x), static_cast<GLsizei>(sceneViewportSize.y));
+    frameData.viewMatrix = packet.camera.matrices.viewMatrix;
+    frameData.projectionMatrix = packet.camera.matrices.projectionMatrix;
+    frameData.viewProjectionMatrix = packet.camera.matrices.viewProjectionMatrix;
+    frameData.clusterDetails.w = isClusteredLightingEnabled;
+    uniformBufferManager.updateFrameData(frameData);
+  }
+
+  /**
+   * Fill the given render packet with the state of the scene the frame is rendered from, so that the scene can be changed while
+   *   the packet is rendered. Makes no GL calls, so that it can be done on the main thread while the last packet is rendered on
+   *   the thread owning the GL context.
+   * 
+   * @param packet  The render packet to fill.
+   */
+  void fillRenderPacket(RenderPacket &packet)
+  {
+    // Take the state of the inputs and the window the frame starts with.
+    packet.input = controlManager.getInputSnapshot();
+    packet.inputSampleTime = controlManager.getInputSampleTime();
+    packet.swapInterval = SWAP_INTERVAL;
+
+    // Take the state of the active camera.
+    const auto activeCamera = cameraManager.getCamera(activeCameraHandle);
+    packet.camera = {activeCamera->getCameraPosition(), activeCamera->getCameraMatrices(), 0};
+    // Take the time the spinning models are animated to, at the same point between the last two steps as the interpolated transforms.
+    packet.animationTime = static_cast<float_t>(simulationClock.getRenderTime());
+
+    // Move the lights attached to the models moved since the last frame, before they are ranked.
+    attachmentManager.resolveAttachments();
+    // Rank the lights by their contribution to the view, merge the nearby ones casting no shadows, and take the state of the ones
+    //   reaching it.
+    packet.lights.clear();
+    const auto rankedLights = lightManager.getRankedLights(packet.camera.matrices.frustum, packet.camera.position);
+    packet.mergedLightsCount = 0;
+    for (const auto &aggregate : LightManager::aggregateLights(rankedLights, RenderConfigManager::getConfig().isLightAggregationEnabled))
+    {
+      packet.lights.push_back(createRenderLightState(aggregate));
+      packet.mergedLightsCount += aggregate.lightsCount - 1;
+    }
+    packet.registeredLightsCount = lightManager.getAllLights().size();
+    // Take whether any static casters are registered, which the static shadow cache is switched on for.
+    packet.hasStaticCasters = modelManager.getStaticCastersCount() > 0;
+
+    // Rebuild the world matrices and AABBs of all the models moved since the last frame at once, before the models are grouped,
+    //   and start the visibility of the frame with the transforms they changed.
+    transformManager.updateWorldTransforms();
+    visibilityManager.beginFrame();
+    packet.camera.visibilityView = visibilityManager.addView(packet.camera.matrices.viewProjectionMatrix);
+    // Check if the "J" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_J))
+    {
+      // "J" was pressed. Toggle the impostors of the distant models.
+      isImpostorRenderingEnabled = !isImpostorRenderingEnabled;
+    }
+    // Check if the "1" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_1))
+    {
+      // "1" was pressed. Toggle the additional views.
+      isMultiViewEnabled = !isMultiViewEnabled;
+    }
+    // Take the state of the cameras of the additional views.
+    packet.views.resize(isMultiViewEnabled ? viewCameras.size() : 0);
+    for (size_t i = 0; i < packet.views.size(); i++)
+    {
+      const auto viewCamera = cameraManager.getCamera(viewCameras[i].cameraHandle);
+      auto &view = packet.views[i];
+      view.camera = {viewCamera->getCameraPosition(), viewCamera->getCameraMatrices(), 0};
+      view.camera.visibilityView = visibilityManager.addView(view.camera.matrices.viewProjectionMatrix);
+      view.viewportRect = viewCameras[i].viewportRect;
+    }
+    // Find the models visible to the cameras, then group the models by type, shared by the light and model render steps, and
+    //   group the ones inside the view frustums of the additional views.
+    visibilityManager.computeViews(packet.visibility);
+    createModelGroups(packet);
+    for (auto &view : packet.views)
+    {
+      createViewModelGroups(packet, view);
+    }
+    // Fit the shadow projections of the lights to the world AABBs of the models just grouped, taking the matrices and the shadow
+    //   versions they end up with.
+    if (RenderConfigManager::getConfig().isShadowFittingEnabled)
+    {
+      for (auto &lightState : packet.lights)
+      {
+        if (lightState.light->isShadowCaster())
+        {
+          lightState.light->fitShadowProjections(packet.groupedMinCorners, packet.groupedMaxCorners);
+          lightState.vpMatrices = createLightVpMatrices(*lightState.light);
+          lightState.shadowVersion = lightState.light->getShadowVersion();
+        }
+      }
+    }
+    // Find the models inside the shadowmap faces of the lights casting shadows, limited to the far planes of the lights.
+    for (auto &lightState : packet.lights)
+    {
+      if (!lightState.light->isShadowCaster())
+      {
+        continue;
+      }
+      lightState.visibilityView = visibilityManager.addView(lightState.vpMatrices[0], lightState.lightPosition, lightState.farPlane);
+      for (uint32_t j = 1; j < lightState.facesCount; j++)
+      {
+        visibilityManager.addView(lightState.vpMatrices[j], lightState.lightPosition, lightState.farPlane);
+      }
+    }
+    visibilityManager.computeViews(packet.visibility);
+    // Take the shots and the enemies to test against each other on the GPU.
+    gpuShotCollisionManager.fillBatch(packet.shotCollisionBatch);
+    // Take the pick requested for the frame, and whether the layer cache is used for it.
+    packet.pickRequest = pendingPickRequest;
+    packet.isLayerCacheEnabled = isLayerCacheEnabled;
+    pendingPickRequest.requestId = 0;
+  }
+
+  /**
+   * Render the scene with the light shadowmaps and the models from the given render packet, without touching the state of the scene.
+   * 
+   * @param packet  The render packet of the frame.
+   */
+  void render(const RenderPacket &packet)
+  {
+    // The render loop is meant to reuse the storage of the last frame, so any allocation in it is flagged.
+    NO_ALLOC_ZONE("Render");
+
+    // Get the time at the start of the frame.
+    const auto currentTime = glfwGetTime();
+    auto updateStartTime = currentTime, updateEndTime = currentTime;
+
+    // Check if the "L" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_L))
+    {
+      // "L" was pressed, meaning we need to start disabling render features.
+      // Check which features have already been disabled.
+      switch (disableFeatureMask)
+      {
+      case 0:
+        // No features were disabled. Start disabling shadows.
+        disableFeatureMask = DISABLE_SHADOW;
+        break;
+      case 1:
+        // Shadows were disabled. Start disabling lighting.
+        disableFeatureMask = DISABLE_LIGHT;
+        break;
       case 2:
       default:
         // All features were disabled. Enable everything.
         disableFeatureMask = 0;
       }
-      // Update the timestamp for when the disable feature mask was changed
-      lastDisableFeatureMaskChange = currentTime;
+    }
+
+    // Check if the "P" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_P))
+    {
+      // "P" was pressed. Toggle the depth pre-pass.
+      isDepthPrePassEnabled = !isDepthPrePassEnabled;
+    }
+
+    // Check if the "E" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_E))
+    {
+      // "E" was pressed. Toggle the deferred shading.
+      isDeferredShadingEnabled = !isDeferredShadingEnabled;
+    }
+
+    // Check if the "C" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_C))
+    {
+      // "C" was pressed. Toggle the clustered lighting.
+      isClusteredLightingEnabled = !isClusteredLightingEnabled;
+    }
+
+    // Check if the "K" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_K))
+    {
+      // "K" was pressed. Switch to the next shadow filter kernel, going back to the smallest after the largest.
+      shadowFilterKernel = static_cast<ShadowFilterKernel>((shadowFilterKernel + 1) % (ShadowFilterKernel::FILTER_POISSON_16 + 1));
+    }
+
+    // Check if the "Y" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_Y))
+    {
+      // "Y" was pressed. Switch to the next combination of shadow techniques of the cone and point lights.
+      const auto techniques = (shadowTechniques.at(ShadowBufferType::CONE) + (2 * shadowTechniques.at(ShadowBufferType::POINT)) + 1) % 4;
+      for (const auto &shadowTechnique : {std::make_pair(ShadowBufferType::CONE, static_cast<ShadowTechnique>(techniques % 2)),
+                                          std::make_pair(ShadowBufferType::POINT, static_cast<ShadowTechnique>(techniques / 2))})
+      {
+        // Render all the shadowmaps of the light types switched to variance shadow maps again, so that all their moments are written.
+        if (shadowTechnique.second == ShadowTechnique::TECHNIQUE_VSM && shadowTechniques.at(shadowTechnique.first) != ShadowTechnique::TECHNIQUE_VSM)
+        {
+          shadowFaceStates.erase(shadowTechnique.first);
+        }
+        shadowTechniques.at(shadowTechnique.first) = shadowTechnique.second;
+      }
+    }
+
+    // Check if the "F" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_F))
+    {
+      // "F" was pressed. Toggle the amortized shadowmap updates.
+      isShadowUpdateAmortized = !isShadowUpdateAmortized;
+    }
+
+    // Check if the "Q" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_Q))
+    {
+      // "Q" was pressed. Switch to the next quality preset, going back to the lowest after the highest.
+      qualityPreset = (qualityPreset + 1) % QUALITY_PRESETS_COUNT;
+    }
+
+    // Check if the "X" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_X))
+    {
+      // "X" was pressed. Switch to the next dynamic resolution mode.
+      dynamicResolutionManager.cycleMode();
+    }
+
+    // Check if the "N" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_N))
+    {
+      // "N" was pressed. Switch to the next anti-aliasing mode.
+      dynamicResolutionManager.cycleAntiAliasingMode();
+    }
+
+    // Check if the "I" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_I) && windowManager.isGpuDrivenRenderingSupported())
+    {
+      // "I" was pressed. Toggle the GPU-driven rendering.
+      isGpuDrivenRenderingEnabled = !isGpuDrivenRenderingEnabled;
+    }
+
+    // Check if the "Z" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_Z))
+    {
+      // "Z" was pressed. Toggle the occlusion culling, which stops once the depth pyramid is forgotten.
+      isOcclusionCullingEnabled = !isOcclusionCullingEnabled;
+    }
+
+    // Check if the "H" has been pressed since the last frame.
+    if (packet.input.wasKeyPressed(GLFW_KEY_H))
+    {
+      // "H" was pressed. Toggle the occlusion queries of the expensive model groups.
+      isOcclusionQueryEnabled = !isOcclusionQueryEnabled;
+    }
+
+    // Upload a streamed texture if one is done being read, replacing its placeholder.
+    textureManager.updateStreamingTextures();
+    // Create an object and shader program preloaded for the likely-next scene, if they are done being read.
+    scenePreloader.update();
+
+    // Test the shots against the enemies on the GPU, and collect the hits of the earlier frames the GPU is done with.
+    gpuShotCollisionManager.dispatchBatch(packet.shotCollisionBatch);
+
+    // Pick the lights shaded in the frame, and give the shadowmaps to the most important ones.
+    selectLights(packet);
+
+    // Write the model matrices to the model matrix buffer, orphaning the storage used by the last frame.
+    glBindBuffer(GL_ARRAY_BUFFER, modelMatrixBufferId);
+    GlCalls::bufferData(GL_ARRAY_BUFFER, packet.modelMatrices.size() * sizeof(glm::mat4), packet.modelMatrices.data(), GL_STREAM_DRAW);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, modelMatrixBufferId, GpuMemoryCategory::DYNAMIC, "Model Matrices", packet.modelMatrices.size() * sizeof(glm::mat4));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Write the layers of the texture arrays containing the diffuse textures of the visible models to the model texture layer
+    //   buffer, once the streamed textures are uploaded, so that models of different types can share a texture array.
+    if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+    {
+      modelTextureLayers.assign(packet.groupedModels.size(), 0);
+      for (const auto &modelGroup : packet.modelGroups)
+      {
+        // The layers of all the models are needed if they are culled on the GPU.
+        const auto firstLayer = modelTextureLayers.begin() + modelGroup.instanceOffset;
+        std::fill(firstLayer, firstLayer + (isGpuDrivenRenderingEnabled ? modelGroup.instanceCount : modelGroup.visibleInstanceCount), modelGroup.model->getTextureDetails()->getTextureLayer());
+      }
+      glBindBuffer(GL_ARRAY_BUFFER, modelTextureLayerBufferId);
+      GlCalls::bufferData(GL_ARRAY_BUFFER, modelTextureLayers.size() * sizeof(uint32_t), modelTextureLayers.data(), GL_STREAM_DRAW);
+      gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, modelTextureLayerBufferId, GpuMemoryCategory::DYNAMIC, "Texture Layers", modelTextureLayers.size() * sizeof(uint32_t));
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     // Render the light shadowmaps.
     updateStartTime = glfwGetTime();
-    const auto categorizedLights = renderLights();
+    gpuTimerManager.beginTimer("Light Render");
+    const auto &frameLights = renderLights(packet);
+    gpuTimerManager.endTimer("Light Render");
     updateEndTime = glfwGetTime();
-    textManager.addText("Light Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 25.5f), 0.5f);
+    // The display names of the shadow filter kernels, indexed by the kernels.
+    const char *shadowFilterKernelNames[] = {"1x1", "3x3", "Poisson 8", "Poisson 16"};
+    // The display names of the shadow techniques, indexed by the techniques.
+    const char *shadowTechniqueNames[] = {"PCF", "VSM"};
+    // The display names of the quality presets, indexed by the presets.
+    textManager.beginText(glm::vec2(1, 25.5f), 0.5f) << "Light Render: " << (updateEndTime - updateStartTime) * 1000 << "ms | GPU: " << gpuTimerManager.getTimeMs("Light Render") << "ms | Shadow Filter (K): " << shadowFilterKernelNames[shadowFilterKernel] << " | Shadow Technique (Y): Cone " << shadowTechniqueNames[shadowTechniques.at(ShadowBufferType::CONE)] << ", Point " << shadowTechniqueNames[shadowTechniques.at(ShadowBufferType::POINT)] << " | Quality (Q): " << QUALITY_PRESET_NAMES[qualityPreset];
 
     // Render the models.
     updateStartTime = glfwGetTime();
-    renderModels(categorizedLights);
+    gpuTimerManager.beginTimer("Model Render");
+    renderModels(frameLights, packet);
+    gpuTimerManager.endTimer("Model Render");
     updateEndTime = glfwGetTime();
-    textManager.addText("Model Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 25), 0.5f);
+    // Draw the IDs of the pickable models under the point of the pick requested, if any.
+    renderPick(packet);
+    // Render the additional views with the same shadowmaps.
+    const auto viewsStartTime = glfwGetTime();
+    renderViews(frameLights, packet);
+    const auto viewsEndTime = glfwGetTime();
+    {
+      auto text = textManager.beginText(glm::vec2(1, 25), 0.5f);
+      text << "Model Render: " << (updateEndTime - updateStartTime) * 1000 << "ms | GPU: " << gpuTimerManager.getTimeMs("Model Render") << "ms | Depth Pre-Pass (P): " << (isDepthPrePassEnabled ? "On" : "Off") << " | GPU-Driven (I): " << (!windowManager.isGpuDrivenRenderingSupported() ? "Unsupported" : isGpuDrivenRenderingEnabled ? "On" : "Off") << " | Views (1): ";
+      if (!packet.views.empty())
+      {
+        text << packet.views.size() << " (" << (viewsEndTime - viewsStartTime) * 1000 << "ms)";
+      }
+      else
+      {
+        text << "Off";
+      }
+    }
 
     // Update the last start time of the latest rendered frame to the start time of the current frame.
     lastTime = currentTime;
+    // The lights of the packet are only pointed at for the frame.
+    shadedLights.clear();
+  }
+
+  /**
+   * Render the scene with the light shadowmaps and the models, filling the render packet of the frame on the spot.
+   */
+  void render()
+  {
+    // Run the tasks queued for the main thread within their time budget, which may change the scene before it is filled into the
+    //   packet.
+    jobManager.runMainThreadTasks(MAIN_THREAD_TASKS_TIME_BUDGET);
+
+    fillRenderPacket(framePacket);
+    render(framePacket);
   }
 
   /**
@@ -608,5 +3093,15 @@ const float_t RenderManager::ambientFactor = 0.25f;
 const int32_t RenderManager::DISABLE_SHADOW = 1;
 // Initialize the mask value for disabling lighting static variable.
 const int32_t RenderManager::DISABLE_LIGHT = 2;
+// Initialize the ID of the first vertex attribute of the model matrix static variable (matches the location in the shaders).
+const GLuint RenderManager::MODEL_MATRIX_ATTRIBUTE_ID = 3;
+// Initialize the ID of the vertex attribute of the shadow caster mask static variable (matches the location in the shaders).
+const GLuint RenderManager::CASTER_MASK_ATTRIBUTE_ID = 7;
+// Initialize the ID of the vertex attribute of the shadowmap face static variable (matches the location in the shaders).
+const GLuint RenderManager::CASTER_FACE_ATTRIBUTE_ID = 8;
+// Initialize the ID of the vertex attribute of the model light mask static variable (matches the location in the shaders).
+const GLuint RenderManager::MODEL_LIGHT_MASK_ATTRIBUTE_ID = 9;
+// Initialize the ID of the vertex attribute of the model texture layer static variable (matches the location in the shaders).
+const GLuint RenderManager::MODEL_TEXTURE_LAYER_ATTRIBUTE_ID = 10;
 
 #endif
\ No newline at end of file
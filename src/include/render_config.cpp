@@ -0,0 +1,455 @@
+#ifndef INCLUDE_RENDER_CONFIG_CPP
+#define INCLUDE_RENDER_CONFIG_CPP
+
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include "constants.cpp"
+#include "command_line.cpp"
+
+/**
+ * Structure for defining the render settings the engine is started with, read from the render config.
+ */
+struct RenderConfig
+{
+  // The quality preset the other settings started from, which also picks the light limits the render manager starts with.
+  int32_t qualityPreset;
+  // The anti-aliasing mode of the window (a multisampling one), which the scenes start with.
+  int32_t antiAliasingMode;
+  // The shadow filter kernel the model shaders are compiled with first (a ShadowFilterKernel).
+  int32_t shadowFilterKernel;
+  // The shadow techniques of the cone and the point lights (ShadowTechniques).
+  int32_t coneLightShadowTechnique;
+  int32_t pointLightShadowTechnique;
+  // The render passes the render manager starts with.
+  bool isDepthPrePassEnabled;
+  bool isDeferredShadingEnabled;
+  bool isClusteredLightingEnabled;
+  bool isOcclusionCullingEnabled;
+  bool isShadowUpdateAmortized;
+  // Whether the nearby lights casting no shadows are merged into one before they are shaded.
+  bool isLightAggregationEnabled;
+  // Whether the shadow visibility of the lights is evaluated into a half-resolution mask along with the depth pre-pass.
+  bool isShadowMaskEnabled;
+  // Whether the shadow projections of the cone lights are fitted to the models in their range every frame.
+  bool isShadowFittingEnabled;
+  // Whether the shadow mask takes a few rotated taps every frame, accumulated over the frames, instead of the whole kernel.
+  bool isTemporalShadowFilteringEnabled;
+  // The resolutions of the shadowmaps: the shadow atlas of the cone lights, the largest tile a cone light gets in it, and the cube
+  //   map faces of the point lights (in pixels).
+  int32_t coneLightShadowAtlasSize;
+  int32_t coneLightMaxShadowMapSize;
+  int32_t pointLightShadowMapSize;
+  // The bits per shadowmap depth (16 or 24).
+  int32_t shadowMapDepthBits;
+  // The size the shadowmaps of all the lights are expected to take in video memory (in bytes).
+  uint64_t shadowMemoryBudget;
+  // How the resolution of the scene is picked from the framebuffer of the window, whatever its pixel density (a RenderScalePolicy),
+  //   and the scale of the custom policy.
+  int32_t renderScalePolicy;
+  float_t customRenderScale;
+};
+
+/**
+ * A manager class for the render config, read once during the static initialization, before the window and the render
+ *   managers are created with it, so that each machine class can be tuned without rebuilding.
+ * The config is read from the file given by the "--config" option, or else from the default path if there is a file there. It has
+ *   a setting per line given as its name and value (like "shadow-filter poisson16"), the blank lines and the lines starting with
+ *   "#" being skipped. A "preset" line resets all the settings to the ones of the quality preset, so it usually comes first, and the
+ *   lines after it override some of them. A config that cannot be read is reported, and the default preset is used instead.
+ */
+class RenderConfigManager
+{
+private:
+  // Singleton instance of the render config manager.
+  static RenderConfigManager instance;
+
+  // The names of the values of the settings picking from a list, indexed by the values.
+  static constexpr const char *ANTI_ALIASING_NAMES[WINDOW_ANTI_ALIASING_MODES_COUNT] = {"off", "msaa2", "msaa4", "msaa8"};
+  static constexpr const char *SHADOW_FILTER_NAMES[4] = {"1x1", "3x3", "poisson8", "poisson16"};
+  static constexpr const char *SHADOW_TECHNIQUE_NAMES[2] = {"pcf", "vsm"};
+  static constexpr const char *SWITCH_NAMES[2] = {"off", "on"};
+  // The names of the render scale policies other than the custom one, which is given by its scale instead.
+  static constexpr const char *RENDER_SCALE_NAMES[2] = {"native", "logical"};
+
+  // The render config read.
+  RenderConfig config;
+
+  /**
+   * Find the path of the render config, given by the "--config" option.
+   * 
+   * @param isRequired  Whether the option gave the path, so that a missing file is an error.
+   * 
+   * @return The path of the render config.
+   */
+  static std::string findConfigPath(bool &isRequired)
+  {
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i + 1 < arguments.size(); i++)
+    {
+      if (arguments[i] == "--config")
+      {
+        isRequired = true;
+        return arguments[i + 1];
+      }
+    }
+    isRequired = false;
+    return DEFAULT_RENDER_CONFIG_PATH;
+  }
+
+  /**
+   * Check if two names are the same, in any case.
+   * 
+   * @param first   The first name.
+   * @param second  The second name.
+   * 
+   * @return Whether the names are the same.
+   */
+  static bool isSameName(const std::string &first, const std::string &second)
+  {
+    return std::equal(first.begin(), first.end(), second.begin(), second.end(), [](const char &firstChar, const char &secondChar) {
+      return std::tolower(static_cast<unsigned char>(firstChar)) == std::tolower(static_cast<unsigned char>(secondChar));
+    });
+  }
+
+  /**
+   * Find the value of a setting picking from a list by its name (in any case).
+   * 
+   * @param value        The value given in the config.
+   * @param names        The names of the values, indexed by the values.
+   * @param namesCount   The number of values.
+   * @param parsedValue  The value found.
+   * 
+   * @return Whether the value is one of the list.
+   */
+  static bool parseName(const std::string &value, const char *const names[], const int32_t &namesCount, int32_t &parsedValue)
+  {
+    for (int32_t i = 0; i < namesCount; i++)
+    {
+      if (isSameName(value, names[i]))
+      {
+        parsedValue = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Parse a switch setting, given as "on" or "off".
+   * 
+   * @param value        The value given in the config.
+   * @param parsedValue  The value parsed.
+   * 
+   * @return Whether the value is a valid switch.
+   */
+  static bool parseSwitch(const std::string &value, bool &parsedValue)
+  {
+    int32_t switchValue;
+    if (!parseName(value, SWITCH_NAMES, 2, switchValue))
+    {
+      return false;
+    }
+    parsedValue = switchValue == 1;
+    return true;
+  }
+
+  /**
+   * Parse a shadowmap size, which has to be a power of two within the given range.
+   * 
+   * @param value        The value given in the config.
+   * @param minSize      The smallest size allowed.
+   * @param maxSize      The largest size allowed.
+   * @param parsedValue  The size parsed.
+   * 
+   * @return Whether the value is a valid size.
+   */
+  static bool parseShadowMapSize(const std::string &value, const int32_t &minSize, const int32_t &maxSize, int32_t &parsedValue)
+  {
+    int32_t size;
+    if (std::sscanf(value.c_str(), "%d", &size) != 1 || size < minSize || size > maxSize || (size & (size - 1)) != 0)
+    {
+      return false;
+    }
+    parsedValue = size;
+    return true;
+  }
+
+  /**
+   * Parse the render scale setting, given as "native", "logical", or the scale of the custom policy (like "0.75").
+   * 
+   * @param value   The value given in the config.
+   * @param config  The render config to set the policy and the scale in.
+   * 
+   * @return Whether the value is a valid render scale.
+   */
+  static bool parseRenderScale(const std::string &value, RenderConfig &config)
+  {
+    if (parseName(value, RENDER_SCALE_NAMES, 2, config.renderScalePolicy))
+    {
+      return true;
+    }
+    float_t scale;
+    if (std::sscanf(value.c_str(), "%f", &scale) != 1 || scale < DYNAMIC_RESOLUTION_MIN_SCALE || scale > DYNAMIC_RESOLUTION_MAX_SCALE)
+    {
+      return false;
+    }
+    // The custom policy comes after the named ones.
+    config.renderScalePolicy = 2;
+    config.customRenderScale = scale;
+    return true;
+  }
+
+  /**
+   * Read the render config from its file, setting the settings read over the default preset.
+   * 
+   * @param path        The path of the render config.
+   * @param lineNumber  The line of the first invalid setting, or 0 if the file could not be read or its sizes do not fit.
+   * 
+   * @return Whether the file is read and all its settings are valid.
+   */
+  bool loadConfigFile(const std::string &path, int32_t &lineNumber)
+  {
+    std::ifstream stream(path);
+    if (!stream)
+    {
+      return false;
+    }
+    std::string line;
+    for (lineNumber = 1; std::getline(stream, line); lineNumber++)
+    {
+      std::istringstream lineStream(line);
+      std::string name, value;
+      if (!(lineStream >> name) || name[0] == '#')
+      {
+        continue;
+      }
+      if (!(lineStream >> value) || !parseSetting(name, value, config))
+      {
+        return false;
+      }
+    }
+    lineNumber = 0;
+
+    // The largest tile of the cone lights has to fit in their atlas.
+    return config.coneLightMaxShadowMapSize <= config.coneLightShadowAtlasSize;
+  }
+
+  RenderConfigManager()
+      : config(getPresetConfig(DEFAULT_QUALITY_PRESET))
+  {
+    auto isRequired = false;
+    const auto path = findConfigPath(isRequired);
+    if (!isRequired && !std::ifstream(path))
+    {
+      return;
+    }
+
+    auto lineNumber = 0;
+    if (!loadConfigFile(path, lineNumber))
+    {
+      std::cerr << "Failed to read the render config " << path;
+      if (lineNumber > 0)
+      {
+        std::cerr << " (line " << lineNumber << ")";
+      }
+      std::cerr << ", using the " << QUALITY_PRESET_NAMES[DEFAULT_QUALITY_PRESET] << " preset" << std::endl;
+      config = getPresetConfig(DEFAULT_QUALITY_PRESET);
+    }
+  }
+
+public:
+  // Preventing copying the render config manager, making sure only one instance can exist.
+  RenderConfigManager(const RenderConfigManager &) = delete;
+
+  /**
+   * Find the quality preset of the given name (in any case) or index.
+   * 
+   * @param name  The name or the index of the quality preset.
+   * 
+   * @return The index of the quality preset, or -1 if there is none by the name.
+   */
+  static int32_t findQualityPreset(const std::string &name)
+  {
+    for (int32_t i = 0; i < QUALITY_PRESETS_COUNT; i++)
+    {
+      if (name == std::to_string(i) || isSameName(name, QUALITY_PRESET_NAMES[i]))
+      {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /**
+   * Get the settings of a quality preset, before any override.
+   * 
+   * @param qualityPreset  The index of the quality preset.
+   * 
+   * @return The render config of the preset.
+   */
+  static RenderConfig getPresetConfig(const int32_t &qualityPreset)
+  {
+    return {
+        qualityPreset,
+        QUALITY_PRESET_ANTI_ALIASING_MODES[qualityPreset],
+        QUALITY_PRESET_SHADOW_FILTER_KERNELS[qualityPreset],
+        0,
+        0,
+        false,
+        false,
+        true,
+        true,
+        QUALITY_PRESET_SHADOW_UPDATES_AMORTIZED[qualityPreset],
+        true,
+        false,
+        true,
+        false,
+        QUALITY_PRESET_CONE_LIGHT_SHADOW_ATLAS_SIZES[qualityPreset],
+        QUALITY_PRESET_CONE_LIGHT_MAX_SHADOW_MAP_SIZES[qualityPreset],
+        QUALITY_PRESET_POINT_LIGHT_SHADOW_MAP_SIZES[qualityPreset],
+        QUALITY_PRESET_SHADOW_MAP_DEPTH_BITS[qualityPreset],
+        QUALITY_PRESET_SHADOW_MEMORY_BUDGETS[qualityPreset],
+        0,
+        1.0f};
+  }
+
+  /**
+   * Set a setting of the render config from its name and value, as given in the config file.
+   * 
+   * @param name    The name of the setting.
+   * @param value   The value of the setting.
+   * @param config  The render config to set it in.
+   * 
+   * @return Whether the setting is known and its value is valid.
+   */
+  static bool parseSetting(const std::string &name, const std::string &value, RenderConfig &config)
+  {
+    if (name == "preset")
+    {
+      const auto qualityPreset = findQualityPreset(value);
+      if (qualityPreset < 0)
+      {
+        return false;
+      }
+      config = getPresetConfig(qualityPreset);
+      return true;
+    }
+    if (name == "anti-aliasing")
+    {
+      return parseName(value, ANTI_ALIASING_NAMES, WINDOW_ANTI_ALIASING_MODES_COUNT, config.antiAliasingMode);
+    }
+    if (name == "shadow-filter")
+    {
+      return parseName(value, SHADOW_FILTER_NAMES, 4, config.shadowFilterKernel);
+    }
+    if (name == "cone-shadows")
+    {
+      return parseName(value, SHADOW_TECHNIQUE_NAMES, 2, config.coneLightShadowTechnique);
+    }
+    if (name == "point-shadows")
+    {
+      return parseName(value, SHADOW_TECHNIQUE_NAMES, 2, config.pointLightShadowTechnique);
+    }
+    if (name == "depth-pre-pass")
+    {
+      return parseSwitch(value, config.isDepthPrePassEnabled);
+    }
+    if (name == "deferred-shading")
+    {
+      return parseSwitch(value, config.isDeferredShadingEnabled);
+    }
+    if (name == "clustered-lighting")
+    {
+      return parseSwitch(value, config.isClusteredLightingEnabled);
+    }
+    if (name == "occlusion-culling")
+    {
+      return parseSwitch(value, config.isOcclusionCullingEnabled);
+    }
+    if (name == "amortized-shadows")
+    {
+      return parseSwitch(value, config.isShadowUpdateAmortized);
+    }
+    if (name == "light-aggregation")
+    {
+      return parseSwitch(value, config.isLightAggregationEnabled);
+    }
+    if (name == "shadow-mask")
+    {
+      return parseSwitch(value, config.isShadowMaskEnabled);
+    }
+    if (name == "fitted-shadows")
+    {
+      return parseSwitch(value, config.isShadowFittingEnabled);
+    }
+    if (name == "temporal-shadows")
+    {
+      return parseSwitch(value, config.isTemporalShadowFilteringEnabled);
+    }
+    if (name == "render-scale")
+    {
+      return parseRenderScale(value, config);
+    }
+    if (name == "cone-shadow-atlas")
+    {
+      return parseShadowMapSize(value, CONE_LIGHT_MIN_SHADOW_MAP_SIZE, 8192, config.coneLightShadowAtlasSize);
+    }
+    if (name == "cone-shadow-tile")
+    {
+      return parseShadowMapSize(value, CONE_LIGHT_MIN_SHADOW_MAP_SIZE, 8192, config.coneLightMaxShadowMapSize);
+    }
+    if (name == "point-shadow-size")
+    {
+      return parseShadowMapSize(value, 16, 2048, config.pointLightShadowMapSize);
+    }
+    if (name == "shadow-depth-bits")
+    {
+      return std::sscanf(value.c_str(), "%d", &config.shadowMapDepthBits) == 1 && (config.shadowMapDepthBits == 16 || config.shadowMapDepthBits == 24);
+    }
+    if (name == "shadow-memory-budget")
+    {
+      // The budget is given in megabytes.
+      uint32_t budget;
+      if (std::sscanf(value.c_str(), "%u", &budget) != 1)
+      {
+        return false;
+      }
+      config.shadowMemoryBudget = static_cast<uint64_t>(budget) * 1024 * 1024;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Get the render config read, which does not change once the engine is started.
+   * 
+   * @return The render config.
+   */
+  static const RenderConfig &getConfig()
+  {
+    return instance.config;
+  }
+
+  /**
+   * Returns the singleton instance of the render config manager.
+   * 
+   * @return The render config manager singleton instance.
+   */
+  static RenderConfigManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the render config manager singleton instance static variable.
+RenderConfigManager RenderConfigManager::instance;
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef INCLUDE_RENDER_GROUP_CPP
+#define INCLUDE_RENDER_GROUP_CPP
+
+#include <vector>
+#include <memory>
+#include <limits>
+
+#include "flat_hash_map.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for defining the registered models of a model type, which are rendered as the instances of a model group.
+ */
+struct RenderGroup
+{
+  // The ID of the model type of the models.
+  ModelTypeId modelTypeId;
+  // The models, in no particular order.
+  std::vector<std::shared_ptr<ModelBaseIntf>> models;
+};
+
+/**
+ * A manager class for keeping the registered models grouped by their model type, updated as the models are registered and
+ *   de-registered, so that the renderer does not group all the models again every frame.
+ * The models are removed by moving the last model of their group into their slot, so that the groups stay compact without
+ *   shifting the other models.
+ */
+class RenderGroupManager
+{
+private:
+  // Singleton instance of the render group manager.
+  static RenderGroupManager instance;
+
+  // The index of a model type without a group yet.
+  static constexpr uint32_t INVALID_GROUP_INDEX = std::numeric_limits<uint32_t>::max();
+
+  // The groups of the model types, in the order their first models were registered (kept once emptied, for their next models).
+  std::vector<RenderGroup> groups;
+  // The indices of the groups of the model types, by the model type IDs.
+  std::vector<uint32_t> groupIndices;
+  // The slots of the added models in their groups.
+  FlatHashMap<const ModelBaseIntf *, uint32_t> modelSlots;
+  // The number of added models.
+  size_t modelsCount;
+
+  RenderGroupManager()
+      : groups({}),
+        groupIndices({}),
+        modelSlots(),
+        modelsCount(0) {}
+
+public:
+  // Preventing copying the render group manager, making sure only one instance can exist.
+  RenderGroupManager(const RenderGroupManager &) = delete;
+
+  /**
+   * Add a model to the group of its model type, creating the group if it is the first model of the type.
+   * 
+   * @param model  The model to add (ignored if it is added already).
+   */
+  void registerModel(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    if (modelSlots.count(model.get()) != 0)
+    {
+      return;
+    }
+
+    const auto &modelTypeId = model->getModelTypeId();
+    if (modelTypeId >= groupIndices.size())
+    {
+      groupIndices.resize(modelTypeId + 1, INVALID_GROUP_INDEX);
+    }
+    if (groupIndices[modelTypeId] == INVALID_GROUP_INDEX)
+    {
+      groupIndices[modelTypeId] = static_cast<uint32_t>(groups.size());
+      groups.push_back({modelTypeId, {}});
+    }
+
+    auto &groupModels = groups[groupIndices[modelTypeId]].models;
+    modelSlots.emplace(model.get(), static_cast<uint32_t>(groupModels.size()));
+    groupModels.push_back(model);
+    modelsCount++;
+  }
+
+  /**
+   * Remove a model from the group of its model type, moving the last model of the group into its slot.
+   * 
+   * @param model  The model to remove (ignored if it is not added).
+   */
+  void deregisterModel(const ModelBaseIntf *model)
+  {
+    const auto modelSlot = modelSlots.find(model);
+    if (modelSlot == modelSlots.end())
+    {
+      return;
+    }
+
+    auto &groupModels = groups[groupIndices[model->getModelTypeId()]].models;
+    const auto slot = modelSlot->second;
+    modelSlots.erase(modelSlot);
+    if (slot + 1 != groupModels.size())
+    {
+      groupModels[slot] = std::move(groupModels.back());
+      modelSlots.at(groupModels[slot].get()) = slot;
+    }
+    groupModels.pop_back();
+    modelsCount--;
+  }
+
+  /**
+   * Get the groups of the model types, in the order their first models were registered. Some of them may be empty.
+   * 
+   * @return The groups.
+   */
+  const std::vector<RenderGroup> &getGroups() const
+  {
+    return groups;
+  }
+
+  /**
+   * Get the number of models added to the groups.
+   * 
+   * @return The number of models.
+   */
+  const size_t &getModelsCount() const
+  {
+    return modelsCount;
+  }
+
+  /**
+   * Returns the singleton instance of the render group manager.
+   * 
+   * @return The render group manager singleton instance.
+   */
+  static RenderGroupManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the render group manager singleton instance static variable.
+RenderGroupManager RenderGroupManager::instance;
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef INCLUDE_RENDER_PACKET_CPP
+#define INCLUDE_RENDER_PACKET_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "control.cpp"
+#include "frustum.cpp"
+#include "text.cpp"
+#include "gpu_shot_collision.cpp"
+#include "picking.cpp"
+#include "visibility.cpp"
+#include "../light/light_base.cpp"
+#include "../camera/camera_base.cpp"
+#include "../models/model_base.cpp"
+
+/**
+ * Structure for defining a group of models of the same type, drawn together with a single instanced draw call.
+ */
+struct ModelGroup
+{
+  // The first model of the group. All the models of a group share its object, texture and shader.
+  const std::shared_ptr<ModelBaseIntf> model;
+  // The index of the model matrix of the first model of the group in the model matrix buffer.
+  const uint32_t instanceOffset;
+  // The number of models in the group.
+  const uint32_t instanceCount;
+  // The number of models in the group inside the view frustum of the active camera and not hidden by the depth of the last frames
+  //   (stored before the culled ones).
+  const uint32_t visibleInstanceCount;
+  // The distance of the visible model of the group closest to the active camera.
+  const float_t viewDepth;
+  // The number of the models drawn with each level of detail of the object, stored one level after the other from the first
+  //   model of the group.
+  const std::array<uint32_t, OBJECT_LOD_COUNT> lodInstanceCounts;
+  // The number of the models at the end of the coarsest level of detail far enough to be drawn as impostors instead, by the passes
+  //   drawing the impostors (the other passes drawing them with the coarsest level).
+  const uint32_t impostorInstanceCount;
+};
+
+/**
+ * Structure for defining the state of the active camera in a render packet.
+ */
+struct RenderCameraState
+{
+  // The position of the camera.
+  glm::vec3 position;
+  // The matrices of the camera, along with its view frustum.
+  CameraMatrices matrices;
+  // The index of the view of the camera in the visibility of the frame.
+  uint32_t visibilityView;
+};
+
+/**
+ * Structure for defining an additional view of the scene in a render packet (e.g. a rear camera shown picture-in-picture), drawn
+ *   into its own part of the render target of the scene with the shadowmaps of the frame.
+ */
+struct RenderViewState
+{
+  // The state of the camera of the view.
+  RenderCameraState camera;
+  // The part of the render target the view is drawn into, as its bottom-left corner followed by its width and height (as shares of
+  //   the size of the render target).
+  glm::vec4 viewportRect;
+  // The models inside the view frustum of the camera grouped by model type, in the same order as the model groups of the frame.
+  std::vector<ModelGroup> modelGroups;
+  // The model matrices of the models of the view, grouped by model type.
+  std::vector<glm::mat4> modelMatrices;
+  // The transforms of the models of the view, in the same order as their model matrices.
+  std::vector<TransformHandle> groupedTransformHandles;
+  // The corners of the world AABBs of the models of the view with the smallest and largest coordinates, in the same order as their
+  //   model matrices.
+  std::vector<glm::vec3> groupedMinCorners;
+  std::vector<glm::vec3> groupedMaxCorners;
+  // The projected sizes of the models of the view, in the same order as their model matrices.
+  std::vector<float_t> groupedScreenSizes;
+};
+
+/**
+ * Structure for defining the state of a light in a render packet, copied from the light so that it can be moved while the
+ *   packet is being rendered.
+ */
+struct RenderLightState
+{
+  // The light, only used for its shader and shadow buffer, which belong to the render side.
+  std::shared_ptr<LightBase> light;
+  // The name of the light type.
+  std::string lightName;
+  // The position of the light.
+  glm::vec3 lightPosition;
+  // The color of the light.
+  glm::vec3 lightColor;
+  // The intensity of the light.
+  float_t lightIntensity;
+  // The closest distance from which the shadowmap captures objects.
+  float_t nearPlane;
+  // The farthest distance till which the shadowmap captures objects.
+  float_t farPlane;
+  // The projection-view matrices of the faces of the shadowmap of the light (only the first faces count are used).
+  std::array<glm::mat4, 6> vpMatrices;
+  // The number of faces of the shadowmap of the light.
+  uint32_t facesCount;
+  // The version of the details of the light its shadowmap depends on.
+  uint64_t shadowVersion;
+  // The index of the view of the first face of the shadowmap in the visibility of the frame, followed by the views of the other
+  //   faces (only set for the lights casting shadows).
+  uint32_t visibilityView;
+};
+
+/**
+ * Structure for defining everything needed to render a frame, filled by the simulation and only read while rendering, so that
+ *   the frame can be rendered on another thread while the next one is simulated.
+ */
+struct RenderPacket
+{
+  // The index of the frame the packet was filled for.
+  uint64_t frameIndex;
+  // The state of the keys and mouse buttons when the frame started.
+  InputSnapshot input;
+  // The time the input of the frame was sampled at (in seconds), for the latency from it until the frame is presented.
+  double_t inputSampleTime;
+  // The interval for swapping buffers the frame is presented with.
+  int32_t swapInterval;
+  // Whether the text of the frame is rendered.
+  bool isTextEnabled;
+  // The times of the last frames for the frame time graph drawn with the text, from the oldest to the newest (in milliseconds).
+  std::array<float_t, FRAME_TIME_HISTORY_SIZE> frameTimes;
+  // The number of frame times of the frame time graph.
+  size_t frameTimesCount;
+
+  // The state of the active camera.
+  RenderCameraState camera;
+  // The time the spinning models are animated to (in seconds).
+  float_t animationTime;
+  // The lights reaching the view, from the most important to the least important.
+  std::vector<RenderLightState> lights;
+  // The number of registered lights, including the ones not reaching the view.
+  uint32_t registeredLightsCount;
+  // The number of lights merged into the other lights of the frame by the light aggregation.
+  uint32_t mergedLightsCount;
+  // Whether any shadow casters flagged as static are registered, so that their shadows are cached.
+  bool hasStaticCasters;
+
+  // The models of the scene grouped by model type, in the order the first model of each type was registered.
+  std::vector<ModelGroup> modelGroups;
+  // The model matrices of all the models, grouped by model type.
+  std::vector<glm::mat4> modelMatrices;
+  // The models of all the model groups, in the same order as their model matrices.
+  std::vector<std::shared_ptr<ModelBaseIntf>> groupedModels;
+  // The transform versions of all the grouped models, in the same order as their model matrices.
+  std::vector<uint64_t> groupedTransformVersions;
+  // The transforms of all the grouped models, in the same order as their model matrices.
+  std::vector<TransformHandle> groupedTransformHandles;
+  // The corners of the world AABBs of all the grouped models with the smallest and largest coordinates, in the same order as
+  //   their model matrices.
+  std::vector<glm::vec3> groupedMinCorners;
+  std::vector<glm::vec3> groupedMaxCorners;
+  // The projected sizes of all the grouped models in the view of the active camera (the diameter of their world AABB as a share
+  //   of the height of the view), in the same order as their model matrices.
+  std::vector<float_t> groupedScreenSizes;
+  // Whether each of the grouped models is hidden behind the depth of the last frames, as bytes, in the same order as their model
+  //   matrices.
+  std::vector<uint8_t> groupedOcclusions;
+  // The number of models inside the view frustum of the active camera hidden behind the depth of the last frames.
+  uint32_t occludedModelsCount;
+  // The additional views of the scene, drawn over the view of the active camera.
+  std::vector<RenderViewState> views;
+  // The models visible to the camera, the additional views and the shadowmap faces of the frame.
+  FrameVisibility visibility;
+
+  // The shots and the enemies to test against each other on the GPU.
+  GpuShotCollisionBatch shotCollisionBatch;
+  // The pick of the model under a point of the screen requested for the frame (0 as its ID if there is none).
+  PickRequest pickRequest;
+  // Whether the lowest render layers are drawn from the layer cache, as asked for by the scene.
+  bool isLayerCacheEnabled;
+
+  // The text of the frame, in the text arena it was formatted into.
+  TextArena textArena;
+
+  /**
+   * Let go of the models, lights and text lines the packet holds, keeping the storage for the next frame. Done on the thread
+   *   owning the GL context, so that the models and lights last held by the packet release their GL resources there.
+   */
+  void releaseReferences()
+  {
+    lights.clear();
+    modelGroups.clear();
+    groupedModels.clear();
+    for (auto &view : views)
+    {
+      view.modelGroups.clear();
+    }
+    textArena.reset();
+  }
+};
+
+/**
+ * Class for passing the render packets from the thread filling them to the thread rendering them, through a ring of packets
+ *   so that the filling thread can work on the next frame while the last one is rendered.
+ */
+class RenderPacketRing
+{
+private:
+  // The packets of the ring, filled and rendered in turn.
+  std::array<RenderPacket, RENDER_PACKET_RING_SIZE> packets;
+  // The mutex guarding the counters of the ring.
+  std::mutex ringMutex;
+  // The condition notified whenever a packet is filled or rendered, or the ring is closed.
+  std::condition_variable ringCondition;
+  // The number of packets filled so far.
+  uint64_t writtenCount;
+  // The number of packets rendered so far.
+  uint64_t readCount;
+  // Whether the ring was closed, which lets the rendering thread finish once the filled packets are rendered.
+  bool isClosed;
+
+public:
+  RenderPacketRing()
+      : packets(),
+        ringMutex(),
+        ringCondition(),
+        writtenCount(0),
+        readCount(0),
+        isClosed(false) {}
+
+  // Preventing copying the ring, since the threads refer to its packets.
+  RenderPacketRing(const RenderPacketRing &) = delete;
+
+  /**
+   * Get the next packet to fill, waiting for the rendering thread if all the packets are still waiting to be rendered.
+   * 
+   * @return The packet to fill, to be passed on with endWrite().
+   */
+  RenderPacket &beginWrite()
+  {
+    std::unique_lock<std::mutex> lock(ringMutex);
+    ringCondition.wait(lock, [this]() { return writtenCount - readCount < RENDER_PACKET_RING_SIZE; });
+    auto &packet = packets[writtenCount % RENDER_PACKET_RING_SIZE];
+    packet.frameIndex = writtenCount;
+    return packet;
+  }
+
+  /**
+   * Pass the packet got from beginWrite() on to the rendering thread.
+   */
+  void endWrite()
+  {
+    {
+      const std::lock_guard<std::mutex> lock(ringMutex);
+      writtenCount++;
+    }
+    ringCondition.notify_all();
+  }
+
+  /**
+   * Get the next packet to render, waiting for the filling thread if there is none.
+   * 
+   * @return The packet to render, to be given back with endRead(), or null if the ring was closed and all the packets rendered.
+   */
+  const RenderPacket *beginRead()
+  {
+    std::unique_lock<std::mutex> lock(ringMutex);
+    ringCondition.wait(lock, [this]() { return writtenCount > readCount || isClosed; });
+    return writtenCount > readCount ? &packets[readCount % RENDER_PACKET_RING_SIZE] : nullptr;
+  }
+
+  /**
+   * Give the packet got from beginRead() back to be filled again, letting go of what it holds first.
+   */
+  void endRead()
+  {
+    packets[readCount % RENDER_PACKET_RING_SIZE].releaseReferences();
+    {
+      const std::lock_guard<std::mutex> lock(ringMutex);
+      readCount++;
+    }
+    ringCondition.notify_all();
+  }
+
+  /**
+   * Close the ring, so that the rendering thread stops once it rendered the packets filled so far.
+   */
+  void close()
+  {
+    {
+      const std::lock_guard<std::mutex> lock(ringMutex);
+      isClosed = true;
+    }
+    ringCondition.notify_all();
+  }
+};
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef INCLUDE_RENDER_QUEUE_CPP
+#define INCLUDE_RENDER_QUEUE_CPP
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+/**
+ * Structure for defining an item of the render queue.
+ */
+struct RenderQueueItem
+{
+  // The key the item is sorted by, packing the GPU state the item uses.
+  uint64_t sortKey;
+  // The index of the item in the list of things to draw.
+  uint32_t itemIndex;
+};
+
+/**
+ * Class for sorting draws by the GPU state they use, so that draws sharing state are issued one after the other.
+ */
+class RenderQueue
+{
+private:
+  // The number of bits used for sorting in each pass of the radix sort.
+  const static uint32_t RADIX_BITS;
+  // The number of buckets used in each pass of the radix sort.
+  const static uint32_t RADIX_BUCKETS;
+
+  // The items in the queue.
+  std::vector<RenderQueueItem> items;
+  // A buffer of the same size as the items, used to store the output of each radix sort pass.
+  std::vector<RenderQueueItem> sortBuffer;
+  // The offset of the next item of each bucket in each radix sort pass.
+  std::vector<uint32_t> bucketOffsets;
+
+  /**
+   * Quantize the given view depth to 16 bits, keeping the order of the depths.
+   * 
+   * @param depth  The view depth (must not be negative).
+   * 
+   * @return The quantized depth.
+   */
+  static uint64_t quantizeDepth(const float_t &depth)
+  {
+    // The bits of a non-negative float have the same order as the float itself, so keep the top 16 bits of it.
+    uint32_t depthBits;
+    const float_t clampedDepth = depth > 0.0f ? depth : 0.0f;
+    std::memcpy(&depthBits, &clampedDepth, sizeof(depthBits));
+    return depthBits >> 16;
+  }
+
+public:
+  /**
+   * Create the sort key of a draw.
+   * Draws are sorted by their render layer first, so that higher layers are always drawn after lower ones.
+   * Opaque draws are grouped by shader, then texture, then object, with the nearest drawn first.
+   * Blended draws are sorted by depth first so that the farthest is drawn first, with the state as the tie-breaker.
+   * Opaque draws tested against the depth of the others (e.g. behind occlusion queries) can be drawn after the others of their layer.
+   * 
+   * @param shaderId     The ID of the shader program the draw uses.
+   * @param textureId    The ID of the texture the draw uses.
+   * @param objectId     The ID of the vertex buffer of the object the draw uses.
+   * @param depth        The distance of the draw from the camera.
+   * @param isBlended    Whether the draw is blended with what was drawn before it.
+   * @param renderLayer  The layer the draw is in (only the lowest 4 bits are used).
+   * @param isDrawnLast  Whether the opaque draw is drawn after the other opaque draws of its layer (ignored for blended draws).
+   * 
+   * @return The sort key of the draw.
+   */
+  static uint64_t createSortKey(const GLuint &shaderId, const GLuint &textureId, const GLuint &objectId, const float_t &depth, const bool &isBlended, const uint32_t &renderLayer, const bool &isDrawnLast)
+  {
+    // Pack the shader ID into 11 bits and the other state IDs into 16 bits each (IDs that overflow only make the grouping less
+    //   effective), leaving the bit above the shader ID for the opaque draws drawn last.
+    const uint64_t stateKey = ((static_cast<uint64_t>(shaderId) & 0x7FF) << 32) | ((static_cast<uint64_t>(textureId) & 0xFFFF) << 16) | (static_cast<uint64_t>(objectId) & 0xFFFF);
+    const uint64_t depthKey = quantizeDepth(depth);
+    // The render layer takes the 4 most significant bits.
+    const uint64_t layerKey = static_cast<uint64_t>(renderLayer & 0xF) << 60;
+
+    // Blended draws must be drawn back to front, so the inverted depth takes the most significant bits after the layer.
+    if (isBlended)
+    {
+      return layerKey | ((0xFFFF - depthKey) << 44) | stateKey;
+    }
+
+    // Opaque draws are drawn front to back within the same state, to reject hidden fragments early.
+    const uint64_t lastKey = isDrawnLast ? static_cast<uint64_t>(1) << 59 : 0;
+    return layerKey | lastKey | (stateKey << 16) | depthKey;
+  }
+
+  /**
+   * Remove all the items from the queue.
+   */
+  void clear()
+  {
+    items.clear();
+  }
+
+  /**
+   * Add an item to the queue.
+   * 
+   * @param sortKey    The key the item is sorted by.
+   * @param itemIndex  The index of the item in the list of things to draw.
+   */
+  void push(const uint64_t &sortKey, const uint32_t &itemIndex)
+  {
+    items.push_back({sortKey, itemIndex});
+  }
+
+  /**
+   * Get the items in the queue, in the order of the last sort if nothing was pushed since.
+   * 
+   * @return The items.
+   */
+  const std::vector<RenderQueueItem> &getItems() const
+  {
+    return items;
+  }
+
+  /**
+   * Sort the items in the queue by their sort key with a least significant digit radix sort.
+   * 
+   * @return The sorted items.
+   */
+  const std::vector<RenderQueueItem> &sort()
+  {
+    sortBuffer.resize(items.size());
+    bucketOffsets.resize(RADIX_BUCKETS);
+
+    // Iterate through the digits of the key, from the least significant to the most significant.
+    for (uint32_t shift = 0; shift < 64; shift += RADIX_BITS)
+    {
+      // Count the number of items in each bucket.
+      std::fill(bucketOffsets.begin(), bucketOffsets.end(), 0);
+      for (const auto &item : items)
+      {
+        bucketOffsets[(item.sortKey >> shift) & (RADIX_BUCKETS - 1)]++;
+      }
+
+      // Skip the pass if all the items fall into the same bucket, since it would not change the order.
+      if (!items.empty() && bucketOffsets[(items.front().sortKey >> shift) & (RADIX_BUCKETS - 1)] == items.size())
+      {
+        continue;
+      }
+
+      // Convert the counts into the offset of the first item of each bucket.
+      uint32_t offset = 0;
+      for (auto &bucketOffset : bucketOffsets)
+      {
+        const auto count = bucketOffset;
+        bucketOffset = offset;
+        offset += count;
+      }
+
+      // Scatter the items into their buckets, keeping the order of items in the same bucket.
+      for (const auto &item : items)
+      {
+        sortBuffer[bucketOffsets[(item.sortKey >> shift) & (RADIX_BUCKETS - 1)]++] = item;
+      }
+      items.swap(sortBuffer);
+    }
+
+    // Return the sorted items.
+    return items;
+  }
+};
+
+// Initialize the number of bits used in each radix sort pass static variable.
+const uint32_t RenderQueue::RADIX_BITS = 8;
+// Initialize the number of buckets used in each radix sort pass static variable.
+const uint32_t RenderQueue::RADIX_BUCKETS = 1 << RenderQueue::RADIX_BITS;
+
+#endif
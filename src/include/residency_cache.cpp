@@ -0,0 +1,102 @@
+#ifndef INCLUDE_RESIDENCY_CACHE_CPP
+#define INCLUDE_RESIDENCY_CACHE_CPP
+
+#include <string>
+#include <map>
+#include <list>
+#include <vector>
+
+/**
+ * Class for keeping the resources that are no longer referenced alive, so that they can be reused when they are created again
+ *   (e.g. by the next scene). The least recently released resources are evicted first once the sizes go over the budget.
+ * Only tracks the names and sizes, leaving the deletion of the evicted resources to the owning manager.
+ */
+class ResidencyCache
+{
+private:
+  // The total size the released resources can take before being evicted.
+  const uint64_t budget;
+
+  // The names of the released resources, from the most recently released to the least recently released.
+  std::list<std::string> releasedNames;
+  // The position in the released names list and the size of each released resource.
+  std::map<const std::string, std::pair<std::list<std::string>::iterator, uint64_t>> releasedResources;
+  // The total size of the released resources.
+  uint64_t releasedSize;
+
+public:
+  /**
+   * Create a new residency cache with the given budget.
+   * 
+   * @param budget  The total size the released resources can take (in the units used by release).
+   */
+  ResidencyCache(const uint64_t &budget)
+      : budget(budget),
+        releasedNames({}),
+        releasedResources({}),
+        releasedSize(0) {}
+
+  // Preventing copying the residency cache, since the iterators point into its own list.
+  ResidencyCache(const ResidencyCache &) = delete;
+
+  /**
+   * Take a resource that is referenced again out of the cache, so that it cannot be evicted.
+   * 
+   * @param name  The name of the resource.
+   * 
+   * @return Whether the resource was in the cache or not.
+   */
+  bool acquire(const std::string &name)
+  {
+    const auto releasedResource = releasedResources.find(name);
+    if (releasedResource == releasedResources.end())
+    {
+      return false;
+    }
+
+    releasedSize -= releasedResource->second.second;
+    releasedNames.erase(releasedResource->second.first);
+    releasedResources.erase(releasedResource);
+    return true;
+  }
+
+  /**
+   * Put a resource that is no longer referenced into the cache, evicting the least recently released resources that do not fit the budget.
+   * 
+   * @param name  The name of the resource.
+   * @param size  The size of the resource.
+   * 
+   * @return The names of the evicted resources, which should be deleted (can include the released resource itself if it is larger than the budget).
+   */
+  std::vector<std::string> release(const std::string &name, const uint64_t &size)
+  {
+    // Add the resource as the most recently released.
+    acquire(name);
+    releasedNames.push_front(name);
+    releasedResources.emplace(name, std::make_pair(releasedNames.begin(), size));
+    releasedSize += size;
+
+    // Evict from the least recently released until the rest fit the budget.
+    std::vector<std::string> evictedNames;
+    while (releasedSize > budget)
+    {
+      const auto evictedName = releasedNames.back();
+      acquire(evictedName);
+      evictedNames.push_back(evictedName);
+    }
+
+    return evictedNames;
+  }
+
+  /**
+   * Get the total size of the resources in the cache.
+   * 
+   * @return The total size of the released resources.
+   */
+  const uint64_t &getReleasedSize() const
+  {
+    return releasedSize;
+  }
+};
+
+#endif
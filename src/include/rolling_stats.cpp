@@ -0,0 +1,157 @@
+#ifndef INCLUDE_ROLLING_STATS_CPP
+#define INCLUDE_ROLLING_STATS_CPP
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+#include "text_arena.cpp"
+
+/**
+ * Structure for defining the statistics of the values kept by rolling statistics.
+ */
+struct RollingStatsSummary
+{
+  // The number of values the statistics are taken over.
+  size_t count;
+  // The mean of the values.
+  double_t mean;
+  // The median, the 95th and the 99th percentiles of the values (the smallest value that many percent of the values are at most).
+  double_t p50;
+  double_t p95;
+  double_t p99;
+  // The largest of the values.
+  double_t max;
+};
+
+/**
+ * Compute the statistics of values sorted from the smallest to the largest.
+ * 
+ * @param sortedValues  The values, sorted.
+ * @param valuesCount   The number of values.
+ * @param valuesSum     The sum of the values.
+ * 
+ * @return The statistics, all 0 if there are no values.
+ */
+inline RollingStatsSummary getSortedValuesSummary(const double_t *sortedValues, const size_t &valuesCount, const double_t &valuesSum)
+{
+  if (valuesCount == 0)
+  {
+    return {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  }
+
+  // Take the percentiles by the nearest rank, so that they are always one of the values.
+  const auto getPercentile = [sortedValues, &valuesCount](const double_t &percent) {
+    const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * valuesCount));
+    return sortedValues[std::max<size_t>(rank, 1) - 1];
+  };
+  return {valuesCount, valuesSum / valuesCount, getPercentile(50.0), getPercentile(95.0), getPercentile(99.0), sortedValues[valuesCount - 1]};
+}
+
+/**
+ * A class for keeping the statistics of the last values of a timing (e.g. the frame times, or the time of a zone of the CPU
+ *   profiler each frame), where the percentiles show the spikes that the mean and the last value hide.
+ * 
+ * @tparam N  The number of values the statistics are taken over.
+ */
+template <size_t N>
+class RollingStats
+{
+private:
+  // The last values, as a ring.
+  std::array<double_t, N> values;
+  // The number of values stored in the ring.
+  size_t valuesCount;
+  // The index of the ring the next value is stored at.
+  size_t nextValueIndex;
+  // The values sorted for finding the percentiles (kept around to avoid allocating them each time).
+  mutable std::array<double_t, N> sortedValues;
+
+public:
+  RollingStats()
+      : values({}),
+        valuesCount(0),
+        nextValueIndex(0),
+        sortedValues({}) {}
+
+  /**
+   * Forget all the values.
+   */
+  void reset()
+  {
+    valuesCount = 0;
+    nextValueIndex = 0;
+  }
+
+  /**
+   * Add a value, replacing the oldest one once the ring is full.
+   * 
+   * @param value  The value.
+   */
+  void add(const double_t &value)
+  {
+    values[nextValueIndex] = value;
+    nextValueIndex = (nextValueIndex + 1) % N;
+    valuesCount = std::min(valuesCount + 1, N);
+  }
+
+  /**
+   * Get the number of values stored.
+   * 
+   * @return The number of values.
+   */
+  const size_t &getCount() const
+  {
+    return valuesCount;
+  }
+
+  /**
+   * Copy the stored values from the oldest to the newest, e.g. for drawing them as a graph.
+   * 
+   * @param copiedValues  The array to copy the values into, which must hold N values.
+   * 
+   * @return The number of values copied.
+   */
+  template <typename T>
+  size_t copyValues(T *copiedValues) const
+  {
+    const auto oldestValueIndex = (nextValueIndex + N - valuesCount) % N;
+    for (size_t i = 0; i < valuesCount; i++)
+    {
+      copiedValues[i] = static_cast<T>(values[(oldestValueIndex + i) % N]);
+    }
+    return valuesCount;
+  }
+
+  /**
+   * Compute the statistics of the stored values.
+   * 
+   * @return The statistics, all 0 if no value is stored.
+   */
+  RollingStatsSummary getSummary() const
+  {
+    auto valuesSum = 0.0;
+    for (size_t i = 0; i < valuesCount; i++)
+    {
+      valuesSum += values[i];
+      sortedValues[i] = values[i];
+    }
+    std::sort(sortedValues.begin(), sortedValues.begin() + valuesCount);
+
+    return getSortedValuesSummary(sortedValues.data(), valuesCount, valuesSum);
+  }
+
+  /**
+   * Write the statistics of the stored values as text.
+   * 
+   * @param text  The writer of the text, written the mean, the median, the 95th and 99th percentiles and the maximum (in
+   *   milliseconds).
+   */
+  void writeSummary(TextWriter &text) const
+  {
+    const auto summary = getSummary();
+    text << "Mean: " << summary.mean << "ms | p50: " << summary.p50 << "ms | p95: " << summary.p95 << "ms | p99: " << summary.p99 << "ms | Max: " << summary.max << "ms";
+  }
+};
+
+#endif
@@ -20,6 +20,15 @@
 #include "shader.cpp"
 #include "collider.cpp"
 #include "text.cpp"
+#include "control.cpp"
+#include "scene_loader.cpp"
+#include "scene_preloader.cpp"
+#include "registry.cpp"
+#include "frame_pacer.cpp"
+#include "profiler.cpp"
+#include "trace_capture.cpp"
+#include "startup_timer.cpp"
+#include "scene_memory.cpp"
 #include "../scenes/scene_base.cpp"
 
 /**
@@ -31,11 +40,31 @@ private:
   // Singleton instance of the scene manager.
   static SceneManager instance;
 
-  std::string activeSceneId;
-  // The map of registered scenes.
-  std::map<const std::string, std::shared_ptr<SceneBase>> registeredScenes;
+  // The control manager responsible for polling the window events while a scene loads.
+  ControlManager &controlManager;
+  // The scene loader responsible for running the loading steps of the scenes.
+  SceneLoader &sceneLoader;
+  // The startup timer, ended by the loading of the first scene.
+  StartupTimer &startupTimer;
+  // The scene preloader holding the assets loaded for the likely-next scene.
+  ScenePreloader &scenePreloader;
+  // The scene memory manager holding the arena the managers allocate from while a scene is loaded.
+  SceneMemoryManager &sceneMemoryManager;
+  // The trace capture manager watching the frames of the scenes for hitches.
+  TraceCaptureManager &traceCaptureManager;
 
-  SceneManager() : registeredScenes({}) {}
+  std::string activeSceneId;
+  // The registered scenes, in their registration order.
+  Registry<SceneBase> registeredScenes;
+
+  SceneManager()
+      : controlManager(ControlManager::getInstance()),
+        sceneLoader(SceneLoader::getInstance()),
+        startupTimer(StartupTimer::getInstance()),
+        scenePreloader(ScenePreloader::getInstance()),
+        sceneMemoryManager(SceneMemoryManager::getInstance()),
+        traceCaptureManager(TraceCaptureManager::getInstance()),
+        registeredScenes() {}
 
 public:
   // Preventing copying the scene manager, making sure only one instance can exist.
@@ -48,8 +77,8 @@ public:
    */
   void registerScene(const std::shared_ptr<SceneBase> &&scene)
   {
-    // Insert the scene to the map of registered scenes.
-    registeredScenes.emplace(scene->getSceneId(), std::move(scene));
+    // Add the scene to the registered scenes.
+    registeredScenes.add(scene->getSceneId(), scene);
   }
 
   /**
@@ -70,14 +99,14 @@ public:
   void deregisterScene(const std::string &sceneId)
   {
     // Check if scene actually exists. If not, just return since it's not registered.
-    if (registeredScenes.find(sceneId) == registeredScenes.end())
+    if (!registeredScenes.contains(sceneId))
     {
       return;
     }
 
     // Get the scene that is registered with the given scene ID.
-    auto scene = registeredScenes[sceneId];
-    // Remove the scene from the map of registered scenes.
+    const auto scene = registeredScenes.get(sceneId);
+    // Remove the scene from the registered scenes.
     deregisterScene(scene);
   }
 
@@ -88,8 +117,8 @@ public:
    */
   void deregisterScene(const std::shared_ptr<SceneBase> &scene)
   {
-    // Remove the scene from the map of registered scenes.
-    registeredScenes.erase(scene->getSceneId());
+    // Remove the scene from the registered scenes.
+    registeredScenes.remove(scene->getSceneId());
   }
 
   /**
@@ -101,26 +130,17 @@ public:
    */
   const std::shared_ptr<SceneBase> &getScene(const std::string &sceneId) const
   {
-    return registeredScenes.at(sceneId);
+    return registeredScenes.get(sceneId);
   }
 
   /**
-   * Return the list of all scenes registered with the scene manager.
+   * Return a view over all the scenes registered with the scene manager, in their registration order.
    * 
-   * @return The list of all registered scenes.
+   * @return The view over the registered scenes.
    */
-  const std::vector<std::shared_ptr<SceneBase>> getAllScenes() const
+  Registry<SceneBase>::View getAllScenes() const
   {
-    // Define a vector to store the list of registered scenes.
-    std::vector<std::shared_ptr<SceneBase>> scenes({});
-    // Iterate through the map of registered scenes.
-    for (const auto &scene : registeredScenes)
-    {
-      // Push each registered scene into the scenes list.
-      scenes.push_back(scene.second);
-    }
-    // Return the list of registered scenes.
-    return scenes;
+    return registeredScenes.getView();
   }
 
   /**
@@ -130,15 +150,49 @@ public:
    */
   bool executeActiveScene()
   {
-    const auto activeScene = registeredScenes.find(activeSceneId);
-    if (activeScene == registeredScenes.end())
+    if (!registeredScenes.contains(activeSceneId))
     {
       return false;
     }
+    const auto activeScene = registeredScenes.get(activeSceneId);
 
-    activeScene->second->init();
-    const auto nextSceneId = activeScene->second->execute();
-    activeScene->second->deinit();
+    // Queue the loading steps of the scene, and keep rendering loading frames until they are all finished. Everything the
+    //   managers register for the scene goes into the arena of the scene.
+    sceneMemoryManager.beginScene();
+    {
+      STARTUP_PHASE("Scene Init", activeSceneId);
+      activeScene->init();
+    }
+    while (!sceneLoader.update())
+    {
+      activeScene->renderLoadingFrame(sceneLoader.getProgress());
+      controlManager.pollEvents();
+    }
+    activeScene->renderLoadingFrame(1.0f);
+    // Poll once more, so that the keys and mouse buttons that went down in the last scene are not reported to this one.
+    controlManager.pollEvents();
+    // The first frame of the first scene loaded ends the startup.
+    startupTimer.recordSceneLoaded(activeSceneId);
+    traceCaptureManager.restartHitchWatch();
+
+    // The scene holds its own references on the assets preloaded and retained for it, so release the ones of the preloader, and
+    //   start preloading the scene likely to follow this one while it runs.
+    scenePreloader.releasePreloadedAssets();
+    const auto likelyNextSceneId = activeScene->getLikelyNextSceneId();
+    if (likelyNextSceneId.has_value() && registeredScenes.contains(likelyNextSceneId.value()))
+    {
+      registeredScenes.get(likelyNextSceneId.value())->preload();
+    }
+
+    const auto nextSceneId = activeScene->execute();
+    // Keep the assets the next scene shares with this one, so that de-initializing this one only unloads the assets that differ.
+    if (nextSceneId.has_value() && registeredScenes.contains(nextSceneId.value()))
+    {
+      registeredScenes.get(nextSceneId.value())->retainSharedAssets();
+    }
+    activeScene->deinit();
+    // Free the arena of the scene at once, now that the scene has de-registered everything it registered.
+    sceneMemoryManager.endScene();
     if (!nextSceneId.has_value())
     {
       return false;
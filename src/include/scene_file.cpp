@@ -0,0 +1,519 @@
+#ifndef INCLUDE_SCENE_FILE_CPP
+#define INCLUDE_SCENE_FILE_CPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <glm/glm.hpp>
+
+#include "asset_archive.cpp"
+#include "asset_manifest.cpp"
+
+/**
+ * An enum for the kinds of lights a scene file can place.
+ */
+enum class SceneLightType : uint32_t
+{
+  POINT,
+  CONE
+};
+
+/**
+ * An enum for the kinds of cameras a scene file can place.
+ */
+enum class SceneCameraType : uint32_t
+{
+  PERSPECTIVE,
+  ORTHOGRAPHIC
+};
+
+/**
+ * Structure for defining the instances of a model type placed by a scene file, with their transformations in one array per
+ *   value so that they are copied in bulk.
+ */
+struct SceneModelGroup
+{
+  // The name of the model type, which the scene creates the instances with.
+  std::string modelType;
+  // The prefix of the IDs of the instances, followed by their index in the group.
+  std::string modelIdPrefix;
+  // The positions of the instances.
+  std::vector<glm::vec3> positions;
+  // The rotations of the instances (in radians), or none to keep the rotation the models are created with.
+  std::vector<glm::vec3> rotations;
+  // The scales of the instances, or none to keep the scale the models are created with.
+  std::vector<glm::vec3> scales;
+};
+
+/**
+ * Structure for defining a light placed by a scene file.
+ */
+struct SceneLight
+{
+  // The ID of the light.
+  std::string lightId;
+  // The kind of the light.
+  SceneLightType type;
+  // The position of the light.
+  glm::vec3 position;
+  // The horizontal and vertical angles the light points at (in radians, only used by the cone lights).
+  glm::vec2 angles;
+  // The intensity of the light.
+  float_t intensity;
+};
+
+/**
+ * Structure for defining a camera placed by a scene file.
+ */
+struct SceneCamera
+{
+  // The ID of the camera.
+  std::string cameraId;
+  // The kind of the camera.
+  SceneCameraType type;
+  // The position of the camera.
+  glm::vec3 position;
+  // The horizontal and vertical angles the camera looks at (in radians).
+  glm::vec2 angles;
+};
+
+/**
+ * Structure for defining the contents of a scene file.
+ */
+struct SceneDescription
+{
+  // The groups of model instances, in the order they are created.
+  std::vector<SceneModelGroup> modelGroups;
+  // The lights, in the order they are registered.
+  std::vector<SceneLight> lights;
+  // The cameras, the first of them being the active one.
+  std::vector<SceneCamera> cameras;
+};
+
+/**
+ * Structure for defining the header a binary scene file starts with, followed by the records of its model groups, lights and
+ *   cameras, the names they point to, and the transformations of the instances of each model group in turn (the positions, then
+ *   the rotations and the scales if the group has them).
+ */
+struct SceneFileHeader
+{
+  // The magic number identifying binary scene files, and the version of their layout.
+  uint32_t magic;
+  uint32_t version;
+  // The number of records of each kind.
+  uint32_t modelGroupsCount;
+  uint32_t lightsCount;
+  uint32_t camerasCount;
+  // The size of the names in bytes.
+  uint32_t namesSize;
+};
+
+/**
+ * Structure for defining the record of a model group in a binary scene file.
+ */
+struct SceneFileModelGroup
+{
+  // The offsets of the model type and the ID prefix in the names, and their lengths (the names are not terminated).
+  uint32_t modelTypeOffset;
+  uint32_t modelTypeLength;
+  uint32_t modelIdPrefixOffset;
+  uint32_t modelIdPrefixLength;
+  // The number of instances of the group.
+  uint32_t instancesCount;
+  // Whether the group has rotations (the first bit) and scales (the second bit).
+  uint32_t flags;
+};
+
+/**
+ * Structure for defining the record of a light in a binary scene file.
+ */
+struct SceneFileLight
+{
+  // The offset of the ID of the light in the names, and its length.
+  uint32_t lightIdOffset;
+  uint32_t lightIdLength;
+  SceneLightType type;
+  float_t intensity;
+  glm::vec3 position;
+  glm::vec2 angles;
+  // Padding to keep the records 8 byte aligned.
+  uint32_t padding;
+};
+
+/**
+ * Structure for defining the record of a camera in a binary scene file.
+ */
+struct SceneFileCamera
+{
+  // The offset of the ID of the camera in the names, and its length.
+  uint32_t cameraIdOffset;
+  uint32_t cameraIdLength;
+  SceneCameraType type;
+  glm::vec3 position;
+  glm::vec2 angles;
+};
+
+static_assert(sizeof(SceneFileHeader) == 24, "The scene file header must not contain any implicit padding");
+static_assert(sizeof(SceneFileModelGroup) == 24, "The scene file model groups must not contain any implicit padding");
+static_assert(sizeof(SceneFileLight) == 40, "The scene file lights must not contain any implicit padding");
+static_assert(sizeof(SceneFileCamera) == 32, "The scene file cameras must not contain any implicit padding");
+
+/**
+ * Class for reading and writing scene files, which describe the models, the lights and the cameras a scene is made of instead
+ *   of the scene creating them one by one in code.
+ * Scene files are authored as text, a line per camera, light, model group or instance:
+ *   camera perspective|orthographic <id> <x> <y> <z> <horizontal angle> <vertical angle>
+ *   light point <id> <x> <y> <z> <intensity>
+ *   light cone <id> <x> <y> <z> <horizontal angle> <vertical angle> <intensity>
+ *   model <type> [id prefix]
+ *   instance <x> <y> <z> [<rotation x> <rotation y> <rotation z> [<scale x> <scale y> <scale z>]]
+ *   with the angles in degrees, the instances belonging to the last model group, and all the instances of a group giving the
+ *   same values. The asset cook turns them into binary scene files, which are read with a few copies and no parsing.
+ */
+class SceneFile
+{
+private:
+  // The magic number identifying binary scene files ("SCNE"), and the version of their layout.
+  static constexpr uint32_t SCENE_FILE_MAGIC = 0x454E4353;
+  static constexpr uint32_t SCENE_FILE_VERSION = 1;
+  // The flags of the model groups having rotations and scales.
+  static constexpr uint32_t MODEL_GROUP_ROTATIONS_FLAG = 1 << 0;
+  static constexpr uint32_t MODEL_GROUP_SCALES_FLAG = 1 << 1;
+
+  /**
+   * Add a name to the names of a binary scene file.
+   * 
+   * @param names   The names written so far.
+   * @param name    The name to add.
+   * @param offset  The output variable for the offset of the name.
+   * @param length  The output variable for the length of the name.
+   */
+  static void addName(std::string &names, const std::string &name, uint32_t &offset, uint32_t &length)
+  {
+    offset = static_cast<uint32_t>(names.size());
+    length = static_cast<uint32_t>(name.size());
+    names += name;
+  }
+
+  /**
+   * Read a name from the names of a binary scene file.
+   * 
+   * @param names      The names of the file.
+   * @param namesSize  The size of the names in bytes.
+   * @param offset     The offset of the name.
+   * @param length     The length of the name.
+   * @param outName    The output variable for the name.
+   * 
+   * @return Whether the name is within the names.
+   */
+  static bool readName(const char *names, const uint32_t &namesSize, const uint32_t &offset, const uint32_t &length, std::string &outName)
+  {
+    if (static_cast<uint64_t>(offset) + length > namesSize)
+    {
+      return false;
+    }
+    outName.assign(names + offset, length);
+    return true;
+  }
+
+public:
+  /**
+   * Parse the text form of a scene file.
+   * 
+   * @param sceneText  The text of the scene file.
+   * @param outScene   The output variable for the scene.
+   * 
+   * @return Whether every line of the scene file is valid.
+   */
+  static bool parseSceneText(const std::string &sceneText, SceneDescription &outScene)
+  {
+    outScene = SceneDescription();
+    std::istringstream stream(sceneText);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+      std::istringstream lineStream(line);
+      std::string keyword;
+      if (!(lineStream >> keyword) || keyword[0] == '#')
+      {
+        continue;
+      }
+
+      if (keyword == "camera")
+      {
+        SceneCamera camera;
+        std::string type;
+        if (!(lineStream >> type >> camera.cameraId >> camera.position.x >> camera.position.y >> camera.position.z >> camera.angles.x >> camera.angles.y) ||
+            (type != "perspective" && type != "orthographic"))
+        {
+          return false;
+        }
+        camera.type = type == "perspective" ? SceneCameraType::PERSPECTIVE : SceneCameraType::ORTHOGRAPHIC;
+        camera.angles = glm::radians(camera.angles);
+        outScene.cameras.push_back(camera);
+      }
+      else if (keyword == "light")
+      {
+        SceneLight light;
+        std::string type;
+        if (!(lineStream >> type >> light.lightId >> light.position.x >> light.position.y >> light.position.z) || (type != "point" && type != "cone"))
+        {
+          return false;
+        }
+        light.type = type == "point" ? SceneLightType::POINT : SceneLightType::CONE;
+        light.angles = glm::vec2(0.0f);
+        if ((light.type == SceneLightType::CONE && !(lineStream >> light.angles.x >> light.angles.y)) || !(lineStream >> light.intensity))
+        {
+          return false;
+        }
+        light.angles = glm::radians(light.angles);
+        outScene.lights.push_back(light);
+      }
+      else if (keyword == "model")
+      {
+        SceneModelGroup modelGroup;
+        if (!(lineStream >> modelGroup.modelType))
+        {
+          return false;
+        }
+        // The ID prefix is optional, defaulting to the model type.
+        if (!(lineStream >> modelGroup.modelIdPrefix))
+        {
+          modelGroup.modelIdPrefix = modelGroup.modelType;
+        }
+        outScene.modelGroups.push_back(modelGroup);
+      }
+      else if (keyword == "instance" && !outScene.modelGroups.empty())
+      {
+        // Read as many vectors as the instance gives, which has to be as many as the other instances of the group give.
+        auto &modelGroup = outScene.modelGroups.back();
+        glm::vec3 values[3];
+        size_t valuesCount = 0;
+        while (valuesCount < 3 && lineStream >> values[valuesCount].x >> values[valuesCount].y >> values[valuesCount].z)
+        {
+          valuesCount++;
+        }
+        const auto isFirstInstance = modelGroup.positions.empty();
+        if (valuesCount == 0 || (!isFirstInstance && (modelGroup.rotations.empty() != (valuesCount < 2) || modelGroup.scales.empty() != (valuesCount < 3))))
+        {
+          return false;
+        }
+        modelGroup.positions.push_back(values[0]);
+        if (valuesCount > 1)
+        {
+          modelGroup.rotations.push_back(glm::radians(values[1]));
+        }
+        if (valuesCount > 2)
+        {
+          modelGroup.scales.push_back(values[2]);
+        }
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Read the binary form of a scene file.
+   * 
+   * @param data      The contents of the scene file.
+   * @param size      The size of the scene file in bytes.
+   * @param outScene  The output variable for the scene.
+   * 
+   * @return Whether the scene file was written by this version of the layout, and is complete.
+   */
+  static bool readSceneBinary(const uint8_t *data, const size_t &size, SceneDescription &outScene)
+  {
+    outScene = SceneDescription();
+    SceneFileHeader header;
+    if (size < sizeof(SceneFileHeader))
+    {
+      return false;
+    }
+    memcpy(&header, data, sizeof(SceneFileHeader));
+    const uint64_t lightsOffset = sizeof(SceneFileHeader) + (static_cast<uint64_t>(header.modelGroupsCount) * sizeof(SceneFileModelGroup));
+    const uint64_t camerasOffset = lightsOffset + (static_cast<uint64_t>(header.lightsCount) * sizeof(SceneFileLight));
+    const uint64_t namesOffset = camerasOffset + (static_cast<uint64_t>(header.camerasCount) * sizeof(SceneFileCamera));
+    if (header.magic != SCENE_FILE_MAGIC || header.version != SCENE_FILE_VERSION || namesOffset + header.namesSize > size)
+    {
+      return false;
+    }
+    const auto names = reinterpret_cast<const char *>(data + namesOffset);
+
+    // Copy the transformations of the instances of each group in bulk, checking that they are within the file first.
+    outScene.modelGroups.resize(header.modelGroupsCount);
+    auto instancesOffset = namesOffset + header.namesSize;
+    for (uint32_t i = 0; i < header.modelGroupsCount; i++)
+    {
+      SceneFileModelGroup record;
+      memcpy(&record, data + sizeof(SceneFileHeader) + (i * sizeof(SceneFileModelGroup)), sizeof(SceneFileModelGroup));
+      auto &modelGroup = outScene.modelGroups[i];
+      if (!readName(names, header.namesSize, record.modelTypeOffset, record.modelTypeLength, modelGroup.modelType) ||
+          !readName(names, header.namesSize, record.modelIdPrefixOffset, record.modelIdPrefixLength, modelGroup.modelIdPrefix))
+      {
+        return false;
+      }
+
+      const uint64_t streamSize = static_cast<uint64_t>(record.instancesCount) * sizeof(glm::vec3);
+      for (const auto &stream : {std::make_pair(&modelGroup.positions, true),
+                                 std::make_pair(&modelGroup.rotations, (record.flags & MODEL_GROUP_ROTATIONS_FLAG) != 0),
+                                 std::make_pair(&modelGroup.scales, (record.flags & MODEL_GROUP_SCALES_FLAG) != 0)})
+      {
+        if (!stream.second)
+        {
+          continue;
+        }
+        if (instancesOffset + streamSize > size)
+        {
+          return false;
+        }
+        stream.first->resize(record.instancesCount);
+        memcpy(stream.first->data(), data + instancesOffset, streamSize);
+        instancesOffset += streamSize;
+      }
+    }
+
+    outScene.lights.resize(header.lightsCount);
+    for (uint32_t i = 0; i < header.lightsCount; i++)
+    {
+      SceneFileLight record;
+      memcpy(&record, data + lightsOffset + (i * sizeof(SceneFileLight)), sizeof(SceneFileLight));
+      auto &light = outScene.lights[i];
+      if (!readName(names, header.namesSize, record.lightIdOffset, record.lightIdLength, light.lightId) || record.type > SceneLightType::CONE)
+      {
+        return false;
+      }
+      light.type = record.type;
+      light.position = record.position;
+      light.angles = record.angles;
+      light.intensity = record.intensity;
+    }
+
+    outScene.cameras.resize(header.camerasCount);
+    for (uint32_t i = 0; i < header.camerasCount; i++)
+    {
+      SceneFileCamera record;
+      memcpy(&record, data + camerasOffset + (i * sizeof(SceneFileCamera)), sizeof(SceneFileCamera));
+      auto &camera = outScene.cameras[i];
+      if (!readName(names, header.namesSize, record.cameraIdOffset, record.cameraIdLength, camera.cameraId) || record.type > SceneCameraType::ORTHOGRAPHIC)
+      {
+        return false;
+      }
+      camera.type = record.type;
+      camera.position = record.position;
+      camera.angles = record.angles;
+    }
+    return instancesOffset == size;
+  }
+
+  /**
+   * Write the binary form of a scene file, replacing the file if it exists.
+   * 
+   * @param filePath  The path of the binary scene file.
+   * @param scene     The scene to write.
+   * 
+   * @return Whether the scene file was written.
+   */
+  static bool writeSceneBinary(const std::string &filePath, const SceneDescription &scene)
+  {
+    std::string names;
+    std::vector<SceneFileModelGroup> modelGroupRecords;
+    for (const auto &modelGroup : scene.modelGroups)
+    {
+      SceneFileModelGroup record = {};
+      addName(names, modelGroup.modelType, record.modelTypeOffset, record.modelTypeLength);
+      addName(names, modelGroup.modelIdPrefix, record.modelIdPrefixOffset, record.modelIdPrefixLength);
+      record.instancesCount = static_cast<uint32_t>(modelGroup.positions.size());
+      record.flags = (modelGroup.rotations.empty() ? 0 : MODEL_GROUP_ROTATIONS_FLAG) | (modelGroup.scales.empty() ? 0 : MODEL_GROUP_SCALES_FLAG);
+      modelGroupRecords.push_back(record);
+    }
+    std::vector<SceneFileLight> lightRecords;
+    for (const auto &light : scene.lights)
+    {
+      SceneFileLight record = {};
+      addName(names, light.lightId, record.lightIdOffset, record.lightIdLength);
+      record.type = light.type;
+      record.intensity = light.intensity;
+      record.position = light.position;
+      record.angles = light.angles;
+      lightRecords.push_back(record);
+    }
+    std::vector<SceneFileCamera> cameraRecords;
+    for (const auto &camera : scene.cameras)
+    {
+      SceneFileCamera record = {};
+      addName(names, camera.cameraId, record.cameraIdOffset, record.cameraIdLength);
+      record.type = camera.type;
+      record.position = camera.position;
+      record.angles = camera.angles;
+      cameraRecords.push_back(record);
+    }
+    const SceneFileHeader header = {SCENE_FILE_MAGIC, SCENE_FILE_VERSION, static_cast<uint32_t>(modelGroupRecords.size()),
+                                    static_cast<uint32_t>(lightRecords.size()), static_cast<uint32_t>(cameraRecords.size()), static_cast<uint32_t>(names.size())};
+
+    std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(SceneFileHeader));
+    stream.write(reinterpret_cast<const char *>(modelGroupRecords.data()), modelGroupRecords.size() * sizeof(SceneFileModelGroup));
+    stream.write(reinterpret_cast<const char *>(lightRecords.data()), lightRecords.size() * sizeof(SceneFileLight));
+    stream.write(reinterpret_cast<const char *>(cameraRecords.data()), cameraRecords.size() * sizeof(SceneFileCamera));
+    stream.write(names.data(), names.size());
+    for (const auto &modelGroup : scene.modelGroups)
+    {
+      stream.write(reinterpret_cast<const char *>(modelGroup.positions.data()), modelGroup.positions.size() * sizeof(glm::vec3));
+      stream.write(reinterpret_cast<const char *>(modelGroup.rotations.data()), modelGroup.rotations.size() * sizeof(glm::vec3));
+      stream.write(reinterpret_cast<const char *>(modelGroup.scales.data()), modelGroup.scales.size() * sizeof(glm::vec3));
+    }
+    return stream.good();
+  }
+
+  /**
+   * Cook the text form of a scene file into its binary form.
+   * 
+   * @param sourceFilePath  The path of the text scene file.
+   * @param cookedFilePath  The path of the binary scene file to write.
+   * 
+   * @return Whether the scene file was cooked.
+   */
+  static bool cookScene(const std::string &sourceFilePath, const std::string &cookedFilePath)
+  {
+    const MappedFile sourceFile(sourceFilePath);
+    SceneDescription scene;
+    return sourceFile.isMapped() && parseSceneText(std::string(reinterpret_cast<const char *>(sourceFile.getData()), sourceFile.getSize()), scene) &&
+           writeSceneBinary(cookedFilePath, scene);
+  }
+
+  /**
+   * Load a scene file, from its cooked binary form if the asset cook wrote one from the text as it is now, or from its text
+   *   otherwise. Does not use the GL context, so it can be run on worker threads.
+   * 
+   * @param filePath  The path of the text scene file.
+   * @param outScene  The output variable for the scene.
+   * 
+   * @return Whether the scene file was read.
+   */
+  static bool loadScene(const std::string &filePath, SceneDescription &outScene)
+  {
+    const auto cookedFilePath = AssetManifest::getInstance().findCookedAsset(filePath);
+    if (!cookedFilePath.empty())
+    {
+      const AssetFile cookedFile(cookedFilePath);
+      if (cookedFile.isMapped() && readSceneBinary(cookedFile.getData(), cookedFile.getSize(), outScene))
+      {
+        return true;
+      }
+    }
+    const AssetFile sceneFile(filePath);
+    return sceneFile.isMapped() && parseSceneText(std::string(reinterpret_cast<const char *>(sceneFile.getData()), sceneFile.getSize()), outScene);
+  }
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef INCLUDE_SCENE_INSTANCER_CPP
+#define INCLUDE_SCENE_INSTANCER_CPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+#include "scene_file.cpp"
+#include "transform.cpp"
+#include "models.cpp"
+#include "light.cpp"
+#include "camera.cpp"
+#include "render.cpp"
+
+#include "../camera/perspective_camera.cpp"
+#include "../camera/orthographic_camera.cpp"
+#include "../light/point_light.cpp"
+#include "../light/cone_light.cpp"
+
+// The function creating a model of a type placed by scene files, with the given ID.
+typedef std::function<std::shared_ptr<ModelBaseIntf>(const std::string &modelId)> SceneModelFactory;
+
+/**
+ * A manager class for creating and registering the models, lights and cameras a scene file describes, with the model types
+ *   the scene knows of. The transform store and the registered models are grown once for all the instances of the scene,
+ *   which are then created group by group, so that the instances of a model type follow each other into the same render
+ *   groups.
+ */
+class SceneInstancer
+{
+private:
+  // Singleton instance of the scene instancer.
+  static SceneInstancer instance;
+
+  // The transform manager storing the transformations of the models.
+  TransformManager &transformManager;
+  // The model manager the models are registered with.
+  ModelManager &modelManager;
+  // The light manager the lights are registered with.
+  LightManager &lightManager;
+  // The camera manager the cameras are registered with.
+  CameraManager &cameraManager;
+  // The render manager the first camera is made active with.
+  RenderManager &renderManager;
+
+  SceneInstancer()
+      : transformManager(TransformManager::getInstance()),
+        modelManager(ModelManager::getInstance()),
+        lightManager(LightManager::getInstance()),
+        cameraManager(CameraManager::getInstance()),
+        renderManager(RenderManager::getInstance()) {}
+
+public:
+  // Preventing copying the scene instancer, making sure only one instance can exist.
+  SceneInstancer(const SceneInstancer &) = delete;
+
+  /**
+   * Get the function creating the models of the given type, through their `create(modelId)` factory.
+   * 
+   * @return The model factory.
+   */
+  template <typename T>
+  static SceneModelFactory getModelFactory()
+  {
+    return [](const std::string &modelId) {
+      return std::static_pointer_cast<ModelBaseIntf>(T::create(modelId));
+    };
+  }
+
+  /**
+   * Create and register the models, lights and cameras of a scene, making its first camera the active one.
+   * 
+   * @param scene           The scene to create.
+   * @param modelFactories  The functions creating the models, by the names of their types.
+   * @param modelHandles    The handles of the models of the scene, which the created ones are added to.
+   * @param lightHandles    The handles of the lights of the scene, which the created ones are added to.
+   * @param cameraHandles   The handles of the cameras of the scene, which the created ones are added to.
+   * 
+   * @return Whether the scene was created, which it is not if it has models of a type without a factory.
+   */
+  bool instantiateScene(const SceneDescription &scene, const std::map<std::string, SceneModelFactory> &modelFactories,
+                        std::vector<RegistryHandle> &modelHandles, std::vector<RegistryHandle> &lightHandles, std::vector<RegistryHandle> &cameraHandles)
+  {
+    // Check that every model type is known before creating anything, and grow the stores once for all the instances.
+    size_t instancesCount = 0;
+    for (const auto &modelGroup : scene.modelGroups)
+    {
+      if (modelFactories.find(modelGroup.modelType) == modelFactories.end())
+      {
+        return false;
+      }
+      instancesCount += modelGroup.positions.size();
+    }
+    transformManager.reserveTransforms(instancesCount);
+    modelManager.reserveModels(instancesCount);
+    modelHandles.reserve(modelHandles.size() + instancesCount);
+
+    for (const auto &modelGroup : scene.modelGroups)
+    {
+      const auto &modelFactory = modelFactories.at(modelGroup.modelType);
+      for (size_t i = 0; i < modelGroup.positions.size(); i++)
+      {
+        auto model = modelFactory(modelGroup.modelIdPrefix + std::to_string(i));
+        model->setModelPosition(modelGroup.positions[i]);
+        if (!modelGroup.rotations.empty())
+        {
+          model->setModelRotation(modelGroup.rotations[i]);
+        }
+        if (!modelGroup.scales.empty())
+        {
+          model->setModelScale(modelGroup.scales[i]);
+        }
+        modelHandles.push_back(modelManager.registerModel(std::move(model)));
+      }
+    }
+
+    for (const auto &light : scene.lights)
+    {
+      if (light.type == SceneLightType::CONE)
+      {
+        const auto coneLight = ConeLight::create(light.lightId);
+        coneLight->setLightPosition(light.position);
+        coneLight->setLightAngles(light.angles.x, light.angles.y);
+        coneLight->setLightIntensity(light.intensity);
+        lightHandles.push_back(lightManager.registerLight(coneLight));
+        continue;
+      }
+      const auto pointLight = PointLight::create(light.lightId);
+      pointLight->setLightPosition(light.position);
+      pointLight->setLightIntensity(light.intensity);
+      lightHandles.push_back(lightManager.registerLight(pointLight));
+    }
+
+    instantiateCameras(scene, cameraHandles);
+    return true;
+  }
+
+  /**
+   * Create and register the cameras of a scene alone, making its first camera the active one (e.g. for a scene whose models and
+   *   lights are restored from a scene snapshot).
+   * 
+   * @param scene          The scene to create the cameras of.
+   * @param cameraHandles  The handles of the cameras of the scene, which the created ones are added to.
+   */
+  void instantiateCameras(const SceneDescription &scene, std::vector<RegistryHandle> &cameraHandles)
+  {
+    for (size_t i = 0; i < scene.cameras.size(); i++)
+    {
+      const auto &camera = scene.cameras[i];
+      if (camera.type == SceneCameraType::ORTHOGRAPHIC)
+      {
+        const auto orthographicCamera = OrthographicCamera::create(camera.cameraId);
+        orthographicCamera->setCameraPosition(camera.position);
+        orthographicCamera->setCameraAngles(camera.angles.x, camera.angles.y);
+        cameraHandles.push_back(cameraManager.registerCamera(orthographicCamera));
+      }
+      else
+      {
+        const auto perspectiveCamera = PerspectiveCamera::create(camera.cameraId);
+        perspectiveCamera->setCameraPosition(camera.position);
+        perspectiveCamera->setCameraAngles(camera.angles.x, camera.angles.y);
+        cameraHandles.push_back(cameraManager.registerCamera(perspectiveCamera));
+      }
+      if (i == 0)
+      {
+        renderManager.registerActiveCamera(cameraHandles.back());
+      }
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the scene instancer.
+   * 
+   * @return The scene instancer singleton instance.
+   */
+  static SceneInstancer &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the scene instancer singleton instance static variable.
+SceneInstancer SceneInstancer::instance;
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef INCLUDE_SCENE_LOADER_CPP
+#define INCLUDE_SCENE_LOADER_CPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <memory_resource>
+
+#include <GLFW/glfw3.h>
+
+#include "object.cpp"
+#include "texture.cpp"
+#include "shader.cpp"
+#include "job.cpp"
+#include "asset_archive.cpp"
+#include "memory_resource.cpp"
+
+/**
+ * Structure for defining a single step of loading a scene.
+ */
+struct SceneLoadStep
+{
+  // The function running the step on the main thread, returning false while it is waiting for a worker thread.
+  std::function<bool()> execute;
+  // The number of bytes the step accounts for in the progress of the scene.
+  uint64_t byteCount;
+};
+
+/**
+ * A manager class for loading scenes across multiple frames, so that the window keeps responding while files are read.
+ * Scenes queue steps that use the GL context, which are run in order on the main thread in time-sliced batches, while the file
+ *   reading and parsing the steps wait for is done on worker threads.
+ */
+class SceneLoader
+{
+private:
+  // Singleton instance of the scene loader.
+  static SceneLoader instance;
+
+  // The time the steps can take per frame, in seconds.
+  static constexpr double FRAME_BUDGET = 0.008;
+
+  // The job manager running the tasks queued for the main thread.
+  JobManager &jobManager;
+  // The texture manager responsible for uploading the streamed textures.
+  TextureManager &textureManager;
+  // The shader manager responsible for submitting the queued shader programs.
+  ShaderManager &shaderManager;
+
+  // The queued steps, in the order they are run.
+  std::pmr::vector<SceneLoadStep> steps;
+  // The index of the next step to run.
+  size_t nextStepIndex;
+  // The number of bytes accounted for by the finished steps.
+  uint64_t completedByteCount;
+  // The number of bytes accounted for by all the queued steps.
+  uint64_t totalByteCount;
+
+  SceneLoader()
+      : jobManager(JobManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        steps(),
+        nextStepIndex(0),
+        completedByteCount(0),
+        totalByteCount(0) {}
+
+public:
+  // Preventing copying the scene loader, making sure only one instance can exist.
+  SceneLoader(const SceneLoader &) = delete;
+
+  /**
+   * Queue a step for loading the scene.
+   * 
+   * @param step       The function running the step, returning false to be called again on a later frame (e.g. while waiting for a worker thread).
+   * @param filePaths  The paths of the files the step loads, whose sizes are used for the progress of the scene.
+   */
+  void addStep(const std::function<bool()> &step, const std::vector<std::string> &filePaths = {})
+  {
+    // Every step counts as at least one byte, so that steps without files still move the progress.
+    uint64_t byteCount = 1;
+    for (const auto &filePath : filePaths)
+    {
+      byteCount += AssetFile::getAssetSize(filePath);
+    }
+
+    steps.push_back({step, byteCount});
+    totalByteCount += byteCount;
+  }
+
+  /**
+   * Queue a step for loading the scene in two parts, a function run on a worker thread and then a function run on the main thread
+   *   once it finished. The worker function is started right away, so that it runs along with the steps queued before it, while
+   *   the main thread function still runs in the order of the steps (so a load reads as the sequence it is).
+   * 
+   * @param workerFunction  The function run on a worker thread, e.g. reading and parsing the files of the step.
+   * @param step            The function run on the main thread once the worker function finished, returning false to be called again on a later frame.
+   * @param filePaths       The paths of the files the step loads, whose sizes are used for the progress of the scene.
+   */
+  void addWorkerStep(const std::function<void()> &workerFunction, const std::function<bool()> &step, const std::vector<std::string> &filePaths = {})
+  {
+    const auto task = jobManager.submitTask(workerFunction);
+    addStep(
+        [task, step]() {
+          return task->isFinished() && step();
+        },
+        filePaths);
+  }
+
+  /**
+   * Run the queued steps until they all finish, a step has to wait, or the time budget of the frame is used up.
+   * Clears the steps once they are all finished, so that the next scene starts from scratch.
+   * 
+   * @return Whether all the steps are finished or not.
+   */
+  bool update()
+  {
+    // Run the tasks queued for the main thread (which is all of them without worker threads), so that the work the steps wait
+    //   for makes progress.
+    jobManager.runMainThreadTasks();
+    // Upload any streamed texture that is done being read, and submit any shader program that is done being read.
+    textureManager.updateStreamingTextures();
+    shaderManager.updatePendingShaderPrograms();
+
+    const auto startTime = glfwGetTime();
+    while (nextStepIndex < steps.size() && (glfwGetTime() - startTime) < FRAME_BUDGET)
+    {
+      auto &step = steps[nextStepIndex];
+      if (!step.execute())
+      {
+        // The step is waiting for a worker thread, so give the rest of the frame to it.
+        std::this_thread::yield();
+        return false;
+      }
+
+      completedByteCount += step.byteCount;
+      nextStepIndex++;
+    }
+
+    if (nextStepIndex < steps.size())
+    {
+      return false;
+    }
+
+    // All the steps are finished.
+    steps.clear();
+    nextStepIndex = 0;
+    completedByteCount = 0;
+    totalByteCount = 0;
+    return true;
+  }
+
+  /**
+   * Get the progress of loading the scene.
+   * 
+   * @return The fraction of the queued bytes that are loaded (1 if nothing is queued).
+   */
+  float_t getProgress() const
+  {
+    return totalByteCount == 0 ? 1.0f : static_cast<float_t>(completedByteCount) / totalByteCount;
+  }
+
+  /**
+   * Switch the memory resource the queued steps are kept in, e.g. to the arena of the scene. Must not be called while the steps are run.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    rebindMemoryResource(steps, memoryResource);
+  }
+
+  /**
+   * Returns the singleton instance of the scene loader.
+   * 
+   * @return The scene loader singleton instance.
+   */
+  static SceneLoader &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the scene loader singleton instance static variable.
+SceneLoader SceneLoader::instance;
+
+/**
+ * A class for writing a load of the scene as the sequence it reads as, one awaited load after the other, e.g.
+ *   SceneLoadFlow(sceneLoader).loadObject(...).loadTexture(...).onGlThread(...).
+ * Each load starts its file work on the worker threads as soon as it is added, so that the loads of the flow (and of the other
+ *   flows) run in parallel, while its GL work and the functions of the flow run on the GL thread in the order they were added,
+ *   each waiting for the loads before it. The progress of the scene is counted from the files of the loads.
+ */
+class SceneLoadFlow
+{
+private:
+  // The scene loader the steps of the flow are queued in.
+  SceneLoader &sceneLoader;
+
+public:
+  SceneLoadFlow(SceneLoader &sceneLoader)
+      : sceneLoader(sceneLoader) {}
+
+  /**
+   * Load an object, parsing its file on a worker thread and uploading it on the GL thread once parsed.
+   * 
+   * @param objectName      The name of the object.
+   * @param objectFilePath  The file path to the object data.
+   * @param objectDetails   Set to the details of the loaded object, once its step of the flow is run.
+   * 
+   * @return The flow, to add the next steps to.
+   */
+  SceneLoadFlow &loadObject(const std::string &objectName, const std::string &objectFilePath, std::shared_ptr<const ObjectDetails> &objectDetails)
+  {
+    auto &objectManager = ObjectManager::getInstance();
+    objectManager.prepareObject(objectName, objectFilePath);
+    sceneLoader.addStep(
+        [&objectManager, &objectDetails, objectName, objectFilePath]() {
+          if (!objectManager.isObjectPrepared(objectName))
+          {
+            return false;
+          }
+          objectDetails = objectManager.createObject(objectName, objectFilePath);
+          return true;
+        },
+        {objectFilePath});
+    return *this;
+  }
+
+  /**
+   * Load a texture, streaming its image from a worker thread, and wait for the image to be uploaded.
+   * 
+   * @param textureName      The name of the texture.
+   * @param textureFilePath  The file path to the texture image.
+   * @param textureDetails   Set to the details of the texture right away (drawn with a placeholder until its image is uploaded).
+   * 
+   * @return The flow, to add the next steps to.
+   */
+  SceneLoadFlow &loadTexture(const std::string &textureName, const std::string &textureFilePath, std::shared_ptr<const TextureDetails> &textureDetails)
+  {
+    auto &textureManager = TextureManager::getInstance();
+    textureDetails = textureManager.create2dTexture(textureName, textureFilePath);
+    sceneLoader.addStep(
+        [&textureManager, textureName]() {
+          return !textureManager.isTextureStreaming(textureName);
+        },
+        {textureFilePath});
+    return *this;
+  }
+
+  /**
+   * Load a shader program, reading and compiling its shaders in the background and creating it on the GL thread once compiled.
+   * 
+   * @param shaderName              The name of the shader program.
+   * @param vertexShaderFilePath    The file path to the vertex shader.
+   * @param fragmentShaderFilePath  The file path to the fragment shader.
+   * @param shaderDetails           Set to the details of the loaded shader program, once its step of the flow is run.
+   * 
+   * @return The flow, to add the next steps to.
+   */
+  SceneLoadFlow &loadShader(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath, std::shared_ptr<const ShaderDetails> &shaderDetails)
+  {
+    auto &shaderManager = ShaderManager::getInstance();
+    shaderManager.submitShaderProgram(shaderName, vertexShaderFilePath, fragmentShaderFilePath);
+    sceneLoader.addStep(
+        [&shaderManager, &shaderDetails, shaderName, vertexShaderFilePath, fragmentShaderFilePath]() {
+          if (!shaderManager.isShaderProgramReady(shaderName))
+          {
+            return false;
+          }
+          shaderDetails = shaderManager.createShaderProgram(shaderName, vertexShaderFilePath, fragmentShaderFilePath);
+          return true;
+        },
+        {vertexShaderFilePath, fragmentShaderFilePath});
+    return *this;
+  }
+
+  /**
+   * Run a function on a worker thread, started right away, which the next steps of the flow wait for.
+   * 
+   * @param workerFunction  The function run on a worker thread, e.g. reading and parsing a file.
+   * @param filePaths       The paths of the files the function reads, whose sizes are used for the progress of the scene.
+   * 
+   * @return The flow, to add the next steps to.
+   */
+  SceneLoadFlow &onWorker(const std::function<void()> &workerFunction, const std::vector<std::string> &filePaths = {})
+  {
+    sceneLoader.addWorkerStep(
+        workerFunction, []() {
+          return true;
+        },
+        filePaths);
+    return *this;
+  }
+
+  /**
+   * Run a function on the GL thread, once the steps of the flow before it are done.
+   * 
+   * @param function  The function run on the GL thread, e.g. creating the models from the loaded dependencies.
+   * 
+   * @return The flow, to add the next steps to.
+   */
+  SceneLoadFlow &onGlThread(const std::function<void()> &function)
+  {
+    sceneLoader.addStep([function]() {
+      function();
+      return true;
+    });
+    return *this;
+  }
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef INCLUDE_SCENE_MEMORY_CPP
+#define INCLUDE_SCENE_MEMORY_CPP
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "memory_resource.cpp"
+#include "models.cpp"
+#include "light.cpp"
+#include "camera.cpp"
+#include "text.cpp"
+#include "scene_loader.cpp"
+
+/**
+ * A manager class for the arena the memory of a scene is allocated from, which the managers keep their registries in while the
+ *   scene is loaded, so that it is all freed at once when the scene is de-initialized instead of container by container.
+ * The managers are switched back to the default memory resource before the arena is released, taking along whatever outlives
+ *   the scene.
+ */
+class SceneMemoryManager
+{
+private:
+  // Singleton instance of the scene memory manager.
+  static SceneMemoryManager instance;
+
+  // The size of the first buffer of the arena, grown geometrically from there.
+  static constexpr size_t INITIAL_ARENA_SIZE = 256 * 1024;
+
+  // The managers keeping their registries in the arena of the scene.
+  ModelManager &modelManager;
+  LightManager &lightManager;
+  CameraManager &cameraManager;
+  TextManager &textManager;
+  SceneLoader &sceneLoader;
+
+  // The arena of the loaded scene.
+  SynchronizedMonotonicResource sceneResource;
+  // Whether a scene is loaded, allocating from the arena.
+  bool isSceneLoaded;
+
+  /**
+   * Switch the memory resource all the managers allocate from.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    modelManager.setMemoryResource(memoryResource);
+    lightManager.setMemoryResource(memoryResource);
+    cameraManager.setMemoryResource(memoryResource);
+    textManager.setMemoryResource(memoryResource);
+    sceneLoader.setMemoryResource(memoryResource);
+  }
+
+  SceneMemoryManager()
+      : modelManager(ModelManager::getInstance()),
+        lightManager(LightManager::getInstance()),
+        cameraManager(CameraManager::getInstance()),
+        textManager(TextManager::getInstance()),
+        sceneLoader(SceneLoader::getInstance()),
+        sceneResource(INITIAL_ARENA_SIZE),
+        isSceneLoaded(false) {}
+
+  ~SceneMemoryManager()
+  {
+    // The managers outlive the arena, so take them off it if the program ends in the middle of a scene.
+    endScene();
+  }
+
+public:
+  // Preventing copying the scene memory manager, making sure only one instance can exist.
+  SceneMemoryManager(const SceneMemoryManager &) = delete;
+
+  /**
+   * Have the managers allocate from the arena of the scene, before the scene is initialized.
+   */
+  void beginScene()
+  {
+    if (isSceneLoaded)
+    {
+      return;
+    }
+    isSceneLoaded = true;
+    setMemoryResource(&sceneResource);
+  }
+
+  /**
+   * Move the managers back to the default memory resource and release the arena of the scene, once the scene is de-initialized.
+   */
+  void endScene()
+  {
+    if (!isSceneLoaded)
+    {
+      return;
+    }
+    setMemoryResource(std::pmr::get_default_resource());
+    sceneResource.release();
+    isSceneLoaded = false;
+  }
+
+  /**
+   * Get the memory resource for the memory of the loaded scene, freed along with the scene when it is de-initialized.
+   * 
+   * @return The arena of the scene while a scene is loaded, or the default memory resource otherwise.
+   */
+  std::pmr::memory_resource *getSceneResource()
+  {
+    return isSceneLoaded ? static_cast<std::pmr::memory_resource *>(&sceneResource) : std::pmr::get_default_resource();
+  }
+
+  /**
+   * Get the number of bytes allocated from the arena of the loaded scene.
+   * 
+   * @return The number of bytes.
+   */
+  size_t getSceneAllocatedBytes()
+  {
+    return sceneResource.getAllocatedBytes();
+  }
+
+  /**
+   * Returns the singleton instance of the scene memory manager.
+   * 
+   * @return The scene memory manager singleton instance.
+   */
+  static SceneMemoryManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the scene memory manager singleton instance static variable.
+SceneMemoryManager SceneMemoryManager::instance;
+
+#endif
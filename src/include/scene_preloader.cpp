@@ -0,0 +1,234 @@
+#ifndef INCLUDE_SCENE_PRELOADER_CPP
+#define INCLUDE_SCENE_PRELOADER_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+
+#include "constants.cpp"
+#include "object.cpp"
+#include "texture.cpp"
+#include "shader.cpp"
+#include "asset_archive.cpp"
+
+/**
+ * Structure for keeping the dependencies of a model type preloaded for the likely-next scene.
+ */
+struct PreloadedModelDeps
+{
+  // The names and file paths of the object and the shader program, created once they are read.
+  std::string objectName;
+  std::string objectFilePath;
+  std::string shaderName;
+  std::string vertexShaderFilePath;
+  std::string fragmentShaderFilePath;
+  // The references held on the dependencies, the object and shader program being empty until they are created.
+  std::shared_ptr<const ObjectDetails> objectDetails;
+  std::shared_ptr<const ShaderDetails> shaderDetails;
+  std::shared_ptr<const TextureDetails> textureDetails;
+};
+
+/**
+ * A manager class for loading the assets of the likely-next scene while the current scene runs, so that initializing the next scene
+ *   only takes the references of assets that are already created (e.g. the game scene while the main menu is shown).
+ * The scene to preload records the model dependencies it would load, which are read on worker threads and created a few at a time on
+ *   the main thread, as long as their files fit the preload budget together. The references are held until the next scene is loaded,
+ *   which then either keeps the assets with its own references or leaves them to the residency caches.
+ * The assets the next scene shares with the current one are retained the same way while switching between them, so that
+ *   de-initializing the current scene only unloads the assets the next one does not need, and initializing the next one only
+ *   loads the ones the current one did not have.
+ */
+class ScenePreloader
+{
+private:
+  // Singleton instance of the scene preloader.
+  static ScenePreloader instance;
+
+  // The object manager responsible for creating the preloaded objects.
+  ObjectManager &objectManager;
+  // The texture manager responsible for creating the preloaded textures.
+  TextureManager &textureManager;
+  // The shader manager responsible for creating the preloaded shader programs.
+  ShaderManager &shaderManager;
+
+  // Whether the model dependencies initialized are recorded instead of loaded for the scene.
+  bool isRecording;
+  // Whether the recorded model dependencies are only retained if they are already created, instead of being preloaded.
+  bool isRetaining;
+  // The preloaded model dependencies, in the order they were recorded.
+  std::vector<PreloadedModelDeps> preloadedModelDeps;
+  // The size of the files of the preloaded model dependencies (in bytes), which is kept within the preload budget.
+  uint64_t preloadedSize;
+
+  ScenePreloader()
+      : objectManager(ObjectManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        isRecording(false),
+        isRetaining(false),
+        preloadedModelDeps({}),
+        preloadedSize(0) {}
+
+  /**
+   * Create the object and the shader program of the preloaded model dependencies, waiting for them to be read if needed.
+   * 
+   * @param modelDeps  The preloaded model dependencies.
+   */
+  void createModelDeps(PreloadedModelDeps &modelDeps)
+  {
+    modelDeps.objectDetails = objectManager.createObject(modelDeps.objectName, modelDeps.objectFilePath);
+    modelDeps.shaderDetails = shaderManager.createShaderProgram(modelDeps.shaderName, modelDeps.vertexShaderFilePath, modelDeps.fragmentShaderFilePath);
+  }
+
+public:
+  // Preventing copying the scene preloader, making sure only one instance can exist.
+  ScenePreloader(const ScenePreloader &) = delete;
+
+  /**
+   * Preload the model dependencies initialized by the given function, instead of loading them for the current scene.
+   * 
+   * @param initModels  The function initializing the dependencies of the model types of the scene to preload.
+   */
+  void recordModels(const std::function<void()> &initModels)
+  {
+    isRecording = true;
+    initModels();
+    isRecording = false;
+  }
+
+  /**
+   * Retain the model dependencies initialized by the given function that are already created (e.g. used by the current scene), so
+   *   that they stay resident while switching to the scene using them. The other ones are left to be loaded with the scene.
+   * 
+   * @param initModels  The function initializing the dependencies of the model types of the next scene.
+   */
+  void retainModels(const std::function<void()> &initModels)
+  {
+    isRetaining = true;
+    recordModels(initModels);
+    isRetaining = false;
+  }
+
+  /**
+   * Check if the model dependencies initialized are recorded instead of loaded for the scene, so that the models skip queuing
+   *   the loading steps of the scene.
+   * 
+   * @return Whether the preloader is recording.
+   */
+  bool isRecordingModels() const
+  {
+    return isRecording;
+  }
+
+  /**
+   * Start preloading the dependencies of a model type, the files being read in the background, or take references on them if they
+   *   are created and only retained. Does nothing if they were already recorded, or if their files do not fit the preload budget
+   *   anymore (so that they are loaded with the scene as usual).
+   * 
+   * @param modelName                    The name of the model type.
+   * @param modelObjectFilePath          The file path to the object of the model.
+   * @param modelTextureFilePath         The file path to the texture of the model.
+   * @param modelVertexShaderFilePath    The file path to the vertex shader of the model.
+   * @param modelFragmentShaderFilePath  The file path to the fragment shader of the model.
+   */
+  void recordModelDeps(
+      const std::string &modelName,
+      const std::string &modelObjectFilePath,
+      const std::string &modelTextureFilePath,
+      const std::string &modelVertexShaderFilePath, const std::string &modelFragmentShaderFilePath)
+  {
+    // The dependencies are named after the model type, the same way the models name them.
+    const auto objectName = modelName + "::Object";
+    const auto textureName = modelName + "::Texture";
+    const auto shaderName = modelName + "::Shader";
+    const auto existingModelDeps = std::find_if(preloadedModelDeps.begin(), preloadedModelDeps.end(), [&objectName](const PreloadedModelDeps &modelDeps) {
+      return modelDeps.objectName == objectName;
+    });
+    if (existingModelDeps != preloadedModelDeps.end())
+    {
+      return;
+    }
+
+    // The retained dependencies are created already, so they take no loading and count against no budget.
+    if (isRetaining)
+    {
+      if (objectManager.isObjectCreated(objectName) && textureManager.isTextureCreated(textureName) && shaderManager.isShaderProgramCreated(shaderName))
+      {
+        preloadedModelDeps.push_back({objectName, modelObjectFilePath, shaderName, modelVertexShaderFilePath, modelFragmentShaderFilePath,
+                                      objectManager.createObject(objectName, modelObjectFilePath),
+                                      shaderManager.createShaderProgram(shaderName, modelVertexShaderFilePath, modelFragmentShaderFilePath),
+                                      textureManager.create2dTexture(textureName, modelTextureFilePath)});
+      }
+      return;
+    }
+
+    const auto modelDepsSize = AssetFile::getAssetSize(modelObjectFilePath) + AssetFile::getAssetSize(modelTextureFilePath) +
+                               AssetFile::getAssetSize(modelVertexShaderFilePath) + AssetFile::getAssetSize(modelFragmentShaderFilePath);
+    if (preloadedSize + modelDepsSize > SCENE_PRELOAD_BUDGET)
+    {
+      return;
+    }
+    preloadedSize += modelDepsSize;
+
+    // Start reading the files in the background, the texture streaming its image right away.
+    objectManager.prepareObject(objectName, modelObjectFilePath);
+    shaderManager.submitShaderProgram(shaderName, modelVertexShaderFilePath, modelFragmentShaderFilePath);
+    const auto textureDetails = textureManager.create2dTexture(textureName, modelTextureFilePath);
+    preloadedModelDeps.push_back({objectName, modelObjectFilePath, shaderName, modelVertexShaderFilePath, modelFragmentShaderFilePath, nullptr, nullptr, textureDetails});
+  }
+
+  /**
+   * Submit the preloaded shader programs that are done being read, and create the object and shader program of one preloaded model
+   *   type once they are done being read and compiled, so that the costs are spread over multiple frames. Meant to be called once
+   *   per frame.
+   */
+  void update()
+  {
+    shaderManager.updatePendingShaderPrograms();
+    for (auto &modelDeps : preloadedModelDeps)
+    {
+      if (modelDeps.objectDetails == nullptr && objectManager.isObjectPrepared(modelDeps.objectName) && shaderManager.isShaderProgramReady(modelDeps.shaderName))
+      {
+        createModelDeps(modelDeps);
+        return;
+      }
+    }
+  }
+
+  /**
+   * Release the references held on the preloaded and retained model dependencies, once the scene they were recorded for is loaded
+   *   (or another scene is loaded instead). The ones not created yet are created first, so that no read data is left behind.
+   */
+  void releasePreloadedAssets()
+  {
+    for (auto &modelDeps : preloadedModelDeps)
+    {
+      if (modelDeps.objectDetails == nullptr)
+      {
+        createModelDeps(modelDeps);
+      }
+      objectManager.destroyObject(modelDeps.objectDetails);
+      textureManager.destroyTexture(modelDeps.textureDetails);
+      shaderManager.destroyShaderProgram(modelDeps.shaderDetails);
+    }
+    preloadedModelDeps.clear();
+    preloadedSize = 0;
+  }
+
+  /**
+   * Returns the singleton instance of the scene preloader.
+   * 
+   * @return The scene preloader singleton instance.
+   */
+  static ScenePreloader &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the scene preloader singleton instance static variable.
+ScenePreloader ScenePreloader::instance;
+
+#endif
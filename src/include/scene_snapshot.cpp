@@ -0,0 +1,163 @@
+#ifndef INCLUDE_SCENE_SNAPSHOT_CPP
+#define INCLUDE_SCENE_SNAPSHOT_CPP
+
+#include <vector>
+#include <memory>
+#include <random>
+
+#include <glm/glm.hpp>
+
+#include "transform.cpp"
+#include "models.cpp"
+#include "light.cpp"
+#include "registry.cpp"
+
+/**
+ * Structure for defining the parameters of a light kept by a scene snapshot.
+ */
+struct LightSnapshotState
+{
+  // The position of the light.
+  glm::vec3 position;
+  // The color of the light.
+  glm::vec3 color;
+  // The intensity of the light.
+  float_t intensity;
+};
+
+/**
+ * Class for keeping the models and lights of a scene as its init left them, so that running the scene again brings them back
+ *   instead of creating them again (along with their transforms, colliders and shadow buffers, which stay allocated while the
+ *   scene is not running).
+ * Restoring the snapshot copies the transformations of the models back at once, refits their colliders to them, sets the
+ *   parameters of the lights back, and registers them all again in the order they were captured in.
+ */
+class SceneSnapshot
+{
+private:
+  TransformManager &transformManager;
+  ModelManager &modelManager;
+  LightManager &lightManager;
+
+  // The models of the scene, kept alive between the runs of the scene.
+  std::vector<std::shared_ptr<ModelBaseIntf>> models;
+  // The transformations of the models as the init left them.
+  TransformSnapshot transforms;
+  // The lights of the scene, kept alive between the runs of the scene.
+  std::vector<std::shared_ptr<LightBase>> lights;
+  // The parameters of the lights as the init left them.
+  std::vector<LightSnapshotState> lightStates;
+  // The state of the generator the scene draws the random properties of its models from, as the init left it.
+  std::mt19937 generator;
+  // Whether the snapshot holds a scene.
+  bool isSnapshotCaptured;
+
+public:
+  SceneSnapshot()
+      : transformManager(TransformManager::getInstance()),
+        modelManager(ModelManager::getInstance()),
+        lightManager(LightManager::getInstance()),
+        models(),
+        transforms(),
+        lights(),
+        lightStates(),
+        generator(),
+        isSnapshotCaptured(false) {}
+
+  /**
+   * Capture the given registered models and lights of a scene, right after the scene is initialized.
+   *
+   * @param modelHandles  The handles of the models of the scene.
+   * @param lightHandles  The handles of the lights of the scene.
+   * @param generator     The generator the scene draws the random properties of its models from.
+   */
+  void capture(const std::vector<RegistryHandle> &modelHandles, const std::vector<RegistryHandle> &lightHandles, const std::mt19937 &generator)
+  {
+    clear();
+    models.reserve(modelHandles.size());
+    std::vector<TransformHandle> transformHandles;
+    transformHandles.reserve(modelHandles.size());
+    for (const auto &modelHandle : modelHandles)
+    {
+      models.push_back(modelManager.getModel(modelHandle));
+      transformHandles.push_back(models.back()->getTransformHandle());
+    }
+    transformManager.captureTransforms(transformHandles, transforms);
+
+    lights.reserve(lightHandles.size());
+    lightStates.reserve(lightHandles.size());
+    for (const auto &lightHandle : lightHandles)
+    {
+      lights.push_back(lightManager.getLight(lightHandle));
+      lightStates.push_back({lights.back()->getLightPosition(), lights.back()->getLightColor(), lights.back()->getLightIntensity()});
+    }
+
+    this->generator = generator;
+    isSnapshotCaptured = true;
+  }
+
+  /**
+   * Restore the models and lights of the snapshot as they were captured, and register them again. They must have been
+   *   de-registered since.
+   *
+   * @param modelHandles  The handles of the models of the scene, which the restored ones are added to.
+   * @param lightHandles  The handles of the lights of the scene, which the restored ones are added to.
+   */
+  void restore(std::vector<RegistryHandle> &modelHandles, std::vector<RegistryHandle> &lightHandles)
+  {
+    // Copy the transformations back first, so that the colliders are refit to them before the models are hashed into the
+    //   collision manager and the scene tree by their registration.
+    transformManager.restoreTransforms(transforms);
+    modelManager.reserveModels(models.size());
+    modelHandles.reserve(modelHandles.size() + models.size());
+    for (const auto &model : models)
+    {
+      model->getColliderDetails()->getColliderShape()->updateTransformations(model->getModelPosition(), model->getModelOrientation(), model->getModelScale());
+      model->restoreInitialState();
+      modelHandles.push_back(modelManager.registerModel(std::shared_ptr<ModelBaseIntf>(model)));
+    }
+
+    lightHandles.reserve(lightHandles.size() + lights.size());
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+      lights[i]->setLightPosition(lightStates[i].position);
+      lights[i]->setLightColor(lightStates[i].color);
+      lights[i]->setLightIntensity(lightStates[i].intensity);
+      lightHandles.push_back(lightManager.registerLight(std::shared_ptr<LightBase>(lights[i])));
+    }
+  }
+
+  /**
+   * Release the models and lights of the snapshot (destroying the ones nothing else holds).
+   */
+  void clear()
+  {
+    models.clear();
+    lights.clear();
+    lightStates.clear();
+    transformManager.captureTransforms({}, transforms);
+    isSnapshotCaptured = false;
+  }
+
+  /**
+   * Get the state of the generator the scene draws the random properties of its models from, as it was captured.
+   *
+   * @return The generator.
+   */
+  const std::mt19937 &getGenerator() const
+  {
+    return generator;
+  }
+
+  /**
+   * Check if the snapshot holds a scene to restore.
+   *
+   * @return Whether a scene was captured.
+   */
+  bool isCaptured() const
+  {
+    return isSnapshotCaptured;
+  }
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef INCLUDE_SCENE_TREE_CPP
+#define INCLUDE_SCENE_TREE_CPP
+
+#include <map>
+#include <vector>
+#include <mutex>
+
+#include <glm/glm.hpp>
+
+#include "collider.cpp"
+#include "collision_tree.cpp"
+#include "frustum.cpp"
+
+class ModelBaseIntf;
+
+/**
+ * A manager class for keeping the world AABBs of all the registered models in a loose bounding volume hierarchy, so that the
+ *   renderer can find the models inside a view frustum or the range of a light without testing every model. Unlike the
+ *   collision manager, which only needs the models that collide in the structure it is set to, it always keeps all the models
+ *   in a tree, updated incrementally with the models transformed since the last query.
+ */
+class SceneTreeManager
+{
+private:
+  // Singleton instance of the scene tree manager.
+  static SceneTreeManager instance;
+
+  /**
+   * Structure for defining a model added to the scene tree.
+   */
+  struct SceneTreeEntry
+  {
+    // The collider shape of the model, whose transformed AABB is added to the tree.
+    const ColliderShape *colliderShape;
+    // Whether the model was transformed since its AABB was last updated in the tree.
+    bool isMoved;
+  };
+
+  // The added models, by the model they belong to.
+  std::map<const ModelBaseIntf *, SceneTreeEntry> entries;
+  // The bounding volume hierarchy of the AABBs of the added models, fattened so that small movements do not change it.
+  CollisionTree tree;
+
+  // The models transformed since their AABBs were last updated in the tree.
+  std::vector<const ModelBaseIntf *> movedModels;
+  // The mutex guarding the moved models, since the models updated in parallel mark themselves as moved at the same time.
+  std::mutex movedModelsMutex;
+  // The version of the set of added models, changed whenever a model is added or removed.
+  uint64_t membershipVersion;
+
+  /**
+   * Update the AABBs of the transformed models in the tree, so that they are only read once per query no matter how many times
+   *   the models were transformed since the last one.
+   */
+  void updateMovedModels()
+  {
+    for (const auto &movedModel : movedModels)
+    {
+      // Skip the models removed since they were transformed.
+      const auto entry = entries.find(movedModel);
+      if (entry == entries.end() || !entry->second.isMoved)
+      {
+        continue;
+      }
+
+      const auto &transformedBox = entry->second.colliderShape->getTransformedBox();
+      tree.updateCollider(movedModel, transformedBox.getMinCorner(), transformedBox.getMaxCorner());
+      entry->second.isMoved = false;
+    }
+    movedModels.clear();
+  }
+
+  SceneTreeManager()
+      : entries({}),
+        tree(),
+        movedModels({}),
+        membershipVersion(0) {}
+
+public:
+  // Preventing copying the scene tree manager, making sure only one instance can exist.
+  SceneTreeManager(const SceneTreeManager &) = delete;
+
+  /**
+   * Add a model to the scene tree, with the transformed AABB of its collider.
+   * 
+   * @param model          The model to add.
+   * @param colliderShape  The collider shape of the model, which must live as long as the model is added.
+   */
+  void registerModel(const ModelBaseIntf *model, const ColliderShape *colliderShape)
+  {
+    // Remove any earlier addition of the model.
+    deregisterModel(model);
+
+    entries.emplace(model, SceneTreeEntry{colliderShape, false});
+    const auto &transformedBox = colliderShape->getTransformedBox();
+    tree.insertCollider(model, transformedBox.getMinCorner(), transformedBox.getMaxCorner());
+    membershipVersion++;
+  }
+
+  /**
+   * Remove a model from the scene tree.
+   * 
+   * @param model  The model to remove (ignored if it is not added).
+   */
+  void deregisterModel(const ModelBaseIntf *model)
+  {
+    const auto entry = entries.find(model);
+    if (entry == entries.end())
+    {
+      return;
+    }
+
+    tree.removeCollider(model);
+    entries.erase(entry);
+    membershipVersion++;
+  }
+
+  /**
+   * Get the version of the set of added models.
+   * 
+   * @return The membership version, changed whenever a model is added or removed.
+   */
+  const uint64_t &getMembershipVersion() const
+  {
+    return membershipVersion;
+  }
+
+  /**
+   * Mark a model as transformed, so that its AABB is updated in the tree before the next query. Can be called for different
+   *   models from multiple threads at once, but not while models are added or removed.
+   * 
+   * @param model  The model that was transformed (ignored if it is not added).
+   */
+  void markModelMoved(const ModelBaseIntf *model)
+  {
+    const auto entry = entries.find(model);
+    if (entry == entries.end() || entry->second.isMoved)
+    {
+      return;
+    }
+
+    entry->second.isMoved = true;
+    const std::lock_guard<std::mutex> lock(movedModelsMutex);
+    movedModels.push_back(model);
+  }
+
+  /**
+   * Find the models that can be inside the given frustum (e.g. the view frustum of a camera, or the shadowmap face of a light).
+   * 
+   * @param frustum            The frustum.
+   * @param containedModels    Appended with the models fully inside the frustum.
+   * @param intersectedModels  Appended with the models that may be partially inside the frustum, whose AABBs still need testing.
+   */
+  void queryFrustum(const Frustum &frustum, std::vector<const ModelBaseIntf *> &containedModels, std::vector<const ModelBaseIntf *> &intersectedModels)
+  {
+    updateMovedModels();
+    tree.queryFrustum(frustum, containedModels, intersectedModels);
+  }
+
+  /**
+   * Find the models that can overlap the given sphere (e.g. the range of a light), whose AABBs still need testing.
+   * 
+   * @param center  The center of the sphere.
+   * @param radius  The radius of the sphere.
+   * @param models  Appended with the models.
+   */
+  void querySphere(const glm::vec3 &center, const float_t &radius, std::vector<const ModelBaseIntf *> &models)
+  {
+    updateMovedModels();
+    tree.querySphere(center, radius, models);
+  }
+
+  /**
+   * Returns the singleton instance of the scene tree manager.
+   * 
+   * @return The scene tree manager singleton instance.
+   */
+  static SceneTreeManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the scene tree manager singleton instance static variable.
+SceneTreeManager SceneTreeManager::instance;
+
+#endif
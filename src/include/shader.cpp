@@ -8,9 +8,26 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <optional>
+#include <filesystem>
+#include <iterator>
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
 
 #include <GL/glew.h>
 
+#include "constants.cpp"
+#include "residency_cache.cpp"
+#include "job.cpp"
+#include "gl_debug.cpp"
+#include "asset_archive.cpp"
+#include "name_interner.cpp"
+#include "asset_registry.cpp"
+#include "startup_timer.cpp"
+#include "gpu_deletion.cpp"
+
 /**
  * Class for containing the details of the shader.
  */
@@ -32,13 +49,28 @@ private:
 	// The file path to the fragment shader.
 	const std::string fragmentShaderFilePath;
 
+	// The locations of the uniforms of the shader program, indexed by their uniform IDs.
+	const std::vector<GLint> uniformLocations;
+	// Whether the shaders of the program can be compiled as variants with preprocessor definitions (i.e. they check SHADER_VARIANT).
+	const bool isPermutable;
+
+	// The ID of the program pipeline combining the separable programs of the stages (0 for a shader program linked as a whole).
+	const GLuint pipelineId;
+	// The separable programs of the stages combined by the program pipeline, shared with the other pipelines using the same stages.
+	const std::vector<std::shared_ptr<const ShaderDetails>> stagePrograms;
+
 public:
-	ShaderDetails(const GLuint &shaderId, const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	ShaderDetails(const GLuint &shaderId, const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath, const std::vector<GLint> &uniformLocations, const bool &isPermutable,
+								const GLuint &pipelineId = 0, const std::vector<std::shared_ptr<const ShaderDetails>> &stagePrograms = {})
 			: shaderId(shaderId),
 				shaderName(shaderName),
 				vertexShaderFilePath(vertexShaderFilePath),
 				geometryShaderFilePath(geometryShaderFilePath),
-				fragmentShaderFilePath(fragmentShaderFilePath) {}
+				fragmentShaderFilePath(fragmentShaderFilePath),
+				uniformLocations(uniformLocations),
+				isPermutable(isPermutable),
+				pipelineId(pipelineId),
+				stagePrograms(stagePrograms) {}
 
 	/**
    * Get the name of the shader program.
@@ -59,6 +91,71 @@ public:
 	{
 		return shaderId;
 	}
+
+	/**
+	 * Get the ID of the program pipeline of the shader, which is bound instead of a shader program (with no shader program in use).
+	 * 
+	 * @return The program pipeline ID, or 0 if the shader is a shader program.
+	 */
+	const GLuint &getPipelineId() const
+	{
+		return pipelineId;
+	}
+
+	/**
+   * Get the location of the uniform with the given uniform ID in the shader program.
+   * 
+   * @param uniformId  The ID of the uniform (as returned by the shader manager).
+   * 
+   * @return The location of the uniform, or -1 if the shader program does not use it.
+   */
+	GLint getUniformLocation(const GLuint &uniformId) const
+	{
+		// Any uniform ID created after this program was linked cannot be one of its active uniforms,
+		//   since all active uniforms are given an ID during linking.
+		return uniformId < uniformLocations.size() ? uniformLocations[uniformId] : -1;
+	}
+};
+
+// The preprocessor definitions of a shader program variant, by their names.
+typedef std::map<const std::string, std::string> ShaderDefines;
+
+/**
+ * Structure for storing the details of a shader program that was queued or submitted, but not checked yet.
+ */
+struct PendingShaderProgram
+{
+	// The types and file paths of the shaders of the program, in the order they are linked.
+	std::vector<std::pair<GLenum, std::string>> shaderFilePaths;
+	// Whether the program was submitted to the driver or not.
+	bool isSubmitted;
+	// The ID of the shader program (0 until it is submitted).
+	GLuint programId;
+	// The IDs of the shaders being compiled (empty if the program was loaded from its binary).
+	std::vector<GLuint> shaderIds;
+	// The keys of the shaders being compiled in the compiled shader stages, which the program holds until it is linked.
+	std::vector<std::string> shaderStageKeys;
+	// The path of the program binary cache file to save the program into (empty if it should not be saved).
+	std::string binaryFilePath;
+	// The preprocessor definitions inserted after the version directive of each shader (empty for programs that are not variants).
+	std::string definesCode;
+	// Whether the shaders of the program can be compiled as variants.
+	bool isPermutable;
+	// Whether the program is linked as a separable program of a single stage, to be combined with others by program pipelines.
+	bool isSeparable;
+};
+
+/**
+ * Structure for storing a compiled shader of a single stage, attached to every shader program linked with the same stage code.
+ */
+struct CompiledShaderStage
+{
+	// The ID of the shader.
+	GLuint shaderId;
+	// Whether the compile result of the shader was checked already.
+	bool isChecked;
+	// The number of the submitted shader programs still linking with the shader.
+	uint32_t referencesCount;
 };
 
 /**
@@ -70,13 +167,64 @@ private:
 	// Singleton instance of the shader manager.
 	static ShaderManager instance;
 
-	// A map of created shaders.
-	std::map<const std::string, const std::shared_ptr<const ShaderDetails>> namedShaders;
-	// A map counting the references to the created shaders.
-	std::map<const std::string, int32_t> namedShaderReferences;
+	// The directory the linked shader program binaries are saved in.
+	static constexpr const char *PROGRAM_BINARY_CACHE_DIRECTORY = "assets/shaders/cache/";
+	// The file extension of the saved shader program binaries.
+	static constexpr const char *PROGRAM_BINARY_FILE_EXTENSION = ".programbinary";
+	// The name of the definition that shaders supporting variants check, to tell the defaults apart from the variant definitions.
+	static constexpr const char *SHADER_VARIANT_DEFINE = "SHADER_VARIANT";
+	// The name of the definition that the model shaders check to sample their diffuse textures from the layers of texture arrays.
+	static constexpr const char *DIFFUSE_TEXTURE_ARRAY_DEFINE = "IS_DIFFUSE_TEXTURE_ARRAY";
+	// The definitions of the engine limits inserted into every shader, sizing their arrays the same as the engine does.
+	static const std::string ENGINE_LIMITS_DEFINES_CODE;
+
+	// The name interner the names of the created shaders are interned with.
+	NameInterner &nameInterner;
+	// The GPU deletion queue the programs of the destroyed shader programs are retired to.
+	GpuDeletionQueue &gpuDeletionQueue;
+	// The registry of the created shaders and their reference counts, by their interned names (looked up from any thread).
+	AssetRegistry<const ShaderDetails> namedShaders;
+
+	// A map of the IDs assigned to the names of uniforms used by any shader program.
+	std::map<const std::string, GLuint> namedUniformIds;
+	// A map of the binding points assigned to the names of uniform blocks used by any shader program.
+	std::map<const std::string, GLuint> namedUniformBlockBindings;
+	// A map of the shader codes being read on worker threads, by their file paths.
+	std::map<const std::string, JobFuture<std::optional<std::string>>> prefetchedShaderCodes;
+	// A map of the shader programs that were queued or submitted, waiting to be created.
+	std::map<const std::string, PendingShaderProgram> pendingShaderPrograms;
+	// A map of the compiled shaders, by their stage types and hashed codes (with the definitions inserted).
+	std::map<const std::string, CompiledShaderStage> compiledShaderStages;
+	// The cache keeping the shader programs without references alive, so that the next scene using them does not compile them again.
+	ResidencyCache residencyCache;
+	// The cache keeping the compiled shaders no program is linking with alive, so that the programs sharing a stage compile it once.
+	ResidencyCache shaderStageResidencyCache;
+	// The GL debug manager the shader programs are labeled with.
+	const GlDebugManager &glDebugManager;
+
+	/**
+	 * Read the shader code from the given shader file, without reporting failures so that it can be run on worker threads.
+	 * 
+	 * @param shaderFilePath  The file path to the shader code.
+	 * 
+	 * @return The shader code (empty if the file could not be opened).
+	 */
+	static std::optional<std::string> readShaderCode(const std::string shaderFilePath)
+	{
+		// Read the shader file (or find it in the asset archive).
+		const AssetFile shaderFile(shaderFilePath);
+		// Check if the shader file could be read.
+		if (!shaderFile.isMapped())
+		{
+			return std::nullopt;
+		}
+
+		// Return the contents of the shader file as a string.
+		return std::string(reinterpret_cast<const char *>(shaderFile.getData()), shaderFile.getSize());
+	}
 
 	/**
-	 * Read the shader code from the given shader file.
+	 * Get the shader code of the given shader file, using the prefetched code if it was read in the background.
 	 * 
 	 * @param shaderName      The name of the shader program being loaded.
 	 * @param shaderFilePath  The file path to the shader code.
@@ -85,10 +233,21 @@ private:
 	 */
 	std::string loadShaderCode(const std::string &shaderName, const std::string &shaderFilePath)
 	{
-		// Create an input file stream for reading the shader file.
-		const std::ifstream shaderStream(shaderFilePath, std::ios::in);
-		// Check if the input file stream is open.
-		if (!shaderStream.is_open())
+		// Take the prefetched code if there is any, or read the file now.
+		std::optional<std::string> shaderCode;
+		const auto prefetchedShaderCode = prefetchedShaderCodes.find(shaderFilePath);
+		if (prefetchedShaderCode != prefetchedShaderCodes.end())
+		{
+			shaderCode = prefetchedShaderCode->second.get();
+			prefetchedShaderCodes.erase(prefetchedShaderCode);
+		}
+		else
+		{
+			shaderCode = readShaderCode(shaderFilePath);
+		}
+
+		// Check if the shader file could be read.
+		if (!shaderCode.has_value())
 		{
 			// Couldn't open the input file stream. Time to crash.
 			std::cout << shaderName << std::endl
@@ -96,23 +255,171 @@ private:
 			exit(1);
 		}
 
-		// Define a stringstream to read the file contents into.
-		std::stringstream sstr;
-		// Push the contents of the input file stream into the string stream.
-		sstr << shaderStream.rdbuf();
+		// Return the shader code.
+		return shaderCode.value();
+	}
 
-		// Return the string contents of the string stream.
-		return sstr.str();
+	/**
+	 * Check if the driver can save and load linked shader programs as binaries.
+	 * 
+	 * @return Whether program binaries are supported or not.
+	 */
+	static bool isProgramBinarySupported()
+	{
+		// Some drivers expose the extension without supporting any binary format.
+		GLint binaryFormatsCount = 0;
+		if (GLEW_ARB_get_program_binary)
+		{
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatsCount);
+		}
+		return binaryFormatsCount > 0;
 	}
 
 	/**
-	 * Compiles the given shader code to the given shader.
+	 * Get the path of the program binary cache file for the given shader codes. The file is named after a hash of the codes
+	 *   and the driver details, so that editing a shader or updating the driver never loads an outdated binary.
+	 * 
+	 * @param shaderCodes  The codes of the shaders of the program, in the order they are linked.
+	 * 
+	 * @return The path of the program binary cache file.
+	 */
+	static std::string getProgramBinaryFilePath(const std::vector<std::string> &shaderCodes, const bool &isSeparable)
+	{
+		// Collect the driver details, since binaries can only be loaded by the same driver that saved them.
+		std::vector<std::string> keyParts;
+		for (const auto &driverDetail : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+		{
+			const auto driverDetailString = reinterpret_cast<const char *>(glGetString(driverDetail));
+			keyParts.push_back(driverDetailString != nullptr ? driverDetailString : "");
+		}
+		// Separable programs are linked differently from the programs linked with the same shaders as a whole.
+		keyParts.push_back(isSeparable ? "separable" : "");
+		keyParts.insert(keyParts.end(), shaderCodes.begin(), shaderCodes.end());
+
+		// Format the hash as the file name.
+		return std::string(PROGRAM_BINARY_CACHE_DIRECTORY) + hashKeyParts(keyParts) + PROGRAM_BINARY_FILE_EXTENSION;
+	}
+
+	/**
+	 * Hash the given key parts using FNV-1a, including the terminating zeros so that the parts cannot run into each other.
+	 * 
+	 * @param keyParts  The parts of the key.
+	 * 
+	 * @return The hash, formatted as hexadecimal digits.
+	 */
+	static std::string hashKeyParts(const std::vector<std::string> &keyParts)
+	{
+		uint64_t hash = 0xcbf29ce484222325;
+		for (const auto &keyPart : keyParts)
+		{
+			for (size_t i = 0; i <= keyPart.size(); i++)
+			{
+				hash = (hash ^ static_cast<uint8_t>(keyPart.c_str()[i])) * 0x100000001b3;
+			}
+		}
+
+		char hashString[17];
+		snprintf(hashString, sizeof(hashString), "%016llx", static_cast<unsigned long long>(hash));
+		return hashString;
+	}
+
+	/**
+	 * Create a shader program from the given program binary cache file.
+	 * 
+	 * @param binaryFilePath  The path of the program binary cache file.
+	 * @param isSeparable     Whether the shader program is a separable program.
+	 * 
+	 * @return The ID of the shader program (0 if the file is missing, or the driver rejects the binary).
+	 */
+	static GLuint loadProgramBinary(const std::string &binaryFilePath, const bool &isSeparable)
+	{
+		// Read the whole binary file, which starts with the format of the binary.
+		std::ifstream binaryStream(binaryFilePath, std::ios::in | std::ios::binary);
+		if (!binaryStream.is_open())
+		{
+			return 0;
+		}
+		const std::vector<char> fileData((std::istreambuf_iterator<char>(binaryStream)), std::istreambuf_iterator<char>());
+		if (fileData.size() <= sizeof(GLenum))
+		{
+			return 0;
+		}
+		GLenum binaryFormat;
+		memcpy(&binaryFormat, &fileData[0], sizeof(GLenum));
+
+		// Create the shader program from the binary, and check if the driver accepted it.
+		const auto programId = glCreateProgram();
+		if (isSeparable)
+		{
+			glProgramParameteri(programId, GL_PROGRAM_SEPARABLE, GL_TRUE);
+		}
+		glProgramBinary(programId, binaryFormat, &fileData[sizeof(GLenum)], fileData.size() - sizeof(GLenum));
+		auto result = GL_FALSE;
+		glGetProgramiv(programId, GL_LINK_STATUS, &result);
+		if (result == GL_FALSE)
+		{
+			// The binary is not valid anymore, so compile the program from source instead.
+			glDeleteProgram(programId);
+			return 0;
+		}
+
+		// Return the ID of the created shader program.
+		return programId;
+	}
+
+	/**
+	 * Save the given linked shader program into the given program binary cache file.
+	 * 
+	 * @param binaryFilePath  The path of the program binary cache file.
+	 * @param programId       The ID of the shader program.
+	 */
+	static void saveProgramBinary(const std::string &binaryFilePath, const GLuint &programId)
+	{
+		// Get the binary of the program.
+		GLint binaryLength = 0;
+		glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		if (binaryLength <= 0)
+		{
+			return;
+		}
+		std::vector<char> binaryData(binaryLength);
+		GLenum binaryFormat;
+		glGetProgramBinary(programId, binaryLength, nullptr, &binaryFormat, &binaryData[0]);
+
+		// Write to a temporary file first, so that a binary being written is never loaded half finished.
+		// Failing to write the cache is not an error, since it only makes the next launch slower.
+		std::error_code errorCode;
+		std::filesystem::create_directories(PROGRAM_BINARY_CACHE_DIRECTORY, errorCode);
+		const auto tempFilePath = binaryFilePath + ".tmp";
+		{
+			std::ofstream binaryStream(tempFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!binaryStream.is_open())
+			{
+				return;
+			}
+			binaryStream.write(reinterpret_cast<const char *>(&binaryFormat), sizeof(GLenum));
+			binaryStream.write(&binaryData[0], binaryLength);
+			if (!binaryStream.good())
+			{
+				binaryStream.close();
+				remove(tempFilePath.c_str());
+				return;
+			}
+		}
+		std::filesystem::rename(tempFilePath, binaryFilePath, errorCode);
+		if (errorCode)
+		{
+			remove(tempFilePath.c_str());
+		}
+	}
+
+	/**
+	 * Start compiling the given shader code to the given shader, without waiting for the result.
 	 * 
-	 * @param shaderName  The name of the shader program being compiled.
 	 * @param shaderCode  The shader code.
 	 * @param shaderId    The ID of the shader.
 	 */
-	void compileShader(const std::string &shaderName, const std::string &shaderCode, const GLuint &shaderId)
+	void compileShader(const std::string &shaderCode, const GLuint &shaderId)
 	{
 		// Convert the shader source code string into a character array.
 		const auto sourcePointer = shaderCode.c_str();
@@ -120,7 +427,16 @@ private:
 		glShaderSource(shaderId, 1, &sourcePointer, NULL);
 		// Compile the shader.
 		glCompileShader(shaderId);
+	}
 
+	/**
+	 * Check the compilation result of the given shader, waiting for it if it is still compiling.
+	 * 
+	 * @param shaderName  The name of the shader program being compiled.
+	 * @param shaderId    The ID of the shader.
+	 */
+	void checkShader(const std::string &shaderName, const GLuint &shaderId)
+	{
 		// Define variables for capturing the compilation result information.
 		auto result = GL_FALSE;
 		int32_t infoLogLength;
@@ -141,15 +457,26 @@ private:
 	}
 
 	/**
-	 * Creates a shader program using the list of given shaders (vertex, geometry, fragment).
+	 * Start linking a shader program using the list of given shaders (vertex, geometry, fragment), without waiting for the result.
 	 * 
-	 * @param shaderName  The name of the shader program being compiled.
-	 * @param shaderIds   The IDs of the shaders to link together.
+	 * @param shaderIds    The IDs of the shaders to link together.
+	 * @param isSeparable  Whether the shader program is linked as a separable program, to be combined by program pipelines.
+	 * 
+	 * @return The ID of the created shader program.
 	 */
-	GLuint createProgram(const std::string &shaderName, const std::vector<GLuint> &shaderIds)
+	GLuint createProgram(const std::vector<GLuint> &shaderIds, const bool &isSeparable)
 	{
 		// Create a new shader program.
 		const auto programId = glCreateProgram();
+		if (isSeparable)
+		{
+			glProgramParameteri(programId, GL_PROGRAM_SEPARABLE, GL_TRUE);
+		}
+		// Let the driver know that the binary of the program will be saved.
+		if (isProgramBinarySupported())
+		{
+			glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
 		// Iterate through the IDs of the shader.
 		for (const auto &shaderId : shaderIds)
 		{
@@ -159,6 +486,18 @@ private:
 		// Link the shader together.
 		glLinkProgram(programId);
 
+		// Return the ID of the created shader program.
+		return programId;
+	}
+
+	/**
+	 * Check the link result of the given shader program, waiting for it if it is still linking.
+	 * 
+	 * @param shaderName  The name of the shader program being compiled.
+	 * @param programId   The ID of the shader program.
+	 */
+	void checkProgram(const std::string &shaderName, const GLuint &programId)
+	{
 		// Define variables for capturing the compilation result information.
 		auto result = GL_FALSE;
 		int32_t infoLogLength;
@@ -176,151 +515,612 @@ private:
 								<< "Failed at shader 3" << std::endl;
 			exit(1);
 		}
+	}
 
-		// Return the ID of the created shader program.
-		return programId;
+	/**
+	 * Stores the location of the given uniform in the given table of uniform locations, growing the table if required.
+	 * 
+	 * @param programId         The ID of the shader program.
+	 * @param uniformName       The name of the uniform.
+	 * @param uniformLocations  The table of uniform locations indexed by uniform ID.
+	 */
+	void storeUniformLocation(const GLuint &programId, const std::string &uniformName, std::vector<GLint> &uniformLocations)
+	{
+		// Get the ID of the uniform.
+		const auto uniformId = getUniformId(uniformName);
+		// Grow the table of locations so that it can contain the uniform ID.
+		if (uniformId >= uniformLocations.size())
+		{
+			uniformLocations.resize(uniformId + 1, -1);
+		}
+		// Store the location of the uniform in the table.
+		uniformLocations[uniformId] = glGetUniformLocation(programId, uniformName.c_str());
 	}
 
 	/**
-	 * Loads a shader program using the given vertex shader file and fragment shader file.
+	 * Introspect the given shader program and create a table of the locations of all its active uniforms.
 	 * 
-	 * @param shaderName              The name of the shader program being loaded.
-	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
-	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * @param programId  The ID of the shader program.
 	 * 
-	 * @return The ID of the shader program.
+	 * @return The table of uniform locations indexed by uniform ID.
 	 */
-	GLuint loadShaders(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath)
+	std::vector<GLint> createUniformLocations(const GLuint &programId)
 	{
-		// Create a vertex shader.
-		const auto vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-		// Create a fragment shader.
-		const auto fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+		// Define the table of uniform locations.
+		std::vector<GLint> uniformLocations;
 
-		// Load the vertex shader code.
-		const auto vertexShaderCode = loadShaderCode(shaderName, vertexShaderFilePath);
-		// Load the fragment shader code.
-		const auto fragmentShaderCode = loadShaderCode(shaderName, fragmentShaderFilePath);
+		// Get the number of active uniforms and the longest uniform name in the shader program.
+		int32_t uniformsCount = 0, maxUniformNameLength = 0;
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &uniformsCount);
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformNameLength);
 
-		// Compile the vertex shader code.
-		compileShader(shaderName, vertexShaderCode, vertexShaderId);
-		// Compile the fragment shader code.
-		compileShader(shaderName, fragmentShaderCode, fragmentShaderId);
+		// Iterate through the active uniforms.
+		std::vector<char> uniformNameBuffer(maxUniformNameLength + 1);
+		for (int32_t i = 0; i < uniformsCount; i++)
+		{
+			// Get the name and array size of the uniform.
+			GLsizei uniformNameLength = 0;
+			GLint uniformSize = 0;
+			GLenum uniformType = 0;
+			glGetActiveUniform(programId, i, uniformNameBuffer.size(), &uniformNameLength, &uniformSize, &uniformType, &uniformNameBuffer[0]);
+			const auto uniformName = std::string(&uniformNameBuffer[0], uniformNameLength);
 
-		// Create the shader program using the vertex shader and fragment shader.
-		const auto programId = createProgram(shaderName, std::vector<GLuint>({vertexShaderId, fragmentShaderId}));
+			// Check if the uniform is an array (array uniforms are reported with a "[0]" suffix).
+			const auto arraySuffix = std::string("[0]");
+			if (uniformName.size() > arraySuffix.size() && uniformName.compare(uniformName.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0)
+			{
+				// Store the location of the array by its base name and of each of its elements.
+				const auto baseUniformName = uniformName.substr(0, uniformName.size() - arraySuffix.size());
+				storeUniformLocation(programId, baseUniformName, uniformLocations);
+				for (GLint j = 0; j < uniformSize; j++)
+				{
+					storeUniformLocation(programId, baseUniformName + "[" + std::to_string(j) + "]", uniformLocations);
+				}
+			}
+			else
+			{
+				// Store the location of the uniform.
+				storeUniformLocation(programId, uniformName, uniformLocations);
+			}
+		}
 
-		// Detach and delete the vertex shader since it's no longer required.
-		glDetachShader(programId, vertexShaderId);
-		glDeleteShader(vertexShaderId);
+		// Return the table of uniform locations.
+		return uniformLocations;
+	}
 
-		// Detach and delete the fragment shader since it's no longer required.
-		glDetachShader(programId, fragmentShaderId);
-		glDeleteShader(fragmentShaderId);
+	/**
+	 * Introspect the given shader program and bind all its active uniform blocks to the binding points assigned to their names.
+	 * 
+	 * @param programId  The ID of the shader program.
+	 */
+	void bindUniformBlocks(const GLuint &programId)
+	{
+		// Get the number of active uniform blocks and the longest uniform block name in the shader program.
+		int32_t uniformBlocksCount = 0, maxUniformBlockNameLength = 0;
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCKS, &uniformBlocksCount);
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxUniformBlockNameLength);
 
-		// Return the shader program ID.
-		return programId;
+		// Iterate through the active uniform blocks.
+		std::vector<char> uniformBlockNameBuffer(maxUniformBlockNameLength + 1);
+		for (int32_t i = 0; i < uniformBlocksCount; i++)
+		{
+			// Get the name of the uniform block.
+			GLsizei uniformBlockNameLength = 0;
+			glGetActiveUniformBlockName(programId, i, uniformBlockNameBuffer.size(), &uniformBlockNameLength, &uniformBlockNameBuffer[0]);
+			const auto uniformBlockName = std::string(&uniformBlockNameBuffer[0], uniformBlockNameLength);
+
+			// Bind the uniform block to the binding point assigned to its name.
+			glUniformBlockBinding(programId, i, getUniformBlockBinding(uniformBlockName));
+		}
 	}
 
 	/**
-	 * Loads a shader program using the given vertex shader file, geometry shader file and fragment shader file.
+	 * Create the preprocessor definitions of the engine limits, which every shader is compiled with.
 	 * 
-	 * @param shaderName              The name of the shader program being loaded.
-	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
-	 * @param geometryShaderFilePath  The file path to the geometry shader source code.
-	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * @return The preprocessor definitions code.
+	 */
+	static std::string createEngineLimitsDefinesCode()
+	{
+		const auto createDefine = [](const std::string &name, const int64_t &value) {
+			return "#define " + name + " " + std::to_string(value) + "\n";
+		};
+		return createDefine(LightLimit<LightLimitType::CONE>::SHADER_DEFINE, LightLimit<LightLimitType::CONE>::MAX_COUNT) +
+				createDefine(LightLimit<LightLimitType::POINT>::SHADER_DEFINE, LightLimit<LightLimitType::POINT>::MAX_COUNT) +
+				createDefine("MAX_SHADOW_LIGHTS", EngineLimits::MAX_SHADOW_LIGHTS) +
+				createDefine("POINT_SHADOW_MAX_VERTICES", EngineLimits::POINT_SHADOW_MAX_VERTICES) +
+				createDefine("SHADOW_MASK_LAYERS_COUNT", EngineLimits::SHADOW_MASK_LAYERS_COUNT) +
+				createDefine("LOD_COUNT", EngineLimits::OBJECT_LOD_COUNT);
+	}
+
+	/**
+	 * Insert the given preprocessor definitions into the given shader code, right after its version directive (which has to come first).
+	 * A line directive is added after the definitions, so that compile errors still report the line numbers of the shader file.
 	 * 
-	 * @return The ID of the shader program.
+	 * @param shaderCode   The shader code to insert the definitions into.
+	 * @param definesCode  The preprocessor definitions.
 	 */
-	GLuint loadShaders(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	static void insertShaderDefines(std::string &shaderCode, const std::string &definesCode)
 	{
-		// Create a vertex shader.
-		const auto vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-		// Create a geometry shader.
-		const auto geometryShaderId = glCreateShader(GL_GEOMETRY_SHADER);
-		// Create a fragment shader.
-		const auto fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+		// Find the start of the line after the version directive.
+		const auto versionPosition = shaderCode.find("#version");
+		auto insertPosition = versionPosition == std::string::npos ? 0 : shaderCode.find('\n', versionPosition);
+		insertPosition = insertPosition == std::string::npos ? shaderCode.size() : insertPosition + (versionPosition == std::string::npos ? 0 : 1);
 
-		// Load the vertex shader code.
-		const auto vertexShaderCode = loadShaderCode(shaderName, vertexShaderFilePath);
-		// Load the geometry shader code.
-		const auto geometryShaderCode = loadShaderCode(shaderName, geometryShaderFilePath);
-		// Load the fragment shader code.
-		const auto fragmentShaderCode = loadShaderCode(shaderName, fragmentShaderFilePath);
+		// Insert the definitions, followed by the number of the next line of the shader file.
+		const auto nextLineNumber = std::count(shaderCode.begin(), shaderCode.begin() + insertPosition, '\n') + 1;
+		shaderCode.insert(insertPosition, definesCode + "#line " + std::to_string(nextLineNumber) + "\n");
+	}
 
-		// Compile the vertex shader code.
-		compileShader(shaderName, vertexShaderCode, vertexShaderId);
-		// Compile the geometry shader code.
-		compileShader(shaderName, geometryShaderCode, geometryShaderId);
-		// Compile the fragment shader code.
-		compileShader(shaderName, fragmentShaderCode, fragmentShaderId);
+	/**
+	 * Delete the shader program with the given name, and remove it from the created shader programs.
+	 * 
+	 * @param shaderName  The name of the shader program to delete.
+	 */
+	void deleteShaderProgram(const std::string shaderName)
+	{
+		// Get the shader program before removing it.
+		const auto shaderNameId = nameInterner.intern(shaderName);
+		const auto shaderDetails = namedShaders.at(shaderNameId);
+		// Remove the shader program from the created shader programs, along with its reference count.
+		namedShaders.erase(shaderNameId);
+		// Retire the shader program (or the program pipeline), since the frames still in flight may draw with it.
+		if (shaderDetails->pipelineId == 0)
+		{
+			gpuDeletionQueue.retireProgram(shaderDetails->shaderId);
+			return;
+		}
+		gpuDeletionQueue.retireProgramPipeline(shaderDetails->pipelineId);
+		// Drop the references of the pipeline to the separable programs of its stages.
+		for (const auto &stageProgram : shaderDetails->stagePrograms)
+		{
+			destroyShaderProgram(stageProgram);
+		}
+	}
 
-		// Create the shader program using the vertex shader, geometry shader and fragment shader.
-		const auto programId = createProgram(shaderName, std::vector<GLuint>({vertexShaderId, geometryShaderId, fragmentShaderId}));
+	/**
+	 * Get the compiled shader of the given stage code, and start compiling it if no other shader program was linked with the same
+	 *   code recently. The compiled shader is held until the program linking with it releases it.
+	 * 
+	 * @param shaderType  The type of the shader.
+	 * @param shaderCode  The shader code, with the definitions inserted.
+	 * 
+	 * @return The key of the compiled shader in the compiled shader stages.
+	 */
+	std::string acquireShaderStage(const GLenum &shaderType, const std::string &shaderCode)
+	{
+		const auto shaderStageKey = std::to_string(shaderType) + ":" + hashKeyParts({shaderCode});
+		const auto existingShaderStage = compiledShaderStages.find(shaderStageKey);
+		if (existingShaderStage != compiledShaderStages.end())
+		{
+			// Take the shader out of the residency cache if no program was linking with it.
+			shaderStageResidencyCache.acquire(shaderStageKey);
+			existingShaderStage->second.referencesCount++;
+			return shaderStageKey;
+		}
+
+		const auto shaderId = glCreateShader(shaderType);
+		compileShader(shaderCode, shaderId);
+		compiledShaderStages.emplace(shaderStageKey, CompiledShaderStage({shaderId, false, 1}));
+		return shaderStageKey;
+	}
+
+	/**
+	 * Release the compiled shaders the given pending shader program linked with, keeping the ones no program links with anymore
+	 *   in the residency cache, and deleting the ones that do not fit its budget.
+	 * 
+	 * @param pendingShaderProgram  The pending shader program.
+	 */
+	void releaseShaderStages(PendingShaderProgram &pendingShaderProgram)
+	{
+		for (const auto &shaderStageKey : pendingShaderProgram.shaderStageKeys)
+		{
+			auto &shaderStage = compiledShaderStages.at(shaderStageKey);
+			if (--shaderStage.referencesCount > 0)
+			{
+				continue;
+			}
+			for (const auto &evictedShaderStageKey : shaderStageResidencyCache.release(shaderStageKey, 1))
+			{
+				glDeleteShader(compiledShaderStages.at(evictedShaderStageKey).shaderId);
+				compiledShaderStages.erase(evictedShaderStageKey);
+			}
+		}
+		pendingShaderProgram.shaderIds.clear();
+		pendingShaderProgram.shaderStageKeys.clear();
+	}
 
-		// Detach and delete the vertex shader since it's no longer required.
-		glDetachShader(programId, vertexShaderId);
-		glDeleteShader(vertexShaderId);
+	/**
+	 * Check if the shaders can be linked as separable programs of single stages, combined by program pipelines.
+	 * 
+	 * @return Whether separate shader stages are enabled and supported or not.
+	 */
+	static bool isSeparateShaderStagesSupported()
+	{
+		return IS_SEPARATE_SHADER_STAGES_ENABLED && GLEW_ARB_separate_shader_objects;
+	}
 
-		// Detach and delete the geometry shader since it's no longer required.
-		glDetachShader(programId, geometryShaderId);
-		glDeleteShader(geometryShaderId);
+	/**
+	 * Get the bit of the program pipeline stage of the given shader type.
+	 * 
+	 * @param shaderType  The type of the shader.
+	 * 
+	 * @return The bit of the stage.
+	 */
+	static GLbitfield getShaderStageBit(const GLenum &shaderType)
+	{
+		switch (shaderType)
+		{
+		case GL_VERTEX_SHADER:
+			return GL_VERTEX_SHADER_BIT;
+		case GL_GEOMETRY_SHADER:
+			return GL_GEOMETRY_SHADER_BIT;
+		case GL_COMPUTE_SHADER:
+			return GL_COMPUTE_SHADER_BIT;
+		default:
+			return GL_FRAGMENT_SHADER_BIT;
+		}
+	}
 
-		// Detach and delete the fragment shader since it's no longer required.
-		glDetachShader(programId, fragmentShaderId);
-		glDeleteShader(fragmentShaderId);
+	/**
+	 * Check if the shader codes of the given pending shader program were read, so that submitting it does not wait for any file.
+	 * 
+	 * @param pendingShaderProgram  The pending shader program.
+	 * 
+	 * @return Whether the shader codes are available or not.
+	 */
+	bool isShaderCodeRead(const PendingShaderProgram &pendingShaderProgram) const
+	{
+		for (const auto &shaderFilePath : pendingShaderProgram.shaderFilePaths)
+		{
+			// Shader files that are not being prefetched (e.g. already used by another program) are read right away.
+			const auto prefetchedShaderCode = prefetchedShaderCodes.find(shaderFilePath.second);
+			if (prefetchedShaderCode != prefetchedShaderCodes.end() && !prefetchedShaderCode->second.isReady())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Start creating the given pending shader program, either from its saved program binary, or by compiling and linking its shader codes
+	 *   without waiting for the results, so that the driver can work on multiple programs at once.
+	 * 
+	 * @param shaderName            The name of the shader program being loaded.
+	 * @param pendingShaderProgram  The pending shader program.
+	 */
+	void submitShaders(const std::string &shaderName, PendingShaderProgram &pendingShaderProgram)
+	{
+		// Load the shader codes.
+		std::vector<std::string> shaderCodes;
+		{
+			STARTUP_PHASE("Shader Read", shaderName);
+			for (const auto &shaderFilePath : pendingShaderProgram.shaderFilePaths)
+			{
+				shaderCodes.push_back(loadShaderCode(shaderName, shaderFilePath.second));
+			}
+		}
+		pendingShaderProgram.isSubmitted = true;
+
+		// Check if the shaders support variants, and insert the definitions of the variant along with the ones of the engine limits
+		//   and of the options that all the shaders follow. The limits end up in the keys of the program binaries, so changing
+		//   them recompiles the programs.
+		const auto definesCode = ENGINE_LIMITS_DEFINES_CODE + (IS_TEXTURE_ARRAY_BATCHING_ENABLED ? std::string("#define ") + DIFFUSE_TEXTURE_ARRAY_DEFINE + " 1\n" : std::string()) + pendingShaderProgram.definesCode;
+		for (auto &shaderCode : shaderCodes)
+		{
+			pendingShaderProgram.isPermutable = pendingShaderProgram.isPermutable || shaderCode.find(SHADER_VARIANT_DEFINE) != std::string::npos;
+			insertShaderDefines(shaderCode, definesCode);
+		}
+
+		// Skip compiling if the program binary was saved by an earlier launch.
+		const auto isBinarySupported = isProgramBinarySupported();
+		pendingShaderProgram.binaryFilePath = isBinarySupported ? getProgramBinaryFilePath(shaderCodes, pendingShaderProgram.isSeparable) : "";
+		{
+			STARTUP_PHASE("Shader Binary", shaderName);
+			pendingShaderProgram.programId = isBinarySupported ? loadProgramBinary(pendingShaderProgram.binaryFilePath, pendingShaderProgram.isSeparable) : 0;
+		}
+		if (pendingShaderProgram.programId != 0)
+		{
+			pendingShaderProgram.binaryFilePath = "";
+			return;
+		}
+
+		// Let the driver use as many compiler threads as it likes.
+		if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		}
+
+		// Create and start compiling the shaders, sharing the ones already compiled for the other programs with the same stage codes
+		//   (e.g. the vertex shaders of the fullscreen passes).
+		{
+			STARTUP_PHASE("Shader Compile", shaderName);
+			for (size_t i = 0; i < shaderCodes.size(); i++)
+			{
+				const auto shaderStageKey = acquireShaderStage(pendingShaderProgram.shaderFilePaths[i].first, shaderCodes[i]);
+				pendingShaderProgram.shaderStageKeys.push_back(shaderStageKey);
+				pendingShaderProgram.shaderIds.push_back(compiledShaderStages.at(shaderStageKey).shaderId);
+			}
+		}
+
+		// Start linking the shader program.
+		STARTUP_PHASE("Shader Link", shaderName);
+		pendingShaderProgram.programId = createProgram(pendingShaderProgram.shaderIds, pendingShaderProgram.isSeparable);
+	}
+
+	/**
+	 * Finish creating the given submitted shader program, checking the results of compiling and linking it.
+	 * 
+	 * @param shaderName            The name of the shader program being loaded.
+	 * @param pendingShaderProgram  The submitted shader program.
+	 * 
+	 * @return The ID of the shader program.
+	 */
+	GLuint finishShaders(const std::string &shaderName, PendingShaderProgram &pendingShaderProgram)
+	{
+		const auto programId = pendingShaderProgram.programId;
+		// Programs loaded from their binaries were already checked.
+		if (pendingShaderProgram.shaderIds.empty())
+		{
+			return programId;
+		}
+
+		// Check the results of compiling the shaders and linking the program, which is where the driver is waited for if it compiles
+		//   them in the background.
+		{
+			STARTUP_PHASE("Shader Compile Wait", shaderName);
+			for (const auto &shaderStageKey : pendingShaderProgram.shaderStageKeys)
+			{
+				// The shaders shared with the programs linked earlier were checked with them.
+				auto &shaderStage = compiledShaderStages.at(shaderStageKey);
+				if (!shaderStage.isChecked)
+				{
+					checkShader(shaderName, shaderStage.shaderId);
+					shaderStage.isChecked = true;
+				}
+			}
+		}
+		{
+			STARTUP_PHASE("Shader Link Wait", shaderName);
+			checkProgram(shaderName, programId);
+		}
+
+		// Detach the shaders and release them since the program no longer requires them, keeping them for the next programs
+		//   linking with the same stages.
+		for (const auto &shaderId : pendingShaderProgram.shaderIds)
+		{
+			glDetachShader(programId, shaderId);
+		}
+		releaseShaderStages(pendingShaderProgram);
+
+		// Save the program binary for the next launch.
+		if (!pendingShaderProgram.binaryFilePath.empty())
+		{
+			saveProgramBinary(pendingShaderProgram.binaryFilePath, programId);
+		}
 
 		// Return the shader program ID.
 		return programId;
 	}
 
+	/**
+	 * Load and create a shader program from the given shader file paths, using the submitted program if there is one.
+	 * If a shader program with the same name was already created, return the same shader program.
+	 * 
+	 * @param shaderName       The name of the shader program being loaded.
+	 * @param shaderFilePaths  The types and file paths of the shaders of the program, in the order they are linked.
+	 * @param definesCode      The preprocessor definitions to insert into the shaders (if the program was not submitted earlier).
+	 * @param isSeparable      Whether the program is linked as a separable program (if the program was not submitted earlier).
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	std::shared_ptr<const ShaderDetails> loadShaderProgram(const std::string &shaderName, const std::vector<std::pair<GLenum, std::string>> &shaderFilePaths, const std::string &definesCode = "", const bool &isSeparable = false)
+	{
+		// Check if an shader program with the name already exists.
+		const auto shaderNameId = nameInterner.intern(shaderName);
+		const auto existingShader = namedShaders.find(shaderNameId);
+		if (existingShader != nullptr)
+		{
+			// Shader already loaded. Take it out of the residency cache if it had no references, increase its reference count and return it.
+			residencyCache.acquire(shaderName);
+			namedShaders.addReference(shaderNameId);
+			return existingShader;
+		}
+
+		// Take the pending shader program if it was submitted earlier, or create a new one.
+		PendingShaderProgram pendingShaderProgram = {shaderFilePaths, false, 0, {}, {}, "", definesCode, false, isSeparable};
+		const auto existingPendingShaderProgram = pendingShaderPrograms.find(shaderName);
+		if (existingPendingShaderProgram != pendingShaderPrograms.end())
+		{
+			pendingShaderProgram = existingPendingShaderProgram->second;
+			pendingShaderPrograms.erase(existingPendingShaderProgram);
+		}
+		if (!pendingShaderProgram.isSubmitted)
+		{
+			submitShaders(shaderName, pendingShaderProgram);
+		}
+
+		// Finish loading the shader program and store its details.
+		const auto shaderProgramId = finishShaders(shaderName, pendingShaderProgram);
+		// Create the table of the uniform locations of the shader program.
+		const auto uniformLocations = createUniformLocations(shaderProgramId);
+		// Bind the uniform blocks of the shader program to their shared binding points.
+		bindUniformBlocks(shaderProgramId);
+		// Label the shader program with its name.
+		glDebugManager.labelObject(GL_PROGRAM, shaderProgramId, shaderName);
+
+		// Create a new shader program details with the captured data.
+		const auto newShader = std::make_shared<const ShaderDetails>(shaderProgramId, shaderName, shaderFilePaths.front().second, shaderFilePaths.size() > 2 ? shaderFilePaths[1].second : "", shaderFilePaths.back().second, uniformLocations, pendingShaderProgram.isPermutable);
+
+		// Register the newly created shader program with a reference count of 1.
+		namedShaders.insert(shaderNameId, newShader);
+
+		// Return the shader program details.
+		return newShader;
+	}
+
+	/**
+	 * Queue a shader program to be submitted once its shader codes are read in the background. Does nothing if a shader program
+	 *   with the same name was already created or submitted.
+	 * 
+	 * @param shaderName       The name of the shader program.
+	 * @param shaderFilePaths  The types and file paths of the shaders of the program, in the order they are linked.
+	 * @param definesCode      The preprocessor definitions to insert into the shaders (for variants).
+	 */
+	void queueShaderProgram(const std::string &shaderName, const std::vector<std::pair<GLenum, std::string>> &shaderFilePaths, const std::string &definesCode = "")
+	{
+		if (namedShaders.contains(nameInterner.intern(shaderName)) || pendingShaderPrograms.find(shaderName) != pendingShaderPrograms.end())
+		{
+			return;
+		}
+
+		// Start reading the shader codes.
+		for (const auto &shaderFilePath : shaderFilePaths)
+		{
+			prefetchShaderCode(shaderFilePath.second);
+		}
+		pendingShaderPrograms.emplace(shaderName, PendingShaderProgram({shaderFilePaths, false, 0, {}, {}, "", definesCode, false, false}));
+	}
+
 	ShaderManager()
-			: namedShaders({}),
-				namedShaderReferences({}) {}
+			: nameInterner(NameInterner::getInstance()),
+				gpuDeletionQueue(GpuDeletionQueue::getInstance()),
+				namedShaders(),
+				namedUniformIds({}),
+				namedUniformBlockBindings({}),
+				prefetchedShaderCodes(),
+				pendingShaderPrograms(),
+				compiledShaderStages(),
+				residencyCache(SHADER_RESIDENCY_BUDGET),
+				shaderStageResidencyCache(SHADER_STAGE_RESIDENCY_BUDGET),
+				glDebugManager(GlDebugManager::getInstance()) {}
 
 public:
 	// Preventing copying the shader manager, making sure only one instance can exist.
 	ShaderManager(const ShaderManager &) = delete;
 
 	/**
-	 * Load and create a shader program from the given shader file paths. If a shader program with the same name was already created,
-	 * return the same shader program.
+	 * Start reading the shader code of the given shader file on a worker thread, so that creating a shader program with it later
+	 * does not wait for the file. Does nothing if the file is already being read.
 	 * 
-	 * @param shaderName              The name of the shader program being loaded.
+	 * @param shaderFilePath  The file path to the shader code.
+	 */
+	void prefetchShaderCode(const std::string &shaderFilePath)
+	{
+		if (prefetchedShaderCodes.find(shaderFilePath) != prefetchedShaderCodes.end())
+		{
+			return;
+		}
+		prefetchedShaderCodes.emplace(shaderFilePath, [shaderFilePath]() { return readShaderCode(shaderFilePath); });
+	}
+
+	/**
+	 * Queue a shader program to be compiled in the background, so that many programs can be compiled at once (e.g. all the programs of a scene).
+	 * The program is submitted to the driver once its shader files are read, and its compile results are only checked when it is created.
+	 * 
+	 * @param shaderName              The name of the shader program.
 	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
 	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 */
+	void submitShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath)
+	{
+		queueShaderProgram(shaderName, {{GL_VERTEX_SHADER, vertexShaderFilePath}, {GL_FRAGMENT_SHADER, fragmentShaderFilePath}});
+	}
+
+	/**
+	 * Queue a shader program to be compiled in the background, so that many programs can be compiled at once (e.g. all the programs of a scene).
+	 * The program is submitted to the driver once its shader files are read, and its compile results are only checked when it is created.
 	 * 
-	 * @return The details of the loaded shader program.
+	 * @param shaderName              The name of the shader program.
+	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
+	 * @param geometryShaderFilePath  The file path to the geometry shader source code.
+	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
 	 */
-	const std::shared_ptr<const ShaderDetails> &createShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath)
+	void submitShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
 	{
-		// Check if an shader program with the name already exists.
-		const auto existingShader = namedShaders.find(shaderName);
-		if (existingShader != namedShaders.end())
+		queueShaderProgram(shaderName, {{GL_VERTEX_SHADER, vertexShaderFilePath}, {GL_GEOMETRY_SHADER, geometryShaderFilePath}, {GL_FRAGMENT_SHADER, fragmentShaderFilePath}});
+	}
+
+	/**
+	 * Submit the queued shader programs whose shader files are done being read.
+	 */
+	void updatePendingShaderPrograms()
+	{
+		for (auto &pendingShaderProgram : pendingShaderPrograms)
 		{
-			// Shader already loaded. Increase its reference count and return it.
-			namedShaderReferences[shaderName]++;
-			return existingShader->second;
+			if (!pendingShaderProgram.second.isSubmitted && isShaderCodeRead(pendingShaderProgram.second))
+			{
+				submitShaders(pendingShaderProgram.first, pendingShaderProgram.second);
+			}
 		}
+	}
 
-		// Load the shader program and store its details.
-		const auto shaderProgramId = loadShaders(shaderName, vertexShaderFilePath, fragmentShaderFilePath);
+	/**
+	 * Check if the shader program with the given name can be created without waiting for the driver.
+	 * Without parallel shader compiling support, submitted programs are always reported as ready, since the driver cannot be asked.
+	 * 
+	 * @param shaderName  The name of the shader program.
+	 * 
+	 * @return Whether the shader program is not being read or compiled anymore.
+	 */
+	bool isShaderProgramReady(const std::string &shaderName) const
+	{
+		const auto pendingShaderProgram = pendingShaderPrograms.find(shaderName);
+		if (pendingShaderProgram == pendingShaderPrograms.end())
+		{
+			return true;
+		}
+		if (!pendingShaderProgram->second.isSubmitted)
+		{
+			return false;
+		}
+		if (!GLEW_ARB_parallel_shader_compile || pendingShaderProgram->second.shaderIds.empty())
+		{
+			return true;
+		}
 
-		// Create a new shader program details with the captured data.
-		const auto newShader = std::make_shared<const ShaderDetails>(shaderProgramId, shaderName, vertexShaderFilePath, "", fragmentShaderFilePath);
+		// Ask the driver if linking is done, which also means compiling the shaders is done.
+		auto isCompleted = GL_FALSE;
+		glGetProgramiv(pendingShaderProgram->second.programId, GL_COMPLETION_STATUS_ARB, &isCompleted);
+		return isCompleted == GL_TRUE;
+	}
 
-		// Insert the newly created shader program into the map of created shader programs.
-		namedShaders.insert(std::make_pair(shaderName, newShader));
-		// Set the reference count of the shader program to 1.
-		namedShaderReferences[shaderName] = 1;
+	/**
+	 * Load and create a shader program from the given shader file paths, using the submitted program if there is one.
+	 * If a shader program with the same name was already created, return the same shader program.
+	 * 
+	 * @param shaderName              The name of the shader program being loaded.
+	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
+	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	std::shared_ptr<const ShaderDetails> createShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath)
+	{
+		return loadShaderProgram(shaderName, {{GL_VERTEX_SHADER, vertexShaderFilePath}, {GL_FRAGMENT_SHADER, fragmentShaderFilePath}});
+	}
 
-		// Return the shader program details.
-		return namedShaders[shaderName];
+	/**
+	 * Load and create a shader program from the given shader file paths, with the given preprocessor definitions inserted into the
+	 *   shaders (e.g. to pick a pass of a shader shared with the models). The variants of the program are created with the
+	 *   definitions of the variant instead.
+	 * If a shader program with the same name was already created, return the same shader program.
+	 * 
+	 * @param shaderName              The name of the shader program being loaded.
+	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
+	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * @param definesCode             The preprocessor definitions to insert into the shaders.
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	std::shared_ptr<const ShaderDetails> createShaderProgramWithDefines(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath, const std::string &definesCode)
+	{
+		return loadShaderProgram(shaderName, {{GL_VERTEX_SHADER, vertexShaderFilePath}, {GL_FRAGMENT_SHADER, fragmentShaderFilePath}}, definesCode);
 	}
 
 	/**
-	 * Load and create a shader program from the given shader file paths. If a shader program with the same name was already created,
-	 * return the same shader program.
+	 * Load and create a shader program from the given shader file paths, using the submitted program if there is one.
+	 * If a shader program with the same name was already created, return the same shader program.
 	 * 
 	 * @param shaderName              The name of the shader program being loaded.
 	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
@@ -329,30 +1129,210 @@ public:
 	 * 
 	 * @return The details of the loaded shader program.
 	 */
-	const std::shared_ptr<const ShaderDetails> &createShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	std::shared_ptr<const ShaderDetails> createShaderProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
 	{
-		// Check if an shader program with the name already exists.
-		const auto existingShader = namedShaders.find(shaderName);
-		if (existingShader != namedShaders.end())
+		return loadShaderProgram(shaderName, {{GL_VERTEX_SHADER, vertexShaderFilePath}, {GL_GEOMETRY_SHADER, geometryShaderFilePath}, {GL_FRAGMENT_SHADER, fragmentShaderFilePath}});
+	}
+
+	/**
+	 * Load and create a shader pipeline from the given shader file paths, for the shaders that only read uniform blocks (their
+	 *   uniforms cannot be set through the locations of the shader, since the pipeline has no program of its own).
+	 * Each stage is linked into a separable program once, shared by every pipeline using the same shader file, and the pipeline
+	 *   combines the programs of its stages. Without separate shader objects, a shader program linked as a whole is created instead.
+	 * If a shader with the same name was already created, return the same shader.
+	 * 
+	 * @param shaderName              The name of the shader being loaded.
+	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
+	 * @param geometryShaderFilePath  The file path to the geometry shader source code (empty to leave the stage out).
+	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * 
+	 * @return The details of the loaded shader.
+	 */
+	std::shared_ptr<const ShaderDetails> createShaderPipeline(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	{
+		std::vector<std::pair<GLenum, std::string>> shaderFilePaths = {{GL_VERTEX_SHADER, vertexShaderFilePath}};
+		if (!geometryShaderFilePath.empty())
 		{
-			// Shader already loaded. Increase its reference count and return it.
-			namedShaderReferences[shaderName]++;
-			return existingShader->second;
+			shaderFilePaths.push_back({GL_GEOMETRY_SHADER, geometryShaderFilePath});
+		}
+		shaderFilePaths.push_back({GL_FRAGMENT_SHADER, fragmentShaderFilePath});
+		if (!isSeparateShaderStagesSupported())
+		{
+			return loadShaderProgram(shaderName, shaderFilePaths);
 		}
 
-		// Load the shader program and store its details.
-		const auto shaderProgramId = loadShaders(shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath);
+		// Check if a shader with the name already exists.
+		const auto shaderNameId = nameInterner.intern(shaderName);
+		const auto existingShader = namedShaders.find(shaderNameId);
+		if (existingShader != nullptr)
+		{
+			residencyCache.acquire(shaderName);
+			namedShaders.addReference(shaderNameId);
+			return existingShader;
+		}
 
-		// Create a new shader program details with the captured data.
-		const auto newShader = std::make_shared<const ShaderDetails>(shaderProgramId, shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath);
+		// Load the separable program of each stage, named after its shader file, and combine them into the pipeline.
+		std::vector<std::shared_ptr<const ShaderDetails>> stagePrograms;
+		GLuint pipelineId;
+		glGenProgramPipelines(1, &pipelineId);
+		for (const auto &shaderFilePath : shaderFilePaths)
+		{
+			stagePrograms.push_back(loadShaderProgram("Separable[" + shaderFilePath.second + "]", {shaderFilePath}, "", true));
+			glUseProgramStages(pipelineId, getShaderStageBit(shaderFilePath.first), stagePrograms.back()->shaderId);
+		}
+		glDebugManager.labelObject(GL_PROGRAM_PIPELINE, pipelineId, shaderName);
 
-		// Insert the newly created shader program into the map of created shader programs.
-		namedShaders.insert(std::make_pair(shaderName, newShader));
-		// Set the reference count of the shader program to 1.
-		namedShaderReferences[shaderName] = 1;
+		// Register the pipeline with a reference count of 1, without any uniform locations.
+		const auto newShader = std::make_shared<const ShaderDetails>(0, shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath, std::vector<GLint>(), false, pipelineId, stagePrograms);
+		namedShaders.insert(shaderNameId, newShader);
+		return newShader;
+	}
 
-		// Return the shader program details.
-		return namedShaders[shaderName];
+	/**
+	 * Load and create a compute shader program from the given shader file path (needs OpenGL 4.3).
+	 * If a shader program with the same name was already created, return the same shader program.
+	 * 
+	 * @param shaderName             The name of the shader program being loaded.
+	 * @param computeShaderFilePath  The file path to the compute shader source code.
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	std::shared_ptr<const ShaderDetails> createComputeShaderProgram(const std::string &shaderName, const std::string &computeShaderFilePath)
+	{
+		return loadShaderProgram(shaderName, {{GL_COMPUTE_SHADER, computeShaderFilePath}});
+	}
+
+	/**
+	 * Create the preprocessor definitions code of a shader program variant, to be used with getShaderVariant.
+	 * Should be created once and reused, since it is also used as the key of the variant.
+	 * 
+	 * @param shaderDefines  The preprocessor definitions of the variant.
+	 * 
+	 * @return The preprocessor definitions code.
+	 */
+	static std::string createShaderDefinesCode(const ShaderDefines &shaderDefines)
+	{
+		auto definesCode = std::string("#define ") + SHADER_VARIANT_DEFINE + " 1\n";
+		for (const auto &shaderDefine : shaderDefines)
+		{
+			definesCode += "#define " + shaderDefine.first + " " + shaderDefine.second + "\n";
+		}
+		return definesCode;
+	}
+
+	/**
+	 * Get the variant of the given shader program compiled with the given preprocessor definitions (e.g. with features and loop counts
+	 *   fixed at compile time). The variant is compiled in the background on first use, and the given shader program is returned until it is ready.
+	 * Variants are owned by the shader manager, and deleted together with the shader program they were created from.
+	 * 
+	 * @param shaderDetails  The details of the shader program.
+	 * @param definesCode    The preprocessor definitions code of the variant (as created by createShaderDefinesCode).
+	 * 
+	 * @return The details of the variant, or the given shader program if it does not support variants or the variant is not ready yet.
+	 */
+	std::shared_ptr<const ShaderDetails> getShaderVariant(const std::shared_ptr<const ShaderDetails> &shaderDetails, const std::string &definesCode)
+	{
+		if (!shaderDetails->isPermutable)
+		{
+			return shaderDetails;
+		}
+
+		// Check if the variant was already created.
+		const auto variantName = shaderDetails->shaderName + "[" + definesCode + "]";
+		const auto existingVariant = namedShaders.find(nameInterner.intern(variantName));
+		if (existingVariant != nullptr)
+		{
+			return existingVariant;
+		}
+
+		// Queue the variant if this is its first use.
+		std::vector<std::pair<GLenum, std::string>> shaderFilePaths = {{GL_VERTEX_SHADER, shaderDetails->vertexShaderFilePath}};
+		if (!shaderDetails->geometryShaderFilePath.empty())
+		{
+			shaderFilePaths.push_back({GL_GEOMETRY_SHADER, shaderDetails->geometryShaderFilePath});
+		}
+		shaderFilePaths.push_back({GL_FRAGMENT_SHADER, shaderDetails->fragmentShaderFilePath});
+		const auto pendingVariant = pendingShaderPrograms.find(variantName);
+		if (pendingVariant == pendingShaderPrograms.end())
+		{
+			queueShaderProgram(variantName, shaderFilePaths, definesCode);
+			return shaderDetails;
+		}
+
+		// Submit the variant once its shader codes are read, and create it once the driver is done compiling it.
+		if (!pendingVariant->second.isSubmitted)
+		{
+			if (!isShaderCodeRead(pendingVariant->second))
+			{
+				return shaderDetails;
+			}
+			submitShaders(variantName, pendingVariant->second);
+		}
+		if (!isShaderProgramReady(variantName))
+		{
+			return shaderDetails;
+		}
+		return loadShaderProgram(variantName, shaderFilePaths);
+	}
+
+	/**
+	 * Return the ID of the uniform with the given name, creating a new ID if the name was not seen before.
+	 * The ID can be used to look up the location of the uniform in any shader program without any string lookups.
+	 * 
+	 * @param uniformName  The name of the uniform (including any array indices and structure members).
+	 * 
+	 * @return The ID of the uniform.
+	 */
+	GLuint getUniformId(const std::string &uniformName)
+	{
+		// Check if the uniform name was already assigned an ID.
+		const auto existingUniformId = namedUniformIds.find(uniformName);
+		if (existingUniformId != namedUniformIds.end())
+		{
+			// Uniform ID already created. Return it.
+			return existingUniformId->second;
+		}
+
+		// Assign the next available ID to the uniform name and return it.
+		const GLuint newUniformId = namedUniformIds.size();
+		namedUniformIds.insert(std::make_pair(uniformName, newUniformId));
+		return newUniformId;
+	}
+
+	/**
+	 * Return the binding point of the uniform block with the given name, creating a new binding point if the name was not seen before.
+	 * Every shader program using a uniform block with the same name will have it bound to the same binding point.
+	 * 
+	 * @param uniformBlockName  The name of the uniform block.
+	 * 
+	 * @return The binding point of the uniform block.
+	 */
+	GLuint getUniformBlockBinding(const std::string &uniformBlockName)
+	{
+		// Check if the uniform block name was already assigned a binding point.
+		const auto existingUniformBlockBinding = namedUniformBlockBindings.find(uniformBlockName);
+		if (existingUniformBlockBinding != namedUniformBlockBindings.end())
+		{
+			// Binding point already assigned. Return it.
+			return existingUniformBlockBinding->second;
+		}
+
+		// Assign the next available binding point to the uniform block name and return it.
+		const GLuint newUniformBlockBinding = namedUniformBlockBindings.size();
+		namedUniformBlockBindings.insert(std::make_pair(uniformBlockName, newUniformBlockBinding));
+		return newUniformBlockBinding;
+	}
+
+	/**
+	 * Check if the shader program with the given name is created, whether it is referenced or only kept in the residency cache.
+	 * 
+	 * @param shaderName  The name of the shader program.
+	 * 
+	 * @return Whether the shader program is created or not.
+	 */
+	bool isShaderProgramCreated(const std::string &shaderName) const
+	{
+		return namedShaders.contains(nameInterner.intern(shaderName));
 	}
 
 	/**
@@ -362,9 +1342,9 @@ public:
    * 
    * @return The shader program created with the given name.
    */
-	const std::shared_ptr<const ShaderDetails> &getShaderDetails(const std::string &shaderName) const
+	std::shared_ptr<const ShaderDetails> getShaderDetails(const std::string &shaderName) const
 	{
-		return namedShaders.at(shaderName);
+		return namedShaders.at(nameInterner.intern(shaderName));
 	}
 
 	/**
@@ -374,18 +1354,36 @@ public:
 	 */
 	void destroyShaderProgram(const std::shared_ptr<const ShaderDetails> &shaderDetails)
 	{
-		// Reduce the reference count of the shader program.
-		namedShaderReferences[shaderDetails->getShaderName()]--;
-		// Check if there are no more references to the shader program.
-		if (namedShaderReferences[shaderDetails->getShaderName()] <= 0)
+		// Reduce the reference count of the shader program, and check if there are no more references to it.
+		if (namedShaders.removeReference(nameInterner.intern(shaderDetails->getShaderName())) <= 0)
 		{
-			// No more references left, so time to clean.
-			// Remove the shader program from the created shader programs references map.
-			namedShaderReferences.erase(shaderDetails->getShaderName());
-			// Remove the shader program from the created shader programs map.
-			namedShaders.erase(shaderDetails->getShaderName());
-			// Delete the shader program.
-			glDeleteProgram(shaderDetails->shaderId);
+			// No more references left, so keep it in the residency cache (counting each program as one), and clean the ones that do not fit the budget anymore.
+			for (const auto &evictedShaderName : residencyCache.release(shaderDetails->getShaderName(), 1))
+			{
+				deleteShaderProgram(evictedShaderName);
+
+				// Delete the variants of the shader program as well, which are named after it.
+				const auto variantNamePrefix = evictedShaderName + "[";
+				//   The created shader programs are not ordered by their names, so the variants are collected before deleting them.
+				std::vector<std::string> variantNames;
+				for (const auto &variant : *namedShaders.getSnapshot())
+				{
+					if (variant.second.asset->getShaderName().compare(0, variantNamePrefix.size(), variantNamePrefix) == 0)
+					{
+						variantNames.push_back(variant.second.asset->getShaderName());
+					}
+				}
+				for (const auto &variantName : variantNames)
+				{
+					deleteShaderProgram(variantName);
+				}
+				for (auto pendingVariant = pendingShaderPrograms.lower_bound(variantNamePrefix); pendingVariant != pendingShaderPrograms.end() && pendingVariant->first.compare(0, variantNamePrefix.size(), variantNamePrefix) == 0;)
+				{
+					glDeleteProgram(pendingVariant->second.programId);
+					releaseShaderStages(pendingVariant->second);
+					pendingVariant = pendingShaderPrograms.erase(pendingVariant);
+				}
+			}
 		}
 	}
 
@@ -400,6 +1398,8 @@ public:
 	}
 };
 
+// Initialize the engine limits definitions static variable.
+const std::string ShaderManager::ENGINE_LIMITS_DEFINES_CODE = ShaderManager::createEngineLimitsDefinesCode();
 // Initialize the shader manager singleton instance static variable.
 ShaderManager ShaderManager::instance;
 
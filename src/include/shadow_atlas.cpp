@@ -0,0 +1,143 @@
+#ifndef INCLUDE_SHADOW_ATLAS_CPP
+#define INCLUDE_SHADOW_ATLAS_CPP
+
+#include <set>
+#include <tuple>
+#include <algorithm>
+
+/**
+ * Structure for defining a square tile of a shadow atlas.
+ */
+struct ShadowAtlasTile
+{
+  // The position of the bottom-left corner of the tile in the atlas, in pixels.
+  int32_t x;
+  int32_t y;
+  // The width and height of the tile in pixels (0 if no tile is assigned).
+  int32_t size;
+};
+
+/**
+ * Class for dividing a square shadow atlas into power-of-two tiles, as a quadtree where every tile can be split into four.
+ * Freed tiles are merged back with their three siblings once all of them are free, so that larger tiles can be handed out again.
+ * Only tracks the tiles, leaving the texture and the rendering to the shadow buffer manager.
+ */
+class ShadowAtlas
+{
+private:
+  // The width and height of the atlas in pixels.
+  const int32_t atlasSize;
+  // The smallest tile size the atlas hands out.
+  const int32_t minTileSize;
+
+  // The free tiles, ordered by their sizes and then their positions.
+  std::set<std::tuple<int32_t, int32_t, int32_t>> freeTiles;
+
+public:
+  /**
+   * Create a new shadow atlas with a single free tile covering all of it.
+   * 
+   * @param atlasSize    The width and height of the atlas in pixels (a power of two).
+   * @param minTileSize  The smallest tile size the atlas hands out (a power of two).
+   */
+  ShadowAtlas(const int32_t &atlasSize, const int32_t &minTileSize)
+      : atlasSize(atlasSize),
+        minTileSize(minTileSize),
+        freeTiles({{atlasSize, 0, 0}}) {}
+
+  /**
+   * Take a tile of the given size out of the atlas, splitting the smallest larger free tile if there is no free tile of that size.
+   * 
+   * @param tileSize  The width and height of the tile (a power of two, clamped to the tile sizes the atlas hands out).
+   * 
+   * @return The allocated tile (with a size of 0 if the atlas has no free space for it).
+   */
+  ShadowAtlasTile allocate(int32_t tileSize)
+  {
+    tileSize = std::max(minTileSize, std::min(atlasSize, tileSize));
+
+    // Find the smallest free tile that fits the requested size.
+    const auto freeTile = freeTiles.lower_bound({tileSize, 0, 0});
+    if (freeTile == freeTiles.end())
+    {
+      return {0, 0, 0};
+    }
+    auto size = std::get<0>(*freeTile);
+    const auto x = std::get<1>(*freeTile), y = std::get<2>(*freeTile);
+    freeTiles.erase(freeTile);
+
+    // Split the tile until it is the requested size, keeping the bottom-left quarter and freeing the other three.
+    while (size > tileSize)
+    {
+      size /= 2;
+      freeTiles.insert({size, x + size, y});
+      freeTiles.insert({size, x, y + size});
+      freeTiles.insert({size, x + size, y + size});
+    }
+
+    return {x, y, size};
+  }
+
+  /**
+   * Give the given tile back to the atlas, merging it with its siblings while they are all free.
+   * 
+   * @param tile  The tile to free (ignored if it has a size of 0).
+   */
+  void release(const ShadowAtlasTile &tile)
+  {
+    auto size = tile.size, x = tile.x, y = tile.y;
+    if (size == 0)
+    {
+      return;
+    }
+
+    while (size < atlasSize)
+    {
+      // Find the bottom-left corner of the parent tile, and check if the three siblings of the tile are free.
+      const auto parentX = x - (x % (size * 2)), parentY = y - (y % (size * 2));
+      bool areSiblingsFree = true;
+      for (int32_t i = 0; i < 4 && areSiblingsFree; i++)
+      {
+        const auto siblingX = parentX + ((i % 2) * size), siblingY = parentY + ((i / 2) * size);
+        areSiblingsFree = (siblingX == x && siblingY == y) || freeTiles.count({size, siblingX, siblingY}) != 0;
+      }
+      if (!areSiblingsFree)
+      {
+        break;
+      }
+
+      // Merge the tile with its siblings into the parent tile.
+      for (int32_t i = 0; i < 4; i++)
+      {
+        freeTiles.erase({size, parentX + ((i % 2) * size), parentY + ((i / 2) * size)});
+      }
+      size *= 2;
+      x = parentX;
+      y = parentY;
+    }
+
+    freeTiles.insert({size, x, y});
+  }
+
+  /**
+   * Get the width and height of the atlas.
+   * 
+   * @return The size of the atlas in pixels.
+   */
+  const int32_t &getAtlasSize() const
+  {
+    return atlasSize;
+  }
+
+  /**
+   * Get the smallest tile size the atlas hands out.
+   * 
+   * @return The smallest tile size in pixels.
+   */
+  const int32_t &getMinTileSize() const
+  {
+    return minTileSize;
+  }
+};
+
+#endif
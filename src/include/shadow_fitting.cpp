@@ -0,0 +1,145 @@
+#ifndef INCLUDE_SHADOW_FITTING_CPP
+#define INCLUDE_SHADOW_FITTING_CPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "constants.cpp"
+#include "frustum.cpp"
+
+/**
+ * Structure for defining the extents of a perspective shadow projection around the view direction of its light, as the tangents
+ *   of its half angles across and up, and its planes.
+ */
+struct ShadowProjectionFit
+{
+  // The tangents of the half angles of the projection across and up the view of the light.
+  float_t tanHalfWidth;
+  float_t tanHalfHeight;
+  // The closest and farthest distances along the view direction of the light the projection captures.
+  float_t nearPlane;
+  float_t farPlane;
+
+  /**
+   * Create the projection matrix of the fit, kept centered on the view direction of the light.
+   *
+   * @return The projection matrix.
+   */
+  glm::mat4 createProjectionMatrix() const
+  {
+    return glm::frustum(-tanHalfWidth * nearPlane, tanHalfWidth * nearPlane, -tanHalfHeight * nearPlane, tanHalfHeight * nearPlane, nearPlane, farPlane);
+  }
+};
+
+/**
+ * Class for fitting the perspective shadow projections of the lights to the models in their range, so that the shadowmaps only
+ *   cover the space the casters and receivers take instead of the whole cone of the light.
+ * Every model in the range of a light and inside its full projection is kept inside the fit (whether it casts shadows or only
+ *   receives them), since the fragments outside the projection are shaded as being in shadow.
+ * The fits are stabilized by snapping their extents outwards to fixed steps of the full projection, only growing them as soon as
+ *   the models leave them and only shrinking them once the models take much less than them, so that the texels of the shadowmaps
+ *   keep their size while the models move around (which would make the shadow edges shimmer) and the shadowmaps are not
+ *   rendered again every frame just for a slightly different fit.
+ */
+class ShadowFitting
+{
+private:
+  /**
+   * Snap the given extent outwards to the steps of the full extent, keeping the last extent while the given one still fits in it
+   *   and takes enough of it (and the full extent did not shrink past it).
+   *
+   * @param extent      The extent the models need.
+   * @param lastExtent  The extent of the last fit.
+   * @param step        The size of the steps the extent is snapped to.
+   * @param fullExtent  The extent of the full projection, which the extent never goes past.
+   *
+   * @return The stabilized extent.
+   */
+  static float_t stabilizeExtent(const float_t &extent, const float_t &lastExtent, const float_t &step, const float_t &fullExtent)
+  {
+    if (extent <= lastExtent && lastExtent <= fullExtent && extent * SHADOW_FIT_SHRINK_RATIO >= lastExtent)
+    {
+      return lastExtent;
+    }
+    return std::min(fullExtent, std::max(step, std::ceil(extent / step) * step));
+  }
+
+public:
+  /**
+   * Fit the perspective shadow projection with the given view matrix to the models in the range of the light, and stabilize it
+   *   against the last fit.
+   *
+   * @param viewMatrix      The view matrix of the light.
+   * @param lightPosition   The position of the light.
+   * @param fullProjection  The extents of the full projection of the light, whose far plane is its range.
+   * @param lastFit         The last fit of the light, which the new fit is kept at while the models still fit in it.
+   * @param minCorners      The corners of the world AABBs of the models with the smallest coordinates.
+   * @param maxCorners      The corners of the world AABBs of the models with the largest coordinates.
+   *
+   * @return The fitted extents of the projection (the last fit if no model is in the projection of the light).
+   */
+  static ShadowProjectionFit fitPerspective(const glm::mat4 &viewMatrix, const glm::vec3 &lightPosition, const ShadowProjectionFit &fullProjection,
+                                            const ShadowProjectionFit &lastFit, const std::vector<glm::vec3> &minCorners, const std::vector<glm::vec3> &maxCorners)
+  {
+    const Frustum fullFrustum(fullProjection.createProjectionMatrix() * viewMatrix);
+    const auto range = fullProjection.farPlane;
+    auto tanHalfWidth = 0.0f, tanHalfHeight = 0.0f;
+    auto nearPlane = range, farPlane = fullProjection.nearPlane;
+    auto isAnyModelInside = false;
+    for (size_t i = 0; i < minCorners.size(); i++)
+    {
+      // Pad the box for the models drawn interpolated between the last two steps, and skip the ones the light cannot reach.
+      const auto minCorner = minCorners[i] - glm::vec3(SHADOW_FIT_BOX_MARGIN);
+      const auto maxCorner = maxCorners[i] + glm::vec3(SHADOW_FIT_BOX_MARGIN);
+      const auto offset = glm::clamp(lightPosition, minCorner, maxCorner) - lightPosition;
+      if (glm::dot(offset, offset) > range * range || !fullFrustum.isBoxInside(minCorner, maxCorner))
+      {
+        continue;
+      }
+      isAnyModelInside = true;
+
+      // Find the extents of the corners of the box in the view of the light. A box reaching behind the near plane of the full
+      //   projection spreads over all of it, and is only kept within it.
+      for (auto corner = 0; corner < 8; corner++)
+      {
+        const auto position = glm::vec3(viewMatrix * glm::vec4(corner & 1 ? maxCorner.x : minCorner.x, corner & 2 ? maxCorner.y : minCorner.y, corner & 4 ? maxCorner.z : minCorner.z, 1.0f));
+        const auto depth = -position.z;
+        if (depth < fullProjection.nearPlane)
+        {
+          tanHalfWidth = fullProjection.tanHalfWidth;
+          tanHalfHeight = fullProjection.tanHalfHeight;
+          nearPlane = fullProjection.nearPlane;
+          continue;
+        }
+        tanHalfWidth = std::max(tanHalfWidth, std::abs(position.x) / depth);
+        tanHalfHeight = std::max(tanHalfHeight, std::abs(position.y) / depth);
+        nearPlane = std::min(nearPlane, depth);
+        farPlane = std::max(farPlane, depth);
+      }
+    }
+    if (!isAnyModelInside)
+    {
+      return lastFit;
+    }
+
+    // Snap the extents to the steps of the full projection, the planes being snapped as distances from the far and near planes
+    //   of the full projection so that both snap outwards.
+    const auto tanWidthStep = fullProjection.tanHalfWidth / SHADOW_FIT_ANGLE_STEPS;
+    const auto tanHeightStep = fullProjection.tanHalfHeight / SHADOW_FIT_ANGLE_STEPS;
+    const auto depthStep = (range - fullProjection.nearPlane) / SHADOW_FIT_DEPTH_STEPS;
+    const auto fullDepth = range - fullProjection.nearPlane;
+    ShadowProjectionFit fit = {stabilizeExtent(tanHalfWidth, lastFit.tanHalfWidth, tanWidthStep, fullProjection.tanHalfWidth),
+                               stabilizeExtent(tanHalfHeight, lastFit.tanHalfHeight, tanHeightStep, fullProjection.tanHalfHeight),
+                               range - stabilizeExtent(range - std::max(nearPlane, fullProjection.nearPlane), range - lastFit.nearPlane, depthStep, fullDepth),
+                               fullProjection.nearPlane + stabilizeExtent(std::min(farPlane, range) - fullProjection.nearPlane, lastFit.farPlane - fullProjection.nearPlane, depthStep, fullDepth)};
+    // Keep the planes at least a step apart for the models lying flat across the view of the light.
+    fit.farPlane = std::max(fit.farPlane, fit.nearPlane + depthStep);
+    return fit;
+  }
+};
+
+#endif
@@ -0,0 +1,427 @@
+#ifndef INCLUDE_SHADOW_MASK_CPP
+#define INCLUDE_SHADOW_MASK_CPP
+
+#include <string>
+#include <memory>
+#include <iostream>
+#include <utility>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "render_config.cpp"
+#include "shader.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Class for evaluating the shadow visibility of the lights with a shadowmap into a half-resolution mask, once per pixel of the
+ *   mask, instead of once per shaded fragment of the models at full resolution (and per sample with multisampling).
+ * The depth drawn by the depth pre-pass is copied into a single-sampled texture first, which the mask pass reconstructs the
+ *   positions of the pixels of the mask from with a fullscreen triangle, compiled from the model shader with IS_SHADOW_MASK_PASS.
+ *   The models are then shaded with IS_SHADOW_MASK_ENABLED, which upsamples the mask around each fragment instead of sampling the
+ *   shadowmaps, weighing the texels of the mask by how close the depths they were evaluated at are to the depth of the fragment.
+ * The mask has a channel per light with a shadowmap, the cone lights followed by the point lights by the cube map of their
+ *   shadowmap, four of them per layer. The textures are only created once the mask is first used.
+ * With temporal filtering, the mask pass only takes a few rotated taps of the shadow filter kernel every frame, and blends them
+ *   with the mask of the last frame reprojected to the pixels, so that the mask converges to the soft result over a few frames.
+ *   The mask and the depth copy of the last frame are kept for it, the last mask being rejected where the depth it was written
+ *   from does not match (a disocclusion), or faded out as the pixels move.
+ */
+class ShadowMask
+{
+private:
+  // The layers of the mask, enough for a channel per light with a shadowmap (SHADOW_MASK_LAYERS_COUNT in the model shaders).
+  static constexpr GLsizei LAYERS_COUNT = EngineLimits::SHADOW_MASK_LAYERS_COUNT;
+  static_assert(LAYERS_COUNT <= 2, "The mask pass of the model shaders writes two layers of the mask");
+
+  // The definition that the model shaders check to only write the shadow visibility of the lights into the mask.
+  static constexpr const char *MASK_PASS_DEFINE = "#define IS_SHADOW_MASK_PASS 1\n";
+  // The definition that the model shaders check to read the shadow visibility of the lights from the mask.
+  static constexpr const char *MASKED_SHADOWS_DEFINE = "#define IS_SHADOW_MASK_ENABLED 1\n";
+  // The definition that the mask pass checks to filter the mask over time.
+  static constexpr const char *TEMPORAL_FILTER_DEFINE = "#define IS_TEMPORAL_SHADOW_FILTER 1\n";
+  // The number of frames taking different taps of the kernel with temporal filtering (matches the mask pass).
+  static constexpr uint32_t TEMPORAL_FILTER_FRAMES_COUNT = 4;
+
+  // The shader manager responsible for creating the mask shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the mask textures are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // Whether the mask is filtered over time.
+  const bool isTemporalFilteringEnabled;
+  // The definitions of the mask pass.
+  const std::string maskPassDefinesCode;
+
+  // The shader program writing the mask, with the features and light counts read from the frame details.
+  const std::shared_ptr<const ShaderDetails> maskShaderDetails;
+  // The uniform IDs of the mask shader and the model shaders reading the mask.
+  const GLuint shadowMaskTextureUniformId;
+  const GLuint shadowMaskDepthTextureUniformId;
+  const GLuint shadowMaskSceneSizeUniformId;
+  const GLuint inverseProjectionMatrixUniformId;
+  const GLuint inverseViewMatrixUniformId;
+  const GLuint shadowMaskHistoryTextureUniformId;
+  const GLuint shadowMaskHistoryDepthTextureUniformId;
+  const GLuint previousViewProjectionMatrixUniformId;
+  const GLuint temporalShadowFilterDetailsUniformId;
+
+  // The size the depth texture was created with (0 until it is needed), the mask being half of it.
+  glm::ivec2 depthSize;
+  // The size of the viewport of the scene the mask was last written for.
+  glm::ivec2 sceneSize;
+  // The framebuffer of the depth copy, and its depth texture.
+  GLuint depthFramebufferId;
+  GLuint depthTextureId;
+  // The framebuffer of the mask, and its texture array.
+  GLuint maskFramebufferId;
+  GLuint maskTextureId;
+  // The framebuffers and textures of the depth copy and the mask written by the last frame, with temporal filtering (swapped
+  //   with the ones of the current frame every frame).
+  GLuint historyDepthFramebufferId;
+  GLuint historyDepthTextureId;
+  GLuint historyMaskFramebufferId;
+  GLuint historyMaskTextureId;
+  // The empty vertex array object the fullscreen triangle is drawn with (its vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  // Whether the mask of the last frame can be reprojected (the mask was written by the last frame, at the same size).
+  bool isHistoryValid;
+  // The view-projection matrix of the camera the mask of the last frame was written with.
+  glm::mat4 previousViewProjectionMatrix;
+  // The number of masks written with temporal filtering, picking the taps of the kernel of each frame.
+  uint32_t temporalFramesCount;
+
+  // The preprocessor definitions code of the models the pass definitions were last created from, and the pass definitions.
+  std::string modelDefinesCode;
+  std::string maskDefinesCode;
+  std::string maskedDefinesCode;
+
+  /**
+   * Delete the textures of the mask, if they were created.
+   */
+  void deleteMaskTextures()
+  {
+    for (const auto &textureId : {depthTextureId, maskTextureId, historyDepthTextureId, historyMaskTextureId})
+    {
+      if (textureId != 0)
+      {
+        GlCalls::deleteTextures(1, &textureId);
+        gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, textureId);
+      }
+    }
+    for (const auto &framebufferId : {depthFramebufferId, maskFramebufferId, historyDepthFramebufferId, historyMaskFramebufferId})
+    {
+      if (framebufferId != 0)
+      {
+        GlCalls::deleteFramebuffers(1, &framebufferId);
+      }
+    }
+    depthTextureId = maskTextureId = depthFramebufferId = maskFramebufferId = 0;
+    historyDepthTextureId = historyMaskTextureId = historyDepthFramebufferId = historyMaskFramebufferId = 0;
+    isHistoryValid = false;
+  }
+
+  /**
+   * Create the single-sampled depth texture the depth of the scene is copied into (in the same format for the copy), and its
+   *   framebuffer.
+   * 
+   * @param framebufferId  The ID of the created framebuffer.
+   * @param textureId      The ID of the created depth texture.
+   * @param name           The name the texture is accounted with.
+   */
+  void createDepthTexture(GLuint &framebufferId, GLuint &textureId, const std::string &name)
+  {
+    glGenFramebuffers(1, &framebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, depthSize.x, depthSize.y, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureId, GpuMemoryCategory::RENDER_TARGET, name, GpuMemoryManager::getTextureSize(depthSize.x, depthSize.y, 1, 4, false));
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, textureId, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      std::cout << "Failed at shadow mask depth" << std::endl;
+    }
+  }
+
+  /**
+   * Create the texture array of the mask at half the size of the depth, with a layer per color attachment of its framebuffer,
+   *   so that every layer is written by the same pass.
+   * 
+   * @param framebufferId  The ID of the created framebuffer.
+   * @param textureId      The ID of the created texture array.
+   * @param name           The name the texture is accounted with.
+   */
+  void createMaskTexture(GLuint &framebufferId, GLuint &textureId, const std::string &name)
+  {
+    const auto maskSize = (depthSize + 1) / 2;
+    glGenFramebuffers(1, &framebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glGenTextures(1, &textureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, maskSize.x, maskSize.y, LAYERS_COUNT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureId, GpuMemoryCategory::RENDER_TARGET, name, GpuMemoryManager::getTextureSize(maskSize.x, maskSize.y, LAYERS_COUNT, 4, false));
+    GLenum drawBuffers[LAYERS_COUNT];
+    for (GLsizei i = 0; i < LAYERS_COUNT; i++)
+    {
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, textureId, 0, i);
+      drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    glDrawBuffers(LAYERS_COUNT, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      std::cout << "Failed at shadow mask" << std::endl;
+    }
+  }
+
+  /**
+   * Create the textures of the mask at the size of the viewport, if they do not exist yet or the viewport was resized since.
+   * They are as large as the scene at full resolution, so the scene scaled down by the dynamic resolution uses a corner of them.
+   */
+  void createMaskTextures()
+  {
+    const auto viewportSize = glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    if (maskFramebufferId != 0 && depthSize == viewportSize)
+    {
+      return;
+    }
+    deleteMaskTextures();
+    depthSize = viewportSize;
+
+    // Create the depth copy and the mask, along with the ones of the last frame with temporal filtering.
+    createDepthTexture(depthFramebufferId, depthTextureId, "Shadow Mask Depth");
+    createMaskTexture(maskFramebufferId, maskTextureId, "Shadow Mask");
+    if (isTemporalFilteringEnabled)
+    {
+      createDepthTexture(historyDepthFramebufferId, historyDepthTextureId, "Shadow Mask History Depth");
+      createMaskTexture(historyMaskFramebufferId, historyMaskTextureId, "Shadow Mask History");
+    }
+  }
+
+  /**
+   * Create the definitions of the mask pass and of the models reading the mask from the given definitions of the models, if
+   *   they changed.
+   * 
+   * @param definesCode  The preprocessor definitions code the models receiving light are drawn with.
+   */
+  void updateDefinesCode(const std::string &definesCode)
+  {
+    if (definesCode == modelDefinesCode)
+    {
+      return;
+    }
+    modelDefinesCode = definesCode;
+    maskDefinesCode = definesCode + maskPassDefinesCode;
+    maskedDefinesCode = definesCode + MASKED_SHADOWS_DEFINE;
+  }
+
+public:
+  ShadowMask()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        isTemporalFilteringEnabled(RenderConfigManager::getConfig().isTemporalShadowFilteringEnabled),
+        maskPassDefinesCode(std::string(MASK_PASS_DEFINE) + (isTemporalFilteringEnabled ? TEMPORAL_FILTER_DEFINE : "")),
+        maskShaderDetails(shaderManager.createShaderProgramWithDefines("ShadowMask::Mask", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/default.glsl", maskPassDefinesCode)),
+        shadowMaskTextureUniformId(shaderManager.getUniformId("shadowMaskTexture")),
+        shadowMaskDepthTextureUniformId(shaderManager.getUniformId("shadowMaskDepthTexture")),
+        shadowMaskSceneSizeUniformId(shaderManager.getUniformId("shadowMaskSceneSize")),
+        inverseProjectionMatrixUniformId(shaderManager.getUniformId("inverseProjectionMatrix")),
+        inverseViewMatrixUniformId(shaderManager.getUniformId("inverseViewMatrix")),
+        shadowMaskHistoryTextureUniformId(shaderManager.getUniformId("shadowMaskHistoryTexture")),
+        shadowMaskHistoryDepthTextureUniformId(shaderManager.getUniformId("shadowMaskHistoryDepthTexture")),
+        previousViewProjectionMatrixUniformId(shaderManager.getUniformId("previousViewProjectionMatrix")),
+        temporalShadowFilterDetailsUniformId(shaderManager.getUniformId("temporalShadowFilterDetails")),
+        depthSize(0),
+        sceneSize(0),
+        depthFramebufferId(0),
+        depthTextureId(0),
+        maskFramebufferId(0),
+        maskTextureId(0),
+        historyDepthFramebufferId(0),
+        historyDepthTextureId(0),
+        historyMaskFramebufferId(0),
+        historyMaskTextureId(0),
+        vertexArrayId(0),
+        isHistoryValid(false),
+        previousViewProjectionMatrix(1.0f),
+        temporalFramesCount(0),
+        modelDefinesCode(),
+        maskDefinesCode(),
+        maskedDefinesCode()
+  {
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~ShadowMask()
+  {
+    // Destroy the mask shader, and delete the textures of the mask.
+    shaderManager.destroyShaderProgram(maskShaderDetails);
+    deleteMaskTextures();
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+  }
+
+  // Preventing copying the shadow mask, since it owns GPU resources.
+  ShadowMask(const ShadowMask &) = delete;
+
+  /**
+   * Check if the mask is filtered over time.
+   * 
+   * @return Whether temporal filtering is enabled or not.
+   */
+  bool isTemporalFiltered() const
+  {
+    return isTemporalFilteringEnabled;
+  }
+
+  /**
+   * Drop the mask of the last frame, so that the next mask is not blended with it (e.g. when a frame is rendered without the mask).
+   */
+  void resetHistory()
+  {
+    isHistoryValid = false;
+  }
+
+  /**
+   * Get the preprocessor definitions code the models receiving light are drawn with to read the shadow visibility of the lights
+   *   from the mask.
+   * 
+   * @param definesCode  The preprocessor definitions code the models receiving light are drawn with otherwise.
+   * 
+   * @return The preprocessor definitions code reading the mask.
+   */
+  const std::string &getMaskedDefinesCode(const std::string &definesCode)
+  {
+    updateDefinesCode(definesCode);
+    return maskedDefinesCode;
+  }
+
+  /**
+   * Get the shader program writing the mask, which is the variant with the features and light counts fixed at compile time once
+   *   it is compiled.
+   * 
+   * @param definesCode  The preprocessor definitions code the models receiving light are drawn with.
+   * 
+   * @return The details of the mask shader.
+   */
+  std::shared_ptr<const ShaderDetails> getMaskShader(const std::string &definesCode)
+  {
+    updateDefinesCode(definesCode);
+    return shaderManager.getShaderVariant(maskShaderDetails, maskDefinesCode);
+  }
+
+  /**
+   * Write the shadow visibility of the lights into the mask, from the depth of the models drawn into the render target of the
+   *   scene by the depth pre-pass, and bind the render target of the scene again.
+   * The mask shader has to be in use, with the texture units of the shadowmaps already set.
+   * 
+   * @param maskShader           The details of the mask shader (as returned by getMaskShader).
+   * @param sceneFramebufferId   The ID of the framebuffer the scene is rendered into.
+   * @param viewportSize         The size of the viewport of the scene.
+   * @param projectionMatrix     The projection matrix of the camera.
+   * @param viewMatrix           The view matrix of the camera.
+   * @param firstTextureUnit     The first of the two texture units the textures of the mask are bound to (followed by two more
+   *                               for the textures of the last frame with temporal filtering).
+   */
+  void renderMask(const std::shared_ptr<const ShaderDetails> &maskShader, const GLuint &sceneFramebufferId, const glm::ivec2 &viewportSize, const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix, const GLint &firstTextureUnit)
+  {
+    createMaskTextures();
+    // The mask of the last frame only covers the same pixels if the scene has the same size.
+    isHistoryValid = isHistoryValid && sceneSize == viewportSize;
+    sceneSize = viewportSize;
+
+    // Keep the depth copy and the mask written by the last frame, and write the ones of this frame into the other textures.
+    if (isTemporalFilteringEnabled)
+    {
+      std::swap(depthFramebufferId, historyDepthFramebufferId);
+      std::swap(depthTextureId, historyDepthTextureId);
+      std::swap(maskFramebufferId, historyMaskFramebufferId);
+      std::swap(maskTextureId, historyMaskTextureId);
+    }
+
+    // Copy the depth of the scene, which may be multisampled, into the single-sampled depth texture.
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::bindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFramebufferId);
+    glBlitFramebuffer(0, 0, sceneSize.x, sceneSize.y, 0, 0, sceneSize.x, sceneSize.y, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    // Write every pixel of the mask covering the scene with a fullscreen triangle, evaluated from the depth copy.
+    const auto maskSize = (sceneSize + 1) / 2;
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, maskFramebufferId);
+    GlCalls::viewport(0, 0, maskSize.x, maskSize.y);
+    GlCalls::bindTextureUnit(firstTextureUnit + 1, GL_TEXTURE_2D, depthTextureId);
+    setMaskUniforms(*maskShader, firstTextureUnit);
+    GlCalls::uniformMatrix4fv(maskShader->getUniformLocation(inverseProjectionMatrixUniformId), 1, GL_FALSE, &glm::inverse(projectionMatrix)[0][0]);
+    GlCalls::uniformMatrix4fv(maskShader->getUniformLocation(inverseViewMatrixUniformId), 1, GL_FALSE, &glm::inverse(viewMatrix)[0][0]);
+    if (isTemporalFilteringEnabled)
+    {
+      // Bind the textures of the last frame after the ones of the mask, and pick the taps of the kernel of the frame.
+      GlCalls::bindTextureUnit(firstTextureUnit + 2, GL_TEXTURE_2D_ARRAY, historyMaskTextureId);
+      GlCalls::bindTextureUnit(firstTextureUnit + 3, GL_TEXTURE_2D, historyDepthTextureId);
+      GlCalls::uniform1i(maskShader->getUniformLocation(shadowMaskHistoryTextureUniformId), firstTextureUnit + 2);
+      GlCalls::uniform1i(maskShader->getUniformLocation(shadowMaskHistoryDepthTextureUniformId), firstTextureUnit + 3);
+      GlCalls::uniformMatrix4fv(maskShader->getUniformLocation(previousViewProjectionMatrixUniformId), 1, GL_FALSE, &previousViewProjectionMatrix[0][0]);
+      GlCalls::uniform2f(maskShader->getUniformLocation(temporalShadowFilterDetailsUniformId), temporalFramesCount % TEMPORAL_FILTER_FRAMES_COUNT, isHistoryValid ? TEMPORAL_SHADOW_HISTORY_WEIGHT : 0.0f);
+      temporalFramesCount++;
+    }
+    GlCalls::disable(GL_DEPTH_TEST);
+    GlCalls::bindVertexArray(vertexArrayId);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+    GlCalls::bindVertexArray(0);
+    GlCalls::enable(GL_DEPTH_TEST);
+    if (isTemporalFilteringEnabled)
+    {
+      GlCalls::bindTextureUnit(firstTextureUnit + 3, GL_TEXTURE_2D, 0);
+      GlCalls::bindTextureUnit(firstTextureUnit + 2, GL_TEXTURE_2D_ARRAY, 0);
+      previousViewProjectionMatrix = projectionMatrix * viewMatrix;
+      isHistoryValid = true;
+    }
+
+    // Bind the mask next to the depth copy, for the models reading it.
+    GlCalls::bindTextureUnit(firstTextureUnit, GL_TEXTURE_2D_ARRAY, maskTextureId);
+    GlCalls::activeTexture(GL_TEXTURE0);
+
+    // Bind the scene framebuffer again for the models shaded with the mask.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferId);
+    GlCalls::viewport(0, 0, sceneSize.x, sceneSize.y);
+  }
+
+  /**
+   * Set the texture units of the textures of the mask, and the size of the scene the mask was written for, of the given shader
+   *   program reading the mask.
+   * 
+   * @param shaderDetails     The details of the shader program in use.
+   * @param firstTextureUnit  The first of the two texture units the textures of the mask are bound to.
+   */
+  void setMaskUniforms(const ShaderDetails &shaderDetails, const GLint &firstTextureUnit) const
+  {
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(shadowMaskTextureUniformId), firstTextureUnit);
+    GlCalls::uniform1i(shaderDetails.getUniformLocation(shadowMaskDepthTextureUniformId), firstTextureUnit + 1);
+    GlCalls::uniform2f(shaderDetails.getUniformLocation(shadowMaskSceneSizeUniformId), sceneSize.x, sceneSize.y);
+  }
+
+  /**
+   * Unbind the textures of the mask, once the models reading it are drawn.
+   * 
+   * @param firstTextureUnit  The first of the two texture units the textures of the mask are bound to.
+   */
+  void unbindMaskTextures(const GLint &firstTextureUnit) const
+  {
+    GlCalls::bindTextureUnit(firstTextureUnit + 1, GL_TEXTURE_2D, 0);
+    GlCalls::bindTextureUnit(firstTextureUnit, GL_TEXTURE_2D_ARRAY, 0);
+    GlCalls::activeTexture(GL_TEXTURE0);
+  }
+};
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef INCLUDE_SHADOW_MOMENTS_CPP
+#define INCLUDE_SHADOW_MOMENTS_CPP
+
+#include <memory>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "shadowbuffer.cpp"
+#include "render_config.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Class for writing the moments of the shadowmaps of the lights shadowed with variance shadow maps.
+ * The moments are written from the depths of the shadowmaps once they are rendered (so that the light shaders, the shadowmap
+ *   caching and the percentage-closer filtering are left as they are), at a fraction of their size, blurred with a separable
+ *   pass and mip-mapped, so that the model shaders filter them with a single fetch per light.
+ * The moment textures of a light type are only created once a light of the type is shadowed with them.
+ */
+class ShadowMomentMaps
+{
+private:
+  /**
+   * Enum of the sources the moments are read from (matches the MOMENT_SOURCE values in the shader).
+   */
+  enum MomentSource
+  {
+    CONE_LIGHT_DEPTH = 0,
+    POINT_LIGHT_DEPTH = 1,
+    MOMENTS = 2
+  };
+
+  // The shader manager responsible for creating the moment shader.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the moment textures are accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The shader program writing the blurred moments of the shadowmaps.
+  const std::shared_ptr<const ShaderDetails> momentShaderDetails;
+  // The uniform IDs of the moment shader.
+  const GLuint coneLightDepthTextureUniformId;
+  const GLuint pointLightDepthTexturesUniformId;
+  const GLuint momentsTextureUniformId;
+  const GLuint momentSourceUniformId;
+  const GLuint sourceOffsetUniformId;
+  const GLuint targetOffsetUniformId;
+  const GLuint targetSizeUniformId;
+  const GLuint blurDirectionUniformId;
+  const GLuint pointLightCubeIndexUniformId;
+  const GLuint pointLightFaceUniformId;
+  const GLuint depthPlanesUniformId;
+
+  // The atlas of the moments of the cone lights, with the same tiles as the shadow atlas (0 until it is needed).
+  GLuint coneLightMomentAtlasId;
+  GLuint coneLightMomentFramebufferId;
+  // The cube map array of the moments of the point lights, with the same layers as the shadowmaps (0 until it is needed).
+  GLuint pointLightMomentTextureArrayId;
+  GLuint pointLightMomentFramebufferId;
+  // The texture the moments blurred along the first axis are written to, as large as the largest tile of the cone lights.
+  GLuint blurTextureId;
+  GLuint blurFramebufferId;
+  // The sampler reading the depths of the shadowmaps as they are, instead of comparing them.
+  GLuint depthSamplerId;
+  // The empty vertex array object the fullscreen triangles are drawn with (their vertices come from the vertex IDs).
+  GLuint vertexArrayId;
+
+  /**
+   * Get the size of the moments of a shadowmap.
+   * 
+   * @param shadowMapSize  The size of the shadowmap (or of its tile of the shadow atlas).
+   * 
+   * @return The size of the moments.
+   */
+  static int32_t getMomentMapSize(const int32_t &shadowMapSize)
+  {
+    return shadowMapSize / SHADOW_MOMENT_MAP_DOWNSCALE;
+  }
+
+  /**
+   * Set the filtering of the moment texture bound to the given target, trilinear across its mip levels.
+   * 
+   * @param target  The target the texture is bound to.
+   */
+  static void setMomentTextureParameters(const GLenum &target)
+  {
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, SHADOW_MOMENT_MIP_LEVELS - 1);
+  }
+
+  /**
+   * Clear the moments of the framebuffer to the farthest depth, so that whatever has not been written yet is lit.
+   * 
+   * @param framebufferId  The ID of the framebuffer with the moments attached.
+   */
+  static void clearMoments(const GLuint &framebufferId)
+  {
+    // Clear without touching the clear color the scenes set.
+    const GLfloat farthestMoments[] = {1.0f, 1.0f, 0.0f, 0.0f};
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glClearBufferfv(GL_COLOR, 0, farthestMoments);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  /**
+   * Create the atlas of the moments of the cone lights, if it does not exist yet.
+   */
+  void createConeLightMomentAtlas()
+  {
+    if (coneLightMomentAtlasId != 0)
+    {
+      return;
+    }
+
+    const auto atlasSize = getMomentMapSize(RenderConfigManager::getConfig().coneLightShadowAtlasSize);
+    glGenTextures(1, &coneLightMomentAtlasId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, coneLightMomentAtlasId);
+    for (GLint i = 0; i < SHADOW_MOMENT_MIP_LEVELS; i++)
+    {
+      GlCalls::texImage2D(GL_TEXTURE_2D, i, GL_RG32F, atlasSize >> i, atlasSize >> i, GL_RG, GL_FLOAT, nullptr, 8);
+    }
+    setMomentTextureParameters(GL_TEXTURE_2D);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, coneLightMomentAtlasId, GpuMemoryCategory::SHADOW_MAP, "Cone Light Moments", GpuMemoryManager::getTextureSize(atlasSize, atlasSize, 1, 8, true));
+
+    glGenFramebuffers(1, &coneLightMomentFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, coneLightMomentFramebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, coneLightMomentAtlasId, 0);
+    clearMoments(coneLightMomentFramebufferId);
+  }
+
+  /**
+   * Create the cube map array of the moments of the point lights, if it does not exist yet.
+   */
+  void createPointLightMomentTextureArray()
+  {
+    if (pointLightMomentTextureArrayId != 0)
+    {
+      return;
+    }
+
+    const auto faceSize = getMomentMapSize(RenderConfigManager::getConfig().pointLightShadowMapSize);
+    const auto layersCount = 6 * MAX_POINT_LIGHTS;
+    glGenTextures(1, &pointLightMomentTextureArrayId);
+    GlCalls::bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointLightMomentTextureArrayId);
+    for (GLint i = 0; i < SHADOW_MOMENT_MIP_LEVELS; i++)
+    {
+      glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, i, GL_RG32F, faceSize >> i, faceSize >> i, layersCount, 0, GL_RG, GL_FLOAT, nullptr);
+    }
+    setMomentTextureParameters(GL_TEXTURE_CUBE_MAP_ARRAY);
+    GlCalls::bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, pointLightMomentTextureArrayId, GpuMemoryCategory::SHADOW_MAP, "Point Light Moments", GpuMemoryManager::getTextureSize(faceSize, faceSize, layersCount, 8, true));
+
+    // Attach all the layers to clear them at once, each face is attached on its own when its moments are written.
+    glGenFramebuffers(1, &pointLightMomentFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, pointLightMomentFramebufferId);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, pointLightMomentTextureArrayId, 0);
+    clearMoments(pointLightMomentFramebufferId);
+  }
+
+  /**
+   * Write the blurred moments of a tile or a face of a shadowmap, with the depth texture of the shadowmap bound and the source
+   *   specific uniforms set.
+   * 
+   * @param momentSource         The source the depths are read from.
+   * @param sourceOffset         The texel the tile starts at in the shadowmap.
+   * @param momentSize           The size of the moments.
+   * @param targetFramebufferId  The ID of the framebuffer the moments are written to.
+   * @param targetOffset         The texel the moments start at in the framebuffer.
+   */
+  void writeMoments(const MomentSource &momentSource, const glm::ivec2 &sourceOffset, const int32_t &momentSize, const GLuint &targetFramebufferId, const glm::ivec2 &targetOffset) const
+  {
+    // Blur the moments of the depths horizontally into the blur texture.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, blurFramebufferId);
+    GlCalls::viewport(0, 0, momentSize, momentSize);
+    GlCalls::uniform1i(momentShaderDetails->getUniformLocation(momentSourceUniformId), momentSource);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(sourceOffsetUniformId), sourceOffset.x, sourceOffset.y);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(targetOffsetUniformId), 0, 0);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(targetSizeUniformId), momentSize, momentSize);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(blurDirectionUniformId), 1, 0);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+
+    // Blur them vertically into the moments of the light.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, targetFramebufferId);
+    GlCalls::viewport(targetOffset.x, targetOffset.y, momentSize, momentSize);
+    GlCalls::uniform1i(momentShaderDetails->getUniformLocation(momentSourceUniformId), MOMENTS);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(sourceOffsetUniformId), 0, 0);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(targetOffsetUniformId), targetOffset.x, targetOffset.y);
+    GlCalls::uniform2i(momentShaderDetails->getUniformLocation(blurDirectionUniformId), 0, 1);
+    GlCalls::drawArrays(GL_TRIANGLES, 0, 3);
+  }
+
+public:
+  ShadowMomentMaps()
+      : shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        momentShaderDetails(shaderManager.createShaderProgram("ShadowMomentMaps::Moments", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/shadow_moments.glsl")),
+        coneLightDepthTextureUniformId(shaderManager.getUniformId("coneLightDepthTexture")),
+        pointLightDepthTexturesUniformId(shaderManager.getUniformId("pointLightDepthTextures")),
+        momentsTextureUniformId(shaderManager.getUniformId("momentsTexture")),
+        momentSourceUniformId(shaderManager.getUniformId("momentSource")),
+        sourceOffsetUniformId(shaderManager.getUniformId("sourceOffset")),
+        targetOffsetUniformId(shaderManager.getUniformId("targetOffset")),
+        targetSizeUniformId(shaderManager.getUniformId("targetSize")),
+        blurDirectionUniformId(shaderManager.getUniformId("blurDirection")),
+        pointLightCubeIndexUniformId(shaderManager.getUniformId("pointLightCubeIndex")),
+        pointLightFaceUniformId(shaderManager.getUniformId("pointLightFace")),
+        depthPlanesUniformId(shaderManager.getUniformId("depthPlanes")),
+        coneLightMomentAtlasId(0),
+        coneLightMomentFramebufferId(0),
+        pointLightMomentTextureArrayId(0),
+        pointLightMomentFramebufferId(0),
+        blurTextureId(0),
+        blurFramebufferId(0),
+        depthSamplerId(0),
+        vertexArrayId(0)
+  {
+    // Create the blur texture, as large as the moments of the largest shadowmap of either light type.
+    const auto &renderConfig = RenderConfigManager::getConfig();
+    const auto blurSize = getMomentMapSize(std::max(renderConfig.coneLightMaxShadowMapSize, renderConfig.pointLightShadowMapSize));
+    glGenTextures(1, &blurTextureId);
+    GlCalls::bindTexture(GL_TEXTURE_2D, blurTextureId);
+    GlCalls::texImage2D(GL_TEXTURE_2D, 0, GL_RG32F, blurSize, blurSize, GL_RG, GL_FLOAT, nullptr, 8);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, blurTextureId, GpuMemoryCategory::SHADOW_MAP, "Shadow Moment Blur", GpuMemoryManager::getTextureSize(blurSize, blurSize, 1, 8, false));
+    glGenFramebuffers(1, &blurFramebufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, blurFramebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, blurTextureId, 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Create the sampler reading the depths of the shadowmaps texel by texel, without the comparison the model shaders use.
+    glGenSamplers(1, &depthSamplerId);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(depthSamplerId, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glGenVertexArrays(1, &vertexArrayId);
+  }
+
+  ~ShadowMomentMaps()
+  {
+    // Destroy the moment shader.
+    shaderManager.destroyShaderProgram(momentShaderDetails);
+    // Delete the framebuffers and textures of the moments, including the ones that were never created.
+    for (const auto &textureId : {coneLightMomentAtlasId, pointLightMomentTextureArrayId, blurTextureId})
+    {
+      if (textureId != 0)
+      {
+        GlCalls::deleteTextures(1, &textureId);
+        gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, textureId);
+      }
+    }
+    for (const auto &framebufferId : {coneLightMomentFramebufferId, pointLightMomentFramebufferId, blurFramebufferId})
+    {
+      if (framebufferId != 0)
+      {
+        GlCalls::deleteFramebuffers(1, &framebufferId);
+      }
+    }
+    glDeleteSamplers(1, &depthSamplerId);
+    GlCalls::deleteVertexArrays(1, &vertexArrayId);
+  }
+
+  // Preventing copying the shadow moment maps, since they own GPU resources.
+  ShadowMomentMaps(const ShadowMomentMaps &) = delete;
+
+  /**
+   * Write the moments of the given shadow buffer from the depths of its shadowmap, once the shadowmap is rendered.
+   * The mip levels of the moments of the light type have to be generated again once the moments of all its lights are written.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer of the light.
+   * @param faceMask             The mask of the cube map faces to write for point lights (a bit per face, ignored for cone lights).
+   * @param nearPlane            The near plane of the light.
+   * @param farPlane             The far plane of the light.
+   */
+  void updateMoments(const std::shared_ptr<const ShadowBufferDetails> &shadowBufferDetails, const uint32_t &faceMask, const float_t &nearPlane, const float_t &farPlane)
+  {
+    const auto isPointLight = shadowBufferDetails->getShadowBufferType() == ShadowBufferType::POINT;
+    if (isPointLight)
+    {
+      createPointLightMomentTextureArray();
+    }
+    else
+    {
+      createConeLightMomentAtlas();
+    }
+
+    // Write the moments with a fullscreen triangle, without testing or blending it with anything.
+    const auto isBlendEnabled = glIsEnabled(GL_BLEND);
+    GlCalls::disable(GL_BLEND);
+    GlCalls::disable(GL_DEPTH_TEST);
+    GlCalls::useProgram(momentShaderDetails->getShaderId());
+    GlCalls::uniform1i(momentShaderDetails->getUniformLocation(coneLightDepthTextureUniformId), 0);
+    GlCalls::uniform1i(momentShaderDetails->getUniformLocation(pointLightDepthTexturesUniformId), 1);
+    GlCalls::uniform1i(momentShaderDetails->getUniformLocation(momentsTextureUniformId), 2);
+    GlCalls::uniform2f(momentShaderDetails->getUniformLocation(depthPlanesUniformId), nearPlane, farPlane);
+    GlCalls::bindVertexArray(vertexArrayId);
+    // Bind the depths of the shadowmap with the sampler reading them as they are, and the moments of the first pass.
+    const auto depthTextureUnit = isPointLight ? 1 : 0;
+    const auto depthTextureTarget = isPointLight ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D;
+    GlCalls::activeTexture(GL_TEXTURE0 + depthTextureUnit);
+    GlCalls::bindTexture(depthTextureTarget, shadowBufferDetails->getShadowBufferTextureArrayId());
+    glBindSampler(depthTextureUnit, depthSamplerId);
+    GlCalls::activeTexture(GL_TEXTURE2);
+    GlCalls::bindTexture(GL_TEXTURE_2D, blurTextureId);
+
+    if (isPointLight)
+    {
+      // Write each face of the cube map into its layer of the moments.
+      const auto layerId = shadowBufferDetails->getShadowBufferTextureArrayLayerId();
+      GlCalls::uniform1i(momentShaderDetails->getUniformLocation(pointLightCubeIndexUniformId), static_cast<GLint>(layerId / 6));
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, pointLightMomentFramebufferId);
+      for (uint32_t i = 0; i < 6; i++)
+      {
+        if ((faceMask & (1u << i)) == 0)
+        {
+          continue;
+        }
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, pointLightMomentTextureArrayId, 0, layerId + i);
+        GlCalls::uniform1i(momentShaderDetails->getUniformLocation(pointLightFaceUniformId), static_cast<GLint>(i));
+        writeMoments(POINT_LIGHT_DEPTH, glm::ivec2(0), getMomentMapSize(RenderConfigManager::getConfig().pointLightShadowMapSize), pointLightMomentFramebufferId, glm::ivec2(0));
+      }
+    }
+    else
+    {
+      // Write the tile of the light into the same tile of the moment atlas, scaled down with it.
+      const auto &shadowMapTile = shadowBufferDetails->getShadowMapTile();
+      const auto tileOffset = glm::ivec2(shadowMapTile.x, shadowMapTile.y);
+      writeMoments(CONE_LIGHT_DEPTH, tileOffset, getMomentMapSize(shadowMapTile.size), coneLightMomentFramebufferId, tileOffset / SHADOW_MOMENT_MAP_DOWNSCALE);
+    }
+
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    GlCalls::activeTexture(GL_TEXTURE0 + depthTextureUnit);
+    glBindSampler(depthTextureUnit, 0);
+    GlCalls::bindTexture(depthTextureTarget, 0);
+    GlCalls::bindVertexArray(0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlCalls::enable(GL_DEPTH_TEST);
+    if (isBlendEnabled)
+    {
+      GlCalls::enable(GL_BLEND);
+    }
+  }
+
+  /**
+   * Generate the mip levels of the moments of the given light type again, once the moments of its lights are written.
+   * 
+   * @param shadowBufferType  The type of the lights.
+   */
+  void generateMipmaps(const ShadowBufferType &shadowBufferType) const
+  {
+    const auto target = shadowBufferType == ShadowBufferType::POINT ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D;
+    const auto textureId = getMomentTextureId(shadowBufferType);
+    if (textureId == 0)
+    {
+      return;
+    }
+    GlCalls::bindTexture(target, textureId);
+    glGenerateMipmap(target);
+    GlCalls::bindTexture(target, 0);
+  }
+
+  /**
+   * Get the ID of the moment texture of the given light type (the atlas of the cone lights, or the cube map array of the point lights).
+   * 
+   * @param shadowBufferType  The type of the lights.
+   * 
+   * @return The ID of the moment texture (0 if no light of the type has been shadowed with it).
+   */
+  const GLuint &getMomentTextureId(const ShadowBufferType &shadowBufferType) const
+  {
+    return shadowBufferType == ShadowBufferType::POINT ? pointLightMomentTextureArrayId : coneLightMomentAtlasId;
+  }
+};
+
+#endif
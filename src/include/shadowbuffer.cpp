@@ -6,11 +6,18 @@
 #include <set>
 #include <memory>
 #include <limits>
+#include <vector>
+#include <algorithm>
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 
 #include "constants.cpp"
 #include "window.cpp"
+#include "render_config.cpp"
+#include "shadow_atlas.cpp"
+#include "gpu_memory.cpp"
+#include "name_interner.cpp"
 
 /**
  * Enum of supported shadow buffer types.
@@ -21,6 +28,28 @@ enum ShadowBufferType
   POINT
 };
 
+/**
+ * Enum of the supported kernels of shadowmap taps averaged by the model shaders (matches the SHADOW_FILTER values in the shaders).
+ */
+enum ShadowFilterKernel
+{
+  FILTER_1X1 = 0,
+  FILTER_3X3 = 1,
+  FILTER_POISSON_8 = 2,
+  FILTER_POISSON_16 = 3
+};
+
+/**
+ * Enum of the supported techniques the model shaders shadow the lights of a type with (matches the SHADOW_TECHNIQUE values in the shaders).
+ */
+enum ShadowTechnique
+{
+  // Percentage-closer filtering of the depths of the shadowmaps, with the taps of the shadow filter kernel.
+  TECHNIQUE_PCF = 0,
+  // Variance shadow maps, filtering the blurred and mip-mapped moments of the depths with a single fetch.
+  TECHNIQUE_VSM = 1
+};
+
 /**
  * Class for containing the details of the shadow buffer.
  */
@@ -34,15 +63,24 @@ private:
   const GLuint shadowBufferId;
   // The ID of the texture array the shadow buffer copies data to in a layer.
   const GLuint shadowBufferTextureArrayId;
-  // The ID of the layer of the texture array that the shadow buffer data is stored in.
-  const uint32_t shadowBufferTextureArrayLayerId;
+  // The ID of the layer of the texture array that the shadow buffer data is stored in (for cone lights, the slot of the light in the shadow atlas),
+  //   reassigned by the shadow buffer manager as the importance of the light changes.
+  mutable uint32_t shadowBufferTextureArrayLayerId;
   // The type of the shadow buffer.
   const ShadowBufferType shadowBufferType;
 
+  // The tile of the shadow atlas the shadowmap is drawn to (only for cone lights), reassigned by the shadow buffer manager as the importance of the light changes.
+  mutable ShadowAtlasTile shadowMapTile;
+  // The tile size last requested for the light, so that lights given a smaller tile while the atlas is full are not reassigned every frame.
+  mutable int32_t requestedTileSize;
+
   // The name of the shadow buffer.
   const std::string shadowBufferName;
 
 public:
+  // The layer ID of shadow buffers that could not be assigned a layer of the texture array.
+  const static uint32_t NO_LAYER_ID;
+
   ShadowBufferDetails(
       const GLuint &shadowBufferId,
       const GLuint &shadowBufferTextureArrayId,
@@ -53,6 +91,8 @@ public:
         shadowBufferTextureArrayId(shadowBufferTextureArrayId),
         shadowBufferTextureArrayLayerId(shadowBufferTextureArrayLayerId),
         shadowBufferType(shadowBufferType),
+        shadowMapTile({0, 0, 0}),
+        requestedTileSize(0),
         shadowBufferName(shadowBufferName) {}
 
   /**
@@ -85,6 +125,41 @@ public:
     return shadowBufferTextureArrayLayerId;
   }
 
+  /**
+   * Check if a layer of the texture array was assigned to the shadow buffer.
+   * Lights that are not among the most important ones of the frame do not get one, and are lit without shadows (or not at all).
+   * 
+   * @return Whether the shadow buffer has a shadow map or not.
+   */
+  bool hasShadowMap() const
+  {
+    return shadowBufferTextureArrayLayerId != NO_LAYER_ID;
+  }
+
+  /**
+   * Get the tile of the shadow atlas the shadowmap is drawn to.
+   * 
+   * @return The shadow atlas tile (with a size of 0 for point lights, and for cone lights evicted from the atlas).
+   */
+  const ShadowAtlasTile &getShadowMapTile() const
+  {
+    return shadowMapTile;
+  }
+
+  /**
+   * Get the region of the shadowmap texture the shadowmap is drawn to, in texture coordinates.
+   * 
+   * @return The offset (x, y) and size (z, w) of the region (with a size of 0 for cone lights evicted from the shadow atlas).
+   */
+  glm::vec4 getShadowMapRect() const
+  {
+    if (shadowBufferType == POINT)
+    {
+      return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    }
+    return glm::vec4(shadowMapTile.x, shadowMapTile.y, shadowMapTile.size, shadowMapTile.size) / static_cast<float_t>(RenderConfigManager::getConfig().coneLightShadowAtlasSize);
+  }
+
   /**
    * Get the name of the shadow buffer.
    * 
@@ -118,33 +193,59 @@ private:
   // Singleton instance of the shadow buffer manager.
   static ShadowBufferManager instance;
 
-  // A map of created textures.
-  std::map<const std::string, const std::shared_ptr<const ShadowBufferDetails>> namedShadowBuffers;
-  // A map counting the references to the created textures.
-  std::map<const std::string, int32_t> namedShadowBufferReferences;
+  // The name interner the names of the created shadow buffers are interned with.
+  NameInterner &nameInterner;
+  // A map of created textures, by their interned names.
+  FlatHashMap<NameId, std::shared_ptr<const ShadowBufferDetails>> namedShadowBuffers;
+  // A map counting the references to the created textures, by their interned names.
+  FlatHashMap<NameId, int32_t> namedShadowBufferReferences;
 
-  // The texture ID of the texture array for cone lights.
-  const GLuint coneLightTextureArrayId;
-  // The shadow framebuffer ID that the texture array for cone lights is attached to.
-  const GLuint coneLightShadowBufferId;
-  // The set of layer IDs being used in the texture array for cone lights.
+  // The texture ID of the shadow atlas for cone lights (0 until the first shadow buffer is created, like the other shadowmaps).
+  GLuint coneLightAtlasTextureId;
+  // The shadow framebuffer ID that the shadow atlas for cone lights is attached to.
+  GLuint coneLightShadowBufferId;
+  // The set of slots being used in the shadow atlas for cone lights (limited by the number of cone lights the model shaders take).
   static std::set<uint32_t> assignedConeLightTextureArrayLayerIds;
+  // The tiles of the shadow atlas for cone lights.
+  ShadowAtlas coneLightShadowAtlas;
+  // The texture ID of the copy of the shadow atlas for cone lights caching the shadows of the static casters (0 if not cached).
+  GLuint coneLightStaticAtlasTextureId;
+  // The shadow framebuffer ID that the static copy of the shadow atlas for cone lights is attached to (0 if not cached).
+  GLuint coneLightStaticShadowBufferId;
 
   // The texture ID of the texture array for point lights.
-  const GLuint pointLightTextureArrayId;
+  GLuint pointLightTextureArrayId;
   // The shadow framebuffer ID that the texture array for point lights is attached to.
-  const GLuint pointLightShadowBufferId;
+  GLuint pointLightShadowBufferId;
+  // The texture ID of the copy of the texture array for point lights caching the shadows of the static casters (0 if not cached).
+  GLuint pointLightStaticTextureArrayId;
+  // The shadow framebuffer ID that the static copy of the texture array for point lights is attached to (0 if not cached).
+  GLuint pointLightStaticShadowBufferId;
   // The set of layer IDs being used in the texture array for point lights.
   static std::set<uint32_t> assignedPointLightTextureArrayLayerIds;
 
+  // Whether the shadows of the static casters are cached in the static copies of the shadowmaps, switched on by the renderer while
+  //   static casters are registered.
+  bool isStaticCacheEnabled;
+
+  /**
+   * Get the internal format of the shadowmap texture arrays, chosen by the configured depth bits.
+   * 
+   * @return The depth format of the shadowmaps.
+   */
+  static GLenum getShadowMapDepthFormat()
+  {
+    return RenderConfigManager::getConfig().shadowMapDepthBits == 16 ? GL_DEPTH_COMPONENT16 : GL_DEPTH_COMPONENT24;
+  }
+
   /**
-   * Finds a free layer ID in the shadow map texture array that can be assigned to a cone light and returns it.
+   * Finds a free slot in the shadow atlas that can be assigned to a cone light and returns it.
    * 
-   * @return Index of an available layer in the cone light shadow map texture array.
+   * @return Index of an available slot in the cone light shadow atlas (or no layer ID if all the slots are in use).
    */
   uint32_t createNewConeLightLayerId()
   {
-    // Iterate through all possible indices for layers in the cone light shadow map texture array.
+    // Iterate through all possible indices for slots in the cone light shadow atlas.
     for (uint32_t i = 0; i < MAX_CONE_LIGHTS; i++)
     {
       // Check if the index is already in use.
@@ -159,15 +260,14 @@ private:
       return i;
     }
 
-    // Could not find any available index. Time to crash.
-    std::cout << "Failed at shadowbuffer 1" << std::endl;
-    exit(1);
+    // Could not find any available index, so the cone light will not cast shadows.
+    return ShadowBufferDetails::NO_LAYER_ID;
   }
 
   /**
    * Finds a free layer ID in the shadow map texture array that can be assigned to a point light and returns it.
    * 
-   * @return Index of an available layer in the point light shadow map texture array.
+   * @return Index of an available layer in the point light shadow map texture array (or no layer ID if all the layers are in use).
    */
   uint32_t createNewPointLightLayerId()
   {
@@ -186,9 +286,37 @@ private:
       return facesPerCubeMap * i;
     }
 
-    // Could not find any available index. Time to crash.
-    std::cout << "Failed at shadowbuffer 2" << std::endl;
-    exit(1);
+    // Could not find any available index, so the point light will not cast shadows.
+    return ShadowBufferDetails::NO_LAYER_ID;
+  }
+
+  /**
+   * Un-assign the layer (and for cone lights, the tile of the shadow atlas) reserved for the given shadow buffer, leaving it without a shadow map.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer to take the slot from.
+   */
+  void releaseShadowSlot(const std::shared_ptr<const ShadowBufferDetails> &shadowBufferDetails)
+  {
+    // Skip releasing the layer if the shadow buffer has none.
+    if (!shadowBufferDetails->hasShadowMap())
+    {
+      return;
+    }
+    // Check the type of light the shadow map was used for.
+    switch (shadowBufferDetails->getShadowBufferType())
+    {
+    case POINT:
+      // Un-assign the layer that was reserved for the shadow buffer in the point light shadow map texture array.
+      assignedPointLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId() / facesPerCubeMap);
+      break;
+    default:
+      // Un-assign the slot and the tile that were reserved for the shadow buffer in the cone light shadow atlas.
+      assignedConeLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId());
+      coneLightShadowAtlas.release(shadowBufferDetails->getShadowMapTile());
+      shadowBufferDetails->shadowMapTile = {0, 0, 0};
+      shadowBufferDetails->requestedTileSize = 0;
+    }
+    shadowBufferDetails->shadowBufferTextureArrayLayerId = ShadowBufferDetails::NO_LAYER_ID;
   }
 
   /**
@@ -205,7 +333,7 @@ private:
     // Create a new texture and store the framebuffer ID.
     glGenFramebuffers(1, &shadowBufferId);
     // Bind the framebuffer.
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
     // Attach the depth texture array as the depth texture for the bounded framebuffer.
     glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0);
 
@@ -222,106 +350,192 @@ private:
     }
 
     // Unbind the framebuffer now that we're done.
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Return the ID of the created framebuffer.
     return shadowBufferId;
   }
 
   /**
-   * Initialize the cone light shadow map texture array to which cone light
+   * Get the size of a texel of the shadowmaps in video memory.
+   * 
+   * @return The size of a texel in bytes (drivers store 24-bit depths padded to 32 bits).
+   */
+  static uint32_t getShadowMapBytesPerTexel()
+  {
+    return RenderConfigManager::getConfig().shadowMapDepthBits == 16 ? 2 : 4;
+  }
+
+  /**
+   * Initialize the cone light shadow atlas texture, whose tiles cone light
    *   shadow maps are drawn to.
+   * 
+   * @param assetName  The name the atlas is accounted under in the GPU memory.
    */
-  GLuint initializeConeLightTextureArrays()
+  GLuint initializeConeLightShadowAtlas(const std::string &assetName)
   {
+    const auto atlasSize = RenderConfigManager::getConfig().coneLightShadowAtlasSize;
     GLuint newTextureId;
     // Generate a new texture.
     glGenTextures(1, &newTextureId);
 
-    // Bind the texture as a 2D image texture array.
-    glBindTexture(GL_TEXTURE_2D_ARRAY, newTextureId);
-    // Define the size of an image, number of images (layers), and the type of data
-    //   being drawn to the texture array as a whole.
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, MAX_CONE_LIGHTS, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Bind the texture as a 2D image texture.
+    GlCalls::bindTexture(GL_TEXTURE_2D, newTextureId);
+    // Define the size of the atlas, and the type of data being drawn to it.
+    glTexImage2D(GL_TEXTURE_2D, 0, getShadowMapDepthFormat(), atlasSize, atlasSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::TEXTURE, newTextureId, GpuMemoryCategory::SHADOW_MAP, assetName, GpuMemoryManager::getTextureSize(atlasSize, atlasSize, 1, getShadowMapBytesPerTexel(), false));
 
     // Provide parameters for behaviour when reading coordinates that are out-of-bounds,
     //   as well as algorithms to use for maginifcation and minification.
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    // Set the color to black for the border of the layers in the texture array.
-    // Since the values for coordinates outside the range of layers in the texture
-    //   are clamped to the border, this will make sure that when the texture is
-    //   queried for out-of-bounds coordinates, a black color is returned, which
-    //   will mark those coordinates as always being in shadow.
-    GLfloat outsideMapDepth[] = {0.0f, 0.0f, 0.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, outsideMapDepth);
+    // Coordinates outside the tile of a light are handled by the model shaders, since they
+    //   would otherwise read the tiles of other lights.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Compare the depths against the reference depth given by the shaders when sampling, so that with linear filtering
+    //   the hardware returns the fraction of the closest 4 texels that the reference depth is not behind.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
     // Unbind the texture now that we're done.
-    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
 
     // Generate a shadow framebuffer for the cone light texture array and save the ID.
     return newTextureId;
   }
 
-  GLuint initializePointLightTextureArrays()
+  /**
+   * Initialize the point light cube map texture array, whose layers the faces of the point light shadow maps are drawn to.
+   * 
+   * @param assetName  The name the texture array is accounted under in the GPU memory.
+   */
+  GLuint initializePointLightTextureArrays(const std::string &assetName)
   {
+    const auto faceSize = RenderConfigManager::getConfig().pointLightShadowMapSize;
     GLuint newTextureId;
     // Generate a new texture.
     glGenTextures(1, &newTextureId);
 
     // Bind the texture as a cube map texture array.
-    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, newTextureId);
+    GlCalls::bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, newTextureId);
     // Define the size of a cube map, number of cube maps (face layers), and the type
     //   of data being drawn to the texture array as a whole.
     glTexImage3D(
         GL_TEXTURE_CUBE_MAP_ARRAY,
         0,
-        GL_DEPTH_COMPONENT,
-        FRAMEBUFFER_WIDTH,
-        FRAMEBUFFER_HEIGHT,
+        getShadowMapDepthFormat(),
+        faceSize,
+        faceSize,
         facesPerCubeMap * MAX_POINT_LIGHTS,
         0,
         GL_DEPTH_COMPONENT,
         GL_FLOAT,
         nullptr);
+    GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::TEXTURE, newTextureId, GpuMemoryCategory::SHADOW_MAP, assetName, GpuMemoryManager::getTextureSize(faceSize, faceSize, facesPerCubeMap * MAX_POINT_LIGHTS, getShadowMapBytesPerTexel(), false));
 
     // Provide parameters for behaviour when reading coordinates that are out-of-bounds,
     //   as well as algorithms to use for maginifcation and minification.
     glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Compare the depths against the reference depth given by the shaders when sampling (see the cone light texture array).
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
     // Unbind the texture now that we're done.
-    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+    GlCalls::bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
 
     // Generate a shadow framebuffer for the point light texture array and save the ID.
     return newTextureId;
   }
 
   ShadowBufferManager()
-      : namedShadowBuffers({}),
-        namedShadowBufferReferences({}),
-        coneLightTextureArrayId(initializeConeLightTextureArrays()),
-        coneLightShadowBufferId(createShadowBuffer(coneLightTextureArrayId)),
-        pointLightTextureArrayId(initializePointLightTextureArrays()),
-        pointLightShadowBufferId(createShadowBuffer(pointLightTextureArrayId))
+      : nameInterner(NameInterner::getInstance()),
+        namedShadowBuffers(),
+        namedShadowBufferReferences(),
+        coneLightAtlasTextureId(0),
+        coneLightShadowBufferId(0),
+        coneLightShadowAtlas(RenderConfigManager::getConfig().coneLightShadowAtlasSize, CONE_LIGHT_MIN_SHADOW_MAP_SIZE),
+        coneLightStaticAtlasTextureId(0),
+        coneLightStaticShadowBufferId(0),
+        pointLightTextureArrayId(0),
+        pointLightShadowBufferId(0),
+        pointLightStaticTextureArrayId(0),
+        pointLightStaticShadowBufferId(0),
+        isStaticCacheEnabled(false)
   {
   }
 
+  /**
+   * Create the shadowmaps and their framebuffers, when the first shadow buffer is created, so that the scenes without lights
+   *   (like the menus) do not allocate them, and they are not part of the startup.
+   */
+  void createShadowMaps()
+  {
+    coneLightAtlasTextureId = initializeConeLightShadowAtlas("Cone Light Atlas");
+    coneLightShadowBufferId = createShadowBuffer(coneLightAtlasTextureId);
+    pointLightTextureArrayId = initializePointLightTextureArrays("Point Light Arrays");
+    pointLightShadowBufferId = createShadowBuffer(pointLightTextureArrayId);
+    if (isStaticCacheEnabled)
+    {
+      createStaticShadowMaps();
+    }
+  }
+
+  /**
+   * Create the static copies of the shadowmaps caching the shadows of the static casters, in the same layers and tiles.
+   */
+  void createStaticShadowMaps()
+  {
+    coneLightStaticAtlasTextureId = initializeConeLightShadowAtlas("Cone Light Static Atlas");
+    coneLightStaticShadowBufferId = createShadowBuffer(coneLightStaticAtlasTextureId);
+    pointLightStaticTextureArrayId = initializePointLightTextureArrays("Point Light Static Arrays");
+    pointLightStaticShadowBufferId = createShadowBuffer(pointLightStaticTextureArrayId);
+  }
+
+  /**
+   * Delete the static copies of the shadowmaps, once no static casters are left to cache the shadows of.
+   */
+  void deleteStaticShadowMaps()
+  {
+    GlCalls::deleteTextures(1, &coneLightStaticAtlasTextureId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::TEXTURE, coneLightStaticAtlasTextureId);
+    GlCalls::deleteFramebuffers(1, &coneLightStaticShadowBufferId);
+    GlCalls::deleteTextures(1, &pointLightStaticTextureArrayId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::TEXTURE, pointLightStaticTextureArrayId);
+    GlCalls::deleteFramebuffers(1, &pointLightStaticShadowBufferId);
+    coneLightStaticAtlasTextureId = 0;
+    coneLightStaticShadowBufferId = 0;
+    pointLightStaticTextureArrayId = 0;
+    pointLightStaticShadowBufferId = 0;
+  }
+
   ~ShadowBufferManager()
   {
-    // Delete the texture array and framebuffer containing the shadow buffer data for cone lights.
-    glDeleteTextures(1, &coneLightTextureArrayId);
-    glDeleteFramebuffers(1, &coneLightShadowBufferId);
+    // Nothing to delete if no shadow buffer was ever created.
+    if (coneLightAtlasTextureId == 0)
+    {
+      return;
+    }
+
+    // Delete the shadow atlas and framebuffer containing the shadow buffer data for cone lights.
+    GlCalls::deleteTextures(1, &coneLightAtlasTextureId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::TEXTURE, coneLightAtlasTextureId);
+    GlCalls::deleteFramebuffers(1, &coneLightShadowBufferId);
 
     // Delete the texture array and framebuffer containing the shadow buffer data for point lights.
-    glDeleteTextures(1, &pointLightTextureArrayId);
-    glDeleteFramebuffers(1, &pointLightShadowBufferId);
+    GlCalls::deleteTextures(1, &pointLightTextureArrayId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::TEXTURE, pointLightTextureArrayId);
+    GlCalls::deleteFramebuffers(1, &pointLightShadowBufferId);
+
+    // Delete the static copies caching the shadows of the static casters, if they were created.
+    if (coneLightStaticAtlasTextureId != 0)
+    {
+      deleteStaticShadowMaps();
+    }
   }
 
 public:
@@ -338,16 +552,21 @@ public:
 	 * 
 	 * @return The details of the loaded shadow buffer.
 	 */
-  const std::shared_ptr<const ShadowBufferDetails> &createShadowBuffer(const std::string &shadowBufferName, const ShadowBufferType &shadowBufferType)
+  std::shared_ptr<const ShadowBufferDetails> createShadowBuffer(const std::string &shadowBufferName, const ShadowBufferType &shadowBufferType)
   {
     // Check if an shadow buffer with the name already exists.
-    const auto existingShadowBuffer = namedShadowBuffers.find(shadowBufferName);
+    const auto shadowBufferNameId = nameInterner.intern(shadowBufferName);
+    const auto existingShadowBuffer = namedShadowBuffers.find(shadowBufferNameId);
     if (existingShadowBuffer != namedShadowBuffers.end())
     {
       // Shadow buffer already created. Increase its reference count and return it.
-      namedShadowBufferReferences[shadowBufferName]++;
+      namedShadowBufferReferences[shadowBufferNameId]++;
       return existingShadowBuffer->second;
     }
+    if (coneLightAtlasTextureId == 0)
+    {
+      createShadowMaps();
+    }
 
     // Define a variable for storing the ID of the shadow framebuffer the shadow is being rendered to.
     GLuint shadowBufferId;
@@ -369,9 +588,9 @@ public:
     default:
       // Set the shadow framebuffer ID for cone lights.
       shadowBufferId = coneLightShadowBufferId;
-      // Set the texture array ID as the one for cone lights.
-      shadowBufferTextureArrayId = coneLightTextureArrayId;
-      // Get a layer assigned for the cone light 2D texture.
+      // Set the texture ID as the shadow atlas for cone lights.
+      shadowBufferTextureArrayId = coneLightAtlasTextureId;
+      // Get a slot assigned for the cone light in the shadow atlas (its tile is assigned by updateShadowAtlas).
       shadowBufferTextureArrayLayerId = createNewConeLightLayerId();
     }
 
@@ -379,12 +598,86 @@ public:
     const auto newShadowBuffer = std::make_shared<const ShadowBufferDetails>(shadowBufferId, shadowBufferTextureArrayId, shadowBufferTextureArrayLayerId, shadowBufferName, shadowBufferType);
 
     // Insert the newly created shadow buffer into the map of created textures.
-    namedShadowBuffers.insert(std::make_pair(shadowBufferName, newShadowBuffer));
+    namedShadowBuffers.emplace(shadowBufferNameId, newShadowBuffer);
     // Set the reference count of the shadow buffer to 1.
-    namedShadowBufferReferences[shadowBufferName] = 1;
+    namedShadowBufferReferences[shadowBufferNameId] = 1;
 
     // Return the shadow buffer details.
-    return namedShadowBuffers[shadowBufferName];
+    return newShadowBuffer;
+  }
+
+  /**
+   * Get the resolution of the textures the shadowmaps of the given shadow buffer type are drawn to.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The width and height of the shadow atlas (or of a cube map face) in pixels.
+   */
+  static int32_t getShadowMapSize(const ShadowBufferType &shadowBufferType)
+  {
+    const auto &renderConfig = RenderConfigManager::getConfig();
+    return shadowBufferType == POINT ? renderConfig.pointLightShadowMapSize : renderConfig.coneLightShadowAtlasSize;
+  }
+
+  /**
+   * Assign the tiles of the shadow atlas to the given cone light shadow buffers by their importance, so that the lights lighting
+   *   more of the view get the larger tiles. Lights keep their tiles while the size they need stays the same, and are given smaller
+   *   tiles (or evicted, and drawn without shadows) when the atlas is full.
+   * 
+   * @param shadowBufferImportances  The cone light shadow buffers, with their importance between 0 and 1 (the fraction of the view their light covers).
+   */
+  void updateShadowAtlas(std::vector<std::pair<std::shared_ptr<const ShadowBufferDetails>, float_t>> shadowBufferImportances)
+  {
+    // Handle the most important lights first, so that they are the last to be given smaller tiles.
+    std::stable_sort(shadowBufferImportances.begin(), shadowBufferImportances.end(), [](const auto &a, const auto &b)
+                     { return a.second > b.second; });
+
+    // Free the tiles of the lights whose importance changed their tile size, so that the space can be reused.
+    const auto maxTileSize = RenderConfigManager::getConfig().coneLightMaxShadowMapSize;
+    std::vector<int32_t> tileSizes;
+    for (const auto &shadowBufferImportance : shadowBufferImportances)
+    {
+      // Halve the largest tile size for as long as it is larger than the importance of the light needs.
+      auto tileSize = maxTileSize;
+      while (tileSize > CONE_LIGHT_MIN_SHADOW_MAP_SIZE && tileSize / 2 >= shadowBufferImportance.second * maxTileSize)
+      {
+        tileSize /= 2;
+      }
+      tileSizes.push_back(tileSize);
+
+      const auto &shadowBufferDetails = shadowBufferImportance.first;
+      if (shadowBufferDetails->requestedTileSize != tileSize)
+      {
+        coneLightShadowAtlas.release(shadowBufferDetails->shadowMapTile);
+        shadowBufferDetails->shadowMapTile = {0, 0, 0};
+        shadowBufferDetails->requestedTileSize = tileSize;
+      }
+    }
+
+    // Assign tiles to the lights without one, falling back to smaller tiles while the atlas has no space for the requested size.
+    for (uint32_t i = 0; i < shadowBufferImportances.size(); i++)
+    {
+      const auto &shadowBufferDetails = shadowBufferImportances[i].first;
+      for (auto tileSize = tileSizes[i]; shadowBufferDetails->shadowMapTile.size == 0 && tileSize >= CONE_LIGHT_MIN_SHADOW_MAP_SIZE; tileSize /= 2)
+      {
+        shadowBufferDetails->shadowMapTile = coneLightShadowAtlas.allocate(tileSize);
+      }
+    }
+  }
+
+  /**
+   * Get the size the shadowmap texture arrays take in video memory, to be compared against the shadow memory budget.
+   * 
+   * @return The estimated size of the shadowmaps in bytes.
+   */
+  static uint64_t getShadowMemorySize()
+  {
+    const auto &renderConfig = RenderConfigManager::getConfig();
+    const uint64_t bytesPerTexel = getShadowMapBytesPerTexel();
+    const uint64_t coneLightAtlasSize = static_cast<uint64_t>(renderConfig.coneLightShadowAtlasSize) * renderConfig.coneLightShadowAtlasSize * bytesPerTexel;
+    const uint64_t pointLightLayerSize = static_cast<uint64_t>(renderConfig.pointLightShadowMapSize) * renderConfig.pointLightShadowMapSize * bytesPerTexel;
+    // The static copies caching the shadows of the static casters take as much again while they are enabled.
+    return (coneLightAtlasSize + (pointLightLayerSize * facesPerCubeMap * MAX_POINT_LIGHTS)) * (instance.isStaticCacheEnabled ? 2 : 1);
   }
 
   /**
@@ -394,9 +687,159 @@ public:
    * 
    * @return The shadow buffer created with the given name.
    */
-  const std::shared_ptr<const ShadowBufferDetails> &getShadowBufferDetails(const std::string &shadowBufferName) const
+  std::shared_ptr<const ShadowBufferDetails> getShadowBufferDetails(const std::string &shadowBufferName) const
   {
-    return namedShadowBuffers.at(shadowBufferName);
+    return namedShadowBuffers.at(nameInterner.intern(shadowBufferName));
+  }
+
+  /**
+   * Clear the given layers of a shadowmap texture to the far depth straight in the texture, without attaching them to a
+   *   framebuffer, merging the runs of consecutive faces into a single clear.
+   * 
+   * @param textureId     The ID of the shadowmap texture.
+   * @param firstLayerId  The layer of the first face.
+   * @param faceMask      The mask of the faces to clear (a bit per face).
+   * @param faceSize      The width and height of a face (in texels).
+   */
+  static void clearShadowTextureLayers(const GLuint &textureId, const uint32_t &firstLayerId, const uint32_t &faceMask, const int32_t &faceSize)
+  {
+    const float_t farDepth = 1.0f;
+    for (uint32_t i = 0; i < facesPerCubeMap;)
+    {
+      if ((faceMask & (1u << i)) == 0)
+      {
+        i++;
+        continue;
+      }
+      auto runEnd = i + 1;
+      while (runEnd < facesPerCubeMap && (faceMask & (1u << runEnd)) != 0)
+      {
+        runEnd++;
+      }
+      glClearTexSubImage(textureId, 0, 0, 0, firstLayerId + i, faceSize, faceSize, runEnd - i, GL_DEPTH_COMPONENT, GL_FLOAT, &farDepth);
+      i = runEnd;
+    }
+  }
+
+  /**
+   * Clear only the layers of the shadow framebuffer texture array (or the tile of the shadow atlas) used by the given shadow buffer, leaving the other shadow maps intact.
+   * The layers are cleared straight in the texture where the driver can, which saves the framebuffer from being bound and its
+   *   attachment from being switched to each layer and back.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer to clear.
+   * @param faceMask             The mask of the cube map faces to clear for point lights (a bit per face, ignored for cone lights).
+   * @param isStaticCache        Whether to clear the static copy caching the shadows of the static casters instead.
+   */
+  void clearShadowBuffer(const std::shared_ptr<const ShadowBufferDetails> &shadowBufferDetails, const uint32_t &faceMask = 0x3F, const bool &isStaticCache = false) const
+  {
+    const auto &shadowBufferType = shadowBufferDetails->getShadowBufferType();
+    const auto &shadowBufferId = isStaticCache ? getStaticShadowBufferId(shadowBufferType) : shadowBufferDetails->getShadowBufferId();
+    const auto &shadowBufferTextureArrayId = isStaticCache ? getStaticShadowTextureId(shadowBufferType) : shadowBufferDetails->getShadowBufferTextureArrayId();
+    const auto isClearTextureSupported = WindowManager::getInstance().getGpuCapabilities().isClearTextureSupported;
+
+    // Clear only the tile of the shadow atlas for cone lights.
+    if (shadowBufferDetails->getShadowBufferType() != POINT)
+    {
+      const auto &shadowMapTile = shadowBufferDetails->getShadowMapTile();
+      if (shadowMapTile.size == 0)
+      {
+        return;
+      }
+      if (isClearTextureSupported)
+      {
+        const float_t farDepth = 1.0f;
+        glClearTexSubImage(shadowBufferTextureArrayId, 0, shadowMapTile.x, shadowMapTile.y, 0, shadowMapTile.size, shadowMapTile.size, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &farDepth);
+        return;
+      }
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
+      glEnable(GL_SCISSOR_TEST);
+      glScissor(shadowMapTile.x, shadowMapTile.y, shadowMapTile.size, shadowMapTile.size);
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glDisable(GL_SCISSOR_TEST);
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+      return;
+    }
+
+    if (isClearTextureSupported)
+    {
+      clearShadowTextureLayers(shadowBufferTextureArrayId, shadowBufferDetails->getShadowBufferTextureArrayLayerId(), faceMask, RenderConfigManager::getConfig().pointLightShadowMapSize);
+      return;
+    }
+
+    // Get the number of layers used by the shadow buffer (point lights use one layer per cube map face).
+    const uint32_t layerCount = shadowBufferDetails->getShadowBufferType() == POINT ? facesPerCubeMap : 1;
+
+    // Bind the shadow framebuffer as the active framebuffer.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
+    // Iterate through the layers of the shadow buffer.
+    for (uint32_t i = 0; i < layerCount; i++)
+    {
+      // Skip the faces that are not being rendered again.
+      if ((faceMask & (1u << i)) == 0)
+      {
+        continue;
+      }
+      // Attach only the current layer, so that clearing does not affect the rest of the texture array.
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0, shadowBufferDetails->getShadowBufferTextureArrayLayerId() + i);
+      glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    // Attach the whole texture array again, so that the geometry shaders can pick the layer to draw to.
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0);
+    // Bind the window framebuffer as the active framebuffer.
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  /**
+   * Copy the shadows of the static casters cached for the given shadow buffer over its layers (or its tile of the shadow atlas),
+   *   in place of clearing them, so that only the dynamic casters are drawn on top.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer to copy the cached shadows of.
+   * @param faceMask             The mask of the cube map faces to copy for point lights (a bit per face, ignored for cone lights).
+   */
+  void copyStaticShadowBuffer(const std::shared_ptr<const ShadowBufferDetails> &shadowBufferDetails, const uint32_t &faceMask) const
+  {
+    const auto &staticShadowTextureId = getStaticShadowTextureId(shadowBufferDetails->getShadowBufferType());
+    GlCalls::bindFramebuffer(GL_READ_FRAMEBUFFER, getStaticShadowBufferId(shadowBufferDetails->getShadowBufferType()));
+    GlCalls::bindFramebuffer(GL_DRAW_FRAMEBUFFER, shadowBufferDetails->getShadowBufferId());
+    // The copied depths replace the ones of the last frame entirely, so those are discarded instead of being loaded back first.
+    const auto isInvalidateSupported = WindowManager::getInstance().getGpuCapabilities().isInvalidateFramebufferSupported;
+    const GLenum depthAttachment = GL_DEPTH_ATTACHMENT;
+
+    // Copy only the tile of the shadow atlas for cone lights.
+    if (shadowBufferDetails->getShadowBufferType() != POINT)
+    {
+      const auto &shadowMapTile = shadowBufferDetails->getShadowMapTile();
+      const auto tileEndX = shadowMapTile.x + shadowMapTile.size, tileEndY = shadowMapTile.y + shadowMapTile.size;
+      if (isInvalidateSupported)
+      {
+        glInvalidateSubFramebuffer(GL_DRAW_FRAMEBUFFER, 1, &depthAttachment, shadowMapTile.x, shadowMapTile.y, shadowMapTile.size, shadowMapTile.size);
+      }
+      glBlitFramebuffer(shadowMapTile.x, shadowMapTile.y, tileEndX, tileEndY, shadowMapTile.x, shadowMapTile.y, tileEndX, tileEndY, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
+      return;
+    }
+
+    // Iterate through the faces of the cube map, attaching only the layer of the current face to both framebuffers.
+    for (uint32_t i = 0; i < facesPerCubeMap; i++)
+    {
+      if ((faceMask & (1u << i)) == 0)
+      {
+        continue;
+      }
+      const auto layerId = shadowBufferDetails->getShadowBufferTextureArrayLayerId() + i;
+      glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowTextureId, 0, layerId);
+      glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferDetails->getShadowBufferTextureArrayId(), 0, layerId);
+      const auto faceSize = RenderConfigManager::getConfig().pointLightShadowMapSize;
+      if (isInvalidateSupported)
+      {
+        glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 1, &depthAttachment);
+      }
+      glBlitFramebuffer(0, 0, faceSize, faceSize, 0, 0, faceSize, faceSize, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    // Attach the whole texture arrays again, so that the geometry shaders can pick the layer to draw to.
+    glFramebufferTexture(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowTextureId, 0);
+    glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferDetails->getShadowBufferTextureArrayId(), 0);
+    GlCalls::bindFramebuffer(GL_FRAMEBUFFER, 0);
   }
 
   /**
@@ -407,43 +850,136 @@ public:
   void destroyShadowBuffer(const std::shared_ptr<const ShadowBufferDetails> &shadowBufferDetails)
   {
     // Reduce the reference count of the shadow buffer.
-    namedShadowBufferReferences[shadowBufferDetails->getShadowBufferName()]--;
+    const auto shadowBufferNameId = nameInterner.intern(shadowBufferDetails->getShadowBufferName());
+    namedShadowBufferReferences[shadowBufferNameId]--;
     // Check if there are no more references to the shadow buffer.
-    if (namedShadowBufferReferences[shadowBufferDetails->getShadowBufferName()] <= 0)
+    if (namedShadowBufferReferences[shadowBufferNameId] <= 0)
     {
       // No more references left, so time to clean.
       // Remove the shadow buffer from the created textures references map.
-      namedShadowBufferReferences.erase(shadowBufferDetails->getShadowBufferName());
+      namedShadowBufferReferences.erase(shadowBufferNameId);
       // Remove the shadow buffer from the created textures map.
-      namedShadowBuffers.erase(shadowBufferDetails->getShadowBufferName());
-      // Check the type of light the shadow map was used for.
-      switch (shadowBufferDetails->getShadowBufferType())
+      namedShadowBuffers.erase(shadowBufferNameId);
+      // Release the layer of the shadow buffer, if it has one.
+      releaseShadowSlot(shadowBufferDetails);
+    }
+  }
+
+  /**
+   * Reassign the shadowmap slots of the given shadow buffer type, so that only the given shadow buffers have shadowmaps.
+   * Shadow buffers keeping their slots stay in the same layers (and tiles), so that their cached shadowmaps remain valid.
+   * 
+   * @param shadowBufferType  The type of the shadow buffers.
+   * @param shadowBuffers     The shadow buffers to give slots to, from the most important to the least important (the ones beyond the
+   *                            number of slots of the type do not get one).
+   */
+  void updateShadowSlots(const ShadowBufferType &shadowBufferType, const std::vector<std::shared_ptr<const ShadowBufferDetails>> &shadowBuffers)
+  {
+    // Find the shadow buffers that fit in the slots of the type.
+    const auto slotsCount = std::min(shadowBuffers.size(), static_cast<size_t>(shadowBufferType == POINT ? MAX_POINT_LIGHTS : MAX_CONE_LIGHTS));
+    std::set<const ShadowBufferDetails *> slottedShadowBuffers;
+    for (size_t i = 0; i < slotsCount; i++)
+    {
+      slottedShadowBuffers.insert(shadowBuffers[i].get());
+    }
+
+    // Take the slots away from the other shadow buffers of the type first, so that the freed slots can be handed out.
+    for (const auto &namedShadowBuffer : namedShadowBuffers)
+    {
+      if (namedShadowBuffer.second->getShadowBufferType() == shadowBufferType && slottedShadowBuffers.count(namedShadowBuffer.second.get()) == 0)
+      {
+        releaseShadowSlot(namedShadowBuffer.second);
+      }
+    }
+
+    // Give slots to the shadow buffers without one.
+    for (size_t i = 0; i < slotsCount; i++)
+    {
+      if (!shadowBuffers[i]->hasShadowMap())
       {
-      case POINT:
-        // Un-assign the layer that was reserved for the shadow buffer in the point light shadow map texture array.
-        assignedPointLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId() / facesPerCubeMap);
-        break;
-      default:
-        // Un-assign the layer that was reserved for the shadow buffer in the cone light shadow map texture array.
-        assignedConeLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId());
+        shadowBuffers[i]->shadowBufferTextureArrayLayerId = shadowBufferType == POINT ? createNewPointLightLayerId() : createNewConeLightLayerId();
       }
     }
   }
 
   /**
-   * Get the ID of the texture array of the cone light shadow textures.
+   * Enable or disable caching the shadows of the static casters in the static copies of the shadowmaps, creating the copies when
+   *   enabled (once the shadowmaps exist) and deleting them when disabled, so that they only take memory while static casters
+   *   are registered.
+   * 
+   * @param isEnabled  Whether the shadows of the static casters are cached.
+   */
+  void setStaticShadowCacheEnabled(const bool &isEnabled)
+  {
+    if (isStaticCacheEnabled == isEnabled)
+    {
+      return;
+    }
+    isStaticCacheEnabled = isEnabled;
+
+    // The copies are created along with the shadowmaps if those do not exist yet.
+    if (coneLightAtlasTextureId == 0)
+    {
+      return;
+    }
+    if (isEnabled)
+    {
+      createStaticShadowMaps();
+    }
+    else
+    {
+      deleteStaticShadowMaps();
+    }
+  }
+
+  /**
+   * Check if the shadows of the static casters are cached in the static copies of the shadowmaps.
+   * 
+   * @return Whether the static shadow cache is enabled or not.
+   */
+  const bool &isStaticShadowCacheEnabled() const
+  {
+    return isStaticCacheEnabled;
+  }
+
+  /**
+   * Get the ID of the shadow framebuffer the static copy of the shadowmaps of the given type is attached to.
+   * 
+   * @param shadowBufferType  The type of the shadow buffers.
+   * 
+   * @return The ID of the static shadow buffer (0 if the static shadow cache is disabled).
+   */
+  const GLuint &getStaticShadowBufferId(const ShadowBufferType &shadowBufferType) const
+  {
+    return shadowBufferType == POINT ? pointLightStaticShadowBufferId : coneLightStaticShadowBufferId;
+  }
+
+  /**
+   * Get the ID of the texture of the static copy of the shadowmaps of the given type.
+   * 
+   * @param shadowBufferType  The type of the shadow buffers.
+   * 
+   * @return The ID of the static shadow texture (0 if the static shadow cache is disabled).
+   */
+  const GLuint &getStaticShadowTextureId(const ShadowBufferType &shadowBufferType) const
+  {
+    return shadowBufferType == POINT ? pointLightStaticTextureArrayId : coneLightStaticAtlasTextureId;
+  }
+
+  /**
+   * Get the ID of the shadow atlas texture of the cone light shadow maps.
    * 
-   * @return The ID of the texture array.
+   * @return The ID of the shadow atlas texture (0 if no shadow buffer was created yet).
    */
-  const GLuint &getConeLightTextureArrayId() const
+  const GLuint &getConeLightAtlasTextureId() const
   {
-    return coneLightTextureArrayId;
+    return coneLightAtlasTextureId;
   }
 
   /**
    * Get the ID of the texture array of the point light shadow textures.
    * 
-   * @return The ID of the texture array.
+   * @return The ID of the texture array (0 if no shadow buffer was created yet).
    */
   const GLuint &getPointLightTextureArrayId() const
   {
@@ -481,9 +1017,11 @@ public:
   }
 };
 
+// Initialize the layer ID of shadow buffers without a layer static variable.
+const uint32_t ShadowBufferDetails::NO_LAYER_ID = std::numeric_limits<uint32_t>::max();
 // Initialize the number of faces in a single cube map static variable.
 const unsigned short ShadowBufferManager::facesPerCubeMap = 6;
-// Initialize the cone lights texture array assigned layer IDs set static variable.
+// Initialize the cone lights shadow atlas assigned slots set static variable.
 std::set<uint32_t> ShadowBufferManager::assignedConeLightTextureArrayLayerIds = std::set<uint32_t>({});
 // Initialize the point lights texture array assigned layer IDs set static variable.
 std::set<uint32_t> ShadowBufferManager::assignedPointLightTextureArrayLayerIds = std::set<uint32_t>({});
@@ -0,0 +1,190 @@
+#ifndef INCLUDE_SIMULATION_CLOCK_CPP
+#define INCLUDE_SIMULATION_CLOCK_CPP
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+
+#include "constants.cpp"
+
+/**
+ * A clock class for running the simulation of a scene in steps of a fixed length, however many frames are rendered.
+ * Each frame adds the real time that passed to an accumulator, which is spent on as many steps as fit into it, and whatever is
+ *   left (less than a step) is used to interpolate the rendered transforms between the last two steps.
+ * While no fixed-step simulation is running, the simulation time is just the real time, so that the models updated once per
+ *   frame (like in the menu scenes) behave as before.
+ */
+class SimulationClock
+{
+private:
+  // Singleton instance of the simulation clock.
+  static SimulationClock instance;
+
+  // Whether the simulation is run in fixed steps.
+  bool isFixedStepActive;
+  // Whether each frame runs a set number of steps, however much real time passed, so that the simulation does not depend on the
+  //   frame times (e.g. for the benchmark mode, or when replaying a recorded session).
+  bool isLockStepActive;
+  // The number of steps each frame runs in lock step.
+  uint32_t lockStepsCount;
+  // The time the simulation has reached (in seconds).
+  double_t simulationTime;
+  // The real time of the start of the last frame (in seconds).
+  double_t lastFrameTime;
+  // The real time not spent on steps yet (in seconds, less than a step at the end of a frame).
+  double_t accumulatedTime;
+  // The number of steps run in the last frame.
+  uint32_t frameStepsCount;
+  // The number of steps dropped, for the frames that fell behind by more than the catch-up limit.
+  uint64_t droppedStepsCount;
+
+  SimulationClock()
+      : isFixedStepActive(false),
+        isLockStepActive(false),
+        lockStepsCount(1),
+        simulationTime(0.0),
+        lastFrameTime(0.0),
+        accumulatedTime(0.0),
+        frameStepsCount(0),
+        droppedStepsCount(0) {}
+
+public:
+  // Preventing copying the simulation clock, making sure only one instance can exist.
+  SimulationClock(const SimulationClock &) = delete;
+
+  /**
+   * Start running the simulation in fixed steps, from the current real time.
+   */
+  void startFixedStep()
+  {
+    isFixedStepActive = true;
+    simulationTime = glfwGetTime();
+    lastFrameTime = simulationTime;
+    accumulatedTime = 0.0;
+    frameStepsCount = 0;
+    droppedStepsCount = 0;
+  }
+
+  /**
+   * Stop running the simulation in fixed steps, going back to the real time.
+   */
+  void stopFixedStep()
+  {
+    isFixedStepActive = false;
+  }
+
+  /**
+   * Set whether each frame runs a set number of steps, instead of as many as the real time since the last frame fits.
+   * 
+   * @param isActive    Whether the simulation runs in lock step with the frames.
+   * @param stepsCount  The number of steps each frame runs in lock step (e.g. the number a recorded frame ran).
+   */
+  void setLockStep(const bool &isActive, const uint32_t &stepsCount = 1)
+  {
+    isLockStepActive = isActive;
+    lockStepsCount = stepsCount;
+  }
+
+  /**
+   * Add the real time since the last frame to the accumulator, and find the number of steps to run in the frame. If the simulation
+   *   fell behind by more than the catch-up limit (e.g. after a hitch), the steps beyond it are dropped, slowing the simulation
+   *   down instead of spending ever longer frames catching up.
+   * 
+   * @return The number of steps to run in the frame, each started with advanceStep().
+   */
+  uint32_t beginFrame()
+  {
+    const auto frameTime = glfwGetTime();
+    accumulatedTime += frameTime - lastFrameTime;
+    lastFrameTime = frameTime;
+    if (isLockStepActive)
+    {
+      // Nothing is left to interpolate, since the rendered state is always the one after the step.
+      accumulatedTime = 0.0;
+      frameStepsCount = lockStepsCount;
+      return frameStepsCount;
+    }
+
+    const auto stepsCount = static_cast<uint64_t>(std::floor(accumulatedTime / SIMULATION_STEP_TIME));
+    frameStepsCount = static_cast<uint32_t>(std::min<uint64_t>(stepsCount, MAX_SIMULATION_STEPS_PER_FRAME));
+    droppedStepsCount += stepsCount - frameStepsCount;
+    accumulatedTime = std::max(accumulatedTime - (stepsCount * SIMULATION_STEP_TIME), 0.0);
+    return frameStepsCount;
+  }
+
+  /**
+   * Advance the simulation time by a step, before the step is run.
+   */
+  void advanceStep()
+  {
+    simulationTime += SIMULATION_STEP_TIME;
+  }
+
+  /**
+   * Get the time the simulation has reached, which the models are updated with.
+   * 
+   * @return The simulation time (in seconds), or the real time if no fixed-step simulation is running.
+   */
+  double_t getTime() const
+  {
+    return isFixedStepActive ? simulationTime : glfwGetTime();
+  }
+
+  /**
+   * Get how far the real time is between the last two steps, to interpolate the rendered transforms with.
+   * 
+   * @return The interpolation factor, from 0 (the state before the last step) to 1 (the state after it, always the case if no
+   *   fixed-step simulation is running, or it runs in lock step).
+   */
+  float_t getInterpolationFactor() const
+  {
+    return isFixedStepActive && !isLockStepActive ? static_cast<float_t>(accumulatedTime / SIMULATION_STEP_TIME) : 1.0f;
+  }
+
+  /**
+   * Get the time the rendered transforms are interpolated to, between the last two steps, to animate the rendered models with.
+   * 
+   * @return The simulation time less the part of the last step the interpolation has not reached (in seconds).
+   */
+  double_t getRenderTime() const
+  {
+    return getTime() - ((1.0 - getInterpolationFactor()) * SIMULATION_STEP_TIME);
+  }
+
+  /**
+   * Get the number of steps run in the last frame.
+   * 
+   * @return The number of steps.
+   */
+  const uint32_t &getFrameStepsCount() const
+  {
+    return frameStepsCount;
+  }
+
+  /**
+   * Get the number of steps dropped since the fixed-step simulation started.
+   * 
+   * @return The number of steps dropped.
+   */
+  const uint64_t &getDroppedStepsCount() const
+  {
+    return droppedStepsCount;
+  }
+
+  /**
+   * Returns the singleton instance of the simulation clock.
+   * 
+   * @return The simulation clock singleton instance.
+   */
+  static SimulationClock &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the simulation clock singleton instance static variable.
+SimulationClock SimulationClock::instance;
+
+#endif
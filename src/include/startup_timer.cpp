@@ -0,0 +1,363 @@
+#ifndef INCLUDE_STARTUP_TIMER_CPP
+#define INCLUDE_STARTUP_TIMER_CPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <ostream>
+#include <cmath>
+
+#include "command_line.cpp"
+#include "trace_writer.cpp"
+
+// Concatenate two tokens after expanding them, for naming the phase variables after their lines.
+#define STARTUP_TIMER_CONCAT_TOKENS(first, second) first##second
+#define STARTUP_TIMER_CONCAT(first, second) STARTUP_TIMER_CONCAT_TOKENS(first, second)
+
+// Time the rest of the scope as a phase of the startup with the given category and name, if the startup is not over yet.
+#define STARTUP_PHASE(category, phaseName) const StartupPhase STARTUP_TIMER_CONCAT(startupPhase, __LINE__)(category, phaseName)
+
+/**
+ * Structure for defining a step or a phase of the startup, once it ended.
+ */
+struct StartupSpan
+{
+  // The category of the span (e.g. "Shader Compile"), which the report sums the spans by.
+  const char *category;
+  // The name of the span (e.g. the name of the shader program compiled).
+  std::string name;
+  // The index of the thread that recorded the span, in the order the threads first recorded one (0 for the main thread).
+  uint32_t threadIndex;
+  // The times the span started and ended (in milliseconds from the start of the startup).
+  double_t startTime;
+  double_t endTime;
+};
+
+/**
+ * A manager class for tracing the startup of the engine, from the start of the static initialization (the timer is the first
+ *   static object constructed) until the first frame of the first scene is presented.
+ * The startup is split into steps, each timed from the end of the one before it so that they add up to the time to the first
+ *   frame, and the work done during them is timed as phases (e.g. the initialization of GLFW, the font, the dependencies of each
+ *   model and the compiling and linking of each shader program), on whichever thread does it. Once the startup is over, a report
+ *   of the steps, of the phases summed by category and of the slowest phases is written out, along with a Chrome Trace Event
+ *   JSON file of all of them if the "--startup-trace" option gives its path. Phases recorded after the startup cost a check.
+ */
+class StartupTimer
+{
+private:
+  // Singleton instance of the startup timer.
+  static StartupTimer instance;
+
+  // The category of the steps.
+  static constexpr const char *STEP_CATEGORY = "Step";
+  // The number of the slowest phases listed by the report.
+  static constexpr size_t REPORTED_PHASES_COUNT = 10;
+
+  // The time the startup started at (the construction of the timer), and the time the last step ended at.
+  const std::chrono::steady_clock::time_point startTime;
+  std::chrono::steady_clock::time_point lastStepTime;
+  // The path the trace of the startup is written to (empty if it was not asked for).
+  const std::string tracePath;
+  // The steps and the phases of the startup so far, in the order they ended.
+  std::vector<StartupSpan> spans;
+  // The threads that recorded a span, by their indices.
+  std::vector<std::thread::id> threadIds;
+  // Whether the first scene finished loading, so that the next frame presented ends the startup.
+  std::atomic<bool> isSceneLoaded;
+  // Whether the startup is still running, checked by the phases without the lock.
+  std::atomic<bool> isRunning;
+  // The mutex guarding the spans, since the phases are recorded by the worker threads as well.
+  std::mutex spansMutex;
+
+  /**
+   * Find the path of the trace of the startup, given by the "--startup-trace" option.
+   * 
+   * @return The path of the trace, or an empty one if it was not asked for.
+   */
+  static std::string findTracePath()
+  {
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i + 1 < arguments.size(); i++)
+    {
+      if (arguments[i] == "--startup-trace")
+      {
+        return arguments[i + 1];
+      }
+    }
+    return "";
+  }
+
+  /**
+   * Get the time in milliseconds from the start of the startup until the given time.
+   * 
+   * @param time  The time.
+   * 
+   * @return The time since the start of the startup in milliseconds.
+   */
+  double_t getMilliseconds(const std::chrono::steady_clock::time_point &time) const
+  {
+    return std::chrono::duration<double_t, std::milli>(time - startTime).count();
+  }
+
+  /**
+   * Get the index of the calling thread, giving it the next one if it did not record a span yet. The spans mutex must be locked.
+   * 
+   * @return The index of the thread.
+   */
+  uint32_t getThreadIndex()
+  {
+    const auto threadId = std::this_thread::get_id();
+    const auto existingThread = std::find(threadIds.begin(), threadIds.end(), threadId);
+    if (existingThread != threadIds.end())
+    {
+      return static_cast<uint32_t>(existingThread - threadIds.begin());
+    }
+    threadIds.push_back(threadId);
+    return static_cast<uint32_t>(threadIds.size() - 1);
+  }
+
+  /**
+   * Write the report of the startup: the steps in their order, the total time of the phases of each category, and the slowest
+   *   phases, both from the slowest. The phases of a category may overlap (e.g. the shaders compiled by the driver together),
+   *   so their totals can add up to more than the steps.
+   * 
+   * @param stream          The stream to write the report to.
+   * @param firstFrameTime  The time the first frame was presented (in milliseconds from the start of the startup).
+   */
+  void writeReport(std::ostream &stream, const double_t &firstFrameTime) const
+  {
+    std::vector<const StartupSpan *> phases({});
+    std::map<std::string, std::pair<double_t, uint32_t>> categoryTotals({});
+    stream << "Startup:";
+    for (const auto &span : spans)
+    {
+      if (span.category == STEP_CATEGORY)
+      {
+        stream << " " << span.name << " " << span.endTime - span.startTime << "ms |";
+        continue;
+      }
+      phases.push_back(&span);
+      auto &categoryTotal = categoryTotals[span.category];
+      categoryTotal.first += span.endTime - span.startTime;
+      categoryTotal.second++;
+    }
+    stream << " Time To First Frame: " << firstFrameTime << "ms" << std::endl;
+
+    std::vector<std::pair<std::string, std::pair<double_t, uint32_t>>> sortedCategories(categoryTotals.begin(), categoryTotals.end());
+    std::sort(sortedCategories.begin(), sortedCategories.end(), [](const auto &first, const auto &second) {
+      return first.second.first > second.second.first;
+    });
+    stream << "Startup Phases:";
+    for (const auto &category : sortedCategories)
+    {
+      stream << " " << category.first << " " << category.second.first << "ms (" << category.second.second << ") |";
+    }
+    stream << std::endl;
+
+    const auto reportedCount = std::min(phases.size(), REPORTED_PHASES_COUNT);
+    std::partial_sort(phases.begin(), phases.begin() + reportedCount, phases.end(), [](const StartupSpan *first, const StartupSpan *second) {
+      return first->endTime - first->startTime > second->endTime - second->startTime;
+    });
+    stream << "Slowest Startup Phases:";
+    for (size_t i = 0; i < reportedCount; i++)
+    {
+      stream << " " << phases[i]->category << " " << phases[i]->name << " " << phases[i]->endTime - phases[i]->startTime << "ms |";
+    }
+    stream << std::endl;
+  }
+
+  /**
+   * Write the steps and the phases of the startup as a Chrome Trace Event JSON file, the steps on a track of their own and the
+   *   phases on the threads that recorded them.
+   * 
+   * @return Whether the file was written.
+   */
+  bool writeTrace() const
+  {
+    TraceWriter writer(tracePath);
+    if (!writer.isOpen())
+    {
+      return false;
+    }
+
+    writer.writeNameEvent("thread_name", 1, 0, "Steps");
+    for (uint32_t i = 0; i < threadIds.size(); i++)
+    {
+      writer.writeNameEvent("thread_name", 1, i + 1, i == 0 ? std::string("Main Thread") : "Thread " + std::to_string(i));
+    }
+    // The trace times are in microseconds.
+    for (const auto &span : spans)
+    {
+      writer.writeCompleteEvent(span.name, 1, span.category == STEP_CATEGORY ? 0 : span.threadIndex + 1, span.startTime * 1000, (span.endTime - span.startTime) * 1000, span.category);
+    }
+    return writer.finish();
+  }
+
+  StartupTimer()
+      : startTime(std::chrono::steady_clock::now()),
+        lastStepTime(startTime),
+        tracePath(findTracePath()),
+        spans({}),
+        threadIds({std::this_thread::get_id()}),
+        isSceneLoaded(false),
+        isRunning(true),
+        spansMutex() {}
+
+public:
+  // Preventing copying the startup timer, making sure only one instance can exist.
+  StartupTimer(const StartupTimer &) = delete;
+
+  /**
+   * Check if the startup is still running, so that its phases are recorded.
+   * 
+   * @return Whether the startup is still running or not.
+   */
+  bool isStartupRunning() const
+  {
+    return isRunning.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the current time, for the start of a phase.
+   * 
+   * @return The time since the start of the startup in milliseconds.
+   */
+  double_t getTime() const
+  {
+    return getMilliseconds(std::chrono::steady_clock::now());
+  }
+
+  /**
+   * Record a phase of the startup done by the calling thread. Ignored once the startup is over.
+   * 
+   * @param category        The category of the phase, which has to outlive the startup timer.
+   * @param phaseName       The name of the phase.
+   * @param phaseStartTime  The time the phase started (in milliseconds from the start of the startup).
+   * @param phaseEndTime    The time the phase ended (in milliseconds from the start of the startup).
+   */
+  void recordPhase(const char *category, const std::string &phaseName, const double_t &phaseStartTime, const double_t &phaseEndTime)
+  {
+    const std::lock_guard<std::mutex> lock(spansMutex);
+    if (!isStartupRunning())
+    {
+      return;
+    }
+    spans.push_back({category, phaseName, getThreadIndex(), phaseStartTime, phaseEndTime});
+  }
+
+  /**
+   * End a step of the startup, timed from the end of the last one (or the start of the startup). Ignored once the startup is
+   *   over.
+   * 
+   * @param stepName  The name of the step.
+   */
+  void recordStep(const std::string &stepName)
+  {
+    const std::lock_guard<std::mutex> lock(spansMutex);
+    if (!isStartupRunning())
+    {
+      return;
+    }
+    const auto currentTime = std::chrono::steady_clock::now();
+    spans.push_back({STEP_CATEGORY, stepName, 0, getMilliseconds(lastStepTime), getMilliseconds(currentTime)});
+    lastStepTime = currentTime;
+  }
+
+  /**
+   * End the loading of the first scene as a step of the startup, so that the next frame presented (its first one) ends the
+   *   startup.
+   * 
+   * @param sceneId  The ID of the scene.
+   */
+  void recordSceneLoaded(const std::string &sceneId)
+  {
+    recordStep(sceneId + " Loading");
+    isSceneLoaded.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * End the startup once the first frame of the first scene is presented, as its last step since the one before, and write out
+   *   the report (and the trace, if asked for). Ignored for the frames presented before that (e.g. the loading frames).
+   * 
+   * @param stream  The stream to write the report of the startup to.
+   */
+  void recordFirstFrame(std::ostream &stream)
+  {
+    if (!isSceneLoaded.load(std::memory_order_relaxed) || !isStartupRunning())
+    {
+      return;
+    }
+    recordStep("First Frame");
+
+    const std::lock_guard<std::mutex> lock(spansMutex);
+    isRunning.store(false, std::memory_order_relaxed);
+    writeReport(stream, getMilliseconds(lastStepTime));
+    if (!tracePath.empty() && !writeTrace())
+    {
+      stream << "Failed to write the startup trace " << tracePath << std::endl;
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the startup timer.
+   * 
+   * @return The startup timer singleton instance.
+   */
+  static StartupTimer &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the startup timer singleton instance static variable.
+StartupTimer StartupTimer::instance;
+
+/**
+ * Class for timing the rest of a scope as a phase of the startup (through the STARTUP_PHASE macro). Nothing is recorded (or
+ *   copied) once the startup is over.
+ */
+class StartupPhase
+{
+private:
+  // The category of the phase, which has to outlive the startup timer.
+  const char *category;
+  // The name of the phase (only kept while the startup is running).
+  std::string phaseName;
+  // Whether the phase is recorded, since the startup was running when it started.
+  const bool isRecorded;
+  // The time the phase started (in milliseconds from the start of the startup).
+  double_t startTime;
+
+public:
+  StartupPhase(const char *category, const std::string &phaseName)
+      : category(category),
+        phaseName(),
+        isRecorded(StartupTimer::getInstance().isStartupRunning()),
+        startTime(0.0)
+  {
+    if (isRecorded)
+    {
+      this->phaseName = phaseName;
+      startTime = StartupTimer::getInstance().getTime();
+    }
+  }
+
+  ~StartupPhase()
+  {
+    if (isRecorded)
+    {
+      auto &startupTimer = StartupTimer::getInstance();
+      startupTimer.recordPhase(category, phaseName, startTime, startupTimer.getTime());
+    }
+  }
+
+  StartupPhase(const StartupPhase &) = delete;
+};
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef INCLUDE_STREAM_BUFFER_CPP
+#define INCLUDE_STREAM_BUFFER_CPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+#include "constants.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "gl_debug.cpp"
+
+/**
+ * Structure for defining a part of the stream buffer handed out for the data of a frame.
+ */
+struct StreamAllocation
+{
+  // The ID of the buffer the data is read from by the draws (0 if the region of the frame was full).
+  GLuint bufferId;
+  // The byte offset of the data in the buffer, to point the attributes at.
+  size_t offset;
+  // The size of the allocation in bytes.
+  size_t size;
+  // The memory the data is written to, in the mapped buffer or in the staged data of the frame (null if the region was full).
+  uint8_t *data;
+};
+
+/**
+ * A manager class for streaming the data written anew every frame (e.g. the glyph instances of the text, the debug lines and the
+ *   shadow casters) through one buffer split into regions, each written by one frame while the GPU may still read the others.
+ * The data is handed out as aligned sub-allocations of the region of the frame. When the driver supports buffer storage, the
+ *   buffer is persistently and coherently mapped, and the region is waited for through the fence of the last frame that used it
+ *   before its first allocation in a frame, so that no upload goes through the driver and nothing stalls implicitly. Otherwise,
+ *   the allocations are staged and uploaded once written, into a single region orphaned at the first allocation of the frame.
+ * The buffer is created at the first allocation, since the manager is created before the GL context.
+ */
+class StreamBufferManager
+{
+private:
+  // Singleton instance of the stream buffer manager.
+  static StreamBufferManager instance;
+
+  // The GPU memory manager the stream buffer is accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The ID of the stream buffer (0 until the first allocation).
+  GLuint bufferId;
+  // Whether the stream buffer is persistently mapped, instead of being uploaded to as the allocations are written.
+  bool isPersistent;
+  // The stream buffer mapped for writing, if it is persistently mapped.
+  uint8_t *mappedData;
+  // The allocations of the frame, staged for the upload if the stream buffer is not persistently mapped.
+  std::vector<uint8_t> stagedData;
+  // The fences of the frames that last read each region, if the stream buffer is persistently mapped.
+  std::array<GLsync, STREAM_BUFFER_REGIONS> regionFences;
+  // The region written by the frame.
+  uint32_t currentRegion;
+  // The number of bytes of the region of the frame handed out so far.
+  size_t regionOffset;
+  // Whether the region of the frame was waited for (or orphaned) since the frame started.
+  bool isRegionAcquired;
+
+  /**
+   * Create the stream buffer, with all its regions if it can be persistently mapped.
+   */
+  void createBuffer()
+  {
+    isPersistent = GLEW_ARB_buffer_storage;
+    const auto bufferSize = STREAM_BUFFER_REGION_SIZE * (isPersistent ? STREAM_BUFFER_REGIONS : 1);
+
+    glGenBuffers(1, &bufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+    if (isPersistent)
+    {
+      // Create immutable storage for all the regions, and keep it mapped for the lifetime of the stream buffer manager.
+      const auto mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, NULL, mapFlags);
+      mappedData = static_cast<uint8_t *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, mapFlags));
+    }
+    else
+    {
+      GlCalls::bufferData(GL_COPY_WRITE_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+      stagedData.resize(STREAM_BUFFER_REGION_SIZE);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "Stream Buffer", bufferSize);
+    GlDebugManager::getInstance().labelObject(GL_BUFFER, bufferId, "Stream Buffer");
+  }
+
+  /**
+   * Make the region of the frame writable, waiting for the frame that last read it, or orphaning the storage read by the last
+   *   frame if the stream buffer is not persistently mapped.
+   */
+  void acquireRegion()
+  {
+    if (bufferId == 0)
+    {
+      createBuffer();
+    }
+    isRegionAcquired = true;
+
+    if (!isPersistent)
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+      GlCalls::bufferData(GL_COPY_WRITE_BUFFER, STREAM_BUFFER_REGION_SIZE, NULL, GL_STREAM_DRAW);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+      return;
+    }
+
+    // Wait for the frame that last read the region, which is usually long done since the other regions were used in between.
+    auto &regionFence = regionFences[currentRegion];
+    if (regionFence != nullptr)
+    {
+      while (glClientWaitSync(regionFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+      {
+      }
+      glDeleteSync(regionFence);
+      regionFence = nullptr;
+    }
+  }
+
+  StreamBufferManager()
+      : gpuMemoryManager(GpuMemoryManager::getInstance()),
+        bufferId(0),
+        isPersistent(false),
+        mappedData(nullptr),
+        stagedData({}),
+        regionFences({}),
+        currentRegion(0),
+        regionOffset(0),
+        isRegionAcquired(false) {}
+
+  ~StreamBufferManager()
+  {
+    if (bufferId == 0)
+    {
+      return;
+    }
+    for (const auto &regionFence : regionFences)
+    {
+      if (regionFence != nullptr)
+      {
+        glDeleteSync(regionFence);
+      }
+    }
+    if (isPersistent)
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &bufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, bufferId);
+  }
+
+public:
+  // Preventing copying the stream buffer manager, making sure only one instance can exist.
+  StreamBufferManager(const StreamBufferManager &) = delete;
+
+  /**
+   * Hand out a part of the region of the frame for data read by the draws of the frame. Must be called on the thread the GL
+   *   context is current on, and the data must be committed once written.
+   * 
+   * @param size       The size of the data in bytes.
+   * @param alignment  The alignment of the offset of the data in the buffer (e.g. the size of a vertex attribute component).
+   * 
+   * @return The allocation, with no buffer and no memory if the region of the frame has no room left for it.
+   */
+  StreamAllocation allocate(const size_t &size, const size_t &alignment = 16)
+  {
+    if (!isRegionAcquired)
+    {
+      acquireRegion();
+    }
+
+    const auto offset = ((regionOffset + alignment - 1) / alignment) * alignment;
+    if (size == 0 || offset + size > STREAM_BUFFER_REGION_SIZE)
+    {
+      return {0, 0, 0, nullptr};
+    }
+    regionOffset = offset + size;
+
+    if (isPersistent)
+    {
+      const auto bufferOffset = (currentRegion * STREAM_BUFFER_REGION_SIZE) + offset;
+      return {bufferId, bufferOffset, size, mappedData + bufferOffset};
+    }
+    return {bufferId, offset, size, stagedData.data() + offset};
+  }
+
+  /**
+   * Make the written data of an allocation available to the draws. The mapping is coherent, so this only uploads the data if
+   *   the stream buffer is not persistently mapped.
+   * 
+   * @param allocation   The allocation.
+   * @param writtenSize  The number of bytes written from the start of the allocation.
+   */
+  void commit(const StreamAllocation &allocation, const size_t &writtenSize)
+  {
+    if (isPersistent || allocation.data == nullptr || writtenSize == 0)
+    {
+      return;
+    }
+    GlCalls::namedBufferSubData(GL_COPY_WRITE_BUFFER, bufferId, allocation.offset, writtenSize, allocation.data);
+  }
+
+  /**
+   * End the frame of the allocations, fencing the region read by its draws, and moving on to the next region.
+   */
+  void endFrame()
+  {
+    if (!isRegionAcquired)
+    {
+      return;
+    }
+    if (isPersistent)
+    {
+      regionFences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      currentRegion = (currentRegion + 1) % STREAM_BUFFER_REGIONS;
+    }
+    regionOffset = 0;
+    isRegionAcquired = false;
+  }
+
+  /**
+   * Returns the singleton instance of the stream buffer manager.
+   * 
+   * @return The stream buffer manager singleton instance.
+   */
+  static StreamBufferManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the stream buffer manager singleton instance static variable.
+StreamBufferManager StreamBufferManager::instance;
+
+#endif
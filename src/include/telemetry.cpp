@@ -0,0 +1,386 @@
+#ifndef INCLUDE_TELEMETRY_CPP
+#define INCLUDE_TELEMETRY_CPP
+
+#include <ctime>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "constants.cpp"
+#include "command_line.cpp"
+#include "mpsc_queue.cpp"
+#include "rolling_stats.cpp"
+#include "profiler.cpp"
+#include "allocation_tracker.cpp"
+#include "gpu_timer.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "models.cpp"
+#include "light.cpp"
+
+/**
+ * Structure for defining what the telemetry samples of a frame, handed over to the thread writing the log.
+ */
+struct TelemetryFrame
+{
+  // The time the frame ended (in nanoseconds of the steady clock).
+  int64_t endTime;
+  // The time from the start of the frame before to the start of this one, and from the start of the frame to the end of its
+  //   work (in milliseconds).
+  float_t frameTime;
+  float_t processTime;
+  // The CPU times of the light and the model renders (in milliseconds).
+  float_t lightRenderTime;
+  float_t modelRenderTime;
+  // The GPU times of the latest finished measurements of the scene, the light and the model renders (in milliseconds).
+  float_t sceneGpuTime;
+  float_t lightGpuTime;
+  float_t modelGpuTime;
+  // The number of draw calls of the last frame rendered.
+  uint32_t drawsCount;
+  // The numbers of registered models and lights.
+  uint32_t modelsCount;
+  uint32_t lightsCount;
+  // The allocations made in the frame (always 0 if the allocations are not tracked).
+  uint32_t allocationsCount;
+  // The size of the GPU memory tracked (in bytes).
+  uint64_t gpuMemorySize;
+};
+
+/**
+ * Structure for defining the aggregates of the frames of a second, written as a row of the log.
+ */
+struct TelemetrySecond
+{
+  // The time the first frame of the second ended (in nanoseconds of the steady clock).
+  int64_t startTime;
+  // The frame times of the second, sorted for the percentiles once the second is written (in milliseconds).
+  std::vector<double_t> frameTimes;
+  // The sums of the timings of the frames (in milliseconds), and of their draws and allocations.
+  double_t frameTimesSum;
+  double_t processTimesSum;
+  double_t lightRenderTimesSum;
+  double_t modelRenderTimesSum;
+  double_t sceneGpuTimesSum;
+  double_t lightGpuTimesSum;
+  double_t modelGpuTimesSum;
+  uint64_t drawsSum;
+  uint64_t allocationsSum;
+  // The counts of the last frame of the second.
+  uint32_t modelsCount;
+  uint32_t lightsCount;
+  uint64_t gpuMemorySize;
+};
+
+/**
+ * A manager class for logging the performance of a session, for deployments running long past what the debug text shows.
+ *   Enabled by the --telemetry option, the main thread samples each frame into a lock-free queue, and a thread of the manager
+ *   drains it, aggregates the frames of each second (the frame time percentiles, the CPU and GPU times of the renders, the
+ *   draws, the models and the lights, the GPU memory and the resident memory, and the allocations) and appends them as a row
+ *   of a CSV log. The log moves on to a new file once a file has a given number of rows, and only keeps the latest files.
+ */
+class TelemetryManager
+{
+private:
+  // Singleton instance of the telemetry manager.
+  static TelemetryManager instance;
+
+  // The CPU profiler the times of the renders are read from.
+  CpuProfiler &cpuProfiler;
+  // The GPU timer manager the GPU times of the renders are read from.
+  GpuTimerManager &gpuTimerManager;
+  // The GL stats manager the draws are read from.
+  GlStatsManager &glStatsManager;
+  // The GPU memory manager the tracked GPU memory is read from.
+  GpuMemoryManager &gpuMemoryManager;
+  // The allocation tracker the allocations of the frames are read from.
+  AllocationTracker &allocationTracker;
+
+  // Whether the session is logged.
+  bool isEnabled;
+  // The GPU times of the latest finished measurements, read on the thread the GL context is current on.
+  double_t sceneGpuTime;
+  double_t lightGpuTime;
+  double_t modelGpuTime;
+
+  // The frames sampled and not logged yet, pushed by the main thread and popped by the log thread.
+  MpscQueue<TelemetryFrame, TELEMETRY_QUEUE_CAPACITY> frames;
+  // The number of frames dropped since the queue was full, logged with the next second.
+  std::atomic<uint32_t> droppedFramesCount;
+  // The thread writing the log, started with the first frame sampled.
+  std::thread logThread;
+  // Whether the log thread has to stop, once it logged the frames left.
+  std::atomic<bool> isStopping;
+
+  // The frames of the second being aggregated, only used by the log thread.
+  TelemetrySecond second;
+  // The time the session started (in nanoseconds of the steady clock), which the rows are timed from.
+  int64_t sessionStartTime;
+  // The time of day the session started, which the files of the log are named with.
+  std::string sessionName;
+  // The file of the log being written, its index and the number of rows written to it.
+  std::ofstream logStream;
+  uint32_t logFileIndex;
+  uint32_t logRowsCount;
+
+  TelemetryManager()
+      : cpuProfiler(CpuProfiler::getInstance()),
+        gpuTimerManager(GpuTimerManager::getInstance()),
+        glStatsManager(GlStatsManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        allocationTracker(AllocationTracker::getInstance()),
+        isEnabled(false),
+        sceneGpuTime(0.0),
+        lightGpuTime(0.0),
+        modelGpuTime(0.0),
+        droppedFramesCount(0),
+        isStopping(false),
+        second({0, {}, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0, 0}),
+        sessionStartTime(0),
+        sessionName(),
+        logFileIndex(0),
+        logRowsCount(0)
+  {
+    // Read whether the session is logged from the command line.
+    const auto arguments = CommandLine::getArguments();
+    isEnabled = std::find(arguments.begin(), arguments.end(), "--telemetry") != arguments.end();
+  }
+
+  ~TelemetryManager()
+  {
+    // Log the frames still queued, and stop the log thread.
+    if (logThread.joinable())
+    {
+      isStopping = true;
+      logThread.join();
+    }
+  }
+
+  /**
+   * Get the memory of the process resident in RAM.
+   * 
+   * @return The resident memory (in bytes, 0 if the platform does not tell).
+   */
+  static uint64_t getResidentMemorySize()
+  {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+      return counters.WorkingSetSize;
+    }
+#elif defined(__linux__)
+    // The second number of statm is the resident set, in pages.
+    std::ifstream statmStream("/proc/self/statm");
+    uint64_t totalPagesCount = 0, residentPagesCount = 0;
+    if (statmStream >> totalPagesCount >> residentPagesCount)
+    {
+      return residentPagesCount * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+  }
+
+  /**
+   * Open the next file of the log, deleting the oldest file kept once there are more files than kept.
+   */
+  void openLogFile()
+  {
+    logStream.close();
+    std::error_code errorCode;
+    std::filesystem::create_directories(TELEMETRY_DIRECTORY, errorCode);
+    const auto getLogPath = [this](const uint32_t &fileIndex) {
+      return std::string(TELEMETRY_DIRECTORY) + "telemetry_" + sessionName + "_" + std::to_string(fileIndex) + ".csv";
+    };
+    if (logFileIndex >= TELEMETRY_FILES_KEPT)
+    {
+      std::filesystem::remove(getLogPath(logFileIndex - TELEMETRY_FILES_KEPT), errorCode);
+    }
+
+    logStream.open(getLogPath(logFileIndex), std::ios::out | std::ios::trunc);
+    logStream.setf(std::ios::fixed);
+    logStream.precision(3);
+    logStream << "Time,Frames,Dropped Frames,FPS,Frame Mean (ms),Frame p50 (ms),Frame p95 (ms),Frame p99 (ms),Frame Max (ms),Process Mean (ms),Light Render CPU (ms),Model Render CPU (ms),Scene GPU (ms),Light Render GPU (ms),Model Render GPU (ms),Draws,Models,Lights,GPU Memory (MB),Resident Memory (MB),Allocations\n";
+    logFileIndex++;
+    logRowsCount = 0;
+  }
+
+  /**
+   * Write the aggregates of the frames of the second as a row of the log, and start the next second.
+   */
+  void writeSecond()
+  {
+    const auto framesCount = second.frameTimes.size();
+    if (framesCount == 0)
+    {
+      return;
+    }
+    if (!logStream.is_open() || logRowsCount >= TELEMETRY_ROWS_PER_FILE)
+    {
+      openLogFile();
+    }
+
+    std::sort(second.frameTimes.begin(), second.frameTimes.end());
+    const auto frameTimes = getSortedValuesSummary(second.frameTimes.data(), framesCount, second.frameTimesSum);
+    logStream << (second.startTime - sessionStartTime) / 1000000000.0 << "," << framesCount << "," << droppedFramesCount.exchange(0) << "," << framesCount * 1000.0 / second.frameTimesSum
+              << "," << frameTimes.mean << "," << frameTimes.p50 << "," << frameTimes.p95 << "," << frameTimes.p99 << "," << frameTimes.max
+              << "," << second.processTimesSum / framesCount << "," << second.lightRenderTimesSum / framesCount << "," << second.modelRenderTimesSum / framesCount
+              << "," << second.sceneGpuTimesSum / framesCount << "," << second.lightGpuTimesSum / framesCount << "," << second.modelGpuTimesSum / framesCount
+              << "," << static_cast<double_t>(second.drawsSum) / framesCount << "," << second.modelsCount << "," << second.lightsCount
+              << "," << second.gpuMemorySize / (1024.0 * 1024.0) << "," << getResidentMemorySize() / (1024.0 * 1024.0) << "," << second.allocationsSum << "\n";
+    // Flush each row, so that the log is complete up to the last second if the session ends abruptly.
+    logStream.flush();
+    logRowsCount++;
+
+    second.frameTimes.clear();
+    second.frameTimesSum = second.processTimesSum = second.lightRenderTimesSum = second.modelRenderTimesSum = 0.0;
+    second.sceneGpuTimesSum = second.lightGpuTimesSum = second.modelGpuTimesSum = 0.0;
+    second.drawsSum = second.allocationsSum = 0;
+  }
+
+  /**
+   * Aggregate the frames queued into their seconds, writing each second once a frame of the next one is reached.
+   */
+  void aggregateFrames()
+  {
+    TelemetryFrame frame;
+    while (frames.tryPop(frame))
+    {
+      if (sessionStartTime == 0)
+      {
+        sessionStartTime = frame.endTime;
+      }
+      if (second.frameTimes.empty() || frame.endTime - second.startTime >= 1000000000)
+      {
+        writeSecond();
+        second.startTime = frame.endTime;
+      }
+      second.frameTimes.push_back(frame.frameTime);
+      second.frameTimesSum += frame.frameTime;
+      second.processTimesSum += frame.processTime;
+      second.lightRenderTimesSum += frame.lightRenderTime;
+      second.modelRenderTimesSum += frame.modelRenderTime;
+      second.sceneGpuTimesSum += frame.sceneGpuTime;
+      second.lightGpuTimesSum += frame.lightGpuTime;
+      second.modelGpuTimesSum += frame.modelGpuTime;
+      second.drawsSum += frame.drawsCount;
+      second.allocationsSum += frame.allocationsCount;
+      second.modelsCount = frame.modelsCount;
+      second.lightsCount = frame.lightsCount;
+      second.gpuMemorySize = frame.gpuMemorySize;
+    }
+  }
+
+  /**
+   * Run the log thread, draining the queue every so often until it has to stop.
+   */
+  void runLogThread()
+  {
+    second.frameTimes.reserve(TELEMETRY_QUEUE_CAPACITY);
+    while (!isStopping)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double_t>(TELEMETRY_DRAIN_INTERVAL));
+      aggregateFrames();
+    }
+    // Log the frames left, including the second they end in.
+    aggregateFrames();
+    writeSecond();
+  }
+
+public:
+  // Preventing copying the telemetry manager, making sure only one instance can exist.
+  TelemetryManager(const TelemetryManager &) = delete;
+
+  /**
+   * Get whether the session is logged.
+   * 
+   * @return Whether the telemetry is enabled.
+   */
+  bool isTelemetryEnabled() const
+  {
+    return isEnabled;
+  }
+
+  /**
+   * Read the GPU times of the latest finished measurements. Has to be done on the thread the GL context is current on, once
+   *   per frame after the scene is rendered.
+   */
+  void sampleGpuTimes()
+  {
+    sceneGpuTime = gpuTimerManager.getTimeMs("Scene Render");
+    lightGpuTime = gpuTimerManager.getTimeMs("Light Render");
+    modelGpuTime = gpuTimerManager.getTimeMs("Model Render");
+  }
+
+  /**
+   * Sample a frame into the log, once it is aggregated by the profiler. Only pushes the frame to the queue of the log thread
+   *   (dropping it if the queue is full), starting the thread with the first frame.
+   * 
+   * @param frameTime    The time from the start of the frame before to the start of the frame (in milliseconds).
+   * @param processTime  The time from the start of the frame to the end of its work (in milliseconds).
+   */
+  void recordFrame(const double_t &frameTime, const double_t &processTime)
+  {
+    if (!isEnabled)
+    {
+      return;
+    }
+    if (!logThread.joinable())
+    {
+      const auto currentTime = std::time(nullptr);
+      char timeText[32];
+      std::strftime(timeText, sizeof(timeText), "%Y%m%d_%H%M%S", std::localtime(&currentTime));
+      sessionName = timeText;
+      logThread = std::thread(&TelemetryManager::runLogThread, this);
+    }
+
+    auto &modelManager = ModelManager::getInstance();
+    auto &lightManager = LightManager::getInstance();
+    const auto totalCounts = glStatsManager.getLastFrameTotalCounts();
+    auto frame = TelemetryFrame({CpuProfiler::getTimestamp(), static_cast<float_t>(frameTime), static_cast<float_t>(processTime),
+                                 static_cast<float_t>(cpuProfiler.getChildZoneStats(0, "Light Render").getTotalTimeMs()), static_cast<float_t>(cpuProfiler.getChildZoneStats(0, "Model Render").getTotalTimeMs()),
+                                 static_cast<float_t>(sceneGpuTime), static_cast<float_t>(lightGpuTime), static_cast<float_t>(modelGpuTime),
+                                 static_cast<uint32_t>(totalCounts.draws), static_cast<uint32_t>(modelManager.getAllModels().size()), static_cast<uint32_t>(lightManager.getAllLights().size()),
+                                 static_cast<uint32_t>(allocationTracker.getLastFrameAllocationsCount()), gpuMemoryManager.getTotalSize()});
+    if (!frames.tryPush(frame))
+    {
+      droppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the telemetry manager.
+   * 
+   * @return The telemetry manager singleton instance.
+   */
+  static TelemetryManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the telemetry manager singleton instance static variable.
+TelemetryManager TelemetryManager::instance;
+
+#endif
@@ -3,12 +3,23 @@
 
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <limits>
+#include <array>
+#include <atomic>
+#include <string_view>
+#include <functional>
+#include <cstddef>
+#include <memory_resource>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -16,6 +27,12 @@
 #include "common.cpp"
 #include "window.cpp"
 #include "shader.cpp"
+#include "registry.cpp"
+#include "text_arena.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+#include "stream_buffer.cpp"
+#include "asset_archive.cpp"
 
 /**
  * Class containing information about a text character.
@@ -27,33 +44,54 @@ class TextCharacter
   friend class TextCharacterSet;
 
 private:
-  const unsigned char character;
-  const uint32_t characterSetLayerId;
+  const uint32_t codePoint;
   const glm::vec2 size;
   const glm::vec2 bearing;
   const float_t advance;
-  const glm::vec2 maxUv;
+  // The corners of the glyph bitmap in the atlas (in texels, so that they stay valid when the atlas grows).
+  const glm::ivec2 atlasMin;
+  const glm::ivec2 atlasMax;
 
 public:
-  TextCharacter(const unsigned char &character,
+  TextCharacter(const uint32_t &codePoint,
                 const glm::vec2 &size,
                 const glm::vec2 &bearing,
                 const float_t &advance,
-                const glm::vec2 &maxUv,
-                const uint32_t &characterSetLayerId)
-      : character(character),
-        characterSetLayerId(characterSetLayerId),
+                const glm::ivec2 &atlasMin,
+                const glm::ivec2 &atlasMax)
+      : codePoint(codePoint),
         size(size),
         bearing(bearing),
         advance(advance),
-        maxUv(maxUv) {}
+        atlasMin(atlasMin),
+        atlasMax(atlasMax) {}
 
-  const unsigned char &getCharacter() const
+  const uint32_t &getCodePoint() const
   {
-    return character;
+    return codePoint;
   }
 };
 
+/**
+ * Structure for defining a segment of the skyline of the glyph atlas, the top edge of the glyphs packed below it.
+ */
+struct TextAtlasSkylineSegment
+{
+  // The left edge of the segment (in texels).
+  int32_t x;
+  // The height of the skyline along the segment (in texels).
+  int32_t y;
+  // The width of the segment (in texels).
+  int32_t width;
+};
+
+/**
+ * Class for a font rasterized into a single 2D glyph atlas, with the glyphs packed by a skyline packer.
+ * The printable ASCII glyphs are rasterized when the font is loaded, and any other glyph the first time it is laid out, packed
+ *   into the atlas without touching the glyphs already in it. The atlas grows taller when it is full, keeping its contents.
+ * Glyphs can be laid out on any thread, so the atlas is rasterized into a copy in memory, and uploaded by the thread rendering
+ *   the text.
+ */
 class TextCharacterSet
 {
   // Let the text manager access private variables.
@@ -63,162 +101,586 @@ private:
   const std::string fontId;
   const std::string fontFilePath;
 
-  const GLuint characterTextureArrayId;
+  // The FreeType library and font face, kept open for rasterizing the glyphs on demand.
+  FT_Library freeType;
+  FT_Face fontFace;
+  // The font file the font face reads from, which has to stay alive as long as the face.
+  std::unique_ptr<AssetFile> fontFile;
+
+  const GLuint atlasTextureId;
+  // The size of the atlas (in texels), of which the width is fixed and the height grows.
+  const int32_t atlasWidth;
+  int32_t atlasHeight;
+  // The texels of the atlas, in rows from the top.
+  std::vector<uint8_t> atlasPixels;
+  // The skyline of the packed glyphs, in segments from left to right.
+  std::vector<TextAtlasSkylineSegment> skyline;
+  // The rows of the atlas changed since the last upload (empty if the minimum is past the maximum).
+  int32_t dirtyMinRow;
+  int32_t dirtyMaxRow;
+  // Whether the atlas grew since the last upload, which needs its storage reallocated.
+  bool isAtlasResized;
+
+  // The buffers of the distance field generation (their storage is reused between the glyphs).
+  std::vector<float_t> distancesToInside;
+  std::vector<float_t> distancesToOutside;
+  std::vector<float_t> distanceTransformValues;
+  std::vector<int32_t> distanceTransformVertices;
+  std::vector<float_t> distanceTransformBounds;
+  std::vector<uint8_t> distanceFieldPixels;
+
+  std::unordered_map<uint32_t, const TextCharacter> characterMap;
+  // The glyphs of the first code points, pointing into the character map (whose elements never move), so that the text laid
+  //   out nearly always finds its glyphs without the lock. Null until the glyph is rasterized, or the question mark if the font
+  //   cannot rasterize it.
+  std::array<std::atomic<const TextCharacter *>, TEXT_GLYPH_TABLE_SIZE> glyphTable;
+  // The mutex guarding the glyphs and the atlas, since the text is laid out on several threads.
+  mutable std::mutex characterMutex;
+
+  GLuint createAtlasTexture()
+  {
+    GLuint newTextureId;
+    glGenTextures(1, &newTextureId);
+
+    GlCalls::bindTexture(GL_TEXTURE_2D, newTextureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
 
-  std::map<const unsigned char, const TextCharacter> characterMap;
+    return newTextureId;
+  }
 
-  GLuint createTextureArray()
+  /**
+   * Find where the skyline has room for a glyph, at the lowest height and then the leftmost position.
+   * 
+   * @param width         The width of the glyph (in texels).
+   * @param height        The height of the glyph (in texels).
+   * @param segmentIndex  Set to the index of the segment the glyph starts at.
+   * 
+   * @return The position of the bottom-left corner of the glyph, or -1 if it does not fit within the largest atlas.
+   */
+  glm::ivec2 findSkylinePosition(const int32_t &width, const int32_t &height, size_t &segmentIndex) const
   {
-    GLuint newTextureArrayId;
-    glGenTextures(1, &newTextureArrayId);
-    return newTextureArrayId;
+    auto bestPosition = glm::ivec2(-1);
+    for (size_t i = 0; i < skyline.size(); i++)
+    {
+      const auto x = skyline[i].x;
+      if (x + width > atlasWidth)
+      {
+        break;
+      }
+
+      // The glyph rests on the highest of the segments it spans.
+      auto y = 0;
+      auto widthLeft = width;
+      for (auto j = i; widthLeft > 0; j++)
+      {
+        y = std::max(y, skyline[j].y);
+        widthLeft -= skyline[j].width;
+      }
+      if (y + height <= TEXT_ATLAS_MAX_HEIGHT && (bestPosition.y < 0 || y < bestPosition.y))
+      {
+        bestPosition = glm::ivec2(x, y);
+        segmentIndex = i;
+      }
+    }
+    return bestPosition;
   }
 
-  void loadFont(const std::string &fontId, const std::string &fontFilePath)
+  /**
+   * Raise the skyline over a glyph packed at the given position, merging the segments left at the same height.
+   * 
+   * @param segmentIndex  The index of the segment the glyph starts at.
+   * @param position      The position of the bottom-left corner of the glyph.
+   * @param width         The width of the glyph (in texels).
+   * @param height        The height of the glyph (in texels).
+   */
+  void raiseSkyline(const size_t &segmentIndex, const glm::ivec2 &position, const int32_t &width, const int32_t &height)
   {
-    FT_Library freeType;
-    if (FT_Init_FreeType(&freeType))
+    skyline.insert(skyline.begin() + segmentIndex, {position.x, position.y + height, width});
+
+    // Cut the segments covered by the glyph away from the left.
+    const auto right = position.x + width;
+    for (auto i = segmentIndex + 1; i < skyline.size();)
     {
-      std::cout << fontId << std::endl
-                << "Failed at text character set 1" << std::endl;
-      exit(1);
+      if (skyline[i].x >= right)
+      {
+        break;
+      }
+      const auto overlap = std::min(right - skyline[i].x, skyline[i].width);
+      skyline[i].x += overlap;
+      skyline[i].width -= overlap;
+      if (skyline[i].width == 0)
+      {
+        skyline.erase(skyline.begin() + i);
+      }
+      else
+      {
+        i++;
+      }
     }
 
-    FT_Face fontFace;
-    if (FT_New_Face(freeType, fontFilePath.c_str(), 0, &fontFace))
+    // Merge the neighbouring segments at the same height.
+    for (size_t i = 1; i < skyline.size();)
     {
-      std::cout << fontId << std::endl
-                << "Failed at text character set 2" << std::endl;
-      exit(1);
+      if (skyline[i - 1].y == skyline[i].y)
+      {
+        skyline[i - 1].width += skyline[i].width;
+        skyline.erase(skyline.begin() + i);
+      }
+      else
+      {
+        i++;
+      }
     }
+  }
 
-    FT_Set_Pixel_Sizes(fontFace, 0, TEXT_HEIGHT);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  /**
+   * Compute the exact squared distances to the nearest seed along a row or column, from the squared distances to the nearest
+   *   seeds along the other axis (the lower envelope of parabolas of Felzenszwalb and Huttenlocher).
+   * 
+   * @param distances  The squared distances along the other axis, replaced with the squared distances in 2D.
+   * @param stride     The offset between consecutive elements of the row or column.
+   * @param count      The number of elements of the row or column.
+   * @param values     The copy of the input values (its storage is reused).
+   * @param vertices   The positions of the parabolas of the lower envelope (its storage is reused).
+   * @param bounds     The boundaries between the parabolas of the lower envelope (its storage is reused).
+   */
+  static void transformDistances(float_t *distances, const int32_t &stride, const int32_t &count, std::vector<float_t> &values, std::vector<int32_t> &vertices, std::vector<float_t> &bounds)
+  {
+    values.resize(count);
+    vertices.resize(count);
+    bounds.resize(count + 1);
+    for (auto i = 0; i < count; i++)
+    {
+      values[i] = distances[i * stride];
+    }
 
-    glBindTexture(GL_TEXTURE_2D_ARRAY, characterTextureArrayId);
+    // Find the parabolas forming the lower envelope, and where each of them is the lowest.
+    auto envelopeIndex = 0;
+    vertices[0] = 0;
+    bounds[0] = -std::numeric_limits<float_t>::infinity();
+    bounds[1] = std::numeric_limits<float_t>::infinity();
+    for (auto q = 1; q < count; q++)
+    {
+      auto intersection = 0.0f;
+      while (true)
+      {
+        const auto v = vertices[envelopeIndex];
+        intersection = ((values[q] + (q * q)) - (values[v] + (v * v))) / (2.0f * (q - v));
+        if (intersection > bounds[envelopeIndex])
+        {
+          break;
+        }
+        // The parabola of the vertex is lower nowhere, so drop it (the first bound is -infinity, so this stops there).
+        envelopeIndex--;
+      }
+      envelopeIndex++;
+      vertices[envelopeIndex] = q;
+      bounds[envelopeIndex] = intersection;
+      bounds[envelopeIndex + 1] = std::numeric_limits<float_t>::infinity();
+    }
 
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Read the squared distances off the lower envelope.
+    envelopeIndex = 0;
+    for (auto q = 0; q < count; q++)
+    {
+      while (bounds[envelopeIndex + 1] < q)
+      {
+        envelopeIndex++;
+      }
+      const auto v = vertices[envelopeIndex];
+      distances[q * stride] = ((q - v) * (q - v)) + values[v];
+    }
+  }
+
+  /**
+   * Compute the squared distances from each texel to the nearest seed texel, in two passes of exact 1D distance transforms.
+   * 
+   * @param distances  Set to 0 for the seed texels and further than any texel for the others, replaced with the squared distances.
+   * @param width      The width of the texels.
+   * @param height     The height of the texels.
+   */
+  void transformDistances2d(std::vector<float_t> &distances, const int32_t &width, const int32_t &height)
+  {
+    for (auto x = 0; x < width; x++)
+    {
+      transformDistances(distances.data() + x, width, height, distanceTransformValues, distanceTransformVertices, distanceTransformBounds);
+    }
+    for (auto y = 0; y < height; y++)
+    {
+      transformDistances(distances.data() + (y * width), 1, width, distanceTransformValues, distanceTransformVertices, distanceTransformBounds);
+    }
+  }
 
-    float_t maxWidth = 0;
-    float_t maxRows = 0;
-    for (unsigned char character = 0; character < std::numeric_limits<unsigned char>::max(); character++)
+  /**
+   * Create the signed distance field of a rasterized glyph, encoded so that the edge is at 0.5, the inside above it, and the
+   *   spread is mapped to the rest of the range. The character mutex has to be held.
+   * 
+   * @param bitmap       The rasterized glyph, with its coverage taken as inside at half of it.
+   * @param fieldTexels  Set to the texels of the distance field, padded by the spread on every side.
+   */
+  void createDistanceField(const FT_Bitmap &bitmap, std::vector<uint8_t> &fieldTexels)
+  {
+    const auto width = static_cast<int32_t>(bitmap.width) + (2 * TEXT_SDF_SPREAD);
+    const auto height = static_cast<int32_t>(bitmap.rows) + (2 * TEXT_SDF_SPREAD);
+
+    // Seed the distances to the inside with the inside texels, and the distances to the outside with the outside texels. The
+    //   texels that are not seeds start further away than any texel (instead of at infinity, which the transform cannot take).
+    const auto infinity = static_cast<float_t>((width * width) + (height * height));
+    distancesToInside.assign(width * height, infinity);
+    distancesToOutside.assign(width * height, 0.0f);
+    for (auto y = 0; y < static_cast<int32_t>(bitmap.rows); y++)
     {
-      if (FT_Load_Char(fontFace, character, FT_LOAD_RENDER))
+      for (auto x = 0; x < static_cast<int32_t>(bitmap.width); x++)
       {
-        std::cout << fontId << std::endl
-                  << "Failed at text character set 3" << std::endl;
-        continue;
+        if (bitmap.buffer[(y * bitmap.pitch) + x] >= 128)
+        {
+          const auto index = ((y + TEXT_SDF_SPREAD) * width) + x + TEXT_SDF_SPREAD;
+          distancesToInside[index] = 0.0f;
+          distancesToOutside[index] = infinity;
+        }
       }
+    }
+    transformDistances2d(distancesToInside, width, height);
+    transformDistances2d(distancesToOutside, width, height);
 
-      maxWidth = glm::max(maxWidth, static_cast<float_t>(fontFace->glyph->bitmap.width));
-      maxRows = glm::max(maxRows, static_cast<float_t>(fontFace->glyph->bitmap.rows));
+    // The edge lies halfway between the inside and outside texels next to each other.
+    fieldTexels.resize(width * height);
+    for (auto i = 0; i < width * height; i++)
+    {
+      const auto signedDistance = distancesToOutside[i] > 0.0f ? std::sqrt(distancesToOutside[i]) - 0.5f : 0.5f - std::sqrt(distancesToInside[i]);
+      const auto encodedDistance = 0.5f + (signedDistance / (2.0f * TEXT_SDF_SPREAD));
+      fieldTexels[i] = static_cast<uint8_t>(glm::round(glm::clamp(encodedDistance, 0.0f, 1.0f) * 255.0f));
     }
+  }
 
-    std::vector<uint8_t> clearData(maxWidth * maxRows, 0);
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RED, maxWidth, maxRows, std::numeric_limits<unsigned char>::max(), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+  /**
+   * Rasterize a glyph of the font, and pack it into the atlas. The character mutex has to be held.
+   * 
+   * @param codePoint  The Unicode code point of the glyph.
+   * 
+   * @return The rasterized glyph, or null if the font cannot rasterize it or there is no room for it left.
+   */
+  const TextCharacter *rasterizeCharacter(const uint32_t &codePoint)
+  {
+    if (FT_Load_Char(fontFace, codePoint, FT_LOAD_RENDER))
+    {
+      std::cout << fontId << std::endl
+                << "Failed at text character set 3" << std::endl;
+      return nullptr;
+    }
 
-    for (unsigned char character = 0; character < std::numeric_limits<unsigned char>::max(); character++)
+    const auto &bitmap = fontFace->glyph->bitmap;
+    auto width = static_cast<int32_t>(bitmap.width);
+    auto height = static_cast<int32_t>(bitmap.rows);
+    auto glyphPixels = bitmap.buffer;
+    auto glyphPitch = static_cast<int32_t>(bitmap.pitch);
+    // The glyph metrics are in the pixels of the rasterized font, scaled to the text height if the glyphs are distance fields.
+    auto bearing = glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap_left), static_cast<float_t>(fontFace->glyph->bitmap_top));
+    if (IS_TEXT_SDF_ENABLED && width > 0 && height > 0)
+    {
+      // The distance field reaches past the edges of the bitmap by the spread.
+      createDistanceField(bitmap, distanceFieldPixels);
+      width += 2 * TEXT_SDF_SPREAD;
+      height += 2 * TEXT_SDF_SPREAD;
+      glyphPixels = distanceFieldPixels.data();
+      glyphPitch = width;
+      bearing += glm::vec2(-TEXT_SDF_SPREAD, TEXT_SDF_SPREAD);
+    }
+    auto atlasPosition = glm::ivec2(0);
+    if (width > 0 && height > 0)
     {
-      if (FT_Load_Char(fontFace, character, FT_LOAD_RENDER))
+      // Pack the glyph with a gap around it, so that the linear filtering never picks up its neighbours.
+      size_t segmentIndex = 0;
+      atlasPosition = findSkylinePosition(width + TEXT_ATLAS_GLYPH_PADDING, height + TEXT_ATLAS_GLYPH_PADDING, segmentIndex);
+      if (atlasPosition.y < 0)
       {
         std::cout << fontId << std::endl
                   << "Failed at text character set 4" << std::endl;
-        continue;
+        return nullptr;
       }
+      raiseSkyline(segmentIndex, atlasPosition, width + TEXT_ATLAS_GLYPH_PADDING, height + TEXT_ATLAS_GLYPH_PADDING);
 
-      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<uint32_t>(character), maxWidth, maxRows, 1, GL_RED, GL_UNSIGNED_BYTE, &clearData[0]);
-      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<uint32_t>(character), fontFace->glyph->bitmap.width, fontFace->glyph->bitmap.rows, 1, GL_RED, GL_UNSIGNED_BYTE, fontFace->glyph->bitmap.buffer);
+      // Grow the atlas until the glyph fits, keeping the rows already packed.
+      while (atlasPosition.y + height > atlasHeight)
+      {
+        atlasHeight *= 2;
+        atlasPixels.resize(atlasWidth * atlasHeight, 0);
+        isAtlasResized = true;
+      }
 
-      const TextCharacter textCharacter(
-          character,
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap.width), static_cast<float_t>(fontFace->glyph->bitmap.rows)),
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap_left), static_cast<float_t>(fontFace->glyph->bitmap_top)),
-          static_cast<float_t>(fontFace->glyph->advance.x) / 64.0f,
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap.width) / maxWidth, static_cast<float_t>(fontFace->glyph->bitmap.rows) / maxRows),
-          (uint32_t)character);
-      characterMap.insert(std::pair<const unsigned char, const TextCharacter>(character, textCharacter));
+      // Copy the glyph bitmap into the atlas, and mark its rows for the upload.
+      for (auto row = 0; row < height; row++)
+      {
+        std::copy_n(glyphPixels + (row * glyphPitch), width, atlasPixels.begin() + ((atlasPosition.y + row) * atlasWidth) + atlasPosition.x);
+      }
+      dirtyMinRow = std::min(dirtyMinRow, atlasPosition.y);
+      dirtyMaxRow = std::max(dirtyMaxRow, atlasPosition.y + height - 1);
     }
 
-    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    const auto metricsScale = IS_TEXT_SDF_ENABLED ? static_cast<float_t>(TEXT_HEIGHT) / TEXT_SDF_FONT_SIZE : 1.0f;
+    const TextCharacter textCharacter(
+        codePoint,
+        glm::vec2(static_cast<float_t>(width), static_cast<float_t>(height)) * metricsScale,
+        bearing * metricsScale,
+        (static_cast<float_t>(fontFace->glyph->advance.x) / 64.0f) * metricsScale,
+        atlasPosition,
+        atlasPosition + glm::ivec2(width, height));
+    const auto newCharacter = &characterMap.emplace(codePoint, textCharacter).first->second;
+    if (codePoint < TEXT_GLYPH_TABLE_SIZE)
+    {
+      glyphTable[codePoint].store(newCharacter, std::memory_order_release);
+    }
+    return newCharacter;
+  }
 
-    FT_Done_Face(fontFace);
-    FT_Done_FreeType(freeType);
+  void loadFont(const std::string &fontId, const std::string &fontFilePath)
+  {
+    if (FT_Init_FreeType(&freeType))
+    {
+      std::cout << fontId << std::endl
+                << "Failed at text character set 1" << std::endl;
+      exit(1);
+    }
+
+    // The font is read from memory, since it can be in the asset archive.
+    fontFile = std::make_unique<AssetFile>(fontFilePath);
+    if (!fontFile->isMapped() || FT_New_Memory_Face(freeType, fontFile->getData(), fontFile->getSize(), 0, &fontFace))
+    {
+      std::cout << fontId << std::endl
+                << "Failed at text character set 2" << std::endl;
+      exit(1);
+    }
+
+    // Distance fields are generated from a fixed size, since they stay crisp at any scale.
+    FT_Set_Pixel_Sizes(fontFace, 0, IS_TEXT_SDF_ENABLED ? TEXT_SDF_FONT_SIZE : TEXT_HEIGHT);
+
+    // Rasterize the printable ASCII glyphs up front, since nearly all the text uses only them.
+    const std::lock_guard<std::mutex> lock(characterMutex);
+    for (uint32_t codePoint = ' '; codePoint <= '~'; codePoint++)
+    {
+      rasterizeCharacter(codePoint);
+    }
   }
 
   TextCharacterSet(const std::string &fontId, const std::string &fontFilePath)
       : fontId(fontId),
         fontFilePath(fontFilePath),
-        characterTextureArrayId(createTextureArray())
+        freeType(nullptr),
+        fontFace(nullptr),
+        fontFile(nullptr),
+        atlasTextureId(createAtlasTexture()),
+        atlasWidth(TEXT_ATLAS_WIDTH),
+        atlasHeight(TEXT_ATLAS_INITIAL_HEIGHT),
+        atlasPixels(TEXT_ATLAS_WIDTH * TEXT_ATLAS_INITIAL_HEIGHT, 0),
+        skyline({{0, 0, TEXT_ATLAS_WIDTH}}),
+        dirtyMinRow(std::numeric_limits<int32_t>::max()),
+        dirtyMaxRow(-1),
+        isAtlasResized(true),
+        distancesToInside({}),
+        distancesToOutside({}),
+        distanceTransformValues({}),
+        distanceTransformVertices({}),
+        distanceTransformBounds({}),
+        distanceFieldPixels({})
   {
+    STARTUP_PHASE("Font", fontId);
+    for (auto &glyph : glyphTable)
+    {
+      glyph.store(nullptr, std::memory_order_relaxed);
+    }
     loadFont(fontId, fontFilePath);
   }
 
 public:
+  ~TextCharacterSet()
+  {
+    FT_Done_Face(fontFace);
+    FT_Done_FreeType(freeType);
+    GlCalls::deleteTextures(1, &atlasTextureId);
+    GpuMemoryManager::getInstance().recordRelease(GpuResourceType::TEXTURE, atlasTextureId);
+  }
+
   const std::string &getFontId() const
   {
     return fontId;
   }
 
-  const TextCharacter &getCharacter(const unsigned char &character) const
+  /**
+   * Get the glyph of a code point, rasterizing it into the atlas the first time. The glyphs the font does not have fall back to
+   *   the question mark.
+   * 
+   * @param codePoint  The Unicode code point of the glyph.
+   * 
+   * @return The glyph.
+   */
+  const TextCharacter &getCharacter(const uint32_t &codePoint)
   {
-    return characterMap.at(character);
+    // The glyphs in the flat table never change once set, so they are read without the lock.
+    if (codePoint < TEXT_GLYPH_TABLE_SIZE)
+    {
+      const auto tableCharacter = glyphTable[codePoint].load(std::memory_order_acquire);
+      if (tableCharacter != nullptr)
+      {
+        return *tableCharacter;
+      }
+    }
+
+    const std::lock_guard<std::mutex> lock(characterMutex);
+    const auto existingCharacter = characterMap.find(codePoint);
+    if (existingCharacter != characterMap.end())
+    {
+      return existingCharacter->second;
+    }
+
+    const auto newCharacter = rasterizeCharacter(codePoint);
+    if (newCharacter != nullptr)
+    {
+      return *newCharacter;
+    }
+    // Keep the fallback in the flat table, so that the font is not asked again for a glyph it does not have.
+    const auto &fallbackCharacter = characterMap.at('?');
+    if (codePoint < TEXT_GLYPH_TABLE_SIZE)
+    {
+      glyphTable[codePoint].store(&fallbackCharacter, std::memory_order_release);
+    }
+    return fallbackCharacter;
   }
+
+  /**
+   * Upload the rows of the atlas changed since the last upload, reallocating the texture if the atlas grew. Done by the thread
+   *   rendering the text.
+   */
+  void uploadAtlas()
+  {
+    const std::lock_guard<std::mutex> lock(characterMutex);
+    if (!isAtlasResized && dirtyMinRow > dirtyMaxRow)
+    {
+      return;
+    }
+
+    // The texel rows of the atlas are tightly packed.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GlCalls::bindTexture(GL_TEXTURE_2D, atlasTextureId);
+    if (isAtlasResized)
+    {
+      GlCalls::texImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, GL_RED, GL_UNSIGNED_BYTE, atlasPixels.data(), 1);
+      GpuMemoryManager::getInstance().recordAllocation(GpuResourceType::TEXTURE, atlasTextureId, GpuMemoryCategory::TEXT, "Glyph Atlas", GpuMemoryManager::getTextureSize(atlasWidth, atlasHeight, 1, 1, false));
+    }
+    else
+    {
+      GlCalls::texSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyMinRow, atlasWidth, dirtyMaxRow - dirtyMinRow + 1, GL_RED, GL_UNSIGNED_BYTE, atlasPixels.data() + (dirtyMinRow * atlasWidth), 1);
+    }
+    GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    isAtlasResized = false;
+    dirtyMinRow = std::numeric_limits<int32_t>::max();
+    dirtyMaxRow = -1;
+  }
+
+  /**
+   * Get the size of the atlas, which the texel coordinates of the glyphs are normalized with.
+   * 
+   * @return The width and height of the atlas (in texels).
+   */
+  glm::vec2 getAtlasSize() const
+  {
+    const std::lock_guard<std::mutex> lock(characterMutex);
+    return glm::vec2(atlasWidth, atlasHeight);
+  }
+};
+
+/**
+ * Structure for defining a glyph drawn as one instance of the unit quad of the text, matching the attributes of the text shader.
+ */
+struct TextGlyphInstance
+{
+  // The position of the bottom-left corner of the glyph (in pixels).
+  glm::vec2 position;
+  // The size of the glyph (in pixels, as half floats).
+  uint16_t size[2];
+  // The corners of the glyph bitmap in the atlas (in texels, top-left and bottom-right).
+  uint16_t atlasMin[2];
+  uint16_t atlasMax[2];
 };
 
 /**
- * Class for containing the details of the text to render.
+ * Structure for defining a text line laid out by an earlier frame, with the glyph instances it was laid out into.
  */
-class TextDetails
+struct TextLayoutCacheEntry
 {
+  // The hash of the content, checked before the content itself.
+  size_t contentHash;
+  // The text content (its storage is reused by the text lines replacing it).
+  std::string content;
+  // The position and the normalized scale of the text.
+  glm::vec2 position;
+  float_t scale;
+  // The glyph instances laid out for the text.
+  std::vector<TextGlyphInstance> instances;
+};
+
+/**
+ * Class for containing the details of a text kept on screen across frames, along with its glyph instances, which are only laid
+ *   out again when its content changes.
+ */
+class RetainedTextDetails
+{
+  // Let the text manager access private variables.
+  friend class TextManager;
+
 private:
   // The text content to render.
-  const std::string content;
+  std::string content;
   // The position of the text, with the origin being the bottom-left of the screen.
   const glm::vec2 position;
   // The normalized scale of the text, where a value of 1.0f is 100% the default size of the text.
   const float_t scale;
+  // The glyph instances laid out for the content.
+  std::vector<TextGlyphInstance> instances;
 
 public:
-  TextDetails(
-      const std::string &content,
+  RetainedTextDetails(
       const glm::vec2 &position,
       const float_t &scale)
-      : content(content),
+      : content(""),
         position(position),
-        scale(scale) {}
+        scale(scale),
+        instances({}) {}
+};
 
-  /**
-   * Get the content of the text.
-   * 
-   * @return The text content.
-   */
-  const std::string &getContent() const
-  {
-    return content;
-  }
+/**
+ * A class for formatting a text line into the text arena of the frame, holding the lock of the text to render while doing so, and
+ *   adding the text line once it is destroyed.
+ */
+class TextLineWriter : public TextWriter
+{
+private:
+  // The lock of the text to render, held until the text line is added.
+  std::unique_lock<std::mutex> lock;
+  // The position of the text, with the origin being the bottom-left of the screen.
+  const glm::vec2 position;
+  // The normalized scale of the text.
+  const float_t scale;
 
-  /**
-   * Get the position of the text, with the origin being the bottom-left of the screen.
-   * 
-   * @return The text position.
-   */
-  const glm::vec2 &getPosition() const
-  {
-    return position;
-  }
+public:
+  TextLineWriter(
+      std::unique_lock<std::mutex> &&lock,
+      TextArena &arena,
+      const glm::vec2 &position,
+      const float_t &scale)
+      : TextWriter(arena),
+        lock(std::move(lock)),
+        position(position),
+        scale(scale) {}
 
-  /**
-   * Get the scale of the text, where a value of 1.0f is 100% the default size of the text.
-   * 
-   * @return The text scale.
-   */
-  const float_t &getScale() const
+  ~TextLineWriter()
   {
-    return scale;
+    arena.addTextLine(offset, position, scale);
   }
 };
 
@@ -231,73 +693,353 @@ private:
   // The shader manager responsible for creating shader programs.
   WindowManager &windowManager;
   ShaderManager &shaderManager;
+  // The GPU memory manager the retained glyph instance buffer is accounted in.
+  GpuMemoryManager &gpuMemoryManager;
+  // The stream buffer manager the glyph instances of each frame are written through.
+  StreamBufferManager &streamBufferManager;
 
   static TextManager instance;
-  const static TextCharacterSet characterSet;
 
   // The shader program details of the model.
   const std::shared_ptr<const ShaderDetails> textShader;
   const glm::mat4 textProjectionMatrix;
-  const GLuint textVertexBufferId;
-  const GLuint textUvBufferId;
-  const GLuint textUvLayerBufferId;
+  // The vertex array object describing the instance attributes of the glyph instances of the frame (the unit quad has no
+  //   buffer), pointed at the allocation of the frame in the stream buffer.
+  const GLuint textVertexArrayId;
+  // The allocation of the stream buffer the glyph instances of the frame are written to.
+  StreamAllocation instanceAllocation;
+  // The glyph instances of the frame, laid out here without being drawn if the stream buffer had no room left for them.
+  std::vector<TextGlyphInstance> discardedInstances;
+  // The text lines laid out by the last frames, by the hash of their content, position and scale (one text line for each hash),
+  //   since most of the text of a frame is the same as in the frame before.
+  std::array<TextLayoutCacheEntry, TEXT_LAYOUT_CACHE_SIZE> layoutCache;
+
+  // The texts kept on screen across frames, by their IDs.
+  Registry<RetainedTextDetails> retainedTexts;
+  // Whether a retained text was added, removed or changed since the retained glyph instances were uploaded.
+  bool isRetainedTextDirty;
+  // The buffer of the glyph instances of all the retained texts, only uploaded when they change.
+  const GLuint retainedInstanceBufferId;
+  // The vertex array object describing the instance attributes of the retained glyph instance buffer.
+  const GLuint retainedVertexArrayId;
+  // The number of glyph instances in the retained glyph instance buffer.
+  uint32_t retainedInstancesCount;
+  // The glyph instances of all the retained texts, gathered for the upload (its storage is reused).
+  std::vector<TextGlyphInstance> gatheredRetainedInstances;
+  // The mutex guarding the retained texts, which are changed by the scenes while another thread may be rendering them.
+  std::mutex retainedTextMutex;
+
+  // The text to render, formatted into the arena of the frame.
+  TextArena textArena;
+  // The mutex guarding the text to render, since the phases of a frame running on worker threads add text as well.
+  std::mutex textToRenderMutex;
 
-  std::vector<std::shared_ptr<const TextDetails>> textToRenderMap;
+  /**
+   * Describe the instance attributes of the glyph instances starting at the given offset of a glyph instance buffer, in the
+   *   bound vertex array object. The attributes are pointed at the allocation of the frame, since there is no base instance in
+   *   OpenGL 3.3.
+   * 
+   * @param bufferId      The ID of the glyph instance buffer.
+   * @param bufferOffset  The byte offset of the first glyph instance in the buffer.
+   */
+  static void describeInstanceAttributes(const GLuint &bufferId, const size_t &bufferOffset)
+  {
+    // Describe the position, size, and atlas rectangle attributes (matching the locations in the text shader).
+    VertexArray::enableAttribute(0, bufferId, 2, GL_FLOAT, 1, sizeof(TextGlyphInstance), bufferOffset + offsetof(TextGlyphInstance, position));
+    VertexArray::enableAttribute(1, bufferId, 2, GL_HALF_FLOAT, 1, sizeof(TextGlyphInstance), bufferOffset + offsetof(TextGlyphInstance, size));
+    VertexArray::enableAttribute(2, bufferId, 2, GL_UNSIGNED_SHORT, 1, sizeof(TextGlyphInstance), bufferOffset + offsetof(TextGlyphInstance, atlasMin));
+    VertexArray::enableAttribute(3, bufferId, 2, GL_UNSIGNED_SHORT, 1, sizeof(TextGlyphInstance), bufferOffset + offsetof(TextGlyphInstance, atlasMax));
+  }
 
-  void clearTextToRenderMap()
+  static GLuint createFrameVertexArray()
   {
-    textToRenderMap.clear();
+    // The instance attributes are described with each frame, once the glyph instances of the frame are allocated.
+    const auto vertexArrayId = VertexArray::createVertexArray();
+    GlCalls::bindVertexArray(0);
+    return vertexArrayId;
   }
 
-  GLuint createTextVertexBuffer()
+  GLuint createTextVertexArray(const GLuint &bufferId)
   {
-    GLuint newBufferId;
-    glGenBuffers(1, &newBufferId);
+    const auto vertexArrayId = VertexArray::createVertexArray();
 
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 2 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
+    describeInstanceAttributes(bufferId, 0);
 
+    GlCalls::bindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    return newBufferId;
+    return vertexArrayId;
+  }
+
+  /**
+   * Get the glyph instances the frame writes to, allocated in the stream buffer.
+   * 
+   * @return The glyph instances to write to, room for the maximum number of text characters.
+   */
+  TextGlyphInstance *beginInstances()
+  {
+    instanceAllocation = streamBufferManager.allocate(sizeof(TextGlyphInstance) * MAX_TEXT_CHARS, sizeof(TextGlyphInstance));
+    if (instanceAllocation.data == nullptr)
+    {
+      discardedInstances.resize(MAX_TEXT_CHARS);
+      return discardedInstances.data();
+    }
+    return reinterpret_cast<TextGlyphInstance *>(instanceAllocation.data);
+  }
+
+  /**
+   * Make the glyph instances written by the frame available to the draw, and point the instance attributes at them.
+   * 
+   * @param instancesCount  The number of glyph instances written.
+   * 
+   * @return Whether the glyph instances can be drawn, which they cannot if the stream buffer had no room left for them.
+   */
+  bool endInstances(const uint32_t &instancesCount)
+  {
+    if (instanceAllocation.data == nullptr)
+    {
+      return false;
+    }
+    streamBufferManager.commit(instanceAllocation, sizeof(TextGlyphInstance) * instancesCount);
+    describeInstanceAttributes(instanceAllocation.bufferId, instanceAllocation.offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
   }
 
-  GLuint createTextUvBuffer()
+  GLuint createRetainedInstanceBuffer()
   {
     GLuint newBufferId;
     glGenBuffers(1, &newBufferId);
+    return newBufferId;
+  }
 
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 2 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
+  /**
+   * Decode the code point starting at the given index of a UTF-8 string.
+   * 
+   * @param content  The characters of the string.
+   * @param length   The number of characters of the string.
+   * @param index    The index of the first byte of the code point, moved past its last byte.
+   * 
+   * @return The code point.
+   */
+  static uint32_t decodeUtf8(const char *content, const size_t &length, size_t &index)
+  {
+    const auto leadByte = static_cast<uint8_t>(content[index++]);
+    // Find the number of continuation bytes from the lead byte.
+    const auto continuationsCount = (leadByte & 0xE0) == 0xC0 ? 1 : (leadByte & 0xF0) == 0xE0 ? 2 : (leadByte & 0xF8) == 0xF0 ? 3 : 0;
+    if (continuationsCount == 0 || index + continuationsCount > length)
+    {
+      return leadByte;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uint32_t codePoint = leadByte & (0x3F >> continuationsCount);
+    for (auto i = 0; i < continuationsCount; i++)
+    {
+      const auto continuationByte = static_cast<uint8_t>(content[index + i]);
+      if ((continuationByte & 0xC0) != 0x80)
+      {
+        return leadByte;
+      }
+      codePoint = (codePoint << 6) | (continuationByte & 0x3F);
+    }
+    index += continuationsCount;
+    return codePoint;
+  }
 
-    return newBufferId;
+  /**
+   * Lay out the glyph instances of a text, from its position and scale. The content is decoded as UTF-8, with the bytes that
+   *   are not valid UTF-8 taken as Latin-1 characters.
+   * 
+   * @param content            The text content.
+   * @param length             The number of bytes of the text content.
+   * @param position           The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale              The normalized scale of the text.
+   * @param instances          The glyph instances to write to.
+   * @param maxInstancesCount  The number of glyph instances there is room for.
+   * 
+   * @return The number of glyph instances written.
+   */
+  static uint32_t layoutGlyphs(const char *content, const size_t &length, const glm::vec2 &position, const float_t &scale, TextGlyphInstance *instances, const uint32_t &maxInstancesCount)
+  {
+    // The glyphs are laid out a chunk at a time, the metrics of the glyphs of a chunk gathered into arrays so that the quads
+    //   are computed by a loop without lookups or dependencies between the glyphs, which the compiler vectorizes.
+    constexpr uint32_t chunkSize = 64;
+    float_t penX[chunkSize], bearingX[chunkSize], dropY[chunkSize], sizeX[chunkSize], sizeY[chunkSize];
+    const TextCharacter *chunkCharacters[chunkSize];
+
+    auto &characterSet = getCharacterSet();
+    const auto baseY = position.y * TEXT_HEIGHT;
+    uint32_t instancesCount = 0;
+    auto startX = position.x * TEXT_WIDTH;
+    for (size_t i = 0; i < length && instancesCount < maxInstancesCount;)
+    {
+      // Gather the glyphs of the chunk, advancing the pen past each of them.
+      uint32_t chunkCount = 0;
+      for (; chunkCount < chunkSize && i < length && instancesCount + chunkCount < maxInstancesCount; chunkCount++)
+      {
+        const auto &textCharacter = characterSet.getCharacter(decodeUtf8(content, length, i));
+        chunkCharacters[chunkCount] = &textCharacter;
+        penX[chunkCount] = startX;
+        bearingX[chunkCount] = textCharacter.bearing.x;
+        dropY[chunkCount] = textCharacter.size.y - textCharacter.bearing.y;
+        sizeX[chunkCount] = textCharacter.size.x;
+        sizeY[chunkCount] = textCharacter.size.y;
+        startX += textCharacter.advance * scale;
+      }
+
+      // Compute the corners and the sizes of the quads, in place.
+      for (uint32_t k = 0; k < chunkCount; k++)
+      {
+        penX[k] += bearingX[k] * scale;
+        dropY[k] = baseY - (dropY[k] * scale);
+        sizeX[k] *= scale;
+        sizeY[k] *= scale;
+      }
+
+      // Write the glyph instances of the chunk.
+      for (uint32_t k = 0; k < chunkCount; k++)
+      {
+        const auto &textCharacter = *chunkCharacters[k];
+        auto &instance = instances[instancesCount + k];
+        instance.position = glm::vec2(penX[k], dropY[k]);
+        instance.size[0] = glm::packHalf1x16(sizeX[k]);
+        instance.size[1] = glm::packHalf1x16(sizeY[k]);
+        instance.atlasMin[0] = static_cast<uint16_t>(textCharacter.atlasMin.x);
+        instance.atlasMin[1] = static_cast<uint16_t>(textCharacter.atlasMin.y);
+        instance.atlasMax[0] = static_cast<uint16_t>(textCharacter.atlasMax.x);
+        instance.atlasMax[1] = static_cast<uint16_t>(textCharacter.atlasMax.y);
+      }
+      instancesCount += chunkCount;
+    }
+    return instancesCount;
   }
 
-  GLuint createTextUvLayerBuffer()
+  /**
+   * Lay out the glyph instances of a text line of the frame, copying them from the layout cache if an earlier frame laid out the
+   *   same text line, and keeping them there otherwise. The glyphs never move in the atlas, so the cached instances stay valid.
+   * 
+   * @param content            The text content.
+   * @param length             The number of bytes of the text content.
+   * @param position           The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale              The normalized scale of the text.
+   * @param instances          The glyph instances to write to.
+   * @param maxInstancesCount  The number of glyph instances there is room for.
+   * 
+   * @return The number of glyph instances written.
+   */
+  uint32_t layoutCachedGlyphs(const char *content, const size_t &length, const glm::vec2 &position, const float_t &scale, TextGlyphInstance *instances, const uint32_t &maxInstancesCount)
   {
-    GLuint newBufferId;
-    glGenBuffers(1, &newBufferId);
+    const std::string_view contentView(content, length);
+    auto keyHash = std::hash<std::string_view>()(contentView);
+    const auto contentHash = keyHash;
+    for (const auto component : {position.x, position.y, scale})
+    {
+      keyHash = (keyHash * 31) + std::hash<float_t>()(component);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 1 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
+    auto &entry = layoutCache[keyHash % TEXT_LAYOUT_CACHE_SIZE];
+    if (entry.contentHash == contentHash && entry.position == position && entry.scale == scale && entry.content == contentView)
+    {
+      const auto instancesCount = std::min(static_cast<uint32_t>(entry.instances.size()), maxInstancesCount);
+      std::copy_n(entry.instances.begin(), instancesCount, instances);
+      return instancesCount;
+    }
 
+    const auto instancesCount = layoutGlyphs(content, length, position, scale, instances, maxInstancesCount);
+    // Only a text line laid out whole is kept, since there is a glyph instance for at most each of its bytes.
+    if (length <= maxInstancesCount)
+    {
+      entry.contentHash = contentHash;
+      entry.content.assign(content, length);
+      entry.position = position;
+      entry.scale = scale;
+      entry.instances.assign(instances, instances + instancesCount);
+    }
+    return instancesCount;
+  }
+
+  /**
+   * Upload the glyph instances of all the retained texts if any of them changed since the last upload.
+   * 
+   * @return The number of retained glyph instances to render.
+   */
+  uint32_t updateRetainedInstances()
+  {
+    const std::lock_guard<std::mutex> lock(retainedTextMutex);
+    if (!isRetainedTextDirty)
+    {
+      return retainedInstancesCount;
+    }
+    isRetainedTextDirty = false;
+
+    // Gather the glyph instances of the retained texts, in the order they were added.
+    gatheredRetainedInstances.clear();
+    for (const auto &retainedText : retainedTexts.getView())
+    {
+      gatheredRetainedInstances.insert(gatheredRetainedInstances.end(), retainedText->instances.begin(), retainedText->instances.end());
+    }
+    retainedInstancesCount = gatheredRetainedInstances.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, retainedInstanceBufferId);
+    GlCalls::bufferData(GL_ARRAY_BUFFER, sizeof(TextGlyphInstance) * retainedInstancesCount, gatheredRetainedInstances.data(), GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, retainedInstanceBufferId, GpuMemoryCategory::TEXT, "Retained Glyphs", sizeof(TextGlyphInstance) * retainedInstancesCount);
+    return retainedInstancesCount;
+  }
 
-    return newBufferId;
+  /**
+   * Set the content of a retained text, and lay out its glyph instances for it. The retained text mutex has to be held.
+   * 
+   * @param retainedText  The retained text.
+   * @param content       The text content.
+   * @param length        The number of bytes of the text content.
+   */
+  void layoutRetainedText(RetainedTextDetails &retainedText, const char *content, const size_t &length)
+  {
+    retainedText.content.assign(content, length);
+    retainedText.instances.resize(length);
+    retainedText.instances.resize(layoutGlyphs(content, length, retainedText.position, retainedText.scale, retainedText.instances.data(), length));
+    isRetainedTextDirty = true;
   }
 
   TextManager()
       : shaderManager(ShaderManager::getInstance()),
         windowManager(WindowManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        streamBufferManager(StreamBufferManager::getInstance()),
         textShader(shaderManager.createShaderProgram("Text", "assets/shaders/vertex/text.glsl", "assets/shaders/fragment/text.glsl")),
         textProjectionMatrix(glm::ortho(0.0f, 1.0f * VIEWPORT_WIDTH, 0.0f, 1.0f * VIEWPORT_HEIGHT)),
-        textVertexBufferId(createTextVertexBuffer()),
-        textUvBufferId(createTextUvBuffer()),
-        textUvLayerBufferId(createTextUvLayerBuffer()) {}
+        textVertexArrayId(createFrameVertexArray()),
+        instanceAllocation({}),
+        discardedInstances({}),
+        layoutCache({}),
+        retainedTexts(),
+        isRetainedTextDirty(false),
+        retainedInstanceBufferId(createRetainedInstanceBuffer()),
+        retainedVertexArrayId(createTextVertexArray(retainedInstanceBufferId)),
+        retainedInstancesCount(0),
+        gatheredRetainedInstances({}),
+        textArena() {}
+
+  ~TextManager()
+  {
+    GlCalls::deleteVertexArrays(1, &textVertexArrayId);
+    GlCalls::deleteVertexArrays(1, &retainedVertexArrayId);
+    glDeleteBuffers(1, &retainedInstanceBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, retainedInstanceBufferId);
+  }
 
 public:
+  /**
+   * Switch the memory resource the retained texts are kept in, e.g. to the arena of the scene. Must not be called while the retained texts are iterated.
+   * 
+   * @param memoryResource  The memory resource to allocate from.
+   */
+  void setMemoryResource(std::pmr::memory_resource *memoryResource)
+  {
+    retainedTexts.setMemoryResource(memoryResource);
+  }
+
   /**
    * Returns the singleton instance of the text manager.
    * 
@@ -310,131 +1052,227 @@ public:
 
   uint32_t render()
   {
-    std::vector<float_t> characterVertices({});
-    std::vector<float_t> characterUvs({});
-    std::vector<float_t> characterUvLayers({});
-    for (auto &textLine : textToRenderMap)
-    {
-      auto startX = textLine->getPosition().x * TEXT_WIDTH;
-      for (auto &ch : textLine->getContent())
-      {
-        if (characterVertices.size() / (6 * 2) >= MAX_TEXT_CHARS)
-        {
-          goto BufferFilled;
-        }
-
-        const auto textCharacter = characterSet.getCharacter(ch);
-
-        {
-          const auto xPos = startX + (textCharacter.bearing.x * textLine->getScale());
-          const auto yPos = (textLine->getPosition().y * TEXT_HEIGHT) - ((textCharacter.size.y - textCharacter.bearing.y) * textLine->getScale());
-
-          const auto width = textCharacter.size.x * textLine->getScale();
-          const auto height = textCharacter.size.y * textLine->getScale();
-
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos + height);
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos);
-
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos + height);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos + height);
-        }
-
-        {
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(textCharacter.maxUv.y);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(textCharacter.maxUv.y);
-
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(textCharacter.maxUv.y);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(0.0f);
-        }
-
-        {
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-        }
+    const std::lock_guard<std::mutex> lock(textToRenderMutex);
+    const auto renderedCharactersCount = render(textArena);
+    // Reset the arena of the frame, keeping its storage for the text of the next frame.
+    textArena.reset();
+    return renderedCharactersCount;
+  }
 
-        startX += textCharacter.advance * textLine->getScale();
-      }
+  /**
+   * Render the text of the given text arena instead of the added text, for when the text of a frame was taken to be rendered on
+   *   another thread.
+   * 
+   * @param renderedTextArena  The text arena holding the text lines to render.
+   * 
+   * @return The number of characters rendered.
+   */
+  uint32_t render(const TextArena &renderedTextArena)
+  {
+    GL_STATS_PASS(GlStatsPass::TEXT);
+    // Write a glyph instance for each character, up to the maximum number of text characters.
+    auto instances = beginInstances();
+    uint32_t instancesCount = 0;
+    for (const auto &textLine : renderedTextArena.getTextLines())
+    {
+      const auto content = renderedTextArena.getCharacters(textLine.getOffset());
+      instancesCount += layoutCachedGlyphs(content, textLine.getLength(), textLine.getPosition(), textLine.getScale(), instances + instancesCount, MAX_TEXT_CHARS - instancesCount);
     }
+    // The retained texts are drawn from their own buffer, laid out when they last changed.
+    const auto retainedInstancesCount = updateRetainedInstances();
 
-  BufferFilled:
-
-    if (characterVertices.empty())
+    if (instancesCount == 0 && retainedInstancesCount == 0)
     {
       return 0;
     }
 
+    // Upload the glyphs rasterized since the last frame, once all the text of the frame is laid out.
+    auto &characterSet = getCharacterSet();
+    characterSet.uploadAtlas();
+
     windowManager.enableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Render text
-    glUseProgram(textShader->getShaderId());
+    GlCalls::useProgram(textShader->getShaderId());
 
     const auto textTextureId = glGetUniformLocation(textShader->getShaderId(), "textTexture");
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, characterSet.characterTextureArrayId);
-    glUniform1i(textTextureId, 0);
+    GlCalls::bindTextureUnit(0, GL_TEXTURE_2D, characterSet.atlasTextureId);
+    GlCalls::uniform1i(textTextureId, 0);
+
+    const auto atlasSize = characterSet.getAtlasSize();
+    GlCalls::uniform2f(glGetUniformLocation(textShader->getShaderId(), "atlasSize"), atlasSize.x, atlasSize.y);
+    GlCalls::uniform1i(glGetUniformLocation(textShader->getShaderId(), "isSdfEnabled"), IS_TEXT_SDF_ENABLED);
 
     const auto projectionId = glGetUniformLocation(textShader->getShaderId(), "projection");
-    glUniformMatrix4fv(projectionId, 1, GL_FALSE, &textProjectionMatrix[0][0]);
+    GlCalls::uniformMatrix4fv(projectionId, 1, GL_FALSE, &textProjectionMatrix[0][0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textVertexBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterVertices.size(), &characterVertices[0]);
+    // Bind the vertex array object of the retained glyph instances, and draw the unit quad once for each of them.
+    if (retainedInstancesCount > 0)
+    {
+      GlCalls::bindVertexArray(retainedVertexArrayId);
+      GlCalls::drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, retainedInstancesCount);
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, textUvBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterUvs.size(), &characterUvs[0]);
+    // Bind the vertex array object of the glyph instances of the frame, and draw the unit quad once for each of them.
+    if (instancesCount > 0)
+    {
+      GlCalls::bindVertexArray(textVertexArrayId);
+      if (endInstances(instancesCount))
+      {
+        GlCalls::drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instancesCount);
+      }
+    }
+    GlCalls::bindVertexArray(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textUvLayerBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterUvLayers.size(), &characterUvLayers[0]);
+    windowManager.disableBlending();
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return instancesCount + retainedInstancesCount;
+  }
 
-    { // Define vertex attribute arrays that contains the vertex position, UV coordinates, and normal vector data of the model.
-      VertexAttributeArray vertexArray("VertexArray", textVertexBufferId, 2);
-      VertexAttributeArray uvArray("UvArray", textUvBufferId, 2);
-      VertexAttributeArray normalArray("UvLayerArray", textUvLayerBufferId, 1);
+  /**
+   * Discard all the text added so far, for the frames that are not rendered.
+   */
+  void clearText()
+  {
+    const std::lock_guard<std::mutex> lock(textToRenderMutex);
+    textArena.reset();
+  }
 
-      // Enable them so that it can be used by the GPU.
-      vertexArray.enableAttribute();
-      uvArray.enableAttribute();
-      normalArray.enableAttribute();
+  /**
+   * Take all the text added so far, leaving none to render, so that it can be rendered on another thread.
+   * 
+   * @param takenTextArena  Set to the text added so far (its storage is reused for the text of the next frame).
+   */
+  void takeText(TextArena &takenTextArena)
+  {
+    const std::lock_guard<std::mutex> lock(textToRenderMutex);
+    takenTextArena.reset();
+    takenTextArena.swap(textArena);
+  }
 
-      glDrawArrays(GL_TRIANGLES, 0, characterVertices.size() / 2);
+  /**
+   * Add a text line to render in the frame, copying its content into the text arena of the frame.
+   * 
+   * @param content   The text content.
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The normalized scale of the text.
+   */
+  void addText(const char *content, const glm::vec2 &position, const float_t &scale)
+  {
+    beginText(position, scale) << content;
+  }
+
+  void addText(const std::string &content, const glm::vec2 &position, const float_t &scale)
+  {
+    beginText(position, scale) << content;
+  }
+
+  /**
+   * Begin formatting a text line to render in the frame directly into the text arena of the frame, added once the returned
+   *   writer is destroyed (at the end of the statement it is streamed to). The text of the other threads waits until then.
+   * 
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The normalized scale of the text.
+   * 
+   * @return The writer of the text line.
+   */
+  TextLineWriter beginText(const glm::vec2 &position, const float_t &scale)
+  {
+    return TextLineWriter(std::unique_lock<std::mutex>(textToRenderMutex), textArena, position, scale);
+  }
+
+  /**
+   * Add a text kept on screen across frames, instead of being added again each frame, unless a text with the ID is already kept.
+   * 
+   * @param textId    The ID of the text.
+   * @param content   The text content.
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The normalized scale of the text.
+   * 
+   * @return The handle of the retained text.
+   */
+  RegistryHandle addRetainedText(const std::string &textId, const std::string &content, const glm::vec2 &position, const float_t &scale)
+  {
+    const std::lock_guard<std::mutex> lock(retainedTextMutex);
+    if (retainedTexts.contains(textId))
+    {
+      return retainedTexts.getHandle(textId);
     }
+    const auto retainedText = std::make_shared<RetainedTextDetails>(position, scale);
+    layoutRetainedText(*retainedText, content.data(), content.size());
+    return retainedTexts.add(textId, retainedText);
+  }
 
-    windowManager.disableBlending();
+  /**
+   * Change the content of a retained text, laying its glyphs out again only if the content is different.
+   * 
+   * @param textHandle  The handle of the retained text.
+   * @param content     The new text content.
+   */
+  void setRetainedText(const RegistryHandle &textHandle, const std::string &content)
+  {
+    setRetainedText(textHandle, content.data(), content.size());
+  }
+
+  /**
+   * Change the content of a retained text to the text formatted by a writer, laying its glyphs out again only if the content is
+   *   different, so that the retained texts changed each frame are formatted without allocating strings.
+   * 
+   * @param textHandle  The handle of the retained text.
+   * @param content     The writer of the new text content.
+   */
+  void setRetainedText(const RegistryHandle &textHandle, const TextWriter &content)
+  {
+    setRetainedText(textHandle, content.getContent(), content.getLength());
+  }
 
-    clearTextToRenderMap();
+  /**
+   * Change the content of a retained text, laying its glyphs out again only if the content is different.
+   * 
+   * @param textHandle  The handle of the retained text.
+   * @param content     The new text content.
+   * @param length      The number of bytes of the new text content.
+   */
+  void setRetainedText(const RegistryHandle &textHandle, const char *content, const size_t &length)
+  {
+    const std::lock_guard<std::mutex> lock(retainedTextMutex);
+    if (!retainedTexts.contains(textHandle))
+    {
+      return;
+    }
+    const auto &retainedText = retainedTexts.get(textHandle);
+    if (retainedText->content.compare(0, std::string::npos, content, length) != 0)
+    {
+      layoutRetainedText(*retainedText, content, length);
+    }
+  }
 
-    return characterUvLayers.size() / 6;
+  /**
+   * Get the character set of the text, loading the font the first time, so that it is loaded by the startup of the engine (or
+   *   the first text laid out) instead of during the static initialization. Must be called first on the thread the GL context
+   *   is current on, since it creates the glyph atlas.
+   * 
+   * @return The character set.
+   */
+  static TextCharacterSet &getCharacterSet()
+  {
+    static TextCharacterSet characterSet("Roboto", "assets/fonts/Roboto-Regular.ttf");
+    return characterSet;
   }
 
-  void addText(const std::string &content, const glm::vec2 &position, const float_t &scale)
+  /**
+   * Remove a retained text from the screen.
+   * 
+   * @param textHandle  The handle of the retained text.
+   */
+  void removeRetainedText(const RegistryHandle &textHandle)
   {
-    textToRenderMap.push_back(std::make_shared<const TextDetails>(content, position, scale));
+    const std::lock_guard<std::mutex> lock(retainedTextMutex);
+    retainedTexts.remove(textHandle);
+    isRetainedTextDirty = true;
   }
 };
 
-// Initialize the text character set static variable.
-const TextCharacterSet TextManager::characterSet = TextCharacterSet("Roboto", "assets/fonts/Roboto-Regular.ttf");
 // Initialize the text manager singleton instance static variable.
 TextManager TextManager::instance;
 
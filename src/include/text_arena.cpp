@@ -0,0 +1,281 @@
+#ifndef INCLUDE_TEXT_ARENA_CPP
+#define INCLUDE_TEXT_ARENA_CPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+
+/**
+ * Class for containing the details of the text to render, the content of which is a span of the characters of a text arena.
+ */
+class TextDetails
+{
+private:
+  // The offset of the text content in the characters of the text arena.
+  size_t offset;
+  // The number of bytes of the text content.
+  size_t length;
+  // The position of the text, with the origin being the bottom-left of the screen.
+  glm::vec2 position;
+  // The normalized scale of the text, where a value of 1.0f is 100% the default size of the text.
+  float_t scale;
+
+public:
+  TextDetails(
+      const size_t &offset,
+      const size_t &length,
+      const glm::vec2 &position,
+      const float_t &scale)
+      : offset(offset),
+        length(length),
+        position(position),
+        scale(scale) {}
+
+  /**
+   * Get the offset of the content of the text in the characters of its text arena.
+   * 
+   * @return The text content offset.
+   */
+  const size_t &getOffset() const
+  {
+    return offset;
+  }
+
+  /**
+   * Get the number of bytes of the content of the text.
+   * 
+   * @return The text content length.
+   */
+  const size_t &getLength() const
+  {
+    return length;
+  }
+
+  /**
+   * Get the position of the text, with the origin being the bottom-left of the screen.
+   * 
+   * @return The text position.
+   */
+  const glm::vec2 &getPosition() const
+  {
+    return position;
+  }
+
+  /**
+   * Get the scale of the text, where a value of 1.0f is 100% the default size of the text.
+   * 
+   * @return The text scale.
+   */
+  const float_t &getScale() const
+  {
+    return scale;
+  }
+};
+
+/**
+ * A class for a linear arena holding the text of a frame, which the text is formatted into directly instead of being built from
+ *   strings. Its storage is allocated once and reused, so that the text of a frame makes no heap allocations, and it is reset
+ *   once the text is rendered.
+ */
+class TextArena
+{
+private:
+  // The characters of the text of the frame, sized up front (with room for the terminating null character of the formatting).
+  std::vector<char> characters;
+  // The number of characters written into the arena.
+  size_t charactersCount;
+  // The text lines of the frame, as spans of the characters.
+  std::vector<TextDetails> textLines;
+
+public:
+  TextArena(const size_t &capacity = TEXT_ARENA_SIZE, const size_t &textLinesCapacity = TEXT_ARENA_LINES)
+      : characters(capacity + 1, '\0'),
+        charactersCount(0),
+        textLines({})
+  {
+    textLines.reserve(textLinesCapacity);
+  }
+
+  /**
+   * Discard all the text of the arena, keeping its storage for the next frame.
+   */
+  void reset()
+  {
+    charactersCount = 0;
+    textLines.clear();
+  }
+
+  /**
+   * Swap the text of the arena with that of another one, for passing the text of a frame to another thread.
+   * 
+   * @param other  The other text arena.
+   */
+  void swap(TextArena &other)
+  {
+    characters.swap(other.characters);
+    std::swap(charactersCount, other.charactersCount);
+    textLines.swap(other.textLines);
+  }
+
+  /**
+   * Append characters to the text of the arena, cutting them off if the arena is full.
+   * 
+   * @param content  The characters to append.
+   * @param length   The number of characters.
+   */
+  void append(const char *content, const size_t &length)
+  {
+    const auto appendedCount = std::min(length, characters.size() - 1 - charactersCount);
+    std::memcpy(characters.data() + charactersCount, content, appendedCount);
+    charactersCount += appendedCount;
+  }
+
+  /**
+   * Append formatted characters to the text of the arena, cutting them off if the arena is full.
+   * 
+   * @param format     The printf format of the characters.
+   * @param arguments  The arguments of the format.
+   */
+  template <typename... Arguments>
+  void appendFormatted(const char *format, const Arguments &...arguments)
+  {
+    const auto roomCount = characters.size() - charactersCount;
+    const auto formattedCount = std::snprintf(characters.data() + charactersCount, roomCount, format, arguments...);
+    if (formattedCount > 0)
+    {
+      charactersCount += std::min(static_cast<size_t>(formattedCount), roomCount - 1);
+    }
+  }
+
+  /**
+   * Add a text line made of the characters appended since the given offset.
+   * 
+   * @param offset    The offset of the first character of the text line.
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The normalized scale of the text.
+   */
+  void addTextLine(const size_t &offset, const glm::vec2 &position, const float_t &scale)
+  {
+    textLines.emplace_back(offset, charactersCount - offset, position, scale);
+  }
+
+  /**
+   * Get the number of characters written into the arena, which is the offset the next characters are appended at.
+   * 
+   * @return The number of characters.
+   */
+  const size_t &getCharactersCount() const
+  {
+    return charactersCount;
+  }
+
+  /**
+   * Get the characters of the arena starting at the given offset.
+   * 
+   * @param offset  The offset of the first character.
+   * 
+   * @return The characters.
+   */
+  const char *getCharacters(const size_t &offset) const
+  {
+    return characters.data() + offset;
+  }
+
+  /**
+   * Get the text lines of the frame.
+   * 
+   * @return The text lines.
+   */
+  const std::vector<TextDetails> &getTextLines() const
+  {
+    return textLines;
+  }
+};
+
+/**
+ * A class for formatting text into a text arena, one value at a time, like an output stream. The numbers are formatted like
+ *   std::to_string formats them.
+ */
+class TextWriter
+{
+protected:
+  // The text arena written to.
+  TextArena &arena;
+  // The offset of the first character written.
+  const size_t offset;
+
+public:
+  explicit TextWriter(TextArena &arena)
+      : arena(arena),
+        offset(arena.getCharactersCount()) {}
+
+  // Preventing copying the text writer, since the text it wrote is a span of the arena.
+  TextWriter(const TextWriter &) = delete;
+
+  TextWriter &operator<<(const char *content)
+  {
+    arena.append(content, std::strlen(content));
+    return *this;
+  }
+
+  TextWriter &operator<<(const std::string &content)
+  {
+    arena.append(content.data(), content.size());
+    return *this;
+  }
+
+  TextWriter &operator<<(const char &character)
+  {
+    arena.append(&character, 1);
+    return *this;
+  }
+
+  template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+  TextWriter &operator<<(const T &value)
+  {
+    if (std::is_signed<T>::value)
+    {
+      arena.appendFormatted("%lld", static_cast<long long>(value));
+    }
+    else
+    {
+      arena.appendFormatted("%llu", static_cast<unsigned long long>(value));
+    }
+    return *this;
+  }
+
+  TextWriter &operator<<(const double_t &value)
+  {
+    arena.appendFormatted("%f", value);
+    return *this;
+  }
+
+  /**
+   * Get the text written so far.
+   * 
+   * @return The characters of the text.
+   */
+  const char *getContent() const
+  {
+    return arena.getCharacters(offset);
+  }
+
+  /**
+   * Get the number of characters of the text written so far.
+   * 
+   * @return The number of characters.
+   */
+  size_t getLength() const
+  {
+    return arena.getCharactersCount() - offset;
+  }
+};
+
+#endif
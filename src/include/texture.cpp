@@ -6,9 +6,31 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include <string.h>
 
 #include <GL/glew.h>
 
+#include "constants.cpp"
+#include "mapped_file.cpp"
+#include "asset_archive.cpp"
+#include "residency_cache.cpp"
+#include "job.cpp"
+#include "gpu_memory.cpp"
+#include "gl_debug.cpp"
+#include "asset_manifest.cpp"
+#include "name_interner.cpp"
+#include "asset_registry.cpp"
+#include "startup_timer.cpp"
+#include "upload_context.cpp"
+#include "gpu_deletion.cpp"
+#include "mip_chain.cpp"
+
 /**
  * Class for containing the details of the shader.
  */
@@ -18,19 +40,25 @@ class TextureDetails
 	friend class TextureManager;
 
 private:
-	// The ID of the texture containing the texture data.
-	const GLuint textureId;
+	// The ID of the texture containing the texture data (or of the texture array containing it, which changes when the array grows).
+	GLuint textureId;
+	// The layer of the texture array containing the texture data (0 if the texture is not batched).
+	uint32_t textureLayer;
 
 	// The name of the texture.
 	const std::string textureName;
 	// The file path to the texture data.
 	const std::string textureFilePath;
+	// The estimated size of the texture data in GPU memory in bytes (including the mip-maps).
+	const uint64_t textureSize;
 
 public:
-	TextureDetails(const GLuint &textureId, const std::string &textureName, const std::string &textureFilePath)
+	TextureDetails(const GLuint &textureId, const uint32_t &textureLayer, const std::string &textureName, const std::string &textureFilePath, const uint64_t &textureSize)
 			: textureId(textureId),
+				textureLayer(textureLayer),
 				textureName(textureName),
-				textureFilePath(textureFilePath) {}
+				textureFilePath(textureFilePath),
+				textureSize(textureSize) {}
 
 	/**
    * Get the name of the texture.
@@ -51,6 +79,113 @@ public:
 	{
 		return textureName;
 	}
+
+	/**
+	 * Get the layer of the texture array containing the texture data.
+	 * 
+	 * @return The layer, which is 0 if the texture is not batched.
+	 */
+	const uint32_t &getTextureLayer() const
+	{
+		return textureLayer;
+	}
+
+	/**
+	 * Get the target the textures are bound to, which is the texture array target when the textures are batched.
+	 * 
+	 * @return The texture target.
+	 */
+	static GLenum getTextureTarget()
+	{
+		return IS_TEXTURE_ARRAY_BATCHING_ENABLED ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+	}
+};
+
+/**
+ * Structure for defining a texture whose image data is being read in the background.
+ */
+struct StreamingTexture
+{
+	// The ID of the texture, containing a placeholder until the image data is uploaded.
+	GLuint textureId;
+	// The ID of the pixel buffer object the image data is read into.
+	GLuint pixelBufferId;
+	// Whether the pixel buffer object is still mapped for the read task.
+	bool isPixelBufferMapped;
+	// The width of the image.
+	uint32_t width;
+	// The height of the image.
+	uint32_t height;
+	// The task reading the image data into the mapped pixel buffer object on a worker thread.
+	std::shared_ptr<JobTask> readTask;
+	// Whether the task is done reading.
+	std::atomic<bool> isReadDone;
+	// Whether all of the image data was read (only valid once the task is done).
+	bool isReadSuccessful;
+	// The upload reading the image data into a texture of its own on the upload context, instead of the read task and the pixel
+	//   buffer object (null if there is no upload context).
+	std::shared_ptr<ContextUpload> upload;
+	// The ID of the texture created by the upload, which replaces the placeholder once the upload is done (0 if it failed).
+	GLuint uploadedTextureId;
+	// The layouts of the mip levels generated into the pixel buffer object along with the image (empty if the mip-maps are
+	//   generated by the driver).
+	std::vector<MipLevelLayout> mipLevels;
+	// The number of generated mip levels uploaded so far, from the smallest one.
+	uint32_t uploadedLevelsCount;
+};
+
+/**
+ * Structure for defining a block-compressed texture whose mip levels are streamed in and out, keeping its file mapped so that
+ *   any level can be uploaded again. Only the levels from the base level down to the smallest one are resident.
+ */
+struct StreamedMipChain
+{
+	// The ID of the texture.
+	GLuint textureId;
+	// The mapped DDS file, containing the whole mip chain.
+	std::unique_ptr<AssetFile> file;
+	// The GL format of the compressed data.
+	GLenum internalFormat;
+	// The width and height of the largest level.
+	uint32_t width;
+	uint32_t height;
+	// The positions and sizes of the data of the levels in the file, from the largest level to the smallest.
+	std::vector<size_t> levelOffsets;
+	std::vector<uint32_t> levelSizes;
+	// The largest level that is resident, which the texture is sampled from.
+	uint32_t baseLevel;
+	// The level the texture never drops below, which is resident from the start.
+	uint32_t floorLevel;
+	// The largest level needed by the models drawn with the texture, as of the last update.
+	uint32_t requestedLevel;
+	// The most texels along the largest side needed by the models drawn with the texture since the last update.
+	float_t requestedTexels;
+	// The update the base level was last needed in.
+	uint64_t neededUpdate;
+	// Whether the levels are committed and uncommitted in sparse storage, instead of being specified again.
+	bool isSparse;
+	// The number of levels that can be committed separately, the rest being the mip tail committed along with the floor level.
+	uint32_t sparseLevelsCount;
+};
+
+/**
+ * Structure for defining a texture array shared by the textures of the same format and size, with a layer for each texture.
+ */
+struct TextureArray
+{
+	// The ID of the texture array.
+	GLuint textureId;
+	// The GL format of the layers, and the size of its 4x4 blocks (0 if it is not block-compressed).
+	GLenum internalFormat;
+	uint32_t blockSize;
+	// The width and height of the largest level, and the number of levels.
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelsCount;
+	// The size of a layer with all its levels in GPU memory.
+	uint64_t layerSize;
+	// The names of the textures in each layer the array has storage for (empty for the free layers).
+	std::vector<std::string> layerTextureNames;
 };
 
 /**
@@ -62,10 +197,66 @@ private:
 	// Singleton instance of the texture manager.
 	static TextureManager instance;
 
-	// A map of created textures.
-	std::map<const std::string, const std::shared_ptr<const TextureDetails>> namedTextures;
-	// A map counting the references to the created textures.
-	std::map<const std::string, int32_t> namedTextureReferences;
+	// The job manager running the reads of the streaming textures.
+	JobManager &jobManager;
+	// The upload context manager responsible for uploading the images of the BMP textures off the main context.
+	UploadContextManager &uploadContextManager;
+	// The GPU memory manager the textures and their pixel buffer objects are accounted in.
+	GpuMemoryManager &gpuMemoryManager;
+	// The GL debug manager the textures and their pixel buffer objects are labeled with.
+	const GlDebugManager &glDebugManager;
+	// The GPU deletion queue the destroyed textures and the used pixel buffer objects are retired to.
+	GpuDeletionQueue &gpuDeletionQueue;
+	// The manifest of the cooked assets, the textures are looked up in to load their cooked versions.
+	const AssetManifest &assetManifest;
+
+	// The name interner the names of the created textures are interned with.
+	NameInterner &nameInterner;
+	// The registry of the created textures and their reference counts, by their interned names (looked up from any thread).
+	AssetRegistry<TextureDetails> namedTextures;
+	// A map of the textures whose image data is still being read in the background.
+	std::map<const std::string, std::unique_ptr<StreamingTexture>> streamingTextures;
+	// A map of the textures whose mip levels are streamed by the screen sizes of the models drawn with them.
+	std::map<const std::string, std::unique_ptr<StreamedMipChain>> streamedMipChains;
+	// The size of the resident mip levels of the streamed textures in GPU memory.
+	uint64_t streamedMipsSize;
+	// The number of times the streamed mip levels were updated, which the times the levels were last needed are counted in.
+	uint64_t mipStreamingUpdate;
+	// The texture arrays shared by the batched textures.
+	std::vector<std::unique_ptr<TextureArray>> textureArrays;
+	// The ID of the texture array with a single grey pixel, shown by the batched textures until their image data is uploaded
+	//   (created with the first one).
+	GLuint placeholderArrayId;
+	// The cache keeping the textures without references alive, so that the next scene using them does not load them again.
+	ResidencyCache residencyCache;
+
+	// The size of the DDS magic number and header, after which either the DX10 header or the texture data start.
+	static constexpr uint32_t DDS_HEADER_SIZE = 4 + 124;
+	// The size of the DX10 header, used by DDS files storing formats without a FourCC code (like BC7).
+	static constexpr uint32_t DDS_DX10_HEADER_SIZE = 20;
+	// The DXGI format codes of the supported block-compressed formats in the DX10 header.
+	static constexpr uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+	static constexpr uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+	static constexpr uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+	/**
+	 * Check if the given file path ends with the given extension, ignoring the case.
+	 * 
+	 * @param filePath   The file path.
+	 * @param extension  The extension, including the dot.
+	 * 
+	 * @return Whether the file path has the extension or not.
+	 */
+	static bool hasFileExtension(const std::string &filePath, const std::string &extension)
+	{
+		if (filePath.size() < extension.size())
+		{
+			return false;
+		}
+		return std::equal(extension.begin(), extension.end(), filePath.end() - extension.size(), [](const char &a, const char &b) {
+			return tolower(a) == tolower(b);
+		});
+	}
 
 	/**
 	 * Create a 2D texture of the given width and height, and store the data of the texture.
@@ -84,7 +275,7 @@ private:
 		// Create a new texture and store the ID.
 		glGenTextures(1, &textureId);
 		// Bind the texture as a 2D texture.
-		glBindTexture(GL_TEXTURE_2D, textureId);
+		GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
 		// Create a 2D RGB texture image on the bounded texture.
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, textureData);
 
@@ -99,32 +290,1018 @@ private:
 		glGenerateMipmap(GL_TEXTURE_2D);
 
 		// Unbind the texture now that we're done.
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GlCalls::bindTexture(GL_TEXTURE_2D, 0);
 
 		// Return the ID of the created texture.
 		return textureId;
 	}
 
 	/**
-	 * Load the BMP image and create a texture for it.
+	 * Get the size of a level of a block-compressed texture.
+	 * 
+	 * @param width      The width of the level.
+	 * @param height     The height of the level.
+	 * @param blockSize  The size of each 4x4 block.
+	 * 
+	 * @return The size of the level, with the partial blocks at the edges stored whole.
+	 */
+	static uint32_t getCompressedLevelSize(const uint32_t &width, const uint32_t &height, const uint32_t &blockSize)
+	{
+		return ((std::max(width, 1u) + 3) / 4) * ((std::max(height, 1u) + 3) / 4) * blockSize;
+	}
+
+	/**
+	 * Specify the storage of every level of the bound texture array, for the given number of layers and without any data.
+	 * 
+	 * @param textureArray  The texture array.
+	 * @param layersCount   The number of layers.
+	 */
+	static void allocateTextureArray(const TextureArray &textureArray, const uint32_t &layersCount)
+	{
+		for (uint32_t level = 0; level < textureArray.levelsCount; level++)
+		{
+			const auto levelWidth = std::max(textureArray.width >> level, 1u);
+			const auto levelHeight = std::max(textureArray.height >> level, 1u);
+			if (textureArray.blockSize > 0)
+			{
+				glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.internalFormat, levelWidth, levelHeight, layersCount, 0, getCompressedLevelSize(levelWidth, levelHeight, textureArray.blockSize) * layersCount, nullptr);
+			}
+			else
+			{
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.internalFormat, levelWidth, levelHeight, layersCount, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+
+		// Provide parameters for behaviour when reading coordinates that are out-of-bounds,
+		//   as well as algorithms to use for maginifcation and minification.
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, textureArray.levelsCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.levelsCount - 1);
+	}
+
+	/**
+	 * Record the memory of a texture array and label it, after its storage changed.
+	 * 
+	 * @param textureArray  The texture array.
+	 */
+	void recordTextureArray(const TextureArray &textureArray)
+	{
+		const auto arrayName = "Texture Array " + std::to_string(textureArray.width) + "x" + std::to_string(textureArray.height);
+		gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureArray.textureId, GpuMemoryCategory::TEXTURE, arrayName, textureArray.layerSize * textureArray.layerTextureNames.size());
+		glDebugManager.labelObject(GL_TEXTURE, textureArray.textureId, arrayName);
+	}
+
+	/**
+	 * Double the layers of a full texture array, copying the layers into a new texture array and pointing the textures in it
+	 *   at the new one. Needs the copy image extension.
+	 * 
+	 * @param textureArray  The texture array.
+	 */
+	void growTextureArray(TextureArray &textureArray)
+	{
+		const auto layersCount = static_cast<uint32_t>(textureArray.layerTextureNames.size());
+		const auto grownLayersCount = std::min(layersCount * 2, TEXTURE_ARRAY_MAX_LAYERS);
+		GLuint textureId;
+		glGenTextures(1, &textureId);
+		GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+		allocateTextureArray(textureArray, grownLayersCount);
+		GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		for (uint32_t level = 0; level < textureArray.levelsCount; level++)
+		{
+			glCopyImageSubData(textureArray.textureId, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, textureId, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+												 std::max(textureArray.width >> level, 1u), std::max(textureArray.height >> level, 1u), layersCount);
+		}
+		gpuDeletionQueue.retireTexture(textureArray.textureId);
+		gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, textureArray.textureId);
+
+		textureArray.textureId = textureId;
+		textureArray.layerTextureNames.resize(grownLayersCount);
+		recordTextureArray(textureArray);
+		for (const auto &layerTextureName : textureArray.layerTextureNames)
+		{
+			const auto layerTexture = namedTextures.find(nameInterner.intern(layerTextureName));
+			if (layerTexture != nullptr)
+			{
+				layerTexture->textureId = textureId;
+			}
+		}
+	}
+
+	/**
+	 * Take a free layer of a texture array of the given format and size for a texture, growing a full array or creating a new
+	 *   one if there is none. The arrays only have a single layer each if they cannot be copied to grow.
+	 * 
+	 * @param textureName      The name of the texture.
+	 * @param internalFormat   The GL format of the texture.
+	 * @param blockSize        The size of each 4x4 block of the format (0 if it is not block-compressed).
+	 * @param width            The width of the texture.
+	 * @param height           The height of the texture.
+	 * @param levelsCount      The number of mip levels of the texture.
+	 * @param outTextureLayer  The output variable for the layer taken.
+	 * 
+	 * @return The texture array the layer was taken in.
+	 */
+	const TextureArray &acquireTextureLayer(const std::string &textureName, const GLenum &internalFormat, const uint32_t &blockSize, const uint32_t &width, const uint32_t &height, const uint32_t &levelsCount, uint32_t &outTextureLayer)
+	{
+		// Look for a free layer in an array of the same format and size, or for one that can grow.
+		TextureArray *grownArray = nullptr;
+		for (auto &textureArray : textureArrays)
+		{
+			if (textureArray->internalFormat != internalFormat || textureArray->width != width || textureArray->height != height || textureArray->levelsCount != levelsCount)
+			{
+				continue;
+			}
+			auto &layerTextureNames = textureArray->layerTextureNames;
+			const auto freeLayer = std::find(layerTextureNames.begin(), layerTextureNames.end(), "");
+			if (freeLayer != layerTextureNames.end())
+			{
+				*freeLayer = textureName;
+				outTextureLayer = static_cast<uint32_t>(freeLayer - layerTextureNames.begin());
+				return *textureArray;
+			}
+			if (grownArray == nullptr && GLEW_ARB_copy_image && layerTextureNames.size() < TEXTURE_ARRAY_MAX_LAYERS)
+			{
+				grownArray = textureArray.get();
+			}
+		}
+
+		if (grownArray != nullptr)
+		{
+			growTextureArray(*grownArray);
+		}
+		else
+		{
+			// Create a new array with a single layer.
+			auto textureArray = std::make_unique<TextureArray>();
+			textureArray->internalFormat = internalFormat;
+			textureArray->blockSize = blockSize;
+			textureArray->width = width;
+			textureArray->height = height;
+			textureArray->levelsCount = levelsCount;
+			textureArray->layerSize = 0;
+			for (uint32_t level = 0; level < levelsCount; level++)
+			{
+				const auto levelWidth = std::max(width >> level, 1u);
+				const auto levelHeight = std::max(height >> level, 1u);
+				// The uncompressed layers are usually stored with 4 bytes per pixel.
+				textureArray->layerSize += blockSize > 0 ? getCompressedLevelSize(levelWidth, levelHeight, blockSize) : static_cast<uint64_t>(levelWidth) * levelHeight * 4;
+			}
+			textureArray->layerTextureNames.resize(1);
+			glGenTextures(1, &textureArray->textureId);
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, textureArray->textureId);
+			allocateTextureArray(*textureArray, 1);
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			recordTextureArray(*textureArray);
+			grownArray = textureArray.get();
+			textureArrays.push_back(std::move(textureArray));
+		}
+		const auto freeLayer = std::find(grownArray->layerTextureNames.begin(), grownArray->layerTextureNames.end(), "");
+		*freeLayer = textureName;
+		outTextureLayer = static_cast<uint32_t>(freeLayer - grownArray->layerTextureNames.begin());
+		return *grownArray;
+	}
+
+	/**
+	 * Free the layer of the texture array containing the given texture, deleting the array once all of its layers are free.
+	 * 
+	 * @param textureName  The name of the texture (which may still be showing the placeholder, in no texture array).
+	 */
+	void releaseTextureLayer(const std::string &textureName)
+	{
+		for (auto textureArray = textureArrays.begin(); textureArray != textureArrays.end(); textureArray++)
+		{
+			auto &layerTextureNames = (*textureArray)->layerTextureNames;
+			const auto layer = std::find(layerTextureNames.begin(), layerTextureNames.end(), textureName);
+			if (layer == layerTextureNames.end())
+			{
+				continue;
+			}
+			layer->clear();
+			if (std::all_of(layerTextureNames.begin(), layerTextureNames.end(), [](const std::string &layerTextureName) { return layerTextureName.empty(); }))
+			{
+				gpuDeletionQueue.retireTexture((*textureArray)->textureId);
+				gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, (*textureArray)->textureId);
+				textureArrays.erase(textureArray);
+			}
+			return;
+		}
+	}
+
+	/**
+	 * Get the texture array shown by the batched textures until their image data is uploaded, creating it on first use.
+	 * 
+	 * @return The ID of the placeholder texture array.
+	 */
+	GLuint getPlaceholderArray()
+	{
+		if (placeholderArrayId == 0)
+		{
+			const unsigned char placeholderData[3] = {128, 128, 128};
+			glGenTextures(1, &placeholderArrayId);
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, placeholderArrayId);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, 1, 1, 1, 0, GL_BGR, GL_UNSIGNED_BYTE, placeholderData);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			glDebugManager.labelObject(GL_TEXTURE, placeholderArrayId, "Texture Array Placeholder");
+		}
+		return placeholderArrayId;
+	}
+
+	/**
+	 * Load the BMP image in the background, and create a texture for it containing a placeholder until the image data is uploaded by updateStreamingTextures.
 	 * 
 	 * @param textureName      The name of the texture being loaded.
 	 * @param textureFilePath  The file path to the texture data.
+	 * @param outTextureSize   The output variable for the estimated size of the texture in GPU memory.
 	 * 
 	 * @return The ID of the texture.
 	 */
-	GLuint loadBmpTexture(const std::string &textureName, const std::string &textureFilePath)
+	GLuint loadBmpTexture(const std::string &textureName, const std::string &textureFilePath, uint64_t &outTextureSize)
+	{
+		// Read the BMP metadata information, so that the image can be checked before anything is created.
+		uint32_t dataPos, imageSize, width, height;
+		readBmpHeader(textureName, textureFilePath, dataPos, imageSize, width, height);
+
+		// Create the texture with a single grey pixel as the placeholder (or show the shared placeholder, for the batched textures).
+		const unsigned char placeholderData[3] = {128, 128, 128};
+		const auto textureId = IS_TEXTURE_ARRAY_BATCHING_ENABLED ? getPlaceholderArray() : create2dTexture(placeholderData, 1, 1);
+
+		// Create a pixel buffer object for the image data, and map it for writing so that the read task can fill it.
+		auto streamingTexture = std::make_unique<StreamingTexture>();
+		streamingTexture->textureId = textureId;
+		streamingTexture->width = width;
+		streamingTexture->height = height;
+		streamingTexture->isReadDone.store(false);
+		streamingTexture->isReadSuccessful = false;
+		streamingTexture->uploadedTextureId = 0;
+		streamingTexture->uploadedLevelsCount = 0;
+
+		// The image is usually stored with 4 bytes per pixel, and the mip-maps take another third of it.
+		outTextureSize = (static_cast<uint64_t>(width) * height * 4 * 4) / 3;
+
+		// Read and upload the image on the upload context if there is one, so that nothing of it is done on the main context (the
+		//   batched textures are uploaded into the layers of their arrays, which the main context keeps using, and the textures with
+		//   generated mip chains are uploaded a few levels at a time through their pixel buffer objects).
+		const auto streamingTexturePointer = streamingTexture.get();
+		if (!IS_TEXTURE_ARRAY_BATCHING_ENABLED && !IS_CPU_MIP_GENERATION_ENABLED)
+		{
+			streamingTexture->upload = uploadContextManager.submitUpload([textureFilePath, dataPos, imageSize, streamingTexturePointer]() {
+				uploadBmpData(textureFilePath, dataPos, imageSize, streamingTexturePointer);
+			});
+		}
+		if (streamingTexture->upload != nullptr)
+		{
+			streamingTexture->pixelBufferId = 0;
+			streamingTexture->isPixelBufferMapped = false;
+			streamingTextures[textureName] = std::move(streamingTexture);
+			return textureId;
+		}
+
+		// Make room in the pixel buffer object for the whole mip chain if it is generated, stored after the image.
+		uint64_t pixelBufferSize = imageSize;
+		if (IS_CPU_MIP_GENERATION_ENABLED)
+		{
+			streamingTexture->mipLevels = MipChainGenerator::getLevelLayouts(width, height);
+			pixelBufferSize = MipChainGenerator::getChainSize(streamingTexture->mipLevels);
+		}
+		glGenBuffers(1, &streamingTexture->pixelBufferId);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingTexture->pixelBufferId);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, pixelBufferSize, nullptr, GL_STREAM_DRAW);
+		gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, streamingTexture->pixelBufferId, GpuMemoryCategory::DYNAMIC, textureName, pixelBufferSize);
+		glDebugManager.labelObject(GL_BUFFER, streamingTexture->pixelBufferId, textureName + " Pixels");
+		const auto textureData = static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, pixelBufferSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		streamingTexture->isPixelBufferMapped = true;
+		if (textureData == nullptr)
+		{
+			// Could not map the pixel buffer object. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 10" << std::endl;
+			exit(1);
+		}
+
+		// Start reading the image data on a worker thread, into the memory the mip chain is generated in as well if it is generated.
+		//   The mip levels are filtered and copied into the pixel buffer object by tasks of their own once the image is read.
+		const auto chainData = IS_CPU_MIP_GENERATION_ENABLED ? std::make_shared<std::vector<unsigned char>>() : nullptr;
+		const auto baseLevelSize = IS_CPU_MIP_GENERATION_ENABLED ? std::min<uint64_t>(imageSize, streamingTexture->mipLevels.front().getSize()) : imageSize;
+		auto readTask = jobManager.submitTask([textureFilePath, dataPos, baseLevelSize, textureData, chainData, pixelBufferSize, streamingTexturePointer]() {
+			readBmpData(textureFilePath, dataPos, baseLevelSize, textureData, chainData.get(), pixelBufferSize, streamingTexturePointer);
+		});
+		if (IS_CPU_MIP_GENERATION_ENABLED)
+		{
+			readTask = MipChainGenerator::submitFilterTasks(chainData, textureData, streamingTexture->mipLevels, readTask);
+		}
+		// Let the GL thread know the data can be uploaded once it is all there.
+		streamingTexture->readTask = jobManager.submitTask([streamingTexturePointer]() { streamingTexturePointer->isReadDone.store(true, std::memory_order_release); }, {readTask});
+		streamingTextures[textureName] = std::move(streamingTexture);
+
+		// Return the ID of the created texture.
+		return textureId;
+	}
+
+	/**
+	 * Finish streaming the given texture uploaded on the upload context, replacing the placeholder with the texture created by the
+	 *   upload if requested, or deleting it otherwise. Waits for the upload if it is not done yet.
+	 * 
+	 * @param textureName        The name of the texture.
+	 * @param streamingTexture   The streaming texture.
+	 * @param isUploadRequested  Whether to use the uploaded texture, or just delete it.
+	 */
+	void finishContextUpload(const std::string &textureName, StreamingTexture &streamingTexture, const bool &isUploadRequested)
+	{
+		uploadContextManager.waitForUpload(*streamingTexture.upload);
+		if (!isUploadRequested)
+		{
+			gpuDeletionQueue.retireTexture(streamingTexture.uploadedTextureId);
+			return;
+		}
+		if (!streamingTexture.isReadSuccessful)
+		{
+			// Could not read the BMP file. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 2" << std::endl;
+			exit(1);
+		}
+
+		// Show the uploaded texture instead of the placeholder, moving its memory and label over.
+		auto &textureDetails = *namedTextures.at(nameInterner.intern(textureName));
+		gpuDeletionQueue.retireTexture(streamingTexture.textureId);
+		gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, streamingTexture.textureId);
+		textureDetails.textureId = streamingTexture.uploadedTextureId;
+		gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureDetails.textureId, GpuMemoryCategory::TEXTURE, textureName, textureDetails.textureSize);
+		glDebugManager.labelObject(GL_TEXTURE, textureDetails.textureId, textureName);
+	}
+
+	/**
+	 * Wait for the read task of the given streaming texture, and unmap its pixel buffer object (if it is still mapped), leaving it
+	 *   bound.
+	 * 
+	 * @param streamingTexture  The streaming texture.
+	 * 
+	 * @return Whether all of the image data is in the pixel buffer object.
+	 */
+	bool unmapPixelBuffer(StreamingTexture &streamingTexture)
+	{
+		jobManager.waitForTask(streamingTexture.readTask);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingTexture.pixelBufferId);
+		if (streamingTexture.isPixelBufferMapped)
+		{
+			streamingTexture.isPixelBufferMapped = false;
+			streamingTexture.isReadSuccessful = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE && streamingTexture.isReadSuccessful;
+		}
+		return streamingTexture.isReadSuccessful;
+	}
+
+	/**
+	 * Upload the generated mip levels of the given streaming texture from its pixel buffer object, from the smallest level not
+	 *   uploaded yet up, until the given size is used up (uploading at least one level). The base level of the texture is lowered
+	 *   to the largest uploaded level, so that it shows the levels uploaded so far instead of the placeholder.
+	 * 
+	 * @param textureName       The name of the texture.
+	 * @param streamingTexture  The streaming texture, whose read task is done.
+	 * @param sizeBudget        The size of the levels to upload (in bytes).
+	 * 
+	 * @return Whether all the levels are uploaded.
+	 */
+	bool uploadMipLevels(const std::string &textureName, StreamingTexture &streamingTexture, const uint64_t &sizeBudget)
+	{
+		if (!unmapPixelBuffer(streamingTexture))
+		{
+			// Could not read the BMP file. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 2" << std::endl;
+			exit(1);
+		}
+
+		GlCalls::bindTexture(GL_TEXTURE_2D, streamingTexture.textureId);
+		const auto levelsCount = static_cast<uint32_t>(streamingTexture.mipLevels.size());
+		uint64_t uploadedSize = 0;
+		while (streamingTexture.uploadedLevelsCount < levelsCount)
+		{
+			const auto level = levelsCount - 1 - streamingTexture.uploadedLevelsCount;
+			const auto &levelLayout = streamingTexture.mipLevels[level];
+			if (uploadedSize > 0 && uploadedSize + levelLayout.getSize() > sizeBudget)
+			{
+				break;
+			}
+			// The level replaces the one of the placeholder (if any), read from its offset in the bound pixel buffer object.
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, levelLayout.width, levelLayout.height, 0, GL_BGR, GL_UNSIGNED_BYTE, reinterpret_cast<const void *>(levelLayout.offset));
+			uploadedSize += levelLayout.getSize();
+			streamingTexture.uploadedLevelsCount++;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelsCount - streamingTexture.uploadedLevelsCount);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelsCount - 1);
+		GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return streamingTexture.uploadedLevelsCount == levelsCount;
+	}
+
+	/**
+	 * Finish streaming the given texture, uploading the image data from its pixel buffer object into the texture if requested.
+	 * Waits for the read task if it is still running.
+	 * 
+	 * @param textureName        The name of the texture.
+	 * @param streamingTexture   The streaming texture.
+	 * @param isUploadRequested  Whether to upload the image data, or just release the pixel buffer object.
+	 */
+	void finishStreamingTexture(const std::string &textureName, StreamingTexture &streamingTexture, const bool &isUploadRequested)
+	{
+		STARTUP_PHASE("Texture Upload", textureName);
+		if (streamingTexture.upload != nullptr)
+		{
+			finishContextUpload(textureName, streamingTexture, isUploadRequested);
+			return;
+		}
+
+		// Wait for the read task, and unmap the pixel buffer object.
+		const auto isReadSuccessful = unmapPixelBuffer(streamingTexture);
+
+		if (isUploadRequested)
+		{
+			// Check if the image data is all there.
+			if (!isReadSuccessful)
+			{
+				// Could not read the BMP file. Time to crash.
+				std::cout << textureName << std::endl
+									<< "Failed at texture 2" << std::endl;
+				exit(1);
+			}
+
+			if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+			{
+				// Take a layer of a texture array for the full image first (with no pixel buffer object bound, since the storage of the
+				//   array is specified without any data).
+				uint32_t levelsCount = 1;
+				while ((std::max(streamingTexture.width, streamingTexture.height) >> levelsCount) > 0)
+				{
+					levelsCount++;
+				}
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				uint32_t textureLayer;
+				const auto &textureArray = acquireTextureLayer(textureName, GL_RGB8, 0, streamingTexture.width, streamingTexture.height, levelsCount, textureLayer);
+
+				// Replace the placeholder with the full image in the layer, read straight from the pixel buffer object.
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingTexture.pixelBufferId);
+				GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureId);
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, textureLayer, streamingTexture.width, streamingTexture.height, 1, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+				if (streamingTexture.mipLevels.empty())
+				{
+					// Generate mip-maps for the array, which generates the same ones again for the other layers.
+					glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+				}
+				else
+				{
+					// Upload the generated mip levels into the layer alone.
+					for (uint32_t level = 1; level < streamingTexture.mipLevels.size(); level++)
+					{
+						const auto &levelLayout = streamingTexture.mipLevels[level];
+						glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, textureLayer, levelLayout.width, levelLayout.height, 1, GL_BGR, GL_UNSIGNED_BYTE, reinterpret_cast<const void *>(levelLayout.offset));
+					}
+				}
+				GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+				auto &textureDetails = *namedTextures.at(nameInterner.intern(textureName));
+				textureDetails.textureId = textureArray.textureId;
+				textureDetails.textureLayer = textureLayer;
+			}
+			else if (!streamingTexture.mipLevels.empty())
+			{
+				// Upload the generated mip levels left.
+				uploadMipLevels(textureName, streamingTexture, std::numeric_limits<uint64_t>::max());
+			}
+			else
+			{
+				// Replace the placeholder with the full image, read straight from the bound pixel buffer object.
+				GlCalls::bindTexture(GL_TEXTURE_2D, streamingTexture.textureId);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, streamingTexture.width, streamingTexture.height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+				// Generate mip-maps for the texture.
+				glGenerateMipmap(GL_TEXTURE_2D);
+				GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+			}
+		}
+
+		// Retire the pixel buffer object now that we're done, since the upload may still be reading from it.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		gpuDeletionQueue.retireBuffer(streamingTexture.pixelBufferId);
+		gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, streamingTexture.pixelBufferId);
+	}
+
+	/**
+	 * Create sparse storage for the mip chain, if sparse textures are supported for its format and size. The levels are then
+	 *   resident only where their pages are committed.
+	 * 
+	 * @param mipChain  The mip chain, whose texture is bound.
+	 * 
+	 * @return Whether the storage was created, with the number of levels that can be committed separately set.
+	 */
+	static bool createSparseStorage(StreamedMipChain &mipChain)
+	{
+		// Check if the format has a page size that the largest level is made of whole pages of.
+		GLint pageSizesCount = 0;
+		if (!GLEW_ARB_sparse_texture)
+		{
+			return false;
+		}
+		glGetInternalformativ(GL_TEXTURE_2D, mipChain.internalFormat, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &pageSizesCount);
+		if (pageSizesCount <= 0)
+		{
+			return false;
+		}
+		GLint pageWidth = 0, pageHeight = 0;
+		glGetInternalformativ(GL_TEXTURE_2D, mipChain.internalFormat, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth);
+		glGetInternalformativ(GL_TEXTURE_2D, mipChain.internalFormat, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight);
+		if (pageWidth <= 0 || pageHeight <= 0 || mipChain.width % pageWidth != 0 || mipChain.height % pageHeight != 0)
+		{
+			return false;
+		}
+
+		// Create the storage for all the levels without committing any memory, and find where the mip tail starts.
+		const auto levelsCount = static_cast<GLsizei>(mipChain.levelOffsets.size());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+		glTexParameteri(GL_TEXTURE_2D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+		glTexStorage2D(GL_TEXTURE_2D, levelsCount, mipChain.internalFormat, mipChain.width, mipChain.height);
+		GLint sparseLevelsCount = 0;
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevelsCount);
+		mipChain.sparseLevelsCount = static_cast<uint32_t>(std::max(sparseLevelsCount, 0));
+		return true;
+	}
+
+	/**
+	 * Upload a mip level of the chain from its file, committing its pages first if it has sparse storage.
+	 * 
+	 * @param mipChain  The mip chain, whose texture is bound.
+	 * @param level     The level to upload.
+	 */
+	static void uploadMipLevel(const StreamedMipChain &mipChain, const uint32_t &level)
+	{
+		const auto levelWidth = std::max(mipChain.width >> level, 1u);
+		const auto levelHeight = std::max(mipChain.height >> level, 1u);
+		const auto levelData = mipChain.file->getData() + mipChain.levelOffsets[level];
+		if (!mipChain.isSparse)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, mipChain.internalFormat, levelWidth, levelHeight, 0, mipChain.levelSizes[level], levelData);
+			return;
+		}
+		if (level < mipChain.sparseLevelsCount && level < mipChain.floorLevel)
+		{
+			glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, levelWidth, levelHeight, 1, GL_TRUE);
+		}
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight, mipChain.internalFormat, mipChain.levelSizes[level], levelData);
+	}
+
+	/**
+	 * Free the memory of a mip level of the chain, by uncommitting its pages or specifying it again as empty.
+	 * 
+	 * @param mipChain  The mip chain, whose texture is bound.
+	 * @param level     The level to free, which has to be above the base level.
+	 */
+	static void freeMipLevel(const StreamedMipChain &mipChain, const uint32_t &level)
+	{
+		if (mipChain.isSparse)
+		{
+			glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, std::max(mipChain.width >> level, 1u), std::max(mipChain.height >> level, 1u), 1, GL_FALSE);
+			return;
+		}
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, 0, 0, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	/**
+	 * Get the size of the resident mip levels of the chain in GPU memory.
+	 * 
+	 * @param mipChain  The mip chain.
+	 * 
+	 * @return The size of the levels from the base level to the smallest one (in bytes).
+	 */
+	static uint64_t getResidentSize(const StreamedMipChain &mipChain)
+	{
+		uint64_t residentSize = 0;
+		for (auto level = mipChain.baseLevel; level < mipChain.levelSizes.size(); level++)
+		{
+			residentSize += mipChain.levelSizes[level];
+		}
+		return residentSize;
+	}
+
+	/**
+	 * Move the base level of the mip chain, uploading the level below the base or freeing the base level, and account the change.
+	 * 
+	 * @param textureName  The name of the texture.
+	 * @param mipChain     The mip chain.
+	 * @param isRaised     Whether to upload the next larger level, or to free the largest resident one.
+	 */
+	void moveBaseLevel(const std::string &textureName, StreamedMipChain &mipChain, const bool &isRaised)
+	{
+		GlCalls::bindTexture(GL_TEXTURE_2D, mipChain.textureId);
+		streamedMipsSize -= getResidentSize(mipChain);
+		if (isRaised)
+		{
+			// Upload the level before sampling from it.
+			uploadMipLevel(mipChain, mipChain.baseLevel - 1);
+			mipChain.baseLevel--;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mipChain.baseLevel);
+		}
+		else
+		{
+			// Stop sampling from the level before freeing it.
+			mipChain.baseLevel++;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mipChain.baseLevel);
+			freeMipLevel(mipChain, mipChain.baseLevel - 1);
+			mipChain.neededUpdate = mipStreamingUpdate;
+		}
+		GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+		const auto residentSize = getResidentSize(mipChain);
+		streamedMipsSize += residentSize;
+		gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, mipChain.textureId, GpuMemoryCategory::TEXTURE, textureName, residentSize);
+	}
+
+	/**
+	 * Update the mip levels of the streamed textures by the texels requested since the last update. The top levels that went
+	 *   unneeded for a while are dropped, as are the levels needed the least while over the budget, and the level furthest from
+	 *   the one requested is uploaded if it fits the budget. Only one level is uploaded per update, so that the upload costs are
+	 *   spread over multiple frames.
+	 */
+	void updateStreamedMipLevels()
+	{
+		mipStreamingUpdate++;
+		for (auto &mipChain : streamedMipChains)
+		{
+			// Find the largest level whose largest side still has the requested texels (not drawn textures need only the floor level).
+			auto &chain = *mipChain.second;
+			if (chain.requestedTexels > 0.0f)
+			{
+				const auto levelsBelow = std::log2(static_cast<float_t>(std::max(chain.width, chain.height)) / chain.requestedTexels);
+				chain.requestedLevel = static_cast<uint32_t>(std::clamp(std::floor(levelsBelow), 0.0f, static_cast<float_t>(chain.floorLevel)));
+				chain.requestedTexels = 0.0f;
+			}
+			else
+			{
+				chain.requestedLevel = chain.floorLevel;
+			}
+			if (chain.requestedLevel <= chain.baseLevel)
+			{
+				chain.neededUpdate = mipStreamingUpdate;
+			}
+		}
+
+		// Drop the top levels that have not been needed for a while.
+		for (auto &mipChain : streamedMipChains)
+		{
+			if (mipChain.second->baseLevel < mipChain.second->requestedLevel && mipStreamingUpdate - mipChain.second->neededUpdate > TEXTURE_STREAMING_DROP_DELAY)
+			{
+				moveBaseLevel(mipChain.first, *mipChain.second, false);
+			}
+		}
+
+		// While over the budget, drop the top level of the texture furthest above its requested level, or the largest one if all
+		//   of them have only the levels requested.
+		while (streamedMipsSize > TEXTURE_STREAMING_BUDGET)
+		{
+			auto droppedMipChain = streamedMipChains.end();
+			for (auto mipChain = streamedMipChains.begin(); mipChain != streamedMipChains.end(); mipChain++)
+			{
+				const auto &chain = *mipChain->second;
+				if (chain.baseLevel >= chain.floorLevel)
+				{
+					continue;
+				}
+				if (droppedMipChain == streamedMipChains.end())
+				{
+					droppedMipChain = mipChain;
+					continue;
+				}
+				const auto &dropped = *droppedMipChain->second;
+				const auto excess = static_cast<int32_t>(chain.requestedLevel) - static_cast<int32_t>(chain.baseLevel);
+				const auto droppedExcess = static_cast<int32_t>(dropped.requestedLevel) - static_cast<int32_t>(dropped.baseLevel);
+				if (excess > droppedExcess || (excess == droppedExcess && chain.levelSizes[chain.baseLevel] > dropped.levelSizes[dropped.baseLevel]))
+				{
+					droppedMipChain = mipChain;
+				}
+			}
+			if (droppedMipChain == streamedMipChains.end())
+			{
+				break;
+			}
+			moveBaseLevel(droppedMipChain->first, *droppedMipChain->second, false);
+		}
+
+		// Upload the next level of the texture furthest below its requested level, if it fits the budget.
+		auto raisedMipChain = streamedMipChains.end();
+		for (auto mipChain = streamedMipChains.begin(); mipChain != streamedMipChains.end(); mipChain++)
+		{
+			const auto &chain = *mipChain->second;
+			if (chain.baseLevel > chain.requestedLevel && (raisedMipChain == streamedMipChains.end() ||
+																										 chain.baseLevel - chain.requestedLevel > raisedMipChain->second->baseLevel - raisedMipChain->second->requestedLevel))
+			{
+				raisedMipChain = mipChain;
+			}
+		}
+		if (raisedMipChain != streamedMipChains.end() &&
+				streamedMipsSize + raisedMipChain->second->levelSizes[raisedMipChain->second->baseLevel - 1] <= TEXTURE_STREAMING_BUDGET)
+		{
+			moveBaseLevel(raisedMipChain->first, *raisedMipChain->second, true);
+		}
+	}
+
+	/**
+	 * Load the DDS image and create a block-compressed texture for it, uploading its prebuilt mip chain straight from the file mapping.
+	 * Supports BC1 (DXT1), BC3 (DXT5) and BC7 (through the DX10 header). Since block-compressed data cannot be flipped cheaply,
+	 *   the image has to be stored with the bottom row first like the BMP images (i.e. flipped vertically when exported).
+	 * Only the levels up to the initial size are uploaded at first, and the larger ones are streamed by updateStreamingTextures
+	 *   once the models drawn with the texture need them, using sparse storage if it is supported. The batched textures are
+	 *   uploaded whole into a layer of a texture array instead.
+	 * 
+	 * @param textureName      The name of the texture being loaded.
+	 * @param textureFilePath  The file path to the texture data.
+	 * @param outTextureSize   The output variable for the size of the texture in GPU memory (with all of its levels resident).
+	 * @param outTextureLayer  The output variable for the layer of the texture array containing the texture (0 if not batched).
+	 * 
+	 * @return The ID of the texture (or of the texture array containing it).
+	 */
+	GLuint loadDdsTexture(const std::string &textureName, const std::string &textureFilePath, uint64_t &outTextureSize, uint32_t &outTextureLayer)
+	{
+		// Map the DDS file into memory.
+		auto file = std::make_unique<AssetFile>(textureFilePath);
+		// Check if the file is accessible, and large enough to contain the header.
+		if (!file->isMapped() || file->getSize() < DDS_HEADER_SIZE)
+		{
+			// Could not read the DDS file. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 6" << std::endl;
+			exit(1);
+		}
+		const auto fileData = file->getData();
+
+		// Check if the file starts with the "DDS " magic number.
+		if (memcmp(fileData, "DDS ", 4) != 0)
+		{
+			// Invalid file. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 7" << std::endl;
+			exit(1);
+		}
+
+		// Grab the DDS metadata information.
+		uint32_t height, width, mipMapCount, fourCc;
+		memcpy(&height, &fileData[0x0C], sizeof(uint32_t));
+		memcpy(&width, &fileData[0x10], sizeof(uint32_t));
+		memcpy(&mipMapCount, &fileData[0x1C], sizeof(uint32_t));
+		memcpy(&fourCc, &fileData[0x54], sizeof(uint32_t));
+		// Files without the mip map count flag contain only the full sized image.
+		mipMapCount = std::max(mipMapCount, 1u);
+
+		// Find the GL format and block size of the compression format.
+		GLenum internalFormat;
+		uint32_t blockSize;
+		uint32_t dataPos = DDS_HEADER_SIZE;
+		uint32_t dxgiFormat = 0;
+		if (memcmp(&fourCc, "DX10", 4) == 0)
+		{
+			// The format is defined by the DX10 header right after the DDS header.
+			if (file->getSize() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+			{
+				// Invalid file. Time to crash.
+				std::cout << textureName << std::endl
+									<< "Failed at texture 7" << std::endl;
+				exit(1);
+			}
+			memcpy(&dxgiFormat, &fileData[DDS_HEADER_SIZE], sizeof(uint32_t));
+			dataPos += DDS_DX10_HEADER_SIZE;
+		}
+		if (memcmp(&fourCc, "DXT1", 4) == 0 || dxgiFormat == DXGI_FORMAT_BC1_UNORM)
+		{
+			internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			blockSize = 8;
+		}
+		else if (memcmp(&fourCc, "DXT5", 4) == 0 || dxgiFormat == DXGI_FORMAT_BC3_UNORM)
+		{
+			internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			blockSize = 16;
+		}
+		else if (dxgiFormat == DXGI_FORMAT_BC7_UNORM)
+		{
+			internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+			blockSize = 16;
+		}
+		else
+		{
+			// Cannot support compression format. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 8" << std::endl;
+			exit(1);
+		}
+
+		// Find the mip levels of the chain, which are stored one after another from the largest to the smallest.
+		std::vector<size_t> levelOffsets;
+		std::vector<uint32_t> levelSizes;
+		outTextureSize = 0;
+		for (uint32_t levelWidth = width, levelHeight = height; levelOffsets.size() < mipMapCount && (levelWidth > 0 || levelHeight > 0); levelWidth /= 2, levelHeight /= 2)
+		{
+			// Each block covers 4x4 pixels, and partial blocks at the edges are stored whole.
+			const auto levelSize = getCompressedLevelSize(levelWidth, levelHeight, blockSize);
+			if (dataPos + static_cast<uint64_t>(levelSize) > file->getSize())
+			{
+				// The file is missing some of the data. Time to crash.
+				std::cout << textureName << std::endl
+									<< "Failed at texture 9" << std::endl;
+				exit(1);
+			}
+			levelOffsets.push_back(dataPos);
+			levelSizes.push_back(levelSize);
+			dataPos += levelSize;
+			outTextureSize += levelSize;
+		}
+		const auto levelsCount = static_cast<uint32_t>(levelOffsets.size());
+
+		// Clear any earlier errors, so that an unsupported compression format can be detected after the upload.
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+
+		// Upload all the levels into a layer of a shared texture array instead, for the batched textures.
+		if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+		{
+			const auto &textureArray = acquireTextureLayer(textureName, internalFormat, blockSize, width, height, levelsCount, outTextureLayer);
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureId);
+			for (uint32_t level = 0; level < levelsCount; level++)
+			{
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, outTextureLayer, std::max(width >> level, 1u), std::max(height >> level, 1u), 1, internalFormat, levelSizes[level], &fileData[levelOffsets[level]]);
+			}
+			GlCalls::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			if (glGetError() == GL_INVALID_ENUM)
+			{
+				// Cannot support compression format. Time to crash.
+				std::cout << textureName << std::endl
+									<< "Failed at texture 8" << std::endl;
+				exit(1);
+			}
+			return textureArray.textureId;
+		}
+		outTextureLayer = 0;
+
+		// Define a variable for storing the texture ID.
+		GLuint textureId;
+		// Create a new texture and store the ID.
+		glGenTextures(1, &textureId);
+		// Bind the texture as a 2D texture.
+		GlCalls::bindTexture(GL_TEXTURE_2D, textureId);
+
+		// Start with the largest level that fits the initial size, and stream the larger ones once the models need them.
+		auto mipChain = std::make_unique<StreamedMipChain>();
+		mipChain->textureId = textureId;
+		mipChain->file = std::move(file);
+		mipChain->internalFormat = internalFormat;
+		mipChain->width = width;
+		mipChain->height = height;
+		mipChain->levelOffsets = std::move(levelOffsets);
+		mipChain->levelSizes = std::move(levelSizes);
+		mipChain->floorLevel = 0;
+		while (mipChain->floorLevel + 1 < levelsCount && (std::max(width, height) >> mipChain->floorLevel) > TEXTURE_STREAMING_INITIAL_SIZE)
+		{
+			mipChain->floorLevel++;
+		}
+		mipChain->isSparse = mipChain->floorLevel > 0 && createSparseStorage(*mipChain);
+		if (mipChain->isSparse)
+		{
+			// Commit the mip tail along with the levels up to the floor level, which are never uncommitted.
+			mipChain->floorLevel = std::min(mipChain->floorLevel, mipChain->sparseLevelsCount);
+			for (auto level = mipChain->floorLevel; level < std::min(mipChain->sparseLevelsCount + 1, levelsCount); level++)
+			{
+				glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, std::max(width >> level, 1u), std::max(height >> level, 1u), 1, GL_TRUE);
+			}
+		}
+		for (auto level = mipChain->floorLevel; level < levelsCount; level++)
+		{
+			uploadMipLevel(*mipChain, level);
+		}
+		mipChain->baseLevel = mipChain->floorLevel;
+		mipChain->requestedLevel = mipChain->floorLevel;
+		mipChain->requestedTexels = 0.0f;
+		mipChain->neededUpdate = mipStreamingUpdate;
+
+		// Check if the GPU supports the compression format.
+		if (glGetError() == GL_INVALID_ENUM)
+		{
+			// Cannot support compression format. Time to crash.
+			std::cout << textureName << std::endl
+								<< "Failed at texture 8" << std::endl;
+			exit(1);
+		}
+
+		// Provide parameters for behaviour when reading coordinates that are out-of-bounds,
+		//   as well as algorithms to use for maginifcation and minification.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelsCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		// Only sample the resident mip levels stored in the file, since mip-maps cannot be generated for compressed textures.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mipChain->baseLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelsCount - 1);
+
+		// Keep the file mapped to stream the larger levels from, if there are any.
+		if (mipChain->floorLevel > 0)
+		{
+			streamedMipsSize += getResidentSize(*mipChain);
+			streamedMipChains[textureName] = std::move(mipChain);
+		}
+
+		// Unbind the texture now that we're done.
+		GlCalls::bindTexture(GL_TEXTURE_2D, 0);
+
+		// Return the ID of the created texture.
+		return textureId;
+	}
+
+	/**
+	 * Delete the texture with the given name, and remove it from the created textures.
+	 * 
+	 * @param textureName  The name of the texture to delete.
+	 */
+	void deleteTexture(const std::string textureName)
+	{
+		const auto textureNameId = nameInterner.intern(textureName);
+		const auto textureDetails = namedTextures.at(textureNameId);
+		// Remove the texture from the created textures, along with its reference count.
+		namedTextures.erase(textureNameId);
+		// Stop streaming the texture if its image data is still being read.
+		const auto streamingTexture = streamingTextures.find(textureName);
+		if (streamingTexture != streamingTextures.end())
+		{
+			finishStreamingTexture(streamingTexture->first, *streamingTexture->second, false);
+			streamingTextures.erase(streamingTexture);
+		}
+		// Stop streaming the mip levels of the texture.
+		const auto streamedMipChain = streamedMipChains.find(textureName);
+		if (streamedMipChain != streamedMipChains.end())
+		{
+			streamedMipsSize -= getResidentSize(*streamedMipChain->second);
+			streamedMipChains.erase(streamedMipChain);
+		}
+		// Free the layer of the texture array containing the texture data, or delete the texture containing it.
+		if (IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+		{
+			releaseTextureLayer(textureName);
+			return;
+		}
+		gpuDeletionQueue.retireTexture(textureDetails->textureId);
+		gpuMemoryManager.recordRelease(GpuResourceType::TEXTURE, textureDetails->textureId);
+	}
+
+	TextureManager()
+			: jobManager(JobManager::getInstance()),
+				uploadContextManager(UploadContextManager::getInstance()),
+				gpuMemoryManager(GpuMemoryManager::getInstance()),
+				glDebugManager(GlDebugManager::getInstance()),
+				gpuDeletionQueue(GpuDeletionQueue::getInstance()),
+				assetManifest(AssetManifest::getInstance()),
+				nameInterner(NameInterner::getInstance()),
+				namedTextures(),
+				streamingTextures(),
+				streamedMipChains(),
+				streamedMipsSize(0),
+				mipStreamingUpdate(0),
+				textureArrays(),
+				placeholderArrayId(0),
+				residencyCache(TEXTURE_RESIDENCY_BUDGET) {}
+
+	~TextureManager()
+	{
+		// Wait for any read task or upload still running, since its buffer or texture is about to go away with the GL context.
+		for (auto &streamingTexture : streamingTextures)
+		{
+			if (streamingTexture.second->upload != nullptr)
+			{
+				uploadContextManager.waitForUpload(*streamingTexture.second->upload);
+				continue;
+			}
+			jobManager.waitForTask(streamingTexture.second->readTask);
+		}
+	}
+
+public:
+	// Preventing copying the texture manager, making sure only one instance can exist.
+	TextureManager(const TextureManager &) = delete;
+
+	/**
+	 * Read and check the header of the BMP image.
+	 * 
+	 * @param textureName      The name of the texture being loaded.
+	 * @param textureFilePath  The file path to the texture data.
+	 * @param outDataPos       The output variable for the position of the image data in the file.
+	 * @param outImageSize     The output variable for the size of the image data.
+	 * @param outWidth         The output variable for the width of the image.
+	 * @param outHeight        The output variable for the height of the image.
+	 */
+	static void readBmpHeader(const std::string &textureName, const std::string &textureFilePath, uint32_t &outDataPos, uint32_t &outImageSize, uint32_t &outWidth, uint32_t &outHeight)
 	{
 		// Define vectors for storing the BMP metadata information.
 		unsigned char header[54];
-		uint32_t dataPos;
-		uint32_t imageSize;
-		uint32_t width, height;
 
-		// Open the BMP file.
-		const auto file = fopen(textureFilePath.c_str(), "rb");
+		// Open the BMP file (or find it in the asset archive).
+		const AssetFile file(textureFilePath);
 		// Check if the file is accessible.
-		if (!file)
+		if (!file.isMapped())
 		{
 			// Could not read the BMP file. Time to crash.
 			std::cout << textureName << std::endl
@@ -132,22 +1309,19 @@ private:
 			exit(1);
 		}
 
-		// Read the first 54 bytes of the file (contains the BMP header).
-		const auto readBytes = fread(header, 1, 54, file);
-		// Check if we managed to read the first 54 bytes.
-		if (readBytes != 54)
+		// Check if the file has the first 54 bytes (contains the BMP header), and copy them.
+		if (file.getSize() < 54)
 		{
 			// Could not read the BMP file. Time to crash.
-			fclose(file);
 			std::cout << textureName << std::endl
 								<< "Failed at texture 2" << std::endl;
 			exit(1);
 		}
+		memcpy(header, file.getData(), 54);
 		// Check if the first two characters of the header start with "BM".
 		if (header[0] != 'B' || header[1] != 'M')
 		{
 			// Invalid file. Time to crash.
-			fclose(file);
 			std::cout << textureName << std::endl
 								<< "Failed at texture 3" << std::endl;
 			exit(1);
@@ -156,7 +1330,6 @@ private:
 		if (*(int32_t *)&(header[0x1C]) != 24)
 		{
 			// Cannot support color format. Time to crash.
-			fclose(file);
 			std::cout << textureName << std::endl
 								<< "Failed at texture 4" << std::endl;
 			exit(1);
@@ -165,92 +1338,163 @@ private:
 		if (*(int32_t *)&(header[0x1E]) != 0)
 		{
 			// Cannot support compressed BMPs. Time to crash.
-			fclose(file);
 			std::cout << textureName << std::endl
 								<< "Failed at texture 5" << std::endl;
 			exit(1);
 		}
 
 		// Grab the BMP metadata information
-		dataPos = *(int32_t *)&(header[0x0A]);
-		imageSize = *(int32_t *)&(header[0x22]);
-		width = *(int32_t *)&(header[0x12]);
-		height = *(int32_t *)&(header[0x16]);
+		outDataPos = *(int32_t *)&(header[0x0A]);
+		outImageSize = *(int32_t *)&(header[0x22]);
+		outWidth = *(int32_t *)&(header[0x12]);
+		outHeight = *(int32_t *)&(header[0x16]);
 
 		// Some BMP files can be misformatted, so guess missing information.
-		if (imageSize == 0)
+		if (outImageSize == 0)
 		{
 			// Image size would be width times height. But since each pixel contains 3 bytes of information
 			//   (one per color channel), multiply that result by 3.
-			imageSize = width * height * 3;
+			outImageSize = outWidth * outHeight * 3;
 		}
-		if (dataPos == 0)
+		if (outDataPos == 0)
 		{
 			// Data should start right after the BMP header, which is located at the start of the file and is 54 bytes in size.
 			// So read from that point after.
-			dataPos = 54;
+			outDataPos = 54;
 		}
+	}
 
-		// Create a buffer for storing the texture RBG data.
-		const auto textureData = new unsigned char[imageSize];
-
-		// Read the texture data from the file and store into the buffer.
-		fread(textureData, 1, imageSize, file);
-
-		// Close the file now that we're done reading it.
-		fclose(file);
-
-		// Create the 2D texture and store the texture data there.
-		const auto textureId = create2dTexture(textureData, width, height);
-
-		// Delete the texture data file we're storing since we no longer need it.
-		delete[] textureData;
+	/**
+	 * Read the image data of a BMP file into the given memory. Runs in the read task of a streaming texture.
+	 * 
+	 * @param textureFilePath   The file path to the texture data.
+	 * @param dataPos           The position of the image data in the file.
+	 * @param imageSize         The size of the image data.
+	 * @param textureData       The memory to read the image data into (the mapped pixel buffer object).
+	 * @param chainData         The memory to read the image data into as well, sized for the mip chain generated from it (null if
+	 *                            the mip-maps are generated by the driver).
+	 * @param chainSize         The size of the mip chain.
+	 * @param streamingTexture  The streaming texture to set whether the data was read of.
+	 */
+	static void readBmpData(const std::string textureFilePath, const uint32_t dataPos, const uint64_t imageSize, unsigned char *const textureData,
+													std::vector<unsigned char> *const chainData, const uint64_t chainSize, StreamingTexture *const streamingTexture)
+	{
+		STARTUP_PHASE("Texture Read", textureFilePath);
+		// Open the BMP file (or find it in the asset archive), and copy the image data from its position.
+		const AssetFile file(textureFilePath);
+		const auto isReadSuccessful = file.isMapped() && static_cast<uint64_t>(dataPos) + imageSize <= file.getSize();
+		if (isReadSuccessful)
+		{
+			memcpy(textureData, file.getData() + dataPos, imageSize);
+		}
+		if (chainData != nullptr)
+		{
+			// The mip levels are generated from a copy in system memory, since the mapped pixel buffer object is only written to.
+			chainData->resize(chainSize);
+			if (isReadSuccessful)
+			{
+				memcpy(chainData->data(), file.getData() + dataPos, imageSize);
+			}
+		}
 
-		// Return the ID of the created texture.
-		return textureId;
+		streamingTexture->isReadSuccessful = isReadSuccessful;
 	}
 
-	TextureManager()
-			: namedTextures({}),
-				namedTextureReferences({}) {}
+	/**
+	 * Read the image data of a BMP file straight into a new texture, generating its mip-maps. Runs on the upload thread, with the
+	 *   upload context current (so the state cache of the GL calls is not used).
+	 * 
+	 * @param textureFilePath   The file path to the texture data.
+	 * @param dataPos           The position of the image data in the file.
+	 * @param imageSize         The size of the image data.
+	 * @param streamingTexture  The streaming texture to set the uploaded texture of.
+	 */
+	static void uploadBmpData(const std::string textureFilePath, const uint32_t dataPos, const uint32_t imageSize, StreamingTexture *const streamingTexture)
+	{
+		STARTUP_PHASE("Texture Context Upload", textureFilePath);
+		// Open the BMP file (or find it in the asset archive), and upload the image data from its position.
+		const AssetFile file(textureFilePath);
+		streamingTexture->isReadSuccessful = file.isMapped() && static_cast<uint64_t>(dataPos) + imageSize <= file.getSize();
+		if (!streamingTexture->isReadSuccessful)
+		{
+			return;
+		}
 
-public:
-	// Preventing copying the texture manager, making sure only one instance can exist.
-	TextureManager(const TextureManager &) = delete;
+		// Create the texture the same way as the placeholder, with the full image.
+		glGenTextures(1, &streamingTexture->uploadedTextureId);
+		glBindTexture(GL_TEXTURE_2D, streamingTexture->uploadedTextureId);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, streamingTexture->width, streamingTexture->height, 0, GL_BGR, GL_UNSIGNED_BYTE, file.getData() + dataPos);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 
 	/**
 	 * Load and create an texture from the given texture file path. If an texture with the same name was already created,
-	 * return the same texture.
+	 * return the same texture. Block-compressed DDS files are loaded with their prebuilt mip chains, and any other file is loaded as a BMP
+	 * in the background (showing a placeholder until updateStreamingTextures uploads it). A texture cooked by the asset cook is loaded
+	 * instead of its source file, as long as the source has not changed since. The textures of the same format and size share
+	 * texture arrays if they are batched.
 	 * 
 	 * @param textureName      The name of the texture.
 	 * @param textureFilePath  The file path to the texture data.
 	 * 
 	 * @return The details of the loaded texture.
 	 */
-	const std::shared_ptr<const TextureDetails> &create2dTexture(const std::string &textureName, const std::string &textureFilePath)
+	std::shared_ptr<const TextureDetails> create2dTexture(const std::string &textureName, const std::string &textureFilePath)
 	{
 		// Check if an texture with the name already exists.
-		const auto existingTexture = namedTextures.find(textureName);
-		if (existingTexture != namedTextures.end())
+		const auto textureNameId = nameInterner.intern(textureName);
+		const auto existingTexture = namedTextures.find(textureNameId);
+		if (existingTexture != nullptr)
 		{
-			// Texture already loaded. Increase its reference count and return it.
-			namedTextureReferences[textureName]++;
-			return existingTexture->second;
+			// Texture already loaded. Take it out of the residency cache if it had no references, increase its reference count and return it.
+			residencyCache.acquire(textureName);
+			namedTextures.addReference(textureNameId);
+			return existingTexture;
 		}
 
-		// Load the BMP image file and store its details.
-		const GLuint textureId = loadBmpTexture(textureName, textureFilePath);
+		// Load the cooked texture if there is one, or the image file based on its extension otherwise, and store its details.
+		uint64_t textureSize;
+		uint32_t textureLayer = 0;
+		const auto cookedFilePath = assetManifest.findCookedAsset(textureFilePath);
+		const auto &loadedFilePath = cookedFilePath.empty() ? textureFilePath : cookedFilePath;
+		const GLuint textureId = hasFileExtension(loadedFilePath, ".dds") ? loadDdsTexture(textureName, loadedFilePath, textureSize, textureLayer) : loadBmpTexture(textureName, loadedFilePath, textureSize);
+		// The memory of the batched textures is accounted and labeled with their texture arrays.
+		if (!IS_TEXTURE_ARRAY_BATCHING_ENABLED)
+		{
+			// Account the memory of the texture (at its full size even while a placeholder is shown, but only the resident levels of
+			//   a streamed mip chain).
+			const auto streamedMipChain = streamedMipChains.find(textureName);
+			const auto residentSize = streamedMipChain != streamedMipChains.end() ? getResidentSize(*streamedMipChain->second) : textureSize;
+			gpuMemoryManager.recordAllocation(GpuResourceType::TEXTURE, textureId, GpuMemoryCategory::TEXTURE, textureName, residentSize);
+			// Label the texture with its name.
+			glDebugManager.labelObject(GL_TEXTURE, textureId, textureName);
+		}
 
 		// Create a new texture details with the captured data.
-		const auto newTexture = std::make_shared<const TextureDetails>(textureId, textureName, textureFilePath);
+		const auto newTexture = std::make_shared<TextureDetails>(textureId, textureLayer, textureName, textureFilePath, textureSize);
 
-		// Insert the newly created texture into the map of created textures.
-		namedTextures.insert(std::make_pair(textureName, newTexture));
-		// Set the reference count of the texture to 1.
-		namedTextureReferences[textureName] = 1;
+		// Register the newly created texture with a reference count of 1.
+		namedTextures.insert(textureNameId, newTexture);
 
 		// Return the texture details.
-		return namedTextures[textureName];
+		return newTexture;
+	}
+
+	/**
+	 * Check if the texture with the given name is created, whether it is referenced or only kept in the residency cache.
+	 * 
+	 * @param textureName  The name of the texture.
+	 * 
+	 * @return Whether the texture is created or not.
+	 */
+	bool isTextureCreated(const std::string &textureName) const
+	{
+		return namedTextures.contains(nameInterner.intern(textureName));
 	}
 
 	/**
@@ -260,9 +1504,9 @@ public:
    * 
    * @return The texture created with the given name.
    */
-	const std::shared_ptr<const TextureDetails> &getTextureDetails(const std::string &textureName) const
+	std::shared_ptr<const TextureDetails> getTextureDetails(const std::string &textureName) const
 	{
-		return namedTextures.at(textureName);
+		return namedTextures.at(nameInterner.intern(textureName));
 	}
 
 	/**
@@ -272,21 +1516,81 @@ public:
 	 */
 	void destroyTexture(const std::shared_ptr<const TextureDetails> &textureDetails)
 	{
-		// Reduce the reference count of the texture.
-		namedTextureReferences[textureDetails->getTextureName()]--;
-		// Check if there are no more references to the texture.
-		if (namedTextureReferences[textureDetails->getTextureName()] <= 0)
+		// Reduce the reference count of the texture, and check if there are no more references to it.
+		if (namedTextures.removeReference(nameInterner.intern(textureDetails->getTextureName())) <= 0)
 		{
-			// No more references left, so time to clean.
-			// Remove the texture from the created textures references map.
-			namedTextureReferences.erase(textureDetails->getTextureName());
-			// Remove the texture from the created textures map.
-			namedTextures.erase(textureDetails->getTextureName());
-			// Delete the texture containing the texture data.
-			glDeleteTextures(1, &textureDetails->textureId);
+			// No more references left, so keep it in the residency cache, and clean the textures that do not fit the budget anymore.
+			for (const auto &evictedTextureName : residencyCache.release(textureDetails->getTextureName(), textureDetails->textureSize))
+			{
+				deleteTexture(evictedTextureName);
+			}
 		}
 	}
 
+	/**
+	 * Upload the image data of a streaming texture that is done being read, replacing its placeholder, and update the mip levels
+	 *   of the streamed textures by the resolutions requested since the last call.
+	 * Only one texture (and one mip level) is uploaded per call, so that the upload costs are spread over multiple frames.
+	 */
+	void updateStreamingTextures()
+	{
+		updateStreamedMipLevels();
+		for (auto streamingTexture = streamingTextures.begin(); streamingTexture != streamingTextures.end(); streamingTexture++)
+		{
+			const auto &upload = streamingTexture->second->upload;
+			if (upload != nullptr ? uploadContextManager.isUploadDone(*upload) : streamingTexture->second->isReadDone.load(std::memory_order_acquire))
+			{
+				// Upload the generated mip levels a few at a time, from the smallest one, finishing the texture once the image is uploaded.
+				if (!IS_TEXTURE_ARRAY_BATCHING_ENABLED && !streamingTexture->second->mipLevels.empty() &&
+						!uploadMipLevels(streamingTexture->first, *streamingTexture->second, MIP_UPLOAD_BUDGET))
+				{
+					return;
+				}
+				finishStreamingTexture(streamingTexture->first, *streamingTexture->second, true);
+				streamingTextures.erase(streamingTexture);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Request the resolution that models drawn with the texture need, from the screen sizes of the models. The largest request
+	 *   since the last update decides the mip levels streamed in by the next update.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 * @param texelsCount     The texels needed along the largest side of the texture.
+	 */
+	void requestTextureResolution(const std::shared_ptr<const TextureDetails> &textureDetails, const float_t &texelsCount)
+	{
+		const auto streamedMipChain = streamedMipChains.find(textureDetails->textureName);
+		if (streamedMipChain != streamedMipChains.end())
+		{
+			streamedMipChain->second->requestedTexels = std::max(streamedMipChain->second->requestedTexels, texelsCount);
+		}
+	}
+
+	/**
+	 * Get the size of the resident mip levels of the streamed textures, which is kept within the streaming budget.
+	 * 
+	 * @return The size in GPU memory (in bytes).
+	 */
+	const uint64_t &getStreamedMipsSize() const
+	{
+		return streamedMipsSize;
+	}
+
+	/**
+	 * Check if the texture with the given name is still showing its placeholder, waiting for its image data to be uploaded.
+	 * 
+	 * @param textureName  The name of the texture.
+	 * 
+	 * @return Whether the texture is still streaming or not.
+	 */
+	bool isTextureStreaming(const std::string &textureName) const
+	{
+		return streamingTextures.find(textureName) != streamingTextures.end();
+	}
+
 	/**
    * Returns the singleton instance of the texture manager.
    * 
@@ -0,0 +1,509 @@
+#ifndef INCLUDE_THREAD_SCHEDULING_CPP
+#define INCLUDE_THREAD_SCHEDULING_CPP
+
+#include <array>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#include "constants.cpp"
+#include "command_line.cpp"
+#include "profiler.cpp"
+
+/**
+ * Enumeration of the roles of the threads, which pick their CPUs and priorities.
+ */
+enum class ThreadRole
+{
+  // The thread running main(), which runs the frames (and renders them without the render thread).
+  MAIN,
+  // The thread rendering the frames, with the render thread.
+  RENDER,
+  // The thread uploading the assets on the upload context, in the background.
+  LOADER,
+  // The worker threads of the job manager.
+  WORKER
+};
+
+/**
+ * Structure for defining how the scheduler of the OS ran a thread, sampled by the thread itself. Aligned to a cache line, so that
+ *   the threads do not slow each other down writing their statistics next to each other.
+ */
+struct alignas(64) ThreadSchedulingStats
+{
+  // Whether the thread was started (the others are never sampled).
+  std::atomic<bool> isStarted;
+  // Whether the thread is pinned to the CPUs of its role.
+  std::atomic<bool> isPinned;
+  // The logical CPU the thread was on when last sampled (-1 if the platform does not tell).
+  std::atomic<int32_t> cpu;
+  // The number of times the thread was found on another CPU than when it was sampled before.
+  std::atomic<uint32_t> migrationsCount;
+  // The number of times the thread was preempted since it started (0 if the platform does not tell).
+  std::atomic<uint64_t> preemptionsCount;
+};
+
+/**
+ * A manager class for placing the threads of the engine on the CPUs, so that the frames are not slowed down by the OS moving the
+ *   threads around or running the background ones in their place:
+ *   - The main thread (and the render thread) get the first performance cores, and a higher priority where the process may
+ *       raise it.
+ *   - The worker threads of the job manager get the cores after them, one each, for as many worker threads as cores are
+ *       reserved for the job system with the "--job-cores N" option (one for each core left otherwise).
+ *   - The loader thread gets a lower priority, and the efficiency cores of a hybrid CPU.
+ * The threads are only pinned to their CPUs with the "--pin-threads" option, since pinning is only a win while nothing else
+ *   competes for the same cores. The performance and efficiency cores are told apart where the platform exposes them (the
+ *   hybrid CPU sysfs devices on Linux, the efficiency classes of the cores on Windows), all the cores being performance ones
+ *   otherwise.
+ * Each thread applies its own placement when it starts, and samples how it was scheduled since.
+ */
+class ThreadSchedulingManager
+{
+public:
+  // The number of threads sampled (the main, render and loader threads, then the worker threads).
+  static constexpr size_t THREADS_COUNT = MAX_JOB_WORKER_THREADS + 3;
+
+private:
+  // Singleton instance of the thread scheduling manager.
+  static ThreadSchedulingManager instance;
+  // The index of the statistics of the calling thread (-1 until it applies its placement).
+  inline static thread_local int32_t currentThreadIndex = -1;
+
+  // The logical CPUs of the performance cores, and of the efficiency cores of a hybrid CPU.
+  std::vector<uint32_t> performanceCpus;
+  std::vector<uint32_t> efficiencyCpus;
+  // Whether the threads are pinned to the CPUs of their roles.
+  bool isPinningEnabled;
+  // The number of cores reserved for the job system (0 to leave the number of worker threads to the job manager).
+  uint32_t jobCoresCount;
+  // The scheduling statistics of the threads, by their indices.
+  std::array<ThreadSchedulingStats, THREADS_COUNT> threadStats;
+  // The names of the counters of the threads in the profiler captures, which have to outlive the captures.
+  std::array<std::string, THREADS_COUNT> preemptionCounterNames;
+  std::array<std::string, THREADS_COUNT> migrationCounterNames;
+
+  /**
+   * Parse a list of logical CPUs in the kernel format (e.g. "0-7,16").
+   * 
+   * @param cpuList  The list of CPUs.
+   * 
+   * @return The CPUs of the list.
+   */
+  static std::vector<uint32_t> parseCpuList(const std::string &cpuList)
+  {
+    std::vector<uint32_t> cpus({});
+    std::stringstream stream(cpuList);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+      const auto separatorIndex = range.find('-');
+      const auto first = std::strtoul(range.c_str(), nullptr, 10);
+      const auto last = separatorIndex != std::string::npos ? std::strtoul(range.c_str() + separatorIndex + 1, nullptr, 10) : first;
+      for (auto cpu = first; cpu <= last && !range.empty(); cpu++)
+      {
+        cpus.push_back(static_cast<uint32_t>(cpu));
+      }
+    }
+    return cpus;
+  }
+
+  /**
+   * Find the logical CPUs of the performance and efficiency cores.
+   */
+  void findCpus()
+  {
+#ifdef _WIN32
+    // The cores with the highest efficiency class are the performance ones (every core has class 0 on a CPU that is not hybrid).
+    DWORD bufferSize = 0;
+    GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &bufferSize);
+    std::vector<uint8_t> buffer(bufferSize);
+    const auto information = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (bufferSize > 0 && GetLogicalProcessorInformationEx(RelationProcessorCore, information, &bufferSize))
+    {
+      std::vector<std::pair<BYTE, KAFFINITY>> cores({});
+      BYTE performanceClass = 0;
+      for (DWORD offset = 0; offset < bufferSize;)
+      {
+        const auto core = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+        // Only the CPUs of the first processor group can be pinned to with an affinity mask.
+        if (core->Processor.GroupMask[0].Group == 0)
+        {
+          cores.push_back({core->Processor.EfficiencyClass, core->Processor.GroupMask[0].Mask});
+          performanceClass = std::max(performanceClass, core->Processor.EfficiencyClass);
+        }
+        offset += core->Size;
+      }
+      for (const auto &core : cores)
+      {
+        for (uint32_t cpu = 0; cpu < sizeof(KAFFINITY) * 8; cpu++)
+        {
+          if ((core.second & (static_cast<KAFFINITY>(1) << cpu)) != 0)
+          {
+            (core.first == performanceClass ? performanceCpus : efficiencyCpus).push_back(cpu);
+          }
+        }
+      }
+    }
+#elif defined(__linux__)
+    // The hybrid CPUs expose their core types as separate devices, listing their CPUs.
+    const auto readCpuList = [](const std::string &filePath) {
+      std::ifstream stream(filePath);
+      std::string cpuList;
+      std::getline(stream, cpuList);
+      return parseCpuList(cpuList);
+    };
+    performanceCpus = readCpuList("/sys/devices/cpu_core/cpus");
+    efficiencyCpus = readCpuList("/sys/devices/cpu_atom/cpus");
+    if (performanceCpus.empty())
+    {
+      efficiencyCpus.clear();
+      cpu_set_t allowedCpus;
+      CPU_ZERO(&allowedCpus);
+      if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) == 0)
+      {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+          if (CPU_ISSET(cpu, &allowedCpus))
+          {
+            performanceCpus.push_back(cpu);
+          }
+        }
+      }
+    }
+#endif
+    std::sort(performanceCpus.begin(), performanceCpus.end());
+    std::sort(efficiencyCpus.begin(), efficiencyCpus.end());
+    if (performanceCpus.empty())
+    {
+      // The platform does not tell, so take every CPU as a performance one.
+      efficiencyCpus.clear();
+      for (uint32_t cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++)
+      {
+        performanceCpus.push_back(cpu);
+      }
+    }
+  }
+
+  /**
+   * Find the options of the thread placement the program was started with.
+   */
+  void findOptions()
+  {
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i < arguments.size(); i++)
+    {
+      if (arguments[i] == "--pin-threads")
+      {
+        isPinningEnabled = true;
+      }
+      else if (arguments[i] == "--job-cores" && i + 1 < arguments.size())
+      {
+        jobCoresCount = static_cast<uint32_t>(std::clamp(std::atoi(arguments[i + 1].c_str()), 0, static_cast<int32_t>(MAX_JOB_WORKER_THREADS)));
+      }
+    }
+  }
+
+  /**
+   * Get the index of the statistics of a thread.
+   * 
+   * @param role         The role of the thread.
+   * @param workerIndex  The index of the thread in the job manager, for the worker threads (from 1).
+   * 
+   * @return The index of the thread.
+   */
+  static size_t getThreadIndex(const ThreadRole &role, const uint32_t &workerIndex)
+  {
+    switch (role)
+    {
+    case ThreadRole::MAIN:
+      return 0;
+    case ThreadRole::RENDER:
+      return 1;
+    case ThreadRole::LOADER:
+      return 2;
+    default:
+      return std::min(static_cast<size_t>(workerIndex) + 2, THREADS_COUNT - 1);
+    }
+  }
+
+  /**
+   * Get the CPUs a thread is pinned to, the performance cores being given out first, in the order of the roles.
+   * 
+   * @param role         The role of the thread.
+   * @param workerIndex  The index of the thread in the job manager, for the worker threads (from 1).
+   * 
+   * @return The CPUs of the thread (none to leave it to the scheduler).
+   */
+  std::vector<uint32_t> getThreadCpus(const ThreadRole &role, const uint32_t &workerIndex) const
+  {
+    if (role == ThreadRole::LOADER)
+    {
+      return efficiencyCpus;
+    }
+    auto cpus = performanceCpus;
+    cpus.insert(cpus.end(), efficiencyCpus.begin(), efficiencyCpus.end());
+    const uint32_t frameThreadsCount = IS_RENDER_THREAD_ENABLED ? 2 : 1;
+    switch (role)
+    {
+    case ThreadRole::MAIN:
+      return {cpus[0]};
+    case ThreadRole::RENDER:
+      return {cpus[1 % cpus.size()]};
+    default:
+      return {cpus[(frameThreadsCount + workerIndex - 1) % cpus.size()]};
+    }
+  }
+
+  /**
+   * Pin the calling thread to the given CPUs.
+   * 
+   * @param cpus  The CPUs.
+   * 
+   * @return Whether the thread was pinned.
+   */
+  static bool setCurrentThreadCpus(const std::vector<uint32_t> &cpus)
+  {
+    if (cpus.empty())
+    {
+      return false;
+    }
+#ifdef _WIN32
+    DWORD_PTR affinityMask = 0;
+    for (const auto &cpu : cpus)
+    {
+      affinityMask |= cpu < sizeof(DWORD_PTR) * 8 ? static_cast<DWORD_PTR>(1) << cpu : 0;
+    }
+    return affinityMask != 0 && SetThreadAffinityMask(GetCurrentThread(), affinityMask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const auto &cpu : cpus)
+    {
+      CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Set the priority of the calling thread by its role. The frame threads only get a higher priority if the process is allowed
+   *   to raise it, staying at the normal one otherwise.
+   * 
+   * @param role  The role of the thread.
+   */
+  static void setCurrentThreadPriority(const ThreadRole &role)
+  {
+    const auto isFrameThread = role == ThreadRole::MAIN || role == ThreadRole::RENDER;
+    if (!isFrameThread && role != ThreadRole::LOADER)
+    {
+      return;
+    }
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), isFrameThread ? THREAD_PRIORITY_ABOVE_NORMAL : THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    // The nice values are per thread on Linux.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), isFrameThread ? -5 : 10);
+#endif
+  }
+
+  ThreadSchedulingManager()
+      : performanceCpus({}),
+        efficiencyCpus({}),
+        isPinningEnabled(false),
+        jobCoresCount(0),
+        threadStats(),
+        preemptionCounterNames({}),
+        migrationCounterNames({})
+  {
+    for (size_t i = 0; i < THREADS_COUNT; i++)
+    {
+      auto &stats = threadStats[i];
+      stats.isStarted.store(false);
+      stats.isPinned.store(false);
+      stats.cpu.store(-1);
+      stats.migrationsCount.store(0);
+      stats.preemptionsCount.store(0);
+      const auto threadName = i == 0 ? std::string("Main") : i == 1 ? std::string("Render") : i == 2 ? std::string("Loader") : "T" + std::to_string(i - 2);
+      preemptionCounterNames[i] = threadName + " Preemptions";
+      migrationCounterNames[i] = threadName + " Migrations";
+    }
+    findCpus();
+    findOptions();
+    // The singletons are created on the main thread.
+    applyToCurrentThread(ThreadRole::MAIN);
+    writeCpuReport(std::cout);
+  }
+
+public:
+  // Preventing copying the thread scheduling manager, making sure only one instance can exist.
+  ThreadSchedulingManager(const ThreadSchedulingManager &) = delete;
+
+  /**
+   * Place the calling thread on the CPUs of its role with its priority, and start sampling how it is scheduled. Meant to be
+   *   called by each thread once, when it starts.
+   * 
+   * @param role         The role of the thread.
+   * @param workerIndex  The index of the thread in the job manager, for the worker threads (from 1).
+   */
+  void applyToCurrentThread(const ThreadRole &role, const uint32_t &workerIndex = 0)
+  {
+    const auto threadIndex = getThreadIndex(role, workerIndex);
+    currentThreadIndex = static_cast<int32_t>(threadIndex);
+    setCurrentThreadPriority(role);
+    auto &stats = threadStats[threadIndex];
+    stats.isPinned.store(isPinningEnabled && setCurrentThreadCpus(getThreadCpus(role, workerIndex)), std::memory_order_relaxed);
+    stats.isStarted.store(true, std::memory_order_release);
+    sampleCurrentThread();
+  }
+
+  /**
+   * Sample how the calling thread was scheduled since it was sampled before, if it applied its placement.
+   */
+  void sampleCurrentThread()
+  {
+    if (currentThreadIndex < 0)
+    {
+      return;
+    }
+    auto &stats = threadStats[currentThreadIndex];
+#ifdef _WIN32
+    const auto cpu = static_cast<int32_t>(GetCurrentProcessorNumber());
+#elif defined(__linux__)
+    const auto cpu = static_cast<int32_t>(sched_getcpu());
+    rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0)
+    {
+      stats.preemptionsCount.store(static_cast<uint64_t>(usage.ru_nivcsw), std::memory_order_relaxed);
+    }
+#else
+    const auto cpu = -1;
+#endif
+    const auto lastCpu = stats.cpu.exchange(cpu, std::memory_order_relaxed);
+    if (lastCpu >= 0 && cpu >= 0 && lastCpu != cpu)
+    {
+      stats.migrationsCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Sample the calling thread at the end of a frame, and add the statistics of all the started threads to the profiler capture
+   *   (if one is running).
+   */
+  void endFrame()
+  {
+    sampleCurrentThread();
+    auto &cpuProfiler = CpuProfiler::getInstance();
+    if (!cpuProfiler.isCaptureRunning())
+    {
+      return;
+    }
+    const auto time = CpuProfiler::getTimestamp();
+    for (size_t i = 0; i < THREADS_COUNT; i++)
+    {
+      const auto &stats = threadStats[i];
+      if (stats.isStarted.load(std::memory_order_acquire))
+      {
+        cpuProfiler.recordCounter(preemptionCounterNames[i].c_str(), time, static_cast<double_t>(stats.preemptionsCount.load(std::memory_order_relaxed)));
+        cpuProfiler.recordCounter(migrationCounterNames[i].c_str(), time, stats.migrationsCount.load(std::memory_order_relaxed));
+      }
+    }
+  }
+
+  /**
+   * Get the scheduling statistics of a thread of the job manager.
+   * 
+   * @param jobThreadIndex  The index of the thread in the job manager, where the main thread is 0.
+   * 
+   * @return The statistics of the thread.
+   */
+  const ThreadSchedulingStats &getJobThreadStats(const size_t &jobThreadIndex) const
+  {
+    return threadStats[jobThreadIndex == 0 ? 0 : getThreadIndex(ThreadRole::WORKER, static_cast<uint32_t>(jobThreadIndex))];
+  }
+
+  /**
+   * Check if the given logical CPU is one of the efficiency cores of a hybrid CPU.
+   * 
+   * @param cpu  The logical CPU.
+   * 
+   * @return Whether the CPU is an efficiency core.
+   */
+  bool isEfficiencyCpu(const int32_t &cpu) const
+  {
+    return cpu >= 0 && std::binary_search(efficiencyCpus.begin(), efficiencyCpus.end(), static_cast<uint32_t>(cpu));
+  }
+
+  /**
+   * Get the number of cores reserved for the job system with the "--job-cores N" option.
+   * 
+   * @return The number of cores, or 0 if the option was not given.
+   */
+  uint32_t getJobCoresCount() const
+  {
+    return jobCoresCount;
+  }
+
+  /**
+   * Write the CPUs found and how the threads are placed on them.
+   * 
+   * @param stream  The stream to write the report to.
+   */
+  void writeCpuReport(std::ostream &stream) const
+  {
+    stream << "CPU: " << performanceCpus.size() << " Performance Threads";
+    if (!efficiencyCpus.empty())
+    {
+      stream << ", " << efficiencyCpus.size() << " Efficiency Threads (Hybrid)";
+    }
+    stream << " | Thread Pinning: " << (isPinningEnabled ? "On" : "Off") << " | Job Cores: ";
+    if (jobCoresCount > 0)
+    {
+      stream << jobCoresCount;
+    }
+    else
+    {
+      stream << "Auto";
+    }
+    stream << std::endl;
+  }
+
+  /**
+   * Returns the singleton instance of the thread scheduling manager.
+   * 
+   * @return The thread scheduling manager singleton instance.
+   */
+  static ThreadSchedulingManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the thread scheduling manager singleton instance static variable.
+ThreadSchedulingManager ThreadSchedulingManager::instance;
+
+#endif
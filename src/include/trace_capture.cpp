@@ -0,0 +1,341 @@
+#ifndef INCLUDE_TRACE_CAPTURE_CPP
+#define INCLUDE_TRACE_CAPTURE_CPP
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+
+#include "constants.cpp"
+#include "command_line.cpp"
+#include "profiler.cpp"
+#include "allocation_tracker.cpp"
+#include "text_arena.cpp"
+#include "trace_writer.cpp"
+
+/**
+ * A manager class for capturing the zones of the CPU profiler and the GPU timer measurements over a stretch of frames, and
+ *   writing them out as a Chrome Trace Event JSON file (which chrome://tracing and the Perfetto UI open), so that the single
+ *   frames that hitch can be looked at instead of the averages of the debug text.
+ * With a hitch budget (the --hitch-budget option), a capture of the last few frames is kept running whenever no trace is, and
+ *   written out with the time of day each time a frame takes longer than the budget, so that the hitches of a long session can
+ *   be looked at after it.
+ */
+class TraceCaptureManager
+{
+private:
+  // Singleton instance of the trace capture manager.
+  static TraceCaptureManager instance;
+
+  // The CPU profiler the captures are recorded by.
+  CpuProfiler &cpuProfiler;
+
+  // The time the running capture stops at (in nanoseconds of the steady clock).
+  int64_t captureStopTime;
+  // The number of traces written since the program started, which the file names are numbered with.
+  uint32_t tracesCount;
+  // The path of the last trace written, or the reason it could not be.
+  std::string lastTraceText;
+  // The capture handed over by the profiler, kept around to reuse its memory.
+  ProfilerCapture stoppedCapture;
+  // Whether a trace asked for is being captured, rather than the last frames watched for hitches.
+  bool isTraceRunning;
+
+  // The time a frame can take before it is written out as a hitch (in seconds, 0 to not watch for hitches).
+  double_t hitchBudget;
+  // The time the last frame ended (in nanoseconds of the steady clock, 0 until a frame ended since the hitches are watched).
+  int64_t lastFrameEndTime;
+  // The number of hitches written since the program started.
+  uint32_t hitchesCount;
+  // The path of the last hitch written, or the reason it could not be.
+  std::string lastHitchText;
+
+  TraceCaptureManager()
+      : cpuProfiler(CpuProfiler::getInstance()),
+        captureStopTime(0),
+        tracesCount(0),
+        lastTraceText("None"),
+        stoppedCapture({0, 0, {}, {}, {}, {}}),
+        isTraceRunning(false),
+        hitchBudget(0.0),
+        lastFrameEndTime(0),
+        hitchesCount(0),
+        lastHitchText("None")
+  {
+    // Read the budget of the frames from the command line (in milliseconds). main() checks the value.
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i + 1 < arguments.size(); i++)
+    {
+      if (arguments[i] == "--hitch-budget")
+      {
+        hitchBudget = std::max(std::atof(arguments[i + 1].c_str()), 0.0) / 1000.0;
+      }
+    }
+  }
+
+  ~TraceCaptureManager()
+  {
+    // Write out a trace still running when the program ends, since it was asked for.
+    if (isTraceRunning)
+    {
+      stopCapture();
+    }
+  }
+
+  /**
+   * Write a capture as a Chrome Trace Event JSON file. The CPU zones are shown as the threads of one process (the frames on a
+   *   track of their own), the GPU timer measurements as another process, and the counters as graphs of a third one.
+   * 
+   * @param capture    The capture.
+   * @param tracePath  The path of the file.
+   * 
+   * @return Whether the file was written.
+   */
+  bool writeTrace(const ProfilerCapture &capture, const std::string &tracePath)
+  {
+    TraceWriter writer(tracePath);
+    if (!writer.isOpen())
+    {
+      return false;
+    }
+
+    // The trace times are in microseconds from the start of the capture.
+    const auto getTraceTime = [&capture](const int64_t &time) {
+      return (time - capture.startTime) / 1000.0;
+    };
+    writer.writeNameEvent("process_name", 1, 0, "CPU");
+    writer.writeNameEvent("process_name", 2, 0, "GPU");
+    writer.writeNameEvent("process_name", 3, 0, "Counters");
+    writer.writeNameEvent("thread_name", 1, 0, "Frames");
+    writer.writeNameEvent("thread_name", 2, 1, "GPU Timers");
+
+    // The frames, each from the end of the one before (the first one from the start of the capture).
+    auto frameStartTime = capture.startTime;
+    for (size_t i = 0; i < capture.frameEndTimes.size(); i++)
+    {
+      writer.writeCompleteEvent("Frame " + std::to_string(i), 1, 0, getTraceTime(frameStartTime), (capture.frameEndTimes[i] - frameStartTime) / 1000.0);
+      frameStartTime = capture.frameEndTimes[i];
+    }
+
+    // The zones on the threads they were recorded by, named the first time a zone of the thread is written.
+    auto zoneNames = std::vector<std::string>({});
+    auto isThreadNamed = std::vector<bool>({});
+    for (const auto &zone : capture.zones)
+    {
+      if (zone.threadIndex >= isThreadNamed.size())
+      {
+        isThreadNamed.resize(zone.threadIndex + 1, false);
+      }
+      if (!isThreadNamed[zone.threadIndex])
+      {
+        writer.writeNameEvent("thread_name", 1, zone.threadIndex + 1, zone.threadIndex == capture.mainThreadIndex ? std::string("Main Thread") : "Thread " + std::to_string(zone.threadIndex));
+        isThreadNamed[zone.threadIndex] = true;
+      }
+      if (zone.record.zoneId >= zoneNames.size())
+      {
+        zoneNames.resize(zone.record.zoneId + 1);
+      }
+      if (zoneNames[zone.record.zoneId].empty())
+      {
+        zoneNames[zone.record.zoneId] = cpuProfiler.getZoneName(zone.record.zoneId);
+      }
+      writer.writeCompleteEvent(zoneNames[zone.record.zoneId], 1, zone.threadIndex + 1, getTraceTime(zone.record.startTime), (zone.record.endTime - zone.record.startTime) / 1000.0, nullptr, zone.record.allocationsCount, zone.record.allocatedBytes);
+    }
+
+    // The GPU timer measurements, which nest like the timers were.
+    for (const auto &gpuTime : capture.gpuTimes)
+    {
+      writer.writeCompleteEvent(gpuTime.timerName, 2, 1, getTraceTime(gpuTime.startTime), (gpuTime.endTime - gpuTime.startTime) / 1000.0);
+    }
+
+    // The counter samples, each counter as a graph of its own.
+    for (const auto &counter : capture.counters)
+    {
+      writer.writeCounterEvent(counter.counterName, 3, getTraceTime(counter.time), counter.value);
+    }
+
+    return writer.finish();
+  }
+
+  /**
+   * Stop the capture of the last frames, and write it out as a hitch file named with the time of day and the time of the frame.
+   * 
+   * @param frameTime  The time the last frame took (in nanoseconds).
+   */
+  void writeHitch(const int64_t &frameTime)
+  {
+    cpuProfiler.stopCapture(stoppedCapture);
+
+    const auto currentTime = std::time(nullptr);
+    char timeText[32];
+    std::strftime(timeText, sizeof(timeText), "%Y%m%d_%H%M%S", std::localtime(&currentTime));
+    const auto frameTimeMs = static_cast<int64_t>(frameTime / 1000000);
+    std::error_code errorCode;
+    std::filesystem::create_directories(TRACE_CAPTURE_DIRECTORY, errorCode);
+    const auto hitchPath = std::string(TRACE_CAPTURE_DIRECTORY) + "hitch_" + timeText + "_" + std::to_string(hitchesCount) + "_" + std::to_string(frameTimeMs) + "ms.json";
+    if (writeTrace(stoppedCapture, hitchPath))
+    {
+      lastHitchText = hitchPath;
+      hitchesCount++;
+    }
+    else
+    {
+      lastHitchText = "Failed to write " + hitchPath;
+    }
+    std::cout << "Hitch of " << frameTimeMs << "ms: " << lastHitchText << std::endl;
+  }
+
+public:
+  // Preventing copying the trace capture manager, making sure only one instance can exist.
+  TraceCaptureManager(const TraceCaptureManager &) = delete;
+
+  /**
+   * Start a capture, which stops by itself after the given time. Replaces the capture of the last frames watched for hitches
+   *   until it stops.
+   * 
+   * @param duration  The time to capture for (in seconds).
+   */
+  void startCapture(const double_t &duration = TRACE_CAPTURE_DURATION)
+  {
+    cpuProfiler.startCapture();
+    captureStopTime = CpuProfiler::getTimestamp() + static_cast<int64_t>(duration * 1000000000.0);
+    isTraceRunning = true;
+  }
+
+  /**
+   * Stop the running capture, and write it out as the next trace file.
+   */
+  void stopCapture()
+  {
+    cpuProfiler.stopCapture(stoppedCapture);
+    isTraceRunning = false;
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(TRACE_CAPTURE_DIRECTORY, errorCode);
+    const auto tracePath = std::string(TRACE_CAPTURE_DIRECTORY) + "trace_" + std::to_string(tracesCount) + ".json";
+    if (writeTrace(stoppedCapture, tracePath))
+    {
+      lastTraceText = tracePath;
+      tracesCount++;
+    }
+    else
+    {
+      lastTraceText = "Failed to write " + tracePath;
+    }
+  }
+
+  /**
+   * Start a capture if none is running, or stop the running one otherwise.
+   */
+  void toggleCapture()
+  {
+    if (isTraceRunning)
+    {
+      stopCapture();
+    }
+    else
+    {
+      startCapture();
+    }
+  }
+
+  /**
+   * Stop the running capture if its time is up, or write out the last frames if the last one took longer than the hitch budget.
+   *   Done once per frame, after the profiler aggregated the frame.
+   */
+  void update()
+  {
+    const auto frameEndTime = CpuProfiler::getTimestamp();
+    const auto frameTime = lastFrameEndTime != 0 ? frameEndTime - lastFrameEndTime : 0;
+    lastFrameEndTime = frameEndTime;
+    if (cpuProfiler.isCaptureRunning())
+    {
+      // Sample the time and the allocations of the frame, which the hitches are looked at for.
+      cpuProfiler.recordCounter("Frame Time (ms)", frameEndTime, frameTime / 1000000.0);
+#ifdef ALLOCATION_TRACKING_ENABLED
+      cpuProfiler.recordCounter("Frame Allocations", frameEndTime, static_cast<double_t>(AllocationTracker::getInstance().getLastFrameAllocationsCount()));
+#endif
+    }
+
+    if (isTraceRunning)
+    {
+      if (frameEndTime >= captureStopTime)
+      {
+        stopCapture();
+      }
+      return;
+    }
+    if (hitchBudget <= 0.0)
+    {
+      return;
+    }
+
+    // Keep capturing the last frames, starting over once a hitch is written.
+    if (!cpuProfiler.isCaptureRunning())
+    {
+      cpuProfiler.startCapture();
+    }
+    else if (frameTime > static_cast<int64_t>(hitchBudget * 1000000000.0))
+    {
+      writeHitch(frameTime);
+      cpuProfiler.startCapture();
+    }
+    else
+    {
+      cpuProfiler.trimCapture(HITCH_CAPTURE_FRAMES);
+    }
+  }
+
+  /**
+   * Start watching for hitches over again from the next frame, e.g. once a scene is done loading, since the frames it took are
+   *   not frames of the game.
+   */
+  void restartHitchWatch()
+  {
+    lastFrameEndTime = 0;
+    if (!isTraceRunning && hitchBudget > 0.0)
+    {
+      cpuProfiler.startCapture();
+    }
+  }
+
+  /**
+   * Write the state of the capture as text.
+   * 
+   * @param text  The writer of the text, written the time left of the running capture or the last trace written.
+   */
+  void writeStatus(TextWriter &text) const
+  {
+    if (isTraceRunning)
+    {
+      text << "Capturing (" << (captureStopTime - CpuProfiler::getTimestamp()) / 1000000000.0 << "s Left)";
+    }
+    else
+    {
+      text << "Last Trace: " << lastTraceText;
+    }
+    if (hitchBudget > 0.0)
+    {
+      text << " | Hitches Over " << hitchBudget * 1000 << "ms: " << hitchesCount << " (Last: " << lastHitchText << ")";
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the trace capture manager.
+   * 
+   * @return The trace capture manager singleton instance.
+   */
+  static TraceCaptureManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the trace capture manager singleton instance static variable.
+TraceCaptureManager TraceCaptureManager::instance;
+
+#endif
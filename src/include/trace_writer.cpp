@@ -0,0 +1,156 @@
+#ifndef INCLUDE_TRACE_WRITER_CPP
+#define INCLUDE_TRACE_WRITER_CPP
+
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <fstream>
+
+/**
+ * A class for writing a Chrome Trace Event JSON file (which chrome://tracing and the Perfetto UI open) event by event, shared by
+ *   the traces of the CPU profiler and of the startup. Only depends on the standard library, so that it can be used during the
+ *   static initialization.
+ */
+class TraceWriter
+{
+private:
+  // The stream of the file.
+  std::ofstream stream;
+  // Whether no event was written yet, which is the only one not preceded by a comma.
+  bool isFirstEvent;
+
+  /**
+   * Write a name as a JSON string, escaping the characters JSON does not allow as they are.
+   * 
+   * @param name  The name.
+   */
+  void writeJsonString(const std::string &name)
+  {
+    stream << '"';
+    for (const auto &character : name)
+    {
+      if (character == '"' || character == '\\')
+      {
+        stream << '\\' << character;
+      }
+      else if (static_cast<unsigned char>(character) >= 0x20)
+      {
+        stream << character;
+      }
+    }
+    stream << '"';
+  }
+
+  /**
+   * Start an event, separating it from the one before.
+   * 
+   * @param name  The name of the event.
+   */
+  void beginEvent(const std::string &name)
+  {
+    stream << (isFirstEvent ? "{\"name\":" : ",\n{\"name\":");
+    writeJsonString(name);
+    isFirstEvent = false;
+  }
+
+public:
+  /**
+   * Open the file and write the start of the trace.
+   * 
+   * @param tracePath  The path of the file.
+   */
+  explicit TraceWriter(const std::string &tracePath)
+      : stream(tracePath, std::ios::out | std::ios::trunc),
+        isFirstEvent(true)
+  {
+    if (!stream.is_open())
+    {
+      return;
+    }
+    stream.setf(std::ios::fixed);
+    stream.precision(3);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  }
+
+  /**
+   * Check if the file could be opened.
+   * 
+   * @return Whether the file is open or not.
+   */
+  bool isOpen() const
+  {
+    return stream.is_open();
+  }
+
+  /**
+   * Write the name of a process or a thread of the trace.
+   * 
+   * @param eventName  The name of the metadata event ("process_name" or "thread_name").
+   * @param processId  The ID of the process.
+   * @param threadId   The ID of the thread.
+   * @param name       The name shown for the process or the thread.
+   */
+  void writeNameEvent(const char *eventName, const uint32_t &processId, const uint32_t &threadId, const std::string &name)
+  {
+    beginEvent(eventName);
+    stream << ",\"ph\":\"M\",\"pid\":" << processId << ",\"tid\":" << threadId << ",\"args\":{\"name\":";
+    writeJsonString(name);
+    stream << "}}";
+  }
+
+  /**
+   * Write a complete event (with a start and a duration) of the trace.
+   * 
+   * @param name              The name of the event.
+   * @param processId         The ID of the process the event is shown in.
+   * @param threadId          The ID of the thread the event is shown in.
+   * @param startTime         The time the event started (in microseconds from the start of the trace).
+   * @param duration          The time the event took (in microseconds).
+   * @param category          The category of the event, none if null.
+   * @param allocationsCount  The number of allocations made in the event, shown in its arguments if there are any.
+   * @param allocatedBytes    The number of bytes allocated in the event.
+   */
+  void writeCompleteEvent(const std::string &name, const uint32_t &processId, const uint32_t &threadId, const double_t &startTime, const double_t &duration, const char *category = nullptr, const uint64_t &allocationsCount = 0, const uint64_t &allocatedBytes = 0)
+  {
+    beginEvent(name);
+    if (category != nullptr)
+    {
+      stream << ",\"cat\":";
+      writeJsonString(category);
+    }
+    stream << ",\"ph\":\"X\",\"pid\":" << processId << ",\"tid\":" << threadId << ",\"ts\":" << startTime << ",\"dur\":" << duration;
+    if (allocationsCount > 0)
+    {
+      stream << ",\"args\":{\"allocations\":" << allocationsCount << ",\"allocatedBytes\":" << allocatedBytes << "}";
+    }
+    stream << "}";
+  }
+
+  /**
+   * Write a counter event (a sample of a counter, shown as a graph) of the trace.
+   * 
+   * @param name       The name of the counter.
+   * @param processId  The ID of the process the counter is shown in.
+   * @param time       The time the sample was taken (in microseconds from the start of the trace).
+   * @param value      The value of the counter.
+   */
+  void writeCounterEvent(const std::string &name, const uint32_t &processId, const double_t &time, const double_t &value)
+  {
+    beginEvent(name);
+    stream << ",\"ph\":\"C\",\"pid\":" << processId << ",\"ts\":" << time << ",\"args\":{\"value\":" << value << "}}";
+  }
+
+  /**
+   * Write the end of the trace.
+   * 
+   * @return Whether the file was written.
+   */
+  bool finish()
+  {
+    stream << "\n]}\n";
+    stream.flush();
+    return stream.good();
+  }
+};
+
+#endif
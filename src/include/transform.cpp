@@ -0,0 +1,595 @@
+#ifndef INCLUDE_TRANSFORM_CPP
+#define INCLUDE_TRANSFORM_CPP
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "collider.cpp"
+#include "job.cpp"
+#include "transform_batch.cpp"
+
+// The handle of a transform in the transform manager, which stays the same for as long as the transform exists.
+typedef uint32_t TransformHandle;
+
+/**
+ * Structure for defining a copy of the transformations of a set of transforms, one array per value like the transform manager,
+ *   which the transforms can be restored from at once.
+ */
+struct TransformSnapshot
+{
+  // The handles of the transforms.
+  std::vector<TransformHandle> handles;
+  // The positions, rotations, scales and spins of the transforms, in the order of their handles.
+  std::vector<glm::vec3> positions;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+  std::vector<glm::vec2> spins;
+};
+
+/**
+ * A manager class for storing the transformations of all the models next to each other, one array per value, so that the
+ *   render, cull and collision passes can go through them linearly instead of through each model.
+ * The references returned by the getters are only valid until the next transform is created, since that may grow the arrays.
+ */
+class TransformManager
+{
+private:
+  // Singleton instance of the transform manager.
+  static TransformManager instance;
+
+  // The positions of the transforms.
+  std::vector<glm::vec3> positions;
+  // The rotations of the transforms, as unit quaternions, so that no Euler angles are converted when the matrices are rebuilt.
+  std::vector<glm::quat> rotations;
+  // The scales of the transforms.
+  std::vector<glm::vec3> scales;
+  // The spins of the transforms about their local Y axis (the speed in radians per second, then the angle at time 0), applied by
+  //   the vertex shaders on top of the world matrices, so that the spinning transforms are not modified every step.
+  std::vector<glm::vec2> spins;
+  // The positions, rotations and scales of the transforms before the last simulation step, to interpolate the rendered
+  //   transforms from.
+  std::vector<glm::vec3> previousPositions;
+  std::vector<glm::quat> previousRotations;
+  std::vector<glm::vec3> previousScales;
+  // The world matrices of the transforms, only rebuilt when they are accessed after the transformations changed.
+  mutable std::vector<glm::mat4> worldMatrices;
+  // The corners of the world AABBs of the transforms with the smallest coordinates.
+  mutable std::vector<glm::vec3> worldMinCorners;
+  // The corners of the world AABBs of the transforms with the largest coordinates.
+  mutable std::vector<glm::vec3> worldMaxCorners;
+  // The colliders the world AABBs are taken from, or null for the transforms without one.
+  std::vector<const ColliderShape *> colliderShapes;
+  // The versions of the transforms, changed whenever any of their transformations is modified.
+  std::vector<uint64_t> versions;
+  // Whether the transformations changed since the world matrix and AABB of each transform were last built.
+  mutable std::vector<uint8_t> dirtyFlags;
+  // Whether each transform is in use, or free to be handed out again.
+  std::vector<uint8_t> aliveFlags;
+
+  // The handles of the destroyed transforms, to be reused by the next transforms created.
+  std::vector<TransformHandle> freeHandles;
+  // The last transform version handed out, so that versions are never reused between transforms. Atomic, since the models
+  //   updated in parallel modify their transforms at the same time.
+  std::atomic<uint64_t> lastVersion;
+
+  TransformManager()
+      : positions({}),
+        rotations({}),
+        scales({}),
+        spins({}),
+        previousPositions({}),
+        previousRotations({}),
+        previousScales({}),
+        worldMatrices({}),
+        worldMinCorners({}),
+        worldMaxCorners({}),
+        colliderShapes({}),
+        versions({}),
+        dirtyFlags({}),
+        aliveFlags({}),
+        freeHandles({}),
+        lastVersion(0) {}
+
+  /**
+   * Rebuild the world AABB of the given transform, once its world matrix is rebuilt, and clear its dirty flag.
+   * 
+   * @param handle  The handle of the transform.
+   */
+  void updateWorldBox(const TransformHandle &handle) const
+  {
+    if (colliderShapes[handle] != nullptr)
+    {
+      const auto &transformedBox = colliderShapes[handle]->getTransformedBox();
+      worldMinCorners[handle] = transformedBox.getMinCorner();
+      worldMaxCorners[handle] = transformedBox.getMaxCorner();
+    }
+    dirtyFlags[handle] = false;
+  }
+
+  /**
+   * Rebuild the world matrix and AABB of the given transform, and clear its dirty flag.
+   * 
+   * @param handle  The handle of the transform.
+   */
+  void updateWorldTransform(const TransformHandle &handle) const
+  {
+    worldMatrices[handle] = TransformBatchComposer::composeWorldMatrix(positions[handle], rotations[handle], scales[handle]);
+    updateWorldBox(handle);
+  }
+
+  /**
+   * Mark the given transform as modified, rebuilding its world matrix and AABB on their next access. Can be called for
+   *   different transforms from multiple threads at once.
+   * 
+   * @param handle  The handle of the transform.
+   */
+  void markTransformDirty(const TransformHandle &handle)
+  {
+    versions[handle] = ++lastVersion;
+    dirtyFlags[handle] = true;
+  }
+
+public:
+  // Preventing copying the transform manager, making sure only one instance can exist.
+  TransformManager(const TransformManager &) = delete;
+
+  /**
+   * Make room for the given number of transforms to be created, on top of those that can reuse the handles of destroyed ones,
+   *   so that creating them in bulk grows each array once.
+   * 
+   * @param transformsCount  The number of transforms to make room for.
+   */
+  void reserveTransforms(const size_t &transformsCount)
+  {
+    if (transformsCount <= freeHandles.size())
+    {
+      return;
+    }
+    const auto newTransformsCount = positions.size() + transformsCount - freeHandles.size();
+    positions.reserve(newTransformsCount);
+    rotations.reserve(newTransformsCount);
+    scales.reserve(newTransformsCount);
+    spins.reserve(newTransformsCount);
+    previousPositions.reserve(newTransformsCount);
+    previousRotations.reserve(newTransformsCount);
+    previousScales.reserve(newTransformsCount);
+    worldMatrices.reserve(newTransformsCount);
+    worldMinCorners.reserve(newTransformsCount);
+    worldMaxCorners.reserve(newTransformsCount);
+    colliderShapes.reserve(newTransformsCount);
+    versions.reserve(newTransformsCount);
+    dirtyFlags.reserve(newTransformsCount);
+    aliveFlags.reserve(newTransformsCount);
+  }
+
+  /**
+   * Create a new transform, reusing the handle of a destroyed one if there is any.
+   * 
+   * @param position  The position of the transform.
+   * @param rotation  The rotation of the transform (a unit quaternion).
+   * @param scale     The scale of the transform.
+   * 
+   * @return The handle of the transform.
+   */
+  TransformHandle createTransform(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+  {
+    TransformHandle handle;
+    if (!freeHandles.empty())
+    {
+      handle = freeHandles.back();
+      freeHandles.pop_back();
+    }
+    else
+    {
+      // Grow all the arrays by one transform.
+      handle = static_cast<TransformHandle>(positions.size());
+      positions.emplace_back();
+      rotations.emplace_back();
+      scales.emplace_back();
+      spins.emplace_back();
+      previousPositions.emplace_back();
+      previousRotations.emplace_back();
+      previousScales.emplace_back();
+      worldMatrices.emplace_back();
+      worldMinCorners.emplace_back();
+      worldMaxCorners.emplace_back();
+      colliderShapes.emplace_back();
+      versions.emplace_back();
+      dirtyFlags.emplace_back();
+      aliveFlags.emplace_back();
+    }
+
+    positions[handle] = position;
+    rotations[handle] = rotation;
+    scales[handle] = scale;
+    spins[handle] = glm::vec2(0.0f);
+    previousPositions[handle] = position;
+    previousRotations[handle] = rotation;
+    previousScales[handle] = scale;
+    worldMinCorners[handle] = position;
+    worldMaxCorners[handle] = position;
+    colliderShapes[handle] = nullptr;
+    aliveFlags[handle] = true;
+    markTransformDirty(handle);
+
+    return handle;
+  }
+
+  /**
+   * Destroy the given transform, freeing its handle to be reused.
+   * 
+   * @param handle  The handle of the transform.
+   */
+  void destroyTransform(const TransformHandle &handle)
+  {
+    if (handle >= aliveFlags.size() || !aliveFlags[handle])
+    {
+      return;
+    }
+
+    aliveFlags[handle] = false;
+    colliderShapes[handle] = nullptr;
+    freeHandles.push_back(handle);
+  }
+
+  /**
+   * Set the collider the world AABB of the given transform is taken from.
+   * 
+   * @param handle         The handle of the transform.
+   * @param colliderShape  The collider shape, kept alive by its model for as long as the transform exists.
+   */
+  void setColliderShape(const TransformHandle &handle, const ColliderShape *colliderShape)
+  {
+    colliderShapes[handle] = colliderShape;
+    // The world AABB follows the collider, so the version changes with it.
+    markTransformDirty(handle);
+  }
+
+  /**
+   * Get the position of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The position.
+   */
+  const glm::vec3 &getPosition(const TransformHandle &handle) const
+  {
+    return positions[handle];
+  }
+
+  /**
+   * Get the rotation of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The rotation (a unit quaternion).
+   */
+  const glm::quat &getRotation(const TransformHandle &handle) const
+  {
+    return rotations[handle];
+  }
+
+  /**
+   * Get the scale of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The scale.
+   */
+  const glm::vec3 &getScale(const TransformHandle &handle) const
+  {
+    return scales[handle];
+  }
+
+  /**
+   * Get the spin of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The spin about the local Y axis (the speed in radians per second, then the angle at time 0).
+   */
+  const glm::vec2 &getSpin(const TransformHandle &handle) const
+  {
+    return spins[handle];
+  }
+
+  /**
+   * Get the version of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The version, changed whenever any of the transformations is modified.
+   */
+  const uint64_t &getVersion(const TransformHandle &handle) const
+  {
+    return versions[handle];
+  }
+
+  /**
+   * Get the world matrix of the given transform.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The world matrix (rebuilt here if the transformations changed since it was last built).
+   */
+  const glm::mat4 &getWorldMatrix(const TransformHandle &handle) const
+  {
+    if (dirtyFlags[handle])
+    {
+      updateWorldTransform(handle);
+    }
+    return worldMatrices[handle];
+  }
+
+  /**
+   * Get the world matrix of the given transform spun to the given time, the same way as the vertex shaders spin it. Only
+   *   evaluated on demand, for the passes that need the exact orientation of a spinning transform (the world AABBs are taken
+   *   from the colliders, which keep the rotation without the spin).
+   * 
+   * @param handle  The handle of the transform.
+   * @param time    The time to spin the transform to (in seconds).
+   * 
+   * @return The spun world matrix.
+   */
+  glm::mat4 getSpunWorldMatrix(const TransformHandle &handle, const double_t &time) const
+  {
+    const auto &spin = spins[handle];
+    return getWorldMatrix(handle) * glm::rotate(static_cast<float_t>(spin.y + (spin.x * time)), glm::vec3(0.0f, 1.0f, 0.0f));
+  }
+
+  /**
+   * Get the corner of the world AABB of the given transform with the smallest coordinates.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The corner (rebuilt here if the transformations changed since it was last built).
+   */
+  const glm::vec3 &getWorldMinCorner(const TransformHandle &handle) const
+  {
+    if (dirtyFlags[handle])
+    {
+      updateWorldTransform(handle);
+    }
+    return worldMinCorners[handle];
+  }
+
+  /**
+   * Get the corner of the world AABB of the given transform with the largest coordinates.
+   * 
+   * @param handle  The handle of the transform.
+   * 
+   * @return The corner (rebuilt here if the transformations changed since it was last built).
+   */
+  const glm::vec3 &getWorldMaxCorner(const TransformHandle &handle) const
+  {
+    if (dirtyFlags[handle])
+    {
+      updateWorldTransform(handle);
+    }
+    return worldMaxCorners[handle];
+  }
+
+  /**
+   * Set the position of the given transform.
+   * 
+   * @param handle       The handle of the transform.
+   * @param newPosition  The position.
+   * 
+   * @return Whether the value changed or not.
+   */
+  bool setPosition(const TransformHandle &handle, const glm::vec3 &newPosition)
+  {
+    // Mark the transformations as modified only if the value actually changed.
+    if (positions[handle] == newPosition)
+    {
+      return false;
+    }
+    positions[handle] = newPosition;
+    markTransformDirty(handle);
+    return true;
+  }
+
+  /**
+   * Set the rotation of the given transform.
+   * 
+   * @param handle       The handle of the transform.
+   * @param newRotation  The rotation (a unit quaternion).
+   * 
+   * @return Whether the value changed or not.
+   */
+  bool setRotation(const TransformHandle &handle, const glm::quat &newRotation)
+  {
+    // Mark the transformations as modified only if the value actually changed.
+    if (rotations[handle] == newRotation)
+    {
+      return false;
+    }
+    rotations[handle] = newRotation;
+    markTransformDirty(handle);
+    return true;
+  }
+
+  /**
+   * Set the scale of the given transform.
+   * 
+   * @param handle    The handle of the transform.
+   * @param newScale  The scale.
+   * 
+   * @return Whether the value changed or not.
+   */
+  bool setScale(const TransformHandle &handle, const glm::vec3 &newScale)
+  {
+    // Mark the transformations as modified only if the value actually changed.
+    if (scales[handle] == newScale)
+    {
+      return false;
+    }
+    scales[handle] = newScale;
+    markTransformDirty(handle);
+    return true;
+  }
+
+  /**
+   * Set the spin of the given transform.
+   * 
+   * @param handle   The handle of the transform.
+   * @param newSpin  The spin about the local Y axis (the speed in radians per second, then the angle at time 0).
+   */
+  void setSpin(const TransformHandle &handle, const glm::vec2 &newSpin)
+  {
+    // Mark the transformations as modified only if the value actually changed.
+    if (spins[handle] != newSpin)
+    {
+      spins[handle] = newSpin;
+      markTransformDirty(handle);
+    }
+  }
+
+  /**
+   * Copy the transformations of the given transforms into a snapshot.
+   * 
+   * @param handles   The handles of the transforms.
+   * @param snapshot  The snapshot to copy the transformations into.
+   */
+  void captureTransforms(const std::vector<TransformHandle> &handles, TransformSnapshot &snapshot) const
+  {
+    snapshot.handles = handles;
+    snapshot.positions.resize(handles.size());
+    snapshot.rotations.resize(handles.size());
+    snapshot.scales.resize(handles.size());
+    snapshot.spins.resize(handles.size());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+      const auto &handle = handles[i];
+      snapshot.positions[i] = positions[handle];
+      snapshot.rotations[i] = rotations[handle];
+      snapshot.scales[i] = scales[handle];
+      snapshot.spins[i] = spins[handle];
+    }
+  }
+
+  /**
+   * Restore the transformations of the transforms of a snapshot, which must all still exist, without interpolating them from
+   *   where they were before. The colliders following the transforms are left to their owners to update.
+   * 
+   * @param snapshot  The snapshot to restore the transformations from.
+   */
+  void restoreTransforms(const TransformSnapshot &snapshot)
+  {
+    for (size_t i = 0; i < snapshot.handles.size(); i++)
+    {
+      const auto &handle = snapshot.handles[i];
+      positions[handle] = previousPositions[handle] = snapshot.positions[i];
+      rotations[handle] = previousRotations[handle] = snapshot.rotations[i];
+      scales[handle] = previousScales[handle] = snapshot.scales[i];
+      spins[handle] = snapshot.spins[i];
+      markTransformDirty(handle);
+    }
+  }
+
+  /**
+   * Get the world matrix of the given transform interpolated between its state before the last simulation step and its current state.
+   * 
+   * @param handle               The handle of the transform.
+   * @param interpolationFactor  How far to go from the state before the last step (0) to the current state (1).
+   * 
+   * @return The interpolated world matrix.
+   */
+  glm::mat4 getInterpolatedWorldMatrix(const TransformHandle &handle, const float_t &interpolationFactor) const
+  {
+    return TransformBatchComposer::composeWorldMatrix(
+        glm::mix(previousPositions[handle], positions[handle], interpolationFactor),
+        glm::slerp(previousRotations[handle], rotations[handle], interpolationFactor),
+        glm::mix(previousScales[handle], scales[handle], interpolationFactor));
+  }
+
+  /**
+   * Keep the current state of all the transforms as the state before the next simulation step, to interpolate the rendered
+   *   transforms from.
+   */
+  void saveSimulationState()
+  {
+    previousPositions = positions;
+    previousRotations = rotations;
+    previousScales = scales;
+  }
+
+  /**
+   * Drop the state of the given transform before the last simulation step, so that it is not interpolated from there (e.g. for
+   *   a pooled model spawned somewhere else than where it was despawned).
+   * 
+   * @param handle  The handle of the transform.
+   */
+  void resetInterpolation(const TransformHandle &handle)
+  {
+    previousPositions[handle] = positions[handle];
+    previousRotations[handle] = rotations[handle];
+    previousScales[handle] = scales[handle];
+  }
+
+  /**
+   * Rebuild the world matrices and AABBs of all the transforms modified since they were last built, in a single pass over
+   *   the arrays split across the threads of the job manager, so that the passes reading them afterwards do not rebuild them
+   *   one model at a time. Each transform only touches its own entries (and its own collider), so the ranges run in parallel.
+   * The modified transforms of each range are gathered into a batch, whose world matrices are composed a vector at a time.
+   */
+  void updateWorldTransforms()
+  {
+    JobManager::getInstance().parallelFor(dirtyFlags.size(), TRANSFORM_UPDATE_JOB_SIZE, [this](const size_t &begin, const size_t &end) {
+      // Each thread keeps its batch between the ranges, so that its arrays are only grown once.
+      thread_local TransformBatch batch;
+      batch.clear();
+      for (auto handle = static_cast<TransformHandle>(begin); handle < end; handle++)
+      {
+        if (dirtyFlags[handle] && aliveFlags[handle])
+        {
+          batch.add(positions[handle], rotations[handle], scales[handle], &worldMatrices[handle]);
+        }
+      }
+      if (batch.size() == 0)
+      {
+        return;
+      }
+      TransformBatchComposer::composeWorldMatrices(batch);
+      for (auto handle = static_cast<TransformHandle>(begin); handle < end; handle++)
+      {
+        if (dirtyFlags[handle] && aliveFlags[handle])
+        {
+          updateWorldBox(handle);
+        }
+      }
+    });
+  }
+
+  /**
+   * Get the number of transforms, including the destroyed ones waiting to be reused, which the handles are all below.
+   * 
+   * @return The number of transforms.
+   */
+  size_t getTransformsCount() const
+  {
+    return positions.size();
+  }
+
+  /**
+   * Returns the singleton instance of the transform manager.
+   * 
+   * @return The transform manager singleton instance.
+   */
+  static TransformManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the transform manager singleton instance static variable.
+TransformManager TransformManager::instance;
+
+#endif
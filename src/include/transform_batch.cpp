@@ -0,0 +1,192 @@
+#ifndef INCLUDE_TRANSFORM_BATCH_CPP
+#define INCLUDE_TRANSFORM_BATCH_CPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSFORM_BATCH_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Structure for defining a batch of transforms to compose the world matrices of as structure-of-arrays, so that the kernel can
+ *   load them a vector at a time.
+ */
+struct TransformBatch
+{
+  // The positions of the transforms, per axis.
+  std::vector<float_t> positionX;
+  std::vector<float_t> positionY;
+  std::vector<float_t> positionZ;
+  // The rotations of the transforms, per quaternion component.
+  std::vector<float_t> rotationW;
+  std::vector<float_t> rotationX;
+  std::vector<float_t> rotationY;
+  std::vector<float_t> rotationZ;
+  // The scales of the transforms, per axis.
+  std::vector<float_t> scaleX;
+  std::vector<float_t> scaleY;
+  std::vector<float_t> scaleZ;
+  // The matrices to write the world matrices of the transforms to.
+  std::vector<glm::mat4 *> targets;
+
+  /**
+   * Remove all the transforms from the batch, keeping the memory for the next batch.
+   */
+  void clear()
+  {
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    rotationW.clear();
+    rotationX.clear();
+    rotationY.clear();
+    rotationZ.clear();
+    scaleX.clear();
+    scaleY.clear();
+    scaleZ.clear();
+    targets.clear();
+  }
+
+  /**
+   * Add a transform to the batch.
+   * 
+   * @param position  The position of the transform.
+   * @param rotation  The rotation of the transform (a unit quaternion).
+   * @param scale     The scale of the transform.
+   * @param target    The matrix to write the world matrix of the transform to.
+   */
+  void add(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale, glm::mat4 *target)
+  {
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    rotationW.push_back(rotation.w);
+    rotationX.push_back(rotation.x);
+    rotationY.push_back(rotation.y);
+    rotationZ.push_back(rotation.z);
+    scaleX.push_back(scale.x);
+    scaleY.push_back(scale.y);
+    scaleZ.push_back(scale.z);
+    targets.push_back(target);
+  }
+
+  /**
+   * Get the number of transforms in the batch.
+   * 
+   * @return The number of transforms.
+   */
+  size_t size() const
+  {
+    return targets.size();
+  }
+};
+
+/**
+ * A class that composes world matrices (translation * rotation * scale) straight from the positions, rotations and scales,
+ *   writing the rotation from the quaternion and scaling its columns in place, instead of multiplying three 4x4 matrices.
+ * The batches are composed four transforms at a time with SSE2 where available, and with scalar code everywhere else.
+ */
+class TransformBatchComposer
+{
+private:
+  /**
+   * Compose the world matrices of a batch with scalar code, from the given index to the end of the batch.
+   * 
+   * @param batch  The batch of transforms.
+   * @param index  The index of the first transform to compose.
+   */
+  static void composeWorldMatricesScalar(const TransformBatch &batch, size_t index)
+  {
+    for (; index < batch.size(); index++)
+    {
+      *batch.targets[index] = composeWorldMatrix(
+          glm::vec3(batch.positionX[index], batch.positionY[index], batch.positionZ[index]),
+          glm::quat(batch.rotationW[index], batch.rotationX[index], batch.rotationY[index], batch.rotationZ[index]),
+          glm::vec3(batch.scaleX[index], batch.scaleY[index], batch.scaleZ[index]));
+    }
+  }
+
+#ifdef TRANSFORM_BATCH_X86
+  /**
+   * Compose the world matrices of a batch four at a time with SSE2, leaving the transforms that do not fill a vector.
+   * 
+   * @param batch  The batch of transforms.
+   * 
+   * @return The index of the first transform left uncomposed.
+   */
+  static size_t composeWorldMatricesSse2(const TransformBatch &batch)
+  {
+    const auto one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+    size_t index = 0;
+    for (; index + 4 <= batch.size(); index += 4)
+    {
+      const auto w = _mm_loadu_ps(&batch.rotationW[index]), x = _mm_loadu_ps(&batch.rotationX[index]), y = _mm_loadu_ps(&batch.rotationY[index]), z = _mm_loadu_ps(&batch.rotationZ[index]);
+      // The rotation matrices of the quaternions, with each column scaled by the scale along its axis.
+      const auto xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+      const auto xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+      const auto wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+      const auto scaleX = _mm_loadu_ps(&batch.scaleX[index]), scaleY = _mm_loadu_ps(&batch.scaleY[index]), scaleZ = _mm_loadu_ps(&batch.scaleZ[index]);
+      const auto doubleScaleX = _mm_mul_ps(two, scaleX), doubleScaleY = _mm_mul_ps(two, scaleY), doubleScaleZ = _mm_mul_ps(two, scaleZ);
+      __m128 columns[4][4] = {
+          {_mm_mul_ps(scaleX, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)))), _mm_mul_ps(doubleScaleX, _mm_add_ps(xy, wz)), _mm_mul_ps(doubleScaleX, _mm_sub_ps(xz, wy)), zero},
+          {_mm_mul_ps(doubleScaleY, _mm_sub_ps(xy, wz)), _mm_mul_ps(scaleY, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))), _mm_mul_ps(doubleScaleY, _mm_add_ps(yz, wx)), zero},
+          {_mm_mul_ps(doubleScaleZ, _mm_add_ps(xz, wy)), _mm_mul_ps(doubleScaleZ, _mm_sub_ps(yz, wx)), _mm_mul_ps(scaleZ, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))), zero},
+          {_mm_loadu_ps(&batch.positionX[index]), _mm_loadu_ps(&batch.positionY[index]), _mm_loadu_ps(&batch.positionZ[index]), one}};
+
+      // Transpose the components of each column from a vector per component to a vector per transform, and store them.
+      for (auto column = 0; column < 4; column++)
+      {
+        _MM_TRANSPOSE4_PS(columns[column][0], columns[column][1], columns[column][2], columns[column][3]);
+        for (auto lane = 0; lane < 4; lane++)
+        {
+          _mm_storeu_ps(&(*batch.targets[index + lane])[column][0], columns[column][lane]);
+        }
+      }
+    }
+    return index;
+  }
+#endif
+
+public:
+  /**
+   * Compose a world matrix from a position, a rotation and a scale.
+   * 
+   * @param position  The position.
+   * @param rotation  The rotation (a unit quaternion).
+   * @param scale     The scale.
+   * 
+   * @return The world matrix, equal to translate(position) * toMat4(rotation) * scale(scale).
+   */
+  static glm::mat4 composeWorldMatrix(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+  {
+    const auto xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+    const auto xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+    const auto wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+    return glm::mat4(
+        scale.x * (1.0f - 2.0f * (yy + zz)), scale.x * 2.0f * (xy + wz), scale.x * 2.0f * (xz - wy), 0.0f,
+        scale.y * 2.0f * (xy - wz), scale.y * (1.0f - 2.0f * (xx + zz)), scale.y * 2.0f * (yz + wx), 0.0f,
+        scale.z * 2.0f * (xz + wy), scale.z * 2.0f * (yz - wx), scale.z * (1.0f - 2.0f * (xx + yy)), 0.0f,
+        position.x, position.y, position.z, 1.0f);
+  }
+
+  /**
+   * Compose the world matrices of all the transforms of a batch, writing each to its target.
+   * 
+   * @param batch  The batch of transforms.
+   */
+  static void composeWorldMatrices(const TransformBatch &batch)
+  {
+#ifdef TRANSFORM_BATCH_X86
+    const auto index = composeWorldMatricesSse2(batch);
+#else
+    const size_t index = 0;
+#endif
+    composeWorldMatricesScalar(batch, index);
+  }
+};
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef INCLUDE_UNIFORM_BUFFER_CPP
+#define INCLUDE_UNIFORM_BUFFER_CPP
+
+#include <map>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "window.cpp"
+#include "shader.cpp"
+#include "shadowbuffer.cpp"
+#include "gpu_memory.cpp"
+#include "gl_stats.cpp"
+
+/**
+ * Structure for defining the details of a single light used by the model shaders.
+ * Matches the std140 layout of the "LightDetails" structure in the model shaders.
+ */
+struct FrameLightData
+{
+  // The projection-view matrix of the light.
+  glm::mat4 lightVpMatrix;
+  // The position of the light (the w component is unused).
+  glm::vec4 lightPosition;
+  // The product of the color and intensity of the light (the w component is unused).
+  glm::vec4 lightColorIntensity;
+  // The closest distance from which the shadowmap captures objects.
+  float_t nearPlane;
+  // The farthest distance till which the shadowmap captures objects.
+  float_t farPlane;
+  // The index of the shadowmap of the light in the shadowmap texture array.
+  int32_t layerId;
+  // Padding to align the shadowmap region to 16 bytes.
+  int32_t padding;
+  // The region of the shadowmap texture the shadowmap of the light is drawn to, in texture coordinates (offset, then size).
+  glm::vec4 shadowMapRect;
+};
+
+/**
+ * Structure for defining the frame-constant details used by the model shaders.
+ * Matches the std140 layout of the "FrameDetails" uniform block in the model shaders.
+ */
+struct FrameData
+{
+  // The view matrix of the active camera.
+  glm::mat4 viewMatrix;
+  // The projection matrix of the active camera.
+  glm::mat4 projectionMatrix;
+  // The product of the projection and view matrices of the active camera, so that the shaders do not multiply them per vertex.
+  glm::mat4 viewProjectionMatrix;
+  // The details of the active cone lights.
+  FrameLightData coneLights[MAX_CONE_LIGHTS];
+  // The details of the active point lights.
+  FrameLightData pointLights[MAX_POINT_LIGHTS];
+  // The ambient lighting factor of the scene.
+  float_t ambientFactor;
+  // A mask defining what features to disable (shadows/lighting).
+  int32_t disableFeatureMask;
+  // The number of active cone lights.
+  int32_t coneLightsCount;
+  // The number of active point lights.
+  int32_t pointLightsCount;
+  // The number of light clusters along the width, height and depth of the view, and whether the point lights are read from them.
+  glm::ivec4 clusterDetails;
+  // The scale and bias converting the log of the view depth to a light cluster depth slice, followed by the size of a cluster tile in pixels.
+  glm::vec4 clusterDepthDetails;
+  // The time the spinning models are animated to (in seconds), followed by padding.
+  glm::vec4 animationDetails;
+};
+
+/**
+ * Structure for defining the details of a single light used by the light shadowmap shaders.
+ * Matches the std140 layout of the "LightDetails" structure in the light shaders.
+ */
+struct ShadowLightData
+{
+  // The projection-view matrices of the light (one per shadowmap face).
+  glm::mat4 vpMatrices[6];
+  // The position of the light (the w component is unused).
+  glm::vec4 lightPosition;
+  // The base layer-face of the shadowmap of the light in the shadowmap texture array.
+  int32_t layerId;
+  // The number of projection-view matrices of the light.
+  int32_t vpMatrixCount;
+  // The closest distance from which the shadowmap captures objects.
+  float_t nearPlane;
+  // The farthest distance till which the shadowmap captures objects.
+  float_t farPlane;
+  // The region of the shadowmap texture the shadowmap of the light is drawn to, in texture coordinates (offset, then size).
+  glm::vec4 shadowMapRect;
+};
+
+/**
+ * Structure for defining the details of all the lights of a shadow buffer type used by the light shadowmap shaders.
+ * Matches the std140 layout of the "ShadowDetails" uniform block in the light shaders.
+ */
+struct ShadowData
+{
+  // The details of the lights.
+  ShadowLightData lights[EngineLimits::MAX_SHADOW_LIGHTS];
+  // The number of lights.
+  int32_t lightsCount;
+  // The time the spinning models are animated to (in seconds).
+  float_t animationTime;
+  // Padding to round the structure up to a multiple of 16 bytes.
+  int32_t padding[2];
+};
+
+// Make sure the structures match the sizes the std140 layout rules give them in the shaders.
+static_assert(sizeof(FrameLightData) == 128, "FrameLightData does not match the std140 layout");
+static_assert(sizeof(FrameData) == 192 + (128 * MAX_LIGHTS) + 64, "FrameData does not match the std140 layout");
+static_assert(sizeof(ShadowLightData) == 432, "ShadowLightData does not match the std140 layout");
+static_assert(sizeof(ShadowData) == (432 * EngineLimits::MAX_SHADOW_LIGHTS) + 16, "ShadowData does not match the std140 layout");
+
+/**
+ * A manager class for managing the uniform buffers that contain data shared by all shader programs.
+ */
+class UniformBufferManager
+{
+private:
+  // Singleton instance of the uniform buffer manager.
+  static UniformBufferManager instance;
+
+  // The window manager responsible for the window (must be created before any buffer).
+  WindowManager &windowManager;
+  // The shader manager responsible for assigning binding points to uniform blocks.
+  ShaderManager &shaderManager;
+  // The GPU memory manager the uniform buffers are accounted in (must be set before any buffer is created).
+  GpuMemoryManager &gpuMemoryManager;
+
+  // The binding point of the frame details uniform block.
+  const GLuint frameBindingPoint;
+  // The binding point of the shadow details uniform block.
+  const GLuint shadowBindingPoint;
+
+  // The ID of the uniform buffer containing the frame details.
+  const GLuint frameBufferId;
+  // The IDs of the uniform buffers containing the shadow details of each shadow buffer type.
+  const std::map<const ShadowBufferType, const GLuint> shadowBufferIds;
+
+  /**
+   * Create a new uniform buffer of the given size.
+   * 
+   * @param bufferSize  The size of the buffer in bytes.
+   * 
+   * @return The ID of the created buffer.
+   */
+  GLuint createUniformBuffer(const GLsizeiptr &bufferSize)
+  {
+    // Define a variable for storing the buffer ID.
+    GLuint bufferId;
+    // Create a new buffer and store the buffer ID.
+    glGenBuffers(1, &bufferId);
+    // Bind the buffer as a uniform buffer.
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+    // Allocate the storage of the buffer, since it will be rewritten every frame.
+    GlCalls::bufferData(GL_UNIFORM_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
+    // Unbind the buffer now that we're done.
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // Account the memory of the buffer.
+    gpuMemoryManager.recordAllocation(GpuResourceType::BUFFER, bufferId, GpuMemoryCategory::DYNAMIC, "Uniform Blocks", bufferSize);
+
+    // Return the ID of the created buffer.
+    return bufferId;
+  }
+
+  /**
+   * Write the given data into the given uniform buffer.
+   * 
+   * @param bufferId    The ID of the uniform buffer.
+   * @param data        The data to write.
+   * @param dataSize    The size of the data in bytes.
+   */
+  void writeUniformBuffer(const GLuint &bufferId, const void *data, const GLsizeiptr &dataSize) const
+  {
+    GlCalls::namedBufferSubData(GL_UNIFORM_BUFFER, bufferId, 0, dataSize, data);
+  }
+
+  UniformBufferManager()
+      : windowManager(WindowManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        frameBindingPoint(shaderManager.getUniformBlockBinding("FrameDetails")),
+        shadowBindingPoint(shaderManager.getUniformBlockBinding("ShadowDetails")),
+        frameBufferId(createUniformBuffer(sizeof(FrameData))),
+        shadowBufferIds({{ShadowBufferType::CONE, createUniformBuffer(sizeof(ShadowData))}, {ShadowBufferType::POINT, createUniformBuffer(sizeof(ShadowData))}})
+  {
+    // Bind the frame details buffer to its binding point, since it is the only buffer ever used with it.
+    glBindBufferBase(GL_UNIFORM_BUFFER, frameBindingPoint, frameBufferId);
+  }
+
+  ~UniformBufferManager()
+  {
+    // Delete the frame details and shadow details buffers.
+    glDeleteBuffers(1, &frameBufferId);
+    gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, frameBufferId);
+    for (const auto &shadowBufferId : shadowBufferIds)
+    {
+      glDeleteBuffers(1, &shadowBufferId.second);
+      gpuMemoryManager.recordRelease(GpuResourceType::BUFFER, shadowBufferId.second);
+    }
+  }
+
+public:
+  // Preventing copying the uniform buffer manager, making sure only one instance can exist.
+  UniformBufferManager(const UniformBufferManager &) = delete;
+
+  /**
+   * Write the frame details into the frame details uniform buffer.
+   * 
+   * @param frameData  The frame details.
+   */
+  void updateFrameData(const FrameData &frameData) const
+  {
+    writeUniformBuffer(frameBufferId, &frameData, sizeof(FrameData));
+  }
+
+  /**
+   * Write the shadow details of the given shadow buffer type into its uniform buffer, and bind it to the shadow details binding point.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer the lights render to.
+   * @param shadowData        The shadow details of the lights.
+   */
+  void updateShadowData(const ShadowBufferType &shadowBufferType, const ShadowData &shadowData) const
+  {
+    const auto &shadowBufferId = shadowBufferIds.at(shadowBufferType);
+    writeUniformBuffer(shadowBufferId, &shadowData, sizeof(ShadowData));
+    glBindBufferBase(GL_UNIFORM_BUFFER, shadowBindingPoint, shadowBufferId);
+  }
+
+  /**
+   * Returns the singleton instance of the uniform buffer manager.
+   * 
+   * @return The uniform buffer manager singleton instance.
+   */
+  static UniformBufferManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the uniform buffer manager singleton instance static variable.
+UniformBufferManager UniformBufferManager::instance;
+
+#endif
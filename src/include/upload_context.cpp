@@ -0,0 +1,251 @@
+#ifndef INCLUDE_UPLOAD_CONTEXT_CPP
+#define INCLUDE_UPLOAD_CONTEXT_CPP
+
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "constants.cpp"
+#include "thread_scheduling.cpp"
+
+/**
+ * Class for defining an upload submitted to the upload context, which is done once its function ran on the upload thread and
+ *   the GPU executed the commands it issued.
+ */
+class ContextUpload
+{
+private:
+  friend class UploadContextManager;
+
+  // The function of the upload, run with the upload context current, and released once it has run.
+  std::function<void()> function;
+  // The fence issued by the upload thread after the commands of the upload (only set once the upload ran).
+  GLsync fence;
+  // Whether the function of the upload ran and its fence was issued.
+  std::atomic<bool> isUploadRun;
+
+public:
+  explicit ContextUpload(std::function<void()> function)
+      : function(std::move(function)),
+        fence(nullptr),
+        isUploadRun(false) {}
+};
+
+/**
+ * A manager class for creating and uploading the large GL resources (e.g. the images of the BMP textures) on a thread of its
+ *   own, with a hidden context shared with the window, so that their uploads and mip-map generations never block the frames
+ *   rendered on the main context.
+ * Each upload issues a fence once it ran, and is only done once the GPU passed the fence, so that the main context can use the
+ *   objects it created right away. The objects are created anew rather than changed in place, since the changes to an object
+ *   already bound by the main context are only guaranteed to show once it is bound again.
+ * The context and the thread are created at the first upload, which has to be submitted from the thread the window context is
+ *   current on. If the shared context cannot be created (or the option is off), no upload is accepted, and the callers upload on
+ *   the main context instead.
+ */
+class UploadContextManager
+{
+private:
+  // Singleton instance of the upload context manager.
+  static UploadContextManager instance;
+
+  // The hidden window owning the upload context (null until the first upload).
+  GLFWwindow *uploadWindow;
+  // Whether the upload context was tried to be created, successfully or not.
+  bool isContextCreated;
+  // The thread running the uploads with the upload context current.
+  std::thread uploadThread;
+
+  // The mutex guarding the queued uploads and the stop flag.
+  std::mutex uploadsMutex;
+  // The condition that the upload thread is woken by when an upload is queued or it is stopped, and the waits for an upload are
+  //   woken by when it ran.
+  std::condition_variable uploadsCondition;
+  // The uploads queued for the upload thread, in the order they were submitted.
+  std::deque<std::shared_ptr<ContextUpload>> queuedUploads;
+  // Whether the upload thread is being stopped.
+  bool isStopping;
+
+  /**
+   * Create the hidden window of the upload context, sharing the objects of the current context, and start the upload thread.
+   */
+  void createUploadContext()
+  {
+    isContextCreated = true;
+    const auto sharedWindow = glfwGetCurrentContext();
+    if (!IS_UPLOAD_CONTEXT_ENABLED || sharedWindow == nullptr)
+    {
+      return;
+    }
+
+    // The window hints of the shared window are kept, so that the context is created with the same version and profile. They are
+    //   not restored, since no other window is created after it.
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    uploadWindow = glfwCreateWindow(1, 1, "Upload Context", nullptr, sharedWindow);
+    if (uploadWindow == nullptr)
+    {
+      return;
+    }
+    uploadThread = std::thread(&UploadContextManager::runUploadThread, this);
+  }
+
+  /**
+   * Run the loop of the upload thread, running the queued uploads in their order whenever it is woken.
+   */
+  void runUploadThread()
+  {
+    glfwMakeContextCurrent(uploadWindow);
+    ThreadSchedulingManager::getInstance().applyToCurrentThread(ThreadRole::LOADER);
+    while (true)
+    {
+      std::shared_ptr<ContextUpload> upload;
+      {
+        std::unique_lock<std::mutex> lock(uploadsMutex);
+        uploadsCondition.wait(lock, [this]() { return isStopping || !queuedUploads.empty(); });
+        if (queuedUploads.empty())
+        {
+          break;
+        }
+        upload = std::move(queuedUploads.front());
+        queuedUploads.pop_front();
+      }
+
+      // Run the upload, and flush its commands along with its fence, so that the main context can wait for it.
+      upload->function();
+      upload->function = nullptr;
+      upload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+      {
+        const std::lock_guard<std::mutex> lock(uploadsMutex);
+        upload->isUploadRun.store(true, std::memory_order_release);
+      }
+      uploadsCondition.notify_all();
+    }
+    glfwMakeContextCurrent(nullptr);
+  }
+
+  UploadContextManager()
+      : uploadWindow(nullptr),
+        isContextCreated(false),
+        uploadThread(),
+        queuedUploads(),
+        isStopping(false) {}
+
+  ~UploadContextManager()
+  {
+    if (uploadWindow == nullptr)
+    {
+      return;
+    }
+    // Run the uploads still queued, since their callers may wait for them, and stop the upload thread.
+    {
+      const std::lock_guard<std::mutex> lock(uploadsMutex);
+      isStopping = true;
+    }
+    uploadsCondition.notify_all();
+    uploadThread.join();
+    glfwDestroyWindow(uploadWindow);
+  }
+
+public:
+  // Preventing copying the upload context manager, making sure only one instance can exist.
+  UploadContextManager(const UploadContextManager &) = delete;
+
+  /**
+   * Queue an upload for the upload thread, creating the upload context if it is the first one. Must be called on the thread the
+   *   window context is current on.
+   * The function must only make GL calls on objects that are not used by the main context until the upload is done, and must not
+   *   go through the state cache of the GL calls, which tracks the main context.
+   * 
+   * @param function  The function of the upload.
+   * 
+   * @return The upload, or null if there is no upload context (in which case the caller has to upload on the main context).
+   */
+  std::shared_ptr<ContextUpload> submitUpload(std::function<void()> function)
+  {
+    if (!isContextCreated)
+    {
+      createUploadContext();
+    }
+    if (uploadWindow == nullptr)
+    {
+      return nullptr;
+    }
+
+    auto upload = std::make_shared<ContextUpload>(std::move(function));
+    {
+      const std::lock_guard<std::mutex> lock(uploadsMutex);
+      queuedUploads.push_back(upload);
+    }
+    uploadsCondition.notify_all();
+    return upload;
+  }
+
+  /**
+   * Check if the given upload is done, without waiting for it. Must be called on the thread the window context is current on.
+   * 
+   * @param upload  The upload.
+   * 
+   * @return Whether the upload ran and the GPU executed its commands, so that its objects can be used by the main context.
+   */
+  bool isUploadDone(ContextUpload &upload) const
+  {
+    if (!upload.isUploadRun.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    if (upload.fence == nullptr)
+    {
+      return true;
+    }
+    if (glClientWaitSync(upload.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+      return false;
+    }
+    glDeleteSync(upload.fence);
+    upload.fence = nullptr;
+    return true;
+  }
+
+  /**
+   * Wait for the given upload to be done. Must be called on the thread the window context is current on.
+   * 
+   * @param upload  The upload.
+   */
+  void waitForUpload(ContextUpload &upload)
+  {
+    {
+      std::unique_lock<std::mutex> lock(uploadsMutex);
+      uploadsCondition.wait(lock, [&upload]() { return upload.isUploadRun.load(std::memory_order_acquire); });
+    }
+    if (upload.fence != nullptr)
+    {
+      while (glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+      {
+      }
+      glDeleteSync(upload.fence);
+      upload.fence = nullptr;
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the upload context manager.
+   * 
+   * @return The upload context manager singleton instance.
+   */
+  static UploadContextManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the upload context manager singleton instance static variable.
+UploadContextManager UploadContextManager::instance;
+
+#endif
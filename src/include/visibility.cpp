@@ -0,0 +1,355 @@
+#ifndef INCLUDE_VISIBILITY_CPP
+#define INCLUDE_VISIBILITY_CPP
+
+#include <vector>
+#include <limits>
+#include <bitset>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "frustum.cpp"
+#include "transform.cpp"
+#include "scene_tree.cpp"
+#include "job.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for defining a view the visibility of the models is computed for: a view frustum, limited to a sphere for the views
+ *   of the lights (their range).
+ */
+struct VisibilityView
+{
+  // The projection-view matrix of the view.
+  glm::mat4 vpMatrix;
+  // The center and the radius of the sphere the view is limited to (an infinite radius for the views without one).
+  glm::vec3 sphereCenter;
+  float_t sphereRadius;
+
+  bool operator==(const VisibilityView &other) const
+  {
+    return vpMatrix == other.vpMatrix && sphereCenter == other.sphereCenter && sphereRadius == other.sphereRadius;
+  }
+};
+
+/**
+ * Structure for defining the visibility of the models to the views of a frame, as a bit per transform handle per view, so that
+ *   every pass reads the result of the same test instead of testing the models again.
+ */
+struct FrameVisibility
+{
+  // The number of 64-bit words of the bits of each view.
+  size_t wordsCount;
+  // The bits of the views, one view after the other (a bit per transform handle, set if the model is visible to the view).
+  std::vector<uint64_t> bits;
+  // The number of tests of a model against a view run for the frame, and the number skipped since neither changed.
+  size_t testedCount;
+  size_t reusedCount;
+
+  /**
+   * Check if the model with the given transform is visible to the given view.
+   *
+   * @param view    The index of the view.
+   * @param handle  The handle of the transform of the model.
+   *
+   * @return Whether the model is visible to the view or not.
+   */
+  bool isVisible(const uint32_t &view, const TransformHandle &handle) const
+  {
+    return ((bits[(view * wordsCount) + (handle / 64)] >> (handle % 64)) & 1) != 0;
+  }
+};
+
+/**
+ * A manager class for computing the visibility of all the models to every view of a frame once (the active camera, the cameras
+ *   of the additional views and each shadowmap face of the lights), for all the passes to read.
+ * The views are added and computed in batches, so that the views depending on the results of the earlier ones (like the lights
+ *   fitted to the models) can be added after them. Each view keeps the results of the last frame for the view added in the same
+ *   order if it did not change, so that only the models whose transforms changed since the last frame are tested for it again
+ *   (as long as no model was added to the scene tree or removed from it since).
+ */
+class VisibilityManager
+{
+private:
+  // Singleton instance of the visibility manager.
+  static VisibilityManager instance;
+
+  // The transform manager the world AABBs and versions of the models are read from.
+  const TransformManager &transformManager;
+  // The scene tree manager the models inside the changed views are found through.
+  SceneTreeManager &sceneTreeManager;
+  // The job manager the tests are split across.
+  JobManager &jobManager;
+
+  // The views added this frame, and the ones of the last frame.
+  std::vector<VisibilityView> views;
+  std::vector<VisibilityView> lastViews;
+  // The view frustums of the views added this frame.
+  std::vector<Frustum> frustums;
+  // The number of views of the frame already computed.
+  size_t computedViewsCount;
+  // The visibility bits of the views of this frame and of the last frame, and the number of words of each view of them (kept
+  //   here as well as in the frame visibility, since the render packets the frames are computed into take turns).
+  std::vector<uint64_t> bits;
+  size_t wordsCount;
+  std::vector<uint64_t> lastBits;
+  size_t lastWordsCount;
+  // The membership version of the scene tree in the last frame, since the models added to it or removed from it change the
+  //   results of the views without changing their transforms.
+  uint64_t lastMembershipVersion;
+  // Whether the membership of the scene tree is the same as in the last frame.
+  bool isMembershipCoherent;
+  // The versions of the transforms when their visibility was last computed.
+  std::vector<uint64_t> lastVersions;
+  // The bits of the transforms changed since the last frame (a bit per transform handle).
+  std::vector<uint64_t> changedBits;
+  // Whether each view of the batch being computed is the same as in the last frame, and the bits of the transforms to test for
+  //   each view of the batch (kept around to avoid reallocating every frame).
+  std::vector<uint8_t> isViewCoherent;
+  std::vector<uint64_t> testedBits;
+  // The models found fully inside and crossing the view being queried through the scene tree (kept around to avoid reallocating
+  //   every frame).
+  std::vector<const ModelBaseIntf *> containedModels;
+  std::vector<const ModelBaseIntf *> intersectedModels;
+  // The number of models tested this frame, and the number whose result was kept from the last frame instead.
+  size_t testedCount;
+  size_t reusedCount;
+
+  VisibilityManager()
+      : transformManager(TransformManager::getInstance()),
+        sceneTreeManager(SceneTreeManager::getInstance()),
+        jobManager(JobManager::getInstance()),
+        views({}),
+        lastViews({}),
+        frustums({}),
+        computedViewsCount(0),
+        bits({}),
+        wordsCount(0),
+        lastBits({}),
+        lastWordsCount(0),
+        lastMembershipVersion(std::numeric_limits<uint64_t>::max()),
+        isMembershipCoherent(false),
+        lastVersions({}),
+        changedBits({}),
+        isViewCoherent({}),
+        testedBits({}),
+        containedModels({}),
+        intersectedModels({}),
+        testedCount(0),
+        reusedCount(0) {}
+
+  /**
+   * Test the world AABB of the given transform against the given view.
+   *
+   * @param view     The view.
+   * @param frustum  The view frustum of the view.
+   * @param handle   The handle of the transform.
+   *
+   * @return Whether the model of the transform is visible to the view or not.
+   */
+  bool isBoxVisible(const VisibilityView &view, const Frustum &frustum, const TransformHandle &handle) const
+  {
+    const auto &minCorner = transformManager.getWorldMinCorner(handle);
+    const auto &maxCorner = transformManager.getWorldMaxCorner(handle);
+    const auto offset = glm::clamp(view.sphereCenter, minCorner, maxCorner) - view.sphereCenter;
+    return glm::dot(offset, offset) <= view.sphereRadius * view.sphereRadius && frustum.isBoxInside(minCorner, maxCorner);
+  }
+
+public:
+  // Preventing copying the visibility manager, making sure only one instance can exist.
+  VisibilityManager(const VisibilityManager &) = delete;
+
+  /**
+   * Start the visibility of a new frame, once the world AABBs of the transforms are rebuilt, finding the transforms changed
+   *   since the last frame.
+   */
+  void beginFrame()
+  {
+    // Keep the views and results of the last frame around to compare against.
+    lastViews.swap(views);
+    views.clear();
+    frustums.clear();
+    computedViewsCount = 0;
+    lastBits.swap(bits);
+    lastWordsCount = wordsCount;
+    bits.clear();
+    testedCount = 0;
+    reusedCount = 0;
+    isMembershipCoherent = sceneTreeManager.getMembershipVersion() == lastMembershipVersion;
+    lastMembershipVersion = sceneTreeManager.getMembershipVersion();
+
+    // Mark the transforms whose versions changed (or which did not exist in the last frame), 64 at a time.
+    const auto transformsCount = transformManager.getTransformsCount();
+    wordsCount = (transformsCount + 63) / 64;
+    lastVersions.resize(transformsCount, std::numeric_limits<uint64_t>::max());
+    changedBits.assign(wordsCount, 0);
+    jobManager.parallelFor(wordsCount, MODEL_CULL_JOB_SIZE / 64, [this, &transformsCount](const size_t &begin, const size_t &end) {
+      for (auto word = begin; word < end; word++)
+      {
+        uint64_t changedWord = 0;
+        for (auto handle = static_cast<TransformHandle>(word * 64); handle < std::min((word + 1) * 64, transformsCount); handle++)
+        {
+          const auto &version = transformManager.getVersion(handle);
+          if (version != lastVersions[handle])
+          {
+            changedWord |= 1ull << (handle % 64);
+            lastVersions[handle] = version;
+          }
+        }
+        changedBits[word] = changedWord;
+      }
+    });
+  }
+
+  /**
+   * Add a view to the frame, computed with the next batch of views.
+   *
+   * @param vpMatrix      The projection-view matrix of the view.
+   * @param sphereCenter  The center of the sphere the view is limited to.
+   * @param sphereRadius  The radius of the sphere the view is limited to (infinite for none).
+   *
+   * @return The index of the view in the frame visibility.
+   */
+  uint32_t addView(const glm::mat4 &vpMatrix, const glm::vec3 &sphereCenter = glm::vec3(0.0f), const float_t &sphereRadius = std::numeric_limits<float_t>::infinity())
+  {
+    views.push_back({vpMatrix, sphereCenter, sphereRadius});
+    frustums.push_back(Frustum(vpMatrix));
+    return static_cast<uint32_t>(views.size() - 1);
+  }
+
+  /**
+   * Compute the visibility of the models to the views added since the last batch, and copy the views of the frame so far into
+   *   the given frame visibility.
+   * A view that is the same as the view added in the same order in the last frame keeps the bits of the unchanged transforms, and
+   *   only tests the changed ones. The other views go through the scene tree, which takes the models fully inside them without
+   *   testing them (unless the view is limited to a sphere), and only leaves the models crossing their planes to be tested.
+   * The tests are split across the jobs 64 transforms at a time, so that each job writes whole words of the bits of each view.
+   *
+   * @param visibility  The frame visibility of the frame.
+   */
+  void computeViews(FrameVisibility &visibility)
+  {
+    const auto firstView = computedViewsCount;
+    const auto viewsCount = views.size() - firstView;
+    computedViewsCount = views.size();
+    const auto transformsCount = transformManager.getTransformsCount();
+    bits.resize(views.size() * wordsCount, 0);
+
+    // Find the views that are the same as in the last frame, whose results can be kept, and mark the models the scene tree finds
+    //   for the others as the ones to test (or as visible, for the models fully inside the views not limited to a sphere).
+    isViewCoherent.assign(viewsCount, false);
+    testedBits.assign(viewsCount * wordsCount, 0);
+    for (size_t v = 0; v < viewsCount; v++)
+    {
+      const auto view = firstView + v;
+      isViewCoherent[v] = isMembershipCoherent && view < lastViews.size() && views[view] == lastViews[view] && wordsCount <= lastWordsCount;
+      if (isViewCoherent[v])
+      {
+        continue;
+      }
+      containedModels.clear();
+      intersectedModels.clear();
+      sceneTreeManager.queryFrustum(frustums[view], containedModels, intersectedModels);
+      const auto isSphereLimited = views[view].sphereRadius < std::numeric_limits<float_t>::infinity();
+      for (const auto &model : containedModels)
+      {
+        const auto handle = model->getTransformHandle();
+        (isSphereLimited ? testedBits[(v * wordsCount) + (handle / 64)] : bits[(view * wordsCount) + (handle / 64)]) |= 1ull << (handle % 64);
+      }
+      for (const auto &model : intersectedModels)
+      {
+        const auto handle = model->getTransformHandle();
+        testedBits[(v * wordsCount) + (handle / 64)] |= 1ull << (handle % 64);
+      }
+    }
+
+    std::atomic<size_t> batchTestedCount(0), batchReusedCount(0);
+    jobManager.parallelFor(wordsCount, MODEL_CULL_JOB_SIZE / 64, [this, &firstView, &viewsCount, &transformsCount, &batchTestedCount, &batchReusedCount](const size_t &begin, const size_t &end) {
+      size_t jobTestedCount = 0, jobReusedCount = 0;
+      for (auto word = begin; word < end; word++)
+      {
+        const auto firstHandle = word * 64;
+        const auto handlesCount = std::min<size_t>(64, transformsCount - firstHandle);
+        const auto allBits = handlesCount == 64 ? ~0ull : (1ull << handlesCount) - 1;
+        for (size_t v = 0; v < viewsCount; v++)
+        {
+          const auto view = firstView + v;
+          auto &visibleWord = bits[(view * wordsCount) + word];
+          auto wordTestedBits = testedBits[(v * wordsCount) + word];
+          // Keep the results of the unchanged transforms if the view did not change either, testing the others.
+          if (isViewCoherent[v])
+          {
+            wordTestedBits = changedBits[word] & allBits;
+            visibleWord = lastBits[(view * lastWordsCount) + word] & ~wordTestedBits;
+            jobReusedCount += handlesCount - std::bitset<64>(wordTestedBits).count();
+          }
+          for (uint32_t bit = 0; bit < handlesCount; bit++)
+          {
+            if (((wordTestedBits >> bit) & 1) != 0 && isBoxVisible(views[view], frustums[view], static_cast<TransformHandle>(firstHandle + bit)))
+            {
+              visibleWord |= 1ull << bit;
+            }
+          }
+          jobTestedCount += std::bitset<64>(wordTestedBits).count();
+        }
+      }
+      batchTestedCount += jobTestedCount;
+      batchReusedCount += jobReusedCount;
+    });
+    testedCount += batchTestedCount;
+    reusedCount += batchReusedCount;
+
+    visibility.wordsCount = wordsCount;
+    visibility.bits.assign(bits.begin(), bits.end());
+    visibility.testedCount = testedCount;
+    visibility.reusedCount = reusedCount;
+  }
+
+  /**
+   * Get the number of views added this frame.
+   *
+   * @return The number of views.
+   */
+  size_t getViewsCount() const
+  {
+    return views.size();
+  }
+
+  /**
+   * Get the number of tests of a model against a view run this frame.
+   *
+   * @return The number of tests.
+   */
+  const size_t &getTestedCount() const
+  {
+    return testedCount;
+  }
+
+  /**
+   * Get the number of tests of a model against a view skipped this frame, since neither changed since the last frame.
+   *
+   * @return The number of tests skipped.
+   */
+  const size_t &getReusedCount() const
+  {
+    return reusedCount;
+  }
+
+  /**
+   * Returns the singleton instance of the visibility manager.
+   *
+   * @return The visibility manager singleton instance.
+   */
+  static VisibilityManager &getInstance()
+  {
+    return instance;
+  }
+};
+
+// Initialize the visibility manager singleton instance static variable.
+VisibilityManager VisibilityManager::instance;
+
+#endif
@@ -3,13 +3,52 @@
 
 #include <iostream>
 #include <set>
+#include <array>
+#include <atomic>
 #include <string>
+#include <optional>
+#include <cstdlib>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
 #include "constants.cpp"
+#include "command_line.cpp"
+#include "render_config.cpp"
+#include "gl_stats.cpp"
+#include "gl_debug.cpp"
+#include "stream_buffer.cpp"
+#include "startup_timer.cpp"
+#include "gpu_deletion.cpp"
+#include "thread_scheduling.cpp"
+
+/**
+ * Structure for defining the GPU the context of the window runs on, and the optional fast paths its driver supports.
+ */
+struct GpuCapabilities
+{
+  // The renderer, vendor and version strings of the driver.
+  std::string renderer;
+  std::string vendor;
+  std::string version;
+  // Whether the renderer is an integrated or a software one by its name, rather than a discrete GPU.
+  bool isIntegratedGpu;
+  // Whether the textures can be sampled through bindless handles (GL_ARB_bindless_texture).
+  bool isBindlessTextureSupported;
+  // Whether the draws can be culled and issued by the GPU with compute shaders and indirect multi-draws (OpenGL 4.3).
+  bool isMultiDrawIndirectSupported;
+  // Whether the driver compiles the shaders in the background, so that their completion can be polled.
+  bool isParallelShaderCompileSupported;
+  // Whether the vertex shaders can pick the layer of a layered framebuffer to draw to.
+  bool isVertexShaderLayerSupported;
+  // Whether the objects can be changed without being bound, through direct state access (OpenGL 4.5).
+  bool isDirectStateAccessSupported;
+  // Whether parts of the textures can be cleared without attaching them to a framebuffer (OpenGL 4.4).
+  bool isClearTextureSupported;
+  // Whether the contents of framebuffer attachments can be discarded once they are not needed anymore (OpenGL 4.3).
+  bool isInvalidateFramebufferSupported;
+};
 
 /**
  * A class to manage the window.
@@ -20,12 +59,162 @@ private:
   // Singleton instance of the window manager.
   static WindowManager instance;
 
+  // The size the window is rendered at offscreen, if it is headless (zero if the window is shown).
+  const glm::ivec2 headlessSize;
   // Is GLFW initialized.
   const bool isGlfwInitialized;
   // A pointer to the GLFW created window.
   GLFWwindow *const window;
+  // The names of the OpenGL extensions supported by the driver (filled in while initializing GLEW).
+  std::set<std::string> supportedExtensions;
   // Is GLEW initialized.
   const bool isGlewInitialized;
+  // Whether the swap interval can be negative, swapping late frames right away instead of waiting for the next refresh (adaptive vsync).
+  const bool isSwapTearSupported;
+  // The GPU the context runs on and the fast paths its driver supports, reported once at startup.
+  const GpuCapabilities gpuCapabilities;
+  // Is blending currently enabled.
+  bool isBlendingActive;
+  // The framebuffer a headless window is rendered into instead of its own, with its color and depth renderbuffers.
+  GLuint headlessFramebufferId;
+  GLuint headlessColorRenderbufferId;
+  GLuint headlessDepthRenderbufferId;
+  // The number of frames the GPU may still be working on once a frame is swapped.
+  const uint32_t maxFramesInFlight;
+  // The fences of the last swapped frames, by the frame number modulo the most frames in flight, and the number of the next.
+  std::array<GLsync, MAX_FRAMES_IN_FLIGHT_LIMIT> frameFences;
+  uint32_t frameNumber;
+  // The times the input of the last swapped frames was sampled at (in seconds), if given with the swap, by their fences.
+  std::array<std::optional<double_t>, MAX_FRAMES_IN_FLIGHT_LIMIT> frameInputSampleTimes;
+  // The time the CPU spent waiting on the GPU after the last swap (in milliseconds), read by the debug text on any thread.
+  std::atomic<double_t> lastGpuWaitTime;
+  // The time from sampling the input of the last frame waited for until the GPU finished it (in milliseconds), read by the
+  //   debug text on any thread.
+  std::atomic<double_t> lastInputLatency;
+  // The size the framebuffer of the window was last resized to, and the size of the window in screen coordinates (smaller than
+  //   the framebuffer on high pixel density displays), packed by packSize(). Written by the resize callback on the main thread,
+  //   and applied to the viewport by the thread owning the context at the next swap.
+  std::atomic<uint64_t> pendingFramebufferSize;
+  std::atomic<uint64_t> windowSize;
+  // The number of resizes of the framebuffer applied to the viewport.
+  uint32_t framebufferResizesCount;
+
+  /**
+   * Pack a size into a single value, so that both of its dimensions are handed over between the threads at once.
+   * 
+   * @param size  The size.
+   * 
+   * @return The packed size.
+   */
+  static uint64_t packSize(const glm::ivec2 &size)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(size.x)) << 32) | static_cast<uint32_t>(size.y);
+  }
+
+  /**
+   * Unpack a size packed by packSize().
+   * 
+   * @param packedSize  The packed size.
+   * 
+   * @return The size.
+   */
+  static glm::ivec2 unpackSize(const uint64_t &packedSize)
+  {
+    return glm::ivec2(static_cast<int32_t>(packedSize >> 32), static_cast<int32_t>(packedSize & 0xFFFFFFFF));
+  }
+
+  /**
+   * Record the new size of the framebuffer of the window, along with the size of the window, to be applied at the next swap.
+   *   Called by GLFW while the events are polled on the main thread.
+   * 
+   * @param resizedWindow  The window resized.
+   * @param width          The new width of the framebuffer (in pixels).
+   * @param height         The new height of the framebuffer (in pixels).
+   */
+  static void onFramebufferResized(GLFWwindow *resizedWindow, int width, int height)
+  {
+    int32_t windowWidth, windowHeight;
+    glfwGetWindowSize(resizedWindow, &windowWidth, &windowHeight);
+    instance.windowSize.store(packSize(glm::ivec2(windowWidth, windowHeight)), std::memory_order_relaxed);
+    instance.pendingFramebufferSize.store(packSize(glm::ivec2(width, height)), std::memory_order_relaxed);
+  }
+
+  /**
+   * Find the size of the window in screen coordinates, which is the size of the offscreen framebuffer of a headless window.
+   * 
+   * @return The packed size of the window.
+   */
+  uint64_t findWindowSize() const
+  {
+    if (isHeadless())
+    {
+      return packSize(headlessSize);
+    }
+    int32_t windowWidth, windowHeight;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    return packSize(glm::ivec2(windowWidth, windowHeight));
+  }
+
+  /**
+   * Apply the size the framebuffer of the window was last resized to, if it changed, to the size of the viewport of the window.
+   *   The render targets sized by the viewport are created again at the new size by their owners the next time they are used.
+   *   The text keeps the layout of the size the window was created with, stretched over the resized viewport.
+   */
+  void applyFramebufferResize()
+  {
+    const auto size = unpackSize(pendingFramebufferSize.load(std::memory_order_relaxed));
+    // A minimized window has an empty framebuffer, so the viewport keeps its size until the window is shown again.
+    if (isHeadless() || size.x <= 0 || size.y <= 0 || size == glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT))
+    {
+      return;
+    }
+    VIEWPORT_WIDTH = size.x;
+    VIEWPORT_HEIGHT = size.y;
+    FRAMEBUFFER_WIDTH = VIEWPORT_WIDTH;
+    FRAMEBUFFER_HEIGHT = VIEWPORT_WIDTH;
+    framebufferResizesCount++;
+  }
+
+  /**
+   * Find the size the window is rendered at offscreen, if the program was started with the "--headless [WxH]" option (read
+   *   from the command line here, since the window is created before main() starts).
+   * 
+   * @return The size of the offscreen framebuffer, or zero if the window is shown.
+   */
+  static glm::ivec2 findHeadlessSize()
+  {
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i < arguments.size(); i++)
+    {
+      if (arguments[i] == "--headless")
+      {
+        // The size is optional, defaulting to the one of the constants.
+        glm::ivec2 size;
+        return i + 1 < arguments.size() && CommandLine::parseSize(arguments[i + 1], size) ? size : glm::ivec2(HEADLESS_WIDTH, HEADLESS_HEIGHT);
+      }
+    }
+    return glm::ivec2(0);
+  }
+
+  /**
+   * Find the number of frames the GPU may still be working on once a frame is swapped, if the program was started with the
+   *   "--frames-in-flight N" option.
+   * 
+   * @return The number of frames in flight, between 1 and the most it can be set to.
+   */
+  static uint32_t findMaxFramesInFlight()
+  {
+    const auto arguments = CommandLine::getArguments();
+    for (size_t i = 0; i + 1 < arguments.size(); i++)
+    {
+      if (arguments[i] == "--frames-in-flight")
+      {
+        const auto framesInFlight = std::atoi(arguments[i + 1].c_str());
+        return static_cast<uint32_t>(glm::clamp(framesInFlight, 1, static_cast<int32_t>(MAX_FRAMES_IN_FLIGHT_LIMIT)));
+      }
+    }
+    return DEFAULT_MAX_FRAMES_IN_FLIGHT;
+  }
 
   /**
    * Initialize GLFW library.
@@ -34,6 +223,7 @@ private:
    */
   bool initializeGlfw()
   {
+    STARTUP_PHASE("Window", "GLFW Init");
     // Initialize GLFW library.
     if (!glfwInit())
     {
@@ -43,11 +233,20 @@ private:
     }
 
     // Set up OpenGL window hints for creating an OpenGL context.
-    glfwWindowHint(GLFW_SAMPLES, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_SAMPLES, ANTI_ALIASING_SAMPLES[RenderConfigManager::getConfig().antiAliasingMode]);
+    // Ask for OpenGL 4.3 if the models may be drawn by the GPU-driven path, which the window falls back to 3.3 from.
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, IS_GPU_DRIVEN_RENDERING_ENABLED ? 4 : 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Because MacOS.
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Ask for a debug context if its messages are to be received.
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, IS_GL_DEBUG_CONTEXT_ENABLED ? GL_TRUE : GL_FALSE);
+    // Keep a headless window hidden, with no samples since its own framebuffer is never drawn to.
+    if (isHeadless())
+    {
+      glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+      glfwWindowHint(GLFW_SAMPLES, 0);
+    }
 
     return true;
   }
@@ -59,8 +258,18 @@ private:
    */
   GLFWwindow *createWindow()
   {
+    STARTUP_PHASE("Window", "Window Creation");
     // Create a new window.
-    const auto newWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Game Tutorial", nullptr, nullptr);
+    auto newWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Game Tutorial", nullptr, nullptr);
+
+    // Check if the driver does not have the OpenGL 4.3 context asked for by the GPU-driven path.
+    if (newWindow == NULL && IS_GPU_DRIVEN_RENDERING_ENABLED)
+    {
+      // If so, fall back to an OpenGL 3.3 context, which the CPU-driven path draws with.
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+      newWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Game Tutorial", nullptr, nullptr);
+    }
 
     // Check if the window creation was successful.
     if (newWindow == NULL)
@@ -73,8 +282,16 @@ private:
     // Set the newly created window as the current context in GLFW.
     glfwMakeContextCurrent(newWindow);
 
-    // Get the size of the viewport of the window (this should be the same as the window width, but on MacOS it is float_t).
+    // Get the size of the viewport of the window (this should be the same as the window width, but on MacOS it is float_t), or
+    //   the size of the offscreen framebuffer of a headless window.
     glfwGetFramebufferSize(newWindow, &VIEWPORT_WIDTH, &VIEWPORT_HEIGHT);
+    if (isHeadless())
+    {
+      VIEWPORT_WIDTH = headlessSize.x;
+      VIEWPORT_HEIGHT = headlessSize.y;
+      // Nothing is shown, so the frames are never held for a screen refresh.
+      SWAP_INTERVAL = 0;
+    }
     // Define the framebuffer width as float_t the viewport width.
     FRAMEBUFFER_WIDTH = VIEWPORT_WIDTH;
     // Define the framebuffer height as float_t the viewport width (so that framebuffer is a square).
@@ -104,6 +321,7 @@ private:
    */
   bool initializeGlew()
   {
+    STARTUP_PHASE("Window", "GLEW Init");
     // Setup GLEW as experimental mode so that we can initialize the core OpenGL profile.
     glewExperimental = true;
     // Initialize GLEW.
@@ -116,7 +334,6 @@ private:
 
     int32_t numberOfExtensions;
     glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions);
-    std::set<std::string> supportedExtensions;
     for (int32_t i = 0; i < numberOfExtensions; i++)
     {
       const auto extensionName = (const char *)glGetStringi(GL_EXTENSIONS, i);
@@ -131,28 +348,178 @@ private:
       exit(1);
     }
 
+    // Start receiving the messages of the debug context (if it is one), before any GL object of the game is created.
+    GlDebugManager::getInstance().enable();
+
     // Set the viewport width to the values we got from GLFW.
-    glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    GlCalls::viewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
     // Set the color to use when clearing the screen/framebuffer.
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
     // Enable depth testing of the fragments, allowing the GPU to drop fragments from a single object and not process them if a condition is satisfied.
-    glEnable(GL_DEPTH_TEST);
+    GlCalls::enable(GL_DEPTH_TEST);
     // Use the less than function for depth testing fragments. This means any fragment of an object that is behind another fragment of the same object is dropped.
-    glDepthFunc(GL_LESS);
+    GlCalls::depthFunc(GL_LESS);
 
     // Enable culling of faces/polygons. This means that any face/polygon that is behind another polygon within the same object is dropped.
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GlCalls::enable(GL_CULL_FACE);
+    GlCalls::cullFace(GL_BACK);
 
     return true;
   }
 
-  WindowManager() : isGlfwInitialized(initializeGlfw()),
+  /**
+   * Find the GPU the context runs on and the fast paths its driver supports, once GLEW is initialized.
+   * 
+   * @return The capabilities of the GPU.
+   */
+  GpuCapabilities findGpuCapabilities() const
+  {
+    GpuCapabilities capabilities;
+    const auto getDriverString = [](const GLenum &name) {
+      const auto driverString = reinterpret_cast<const char *>(glGetString(name));
+      return std::string(driverString != nullptr ? driverString : "");
+    };
+    capabilities.renderer = getDriverString(GL_RENDERER);
+    capabilities.vendor = getDriverString(GL_VENDOR);
+    capabilities.version = getDriverString(GL_VERSION);
+
+    // The integrated and software renderers are told apart by their names, since OpenGL does not report the class of the GPU.
+    capabilities.isIntegratedGpu = false;
+    for (const auto &integratedName : {"Intel", "llvmpipe", "softpipe", "SwiftShader", "Microsoft Basic Render"})
+    {
+      if (capabilities.renderer.find(integratedName) != std::string::npos || capabilities.vendor.find(integratedName) != std::string::npos)
+      {
+        capabilities.isIntegratedGpu = true;
+      }
+    }
+
+    capabilities.isBindlessTextureSupported = supportedExtensions.count("GL_ARB_bindless_texture") != 0;
+    capabilities.isMultiDrawIndirectSupported = GLEW_VERSION_4_3;
+    capabilities.isParallelShaderCompileSupported = supportedExtensions.count("GL_ARB_parallel_shader_compile") != 0 || supportedExtensions.count("GL_KHR_parallel_shader_compile") != 0;
+    capabilities.isVertexShaderLayerSupported = supportedExtensions.count("GL_ARB_shader_viewport_layer_array") != 0 || supportedExtensions.count("GL_AMD_vertex_shader_layer") != 0;
+    capabilities.isDirectStateAccessSupported = GLEW_VERSION_4_5 || supportedExtensions.count("GL_ARB_direct_state_access") != 0;
+    capabilities.isClearTextureSupported = GLEW_VERSION_4_4 || supportedExtensions.count("GL_ARB_clear_texture") != 0;
+    capabilities.isInvalidateFramebufferSupported = GLEW_VERSION_4_3 || supportedExtensions.count("GL_ARB_invalidate_subdata") != 0;
+    return capabilities;
+  }
+
+  /**
+   * Write the GPU the context runs on, its OpenGL version, and the fast paths its driver supports along with the ones picked
+   *   from them, so that a run on the integrated GPU of a hybrid laptop shows in its log.
+   * 
+   * @param stream  The stream to write the report to.
+   */
+  void writeGpuReport(std::ostream &stream) const
+  {
+    const auto getSupportText = [](const bool &isSupported) { return isSupported ? "Yes" : "No"; };
+    stream << "GPU: " << gpuCapabilities.renderer << " (" << gpuCapabilities.vendor << ", " << (gpuCapabilities.isIntegratedGpu ? "Integrated" : "Discrete") << "), OpenGL " << gpuCapabilities.version << std::endl;
+    stream << "Fast Paths: Bindless Textures: " << getSupportText(gpuCapabilities.isBindlessTextureSupported) << " (Unused)"
+           << " | Multi-Draw Indirect: " << getSupportText(gpuCapabilities.isMultiDrawIndirectSupported) << (isGpuDrivenRenderingPreferred() ? " (GPU-Driven Rendering)" : "")
+           << " | Parallel Shader Compile: " << getSupportText(gpuCapabilities.isParallelShaderCompileSupported)
+           << " | Vertex Shader Layer: " << getSupportText(gpuCapabilities.isVertexShaderLayerSupported) << (gpuCapabilities.isVertexShaderLayerSupported ? " (Instanced Point Light Faces)" : "")
+           << " | Direct State Access: " << getSupportText(gpuCapabilities.isDirectStateAccessSupported) << (GlCalls::isDirectStateAccessEnabled() ? " (Texture Unit Binds, Buffer Uploads)" : "")
+           << " | Clear Texture: " << getSupportText(gpuCapabilities.isClearTextureSupported) << (gpuCapabilities.isClearTextureSupported ? " (Shadow Map Layers)" : "")
+           << " | Invalidate Framebuffer: " << getSupportText(gpuCapabilities.isInvalidateFramebufferSupported) << std::endl;
+  }
+
+  /**
+   * Fence the swapped frame, and wait for the GPU to finish the frame swapped the number of frames in flight before the next.
+   *   With one frame in flight, this waits for the swapped frame itself.
+   * 
+   * @param inputSampleTime  The time the input of the swapped frame was sampled at, if it is measured.
+   */
+  void waitForFramesInFlight(const std::optional<double_t> &inputSampleTime)
+  {
+    const auto swappedFrameSlot = frameNumber % MAX_FRAMES_IN_FLIGHT_LIMIT;
+    if (frameFences[swappedFrameSlot] != nullptr)
+    {
+      glDeleteSync(frameFences[swappedFrameSlot]);
+    }
+    frameFences[swappedFrameSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameInputSampleTimes[swappedFrameSlot] = inputSampleTime;
+
+    const auto waitedFrameSlot = (frameNumber + MAX_FRAMES_IN_FLIGHT_LIMIT - (maxFramesInFlight - 1)) % MAX_FRAMES_IN_FLIGHT_LIMIT;
+    auto &waitedFrameFence = frameFences[waitedFrameSlot];
+    frameNumber++;
+    if (waitedFrameFence == nullptr)
+    {
+      lastGpuWaitTime.store(0.0, std::memory_order_relaxed);
+      return;
+    }
+    const auto waitStartTime = glfwGetTime();
+    while (glClientWaitSync(waitedFrameFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+    glDeleteSync(waitedFrameFence);
+    waitedFrameFence = nullptr;
+    const auto waitEndTime = glfwGetTime();
+    lastGpuWaitTime.store((waitEndTime - waitStartTime) * 1000, std::memory_order_relaxed);
+
+    // The frame is presented once the GPU finished it, which is only known to have happened by the end of the wait (so that the
+    //   latency is an upper bound when the frame was already finished, ignoring the wait for the screen refresh).
+    if (frameInputSampleTimes[waitedFrameSlot].has_value())
+    {
+      lastInputLatency.store((waitEndTime - *frameInputSampleTimes[waitedFrameSlot]) * 1000, std::memory_order_relaxed);
+      frameInputSampleTimes[waitedFrameSlot].reset();
+    }
+  }
+
+  WindowManager() : headlessSize(findHeadlessSize()),
+                    isGlfwInitialized(initializeGlfw()),
                     window(createWindow()),
-                    isGlewInitialized(initializeGlew())
+                    isGlewInitialized(initializeGlew()),
+                    isSwapTearSupported(glfwExtensionSupported("WGL_EXT_swap_control_tear") == GL_TRUE || glfwExtensionSupported("GLX_EXT_swap_control_tear") == GL_TRUE),
+                    gpuCapabilities(findGpuCapabilities()),
+                    isBlendingActive(false),
+                    headlessFramebufferId(0),
+                    headlessColorRenderbufferId(0),
+                    headlessDepthRenderbufferId(0),
+                    maxFramesInFlight(findMaxFramesInFlight()),
+                    frameFences({}),
+                    frameNumber(0),
+                    frameInputSampleTimes({}),
+                    lastGpuWaitTime(0.0),
+                    lastInputLatency(0.0),
+                    pendingFramebufferSize(packSize(glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT))),
+                    windowSize(findWindowSize()),
+                    framebufferResizesCount(0)
   {
+    // Follow the resizes of a shown window, including the ones moving it to a display of another pixel density.
+    if (!isHeadless())
+    {
+      glfwSetFramebufferSizeCallback(window, onFramebufferResized);
+    }
+
+    // Create the framebuffer a headless window is rendered into, in the formats of the window framebuffer (single-sampled, since
+    //   the scene is always rendered into the multisampled scene target first when headless).
+    if (isHeadless())
+    {
+      glGenRenderbuffers(1, &headlessColorRenderbufferId);
+      glBindRenderbuffer(GL_RENDERBUFFER, headlessColorRenderbufferId);
+      glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, headlessSize.x, headlessSize.y);
+      glGenRenderbuffers(1, &headlessDepthRenderbufferId);
+      glBindRenderbuffer(GL_RENDERBUFFER, headlessDepthRenderbufferId);
+      glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, headlessSize.x, headlessSize.y);
+      glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+      glGenFramebuffers(1, &headlessFramebufferId);
+      GlCalls::bindFramebuffer(GL_FRAMEBUFFER, headlessFramebufferId);
+      glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headlessColorRenderbufferId);
+      glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, headlessDepthRenderbufferId);
+      if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+      {
+        // Failed to create the offscreen framebuffer. Time to crash.
+        std::cout << "Failed at window 5" << std::endl;
+        exit(1);
+      }
+      GlDebugManager::getInstance().labelObject(GL_FRAMEBUFFER, headlessFramebufferId, "Headless Window");
+    }
+    // Make the texture binds and buffer uploads without going through the bind points, if the driver can.
+    GlCalls::setDirectStateAccessEnabled(gpuCapabilities.isDirectStateAccessSupported);
+    writeGpuReport(std::cout);
+    StartupTimer::getInstance().recordStep("Window");
   }
 
 public:
@@ -161,7 +528,22 @@ public:
 
   ~WindowManager()
   {
-    // Destroy the GLFW window on application termination.
+    for (const auto &frameFence : frameFences)
+    {
+      if (frameFence != nullptr)
+      {
+        glDeleteSync(frameFence);
+      }
+    }
+    // Delete the offscreen framebuffer of a headless window.
+    if (isHeadless())
+    {
+      GlCalls::deleteFramebuffers(1, &headlessFramebufferId);
+      glDeleteRenderbuffers(1, &headlessColorRenderbufferId);
+      glDeleteRenderbuffers(1, &headlessDepthRenderbufferId);
+    }
+    // Delete the retired objects while the GL context is still there, and destroy the GLFW window on application termination.
+    GpuDeletionQueue::getInstance().deleteAll();
     glfwDestroyWindow(window);
   }
 
@@ -175,12 +557,33 @@ public:
     return window;
   }
 
+  /**
+   * Check if the window is headless, hidden and rendered into an offscreen framebuffer (e.g. for the benchmark machines without
+   *   a display).
+   * 
+   * @return Whether the window is headless.
+   */
+  bool isHeadless() const
+  {
+    return headlessSize.x > 0;
+  }
+
+  /**
+   * Get the framebuffer the frames are presented into, standing for the window.
+   * 
+   * @return The ID of the offscreen framebuffer of a headless window, or 0 for the framebuffer of the window.
+   */
+  GLuint getWindowFramebufferId() const
+  {
+    return headlessFramebufferId;
+  }
+
   /**
    * Set the viewport to the size of the window viewport.
    */
   void switchToWindowViewport()
   {
-    glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    GlCalls::viewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
   }
 
   /**
@@ -188,7 +591,7 @@ public:
    */
   void switchToFrameBufferViewport()
   {
-    glViewport(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+    GlCalls::viewport(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
   }
 
   /**
@@ -196,11 +599,65 @@ public:
    * * A value of 0 means the swap should be immediate.
    * * A value of 1 means that a single screen refresh should occur before swapping buffers. 
    * * A value of 2 means that two screen refreshes should occur before swapping buffers. 
+   * * A value of -1 means that a single screen refresh should occur, unless the frame is late, in which case it is swapped
+   *   right away (adaptive vsync, only if the driver supports it).
    */
   void toggleVsync()
   {
-    SWAP_INTERVAL = SWAP_INTERVAL == 0 ? 2 : SWAP_INTERVAL == 2 ? 1 : 0;
-    glfwSwapInterval(SWAP_INTERVAL);
+    SWAP_INTERVAL = SWAP_INTERVAL == 0 ? 2 : SWAP_INTERVAL == 2 ? 1 : SWAP_INTERVAL == 1 && isSwapTearSupported ? -1 : 0;
+    // The interval belongs to the context, so it is left to the render thread to apply while the context is handed over to it.
+    if (glfwGetCurrentContext() == window)
+    {
+      glfwSwapInterval(SWAP_INTERVAL);
+    }
+  }
+
+  /**
+   * Get the interval for swapping buffers as text.
+   * 
+   * @return The description of the swap interval.
+   */
+  const char *getVsyncText() const
+  {
+    switch (SWAP_INTERVAL)
+    {
+    case 0:
+      return "False";
+    case 1:
+      return "True (Single-Sync)";
+    case 2:
+      return "True (Double-Sync)";
+    default:
+      return "Adaptive (Single-Sync, Tearing When Late)";
+    }
+  }
+
+  /**
+   * Apply the given interval for swapping buffers to the context of the window, which has to be current on the calling thread.
+   * 
+   * @param swapInterval  The number of screen refreshes to wait for before swapping buffers.
+   */
+  void applySwapInterval(const int32_t &swapInterval)
+  {
+    glfwSwapInterval(swapInterval);
+  }
+
+  /**
+   * Make the context of the window current on the calling thread, so that the thread can make GL calls and swap the buffers.
+   *   The context has to be released by the thread it was current on first.
+   */
+  void makeContextCurrent()
+  {
+    glfwMakeContextCurrent(window);
+  }
+
+  /**
+   * Release the context of the window from the calling thread, so that another thread can make it current. The events are still
+   *   polled on the main thread, which does not need the context for it.
+   */
+  void releaseContext()
+  {
+    glfwMakeContextCurrent(nullptr);
   }
 
   /**
@@ -225,26 +682,167 @@ public:
 
   void enableBlending(const GLenum sFactor, const GLenum dFactor)
   {
-    glDisable(GL_CULL_FACE);
+    GlCalls::disable(GL_CULL_FACE);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(sFactor, dFactor);
+    GlCalls::enable(GL_BLEND);
+    GlCalls::blendFunc(sFactor, dFactor);
+
+    isBlendingActive = true;
   }
 
   void disableBlending()
   {
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GlCalls::enable(GL_CULL_FACE);
+    GlCalls::cullFace(GL_BACK);
+
+    GlCalls::disable(GL_BLEND);
 
-    glDisable(GL_BLEND);
+    isBlendingActive = false;
   }
 
   /**
-   * Swap the active framebuffer of the window to the one on which was drawn.
+   * Check if blending is currently enabled.
+   * 
+   * @return Whether blending is enabled or not.
+   */
+  bool isBlendingEnabled() const
+  {
+    return isBlendingActive;
+  }
+
+  /**
+   * Check if the vertex shaders can pick the layer of a layered framebuffer to draw to, so that the shadowmaps of point lights
+   *   can be drawn with one instance per face instead of amplifying the triangles in a geometry shader.
+   * 
+   * @return Whether the gl_Layer output is available to vertex shaders or not.
+   */
+  bool isVertexShaderLayerSupported() const
+  {
+    return gpuCapabilities.isVertexShaderLayerSupported;
+  }
+
+  /**
+   * Check if the models can be culled and drawn by the GPU, which needs compute shaders, shader storage buffers and indirect
+   *   multi-draws with base instances (all core in OpenGL 4.3, which the window asks for if the GPU-driven path is enabled).
+   * 
+   * @return Whether the GPU-driven rendering path is available or not.
+   */
+  bool isGpuDrivenRenderingSupported() const
+  {
+    return IS_GPU_DRIVEN_RENDERING_ENABLED && gpuCapabilities.isMultiDrawIndirectSupported;
+  }
+
+  /**
+   * Check if the models are better culled and drawn by the GPU from the start, which is the case if the GPU-driven path is
+   *   supported on a discrete GPU. An integrated GPU shares its memory bandwidth with the CPU, so it is left the fewer triangles
+   *   of the levels of detail and impostors picked by the CPU-driven path.
+   * 
+   * @return Whether the GPU-driven rendering path is picked at startup or not.
+   */
+  bool isGpuDrivenRenderingPreferred() const
+  {
+    return isGpuDrivenRenderingSupported() && !gpuCapabilities.isIntegratedGpu;
+  }
+
+  /**
+   * Check if the shots can be tested against the enemies by a compute shader, which needs compute shaders, shader storage
+   *   buffers and atomic counters (all core in OpenGL 4.3, which the window only asks for if the GPU-driven path is enabled).
+   * 
+   * @return Whether the GPU shot collision is available or not.
+   */
+  bool isGpuShotCollisionSupported() const
+  {
+    return IS_GPU_SHOT_COLLISION_ENABLED && gpuCapabilities.isMultiDrawIndirectSupported;
+  }
+
+  /**
+   * Get the GPU the context of the window runs on, and the fast paths its driver supports.
+   * 
+   * @return The capabilities of the GPU.
+   */
+  const GpuCapabilities &getGpuCapabilities() const
+  {
+    return gpuCapabilities;
+  }
+
+  /**
+   * Swap the active framebuffer of the window to the one on which was drawn, then wait until the GPU is at most the number of
+   *   frames in flight behind, so that the driver does not queue frames ahead (adding input latency) when they are not held
+   *   for a screen refresh.
+   * 
+   * @param inputSampleTime  The time the input of the frame was sampled at (in seconds), for measuring the latency from it until
+   *                           the frame is presented.
+   */
+  void swapBuffers(const std::optional<double_t> &inputSampleTime = std::nullopt)
+  {
+    {
+      // Time the swaps of the startup, since the first one may wait for the driver to finish setting up the window.
+      STARTUP_PHASE("Swap", "Swap");
+      glfwSwapBuffers(window);
+    }
+    waitForFramesInFlight(inputSampleTime);
+    // The next frame is rendered at the size the window was last resized to.
+    applyFramebufferResize();
+    // The swap ends the frame of the GL calls counted since the last one, and of the data streamed for its draws.
+    StreamBufferManager::getInstance().endFrame();
+    // The swap is also where the objects retired by the earlier frames the GPU is done with are deleted.
+    GpuDeletionQueue::getInstance().endFrame();
+    GlStatsManager::getInstance().endFrame();
+    GlDebugManager::getInstance().endFrame();
+    ThreadSchedulingManager::getInstance().endFrame();
+    // The first swap after the first scene is loaded presents its first frame, ending the startup.
+    StartupTimer::getInstance().recordFirstFrame(std::cout);
+  }
+
+  /**
+   * Get the number of pixels of the framebuffer of the window per screen coordinate of the window (e.g. 2 on a Retina display).
+   * 
+   * @return The pixel density of the window.
+   */
+  float_t getPixelDensity() const
+  {
+    const auto size = unpackSize(windowSize.load(std::memory_order_relaxed));
+    return size.x > 0 ? static_cast<float_t>(VIEWPORT_WIDTH) / size.x : 1.0f;
+  }
+
+  /**
+   * Get the number of resizes of the framebuffer of the window applied to the viewport since the window was created.
+   * 
+   * @return The number of resizes.
+   */
+  uint32_t getFramebufferResizesCount() const
+  {
+    return framebufferResizesCount;
+  }
+
+  /**
+   * Get the number of frames the GPU may still be working on once a frame is swapped.
+   * 
+   * @return The number of frames in flight.
+   */
+  uint32_t getMaxFramesInFlight() const
+  {
+    return maxFramesInFlight;
+  }
+
+  /**
+   * Get the time the CPU spent waiting on the GPU after the last swap, for the number of frames in flight.
+   * 
+   * @return The time waited in milliseconds.
+   */
+  double_t getLastGpuWaitTime() const
+  {
+    return lastGpuWaitTime.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the estimated latency from sampling the input of the last frame measured until the GPU finished it.
+   * 
+   * @return The latency in milliseconds.
    */
-  void swapBuffers()
+  double_t getLastInputLatency() const
   {
-    glfwSwapBuffers(window);
+    return lastInputLatency.load(std::memory_order_relaxed);
   }
 
   /**
@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../include/shadow_fitting.cpp"
 #include "light_base.cpp"
 
 /**
@@ -18,16 +19,15 @@ class ConeLight : public LightBase
 private:
   float_t horizontalAngle;
   float_t verticalAngle;
+  // The extents the projection of the light was last fitted to, the full projection while it was never fitted.
+  ShadowProjectionFit shadowFit;
 
   /**
-   * Create the view matrices for the cone light.
-   * 
-   * @param horizontalAngle  The horizontal angle of the light.
-   * @param verticalAngle  The vertical angle of the light.
+   * Create the view matrices for the cone light, from its position and angles.
    * 
    * @return The list of view matrices for the cone light.
    */
-  std::vector<glm::mat4> createViewMatrices(const float_t &horizontalAngle, const float_t &verticalAngle)
+  std::vector<glm::mat4> createViewMatrices() const override
   {
     // Calculate the direction of the light.
     const auto direction = glm::vec3(
@@ -55,7 +55,7 @@ private:
    * Create the projection matrices for the cone light.
    * 
    * @param nearPlane  The closest distance the light can project from.
-   * @param farPlane   The farthest distance the light can project till.
+   * @param farPlane   The farthest distance the light can project till (its range).
    * 
    * @return The list of projection matrices for the cone light.
    */
@@ -64,6 +64,25 @@ private:
     return std::vector<glm::mat4>({glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane)});
   }
 
+  /**
+   * Get the extents of the full projection of the cone light, which covers its whole cone till its range.
+   * 
+   * @return The extents of the full projection.
+   */
+  ShadowProjectionFit getFullProjection() const
+  {
+    return {1.0f, 1.0f, getLightNearPlane(), getLightRange()};
+  }
+
+  /**
+   * Go back to the full projection of the cone light, after the details it follows changed.
+   */
+  void resetProjectionMatrices()
+  {
+    shadowFit = getFullProjection();
+    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), getLightRange()));
+  }
+
 public:
   ConeLight(const std::string &lightId)
       : LightBase(
@@ -73,28 +92,24 @@ public:
             "assets/shaders/vertex/light_base.glsl", "assets/shaders/geometry/cone_light.glsl", "assets/shaders/fragment/cone_light.glsl",
             glm::vec3(0.0f),
             0.1f, 100.0f,
-            createViewMatrices(0.0f, 0.0f), createProjectionMatrices(0.1f, 100.0f),
+            createProjectionMatrices(0.1f, getInfluenceRange(glm::vec3(1.0f), 100.0f, 100.0f)),
             ShadowBufferType::CONE),
         horizontalAngle(0.0f),
-        verticalAngle(0.0f) {}
+        verticalAngle(0.0f),
+        shadowFit(getFullProjection()) {}
 
   virtual ~ConeLight() {}
 
-  void setLightPosition(const glm::vec3 &newPosition) override
-  {
-    // Update the light position.
-    LightBase::setLightPosition(newPosition);
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices(horizontalAngle, verticalAngle));
-  }
-
   void setLightAngles(const float_t &newHorizontalAngle, const float_t &newVerticalAngle)
   {
+    // Mark the view matrices as outdated only if the angles actually changed.
+    if (horizontalAngle != newHorizontalAngle || verticalAngle != newVerticalAngle)
+    {
+      markViewMatricesDirty();
+    }
     // Update the light angles.
     horizontalAngle = newHorizontalAngle;
     verticalAngle = newVerticalAngle;
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices(newHorizontalAngle, newVerticalAngle));
   }
 
   void setLightNearPlane(const float_t &newNearPlane) override
@@ -102,15 +117,39 @@ public:
     // Update the light near plane.
     LightBase::setLightNearPlane(newNearPlane);
     // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(newNearPlane, getLightFarPlane()));
+    resetProjectionMatrices();
   }
 
   void setLightFarPlane(const float_t &newFarPlane) override
   {
     // Update the light far plane.
     LightBase::setLightFarPlane(newFarPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), newFarPlane));
+    // Update the projection matrices, projected till the range of the light.
+    resetProjectionMatrices();
+  }
+
+  void setLightColor(const glm::vec3 &newLightColor) override
+  {
+    // Update the light color.
+    LightBase::setLightColor(newLightColor);
+    // Update the projection matrices, since the range of the light follows its color.
+    resetProjectionMatrices();
+  }
+
+  void setLightIntensity(const float_t &newLightIntensity) override
+  {
+    // Update the light intensity.
+    LightBase::setLightIntensity(newLightIntensity);
+    // Update the projection matrices, since the range of the light follows its intensity.
+    resetProjectionMatrices();
+  }
+
+  void fitShadowProjections(const std::vector<glm::vec3> &minCorners, const std::vector<glm::vec3> &maxCorners) override
+  {
+    // Fit the projection to the models in the cone, only changing the projection matrices (and outdating the shadowmap) once the
+    //   stabilized fit moves to other steps.
+    shadowFit = ShadowFitting::fitPerspective(getViewMatrices()[0], getLightPosition(), getFullProjection(), shadowFit, minCorners, maxCorners);
+    setProjectionMatrices({shadowFit.createProjectionMatrix()});
   }
 
   /**
@@ -4,9 +4,12 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cmath>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 
+#include "../include/constants.cpp"
 #include "../include/shader.cpp"
 #include "../include/shadowbuffer.cpp"
 
@@ -17,6 +20,9 @@ class LightBase
 {
 
 private:
+  // The last shadow version handed out to any light, so that versions are never reused between lights.
+  inline static uint64_t lastShadowVersion = 0;
+
   // The shader manager responsible for creating shader programs.
   ShaderManager &shaderManager;
   // The shadow buffer manager responsible for creating shadow buffers for lights.
@@ -39,15 +45,67 @@ private:
   // The farthest distance the light can capture till.
   float_t farPlane;
 
-  // The list of view matrices of the light.
-  std::vector<glm::mat4> viewMatrices;
+  // The list of view matrices of the light, only rebuilt when they are accessed after the details they follow changed.
+  mutable std::vector<glm::mat4> viewMatrices;
+  // Whether the details the view matrices follow changed since they were last built.
+  mutable bool areViewMatricesDirty;
   // The list of projection matrices of the light.
   std::vector<glm::mat4> projectionMatrices;
-  // The shader program details of the light.
+  // The type of the light, which is the type of its shadow buffer if it casts shadows.
+  const ShadowBufferType lightType;
+  // The shader program details of the light (null if the light casts no shadows).
   const std::shared_ptr<const ShaderDetails> shaderDetails;
-  // The shadow buffer details of the light.
+  // The shadow buffer details of the light (null if the light casts no shadows).
   const std::shared_ptr<const ShadowBufferDetails> shadowBufferDetails;
 
+  // The version of the details of the light that affect its shadowmap, changed whenever any of them is modified.
+  uint64_t shadowVersion;
+
+  /**
+   * Mark the shadowmap of the light as outdated, by giving it a new shadow version.
+   */
+  void markShadowDirty()
+  {
+    shadowVersion = ++lastShadowVersion;
+  }
+
+protected:
+  /**
+   * Create the view matrices of the light, from its current details. Lights casting no shadows have none.
+   * 
+   * @return The list of view matrices of the light.
+   */
+  virtual std::vector<glm::mat4> createViewMatrices() const
+  {
+    return {};
+  }
+
+  /**
+   * Mark the view matrices of the light as outdated, rebuilding them on their next access, along with its shadowmap.
+   */
+  void markViewMatricesDirty()
+  {
+    areViewMatricesDirty = true;
+    markShadowDirty();
+  }
+
+public:
+  /**
+   * Calculate the range of a light from its color and intensity, which is the distance past which its lighting falls below the
+   *   influence cutoff.
+   * 
+   * @param lightColor      The color of the light.
+   * @param lightIntensity  The intensity of the light.
+   * @param farPlane        The farthest distance the light can reach, which limits the range.
+   * 
+   * @return The range of the light.
+   */
+  static float_t getInfluenceRange(const glm::vec3 &lightColor, const float_t &lightIntensity, const float_t &farPlane)
+  {
+    const auto maxColorIntensity = std::max({lightColor.r, lightColor.g, lightColor.b}) * lightIntensity;
+    return std::min(farPlane, std::sqrt(std::max(maxColorIntensity, 0.0f) / LIGHT_INFLUENCE_CUTOFF));
+  }
+
 protected:
   LightBase(
       const std::string &lightId,
@@ -56,7 +114,7 @@ protected:
       const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath,
       const glm::vec3 &position,
       const float_t &nearPlane, const float_t &farPlane,
-      const std::vector<glm::mat4> &viewMatrices, const std::vector<glm::mat4> &projectionMatrices,
+      const std::vector<glm::mat4> &projectionMatrices,
       const ShadowBufferType &shadowBufferType)
       : shaderManager(ShaderManager::getInstance()),
         shadowBufferManager(ShadowBufferManager::getInstance()),
@@ -67,10 +125,13 @@ protected:
         position(position),
         nearPlane(nearPlane),
         farPlane(farPlane),
-        viewMatrices(viewMatrices),
+        viewMatrices({}),
+        areViewMatricesDirty(true),
         projectionMatrices(projectionMatrices),
-        shaderDetails(shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, fragmentShaderFilePath)),
-        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType))
+        lightType(shadowBufferType),
+        shaderDetails(shaderManager.createShaderPipeline(lightName + "::Shader", vertexShaderFilePath, "", fragmentShaderFilePath)),
+        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType)),
+        shadowVersion(++lastShadowVersion)
   {
   }
 
@@ -81,7 +142,7 @@ protected:
       const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath,
       const glm::vec3 &position,
       const float_t &nearPlane, const float_t &farPlane,
-      const std::vector<glm::mat4> &viewMatrices, const std::vector<glm::mat4> &projectionMatrices,
+      const std::vector<glm::mat4> &projectionMatrices,
       const ShadowBufferType &shadowBufferType)
       : shaderManager(ShaderManager::getInstance()),
         shadowBufferManager(ShadowBufferManager::getInstance()),
@@ -92,19 +153,58 @@ protected:
         position(position),
         nearPlane(nearPlane),
         farPlane(farPlane),
-        viewMatrices(viewMatrices),
+        viewMatrices({}),
+        areViewMatricesDirty(true),
         projectionMatrices(projectionMatrices),
-        shaderDetails(shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath)),
-        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType))
+        lightType(shadowBufferType),
+        // An empty geometry shader path leaves the geometry shader out of the pipeline. The shadow shaders only read the shadow
+        //   details uniform block, so their stages are shared between the lights through separable programs.
+        shaderDetails(shaderManager.createShaderPipeline(lightName + "::Shader", vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath)),
+        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType)),
+        shadowVersion(++lastShadowVersion)
+  {
+  }
+
+  /**
+   * Create a light that casts no shadows, which takes no shader program and no shadow buffer, and has no view and projection
+   *   matrices. Only point lights can be shaded without a shadowmap (through the light clusters).
+   */
+  LightBase(
+      const std::string &lightId,
+      const std::string &lightName,
+      const glm::vec3 &lightColor, const float_t &lightIntensity,
+      const glm::vec3 &position,
+      const float_t &nearPlane, const float_t &farPlane,
+      const ShadowBufferType &lightType)
+      : shaderManager(ShaderManager::getInstance()),
+        shadowBufferManager(ShadowBufferManager::getInstance()),
+        lightId(lightId),
+        lightName(lightName),
+        lightColor(lightColor),
+        lightIntensity(lightIntensity),
+        position(position),
+        nearPlane(nearPlane),
+        farPlane(farPlane),
+        viewMatrices({}),
+        areViewMatricesDirty(false),
+        projectionMatrices({}),
+        lightType(lightType),
+        shaderDetails(nullptr),
+        shadowBufferDetails(nullptr),
+        shadowVersion(++lastShadowVersion)
   {
   }
 
   virtual ~LightBase()
   {
-    // Destroy the shader program for the light.
-    shaderManager.destroyShaderProgram(shaderDetails);
-    // Destroy the shadow buffer for the light.
-    shadowBufferManager.destroyShadowBuffer(shadowBufferDetails);
+    // Check if the light casts shadows, since the other lights have no shader program and no shadow buffer.
+    if (isShadowCaster())
+    {
+      // Destroy the shader program for the light.
+      shaderManager.destroyShaderProgram(shaderDetails);
+      // Destroy the shadow buffer for the light.
+      shadowBufferManager.destroyShadowBuffer(shadowBufferDetails);
+    }
   }
 
 public:
@@ -178,10 +278,42 @@ public:
     return farPlane;
   }
 
+  /**
+   * Get the type of the light.
+   * 
+   * @return The light type.
+   */
+  const ShadowBufferType &getLightType() const
+  {
+    return lightType;
+  }
+
+  /**
+   * Check if the light casts shadows, in which case it has a shadow buffer.
+   * 
+   * @return Whether the light casts shadows or not.
+   */
+  bool isShadowCaster() const
+  {
+    return shadowBufferDetails != nullptr;
+  }
+
+  /**
+   * Get the range of the light, the distance past which its lighting falls below the influence cutoff (limited to its far plane),
+   *   which its shadowmaps are projected till, and which it is culled and shaded within. It is kept past the near plane, so that
+   *   the projections of a light too dim to reach anything stay valid.
+   * 
+   * @return The light range.
+   */
+  float_t getLightRange() const
+  {
+    return std::max(getInfluenceRange(lightColor, lightIntensity, farPlane), 2.0f * nearPlane);
+  }
+
   /**
    * Get the shader program details of the light.
    * 
-   * @return The light shader program details.
+   * @return The light shader program details (null if the light casts no shadows).
    */
   const std::shared_ptr<const ShaderDetails> &getShaderDetails() const
   {
@@ -191,20 +323,35 @@ public:
   /**
    * Get the shadow buffer of the light.
    * 
-   * @return The light shadow buffer.
+   * @return The light shadow buffer (null if the light casts no shadows).
    */
   const std::shared_ptr<const ShadowBufferDetails> &getShadowBufferDetails() const
   {
     return shadowBufferDetails;
   }
 
+  /**
+   * Get the shadow version of the light, which changes whenever the position, planes or matrices of the light change.
+   * 
+   * @return The light shadow version.
+   */
+  const uint64_t &getShadowVersion() const
+  {
+    return shadowVersion;
+  }
+
   /**
    * Get the view matrices of the light.
    * 
-   * @return The light view matrices.
+   * @return The light view matrices (rebuilt here if the details they follow changed since they were last built).
    */
   const std::vector<glm::mat4> &getViewMatrices() const
   {
+    if (areViewMatricesDirty)
+    {
+      viewMatrices = createViewMatrices();
+      areViewMatricesDirty = false;
+    }
     return viewMatrices;
   }
 
@@ -225,6 +372,11 @@ public:
    */
   virtual void setLightPosition(const glm::vec3 &newPosition)
   {
+    // Mark the view matrices and the shadowmap as outdated only if the value actually changed.
+    if (position != newPosition)
+    {
+      markViewMatricesDirty();
+    }
     position = newPosition;
   }
 
@@ -255,6 +407,11 @@ public:
    */
   virtual void setLightNearPlane(const float_t &newNearPlane)
   {
+    // Mark the shadowmap as outdated only if the value actually changed.
+    if (nearPlane != newNearPlane)
+    {
+      markShadowDirty();
+    }
     nearPlane = newNearPlane;
   }
 
@@ -265,27 +422,40 @@ public:
    */
   virtual void setLightFarPlane(const float_t &newFarPlane)
   {
+    // Mark the shadowmap as outdated only if the value actually changed.
+    if (farPlane != newFarPlane)
+    {
+      markShadowDirty();
+    }
     farPlane = newFarPlane;
   }
 
   /**
-   * Set the view matrices of the light.
+   * Set the projection matrices of the light.
    * 
-   * @param newViewMatrices  The light view matrices.
+   * @param newProjectionMatrices  The light projection matrices.
    */
-  virtual void setViewMatrices(const std::vector<glm::mat4> &newViewMatrices)
+  virtual void setProjectionMatrices(const std::vector<glm::mat4> &newProjectionMatrices)
   {
-    viewMatrices = newViewMatrices;
+    // Mark the shadowmap as outdated only if the value actually changed.
+    if (projectionMatrices != newProjectionMatrices)
+    {
+      markShadowDirty();
+    }
+    projectionMatrices = newProjectionMatrices;
   }
 
   /**
-   * Set the projection matrices of the light.
-   * 
-   * @param newProjectionMatrices  The light projection matrices.
+   * Fit the shadow projections of the light to the given models, so that its shadowmaps only cover the space they take. Lights
+   *   whose projections cannot be fitted keep them as they are.
+   *
+   * @param minCorners  The corners of the world AABBs of the models with the smallest coordinates.
+   * @param maxCorners  The corners of the world AABBs of the models with the largest coordinates.
    */
-  virtual void setProjectionMatrices(const std::vector<glm::mat4> &newProjectionMatrices)
+  virtual void fitShadowProjections(const std::vector<glm::vec3> &minCorners, const std::vector<glm::vec3> &maxCorners)
   {
-    projectionMatrices = newProjectionMatrices;
+    (void)minCorners;
+    (void)maxCorners;
   }
 
   /**
@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../include/window.cpp"
 #include "light_base.cpp"
 
 /**
@@ -17,11 +18,11 @@ class PointLight : public LightBase
 {
 private:
   /**
-   * Create the view matrices for the point light.
+   * Create the view matrices for the point light, one per face of its shadow cubemap.
    * 
    * @return The list of view matrices for the point light.
    */
-  std::vector<glm::mat4> createViewMatrices()
+  std::vector<glm::mat4> createViewMatrices() const override
   {
     const auto position = getLightPosition();
     return std::vector<glm::mat4>({glm::lookAt(position, position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
@@ -36,7 +37,7 @@ private:
    * Create the projection matrices for the point light.
    * 
    * @param nearPlane  The closest distance the light can project from.
-   * @param farPlane   The farthest distance the light can project till.
+   * @param farPlane   The farthest distance the light can project till (its range).
    * 
    * @return The list of projection matrices for the point light.
    */
@@ -56,36 +57,47 @@ public:
             lightId,
             "Point",
             glm::vec3(1.0f), 100.0f,
-            "assets/shaders/vertex/light_base.glsl", "assets/shaders/geometry/point_light.glsl", "assets/shaders/fragment/point_light.glsl",
+            // Draw the faces as instances picking their layer in the vertex shader if supported, falling back to the geometry shader otherwise.
+            WindowManager::getInstance().isVertexShaderLayerSupported() ? "assets/shaders/vertex/point_light.glsl" : "assets/shaders/vertex/light_base.glsl",
+            WindowManager::getInstance().isVertexShaderLayerSupported() ? "" : "assets/shaders/geometry/point_light.glsl",
+            "assets/shaders/fragment/point_light.glsl",
             glm::vec3(0.0f),
             1.1f, 100.0f,
-            createViewMatrices(), createProjectionMatrices(0.1f, 100.0f),
+            createProjectionMatrices(0.1f, getInfluenceRange(glm::vec3(1.0f), 100.0f, 100.0f)),
             ShadowBufferType::POINT) {}
 
   virtual ~PointLight() {}
 
-  void setLightPosition(const glm::vec3 &newPosition) override
-  {
-    // Update the light position.
-    LightBase::setLightPosition(newPosition);
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices());
-  }
-
   void setLightNearPlane(const float_t &newNearPlane) override
   {
     // Update the light near plane.
     LightBase::setLightNearPlane(newNearPlane);
     // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(newNearPlane, getLightFarPlane()));
+    setProjectionMatrices(createProjectionMatrices(newNearPlane, getLightRange()));
   }
 
   void setLightFarPlane(const float_t &newFarPlane) override
   {
     // Update the light far plane.
     LightBase::setLightFarPlane(newFarPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), newFarPlane));
+    // Update the projection matrices, projected till the range of the light.
+    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), getLightRange()));
+  }
+
+  void setLightColor(const glm::vec3 &newLightColor) override
+  {
+    // Update the light color.
+    LightBase::setLightColor(newLightColor);
+    // Update the projection matrices, since the range of the light follows its color.
+    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), getLightRange()));
+  }
+
+  void setLightIntensity(const float_t &newLightIntensity) override
+  {
+    // Update the light intensity.
+    LightBase::setLightIntensity(newLightIntensity);
+    // Update the projection matrices, since the range of the light follows its intensity.
+    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), getLightRange()));
   }
 
   /**
@@ -0,0 +1,39 @@
+#ifndef LIGHT_UNSHADOWED_POINT_LIGHT_CPP
+#define LIGHT_UNSHADOWED_POINT_LIGHT_CPP
+
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "light_base.cpp"
+
+/**
+ * Class that represents a point light casting no shadows, for cheap short-lived lights (like the glows of the shots).
+ * It takes no layer of the point light shadow maps and renders no faces, and is only shaded through the light clusters, so that
+ *   any number of them only costs their share of the point lights shaded by the quality preset.
+ */
+class UnshadowedPointLight : public LightBase
+{
+public:
+  UnshadowedPointLight(const std::string &lightId)
+      : LightBase(
+            lightId,
+            "Unshadowed Point",
+            glm::vec3(1.0f), 100.0f,
+            glm::vec3(0.0f),
+            1.1f, 100.0f,
+            ShadowBufferType::POINT) {}
+
+  virtual ~UnshadowedPointLight() {}
+
+  /**
+   * Creates a new instance of the unshadowed point light.
+   */
+  const static std::shared_ptr<UnshadowedPointLight> create(const std::string &lightId)
+  {
+    return std::make_shared<UnshadowedPointLight>(lightId);
+  }
+};
+
+#endif
\ No newline at end of file
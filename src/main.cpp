@@ -1,8 +1,12 @@
 #include <string>
+#include <cstdio>
 #include <future>
+#include <iostream>
 
 #include <GL/glew.h>
 
+// The startup timer is included first, so that it is the first static object constructed and times all the others.
+#include "include/startup_timer.cpp"
 #include "include/scene.cpp"
 
 #include "scenes/main_menu_scene.cpp"
@@ -11,8 +15,147 @@
 
 using namespace glm;
 
-int main(void)
+#ifdef _WIN32
+// Ask the drivers of the hybrid graphics laptops to run the game on the discrete GPU instead of the integrated one, which they look
+//   up in the symbols exported by the executable (the distrib/selectoptimus tool changes the NVIDIA driver settings instead).
+extern "C"
 {
+	__declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+	__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+	// Start the engine explicitly from here, timing each step until the first frame. The window and the managers were created by
+	//   the static initialization, and the subsystems the first frame does not need are created when they are first used.
+	auto &startupTimer = StartupTimer::getInstance();
+	startupTimer.recordStep("Managers");
+
+	// Start a trace capture of the first frames if asked to, for the hitches that happen before a hotkey can be pressed.
+	// Capture the frames of the game scene if asked to.
+	// Run the game scene as a benchmark if asked to, with the scene the options after it describe.
+	// Render into an offscreen framebuffer if asked to (the window reads the option itself, since it is created before main()).
+	auto isBenchmarkRequested = false;
+	auto isHeadlessRequested = false;
+	auto benchmarkSettings = BenchmarkManager::getInstance().getSettings();
+	auto isInputSessionRequested = false;
+	auto isUsageShown = false;
+	for (int i = 1; i < argc && !isUsageShown; i++)
+	{
+		const std::string argument(argv[i]);
+		const auto hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+		if (argument == "--trace")
+		{
+			// The time to capture for is optional, defaulting to the duration of the hotkey captures.
+			const auto duration = hasValue ? std::stod(argv[++i]) : TRACE_CAPTURE_DURATION;
+			TraceCaptureManager::getInstance().startCapture(duration);
+		}
+		else if (argument == "--hitch-budget" && hasValue)
+		{
+			// The budget of the frames was already read by the trace capture manager, but has to be a positive number of milliseconds.
+			isUsageShown = std::atof(argv[++i]) <= 0.0;
+		}
+		else if (argument == "--telemetry")
+		{
+			// The session is logged by the telemetry manager, which read the option itself since it is created before main().
+		}
+		else if (argument == "--capture")
+		{
+			// Capture every frame of the game scene from its start (e.g. for a video of a benchmark run).
+			FrameCaptureManager::getInstance().toggleContinuousCapture();
+		}
+		else if (argument == "--headless")
+		{
+			// The size is optional, but has to be valid if given.
+			glm::ivec2 headlessSize;
+			isHeadlessRequested = true;
+			isUsageShown = hasValue && !CommandLine::parseSize(argv[++i], headlessSize);
+		}
+		else if (argument == "--startup-trace" && hasValue)
+		{
+			// The path of the startup trace was already read by the startup timer, which is created before main().
+			i++;
+		}
+		else if (argument == "--config" && hasValue)
+		{
+			// The render config was already read by the render config manager, which is created before main().
+			i++;
+		}
+		else if (argument == "--frames-in-flight" && hasValue)
+		{
+			// The number of frames in flight was already read by the window, but has to be a number from 1 to its limit.
+			const auto framesInFlight = std::atoi(argv[++i]);
+			isUsageShown = framesInFlight < 1 || framesInFlight > static_cast<int32_t>(MAX_FRAMES_IN_FLIGHT_LIMIT);
+		}
+		else if (argument == "--pin-threads")
+		{
+			// The threads are pinned by the thread scheduling manager, which read the option itself since it is created before main().
+		}
+		else if (argument == "--job-cores" && hasValue)
+		{
+			// The number of cores reserved for the job system was already read by the thread scheduling manager, but has to be a
+			//   number up to the most worker threads.
+			const auto jobCoresCount = std::atoi(argv[++i]);
+			isUsageShown = jobCoresCount < 1 || jobCoresCount > static_cast<int32_t>(MAX_JOB_WORKER_THREADS);
+		}
+		else if (argument == "--benchmark")
+		{
+			// The number of frames to measure is optional, defaulting to the one of the constants.
+			isBenchmarkRequested = true;
+			benchmarkSettings.framesCount = hasValue ? static_cast<uint32_t>(std::stoul(argv[++i])) : BENCHMARK_DEFAULT_FRAMES_COUNT;
+		}
+		else if (argument == "--scene" && hasValue)
+		{
+			// Set the scene of the benchmark from a scene file, the options after it overriding its settings.
+			if (!BenchmarkManager::loadSceneFile(argv[++i], benchmarkSettings))
+			{
+				std::cerr << "Failed to read the benchmark scene " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (argument == "--record" && hasValue)
+		{
+			// Record the input of the game sessions, to replay them later.
+			ControlManager::getInstance().setInputRecordingPath(argv[++i]);
+			isInputSessionRequested = true;
+		}
+		else if (argument == "--replay" && hasValue)
+		{
+			// Replay the input of a recorded game session instead of taking it from the window.
+			if (!ControlManager::getInstance().loadInputReplay(argv[++i]))
+			{
+				std::cerr << "Failed to read the input recording " << argv[i] << std::endl;
+				return 1;
+			}
+			isInputSessionRequested = true;
+		}
+		else if (argument.rfind("--", 0) == 0 && hasValue)
+		{
+			// The settings of the scene of the benchmark, like "--enemies 5x3x3".
+			isUsageShown = !BenchmarkManager::parseSetting(argument.substr(2), argv[++i], benchmarkSettings);
+		}
+		else
+		{
+			isUsageShown = true;
+		}
+	}
+	// The benchmark scripts the input itself, so it cannot be recorded or replayed. A headless window has no input, so only the
+	//   benchmark can run in it.
+	if (isUsageShown || (isBenchmarkRequested && isInputSessionRequested) || (isHeadlessRequested && !isBenchmarkRequested))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--trace [seconds]] [--hitch-budget ms] [--telemetry] [--capture] [--record file | --replay file] [--headless [WxH]] [--frames-in-flight 1-3] [--pin-threads] [--job-cores 1-7] [--startup-trace file] [--config file] [--benchmark [frames] [--scene file] [--seed seed] [--enemies XxYxZ] [--spacing distance] [--scatter distance] [--unlit-enemies fraction] [--static-enemies fraction] [--lights count] [--cone-lights count] [--fire-rate shots] [--quality low|medium|high|ultra] [--screenshot-frame frame]]" << std::endl;
+		return 1;
+	}
+	if (isBenchmarkRequested)
+	{
+		BenchmarkManager::getInstance().enable(benchmarkSettings);
+	}
+
+	// Load the font, which the loading text of the first scene needs.
+	TextManager::getCharacterSet();
+	startupTimer.recordStep("Font");
+
 	SceneManager &sceneManager = SceneManager::getInstance();
 
 	auto mainMenuScene = MainMenuScene::create("MainMenuScene");
@@ -23,11 +166,9 @@ int main(void)
 	sceneManager.registerScene(gameScene);
 	sceneManager.registerScene(endScene);
 
-	sceneManager.registerActiveScene(mainMenuScene->getSceneId());
-
-	GLuint vertexArrayID;
-	glGenVertexArrays(1, &vertexArrayID);
-	glBindVertexArray(vertexArrayID);
+	// The benchmark skips the main menu, and quits once the game scene is done.
+	sceneManager.registerActiveScene(isBenchmarkRequested ? gameScene->getSceneId() : mainMenuScene->getSceneId());
+	startupTimer.recordStep("Scenes");
 
 	while (sceneManager.executeActiveScene())
 		;
@@ -36,7 +177,5 @@ int main(void)
 	sceneManager.deregisterScene("GameScene");
 	sceneManager.deregisterScene("MainMenuScene");
 
-	glDeleteVertexArrays(1, &vertexArrayID);
-
 	return 0;
 }
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -13,6 +15,8 @@
 
 #include "../include/constants.cpp"
 #include "../include/control.cpp"
+#include "../include/texture.cpp"
+#include "../include/asset_archive.cpp"
 
 #include "model_base.cpp"
 
@@ -22,13 +26,14 @@
 class CursorModel : public ModelBase<CursorModel>
 {
 private:
+  // The path of the image of the cursor, drawn on the model or shown as the hardware cursor.
+  static constexpr const char *CURSOR_IMAGE_PATH = "assets/textures/cursor.bmp";
+
   // The control manager responsible for managing controls and inputs of the window.
   ControlManager &controlManager;
 
   // Whether to accept input or not.
   bool acceptInput;
-  // The last time the ability to accept input was changed.
-  float_t lastAcceptInputChange;
 
   // The timestamp of the last time the update for the camera was started.
   float_t lastTime;
@@ -41,16 +46,17 @@ public:
             ColliderShapeType::BOX),
         controlManager(ControlManager::getInstance()),
         lastTime(glfwGetTime()),
-        acceptInput(true),
-        lastAcceptInputChange(glfwGetTime() - 10.0f) {}
+        acceptInput(true) {}
 
   static void initModel()
   {
     ModelBase::initModelDeps(
         "Cursor",
         "assets/objects/cursor.obj",
-        "assets/textures/cursor.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit_black_alpha.glsl");
+        CURSOR_IMAGE_PATH,
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit_black_alpha.glsl",
+        // The cursor is unlit and drawn in a layer after the rest of the menu (the buttons included), so that it blends over it.
+        {false, false, 2, false, false});
   }
 
   static void deinitModel()
@@ -58,12 +64,69 @@ public:
     ModelBase::deinitModelDeps();
   }
 
+  /**
+   * Create a hardware cursor from the image of the cursor model, so that the menus can show it without drawing the model. The
+   *   image is scaled down by averaging the blocks of its pixels, and its black background is made transparent like the shader
+   *   of the model does, with the tip of the arrow in the top left corner as the hotspot. Must be called on the main thread.
+   * 
+   * @return The hardware cursor, or null if it could not be created.
+   */
+  static GLFWcursor *createHardwareCursor()
+  {
+    uint32_t dataPos, imageSize, width, height;
+    TextureManager::readBmpHeader("Cursor", CURSOR_IMAGE_PATH, dataPos, imageSize, width, height);
+    // The rows of the BMP image are padded to 4 bytes, and stored with the bottom row first.
+    const auto rowSize = ((width * 3) + 3) & ~3u;
+    const AssetFile file(CURSOR_IMAGE_PATH);
+    if (!file.isMapped() || static_cast<uint64_t>(dataPos) + (static_cast<uint64_t>(rowSize) * height) > file.getSize())
+    {
+      return nullptr;
+    }
+    const auto bmpData = reinterpret_cast<const unsigned char *>(file.getData()) + dataPos;
+
+    std::vector<unsigned char> pixels(HARDWARE_CURSOR_SIZE * HARDWARE_CURSOR_SIZE * 4);
+    for (int32_t y = 0; y < HARDWARE_CURSOR_SIZE; y++)
+    {
+      const auto firstRow = (y * height) / HARDWARE_CURSOR_SIZE;
+      const auto lastRow = std::max(firstRow + 1, ((y + 1) * height) / HARDWARE_CURSOR_SIZE);
+      for (int32_t x = 0; x < HARDWARE_CURSOR_SIZE; x++)
+      {
+        const auto firstColumn = (x * width) / HARDWARE_CURSOR_SIZE;
+        const auto lastColumn = std::max(firstColumn + 1, ((x + 1) * width) / HARDWARE_CURSOR_SIZE);
+        // Weigh the colors of the block by their alpha, so that the edges do not darken towards the background.
+        auto color = glm::vec3(0.0f);
+        auto alpha = 0.0f;
+        for (auto row = firstRow; row < lastRow; row++)
+        {
+          for (auto column = firstColumn; column < lastColumn; column++)
+          {
+            const auto bmpPixel = bmpData + ((height - 1 - row) * rowSize) + (column * 3);
+            const auto pixelColor = glm::vec3(bmpPixel[2], bmpPixel[1], bmpPixel[0]) / 255.0f;
+            const auto pixelAlpha = pixelColor.r * pixelColor.g * pixelColor.b;
+            color += pixelColor * pixelAlpha;
+            alpha += pixelAlpha;
+          }
+        }
+        const auto blockSize = static_cast<float_t>((lastRow - firstRow) * (lastColumn - firstColumn));
+        const auto pixel = &pixels[((y * HARDWARE_CURSOR_SIZE) + x) * 4];
+        const auto pixelColor = alpha > 0.0f ? color / alpha : glm::vec3(0.0f);
+        pixel[0] = static_cast<unsigned char>(pixelColor.r * 255.0f);
+        pixel[1] = static_cast<unsigned char>(pixelColor.g * 255.0f);
+        pixel[2] = static_cast<unsigned char>(pixelColor.b * 255.0f);
+        pixel[3] = static_cast<unsigned char>((alpha / blockSize) * 255.0f);
+      }
+    }
+
+    GLFWimage image = {HARDWARE_CURSOR_SIZE, HARDWARE_CURSOR_SIZE, pixels.data()};
+    return glfwCreateCursor(&image, 0, 0);
+  }
+
   /**
    * Creates a new instance of the title model.
    */
   const static std::shared_ptr<CursorModel> create(const std::string &modelId)
   {
-    return std::make_shared<CursorModel>(modelId);
+    return makePooledShared<CursorModel>(modelId);
   }
 
   void update() override
@@ -73,17 +136,14 @@ public:
     // Get the time difference since the start of the last update.
     const auto deltaTime = float_t(currentTime - lastTime);
 
-    // Check if the M key was pressed after 500ms since the last accept input change.
-    if (controlManager.isKeyPressed(GLFW_KEY_M) && (currentTime - lastAcceptInputChange) > 0.5f)
+    // Check if the M key was pressed since the last frame.
+    if (controlManager.wasKeyPressed(GLFW_KEY_M))
     {
       // "M" key was pressed. Toggle accepting input.
       acceptInput = !acceptInput;
 
       setModelPosition(glm::vec3(0.0f));
       controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
-
-      // Update the timestamp for the last time accept input flag was changed.
-      lastAcceptInputChange = currentTime;
     }
 
     // If input is not being accepted, just consume mouse inputs and end.
@@ -93,12 +153,17 @@ public:
     }
 
     const auto cursorPosition = controlManager.getCursorPosition();
-    const auto clampedCursorPosition = glm::clamp(glm::vec2(cursorPosition->getX(), cursorPosition->getY()), glm::vec2(0.05f), glm::vec2(0.95f));
+    const auto clampedCursorPosition = glm::clamp(glm::vec2(cursorPosition.getX(), cursorPosition.getY()), glm::vec2(0.05f), glm::vec2(0.95f));
     controlManager.setCursorPosition(CursorPosition(clampedCursorPosition.x, clampedCursorPosition.y));
 
-    const auto newCursorPosition = glm::vec3((2.0f * ASPECT_RATIO) * (cursorPosition->getX() - 0.5f), -2.0f * (cursorPosition->getY() - 0.5f), 0.0f);
+    const auto newCursorPosition = glm::vec3((2.0f * ASPECT_RATIO) * (cursorPosition.getX() - 0.5f), -2.0f * (cursorPosition.getY() - 0.5f), 0.0f);
     setModelPosition(newCursorPosition);
   }
+
+  uint32_t getCollisionLayer() const override
+  {
+    return CollisionLayer::CURSOR_COLLISION_LAYER;
+  }
 };
 
 #endif
\ No newline at end of file
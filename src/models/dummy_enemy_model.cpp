@@ -17,19 +17,16 @@
 
 class DummyEnemyModel : public ModelBase<DummyEnemyModel>
 {
-private:
-  float_t rotationSpeedY;
-
-  float_t lastTime;
-
 public:
   DummyEnemyModel(const std::string &modelId)
       : ModelBase(
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.1f, 0.1f, 0.1f),
-            ColliderShapeType::SPHERE),
-        rotationSpeedY(-1.0f),
-        lastTime(glfwGetTime()) {}
+            ColliderShapeType::SPHERE)
+  {
+    // Spin the menu enemy in the vertex shaders from the angle it is created with, instead of rotating it every frame.
+    setModelSpin(1.0f, -static_cast<float_t>(glfwGetTime()));
+  }
 
   static void initModel()
   {
@@ -37,7 +34,9 @@ public:
         "DummyEnemy",
         "assets/objects/sphere-saw.obj",
         "assets/textures/sphere-saw.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        // The model is unlit, so it neither casts shadows nor receives light.
+        {false, false, 0, false, false});
   }
 
   static void deinitModel()
@@ -47,17 +46,13 @@ public:
 
   const static std::shared_ptr<DummyEnemyModel> create(const std::string &modelId)
   {
-    return std::make_shared<DummyEnemyModel>(modelId);
+    return makePooledShared<DummyEnemyModel>(modelId);
   }
 
-  void update() override
+  bool isUpdateThreadSafe() const override
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
-
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
-
-    lastTime = currentTime;
+    // The menu enemy is spun by the vertex shaders and has nothing to update, so it can be updated in parallel.
+    return true;
   }
 };
 
@@ -39,7 +39,9 @@ public:
         "DummyPlayer",
         "assets/objects/spaceship.obj",
         "assets/textures/spaceship.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        // The model is unlit, so it neither casts shadows nor receives light.
+        {false, false, 0, false, false});
   }
 
   static void deinitModel()
@@ -49,7 +51,13 @@ public:
 
   const static std::shared_ptr<DummyPlayerModel> create(const std::string &modelId)
   {
-    return std::make_shared<DummyPlayerModel>(modelId);
+    return makePooledShared<DummyPlayerModel>(modelId);
+  }
+
+  bool isUpdateThreadSafe() const override
+  {
+    // The menu player only rotates itself, so it can be updated in parallel.
+    return true;
   }
 
   void update() override
@@ -57,7 +65,7 @@ public:
     const auto currentTime = glfwGetTime();
     const auto deltaTime = currentTime - lastTime;
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+    rotateModel(glm::angleAxis(static_cast<float_t>(-rotationSpeedY * deltaTime), glm::vec3(0.0f, 1.0f, 0.0f)));
 
     lastTime = currentTime;
   }
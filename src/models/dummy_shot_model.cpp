@@ -38,7 +38,9 @@ public:
         "DummyShot",
         "assets/objects/shot.obj",
         "assets/textures/shot.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        // The model is unlit, so it neither casts shadows nor receives light.
+        {false, false, 0, false, false});
   }
 
   static void deinitModel()
@@ -48,7 +50,13 @@ public:
 
   const static std::shared_ptr<DummyShotModel> create(const std::string &modelId)
   {
-    return std::make_shared<DummyShotModel>(modelId);
+    return makePooledShared<DummyShotModel>(modelId);
+  }
+
+  bool isUpdateThreadSafe() const override
+  {
+    // The menu shot only rotates itself, so it can be updated in parallel.
+    return true;
   }
 
   void update() override
@@ -56,7 +64,7 @@ public:
     const auto currentTime = glfwGetTime();
     const auto deltaTime = currentTime - lastTime;
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+    rotateModel(glm::angleAxis(static_cast<float_t>(-rotationSpeedY * deltaTime), glm::vec3(0.0f, 1.0f, 0.0f)));
 
     lastTime = currentTime;
   }
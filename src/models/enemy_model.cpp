@@ -24,18 +24,18 @@ private:
   static std::uniform_real_distribution<float_t> mtInitialRotationDistribution;
   static std::uniform_real_distribution<float_t> mtRotationSpeedDistribution;
 
-  float_t rotationSpeedY;
-
-  float_t lastTime;
-
 public:
   EnemyModel(const std::string &modelId)
       : ModelBase(
             modelId,
-            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, mtInitialRotationDistribution(mtGenerator), 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
-            ColliderShapeType::SPHERE),
-        rotationSpeedY(mtRotationSpeedDistribution(mtGenerator)),
-        lastTime(glfwGetTime()) {}
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
+            ColliderShapeType::SPHERE)
+  {
+    // Spin the enemy from a random angle at a random speed in the vertex shaders, instead of rotating it every step, so that its
+    //   transform (and its place in the collision manager) is left as is. Its sphere collider looks the same from every angle.
+    const auto initialRotation = mtInitialRotationDistribution(mtGenerator);
+    setModelSpin(-mtRotationSpeedDistribution(mtGenerator), initialRotation);
+  }
 
   static void initModel()
   {
@@ -43,7 +43,9 @@ public:
         "Enemy",
         "assets/objects/sphere-saw.obj",
         "assets/textures/sphere-saw.bmp",
-        "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl");
+        "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl",
+        // The enemies look alike from every side and come in crowds, so the distant ones are drawn as impostors.
+        {true, true, 0, false, true});
   }
 
   static void deinitModel()
@@ -51,19 +53,52 @@ public:
     ModelBase::deinitModelDeps();
   }
 
-  const static std::shared_ptr<EnemyModel> create(const std::string &modelId)
+  /**
+   * Seed the generator of the initial rotations and the rotation speeds of the enemies, so that the enemies created after it are
+   *   the same each run (it is seeded from the clock otherwise).
+   * 
+   * @param seed  The seed.
+   */
+  static void seedGenerator(const uint32_t &seed)
+  {
+    mtGenerator.seed(seed);
+  }
+
+  /**
+   * Get the generator of the initial rotations and the rotation speeds of the enemies.
+   * 
+   * @return The generator.
+   */
+  static const std::mt19937 &getGenerator()
   {
-    return std::make_shared<EnemyModel>(modelId);
+    return mtGenerator;
   }
 
-  void update() override
+  /**
+   * Set the state of the generator of the initial rotations and the rotation speeds of the enemies, so that it goes on from
+   *   where the given generator is.
+   * 
+   * @param generator  The generator to take the state of.
+   */
+  static void setGenerator(const std::mt19937 &generator)
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
+    mtGenerator = generator;
+  }
+
+  const static std::shared_ptr<EnemyModel> create(const std::string &modelId)
+  {
+    return makePooledShared<EnemyModel>(modelId);
+  }
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+  bool isUpdateThreadSafe() const override
+  {
+    // The enemy is spun by the vertex shaders and has nothing to update, so the enemies can be updated in parallel.
+    return true;
+  }
 
-    lastTime = currentTime;
+  uint32_t getCollisionLayer() const override
+  {
+    return CollisionLayer::ENEMY_COLLISION_LAYER;
   }
 };
 
@@ -11,8 +11,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
-#include "../include/collider.cpp"
-#include "../include/control.cpp"
+#include "../include/collision.cpp"
 #include "../include/models.cpp"
 
 #include "model_base.cpp"
@@ -25,14 +24,8 @@ class ExitModel : public ModelBase<ExitModel>
 private:
   inline static const auto DEFAULT_SCALE = glm::vec3(0.2f, 0.114f, 1.0f);
 
-  // The model manager responsible for managing the models in the scene.
-  ModelManager &modelManager;
-  // The control manager responsible for managing controls and inputs of the window.
-  const ControlManager &controlManager;
-
-  bool _isClicked;
-
-  std::shared_ptr<ModelBaseIntf> cursor;
+  // Whether the cursor is over the button, as of the last collision pass (or the last pick of the scene, for the hardware cursor).
+  bool isCursorOver;
 
 public:
   ExitModel(const std::string &modelId)
@@ -40,9 +33,7 @@ public:
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), DEFAULT_SCALE,
             ColliderShapeType::BOX),
-        modelManager(ModelManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        _isClicked(false) {}
+        isCursorOver(false) {}
 
   static void initModel()
   {
@@ -50,7 +41,10 @@ public:
         "Exit",
         "assets/objects/exit.obj",
         "assets/textures/exit.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        // The model is unlit, so it neither casts shadows nor receives light. Its layer is drawn after the cached layers of the
+        //   menus every frame, since the button scales up while the cursor is over it.
+        {false, false, 1, false, false});
   }
 
   static void deinitModel()
@@ -63,29 +57,20 @@ public:
    */
   const static std::shared_ptr<ExitModel> create(const std::string &modelId)
   {
-    return std::make_shared<ExitModel>(modelId);
+    return makePooledShared<ExitModel>(modelId);
   }
 
-  bool isClicked()
+  bool isUpdateThreadSafe() const override
   {
-    return _isClicked;
-  }
-
-  void init() override
-  {
-    cursor = modelManager.getModel("Cursor");
+    // The button only scales itself, from the hover state set by its collision events on the main thread.
+    return true;
   }
 
   void update() override
   {
-    const auto cursorCollided = DeepCollisionValidator::haveShapesCollided(cursor->getColliderDetails()->getColliderShape(), this->getColliderDetails()->getColliderShape(), false);
-    if (cursorCollided)
+    // Grow the button while the cursor is over it. Clicks are picked by the scene with a ray cast instead.
+    if (isCursorOver)
     {
-      if (controlManager.isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT))
-      {
-        _isClicked = true;
-      }
-
       setModelScale(DEFAULT_SCALE * glm::vec3(1.1f));
     }
     else
@@ -93,6 +78,42 @@ public:
       setModelScale(DEFAULT_SCALE);
     }
   }
+
+  uint32_t getCollisionLayer() const override
+  {
+    return CollisionLayer::BUTTON_COLLISION_LAYER;
+  }
+
+  uint32_t getCollisionMask() const override
+  {
+    return CollisionLayer::CURSOR_COLLISION_LAYER;
+  }
+
+  ColliderMotionType getColliderMotionType() const override
+  {
+    // The button stays in place, only growing while the cursor is over it.
+    return ColliderMotionType::STATIC_COLLIDER;
+  }
+
+  /**
+   * Set whether the cursor is over the button, for the hardware cursor, which has no model colliding with the button.
+   * 
+   * @param isOver  Whether the cursor is over the button.
+   */
+  void setCursorOver(const bool &isOver)
+  {
+    isCursorOver = isOver;
+  }
+
+  void onCollisionEnter(const std::shared_ptr<ModelBaseIntf> &/* otherModel */) override
+  {
+    isCursorOver = true;
+  }
+
+  void onCollisionExit(const std::shared_ptr<ModelBaseIntf> &/* otherModel */) override
+  {
+    isCursorOver = false;
+  }
 };
 
 #endif
\ No newline at end of file
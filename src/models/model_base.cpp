@@ -18,6 +18,7 @@
 #include "../include/texture.cpp"
 #include "../include/shader.cpp"
 #include "../include/collider.cpp"
+#include "../include/transform.cpp"
 
 #include "model_base_intf.cpp"
 
@@ -31,6 +32,10 @@ class ModelBase : public ModelBaseIntf
 private:
   // The name of the model.
   inline static std::string modelName;
+  // The interned name of the model.
+  inline static NameId modelNameId;
+  // The ID of the model type.
+  inline static const ModelTypeId modelTypeId = createModelTypeId();
 
   // The object details of the model.
   inline static std::shared_ptr<const ObjectDetails> objectDetails;
@@ -38,46 +43,44 @@ private:
   inline static std::shared_ptr<const TextureDetails> textureDetails;
   // The shader program details of the model.
   inline static std::shared_ptr<const ShaderDetails> shaderDetails;
+  // The render flags of the model, lit and casting dynamic shadows in the first layer unless the model type says otherwise.
+  inline static ModelRenderFlags renderFlags = {true, true, 0, false, false};
 
   // The ID of the model.
   const std::string modelId;
+  // The handle the model is registered with in the model manager.
+  RegistryHandle modelHandle;
 
-  // The position of the model.
-  glm::vec3 position;
-  // The rotation of the model.
-  glm::vec3 rotation;
-  // The scale of the model.
-  glm::vec3 scale;
-
-  // The model matrix of the model.
-  glm::mat4 modelMatrix;
+  // The handle of the transformations of the model in the transform manager.
+  const TransformHandle transformHandle;
 
   // The collider details of the model.
   std::shared_ptr<ColliderDetails> colliderDetails;
 
-  /**
-   * Create the model matrix of the madel.
-   */
-  glm::mat4 createModelMatrix()
-  {
-    // Calculate and return the model matrix using the position, rotation, and scaling values of the model.
-    return glm::translate(position) * glm::toMat4(glm::quat(rotation)) * glm::scale(scale);
-  }
-
   const std::shared_ptr<ColliderDetails> createColliderDetails(const ColliderShapeType &colliderShapeType)
   {
-    // Get the vertices of the model.
-    auto modelVertices = objectDetails->getVertices();
+    // Get the transformations of the model.
+    const auto &position = getModelPosition();
+    const auto &rotation = getModelOrientation();
+    const auto &scale = getModelScale();
+    // Get the collider prototype of the object, whose extents were calculated once when it was loaded.
+    const auto &colliderPrototype = objectDetails->getColliderPrototype();
     // Check what collider shape is required,
     switch (colliderShapeType)
     {
     case BOX:
       // Create a box collider for the model.
-      return std::make_shared<ColliderDetails>(modelName + "::Collider", std::make_shared<BoxColliderShape>(position, rotation, scale, modelVertices));
+      return makePooledShared<ColliderDetails>(modelName + "::Collider", makePooledShared<BoxColliderShape>(position, rotation, scale, colliderPrototype));
       break;
+    case CYLINDER:
+      // Create a cylinder collider for the model.
+      return makePooledShared<ColliderDetails>(modelName + "::Collider", makePooledShared<CylinderColliderShape>(position, rotation, scale, colliderPrototype));
+    case PILL:
+      // Create a pill collider for the model.
+      return makePooledShared<ColliderDetails>(modelName + "::Collider", makePooledShared<PillColliderShape>(position, rotation, scale, colliderPrototype));
     default:
       // Create a sphere collider for the model.
-      return std::make_shared<ColliderDetails>(modelName + "::Collider", std::make_shared<SphereColliderShape>(position, rotation, scale, modelVertices));
+      return makePooledShared<ColliderDetails>(modelName + "::Collider", makePooledShared<SphereColliderShape>(position, rotation, scale, colliderPrototype));
     }
   }
 
@@ -87,12 +90,12 @@ protected:
       const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale,
       const std::shared_ptr<ColliderShape> &colliderShape)
       : modelId(modelId),
-        position(position),
-        rotation(rotation),
-        scale(scale),
-        modelMatrix(createModelMatrix()),
-        colliderDetails(std::make_shared<ColliderDetails>(modelName + "::Collider", colliderShape))
+        modelHandle(INVALID_REGISTRY_HANDLE),
+        transformHandle(transformManager.createTransform(position, glm::quat(rotation), scale)),
+        colliderDetails(makePooledShared<ColliderDetails>(modelName + "::Collider", colliderShape))
   {
+    // Have the world AABB of the transformations follow the collider of the model.
+    transformManager.setColliderShape(transformHandle, colliderDetails->getColliderShape().get());
   }
 
   ModelBase(
@@ -100,28 +103,43 @@ protected:
       const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale,
       const ColliderShapeType &colliderShapeType)
       : modelId(modelId),
-        position(position),
-        rotation(rotation),
-        scale(scale),
-        modelMatrix(createModelMatrix()),
+        modelHandle(INVALID_REGISTRY_HANDLE),
+        transformHandle(transformManager.createTransform(position, glm::quat(rotation), scale)),
         colliderDetails(createColliderDetails(colliderShapeType))
   {
+    // Have the world AABB of the transformations follow the collider of the model.
+    transformManager.setColliderShape(transformHandle, colliderDetails->getColliderShape().get());
   }
 
   /**
-   * Initialize the base model dependencies
+   * Initialize the base model dependencies. The files are read on worker threads, and the object and shader program are created by steps
+   *   queued on the scene loader, so the dependencies are only usable once the loader finishes its earlier steps. While the scene
+   *   preloader records the models of another scene, the dependencies are preloaded or retained for it instead.
    */
   static void initModelDeps(
       const std::string &modelName,
       const std::string &modelObjectFilePath,
       const std::string &modelTextureFilePath,
-      const std::string &modelVertexShaderFilePath, const std::string &modelFragmentShaderFilePath)
+      const std::string &modelVertexShaderFilePath, const std::string &modelFragmentShaderFilePath,
+      const ModelRenderFlags &modelRenderFlags = {true, true, 0, false, false})
   {
-    objectDetails = objectManager.createObject(modelName + "::Object", modelObjectFilePath);
-    textureDetails = textureManager.create2dTexture(modelName + "::Texture", modelTextureFilePath);
-    shaderDetails = shaderManager.createShaderProgram(modelName + "::Shader", modelVertexShaderFilePath, modelFragmentShaderFilePath);
+    if (scenePreloader.isRecordingModels())
+    {
+      scenePreloader.recordModelDeps(modelName, modelObjectFilePath, modelTextureFilePath, modelVertexShaderFilePath, modelFragmentShaderFilePath);
+      return;
+    }
 
+    STARTUP_PHASE("Model Deps", modelName);
     ModelBase::modelName = modelName;
+    ModelBase::modelNameId = NameInterner::getInstance().intern(modelName);
+    ModelBase::renderFlags = modelRenderFlags;
+
+    // Load the object, the shader program and the texture of the model in sequence, their files all read in the background
+    //   together, and their GL work done in that order once each is read.
+    SceneLoadFlow(sceneLoader)
+        .loadObject(modelName + "::Object", modelObjectFilePath, objectDetails)
+        .loadShader(modelName + "::Shader", modelVertexShaderFilePath, modelFragmentShaderFilePath, shaderDetails)
+        .loadTexture(modelName + "::Texture", modelTextureFilePath, textureDetails);
   }
 
   /**
@@ -135,9 +153,20 @@ protected:
     textureManager.destroyTexture(textureDetails);
     // Destroy the shader program for the model.
     shaderManager.destroyShaderProgram(shaderDetails);
+
+    // Clear the dependencies, since they are created again by the next scene loading the model.
+    objectDetails = nullptr;
+    textureDetails = nullptr;
+    shaderDetails = nullptr;
   }
 
 public:
+  ~ModelBase()
+  {
+    // Free the transformations of the model to be reused by the next model created.
+    transformManager.destroyTransform(transformHandle);
+  }
+
   /**
    * Get the ID of the model.
    * 
@@ -148,16 +177,105 @@ public:
     return modelId;
   }
 
+  /**
+   * Get the handle the model is registered with in the model manager.
+   * 
+   * @return The model handle, or the invalid handle if the model is not registered.
+   */
+  const RegistryHandle &getModelHandle() const
+  {
+    return modelHandle;
+  }
+
+  /**
+   * Set the handle the model is registered with in the model manager, done by the model manager when registering the model.
+   * 
+   * @param newModelHandle  The model handle.
+   */
+  void setModelHandle(const RegistryHandle &newModelHandle)
+  {
+    modelHandle = newModelHandle;
+  }
+
   /**
    * Get the name of the model.
    * 
    * @return The model name.
    */
-  std::string getModelName() const
+  const std::string &getModelName() const
   {
     return modelName;
   }
 
+  /**
+   * Get the interned name of the model.
+   * 
+   * @return The interned model name.
+   */
+  const NameId &getModelNameId() const
+  {
+    return modelNameId;
+  }
+
+  /**
+   * Get the ID of the model type, without a model of the type.
+   * 
+   * @return The model type ID.
+   */
+  static const ModelTypeId &getTypeId()
+  {
+    return modelTypeId;
+  }
+
+  /**
+   * Get the ID of the type of the model.
+   * 
+   * @return The model type ID.
+   */
+  const ModelTypeId &getModelTypeId() const
+  {
+    return modelTypeId;
+  }
+
+  /**
+   * Update the given models of the type all at once. The model types whose models can all be updated by a single loop (e.g. over
+   *   their transformations) hide it with their own, while the default one calls the update of each model without a virtual
+   *   call, which is compiled out entirely for the types that have nothing to update.
+   * 
+   * @param models       The models of the type.
+   * @param modelsCount  The number of models.
+   */
+  static void updateBatch(T *const *models, const size_t &modelsCount)
+  {
+    for (size_t i = 0; i < modelsCount; i++)
+    {
+      models[i]->T::update();
+    }
+  }
+
+  /**
+   * Update the given models of the type all at once, with the batch update of the type.
+   * 
+   * @param models       The models, all of the type.
+   * @param modelsCount  The number of models.
+   */
+  static void updateModelsBatch(ModelBaseIntf *const *models, const size_t &modelsCount)
+  {
+    // Cast the models to the type on the thread running the batch, into the models kept around to avoid reallocating every frame.
+    static thread_local std::vector<T *> typedModels;
+    typedModels.clear();
+    for (size_t i = 0; i < modelsCount; i++)
+    {
+      typedModels.push_back(static_cast<T *>(models[i]));
+    }
+    T::updateBatch(typedModels.data(), modelsCount);
+  }
+
+  ModelBatchUpdate getBatchUpdate() const
+  {
+    return &ModelBase::updateModelsBatch;
+  }
+
   /**
    * Get the position of the model.
    * 
@@ -165,17 +283,27 @@ public:
    */
   const glm::vec3 &getModelPosition() const
   {
-    return position;
+    return transformManager.getPosition(transformHandle);
   }
 
   /**
    * Get the rotation of the model.
    * 
-   * @return The model rotation.
+   * @return The model rotation (a unit quaternion).
+   */
+  const glm::quat &getModelOrientation() const
+  {
+    return transformManager.getRotation(transformHandle);
+  }
+
+  /**
+   * Get the rotation of the model as Euler angles, converted from its quaternion.
+   * 
+   * @return The model rotation (Euler angles, in radians).
    */
-  const glm::vec3 &getModelRotation() const
+  glm::vec3 getModelRotation() const
   {
-    return rotation;
+    return glm::eulerAngles(getModelOrientation());
   }
 
   /**
@@ -185,7 +313,7 @@ public:
    */
   const glm::vec3 &getModelScale() const
   {
-    return scale;
+    return transformManager.getScale(transformHandle);
   }
 
   /**
@@ -218,6 +346,16 @@ public:
     return shaderDetails;
   }
 
+  /**
+   * Get the render flags shared by all the models of the model type.
+   * 
+   * @return The model render flags.
+   */
+  const ModelRenderFlags &getRenderFlags() const
+  {
+    return renderFlags;
+  }
+
   /**
    * Get the collider details of the model.
    * 
@@ -235,7 +373,39 @@ public:
    */
   const glm::mat4 &getModelMatrix() const
   {
-    return modelMatrix;
+    return transformManager.getWorldMatrix(transformHandle);
+  }
+
+  /**
+   * Get the model matrix of the model spun to the given time, as the vertex shaders draw it.
+   * 
+   * @param time  The time to spin the model to (in seconds).
+   * 
+   * @return The spun model matrix.
+   */
+  glm::mat4 getSpunModelMatrix(const double_t &time) const
+  {
+    return transformManager.getSpunWorldMatrix(transformHandle, time);
+  }
+
+  /**
+   * Get the transform version of the model.
+   * 
+   * @return The model transform version.
+   */
+  const uint64_t &getTransformVersion() const
+  {
+    return transformManager.getVersion(transformHandle);
+  }
+
+  /**
+   * Get the handle of the transformations of the model in the transform manager.
+   * 
+   * @return The model transform handle.
+   */
+  const TransformHandle &getTransformHandle() const
+  {
+    return transformHandle;
   }
 
   /**
@@ -245,27 +415,58 @@ public:
    */
   void setModelPosition(const glm::vec3 &newPosition)
   {
-    // Set the new position.
-    position = newPosition;
+    // Set the new position, which marks the transformations as modified only if the value actually changed, leaving the collider
+    //   as is otherwise.
+    if (!transformManager.setPosition(transformHandle, newPosition))
+    {
+      return;
+    }
     // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(newPosition, rotation, scale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    colliderDetails->getColliderShape()->updateTransformations(newPosition, getModelOrientation(), getModelScale());
+    // Mark the model to be moved in the collision manager and the scene tree before their next queries.
+    collisionManager.markModelMoved(this);
+    sceneTreeManager.markModelMoved(this);
   }
 
   /**
    * Set the rotation of the model.
    * 
-   * @param newRotation  The model rotation.
+   * @param newOrientation  The model rotation (a unit quaternion).
    */
-  void setModelRotation(const glm::vec3 &newRotation)
+  void setModelOrientation(const glm::quat &newOrientation)
   {
-    // Set the new rotation.
-    rotation = newRotation;
+    // Set the new rotation, which marks the transformations as modified only if the value actually changed. A collider that
+    //   looks the same from every side (along with its AABB) is left as is by the rotation, so it is not refit either.
+    if (!transformManager.setRotation(transformHandle, newOrientation) || colliderDetails->getColliderShape()->isRotationInvariant())
+    {
+      return;
+    }
     // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(position, newRotation, scale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    colliderDetails->getColliderShape()->updateTransformations(getModelPosition(), newOrientation, getModelScale());
+    // Mark the model to be moved in the collision manager and the scene tree before their next queries.
+    collisionManager.markModelMoved(this);
+    sceneTreeManager.markModelMoved(this);
+  }
+
+  /**
+   * Set the rotation of the model from Euler angles, converted to a quaternion once here.
+   * 
+   * @param newRotation  The model rotation (Euler angles, in radians).
+   */
+  void setModelRotation(const glm::vec3 &newRotation)
+  {
+    setModelOrientation(glm::quat(newRotation));
+  }
+
+  /**
+   * Rotate the model further by the given rotation, applied in world space on top of its current rotation.
+   * 
+   * @param rotation  The rotation to apply (a unit quaternion).
+   */
+  void rotateModel(const glm::quat &rotation)
+  {
+    // Normalize the product, so that the rounding errors of the rotations applied every frame do not add up.
+    setModelOrientation(glm::normalize(rotation * getModelOrientation()));
   }
 
   /**
@@ -275,12 +476,29 @@ public:
    */
   void setModelScale(const glm::vec3 &newScale)
   {
-    // Set the new scale.
-    scale = newScale;
+    // Set the new scale, which marks the transformations as modified only if the value actually changed, leaving the collider
+    //   as is otherwise.
+    if (!transformManager.setScale(transformHandle, newScale))
+    {
+      return;
+    }
     // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(position, rotation, newScale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    colliderDetails->getColliderShape()->updateTransformations(getModelPosition(), getModelOrientation(), newScale);
+    // Mark the model to be moved in the collision manager and the scene tree before their next queries.
+    collisionManager.markModelMoved(this);
+    sceneTreeManager.markModelMoved(this);
+  }
+
+  /**
+   * Set the spin of the model about its local Y axis, animated by the vertex shaders from the frame time. The collider is left
+   *   as is, since the spin is not part of the rotation it is transformed with.
+   * 
+   * @param speed  The spin speed (in radians per second).
+   * @param phase  The spin angle at time 0 (in radians).
+   */
+  void setModelSpin(const float_t &speed, const float_t &phase)
+  {
+    transformManager.setSpin(transformHandle, glm::vec2(speed, phase));
   }
 };
 
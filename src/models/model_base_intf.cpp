@@ -18,6 +18,36 @@
 #include "../include/texture.cpp"
 #include "../include/shader.cpp"
 #include "../include/collider.cpp"
+#include "../include/scene_loader.cpp"
+#include "../include/scene_preloader.cpp"
+#include "../include/collision.cpp"
+#include "../include/scene_tree.cpp"
+#include "../include/transform.cpp"
+#include "../include/registry.cpp"
+
+/**
+ * Structure for defining how the render manager treats all the models of a model type.
+ */
+struct ModelRenderFlags
+{
+  // Whether the models are drawn into the shadowmaps of the lights.
+  bool isShadowCaster;
+  // Whether the models are shaded by the lights (if not, they are drawn with lighting and shadows compiled out of their shader).
+  bool isLightReceiver;
+  // The layer the models are drawn in, with higher layers drawn after lower ones regardless of their state or depth.
+  uint32_t renderLayer;
+  // Whether the models never move, so that their shadows are cached apart from the ones of the other casters while any are registered.
+  bool isStaticCaster;
+  // Whether the distant models are drawn as billboards baked from the object of the model type (with deferred shading).
+  bool hasImpostors;
+};
+
+// The ID of a model type, assigned to each model type once at startup, so that the types can be compared without their names.
+typedef uint32_t ModelTypeId;
+
+class ModelBaseIntf;
+// The function updating a batch of models of the same model type at once, given the models and their number.
+typedef void (*ModelBatchUpdate)(ModelBaseIntf *const *models, const size_t &modelsCount);
 
 /**
  * Base class for creating models.
@@ -32,8 +62,31 @@ protected:
   static TextureManager &textureManager;
   // The shader manager responsible for creating shader programs.
   static ShaderManager &shaderManager;
+  // The scene loader responsible for spreading the model loading over multiple frames.
+  static SceneLoader &sceneLoader;
+  // The scene preloader responsible for recording the model dependencies of the other scenes ahead of them.
+  static ScenePreloader &scenePreloader;
+  // The collision manager responsible for finding the models that can collide with each other.
+  static CollisionManager &collisionManager;
+  // The scene tree manager responsible for finding the models the renderer needs.
+  static SceneTreeManager &sceneTreeManager;
+  // The transform manager storing the transformations of all the models.
+  static TransformManager &transformManager;
+
+  /**
+   * Create the ID of a new model type, counting up from 0 so that the IDs can index the arrays kept per model type.
+   * 
+   * @return The ID of the model type.
+   */
+  static ModelTypeId createModelTypeId()
+  {
+    static ModelTypeId modelTypesCount = 0;
+    return modelTypesCount++;
+  }
 
 public:
+  virtual ~ModelBaseIntf() {}
+
   /**
    * Get the ID of the model.
    * 
@@ -46,7 +99,21 @@ public:
    * 
    * @return The model name.
    */
-  virtual std::string getModelName() const = 0;
+  virtual const std::string &getModelName() const = 0;
+
+  /**
+   * Get the interned name of the model, which is shared by all the models of the same type.
+   * 
+   * @return The interned model name.
+   */
+  virtual const NameId &getModelNameId() const = 0;
+
+  /**
+   * Get the ID of the type of the model, the same for all the models of the same type.
+   * 
+   * @return The model type ID.
+   */
+  virtual const ModelTypeId &getModelTypeId() const = 0;
 
   /**
    * Get the position of the model.
@@ -58,9 +125,16 @@ public:
   /**
    * Get the rotation of the model.
    * 
-   * @return The model rotation.
+   * @return The model rotation (a unit quaternion).
+   */
+  virtual const glm::quat &getModelOrientation() const = 0;
+
+  /**
+   * Get the rotation of the model as Euler angles.
+   * 
+   * @return The model rotation (Euler angles, in radians).
    */
-  virtual const glm::vec3 &getModelRotation() const = 0;
+  virtual glm::vec3 getModelRotation() const = 0;
 
   /**
    * Get the scale of the model.
@@ -90,6 +164,13 @@ public:
    */
   virtual std::shared_ptr<const ShaderDetails> &getShaderDetails() = 0;
 
+  /**
+   * Get the render flags shared by all the models of the model type.
+   * 
+   * @return The model render flags.
+   */
+  virtual const ModelRenderFlags &getRenderFlags() const = 0;
+
   /**
    * Get the collider details of the model.
    * 
@@ -104,6 +185,35 @@ public:
    */
   virtual const glm::mat4 &getModelMatrix() const = 0;
 
+  /**
+   * Get the transform version of the model, which changes whenever the position, rotation or scale of the model change.
+   * 
+   * @return The model transform version.
+   */
+  virtual const uint64_t &getTransformVersion() const = 0;
+
+  /**
+   * Get the handle of the transformations of the model in the transform manager, to read them along with the ones of the other
+   *   models.
+   * 
+   * @return The model transform handle.
+   */
+  virtual const TransformHandle &getTransformHandle() const = 0;
+
+  /**
+   * Get the handle the model is registered with in the model manager.
+   * 
+   * @return The model handle, or the invalid handle if the model is not registered.
+   */
+  virtual const RegistryHandle &getModelHandle() const = 0;
+
+  /**
+   * Set the handle the model is registered with in the model manager, done by the model manager when registering the model.
+   * 
+   * @param newModelHandle  The model handle.
+   */
+  virtual void setModelHandle(const RegistryHandle &newModelHandle) = 0;
+
   /**
    * Set the position of the model.
    * 
@@ -114,10 +224,24 @@ public:
   /**
    * Set the rotation of the model.
    * 
-   * @param newRotation  The model rotation.
+   * @param newOrientation  The model rotation (a unit quaternion).
+   */
+  virtual void setModelOrientation(const glm::quat &newOrientation) = 0;
+
+  /**
+   * Set the rotation of the model from Euler angles.
+   * 
+   * @param newRotation  The model rotation (Euler angles, in radians).
    */
   virtual void setModelRotation(const glm::vec3 &newRotation) = 0;
 
+  /**
+   * Rotate the model further by the given rotation, applied in world space on top of its current rotation.
+   * 
+   * @param rotation  The rotation to apply (a unit quaternion).
+   */
+  virtual void rotateModel(const glm::quat &rotation) = 0;
+
   /**
    * Set the scale of the model.
    * 
@@ -125,6 +249,48 @@ public:
    */
   virtual void setModelScale(const glm::vec3 &newScale) = 0;
 
+  /**
+   * Get the collision layers the model is in.
+   * 
+   * @return The model collision layers.
+   */
+  virtual uint32_t getCollisionLayer() const
+  {
+    return CollisionLayer::NO_COLLISION_LAYER;
+  }
+
+  /**
+   * Get the collision layers the model wants collision events for.
+   * 
+   * @return The model collision mask.
+   */
+  virtual uint32_t getCollisionMask() const
+  {
+    return CollisionLayer::NO_COLLISION_LAYER;
+  }
+
+  /**
+   * Get how the collider of the model moves.
+   * 
+   * @return The model collider motion type.
+   */
+  virtual ColliderMotionType getColliderMotionType() const
+  {
+    return ColliderMotionType::DYNAMIC_COLLIDER;
+  }
+
+  /**
+   * Check whether the update of the model can run on a worker thread, in parallel with the updates of the other models of the
+   *   same kind. Such updates may only modify the model itself, read their input from the input snapshot of the control manager,
+   *   and queue any registrations and de-registrations with the managers instead of making them.
+   * 
+   * @return Whether the model update is thread-safe.
+   */
+  virtual bool isUpdateThreadSafe() const
+  {
+    return false;
+  }
+
   /**
    * Initialize the model once registered.
    */
@@ -135,14 +301,54 @@ public:
    */
   virtual void deinit() {}
 
+  /**
+   * Restore the state the model keeps of its own to the one it was created with, once a scene snapshot brings the model back for
+   *   the scene to run again (the snapshot restores its transformations).
+   */
+  virtual void restoreInitialState() {}
+
+  /**
+   * Get the function that the model manager updates the models of the type of the model with, once per model type and frame
+   *   instead of once per model.
+   * 
+   * @return The batch update function of the model type.
+   */
+  virtual ModelBatchUpdate getBatchUpdate() const = 0;
+
   /**
    * Update the model during the update step before starting rendering.
    */
   virtual void update() {}
+
+  /**
+   * Handle the model starting to touch another model whose layer is in the collision mask of the model.
+   * 
+   * @param otherModel  The model it started touching.
+   */
+  virtual void onCollisionEnter(const std::shared_ptr<ModelBaseIntf> &/* otherModel */) {}
+
+  /**
+   * Handle the model still touching another model whose layer is in the collision mask of the model.
+   * 
+   * @param otherModel  The model it is touching.
+   */
+  virtual void onCollisionStay(const std::shared_ptr<ModelBaseIntf> &/* otherModel */) {}
+
+  /**
+   * Handle the model no longer touching another model whose layer is in the collision mask of the model.
+   * 
+   * @param otherModel  The model it stopped touching.
+   */
+  virtual void onCollisionExit(const std::shared_ptr<ModelBaseIntf> &/* otherModel */) {}
 };
 
 ObjectManager &ModelBaseIntf::objectManager = ObjectManager::getInstance();
 TextureManager &ModelBaseIntf::textureManager = TextureManager::getInstance();
 ShaderManager &ModelBaseIntf::shaderManager = ShaderManager::getInstance();
+SceneLoader &ModelBaseIntf::sceneLoader = SceneLoader::getInstance();
+ScenePreloader &ModelBaseIntf::scenePreloader = ScenePreloader::getInstance();
+CollisionManager &ModelBaseIntf::collisionManager = CollisionManager::getInstance();
+SceneTreeManager &ModelBaseIntf::sceneTreeManager = SceneTreeManager::getInstance();
+TransformManager &ModelBaseIntf::transformManager = TransformManager::getInstance();
 
 #endif
\ No newline at end of file
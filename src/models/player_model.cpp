@@ -12,8 +12,10 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../include/control.cpp"
+#include "../include/simulation_clock.cpp"
 #include "../include/light.cpp"
 #include "../include/models.cpp"
+#include "../include/attachment.cpp"
 
 #include "model_base.cpp"
 #include "shot_model.cpp"
@@ -32,49 +34,49 @@ private:
   ModelManager &modelManager;
   // The light manager responsible for managing the lights in the scene.
   LightManager &lightManager;
+  // The attachment manager the eye lights follow the player by.
+  AttachmentManager &attachmentManager;
   // The control manager responsible for managing controls and inputs of the window.
   const ControlManager &controlManager;
+  // The simulation clock the model is updated with.
+  const SimulationClock &simulationClock;
 
   // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
+  double_t lastTime;
   // The timestamp of the last time a shot was created.
-  float_t lastShot;
-  // The ID of the last created shot.
-  uint32_t shotId;
+  double_t lastShot;
 
   // Whether to show the eye light or not.
   static bool isEyeLightPresent;
-  // The timestamp for the last time the eye light was toggled.
-  static float_t lastEyeLightChange;
   // The instance of the first eye light for the player.
   std::shared_ptr<ConeLight> eyeLight1;
   // The instance of the second eye light for the player.
   std::shared_ptr<ConeLight> eyeLight2;
+  // The handles the eye lights are registered with in the light manager.
+  RegistryHandle eyeLight1Handle, eyeLight2Handle;
 
   /**
-   * Create a new eye light.
-   * 
-   * @param position  The position of the model.
+   * Create a new eye light, attached to the player.
    */
-  void createEyeLight(glm::vec3 position)
+  void createEyeLight()
   {
     // Create first eye light and set its properties.
     eyeLight1 = ConeLight::create(getModelId() + "::EyeLight1");
-    eyeLight1->setLightPosition(glm::vec3(position.x + 2.12f, position.y - 0.089f, position.z - 2.5f));
+    attachmentManager.attachLight(eyeLight1, getTransformHandle(), glm::vec3(-2.12f, -0.089f, -2.5f));
     eyeLight1->setLightAngles(glm::pi<float_t>(), 0.0f);
     eyeLight1->setLightIntensity(350.0f);
     // Register the first eye light.
     eyeLight1->init();
-    lightManager.registerLight(eyeLight1);
+    eyeLight1Handle = lightManager.registerLight(eyeLight1);
 
     // Create first eye light and set its properties.
     eyeLight2 = ConeLight::create(getModelId() + "::EyeLight2");
-    eyeLight1->setLightPosition(glm::vec3(position.x - 2.12f, position.y - 0.089f, position.z - 2.5f));
+    attachmentManager.attachLight(eyeLight2, getTransformHandle(), glm::vec3(2.12f, -0.089f, -2.5f));
     eyeLight2->setLightAngles(glm::pi<float_t>(), 0.0f);
     eyeLight2->setLightIntensity(350.0f);
     // Register the first eye light.
     eyeLight2->init();
-    lightManager.registerLight(eyeLight2);
+    eyeLight2Handle = lightManager.registerLight(eyeLight2);
 
     // Update the eye light toggle.
     isEyeLightPresent = true;
@@ -86,28 +88,16 @@ private:
   void destroyEyeLight()
   {
     // Destroy the eye lights.
+    attachmentManager.detachLight(eyeLight1);
+    attachmentManager.detachLight(eyeLight2);
     eyeLight1->deinit();
-    lightManager.deregisterLight(eyeLight1);
+    lightManager.deregisterLight(eyeLight1Handle);
     eyeLight2->deinit();
-    lightManager.deregisterLight(eyeLight2);
+    lightManager.deregisterLight(eyeLight2Handle);
     // Update the eye light toggle.
     isEyeLightPresent = false;
   }
 
-  /**
-   * Update the existing eye light.
-   */
-  void updateEyeLight(const glm::vec3 &newPosition)
-  {
-    // Check if eye light toggle is enabled.
-    if (isEyeLightPresent)
-    {
-      // Update the eye lights.
-      eyeLight1->setLightPosition(glm::vec3(newPosition.x - 2.12f, newPosition.y - 0.089f, newPosition.z - 2.5f));
-      eyeLight2->setLightPosition(glm::vec3(newPosition.x + 2.12f, newPosition.y - 0.089f, newPosition.z - 2.5f));
-    }
-  }
-
 public:
   PlayerModel(const std::string &modelId)
       : ModelBase(
@@ -116,10 +106,13 @@ public:
             ColliderShapeType::BOX),
         modelManager(ModelManager::getInstance()),
         lightManager(LightManager::getInstance()),
+        attachmentManager(AttachmentManager::getInstance()),
         controlManager(ControlManager::getInstance()),
-        lastTime(glfwGetTime()),
-        lastShot(glfwGetTime() - 10.0f),
-        shotId(0) {}
+        simulationClock(SimulationClock::getInstance()),
+        lastTime(simulationClock.getTime()),
+        lastShot(simulationClock.getTime() - 10.0f),
+        eyeLight1Handle(INVALID_REGISTRY_HANDLE),
+        eyeLight2Handle(INVALID_REGISTRY_HANDLE) {}
 
   static void initModel()
   {
@@ -140,7 +133,7 @@ public:
    */
   const static std::shared_ptr<PlayerModel> create(const std::string &modelId)
   {
-    return std::make_shared<PlayerModel>(modelId);
+    return makePooledShared<PlayerModel>(modelId);
   }
 
   void init() override
@@ -152,7 +145,7 @@ public:
     if (isEyeLightPresent)
     {
       // Create the eye lights.
-      createEyeLight(getModelPosition());
+      createEyeLight();
     }
   }
 
@@ -167,69 +160,75 @@ public:
     }
   }
 
+  void restoreInitialState() override
+  {
+    // Take the time the player is brought back at as the time it was last updated, and allow it to shoot right away.
+    lastTime = simulationClock.getTime();
+    lastShot = lastTime - 10.0f;
+  }
+
   void update() override
   {
     // Get the timestamp for the start of the update.
-    auto currentTime = glfwGetTime();
+    auto currentTime = simulationClock.getTime();
     // Get the time difference since the start of the last update.
     auto deltaTime = currentTime - lastTime;
 
-    // Check if "J" key was pressed after 500ms since the last eye light toggle.
-    if (controlManager.isKeyPressed(GLFW_KEY_J) && (currentTime - lastEyeLightChange) > 0.5f)
+    // Read the input as of the start of the simulation step, so that a key press toggles once however many steps run per frame.
+    const auto &input = controlManager.getSimulationInputSnapshot();
+
+    // Check if "J" key was pressed since the last simulation step.
+    if (input.wasKeyPressed(GLFW_KEY_J))
     {
-      // "H" key was pressed. Toggle the eye light and create/destroy it accordingly.
+      // "J" key was pressed. Toggle the eye light and create/destroy it accordingly.
       isEyeLightPresent = !isEyeLightPresent;
       if (isEyeLightPresent)
       {
-        createEyeLight(getModelPosition());
+        createEyeLight();
       }
       else
       {
         destroyEyeLight();
       }
-      // Update the timestamp for when the eye light was last toggled.
-      lastEyeLightChange = currentTime;
+    }
+
+    // Check if "H" key was pressed since the last simulation step.
+    if (input.wasKeyPressed(GLFW_KEY_H))
+    {
+      // "H" key was pressed. Toggle the shot light.
+      ShotModel::toggleShotLight();
     }
 
     // Get the player position.
     auto newPosition = getModelPosition();
     // Depending on which key was pressed, move player accordingly (up, down, left, or right).
-    if (controlManager.isKeyPressed(GLFW_KEY_W))
+    if (input.isKeyPressed(GLFW_KEY_W))
     {
       newPosition.y += deltaTime * keyboardSpeed;
     }
-    if (controlManager.isKeyPressed(GLFW_KEY_S))
+    if (input.isKeyPressed(GLFW_KEY_S))
     {
       newPosition.y -= deltaTime * keyboardSpeed;
     }
-    if (controlManager.isKeyPressed(GLFW_KEY_D))
+    if (input.isKeyPressed(GLFW_KEY_D))
     {
       newPosition.x += deltaTime * keyboardSpeed;
     }
-    if (controlManager.isKeyPressed(GLFW_KEY_A))
+    if (input.isKeyPressed(GLFW_KEY_A))
     {
       newPosition.x -= deltaTime * keyboardSpeed;
     }
 
     // Clamp the player position within the defined bounds of the player space.
     newPosition = glm::vec3(glm::clamp<float_t>(newPosition.x, -11.0f, 11.0f), glm::clamp<float_t>(newPosition.y, -6.0f, 6.0f), newPosition.z);
-    // Update the shot position.
+    // Update the player position, which the eye lights follow.
     setModelPosition(newPosition);
-    // Update the eye lights.
-    updateEyeLight(newPosition);
 
     // Check if "Space" key was pressed after 500ms since the last shot creation.
-    if (controlManager.isKeyPressed(GLFW_KEY_SPACE) && (currentTime - lastShot) > 0.17f)
+    if (input.isKeyPressed(GLFW_KEY_SPACE) && (currentTime - lastShot) > 0.17f)
     {
-      // "Space" was pressed. Create a new shot and set its properties.
-      const auto newShot = ShotModel::create("Shot" + std::to_string(shotId));
-      newShot->setModelPosition(glm::vec3(newPosition.x, newPosition.y - 0.05f, newPosition.z - 2.225f));
-      // Register the shot model.
-      newShot->init();
-      modelManager.registerModel(newShot);
-
-      // Increment the next usable shot ID.
-      shotId++;
+      // "Space" was pressed. Spawn a shot from the shot pool in front of the player.
+      ShotModel::spawn(glm::vec3(newPosition.x, newPosition.y - 0.05f, newPosition.z - 2.225f));
       // Update the timestamp for when a shot was last created.
       lastShot = currentTime;
     }
@@ -243,7 +242,5 @@ public:
 float_t PlayerModel::keyboardSpeed = 10.0f;
 // Initialize the eye light toggle static variable.
 bool PlayerModel::isEyeLightPresent = true;
-// Initialize the last time the eye light toggle was changed static variable.
-float_t PlayerModel::lastEyeLightChange = -1;
 
 #endif
\ No newline at end of file
@@ -11,12 +11,18 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "../include/constants.cpp"
 #include "../include/models.cpp"
+#include "../include/model_pool.cpp"
 #include "../include/light.cpp"
 #include "../include/control.cpp"
+#include "../include/simulation_clock.cpp"
+#include "../include/collision.cpp"
+#include "../include/gpu_shot_collision.cpp"
+#include "../include/attachment.cpp"
 
 #include "model_base.cpp"
-#include "../light/point_light.cpp"
+#include "../light/unshadowed_point_light.cpp"
 
 /**
  * Class that represents a shot/bullet model.
@@ -28,59 +34,68 @@ private:
   static double shotSpeed;
   // Whether to show the light or not.
   static bool isShotLightPresent;
-  // The timestamp for the last time the shot light was toggled.
-  static float_t lastShotLightChange;
+  // The pool of the shots, reused between spawns along with their lights.
+  static ModelPool<ShotModel> shotPool;
 
   // The model manager responsible for managing the models in the scene.
   ModelManager &modelManager;
   // The light manager responsible for managing the lights in the scene.
   LightManager &lightManager;
-  // The control manager responsible for managing controls and inputs of the window.
-  const ControlManager &controlManager;
+  // The attachment manager the shot light follows the shot by.
+  AttachmentManager &attachmentManager;
+  // The simulation clock the model is updated with.
+  const SimulationClock &simulationClock;
+  // The GPU shot collision manager the shot is tested against the enemies by, if it is supported.
+  GpuShotCollisionManager &gpuShotCollisionManager;
 
-  float_t rotationSpeedZ;
+  // The rotation applied to the shot every update, about the world Z axis.
+  const glm::quat rotationStep;
 
   // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
+  double_t lastTime;
 
-  // The instance of the point light for the shot.
-  std::shared_ptr<PointLight> shotLight;
+  // The instance of the point light for the shot, created along with the shot and kept for all its spawns.
+  //   It casts no shadows, so that rapid fire does not take the shadowmaps from the lights of the scene.
+  const std::shared_ptr<UnshadowedPointLight> shotLight;
+  // Whether the shot light is registered with the light manager (or queued to be).
+  bool isShotLightRegistered;
+  // The slot of the shot in the GPU shot collision (INVALID_SHOT_INDEX if the shot is left to the collision pass).
+  uint32_t gpuShotIndex;
 
   /**
-   * Create a new shot light.
+   * Queue the registration of the shot light, if it is not registered already.
    */
   void createShotLight()
   {
-    // Destroy any existing shot light.
-    destroyShotLight();
+    // Check if shot light is already registered.
+    if (isShotLightRegistered)
+    {
+      return;
+    }
 
-    // Create shot light and set its properties.
-    shotLight = PointLight::create(getModelId() + "::ShotLight");
-    shotLight->setLightPosition(getModelPosition() + glm::vec3(0.0f, 0.0f, 0.75f));
+    // Attach the shot light behind the shot, which faces backwards (it is turned around the Y axis).
+    attachmentManager.attachLight(shotLight, getTransformHandle(), glm::vec3(0.0f, 0.0f, -0.75f));
 
-    // Register the shot light.
+    // Queue the shot light registration, since the lights may be iterated.
     shotLight->init();
-    lightManager.registerLight(shotLight);
-
-    // Update the shot light toggle.
-    isShotLightPresent = true;
+    lightManager.queueRegisterLight(shotLight);
+    isShotLightRegistered = true;
   }
 
   /**
-   * Destroy the existing shot light.
+   * Queue the de-registration of the shot light, keeping it for the next time it is needed.
    */
   void destroyShotLight()
   {
-    // Check if shot light exists
-    if (shotLight != nullptr)
+    // Check if shot light is registered.
+    if (isShotLightRegistered)
     {
-      // Destroy the shot light.
+      // Queue the shot light de-registration.
+      attachmentManager.detachLight(shotLight);
       shotLight->deinit();
-      lightManager.deregisterLight(shotLight);
-      shotLight = nullptr;
+      lightManager.queueDeregisterLight(shotLight);
+      isShotLightRegistered = false;
     }
-    // Update the shot light toggle.
-    isShotLightPresent = false;
   }
 
   /**
@@ -91,19 +106,12 @@ private:
     // Check if shot light toggle is enabled.
     if (isShotLightPresent)
     {
-      // check if shot light doesn't exist.
-      if (shotLight == nullptr)
-      {
-        // Create shot light.
-        createShotLight();
-      }
-      // Update the shot light.
-      shotLight->setLightPosition(getModelPosition() + glm::vec3(0.0f, 0.0f, 0.75f));
+      // Register the shot light if it isn't registered, which follows the shot from then on.
+      createShotLight();
     }
-    // Check if shot light exists.
-    else if (shotLight != nullptr)
+    else
     {
-      // Destroy any existing shot light.
+      // De-register any registered shot light.
       destroyShotLight();
     }
   }
@@ -116,10 +124,14 @@ public:
             ColliderShapeType::BOX),
         modelManager(ModelManager::getInstance()),
         lightManager(LightManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        rotationSpeedZ(glm::radians(5.0f)),
-        lastTime(glfwGetTime()),
-        shotLight(nullptr) {}
+        attachmentManager(AttachmentManager::getInstance()),
+        simulationClock(SimulationClock::getInstance()),
+        gpuShotCollisionManager(GpuShotCollisionManager::getInstance()),
+        rotationStep(glm::angleAxis(-glm::radians(5.0f), glm::vec3(0.0f, 0.0f, 1.0f))),
+        lastTime(simulationClock.getTime()),
+        shotLight(UnshadowedPointLight::create(modelId + "::ShotLight")),
+        isShotLightRegistered(false),
+        gpuShotIndex(GpuShotCollisionManager::INVALID_SHOT_INDEX) {}
 
   static void initModel()
   {
@@ -127,50 +139,111 @@ public:
         "Shot",
         "assets/objects/shot.obj",
         "assets/textures/shot.bmp",
-        "assets/shaders/vertex/shot.glsl", "assets/shaders/fragment/shot.glsl");
+        "assets/shaders/vertex/shot.glsl", "assets/shaders/fragment/shot.glsl",
+        // The shot is unlit and carries its own light, so it neither casts shadows (which would block that light) nor receives light.
+        {false, false, 0, false, false});
+
+    // Create the pooled shots once the dependencies are loaded, so that firing does not create any (unless only recording them for another scene).
+    if (scenePreloader.isRecordingModels())
+    {
+      return;
+    }
+    sceneLoader.addStep([]() {
+      shotPool.reserve(SHOT_POOL_SIZE);
+      return true;
+    });
   }
 
   static void deinitModel()
   {
+    // Despawn and destroy the pooled shots, along with their lights.
+    shotPool.clear();
+
     ModelBase::deinitModelDeps();
   }
 
+  /**
+   * Spawn a shot from the shot pool.
+   * 
+   * @param position  The position to spawn the shot at.
+   */
+  static void spawn(const glm::vec3 &position)
+  {
+    shotPool.spawn(position);
+  }
+
+  /**
+   * Toggle the lights of all the shots.
+   */
+  static void toggleShotLight()
+  {
+    isShotLightPresent = !isShotLightPresent;
+  }
+
   /**
    * Creates a new instance of the shot model.
    */
   const static std::shared_ptr<ShotModel> create(const std::string &modelId)
   {
-    return std::make_shared<ShotModel>(modelId);
+    return makePooledShared<ShotModel>(modelId);
   }
 
   void init() override
   {
-    // Set the rotation of the model.
+    // Set the rotation of the model, and restart its movement from now, since the shot may have been spawned before.
     setModelRotation(glm::vec3(0.0f, glm::radians(180.0f), 0.0f));
+    lastTime = simulationClock.getTime();
+
+    // Have the enemies the shot goes through found on the GPU if possible, as a sphere bounding its collider, moving in a
+    //   straight line from here. The collision pass is left to find them otherwise, which is known before the shot is registered.
+    const auto &colliderBox = getColliderDetails()->getColliderShape()->getTransformedBox();
+    const auto colliderRadius = glm::distance(colliderBox.getMinCorner(), colliderBox.getMaxCorner()) * 0.5f;
+    gpuShotIndex = gpuShotCollisionManager.registerShot(this, getModelPosition(), glm::vec3(0.0f, 0.0f, -static_cast<float_t>(shotSpeed)), colliderRadius);
 
     // Check if shot light toggle is enabled.
     if (isShotLightPresent)
     {
-      // Create a shot light.
+      // Register the shot light.
       createShotLight();
     }
   }
 
   void deinit() override
   {
-    // Check if shot light toggle is enabled.
-    if (isShotLightPresent)
+    // De-register the shot light.
+    destroyShotLight();
+    // Stop testing the shot on the GPU.
+    gpuShotCollisionManager.deregisterShot(gpuShotIndex);
+    gpuShotIndex = GpuShotCollisionManager::INVALID_SHOT_INDEX;
+  }
+
+  /**
+   * Update the given shots all at once, reading the time of the simulation step once for all of them.
+   * 
+   * @param shots       The shots.
+   * @param shotsCount  The number of shots.
+   */
+  static void updateBatch(ShotModel *const *shots, const size_t &shotsCount)
+  {
+    const auto currentTime = SimulationClock::getInstance().getTime();
+    for (size_t i = 0; i < shotsCount; i++)
     {
-      // Destroy the shot light and update the toggle.
-      destroyShotLight();
-      isShotLightPresent = true;
+      shots[i]->updateShot(currentTime);
     }
   }
 
   void update() override
   {
-    // Get the timestamp for the start of the update.
-    const auto currentTime = glfwGetTime();
+    updateShot(simulationClock.getTime());
+  }
+
+  /**
+   * Update the shot to the given time of the simulation step.
+   * 
+   * @param currentTime  The time of the simulation step.
+   */
+  void updateShot(const double_t &currentTime)
+  {
     // Get the time difference since the start of the last update.
     const auto deltaTime = currentTime - lastTime;
 
@@ -179,63 +252,21 @@ public:
     // Check if the shot has already gone beyond a threshold.
     if (currentPosition.z < -50.0f)
     {
-      // If it has, destroy it.
-      this->deinit();
-      modelManager.deregisterModel(this->getModelId());
+      // If it has, return it to the shot pool.
+      shotPool.despawn(this);
       return;
     }
 
-    // Check if "H" key was pressed after 500ms since the last shot light toggle.
-    if (controlManager.isKeyPressed(GLFW_KEY_H) && (currentTime - lastShotLightChange) > 0.5f)
-    {
-      // "H" key was pressed. Toggle the shot light.
-      isShotLightPresent = !isShotLightPresent;
-      // Update the timestamp for when the shot light was last toggled.
-      lastShotLightChange = currentTime;
-    }
-
-    const auto timeSlices = 12;
-    for (auto i = 0; i < timeSlices; i++)
+    // Update the shot position, and have the collision pass check everything the shot passed through on the way, so that it
+    //   cannot pass through enemies at any speed or frame rate (the GPU sweeps the shots it tests the same way).
+    const auto displacement = glm::vec3(0.0f, 0.0f, -static_cast<float_t>(shotSpeed * deltaTime));
+    setModelPosition(currentPosition + displacement);
+    if (gpuShotIndex == GpuShotCollisionManager::INVALID_SHOT_INDEX)
     {
-      // Update the shot position.
-      setModelPosition(getModelPosition() - glm::vec3(0.0f, 0.0f, (shotSpeed * deltaTime) / timeSlices));
-
-      if (currentPosition.z > 1.5f)
-      {
-        continue;
-      }
-
-      // Get the list of registered models.
-      const auto models = modelManager.getAllModels();
-      // Iterate over the list of registered models.
-      for (const auto &model : models)
-      {
-        // Check if the current model is an enemy model.
-        if (model->getModelName() != "Enemy")
-        {
-          continue;
-        }
-
-        if (glm::distance(model->getModelPosition(), currentPosition) > 3.0f)
-        {
-          continue;
-        }
-
-        // Check if collided with the enemy model.
-        if (DeepCollisionValidator::haveShapesCollided(getColliderDetails()->getColliderShape(), model->getColliderDetails()->getColliderShape(), true))
-        {
-          // Shot has collided with an enemy. Destroy both.
-          model->deinit();
-          modelManager.deregisterModel(model);
-
-          this->deinit();
-          modelManager.deregisterModel(this->getModelId());
-          return;
-        }
-      }
+      collisionManager.setModelSweep(this, displacement);
     }
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, 0.0f, rotationSpeedZ));
+    rotateModel(rotationStep);
 
     // Update the shot light.
     updateShotLight();
@@ -243,13 +274,39 @@ public:
     // Set the timestamp for the start of the last update to the starting timestamp of the current update.
     lastTime = currentTime;
   }
+
+  uint32_t getCollisionLayer() const override
+  {
+    return CollisionLayer::SHOT_COLLISION_LAYER;
+  }
+
+  uint32_t getCollisionMask() const override
+  {
+    // The shots tested on the GPU are left out of the pairs of the collision pass.
+    return gpuShotIndex == GpuShotCollisionManager::INVALID_SHOT_INDEX ? CollisionLayer::ENEMY_COLLISION_LAYER : 0;
+  }
+
+  ColliderMotionType getColliderMotionType() const override
+  {
+    // The shot flies forward every update.
+    return ColliderMotionType::KINEMATIC_COLLIDER;
+  }
+
+  void onCollisionEnter(const std::shared_ptr<ModelBaseIntf> &otherModel) override
+  {
+    // Shot has collided with an enemy. Destroy the enemy once the events are handled, and return the shot to the shot pool.
+    otherModel->deinit();
+    modelManager.queueDeregisterModel(otherModel);
+
+    shotPool.despawn(this);
+  }
 };
 
 // Initialize the shot speed static variable.
 double ShotModel::shotSpeed = 120.0f;
 // Initialize the shot light toggle static variable.
 bool ShotModel::isShotLightPresent = true;
-// Initialize the last time the shot light toggle was changed static variable.
-float_t ShotModel::lastShotLightChange = -1;
+// Initialize the shot pool static variable.
+ModelPool<ShotModel> ShotModel::shotPool("Shot");
 
 #endif
\ No newline at end of file
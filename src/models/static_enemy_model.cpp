@@ -0,0 +1,50 @@
+#ifndef MODELS_STATIC_ENEMY_MODEL_CPP
+#define MODELS_STATIC_ENEMY_MODEL_CPP
+
+#include <string>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "model_base.cpp"
+
+class StaticEnemyModel : public ModelBase<StaticEnemyModel>
+{
+public:
+  StaticEnemyModel(const std::string &modelId)
+      : ModelBase(
+            modelId,
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
+            ColliderShapeType::SPHERE)
+  {
+  }
+
+  static void initModel()
+  {
+    ModelBase::initModelDeps(
+        "StaticEnemy",
+        "assets/objects/sphere-saw.obj",
+        "assets/textures/sphere-saw.bmp",
+        "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl",
+        // The model never moves or spins, so its shadows are cached apart from the ones of the other casters.
+        {true, true, 0, true, false});
+  }
+
+  static void deinitModel()
+  {
+    ModelBase::deinitModelDeps();
+  }
+
+  const static std::shared_ptr<StaticEnemyModel> create(const std::string &modelId)
+  {
+    return makePooledShared<StaticEnemyModel>(modelId);
+  }
+
+  bool isUpdateThreadSafe() const override
+  {
+    // The static enemy has nothing to update, so it can be updated in parallel.
+    return true;
+  }
+};
+
+#endif
@@ -31,7 +31,9 @@ public:
         "Title",
         "assets/objects/title.obj",
         "assets/textures/title.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        // The model is unlit, so it neither casts shadows nor receives light.
+        {false, false, 0, false, false});
   }
 
   static void deinitModel()
@@ -44,12 +46,24 @@ public:
    */
   const static std::shared_ptr<TitleModel> create(const std::string &modelId)
   {
-    return std::make_shared<TitleModel>(modelId);
+    return makePooledShared<TitleModel>(modelId);
+  }
+
+  bool isUpdateThreadSafe() const override
+  {
+    // The title does nothing while updating.
+    return true;
   }
 
   void update() override
   {
   }
+
+  ColliderMotionType getColliderMotionType() const override
+  {
+    // The title never moves.
+    return ColliderMotionType::STATIC_COLLIDER;
+  }
 };
 
 #endif
\ No newline at end of file
@@ -5,6 +5,11 @@
 #include <optional>
 #include <memory>
 #include <vector>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <iostream>
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -14,15 +19,44 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../include/window.cpp"
+#include "../include/render_config.cpp"
 #include "../include/control.cpp"
 #include "../include/camera.cpp"
 #include "../include/light.cpp"
 #include "../include/render.cpp"
 #include "../include/debug_render.cpp"
 #include "../include/text.cpp"
+#include "../include/scene_loader.cpp"
+#include "../include/collision.cpp"
+#include "../include/collision_batch.cpp"
+#include "../include/gpu_shot_collision.cpp"
+#include "../include/frame_graph.cpp"
+#include "../include/render_packet.cpp"
+#include "../include/simulation_clock.cpp"
+#include "../include/gpu_memory.cpp"
+#include "../include/hud_stats.cpp"
+#include "../include/gl_stats.cpp"
+#include "../include/gl_debug.cpp"
+#include "../include/allocation_tracker.cpp"
+#include "../include/transform.cpp"
+#include "../include/frame_pacer.cpp"
+#include "../include/dynamic_resolution.cpp"
+#include "../include/frame_time_graph.cpp"
+#include "../include/rolling_stats.cpp"
+#include "../include/benchmark.cpp"
+#include "../include/telemetry.cpp"
+#include "../include/frame_capture.cpp"
+#include "../include/scene_file.cpp"
+#include "../include/scene_instancer.cpp"
+#include "../include/scene_snapshot.cpp"
 
 #include "../camera/perspective_camera.cpp"
+#include "../camera/rear_view_camera.cpp"
+#include "../light/point_light.cpp"
+#include "../light/cone_light.cpp"
 #include "../models/enemy_model.cpp"
+#include "../models/dummy_enemy_model.cpp"
+#include "../models/static_enemy_model.cpp"
 #include "../models/player_model.cpp"
 
 #include "scene_base.cpp"
@@ -36,98 +70,269 @@ private:
   CameraManager &cameraManager;
   RenderManager &renderManager;
   DebugRenderManager &debugRenderManager;
+  SceneLoader &sceneLoader;
+  CollisionManager &collisionManager;
+  GpuShotCollisionManager &gpuShotCollisionManager;
+  SimulationClock &simulationClock;
+  TransformManager &transformManager;
+  DynamicResolutionManager &dynamicResolutionManager;
+  FrameTimeGraphManager &frameTimeGraphManager;
+  GpuMemoryManager &gpuMemoryManager;
+  HudStatsManager &hudStatsManager;
+  GlStatsManager &glStatsManager;
+  GlDebugManager &glDebugManager;
+  AllocationTracker &allocationTracker;
+  BenchmarkManager &benchmarkManager;
+  TelemetryManager &telemetryManager;
+  FrameCaptureManager &frameCaptureManager;
+  JobManager &jobManager;
+  SceneInstancer &sceneInstancer;
+
+  std::vector<RegistryHandle> sceneCameraHandles;
+  std::vector<RegistryHandle> sceneModelHandles;
+  std::vector<RegistryHandle> sceneLightHandles;
+
+  // The path of the scene file the camera and the enemies of the scene are placed by.
+  static constexpr const char *SCENE_FILE_PATH = "assets/scenes/game.scene";
+  // The scene file, read on a worker thread while the model dependencies load.
+  SceneDescription sceneDescription;
+  bool isSceneFileRead;
+  // The models and lights of the scene as its first init left them, which the next runs restore instead of reading the scene
+  //   file and creating them again (empty in the benchmark mode, which only runs once).
+  SceneSnapshot sceneSnapshot;
 
-  std::vector<std::string> sceneCameraIds;
-  std::vector<std::string> sceneModelIds;
-
-  void initCameras()
+  void deinitCameras()
   {
-    // Create a perspective camera, and set its properties.
-    const auto cameraId = "MainCamera";
-    sceneCameraIds.push_back(cameraId);
-
-    const auto perspectiveCamera = PerspectiveCamera::create(cameraId);
-    perspectiveCamera->setCameraPosition(glm::vec3(0.0f, 20.0f, 40.0f));
-    perspectiveCamera->setCameraAngles(glm::pi<float_t>(), -(glm::pi<float_t>() / 4.3f));
-
-    cameraManager.registerCamera(perspectiveCamera);
-    renderManager.registerActiveCamera(perspectiveCamera->getCameraId());
+    for (const auto &cameraHandle : sceneCameraHandles)
+    {
+      renderManager.deregisterViewCamera(cameraHandle);
+      cameraManager.deregisterCamera(cameraHandle);
+    }
+    sceneCameraHandles.clear();
   }
 
-  void deinitCameras()
+  void initRearViewCamera()
   {
-    for (const auto &cameraId : sceneCameraIds)
+    if (sceneCameraHandles.empty())
     {
-      cameraManager.deregisterCamera(cameraId);
+      return;
     }
+
+    // Show what is behind the camera of the scene in the top-right corner of the screen once the additional views are toggled
+    //   on, in a square share of the screen so that it keeps the aspect ratio of the screen.
+    const auto rearViewCamera = RearViewCamera::create("RearView", cameraManager.getCamera(sceneCameraHandles.front()));
+    sceneCameraHandles.push_back(cameraManager.registerCamera(rearViewCamera));
+    renderManager.registerViewCamera(sceneCameraHandles.back(), glm::vec4(0.7f, 0.7f, 0.28f, 0.28f));
   }
 
-  void initEnemyModels()
+  void initBenchmarkEnemyModels()
   {
-    // Create 45 enemy models stacked in a grid format (5 x 3 x 3), and set their properties.
-    for (auto i = -2; i <= 2; i++)
+    // Create the enemy models stacked in the grid format the benchmark mode asks for instead of the one of the scene file,
+    //   centered across and ending at the front, and set their properties. The benchmark mode can also scatter them randomly
+    //   around their places, and replace some of them with unlit (or static) ones evenly spread through the grid.
+    const auto &settings = benchmarkManager.getSettings();
+    const auto gridSize = settings.enemyGridSize;
+    auto scatterGenerator = std::mt19937(settings.seed);
+    auto scatterDistribution = std::uniform_real_distribution<float_t>(-settings.enemyScatter, settings.enemyScatter);
+    for (auto i = 0; i < gridSize.x; i++)
     {
-      for (auto j = -1; j <= 1; j++)
+      for (auto j = 0; j < gridSize.y; j++)
       {
-        for (auto k = -2; k <= 0; k++)
+        for (auto k = 0; k < gridSize.z; k++)
         {
-          const auto enemyModelId = "Enemy" + std::to_string((9 * (i + 2)) + (3 * (j + 1)) + (k + 2));
-          sceneModelIds.push_back(enemyModelId);
-
+          const auto enemyIndex = (gridSize.y * gridSize.z * i) + (gridSize.z * j) + k;
+          const auto enemyModelId = "Enemy" + std::to_string(enemyIndex);
+          auto enemyPosition = glm::vec3((i - ((gridSize.x - 1) / 2)), (j - ((gridSize.y - 1) / 2)), (k - (gridSize.z - 1))) * settings.enemySpacing;
+          if (settings.enemyScatter > 0.0f)
+          {
+            enemyPosition += glm::vec3(scatterDistribution(scatterGenerator), scatterDistribution(scatterGenerator), scatterDistribution(scatterGenerator));
+          }
+
+          const auto isUnlit = std::floor((enemyIndex + 1) * settings.unlitEnemiesFraction) > std::floor(enemyIndex * settings.unlitEnemiesFraction);
+          if (isUnlit)
+          {
+            // The unlit enemies are made for the menus, so they are scaled up to the size of the enemies.
+            const auto enemyModel = DummyEnemyModel::create(enemyModelId);
+            enemyModel->setModelPosition(enemyPosition);
+            enemyModel->setModelScale(glm::vec3(1.0f, 1.0f, 1.0f));
+            sceneModelHandles.push_back(modelManager.registerModel(enemyModel));
+            continue;
+          }
+
+          const auto isStatic = std::floor((enemyIndex + 1) * settings.staticEnemiesFraction) > std::floor(enemyIndex * settings.staticEnemiesFraction);
+          if (isStatic)
+          {
+            // The static enemies neither move nor spin, so that their shadows are cached by the renderer.
+            const auto enemyModel = StaticEnemyModel::create(enemyModelId);
+            enemyModel->setModelPosition(enemyPosition);
+            sceneModelHandles.push_back(modelManager.registerModel(enemyModel));
+            continue;
+          }
           const auto enemyModel = EnemyModel::create(enemyModelId);
-          enemyModel->setModelPosition(glm::vec3(i * 5, j * 5, k * 5));
-          modelManager.registerModel(enemyModel);
+          enemyModel->setModelPosition(enemyPosition);
+          sceneModelHandles.push_back(modelManager.registerModel(enemyModel));
         }
       }
     }
   }
 
+  void initBenchmarkLights()
+  {
+    // Create the point lights the benchmark mode asks for, spread evenly on a ring over the enemies.
+    const auto &settings = benchmarkManager.getSettings();
+    for (uint32_t i = 0; i < settings.lightsCount; i++)
+    {
+      const auto angle = (2.0f * glm::pi<float_t>() * i) / settings.lightsCount;
+
+      const auto pointLight = PointLight::create("BenchmarkLight" + std::to_string(i));
+      pointLight->setLightPosition(glm::vec3(std::cos(angle) * BENCHMARK_LIGHTS_RADIUS, BENCHMARK_LIGHTS_HEIGHT, (std::sin(angle) * BENCHMARK_LIGHTS_RADIUS) - 5.0f));
+      sceneLightHandles.push_back(lightManager.registerLight(pointLight));
+    }
+
+    // Create the cone lights it asks for on the same ring, half a step around from the point lights, pointed at the middle of the
+    //   enemies.
+    for (uint32_t i = 0; i < settings.coneLightsCount; i++)
+    {
+      const auto angle = (2.0f * glm::pi<float_t>() * (i + 0.5f)) / settings.coneLightsCount;
+      const auto lightPosition = glm::vec3(std::cos(angle) * BENCHMARK_LIGHTS_RADIUS, BENCHMARK_LIGHTS_HEIGHT, (std::sin(angle) * BENCHMARK_LIGHTS_RADIUS) - 5.0f);
+      const auto lightDirection = glm::normalize(glm::vec3(0.0f, 0.0f, -5.0f) - lightPosition);
+
+      const auto coneLight = ConeLight::create("BenchmarkConeLight" + std::to_string(i));
+      coneLight->setLightPosition(lightPosition);
+      coneLight->setLightAngles(std::atan2(lightDirection.x, lightDirection.z), std::asin(lightDirection.y));
+      coneLight->setLightIntensity(350.0f);
+      sceneLightHandles.push_back(lightManager.registerLight(coneLight));
+    }
+  }
+
+  void deinitLights()
+  {
+    for (const auto &lightHandle : sceneLightHandles)
+    {
+      lightManager.deregisterLight(lightHandle);
+    }
+    sceneLightHandles.clear();
+  }
+
   void initPlayerModels()
   {
     // Create a player model.
     const auto playerModelId = "MainPlayer";
-    sceneModelIds.push_back(playerModelId);
 
     const auto playerModel = PlayerModel::create(playerModelId);
-    modelManager.registerModel(playerModel);
+    sceneModelHandles.push_back(modelManager.registerModel(playerModel));
   }
 
-  void initModels()
+  const void initModelTypes()
   {
+    // Include the unlit and the static enemies if the benchmark mode mixes some in.
     EnemyModel::initModel();
-    renderLoadingText("Loading (35%)", glm::vec2(1, 1), 1.0f);
     PlayerModel::initModel();
-    renderLoadingText("Loading (60%)", glm::vec2(1, 1), 1.0f);
     ShotModel::initModel();
-    renderLoadingText("Loading (85%)", glm::vec2(1, 1), 1.0f);
+    if (benchmarkManager.getSettings().unlitEnemiesFraction > 0.0f)
+    {
+      DummyEnemyModel::initModel();
+    }
+    if (benchmarkManager.getSettings().staticEnemiesFraction > 0.0f)
+    {
+      StaticEnemyModel::initModel();
+    }
+  }
 
-    initEnemyModels();
-    renderLoadingText("Loading (90%)", glm::vec2(1, 1), 1.0f);
-    initPlayerModels();
+  void initModels()
+  {
+    // Queue the loading of the model dependencies.
+    initModelTypes();
+
+    // Read the scene file in the background while the dependencies load, and then create the camera and the model instances of
+    //   the scene file, which needs the dependencies to be loaded. The enemies are created the same each run in the benchmark
+    //   mode, and the same as when recorded when replaying a session.
+    SceneLoadFlow(sceneLoader)
+        .onWorker([this]() { isSceneFileRead = SceneFile::loadScene(SCENE_FILE_PATH, sceneDescription); }, {SCENE_FILE_PATH})
+        .onGlThread([this]() {
+          if (!isSceneFileRead)
+          {
+            // Failed to read the scene file. Time to crash.
+            std::cout << "Failed to read the scene file " << SCENE_FILE_PATH << std::endl;
+            exit(1);
+          }
+
+          if (benchmarkManager.isBenchmarkEnabled())
+          {
+            EnemyModel::seedGenerator(benchmarkManager.getSettings().seed);
+            initBenchmarkLights();
+            // The benchmark mode places the enemies itself.
+            auto &modelGroups = sceneDescription.modelGroups;
+            modelGroups.erase(std::remove_if(modelGroups.begin(), modelGroups.end(), [](const SceneModelGroup &modelGroup) {
+                                return modelGroup.modelType == "Enemy";
+                              }),
+                              modelGroups.end());
+            initBenchmarkEnemyModels();
+          }
+          else if (controlManager.isInputSessionSeeded())
+          {
+            EnemyModel::seedGenerator(controlManager.getInputSessionSeed());
+          }
+          const auto isSceneCreated = sceneInstancer.instantiateScene(sceneDescription, {{"Enemy", SceneInstancer::getModelFactory<EnemyModel>()}},
+                                                                      sceneModelHandles, sceneLightHandles, sceneCameraHandles);
+          if (!isSceneCreated)
+          {
+            // The scene file has a model type the scene does not know of. Time to crash.
+            std::cout << "Failed to create the scene file " << SCENE_FILE_PATH << std::endl;
+            exit(1);
+          }
+          initRearViewCamera();
+          initPlayerModels();
+          if (!benchmarkManager.isBenchmarkEnabled())
+          {
+            sceneSnapshot.capture(sceneModelHandles, sceneLightHandles, EnemyModel::getGenerator());
+          }
+        });
+  }
+
+  void restoreModels()
+  {
+    // Queue the loading of the model dependencies, which the residency caches and the preloading by the end scene keep resident
+    //   between the runs.
+    initModelTypes();
+
+    // Bring the models and lights of the last run back as the first init left them, along with the generator of the enemies,
+    //   and create the cameras again from the scene file read by the first init.
+    sceneLoader.addStep([this]() {
+      sceneSnapshot.restore(sceneModelHandles, sceneLightHandles);
+      EnemyModel::setGenerator(sceneSnapshot.getGenerator());
+      sceneInstancer.instantiateCameras(sceneDescription, sceneCameraHandles);
+      initRearViewCamera();
+      return true;
+    });
   }
 
   void deinitModels()
   {
-    for (const auto &modelId : sceneModelIds)
+    // Send the events of the last pipelined collision pass, and run the collision passes of the other scenes right away.
+    modelManager.setCollisionPipelined(false);
+    for (const auto &modelHandle : sceneModelHandles)
     {
-      modelManager.deregisterModel(modelId);
-    }
-
-    // Iterate over the list of registered models.
-    for (const auto &model : modelManager.getAllModels())
-    {
-      // Check if the current model is a shot model.
-      if (model->getModelName() != "Shot")
-      {
-        continue;
-      }
-
-      modelManager.deregisterModel(model->getModelId());
+      modelManager.deregisterModel(modelHandle);
     }
+    sceneModelHandles.clear();
 
+    // The shots are despawned by their model de-initialization, along with their lights.
     EnemyModel::deinitModel();
     PlayerModel::deinitModel();
     ShotModel::deinitModel();
+    if (benchmarkManager.getSettings().unlitEnemiesFraction > 0.0f)
+    {
+      DummyEnemyModel::deinitModel();
+    }
+    if (benchmarkManager.getSettings().staticEnemiesFraction > 0.0f)
+    {
+      StaticEnemyModel::deinitModel();
+    }
+
+    // Apply the de-registrations queued by the models while de-initializing, such as those of the shot lights.
+    modelManager.applyQueuedCommands();
+    lightManager.applyQueuedCommands();
   }
 
 public:
@@ -138,10 +343,31 @@ public:
         lightManager(LightManager::getInstance()),
         cameraManager(CameraManager::getInstance()),
         renderManager(RenderManager::getInstance()),
-        debugRenderManager(DebugRenderManager::getInstance())
+        debugRenderManager(DebugRenderManager::getInstance()),
+        sceneLoader(SceneLoader::getInstance()),
+        collisionManager(CollisionManager::getInstance()),
+        gpuShotCollisionManager(GpuShotCollisionManager::getInstance()),
+        simulationClock(SimulationClock::getInstance()),
+        transformManager(TransformManager::getInstance()),
+        dynamicResolutionManager(DynamicResolutionManager::getInstance()),
+        frameTimeGraphManager(FrameTimeGraphManager::getInstance()),
+        gpuMemoryManager(GpuMemoryManager::getInstance()),
+        hudStatsManager(HudStatsManager::getInstance()),
+        glStatsManager(GlStatsManager::getInstance()),
+        glDebugManager(GlDebugManager::getInstance()),
+        allocationTracker(AllocationTracker::getInstance()),
+        benchmarkManager(BenchmarkManager::getInstance()),
+        telemetryManager(TelemetryManager::getInstance()),
+        frameCaptureManager(FrameCaptureManager::getInstance()),
+        jobManager(JobManager::getInstance()),
+        sceneInstancer(SceneInstancer::getInstance()),
+        sceneDescription(),
+        isSceneFileRead(false),
+        sceneSnapshot()
   {
-    sceneModelIds = std::vector<std::string>({});
-    sceneCameraIds = std::vector<std::string>({});
+    sceneModelHandles = std::vector<RegistryHandle>({});
+    sceneCameraHandles = std::vector<RegistryHandle>({});
+    sceneLightHandles = std::vector<RegistryHandle>({});
   }
 
   const static std::shared_ptr<GameScene> create(const std::string &sceneId)
@@ -151,23 +377,39 @@ public:
 
   const void init()
   {
-    renderLoadingText("Loading (0%)", glm::vec2(1, 1), 1.0f);
-    initCameras();
-    renderLoadingText("Loading (10%)", glm::vec2(1, 1), 1.0f);
-    initModels();
-    renderLoadingText("Loading (95%)", glm::vec2(1, 1), 1.0f);
+    if (sceneSnapshot.isCaptured())
+    {
+      restoreModels();
+    }
+    else
+    {
+      initModels();
+    }
 
     // Poll for events and set the mouse to the center of the screen
-    controlManager.disableCursor();
-    controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
-    controlManager.pollEvents();
-    renderLoadingText("Loading (100%)", glm::vec2(1, 1), 1.0f);
+    sceneLoader.addStep([this]() {
+      controlManager.disableCursor();
+      controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
+      controlManager.pollEvents();
+      return true;
+    });
+  }
+
+  const std::optional<std::string> getLikelyNextSceneId() const
+  {
+    // The benchmark mode exits once it is done, and nothing is loaded while it is measured.
+    if (benchmarkManager.isBenchmarkEnabled())
+    {
+      return std::nullopt;
+    }
+    return "EndScene";
   }
 
   const void deinit()
   {
     renderLoadingText("Cleaning (0%)", glm::vec2(1, 1), 1.0f);
     deinitModels();
+    deinitLights();
     renderLoadingText("Cleaning (50%)", glm::vec2(1, 1), 1.0f);
     deinitCameras();
     renderLoadingText("Cleaning (100%)", glm::vec2(1, 1), 1.0f);
@@ -175,20 +417,7 @@ public:
 
   const uint32_t getEnemyModelsCount()
   {
-    uint32_t enemyModelsCount = 0;
-
-    // Iterate over the list of registered models.
-    for (const auto &model : modelManager.getAllModels())
-    {
-      if (model->getModelName() != "Enemy")
-      {
-        continue;
-      }
-
-      ++enemyModelsCount;
-    }
-
-    return enemyModelsCount;
+    return modelManager.getModelsCount(EnemyModel::getTypeId());
   }
 
   const std::optional<std::string> execute()
@@ -199,147 +428,482 @@ public:
     windowManager.isWindowCloseRequested();
 
     modelManager.initAllModels();
+    modelManager.setCollisionPipelined(IS_COLLISION_PIPELINE_ENABLED);
     cameraManager.initAllCameras();
     lightManager.initAllLights();
 
     // Set debug mode to initially false.
     auto debugEnabled = false;
-    // Set the timestamp for when debug mode toggle was changed to 10 seconds in the past.
-    auto lastDebugEnabledChange = glfwGetTime() - 10;
 
     // Set debug text to initially false.
     auto textEnabled = false;
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastTextEnabledChange = glfwGetTime() - 10;
 
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastVsyncToggledChange = glfwGetTime() - 10;
+    // Declare the phases of a frame with the resources they access, so that the independent ones overlap (like the light
+    //   update on a worker thread and the camera update on the main thread), while the conflicting ones keep their order.
+    FrameGraph frameGraph;
+    frameGraph.addPhase("Light Update", {0, LIGHTS_FRAME_RESOURCE, TEXT_FRAME_RESOURCE}, WORKER_FRAME_PHASE_THREAD, [this]() {
+      lightManager.updateAllLights();
+    });
+    // Run the models in fixed steps of the simulation clock, as many as the real time since the last frame fits, so that the
+    //   simulation costs the same however many frames are rendered.
+    uint32_t simulationStepsCount = 0;
+    frameGraph.addPhase("Model Update", {0, MODELS_FRAME_RESOURCE | TRANSFORMS_FRAME_RESOURCE | LIGHTS_FRAME_RESOURCE, TEXT_FRAME_RESOURCE}, MAIN_FRAME_PHASE_THREAD, [this, &simulationStepsCount]() {
+      auto collisionTime = 0.0;
+      // The number of awake colliders, taken after each step synced the pipelined collision pass (0 if the frame runs no step).
+      size_t awakeCollidersCount = 0;
+      for (uint32_t i = 0; i < simulationStepsCount; i++)
+      {
+        // Keep the transforms before the step, to interpolate the rendered ones from.
+        transformManager.saveSimulationState();
+        simulationClock.advanceStep();
+        if (benchmarkManager.isBenchmarkEnabled())
+        {
+          benchmarkManager.scriptStepInput();
+        }
+        controlManager.advanceSimulationInput();
+        modelManager.updateAllModels();
+        awakeCollidersCount = collisionManager.getAwakeModelsCount();
+        // Run the collision pass once the models have moved, sending them its events (unless it is pipelined, in which case the
+        //   update sent the ones of the pass of the last step), followed by the hits of the shots read back from the GPU since the
+        //   last step. The pass is timed by the model manager, on the worker thread when pipelined.
+        if (!modelManager.isCollisionPipelineEnabled())
+        {
+          modelManager.updateAllCollisions();
+        }
+        const auto applyStartTime = glfwGetTime();
+        gpuShotCollisionManager.applyHits();
+        collisionTime += modelManager.getCollisionPassTime() + (glfwGetTime() - applyStartTime);
+
+        // Apply the registrations and de-registrations queued by the model updates and collision events in one batch, now that
+        //   nothing iterates the models and lights.
+        modelManager.applyQueuedCommands();
+        lightManager.applyQueuedCommands();
+        // With the collisions pipelined, test the models as the step left them on a worker thread while the rest of the frame
+        //   runs, the events reaching the models as the next step starts.
+        if (modelManager.isCollisionPipelineEnabled())
+        {
+          modelManager.submitCollisions();
+        }
+      }
+      auto text = textManager.beginText(glm::vec2(1, 1), 0.5f);
+      modelManager.writeUpdateTiming(text);
+      text << " | Collision Pass: " << collisionTime * 1000 << "ms" << (modelManager.isCollisionPipelineEnabled() ? " (Pipelined)" : "") << " | Collision Broadphase (G): " << (collisionManager.getBroadphaseType() == CollisionBroadphaseType::GRID ? "Grid" : "Tree") << " | Awake Colliders: " << awakeCollidersCount << " / " << collisionManager.getModelsCount() << " | Narrowphase: " << CollisionBatchValidator::getKernelSetName() << " | Shot Collision: " << (gpuShotCollisionManager.isGpuShotCollisionSupported() ? "GPU" : "CPU");
+    });
+    frameGraph.addPhase("Camera Update", {0, CAMERAS_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this]() {
+      // Take the cursor moved while the frame was simulated, right before the view matrices are made from it.
+      controlManager.resampleCursor();
+      cameraManager.updateAllCameras();
+    });
+    // With the render thread, the frame is only filled into a render packet here, and the GL phases run on the render thread.
+    const auto renderPhaseName = std::string(IS_RENDER_THREAD_ENABLED ? "Render Packet" : "Render");
+    if (!IS_RENDER_THREAD_ENABLED)
+    {
+      frameGraph.addPhase(renderPhaseName, {MODELS_FRAME_RESOURCE | TRANSFORMS_FRAME_RESOURCE | LIGHTS_FRAME_RESOURCE | CAMERAS_FRAME_RESOURCE, GPU_FRAME_RESOURCE, TEXT_FRAME_RESOURCE}, MAIN_FRAME_PHASE_THREAD, [this]() {
+        renderManager.render();
+      });
+      // Render the debug models of the main models and lights if debug mode is enabled.
+      frameGraph.addPhase("Debug Render", {MODELS_FRAME_RESOURCE | TRANSFORMS_FRAME_RESOURCE | LIGHTS_FRAME_RESOURCE | CAMERAS_FRAME_RESOURCE, GPU_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this, &debugEnabled]() {
+        if (debugEnabled)
+        {
+          debugRenderManager.render();
+        }
+      });
+      // Upscale the scene to the window, once the debug models are rendered into it too.
+      frameGraph.addPhase("Scene Present", {0, GPU_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this]() {
+        dynamicResolutionManager.presentScene();
+        // Capture the presented scene if asked to, before the debug text is drawn over it.
+        frameCaptureManager.captureFrame();
+        if (benchmarkManager.isBenchmarkEnabled())
+        {
+          benchmarkManager.sampleGpuTimes();
+        }
+        if (telemetryManager.isTelemetryEnabled())
+        {
+          telemetryManager.sampleGpuTimes();
+        }
+      });
+    }
+    // Report the timings of the phases once they are all finished, along with those of the last frame.
+    auto textRenderTimeLast = 0.0;
+    uint32_t textCharsRenderedLast = 0;
+    auto criticalPathLast = std::string("None");
+    // The statistics of the CPU times of the render passes over the last frames, taken from their profiler zones.
+    RollingStats<FRAME_TIME_HISTORY_SIZE> lightRenderStats, modelRenderStats;
+    frameGraph.addPhase("Frame Report", {LIGHTS_FRAME_RESOURCE | MODELS_FRAME_RESOURCE | CAMERAS_FRAME_RESOURCE | GPU_FRAME_RESOURCE, 0, TEXT_FRAME_RESOURCE}, WORKER_FRAME_PHASE_THREAD, [this, &frameGraph, &renderPhaseName, &simulationStepsCount, &debugEnabled, &textRenderTimeLast, &textCharsRenderedLast, &criticalPathLast, &lightRenderStats, &modelRenderStats]() {
+      textManager.beginText(glm::vec2(1, 0.5f), 0.5f) << "Light Update: " << frameGraph.getPhaseTime("Light Update") << "ms";
+      textManager.beginText(glm::vec2(1, 1.5f), 0.5f) << "Camera Update: " << frameGraph.getPhaseTime("Camera Update") << "ms";
+      {
+        auto text = textManager.beginText(glm::vec2(1, 2), 0.5f);
+        text << renderPhaseName << ": " << frameGraph.getPhaseTime(renderPhaseName) << "ms" << (IS_RENDER_THREAD_ENABLED ? " (Render Thread)" : "") << " | Light Render (p95): " << lightRenderStats.getSummary().p95 << "ms | Model Render (p95): " << modelRenderStats.getSummary().p95 << "ms";
+        if (debugEnabled && !IS_RENDER_THREAD_ENABLED)
+        {
+          text << " | Debug Render: " << frameGraph.getPhaseTime("Debug Render") << "ms";
+        }
+      }
+      {
+        auto text = textManager.beginText(glm::vec2(1, 2.5f), 0.5f);
+        text << "GL Calls (Last Frame): ";
+        glStatsManager.writeStatus(text);
+        text << " | GL Debug Messages: ";
+        glDebugManager.writeStatus(text);
+      }
+
+      textManager.beginText(glm::vec2(1, 3), 0.5f) << "Text Render (Last Frame): " << textRenderTimeLast << "ms";
+      {
+        auto text = textManager.beginText(glm::vec2(1, 3.5f), 0.5f);
+        text << "Text Characters Rendered (Last Frame): " << textCharsRenderedLast << " chars | Allocations/Frame: ";
+        allocationTracker.writeStatus(text);
+        // The zone allocating the most of the zones outside of all the others, which count the allocations of the zones in them.
+        auto topZoneName = std::string("None");
+        auto topZoneAllocationsCount = static_cast<uint64_t>(0);
+        cpuProfiler.forEachChildZone(0, [&topZoneName, &topZoneAllocationsCount](const std::string &zoneName, const ProfilerZoneStats &zoneStats) {
+          if (zoneStats.allocationsCount > topZoneAllocationsCount)
+          {
+            topZoneName = zoneName;
+            topZoneAllocationsCount = zoneStats.allocationsCount;
+          }
+        });
+        text << " | Top Zone: " << topZoneName << " (" << topZoneAllocationsCount << ")";
+      }
+      textManager.beginText(glm::vec2(1, 4.5f), 0.5f) << "Process Time (Last Frame): " << framePacer.getProcessTime() << "ms (p95: " << framePacer.getProcessTimeStats().getSummary().p95 << "ms) | Critical Path: " << criticalPathLast << " | GPU Wait: " << windowManager.getLastGpuWaitTime() << "ms (" << windowManager.getMaxFramesInFlight() << " Frames In Flight) | Input Latency: " << windowManager.getLastInputLatency() << "ms";
+      textManager.beginText(glm::vec2(1, 5), 0.5f) << "Process Rate (Last Frame): " << 1000 / framePacer.getProcessTime() << "fps | Simulation Steps: " << simulationStepsCount << " (" << static_cast<int32_t>(std::round(1.0 / SIMULATION_STEP_TIME)) << "Hz, Max " << MAX_SIMULATION_STEPS_PER_FRAME << "/Frame) | Dropped: " << simulationClock.getDroppedStepsCount() << " | Interpolation: " << simulationClock.getInterpolationFactor();
+      {
+        auto text = textManager.beginText(glm::vec2(1, 5.5f), 0.5f);
+        text << "Frame Time (Last Frame): " << framePacer.getFrameTime() << "ms | ";
+        framePacer.writeFrameTimeStats(text);
+      }
+      const auto frameRateLimit = framePacer.getFrameRateLimit();
+      auto text = textManager.beginText(glm::vec2(1, 6), 0.5f);
+      text << "Frame Rate (Last Frame): " << 1000 / framePacer.getFrameTime() << "fps | Limit (R): ";
+      if (frameRateLimit == 0)
+      {
+        text << "Unlimited";
+      }
+      else
+      {
+        text << frameRateLimit << "fps";
+      }
+      text << " | Trace (P): ";
+      traceCaptureManager.writeStatus(text);
+      text << " | Capture (F12/F11): ";
+      frameCaptureManager.writeStatus(text);
+      text << " | Input: ";
+      controlManager.writeInputSessionStatus(text);
+    });
+    // Render the scene at the resolution its GPU time allows, set before the render thread starts reading it.
+    dynamicResolutionManager.setEnabled(true);
+    // Render with the quality preset the benchmark mode asks for, set before the render thread starts reading it too.
+    if (benchmarkManager.isBenchmarkEnabled())
+    {
+      renderManager.setQualityPreset(benchmarkManager.getSettings().qualityPreset);
+    }
+
+    // The ring of render packets passed to the render thread, and the timings of the last frame it rendered.
+    RenderPacketRing renderPacketRing;
+    std::atomic<double_t> renderThreadTextRenderTime(0.0);
+    std::atomic<uint32_t> renderThreadTextCharsRendered(0);
+    std::thread renderThread;
+    // The frame times copied out for the frame time graph, when it is drawn on the main thread.
+    std::array<float_t, FRAME_TIME_HISTORY_SIZE> graphFrameTimes;
+    if (IS_RENDER_THREAD_ENABLED)
+    {
+      // Fill the scene and the text of the frame into the next render packet, once the text of the frame is all added.
+      frameGraph.addPhase(renderPhaseName, {MODELS_FRAME_RESOURCE | LIGHTS_FRAME_RESOURCE | CAMERAS_FRAME_RESOURCE, TRANSFORMS_FRAME_RESOURCE | TEXT_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this, &renderPacketRing, &textEnabled]() {
+        auto &packet = renderPacketRing.beginWrite();
+        renderManager.fillRenderPacket(packet);
+        packet.isTextEnabled = textEnabled;
+        packet.frameTimesCount = framePacer.getFrameTimeStats().copyValues(packet.frameTimes.data());
+        textManager.takeText(packet.textArena);
+        renderPacketRing.endWrite();
+      });
+
+      // Hand the GL context over to the render thread, which renders the packets as they are filled. The events are still
+      //   polled on the main thread.
+      windowManager.releaseContext();
+      const auto initialSwapInterval = SWAP_INTERVAL;
+      renderThread = std::thread([this, &renderPacketRing, &renderThreadTextRenderTime, &renderThreadTextCharsRendered, initialSwapInterval]() {
+        windowManager.makeContextCurrent();
+        ThreadSchedulingManager::getInstance().applyToCurrentThread(ThreadRole::RENDER);
+        auto appliedSwapInterval = initialSwapInterval;
+        while (const auto packet = renderPacketRing.beginRead())
+        {
+          // Apply the interval for swapping buffers toggled on the main thread.
+          if (packet->swapInterval != appliedSwapInterval)
+          {
+            appliedSwapInterval = packet->swapInterval;
+            windowManager.applySwapInterval(appliedSwapInterval);
+          }
+
+          renderManager.render(*packet);
+          // Upscale the scene to the window, and capture it if asked to before the debug text is drawn over it.
+          dynamicResolutionManager.presentScene();
+          frameCaptureManager.captureFrame();
+          if (benchmarkManager.isBenchmarkEnabled())
+          {
+            benchmarkManager.sampleGpuTimes();
+          }
+          if (telemetryManager.isTelemetryEnabled())
+          {
+            telemetryManager.sampleGpuTimes();
+          }
+
+          // Render the text if debug text is enabled.
+          const auto textRenderStartTime = glfwGetTime();
+          if (packet->isTextEnabled)
+          {
+            renderThreadTextCharsRendered = textManager.render(packet->textArena);
+            frameTimeGraphManager.render(packet->frameTimes.data(), packet->frameTimesCount);
+            // Query the video memory the driver reports here, since it has to be done where the context is current.
+            gpuMemoryManager.sampleDriverMemory();
+          }
+          renderThreadTextRenderTime = (glfwGetTime() - textRenderStartTime) * 1000;
+
+          // Swap the window framebuffers.
+          windowManager.swapBuffers(packet->inputSampleTime);
+
+          renderPacketRing.endRead();
+        }
+        windowManager.releaseContext();
+      });
+    }
+    else
+    {
+      // Render the text if debug text is enabled.
+      frameGraph.addPhase("Text Render", {TEXT_FRAME_RESOURCE, GPU_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this, &textEnabled, &textCharsRenderedLast, &graphFrameTimes]() {
+        if (textEnabled)
+        {
+          textCharsRenderedLast = textManager.render();
+          frameTimeGraphManager.render(graphFrameTimes.data(), framePacer.getFrameTimeStats().copyValues(graphFrameTimes.data()));
+          gpuMemoryManager.sampleDriverMemory();
+        }
+      });
+      // Swap the window framebuffers.
+      frameGraph.addPhase("Swap", {0, GPU_FRAME_RESOURCE, 0}, MAIN_FRAME_PHASE_THREAD, [this]() {
+        windowManager.swapBuffers(controlManager.getInputSampleTime());
+      });
+    }
+
+    // Start the simulation clock from the state the models were initialized with. The benchmark mode runs a step each frame with
+    //   the scripted keys instead of the ones of the window, so that the frames simulate the same however long they take.
+    transformManager.saveSimulationState();
+    simulationClock.startFixedStep();
+    if (benchmarkManager.isBenchmarkEnabled())
+    {
+      simulationClock.setLockStep(true);
+      controlManager.setSimulationInputScripted(true);
+      benchmarkManager.start();
+    }
+    controlManager.advanceSimulationInput();
+    // Record or replay the input of the session from its first frame, if asked to.
+    controlManager.beginInputSession();
+
+    // Keep the labels and dividers of the debug text on screen for the whole scene, instead of adding them again each frame.
+    std::vector<RegistryHandle> sceneTextHandles({});
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::WindowDimensions", "Window Dimensions: " + std::to_string(WINDOW_WIDTH) + "x" + std::to_string(WINDOW_HEIGHT) + "px", glm::vec2(1, 11), 0.5f));
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::ViewportDimensions", "Viewport Dimensions: " + std::to_string(VIEWPORT_WIDTH) + "x" + std::to_string(VIEWPORT_HEIGHT) + "px", glm::vec2(1, 10.5f), 0.5f));
+    const auto framebufferTextHandle = textManager.addRetainedText("Game::FramebufferDimensions", "", glm::vec2(1, 10), 0.5f);
+    sceneTextHandles.push_back(framebufferTextHandle);
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::TextDimensions", "Text Dimensions: " + std::to_string(TEXT_WIDTH) + "x" + std::to_string(TEXT_HEIGHT) + "px", glm::vec2(1, 9.5f), 0.5f));
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::MaxLights", "Max Lights:", glm::vec2(1, 9), 0.5f));
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::MaxConeLights", std::to_string(MAX_CONE_LIGHTS) + " Cone Lights", glm::vec2(3, 8.5f), 0.5f));
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::MaxPointLights", std::to_string(MAX_POINT_LIGHTS) + " Point Lights", glm::vec2(3, 8), 0.5f));
+    sceneTextHandles.push_back(textManager.addRetainedText("Game::MaxTextCharacters", "Max Text Characters: " + std::to_string(MAX_TEXT_CHARS) + " chars", glm::vec2(1, 7.5f), 0.5f));
+    const auto vsyncTextHandle = textManager.addRetainedText("Game::Vsync", "", glm::vec2(1, 7), 0.5f);
+    sceneTextHandles.push_back(vsyncTextHandle);
+    const auto dividerPositions = std::vector<float_t>({23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4});
+    for (size_t i = 0; i < dividerPositions.size(); i++)
+    {
+      sceneTextHandles.push_back(textManager.addRetainedText("Game::Divider" + std::to_string(i), "---------------", glm::vec2(1, dividerPositions[i]), 0.5f));
+    }
+
+    // The arena the changing retained texts are formatted into each frame, and the one the critical path of the last frame is.
+    TextArena retainedTextArena;
+    TextArena criticalPathArena;
+
+    // Start timing the frames from the first frame of the scene, and the HUD stats from the counters of its first frame.
+    framePacer.reset();
+    hudStatsManager.clear();
 
     // Start the game loop.
-    auto textRenderTimeLast = 0.0f;
-    auto frameTimeLast = 0.0f;
-    auto processTimeLast = 0.0f;
-    uint32_t textCharsRenderedLast = 0;
     do
     {
-      textManager.addText("Window Dimensions: " + std::to_string(WINDOW_WIDTH) + "x" + std::to_string(WINDOW_HEIGHT) + "px", glm::vec2(1, 11), 0.5f);
-      textManager.addText("Viewport Dimensions: " + std::to_string(VIEWPORT_WIDTH) + "x" + std::to_string(VIEWPORT_HEIGHT) + "px", glm::vec2(1, 10.5f), 0.5f);
-      textManager.addText("Framebuffer Dimensions: " + std::to_string(FRAMEBUFFER_WIDTH) + "x" + std::to_string(FRAMEBUFFER_HEIGHT) + "px", glm::vec2(1, 10), 0.5f);
-      textManager.addText("Text Dimensions: " + std::to_string(TEXT_WIDTH) + "x" + std::to_string(TEXT_HEIGHT) + "px", glm::vec2(1, 9.5f), 0.5f);
-      textManager.addText("Max Lights:", glm::vec2(1, 9), 0.5f);
-      textManager.addText(std::to_string(MAX_CONE_LIGHTS) + " Cone Lights", glm::vec2(3, 8.5f), 0.5f);
-      textManager.addText(std::to_string(MAX_POINT_LIGHTS) + " Point Lights", glm::vec2(3, 8), 0.5f);
-      textManager.addText("Max Text Characters: " + std::to_string(MAX_TEXT_CHARS) + " chars", glm::vec2(1, 7.5f), 0.5f);
-
-      auto isSwapEnabledStr = SWAP_INTERVAL == 0 ? std::string("False") : SWAP_INTERVAL == 1 ? std::string("True (Single-Sync)") : std::string("True (Double-Sync)");
-      textManager.addText("VSync Enabled: " + isSwapEnabledStr, glm::vec2(1, 7), 0.5f);
-
-      // Get the time at the start of the loop.
-      const auto currentTime = glfwGetTime();
-      auto updateStartTime = currentTime, updateEndTime = currentTime;
-
-      // Check if "B" key was pressed beyond 500ms since the last debug mode toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_B) && (currentTime - lastDebugEnabledChange) > 0.5f)
+      // Mark the start of the frame for the frame pacer.
+      framePacer.beginFrame();
+
+      // Change the retained texts with fields that can change, which are only laid out again if they did.
+      //   They are formatted into an arena instead of strings, so that comparing them makes no heap allocations.
+      retainedTextArena.reset();
+      {
+        const auto &renderConfig = RenderConfigManager::getConfig();
+        TextWriter framebufferText(retainedTextArena);
+        framebufferText << "Framebuffer Dimensions: " << FRAMEBUFFER_WIDTH << "x" << FRAMEBUFFER_HEIGHT << "px | Shadow Maps: " << renderConfig.coneLightShadowAtlasSize << "px Cone Atlas, " << renderConfig.pointLightShadowMapSize << "px Point, " << ShadowBufferManager::getShadowMemorySize() / (1024 * 1024) << "/" << renderConfig.shadowMemoryBudget / (1024 * 1024) << "MB" << (ShadowBufferManager::getShadowMemorySize() > renderConfig.shadowMemoryBudget ? " (Over Budget)" : "") << " | GPU Memory (U): ";
+        gpuMemoryManager.writeStatus(framebufferText);
+        textManager.setRetainedText(framebufferTextHandle, framebufferText);
+      }
+      textManager.setRetainedText(vsyncTextHandle, TextWriter(retainedTextArena) << "VSync Enabled: " << windowManager.getVsyncText());
+      // Format the HUD stats sampled by the last frames if it is time to refresh them, their lines being kept as they are otherwise.
+      hudStatsManager.update(glfwGetTime());
+
+      // Check if "B" key was pressed since the last frame, for the debug mode toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_B))
       {
-        // "B" key was pressed. Toggle debug mode and update the last change timestamp.
+        // "B" key was pressed. Toggle debug mode.
         debugEnabled = !debugEnabled;
-        lastDebugEnabledChange = currentTime;
       }
 
-      // Check if "T" key was pressed beyond 500ms since the last debug text toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_T) && (currentTime - lastTextEnabledChange) > 0.5f)
+      // Check if "T" key was pressed since the last frame, for the debug text toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_T))
       {
-        // "T" key was pressed. Toggle debug text and update the last change timestamp.
+        // "T" key was pressed. Toggle debug text.
         textEnabled = !textEnabled;
-        lastTextEnabledChange = currentTime;
       }
 
-      // Check if "V" key was pressed beyond 500ms since the last vsync toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_V) && (currentTime - lastVsyncToggledChange) > 0.5f)
+      // Check if "V" key was pressed since the last frame, for the vsync toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_V))
       {
-        // "V" key was pressed. Toggle vsync and update the last change timestamp.
+        // "V" key was pressed. Toggle vsync.
         windowManager.toggleVsync();
-        lastVsyncToggledChange = currentTime;
       }
 
-      // Update the lights.
-      updateStartTime = glfwGetTime();
-      lightManager.updateAllLights();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Light Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 0.5f), 0.5f);
-
-      // Update the cameras.
-      updateStartTime = glfwGetTime();
-      modelManager.updateAllModels();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Model Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1), 0.5f);
-
-      // Update the models.
-      updateStartTime = glfwGetTime();
-      cameraManager.updateAllCameras();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Camera Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1.5f), 0.5f);
-
-      // Render the scene.
-      updateStartTime = glfwGetTime();
-      renderManager.render();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2), 0.5f);
+      // Check if "G" key was pressed since the last frame, for the collision broadphase change.
+      if (controlManager.wasKeyPressed(GLFW_KEY_G))
+      {
+        // "G" key was pressed. Switch between the grid and the tree, so that their model update times can be compared.
+        collisionManager.setBroadphaseType(collisionManager.getBroadphaseType() == CollisionBroadphaseType::GRID ? CollisionBroadphaseType::TREE : CollisionBroadphaseType::GRID);
+      }
 
-      // Check if debug mode is enabled.
-      if (debugEnabled)
+      // Check if "P" key was pressed since the last frame, for the trace capture toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_P))
       {
-        // Render the debug models fo the main models and lights.
-        updateStartTime = glfwGetTime();
-        debugRenderManager.render();
-        updateEndTime = glfwGetTime();
-        textManager.addText("Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2.5f), 0.5f);
+        // "P" key was pressed. Start capturing a trace of the frames, or stop and write out the one being captured.
+        traceCaptureManager.toggleCapture();
       }
 
-      // Render text
-      textManager.addText("Text Render (Last Frame): " + std::to_string(textRenderTimeLast) + "ms", glm::vec2(1, 3), 0.5f);
-      textManager.addText("Text Characters Rendered (Last Frame): " + std::to_string(textCharsRenderedLast) + " chars", glm::vec2(1, 3.5f), 0.5f);
+      // Check if "F12" key was pressed since the last frame, for the screenshot.
+      if (controlManager.wasKeyPressed(GLFW_KEY_F12))
+      {
+        // "F12" key was pressed. Capture the next frame presented as a screenshot.
+        frameCaptureManager.requestScreenshot();
+      }
 
-      textManager.addText("Process Time (Last Frame): " + std::to_string(processTimeLast) + "ms", glm::vec2(1, 4.5f), 0.5f);
-      textManager.addText("Process Rate (Last Frame): " + std::to_string(1000 / processTimeLast) + "fps", glm::vec2(1, 5), 0.5f);
-      textManager.addText("Frame Time (Last Frame): " + std::to_string(frameTimeLast) + "ms", glm::vec2(1, 5.5f), 0.5f);
-      textManager.addText("Frame Rate (Last Frame): " + std::to_string(1000 / frameTimeLast) + "fps", glm::vec2(1, 6), 0.5f);
+      // Check if "F11" key was pressed since the last frame, for the continuous frame capture toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_F11))
+      {
+        // "F11" key was pressed. Start capturing every frame presented, or stop the running capture.
+        frameCaptureManager.toggleContinuousCapture();
+      }
 
-      const auto dividerPositions = std::vector<double>({23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4});
-      for (const auto &yPosition : dividerPositions)
+      // Check if "U" key was pressed since the last frame, for the GPU memory dump.
+      if (controlManager.wasKeyPressed(GLFW_KEY_U))
       {
-        textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
+        // "U" key was pressed. Print the GPU memory tracked by category and by asset.
+        gpuMemoryManager.dump();
       }
 
-      // Check if debug text is enabled.
-      updateStartTime = glfwGetTime();
-      if (textEnabled)
+      // Check if "R" key was pressed since the last frame, for the frame rate limit change.
+      if (controlManager.wasKeyPressed(GLFW_KEY_R))
       {
-        textCharsRenderedLast = textManager.render();
+        // "R" key was pressed. Switch to the next frame rate limit.
+        framePacer.cycleFrameRateLimit();
       }
-      updateEndTime = glfwGetTime();
-      textRenderTimeLast = (updateEndTime - updateStartTime) * 1000;
-      processTimeLast = (updateEndTime - currentTime) * 1000;
 
-      // Swap the window framebuffers.
-      windowManager.swapBuffers();
+      // Find the simulation steps the frame runs, and how far the rendered transforms are between the last two of them. A
+      //   replayed frame runs as many steps as it did when recorded.
+      if (controlManager.isInputReplaying())
+      {
+        simulationClock.setLockStep(true, controlManager.getReplayedStepsCount());
+      }
+      simulationStepsCount = simulationClock.beginFrame();
+      renderManager.setInterpolationFactor(simulationClock.getInterpolationFactor());
 
-      updateEndTime = glfwGetTime();
-      frameTimeLast = (updateEndTime - currentTime) * 1000;
+      // Run the phases of the frame, and keep the timings of the last frame for the report of the next one.
+      frameGraph.execute();
+      if (IS_RENDER_THREAD_ENABLED)
+      {
+        // The render thread renders the frames behind the main thread, so its timings are of the last frame it rendered.
+        textRenderTimeLast = renderThreadTextRenderTime;
+        textCharsRenderedLast = renderThreadTextCharsRendered;
+      }
+      else
+      {
+        textRenderTimeLast = frameGraph.getPhaseTime("Text Render");
+      }
+      // Copy the critical path into the storage left by the last one, for the report of the next frame.
+      criticalPathArena.reset();
+      TextWriter criticalPathText(criticalPathArena);
+      frameGraph.writeCriticalPath(criticalPathText);
+      criticalPathLast.assign(criticalPathText.getContent(), criticalPathText.getLength());
+      // Aggregate the profiler zones of the frame, for the debug text of the next one, and stop the trace capture if it is done.
+      cpuProfiler.endFrame();
+      allocationTracker.endFrame();
+      traceCaptureManager.update();
+      lightRenderStats.add(cpuProfiler.getChildZoneStats(0, "Light Render").getTotalTimeMs());
+      modelRenderStats.add(cpuProfiler.getChildZoneStats(0, "Model Render").getTotalTimeMs());
+
+      // Hold the frame until its deadline by the frame rate limit.
+      framePacer.endFrame(framePacer.getFrameRateLimit());
+      if (benchmarkManager.isBenchmarkEnabled())
+      {
+        benchmarkManager.recordFrame(framePacer.getFrameTime(), framePacer.getProcessTime());
+        if (benchmarkManager.isScreenshotDue())
+        {
+          frameCaptureManager.requestScreenshot();
+        }
+      }
+      telemetryManager.recordFrame(framePacer.getFrameTime(), framePacer.getProcessTime());
 
-      // Poll for window events.
+      // Poll for window events once the frame is held, right before the next frame is simulated, so that its input is not
+      //   aged by the hold.
       controlManager.pollEvents();
 
-      // Continue loop as long as escape key isn't pressed or the window close is not requested.
+      // Continue loop as long as escape key isn't pressed or the window close is not requested (or the benchmark or the replay is
+      //   finished).
     } while (
         getEnemyModelsCount() > 0 &&
         !controlManager.isKeyPressed(GLFW_KEY_ESCAPE) &&
-        !windowManager.isWindowCloseRequested());
+        !windowManager.isWindowCloseRequested() &&
+        !(benchmarkManager.isBenchmarkEnabled() && benchmarkManager.isFinished()) &&
+        !controlManager.isInputReplayFinished());
+    controlManager.endInputSession();
+
+    // Let the render thread finish the packets filled so far, and take the GL context back from it.
+    if (IS_RENDER_THREAD_ENABLED)
+    {
+      renderPacketRing.close();
+      renderThread.join();
+      windowManager.makeContextCurrent();
+    }
+    // Write out the frames captured so far.
+    frameCaptureManager.finishCaptures();
+
+    // Go back to updating the models with the real time in the other scenes.
+    simulationClock.stopFixedStep();
+    simulationClock.setLockStep(false);
+    controlManager.setSimulationInputScripted(false);
+    renderManager.setInterpolationFactor(1.0f);
+    // Go back to rendering the other scenes straight to the window.
+    dynamicResolutionManager.setEnabled(false);
+    // Take the debug text labels of the scene off the screen.
+    for (const auto &textHandle : sceneTextHandles)
+    {
+      textManager.removeRetainedText(textHandle);
+    }
+    hudStatsManager.clear();
+
+    // Report the benchmark, and quit instead of going to the end scene.
+    if (benchmarkManager.isBenchmarkEnabled())
+    {
+      benchmarkManager.writeReport(std::cout, getEnemyModelsCount(), simulationClock.getDroppedStepsCount());
+    }
 
     modelManager.deinitAllModels();
     lightManager.deinitAllLights();
     cameraManager.deinitAllCameras();
 
+    if (benchmarkManager.isBenchmarkEnabled())
+    {
+      return std::nullopt;
+    }
     return "EndScene";
   }
 };
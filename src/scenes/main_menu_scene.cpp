@@ -19,6 +19,10 @@
 #include "../include/render.cpp"
 #include "../include/debug_render.cpp"
 #include "../include/text.cpp"
+#include "../include/scene_loader.cpp"
+#include "../include/collision.cpp"
+#include "../include/frame_pacer.cpp"
+#include "../include/redraw_scheduler.cpp"
 
 #include "../camera/orthographic_camera.cpp"
 #include "../models/dummy_enemy_model.cpp"
@@ -40,9 +44,13 @@ private:
   CameraManager &cameraManager;
   RenderManager &renderManager;
   DebugRenderManager &debugRenderManager;
+  SceneLoader &sceneLoader;
 
-  std::vector<std::string> sceneCameraIds;
-  std::vector<std::string> sceneModelIds;
+  std::vector<RegistryHandle> sceneCameraHandles;
+  std::vector<RegistryHandle> sceneModelHandles;
+
+  // The hardware cursor shown instead of the cursor model, if the hardware cursor is enabled (null until the scene is loaded).
+  GLFWcursor *hardwareCursor;
 
   std::shared_ptr<StartModel> startModel;
   std::shared_ptr<ExitModel> exitModel;
@@ -51,11 +59,10 @@ private:
   {
     // Create a perspective camera, and set its properties.
     const auto cameraId = "MainCamera";
-    sceneCameraIds.push_back(cameraId);
 
     const auto orthographicCamera = OrthographicCamera::create(cameraId);
-    cameraManager.registerCamera(orthographicCamera);
-    renderManager.registerActiveCamera(orthographicCamera->getCameraId());
+    sceneCameraHandles.push_back(cameraManager.registerCamera(orthographicCamera));
+    renderManager.registerActiveCamera(sceneCameraHandles.back());
 
     orthographicCamera->setCameraPosition(glm::vec3(0.0f, 0.0f, 5.0f));
     orthographicCamera->setCameraAngles(glm::pi<float_t>(), 0.0f);
@@ -63,19 +70,19 @@ private:
 
   void deinitCameras()
   {
-    for (const auto &cameraId : sceneCameraIds)
+    for (const auto &cameraHandle : sceneCameraHandles)
     {
-      cameraManager.deregisterCamera(cameraId);
+      cameraManager.deregisterCamera(cameraHandle);
     }
+    sceneCameraHandles.clear();
   }
 
   void initEnemyModels()
   {
     const auto enemyModelId = "Enemy";
-    sceneModelIds.push_back(enemyModelId);
 
     const auto enemyModel = DummyEnemyModel::create(enemyModelId);
-    modelManager.registerModel(enemyModel);
+    sceneModelHandles.push_back(modelManager.registerModel(enemyModel));
     enemyModel->setModelPosition(glm::vec3(-0.3f, 0.2f, 0.0f));
   }
 
@@ -83,10 +90,9 @@ private:
   {
     // Create a player model.
     const auto playerModelId = "MainPlayer";
-    sceneModelIds.push_back(playerModelId);
 
     const auto playerModel = DummyPlayerModel::create(playerModelId);
-    modelManager.registerModel(playerModel);
+    sceneModelHandles.push_back(modelManager.registerModel(playerModel));
     playerModel->setModelPosition(glm::vec3(0.0f, 0.2f, 0.0f));
   }
 
@@ -94,10 +100,9 @@ private:
   {
     // Create a shot model.
     const auto shotModelId = "Shot";
-    sceneModelIds.push_back(shotModelId);
 
     const auto shotModel = DummyShotModel::create(shotModelId);
-    modelManager.registerModel(shotModel);
+    sceneModelHandles.push_back(modelManager.registerModel(shotModel));
     shotModel->setModelPosition(glm::vec3(0.3f, 0.3f, 0.0f));
   }
 
@@ -106,77 +111,82 @@ private:
     {
       // Create a title model.
       const auto titleModelId = "Title";
-      sceneModelIds.push_back(titleModelId);
 
       const auto titleModel = TitleModel::create(titleModelId);
-      modelManager.registerModel(titleModel);
+      sceneModelHandles.push_back(modelManager.registerModel(titleModel));
       titleModel->setModelPosition(glm::vec3(0.0f, 0.7f, 0.0f));
     }
     {
       // Create a start button model.
       const auto startModelId = "Start";
-      sceneModelIds.push_back(startModelId);
 
       startModel = StartModel::create(startModelId);
-      modelManager.registerModel(startModel);
+      sceneModelHandles.push_back(modelManager.registerModel(startModel));
       startModel->setModelPosition(glm::vec3(0.0f, -0.15f, 0.0f));
     }
     {
       // Create a exit button model.
       const auto exitModelId = "Exit";
-      sceneModelIds.push_back(exitModelId);
 
       exitModel = ExitModel::create(exitModelId);
-      modelManager.registerModel(exitModel);
+      sceneModelHandles.push_back(modelManager.registerModel(exitModel));
       exitModel->setModelPosition(glm::vec3(0.0f, -0.7f, 0.0f));
     }
+    // Create a cursor model, unless the cursor is shown as the hardware cursor.
+    if (!IS_HARDWARE_CURSOR_ENABLED)
     {
-      // Create a cursor model.
       const auto cursorModelId = "Cursor";
-      sceneModelIds.push_back(cursorModelId);
 
       const auto cursorModel = CursorModel::create(cursorModelId);
-      modelManager.registerModel(cursorModel);
+      sceneModelHandles.push_back(modelManager.registerModel(cursorModel));
       cursorModel->setModelPosition(glm::vec3(0.0f, 0.0f, 0.0f));
     }
   }
 
-  void initModels()
+  const void initModelTypes()
   {
     TitleModel::initModel();
-    renderLoadingText("Loading (15%)", glm::vec2(1, 1), 1.0f);
     StartModel::initModel();
     ExitModel::initModel();
-    renderLoadingText("Loading (20%)", glm::vec2(1, 1), 1.0f);
-    CursorModel::initModel();
-    renderLoadingText("Loading (25%)", glm::vec2(1, 1), 1.0f);
+    if (!IS_HARDWARE_CURSOR_ENABLED)
+    {
+      CursorModel::initModel();
+    }
     DummyEnemyModel::initModel();
-    renderLoadingText("Loading (40%)", glm::vec2(1, 1), 1.0f);
     DummyPlayerModel::initModel();
-    renderLoadingText("Loading (55%)", glm::vec2(1, 1), 1.0f);
     DummyShotModel::initModel();
-    renderLoadingText("Loading (70%)", glm::vec2(1, 1), 1.0f);
-
-    initEnemyModels();
-    renderLoadingText("Loading (85%)", glm::vec2(1, 1), 1.0f);
-    initPlayerModels();
-    renderLoadingText("Loading (90%)", glm::vec2(1, 1), 1.0f);
-    initShotModels();
-    renderLoadingText("Loading (95%)", glm::vec2(1, 1), 1.0f);
-    initTitleAndButtonModels();
+  }
+
+  void initModels()
+  {
+    // Queue the loading of the model dependencies.
+    initModelTypes();
+
+    // Queue the creation of the model instances, which needs the dependencies to be loaded.
+    sceneLoader.addStep([this]() {
+      initEnemyModels();
+      initPlayerModels();
+      initShotModels();
+      initTitleAndButtonModels();
+      return true;
+    });
   }
 
   void deinitModels()
   {
-    for (const auto &modelId : sceneModelIds)
+    for (const auto &modelHandle : sceneModelHandles)
     {
-      modelManager.deregisterModel(modelId);
+      modelManager.deregisterModel(modelHandle);
     }
+    sceneModelHandles.clear();
 
     TitleModel::deinitModel();
     StartModel::deinitModel();
     ExitModel::deinitModel();
-    CursorModel::deinitModel();
+    if (!IS_HARDWARE_CURSOR_ENABLED)
+    {
+      CursorModel::deinitModel();
+    }
     DummyEnemyModel::deinitModel();
     DummyPlayerModel::deinitModel();
     DummyShotModel::deinitModel();
@@ -189,10 +199,12 @@ public:
         modelManager(ModelManager::getInstance()),
         cameraManager(CameraManager::getInstance()),
         renderManager(RenderManager::getInstance()),
-        debugRenderManager(DebugRenderManager::getInstance())
+        debugRenderManager(DebugRenderManager::getInstance()),
+        sceneLoader(SceneLoader::getInstance()),
+        hardwareCursor(nullptr)
   {
-    sceneModelIds = std::vector<std::string>({});
-    sceneCameraIds = std::vector<std::string>({});
+    sceneModelHandles = std::vector<RegistryHandle>({});
+    sceneCameraHandles = std::vector<RegistryHandle>({});
   }
 
   const static std::shared_ptr<MainMenuScene> create(const std::string &sceneId)
@@ -202,22 +214,49 @@ public:
 
   const void init()
   {
-    renderLoadingText("Loading (0%)", glm::vec2(1, 1), 1.0f);
-    initCameras();
-    renderLoadingText("Loading (10%)", glm::vec2(1, 1), 1.0f);
+    sceneLoader.addStep([this]() {
+      initCameras();
+      return true;
+    });
     initModels();
-    renderLoadingText("Loading (99%)", glm::vec2(1, 1), 1.0f);
+    // Draw the title and the dummy models from the layer cache, since only the buttons and the cursor change every frame.
+    renderManager.setLayerCacheEnabled(true);
+
+    // Poll for events and set the mouse to the center of the screen. The hardware cursor is shown by the window, and is picked
+    //   with where the cursor is instead of being kept on it like the cursor model.
+    sceneLoader.addStep([this]() {
+      if (IS_HARDWARE_CURSOR_ENABLED)
+      {
+        hardwareCursor = CursorModel::createHardwareCursor();
+        controlManager.setCursorShape(hardwareCursor);
+        controlManager.enableCursor();
+      }
+      else
+      {
+        controlManager.disableCursor();
+      }
+      controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
+      controlManager.pollEvents();
+      return true;
+    });
+  }
 
-    // Poll for events and set the mouse to the center of the screen
-    controlManager.disableCursor();
-    controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
-    controlManager.pollEvents();
-    renderLoadingText("Loading (100%)", glm::vec2(1, 1), 1.0f);
+  const std::optional<std::string> getLikelyNextSceneId() const
+  {
+    // Starting the game is the likely choice over exiting.
+    return "GameScene";
   }
 
   const void deinit()
   {
+    renderManager.setLayerCacheEnabled(false);
     renderLoadingText("Cleaning (0%)", glm::vec2(1, 1), 1.0f);
+    if (hardwareCursor != nullptr)
+    {
+      controlManager.setCursorShape(nullptr);
+      glfwDestroyCursor(hardwareCursor);
+      hardwareCursor = nullptr;
+    }
     deinitModels();
     renderLoadingText("Cleaning (50%)", glm::vec2(1, 1), 1.0f);
     deinitCameras();
@@ -236,132 +275,191 @@ public:
 
     // Set debug mode to initially false.
     auto debugEnabled = false;
-    // Set the timestamp for when debug mode toggle was changed to 10 seconds in the past.
-    auto lastDebugEnabledChange = glfwGetTime() - 10;
 
     // Set debug text to initially false.
     auto textEnabled = false;
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastTextEnabledChange = glfwGetTime() - 10;
 
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastVsyncToggledChange = glfwGetTime() - 10;
+    // Render the frames on demand.
+    RedrawScheduler redrawScheduler;
 
-    // Start the game loop.
+    // The first pick requested by the scene, and the pick requested by the last click while it is not read back yet (0 if none).
+    uint64_t firstPickRequestId = 0, clickPickRequestId = 0;
+
+    // Start the game loop, with the frame times of the last scene forgotten.
     auto textRenderTimeLast = 0.0f;
-    auto frameTimeLast = 0.0f;
-    auto processTimeLast = 0.0f;
     uint32_t textCharsRenderedLast = 0;
+    framePacer.reset();
     do
     {
-      textManager.addText("Window Dimensions: " + std::to_string(WINDOW_WIDTH) + "x" + std::to_string(WINDOW_HEIGHT) + "px", glm::vec2(1, 11), 0.5f);
-      textManager.addText("Viewport Dimensions: " + std::to_string(VIEWPORT_WIDTH) + "x" + std::to_string(VIEWPORT_HEIGHT) + "px", glm::vec2(1, 10.5f), 0.5f);
-      textManager.addText("Text Dimensions: " + std::to_string(TEXT_WIDTH) + "x" + std::to_string(TEXT_HEIGHT) + "px", glm::vec2(1, 9.5f), 0.5f);
-      textManager.addText("Max Text Characters: " + std::to_string(MAX_TEXT_CHARS) + " chars", glm::vec2(1, 7.5f), 0.5f);
+      framePacer.beginFrame();
+
+      textManager.beginText(glm::vec2(1, 11), 0.5f) << "Window Dimensions: " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << "px";
+      textManager.beginText(glm::vec2(1, 10.5f), 0.5f) << "Viewport Dimensions: " << VIEWPORT_WIDTH << "x" << VIEWPORT_HEIGHT << "px";
+      textManager.beginText(glm::vec2(1, 9.5f), 0.5f) << "Text Dimensions: " << TEXT_WIDTH << "x" << TEXT_HEIGHT << "px";
+      textManager.beginText(glm::vec2(1, 7.5f), 0.5f) << "Max Text Characters: " << MAX_TEXT_CHARS << " chars";
 
-      auto isSwapEnabledStr = SWAP_INTERVAL == 0 ? std::string("False") : SWAP_INTERVAL == 1 ? std::string("True (Single-Sync)") : std::string("True (Double-Sync)");
-      textManager.addText("VSync Enabled: " + isSwapEnabledStr, glm::vec2(1, 7), 0.5f);
+      textManager.beginText(glm::vec2(1, 7), 0.5f) << "VSync Enabled: " << windowManager.getVsyncText();
 
       // Get the time at the start of the loop.
       const auto currentTime = glfwGetTime();
       auto updateStartTime = currentTime, updateEndTime = currentTime;
 
-      // Check if "B" key was pressed beyond 500ms since the last debug mode toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_B) && (currentTime - lastDebugEnabledChange) > 0.5f)
+      // Check if "B" key was pressed since the last frame, for the debug mode toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_B))
       {
-        // "B" key was pressed. Toggle debug mode and update the last change timestamp.
+        // "B" key was pressed. Toggle debug mode.
         debugEnabled = !debugEnabled;
-        lastDebugEnabledChange = currentTime;
       }
 
-      // Check if "T" key was pressed beyond 500ms since the last debug text toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_T) && (currentTime - lastTextEnabledChange) > 0.5f)
+      // Check if "T" key was pressed since the last frame, for the debug text toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_T))
       {
-        // "T" key was pressed. Toggle debug text and update the last change timestamp.
+        // "T" key was pressed. Toggle debug text.
         textEnabled = !textEnabled;
-        lastTextEnabledChange = currentTime;
       }
 
-      // Check if "V" key was pressed beyond 500ms since the last vsync toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_V) && (currentTime - lastVsyncToggledChange) > 0.5f)
+      // Check if "V" key was pressed since the last frame, for the vsync toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_V))
       {
-        // "V" key was pressed. Toggle vsync and update the last change timestamp.
+        // "V" key was pressed. Toggle vsync.
         windowManager.toggleVsync();
-        lastVsyncToggledChange = currentTime;
+      }
+
+      // Check if "O" key was pressed since the last frame, for the render mode change.
+      if (controlManager.wasKeyPressed(GLFW_KEY_O))
+      {
+        // "O" key was pressed. Switch between rendering on demand and rendering every frame.
+        redrawScheduler.toggleOnDemand();
       }
 
       // Update the cameras.
       updateStartTime = glfwGetTime();
       modelManager.updateAllModels();
       updateEndTime = glfwGetTime();
-      textManager.addText("Model Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1), 0.5f);
+      // Run the collision pass once the models have moved, sending them its events.
+      const auto collisionStartTime = updateEndTime;
+      modelManager.updateAllCollisions();
+      const auto collisionEndTime = glfwGetTime();
+      {
+        auto text = textManager.beginText(glm::vec2(1, 1), 0.5f);
+        modelManager.writeUpdateTiming(text);
+        text << " | Collision Pass: " << (collisionEndTime - collisionStartTime) * 1000 << "ms";
+      }
+
+      // Apply the registrations and de-registrations queued by the model updates and collision events in one batch, now that
+      //   nothing iterates the models.
+      modelManager.applyQueuedCommands();
 
       // Update the models.
       updateStartTime = glfwGetTime();
       cameraManager.updateAllCameras();
       updateEndTime = glfwGetTime();
-      textManager.addText("Camera Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1.5f), 0.5f);
+      textManager.beginText(glm::vec2(1, 1.5f), 0.5f) << "Camera Update: " << (updateEndTime - updateStartTime) * 1000 << "ms";
 
-      if (startModel->isClicked())
+      // Pick the button under the cursor once per click, by drawing the IDs of the buttons under the cursor on the GPU, read back
+      //   a frame (or a few) later. A click held from the last scene does not press a button, since it did not go down in this
+      //   one. The hardware cursor has no model colliding with the buttons, so it is picked every frame for their hover as well.
+      const auto isClicked = controlManager.wasMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
+      if (isClicked || IS_HARDWARE_CURSOR_ENABLED)
       {
-        return "GameScene";
+        const auto cursorPosition = controlManager.getCursorPosition();
+        const auto pickRequestId = renderManager.requestPick(glm::vec2(cursorPosition.getX(), cursorPosition.getY()), CollisionLayer::BUTTON_COLLISION_LAYER);
+        firstPickRequestId = firstPickRequestId != 0 ? firstPickRequestId : pickRequestId;
+        clickPickRequestId = isClicked ? pickRequestId : clickPickRequestId;
       }
-      if (exitModel->isClicked())
+      // Only the picks requested by the scene are used, since the models picked by the earlier scenes may be gone.
+      const auto pickResult = renderManager.getPickResult();
+      const auto pickedModel = firstPickRequestId != 0 && pickResult.requestId >= firstPickRequestId ? pickResult.model : nullptr;
+      if (IS_HARDWARE_CURSOR_ENABLED)
       {
-        break;
+        startModel->setCursorOver(pickedModel == startModel.get());
+        exitModel->setCursorOver(pickedModel == exitModel.get());
+      }
+      // Press the button picked for the last click, once its pick (or a later one) is read back.
+      if (clickPickRequestId != 0 && pickResult.requestId >= clickPickRequestId)
+      {
+        clickPickRequestId = 0;
+        if (pickedModel == startModel.get())
+        {
+          return "GameScene";
+        }
+        if (pickedModel == exitModel.get())
+        {
+          break;
+        }
       }
 
-      // Render the scene.
-      updateStartTime = glfwGetTime();
-      windowManager.enableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      renderManager.render();
-      windowManager.disableBlending();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2), 0.5f);
-
-      // Check if debug mode is enabled.
-      if (debugEnabled)
+      // Redraw the frame only if the render mode asks for it, discarding its text otherwise.
+      if (redrawScheduler.isRedrawDue())
       {
-        // Render the debug models fo the main models and lights.
+        // Render the scene.
         updateStartTime = glfwGetTime();
-        debugRenderManager.render();
+        windowManager.enableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        renderManager.render();
+        windowManager.disableBlending();
         updateEndTime = glfwGetTime();
-        textManager.addText("Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2.5f), 0.5f);
-      }
-
-      // Render text
-      textManager.addText("Text Render (Last Frame): " + std::to_string(textRenderTimeLast) + "ms", glm::vec2(1, 3), 0.5f);
-      textManager.addText("Text Characters Rendered (Last Frame): " + std::to_string(textCharsRenderedLast) + " chars", glm::vec2(1, 3.5f), 0.5f);
+        {
+          auto text = textManager.beginText(glm::vec2(1, 8.5f), 0.5f);
+          text << "Render Mode (O): ";
+          redrawScheduler.writeRenderMode(text);
+        }
+        textManager.beginText(glm::vec2(1, 2), 0.5f) << "Render: " << (updateEndTime - updateStartTime) * 1000 << "ms";
+
+        // Check if debug mode is enabled.
+        if (debugEnabled)
+        {
+          // Render the debug models fo the main models and lights.
+          updateStartTime = glfwGetTime();
+          debugRenderManager.render();
+          updateEndTime = glfwGetTime();
+          textManager.beginText(glm::vec2(1, 2.5f), 0.5f) << "Debug Render: " << (updateEndTime - updateStartTime) * 1000 << "ms";
+        }
+
+        // Render text
+        textManager.beginText(glm::vec2(1, 3), 0.5f) << "Text Render (Last Frame): " << textRenderTimeLast << "ms";
+        textManager.beginText(glm::vec2(1, 3.5f), 0.5f) << "Text Characters Rendered (Last Frame): " << textCharsRenderedLast << " chars";
+
+        textManager.beginText(glm::vec2(1, 4.5f), 0.5f) << "Process Time (Last Frame): " << framePacer.getProcessTime() << "ms";
+        textManager.beginText(glm::vec2(1, 5), 0.5f) << "Process Rate (Last Frame): " << 1000 / framePacer.getProcessTime() << "fps";
+        {
+          auto text = textManager.beginText(glm::vec2(1, 5.5f), 0.5f);
+          text << "Frame Time (Last Frame): " << framePacer.getFrameTime() << "ms | ";
+          framePacer.writeFrameTimeStats(text);
+        }
+        textManager.beginText(glm::vec2(1, 6), 0.5f) << "Frame Rate (Last Frame): " << 1000 / framePacer.getFrameTime() << "fps | Limit: " << MENU_FRAME_RATE_LIMIT << "fps";
+
+        const double dividerPositions[] = {23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4};
+        for (const auto &yPosition : dividerPositions)
+        {
+          textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
+        }
+
+        // Check if debug text is enabled.
+        updateStartTime = glfwGetTime();
+        if (textEnabled)
+        {
+          textCharsRenderedLast = textManager.render();
+        }
+        updateEndTime = glfwGetTime();
+        textRenderTimeLast = (updateEndTime - updateStartTime) * 1000;
 
-      textManager.addText("Process Time (Last Frame): " + std::to_string(processTimeLast) + "ms", glm::vec2(1, 4.5f), 0.5f);
-      textManager.addText("Process Rate (Last Frame): " + std::to_string(1000 / processTimeLast) + "fps", glm::vec2(1, 5), 0.5f);
-      textManager.addText("Frame Time (Last Frame): " + std::to_string(frameTimeLast) + "ms", glm::vec2(1, 5.5f), 0.5f);
-      textManager.addText("Frame Rate (Last Frame): " + std::to_string(1000 / frameTimeLast) + "fps", glm::vec2(1, 6), 0.5f);
+        // Swap the window framebuffers.
+        windowManager.swapBuffers();
 
-      const auto dividerPositions = std::vector<double>({23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4});
-      for (const auto &yPosition : dividerPositions)
-      {
-        textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
+        // Aggregate the profiler zones of the frames since the last redraw, for the debug text of the next one.
+        cpuProfiler.endFrame();
+        traceCaptureManager.update();
       }
-
-      // Check if debug text is enabled.
-      updateStartTime = glfwGetTime();
-      if (textEnabled)
+      else
       {
-        textCharsRenderedLast = textManager.render();
+        textManager.clearText();
       }
-      updateEndTime = glfwGetTime();
-      textRenderTimeLast = (updateEndTime - updateStartTime) * 1000;
-      processTimeLast = (updateEndTime - currentTime) * 1000;
 
-      // Swap the window framebuffers.
-      windowManager.swapBuffers();
+      // Poll for window events, or wait for them while the scene is idle.
+      redrawScheduler.pollEvents();
 
-      updateEndTime = glfwGetTime();
-      frameTimeLast = (updateEndTime - currentTime) * 1000;
-
-      // Poll for window events.
-      controlManager.pollEvents();
+      // Hold the frame to the frame rate limit of the menus, since they have nothing to gain from running faster.
+      framePacer.endFrame(MENU_FRAME_RATE_LIMIT);
 
       // Continue loop as long as escape key isn't pressed or the window close is not requested.
     } while (!controlManager.isKeyPressed(GLFW_KEY_ESCAPE) &&
@@ -8,6 +8,7 @@
 #include <memory>
 #include <algorithm>
 #include <iterator>
+#include <cmath>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -30,10 +31,18 @@ private:
 protected:
   WindowManager &windowManager;
   TextManager &textManager;
+  FramePacer &framePacer;
+  CpuProfiler &cpuProfiler;
+  TraceCaptureManager &traceCaptureManager;
+  ScenePreloader &scenePreloader;
 
   SceneBase(const std::string &sceneId, const std::string &sceneName)
       : windowManager(WindowManager::getInstance()),
         textManager(TextManager::getInstance()),
+        framePacer(FramePacer::getInstance()),
+        cpuProfiler(CpuProfiler::getInstance()),
+        traceCaptureManager(TraceCaptureManager::getInstance()),
+        scenePreloader(ScenePreloader::getInstance()),
         sceneId(sceneId), sceneName(sceneName)
   {
   }
@@ -42,6 +51,12 @@ protected:
   {
   }
 
+  /**
+   * Initialize the dependencies of the model types of the scene, done by its init, and by the scene manager recording the assets
+   *   of the scene to preload or retain them.
+   */
+  virtual const void initModelTypes() {}
+
   void renderLoadingText(const std::string &content, const glm::vec2 &position, const float_t &scale)
   {
     textManager.addText(content, position, scale);
@@ -54,6 +69,16 @@ protected:
   }
 
 public:
+  /**
+   * Render a frame of the loading screen, showing the given progress of loading the scene.
+   * 
+   * @param progress  The fraction of the scene that is loaded.
+   */
+  void renderLoadingFrame(const float_t &progress)
+  {
+    renderLoadingText("Loading (" + std::to_string(static_cast<int32_t>(std::floor(progress * 100))) + "%)", glm::vec2(1, 1), 1.0f);
+  }
+
   /**
    * Get the ID of the scene.
    * 
@@ -75,10 +100,42 @@ public:
   }
 
   /**
-   * Initialize the scene once registered.
+   * Initialize the scene once registered, queuing the steps for loading it on the scene loader.
    */
   virtual const void init() {}
 
+  /**
+   * Start loading the assets of the scene through the scene preloader, while the scene before it runs, so that its init only takes
+   *   the assets that are already loaded (as many as fit the budget of the preloader).
+   */
+  void preload()
+  {
+    scenePreloader.recordModels([this]() {
+      initModelTypes();
+    });
+  }
+
+  /**
+   * Keep the assets the scene shares with the scene before it through the scene preloader, before the scene before it is
+   *   de-initialized, so that only the assets that differ between the two are unloaded and loaded.
+   */
+  void retainSharedAssets()
+  {
+    scenePreloader.retainModels([this]() {
+      initModelTypes();
+    });
+  }
+
+  /**
+   * Get the ID of the scene most likely to follow this one, which is preloaded while this one runs.
+   * 
+   * @return The ID of the likely-next scene, or nothing if no scene is preloaded.
+   */
+  virtual const std::optional<std::string> getLikelyNextSceneId() const
+  {
+    return std::nullopt;
+  }
+
   /**
    * De-initialize the scene once de-registered.
    */